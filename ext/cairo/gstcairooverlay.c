@@ -84,6 +84,14 @@
  *
  * ]|
  * </refsect2>
+ *
+ * With #GstCairoOverlay:draw-on-transparent-surface the overlay is drawn on
+ * a transparent surface of the size of the video instead of on the frame.
+ * Only the part that was drawn on is then blended onto the frame, or
+ * attached to the buffer as #GstVideoOverlayCompositionMeta when downstream
+ * supports that. A static overlay like a logo can additionally set
+ * #GstCairoOverlay:cache-overlay so that it is only drawn again after
+ * #GstCairoOverlay::invalidate.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -96,6 +104,8 @@
 
 #include <cairo.h>
 
+#include <string.h>
+
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
 #define TEMPLATE_CAPS GST_VIDEO_CAPS_MAKE("{ BGRx, BGRA }")
 #else
@@ -119,15 +129,102 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 
 G_DEFINE_TYPE (GstCairoOverlay, gst_cairo_overlay, GST_TYPE_VIDEO_FILTER);
 
+#define DEFAULT_DRAW_ON_TRANSPARENT_SURFACE FALSE
+#define DEFAULT_CACHE_OVERLAY FALSE
+
+enum
+{
+  PROP_0,
+  PROP_DRAW_ON_TRANSPARENT_SURFACE,
+  PROP_CACHE_OVERLAY
+};
+
 enum
 {
   SIGNAL_DRAW,
   SIGNAL_CAPS_CHANGED,
+  SIGNAL_INVALIDATE,
   N_SIGNALS
 };
 
 static guint gst_cairo_overlay_signals[N_SIGNALS];
 
+static void
+gst_cairo_overlay_clear_composition (GstCairoOverlay * overlay)
+{
+  if (overlay->composition)
+    gst_video_overlay_composition_unref (overlay->composition);
+  overlay->composition = NULL;
+}
+
+static void
+gst_cairo_overlay_invalidate (GstCairoOverlay * overlay)
+{
+  GST_OBJECT_LOCK (overlay);
+  overlay->invalidated = TRUE;
+  GST_OBJECT_UNLOCK (overlay);
+}
+
+static void
+gst_cairo_overlay_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstCairoOverlay *overlay = GST_CAIRO_OVERLAY (object);
+
+  GST_OBJECT_LOCK (overlay);
+  switch (property_id) {
+    case PROP_DRAW_ON_TRANSPARENT_SURFACE:
+      overlay->draw_on_transparent_surface = g_value_get_boolean (value);
+      overlay->invalidated = TRUE;
+      break;
+    case PROP_CACHE_OVERLAY:
+      overlay->cache_overlay = g_value_get_boolean (value);
+      overlay->invalidated = TRUE;
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (overlay);
+}
+
+static void
+gst_cairo_overlay_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstCairoOverlay *overlay = GST_CAIRO_OVERLAY (object);
+
+  GST_OBJECT_LOCK (overlay);
+  switch (property_id) {
+    case PROP_DRAW_ON_TRANSPARENT_SURFACE:
+      g_value_set_boolean (value, overlay->draw_on_transparent_surface);
+      break;
+    case PROP_CACHE_OVERLAY:
+      g_value_set_boolean (value, overlay->cache_overlay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (overlay);
+}
+
+static void
+gst_cairo_overlay_finalize (GObject * object)
+{
+  gst_cairo_overlay_clear_composition (GST_CAIRO_OVERLAY (object));
+
+  G_OBJECT_CLASS (gst_cairo_overlay_parent_class)->finalize (object);
+}
+
+static gboolean
+gst_cairo_overlay_stop (GstBaseTransform * trans)
+{
+  gst_cairo_overlay_clear_composition (GST_CAIRO_OVERLAY (trans));
+
+  return TRUE;
+}
+
 static gboolean
 gst_cairo_overlay_set_info (GstVideoFilter * vfilter, GstCaps * in_caps,
     GstVideoInfo * in_info, GstCaps * out_caps, GstVideoInfo * out_info)
@@ -137,9 +234,155 @@ gst_cairo_overlay_set_info (GstVideoFilter * vfilter, GstCaps * in_caps,
   g_signal_emit (overlay, gst_cairo_overlay_signals[SIGNAL_CAPS_CHANGED], 0,
       in_caps, NULL);
 
+  /* the overlay is drawn again for the new size, and downstream might take
+   * the meta or not with the new caps */
+  gst_cairo_overlay_clear_composition (overlay);
+  overlay->check_meta = TRUE;
+
+  return TRUE;
+}
+
+/* ask downstream if it can handle the overlay composition meta */
+static gboolean
+gst_cairo_overlay_downstream_has_meta (GstCairoOverlay * overlay)
+{
+  GstPad *srcpad = GST_BASE_TRANSFORM_SRC_PAD (overlay);
+  GstCaps *caps;
+  GstQuery *query;
+  gboolean ret = FALSE;
+
+  if (!(caps = gst_pad_get_current_caps (srcpad)))
+    return FALSE;
+
+  query = gst_query_new_allocation (caps, FALSE);
+  if (gst_pad_peer_query (srcpad, query))
+    ret = gst_query_find_allocation_meta (query,
+        GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  return ret;
+}
+
+/* draw the overlay on a transparent surface and keep the part that was drawn
+ * on as the overlay composition */
+static gboolean
+gst_cairo_overlay_render (GstCairoOverlay * overlay, GstVideoFrame * frame)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  const guint8 *data;
+  gint stride, x, y, x0, y0, x1, y1, w, h;
+  GstVideoOverlayRectangle *rect;
+  GstBuffer *pixels;
+  GstMapInfo map;
+
+  gst_cairo_overlay_clear_composition (overlay);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  if (G_UNLIKELY (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS)) {
+    cairo_surface_destroy (surface);
+    return FALSE;
+  }
+
+  cr = cairo_create (surface);
+  if (G_UNLIKELY (!cr)) {
+    cairo_surface_destroy (surface);
+    return FALSE;
+  }
+
+  g_signal_emit (overlay, gst_cairo_overlay_signals[SIGNAL_DRAW], 0,
+      cr, GST_BUFFER_PTS (frame->buffer), GST_BUFFER_DURATION (frame->buffer),
+      NULL);
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  /* find the box around the pixels that were drawn, with premultiplied alpha
+   * the transparent pixels are all 0 */
+  x0 = width;
+  y0 = height;
+  x1 = y1 = -1;
+  for (y = 0; y < height; y++) {
+    const guint32 *line = (const guint32 *) (data + y * stride);
+
+    for (x = 0; x < width && line[x] == 0; x++);
+    if (x == width)
+      continue;
+    x0 = MIN (x0, x);
+    for (x = width - 1; line[x] == 0; x--);
+    x1 = MAX (x1, x);
+    y0 = MIN (y0, y);
+    y1 = y;
+  }
+
+  /* nothing was drawn */
+  if (x1 < 0) {
+    cairo_surface_destroy (surface);
+    return TRUE;
+  }
+
+  w = x1 - x0 + 1;
+  h = y1 - y0 + 1;
+
+  /* cairo's native endian ARGB32 is the RGB format of the overlay API */
+  pixels = gst_buffer_new_and_alloc (w * h * 4);
+  gst_buffer_map (pixels, &map, GST_MAP_WRITE);
+  for (y = 0; y < h; y++)
+    memcpy (map.data + y * w * 4, data + (y0 + y) * stride + x0 * 4, w * 4);
+  gst_buffer_unmap (pixels, &map);
+  cairo_surface_destroy (surface);
+
+  gst_buffer_add_video_meta (pixels, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB, w, h);
+  rect = gst_video_overlay_rectangle_new_raw (pixels, x0, y0, w, h,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
+  gst_buffer_unref (pixels);
+
+  overlay->composition = gst_video_overlay_composition_new (rect);
+  gst_video_overlay_rectangle_unref (rect);
+
   return TRUE;
 }
 
+static GstFlowReturn
+gst_cairo_overlay_transform_transparent (GstCairoOverlay * overlay,
+    GstVideoFrame * frame)
+{
+  gboolean redraw;
+
+  GST_OBJECT_LOCK (overlay);
+  redraw = !overlay->cache_overlay || overlay->invalidated ||
+      overlay->composition == NULL;
+  overlay->invalidated = FALSE;
+  GST_OBJECT_UNLOCK (overlay);
+
+  if (redraw && !gst_cairo_overlay_render (overlay, frame))
+    return GST_FLOW_ERROR;
+
+  if (overlay->composition == NULL)
+    return GST_FLOW_OK;
+
+  if (G_UNLIKELY (overlay->check_meta)) {
+    overlay->attach_meta = gst_cairo_overlay_downstream_has_meta (overlay);
+    overlay->check_meta = FALSE;
+  }
+
+  /* downstream does the blending, or we blend only the drawn part */
+  if (overlay->attach_meta)
+    gst_buffer_add_video_overlay_composition_meta (frame->buffer,
+        overlay->composition);
+  else
+    gst_video_overlay_composition_blend (overlay->composition, frame);
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_cairo_overlay_transform_frame_ip (GstVideoFilter * vfilter,
     GstVideoFrame * frame)
@@ -148,6 +391,14 @@ gst_cairo_overlay_transform_frame_ip (GstVideoFilter * vfilter,
   cairo_surface_t *surface;
   cairo_t *cr;
   cairo_format_t format;
+  gboolean transparent;
+
+  GST_OBJECT_LOCK (overlay);
+  transparent = overlay->draw_on_transparent_surface;
+  GST_OBJECT_UNLOCK (overlay);
+
+  if (transparent)
+    return gst_cairo_overlay_transform_transparent (overlay, frame);
 
   if (GST_VIDEO_FRAME_N_COMPONENTS (frame) == 4)
     format = CAIRO_FORMAT_ARGB32;
@@ -181,12 +432,24 @@ gst_cairo_overlay_transform_frame_ip (GstVideoFilter * vfilter,
 static void
 gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
 {
+  GObjectClass *gobject_class;
+  GstBaseTransformClass *trans_class;
   GstVideoFilterClass *vfilter_class;
   GstElementClass *element_class;
 
+  gobject_class = (GObjectClass *) klass;
+  trans_class = (GstBaseTransformClass *) klass;
   vfilter_class = (GstVideoFilterClass *) klass;
   element_class = (GstElementClass *) klass;
 
+  gobject_class->set_property = gst_cairo_overlay_set_property;
+  gobject_class->get_property = gst_cairo_overlay_get_property;
+  gobject_class->finalize = gst_cairo_overlay_finalize;
+
+  trans_class->stop = gst_cairo_overlay_stop;
+
+  klass->invalidate = gst_cairo_overlay_invalidate;
+
   vfilter_class->set_info = gst_cairo_overlay_set_info;
   vfilter_class->transform_frame_ip = gst_cairo_overlay_transform_frame_ip;
 
@@ -222,6 +485,52 @@ gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
       0,
       0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 1, GST_TYPE_CAPS);
 
+  /**
+   * GstCairoOverlay::invalidate:
+   * @overlay: Overlay element on which the signal is emitted.
+   *
+   * Draw the overlay again for the next frame when
+   * #GstCairoOverlay:cache-overlay is set.
+   *
+   * Since: 1.4
+   */
+  gst_cairo_overlay_signals[SIGNAL_INVALIDATE] =
+      g_signal_new ("invalidate", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_STRUCT_OFFSET (GstCairoOverlayClass, invalidate),
+      NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 0);
+
+  /**
+   * GstCairoOverlay:draw-on-transparent-surface:
+   *
+   * Draw the overlay on a transparent surface instead of on the video frame.
+   * The drawn part is blended onto the frame or attached to it as
+   * #GstVideoOverlayCompositionMeta when downstream supports it.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_DRAW_ON_TRANSPARENT_SURFACE,
+      g_param_spec_boolean ("draw-on-transparent-surface",
+          "Draw on transparent surface",
+          "Let the draw signal work on a transparent surface and blend the "
+          "result onto the video frame", DEFAULT_DRAW_ON_TRANSPARENT_SURFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstCairoOverlay:cache-overlay:
+   *
+   * With #GstCairoOverlay:draw-on-transparent-surface, only emit the draw
+   * signal for the first frame, after caps changes and after
+   * #GstCairoOverlay::invalidate. The other frames get the same overlay.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_OVERLAY,
+      g_param_spec_boolean ("cache-overlay", "Cache overlay",
+          "Only draw the transparent overlay again after it was invalidated",
+          DEFAULT_CACHE_OVERLAY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class, "Cairo overlay",
       "Filter/Editor/Video",
       "Render overlay on a video stream using Cairo",
@@ -236,5 +545,7 @@ gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
 static void
 gst_cairo_overlay_init (GstCairoOverlay * overlay)
 {
-  /* nothing to do */
+  overlay->draw_on_transparent_surface = DEFAULT_DRAW_ON_TRANSPARENT_SURFACE;
+  overlay->cache_overlay = DEFAULT_CACHE_OVERLAY;
+  overlay->check_meta = TRUE;
 }
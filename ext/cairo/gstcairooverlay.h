@@ -45,10 +45,25 @@ typedef struct _GstCairoOverlayClass GstCairoOverlayClass;
 
 struct _GstCairoOverlay {
   GstVideoFilter video_filter;
+
+  /* properties */
+  gboolean draw_on_transparent_surface;
+  gboolean cache_overlay;
+
+  /* what was drawn on the transparent surface */
+  GstVideoOverlayComposition *composition;
+  gboolean invalidated;
+
+  /* downstream takes the composition as meta */
+  gboolean check_meta;
+  gboolean attach_meta;
 };
 
 struct _GstCairoOverlayClass {
   GstVideoFilterClass video_filter_class;
+
+  /* actions */
+  void (*invalidate) (GstCairoOverlay * overlay);
 };
 
 GType gst_cairo_overlay_get_type (void);
@@ -72,6 +72,8 @@
 
 #define DV_DEFAULT_QUALITY DV_QUALITY_BEST
 #define DV_DEFAULT_DECODE_NTH 1
+#define DV_DEFAULT_REUSE_DECODER FALSE
+#define DV_DEFAULT_N_THREADS 1
 
 GST_DEBUG_CATEGORY_STATIC (dvdec_debug);
 #define GST_CAT_DEFAULT dvdec_debug
@@ -82,7 +84,34 @@ enum
   PROP_CLAMP_LUMA,
   PROP_CLAMP_CHROMA,
   PROP_QUALITY,
-  PROP_DECODE_NTH
+  PROP_DECODE_NTH,
+  PROP_REUSE_DECODER,
+  PROP_N_THREADS
+};
+
+/* stopped decoders that wait to be reused, shared by all the elements of
+ * the process. A decoder only fits elements with the same clamping */
+#define MAX_POOLED_DECODERS 16
+
+typedef struct
+{
+  gboolean clamp_luma;
+  gboolean clamp_chroma;
+  dv_decoder_t *decoder;
+} GstDVDecPooled;
+
+static GMutex decoder_pool_lock;
+static GQueue decoder_pool = G_QUEUE_INIT;
+
+/* a frame that waits for the other frames of its batch. The input stays
+ * mapped and the output frame mapped until the batch is decoded */
+struct _GstDVDecJob
+{
+  dv_decoder_t *decoder;
+  GstBuffer *input;
+  GstMapInfo map;
+  GstBuffer *output;
+  GstVideoFrame frame;
 };
 
 const gint qualities[] = {
@@ -138,6 +167,8 @@ static GstFlowReturn gst_dvdec_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 static gboolean gst_dvdec_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_dvdec_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
 
 static GstStateChangeReturn gst_dvdec_change_state (GstElement * element,
     GstStateChange transition);
@@ -174,6 +205,37 @@ gst_dvdec_class_init (GstDVDecClass * klass)
           1, G_MAXINT, DV_DEFAULT_DECODE_NTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDVDec:reuse-decoder:
+   *
+   * Put the libdv decoder in a pool of the process when the element stops,
+   * and take one with the same clamping from there when it starts. This
+   * saves setting up a new decoder and its tables for every stream when
+   * many short streams are decoded.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_REUSE_DECODER,
+      g_param_spec_boolean ("reuse-decoder", "Reuse decoder",
+          "Keep stopped decoders in a pool to use them for the next stream",
+          DV_DEFAULT_REUSE_DECODER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDVDec:n-threads:
+   *
+   * Decode batches of this many frames in parallel, each with its own libdv
+   * decoder. The frames are pushed in their original order but a frame
+   * waits until the batch is complete, which adds n-threads - 1 frames of
+   * latency. 1 decodes every frame right away.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of frames to decode in parallel", 1, 64,
+          DV_DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_dvdec_change_state);
 
   gst_element_class_add_pad_template (gstelement_class,
@@ -198,6 +260,7 @@ gst_dvdec_init (GstDVDec * dvdec)
   gst_element_add_pad (GST_ELEMENT (dvdec), dvdec->sinkpad);
 
   dvdec->srcpad = gst_pad_new_from_static_template (&src_temp, "src");
+  gst_pad_set_query_function (dvdec->srcpad, gst_dvdec_src_query);
   gst_pad_use_fixed_caps (dvdec->srcpad);
   gst_element_add_pad (GST_ELEMENT (dvdec), dvdec->srcpad);
 
@@ -209,6 +272,8 @@ gst_dvdec_init (GstDVDec * dvdec)
   dvdec->clamp_luma = FALSE;
   dvdec->clamp_chroma = FALSE;
   dvdec->quality = DV_DEFAULT_QUALITY;
+  dvdec->reuse_decoder = DV_DEFAULT_REUSE_DECODER;
+  dvdec->n_threads = DV_DEFAULT_N_THREADS;
 }
 
 static gboolean
@@ -357,6 +422,124 @@ gst_dvdec_src_negotiate (GstDVDec * dvdec)
   return TRUE;
 }
 
+static void
+gst_dvdec_decode_frame (GstDVDec * dvdec, dv_decoder_t * decoder,
+    guint8 * inframe, GstVideoFrame * frame)
+{
+  guint8 *outframe_ptrs[3];
+  gint outframe_pitches[3];
+
+  outframe_ptrs[0] = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  outframe_pitches[0] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+
+  /* the rest only matters for YUY2 */
+  if (dvdec->bpp < 3) {
+    outframe_ptrs[1] = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
+    outframe_ptrs[2] = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
+
+    outframe_pitches[1] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+    outframe_pitches[2] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 2);
+  }
+
+  dv_decode_full_frame (decoder, inframe,
+      e_dv_color_yuv, outframe_ptrs, outframe_pitches);
+}
+
+static void
+gst_dvdec_decode_job (gpointer data, gpointer context, guint index)
+{
+  GstDVDec *dvdec = data;
+  GstDVDecJob *job = context;
+
+  /* the header was checked in the chain function, but every decoder needs
+   * to know about the frame it decodes */
+  dv_parse_header (job->decoder, job->map.data);
+  gst_dvdec_decode_frame (dvdec, job->decoder, job->map.data, &job->frame);
+}
+
+static void
+gst_dvdec_unmap_job (GstDVDecJob * job)
+{
+  gst_video_frame_unmap (&job->frame);
+  gst_buffer_unmap (job->input, &job->map);
+  gst_buffer_unref (job->input);
+  job->input = NULL;
+}
+
+/* push the decoded frame of a job, in the order of the batch */
+static GstFlowReturn
+gst_dvdec_finish_job (gpointer data, gpointer context)
+{
+  GstDVDec *dvdec = data;
+  GstDVDecJob *job = context;
+  GstBuffer *outbuf = job->output;
+
+  gst_dvdec_unmap_job (job);
+  job->output = NULL;
+
+  return gst_pad_push (dvdec->srcpad, outbuf);
+}
+
+/* forget a frame that waits for a batch */
+static void
+gst_dvdec_clear_job (gpointer data, gpointer context)
+{
+  GstDVDecJob *job = context;
+
+  gst_dvdec_unmap_job (job);
+  gst_buffer_unref (job->output);
+  job->output = NULL;
+}
+
+/* decode the frames that wait for a batch and push them in order */
+static GstFlowReturn
+gst_dvdec_decode_jobs (GstDVDec * dvdec)
+{
+  if (!dvdec->batch)
+    return GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (dvdec, "decoding and pushing %u buffers",
+      gst_work_batch_get_n_queued (dvdec->batch));
+
+  return gst_work_batch_flush (dvdec->batch);
+}
+
+static gboolean
+gst_dvdec_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstDVDec *dvdec = GST_DVDEC (parent);
+  gboolean res;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    {
+      GstClockTime min, max, latency;
+      gboolean live;
+
+      if ((res = gst_pad_peer_query (dvdec->sinkpad, query))) {
+        gst_query_parse_latency (query, &live, &min, &max);
+
+        /* a frame waits for the rest of its batch */
+        if (dvdec->batch) {
+          latency = gst_work_batch_get_latency (dvdec->batch,
+              dvdec->framerate_numerator, dvdec->framerate_denominator);
+          min += latency;
+          if (max != GST_CLOCK_TIME_NONE)
+            max += latency;
+        }
+
+        gst_query_set_latency (query, live, min, max);
+      }
+      break;
+    }
+    default:
+      res = gst_pad_query_default (pad, parent, query);
+      break;
+  }
+
+  return res;
+}
+
 static gboolean
 gst_dvdec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -365,8 +548,15 @@ gst_dvdec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   dvdec = GST_DVDEC (parent);
 
+  /* the frames that wait for a batch go out before serialized events */
+  if (GST_EVENT_IS_SERIALIZED (event) &&
+      GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP)
+    gst_dvdec_decode_jobs (dvdec);
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_STOP:
+      if (dvdec->batch)
+        gst_work_batch_clear (dvdec->batch);
       gst_segment_init (&dvdec->segment, GST_FORMAT_UNDEFINED);
       dvdec->need_segment = FALSE;
       break;
@@ -415,8 +605,6 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
   GstDVDec *dvdec;
   guint8 *inframe;
-  guint8 *outframe_ptrs[3];
-  gint outframe_pitches[3];
   GstMapInfo map;
   GstVideoFrame frame;
   GstBuffer *outbuf;
@@ -472,8 +660,12 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   dvdec->interlaced = !dv_is_progressive (dvdec->decoder);
 
-  /* negotiate if not done yet */
+  /* negotiate if not done yet, the frames of the old format go out
+   * before the new caps */
   if (!dvdec->src_negotiated) {
+    ret = gst_dvdec_decode_jobs (dvdec);
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      goto done;
     if (!gst_dvdec_src_negotiate (dvdec))
       goto not_negotiated;
   }
@@ -495,33 +687,34 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   if (G_UNLIKELY (ret != GST_FLOW_OK))
     goto no_buffer;
 
-  gst_video_frame_map (&frame, &dvdec->vinfo, outbuf, GST_MAP_WRITE);
+  GST_BUFFER_FLAG_UNSET (outbuf, GST_VIDEO_BUFFER_FLAG_TFF);
 
-  outframe_ptrs[0] = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
-  outframe_pitches[0] = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  GST_BUFFER_OFFSET (outbuf) = GST_BUFFER_OFFSET (buf);
+  GST_BUFFER_OFFSET_END (outbuf) = GST_BUFFER_OFFSET_END (buf);
+  GST_BUFFER_TIMESTAMP (outbuf) = cstart;
+  GST_BUFFER_DURATION (outbuf) = cstop - cstart;
 
-  /* the rest only matters for YUY2 */
-  if (dvdec->bpp < 3) {
-    outframe_ptrs[1] = GST_VIDEO_FRAME_COMP_DATA (&frame, 1);
-    outframe_ptrs[2] = GST_VIDEO_FRAME_COMP_DATA (&frame, 2);
+  /* with several decoders, wait until there is a frame for each of them */
+  if (dvdec->batch) {
+    GstDVDecJob *job = gst_work_batch_peek (dvdec->batch);
 
-    outframe_pitches[1] = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
-    outframe_pitches[2] = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 2);
+    gst_video_frame_map (&job->frame, &dvdec->vinfo, outbuf, GST_MAP_WRITE);
+    job->output = outbuf;
+    /* the job keeps the input mapped until it is decoded */
+    job->input = buf;
+    job->map = map;
+    dvdec->video_offset++;
+
+    return gst_work_batch_queue (dvdec->batch);
   }
 
+  gst_video_frame_map (&frame, &dvdec->vinfo, outbuf, GST_MAP_WRITE);
+
   GST_DEBUG_OBJECT (dvdec, "decoding and pushing buffer");
-  dv_decode_full_frame (dvdec->decoder, inframe,
-      e_dv_color_yuv, outframe_ptrs, outframe_pitches);
+  gst_dvdec_decode_frame (dvdec, dvdec->decoder, inframe, &frame);
 
   gst_video_frame_unmap (&frame);
 
-  GST_BUFFER_FLAG_UNSET (outbuf, GST_VIDEO_BUFFER_FLAG_TFF);
-
-  GST_BUFFER_OFFSET (outbuf) = GST_BUFFER_OFFSET (buf);
-  GST_BUFFER_OFFSET_END (outbuf) = GST_BUFFER_OFFSET_END (buf);
-  GST_BUFFER_TIMESTAMP (outbuf) = cstart;
-  GST_BUFFER_DURATION (outbuf) = cstop - cstart;
-
   ret = gst_pad_push (dvdec->srcpad, outbuf);
 
 skip:
@@ -568,6 +761,98 @@ dropping:
   }
 }
 
+static dv_decoder_t *
+gst_dvdec_acquire_decoder (GstDVDec * dvdec)
+{
+  dv_decoder_t *decoder = NULL;
+  GList *l;
+
+  if (dvdec->reuse_decoder) {
+    g_mutex_lock (&decoder_pool_lock);
+    for (l = decoder_pool.head; l; l = l->next) {
+      GstDVDecPooled *pooled = l->data;
+
+      if (pooled->clamp_luma == dvdec->clamp_luma &&
+          pooled->clamp_chroma == dvdec->clamp_chroma) {
+        decoder = pooled->decoder;
+        g_slice_free (GstDVDecPooled, pooled);
+        g_queue_delete_link (&decoder_pool, l);
+        break;
+      }
+    }
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (decoder) {
+    GST_DEBUG_OBJECT (dvdec, "reusing decoder %p", decoder);
+    return decoder;
+  }
+
+  return dv_decoder_new (0, dvdec->clamp_luma, dvdec->clamp_chroma);
+}
+
+static void
+gst_dvdec_release_decoder (GstDVDec * dvdec, dv_decoder_t * decoder)
+{
+  if (dvdec->reuse_decoder) {
+    g_mutex_lock (&decoder_pool_lock);
+    if (decoder_pool.length < MAX_POOLED_DECODERS) {
+      GstDVDecPooled *pooled = g_slice_new (GstDVDecPooled);
+
+      pooled->clamp_luma = dvdec->clamp_luma;
+      pooled->clamp_chroma = dvdec->clamp_chroma;
+      pooled->decoder = decoder;
+      g_queue_push_head (&decoder_pool, pooled);
+      decoder = NULL;
+    }
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (decoder)
+    dv_decoder_free (decoder);
+}
+
+static void
+gst_dvdec_start_jobs (GstDVDec * dvdec)
+{
+  guint i;
+
+  if (dvdec->n_threads <= 1)
+    return;
+
+  dvdec->batch = gst_work_batch_new (dvdec->n_threads, sizeof (GstDVDecJob),
+      gst_dvdec_decode_job, gst_dvdec_finish_job, gst_dvdec_clear_job, dvdec);
+  GST_DEBUG_OBJECT (dvdec, "decoding with %u threads",
+      gst_work_batch_get_size (dvdec->batch));
+
+  for (i = 0; i < gst_work_batch_get_size (dvdec->batch); i++) {
+    GstDVDecJob *job = gst_work_batch_get_context (dvdec->batch, i);
+    dv_decoder_t *decoder = gst_dvdec_acquire_decoder (dvdec);
+
+    decoder->quality = qualities[dvdec->quality];
+    dv_set_error_log (decoder, NULL);
+    job->decoder = decoder;
+  }
+}
+
+static void
+gst_dvdec_stop_jobs (GstDVDec * dvdec)
+{
+  guint i;
+
+  if (!dvdec->batch)
+    return;
+
+  gst_work_batch_clear (dvdec->batch);
+  for (i = 0; i < gst_work_batch_get_size (dvdec->batch); i++) {
+    GstDVDecJob *job = gst_work_batch_get_context (dvdec->batch, i);
+
+    gst_dvdec_release_decoder (dvdec, job->decoder);
+  }
+  gst_work_batch_free (dvdec->batch);
+  dvdec->batch = NULL;
+}
+
 static GstStateChangeReturn
 gst_dvdec_change_state (GstElement * element, GstStateChange transition)
 {
@@ -579,10 +864,10 @@ gst_dvdec_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_NULL_TO_READY:
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
-      dvdec->decoder =
-          dv_decoder_new (0, dvdec->clamp_luma, dvdec->clamp_chroma);
+      dvdec->decoder = gst_dvdec_acquire_decoder (dvdec);
       dvdec->decoder->quality = qualities[dvdec->quality];
       dv_set_error_log (dvdec->decoder, NULL);
+      gst_dvdec_start_jobs (dvdec);
       gst_video_info_init (&dvdec->vinfo);
       gst_segment_init (&dvdec->segment, GST_FORMAT_UNDEFINED);
       dvdec->src_negotiated = FALSE;
@@ -606,7 +891,8 @@ gst_dvdec_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      dv_decoder_free (dvdec->decoder);
+      gst_dvdec_stop_jobs (dvdec);
+      gst_dvdec_release_decoder (dvdec, dvdec->decoder);
       dvdec->decoder = NULL;
       if (dvdec->pool) {
         gst_buffer_pool_set_active (dvdec->pool, FALSE);
@@ -643,6 +929,12 @@ gst_dvdec_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_DECODE_NTH:
       dvdec->drop_factor = g_value_get_int (value);
       break;
+    case PROP_REUSE_DECODER:
+      dvdec->reuse_decoder = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      dvdec->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -668,6 +960,12 @@ gst_dvdec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DECODE_NTH:
       g_value_set_int (value, dvdec->drop_factor);
       break;
+    case PROP_REUSE_DECODER:
+      g_value_set_boolean (value, dvdec->reuse_decoder);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, dvdec->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
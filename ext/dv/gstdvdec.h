@@ -27,6 +27,8 @@
 
 #include <libdv/dv.h>
 
+#include <gst/workers/gstworkbatch.h>
+
 
 G_BEGIN_DECLS
 
@@ -45,6 +47,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstDVDec GstDVDec;
 typedef struct _GstDVDecClass GstDVDecClass;
+typedef struct _GstDVDecJob GstDVDecJob;
 
 
 struct _GstDVDec {
@@ -57,6 +60,8 @@ struct _GstDVDec {
   gboolean       clamp_luma;
   gboolean       clamp_chroma;
   gint           quality;
+  gboolean       reuse_decoder;
+  guint          n_threads;
 
   gboolean       PAL;
   gboolean       interlaced;
@@ -84,6 +89,9 @@ struct _GstDVDec {
   GstBufferPool *pool;
   GstSegment     segment;
   gboolean       need_segment;
+
+  /* frames that wait to be decoded in parallel, each with its own decoder */
+  GstWorkBatch  *batch;
 };
 
 struct _GstDVDecClass {
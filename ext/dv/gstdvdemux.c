@@ -105,6 +105,9 @@
 #define NTSC_WIDE_PAR_X         40
 #define NTSC_WIDE_PAR_Y         33
 
+/* number of frames that are pulled at once in pull mode */
+#define DV_PULL_FRAMES 8
+
 GST_DEBUG_CATEGORY_STATIC (dvdemux_debug);
 #define GST_CAT_DEFAULT dvdemux_debug
 
@@ -253,10 +256,20 @@ gst_dvdemux_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_dvdemux_clear_pull_cache (GstDVDemux * dvdemux)
+{
+  if (dvdemux->pull_cache) {
+    gst_buffer_unref (dvdemux->pull_cache);
+    dvdemux->pull_cache = NULL;
+  }
+}
+
 /* reset to default values before starting streaming */
 static void
 gst_dvdemux_reset (GstDVDemux * dvdemux)
 {
+  gst_dvdemux_clear_pull_cache (dvdemux);
   dvdemux->frame_offset = 0;
   dvdemux->audio_offset = 0;
   dvdemux->video_offset = 0;
@@ -1512,6 +1525,46 @@ segment_error:
   }
 }
 
+/* pull the frame at the current position. Several frames are pulled at once
+ * and handed out as sub-buffers, which saves a pull_range round trip per
+ * frame. After a seek the cache is used again when it holds the frame */
+static GstFlowReturn
+gst_dvdemux_pull_frame (GstDVDemux * dvdemux, GstBuffer ** buffer)
+{
+  guint64 offset = dvdemux->byte_segment.position;
+  GstFlowReturn ret;
+  gsize size;
+
+  if (dvdemux->pull_cache) {
+    size = gst_buffer_get_size (dvdemux->pull_cache);
+    if (offset < dvdemux->pull_offset ||
+        offset + dvdemux->frame_len > dvdemux->pull_offset + size)
+      gst_dvdemux_clear_pull_cache (dvdemux);
+  }
+
+  if (dvdemux->pull_cache == NULL) {
+    ret = gst_pad_pull_range (dvdemux->sinkpad, offset,
+        DV_PULL_FRAMES * dvdemux->frame_len, &dvdemux->pull_cache);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
+    /* near the end there might not be a complete frame, the caller
+     * checks the size */
+    if (gst_buffer_get_size (dvdemux->pull_cache) < dvdemux->frame_len) {
+      *buffer = dvdemux->pull_cache;
+      dvdemux->pull_cache = NULL;
+      return GST_FLOW_OK;
+    }
+    dvdemux->pull_offset = offset;
+  }
+
+  *buffer = gst_buffer_copy_region (dvdemux->pull_cache,
+      GST_BUFFER_COPY_MEMORY, offset - dvdemux->pull_offset,
+      dvdemux->frame_len);
+
+  return GST_FLOW_OK;
+}
+
 /* flush any remaining data in the adapter, used in chain based scheduling mode */
 static GstFlowReturn
 gst_dvdemux_flush (GstDVDemux * dvdemux)
@@ -1711,8 +1764,7 @@ gst_dvdemux_loop (GstPad * pad)
     GST_DEBUG_OBJECT (dvdemux, "pulling buffer at offset %" G_GINT64_FORMAT,
         dvdemux->byte_segment.position);
 
-    ret = gst_pad_pull_range (dvdemux->sinkpad,
-        dvdemux->byte_segment.position, dvdemux->frame_len, &buffer);
+    ret = gst_dvdemux_pull_frame (dvdemux, &buffer);
     if (ret != GST_FLOW_OK)
       goto pause;
 
@@ -1879,6 +1931,7 @@ gst_dvdemux_change_state (GstElement * element, GstStateChange transition)
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_adapter_clear (dvdemux->adapter);
+      gst_dvdemux_clear_pull_cache (dvdemux);
       dv_decoder_free (dvdemux->decoder);
       dvdemux->decoder = NULL;
 
@@ -60,6 +60,10 @@ struct _GstDVDemux {
   GstAdapter    *adapter;
   gint           frame_len;
 
+  /* in pull mode, the frames that were pulled ahead */
+  GstBuffer     *pull_cache;
+  guint64        pull_offset;
+
   /* video params */
   gint           framerate_numerator;
   gint           framerate_denominator;
@@ -93,6 +93,21 @@ static const GstAudioChannelPosition channel_positions[8][8] = {
 GST_DEBUG_CATEGORY_STATIC (flacdec_debug);
 #define GST_CAT_DEFAULT flacdec_debug
 
+#define DEFAULT_REUSE_DECODER FALSE
+
+enum
+{
+  PROP_0,
+  PROP_REUSE_DECODER
+};
+
+/* stopped decoders that wait to be reused, shared by all the elements of
+ * the process */
+#define MAX_POOLED_DECODERS 16
+
+static GMutex decoder_pool_lock;
+static GQueue decoder_pool = G_QUEUE_INIT;
+
 static FLAC__StreamDecoderReadStatus
 gst_flac_dec_read_stream (const FLAC__StreamDecoder * decoder,
     FLAC__byte buffer[], size_t * bytes, void *client_data);
@@ -105,6 +120,11 @@ static void gst_flac_dec_metadata_cb (const FLAC__StreamDecoder *
 static void gst_flac_dec_error_cb (const FLAC__StreamDecoder *
     decoder, FLAC__StreamDecoderErrorStatus status, void *client_data);
 
+static void gst_flac_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_flac_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
 static void gst_flac_dec_flush (GstAudioDecoder * audio_dec, gboolean hard);
 static gboolean gst_flac_dec_set_format (GstAudioDecoder * dec, GstCaps * caps);
 static gboolean gst_flac_dec_start (GstAudioDecoder * dec);
@@ -149,12 +169,31 @@ gst_flac_dec_class_init (GstFlacDecClass * klass)
 {
   GstAudioDecoderClass *audiodecoder_class;
   GstElementClass *gstelement_class;
+  GObjectClass *gobject_class;
 
   audiodecoder_class = (GstAudioDecoderClass *) klass;
   gstelement_class = (GstElementClass *) klass;
+  gobject_class = (GObjectClass *) klass;
 
   GST_DEBUG_CATEGORY_INIT (flacdec_debug, "flacdec", 0, "flac decoder");
 
+  gobject_class->set_property = gst_flac_dec_set_property;
+  gobject_class->get_property = gst_flac_dec_get_property;
+
+  /**
+   * GstFlacDec:reuse-decoder:
+   *
+   * Put the libFLAC decoder in a pool of the process when the element
+   * stops, and take one from there when it starts. This saves setting up
+   * a new decoder for every stream when many short streams are decoded.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_REUSE_DECODER,
+      g_param_spec_boolean ("reuse-decoder", "Reuse decoder",
+          "Keep stopped decoders in a pool to use them for the next stream",
+          DEFAULT_REUSE_DECODER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   audiodecoder_class->stop = GST_DEBUG_FUNCPTR (gst_flac_dec_stop);
   audiodecoder_class->start = GST_DEBUG_FUNCPTR (gst_flac_dec_start);
   audiodecoder_class->flush = GST_DEBUG_FUNCPTR (gst_flac_dec_flush);
@@ -177,6 +216,79 @@ static void
 gst_flac_dec_init (GstFlacDec * flacdec)
 {
   gst_audio_decoder_set_needs_format (GST_AUDIO_DECODER (flacdec), TRUE);
+
+  flacdec->reuse_decoder = DEFAULT_REUSE_DECODER;
+}
+
+static void
+gst_flac_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstFlacDec *dec = GST_FLAC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_REUSE_DECODER:
+      dec->reuse_decoder = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_flac_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstFlacDec *dec = GST_FLAC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_REUSE_DECODER:
+      g_value_set_boolean (value, dec->reuse_decoder);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static FLAC__StreamDecoder *
+gst_flac_dec_acquire_decoder (GstFlacDec * dec)
+{
+  FLAC__StreamDecoder *decoder = NULL;
+
+  if (dec->reuse_decoder) {
+    g_mutex_lock (&decoder_pool_lock);
+    decoder = g_queue_pop_head (&decoder_pool);
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (decoder) {
+    GST_DEBUG_OBJECT (dec, "reusing decoder %p", decoder);
+    return decoder;
+  }
+
+  return FLAC__stream_decoder_new ();
+}
+
+static void
+gst_flac_dec_release_decoder (GstFlacDec * dec, FLAC__StreamDecoder * decoder)
+{
+  if (dec->reuse_decoder) {
+    /* back to the uninitialized state with the default settings, the
+     * decoder keeps its memory */
+    FLAC__stream_decoder_finish (decoder);
+
+    g_mutex_lock (&decoder_pool_lock);
+    if (decoder_pool.length < MAX_POOLED_DECODERS) {
+      g_queue_push_head (&decoder_pool, decoder);
+      decoder = NULL;
+    }
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (decoder)
+    FLAC__stream_decoder_delete (decoder);
 }
 
 static gboolean
@@ -189,7 +301,7 @@ gst_flac_dec_start (GstAudioDecoder * audio_dec)
 
   dec->adapter = gst_adapter_new ();
 
-  dec->decoder = FLAC__stream_decoder_new ();
+  dec->decoder = gst_flac_dec_acquire_decoder (dec);
 
   gst_audio_info_init (&dec->info);
   dec->depth = 0;
@@ -219,7 +331,7 @@ gst_flac_dec_stop (GstAudioDecoder * dec)
   GstFlacDec *flacdec = GST_FLAC_DEC (dec);
 
   if (flacdec->decoder) {
-    FLAC__stream_decoder_delete (flacdec->decoder);
+    gst_flac_dec_release_decoder (flacdec, flacdec->decoder);
     flacdec->decoder = NULL;
   }
 
@@ -60,6 +60,8 @@ struct _GstFlacDec {
   guint16        max_blocksize;
 
   gint           error_count;
+
+  gboolean       reuse_decoder;
 };
 
 struct _GstFlacDecClass {
@@ -139,7 +139,8 @@ enum
   PROP_MAX_RESIDUAL_PARTITION_ORDER,
   PROP_RICE_PARAMETER_SEARCH_DIST,
   PROP_PADDING,
-  PROP_SEEKPOINTS
+  PROP_SEEKPOINTS,
+  PROP_N_THREADS
 };
 
 GST_DEBUG_CATEGORY_STATIC (flacenc_debug);
@@ -165,6 +166,12 @@ static void gst_flac_enc_finalize (GObject * object);
 
 static gboolean gst_flac_enc_update_quality (GstFlacEnc * flacenc,
     gint quality);
+static gboolean gst_flac_enc_setup_jobs (GstFlacEnc * flacenc,
+    GstAudioInfo * info);
+static void gst_flac_enc_free_jobs (GstFlacEnc * flacenc);
+static gboolean gst_flac_enc_setup_pool (GstFlacEnc * flacenc,
+    GstAudioInfo * info);
+static void gst_flac_enc_release_pool (GstFlacEnc * flacenc);
 static void gst_flac_enc_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_flac_enc_get_property (GObject * object, guint prop_id,
@@ -213,6 +220,32 @@ static const GstFlacEncParams flacenc_params[] = {
 #define DEFAULT_QUALITY 5
 #define DEFAULT_PADDING 0
 #define DEFAULT_SEEKPOINTS -10
+#define DEFAULT_N_THREADS 1
+
+/* blocks of samples in the job of one thread */
+#define JOB_BLOCKS 32
+
+typedef struct
+{
+  guint offset;
+  guint size;
+  guint samples;
+} GstFlacEncFrame;
+
+/* whole blocks of samples that are encoded on one of the threads, the
+ * frames are numbered from 0 and renumbered when they are pushed */
+struct _GstFlacEncJob
+{
+  FLAC__StreamEncoder *encoder;
+  FLAC__int32 *data;            /* job_samples per channel, interleaved */
+  guint n_samples;              /* samples per channel in data */
+  GByteArray *output;
+  GArray *frames;               /* GstFlacEncFrame in output */
+  gboolean failed;
+};
+
+static guint8 crc8_table[256];
+static guint16 crc16_table[256];
 
 #define GST_TYPE_FLAC_ENC_QUALITY (gst_flac_enc_quality_get_type ())
 static GType
@@ -240,6 +273,25 @@ gst_flac_enc_quality_get_type (void)
   return qtype;
 }
 
+/* the CRC-8 of the frame header and the CRC-16 of the whole frame */
+static void
+gst_flac_enc_init_crc_tables (void)
+{
+  guint i, j;
+
+  for (i = 0; i < 256; i++) {
+    guint8 crc8 = i;
+    guint16 crc16 = i << 8;
+
+    for (j = 0; j < 8; j++) {
+      crc8 = (crc8 & 0x80) ? (crc8 << 1) ^ 0x07 : crc8 << 1;
+      crc16 = (crc16 & 0x8000) ? (crc16 << 1) ^ 0x8005 : crc16 << 1;
+    }
+    crc8_table[i] = crc8;
+    crc16_table[i] = crc16;
+  }
+}
+
 static void
 gst_flac_enc_class_init (GstFlacEncClass * klass)
 {
@@ -353,6 +405,23 @@ gst_flac_enc_class_init (GstFlacEncClass * klass)
           -G_MAXINT, G_MAXINT,
           DEFAULT_SEEKPOINTS,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFlacEnc:n-threads:
+   *
+   * The number of threads that encode blocks. With more than one thread
+   * every thread encodes a range of blocks with an encoder of its own, which
+   * adds up to n-threads ranges of latency. The STREAMINFO and SEEKTABLE
+   * headers are rewritten at the end when downstream is seekable. Changes
+   * take effect the next time the format is configured.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to encode blocks", 1, 64,
+          DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
@@ -370,6 +439,8 @@ gst_flac_enc_class_init (GstFlacEncClass * klass)
   base_class->handle_frame = GST_DEBUG_FUNCPTR (gst_flac_enc_handle_frame);
   base_class->getcaps = GST_DEBUG_FUNCPTR (gst_flac_enc_getcaps);
   base_class->sink_event = GST_DEBUG_FUNCPTR (gst_flac_enc_sink_event);
+
+  gst_flac_enc_init_crc_tables ();
 }
 
 static void
@@ -408,6 +479,8 @@ gst_flac_enc_start (GstAudioEncoder * enc)
   flacenc->eos = FALSE;
   flacenc->tags = gst_tag_list_new_empty ();
   flacenc->toc = NULL;
+  flacenc->streaminfo_offset = 0;
+  flacenc->seektable_offset = 0;
 
   return TRUE;
 }
@@ -443,10 +516,14 @@ gst_flac_enc_stop (GstAudioEncoder * enc)
     g_free (flacenc->meta);
     flacenc->meta = NULL;
   }
+  flacenc->seektable = NULL;
   g_list_foreach (flacenc->headers, (GFunc) gst_mini_object_unref, NULL);
   g_list_free (flacenc->headers);
   flacenc->headers = NULL;
 
+  gst_flac_enc_free_jobs (flacenc);
+  gst_flac_enc_release_pool (flacenc);
+
   gst_tag_setter_reset_tags (GST_TAG_SETTER (enc));
   gst_toc_setter_reset (GST_TOC_SETTER (enc));
 
@@ -695,6 +772,7 @@ gst_flac_enc_set_metadata (GstFlacEnc * flacenc, GstAudioInfo * info,
       FLAC__metadata_object_delete (flacenc->meta[1]);
       flacenc->meta[entries] = NULL;
     } else {
+      flacenc->seektable = flacenc->meta[entries];
       entries++;
     }
   } else if (flacenc->seekpoints && total_samples == GST_CLOCK_TIME_NONE) {
@@ -847,6 +925,9 @@ gst_flac_enc_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
 
   gst_flac_enc_set_metadata (flacenc, info, total_samples);
 
+  if (!gst_flac_enc_setup_pool (flacenc, info))
+    goto failed_to_setup_pool;
+
   /* callbacks clear to go now;
    * write callbacks receives headers during init */
   flacenc->stopped = FALSE;
@@ -857,6 +938,9 @@ gst_flac_enc_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
   if (init_status != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
     goto failed_to_initialize;
 
+  if (flacenc->n_threads > 1 && !gst_flac_enc_setup_jobs (flacenc, info))
+    goto failed_to_setup_jobs;
+
   /* no special feedback to base class; should provide all available samples */
 
   return TRUE;
@@ -872,6 +956,18 @@ failed_to_initialize:
         ("could not initialize encoder (wrong parameters?) %d", init_status));
     return FALSE;
   }
+failed_to_setup_pool:
+  {
+    GST_ELEMENT_ERROR (flacenc, RESOURCE, FAILED, (NULL),
+        ("could not set up a pool of output buffers"));
+    return FALSE;
+  }
+failed_to_setup_jobs:
+  {
+    GST_ELEMENT_ERROR (flacenc, LIBRARY, INIT, (NULL),
+        ("could not create the encoders of the threads"));
+    return FALSE;
+  }
 }
 
 static gboolean
@@ -1003,6 +1099,7 @@ notgst_value_array_append_buffer (GValue * array_val, GstBuffer * buf)
 }
 
 #define HDR_TYPE_STREAMINFO     0
+#define HDR_TYPE_SEEKTABLE      3
 #define HDR_TYPE_VORBISCOMMENT  4
 
 static GstFlowReturn
@@ -1116,6 +1213,93 @@ push_headers:
   return ret;
 }
 
+static void
+gst_flac_enc_release_pool (GstFlacEnc * flacenc)
+{
+  if (flacenc->pool) {
+    gst_buffer_pool_set_active (flacenc->pool, FALSE);
+    gst_object_unref (flacenc->pool);
+    flacenc->pool = NULL;
+  }
+}
+
+/* make a pool of buffers that hold any frame. A frame is never bigger than
+ * a frame with verbatim subframes: the header, a subframe header and the
+ * samples of each channel, with one more bit for a side channel, and the
+ * CRC */
+static gboolean
+gst_flac_enc_setup_pool (GstFlacEnc * flacenc, GstAudioInfo * info)
+{
+  static GstAllocationParams params = { 0, 3, 0, 0, };
+  GstBufferPool *pool;
+  GstStructure *config;
+  guint blocksize, size;
+
+  blocksize = FLAC__stream_encoder_get_blocksize (flacenc->encoder);
+  size = 16 + GST_AUDIO_INFO_CHANNELS (info) *
+      (2 + (blocksize * (GST_AUDIO_INFO_DEPTH (info) + 1) + 7) / 8) + 2;
+
+  GST_DEBUG_OBJECT (flacenc, "output buffers of %u bytes", size);
+
+  pool = gst_buffer_pool_new ();
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+  if (!gst_buffer_pool_set_config (pool, config))
+    goto config_failed;
+
+  gst_flac_enc_release_pool (flacenc);
+  flacenc->pool = pool;
+  flacenc->pool_size = size;
+
+  /* and activate */
+  if (!gst_buffer_pool_set_active (pool, TRUE))
+    goto activate_failed;
+
+  return TRUE;
+
+  /* ERRORS */
+config_failed:
+  {
+    GST_WARNING_OBJECT (flacenc, "failed to configure buffer pool");
+    gst_object_unref (pool);
+    return FALSE;
+  }
+activate_failed:
+  {
+    GST_WARNING_OBJECT (flacenc, "failed to activate buffer pool");
+    gst_flac_enc_release_pool (flacenc);
+    return FALSE;
+  }
+}
+
+/* get a buffer for a frame of at most @size bytes, trim it to the size of
+ * the frame when it is filled */
+static GstFlowReturn
+gst_flac_enc_acquire_output (GstFlacEnc * flacenc, gsize size,
+    GstBuffer ** outbuf)
+{
+  GstFlowReturn ret;
+
+  if (G_UNLIKELY (flacenc->pool == NULL || size > flacenc->pool_size)) {
+    /* should not happen, but don't fail on it */
+    GST_WARNING_OBJECT (flacenc, "no pooled buffer of %" G_GSIZE_FORMAT
+        " bytes", size);
+    *outbuf = gst_buffer_new_and_alloc (size);
+    return GST_FLOW_OK;
+  }
+
+  ret = gst_buffer_pool_acquire_buffer (flacenc->pool, outbuf, NULL);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    return ret;
+
+  /* the buffers come back trimmed to the size of their frame */
+  gst_buffer_set_size (*outbuf, flacenc->pool_size);
+
+  return GST_FLOW_OK;
+}
+
 static FLAC__StreamEncoderWriteStatus
 gst_flac_enc_write_callback (const FLAC__StreamEncoder * encoder,
     const FLAC__byte buffer[], size_t bytes,
@@ -1130,14 +1314,35 @@ gst_flac_enc_write_callback (const FLAC__StreamEncoder * encoder,
   if (flacenc->stopped)
     return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
 
-  outbuf = gst_buffer_new_and_alloc (bytes);
-  gst_buffer_fill (outbuf, 0, buffer, bytes);
+  if (samples > 0) {
+    /* libFLAC writes a whole frame at once, copy it into a pooled buffer */
+    ret = gst_flac_enc_acquire_output (flacenc, bytes, &outbuf);
+    if (ret != GST_FLOW_OK) {
+      flacenc->last_flow = ret;
+      return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+    }
+    gst_buffer_fill (outbuf, 0, buffer, bytes);
+    gst_buffer_set_size (outbuf, bytes);
+  } else {
+    outbuf = gst_buffer_new_and_alloc (bytes);
+    gst_buffer_fill (outbuf, 0, buffer, bytes);
+  }
 
   /* we assume libflac passes us stuff neatly framed */
   if (!flacenc->got_headers) {
     if (samples == 0) {
       GST_DEBUG_OBJECT (flacenc, "Got header, queueing (%u bytes)",
           (guint) bytes);
+      /* remember where the headers go that are rewritten when encoding
+       * with threads */
+      if (bytes == 4 + FLAC__STREAM_METADATA_STREAMINFO_LENGTH &&
+          (buffer[0] & 0x7f) == HDR_TYPE_STREAMINFO) {
+        flacenc->streaminfo_offset = flacenc->offset + 4;
+        memcpy (flacenc->streaminfo, buffer + 4,
+            FLAC__STREAM_METADATA_STREAMINFO_LENGTH);
+      } else if (bytes > 4 && (buffer[0] & 0x7f) == HDR_TYPE_SEEKTABLE) {
+        flacenc->seektable_offset = flacenc->offset + 4;
+      }
       flacenc->headers = g_list_append (flacenc->headers, outbuf);
       /* note: it's important that we increase our byte offset */
       goto out;
@@ -1243,19 +1448,575 @@ gst_flac_enc_sink_event (GstAudioEncoder * enc, GstEvent * event)
 #define READ_INT24 GST_READ_UINT24_BE
 #endif
 
+/* convert @samples samples per channel to the FLAC__int32 libFLAC takes, in
+ * the FLAC channel order */
+static void
+gst_flac_enc_convert_samples (GstFlacEnc * flacenc, FLAC__int32 * data,
+    const guint8 * in, guint samples)
+{
+  GstAudioInfo *info =
+      gst_audio_encoder_get_audio_info (GST_AUDIO_ENCODER (flacenc));
+  gint width, channels;
+  gint *reorder_map;
+  gulong i;
+  gint j;
+
+  width = GST_AUDIO_INFO_WIDTH (info);
+  channels = GST_AUDIO_INFO_CHANNELS (info);
+  reorder_map = flacenc->channel_reorder_map;
+
+  if (width == 8) {
+    const gint8 *indata = (const gint8 *) in;
+
+    for (i = 0; i < samples; i++)
+      for (j = 0; j < channels; j++)
+        data[i * channels + reorder_map[j]] =
+            (FLAC__int32) indata[i * channels + j];
+  } else if (width == 16) {
+    const gint16 *indata = (const gint16 *) in;
+
+    for (i = 0; i < samples; i++)
+      for (j = 0; j < channels; j++)
+        data[i * channels + reorder_map[j]] =
+            (FLAC__int32) indata[i * channels + j];
+  } else if (width == 24) {
+    const guint8 *indata = in;
+    guint32 val;
+
+    for (i = 0; i < samples; i++)
+      for (j = 0; j < channels; j++) {
+        val = READ_INT24 (&indata[3 * (i * channels + j)]);
+        if (val & 0x00800000)
+          val |= 0xff000000;
+        data[i * channels + reorder_map[j]] = (FLAC__int32) val;
+      }
+  } else if (width == 32) {
+    const gint32 *indata = (const gint32 *) in;
+
+    for (i = 0; i < samples; i++)
+      for (j = 0; j < channels; j++)
+        data[i * channels + reorder_map[j]] =
+            (FLAC__int32) indata[i * channels + j];
+  } else {
+    g_assert_not_reached ();
+  }
+}
+
+/* give @dest the settings of the main encoder */
+static void
+gst_flac_enc_copy_settings (FLAC__StreamEncoder * dest,
+    const FLAC__StreamEncoder * src)
+{
+#define COPY_SETTING(name)                                                      \
+  FLAC__stream_encoder_set_##name (dest, FLAC__stream_encoder_get_##name (src))
+
+  COPY_SETTING (channels);
+  COPY_SETTING (bits_per_sample);
+  COPY_SETTING (sample_rate);
+  COPY_SETTING (blocksize);
+  COPY_SETTING (streamable_subset);
+  COPY_SETTING (do_mid_side_stereo);
+  COPY_SETTING (loose_mid_side_stereo);
+  COPY_SETTING (max_lpc_order);
+  COPY_SETTING (qlp_coeff_precision);
+  COPY_SETTING (do_qlp_coeff_prec_search);
+  COPY_SETTING (do_escape_coding);
+  COPY_SETTING (do_exhaustive_model_search);
+  COPY_SETTING (min_residual_partition_order);
+  COPY_SETTING (max_residual_partition_order);
+  COPY_SETTING (rice_parameter_search_dist);
+
+#undef COPY_SETTING
+
+  /* the MD5 of the whole stream is computed while the jobs are pushed */
+  FLAC__stream_encoder_set_do_md5 (dest, false);
+}
+
+static gboolean
+gst_flac_enc_setup_jobs (GstFlacEnc * flacenc, GstAudioInfo * info)
+{
+  GstClockTime latency;
+  guint i, channels;
+
+  flacenc->workers = gst_workers_new (flacenc->n_threads);
+  flacenc->n_jobs = gst_workers_get_n_threads (flacenc->workers);
+  if (flacenc->n_jobs < 2) {
+    /* no threads, encode with the main encoder */
+    gst_flac_enc_free_jobs (flacenc);
+    return TRUE;
+  }
+
+  channels = GST_AUDIO_INFO_CHANNELS (info);
+  flacenc->job_samples =
+      FLAC__stream_encoder_get_blocksize (flacenc->encoder) * JOB_BLOCKS;
+
+  flacenc->jobs = g_new0 (GstFlacEncJob, flacenc->n_jobs);
+  for (i = 0; i < flacenc->n_jobs; i++) {
+    GstFlacEncJob *job = &flacenc->jobs[i];
+
+    job->encoder = FLAC__stream_encoder_new ();
+    if (job->encoder == NULL)
+      goto no_encoder;
+    gst_flac_enc_copy_settings (job->encoder, flacenc->encoder);
+
+    job->data = g_new (FLAC__int32, flacenc->job_samples * channels);
+    job->output = g_byte_array_new ();
+    job->frames = g_array_new (FALSE, FALSE, sizeof (GstFlacEncFrame));
+  }
+  flacenc->cur_job = 0;
+
+  flacenc->md5 = g_checksum_new (G_CHECKSUM_MD5);
+  flacenc->md5_data = g_malloc (flacenc->job_samples * channels * 4);
+  flacenc->n_frames = 0;
+  flacenc->n_samples = 0;
+  flacenc->min_framesize = G_MAXUINT;
+  flacenc->max_framesize = 0;
+  flacenc->next_seekpoint = 0;
+
+  GST_DEBUG_OBJECT (flacenc, "encoding with %u threads, %u samples each",
+      flacenc->n_jobs, flacenc->job_samples);
+
+  /* the samples of all jobs are collected before any frame comes out */
+  latency = gst_util_uint64_scale_int (flacenc->job_samples * flacenc->n_jobs,
+      GST_SECOND, GST_AUDIO_INFO_RATE (info));
+  gst_audio_encoder_set_latency (GST_AUDIO_ENCODER (flacenc), latency,
+      latency);
+
+  return TRUE;
+
+  /* ERRORS */
+no_encoder:
+  {
+    gst_flac_enc_free_jobs (flacenc);
+    return FALSE;
+  }
+}
+
+static void
+gst_flac_enc_free_jobs (GstFlacEnc * flacenc)
+{
+  guint i;
+
+  if (flacenc->jobs) {
+    for (i = 0; i < flacenc->n_jobs; i++) {
+      GstFlacEncJob *job = &flacenc->jobs[i];
+
+      if (job->encoder == NULL)
+        break;
+      FLAC__stream_encoder_delete (job->encoder);
+      g_free (job->data);
+      g_byte_array_unref (job->output);
+      g_array_free (job->frames, TRUE);
+    }
+    g_free (flacenc->jobs);
+    flacenc->jobs = NULL;
+  }
+  flacenc->n_jobs = 0;
+  flacenc->cur_job = 0;
+
+  if (flacenc->workers) {
+    gst_workers_free (flacenc->workers);
+    flacenc->workers = NULL;
+  }
+  if (flacenc->md5) {
+    g_checksum_free (flacenc->md5);
+    flacenc->md5 = NULL;
+  }
+  g_free (flacenc->md5_data);
+  flacenc->md5_data = NULL;
+}
+
+static FLAC__StreamEncoderWriteStatus
+gst_flac_enc_job_write_callback (const FLAC__StreamEncoder * encoder,
+    const FLAC__byte buffer[], size_t bytes,
+    unsigned samples, unsigned current_frame, void *client_data)
+{
+  GstFlacEncJob *job = client_data;
+  GstFlacEncFrame frame;
+
+  /* the headers come from the main encoder */
+  if (samples == 0)
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+
+  /* libFLAC writes a frame in one go */
+  frame.offset = job->output->len;
+  frame.size = bytes;
+  frame.samples = samples;
+  g_array_append_val (job->frames, frame);
+  g_byte_array_append (job->output, buffer, bytes);
+
+  return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+/* runs on one of the threads, each job is a stream of its own */
+static void
+gst_flac_enc_encode_job (gpointer data, guint slice, guint n_slices)
+{
+  GstFlacEnc *flacenc = data;
+  GstFlacEncJob *job = &flacenc->jobs[slice];
+
+  if (job->n_samples == 0)
+    return;
+
+  g_byte_array_set_size (job->output, 0);
+  g_array_set_size (job->frames, 0);
+
+  if (FLAC__stream_encoder_init_stream (job->encoder,
+          gst_flac_enc_job_write_callback, NULL, NULL, NULL, job) !=
+      FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+    job->failed = TRUE;
+    return;
+  }
+
+  job->failed = !FLAC__stream_encoder_process_interleaved (job->encoder,
+      job->data, job->n_samples);
+  /* only the last job of the stream ends with a short block, which is
+   * encoded here */
+  FLAC__stream_encoder_finish (job->encoder);
+}
+
+static guint
+gst_flac_enc_utf8_length (guint8 first)
+{
+  guint n = 0;
+
+  while (n < 8 && (first & (0x80 >> n)))
+    n++;
+
+  if (n == 0)
+    return 1;
+  if (n == 1 || n == 8)
+    return 0;
+  return n;
+}
+
+static guint
+gst_flac_enc_write_utf8 (guint8 * data, guint64 val)
+{
+  guint i, n;
+
+  if (val < 0x80) {
+    data[0] = val;
+    return 1;
+  }
+
+  /* n bytes carry 5 * n + 1 bits */
+  for (n = 2; n < 7 && val >= (G_GUINT64_CONSTANT (1) << (5 * n + 1)); n++);
+
+  for (i = n - 1; i > 0; i--) {
+    data[i] = 0x80 | (val & 0x3f);
+    val >>= 6;
+  }
+  data[0] = ((0xff00 >> n) & 0xff) | val;
+
+  return n;
+}
+
+/* copy the frame in @data to @out, which has room for @size + 6 bytes,
+ * with frame number @number. The number is UTF-8 coded in the header, so the
+ * header can change size and both the header and the frame CRC are computed
+ * again. Returns the size of the new frame or 0 when @data is no frame */
+static guint
+gst_flac_enc_renumber_frame (const guint8 * data, guint size, guint64 number,
+    guint8 * out)
+{
+  guint num_len, extra, hdr_len, new_len, i;
+  guint8 crc8;
+  guint16 crc16;
+
+  if (size < 6 || data[0] != 0xff || (data[1] & 0xfe) != 0xf8)
+    return 0;
+
+  num_len = gst_flac_enc_utf8_length (data[4]);
+  if (num_len == 0)
+    return 0;
+
+  /* blocksize and sample rate that don't fit in the codes follow */
+  extra = 0;
+  if ((data[2] >> 4) == 6)
+    extra += 1;
+  else if ((data[2] >> 4) == 7)
+    extra += 2;
+  if ((data[2] & 0x0f) == 12)
+    extra += 1;
+  else if ((data[2] & 0x0f) == 13 || (data[2] & 0x0f) == 14)
+    extra += 2;
+
+  hdr_len = 4 + num_len + extra;
+  if (size < hdr_len + 1 + 2)
+    return 0;
+
+  memcpy (out, data, 4);
+  new_len = 4 + gst_flac_enc_write_utf8 (out + 4, number);
+  memcpy (out + new_len, data + 4 + num_len, extra);
+  new_len += extra;
+
+  crc8 = 0;
+  for (i = 0; i < new_len; i++)
+    crc8 = crc8_table[crc8 ^ out[i]];
+  out[new_len++] = crc8;
+
+  /* the subframes, without the old header and the old CRC-16 */
+  memcpy (out + new_len, data + hdr_len + 1, size - hdr_len - 1 - 2);
+  new_len += size - hdr_len - 1 - 2;
+
+  crc16 = 0;
+  for (i = 0; i < new_len; i++)
+    crc16 = (crc16 << 8) ^ crc16_table[(crc16 >> 8) ^ out[i]];
+  GST_WRITE_UINT16_BE (out + new_len, crc16);
+  new_len += 2;
+
+  return new_len;
+}
+
+/* the MD5 of STREAMINFO is over the samples in little endian with as many
+ * bytes as the depth needs */
+static void
+gst_flac_enc_update_md5 (GstFlacEnc * flacenc, GstFlacEncJob * job)
+{
+  GstAudioInfo *info =
+      gst_audio_encoder_get_audio_info (GST_AUDIO_ENCODER (flacenc));
+  guint i, n, bytes;
+  guint8 *out = flacenc->md5_data;
+
+  n = job->n_samples * GST_AUDIO_INFO_CHANNELS (info);
+  bytes = (GST_AUDIO_INFO_DEPTH (info) + 7) / 8;
+
+  switch (bytes) {
+    case 1:
+      for (i = 0; i < n; i++)
+        out[i] = job->data[i];
+      break;
+    case 2:
+      for (i = 0; i < n; i++)
+        GST_WRITE_UINT16_LE (out + 2 * i, job->data[i]);
+      break;
+    case 3:
+      for (i = 0; i < n; i++)
+        GST_WRITE_UINT24_LE (out + 3 * i, job->data[i]);
+      break;
+    default:
+      for (i = 0; i < n; i++)
+        GST_WRITE_UINT32_LE (out + 4 * i, job->data[i]);
+      break;
+  }
+
+  g_checksum_update (flacenc->md5, out, n * bytes);
+}
+
+/* fill in what the main encoder fills in when it is done with a frame */
+static void
+gst_flac_enc_update_seektable (GstFlacEnc * flacenc, guint samples)
+{
+  FLAC__StreamMetadata_SeekTable *table;
+  guint64 first, last;
+
+  table = &flacenc->seektable->data.seek_table;
+  first = flacenc->n_samples;
+  last = first + samples - 1;
+
+  while (flacenc->next_seekpoint < table->num_points) {
+    FLAC__StreamMetadata_SeekPoint *point =
+        &table->points[flacenc->next_seekpoint];
+
+    /* placeholders have the highest sample number and stop us too */
+    if (point->sample_number > last)
+      break;
+
+    if (point->sample_number >= first) {
+      point->sample_number = first;
+      point->stream_offset = flacenc->offset - flacenc->first_frame_offset;
+      point->frame_samples = samples;
+    }
+    flacenc->next_seekpoint++;
+  }
+}
+
+static GstFlowReturn
+gst_flac_enc_push_job (GstFlacEnc * flacenc, GstFlacEncJob * job)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  if (job->failed)
+    goto encode_failed;
+
+  gst_flac_enc_update_md5 (flacenc, job);
+
+  for (i = 0; i < job->frames->len; i++) {
+    GstFlacEncFrame *frame = &g_array_index (job->frames, GstFlacEncFrame, i);
+    const guint8 *data = job->output->data + frame->offset;
+    GstBuffer *outbuf;
+    GstMapInfo map;
+    gsize size;
+
+    /* the frame number can take up to 6 more bytes */
+    ret = gst_flac_enc_acquire_output (flacenc, frame->size + 6, &outbuf);
+    if (ret != GST_FLOW_OK)
+      break;
+
+    gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+    if (flacenc->n_frames == i) {
+      /* the first job of the stream has the right numbers already */
+      memcpy (map.data, data, frame->size);
+      size = frame->size;
+    } else {
+      size = gst_flac_enc_renumber_frame (data, frame->size,
+          flacenc->n_frames, map.data);
+    }
+    gst_buffer_unmap (outbuf, &map);
+
+    if (size == 0) {
+      gst_buffer_unref (outbuf);
+      goto invalid_frame;
+    }
+    gst_buffer_set_size (outbuf, size);
+
+    if (!flacenc->got_headers) {
+      GST_INFO_OBJECT (flacenc, "Non-header packet, we have all headers now");
+      ret = gst_flac_enc_process_stream_headers (flacenc);
+      flacenc->got_headers = TRUE;
+      flacenc->first_frame_offset = flacenc->offset;
+    }
+
+    if (flacenc->seektable)
+      gst_flac_enc_update_seektable (flacenc, frame->samples);
+
+    flacenc->min_framesize = MIN (flacenc->min_framesize, size);
+    flacenc->max_framesize = MAX (flacenc->max_framesize, size);
+    flacenc->n_samples += frame->samples;
+    flacenc->n_frames++;
+
+    GST_LOG ("Pushing buffer: samples=%u, size=%u, pos=%" G_GUINT64_FORMAT,
+        frame->samples, (guint) size, flacenc->offset);
+    ret = gst_audio_encoder_finish_frame (GST_AUDIO_ENCODER (flacenc),
+        outbuf, frame->samples);
+    flacenc->offset += size;
+    flacenc->last_flow = ret;
+
+    if (ret != GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (flacenc, "flow: %s", gst_flow_get_name (ret));
+      break;
+    }
+  }
+
+  return ret;
+
+  /* ERRORS */
+encode_failed:
+  {
+    GST_ELEMENT_ERROR (flacenc, STREAM, ENCODE, (NULL),
+        ("failed to encode samples"));
+    flacenc->last_flow = GST_FLOW_ERROR;
+    return GST_FLOW_ERROR;
+  }
+invalid_frame:
+  {
+    GST_ELEMENT_ERROR (flacenc, STREAM, ENCODE, (NULL),
+        ("encoder produced an invalid frame"));
+    flacenc->last_flow = GST_FLOW_ERROR;
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* encode the collected jobs and push their frames in order */
+static GstFlowReturn
+gst_flac_enc_encode_jobs (GstFlacEnc * flacenc)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  gst_workers_run (flacenc->workers, gst_flac_enc_encode_job, flacenc);
+
+  /* the frames after a failed job can't be numbered */
+  for (i = 0; i < flacenc->n_jobs; i++) {
+    GstFlacEncJob *job = &flacenc->jobs[i];
+
+    if (job->n_samples == 0)
+      continue;
+    if (ret == GST_FLOW_OK)
+      ret = gst_flac_enc_push_job (flacenc, job);
+    job->n_samples = 0;
+  }
+  flacenc->cur_job = 0;
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_flac_enc_push_header_fixup (GstFlacEnc * flacenc, guint64 offset,
+    const guint8 * data, gsize size)
+{
+  GstBuffer *outbuf;
+  GstFlowReturn ret;
+
+  if (gst_flac_enc_seek_callback (flacenc->encoder, offset, flacenc) !=
+      FLAC__STREAM_ENCODER_SEEK_STATUS_OK)
+    return GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (flacenc, "Fixing up headers at pos=%" G_GUINT64_FORMAT
+      ", size=%u", flacenc->offset, (guint) size);
+
+  outbuf = gst_buffer_new_and_alloc (size);
+  gst_buffer_fill (outbuf, 0, data, size);
+  ret = gst_pad_push (GST_AUDIO_ENCODER_SRC_PAD (flacenc), outbuf);
+  flacenc->offset += size;
+
+  return ret;
+}
+
+/* what the main encoder does in FLAC__stream_encoder_finish() */
+static void
+gst_flac_enc_rewrite_headers (GstFlacEnc * flacenc)
+{
+  guint8 *si = flacenc->streaminfo;
+  gsize len = 16;
+
+  if (!flacenc->got_headers || flacenc->streaminfo_offset == 0)
+    return;
+
+  GST_WRITE_UINT24_BE (si + 4, flacenc->min_framesize);
+  GST_WRITE_UINT24_BE (si + 7, flacenc->max_framesize);
+  /* 36 bits of total samples after the sample size */
+  si[13] = (si[13] & 0xf0) | ((flacenc->n_samples >> 32) & 0x0f);
+  GST_WRITE_UINT32_BE (si + 14, flacenc->n_samples & 0xffffffff);
+  g_checksum_get_digest (flacenc->md5, si + 18, &len);
+
+  if (gst_flac_enc_push_header_fixup (flacenc, flacenc->streaminfo_offset,
+          si, FLAC__STREAM_METADATA_STREAMINFO_LENGTH) != GST_FLOW_OK)
+    return;
+
+  if (flacenc->seektable && flacenc->seektable_offset) {
+    FLAC__StreamMetadata_SeekTable *table =
+        &flacenc->seektable->data.seek_table;
+    guint8 *points, *p;
+    guint i;
+
+    FLAC__format_seektable_sort (table);
+
+    p = points = g_malloc (table->num_points * 18);
+    for (i = 0; i < table->num_points; i++) {
+      GST_WRITE_UINT64_BE (p, table->points[i].sample_number);
+      GST_WRITE_UINT64_BE (p + 8, table->points[i].stream_offset);
+      GST_WRITE_UINT16_BE (p + 16, table->points[i].frame_samples);
+      p += 18;
+    }
+    gst_flac_enc_push_header_fixup (flacenc, flacenc->seektable_offset,
+        points, table->num_points * 18);
+    g_free (points);
+  }
+}
+
 static GstFlowReturn
 gst_flac_enc_handle_frame (GstAudioEncoder * enc, GstBuffer * buffer)
 {
   GstFlacEnc *flacenc;
   FLAC__int32 *data;
   gint samples, width, channels;
-  gulong i;
-  gint j;
   FLAC__bool res;
   GstMapInfo map;
   GstAudioInfo *info =
       gst_audio_encoder_get_audio_info (GST_AUDIO_ENCODER (enc));
-  gint *reorder_map;
 
   flacenc = GST_FLAC_ENC (enc);
 
@@ -1265,11 +2026,16 @@ gst_flac_enc_handle_frame (GstAudioEncoder * enc, GstBuffer * buffer)
 
   width = GST_AUDIO_INFO_WIDTH (info);
   channels = GST_AUDIO_INFO_CHANNELS (info);
-  reorder_map = flacenc->channel_reorder_map;
 
   if (G_UNLIKELY (!buffer)) {
     if (flacenc->eos) {
       GST_DEBUG_OBJECT (flacenc, "finish encoding");
+      if (flacenc->jobs) {
+        if (gst_flac_enc_encode_jobs (flacenc) == GST_FLOW_OK)
+          gst_flac_enc_rewrite_headers (flacenc);
+        /* the main encoder saw none of the samples, ignore its rewrite */
+        flacenc->stopped = TRUE;
+      }
       FLAC__stream_encoder_finish (flacenc->encoder);
     } else {
       /* can't handle intermittent draining/resyncing */
@@ -1283,47 +2049,39 @@ gst_flac_enc_handle_frame (GstAudioEncoder * enc, GstBuffer * buffer)
 
   gst_buffer_map (buffer, &map, GST_MAP_READ);
   samples = map.size / (width >> 3);
-
-  data = g_malloc (samples * sizeof (FLAC__int32));
-
   samples /= channels;
   GST_LOG_OBJECT (flacenc, "processing %d samples, %d channels", samples,
       channels);
-  if (width == 8) {
-    gint8 *indata = (gint8 *) map.data;
-
-    for (i = 0; i < samples; i++)
-      for (j = 0; j < channels; j++)
-        data[i * channels + reorder_map[j]] =
-            (FLAC__int32) indata[i * channels + j];
-  } else if (width == 16) {
-    gint16 *indata = (gint16 *) map.data;
-
-    for (i = 0; i < samples; i++)
-      for (j = 0; j < channels; j++)
-        data[i * channels + reorder_map[j]] =
-            (FLAC__int32) indata[i * channels + j];
-  } else if (width == 24) {
-    guint8 *indata = (guint8 *) map.data;
-    guint32 val;
 
-    for (i = 0; i < samples; i++)
-      for (j = 0; j < channels; j++) {
-        val = READ_INT24 (&indata[3 * (i * channels + j)]);
-        if (val & 0x00800000)
-          val |= 0xff000000;
-        data[i * channels + reorder_map[j]] = (FLAC__int32) val;
+  if (flacenc->jobs) {
+    GstFlowReturn ret = GST_FLOW_OK;
+    gint done = 0;
+
+    /* fill the jobs, they are encoded when all of them are full */
+    while (done < samples) {
+      GstFlacEncJob *job = &flacenc->jobs[flacenc->cur_job];
+      guint n = MIN (samples - done, flacenc->job_samples - job->n_samples);
+
+      gst_flac_enc_convert_samples (flacenc,
+          job->data + job->n_samples * channels,
+          map.data + done * channels * (width >> 3), n);
+      job->n_samples += n;
+      done += n;
+
+      if (job->n_samples == flacenc->job_samples &&
+          ++flacenc->cur_job == flacenc->n_jobs) {
+        ret = gst_flac_enc_encode_jobs (flacenc);
+        if (ret != GST_FLOW_OK)
+          break;
       }
-  } else if (width == 32) {
-    gint32 *indata = (gint32 *) map.data;
+    }
+    gst_buffer_unmap (buffer, &map);
 
-    for (i = 0; i < samples; i++)
-      for (j = 0; j < channels; j++)
-        data[i * channels + reorder_map[j]] =
-            (FLAC__int32) indata[i * channels + j];
-  } else {
-    g_assert_not_reached ();
+    return ret;
   }
+
+  data = g_malloc (samples * channels * sizeof (FLAC__int32));
+  gst_flac_enc_convert_samples (flacenc, data, map.data, samples);
   gst_buffer_unmap (buffer, &map);
 
   res = FLAC__stream_encoder_process_interleaved (flacenc->encoder,
@@ -1407,6 +2165,9 @@ gst_flac_enc_set_property (GObject * object, guint prop_id,
     case PROP_SEEKPOINTS:
       this->seekpoints = g_value_get_int (value);
       break;
+    case PROP_N_THREADS:
+      this->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1483,6 +2244,9 @@ gst_flac_enc_get_property (GObject * object, guint prop_id,
     case PROP_SEEKPOINTS:
       g_value_set_int (value, this->seekpoints);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, this->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
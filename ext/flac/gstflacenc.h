@@ -26,6 +26,8 @@
 
 #include <FLAC/all.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_FLAC_ENC (gst_flac_enc_get_type())
@@ -36,6 +38,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFlacEnc GstFlacEnc;
 typedef struct _GstFlacEncClass GstFlacEncClass;
+typedef struct _GstFlacEncJob GstFlacEncJob;
 
 struct _GstFlacEnc {
   GstAudioEncoder  element;
@@ -54,6 +57,10 @@ struct _GstFlacEnc {
 
   FLAC__StreamEncoder *encoder;
 
+  /* buffers for the encoded frames */
+  GstBufferPool   *pool;
+  guint            pool_size;
+
   FLAC__StreamMetadata **meta;
 
   GstTagList *     tags;
@@ -65,6 +72,31 @@ struct _GstFlacEnc {
   GList           *headers;
 
   gint             channel_reorder_map[8];
+
+  /* parallel encoding: with more than one thread the samples are collected
+   * in jobs that are encoded by encoders of their own, the frames of the
+   * jobs are renumbered and pushed in order */
+  guint            n_threads;
+  GstWorkers      *workers;
+  GstFlacEncJob   *jobs;
+  guint            n_jobs;
+  guint            cur_job;       /* the job being filled */
+  guint            job_samples;   /* samples per channel of a full job */
+
+  /* what the main encoder would have collected for the STREAMINFO and
+   * SEEKTABLE rewrite at the end */
+  guint64          n_frames;
+  guint64          n_samples;
+  guint            min_framesize;
+  guint            max_framesize;
+  GChecksum       *md5;
+  guint8          *md5_data;
+  guint64          first_frame_offset;
+  guint64          streaminfo_offset;
+  guint8           streaminfo[FLAC__STREAM_METADATA_STREAMINFO_LENGTH];
+  guint64          seektable_offset;
+  FLAC__StreamMetadata *seektable;
+  guint            next_seekpoint;
 };
 
 struct _GstFlacEncClass {
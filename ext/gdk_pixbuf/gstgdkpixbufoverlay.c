@@ -32,6 +32,9 @@
  *
  * Negative offsets are also not yet supported.
  *
+ * If downstream supports the #GstVideoOverlayCompositionMeta, the overlay is
+ * attached to the buffers as meta instead of being blended onto the video.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -62,6 +65,8 @@ static void gst_gdk_pixbuf_overlay_finalize (GObject * object);
 
 static gboolean gst_gdk_pixbuf_overlay_start (GstBaseTransform * trans);
 static gboolean gst_gdk_pixbuf_overlay_stop (GstBaseTransform * trans);
+static GstFlowReturn gst_gdk_pixbuf_overlay_transform_ip (GstBaseTransform *
+    trans, GstBuffer * buf);
 static GstFlowReturn
 gst_gdk_pixbuf_overlay_transform_frame_ip (GstVideoFilter * filter,
     GstVideoFrame * frame);
@@ -126,6 +131,8 @@ gst_gdk_pixbuf_overlay_class_init (GstGdkPixbufOverlayClass * klass)
 
   basetrans_class->before_transform =
       GST_DEBUG_FUNCPTR (gst_gdk_pixbuf_overlay_before_transform);
+  basetrans_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_gdk_pixbuf_overlay_transform_ip);
 
   videofilter_class->set_info =
       GST_DEBUG_FUNCPTR (gst_gdk_pixbuf_overlay_set_info);
@@ -404,6 +411,8 @@ gst_gdk_pixbuf_overlay_start (GstBaseTransform * trans)
     gst_base_transform_set_passthrough (trans, TRUE);
   }
 
+  overlay->check_meta = TRUE;
+
   return TRUE;
 
 /* ERRORS */
@@ -435,10 +444,63 @@ static gboolean
 gst_gdk_pixbuf_overlay_set_info (GstVideoFilter * filter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
+  GstGdkPixbufOverlay *overlay = GST_GDK_PIXBUF_OVERLAY (filter);
+
   GST_INFO_OBJECT (filter, "caps: %" GST_PTR_FORMAT, incaps);
+
+  /* downstream might handle the overlay meta with the new caps */
+  overlay->check_meta = TRUE;
+
   return TRUE;
 }
 
+static gboolean
+gst_gdk_pixbuf_overlay_downstream_has_meta (GstGdkPixbufOverlay * overlay)
+{
+  GstPad *srcpad = GST_BASE_TRANSFORM_SRC_PAD (overlay);
+  GstCaps *caps;
+  GstQuery *query;
+  gboolean ret = FALSE;
+
+  if (!(caps = gst_pad_get_current_caps (srcpad)))
+    return FALSE;
+
+  query = gst_query_new_allocation (caps, FALSE);
+  if (gst_pad_peer_query (srcpad, query))
+    ret = gst_query_find_allocation_meta (query,
+        GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  GST_DEBUG_OBJECT (overlay, "downstream %s the overlay composition meta",
+      ret ? "supports" : "does not support");
+
+  return ret;
+}
+
+/* attaches the overlay to @buf, together with one that might be there
+ * already */
+static void
+gst_gdk_pixbuf_overlay_attach_meta (GstGdkPixbufOverlay * overlay,
+    GstBuffer * buf)
+{
+  GstVideoOverlayCompositionMeta *meta;
+  GstVideoOverlayComposition *comp;
+
+  meta = gst_buffer_get_video_overlay_composition_meta (buf);
+  if (meta == NULL) {
+    gst_buffer_add_video_overlay_composition_meta (buf, overlay->comp);
+    return;
+  }
+
+  comp = gst_video_overlay_composition_copy (meta->overlay);
+  gst_video_overlay_composition_add_rectangle (comp,
+      gst_video_overlay_composition_get_rectangle (overlay->comp, 0));
+  gst_buffer_remove_meta (buf, (GstMeta *) meta);
+  gst_buffer_add_video_overlay_composition_meta (buf, comp);
+  gst_video_overlay_composition_unref (comp);
+}
+
 static void
 gst_gdk_pixbuf_overlay_update_composition (GstGdkPixbufOverlay * overlay)
 {
@@ -512,11 +574,12 @@ gst_gdk_pixbuf_overlay_before_transform (GstBaseTransform * trans,
     gst_object_sync_values (GST_OBJECT (trans), stream_time);
 }
 
+/* the composition is kept until the image or its placement changes, so the
+ * rectangle caches its scaled and converted pixels across frames */
 static GstFlowReturn
-gst_gdk_pixbuf_overlay_transform_frame_ip (GstVideoFilter * filter,
-    GstVideoFrame * frame)
+gst_gdk_pixbuf_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
-  GstGdkPixbufOverlay *overlay = GST_GDK_PIXBUF_OVERLAY (filter);
+  GstGdkPixbufOverlay *overlay = GST_GDK_PIXBUF_OVERLAY (trans);
 
   GST_OBJECT_LOCK (overlay);
 
@@ -527,8 +590,34 @@ gst_gdk_pixbuf_overlay_transform_frame_ip (GstVideoFilter * filter,
 
   GST_OBJECT_UNLOCK (overlay);
 
-  if (overlay->comp != NULL)
-    gst_video_overlay_composition_blend (overlay->comp, frame);
+  /* nothing to draw, don't even map the frame */
+  if (overlay->comp == NULL)
+    return GST_FLOW_OK;
+
+  if (G_UNLIKELY (overlay->check_meta)) {
+    overlay->attach_meta =
+        gst_gdk_pixbuf_overlay_downstream_has_meta (overlay);
+    overlay->check_meta = FALSE;
+  }
+
+  /* downstream does the blending */
+  if (overlay->attach_meta) {
+    gst_gdk_pixbuf_overlay_attach_meta (overlay, buf);
+    return GST_FLOW_OK;
+  }
+
+  /* maps the frame and blends in transform_frame_ip */
+  return GST_BASE_TRANSFORM_CLASS (gst_gdk_pixbuf_overlay_parent_class)->
+      transform_ip (trans, buf);
+}
+
+static GstFlowReturn
+gst_gdk_pixbuf_overlay_transform_frame_ip (GstVideoFilter * filter,
+    GstVideoFrame * frame)
+{
+  GstGdkPixbufOverlay *overlay = GST_GDK_PIXBUF_OVERLAY (filter);
+
+  gst_video_overlay_composition_blend (overlay->comp, frame);
 
   return GST_FLOW_OK;
 }
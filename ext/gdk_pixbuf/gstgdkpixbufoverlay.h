@@ -67,6 +67,10 @@ struct _GstGdkPixbufOverlay
 
   /* render position or dimension has changed */
   gboolean                     update_composition;
+
+  /* downstream blends the overlay composition meta */
+  gboolean                     check_meta;
+  gboolean                     attach_meta;
 };
 
 struct _GstGdkPixbufOverlayClass
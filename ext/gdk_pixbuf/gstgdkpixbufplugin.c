@@ -27,6 +27,7 @@
 #include "gstgdkpixbufdec.h"
 #include "gstgdkpixbufoverlay.h"
 #include "gstgdkpixbufsink.h"
+#include "pixbufscale.h"
 
 
 #if 0
@@ -98,6 +99,9 @@ plugin_init (GstPlugin * plugin)
           GST_TYPE_GDK_PIXBUF_SINK))
     return FALSE;
 
+  if (!pixbufscale_init (plugin))
+    return FALSE;
+
   return TRUE;
 }
 
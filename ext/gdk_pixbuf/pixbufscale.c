@@ -23,7 +23,7 @@
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
-#include <pixbufscale.h>
+#include "pixbufscale.h"
 #include <gst/video/video.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
@@ -39,6 +39,8 @@
 GST_DEBUG_CATEGORY_STATIC (pixbufscale_debug);
 #define GST_CAT_DEFAULT pixbufscale_debug
 
+#define DEFAULT_N_THREADS 1
+
 /* GstPixbufScale signals and args */
 enum
 {
@@ -49,7 +51,8 @@ enum
 enum
 {
   ARG_0,
-  ARG_METHOD
+  ARG_METHOD,
+  ARG_N_THREADS
       /* FILL ME */
 };
 
@@ -87,6 +90,7 @@ gst_pixbufscale_method_get_type (void)
   return pixbufscale_method_type;
 }
 
+static void gst_pixbufscale_finalize (GObject * object);
 static void gst_pixbufscale_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_pixbufscale_get_property (GObject * object, guint prop_id,
@@ -133,6 +137,7 @@ gst_pixbufscale_class_init (GstPixbufScaleClass * klass)
 
   gobject_class->set_property = gst_pixbufscale_set_property;
   gobject_class->get_property = gst_pixbufscale_get_property;
+  gobject_class->finalize = gst_pixbufscale_finalize;
 
   g_object_class_install_property (gobject_class,
       ARG_METHOD,
@@ -140,6 +145,20 @@ gst_pixbufscale_class_init (GstPixbufScaleClass * klass)
           GST_TYPE_PIXBUFSCALE_METHOD, GST_PIXBUFSCALE_BILINEAR,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPixbufScale:n-threads:
+   *
+   * The number of threads that scale a frame. Every thread renders a
+   * horizontal stripe of the output, so the output does not depend on this
+   * setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to scale a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   trans_class->transform_caps =
       GST_DEBUG_FUNCPTR (gst_pixbufscale_transform_caps);
   trans_class->fixate_caps = GST_DEBUG_FUNCPTR (gst_pixbufscale_fixate_caps);
@@ -160,6 +179,18 @@ gst_pixbufscale_init (GstPixbufScale * pixbufscale)
 
   pixbufscale->method = GST_PIXBUFSCALE_TILES;
   pixbufscale->gdk_method = GDK_INTERP_TILES;
+  pixbufscale->n_threads = DEFAULT_N_THREADS;
+}
+
+static void
+gst_pixbufscale_finalize (GObject * object)
+{
+  GstPixbufScale *pixbufscale = GST_PIXBUFSCALE (object);
+
+  if (pixbufscale->workers)
+    gst_workers_free (pixbufscale->workers);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static void
@@ -189,6 +220,12 @@ gst_pixbufscale_set_property (GObject * object, guint prop_id,
           break;
       }
       break;
+    case ARG_N_THREADS:
+      /* takes effect with the next frame */
+      GST_OBJECT_LOCK (src);
+      src->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       break;
   }
@@ -207,6 +244,11 @@ gst_pixbufscale_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_METHOD:
       g_value_set_enum (value, src->method);
       break;
+    case ARG_N_THREADS:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->n_threads);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -361,12 +403,42 @@ done:
   return othercaps;
 }
 
+typedef struct
+{
+  GdkPixbuf *src;
+  GdkPixbuf *dest;
+  gdouble scale_x;
+  gdouble scale_y;
+  GdkInterpType method;
+} GstPixbufScaleSliceData;
+
+/* render the rows of stripe @slice of the output. gdk-pixbuf computes every
+ * output row from the offset and the scale alone, so the stripes together
+ * are the same as scaling the whole frame at once */
+static void
+gst_pixbufscale_scale_slice (gpointer user_data, guint slice, guint n_slices)
+{
+  GstPixbufScaleSliceData *data = user_data;
+  gint width = gdk_pixbuf_get_width (data->dest);
+  gint height = gdk_pixbuf_get_height (data->dest);
+  gint y0, y1;
+
+  y0 = height * slice / n_slices;
+  y1 = height * (slice + 1) / n_slices;
+  if (y1 <= y0)
+    return;
+
+  gdk_pixbuf_scale (data->src, data->dest, 0, y0, width, y1 - y0, 0, 0,
+      data->scale_x, data->scale_y, data->method);
+}
+
 static GstFlowReturn
 gst_pixbufscale_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in, GstVideoFrame * out)
 {
   GstPixbufScale *scale;
   GdkPixbuf *src_pixbuf, *dest_pixbuf;
+  GstPixbufScaleSliceData data;
 
   scale = GST_PIXBUFSCALE (filter);
 
@@ -382,12 +454,21 @@ gst_pixbufscale_transform_frame (GstVideoFilter * filter,
       GST_VIDEO_FRAME_HEIGHT (out),
       GST_VIDEO_FRAME_COMP_STRIDE (out, 0), NULL, NULL);
 
-  gdk_pixbuf_scale (src_pixbuf, dest_pixbuf, 0, 0,
-      GST_VIDEO_FRAME_WIDTH (out),
-      GST_VIDEO_FRAME_HEIGHT (out), 0, 0,
-      (double) GST_VIDEO_FRAME_WIDTH (out) / GST_VIDEO_FRAME_WIDTH (in),
-      (double) GST_VIDEO_FRAME_HEIGHT (out) / GST_VIDEO_FRAME_HEIGHT (in),
-      scale->gdk_method);
+  data.src = src_pixbuf;
+  data.dest = dest_pixbuf;
+  data.scale_x =
+      (double) GST_VIDEO_FRAME_WIDTH (out) / GST_VIDEO_FRAME_WIDTH (in);
+  data.scale_y =
+      (double) GST_VIDEO_FRAME_HEIGHT (out) / GST_VIDEO_FRAME_HEIGHT (in);
+  data.method = scale->gdk_method;
+
+  GST_OBJECT_LOCK (scale);
+  gst_workers_ensure (&scale->workers, scale->n_threads);
+  if (scale->workers)
+    gst_workers_run (scale->workers, gst_pixbufscale_scale_slice, &data);
+  else
+    gst_pixbufscale_scale_slice (&data, 0, 1);
+  GST_OBJECT_UNLOCK (scale);
 
   g_object_unref (src_pixbuf);
   g_object_unref (dest_pixbuf);
@@ -29,6 +29,8 @@
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_PIXBUFSCALE			\
@@ -65,7 +67,12 @@ struct _GstPixbufScale {
 
   GstPixbufScaleMethod method;
   GdkInterpType gdk_method;
-  
+
+  /* protected by the object lock */
+  guint n_threads;
+
+  GstWorkers *workers;
+
   /* private */
   gint from_buf_size;
   gint from_stride;
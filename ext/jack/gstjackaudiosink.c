@@ -66,6 +66,7 @@
 
 #include "gstjackaudiosink.h"
 #include "gstjackringbuffer.h"
+#include "gstjackutil.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_jack_audio_sink_debug);
 #define GST_CAT_DEFAULT gst_jack_audio_sink_debug
@@ -211,7 +212,7 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
     if (nframes * sizeof (sample_t) != flen)
       goto wrong_size;
 
-    GST_DEBUG_OBJECT (sink, "copy %d frames: %p, %d bytes, %d channels",
+    GST_LOG_OBJECT (sink, "copy %d frames: %p, %d bytes, %d channels",
         nframes, readptr, flen, channels);
     data = (sample_t *) readptr;
 
@@ -227,9 +228,9 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
     gst_audio_ring_buffer_clear (buf, readseg);
 
     /* we wrote one segment */
-    gst_audio_ring_buffer_advance (buf, 1);
+    gst_jack_ring_buffer_advance (buf);
   } else {
-    GST_DEBUG_OBJECT (sink, "write %d frames silence", nframes);
+    GST_LOG_OBJECT (sink, "write %d frames silence", nframes);
     /* We are not allowed to read from the ringbuffer, write silence to all
      * jack output buffers */
     for (i = 0; i < channels; i++) {
@@ -238,11 +238,11 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
       for (j = 0; j < channels; ++j)
         *data++ = src->buffers[j][i];
 
-    GST_DEBUG ("copy %d frames: %p, %d bytes, %d channels", nframes, writeptr,
+    GST_LOG ("copy %d frames: %p, %d bytes, %d channels", nframes, writeptr,
         len / channels, channels);
 
     /* we wrote one segment */
-    gst_audio_ring_buffer_advance (buf, 1);
+    gst_jack_ring_buffer_advance (buf);
   }
   return 0;
 
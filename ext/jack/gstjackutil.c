@@ -108,3 +108,22 @@ gst_jack_set_layout (GstAudioRingBuffer * buffer, GstAudioRingBufferSpec * spec)
   gst_caps_unref (spec->caps);
   spec->caps = gst_audio_info_to_caps (&spec->info);
 }
+
+/* gst_audio_ring_buffer_advance() for the JACK process thread. The process
+ * thread must never block, so the object lock is only tried to wake up a
+ * waiting streaming thread. When the streaming thread holds it, it is about
+ * to wait itself and the next process cycle wakes it up, the waiting flag
+ * stays set until then. */
+void
+gst_jack_ring_buffer_advance (GstAudioRingBuffer * buffer)
+{
+  g_atomic_int_add (&buffer->segdone, 1);
+
+  if (G_UNLIKELY (g_atomic_int_get (&buffer->waiting))) {
+    if (GST_OBJECT_TRYLOCK (buffer)) {
+      if (g_atomic_int_compare_and_exchange (&buffer->waiting, 1, 0))
+        GST_AUDIO_RING_BUFFER_SIGNAL (buffer);
+      GST_OBJECT_UNLOCK (buffer);
+    }
+  }
+}
@@ -28,4 +28,7 @@
 void
 gst_jack_set_layout (GstAudioRingBuffer * buffer, GstAudioRingBufferSpec *spec);
 
+void
+gst_jack_ring_buffer_advance (GstAudioRingBuffer * buffer);
+
 #endif  // _GST_JACK_UTIL_H_
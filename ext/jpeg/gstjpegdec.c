@@ -56,12 +56,14 @@
 
 #define JPEG_DEFAULT_IDCT_METHOD	JDCT_FASTEST
 #define JPEG_DEFAULT_MAX_ERRORS 	0
+#define DEFAULT_N_THREADS 1
 
 enum
 {
   PROP_0,
   PROP_IDCT_METHOD,
-  PROP_MAX_ERRORS
+  PROP_MAX_ERRORS,
+  PROP_N_THREADS
 };
 
 /* *INDENT-OFF* */
@@ -70,7 +72,7 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE
-        ("{ I420, RGB, BGR, RGBx, xRGB, BGRx, xBGR, GRAY8 }"))
+        ("{ I420, Y42B, Y444, RGB, BGR, RGBx, xRGB, BGRx, xBGR, GRAY8 }"))
     );
 /* *INDENT-ON* */
 
@@ -98,12 +100,14 @@ static gboolean gst_jpeg_dec_set_format (GstVideoDecoder * dec,
 static gboolean gst_jpeg_dec_start (GstVideoDecoder * bdec);
 static gboolean gst_jpeg_dec_stop (GstVideoDecoder * bdec);
 static gboolean gst_jpeg_dec_flush (GstVideoDecoder * bdec);
+static GstFlowReturn gst_jpeg_dec_finish (GstVideoDecoder * bdec);
 static GstFlowReturn gst_jpeg_dec_parse (GstVideoDecoder * bdec,
     GstVideoCodecFrame * frame, GstAdapter * adapter, gboolean at_eos);
 static GstFlowReturn gst_jpeg_dec_handle_frame (GstVideoDecoder * bdec,
     GstVideoCodecFrame * frame);
 static gboolean gst_jpeg_dec_decide_allocation (GstVideoDecoder * bdec,
     GstQuery * query);
+static void gst_jpeg_dec_context_clear (GstJpegDecContext * ctx);
 
 #define gst_jpeg_dec_parent_class parent_class
 G_DEFINE_TYPE (GstJpegDec, gst_jpeg_dec, GST_TYPE_VIDEO_DECODER);
@@ -113,7 +117,7 @@ gst_jpeg_dec_finalize (GObject * object)
 {
   GstJpegDec *dec = GST_JPEG_DEC (object);
 
-  jpeg_destroy_decompress (&dec->cinfo);
+  gst_jpeg_dec_context_clear (&dec->ctx);
   if (dec->input_state)
     gst_video_codec_state_unref (dec->input_state);
 
@@ -158,6 +162,22 @@ gst_jpeg_dec_class_init (GstJpegDecClass * klass)
           -1, G_MAXINT, JPEG_DEFAULT_MAX_ERRORS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstJpegDec:n-threads:
+   *
+   * The number of threads that decode the images. Images with restart
+   * markers are cut in bands of MCU rows that are decoded at the same time,
+   * other images are decoded in batches of one frame per thread, which adds
+   * up to n-threads - 1 frames of latency. Changes take effect the next time
+   * the element starts.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to decode an image", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_jpeg_dec_src_pad_template));
   gst_element_class_add_pad_template (element_class,
@@ -169,6 +189,7 @@ gst_jpeg_dec_class_init (GstJpegDecClass * klass)
   vdec_class->start = gst_jpeg_dec_start;
   vdec_class->stop = gst_jpeg_dec_stop;
   vdec_class->flush = gst_jpeg_dec_flush;
+  vdec_class->finish = gst_jpeg_dec_finish;
   vdec_class->parse = gst_jpeg_dec_parse;
   vdec_class->set_format = gst_jpeg_dec_set_format;
   vdec_class->handle_frame = gst_jpeg_dec_handle_frame;
@@ -181,15 +202,13 @@ gst_jpeg_dec_class_init (GstJpegDecClass * klass)
 static boolean
 gst_jpeg_dec_fill_input_buffer (j_decompress_ptr cinfo)
 {
-  GstJpegDec *dec;
+  struct GstJpegDecSourceMgr *jsrc = (struct GstJpegDecSourceMgr *) cinfo->src;
 
-  dec = CINFO_GET_JPEGDEC (cinfo);
-  g_return_val_if_fail (dec != NULL, FALSE);
-  g_return_val_if_fail (dec->current_frame != NULL, FALSE);
-  g_return_val_if_fail (dec->current_frame_map.data != NULL, FALSE);
+  g_return_val_if_fail (jsrc->dec != NULL, FALSE);
+  g_return_val_if_fail (jsrc->data != NULL, FALSE);
 
-  cinfo->src->next_input_byte = dec->current_frame_map.data;
-  cinfo->src->bytes_in_buffer = dec->current_frame_map.size;
+  cinfo->src->next_input_byte = jsrc->data;
+  cinfo->src->bytes_in_buffer = jsrc->size;
 
   return TRUE;
 }
@@ -250,32 +269,52 @@ METHODDEF (void)
   longjmp (err_mgr->setjmp_buffer, 1);
 }
 
+static void
+gst_jpeg_dec_context_init (GstJpegDec * dec, GstJpegDecContext * ctx)
+{
+  memset (ctx, 0, sizeof (GstJpegDecContext));
+
+  /* setup jpeglib */
+  ctx->cinfo.err = jpeg_std_error (&ctx->jerr.pub);
+  ctx->jerr.pub.output_message = gst_jpeg_dec_my_output_message;
+  ctx->jerr.pub.emit_message = gst_jpeg_dec_my_emit_message;
+  ctx->jerr.pub.error_exit = gst_jpeg_dec_my_error_exit;
+
+  jpeg_create_decompress (&ctx->cinfo);
+
+  ctx->cinfo.src = (struct jpeg_source_mgr *) &ctx->jsrc;
+  ctx->cinfo.src->init_source = gst_jpeg_dec_init_source;
+  ctx->cinfo.src->fill_input_buffer = gst_jpeg_dec_fill_input_buffer;
+  ctx->cinfo.src->skip_input_data = gst_jpeg_dec_skip_input_data;
+  ctx->cinfo.src->resync_to_restart = gst_jpeg_dec_resync_to_restart;
+  ctx->cinfo.src->term_source = gst_jpeg_dec_term_source;
+  ctx->jsrc.dec = dec;
+}
+
+static void gst_jpeg_dec_free_buffers (GstJpegDecContext * ctx);
+
+static void
+gst_jpeg_dec_context_clear (GstJpegDecContext * ctx)
+{
+  jpeg_destroy_decompress (&ctx->cinfo);
+  gst_jpeg_dec_free_buffers (ctx);
+  if (ctx->slice)
+    g_byte_array_unref (ctx->slice);
+  ctx->slice = NULL;
+}
+
 static void
 gst_jpeg_dec_init (GstJpegDec * dec)
 {
   GST_DEBUG ("initializing");
 
-  /* setup jpeglib */
-  memset (&dec->cinfo, 0, sizeof (dec->cinfo));
-  memset (&dec->jerr, 0, sizeof (dec->jerr));
-  dec->cinfo.err = jpeg_std_error (&dec->jerr.pub);
-  dec->jerr.pub.output_message = gst_jpeg_dec_my_output_message;
-  dec->jerr.pub.emit_message = gst_jpeg_dec_my_emit_message;
-  dec->jerr.pub.error_exit = gst_jpeg_dec_my_error_exit;
-
-  jpeg_create_decompress (&dec->cinfo);
-
-  dec->cinfo.src = (struct jpeg_source_mgr *) &dec->jsrc;
-  dec->cinfo.src->init_source = gst_jpeg_dec_init_source;
-  dec->cinfo.src->fill_input_buffer = gst_jpeg_dec_fill_input_buffer;
-  dec->cinfo.src->skip_input_data = gst_jpeg_dec_skip_input_data;
-  dec->cinfo.src->resync_to_restart = gst_jpeg_dec_resync_to_restart;
-  dec->cinfo.src->term_source = gst_jpeg_dec_term_source;
-  dec->jsrc.dec = dec;
+  gst_jpeg_dec_context_init (dec, &dec->ctx);
 
   /* init properties */
   dec->idct_method = JPEG_DEFAULT_IDCT_METHOD;
   dec->max_errors = JPEG_DEFAULT_MAX_ERRORS;
+  dec->n_threads = DEFAULT_N_THREADS;
+  dec->wanted_format = GST_VIDEO_FORMAT_UNKNOWN;
 }
 
 static inline gboolean
@@ -586,6 +625,21 @@ guarantee_huff_tables (j_decompress_ptr dinfo)
   }
 }
 
+/* ask for raw output in the colorspace of the image, this also computes the
+ * output size */
+static void
+gst_jpeg_dec_prepare_output (GstJpegDec * dec, GstJpegDecContext * ctx)
+{
+  ctx->cinfo.do_fancy_upsampling = FALSE;
+  ctx->cinfo.do_block_smoothing = FALSE;
+  ctx->cinfo.out_color_space = ctx->cinfo.jpeg_color_space;
+  ctx->cinfo.dct_method = dec->idct_method;
+  ctx->cinfo.raw_data_out = TRUE;
+
+  guarantee_huff_tables (&ctx->cinfo);
+  jpeg_calc_output_dimensions (&ctx->cinfo);
+}
+
 static gboolean
 gst_jpeg_dec_set_format (GstVideoDecoder * dec, GstVideoCodecState * state)
 {
@@ -604,6 +658,16 @@ gst_jpeg_dec_set_format (GstVideoDecoder * dec, GstVideoCodecState * state)
     gst_video_codec_state_unref (jpeg->input_state);
   jpeg->input_state = gst_video_codec_state_ref (state);
 
+  /* a batch of frames is only pushed when the last one arrived */
+  if (jpeg->batch) {
+    GstClockTime latency;
+
+    latency = gst_work_batch_get_latency (jpeg->batch,
+        GST_VIDEO_INFO_FPS_N (info), GST_VIDEO_INFO_FPS_D (info));
+    if (latency > 0)
+      gst_video_decoder_set_latency (dec, latency, latency);
+  }
+
   return TRUE;
 }
 
@@ -624,94 +688,51 @@ hresamplecpy1 (guint8 * dest, const guint8 * src, guint len)
 }
 
 static void
-gst_jpeg_dec_free_buffers (GstJpegDec * dec)
+gst_jpeg_dec_free_buffers (GstJpegDecContext * ctx)
 {
   gint i;
 
   for (i = 0; i < 16; i++) {
-    g_free (dec->idr_y[i]);
-    g_free (dec->idr_u[i]);
-    g_free (dec->idr_v[i]);
-    dec->idr_y[i] = NULL;
-    dec->idr_u[i] = NULL;
-    dec->idr_v[i] = NULL;
+    g_free (ctx->idr_y[i]);
+    g_free (ctx->idr_u[i]);
+    g_free (ctx->idr_v[i]);
+    ctx->idr_y[i] = NULL;
+    ctx->idr_u[i] = NULL;
+    ctx->idr_v[i] = NULL;
   }
 
-  dec->idr_width_allocated = 0;
+  ctx->idr_width_allocated = 0;
 }
 
 static inline gboolean
-gst_jpeg_dec_ensure_buffers (GstJpegDec * dec, guint maxrowbytes)
+gst_jpeg_dec_ensure_buffers (GstJpegDec * dec, GstJpegDecContext * ctx,
+    guint maxrowbytes)
 {
   gint i;
 
-  if (G_LIKELY (dec->idr_width_allocated == maxrowbytes))
+  if (G_LIKELY (ctx->idr_width_allocated == maxrowbytes))
     return TRUE;
 
   /* FIXME: maybe just alloc one or three blocks altogether? */
   for (i = 0; i < 16; i++) {
-    dec->idr_y[i] = g_try_realloc (dec->idr_y[i], maxrowbytes);
-    dec->idr_u[i] = g_try_realloc (dec->idr_u[i], maxrowbytes);
-    dec->idr_v[i] = g_try_realloc (dec->idr_v[i], maxrowbytes);
+    ctx->idr_y[i] = g_try_realloc (ctx->idr_y[i], maxrowbytes);
+    ctx->idr_u[i] = g_try_realloc (ctx->idr_u[i], maxrowbytes);
+    ctx->idr_v[i] = g_try_realloc (ctx->idr_v[i], maxrowbytes);
 
-    if (G_UNLIKELY (!dec->idr_y[i] || !dec->idr_u[i] || !dec->idr_v[i])) {
+    if (G_UNLIKELY (!ctx->idr_y[i] || !ctx->idr_u[i] || !ctx->idr_v[i])) {
       GST_WARNING_OBJECT (dec, "out of memory, i=%d, bytes=%u", i, maxrowbytes);
       return FALSE;
     }
   }
 
-  dec->idr_width_allocated = maxrowbytes;
+  ctx->idr_width_allocated = maxrowbytes;
   GST_LOG_OBJECT (dec, "allocated temp memory, %u bytes/row", maxrowbytes);
   return TRUE;
 }
 
 static void
-gst_jpeg_dec_decode_grayscale (GstJpegDec * dec, GstVideoFrame * frame)
-{
-  guchar *rows[16];
-  guchar **scanarray[1] = { rows };
-  gint i, j, k;
-  gint lines;
-  guint8 *base[1];
-  gint width, height;
-  gint pstride, rstride;
-
-  GST_DEBUG_OBJECT (dec, "indirect decoding of grayscale");
-
-  width = GST_VIDEO_FRAME_WIDTH (frame);
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
-
-  if (G_UNLIKELY (!gst_jpeg_dec_ensure_buffers (dec, GST_ROUND_UP_32 (width))))
-    return;
-
-  base[0] = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
-  pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
-  rstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
-
-  memcpy (rows, dec->idr_y, 16 * sizeof (gpointer));
-
-  i = 0;
-  while (i < height) {
-    lines = jpeg_read_raw_data (&dec->cinfo, scanarray, DCTSIZE);
-    if (G_LIKELY (lines > 0)) {
-      for (j = 0; (j < DCTSIZE) && (i < height); j++, i++) {
-        gint p;
-
-        p = 0;
-        for (k = 0; k < width; k++) {
-          base[0][p] = rows[j][k];
-          p += pstride;
-        }
-        base[0] += rstride;
-      }
-    } else {
-      GST_INFO_OBJECT (dec, "jpeg_read_raw_data() returned 0");
-    }
-  }
-}
-
-static void
-gst_jpeg_dec_decode_rgb (GstJpegDec * dec, GstVideoFrame * frame)
+gst_jpeg_dec_decode_rgb (GstJpegDec * dec, GstJpegDecContext * ctx,
+    GstVideoFrame * frame)
 {
   guchar *r_rows[16], *g_rows[16], *b_rows[16];
   guchar **scanarray[3] = { r_rows, g_rows, b_rows };
@@ -726,7 +747,8 @@ gst_jpeg_dec_decode_rgb (GstJpegDec * dec, GstVideoFrame * frame)
   width = GST_VIDEO_FRAME_WIDTH (frame);
   height = GST_VIDEO_FRAME_HEIGHT (frame);
 
-  if (G_UNLIKELY (!gst_jpeg_dec_ensure_buffers (dec, GST_ROUND_UP_32 (width))))
+  if (G_UNLIKELY (!gst_jpeg_dec_ensure_buffers (dec, ctx,
+              GST_ROUND_UP_32 (width))))
     return;
 
   for (i = 0; i < 3; i++)
@@ -735,13 +757,13 @@ gst_jpeg_dec_decode_rgb (GstJpegDec * dec, GstVideoFrame * frame)
   pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
   rstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
 
-  memcpy (r_rows, dec->idr_y, 16 * sizeof (gpointer));
-  memcpy (g_rows, dec->idr_u, 16 * sizeof (gpointer));
-  memcpy (b_rows, dec->idr_v, 16 * sizeof (gpointer));
+  memcpy (r_rows, ctx->idr_y, 16 * sizeof (gpointer));
+  memcpy (g_rows, ctx->idr_u, 16 * sizeof (gpointer));
+  memcpy (b_rows, ctx->idr_v, 16 * sizeof (gpointer));
 
   i = 0;
   while (i < height) {
-    lines = jpeg_read_raw_data (&dec->cinfo, scanarray, DCTSIZE);
+    lines = jpeg_read_raw_data (&ctx->cinfo, scanarray, DCTSIZE);
     if (G_LIKELY (lines > 0)) {
       for (j = 0; (j < DCTSIZE) && (i < height); j++, i++) {
         gint p;
@@ -763,174 +785,514 @@ gst_jpeg_dec_decode_rgb (GstJpegDec * dec, GstVideoFrame * frame)
   }
 }
 
-static void
-gst_jpeg_dec_decode_indirect (GstJpegDec * dec, GstVideoFrame * frame, gint r_v,
-    gint r_h, gint comp)
+/* Decode the components of a YCbCr or grayscale image into the planes of
+ * @frame. jpeglib writes whole blocks, the rows of a component go straight
+ * into the frame when the lines of its plane have room for them, the
+ * padding that is configured on the pool normally takes care of that.
+ * Otherwise the rows are decoded into the line buffers and copied. A plane
+ * can have half the lines or the columns of its component, like when an
+ * image is output in a format with a lower chroma resolution. */
+static GstFlowReturn
+gst_jpeg_dec_decode_raw (GstJpegDec * dec, GstJpegDecContext * ctx,
+    GstVideoFrame * frame)
 {
-  guchar *y_rows[16], *u_rows[16], *v_rows[16];
-  guchar **scanarray[3] = { y_rows, u_rows, v_rows };
-  gint i, j, k;
-  gint lines;
-  guchar *base[3], *last[3];
-  gint stride[3];
-  gint width, height;
+  guchar *rows[3][2 * DCTSIZE];
+  guchar **scanarray[3] = { rows[0], rows[1], rows[2] };
+  guchar **idr[3] = { ctx->idr_y, ctx->idr_u, ctx->idr_v };
+  guint8 *base[3];
+  gint stride[3], width[3], height[3], v_samp[3], v_shift[3];
+  gboolean h_shift[3], direct[3];
+  gint c, i, j, n_comps, max_v, lines;
 
-  GST_DEBUG_OBJECT (dec,
-      "unadvantageous width or r_h, taking slow route involving memcpy");
+  n_comps = ctx->cinfo.num_components;
+  max_v = ctx->cinfo.max_v_samp_factor;
 
-  width = GST_VIDEO_FRAME_WIDTH (frame);
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
+  if (G_UNLIKELY (!gst_jpeg_dec_ensure_buffers (dec, ctx,
+              GST_ROUND_UP_32 (GST_VIDEO_FRAME_WIDTH (frame)))))
+    return GST_FLOW_OK;
 
-  if (G_UNLIKELY (!gst_jpeg_dec_ensure_buffers (dec, GST_ROUND_UP_32 (width))))
-    return;
+  for (c = 0; c < n_comps; c++) {
+    jpeg_component_info *comp = &ctx->cinfo.comp_info[c];
 
-  for (i = 0; i < 3; i++) {
-    base[i] = GST_VIDEO_FRAME_COMP_DATA (frame, i);
-    stride[i] = GST_VIDEO_FRAME_COMP_STRIDE (frame, i);
-    /* make sure we don't make jpeglib write beyond our buffer,
-     * which might happen if (height % (r_v*DCTSIZE)) != 0 */
-    last[i] = base[i] + (GST_VIDEO_FRAME_COMP_STRIDE (frame, i) *
-        (GST_VIDEO_FRAME_COMP_HEIGHT (frame, i) - 1));
-  }
+    v_samp[c] = comp->v_samp_factor;
+    if (G_UNLIKELY (v_samp[c] > 2))
+      goto format_not_supported;
+
+    base[c] = GST_VIDEO_FRAME_COMP_DATA (frame, c);
+    stride[c] = GST_VIDEO_FRAME_COMP_STRIDE (frame, c);
+    width[c] = GST_VIDEO_FRAME_COMP_WIDTH (frame, c);
+    height[c] = GST_VIDEO_FRAME_COMP_HEIGHT (frame, c);
 
-  memcpy (y_rows, dec->idr_y, 16 * sizeof (gpointer));
-  memcpy (u_rows, dec->idr_u, 16 * sizeof (gpointer));
-  memcpy (v_rows, dec->idr_v, 16 * sizeof (gpointer));
+    /* only every other line or column of the component is used */
+    v_shift[c] = height[c] < comp->downsampled_height ? 1 : 0;
+    h_shift[c] = width[c] < comp->downsampled_width;
 
-  /* fill chroma components for grayscale */
-  if (comp == 1) {
-    GST_DEBUG_OBJECT (dec, "grayscale, filling chroma");
-    for (i = 0; i < 16; i++) {
-      memset (u_rows[i], GST_ROUND_UP_32 (width), 0x80);
-      memset (v_rows[i], GST_ROUND_UP_32 (width), 0x80);
+    direct[c] = width[c] == comp->downsampled_width &&
+        comp->width_in_blocks * DCTSIZE <= stride[c];
+    if (!direct[c]) {
+      GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, dec,
+          "indirect decoding of component %d using extra buffer copy", c);
     }
   }
 
-  for (i = 0; i < height; i += r_v * DCTSIZE) {
-    lines = jpeg_read_raw_data (&dec->cinfo, scanarray, r_v * DCTSIZE);
-    if (G_LIKELY (lines > 0)) {
-      for (j = 0, k = 0; j < (r_v * DCTSIZE); j += r_v, k++) {
-        if (G_LIKELY (base[0] <= last[0])) {
-          memcpy (base[0], y_rows[j], stride[0]);
-          base[0] += stride[0];
-        }
-        if (r_v == 2) {
-          if (G_LIKELY (base[0] <= last[0])) {
-            memcpy (base[0], y_rows[j + 1], stride[0]);
-            base[0] += stride[0];
-          }
-        }
-        if (G_LIKELY (base[1] <= last[1] && base[2] <= last[2])) {
-          if (r_h == 2) {
-            memcpy (base[1], u_rows[k], stride[1]);
-            memcpy (base[2], v_rows[k], stride[2]);
-          } else if (r_h == 1) {
-            hresamplecpy1 (base[1], u_rows[k], stride[1]);
-            hresamplecpy1 (base[2], v_rows[k], stride[2]);
-          } else {
-            /* FIXME: implement (at least we avoid crashing by doing nothing) */
-          }
-        }
+  for (i = 0; i < GST_VIDEO_FRAME_HEIGHT (frame); i += max_v * DCTSIZE) {
+    for (c = 0; c < n_comps; c++) {
+      gint first = i / max_v * v_samp[c];
 
-        if (r_v == 2 || (k & 1) != 0) {
-          base[1] += stride[1];
-          base[2] += stride[2];
-        }
+      for (j = 0; j < v_samp[c] * DCTSIZE; j++) {
+        gint line = (first + j) >> v_shift[c];
+
+        /* the lines that are skipped or past the end of the plane go to the
+         * line buffers */
+        if (direct[c] && line < height[c] && ((first + j) & v_shift[c]) == 0)
+          rows[c][j] = base[c] + line * stride[c];
+        else
+          rows[c][j] = idr[c][j];
       }
-    } else {
+    }
+
+    lines = jpeg_read_raw_data (&ctx->cinfo, scanarray, max_v * DCTSIZE);
+    if (G_UNLIKELY (!lines)) {
       GST_INFO_OBJECT (dec, "jpeg_read_raw_data() returned 0");
+      continue;
     }
+
+    for (c = 0; c < n_comps; c++) {
+      gint first = i / max_v * v_samp[c];
+
+      if (direct[c])
+        continue;
+
+      for (j = 0; j < v_samp[c] * DCTSIZE; j += 1 << v_shift[c]) {
+        gint line = (first + j) >> v_shift[c];
+        guint8 *dest = base[c] + line * stride[c];
+
+        if (line >= height[c])
+          break;
+
+        if (h_shift[c]) {
+          hresamplecpy1 (dest, rows[c][j], width[c]);
+        } else {
+          /* FIXME: upsample the chroma of 4:1:1 images */
+          memcpy (dest, rows[c][j], MIN (width[c],
+                  ctx->cinfo.comp_info[c].downsampled_width));
+        }
+      }
+    }
+  }
+
+  return GST_FLOW_OK;
+
+format_not_supported:
+  {
+    GstFlowReturn ret = GST_FLOW_OK;
+
+    GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
+        (_("Failed to decode JPEG image")),
+        ("Unsupported subsampling schema: v_samp factor %u of component %d",
+            v_samp[c], c), ret);
+
+    return ret;
   }
 }
 
 static GstFlowReturn
-gst_jpeg_dec_decode_direct (GstJpegDec * dec, GstVideoFrame * frame)
+gst_jpeg_dec_decode_frame (GstJpegDec * dec, GstJpegDecContext * ctx,
+    GstVideoFrame * frame)
 {
-  guchar **line[3];             /* the jpeg line buffer         */
-  guchar *y[4 * DCTSIZE] = { NULL, };   /* alloc enough for the lines   */
-  guchar *u[4 * DCTSIZE] = { NULL, };   /* r_v will be <4               */
-  guchar *v[4 * DCTSIZE] = { NULL, };
-  gint i, j;
-  gint lines, v_samp[3];
-  guchar *base[3], *last[3];
-  gint stride[3];
-  guint height;
-
-  line[0] = y;
-  line[1] = u;
-  line[2] = v;
-
-  v_samp[0] = dec->cinfo.comp_info[0].v_samp_factor;
-  v_samp[1] = dec->cinfo.comp_info[1].v_samp_factor;
-  v_samp[2] = dec->cinfo.comp_info[2].v_samp_factor;
-
-  if (G_UNLIKELY (v_samp[0] > 2 || v_samp[1] > 2 || v_samp[2] > 2))
-    goto format_not_supported;
+  if (ctx->cinfo.jpeg_color_space == JCS_RGB) {
+    gst_jpeg_dec_decode_rgb (dec, ctx, frame);
+    return GST_FLOW_OK;
+  }
 
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
+  GST_LOG_OBJECT (dec, "decompressing (reqired scanline buffer height = %u)",
+      ctx->cinfo.rec_outbuf_height);
 
-  for (i = 0; i < 3; i++) {
-    base[i] = GST_VIDEO_FRAME_COMP_DATA (frame, i);
-    stride[i] = GST_VIDEO_FRAME_COMP_STRIDE (frame, i);
-    /* make sure we don't make jpeglib write beyond our buffer,
-     * which might happen if (height % (r_v*DCTSIZE)) != 0 */
-    last[i] = base[i] + (GST_VIDEO_FRAME_COMP_STRIDE (frame, i) *
-        (GST_VIDEO_FRAME_COMP_HEIGHT (frame, i) - 1));
+  return gst_jpeg_dec_decode_raw (dec, ctx, frame);
+}
+
+/* decode a complete image with the decompressor of a worker thread. The
+ * streaming thread checked the headers already, the image only has to fit
+ * in @frame */
+static gboolean
+gst_jpeg_dec_decode_image (GstJpegDec * dec, GstJpegDecContext * ctx,
+    const guint8 * data, gsize size, GstVideoFrame * frame)
+{
+  ctx->jsrc.data = data;
+  ctx->jsrc.size = size;
+  gst_jpeg_dec_fill_input_buffer (&ctx->cinfo);
+
+  if (setjmp (ctx->jerr.setjmp_buffer))
+    goto decode_error;
+
+  if (G_UNLIKELY (jpeg_read_header (&ctx->cinfo, TRUE) != JPEG_HEADER_OK))
+    goto wrong_image;
+
+  gst_jpeg_dec_prepare_output (dec, ctx);
+
+  if (G_UNLIKELY (ctx->cinfo.output_width != GST_VIDEO_FRAME_WIDTH (frame) ||
+          ctx->cinfo.output_height != GST_VIDEO_FRAME_HEIGHT (frame)))
+    goto wrong_image;
+
+  if (!jpeg_start_decompress (&ctx->cinfo)) {
+    GST_WARNING_OBJECT (dec, "failed to start decompression cycle");
   }
 
-  /* let jpeglib decode directly into our final buffer */
-  GST_DEBUG_OBJECT (dec, "decoding directly into output buffer");
-
-  for (i = 0; i < height; i += v_samp[0] * DCTSIZE) {
-    for (j = 0; j < (v_samp[0] * DCTSIZE); ++j) {
-      /* Y */
-      line[0][j] = base[0] + (i + j) * stride[0];
-      if (G_UNLIKELY (line[0][j] > last[0]))
-        line[0][j] = last[0];
-      /* U */
-      if (v_samp[1] == v_samp[0]) {
-        line[1][j] = base[1] + ((i + j) / 2) * stride[1];
-      } else if (j < (v_samp[1] * DCTSIZE)) {
-        line[1][j] = base[1] + ((i / 2) + j) * stride[1];
-      }
-      if (G_UNLIKELY (line[1][j] > last[1]))
-        line[1][j] = last[1];
-      /* V */
-      if (v_samp[2] == v_samp[0]) {
-        line[2][j] = base[2] + ((i + j) / 2) * stride[2];
-      } else if (j < (v_samp[2] * DCTSIZE)) {
-        line[2][j] = base[2] + ((i / 2) + j) * stride[2];
-      }
-      if (G_UNLIKELY (line[2][j] > last[2]))
-        line[2][j] = last[2];
+  if (G_UNLIKELY (gst_jpeg_dec_decode_frame (dec, ctx, frame) != GST_FLOW_OK))
+    goto wrong_image;
+
+  jpeg_finish_decompress (&ctx->cinfo);
+
+  return TRUE;
+
+  /* ERRORS */
+decode_error:
+  {
+    gchar err_msg[JMSG_LENGTH_MAX];
+
+    ctx->jerr.pub.format_message ((j_common_ptr) (&ctx->cinfo), err_msg);
+    GST_WARNING_OBJECT (dec, "decode error #%u: %s", ctx->jerr.pub.msg_code,
+        err_msg);
+    jpeg_abort_decompress (&ctx->cinfo);
+    return FALSE;
+  }
+wrong_image:
+  {
+    GST_WARNING_OBJECT (dec, "image does not match the checked header");
+    jpeg_abort_decompress (&ctx->cinfo);
+    return FALSE;
+  }
+}
+
+/* a view on the lines @y to @y + @height of @frame */
+static void
+gst_jpeg_dec_sub_frame (GstVideoFrame * frame, GstVideoFrame * sub, guint y,
+    guint height)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint i;
+
+  *sub = *frame;
+
+  /* all our formats have one component per plane */
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (frame); i++) {
+    sub->data[i] = (guint8 *) frame->data[i] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, i, y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, i);
+  }
+  GST_VIDEO_INFO_HEIGHT (&sub->info) = height;
+}
+
+/* Cut the image in bands of MCU rows that start at a restart marker. Every
+ * band is made into a complete image of its own in the slice of a context:
+ * the headers with the height of the band, the entropy coded segments of the
+ * band with the restart markers counting from 0 and an EOI marker.
+ *
+ * Returns: the number of slices or 0 when the image can't be split. */
+static guint
+gst_jpeg_dec_split_slices (GstJpegDec * dec, const guint8 * data, gsize size)
+{
+  static const guint8 eoi_marker[2] = { 0xff, 0xd9 };
+  struct jpeg_decompress_struct *cinfo = &dec->ctx.cinfo;
+  guint mcu_width, mcu_height, mcus_per_row, mcu_rows;
+  guint ri, period, units, n_segments, n, a, b, i;
+  gsize pos, sof = 0, sos_end = 0, eoi = 0;
+  GArray *rst;
+
+  /* the DC predictions only start over at the restart markers, they are
+   * also only at known MCUs when all the components are in one scan */
+  ri = cinfo->restart_interval;
+  if (ri == 0 || cinfo->progressive_mode ||
+      cinfo->comps_in_scan != cinfo->num_components)
+    return 0;
+
+  if (cinfo->comps_in_scan == 1) {
+    mcu_width = mcu_height = DCTSIZE;
+  } else {
+    mcu_width = cinfo->max_h_samp_factor * DCTSIZE;
+    mcu_height = cinfo->max_v_samp_factor * DCTSIZE;
+  }
+  mcus_per_row = (cinfo->image_width + mcu_width - 1) / mcu_width;
+  mcu_rows = (cinfo->image_height + mcu_height - 1) / mcu_height;
+
+  /* a band can start every period rows, that is where a row starts with a
+   * new restart interval */
+  for (a = ri, b = mcus_per_row; b != 0;) {
+    guint t = a % b;
+
+    a = b;
+    b = t;
+  }
+  period = ri / a;
+  units = mcu_rows / period;
+  n = MIN (units, dec->n_contexts);
+  if (n < 2)
+    return 0;
+
+  if (size < 4 || data[0] != 0xff || data[1] != 0xd8)
+    return 0;
+
+  /* find the frame header and the start of the entropy coded data */
+  pos = 2;
+  while (sos_end == 0) {
+    guint8 marker;
+
+    if (pos + 4 > size || data[pos] != 0xff)
+      return 0;
+
+    marker = data[pos + 1];
+    if (marker == 0xff) {
+      /* fill byte */
+      pos++;
+      continue;
     }
+    if (marker == 0xc0 || marker == 0xc1)
+      sof = pos;
+    else if (marker == 0xda)
+      sos_end = pos + 2 + GST_READ_UINT16_BE (data + pos + 2);
+    pos += 2 + GST_READ_UINT16_BE (data + pos + 2);
+  }
+  if (sof == 0 || sos_end >= size)
+    return 0;
+
+  /* collect the restart markers up to the end of the image */
+  rst = g_array_new (FALSE, FALSE, sizeof (gsize));
+  for (pos = sos_end; pos + 1 < size && eoi == 0; pos++) {
+    guint8 marker;
+
+    if (data[pos] != 0xff)
+      continue;
+
+    marker = data[pos + 1];
+    if (marker >= 0xd0 && marker <= 0xd7) {
+      if (marker != 0xd0 + (rst->len & 7))
+        goto no_slices;
+      g_array_append_val (rst, pos);
+      pos++;
+    } else if (marker == 0xd9) {
+      eoi = pos;
+    } else if (marker == 0x00) {
+      pos++;
+    } else if (marker != 0xff) {
+      /* another scan or a DNL marker */
+      goto no_slices;
+    }
+  }
 
-    lines = jpeg_read_raw_data (&dec->cinfo, line, v_samp[0] * DCTSIZE);
-    if (G_UNLIKELY (!lines)) {
-      GST_INFO_OBJECT (dec, "jpeg_read_raw_data() returned 0");
+  n_segments = (mcus_per_row * mcu_rows + ri - 1) / ri;
+  if (eoi == 0 || rst->len + 1 != n_segments)
+    goto no_slices;
+
+  GST_LOG_OBJECT (dec, "%u restart intervals of %u MCUs, %u slices",
+      n_segments, ri, n);
+
+  for (i = 0; i < n; i++) {
+    GstJpegDecContext *ctx = &dec->contexts[i];
+    guint r0, r1, s0, s1, k;
+    gsize start, end;
+
+    /* the rows and the restart intervals of the slice */
+    r0 = units * i / n * period;
+    r1 = (i + 1 == n) ? mcu_rows : units * (i + 1) / n * period;
+    s0 = r0 * mcus_per_row / ri;
+    s1 = (i + 1 == n) ? n_segments : r1 * mcus_per_row / ri;
+
+    start = s0 == 0 ? sos_end : g_array_index (rst, gsize, s0 - 1) + 2;
+    end = s1 == n_segments ? eoi : g_array_index (rst, gsize, s1 - 1);
+
+    ctx->slice_y = r0 * mcu_height;
+    ctx->slice_height = MIN (r1 * mcu_height, cinfo->image_height) -
+        ctx->slice_y;
+
+    if (ctx->slice == NULL)
+      ctx->slice = g_byte_array_new ();
+    g_byte_array_set_size (ctx->slice, 0);
+    g_byte_array_append (ctx->slice, data, sos_end);
+    g_byte_array_append (ctx->slice, data + start, end - start);
+    g_byte_array_append (ctx->slice, eoi_marker, 2);
+
+    GST_WRITE_UINT16_BE (ctx->slice->data + sof + 5, ctx->slice_height);
+    for (k = s0; k + 1 < s1; k++) {
+      pos = g_array_index (rst, gsize, k) - start + sos_end;
+      ctx->slice->data[pos + 1] = 0xd0 + ((k - s0) & 7);
     }
   }
-  return GST_FLOW_OK;
+  g_array_free (rst, TRUE);
 
-format_not_supported:
+  return n;
+
+no_slices:
   {
-    gboolean ret = GST_FLOW_OK;
+    GST_LOG_OBJECT (dec, "restart markers don't allow slices");
+    g_array_free (rst, TRUE);
+    return 0;
+  }
+}
+
+/* what one run of the workers does */
+typedef struct
+{
+  GstJpegDec *dec;
+  GstVideoFrame *frame;         /* the frame of the slices */
+  guint n_items;                /* slices */
+} GstJpegDecWork;
+
+static void
+gst_jpeg_dec_decode_slice (gpointer data, guint slice, guint n_slices)
+{
+  GstJpegDecWork *work = data;
+  GstJpegDecContext *ctx = &work->dec->contexts[slice];
+  GstVideoFrame sub;
 
+  if (slice >= work->n_items)
+    return;
+
+  gst_jpeg_dec_sub_frame (work->frame, &sub, ctx->slice_y, ctx->slice_height);
+  ctx->failed = !gst_jpeg_dec_decode_image (work->dec, ctx, ctx->slice->data,
+      ctx->slice->len, &sub);
+}
+
+/* decode a frame of a batch with the decompressor of its thread */
+static void
+gst_jpeg_dec_decode_job (gpointer data, gpointer context, guint index)
+{
+  GstJpegDec *dec = data;
+  GstJpegDecJob *job = context;
+
+  job->failed = !gst_jpeg_dec_decode_image (dec, &dec->contexts[index],
+      job->map.data, job->map.size, &job->vframe);
+}
+
+/* push a frame that was decoded by the workers, the mappings are released */
+static GstFlowReturn
+gst_jpeg_dec_finish_decoded (GstJpegDec * dec, GstVideoCodecFrame * frame,
+    GstMapInfo * map, GstVideoFrame * vframe, gboolean failed)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  gst_video_frame_unmap (vframe);
+  gst_buffer_unmap (frame->input_buffer, map);
+
+  if (G_UNLIKELY (failed)) {
     GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
         (_("Failed to decode JPEG image")),
-        ("Unsupported subsampling schema: v_samp factors: %u %u %u", v_samp[0],
-            v_samp[1], v_samp[2]), ret);
-
+        ("Decoding in a worker thread failed"), ret);
+    gst_video_decoder_drop_frame (GST_VIDEO_DECODER (dec), frame);
     return ret;
   }
+
+  return gst_video_decoder_finish_frame (GST_VIDEO_DECODER (dec), frame);
 }
 
+/* push a frame of a batch */
+static GstFlowReturn
+gst_jpeg_dec_finish_job (gpointer data, gpointer context)
+{
+  GstJpegDecJob *job = context;
+  GstVideoCodecFrame *frame = job->frame;
+
+  job->frame = NULL;
+
+  return gst_jpeg_dec_finish_decoded (GST_JPEG_DEC (data), frame, &job->map,
+      &job->vframe, job->failed);
+}
+
+/* forget a frame of a batch, it was not decoded */
 static void
+gst_jpeg_dec_clear_job (gpointer data, gpointer context)
+{
+  GstJpegDecJob *job = context;
+
+  gst_video_frame_unmap (&job->vframe);
+  gst_buffer_unmap (job->frame->input_buffer, &job->map);
+  gst_video_codec_frame_unref (job->frame);
+  job->frame = NULL;
+}
+
+/* Decode the mapped input of @frame into @vframe with the worker threads.
+ * Images with restart markers are cut in slices that are decoded at the same
+ * time, other images wait until there is a frame for every thread. */
+static GstFlowReturn
+gst_jpeg_dec_decode_parallel (GstJpegDec * dec, GstVideoCodecFrame * frame,
+    GstVideoFrame * vframe)
+{
+  GstFlowReturn ret, res;
+  GstJpegDecWork work;
+  GstJpegDecJob *job;
+  gboolean failed = FALSE;
+  guint i, n;
+
+  n = gst_jpeg_dec_split_slices (dec, dec->current_frame_map.data,
+      dec->current_frame_map.size);
+  if (n > 0) {
+    /* the frames of an earlier batch go first */
+    ret = gst_work_batch_flush (dec->batch);
+
+    work.dec = dec;
+    work.frame = vframe;
+    work.n_items = n;
+    gst_workers_run (gst_work_batch_get_workers (dec->batch),
+        gst_jpeg_dec_decode_slice, &work);
+
+    for (i = 0; i < n; i++)
+      failed |= dec->contexts[i].failed;
+
+    res = gst_jpeg_dec_finish_decoded (dec, frame, &dec->current_frame_map,
+        vframe, failed);
+
+    return ret == GST_FLOW_OK ? res : ret;
+  }
+
+  job = gst_work_batch_peek (dec->batch);
+  job->frame = frame;
+  job->map = dec->current_frame_map;
+  job->vframe = *vframe;
+
+  return gst_work_batch_queue (dec->batch);
+}
+
+/* the planar format with the subsampling of the image, jpeglib can decode
+ * into it without resampling */
+static GstVideoFormat
+gst_jpeg_dec_get_yuv_format (struct jpeg_decompress_struct *cinfo)
+{
+  jpeg_component_info *comp = cinfo->comp_info;
+
+  if (comp[1].h_samp_factor != 1 || comp[1].v_samp_factor != 1 ||
+      comp[2].h_samp_factor != 1 || comp[2].v_samp_factor != 1)
+    return GST_VIDEO_FORMAT_I420;
+
+  if (comp[0].h_samp_factor == 2 && comp[0].v_samp_factor == 1)
+    return GST_VIDEO_FORMAT_Y42B;
+  if (comp[0].h_samp_factor == 1 && comp[0].v_samp_factor == 1)
+    return GST_VIDEO_FORMAT_Y444;
+
+  return GST_VIDEO_FORMAT_I420;
+}
+
+static gboolean
+gst_jpeg_dec_peer_accepts_format (GstJpegDec * dec, GstVideoFormat format)
+{
+  GstCaps *filter, *caps;
+  gboolean ret;
+
+  filter = gst_caps_new_simple ("video/x-raw", "format", G_TYPE_STRING,
+      gst_video_format_to_string (format), NULL);
+  caps = gst_pad_peer_query_caps (GST_VIDEO_DECODER_SRC_PAD (dec), filter);
+  ret = !gst_caps_is_empty (caps);
+  gst_caps_unref (caps);
+  gst_caps_unref (filter);
+
+  return ret;
+}
+
+static GstFlowReturn
 gst_jpeg_dec_negotiate (GstJpegDec * dec, gint width, gint height, gint clrspc)
 {
   GstVideoCodecState *outstate;
   GstVideoInfo *info;
   GstVideoFormat format;
+  GstFlowReturn ret;
 
   switch (clrspc) {
     case JCS_RGB:
@@ -940,24 +1302,37 @@ gst_jpeg_dec_negotiate (GstJpegDec * dec, gint width, gint height, gint clrspc)
       format = GST_VIDEO_FORMAT_GRAY8;
       break;
     default:
-      format = GST_VIDEO_FORMAT_I420;
+      format = gst_jpeg_dec_get_yuv_format (&dec->ctx.cinfo);
       break;
   }
 
-  /* Compare to currently configured output state */
+  /* Compare to currently configured output state, the format we wanted for
+   * it might not have been accepted */
   outstate = gst_video_decoder_get_output_state (GST_VIDEO_DECODER (dec));
   if (outstate) {
     info = &outstate->info;
 
     if (width == GST_VIDEO_INFO_WIDTH (info) &&
         height == GST_VIDEO_INFO_HEIGHT (info) &&
-        format == GST_VIDEO_INFO_FORMAT (info)) {
+        format == dec->wanted_format) {
       gst_video_codec_state_unref (outstate);
-      return;
+      return GST_FLOW_OK;
     }
     gst_video_codec_state_unref (outstate);
   }
 
+  /* the frames that wait for a batch were allocated for the old format */
+  ret = dec->batch ? gst_work_batch_flush (dec->batch) : GST_FLOW_OK;
+
+  dec->wanted_format = format;
+  if (format == GST_VIDEO_FORMAT_Y42B || format == GST_VIDEO_FORMAT_Y444) {
+    if (!gst_jpeg_dec_peer_accepts_format (dec, format)) {
+      GST_DEBUG_OBJECT (dec, "downstream does not accept %s, using I420",
+          gst_video_format_to_string (format));
+      format = GST_VIDEO_FORMAT_I420;
+    }
+  }
+
   outstate =
       gst_video_decoder_set_output_state (GST_VIDEO_DECODER (dec), format,
       width, height, dec->input_state);
@@ -978,8 +1353,12 @@ gst_jpeg_dec_negotiate (GstJpegDec * dec, gint width, gint height, gint clrspc)
 
   gst_video_decoder_negotiate (GST_VIDEO_DECODER (dec));
 
-  GST_DEBUG_OBJECT (dec, "max_v_samp_factor=%d", dec->cinfo.max_v_samp_factor);
-  GST_DEBUG_OBJECT (dec, "max_h_samp_factor=%d", dec->cinfo.max_h_samp_factor);
+  GST_DEBUG_OBJECT (dec, "max_v_samp_factor=%d",
+      dec->ctx.cinfo.max_v_samp_factor);
+  GST_DEBUG_OBJECT (dec, "max_h_samp_factor=%d",
+      dec->ctx.cinfo.max_h_samp_factor);
+
+  return ret;
 }
 
 static GstFlowReturn
@@ -996,10 +1375,12 @@ gst_jpeg_dec_handle_frame (GstVideoDecoder * bdec, GstVideoCodecFrame * frame)
 
   dec->current_frame = frame;
   gst_buffer_map (frame->input_buffer, &dec->current_frame_map, GST_MAP_READ);
-  gst_jpeg_dec_fill_input_buffer (&dec->cinfo);
+  dec->ctx.jsrc.data = dec->current_frame_map.data;
+  dec->ctx.jsrc.size = dec->current_frame_map.size;
+  gst_jpeg_dec_fill_input_buffer (&dec->ctx.cinfo);
 
-  if (setjmp (dec->jerr.setjmp_buffer)) {
-    code = dec->jerr.pub.msg_code;
+  if (setjmp (dec->ctx.jerr.setjmp_buffer)) {
+    code = dec->ctx.jerr.pub.msg_code;
 
     if (code == JERR_INPUT_EOF) {
       GST_DEBUG ("jpeg input EOF error, we probably need more data");
@@ -1009,74 +1390,64 @@ gst_jpeg_dec_handle_frame (GstVideoDecoder * bdec, GstVideoCodecFrame * frame)
   }
 
   /* read header */
-  hdr_ok = jpeg_read_header (&dec->cinfo, TRUE);
+  hdr_ok = jpeg_read_header (&dec->ctx.cinfo, TRUE);
   if (G_UNLIKELY (hdr_ok != JPEG_HEADER_OK)) {
     GST_WARNING_OBJECT (dec, "reading the header failed, %d", hdr_ok);
   }
 
-  GST_LOG_OBJECT (dec, "num_components=%d", dec->cinfo.num_components);
-  GST_LOG_OBJECT (dec, "jpeg_color_space=%d", dec->cinfo.jpeg_color_space);
+  GST_LOG_OBJECT (dec, "num_components=%d", dec->ctx.cinfo.num_components);
+  GST_LOG_OBJECT (dec, "jpeg_color_space=%d", dec->ctx.cinfo.jpeg_color_space);
 
-  if (!dec->cinfo.num_components || !dec->cinfo.comp_info)
+  if (!dec->ctx.cinfo.num_components || !dec->ctx.cinfo.comp_info)
     goto components_not_supported;
 
-  r_h = dec->cinfo.comp_info[0].h_samp_factor;
-  r_v = dec->cinfo.comp_info[0].v_samp_factor;
+  r_h = dec->ctx.cinfo.comp_info[0].h_samp_factor;
+  r_v = dec->ctx.cinfo.comp_info[0].v_samp_factor;
 
   GST_LOG_OBJECT (dec, "r_h = %d, r_v = %d", r_h, r_v);
 
-  if (dec->cinfo.num_components > 3)
+  if (dec->ctx.cinfo.num_components > 3)
     goto components_not_supported;
 
   /* verify color space expectation to avoid going *boom* or bogus output */
-  if (dec->cinfo.jpeg_color_space != JCS_YCbCr &&
-      dec->cinfo.jpeg_color_space != JCS_GRAYSCALE &&
-      dec->cinfo.jpeg_color_space != JCS_RGB)
+  if (dec->ctx.cinfo.jpeg_color_space != JCS_YCbCr &&
+      dec->ctx.cinfo.jpeg_color_space != JCS_GRAYSCALE &&
+      dec->ctx.cinfo.jpeg_color_space != JCS_RGB)
     goto unsupported_colorspace;
 
 #ifndef GST_DISABLE_GST_DEBUG
   {
     gint i;
 
-    for (i = 0; i < dec->cinfo.num_components; ++i) {
+    for (i = 0; i < dec->ctx.cinfo.num_components; ++i) {
       GST_LOG_OBJECT (dec, "[%d] h_samp_factor=%d, v_samp_factor=%d, cid=%d",
-          i, dec->cinfo.comp_info[i].h_samp_factor,
-          dec->cinfo.comp_info[i].v_samp_factor,
-          dec->cinfo.comp_info[i].component_id);
+          i, dec->ctx.cinfo.comp_info[i].h_samp_factor,
+          dec->ctx.cinfo.comp_info[i].v_samp_factor,
+          dec->ctx.cinfo.comp_info[i].component_id);
     }
   }
 #endif
 
-  /* prepare for raw output */
-  dec->cinfo.do_fancy_upsampling = FALSE;
-  dec->cinfo.do_block_smoothing = FALSE;
-  dec->cinfo.out_color_space = dec->cinfo.jpeg_color_space;
-  dec->cinfo.dct_method = dec->idct_method;
-  dec->cinfo.raw_data_out = TRUE;
-
-  GST_LOG_OBJECT (dec, "starting decompress");
-  guarantee_huff_tables (&dec->cinfo);
-  if (!jpeg_start_decompress (&dec->cinfo)) {
-    GST_WARNING_OBJECT (dec, "failed to start decompression cycle");
-  }
+  gst_jpeg_dec_prepare_output (dec, &dec->ctx);
 
   /* sanity checks to get safe and reasonable output */
-  switch (dec->cinfo.jpeg_color_space) {
+  switch (dec->ctx.cinfo.jpeg_color_space) {
     case JCS_GRAYSCALE:
-      if (dec->cinfo.num_components != 1)
+      if (dec->ctx.cinfo.num_components != 1)
         goto invalid_yuvrgbgrayscale;
       break;
     case JCS_RGB:
-      if (dec->cinfo.num_components != 3 || dec->cinfo.max_v_samp_factor > 1 ||
-          dec->cinfo.max_h_samp_factor > 1)
+      if (dec->ctx.cinfo.num_components != 3 ||
+          dec->ctx.cinfo.max_v_samp_factor > 1 ||
+          dec->ctx.cinfo.max_h_samp_factor > 1)
         goto invalid_yuvrgbgrayscale;
       break;
     case JCS_YCbCr:
-      if (dec->cinfo.num_components != 3 ||
-          r_v > 2 || r_v < dec->cinfo.comp_info[0].v_samp_factor ||
-          r_v < dec->cinfo.comp_info[1].v_samp_factor ||
-          r_h < dec->cinfo.comp_info[0].h_samp_factor ||
-          r_h < dec->cinfo.comp_info[1].h_samp_factor)
+      if (dec->ctx.cinfo.num_components != 3 ||
+          r_v > 2 || r_v < dec->ctx.cinfo.comp_info[0].v_samp_factor ||
+          r_v < dec->ctx.cinfo.comp_info[1].v_samp_factor ||
+          r_h < dec->ctx.cinfo.comp_info[0].h_samp_factor ||
+          r_h < dec->ctx.cinfo.comp_info[1].h_samp_factor)
         goto invalid_yuvrgbgrayscale;
       break;
     default:
@@ -1084,14 +1455,17 @@ gst_jpeg_dec_handle_frame (GstVideoDecoder * bdec, GstVideoCodecFrame * frame)
       break;
   }
 
-  width = dec->cinfo.output_width;
-  height = dec->cinfo.output_height;
+  width = dec->ctx.cinfo.output_width;
+  height = dec->ctx.cinfo.output_height;
 
   if (G_UNLIKELY (width < MIN_WIDTH || width > MAX_WIDTH ||
           height < MIN_HEIGHT || height > MAX_HEIGHT))
     goto wrong_size;
 
-  gst_jpeg_dec_negotiate (dec, width, height, dec->cinfo.jpeg_color_space);
+  ret = gst_jpeg_dec_negotiate (dec, width, height,
+      dec->ctx.cinfo.jpeg_color_space);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto negotiate_failed;
 
   state = gst_video_decoder_get_output_state (bdec);
   ret = gst_video_decoder_allocate_output_frame (bdec, frame);
@@ -1104,39 +1478,27 @@ gst_jpeg_dec_handle_frame (GstVideoDecoder * bdec, GstVideoCodecFrame * frame)
 
   GST_LOG_OBJECT (dec, "width %d, height %d", width, height);
 
-  if (dec->cinfo.jpeg_color_space == JCS_RGB) {
-    gst_jpeg_dec_decode_rgb (dec, &vframe);
-  } else if (dec->cinfo.jpeg_color_space == JCS_GRAYSCALE) {
-    gst_jpeg_dec_decode_grayscale (dec, &vframe);
-  } else {
-    GST_LOG_OBJECT (dec, "decompressing (reqired scanline buffer height = %u)",
-        dec->cinfo.rec_outbuf_height);
-
-    /* For some widths jpeglib requires more horizontal padding than I420 
-     * provides. In those cases we need to decode into separate buffers and then
-     * copy over the data into our final picture buffer, otherwise jpeglib might
-     * write over the end of a line into the beginning of the next line,
-     * resulting in blocky artifacts on the left side of the picture. */
-    if (G_UNLIKELY (width % (dec->cinfo.max_h_samp_factor * DCTSIZE) != 0
-            || dec->cinfo.comp_info[0].h_samp_factor != 2
-            || dec->cinfo.comp_info[1].h_samp_factor != 1
-            || dec->cinfo.comp_info[2].h_samp_factor != 1)) {
-      GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, dec,
-          "indirect decoding using extra buffer copy");
-      gst_jpeg_dec_decode_indirect (dec, &vframe, r_v, r_h,
-          dec->cinfo.num_components);
-    } else {
-      ret = gst_jpeg_dec_decode_direct (dec, &vframe);
+  if (dec->batch) {
+    /* the worker threads decode the image with their own decompressors */
+    jpeg_abort_decompress (&dec->ctx.cinfo);
+    ret = gst_jpeg_dec_decode_parallel (dec, frame, &vframe);
+    need_unmap = FALSE;
+    goto done;
+  }
 
-      if (G_UNLIKELY (ret != GST_FLOW_OK))
-        goto decode_direct_failed;
-    }
+  GST_LOG_OBJECT (dec, "starting decompress");
+  if (!jpeg_start_decompress (&dec->ctx.cinfo)) {
+    GST_WARNING_OBJECT (dec, "failed to start decompression cycle");
   }
 
+  ret = gst_jpeg_dec_decode_frame (dec, &dec->ctx, &vframe);
   gst_video_frame_unmap (&vframe);
 
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto decode_direct_failed;
+
   GST_LOG_OBJECT (dec, "decompressing finished");
-  jpeg_finish_decompress (&dec->cinfo);
+  jpeg_finish_decompress (&dec->ctx.cinfo);
 
   gst_buffer_unmap (frame->input_buffer, &dec->current_frame_map);
   ret = gst_video_decoder_finish_frame (bdec, frame);
@@ -1174,7 +1536,8 @@ decode_error:
   {
     gchar err_msg[JMSG_LENGTH_MAX];
 
-    dec->jerr.pub.format_message ((j_common_ptr) (&dec->cinfo), err_msg);
+    dec->ctx.jerr.pub.format_message ((j_common_ptr) (&dec->ctx.cinfo),
+        err_msg);
 
     GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
         (_("Failed to decode JPEG image")), ("Decode error #%u: %s", code,
@@ -1183,16 +1546,23 @@ decode_error:
     gst_buffer_unmap (frame->input_buffer, &dec->current_frame_map);
     gst_video_decoder_drop_frame (bdec, frame);
     need_unmap = FALSE;
-    jpeg_abort_decompress (&dec->cinfo);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
 
     goto done;
   }
 decode_direct_failed:
   {
     /* already posted an error message */
-    jpeg_abort_decompress (&dec->cinfo);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
     goto done;
   }
+negotiate_failed:
+  {
+    GST_DEBUG_OBJECT (dec, "pushing the pending frames failed, reason %s",
+        gst_flow_get_name (ret));
+    jpeg_abort_decompress (&dec->ctx.cinfo);
+    goto exit;
+  }
 alloc_failed:
   {
     const gchar *reason;
@@ -1201,13 +1571,13 @@ alloc_failed:
 
     GST_DEBUG_OBJECT (dec, "failed to alloc buffer, reason %s", reason);
     /* Reset for next time */
-    jpeg_abort_decompress (&dec->cinfo);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
     if (ret != GST_FLOW_EOS && ret != GST_FLOW_FLUSHING &&
         ret != GST_FLOW_NOT_LINKED) {
       GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
           (_("Failed to decode JPEG image")),
           ("Buffer allocation failed, reason: %s", reason), ret);
-      jpeg_abort_decompress (&dec->cinfo);
+      jpeg_abort_decompress (&dec->ctx.cinfo);
     }
     goto exit;
   }
@@ -1216,8 +1586,8 @@ components_not_supported:
     GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
         (_("Failed to decode JPEG image")),
         ("number of components not supported: %d (max 3)",
-            dec->cinfo.num_components), ret);
-    jpeg_abort_decompress (&dec->cinfo);
+            dec->ctx.cinfo.num_components), ret);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
     goto done;
   }
 unsupported_colorspace:
@@ -1225,7 +1595,7 @@ unsupported_colorspace:
     GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
         (_("Failed to decode JPEG image")),
         ("Picture has unknown or unsupported colourspace"), ret);
-    jpeg_abort_decompress (&dec->cinfo);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
     goto done;
   }
 invalid_yuvrgbgrayscale:
@@ -1233,7 +1603,7 @@ invalid_yuvrgbgrayscale:
     GST_VIDEO_DECODER_ERROR (dec, 1, STREAM, DECODE,
         (_("Failed to decode JPEG image")),
         ("Picture is corrupt or unhandled YUV/RGB/grayscale layout"), ret);
-    jpeg_abort_decompress (&dec->cinfo);
+    jpeg_abort_decompress (&dec->ctx.cinfo);
     goto done;
   }
 }
@@ -1241,14 +1611,16 @@ invalid_yuvrgbgrayscale:
 static gboolean
 gst_jpeg_dec_decide_allocation (GstVideoDecoder * bdec, GstQuery * query)
 {
+  GstJpegDec *dec = (GstJpegDec *) bdec;
   GstBufferPool *pool = NULL;
   GstStructure *config;
+  guint size, min, max;
 
   if (!GST_VIDEO_DECODER_CLASS (parent_class)->decide_allocation (bdec, query))
     return FALSE;
 
   if (gst_query_get_n_allocation_pools (query) > 0)
-    gst_query_parse_nth_allocation_pool (query, 0, &pool, NULL, NULL, NULL);
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
 
   if (pool == NULL)
     return FALSE;
@@ -1257,6 +1629,46 @@ gst_jpeg_dec_decide_allocation (GstVideoDecoder * bdec, GstQuery * query)
   if (gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL)) {
     gst_buffer_pool_config_add_option (config,
         GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+    /* pad the lines to whole MCUs so that jpeglib can write the blocks of
+     * the raw data straight into the buffers */
+    if (dec->ctx.cinfo.max_h_samp_factor > 0 &&
+        gst_buffer_pool_has_option (pool,
+            GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT)) {
+      GstVideoCodecState *state;
+      GstVideoAlignment align;
+      guint width, mcu_width;
+
+      state = gst_video_decoder_get_output_state (bdec);
+      width = GST_VIDEO_INFO_WIDTH (&state->info);
+      gst_video_codec_state_unref (state);
+
+      mcu_width = dec->ctx.cinfo.max_h_samp_factor * DCTSIZE;
+      gst_video_alignment_reset (&align);
+      align.padding_right =
+          (width + mcu_width - 1) / mcu_width * mcu_width - width;
+
+      if (align.padding_right > 0) {
+        GST_DEBUG_OBJECT (dec, "padding lines with %u pixels",
+            align.padding_right);
+        gst_buffer_pool_config_add_option (config,
+            GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+        gst_buffer_pool_config_set_video_alignment (config, &align);
+      }
+    }
+  }
+
+  /* every frame of a batch holds on to its output buffer */
+  if (dec->n_contexts > 1) {
+    GstCaps *caps;
+
+    min += dec->n_contexts - 1;
+    if (max != 0 && max < min)
+      max = min;
+
+    gst_buffer_pool_config_get_params (config, &caps, NULL, NULL, NULL);
+    gst_buffer_pool_config_set_params (config, caps, size, min, max);
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
   }
   gst_buffer_pool_set_config (pool, config);
   gst_object_unref (pool);
@@ -1275,6 +1687,20 @@ gst_jpeg_dec_start (GstVideoDecoder * bdec)
 
   gst_video_decoder_set_packetized (bdec, FALSE);
 
+  if (dec->n_threads > 1) {
+    guint i;
+
+    dec->batch = gst_work_batch_new (dec->n_threads, sizeof (GstJpegDecJob),
+        gst_jpeg_dec_decode_job, gst_jpeg_dec_finish_job,
+        gst_jpeg_dec_clear_job, dec);
+    dec->n_contexts = gst_work_batch_get_size (dec->batch);
+    dec->contexts = g_new (GstJpegDecContext, dec->n_contexts);
+    for (i = 0; i < dec->n_contexts; i++)
+      gst_jpeg_dec_context_init (dec, &dec->contexts[i]);
+
+    GST_DEBUG_OBJECT (dec, "decoding with %u threads", dec->n_contexts);
+  }
+
   return TRUE;
 }
 
@@ -1283,7 +1709,9 @@ gst_jpeg_dec_flush (GstVideoDecoder * bdec)
 {
   GstJpegDec *dec = (GstJpegDec *) bdec;
 
-  jpeg_abort_decompress (&dec->cinfo);
+  jpeg_abort_decompress (&dec->ctx.cinfo);
+  if (dec->batch)
+    gst_work_batch_clear (dec->batch);
   dec->parse_entropy_len = 0;
   dec->parse_resync = FALSE;
   dec->saw_header = FALSE;
@@ -1291,6 +1719,17 @@ gst_jpeg_dec_flush (GstVideoDecoder * bdec)
   return TRUE;
 }
 
+static GstFlowReturn
+gst_jpeg_dec_finish (GstVideoDecoder * bdec)
+{
+  GstJpegDec *dec = (GstJpegDec *) bdec;
+
+  if (dec->batch == NULL)
+    return GST_FLOW_OK;
+
+  return gst_work_batch_flush (dec->batch);
+}
+
 static void
 gst_jpeg_dec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -1306,6 +1745,9 @@ gst_jpeg_dec_set_property (GObject * object, guint prop_id,
     case PROP_MAX_ERRORS:
       g_atomic_int_set (&dec->max_errors, g_value_get_int (value));
       break;
+    case PROP_N_THREADS:
+      dec->n_threads = g_value_get_uint (value);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1328,6 +1770,9 @@ gst_jpeg_dec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_ERRORS:
       g_value_set_int (value, g_atomic_int_get (&dec->max_errors));
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, dec->n_threads);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1339,8 +1784,20 @@ static gboolean
 gst_jpeg_dec_stop (GstVideoDecoder * bdec)
 {
   GstJpegDec *dec = (GstJpegDec *) bdec;
+  guint i;
+
+  gst_jpeg_dec_free_buffers (&dec->ctx);
+
+  if (dec->batch) {
+    gst_work_batch_free (dec->batch);
+    dec->batch = NULL;
+  }
 
-  gst_jpeg_dec_free_buffers (dec);
+  for (i = 0; i < dec->n_contexts; i++)
+    gst_jpeg_dec_context_clear (&dec->contexts[i]);
+  g_free (dec->contexts);
+  dec->contexts = NULL;
+  dec->n_contexts = 0;
 
   return TRUE;
 }
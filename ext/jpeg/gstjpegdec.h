@@ -37,6 +37,8 @@
 #include <stdio.h>
 #include <jpeglib.h>
 
+#include <gst/workers/gstworkbatch.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_JPEG_DEC \
@@ -52,6 +54,8 @@ G_BEGIN_DECLS
 
 typedef struct _GstJpegDec           GstJpegDec;
 typedef struct _GstJpegDecClass      GstJpegDecClass;
+typedef struct _GstJpegDecContext    GstJpegDecContext;
+typedef struct _GstJpegDecJob        GstJpegDecJob;
 
 struct GstJpegDecErrorMgr {
   struct jpeg_error_mgr    pub;   /* public fields */
@@ -61,6 +65,36 @@ struct GstJpegDecErrorMgr {
 struct GstJpegDecSourceMgr {
   struct jpeg_source_mgr   pub;   /* public fields */
   GstJpegDec              *dec;
+  const guint8            *data;  /* the image that is decoded */
+  gsize                    size;
+};
+
+/* a libjpeg decompressor with its buffers. The streaming thread uses the
+ * one of the element, every worker thread has its own */
+struct _GstJpegDecContext {
+  struct jpeg_decompress_struct cinfo;
+  struct GstJpegDecErrorMgr     jerr;
+  struct GstJpegDecSourceMgr    jsrc;
+
+  /* arrays for indirect decoding */
+  gboolean idr_width_allocated;
+  guchar *idr_y[16],*idr_u[16],*idr_v[16];
+
+  /* the image of a band of MCU rows, when decoding with restart slices */
+  GByteArray *slice;
+  guint       slice_y;
+  guint       slice_height;
+
+  /* result of the work of a worker thread */
+  gboolean    failed;
+};
+
+/* a frame that waits to be decoded in parallel with other frames */
+struct _GstJpegDecJob {
+  GstVideoCodecFrame *frame;
+  GstMapInfo          map;
+  GstVideoFrame       vframe;
+  gboolean            failed;
 };
 
 /* Can't use GstBaseTransform, because GstBaseTransform
@@ -71,6 +105,7 @@ struct _GstJpegDec {
 
   /* negotiated state */
   GstVideoCodecState *input_state;
+  GstVideoFormat      wanted_format;  /* for the subsampling of the image */
   GstVideoCodecFrame *current_frame;
   GstMapInfo current_frame_map;
 
@@ -83,13 +118,16 @@ struct _GstJpegDec {
   gint     idct_method;
   gint     max_errors;  /* ATOMIC */
 
-  struct jpeg_decompress_struct cinfo;
-  struct GstJpegDecErrorMgr     jerr;
-  struct GstJpegDecSourceMgr    jsrc;
+  guint    n_threads;
+
+  GstJpegDecContext ctx;
+
+  /* the batch of frames that are decoded together when the images can't
+   * be split in slices, and a decompressor for every one of its threads */
+  GstWorkBatch      *batch;
+  GstJpegDecContext *contexts;
+  guint              n_contexts;
 
-  /* arrays for indirect decoding */
-  gboolean idr_width_allocated;
-  guchar *idr_y[16],*idr_u[16],*idr_v[16];
   /* current (parsed) image size */
   guint    rem_img_len;
 };
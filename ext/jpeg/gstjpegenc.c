@@ -54,6 +54,7 @@ GST_DEBUG_CATEGORY_STATIC (jpegenc_debug);
 #define JPEG_DEFAULT_QUALITY 85
 #define JPEG_DEFAULT_SMOOTHING 0
 #define JPEG_DEFAULT_IDCT_METHOD	JDCT_FASTEST
+#define DEFAULT_N_THREADS 1
 
 /* JpegEnc signals and args */
 enum
@@ -67,7 +68,8 @@ enum
   PROP_0,
   PROP_QUALITY,
   PROP_SMOOTHING,
-  PROP_IDCT_METHOD
+  PROP_IDCT_METHOD,
+  PROP_N_THREADS
 };
 
 static void gst_jpegenc_finalize (GObject * object);
@@ -84,6 +86,8 @@ static gboolean gst_jpegenc_set_format (GstVideoEncoder * encoder,
     GstVideoCodecState * state);
 static GstFlowReturn gst_jpegenc_handle_frame (GstVideoEncoder * encoder,
     GstVideoCodecFrame * frame);
+static GstFlowReturn gst_jpegenc_finish (GstVideoEncoder * encoder);
+static gboolean gst_jpegenc_flush (GstVideoEncoder * encoder);
 static gboolean gst_jpegenc_propose_allocation (GstVideoEncoder * encoder,
     GstQuery * query);
 
@@ -150,6 +154,21 @@ gst_jpegenc_class_init (GstJpegEncClass * klass)
           JPEG_DEFAULT_IDCT_METHOD,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstJpegEnc:n-threads:
+   *
+   * The number of threads that encode frames. With more than one thread the
+   * frames are encoded in batches of one frame per thread, which adds up to
+   * n-threads - 1 frames of latency. Changes take effect the next time the
+   * element starts.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to encode frames", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_jpegenc_sink_pad_template));
   gst_element_class_add_pad_template (element_class,
@@ -162,6 +181,8 @@ gst_jpegenc_class_init (GstJpegEncClass * klass)
   venc_class->stop = gst_jpegenc_stop;
   venc_class->set_format = gst_jpegenc_set_format;
   venc_class->handle_frame = gst_jpegenc_handle_frame;
+  venc_class->finish = gst_jpegenc_finish;
+  venc_class->flush = gst_jpegenc_flush;
   venc_class->propose_allocation = gst_jpegenc_propose_allocation;
 
   GST_DEBUG_CATEGORY_INIT (jpegenc_debug, "jpegenc", 0,
@@ -175,52 +196,42 @@ gst_jpegenc_init_destination (j_compress_ptr cinfo)
 }
 
 static void
-ensure_memory (GstJpegEnc * jpegenc)
+ensure_memory (GstJpegEncContext * ctx)
 {
   GstMemory *new_memory;
   GstMapInfo map;
-  gsize old_size, desired_size, new_size;
-  guint8 *new_data;
+  gsize old_size, desired_size;
   static GstAllocationParams params = { 0, 3, 0, 0, };
 
-  old_size = jpegenc->output_map.size;
-  if (old_size == 0)
-    desired_size = jpegenc->bufsize;
-  else
-    desired_size = old_size * 2;
-
   /* Our output memory wasn't big enough.
    * Make a new memory that's twice the size, */
+  old_size = ctx->output_map.size;
+  desired_size = old_size * 2;
+
   new_memory = gst_allocator_alloc (NULL, desired_size, &params);
-  gst_memory_map (new_memory, &map, GST_MAP_READWRITE);
-  new_data = map.data;
-  new_size = map.size;
-
-  /* copy previous data if any */
-  if (jpegenc->output_mem) {
-    memcpy (new_data, jpegenc->output_map.data, old_size);
-    gst_memory_unmap (jpegenc->output_mem, &jpegenc->output_map);
-    gst_memory_unref (jpegenc->output_mem);
-  }
+  gst_memory_map (new_memory, &map, GST_MAP_WRITE);
+  memcpy (map.data, ctx->output_map.data, old_size);
+  gst_memory_unmap (new_memory, &map);
 
   /* drop it into place, */
-  jpegenc->output_mem = new_memory;
-  jpegenc->output_map = map;
+  gst_buffer_unmap (ctx->output, &ctx->output_map);
+  gst_buffer_replace_all_memory (ctx->output, new_memory);
+  gst_buffer_map (ctx->output, &ctx->output_map, GST_MAP_READWRITE);
 
   /* and last, update libjpeg on where to work. */
-  jpegenc->jdest.next_output_byte = new_data + old_size;
-  jpegenc->jdest.free_in_buffer = new_size - old_size;
+  ctx->jdest.next_output_byte = ctx->output_map.data + old_size;
+  ctx->jdest.free_in_buffer = ctx->output_map.size - old_size;
 }
 
 static boolean
 gst_jpegenc_flush_destination (j_compress_ptr cinfo)
 {
-  GstJpegEnc *jpegenc = (GstJpegEnc *) (cinfo->client_data);
+  GstJpegEncContext *ctx = (GstJpegEncContext *) (cinfo->client_data);
 
-  GST_DEBUG_OBJECT (jpegenc,
+  GST_DEBUG_OBJECT (ctx->enc,
       "gst_jpegenc_chain: flush_destination: buffer too small");
 
-  ensure_memory (jpegenc);
+  ensure_memory (ctx);
 
   return TRUE;
 }
@@ -228,77 +239,60 @@ gst_jpegenc_flush_destination (j_compress_ptr cinfo)
 static void
 gst_jpegenc_term_destination (j_compress_ptr cinfo)
 {
-  GstBuffer *outbuf;
-  GstJpegEnc *jpegenc = (GstJpegEnc *) (cinfo->client_data);
-  gsize memory_size = jpegenc->output_map.size - jpegenc->jdest.free_in_buffer;
-  GstByteReader reader =
-      GST_BYTE_READER_INIT (jpegenc->output_map.data, memory_size);
-  guint16 marker;
-  gint sof_marker = -1;
-
-  GST_DEBUG_OBJECT (jpegenc, "gst_jpegenc_chain: term_source");
+  GstJpegEncContext *ctx = (GstJpegEncContext *) (cinfo->client_data);
 
-  /* Find the SOF marker */
-  while (gst_byte_reader_get_uint16_be (&reader, &marker)) {
-    /* SOF marker */
-    if (marker >> 4 == 0x0ffc) {
-      sof_marker = marker & 0x4;
-      break;
-    }
-  }
+  GST_DEBUG_OBJECT (ctx->enc, "gst_jpegenc_chain: term_source");
 
-  gst_memory_unmap (jpegenc->output_mem, &jpegenc->output_map);
-  /* Trim the buffer size. we will push it in the chain function */
-  gst_memory_resize (jpegenc->output_mem, 0, memory_size);
-  jpegenc->output_map.data = NULL;
-  jpegenc->output_map.size = 0;
+  ctx->output_size = ctx->output_map.size - ctx->jdest.free_in_buffer;
 
-  if (jpegenc->sof_marker != sof_marker) {
-    GstVideoCodecState *output;
-    output =
-        gst_video_encoder_set_output_state (GST_VIDEO_ENCODER (jpegenc),
-        gst_caps_new_simple ("image/jpeg", "sof-marker", G_TYPE_INT, sof_marker,
-            NULL), jpegenc->input_state);
-    gst_video_codec_state_unref (output);
-    jpegenc->sof_marker = sof_marker;
-  }
+  /* Trim the buffer size. we will push it when all the frames of the batch
+   * are done */
+  gst_buffer_unmap (ctx->output, &ctx->output_map);
+  gst_buffer_set_size (ctx->output, ctx->output_size);
+}
 
-  outbuf = gst_buffer_new ();
-  gst_buffer_copy_into (outbuf, jpegenc->current_frame->input_buffer,
-      GST_BUFFER_COPY_METADATA, 0, -1);
-  gst_buffer_append_memory (outbuf, jpegenc->output_mem);
-  jpegenc->output_mem = NULL;
+static void
+gst_jpegenc_context_init (GstJpegEnc * jpegenc, GstJpegEncContext * ctx)
+{
+  memset (ctx, 0, sizeof (GstJpegEncContext));
 
-  jpegenc->current_frame->output_buffer = outbuf;
+  /* setup jpeglib */
+  ctx->enc = jpegenc;
+  ctx->cinfo.err = jpeg_std_error (&ctx->jerr);
+  jpeg_create_compress (&ctx->cinfo);
+
+  ctx->jdest.init_destination = gst_jpegenc_init_destination;
+  ctx->jdest.empty_output_buffer = gst_jpegenc_flush_destination;
+  ctx->jdest.term_destination = gst_jpegenc_term_destination;
+  ctx->cinfo.dest = &ctx->jdest;
+  ctx->cinfo.client_data = ctx;
+}
 
-  gst_video_frame_unmap (&jpegenc->current_vframe);
+static void
+gst_jpegenc_context_clear (GstJpegEncContext * ctx)
+{
+  gint i, j;
 
-  GST_VIDEO_CODEC_FRAME_SET_SYNC_POINT (jpegenc->current_frame);
+  jpeg_destroy_compress (&ctx->cinfo);
 
-  jpegenc->res = gst_video_encoder_finish_frame (GST_VIDEO_ENCODER (jpegenc),
-      jpegenc->current_frame);
-  jpegenc->current_frame = NULL;
+  for (i = 0; i < 3; i++) {
+    g_free (ctx->line[i]);
+    ctx->line[i] = NULL;
+    for (j = 0; j < 4 * DCTSIZE; j++) {
+      g_free (ctx->row[i][j]);
+      ctx->row[i][j] = NULL;
+    }
+  }
 }
 
 static void
 gst_jpegenc_init (GstJpegEnc * jpegenc)
 {
-  /* setup jpeglib */
-  memset (&jpegenc->cinfo, 0, sizeof (jpegenc->cinfo));
-  memset (&jpegenc->jerr, 0, sizeof (jpegenc->jerr));
-  jpegenc->cinfo.err = jpeg_std_error (&jpegenc->jerr);
-  jpeg_create_compress (&jpegenc->cinfo);
-
-  jpegenc->jdest.init_destination = gst_jpegenc_init_destination;
-  jpegenc->jdest.empty_output_buffer = gst_jpegenc_flush_destination;
-  jpegenc->jdest.term_destination = gst_jpegenc_term_destination;
-  jpegenc->cinfo.dest = &jpegenc->jdest;
-  jpegenc->cinfo.client_data = jpegenc;
-
   /* init properties */
   jpegenc->quality = JPEG_DEFAULT_QUALITY;
   jpegenc->smoothing = JPEG_DEFAULT_SMOOTHING;
   jpegenc->idct_method = JPEG_DEFAULT_IDCT_METHOD;
+  jpegenc->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -306,8 +300,6 @@ gst_jpegenc_finalize (GObject * object)
 {
   GstJpegEnc *filter = GST_JPEGENC (object);
 
-  jpeg_destroy_compress (&filter->cinfo);
-
   if (filter->input_state)
     gst_video_codec_state_unref (filter->input_state);
 
@@ -320,6 +312,10 @@ gst_jpegenc_set_format (GstVideoEncoder * encoder, GstVideoCodecState * state)
   GstJpegEnc *enc = GST_JPEGENC (encoder);
   gint i;
   GstVideoInfo *info = &state->info;
+  GstClockTime latency;
+
+  /* the frames of a batch are encoded in the old format */
+  gst_work_batch_flush (enc->batch);
 
   if (enc->input_state)
     gst_video_codec_state_unref (enc->input_state);
@@ -360,6 +356,12 @@ gst_jpegenc_set_format (GstVideoEncoder * encoder, GstVideoCodecState * state)
 
   gst_jpegenc_resync (enc);
 
+  /* a batch of frames is only pushed when the last one arrived */
+  latency = gst_work_batch_get_latency (enc->batch,
+      GST_VIDEO_INFO_FPS_N (info), GST_VIDEO_INFO_FPS_D (info));
+  if (latency > 0)
+    gst_video_encoder_set_latency (encoder, latency, latency);
+
   return TRUE;
 }
 
@@ -369,6 +371,7 @@ gst_jpegenc_resync (GstJpegEnc * jpegenc)
   GstVideoInfo *info;
   gint width, height;
   gint i, j;
+  guint c;
 
   GST_DEBUG_OBJECT (jpegenc, "resync");
 
@@ -376,106 +379,180 @@ gst_jpegenc_resync (GstJpegEnc * jpegenc)
     return;
 
   info = &jpegenc->input_state->info;
-
-  jpegenc->cinfo.image_width = width = GST_VIDEO_INFO_WIDTH (info);
-  jpegenc->cinfo.image_height = height = GST_VIDEO_INFO_HEIGHT (info);
-  jpegenc->cinfo.input_components = jpegenc->channels;
+  width = GST_VIDEO_INFO_WIDTH (info);
+  height = GST_VIDEO_INFO_HEIGHT (info);
 
   GST_DEBUG_OBJECT (jpegenc, "width %d, height %d", width, height);
   GST_DEBUG_OBJECT (jpegenc, "format %d", GST_VIDEO_INFO_FORMAT (info));
-
-  if (GST_VIDEO_INFO_IS_RGB (info)) {
-    GST_DEBUG_OBJECT (jpegenc, "RGB");
-    jpegenc->cinfo.in_color_space = JCS_RGB;
-  } else if (GST_VIDEO_INFO_IS_GRAY (info)) {
-    GST_DEBUG_OBJECT (jpegenc, "gray");
-    jpegenc->cinfo.in_color_space = JCS_GRAYSCALE;
-  } else {
-    GST_DEBUG_OBJECT (jpegenc, "YUV");
-    jpegenc->cinfo.in_color_space = JCS_YCbCr;
-  }
+  GST_DEBUG_OBJECT (jpegenc, "h_max_samp=%d, v_max_samp=%d",
+      jpegenc->h_max_samp, jpegenc->v_max_samp);
 
   /* input buffer size as max output */
   jpegenc->bufsize = GST_VIDEO_INFO_SIZE (info);
-  jpeg_set_defaults (&jpegenc->cinfo);
-  jpegenc->cinfo.raw_data_in = TRUE;
-  /* duh, libjpeg maps RGB to YUV ... and don't expect some conversion */
-  if (jpegenc->cinfo.in_color_space == JCS_RGB)
-    jpeg_set_colorspace (&jpegenc->cinfo, JCS_RGB);
+  /* guard against a potential error in gst_jpegenc_term_destination
+     which occurs iff bufsize % 4 < free_space_remaining */
+  jpegenc->bufsize = GST_ROUND_UP_4 (jpegenc->bufsize);
+  /* the sizes of the old format say nothing about the new one */
+  jpegenc->avg_size = 0;
+
+  for (c = 0; c < gst_work_batch_get_size (jpegenc->batch); c++) {
+    GstJpegEncContext *ctx = gst_work_batch_get_context (jpegenc->batch, c);
+
+    ctx->cinfo.image_width = width;
+    ctx->cinfo.image_height = height;
+    ctx->cinfo.input_components = jpegenc->channels;
+
+    if (GST_VIDEO_INFO_IS_RGB (info)) {
+      ctx->cinfo.in_color_space = JCS_RGB;
+    } else if (GST_VIDEO_INFO_IS_GRAY (info)) {
+      ctx->cinfo.in_color_space = JCS_GRAYSCALE;
+    } else {
+      ctx->cinfo.in_color_space = JCS_YCbCr;
+    }
 
-  GST_DEBUG_OBJECT (jpegenc, "h_max_samp=%d, v_max_samp=%d",
-      jpegenc->h_max_samp, jpegenc->v_max_samp);
-  /* image dimension info */
-  for (i = 0; i < jpegenc->channels; i++) {
-    GST_DEBUG_OBJECT (jpegenc, "comp %i: h_samp=%d, v_samp=%d", i,
-        jpegenc->h_samp[i], jpegenc->v_samp[i]);
-    jpegenc->cinfo.comp_info[i].h_samp_factor = jpegenc->h_samp[i];
-    jpegenc->cinfo.comp_info[i].v_samp_factor = jpegenc->v_samp[i];
-    g_free (jpegenc->line[i]);
-    jpegenc->line[i] = g_new (guchar *, jpegenc->v_max_samp * DCTSIZE);
-    if (!jpegenc->planar) {
-      for (j = 0; j < jpegenc->v_max_samp * DCTSIZE; j++) {
-        g_free (jpegenc->row[i][j]);
-        jpegenc->row[i][j] = g_malloc (width);
-        jpegenc->line[i][j] = jpegenc->row[i][j];
+    jpeg_set_defaults (&ctx->cinfo);
+    ctx->cinfo.raw_data_in = TRUE;
+    /* duh, libjpeg maps RGB to YUV ... and don't expect some conversion */
+    if (ctx->cinfo.in_color_space == JCS_RGB)
+      jpeg_set_colorspace (&ctx->cinfo, JCS_RGB);
+
+    /* image dimension info */
+    for (i = 0; i < jpegenc->channels; i++) {
+      if (c == 0)
+        GST_DEBUG_OBJECT (jpegenc, "comp %i: h_samp=%d, v_samp=%d", i,
+            jpegenc->h_samp[i], jpegenc->v_samp[i]);
+      ctx->cinfo.comp_info[i].h_samp_factor = jpegenc->h_samp[i];
+      ctx->cinfo.comp_info[i].v_samp_factor = jpegenc->v_samp[i];
+      g_free (ctx->line[i]);
+      ctx->line[i] = g_new (guchar *, jpegenc->v_max_samp * DCTSIZE);
+      if (!jpegenc->planar) {
+        for (j = 0; j < jpegenc->v_max_samp * DCTSIZE; j++) {
+          g_free (ctx->row[i][j]);
+          ctx->row[i][j] = g_malloc (width);
+          ctx->line[i][j] = ctx->row[i][j];
+        }
       }
     }
+
+    jpeg_suppress_tables (&ctx->cinfo, TRUE);
   }
 
-  /* guard against a potential error in gst_jpegenc_term_destination
-     which occurs iff bufsize % 4 < free_space_remaining */
-  jpegenc->bufsize = GST_ROUND_UP_4 (jpegenc->bufsize);
+  GST_DEBUG_OBJECT (jpegenc, "resync done");
+}
 
-  jpeg_suppress_tables (&jpegenc->cinfo, TRUE);
+static void
+gst_jpegenc_release_pool (GstJpegEnc * jpegenc)
+{
+  if (jpegenc->pool) {
+    gst_buffer_pool_set_active (jpegenc->pool, FALSE);
+    gst_object_unref (jpegenc->pool);
+    jpegenc->pool = NULL;
+  }
+}
 
-  GST_DEBUG_OBJECT (jpegenc, "resync done");
+/* make a pool of output buffers of @size bytes, the buffers of the old pool
+ * are freed when they come back */
+static gboolean
+gst_jpegenc_setup_pool (GstJpegEnc * jpegenc, gsize size)
+{
+  static GstAllocationParams params = { 0, 3, 0, 0, };
+  GstBufferPool *pool;
+  GstStructure *config;
+
+  GST_DEBUG_OBJECT (jpegenc, "output buffers of %" G_GSIZE_FORMAT " bytes",
+      size);
+
+  pool = gst_buffer_pool_new ();
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+  if (!gst_buffer_pool_set_config (pool, config))
+    goto config_failed;
+
+  gst_jpegenc_release_pool (jpegenc);
+  jpegenc->pool = pool;
+  jpegenc->pool_size = size;
+
+  /* and activate */
+  if (!gst_buffer_pool_set_active (pool, TRUE))
+    goto activate_failed;
+
+  return TRUE;
+
+  /* ERRORS */
+config_failed:
+  {
+    GST_WARNING_OBJECT (jpegenc, "failed to configure buffer pool");
+    gst_object_unref (pool);
+    return FALSE;
+  }
+activate_failed:
+  {
+    GST_WARNING_OBJECT (jpegenc, "failed to activate buffer pool");
+    gst_jpegenc_release_pool (jpegenc);
+    return FALSE;
+  }
 }
 
+/* get an output buffer for the frame of @ctx. Until the size of the frames
+ * is known they get the size of the raw frame, after that twice the
+ * average, so that libjpeg hardly ever has to grow the buffer */
 static GstFlowReturn
-gst_jpegenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
+gst_jpegenc_acquire_output (GstJpegEnc * jpegenc, GstJpegEncContext * ctx)
 {
-  GstJpegEnc *jpegenc;
-  guint height;
-  guchar *base[3], *end[3];
-  guint stride[3];
-  gint i, j, k;
-  static GstAllocationParams params = { 0, 0, 0, 3, };
+  GstFlowReturn ret;
+  gsize avg = jpegenc->avg_size;
 
-  jpegenc = GST_JPEGENC (encoder);
+  if (jpegenc->pool == NULL ||
+      (avg > 0 && (avg + avg / 4 > jpegenc->pool_size ||
+              avg * 4 < jpegenc->pool_size))) {
+    gsize size = avg > 0 ? GST_ROUND_UP_4 (avg * 2) : jpegenc->bufsize;
 
-  GST_LOG_OBJECT (jpegenc, "got new frame");
+    if (!gst_jpegenc_setup_pool (jpegenc, size))
+      return GST_FLOW_ERROR;
+  }
 
-  if (!gst_video_frame_map (&jpegenc->current_vframe,
-          &jpegenc->input_state->info, frame->input_buffer, GST_MAP_READ))
-    goto invalid_frame;
+  ret = gst_buffer_pool_acquire_buffer (jpegenc->pool, &ctx->output, NULL);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    return ret;
+
+  /* the buffers come back trimmed to the size of their frame */
+  gst_buffer_set_size (ctx->output, jpegenc->pool_size);
+  gst_buffer_map (ctx->output, &ctx->output_map, GST_MAP_READWRITE);
+
+  return GST_FLOW_OK;
+}
 
-  jpegenc->current_frame = frame;
+/* compress the frame of @ctx into its output buffer */
+static void
+gst_jpegenc_encode (GstJpegEnc * jpegenc, GstJpegEncContext * ctx)
+{
+  guint height;
+  guchar *base[3], *end[3];
+  guint stride[3];
+  gint i, j, k;
 
   height = GST_VIDEO_INFO_HEIGHT (&jpegenc->input_state->info);
 
   for (i = 0; i < jpegenc->channels; i++) {
-    base[i] = GST_VIDEO_FRAME_COMP_DATA (&jpegenc->current_vframe, i);
-    stride[i] = GST_VIDEO_FRAME_COMP_STRIDE (&jpegenc->current_vframe, i);
-    end[i] =
-        base[i] + GST_VIDEO_FRAME_COMP_HEIGHT (&jpegenc->current_vframe,
-        i) * stride[i];
+    base[i] = GST_VIDEO_FRAME_COMP_DATA (&ctx->vframe, i);
+    stride[i] = GST_VIDEO_FRAME_COMP_STRIDE (&ctx->vframe, i);
+    end[i] = base[i] + GST_VIDEO_FRAME_COMP_HEIGHT (&ctx->vframe, i) *
+        stride[i];
   }
 
-  jpegenc->res = GST_FLOW_OK;
-  jpegenc->output_mem = gst_allocator_alloc (NULL, jpegenc->bufsize, &params);
-  gst_memory_map (jpegenc->output_mem, &jpegenc->output_map, GST_MAP_READWRITE);
-
-  jpegenc->jdest.next_output_byte = jpegenc->output_map.data;
-  jpegenc->jdest.free_in_buffer = jpegenc->output_map.size;
+  ctx->jdest.next_output_byte = ctx->output_map.data;
+  ctx->jdest.free_in_buffer = ctx->output_map.size;
 
   /* prepare for raw input */
 #if JPEG_LIB_VERSION >= 70
-  jpegenc->cinfo.do_fancy_downsampling = FALSE;
+  ctx->cinfo.do_fancy_downsampling = FALSE;
 #endif
-  jpegenc->cinfo.smoothing_factor = jpegenc->smoothing;
-  jpegenc->cinfo.dct_method = jpegenc->idct_method;
-  jpeg_set_quality (&jpegenc->cinfo, jpegenc->quality, TRUE);
-  jpeg_start_compress (&jpegenc->cinfo, TRUE);
+  ctx->cinfo.smoothing_factor = jpegenc->smoothing;
+  ctx->cinfo.dct_method = jpegenc->idct_method;
+  jpeg_set_quality (&ctx->cinfo, jpegenc->quality, TRUE);
+  jpeg_start_compress (&ctx->cinfo, TRUE);
 
   GST_LOG_OBJECT (jpegenc, "compressing");
 
@@ -483,12 +560,12 @@ gst_jpegenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
     for (i = 0; i < height; i += jpegenc->v_max_samp * DCTSIZE) {
       for (k = 0; k < jpegenc->channels; k++) {
         for (j = 0; j < jpegenc->v_samp[k] * DCTSIZE; j++) {
-          jpegenc->line[k][j] = base[k];
+          ctx->line[k][j] = base[k];
           if (base[k] + stride[k] < end[k])
             base[k] += stride[k];
         }
       }
-      jpeg_write_raw_data (&jpegenc->cinfo, jpegenc->line,
+      jpeg_write_raw_data (&ctx->cinfo, ctx->line,
           jpegenc->v_max_samp * DCTSIZE);
     }
   } else {
@@ -500,7 +577,7 @@ gst_jpegenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
 
           /* ouch, copy line */
           src = base[k];
-          dst = jpegenc->line[k][j];
+          dst = ctx->line[k][j];
           for (l = jpegenc->cwidth[k]; l > 0; l--) {
             *dst = *src;
             src += jpegenc->inc[k];
@@ -510,22 +587,148 @@ gst_jpegenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
             base[k] += stride[k];
         }
       }
-      jpeg_write_raw_data (&jpegenc->cinfo, jpegenc->line,
+      jpeg_write_raw_data (&ctx->cinfo, ctx->line,
           jpegenc->v_max_samp * DCTSIZE);
     }
   }
 
   /* This will ensure that gst_jpegenc_term_destination is called */
-  jpeg_finish_compress (&jpegenc->cinfo);
+  jpeg_finish_compress (&ctx->cinfo);
   GST_LOG_OBJECT (jpegenc, "compressing done");
+}
+
+/* encode the frame of @context, on one of the worker threads */
+static void
+gst_jpegenc_encode_job (gpointer data, gpointer context, guint index)
+{
+  gst_jpegenc_encode (GST_JPEGENC (data), context);
+}
+
+/* push the encoded frame of @context */
+static GstFlowReturn
+gst_jpegenc_finish_job (gpointer data, gpointer context)
+{
+  GstJpegEnc *jpegenc = data;
+  GstJpegEncContext *ctx = context;
+  GstVideoCodecFrame *frame = ctx->frame;
+  GstByteReader reader;
+  GstMapInfo map;
+  guint16 marker;
+  gint sof_marker = -1;
+
+  gst_video_frame_unmap (&ctx->vframe);
+
+  /* Find the SOF marker */
+  gst_buffer_map (ctx->output, &map, GST_MAP_READ);
+  gst_byte_reader_init (&reader, map.data, map.size);
+  while (gst_byte_reader_get_uint16_be (&reader, &marker)) {
+    /* SOF marker */
+    if (marker >> 4 == 0x0ffc) {
+      sof_marker = marker & 0x4;
+      break;
+    }
+  }
+  gst_buffer_unmap (ctx->output, &map);
+
+  if (jpegenc->sof_marker != sof_marker) {
+    GstVideoCodecState *output;
+    output =
+        gst_video_encoder_set_output_state (GST_VIDEO_ENCODER (jpegenc),
+        gst_caps_new_simple ("image/jpeg", "sof-marker", G_TYPE_INT, sof_marker,
+            NULL), jpegenc->input_state);
+    gst_video_codec_state_unref (output);
+    jpegenc->sof_marker = sof_marker;
+  }
+
+  /* running average of the frame size for the size of the pool */
+  if (jpegenc->avg_size == 0)
+    jpegenc->avg_size = ctx->output_size;
+  else
+    jpegenc->avg_size = (jpegenc->avg_size * 7 + ctx->output_size) / 8;
+
+  gst_buffer_copy_into (ctx->output, frame->input_buffer,
+      GST_BUFFER_COPY_METADATA, 0, -1);
+  frame->output_buffer = ctx->output;
+  ctx->output = NULL;
+  ctx->frame = NULL;
 
-  return jpegenc->res;
+  GST_VIDEO_CODEC_FRAME_SET_SYNC_POINT (frame);
+
+  return gst_video_encoder_finish_frame (GST_VIDEO_ENCODER (jpegenc), frame);
+}
+
+/* forget the frame of @context, it was not encoded */
+static void
+gst_jpegenc_clear_job (gpointer data, gpointer context)
+{
+  GstJpegEncContext *ctx = context;
+
+  gst_video_frame_unmap (&ctx->vframe);
+  gst_buffer_unmap (ctx->output, &ctx->output_map);
+  gst_buffer_unref (ctx->output);
+  ctx->output = NULL;
+  gst_video_codec_frame_unref (ctx->frame);
+  ctx->frame = NULL;
+}
+
+static GstFlowReturn
+gst_jpegenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
+{
+  GstJpegEnc *jpegenc;
+  GstJpegEncContext *ctx;
+  GstFlowReturn ret;
+
+  jpegenc = GST_JPEGENC (encoder);
+
+  GST_LOG_OBJECT (jpegenc, "got new frame");
+
+  ctx = gst_work_batch_peek (jpegenc->batch);
+
+  if (!gst_video_frame_map (&ctx->vframe, &jpegenc->input_state->info,
+          frame->input_buffer, GST_MAP_READ))
+    goto invalid_frame;
+
+  ret = gst_jpegenc_acquire_output (jpegenc, ctx);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto no_output;
+
+  ctx->frame = frame;
+
+  return gst_work_batch_queue (jpegenc->batch);
 
 invalid_frame:
   {
     GST_WARNING_OBJECT (jpegenc, "invalid frame received");
+    /* keep the frames in order */
+    gst_work_batch_flush (jpegenc->batch);
     return gst_video_encoder_finish_frame (encoder, frame);
   }
+no_output:
+  {
+    GST_DEBUG_OBJECT (jpegenc, "no output buffer, reason %s",
+        gst_flow_get_name (ret));
+    gst_video_frame_unmap (&ctx->vframe);
+    gst_video_codec_frame_unref (frame);
+    return ret;
+  }
+}
+
+static GstFlowReturn
+gst_jpegenc_finish (GstVideoEncoder * encoder)
+{
+  GstJpegEnc *jpegenc = GST_JPEGENC (encoder);
+
+  return gst_work_batch_flush (jpegenc->batch);
+}
+
+static gboolean
+gst_jpegenc_flush (GstVideoEncoder * encoder)
+{
+  GstJpegEnc *jpegenc = GST_JPEGENC (encoder);
+
+  gst_work_batch_clear (jpegenc->batch);
+
+  return TRUE;
 }
 
 static gboolean
@@ -557,6 +760,9 @@ gst_jpegenc_set_property (GObject * object, guint prop_id,
     case PROP_IDCT_METHOD:
       jpegenc->idct_method = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      jpegenc->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -585,6 +791,9 @@ gst_jpegenc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_IDCT_METHOD:
       g_value_set_enum (value, jpegenc->idct_method);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, jpegenc->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -597,12 +806,21 @@ static gboolean
 gst_jpegenc_start (GstVideoEncoder * benc)
 {
   GstJpegEnc *enc = (GstJpegEnc *) benc;
+  guint i, n;
 
-  enc->line[0] = NULL;
-  enc->line[1] = NULL;
-  enc->line[2] = NULL;
   enc->sof_marker = -1;
 
+  enc->batch = gst_work_batch_new (enc->n_threads, sizeof (GstJpegEncContext),
+      gst_jpegenc_encode_job, gst_jpegenc_finish_job, gst_jpegenc_clear_job,
+      enc);
+  n = gst_work_batch_get_size (enc->batch);
+  GST_DEBUG_OBJECT (enc, "encoding with %u threads", n);
+  for (i = 0; i < n; i++)
+    gst_jpegenc_context_init (enc, gst_work_batch_get_context (enc->batch, i));
+
+  /* the contexts need the image description of the current format */
+  gst_jpegenc_resync (enc);
+
   return TRUE;
 }
 
@@ -610,20 +828,18 @@ static gboolean
 gst_jpegenc_stop (GstVideoEncoder * benc)
 {
   GstJpegEnc *enc = (GstJpegEnc *) benc;
-  gint i, j;
-
-  g_free (enc->line[0]);
-  g_free (enc->line[1]);
-  g_free (enc->line[2]);
-  enc->line[0] = NULL;
-  enc->line[1] = NULL;
-  enc->line[2] = NULL;
-  for (i = 0; i < 3; i++) {
-    for (j = 0; j < 4 * DCTSIZE; j++) {
-      g_free (enc->row[i][j]);
-      enc->row[i][j] = NULL;
-    }
+  guint i;
+
+  if (enc->batch) {
+    gst_work_batch_clear (enc->batch);
+    for (i = 0; i < gst_work_batch_get_size (enc->batch); i++)
+      gst_jpegenc_context_clear (gst_work_batch_get_context (enc->batch, i));
+    gst_work_batch_free (enc->batch);
+    enc->batch = NULL;
   }
 
+  gst_jpegenc_release_pool (enc);
+  enc->avg_size = 0;
+
   return TRUE;
 }
@@ -34,6 +34,8 @@
 #include <stdio.h>
 #include <jpeglib.h>
 
+#include <gst/workers/gstworkbatch.h>
+
 G_BEGIN_DECLS
 #define GST_TYPE_JPEGENC \
   (gst_jpegenc_get_type())
@@ -48,15 +50,37 @@ G_BEGIN_DECLS
 
 typedef struct _GstJpegEnc GstJpegEnc;
 typedef struct _GstJpegEncClass GstJpegEncClass;
+typedef struct _GstJpegEncContext GstJpegEncContext;
+
+/* a libjpeg compressor with the frame it encodes. Without worker threads
+ * there is only one */
+struct _GstJpegEncContext
+{
+  GstJpegEnc *enc;
+
+  struct jpeg_compress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  struct jpeg_destination_mgr jdest;
+
+  /* the jpeg line buffer */
+  guchar **line[3];
+  /* indirect encoding line buffers */
+  guchar *row[3][4 * DCTSIZE];
+
+  GstVideoCodecFrame *frame;
+  GstVideoFrame vframe;
+
+  /* the output buffer from the pool and the bytes written to it */
+  GstBuffer *output;
+  GstMapInfo output_map;
+  gsize output_size;
+};
 
 struct _GstJpegEnc
 {
   GstVideoEncoder encoder;
 
   GstVideoCodecState *input_state;
-  GstVideoFrame current_vframe;
-  GstVideoCodecFrame *current_frame;
-  GstFlowReturn res;
 
   guint channels;
 
@@ -71,22 +95,21 @@ struct _GstJpegEnc
   gint sof_marker;
   /* the video buffer */
   gint bufsize;
-  /* the jpeg line buffer */
-  guchar **line[3];
-  /* indirect encoding line buffers */
-  guchar *row[3][4 * DCTSIZE];
 
-  struct jpeg_compress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  struct jpeg_destination_mgr jdest;
+  /* the compressors, when there are worker threads the frames are encoded
+   * in batches of one frame per thread */
+  GstWorkBatch *batch;
+
+  /* output buffers, their size follows the average size of the frames */
+  GstBufferPool *pool;
+  gsize pool_size;
+  gsize avg_size;
 
   /* properties */
   gint quality;
   gint smoothing;
   gint idct_method;
-
-  GstMemory *output_mem;
-  GstMapInfo output_map;
+  guint n_threads;
 };
 
 struct _GstJpegEncClass
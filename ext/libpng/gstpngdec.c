@@ -110,7 +110,9 @@ gst_pngdec_init (GstPngDec * pngdec)
 
   pngdec->color_type = -1;
 
-  pngdec->image_ready = FALSE;
+  pngdec->rows = NULL;
+  pngdec->n_rows = 0;
+  pngdec->output_mapped = FALSE;
 }
 
 static void
@@ -125,32 +127,6 @@ user_warning_fn (png_structp png_ptr, png_const_charp warning_msg)
   GST_WARNING ("%s", warning_msg);
 }
 
-static void
-user_info_callback (png_structp png_ptr, png_infop info)
-{
-  GstPngDec *pngdec = NULL;
-  GstFlowReturn ret = GST_FLOW_OK;
-
-  GST_LOG ("info ready");
-
-  pngdec = GST_PNGDEC (png_get_io_ptr (png_ptr));
-  /* Generate the caps and configure */
-  ret = gst_pngdec_caps_create_and_set (pngdec);
-  if (ret != GST_FLOW_OK) {
-    goto beach;
-  }
-
-  /* Allocate output buffer */
-  ret =
-      gst_video_decoder_allocate_output_frame (GST_VIDEO_DECODER (pngdec),
-      pngdec->current_frame);
-  if (G_UNLIKELY (ret != GST_FLOW_OK))
-    GST_DEBUG_OBJECT (pngdec, "failed to acquire buffer");
-
-beach:
-  pngdec->ret = ret;
-}
-
 static gboolean
 gst_pngdec_set_format (GstVideoDecoder * decoder, GstVideoCodecState * state)
 {
@@ -171,65 +147,27 @@ gst_pngdec_set_format (GstVideoDecoder * decoder, GstVideoCodecState * state)
   return TRUE;
 }
 
+/* libpng reads the image straight from the mapped input frame */
 static void
-user_endrow_callback (png_structp png_ptr, png_bytep new_row,
-    png_uint_32 row_num, int pass)
-{
-  GstPngDec *pngdec = NULL;
-
-  pngdec = GST_PNGDEC (png_get_io_ptr (png_ptr));
-
-  /* FIXME: implement interlaced pictures */
-
-  /* If buffer_out doesn't exist, it means buffer_alloc failed, which 
-   * will already have set the return code */
-  if (GST_IS_BUFFER (pngdec->current_frame->output_buffer)) {
-    GstVideoFrame frame;
-    GstBuffer *buffer = pngdec->current_frame->output_buffer;
-    size_t offset;
-    gint width;
-    guint8 *data;
-
-    if (!gst_video_frame_map (&frame, &pngdec->output_state->info, buffer,
-            GST_MAP_WRITE)) {
-      pngdec->ret = GST_FLOW_ERROR;
-      return;
-    }
-
-    data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
-    offset = row_num * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
-    GST_LOG ("got row %u, copying in buffer %p at offset %" G_GSIZE_FORMAT,
-        (guint) row_num, pngdec->current_frame->output_buffer, offset);
-    width = GST_ROUND_UP_4 (png_get_rowbytes (pngdec->png, pngdec->info));
-    memcpy (data + offset, new_row, width);
-    gst_video_frame_unmap (&frame);
-    pngdec->ret = GST_FLOW_OK;
-  }
-}
-
-static void
-user_end_callback (png_structp png_ptr, png_infop info)
+user_read_data (png_structp png_ptr, png_bytep data, png_size_t length)
 {
-  GstPngDec *pngdec = NULL;
+  GstPngDec *pngdec;
+  GstMapInfo *map;
 
   pngdec = GST_PNGDEC (png_get_io_ptr (png_ptr));
+  map = &pngdec->current_frame_map;
 
-  GST_LOG_OBJECT (pngdec, "and we are done reading this image");
+  if (pngdec->read_offset + length > map->size) {
+    png_error (png_ptr, "Not enough data in the frame");
 
-  if (!pngdec->current_frame->output_buffer)
+    /* never reached */
     return;
+  }
 
-  gst_buffer_unmap (pngdec->current_frame->input_buffer,
-      &pngdec->current_frame_map);
-
-  pngdec->ret =
-      gst_video_decoder_finish_frame (GST_VIDEO_DECODER (pngdec),
-      pngdec->current_frame);
-
-  pngdec->image_ready = TRUE;
+  memcpy (data, map->data + pngdec->read_offset, length);
+  pngdec->read_offset += length;
 }
 
-
 static GstFlowReturn
 gst_pngdec_caps_create_and_set (GstPngDec * pngdec)
 {
@@ -286,6 +224,9 @@ gst_pngdec_caps_create_and_set (GstPngDec * pngdec)
     png_set_palette_to_rgb (pngdec->png);
   }
 
+  /* let png_read_image() combine the passes of interlaced images */
+  png_set_interlace_handling (pngdec->png);
+
   /* Update the info structure */
   png_read_update_info (pngdec->png, pngdec->info);
 
@@ -357,10 +298,20 @@ gst_pngdec_handle_frame (GstVideoDecoder * decoder, GstVideoCodecFrame * frame)
 {
   GstPngDec *pngdec = (GstPngDec *) decoder;
   GstFlowReturn ret = GST_FLOW_OK;
+  guint8 *data;
+  gint i, height, stride;
 
   GST_LOG_OBJECT (pngdec, "Got buffer, size=%u",
       (guint) gst_buffer_get_size (frame->input_buffer));
 
+  /* the frame holds a complete image */
+  if (!gst_buffer_map (frame->input_buffer, &pngdec->current_frame_map,
+          GST_MAP_READ)) {
+    GST_WARNING_OBJECT (pngdec, "Failed to map input buffer");
+    return GST_FLOW_ERROR;
+  }
+  pngdec->read_offset = 0;
+
   /* Let libpng come back here on error */
   if (setjmp (png_jmpbuf (pngdec->png))) {
     GST_WARNING_OBJECT (pngdec, "error during decoding");
@@ -368,34 +319,57 @@ gst_pngdec_handle_frame (GstVideoDecoder * decoder, GstVideoCodecFrame * frame)
     goto beach;
   }
 
-  pngdec->current_frame = frame;
+  png_read_info (pngdec->png, pngdec->info);
 
-  /* Progressive loading of the PNG image */
-  if (!gst_buffer_map (frame->input_buffer, &pngdec->current_frame_map,
-          GST_MAP_READ)) {
-    GST_WARNING_OBJECT (pngdec, "Failed to map input buffer");
-    ret = GST_FLOW_ERROR;
+  /* Generate the caps and configure */
+  ret = gst_pngdec_caps_create_and_set (pngdec);
+  if (ret != GST_FLOW_OK)
+    goto beach;
+
+  /* Allocate output buffer */
+  ret = gst_video_decoder_allocate_output_frame (decoder, frame);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    GST_DEBUG_OBJECT (pngdec, "failed to acquire buffer");
     goto beach;
   }
 
-  png_process_data (pngdec->png, pngdec->info,
-      pngdec->current_frame_map.data, pngdec->current_frame_map.size);
-
-  if (pngdec->image_ready) {
-    /* Reset ourselves for the next frame */
-    gst_pngdec_flush (decoder);
-    GST_LOG_OBJECT (pngdec, "setting up callbacks for next frame");
-    png_set_progressive_read_fn (pngdec->png, pngdec,
-        user_info_callback, user_endrow_callback, user_end_callback);
-    pngdec->image_ready = FALSE;
-  } else {
-    /* An error happened and we have to unmap */
-    gst_buffer_unmap (pngdec->current_frame->input_buffer,
-        &pngdec->current_frame_map);
+  if (!gst_video_frame_map (&pngdec->output_frame,
+          &pngdec->output_state->info, frame->output_buffer, GST_MAP_WRITE)) {
+    ret = GST_FLOW_ERROR;
+    goto beach;
+  }
+  pngdec->output_mapped = TRUE;
+
+  /* point libpng at the rows of the output buffer so that it decodes
+   * straight into it */
+  data = GST_VIDEO_FRAME_COMP_DATA (&pngdec->output_frame, 0);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&pngdec->output_frame, 0);
+  height = GST_VIDEO_FRAME_HEIGHT (&pngdec->output_frame);
+  if (pngdec->n_rows < height) {
+    g_free (pngdec->rows);
+    pngdec->rows = g_new (png_bytep, height);
+    pngdec->n_rows = height;
   }
+  for (i = 0; i < height; i++)
+    pngdec->rows[i] = data + i * stride;
+
+  png_read_image (pngdec->png, pngdec->rows);
+  png_read_end (pngdec->png, pngdec->endinfo);
+
+  GST_LOG_OBJECT (pngdec, "and we are done reading this image");
 
-  ret = pngdec->ret;
 beach:
+  if (pngdec->output_mapped) {
+    gst_video_frame_unmap (&pngdec->output_frame);
+    pngdec->output_mapped = FALSE;
+  }
+  gst_buffer_unmap (frame->input_buffer, &pngdec->current_frame_map);
+
+  /* Reset ourselves for the next frame */
+  gst_pngdec_flush (decoder);
+
+  if (ret == GST_FLOW_OK)
+    ret = gst_video_decoder_finish_frame (decoder, frame);
 
   return ret;
 }
@@ -540,8 +514,7 @@ gst_pngdec_libpng_init (GstPngDec * pngdec)
   if (pngdec->endinfo == NULL)
     goto endinfo_failed;
 
-  png_set_progressive_read_fn (pngdec->png, pngdec,
-      user_info_callback, user_endrow_callback, user_end_callback);
+  png_set_read_fn (pngdec->png, pngdec, user_read_data);
 
   return TRUE;
 
@@ -610,6 +583,10 @@ gst_pngdec_stop (GstVideoDecoder * decoder)
 
   gst_pngdec_libpng_clear (pngdec);
 
+  g_free (pngdec->rows);
+  pngdec->rows = NULL;
+  pngdec->n_rows = 0;
+
   if (pngdec->input_state) {
     gst_video_codec_state_unref (pngdec->input_state);
     pngdec->input_state = NULL;
@@ -24,6 +24,7 @@
 #define __GST_PNGDEC_H__
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
 #include <gst/video/gstvideodecoder.h>
 #include <png.h>
 
@@ -45,17 +46,19 @@ struct _GstPngDec
   GstVideoCodecState *input_state;
   GstVideoCodecState *output_state;
   GstMapInfo current_frame_map;
-  GstVideoCodecFrame *current_frame;
+  gsize read_offset;
 
-  GstFlowReturn ret;
+  /* the output frame libpng decodes into */
+  GstVideoFrame output_frame;
+  gboolean output_mapped;
+  png_bytep *rows;
+  gint n_rows;
 
   png_structp png;
   png_infop info;
   png_infop endinfo;
 
   gint color_type;
-
-  gboolean image_ready;
 };
 
 struct _GstPngDecClass
@@ -47,14 +47,72 @@ enum
 
 #define DEFAULT_SNAPSHOT                FALSE
 #define DEFAULT_COMPRESSION_LEVEL       6
+#define DEFAULT_COMPRESSION_STRATEGY    Z_DEFAULT_STRATEGY
+#define DEFAULT_FILTER                  PNG_FILTER_NONE
+#define DEFAULT_N_THREADS               1
 
 enum
 {
   ARG_0,
   ARG_SNAPSHOT,
-  ARG_COMPRESSION_LEVEL
+  ARG_COMPRESSION_LEVEL,
+  ARG_COMPRESSION_STRATEGY,
+  ARG_FILTER,
+  ARG_N_THREADS
 };
 
+#define GST_TYPE_PNGENC_COMPRESSION_STRATEGY \
+    (gst_pngenc_compression_strategy_get_type())
+static GType
+gst_pngenc_compression_strategy_get_type (void)
+{
+  static const GEnumValue values[] = {
+    {Z_DEFAULT_STRATEGY, "Default deflate strategy", "default"},
+    {Z_FILTERED, "Tuned for filtered data", "filtered"},
+    {Z_HUFFMAN_ONLY, "Huffman coding only, no string matching",
+        "huffman-only"},
+    {Z_RLE, "Only match runs of the same byte", "rle"},
+    {Z_FIXED, "Fixed Huffman codes", "fixed"},
+    {0, NULL, NULL}
+  };
+  static volatile GType id = 0;
+
+  if (g_once_init_enter ((gsize *) & id)) {
+    GType _id;
+
+    _id = g_enum_register_static ("GstPngEncCompressionStrategy", values);
+
+    g_once_init_leave ((gsize *) & id, _id);
+  }
+
+  return id;
+}
+
+#define GST_TYPE_PNGENC_FILTER (gst_pngenc_filter_get_type())
+static GType
+gst_pngenc_filter_get_type (void)
+{
+  static const GFlagsValue values[] = {
+    {PNG_FILTER_NONE, "No filter", "none"},
+    {PNG_FILTER_SUB, "Difference to the left pixel", "sub"},
+    {PNG_FILTER_UP, "Difference to the pixel above", "up"},
+    {PNG_FILTER_AVG, "Difference to the average of left and above", "avg"},
+    {PNG_FILTER_PAETH, "Paeth predictor", "paeth"},
+    {0, NULL, NULL}
+  };
+  static volatile GType id = 0;
+
+  if (g_once_init_enter ((gsize *) & id)) {
+    GType _id;
+
+    _id = g_flags_register_static ("GstPngEncFilter", values);
+
+    g_once_init_leave ((gsize *) & id, _id);
+  }
+
+  return id;
+}
+
 static GstStaticPadTemplate pngenc_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -79,8 +137,16 @@ static void gst_pngenc_set_property (GObject * object,
 static void gst_pngenc_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
 
+static gboolean gst_pngenc_start (GstVideoEncoder * encoder);
+static gboolean gst_pngenc_stop (GstVideoEncoder * encoder);
 static GstFlowReturn gst_pngenc_handle_frame (GstVideoEncoder * encoder,
     GstVideoCodecFrame * frame);
+static GstFlowReturn gst_pngenc_finish (GstVideoEncoder * encoder);
+static gboolean gst_pngenc_flush (GstVideoEncoder * encoder);
+static void gst_pngenc_encode_job (gpointer data, gpointer context,
+    guint index);
+static GstFlowReturn gst_pngenc_finish_job (gpointer data, gpointer context);
+static void gst_pngenc_clear_job (gpointer data, gpointer context);
 static gboolean gst_pngenc_set_format (GstVideoEncoder * encoder,
     GstVideoCodecState * state);
 static gboolean gst_pngenc_propose_allocation (GstVideoEncoder * encoder,
@@ -128,6 +194,50 @@ gst_pngenc_class_init (GstPngEncClass * klass)
           DEFAULT_COMPRESSION_LEVEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPngEnc:compression-strategy:
+   *
+   * The zlib strategy used to compress the filtered rows. rle and
+   * huffman-only are a lot faster than the default and often compress
+   * screen content about as well.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_COMPRESSION_STRATEGY,
+      g_param_spec_enum ("compression-strategy", "Compression strategy",
+          "zlib compression strategy", GST_TYPE_PNGENC_COMPRESSION_STRATEGY,
+          DEFAULT_COMPRESSION_STRATEGY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPngEnc:filter:
+   *
+   * The row filters libpng may use. With more than one filter libpng picks
+   * one for every row, which costs time but usually compresses better.
+   * none and sub are cheap and suit screen content.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_FILTER,
+      g_param_spec_flags ("filter", "Filter",
+          "Row filters to choose from", GST_TYPE_PNGENC_FILTER,
+          DEFAULT_FILTER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPngEnc:n-threads:
+   *
+   * The number of threads that encode frames. With more than one thread the
+   * frames are encoded in batches of one frame per thread, which adds up to
+   * n-threads - 1 frames of latency. Changes take effect the next time the
+   * element starts.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to encode frames", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template
       (element_class, gst_static_pad_template_get (&pngenc_sink_template));
   gst_element_class_add_pad_template
@@ -137,8 +247,12 @@ gst_pngenc_class_init (GstPngEncClass * klass)
       "Encode a video frame to a .png image",
       "Jeremy SIMON <jsimon13@yahoo.fr>");
 
+  venc_class->start = gst_pngenc_start;
+  venc_class->stop = gst_pngenc_stop;
   venc_class->set_format = gst_pngenc_set_format;
   venc_class->handle_frame = gst_pngenc_handle_frame;
+  venc_class->finish = gst_pngenc_finish;
+  venc_class->flush = gst_pngenc_flush;
   venc_class->propose_allocation = gst_pngenc_propose_allocation;
   gobject_class->finalize = gst_pngenc_finalize;
 
@@ -153,10 +267,14 @@ gst_pngenc_set_format (GstVideoEncoder * encoder, GstVideoCodecState * state)
   gboolean ret = TRUE;
   GstVideoInfo *info;
   GstVideoCodecState *output_state;
+  GstClockTime latency;
 
   pngenc = GST_PNGENC (encoder);
   info = &state->info;
 
+  /* the frames of a batch are encoded in the old format */
+  gst_work_batch_flush (pngenc->batch);
+
   switch (GST_VIDEO_INFO_FORMAT (info)) {
     case GST_VIDEO_FORMAT_RGBA:
       pngenc->png_color_type = PNG_COLOR_TYPE_RGBA;
@@ -191,6 +309,12 @@ gst_pngenc_set_format (GstVideoEncoder * encoder, GstVideoCodecState * state)
       gst_caps_new_empty_simple ("image/png"), state);
   gst_video_codec_state_unref (output_state);
 
+  /* a batch of frames is only pushed when the last one arrived */
+  latency = gst_work_batch_get_latency (pngenc->batch,
+      GST_VIDEO_INFO_FPS_N (info), GST_VIDEO_INFO_FPS_D (info));
+  if (latency > 0)
+    gst_video_encoder_set_latency (encoder, latency, latency);
+
 done:
 
   return ret;
@@ -200,11 +324,11 @@ static void
 gst_pngenc_init (GstPngEnc * pngenc)
 {
   /* init settings */
-  pngenc->png_struct_ptr = NULL;
-  pngenc->png_info_ptr = NULL;
-
   pngenc->snapshot = DEFAULT_SNAPSHOT;
   pngenc->compression_level = DEFAULT_COMPRESSION_LEVEL;
+  pngenc->compression_strategy = DEFAULT_COMPRESSION_STRATEGY;
+  pngenc->filter = DEFAULT_FILTER;
+  pngenc->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -226,11 +350,13 @@ user_flush_data (png_structp png_ptr G_GNUC_UNUSED)
 static void
 user_write_data (png_structp png_ptr, png_bytep data, png_uint_32 length)
 {
+  GstPngEncContext *ctx;
   GstPngEnc *pngenc;
   GstMemory *mem;
   GstMapInfo minfo;
 
-  pngenc = (GstPngEnc *) png_get_io_ptr (png_ptr);
+  ctx = (GstPngEncContext *) png_get_io_ptr (png_ptr);
+  pngenc = ctx->enc;
 
   mem = gst_allocator_alloc (NULL, length, NULL);
   if (!mem) {
@@ -254,44 +380,84 @@ user_write_data (png_structp png_ptr, png_bytep data, png_uint_32 length)
   memcpy (minfo.data, data, length);
   gst_memory_unmap (mem, &minfo);
 
-  gst_buffer_append_memory (pngenc->buffer_out, mem);
+  gst_buffer_append_memory (ctx->output, mem);
 }
 
-static GstFlowReturn
-gst_pngenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
+static gboolean
+gst_pngenc_start (GstVideoEncoder * encoder)
+{
+  GstPngEnc *pngenc = GST_PNGENC (encoder);
+  GstPngEncContext *ctx;
+  guint i, n;
+
+  pngenc->batch = gst_work_batch_new (pngenc->n_threads,
+      sizeof (GstPngEncContext), gst_pngenc_encode_job,
+      gst_pngenc_finish_job, gst_pngenc_clear_job, pngenc);
+  n = gst_work_batch_get_size (pngenc->batch);
+  GST_DEBUG_OBJECT (pngenc, "encoding with %u threads", n);
+  for (i = 0; i < n; i++) {
+    ctx = gst_work_batch_get_context (pngenc->batch, i);
+    ctx->enc = pngenc;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_pngenc_stop (GstVideoEncoder * encoder)
+{
+  GstPngEnc *pngenc = GST_PNGENC (encoder);
+
+  if (pngenc->batch) {
+    gst_work_batch_free (pngenc->batch);
+    pngenc->batch = NULL;
+  }
+
+  return TRUE;
+}
+
+/* compress the frame of @ctx into its output buffer, this runs on one of
+ * the worker threads so errors are only recorded in @ctx */
+static void
+gst_pngenc_encode (GstPngEnc * pngenc, GstPngEncContext * ctx)
 {
-  GstPngEnc *pngenc;
-  gint row_index;
-  png_byte **row_pointers;
-  GstFlowReturn ret = GST_FLOW_OK;
   GstVideoInfo *info;
-  GstVideoFrame vframe;
+  png_structp png_struct_ptr;
+  png_infop png_info_ptr;
+  png_byte **row_pointers;
+  gint row_index;
 
-  pngenc = GST_PNGENC (encoder);
   info = &pngenc->input_state->info;
 
   GST_DEBUG_OBJECT (pngenc, "BEGINNING");
 
   /* initialize png struct stuff */
-  pngenc->png_struct_ptr = png_create_write_struct (PNG_LIBPNG_VER_STRING,
+  png_struct_ptr = png_create_write_struct (PNG_LIBPNG_VER_STRING,
       (png_voidp) NULL, user_error_fn, user_warning_fn);
-  if (pngenc->png_struct_ptr == NULL)
+  if (png_struct_ptr == NULL)
     goto struct_init_fail;
 
-  pngenc->png_info_ptr = png_create_info_struct (pngenc->png_struct_ptr);
-  if (!pngenc->png_info_ptr)
+  png_info_ptr = png_create_info_struct (png_struct_ptr);
+  if (!png_info_ptr)
     goto png_info_fail;
 
+  row_pointers = g_new (png_byte *, GST_VIDEO_INFO_HEIGHT (info));
+  for (row_index = 0; row_index < GST_VIDEO_INFO_HEIGHT (info); row_index++) {
+    row_pointers[row_index] = GST_VIDEO_FRAME_COMP_DATA (&ctx->vframe, 0) +
+        (row_index * GST_VIDEO_FRAME_COMP_STRIDE (&ctx->vframe, 0));
+  }
+
   /* non-0 return is from a longjmp inside of libpng */
-  if (setjmp (png_jmpbuf (pngenc->png_struct_ptr)) != 0)
+  if (setjmp (png_jmpbuf (png_struct_ptr)) != 0)
     goto longjmp_fail;
 
-  png_set_filter (pngenc->png_struct_ptr, 0,
-      PNG_FILTER_NONE | PNG_FILTER_VALUE_NONE);
-  png_set_compression_level (pngenc->png_struct_ptr, pngenc->compression_level);
+  png_set_filter (png_struct_ptr, 0,
+      pngenc->filter ? pngenc->filter : PNG_FILTER_NONE);
+  png_set_compression_level (png_struct_ptr, pngenc->compression_level);
+  png_set_compression_strategy (png_struct_ptr, pngenc->compression_strategy);
 
-  png_set_IHDR (pngenc->png_struct_ptr,
-      pngenc->png_info_ptr,
+  png_set_IHDR (png_struct_ptr,
+      png_info_ptr,
       GST_VIDEO_INFO_WIDTH (info),
       GST_VIDEO_INFO_HEIGHT (info),
       pngenc->depth,
@@ -299,75 +465,152 @@ gst_pngenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
       PNG_INTERLACE_NONE,
       PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
-  png_set_write_fn (pngenc->png_struct_ptr, pngenc,
+  png_set_write_fn (png_struct_ptr, ctx,
       (png_rw_ptr) user_write_data, user_flush_data);
 
-  row_pointers = g_new (png_byte *, GST_VIDEO_INFO_HEIGHT (info));
-  if (!gst_video_frame_map (&vframe, &pngenc->input_state->info,
-          frame->input_buffer, GST_MAP_READ)) {
-    GST_ELEMENT_ERROR (pngenc, STREAM, FORMAT, (NULL),
-        ("Failed to map video frame, caps problem?"));
-    ret = GST_FLOW_ERROR;
-    goto done;
+  png_write_info (png_struct_ptr, png_info_ptr);
+  png_write_image (png_struct_ptr, row_pointers);
+  png_write_end (png_struct_ptr, NULL);
+
+  g_free (row_pointers);
+  png_destroy_write_struct (&png_struct_ptr, &png_info_ptr);
+
+  GST_DEBUG_OBJECT (pngenc, "END");
+
+  return;
+
+  /* ERRORS */
+struct_init_fail:
+  {
+    ctx->error = "Failed to initialize png structure";
+    return;
+  }
+png_info_fail:
+  {
+    png_destroy_write_struct (&png_struct_ptr, (png_infopp) NULL);
+    ctx->error = "Failed to initialize the png info structure";
+    return;
+  }
+longjmp_fail:
+  {
+    g_free (row_pointers);
+    png_destroy_write_struct (&png_struct_ptr, &png_info_ptr);
+    ctx->error = "returning from longjmp";
+    return;
   }
+}
 
-  for (row_index = 0; row_index < GST_VIDEO_INFO_HEIGHT (info); row_index++) {
-    row_pointers[row_index] = GST_VIDEO_FRAME_COMP_DATA (&vframe, 0) +
-        (row_index * GST_VIDEO_FRAME_COMP_STRIDE (&vframe, 0));
+/* encode the frame of @context, on one of the worker threads */
+static void
+gst_pngenc_encode_job (gpointer data, gpointer context, guint index)
+{
+  gst_pngenc_encode (GST_PNGENC (data), context);
+}
+
+/* push the encoded frame of @context */
+static GstFlowReturn
+gst_pngenc_finish_job (gpointer data, gpointer context)
+{
+  GstPngEnc *pngenc = data;
+  GstPngEncContext *ctx = context;
+  GstVideoCodecFrame *frame = ctx->frame;
+
+  gst_video_frame_unmap (&ctx->vframe);
+  ctx->frame = NULL;
+
+  if (G_UNLIKELY (ctx->error != NULL))
+    goto encode_failed;
+
+  frame->output_buffer = ctx->output;
+  ctx->output = NULL;
+
+  return gst_video_encoder_finish_frame (GST_VIDEO_ENCODER (pngenc), frame);
+
+  /* ERRORS */
+encode_failed:
+  {
+    GST_ELEMENT_ERROR (pngenc, LIBRARY, FAILED, (NULL), ("%s", ctx->error));
+    ctx->error = NULL;
+    gst_buffer_unref (ctx->output);
+    ctx->output = NULL;
+    /* without output buffer the frame is dropped */
+    gst_video_encoder_finish_frame (GST_VIDEO_ENCODER (pngenc), frame);
+    return GST_FLOW_ERROR;
   }
+}
 
-  /* allocate the output buffer */
-  pngenc->buffer_out = gst_buffer_new ();
+/* forget the frame of @context, it was not encoded */
+static void
+gst_pngenc_clear_job (gpointer data, gpointer context)
+{
+  GstPngEncContext *ctx = context;
 
-  png_write_info (pngenc->png_struct_ptr, pngenc->png_info_ptr);
-  png_write_image (pngenc->png_struct_ptr, row_pointers);
-  png_write_end (pngenc->png_struct_ptr, NULL);
+  gst_video_frame_unmap (&ctx->vframe);
+  gst_buffer_unref (ctx->output);
+  ctx->output = NULL;
+  gst_video_codec_frame_unref (ctx->frame);
+  ctx->frame = NULL;
+}
 
-  g_free (row_pointers);
-  gst_video_frame_unmap (&vframe);
+static GstFlowReturn
+gst_pngenc_handle_frame (GstVideoEncoder * encoder, GstVideoCodecFrame * frame)
+{
+  GstPngEnc *pngenc;
+  GstPngEncContext *ctx;
+  GstFlowReturn ret;
+
+  pngenc = GST_PNGENC (encoder);
 
-  png_destroy_info_struct (pngenc->png_struct_ptr, &pngenc->png_info_ptr);
-  png_destroy_write_struct (&pngenc->png_struct_ptr, (png_infopp) NULL);
+  ctx = gst_work_batch_peek (pngenc->batch);
 
-  /* Set final size and store */
-  frame->output_buffer = pngenc->buffer_out;
+  if (!gst_video_frame_map (&ctx->vframe, &pngenc->input_state->info,
+          frame->input_buffer, GST_MAP_READ))
+    goto map_failed;
 
-  pngenc->buffer_out = NULL;
+  /* the output buffer collects the memory libpng writes */
+  ctx->output = gst_buffer_new ();
+  ctx->frame = frame;
 
-  if ((ret = gst_video_encoder_finish_frame (encoder, frame)) != GST_FLOW_OK)
+  ret = gst_work_batch_queue (pngenc->batch);
+  /* a snapshot is encoded right away */
+  if (ret == GST_FLOW_OK && pngenc->snapshot)
+    ret = gst_work_batch_flush (pngenc->batch);
+  if (ret != GST_FLOW_OK)
     goto done;
 
   if (pngenc->snapshot)
     ret = GST_FLOW_EOS;
 
 done:
-  GST_DEBUG_OBJECT (pngenc, "END, ret:%d", ret);
+  GST_DEBUG_OBJECT (pngenc, "ret:%d", ret);
 
   return ret;
 
   /* ERRORS */
-struct_init_fail:
+map_failed:
   {
-    GST_ELEMENT_ERROR (pngenc, LIBRARY, INIT, (NULL),
-        ("Failed to initialize png structure"));
+    GST_ELEMENT_ERROR (pngenc, STREAM, FORMAT, (NULL),
+        ("Failed to map video frame, caps problem?"));
     return GST_FLOW_ERROR;
   }
+}
 
-png_info_fail:
-  {
-    png_destroy_write_struct (&(pngenc->png_struct_ptr), (png_infopp) NULL);
-    GST_ELEMENT_ERROR (pngenc, LIBRARY, INIT, (NULL),
-        ("Failed to initialize the png info structure"));
-    return GST_FLOW_ERROR;
-  }
+static GstFlowReturn
+gst_pngenc_finish (GstVideoEncoder * encoder)
+{
+  GstPngEnc *pngenc = GST_PNGENC (encoder);
 
-longjmp_fail:
-  {
-    png_destroy_write_struct (&pngenc->png_struct_ptr, &pngenc->png_info_ptr);
-    GST_ELEMENT_ERROR (pngenc, LIBRARY, FAILED, (NULL),
-        ("returning from longjmp"));
-    return GST_FLOW_ERROR;
-  }
+  return gst_work_batch_flush (pngenc->batch);
+}
+
+static gboolean
+gst_pngenc_flush (GstVideoEncoder * encoder)
+{
+  GstPngEnc *pngenc = GST_PNGENC (encoder);
+
+  gst_work_batch_clear (pngenc->batch);
+
+  return TRUE;
 }
 
 static gboolean
@@ -394,6 +637,15 @@ gst_pngenc_get_property (GObject * object,
     case ARG_COMPRESSION_LEVEL:
       g_value_set_uint (value, pngenc->compression_level);
       break;
+    case ARG_COMPRESSION_STRATEGY:
+      g_value_set_enum (value, pngenc->compression_strategy);
+      break;
+    case ARG_FILTER:
+      g_value_set_flags (value, pngenc->filter);
+      break;
+    case ARG_N_THREADS:
+      g_value_set_uint (value, pngenc->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -416,6 +668,15 @@ gst_pngenc_set_property (GObject * object,
     case ARG_COMPRESSION_LEVEL:
       pngenc->compression_level = g_value_get_uint (value);
       break;
+    case ARG_COMPRESSION_STRATEGY:
+      pngenc->compression_strategy = g_value_get_enum (value);
+      break;
+    case ARG_FILTER:
+      pngenc->filter = g_value_get_flags (value);
+      break;
+    case ARG_N_THREADS:
+      pngenc->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
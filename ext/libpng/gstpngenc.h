@@ -27,6 +27,8 @@
 #include <gst/video/gstvideoencoder.h>
 #include <png.h>
 
+#include <gst/workers/gstworkbatch.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -40,23 +42,38 @@ extern "C" {
 
 typedef struct _GstPngEnc GstPngEnc;
 typedef struct _GstPngEncClass GstPngEncClass;
+typedef struct _GstPngEncContext GstPngEncContext;
+
+/* a frame that is encoded on one of the worker threads */
+struct _GstPngEncContext
+{
+  GstPngEnc *enc;
+
+  GstVideoCodecFrame *frame;
+  GstVideoFrame vframe;
+  GstBuffer *output;
+
+  /* set when libpng failed */
+  const gchar *error;
+};
 
 struct _GstPngEnc
 {
   GstVideoEncoder parent;
 
   GstVideoCodecState *input_state;
-  GstBuffer *buffer_out;
 
-  png_structp png_struct_ptr;
-  png_infop png_info_ptr;
+  GstWorkBatch *batch;          /* frames are encoded a batch at a time */
 
   gint png_color_type;
   gint depth;
   guint compression_level;
+  gint compression_strategy;
+  guint filter;
 
   gboolean snapshot;
   gboolean newmedia;
+  guint n_threads;
 };
 
 struct _GstPngEncClass
@@ -1573,6 +1573,13 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
       goto unlock_and_fail;
     }
 
+    /* Copy the samples without the mainloop lock, all the sinks and the
+     * mainloop thread contend for it. The shm chunk stays ours until it is
+     * written or cancelled, which only happens in this thread while
+     * in_commit is set or when the stream is destroyed after streaming
+     * stopped. */
+    pa_threaded_mainloop_unlock (mainloop);
+
     if (G_LIKELY (inr == outr && !reverse)) {
       /* no rate conversion, simply write out the samples */
       /* copy the data into internal buffer */
@@ -1614,6 +1621,8 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
       avail = towrite / bpf;
     }
 
+    pa_threaded_mainloop_lock (mainloop);
+
     /* flush the buffer if it's full */
     if ((pbuf->m_data != NULL) && (pbuf->m_towrite > 0)
         && (pbuf->m_writable == 0)) {
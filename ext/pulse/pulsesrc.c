@@ -1104,7 +1104,7 @@ gst_pulsesrc_read (GstAudioSrc * asrc, gpointer data, guint length,
     GST_LOG_OBJECT (pulsesrc, "reading %u bytes", length);
 
     /*check if we have a leftover buffer */
-    if (!pulsesrc->read_buffer) {
+    if (pulsesrc->read_buffer_length == 0) {
       for (;;) {
         if (gst_pulsesrc_is_dead (pulsesrc, TRUE))
           goto unlock_and_fail;
@@ -1118,8 +1118,10 @@ gst_pulsesrc_read (GstAudioSrc * asrc, gpointer data, guint length,
         GST_LOG_OBJECT (pulsesrc, "have data of %" G_GSIZE_FORMAT " bytes",
             pulsesrc->read_buffer_length);
 
-        /* if we have data, process if */
-        if (pulsesrc->read_buffer && pulsesrc->read_buffer_length)
+        /* if we have data, process if. Without data but with a length there
+         * is a hole in the stream that has to be dropped as well, waiting
+         * for more data would stall the capture */
+        if (pulsesrc->read_buffer_length)
           break;
 
         /* now wait for more data to become available */
@@ -1134,9 +1136,15 @@ gst_pulsesrc_read (GstAudioSrc * asrc, gpointer data, guint length,
     l = pulsesrc->read_buffer_length >
         length ? length : pulsesrc->read_buffer_length;
 
-    memcpy (data, pulsesrc->read_buffer, l);
-
-    pulsesrc->read_buffer = (const guint8 *) pulsesrc->read_buffer + l;
+    if (G_LIKELY (pulsesrc->read_buffer)) {
+      memcpy (data, pulsesrc->read_buffer, l);
+      pulsesrc->read_buffer = (const guint8 *) pulsesrc->read_buffer + l;
+    } else {
+      GST_LOG_OBJECT (pulsesrc, "filling a hole of %" G_GSIZE_FORMAT
+          " bytes with silence", l);
+      gst_audio_format_fill_silence (GST_AUDIO_BASE_SRC (pulsesrc)->
+          ringbuffer->spec.info.finfo, data, l);
+    }
     pulsesrc->read_buffer_length -= l;
 
     data = (guint8 *) data + l;
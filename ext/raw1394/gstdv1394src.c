@@ -85,6 +85,9 @@ GST_DEBUG_CATEGORY_STATIC (dv1394src_debug);
 #define NTSC_FRAMESIZE 120000
 #define NTSC_FRAMERATE 30
 
+/* number of preallocated output frames */
+#define DV1394_RING_SIZE 16
+
 enum
 {
   SIGNAL_FRAME_DROPPED,
@@ -259,7 +262,8 @@ gst_dv1394src_init (GstDV1394Src * dv1394src)
   /* initialized when first header received */
   dv1394src->frame_size = 0;
 
-  dv1394src->buf = NULL;
+  g_queue_init (&dv1394src->queue);
+  dv1394src->pool = NULL;
   dv1394src->frame = NULL;
   dv1394src->frame_sequence = 0;
 
@@ -415,6 +419,55 @@ gst_dv1394src_from_raw1394handle (raw1394handle_t handle)
 }
 #endif /* HAVE_LIBIEC61883 */
 
+/* preallocate a ring of output frames once the frame size is known, more
+ * are allocated if downstream holds on to all of them */
+static void
+gst_dv1394src_setup_pool (GstDV1394Src * dv1394src)
+{
+  GstStructure *config;
+
+  if (dv1394src->pool) {
+    gst_buffer_pool_set_active (dv1394src->pool, FALSE);
+    gst_object_unref (dv1394src->pool);
+  }
+
+  dv1394src->pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (dv1394src->pool);
+  gst_buffer_pool_config_set_params (config, NULL, dv1394src->frame_size,
+      DV1394_RING_SIZE, 0);
+  gst_buffer_pool_set_config (dv1394src->pool, config);
+
+  if (!gst_buffer_pool_set_active (dv1394src->pool, TRUE)) {
+    GST_WARNING_OBJECT (dv1394src, "could not activate buffer pool");
+    gst_object_unref (dv1394src->pool);
+    dv1394src->pool = NULL;
+  }
+}
+
+static GstBuffer *
+gst_dv1394src_new_frame (GstDV1394Src * dv1394src)
+{
+  GstBuffer *buf = NULL;
+
+  if (G_UNLIKELY (dv1394src->pool == NULL))
+    return gst_buffer_new_and_alloc (dv1394src->frame_size);
+
+  if (gst_buffer_pool_acquire_buffer (dv1394src->pool, &buf,
+          NULL) != GST_FLOW_OK)
+    return gst_buffer_new_and_alloc (dv1394src->frame_size);
+
+  return buf;
+}
+
+static void
+gst_dv1394src_clear_queue (GstDV1394Src * dv1394src)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&dv1394src->queue)))
+    gst_buffer_unref (buf);
+}
+
 #ifdef HAVE_LIBIEC61883
 static int
 gst_dv1394src_iec61883_receive (unsigned char *data, int len,
@@ -447,6 +500,7 @@ gst_dv1394src_iec61883_receive (unsigned char *data, int len,
     }
     gst_pad_set_caps (GST_BASE_SRC_PAD (dv1394src), caps);
     gst_caps_unref (caps);
+    gst_dv1394src_setup_pool (dv1394src);
   }
 
   dv1394src->frame = NULL;
@@ -455,11 +509,11 @@ gst_dv1394src_iec61883_receive (unsigned char *data, int len,
     if (complete && len == dv1394src->frame_size) {
       GstBuffer *buf;
 
-      buf = gst_buffer_new_and_alloc (dv1394src->frame_size);
+      buf = gst_dv1394src_new_frame (dv1394src);
 
       GST_BUFFER_OFFSET (buf) = dv1394src->frame_sequence;
       gst_buffer_fill (buf, 0, data, len);
-      dv1394src->buf = buf;
+      g_queue_push_tail (&dv1394src->queue, buf);
     }
   }
   dv1394src->frame_sequence++;
@@ -513,11 +567,13 @@ gst_dv1394src_iso_receive (raw1394handle_t handle, int channel, size_t len,
         }
         gst_pad_set_caps (GST_BASE_SRC_PAD (dv1394src), caps);
         gst_caps_unref (caps);
+        gst_dv1394src_setup_pool (dv1394src);
       }
       // drop last frame when not complete
       if (!dv1394src->drop_incomplete
           || dv1394src->bytes_in_frame == dv1394src->frame_size) {
-        dv1394src->buf = dv1394src->frame;
+        if (dv1394src->frame)
+          g_queue_push_tail (&dv1394src->queue, dv1394src->frame);
       } else {
         GST_INFO_OBJECT (GST_ELEMENT (dv1394src), "incomplete frame dropped");
         g_signal_emit (G_OBJECT (dv1394src),
@@ -526,12 +582,14 @@ gst_dv1394src_iso_receive (raw1394handle_t handle, int channel, size_t len,
           gst_buffer_unref (dv1394src->frame);
         }
       }
+      /* the frame is queued or dropped, skipped frames are not collected */
+      dv1394src->frame = NULL;
       if ((dv1394src->frame_sequence + 1) % (dv1394src->skip +
               dv1394src->consecutive) < dv1394src->consecutive) {
         GstBuffer *buf;
         gint64 i64;
 
-        buf = gst_buffer_new_and_alloc (dv1394src->frame_size);
+        buf = gst_dv1394src_new_frame (dv1394src);
 
         /* fill in offset, duration, timestamp */
         GST_BUFFER_OFFSET (buf) = dv1394src->frame_sequence;
@@ -651,11 +709,9 @@ gst_dv1394src_create (GstPushSrc * psrc, GstBuffer ** buf)
   pollfds[1].fd = READ_SOCKET (dv1394src);
   pollfds[1].events = POLLIN | POLLERR | POLLHUP | POLLPRI;
 
-  if (G_UNLIKELY (dv1394src->buf)) {
-    /* maybe we had an error before, and there's a stale buffer? */
-    gst_buffer_unref (dv1394src->buf);
-    dv1394src->buf = NULL;
-  }
+  /* frames completed by an earlier iteration go out first */
+  if (!g_queue_is_empty (&dv1394src->queue))
+    goto have_frame;
 
   while (TRUE) {
     int res = poll (pollfds, 2, -1);
@@ -678,15 +734,16 @@ gst_dv1394src_create (GstPushSrc * psrc, GstBuffer ** buf)
       /* shouldn't block in theory */
       raw1394_loop_iterate (dv1394src->handle);
 
-      if (dv1394src->buf)
+      if (!g_queue_is_empty (&dv1394src->queue))
         break;
     }
   }
 
-  g_assert (dv1394src->buf);
+have_frame:
+  GST_LOG_OBJECT (dv1394src, "%u frames queued",
+      g_queue_get_length (&dv1394src->queue));
 
-  *buf = dv1394src->buf;
-  dv1394src->buf = NULL;
+  *buf = g_queue_pop_head (&dv1394src->queue);
   return GST_FLOW_OK;
 
 error_while_polling:
@@ -961,6 +1018,17 @@ gst_dv1394src_stop (GstBaseSrc * bsrc)
 
   raw1394_destroy_handle (src->handle);
 
+  gst_dv1394src_clear_queue (src);
+  if (src->frame) {
+    gst_buffer_unref (src->frame);
+    src->frame = NULL;
+  }
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
   return TRUE;
 }
 
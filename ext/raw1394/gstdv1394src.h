@@ -65,8 +65,12 @@ struct _GstDV1394Src {
   struct raw1394_portinfo pinfo[16];
   raw1394handle_t handle;
 
-  GstBuffer *buf;
-  
+  /* complete frames waiting to be pushed, one iteration of the raw1394
+   * loop can complete several of them */
+  GQueue queue;
+  /* preallocated output frames */
+  GstBufferPool *pool;
+
   GstBuffer *frame;
   guint frame_size;
   guint frame_rate;
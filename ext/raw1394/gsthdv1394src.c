@@ -80,6 +80,10 @@ GST_DEBUG_CATEGORY_STATIC (hdv1394src_debug);
 #define DEFAULT_USE_AVC   TRUE
 #define DEFAULT_GUID    0
 
+/* output buffers hold up to 2048 TS packets, a few are preallocated */
+#define HDV1394_BUFFER_SIZE (2048 * IEC61883_MPEG2_TSP_SIZE)
+#define HDV1394_RING_SIZE 8
+
 enum
 {
   PROP_0,
@@ -200,6 +204,8 @@ gst_hdv1394src_init (GstHDV1394Src * dv1394src)
   WRITE_SOCKET (dv1394src) = -1;
 
   dv1394src->frame_sequence = 0;
+
+  g_queue_init (&dv1394src->queue);
 }
 
 static void
@@ -213,6 +219,11 @@ gst_hdv1394src_dispose (GObject * object)
   g_free (src->device_name);
   src->device_name = NULL;
 
+  if (src->pool) {
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -285,6 +296,57 @@ gst_hdv1394src_from_raw1394handle (raw1394handle_t handle)
  * the next loop iteration.
  */
 
+static gboolean
+gst_hdv1394src_begin_buffer (GstHDV1394Src * dv1394src)
+{
+  GstBuffer *buf = NULL;
+
+  if (gst_buffer_pool_acquire_buffer (dv1394src->pool, &buf,
+          NULL) != GST_FLOW_OK)
+    return FALSE;
+
+  dv1394src->outbuf = buf;
+  gst_buffer_map (buf, &dv1394src->outmap, GST_MAP_WRITE);
+  dv1394src->outoffset = 0;
+
+  return TRUE;
+}
+
+/* queue the collected packets for pushing */
+static void
+gst_hdv1394src_finish_buffer (GstHDV1394Src * dv1394src)
+{
+  GstBuffer *buf = dv1394src->outbuf;
+
+  gst_buffer_unmap (buf, &dv1394src->outmap);
+  dv1394src->outbuf = NULL;
+
+  if (dv1394src->outoffset == 0) {
+    gst_buffer_unref (buf);
+    return;
+  }
+
+  gst_buffer_resize (buf, 0, dv1394src->outoffset);
+  g_queue_push_tail (&dv1394src->queue, buf);
+  dv1394src->outoffset = 0;
+}
+
+static void
+gst_hdv1394src_clear_buffers (GstHDV1394Src * dv1394src)
+{
+  GstBuffer *buf;
+
+  if (dv1394src->outbuf) {
+    gst_buffer_unmap (dv1394src->outbuf, &dv1394src->outmap);
+    gst_buffer_unref (dv1394src->outbuf);
+    dv1394src->outbuf = NULL;
+  }
+  dv1394src->outoffset = 0;
+
+  while ((buf = g_queue_pop_head (&dv1394src->queue)))
+    gst_buffer_unref (buf);
+}
+
 static int
 gst_hdv1394src_iec61883_receive (unsigned char *data, int len,
     unsigned int dropped, void *cbdata)
@@ -293,12 +355,17 @@ gst_hdv1394src_iec61883_receive (unsigned char *data, int len,
 
   GST_LOG ("data:%p, len:%d, dropped:%d", data, len, dropped);
 
-  /* error out if we don't have enough room ! */
-  if (G_UNLIKELY (dv1394src->outoffset > (2048 * 188 - len)))
-    return -1;
-
   if (G_LIKELY (len == IEC61883_MPEG2_TSP_SIZE)) {
-    memcpy ((guint8 *) dv1394src->outdata + dv1394src->outoffset, data, len);
+    /* a full buffer is queued and the packets continue in the next one */
+    if (dv1394src->outbuf &&
+        dv1394src->outoffset > dv1394src->outmap.size - len)
+      gst_hdv1394src_finish_buffer (dv1394src);
+
+    /* error out if we don't have any room ! */
+    if (dv1394src->outbuf == NULL && !gst_hdv1394src_begin_buffer (dv1394src))
+      return -1;
+
+    memcpy (dv1394src->outmap.data + dv1394src->outoffset, data, len);
     dv1394src->outoffset += len;
   }
   dv1394src->frame_sequence++;
@@ -376,12 +443,12 @@ gst_hdv1394src_create (GstPushSrc * psrc, GstBuffer ** buf)
   pollfds[1].fd = READ_SOCKET (dv1394src);
   pollfds[1].events = POLLIN | POLLERR | POLLHUP | POLLPRI;
 
-  /* allocate a 2048 samples buffer */
-  dv1394src->outdata = g_malloc (2048 * 188);
-  dv1394src->outoffset = 0;
-
   GST_DEBUG ("Create...");
 
+  /* buffers filled by an earlier iteration go out first */
+  if (!g_queue_is_empty (&dv1394src->queue))
+    goto have_buffer;
+
   while (TRUE) {
     int res = poll (pollfds, 2, -1);
 
@@ -410,19 +477,18 @@ gst_hdv1394src_create (GstPushSrc * psrc, GstBuffer ** buf)
       raw1394_loop_iterate (dv1394src->handle);
       GST_LOG ("After iteration : %d (diff:%d)",
           dv1394src->frame_sequence, dv1394src->frame_sequence - pt);
-      if (dv1394src->outoffset)
+      /* push what the iteration collected */
+      if (dv1394src->outbuf)
+        gst_hdv1394src_finish_buffer (dv1394src);
+      if (!g_queue_is_empty (&dv1394src->queue))
         break;
     }
   }
 
-  g_assert (dv1394src->outoffset);
-
-  GST_LOG ("We have some frames (%u bytes)", (guint) dv1394src->outoffset);
+have_buffer:
+  GST_LOG ("We have %u buffers", g_queue_get_length (&dv1394src->queue));
 
-  /* Create the buffer */
-  *buf = gst_buffer_new_wrapped (dv1394src->outdata, dv1394src->outoffset);
-  dv1394src->outdata = NULL;
-  dv1394src->outoffset = 0;
+  *buf = g_queue_pop_head (&dv1394src->queue);
 
   return GST_FLOW_OK;
 
@@ -586,6 +652,18 @@ gst_hdv1394src_start (GstBaseSrc * bsrc)
       gst_hdv1394src_iso_receive);
 #endif
 
+  if (src->pool == NULL) {
+    GstStructure *config;
+
+    src->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (src->pool);
+    gst_buffer_pool_config_set_params (config, NULL, HDV1394_BUFFER_SIZE,
+        HDV1394_RING_SIZE, 0);
+    gst_buffer_pool_set_config (src->pool, config);
+  }
+  if (!gst_buffer_pool_set_active (src->pool, TRUE))
+    goto cannot_allocate;
+
   GST_DEBUG_OBJECT (src, "successfully opened up 1394 connection");
   src->connected = TRUE;
 
@@ -664,6 +742,16 @@ cannot_start:
         ("can't start 1394 iso receive"));
     return FALSE;
   }
+cannot_allocate:
+  {
+    raw1394_destroy_handle (src->handle);
+    src->handle = NULL;
+    iec61883_mpeg2_close (src->iec61883mpeg2);
+    src->iec61883mpeg2 = NULL;
+    GST_ELEMENT_ERROR (src, RESOURCE, FAILED, (NULL),
+        ("can't allocate output buffers"));
+    return FALSE;
+  }
 cannot_initialise_dv:
   {
     raw1394_destroy_handle (src->handle);
@@ -708,6 +796,13 @@ gst_hdv1394src_stop (GstBaseSrc * bsrc)
 
   raw1394_destroy_handle (src->handle);
 
+  gst_hdv1394src_clear_buffers (src);
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
   return TRUE;
 }
 
@@ -59,8 +59,14 @@ struct _GstHDV1394Src {
   struct raw1394_portinfo pinfo[16];
   raw1394handle_t handle;
 
-  gpointer outdata;
+  /* the buffer the TS packets are collected in */
+  GstBuffer *outbuf;
+  GstMapInfo outmap;
   gsize outoffset;
+  /* filled buffers waiting to be pushed */
+  GQueue queue;
+  /* preallocated output buffers */
+  GstBufferPool *pool;
   guint frame_size;
   guint frame_sequence;
 
@@ -33,6 +33,11 @@
  * server. Properties mount, port, username and password are all server-config
  * dependent.
  * </refsect2>
+ *
+ * The data is sent to the server from a separate thread so that a slow server
+ * does not stall the pipeline. The stream is paced by synchronising on the
+ * clock, data that does not fit in the queue of #GstShout2send:queue-size
+ * bytes is dropped.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -70,7 +75,9 @@ enum
   ARG_PROTOCOL,                 /* Protocol to connect with */
 
   ARG_MOUNT,                    /* mountpoint of stream (icecast only) */
-  ARG_URL                       /* the stream's homepage URL */
+  ARG_URL,                      /* the stream's homepage URL */
+
+  ARG_QUEUE_SIZE                /* bytes queued for the sender thread */
 };
 
 #define DEFAULT_IP           "127.0.0.1"
@@ -85,6 +92,7 @@ enum
 #define DEFAULT_URL          ""
 #define DEFAULT_PROTOCOL     SHOUT2SEND_PROTOCOL_HTTP
 #define DEFAULT_FORMAT       SHOUT_FORMAT_VORBIS
+#define DEFAULT_QUEUE_SIZE   (1024 * 1024)
 
 #ifdef SHOUT_FORMAT_WEBM
 #define WEBM_CAPS "; video/webm; audio/webm"
@@ -208,6 +216,20 @@ gst_shout2send_class_init (GstShout2sendClass * klass)
       g_param_spec_string ("url", "url", "the stream's homepage URL",
           DEFAULT_URL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstShout2send:queue-size:
+   *
+   * Maximum number of bytes that wait to be sent to the server, data that
+   * arrives while the queue is full is dropped.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_QUEUE_SIZE,
+      g_param_spec_uint ("queue-size", "Queue size",
+          "Maximum number of bytes waiting to be sent to the server", 1,
+          G_MAXUINT, DEFAULT_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* signals */
   gst_shout2send_signals[SIGNAL_CONNECTION_PROBLEM] =
       g_signal_new ("connection-problem", G_TYPE_FROM_CLASS (klass),
@@ -240,9 +262,14 @@ gst_shout2send_class_init (GstShout2sendClass * klass)
 static void
 gst_shout2send_init (GstShout2send * shout2send)
 {
-  gst_base_sink_set_sync (GST_BASE_SINK (shout2send), FALSE);
+  /* pacing comes from the clock, the sender thread never waits */
+  gst_base_sink_set_sync (GST_BASE_SINK (shout2send), TRUE);
 
-  shout2send->timer = gst_poll_new_timer ();
+  g_mutex_init (&shout2send->send_lock);
+  g_cond_init (&shout2send->send_cond);
+  g_queue_init (&shout2send->send_queue);
+  shout2send->queue_size = DEFAULT_QUEUE_SIZE;
+  shout2send->send_ret = GST_FLOW_OK;
 
   shout2send->ip = g_strdup (DEFAULT_IP);
   shout2send->port = DEFAULT_PORT;
@@ -279,7 +306,8 @@ gst_shout2send_finalize (GstShout2send * shout2send)
 
   gst_tag_list_unref (shout2send->tags);
 
-  gst_poll_free (shout2send->timer);
+  g_mutex_clear (&shout2send->send_lock);
+  g_cond_clear (&shout2send->send_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize ((GObject *) (shout2send));
 }
@@ -392,20 +420,36 @@ gst_shout2send_event (GstBaseSink * sink, GstEvent * event)
         gst_tag_list_insert (shout2send->tags,
             list,
             gst_tag_setter_get_tag_merge_mode (GST_TAG_SETTER (shout2send)));
-        /* lets get the artist and song tags */
+        /* lets get the artist and song tags, the sender thread passes
+         * them on to the server */
+        g_mutex_lock (&shout2send->send_lock);
         gst_tag_list_foreach ((GstTagList *) list,
             set_shout_metadata, shout2send);
-        if (shout2send->songmetadata && shout2send->connected) {
-          shout_metadata_t *pmetadata;
-
+        if (shout2send->songmetadata) {
           GST_DEBUG_OBJECT (shout2send, "metadata now: %s",
               shout2send->songmetadata);
-
-          pmetadata = shout_metadata_new ();
-          shout_metadata_add (pmetadata, "song", shout2send->songmetadata);
-          shout_set_metadata (shout2send->conn, pmetadata);
-          shout_metadata_free (pmetadata);
+          shout2send->metadata_changed = TRUE;
+          g_cond_signal (&shout2send->send_cond);
         }
+        g_mutex_unlock (&shout2send->send_lock);
+      }
+      break;
+    }
+    case GST_EVENT_EOS:{
+      /* everything that is queued goes out before we post EOS */
+      g_mutex_lock (&shout2send->send_lock);
+      while (shout2send->send_thread && !shout2send->flushing &&
+          shout2send->send_ret == GST_FLOW_OK &&
+          !g_queue_is_empty (&shout2send->send_queue)) {
+        GST_LOG_OBJECT (shout2send, "waiting for %" G_GUINT64_FORMAT " bytes",
+            shout2send->queued_bytes);
+        g_cond_wait (&shout2send->send_cond, &shout2send->send_lock);
+      }
+      g_mutex_unlock (&shout2send->send_lock);
+
+      if (GST_BASE_SINK_CLASS (parent_class)->event) {
+        event = gst_event_ref (event);
+        ret = GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
       }
       break;
     }
@@ -538,17 +582,6 @@ gst_shout2send_connect (GstShout2send * sink)
   GST_DEBUG_OBJECT (sink, "connected to server");
   sink->connected = TRUE;
 
-  /* let's set metadata */
-  if (sink->songmetadata) {
-    shout_metadata_t *pmetadata;
-
-    GST_DEBUG_OBJECT (sink, "shout metadata now: %s", sink->songmetadata);
-    pmetadata = shout_metadata_new ();
-    shout_metadata_add (pmetadata, "song", sink->songmetadata);
-    shout_set_metadata (sink->conn, pmetadata);
-    shout_metadata_free (pmetadata);
-  }
-
   return TRUE;
 
 /* ERRORS */
@@ -570,11 +603,120 @@ could_not_connect:
   }
 }
 
+static void
+gst_shout2send_send_metadata (GstShout2send * sink, const gchar * metadata)
+{
+  shout_metadata_t *pmetadata;
+
+  GST_DEBUG_OBJECT (sink, "shout metadata now: %s", metadata);
+  pmetadata = shout_metadata_new ();
+  shout_metadata_add (pmetadata, "song", metadata);
+  shout_set_metadata (sink->conn, pmetadata);
+  shout_metadata_free (pmetadata);
+}
+
+/* connects to the server and sends the queued buffers and metadata. This is
+ * the only place that talks to the server once the thread is running */
+static gpointer
+gst_shout2send_send_loop (GstShout2send * sink)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gchar *metadata;
+  glong ret;
+
+  if (!gst_shout2send_connect (sink))
+    goto connect_failed;
+
+  g_mutex_lock (&sink->send_lock);
+  if (sink->songmetadata)
+    sink->metadata_changed = TRUE;
+
+  while (TRUE) {
+    while (!sink->send_stop && !sink->metadata_changed &&
+        g_queue_is_empty (&sink->send_queue))
+      g_cond_wait (&sink->send_cond, &sink->send_lock);
+
+    if (sink->send_stop)
+      break;
+
+    if (sink->metadata_changed) {
+      metadata = g_strdup (sink->songmetadata);
+      sink->metadata_changed = FALSE;
+      g_mutex_unlock (&sink->send_lock);
+
+      gst_shout2send_send_metadata (sink, metadata);
+      g_free (metadata);
+
+      g_mutex_lock (&sink->send_lock);
+      continue;
+    }
+
+    buf = g_queue_pop_head (&sink->send_queue);
+    g_mutex_unlock (&sink->send_lock);
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    GST_LOG_OBJECT (sink, "sending %u bytes of data", (guint) map.size);
+    ret = shout_send (sink->conn, map.data, map.size);
+    gst_buffer_unmap (buf, &map);
+
+    g_mutex_lock (&sink->send_lock);
+    sink->queued_bytes -= map.size;
+    gst_buffer_unref (buf);
+    /* wakes up the EOS handler */
+    g_cond_broadcast (&sink->send_cond);
+
+    if (ret != SHOUTERR_SUCCESS)
+      goto send_error;
+  }
+  g_mutex_unlock (&sink->send_lock);
+
+  return NULL;
+
+/* ERRORS */
+connect_failed:
+  {
+    g_mutex_lock (&sink->send_lock);
+    sink->send_ret = GST_FLOW_ERROR;
+    g_cond_broadcast (&sink->send_cond);
+    g_mutex_unlock (&sink->send_lock);
+    return NULL;
+  }
+send_error:
+  {
+    sink->send_ret = GST_FLOW_ERROR;
+    g_mutex_unlock (&sink->send_lock);
+
+    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
+        ("shout_send() failed: %s", shout_get_error (sink->conn)));
+    g_signal_emit (sink, gst_shout2send_signals[SIGNAL_CONNECTION_PROBLEM], 0,
+        shout_get_errno (sink->conn));
+    return NULL;
+  }
+}
+
 static gboolean
 gst_shout2send_stop (GstBaseSink * basesink)
 {
   GstShout2send *sink = GST_SHOUT2SEND (basesink);
 
+  if (sink->send_thread) {
+    g_mutex_lock (&sink->send_lock);
+    sink->send_stop = TRUE;
+    g_cond_broadcast (&sink->send_cond);
+    g_mutex_unlock (&sink->send_lock);
+
+    g_thread_join (sink->send_thread);
+    sink->send_thread = NULL;
+  }
+
+  g_queue_foreach (&sink->send_queue, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&sink->send_queue);
+  sink->queued_bytes = 0;
+  sink->send_stop = FALSE;
+  sink->send_ret = GST_FLOW_OK;
+  sink->metadata_changed = FALSE;
+
   if (sink->conn) {
     if (sink->connected)
       shout_close (sink->conn);
@@ -600,7 +742,10 @@ gst_shout2send_unlock (GstBaseSink * basesink)
   sink = GST_SHOUT2SEND (basesink);
 
   GST_DEBUG_OBJECT (basesink, "unlock");
-  gst_poll_set_flushing (sink->timer, TRUE);
+  g_mutex_lock (&sink->send_lock);
+  sink->flushing = TRUE;
+  g_cond_broadcast (&sink->send_cond);
+  g_mutex_unlock (&sink->send_lock);
 
   return TRUE;
 }
@@ -613,7 +758,9 @@ gst_shout2send_unlock_stop (GstBaseSink * basesink)
   sink = GST_SHOUT2SEND (basesink);
 
   GST_DEBUG_OBJECT (basesink, "unlock_stop");
-  gst_poll_set_flushing (sink->timer, FALSE);
+  g_mutex_lock (&sink->send_lock);
+  sink->flushing = FALSE;
+  g_mutex_unlock (&sink->send_lock);
 
   return TRUE;
 }
@@ -622,53 +769,55 @@ static GstFlowReturn
 gst_shout2send_render (GstBaseSink * basesink, GstBuffer * buf)
 {
   GstShout2send *sink;
-  glong ret;
-  gint delay;
-  GstFlowReturn fret;
-  GstMapInfo map;
+  GstFlowReturn ret;
+  gsize size;
 
   sink = GST_SHOUT2SEND (basesink);
 
   /* presumably we connect here because we need to know the format before
-   * we can set up the connection, which we don't know yet in _start() */
-  if (!sink->connected) {
-    if (!gst_shout2send_connect (sink))
-      return GST_FLOW_ERROR;
+   * we can set up the connection, which we don't know yet in _start(). The
+   * sender thread connects so that we don't block on the server */
+  if (!sink->send_thread) {
+    sink->send_thread = g_thread_try_new ("shout2send",
+        (GThreadFunc) gst_shout2send_send_loop, sink, NULL);
+    if (!sink->send_thread)
+      goto no_thread;
   }
 
-  delay = shout_delay (sink->conn);
+  size = gst_buffer_get_size (buf);
 
-  if (delay > 0) {
-    GST_LOG_OBJECT (sink, "waiting %d msec", delay);
-    if (gst_poll_wait (sink->timer, GST_MSECOND * delay) == -1) {
-      GST_LOG_OBJECT (sink, "unlocked");
+  g_mutex_lock (&sink->send_lock);
+  ret = sink->send_ret;
+  if (ret != GST_FLOW_OK)
+    goto done;
 
-      fret = gst_base_sink_wait_preroll (basesink);
-      if (fret != GST_FLOW_OK)
-        return fret;
-    }
-  } else {
-    GST_LOG_OBJECT (sink, "we're %d msec late", -delay);
-  }
+  /* the server does not keep up, drop the data instead of stalling
+   * upstream */
+  if (sink->queued_bytes > 0 && sink->queued_bytes + size > sink->queue_size)
+    goto queue_full;
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-  GST_LOG_OBJECT (sink, "sending %u bytes of data", (guint) map.size);
-  ret = shout_send (sink->conn, map.data, map.size);
-  gst_buffer_unmap (buf, &map);
-  if (ret != SHOUTERR_SUCCESS)
-    goto send_error;
+  g_queue_push_tail (&sink->send_queue, gst_buffer_ref (buf));
+  sink->queued_bytes += size;
+  g_cond_signal (&sink->send_cond);
 
-  return GST_FLOW_OK;
+done:
+  g_mutex_unlock (&sink->send_lock);
+
+  return ret;
 
 /* ERRORS */
-send_error:
+no_thread:
   {
-    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
-        ("shout_send() failed: %s", shout_get_error (sink->conn)));
-    g_signal_emit (sink, gst_shout2send_signals[SIGNAL_CONNECTION_PROBLEM], 0,
-        shout_get_errno (sink->conn));
+    GST_ELEMENT_ERROR (sink, RESOURCE, FAILED, (NULL),
+        ("Could not start the sender thread"));
     return GST_FLOW_ERROR;
   }
+queue_full:
+  {
+    GST_WARNING_OBJECT (sink, "queue full (%" G_GUINT64_FORMAT " bytes), "
+        "dropping %" G_GSIZE_FORMAT " bytes", sink->queued_bytes, size);
+    goto done;
+  }
 }
 
 static void
@@ -729,6 +878,9 @@ gst_shout2send_set_property (GObject * object, guint prop_id,
         g_free (shout2send->url);
       shout2send->url = g_strdup (g_value_get_string (value));
       break;
+    case ARG_QUEUE_SIZE:
+      shout2send->queue_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -777,6 +929,9 @@ gst_shout2send_get_property (GObject * object, guint prop_id,
     case ARG_URL:              /* the stream's homepage URL */
       g_value_set_string (value, shout2send->url);
       break;
+    case ARG_QUEUE_SIZE:
+      g_value_set_uint (value, shout2send->queue_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -42,10 +42,20 @@ struct _GstShout2send {
 
   GstShout2SendProtocol protocol;
 
-  GstPoll *timer;
-
   shout_t *conn;
 
+  /* sender thread, protected by send_lock */
+  GThread *send_thread;
+  GMutex send_lock;
+  GCond send_cond;
+  GQueue send_queue;
+  guint64 queued_bytes;
+  guint queue_size;
+  gboolean send_stop;
+  gboolean flushing;
+  gboolean metadata_changed;
+  GstFlowReturn send_ret;
+
   gchar *ip;
   guint port;
   gchar *password;
@@ -65,6 +65,7 @@ static void gst_soup_http_client_sink_get_times (GstBaseSink * sink,
 static gboolean gst_soup_http_client_sink_start (GstBaseSink * sink);
 static gboolean gst_soup_http_client_sink_stop (GstBaseSink * sink);
 static gboolean gst_soup_http_client_sink_unlock (GstBaseSink * sink);
+static gboolean gst_soup_http_client_sink_unlock_stop (GstBaseSink * sink);
 static gboolean gst_soup_http_client_sink_event (GstBaseSink * sink,
     GstEvent * event);
 static GstFlowReturn gst_soup_http_client_sink_preroll (GstBaseSink * sink,
@@ -95,11 +96,15 @@ enum
   PROP_PROXY_PW,
   PROP_COOKIES,
   PROP_SESSION,
-  PROP_SOUP_LOG_LEVEL
+  PROP_SOUP_LOG_LEVEL,
+  PROP_MAX_IN_FLIGHT,
+  PROP_MAX_QUEUED_BYTES
 };
 
 #define DEFAULT_USER_AGENT           "GStreamer souphttpclientsink "
 #define DEFAULT_SOUP_LOG_LEVEL       SOUP_LOGGER_LOG_NONE
+#define DEFAULT_MAX_IN_FLIGHT        1
+#define DEFAULT_MAX_QUEUED_BYTES     0
 
 /* pad templates */
 
@@ -184,6 +189,33 @@ gst_soup_http_client_sink_class_init (GstSoupHttpClientSinkClass * klass)
           "Set log level for soup's HTTP session log",
           SOUP_TYPE_LOGGER_LOG_LEVEL, DEFAULT_SOUP_LOG_LEVEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHttpClientSink::max-in-flight:
+   *
+   * Maximum number of PUT requests sent at the same time. Each request
+   * carries the data queued since the previous one with a Content-Range
+   * header, so with values > 1 the server must accept the ranges of a
+   * resource arriving in any order.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_IN_FLIGHT,
+      g_param_spec_uint ("max-in-flight", "Max in flight",
+          "Maximum number of concurrent PUT requests", 1, 64,
+          DEFAULT_MAX_IN_FLIGHT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHttpClientSink::max-queued-bytes:
+   *
+   * Maximum number of bytes queued or being sent before rendering blocks,
+   * 0 for no limit.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUED_BYTES,
+      g_param_spec_uint64 ("max-queued-bytes", "Max queued bytes",
+          "Maximum number of bytes queued or being sent before blocking "
+          "(0 = unlimited)", 0, G_MAXUINT64, DEFAULT_MAX_QUEUED_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_soup_http_client_sink_sink_template));
@@ -201,6 +233,8 @@ gst_soup_http_client_sink_class_init (GstSoupHttpClientSinkClass * klass)
   base_sink_class->stop = GST_DEBUG_FUNCPTR (gst_soup_http_client_sink_stop);
   base_sink_class->unlock =
       GST_DEBUG_FUNCPTR (gst_soup_http_client_sink_unlock);
+  base_sink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_soup_http_client_sink_unlock_stop);
   base_sink_class->event = GST_DEBUG_FUNCPTR (gst_soup_http_client_sink_event);
   if (0)
     base_sink_class->preroll =
@@ -231,6 +265,8 @@ gst_soup_http_client_sink_init (GstSoupHttpClientSink * souphttpsink)
   souphttpsink->prop_session = NULL;
   souphttpsink->timeout = 1;
   souphttpsink->log_level = DEFAULT_SOUP_LOG_LEVEL;
+  souphttpsink->max_in_flight = DEFAULT_MAX_IN_FLIGHT;
+  souphttpsink->max_queued_bytes = DEFAULT_MAX_QUEUED_BYTES;
   proxy = g_getenv ("http_proxy");
   if (proxy && !gst_soup_http_client_sink_set_proxy (souphttpsink, proxy)) {
     GST_WARNING_OBJECT (souphttpsink,
@@ -248,6 +284,9 @@ gst_soup_http_client_sink_reset (GstSoupHttpClientSink * souphttpsink)
   souphttpsink->reason_phrase = NULL;
   souphttpsink->status_code = 0;
   souphttpsink->offset = 0;
+  souphttpsink->in_flight = 0;
+  souphttpsink->queued_bytes = 0;
+  souphttpsink->flushing = FALSE;
 
 }
 
@@ -336,6 +375,12 @@ gst_soup_http_client_sink_set_property (GObject * object, guint property_id,
     case PROP_SOUP_LOG_LEVEL:
       souphttpsink->log_level = g_value_get_enum (value);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      souphttpsink->max_in_flight = g_value_get_uint (value);
+      break;
+    case PROP_MAX_QUEUED_BYTES:
+      souphttpsink->max_queued_bytes = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -391,6 +436,12 @@ gst_soup_http_client_sink_get_property (GObject * object, guint property_id,
     case PROP_SOUP_LOG_LEVEL:
       g_value_set_enum (value, souphttpsink->log_level);
       break;
+    case PROP_MAX_IN_FLIGHT:
+      g_value_set_uint (value, souphttpsink->max_in_flight);
+      break;
+    case PROP_MAX_QUEUED_BYTES:
+      g_value_set_uint64 (value, souphttpsink->max_queued_bytes);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -537,6 +588,11 @@ gst_soup_http_client_sink_start (GstBaseSink * sink)
         souphttpsink->user_agent, SOUP_SESSION_TIMEOUT, souphttpsink->timeout,
         NULL);
 
+    /* the default of 2 connections per host would serialize the requests */
+    if (souphttpsink->max_in_flight > 2)
+      g_object_set (souphttpsink->session, SOUP_SESSION_MAX_CONNS_PER_HOST,
+          souphttpsink->max_in_flight, NULL);
+
     g_signal_connect (souphttpsink->session, "authenticate",
         G_CALLBACK (authenticate), souphttpsink);
   }
@@ -579,8 +635,29 @@ gst_soup_http_client_sink_stop (GstBaseSink * sink)
 static gboolean
 gst_soup_http_client_sink_unlock (GstBaseSink * sink)
 {
+  GstSoupHttpClientSink *souphttpsink = GST_SOUP_HTTP_CLIENT_SINK (sink);
+
   GST_DEBUG ("unlock");
 
+  g_mutex_lock (&souphttpsink->mutex);
+  souphttpsink->flushing = TRUE;
+  g_cond_broadcast (&souphttpsink->cond);
+  g_mutex_unlock (&souphttpsink->mutex);
+
+  return TRUE;
+}
+
+static gboolean
+gst_soup_http_client_sink_unlock_stop (GstBaseSink * sink)
+{
+  GstSoupHttpClientSink *souphttpsink = GST_SOUP_HTTP_CLIENT_SINK (sink);
+
+  GST_DEBUG ("unlock_stop");
+
+  g_mutex_lock (&souphttpsink->mutex);
+  souphttpsink->flushing = FALSE;
+  g_mutex_unlock (&souphttpsink->mutex);
+
   return TRUE;
 }
 
@@ -594,7 +671,7 @@ gst_soup_http_client_sink_event (GstBaseSink * sink, GstEvent * event)
   if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
     GST_DEBUG_OBJECT (souphttpsink, "got eos");
     g_mutex_lock (&souphttpsink->mutex);
-    while (souphttpsink->message) {
+    while (souphttpsink->in_flight > 0) {
       GST_DEBUG_OBJECT (souphttpsink, "waiting");
       g_cond_wait (&souphttpsink->cond, &souphttpsink->mutex);
     }
@@ -624,24 +701,38 @@ free_buffer_list (GList * list)
   g_list_free (list);
 }
 
+/* frees buffers that were queued in render() */
+static void
+release_buffer_list_locked (GstSoupHttpClientSink * souphttpsink, GList * list)
+{
+  GList *g;
+
+  for (g = list; g; g = g_list_next (g))
+    souphttpsink->queued_bytes -= gst_buffer_get_size (g->data);
+  free_buffer_list (list);
+}
+
 static void
 send_message_locked (GstSoupHttpClientSink * souphttpsink)
 {
   GList *g;
   guint64 n;
 
-  if (souphttpsink->queued_buffers == NULL || souphttpsink->message) {
+  SoupMessage *message;
+
+  if (souphttpsink->queued_buffers == NULL ||
+      souphttpsink->in_flight >= souphttpsink->max_in_flight) {
     return;
   }
 
   /* If the URI went away, drop all these buffers */
   if (souphttpsink->location == NULL) {
-    free_buffer_list (souphttpsink->queued_buffers);
+    release_buffer_list_locked (souphttpsink, souphttpsink->queued_buffers);
     souphttpsink->queued_buffers = NULL;
     return;
   }
 
-  souphttpsink->message = soup_message_new ("PUT", souphttpsink->location);
+  message = soup_message_new ("PUT", souphttpsink->location);
 
   n = 0;
   if (souphttpsink->offset == 0) {
@@ -651,7 +742,7 @@ send_message_locked (GstSoupHttpClientSink * souphttpsink)
 
       /* FIXME, lifetime of the buffer? */
       gst_buffer_map (buffer, &map, GST_MAP_READ);
-      soup_message_body_append (souphttpsink->message->request_body,
+      soup_message_body_append (message->request_body,
           SOUP_MEMORY_STATIC, map.data, map.size);
       n += map.size;
       gst_buffer_unmap (buffer, &map);
@@ -665,7 +756,7 @@ send_message_locked (GstSoupHttpClientSink * souphttpsink)
 
       /* FIXME, lifetime of the buffer? */
       gst_buffer_map (buffer, &map, GST_MAP_READ);
-      soup_message_body_append (souphttpsink->message->request_body,
+      soup_message_body_append (message->request_body,
           SOUP_MEMORY_STATIC, map.data, map.size);
       n += map.size;
       gst_buffer_unmap (buffer, &map);
@@ -676,26 +767,28 @@ send_message_locked (GstSoupHttpClientSink * souphttpsink)
     char *s;
     s = g_strdup_printf ("bytes %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT "/*",
         souphttpsink->offset, souphttpsink->offset + n - 1);
-    soup_message_headers_append (souphttpsink->message->request_headers,
+    soup_message_headers_append (message->request_headers,
         "Content-Range", s);
     g_free (s);
   }
 
   if (n == 0) {
-    free_buffer_list (souphttpsink->queued_buffers);
+    release_buffer_list_locked (souphttpsink, souphttpsink->queued_buffers);
     souphttpsink->queued_buffers = NULL;
-    g_object_unref (souphttpsink->message);
-    souphttpsink->message = NULL;
+    g_object_unref (message);
     return;
   }
 
-  souphttpsink->sent_buffers = souphttpsink->queued_buffers;
+  /* the body points into the buffers, keep them until the message is done */
+  g_object_set_data (G_OBJECT (message), "gst-buffers",
+      souphttpsink->queued_buffers);
   souphttpsink->queued_buffers = NULL;
+  souphttpsink->in_flight++;
 
   GST_DEBUG_OBJECT (souphttpsink,
-      "queue message %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT,
-      souphttpsink->offset, n);
-  soup_session_queue_message (souphttpsink->session, souphttpsink->message,
+      "queue message %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+      " (%u in flight)", souphttpsink->offset, n, souphttpsink->in_flight);
+  soup_session_queue_message (souphttpsink->session, message,
       callback, souphttpsink);
 
   souphttpsink->offset += n;
@@ -720,19 +813,20 @@ callback (SoupSession * session, SoupMessage * msg, gpointer user_data)
       msg->status_code, msg->reason_phrase);
 
   g_mutex_lock (&souphttpsink->mutex);
-  g_cond_signal (&souphttpsink->cond);
-  souphttpsink->message = NULL;
+  g_cond_broadcast (&souphttpsink->cond);
+  souphttpsink->in_flight--;
+  release_buffer_list_locked (souphttpsink,
+      g_object_steal_data (G_OBJECT (msg), "gst-buffers"));
 
   if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code)) {
-    souphttpsink->status_code = msg->status_code;
-    souphttpsink->reason_phrase = g_strdup (msg->reason_phrase);
+    if (souphttpsink->status_code == 0) {
+      souphttpsink->status_code = msg->status_code;
+      souphttpsink->reason_phrase = g_strdup (msg->reason_phrase);
+    }
     g_mutex_unlock (&souphttpsink->mutex);
     return;
   }
 
-  free_buffer_list (souphttpsink->sent_buffers);
-  souphttpsink->sent_buffers = NULL;
-
   send_message_locked (souphttpsink);
   g_mutex_unlock (&souphttpsink->mutex);
 }
@@ -755,9 +849,33 @@ gst_soup_http_client_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   g_mutex_lock (&souphttpsink->mutex);
   if (souphttpsink->location != NULL) {
+    gsize size = gst_buffer_get_size (buffer);
+
+    /* backpressure: wait for requests to complete */
+    while (souphttpsink->max_queued_bytes > 0 &&
+        souphttpsink->queued_bytes > 0 &&
+        souphttpsink->queued_bytes + size > souphttpsink->max_queued_bytes) {
+      if (souphttpsink->flushing) {
+        g_mutex_unlock (&souphttpsink->mutex);
+        return GST_FLOW_FLUSHING;
+      }
+      if (souphttpsink->status_code != 0) {
+        g_mutex_unlock (&souphttpsink->mutex);
+        GST_ELEMENT_ERROR (souphttpsink, RESOURCE, WRITE,
+            ("Could not write to HTTP URI"),
+            ("error: %d %s", souphttpsink->status_code,
+                souphttpsink->reason_phrase));
+        return GST_FLOW_ERROR;
+      }
+      GST_LOG_OBJECT (souphttpsink, "%" G_GUINT64_FORMAT " bytes queued, "
+          "waiting", souphttpsink->queued_bytes);
+      g_cond_wait (&souphttpsink->cond, &souphttpsink->mutex);
+    }
+
     wake = (souphttpsink->queued_buffers == NULL);
     souphttpsink->queued_buffers =
         g_list_append (souphttpsink->queued_buffers, gst_buffer_ref (buffer));
+    souphttpsink->queued_bytes += size;
 
     if (wake) {
       source = g_idle_source_new ();
@@ -43,11 +43,12 @@ struct _GstSoupHttpClientSink
   GMainContext *context;
   GMainLoop *loop;
   GThread *thread;
-  SoupMessage *message;
   SoupSession *session;
   GList *queued_buffers;
-  GList *sent_buffers;
   GList *streamheader_buffers;
+  guint in_flight;              /* PUT requests being sent */
+  guint64 queued_bytes;         /* bytes queued or being sent */
+  gboolean flushing;
 
   int status_code;
   char *reason_phrase;
@@ -67,6 +68,8 @@ struct _GstSoupHttpClientSink
   gboolean automatic_redirect;
   gchar **cookies;
   SoupLoggerLogLevel log_level;
+  guint max_in_flight;
+  guint64 max_queued_bytes;
 };
 
 struct _GstSoupHttpClientSinkClass
@@ -80,6 +80,7 @@
 #include <libsoup/soup.h>
 #include "gstsouphttpsrc.h"
 #include "gstsouputils.h"
+#include <gst/pool/gsttrimbufferpool.h>
 
 #include <gst/tag/tag.h>
 
@@ -107,12 +108,30 @@ enum
   PROP_IRADIO_MODE,
   PROP_TIMEOUT,
   PROP_EXTRA_HEADERS,
-  PROP_SOUP_LOG_LEVEL
+  PROP_SOUP_LOG_LEVEL,
+  PROP_PARALLEL_REQUESTS,
+  PROP_CHUNK_SIZE,
+  PROP_CACHE_SIZE,
+  PROP_CACHE_DIRECTORY,
+  PROP_MAX_BLOCKSIZE
 };
 
 #define DEFAULT_USER_AGENT           "GStreamer souphttpsrc "
 #define DEFAULT_IRADIO_MODE          TRUE
 #define DEFAULT_SOUP_LOG_LEVEL       SOUP_LOGGER_LOG_NONE
+#define DEFAULT_PARALLEL_REQUESTS    0
+#define DEFAULT_CHUNK_SIZE           (1024 * 1024)
+#define DEFAULT_CACHE_SIZE           0
+#define DEFAULT_CACHE_DIRECTORY      NULL
+#define DEFAULT_MAX_BLOCKSIZE        0
+
+/* Number of consecutive reads that must fill the whole buffer before the
+ * read size is doubled */
+#define ADAPTIVE_FULL_READS          4
+
+/* Number of times a range request is reissued after the server closed the
+ * connection before the whole range was received */
+#define MAX_RANGE_RETRIES            3
 
 static void gst_soup_http_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -132,6 +151,8 @@ static gboolean gst_soup_http_src_is_seekable (GstBaseSrc * bsrc);
 static gboolean gst_soup_http_src_do_seek (GstBaseSrc * bsrc,
     GstSegment * segment);
 static gboolean gst_soup_http_src_query (GstBaseSrc * bsrc, GstQuery * query);
+static gboolean gst_soup_http_src_decide_allocation (GstBaseSrc * bsrc,
+    GstQuery * query);
 static gboolean gst_soup_http_src_unlock (GstBaseSrc * bsrc);
 static gboolean gst_soup_http_src_unlock_stop (GstBaseSrc * bsrc);
 static gboolean gst_soup_http_src_set_location (GstSoupHTTPSrc * src,
@@ -143,6 +164,8 @@ static gboolean gst_soup_http_src_build_message (GstSoupHTTPSrc * src,
     const gchar * method);
 static void gst_soup_http_src_cancel_message (GstSoupHTTPSrc * src);
 static void gst_soup_http_src_queue_message (GstSoupHTTPSrc * src);
+static void gst_soup_http_src_ranges_clear (GstSoupHTTPSrc * src);
+static void gst_soup_http_src_check_seekable (GstSoupHTTPSrc * src);
 static gboolean gst_soup_http_src_add_range_header (GstSoupHTTPSrc * src,
     guint64 offset, guint64 stop_offset);
 static void gst_soup_http_src_session_unpause_message (GstSoupHTTPSrc * src);
@@ -259,6 +282,77 @@ gst_soup_http_src_class_init (GstSoupHTTPSrcClass * klass)
           "Set log level for soup's HTTP session log",
           SOUP_TYPE_LOGGER_LOG_LEVEL, DEFAULT_SOUP_LOG_LEVEL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHTTPSrc::parallel-requests:
+   *
+   * When set to a value > 0 and the server reports the size of the resource,
+   * the resource is downloaded with this many concurrent range requests of
+   * #GstSoupHTTPSrc:chunk-size bytes ahead of the current position. Data is
+   * kept in a window of twice that many chunks, so that seeks within it
+   * do not need a new request.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_REQUESTS,
+      g_param_spec_uint ("parallel-requests", "Parallel requests",
+          "Number of concurrent range requests used to read ahead "
+          "(0 = disabled)", 0, 16, DEFAULT_PARALLEL_REQUESTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHTTPSrc::chunk-size:
+   *
+   * Number of bytes requested by each range request when
+   * #GstSoupHTTPSrc:parallel-requests is enabled.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CHUNK_SIZE,
+      g_param_spec_uint ("chunk-size", "Chunk size",
+          "Size in bytes of each read-ahead range request", 1024, G_MAXINT,
+          DEFAULT_CHUNK_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHTTPSrc::cache-size:
+   *
+   * Maximum number of bytes of the resource kept in memory, so that reading
+   * the same range again (e.g. index lookups by a demuxer) is served locally
+   * instead of with a new request. The cache is dropped when the location
+   * or the ETag of the resource change.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_SIZE,
+      g_param_spec_uint ("cache-size", "Cache size",
+          "Bytes of downloaded data to cache in memory (0 = disabled)", 0,
+          G_MAXUINT, DEFAULT_CACHE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHTTPSrc::cache-directory:
+   *
+   * If set, downloaded data of resources with an ETag is also stored in this
+   * directory and reused by later instances reading the same URI and ETag.
+   * Files in the directory are never removed by the element.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_DIRECTORY,
+      g_param_spec_string ("cache-directory", "Cache directory",
+          "Directory to cache downloaded data in (NULL = memory only)",
+          DEFAULT_CACHE_DIRECTORY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstSoupHTTPSrc::max-blocksize:
+   *
+   * When larger than #GstBaseSrc:blocksize, the size of the reads adapts to
+   * the rate at which data arrives, between blocksize and this value. Reads
+   * grow while they keep filling the whole buffer and shrink when they
+   * return much less data.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BLOCKSIZE,
+      g_param_spec_uint ("max-blocksize", "Max blocksize",
+          "Largest size in bytes of the adaptive reads (0 = always use "
+          "blocksize)", 0, G_MAXINT, DEFAULT_MAX_BLOCKSIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&srctemplate));
@@ -278,6 +372,8 @@ gst_soup_http_src_class_init (GstSoupHTTPSrcClass * klass)
       GST_DEBUG_FUNCPTR (gst_soup_http_src_is_seekable);
   gstbasesrc_class->do_seek = GST_DEBUG_FUNCPTR (gst_soup_http_src_do_seek);
   gstbasesrc_class->query = GST_DEBUG_FUNCPTR (gst_soup_http_src_query);
+  gstbasesrc_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_soup_http_src_decide_allocation);
 
   gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_soup_http_src_create);
 
@@ -298,6 +394,9 @@ gst_soup_http_src_reset (GstSoupHTTPSrc * src)
   src->stop_position = -1;
   src->content_size = 0;
   src->have_body = FALSE;
+  src->ranges_failed = FALSE;
+  src->read_size = 0;
+  src->full_reads = 0;
 
   gst_caps_replace (&src->src_caps, NULL);
   g_free (src->iradio_name);
@@ -329,7 +428,14 @@ gst_soup_http_src_init (GstSoupHTTPSrc * src)
   src->context = NULL;
   src->session = NULL;
   src->msg = NULL;
+  src->cache = NULL;
   src->log_level = DEFAULT_SOUP_LOG_LEVEL;
+  src->parallel_requests = DEFAULT_PARALLEL_REQUESTS;
+  src->chunk_size = DEFAULT_CHUNK_SIZE;
+  g_queue_init (&src->ranges);
+  src->cache_size = DEFAULT_CACHE_SIZE;
+  src->cache_directory = g_strdup (DEFAULT_CACHE_DIRECTORY);
+  src->max_blocksize = DEFAULT_MAX_BLOCKSIZE;
   proxy = g_getenv ("http_proxy");
   if (proxy && !gst_soup_http_src_set_proxy (src, proxy)) {
     GST_WARNING_OBJECT (src,
@@ -362,6 +468,7 @@ gst_soup_http_src_finalize (GObject * gobject)
   g_free (src->proxy_id);
   g_free (src->proxy_pw);
   g_strfreev (src->cookies);
+  g_free (src->cache_directory);
 
   G_OBJECT_CLASS (parent_class)->finalize (gobject);
 }
@@ -458,6 +565,22 @@ gst_soup_http_src_set_property (GObject * object, guint prop_id,
     case PROP_SOUP_LOG_LEVEL:
       src->log_level = g_value_get_enum (value);
       break;
+    case PROP_PARALLEL_REQUESTS:
+      src->parallel_requests = g_value_get_uint (value);
+      break;
+    case PROP_CHUNK_SIZE:
+      src->chunk_size = g_value_get_uint (value);
+      break;
+    case PROP_CACHE_SIZE:
+      src->cache_size = g_value_get_uint (value);
+      break;
+    case PROP_CACHE_DIRECTORY:
+      g_free (src->cache_directory);
+      src->cache_directory = g_value_dup_string (value);
+      break;
+    case PROP_MAX_BLOCKSIZE:
+      src->max_blocksize = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -522,6 +645,21 @@ gst_soup_http_src_get_property (GObject * object, guint prop_id,
     case PROP_SOUP_LOG_LEVEL:
       g_value_set_enum (value, src->log_level);
       break;
+    case PROP_PARALLEL_REQUESTS:
+      g_value_set_uint (value, src->parallel_requests);
+      break;
+    case PROP_CHUNK_SIZE:
+      g_value_set_uint (value, src->chunk_size);
+      break;
+    case PROP_CACHE_SIZE:
+      g_value_set_uint (value, src->cache_size);
+      break;
+    case PROP_CACHE_DIRECTORY:
+      g_value_set_string (value, src->cache_directory);
+      break;
+    case PROP_MAX_BLOCKSIZE:
+      g_value_set_uint (value, src->max_blocksize);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -585,7 +723,7 @@ gst_soup_http_src_add_range_header (GstSoupHTTPSrc * src, guint64 offset,
 static gboolean
 _append_extra_header (GQuark field_id, const GValue * value, gpointer user_data)
 {
-  GstSoupHTTPSrc *src = GST_SOUP_HTTP_SRC (user_data);
+  SoupMessage *msg = (SoupMessage *) user_data;
   const gchar *field_name = g_quark_to_string (field_id);
   gchar *field_content = NULL;
 
@@ -601,14 +739,14 @@ _append_extra_header (GQuark field_id, const GValue * value, gpointer user_data)
   }
 
   if (field_content == NULL) {
-    GST_ERROR_OBJECT (src, "extra-headers field '%s' contains no value "
+    GST_ERROR ("extra-headers field '%s' contains no value "
         "or can't be converted to a string", field_name);
     return FALSE;
   }
 
-  GST_DEBUG_OBJECT (src, "Appending extra header: \"%s: %s\"", field_name,
+  GST_DEBUG ("Appending extra header: \"%s: %s\"", field_name,
       field_content);
-  soup_message_headers_append (src->msg->request_headers, field_name,
+  soup_message_headers_append (msg->request_headers, field_name,
       field_content);
 
   g_free (field_content);
@@ -649,12 +787,12 @@ _append_extra_headers (GQuark field_id, const GValue * value,
 
 
 static gboolean
-gst_soup_http_src_add_extra_headers (GstSoupHTTPSrc * src)
+gst_soup_http_src_add_extra_headers (GstSoupHTTPSrc * src, SoupMessage * msg)
 {
   if (!src->extra_headers)
     return TRUE;
 
-  return gst_structure_foreach (src->extra_headers, _append_extra_headers, src);
+  return gst_structure_foreach (src->extra_headers, _append_extra_headers, msg);
 }
 
 
@@ -716,6 +854,13 @@ gst_soup_http_src_session_open (GstSoupHTTPSrc * src)
     return FALSE;
   }
 
+  /* The default of 2 connections per host would serialize the read-ahead
+   * range requests */
+  if (src->parallel_requests > 0)
+    g_object_set (src->session, SOUP_SESSION_MAX_CONNS_PER_HOST,
+        src->parallel_requests + 1, SOUP_SESSION_MAX_CONNS,
+        MAX (10, src->parallel_requests + 1), NULL);
+
   g_signal_connect (src->session, "authenticate",
       G_CALLBACK (gst_soup_http_src_authenticate_cb), src);
 
@@ -781,6 +926,10 @@ gst_soup_http_src_got_headers_cb (SoupMessage * msg, GstSoupHTTPSrc * src)
   src->session_io_status = GST_SOUP_HTTP_SRC_SESSION_IO_STATUS_RUNNING;
   src->got_headers = TRUE;
 
+  if (src->cache)
+    gst_soup_block_cache_set_key (src->cache, src->location,
+        soup_message_headers_get_one (msg->response_headers, "ETag"));
+
   /* Parse Content-Length. */
   if (soup_message_headers_get_encoding (msg->response_headers) ==
       SOUP_ENCODING_CONTENT_LENGTH) {
@@ -1023,25 +1172,56 @@ gst_soup_http_src_chunk_free (gpointer user_data)
   g_slice_free (SoupGstChunk, chunk);
 }
 
+static gsize
+gst_soup_http_src_get_read_size (GstSoupHTTPSrc * src)
+{
+  guint blocksize = GST_BASE_SRC_CAST (src)->blocksize;
+
+  if (src->max_blocksize <= blocksize)
+    return blocksize;
+
+  return CLAMP (src->read_size, blocksize, src->max_blocksize);
+}
+
+/* Reads that keep filling the whole buffer mean more data was already
+ * waiting, so read more at once; reads that return little mean data arrives
+ * slower than we read, so don't hold on to big buffers */
+static void
+gst_soup_http_src_update_read_size (GstSoupHTTPSrc * src, gsize filled,
+    gsize allocated)
+{
+  gsize read_size = gst_soup_http_src_get_read_size (src);
+
+  /* Only reads of the full read size tell something about the rate, not the
+   * short ones at the end of a range */
+  if (src->max_blocksize <= GST_BASE_SRC_CAST (src)->blocksize ||
+      allocated != read_size)
+    return;
+
+  if (filled >= allocated) {
+    if (++src->full_reads < ADAPTIVE_FULL_READS)
+      return;
+    read_size = MIN (read_size * 2, src->max_blocksize);
+  } else if (filled < allocated / 4) {
+    read_size /= 2;
+  }
+  src->full_reads = 0;
+
+  if (read_size != src->read_size) {
+    GST_LOG_OBJECT (src, "read size %" G_GSIZE_FORMAT, read_size);
+    src->read_size = read_size;
+  }
+}
+
 static SoupBuffer *
-gst_soup_http_src_chunk_allocator (SoupMessage * msg, gsize max_len,
-    gpointer user_data)
+gst_soup_http_src_alloc_chunk (GstSoupHTTPSrc * src, gsize length)
 {
-  GstSoupHTTPSrc *src = (GstSoupHTTPSrc *) user_data;
   GstBaseSrc *basesrc = GST_BASE_SRC_CAST (src);
   GstBuffer *gstbuf;
   SoupBuffer *soupbuf;
-  gsize length;
   GstFlowReturn rc;
   SoupGstChunk *chunk;
 
-  if (max_len)
-    length = MIN (basesrc->blocksize, max_len);
-  else
-    length = basesrc->blocksize;
-  GST_DEBUG_OBJECT (src, "alloc %" G_GSIZE_FORMAT " bytes <= %" G_GSIZE_FORMAT,
-      length, max_len);
-
   rc = GST_BASE_SRC_CLASS (parent_class)->alloc (basesrc, -1, length, &gstbuf);
   if (G_UNLIKELY (rc != GST_FLOW_OK)) {
     /* Failed to allocate buffer. Stall SoupSession and return error code
@@ -1051,6 +1231,16 @@ gst_soup_http_src_chunk_allocator (SoupMessage * msg, gsize max_len,
     return NULL;
   }
 
+  /* Pool buffers have the largest read size, only let Soup fill what we
+   * asked for */
+  if (G_UNLIKELY (gst_buffer_get_size (gstbuf) < length)) {
+    GST_LOG_OBJECT (src, "read bigger than pool buffers, allocating");
+    gst_buffer_unref (gstbuf);
+    gstbuf = gst_buffer_new_allocate (NULL, length, NULL);
+  } else if (gst_buffer_get_size (gstbuf) > length) {
+    gst_buffer_resize (gstbuf, 0, length);
+  }
+
   chunk = g_slice_new0 (SoupGstChunk);
   chunk->buffer = gstbuf;
   gst_buffer_map (gstbuf, &chunk->map, GST_MAP_READWRITE);
@@ -1061,6 +1251,22 @@ gst_soup_http_src_chunk_allocator (SoupMessage * msg, gsize max_len,
   return soupbuf;
 }
 
+static SoupBuffer *
+gst_soup_http_src_chunk_allocator (SoupMessage * msg, gsize max_len,
+    gpointer user_data)
+{
+  GstSoupHTTPSrc *src = (GstSoupHTTPSrc *) user_data;
+  gsize length;
+
+  length = gst_soup_http_src_get_read_size (src);
+  if (max_len)
+    length = MIN (length, max_len);
+  GST_DEBUG_OBJECT (src, "alloc %" G_GSIZE_FORMAT " bytes <= %" G_GSIZE_FORMAT,
+      length, max_len);
+
+  return gst_soup_http_src_alloc_chunk (src, length);
+}
+
 static void
 gst_soup_http_src_got_chunk_cb (SoupMessage * msg, SoupBuffer * chunk,
     GstSoupHTTPSrc * src)
@@ -1086,12 +1292,17 @@ gst_soup_http_src_got_chunk_cb (SoupMessage * msg, SoupBuffer * chunk,
   /* Extract the GstBuffer from the SoupBuffer and set its fields. */
   gchunk = (SoupGstChunk *) soup_buffer_get_owner (chunk);
   *src->outbuf = gchunk->buffer;
+  gst_soup_http_src_update_read_size (src, chunk->length, gchunk->map.size);
 
   gst_buffer_resize (*src->outbuf, 0, chunk->length);
   GST_BUFFER_OFFSET (*src->outbuf) = basesrc->segment.position;
 
   gst_buffer_ref (*src->outbuf);
 
+  if (src->cache)
+    gst_soup_block_cache_add (src->cache, *src->outbuf, src->read_position,
+        src->have_size ? src->content_size : 0);
+
   new_position = src->read_position + chunk->length;
   if (G_LIKELY (src->request_position == src->read_position))
     src->request_position = new_position;
@@ -1214,6 +1425,18 @@ gst_soup_http_src_parse_status (SoupMessage * msg, GstSoupHTTPSrc * src)
   }
 }
 
+static void
+gst_soup_http_src_add_cookies (GstSoupHTTPSrc * src, SoupMessage * msg)
+{
+  if (src->cookies) {
+    gchar **cookie;
+
+    for (cookie = src->cookies; *cookie != NULL; cookie++) {
+      soup_message_headers_append (msg->request_headers, "Cookie", *cookie);
+    }
+  }
+}
+
 static gboolean
 gst_soup_http_src_build_message (GstSoupHTTPSrc * src, const gchar * method)
 {
@@ -1230,14 +1453,7 @@ gst_soup_http_src_build_message (GstSoupHTTPSrc * src, const gchar * method)
     soup_message_headers_append (src->msg->request_headers, "icy-metadata",
         "1");
   }
-  if (src->cookies) {
-    gchar **cookie;
-
-    for (cookie = src->cookies; *cookie != NULL; cookie++) {
-      soup_message_headers_append (src->msg->request_headers, "Cookie",
-          *cookie);
-    }
-  }
+  gst_soup_http_src_add_cookies (src, src->msg);
   src->retry = FALSE;
 
   g_signal_connect (src->msg, "got_headers",
@@ -1255,7 +1471,7 @@ gst_soup_http_src_build_message (GstSoupHTTPSrc * src, const gchar * method)
   gst_soup_http_src_add_range_header (src, src->request_position,
       src->stop_position);
 
-  gst_soup_http_src_add_extra_headers (src);
+  gst_soup_http_src_add_extra_headers (src, src->msg);
 
   return TRUE;
 }
@@ -1326,6 +1542,371 @@ gst_soup_http_src_do_request (GstSoupHTTPSrc * src, const gchar * method,
   return src->ret;
 }
 
+/* Parallel range read-ahead.
+ * When parallel-requests is set and the size of the resource is known,
+ * create() does not use the single streaming message above. Instead the
+ * resource is split in ranges of chunk-size bytes and up to
+ * parallel-requests of them are requested concurrently, on the same session,
+ * ahead of the current position. Each range keeps the buffers Soup read its
+ * data into, in order, and create() returns them as soon as the range
+ * covering the current position has data. Ranges behind the current position
+ * are kept until the window of 2 * parallel-requests ranges is full, so that
+ * seeking back into the window is served without a new request.
+ */
+
+typedef struct
+{
+  GstSoupHTTPSrc *src;
+  SoupMessage *msg;             /* NULL when no request is pending */
+  guint64 offset;               /* First byte of the range */
+  guint64 size;                 /* Number of bytes in the range */
+  guint64 filled;               /* Number of bytes received so far */
+  GQueue buffers;               /* Received buffers, in order */
+  guint retries;
+  gboolean cancelled;           /* Freed by the response callback */
+} GstSoupHTTPSrcRange;
+
+static gboolean gst_soup_http_src_range_request (GstSoupHTTPSrc * src,
+    GstSoupHTTPSrcRange * range);
+
+static GstSoupHTTPSrcRange *
+gst_soup_http_src_range_new (GstSoupHTTPSrc * src, guint64 offset,
+    guint64 end)
+{
+  GstSoupHTTPSrcRange *range;
+
+  range = g_slice_new0 (GstSoupHTTPSrcRange);
+  range->src = src;
+  range->offset = offset;
+  range->size = MIN (src->chunk_size, end - offset);
+  g_queue_init (&range->buffers);
+
+  return range;
+}
+
+static void
+gst_soup_http_src_range_free (GstSoupHTTPSrcRange * range)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&range->buffers)))
+    gst_buffer_unref (buf);
+  g_slice_free (GstSoupHTTPSrcRange, range);
+}
+
+static void
+gst_soup_http_src_range_cancel (GstSoupHTTPSrcRange * range)
+{
+  SoupMessage *msg = range->msg;
+
+  if (msg == NULL) {
+    gst_soup_http_src_range_free (range);
+    return;
+  }
+
+  /* The session still calls the response callback for the message, which
+   * frees the range */
+  range->cancelled = TRUE;
+  g_signal_handlers_disconnect_by_data (msg, range);
+  soup_session_cancel_message (range->src->session, msg, SOUP_STATUS_CANCELLED);
+}
+
+static SoupBuffer *
+gst_soup_http_src_range_chunk_allocator (SoupMessage * msg, gsize max_len,
+    gpointer user_data)
+{
+  GstSoupHTTPSrcRange *range = (GstSoupHTTPSrcRange *) user_data;
+  GstSoupHTTPSrc *src = range->src;
+  SoupBuffer *soupbuf;
+  gsize length;
+
+  length = gst_soup_http_src_get_read_size (src);
+  if (max_len)
+    length = MIN (length, max_len);
+  if (range->filled < range->size)
+    length = MIN (length, range->size - range->filled);
+
+  soupbuf = gst_soup_http_src_alloc_chunk (src, length);
+  if (G_UNLIKELY (soupbuf == NULL))
+    soup_session_pause_message (src->session, msg);
+
+  return soupbuf;
+}
+
+static void
+gst_soup_http_src_range_got_headers_cb (SoupMessage * msg,
+    GstSoupHTTPSrcRange * range)
+{
+  GstSoupHTTPSrc *src = range->src;
+
+  if (msg->status_code == SOUP_STATUS_PARTIAL_CONTENT ||
+      !SOUP_STATUS_IS_SUCCESSFUL (msg->status_code)) {
+    /* Redirections and authentication are handled by the session, errors
+     * are reported from the response callback */
+    return;
+  }
+
+  GST_WARNING_OBJECT (src, "Server ignored range request (%d: %s), "
+      "disabling read-ahead", msg->status_code, msg->reason_phrase);
+  src->ranges_failed = TRUE;
+  g_main_loop_quit (src->loop);
+}
+
+static void
+gst_soup_http_src_range_got_chunk_cb (SoupMessage * msg, SoupBuffer * chunk,
+    GstSoupHTTPSrcRange * range)
+{
+  GstSoupHTTPSrc *src = range->src;
+  SoupGstChunk *gchunk;
+  GstBuffer *buf;
+  gsize length;
+
+  if (G_UNLIKELY (src->ranges_failed || src->ret != GST_FLOW_OK))
+    return;
+  if (G_UNLIKELY (range->filled >= range->size)) {
+    GST_DEBUG_OBJECT (src, "got chunk past the end of the range");
+    return;
+  }
+
+  gchunk = (SoupGstChunk *) soup_buffer_get_owner (chunk);
+  buf = gchunk->buffer;
+  gst_soup_http_src_update_read_size (src, chunk->length, gchunk->map.size);
+
+  length = MIN (chunk->length, range->size - range->filled);
+  gst_buffer_resize (buf, 0, length);
+  GST_BUFFER_OFFSET (buf) = range->offset + range->filled;
+  g_queue_push_tail (&range->buffers, gst_buffer_ref (buf));
+  range->filled += length;
+
+  GST_LOG_OBJECT (src, "range at %" G_GUINT64_FORMAT " got %" G_GSIZE_FORMAT
+      " bytes (%" G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT ")", range->offset,
+      length, range->filled, range->size);
+
+  /* Wake up create() if it is waiting for this data */
+  if (src->request_position >= range->offset &&
+      src->request_position < range->offset + range->filled)
+    g_main_loop_quit (src->loop);
+}
+
+static void
+gst_soup_http_src_range_response_cb (SoupSession * session, SoupMessage * msg,
+    GstSoupHTTPSrcRange * range)
+{
+  GstSoupHTTPSrc *src = range->src;
+
+  /* The session's SoupMessage object expires after this callback returns. */
+  range->msg = NULL;
+
+  if (range->cancelled) {
+    gst_soup_http_src_range_free (range);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (src, "range at %" G_GUINT64_FORMAT " got response %d: %s",
+      range->offset, msg->status_code, msg->reason_phrase);
+
+  if (!src->ranges_failed && range->filled < range->size) {
+    if ((SOUP_STATUS_IS_SUCCESSFUL (msg->status_code) ||
+            msg->status_code == SOUP_STATUS_IO_ERROR) &&
+        range->retries < MAX_RANGE_RETRIES) {
+      /* The server disconnected before the end of the range. Request the
+       * remaining bytes again. */
+      range->retries++;
+      gst_soup_http_src_range_request (src, range);
+    } else if (SOUP_STATUS_IS_SUCCESSFUL (msg->status_code)) {
+      SOUP_HTTP_SRC_ERROR (src, msg, RESOURCE, READ,
+          _("A network error occured, or the server closed the connection "
+              "unexpectedly."));
+      src->ret = GST_FLOW_ERROR;
+    } else {
+      gst_soup_http_src_parse_status (msg, src);
+      if (src->ret == GST_FLOW_OK)
+        src->ret = GST_FLOW_ERROR;
+    }
+  }
+
+  g_main_loop_quit (src->loop);
+}
+
+static gboolean
+gst_soup_http_src_range_request (GstSoupHTTPSrc * src,
+    GstSoupHTTPSrcRange * range)
+{
+  SoupMessage *msg;
+  gchar buf[64];
+
+  msg = soup_message_new (SOUP_METHOD_GET, src->location);
+  if (!msg) {
+    GST_ELEMENT_ERROR (src, RESOURCE, OPEN_READ,
+        ("Error parsing URL."), ("URL: %s", src->location));
+    src->ret = GST_FLOW_ERROR;
+    return FALSE;
+  }
+
+  /* Unlike the streaming request, the connection is kept alive so that the
+   * session can reuse it for the following ranges */
+  gst_soup_http_src_add_cookies (src, msg);
+  g_snprintf (buf, sizeof (buf), "bytes=%" G_GUINT64_FORMAT "-%"
+      G_GUINT64_FORMAT, range->offset + range->filled,
+      range->offset + range->size - 1);
+  soup_message_headers_append (msg->request_headers, "Range", buf);
+  gst_soup_http_src_add_extra_headers (src, msg);
+
+  g_signal_connect (msg, "got_headers",
+      G_CALLBACK (gst_soup_http_src_range_got_headers_cb), range);
+  g_signal_connect (msg, "got_chunk",
+      G_CALLBACK (gst_soup_http_src_range_got_chunk_cb), range);
+  soup_message_set_flags (msg, SOUP_MESSAGE_OVERWRITE_CHUNKS |
+      (src->automatic_redirect ? 0 : SOUP_MESSAGE_NO_REDIRECT));
+  soup_message_set_chunk_allocator (msg,
+      gst_soup_http_src_range_chunk_allocator, range, NULL);
+
+  GST_DEBUG_OBJECT (src, "Requesting range %s", buf);
+  range->msg = msg;
+  soup_session_queue_message (src->session, msg,
+      (SoupSessionCallback) gst_soup_http_src_range_response_cb, range);
+
+  return TRUE;
+}
+
+static void
+gst_soup_http_src_ranges_clear (GstSoupHTTPSrc * src)
+{
+  GstSoupHTTPSrcRange *range;
+
+  while ((range = g_queue_pop_head (&src->ranges)))
+    gst_soup_http_src_range_cancel (range);
+}
+
+static guint64
+gst_soup_http_src_ranges_end (GstSoupHTTPSrc * src)
+{
+  if (src->stop_position != -1 && src->stop_position < src->content_size)
+    return src->stop_position;
+
+  return src->content_size;
+}
+
+static GstSoupHTTPSrcRange *
+gst_soup_http_src_ranges_find (GstSoupHTTPSrc * src, guint64 position)
+{
+  GList *l;
+
+  for (l = src->ranges.head; l; l = l->next) {
+    GstSoupHTTPSrcRange *range = l->data;
+
+    if (position >= range->offset && position < range->offset + range->size)
+      return range;
+  }
+
+  return NULL;
+}
+
+/* Make sure parallel_requests ranges at or after @position are requested,
+ * dropping the oldest ranges to stay within the window */
+static gboolean
+gst_soup_http_src_ranges_fill (GstSoupHTTPSrc * src, guint64 position)
+{
+  GstSoupHTTPSrcRange *range;
+  guint64 offset, end;
+  guint ahead = 0;
+  GList *l;
+
+  for (l = src->ranges.head; l; l = l->next) {
+    range = l->data;
+    if (range->offset + range->size > position)
+      ahead++;
+  }
+
+  range = g_queue_peek_tail (&src->ranges);
+  offset = range ? range->offset + range->size : position;
+  end = gst_soup_http_src_ranges_end (src);
+
+  while (ahead < src->parallel_requests && offset < end) {
+    if (src->ranges.length >= 2 * src->parallel_requests) {
+      range = g_queue_pop_head (&src->ranges);
+      GST_LOG_OBJECT (src, "Dropping range at %" G_GUINT64_FORMAT,
+          range->offset);
+      gst_soup_http_src_range_cancel (range);
+    }
+
+    range = gst_soup_http_src_range_new (src, offset, end);
+    g_queue_push_tail (&src->ranges, range);
+    if (!gst_soup_http_src_range_request (src, range))
+      return FALSE;
+
+    offset += range->size;
+    ahead++;
+  }
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_soup_http_src_create_ranged (GstSoupHTTPSrc * src, GstBuffer ** outbuf)
+{
+  GstSoupHTTPSrcRange *range;
+  GstBuffer *buf = NULL;
+  guint64 position;
+  GList *l;
+
+  position = src->request_position;
+  if (position >= gst_soup_http_src_ranges_end (src)) {
+    GST_DEBUG_OBJECT (src, "EOS reached");
+    return GST_FLOW_EOS;
+  }
+
+  src->ret = GST_FLOW_OK;
+  if (!gst_soup_http_src_ranges_find (src, position)) {
+    GST_DEBUG_OBJECT (src, "Position %" G_GUINT64_FORMAT " is outside of the "
+        "read-ahead window: requeueing range requests", position);
+    gst_soup_http_src_ranges_clear (src);
+  }
+  if (!gst_soup_http_src_ranges_fill (src, position))
+    return src->ret;
+  range = gst_soup_http_src_ranges_find (src, position);
+
+  /* Let all connections make progress, not only the one we wait for */
+  while (g_main_context_iteration (src->context, FALSE));
+
+  while (position - range->offset >= range->filled) {
+    if (src->interrupted) {
+      GST_DEBUG_OBJECT (src, "interrupted");
+      return GST_FLOW_FLUSHING;
+    }
+    if (src->ret != GST_FLOW_OK || src->ranges_failed)
+      return src->ret;
+
+    g_main_loop_run (src->loop);
+  }
+
+  for (l = range->buffers.head; l; l = l->next) {
+    buf = l->data;
+    if (position < GST_BUFFER_OFFSET (buf) + gst_buffer_get_size (buf))
+      break;
+  }
+
+  if (GST_BUFFER_OFFSET (buf) == position) {
+    *outbuf = gst_buffer_ref (buf);
+  } else {
+    *outbuf = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL,
+        position - GST_BUFFER_OFFSET (buf), -1);
+    GST_BUFFER_OFFSET (*outbuf) = position;
+  }
+
+  if (src->cache)
+    gst_soup_block_cache_add (src->cache, *outbuf, position,
+        src->content_size);
+
+  src->read_position = position + gst_buffer_get_size (*outbuf);
+  src->request_position = src->read_position;
+
+  /* Top up the window for the next call */
+  gst_soup_http_src_ranges_fill (src, src->read_position);
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_soup_http_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
@@ -1334,8 +1915,43 @@ gst_soup_http_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 
   src = GST_SOUP_HTTP_SRC (psrc);
 
+  /* The read-ahead needs the size of the resource up front */
+  if (src->parallel_requests > 0 && !src->ranges_failed)
+    gst_soup_http_src_check_seekable (src);
+
   g_mutex_lock (&src->mutex);
+  /* Serve cached data unless the running request is already at the position */
+  if (src->cache && (src->msg == NULL ||
+          src->request_position != src->read_position) &&
+      (src->stop_position == -1 ||
+          src->request_position < src->stop_position)) {
+    *outbuf = gst_soup_block_cache_lookup (src->cache, src->request_position);
+    if (*outbuf) {
+      gsize size = gst_buffer_get_size (*outbuf);
+
+      if (src->stop_position != -1 &&
+          src->request_position + size > src->stop_position) {
+        size = src->stop_position - src->request_position;
+        gst_buffer_resize (*outbuf, 0, size);
+      }
+      src->request_position += size;
+      ret = GST_FLOW_OK;
+      goto done;
+    }
+  }
+
+  if (src->parallel_requests > 0 && !src->ranges_failed && src->msg == NULL &&
+      src->have_size && src->seekable) {
+    ret = gst_soup_http_src_create_ranged (src, outbuf);
+    if (!src->ranges_failed)
+      goto done;
+
+    GST_DEBUG_OBJECT (src, "Falling back to a single request");
+    gst_soup_http_src_ranges_clear (src);
+  }
   ret = gst_soup_http_src_do_request (src, SOUP_METHOD_GET, outbuf);
+
+done:
   g_mutex_unlock (&src->mutex);
   return ret;
 }
@@ -1347,7 +1963,14 @@ gst_soup_http_src_start (GstBaseSrc * bsrc)
 
   GST_DEBUG_OBJECT (src, "start(\"%s\")", src->location);
 
-  return gst_soup_http_src_session_open (src);
+  if (!gst_soup_http_src_session_open (src))
+    return FALSE;
+
+  if (src->cache_size > 0 || src->cache_directory)
+    src->cache = gst_soup_block_cache_new (src->cache_size,
+        src->cache_directory);
+
+  return TRUE;
 }
 
 static gboolean
@@ -1357,7 +1980,12 @@ gst_soup_http_src_stop (GstBaseSrc * bsrc)
 
   src = GST_SOUP_HTTP_SRC (bsrc);
   GST_DEBUG_OBJECT (src, "stop()");
+  gst_soup_http_src_ranges_clear (src);
   gst_soup_http_src_session_close (src);
+  if (src->cache) {
+    gst_soup_block_cache_free (src->cache);
+    src->cache = NULL;
+  }
   if (src->loop) {
     g_main_loop_unref (src->loop);
     g_main_context_unref (src->context);
@@ -1502,6 +2130,66 @@ gst_soup_http_src_do_seek (GstBaseSrc * bsrc, GstSegment * segment)
   return TRUE;
 }
 
+static gboolean
+gst_soup_http_src_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
+{
+  GstSoupHTTPSrc *src = GST_SOUP_HTTP_SRC (bsrc);
+  GstBufferPool *pool;
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstStructure *config;
+  guint size, min, max;
+  gboolean update;
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    update = TRUE;
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+    update = FALSE;
+  }
+
+  GST_DEBUG_OBJECT (src, "allocation: size:%u min:%u max:%u pool:%"
+      GST_PTR_FORMAT, size, min, max, pool);
+
+  /* other pools don't undo our trimming of the buffers when they are
+   * recycled, always use our own */
+  if (pool)
+    gst_object_unref (pool);
+  /* reads never append memory, there is nothing to drop */
+  pool = gst_trim_buffer_pool_new (FALSE);
+
+  size = MAX (size, MAX (bsrc->blocksize, src->max_blocksize));
+  /* the read-ahead window and the cache can hold on to buffers for a long
+   * time, never wait for one to be returned */
+  max = 0;
+
+  if (gst_query_get_n_allocation_params (query) > 0) {
+    gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+  } else {
+    allocator = NULL;
+    gst_allocation_params_init (&params);
+  }
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, min, max);
+  gst_buffer_pool_config_set_allocator (config, allocator, &params);
+  gst_buffer_pool_set_config (pool, config);
+
+  if (allocator)
+    gst_object_unref (allocator);
+
+  if (update)
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+
+  gst_object_unref (pool);
+
+  return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (bsrc, query);
+}
+
 static gboolean
 gst_soup_http_src_query (GstBaseSrc * bsrc, GstQuery * query)
 {
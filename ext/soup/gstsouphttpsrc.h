@@ -97,6 +97,22 @@ struct _GstSoupHTTPSrc {
 
   guint timeout;
 
+  /* Parallel range read-ahead. */
+  guint parallel_requests;     /* Concurrent range requests, 0 = disabled. */
+  guint chunk_size;            /* Bytes requested per range request. */
+  GQueue ranges;               /* Read-ahead window, in offset order. */
+  gboolean ranges_failed;      /* Server ignored a range request. */
+
+  /* Block cache. */
+  guint cache_size;            /* Bytes of cached data kept in memory. */
+  gchar *cache_directory;      /* Directory for cached data, or NULL. */
+  GstSoupBlockCache *cache;
+
+  /* Adaptive read size. */
+  guint max_blocksize;         /* Largest read size, 0 = always blocksize. */
+  guint read_size;             /* Current read size. */
+  guint full_reads;            /* Consecutive reads that filled the buffer. */
+
   GMutex mutex;
   GCond request_finished_cond;
 };
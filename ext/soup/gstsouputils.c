@@ -17,6 +17,9 @@
 
 #include <glib.h>
 #include <gst/gst.h>
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <gst/base/gstadapter.h>
 #include <libsoup/soup.h>
 #include "gstsouputils.h"
 
@@ -95,3 +98,292 @@ gst_soup_util_log_setup (SoupSession * session, SoupLoggerLogLevel level,
   soup_session_add_feature (session, SOUP_SESSION_FEATURE (logger));
   g_object_unref (logger);
 }
+
+/**
+ * Block cache
+ *
+ * Keeps the data of a resource in blocks of GST_SOUP_BLOCK_CACHE_BLOCK_SIZE
+ * bytes, aligned on multiples of the block size, so that reading the same
+ * bytes again (index lookups, seeks back to the start) does not need a new
+ * request. Blocks are kept in memory up to max_size bytes, evicting the least
+ * recently used ones. When a directory is given and the server sent an ETag,
+ * blocks are also stored there, one file per block named after a checksum of
+ * the URI and ETag, and survive the element. Files in the directory are never
+ * removed by the cache.
+ */
+
+typedef struct
+{
+  guint64 index;
+  GstBuffer *buffer;
+} GstSoupCacheBlock;
+
+struct _GstSoupBlockCache
+{
+  gsize max_size;
+  gsize size;                   /* bytes of all blocks in memory */
+  gchar *directory;
+
+  gchar *uri;
+  gchar *etag;
+  gchar *prefix;                /* file name prefix, NULL if not on disk */
+
+  GHashTable *blocks;           /* index -> link in lru */
+  GQueue lru;                   /* least recently used first */
+
+  /* Collects incoming data up to the next complete block */
+  GstAdapter *fill;
+  guint64 fill_offset;          /* position of the first byte in fill */
+  guint64 fill_position;        /* position of the next expected byte */
+};
+
+static void
+gst_soup_block_cache_block_free (GstSoupCacheBlock * block)
+{
+  gst_buffer_unref (block->buffer);
+  g_slice_free (GstSoupCacheBlock, block);
+}
+
+static void
+gst_soup_block_cache_clear (GstSoupBlockCache * cache)
+{
+  GstSoupCacheBlock *block;
+
+  g_hash_table_remove_all (cache->blocks);
+  while ((block = g_queue_pop_head (&cache->lru)))
+    gst_soup_block_cache_block_free (block);
+  cache->size = 0;
+
+  gst_adapter_clear (cache->fill);
+  cache->fill_offset = cache->fill_position = 0;
+}
+
+GstSoupBlockCache *
+gst_soup_block_cache_new (gsize max_size, const gchar * directory)
+{
+  GstSoupBlockCache *cache;
+
+  cache = g_slice_new0 (GstSoupBlockCache);
+  cache->max_size = max_size;
+  if (directory) {
+    if (g_mkdir_with_parents (directory, 0700) == 0)
+      cache->directory = g_strdup (directory);
+    else
+      GST_WARNING ("can't create cache directory %s: %s", directory,
+          g_strerror (errno));
+  }
+  cache->blocks = g_hash_table_new (g_int64_hash, g_int64_equal);
+  g_queue_init (&cache->lru);
+  cache->fill = gst_adapter_new ();
+
+  return cache;
+}
+
+void
+gst_soup_block_cache_free (GstSoupBlockCache * cache)
+{
+  gst_soup_block_cache_clear (cache);
+  g_hash_table_unref (cache->blocks);
+  g_object_unref (cache->fill);
+  g_free (cache->directory);
+  g_free (cache->uri);
+  g_free (cache->etag);
+  g_free (cache->prefix);
+  g_slice_free (GstSoupBlockCache, cache);
+}
+
+/* Cached data is only valid for the resource it was read from. Changing the
+ * URI or the ETag drops what is in memory. */
+void
+gst_soup_block_cache_set_key (GstSoupBlockCache * cache, const gchar * uri,
+    const gchar * etag)
+{
+  if (g_strcmp0 (cache->uri, uri) == 0 && g_strcmp0 (cache->etag, etag) == 0)
+    return;
+
+  GST_DEBUG ("new cache key %s, ETag %s", uri, GST_STR_NULL (etag));
+  gst_soup_block_cache_clear (cache);
+  g_free (cache->uri);
+  cache->uri = g_strdup (uri);
+  g_free (cache->etag);
+  cache->etag = g_strdup (etag);
+
+  /* Without an ETag we can't tell whether a block on disk is still valid */
+  g_free (cache->prefix);
+  cache->prefix = NULL;
+  if (cache->directory && uri && etag) {
+    gchar *key = g_strconcat (uri, "\n", etag, NULL);
+
+    cache->prefix = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+    g_free (key);
+  }
+}
+
+static gchar *
+gst_soup_block_cache_block_path (GstSoupBlockCache * cache, guint64 index)
+{
+  gchar *name, *path;
+
+  name = g_strdup_printf ("%s-%" G_GUINT64_FORMAT, cache->prefix, index);
+  path = g_build_filename (cache->directory, name, NULL);
+  g_free (name);
+
+  return path;
+}
+
+static void
+gst_soup_block_cache_insert (GstSoupBlockCache * cache, guint64 index,
+    GstBuffer * buffer)
+{
+  GstSoupCacheBlock *block;
+
+  if (gst_buffer_get_size (buffer) > cache->max_size ||
+      g_hash_table_contains (cache->blocks, &index)) {
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  while (cache->size + gst_buffer_get_size (buffer) > cache->max_size) {
+    block = g_queue_pop_head (&cache->lru);
+    g_hash_table_remove (cache->blocks, &block->index);
+    cache->size -= gst_buffer_get_size (block->buffer);
+    gst_soup_block_cache_block_free (block);
+  }
+
+  block = g_slice_new (GstSoupCacheBlock);
+  block->index = index;
+  block->buffer = buffer;
+  g_queue_push_tail (&cache->lru, block);
+  g_hash_table_insert (cache->blocks, &block->index, cache->lru.tail);
+  cache->size += gst_buffer_get_size (buffer);
+}
+
+static void
+gst_soup_block_cache_store (GstSoupBlockCache * cache, guint64 index,
+    GstBuffer * buffer)
+{
+  GST_LOG ("storing block %" G_GUINT64_FORMAT " of %" G_GSIZE_FORMAT " bytes",
+      index, gst_buffer_get_size (buffer));
+
+  if (cache->prefix) {
+    GError *err = NULL;
+    GstMapInfo map;
+    gchar *path;
+
+    path = gst_soup_block_cache_block_path (cache, index);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    if (!g_file_set_contents (path, (gchar *) map.data, map.size, &err)) {
+      GST_WARNING ("can't write %s: %s", path, err->message);
+      g_clear_error (&err);
+    }
+    gst_buffer_unmap (buffer, &map);
+    g_free (path);
+  }
+
+  gst_soup_block_cache_insert (cache, index, buffer);
+}
+
+/* Feed data read from the resource at @offset. Only complete blocks, and the
+ * last block of a resource of known @total_size, are kept. */
+void
+gst_soup_block_cache_add (GstSoupBlockCache * cache, GstBuffer * buffer,
+    guint64 offset, guint64 total_size)
+{
+  gsize size = gst_buffer_get_size (buffer);
+  guint avail;
+
+  if (cache->uri == NULL)
+    return;
+
+  if (offset != cache->fill_position) {
+    /* Discontinuity, restart at the next block boundary */
+    gst_adapter_clear (cache->fill);
+    cache->fill_offset = GST_ROUND_UP_N (offset,
+        (guint64) GST_SOUP_BLOCK_CACHE_BLOCK_SIZE);
+  }
+  cache->fill_position = offset + size;
+
+  if (offset + size <= cache->fill_offset)
+    return;
+
+  if (offset < cache->fill_offset)
+    buffer = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY,
+        cache->fill_offset - offset, -1);
+  else
+    gst_buffer_ref (buffer);
+  gst_adapter_push (cache->fill, buffer);
+
+  while ((avail = gst_adapter_available (cache->fill)) > 0) {
+    if (avail < GST_SOUP_BLOCK_CACHE_BLOCK_SIZE &&
+        cache->fill_offset + avail != total_size)
+      break;
+
+    avail = MIN (avail, GST_SOUP_BLOCK_CACHE_BLOCK_SIZE);
+    gst_soup_block_cache_store (cache,
+        cache->fill_offset / GST_SOUP_BLOCK_CACHE_BLOCK_SIZE,
+        gst_adapter_take_buffer (cache->fill, avail));
+    cache->fill_offset += avail;
+  }
+}
+
+static GstBuffer *
+gst_soup_block_cache_load (GstSoupBlockCache * cache, guint64 index)
+{
+  GstBuffer *buffer = NULL;
+  gchar *path, *data;
+  gsize size;
+
+  if (cache->prefix == NULL)
+    return NULL;
+
+  path = gst_soup_block_cache_block_path (cache, index);
+  if (g_file_get_contents (path, &data, &size, NULL)) {
+    if (size > 0 && size <= GST_SOUP_BLOCK_CACHE_BLOCK_SIZE) {
+      GST_LOG ("loaded block %" G_GUINT64_FORMAT " from %s", index, path);
+      buffer = gst_buffer_new_wrapped (data, size);
+    } else {
+      g_free (data);
+    }
+  }
+  g_free (path);
+
+  return buffer;
+}
+
+/* Returns the cached data from @offset up to the end of its block, or NULL */
+GstBuffer *
+gst_soup_block_cache_lookup (GstSoupBlockCache * cache, guint64 offset)
+{
+  guint64 index = offset / GST_SOUP_BLOCK_CACHE_BLOCK_SIZE;
+  guint64 skip = offset % GST_SOUP_BLOCK_CACHE_BLOCK_SIZE;
+  GstBuffer *block, *buffer;
+  GList *link;
+
+  if (cache->uri == NULL)
+    return NULL;
+
+  link = g_hash_table_lookup (cache->blocks, &index);
+  if (link) {
+    /* Most recently used */
+    g_queue_unlink (&cache->lru, link);
+    g_queue_push_tail_link (&cache->lru, link);
+    block = gst_buffer_ref (((GstSoupCacheBlock *) link->data)->buffer);
+  } else {
+    block = gst_soup_block_cache_load (cache, index);
+    if (block == NULL)
+      return NULL;
+    gst_soup_block_cache_insert (cache, index, gst_buffer_ref (block));
+  }
+
+  if (skip >= gst_buffer_get_size (block)) {
+    gst_buffer_unref (block);
+    return NULL;
+  }
+
+  GST_LOG ("cache hit at %" G_GUINT64_FORMAT, offset);
+  buffer = gst_buffer_copy_region (block, GST_BUFFER_COPY_MEMORY, skip, -1);
+  GST_BUFFER_OFFSET (buffer) = offset;
+  gst_buffer_unref (block);
+
+  return buffer;
+}
@@ -26,6 +26,20 @@ G_BEGIN_DECLS
 void gst_soup_util_log_setup (SoupSession * session, SoupLoggerLogLevel level,
     GstElement * element);
 
+#define GST_SOUP_BLOCK_CACHE_BLOCK_SIZE (64 * 1024)
+
+typedef struct _GstSoupBlockCache GstSoupBlockCache;
+
+GstSoupBlockCache *gst_soup_block_cache_new (gsize max_size,
+    const gchar * directory);
+void gst_soup_block_cache_free (GstSoupBlockCache * cache);
+void gst_soup_block_cache_set_key (GstSoupBlockCache * cache,
+    const gchar * uri, const gchar * etag);
+void gst_soup_block_cache_add (GstSoupBlockCache * cache, GstBuffer * buffer,
+    guint64 offset, guint64 total_size);
+GstBuffer *gst_soup_block_cache_lookup (GstSoupBlockCache * cache,
+    guint64 offset);
+
 G_END_DECLS
 
 #endif
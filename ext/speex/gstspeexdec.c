@@ -52,13 +52,28 @@ GST_DEBUG_CATEGORY_STATIC (speexdec_debug);
 #define GST_CAT_DEFAULT speexdec_debug
 
 #define DEFAULT_ENH   TRUE
+#define DEFAULT_REUSE_DECODER FALSE
 
 enum
 {
   ARG_0,
-  ARG_ENH
+  ARG_ENH,
+  ARG_REUSE_DECODER
 };
 
+/* stopped decoder states that wait to be reused, shared by all the
+ * elements of the process. A state only fits streams of its mode */
+#define MAX_POOLED_DECODERS 16
+
+typedef struct
+{
+  gconstpointer mode;
+  void *state;
+} GstSpeexDecPooled;
+
+static GMutex decoder_pool_lock;
+static GQueue decoder_pool = G_QUEUE_INIT;
+
 #define FORMAT_STR GST_AUDIO_NE(S16)
 
 static GstStaticPadTemplate speex_dec_src_factory =
@@ -116,6 +131,21 @@ gst_speex_dec_class_init (GstSpeexDecClass * klass)
       g_param_spec_boolean ("enh", "Enh", "Enable perceptual enhancement",
           DEFAULT_ENH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSpeexDec:reuse-decoder:
+   *
+   * Put the speex decoder state in a pool of the process when the element
+   * stops, and take one of the same mode from there for the next stream.
+   * This saves setting up a new decoder for every stream when many short
+   * streams are decoded.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_REUSE_DECODER,
+      g_param_spec_boolean ("reuse-decoder", "Reuse decoder",
+          "Keep stopped decoders in a pool to use them for the next stream",
+          DEFAULT_REUSE_DECODER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&speex_dec_src_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -128,13 +158,69 @@ gst_speex_dec_class_init (GstSpeexDecClass * klass)
       "speex decoding element");
 }
 
+static void *
+gst_speex_dec_acquire_decoder (GstSpeexDec * dec)
+{
+  void *state = NULL;
+  GList *l;
+
+  if (dec->reuse_decoder) {
+    g_mutex_lock (&decoder_pool_lock);
+    for (l = decoder_pool.head; l; l = l->next) {
+      GstSpeexDecPooled *pooled = l->data;
+
+      if (pooled->mode == dec->mode) {
+        state = pooled->state;
+        g_slice_free (GstSpeexDecPooled, pooled);
+        g_queue_delete_link (&decoder_pool, l);
+        break;
+      }
+    }
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (state) {
+    GST_DEBUG_OBJECT (dec, "reusing decoder state %p", state);
+    return state;
+  }
+
+  return speex_decoder_init (dec->mode);
+}
+
+static void
+gst_speex_dec_release_decoder (GstSpeexDec * dec, void *state)
+{
+  if (dec->reuse_decoder) {
+    SpeexCallback callback = { 0, };
+
+    /* the stereo state of the handler goes away with the element */
+    callback.callback_id = SPEEX_INBAND_STEREO;
+    callback.func = NULL;
+    speex_decoder_ctl (state, SPEEX_SET_HANDLER, &callback);
+    speex_decoder_ctl (state, SPEEX_RESET_STATE, NULL);
+
+    g_mutex_lock (&decoder_pool_lock);
+    if (decoder_pool.length < MAX_POOLED_DECODERS) {
+      GstSpeexDecPooled *pooled = g_slice_new (GstSpeexDecPooled);
+
+      pooled->mode = dec->mode;
+      pooled->state = state;
+      g_queue_push_head (&decoder_pool, pooled);
+      state = NULL;
+    }
+    g_mutex_unlock (&decoder_pool_lock);
+  }
+
+  if (state)
+    speex_decoder_destroy (state);
+}
+
 static void
 gst_speex_dec_reset (GstSpeexDec * dec)
 {
   dec->packetno = 0;
   dec->frame_size = 0;
   dec->frame_duration = 0;
-  dec->mode = NULL;
   free (dec->header);
   dec->header = NULL;
   speex_bits_destroy (&dec->bits);
@@ -148,9 +234,10 @@ gst_speex_dec_reset (GstSpeexDec * dec)
   }
 
   if (dec->state) {
-    speex_decoder_destroy (dec->state);
+    gst_speex_dec_release_decoder (dec, dec->state);
     dec->state = NULL;
   }
+  dec->mode = NULL;
 }
 
 static void
@@ -159,6 +246,7 @@ gst_speex_dec_init (GstSpeexDec * dec)
   gst_audio_decoder_set_needs_format (GST_AUDIO_DECODER (dec), TRUE);
 
   dec->enh = DEFAULT_ENH;
+  dec->reuse_decoder = DEFAULT_REUSE_DECODER;
 
   gst_speex_dec_reset (dec);
 }
@@ -213,7 +301,7 @@ gst_speex_dec_parse_header (GstSpeexDec * dec, GstBuffer * buf)
   dec->mode = speex_lib_get_mode (dec->header->mode);
 
   /* initialize the decoder */
-  dec->state = speex_decoder_init (dec->mode);
+  dec->state = gst_speex_dec_acquire_decoder (dec);
   if (!dec->state)
     goto init_failed;
 
@@ -553,6 +641,9 @@ gst_speex_dec_get_property (GObject * object, guint prop_id,
     case ARG_ENH:
       g_value_set_boolean (value, speexdec->enh);
       break;
+    case ARG_REUSE_DECODER:
+      g_value_set_boolean (value, speexdec->reuse_decoder);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -571,6 +662,9 @@ gst_speex_dec_set_property (GObject * object, guint prop_id,
     case ARG_ENH:
       speexdec->enh = g_value_get_boolean (value);
       break;
+    case ARG_REUSE_DECODER:
+      speexdec->reuse_decoder = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -60,6 +60,7 @@ struct _GstSpeexDec {
   SpeexBits             bits;
 
   gboolean              enh;
+  gboolean              reuse_decoder;
 
   gint                  frame_size;
   GstClockTime          frame_duration;
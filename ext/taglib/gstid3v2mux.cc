@@ -42,6 +42,10 @@
  * gst-launch-1.0 -m filesrc location=foo.mp3 ! id3demux ! fakesink silent=TRUE 2&gt; /dev/null | grep taglist
  * ]| Verify that tags have been written.
  * </refsect2>
+ *
+ * The #GstId3v2Mux:tag-size property reserves room in the tag, so that
+ * taggers can later update the tag of the file in place instead of
+ * rewriting the whole file.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -67,6 +71,17 @@ using namespace TagLib;
 GST_DEBUG_CATEGORY_STATIC (gst_id3v2_mux_debug);
 #define GST_CAT_DEFAULT gst_id3v2_mux_debug
 
+enum
+{
+  PROP_0,
+  PROP_TAG_SIZE
+};
+
+#define DEFAULT_TAG_SIZE 0
+
+/* the size in the header is a 28 bit synchsafe integer */
+#define ID3V2_MAX_TAG_SIZE ((1 << 28) - 1)
+
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -83,12 +98,36 @@ static GstBuffer *gst_id3v2_mux_render_tag (GstTagMux * mux,
     const GstTagList * taglist);
 static GstBuffer *gst_id3v2_mux_render_end_tag (GstTagMux * mux,
     const GstTagList * taglist);
+static void gst_id3v2_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_id3v2_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static void
 gst_id3v2_mux_class_init (GstId3v2MuxClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
 
+  gobject_class->set_property = gst_id3v2_mux_set_property;
+  gobject_class->get_property = gst_id3v2_mux_get_property;
+
+  /**
+   * GstId3v2Mux:tag-size:
+   *
+   * Minimum size of the tag in bytes, the room that is not used by the
+   * frames is filled with padding. Reserving enough room lets the tag be
+   * updated later without moving the audio data. 0 leaves the padding to
+   * taglib, which adds 1024 bytes.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_TAG_SIZE,
+      g_param_spec_uint ("tag-size", "Tag size",
+          "Minimum size of the tag in bytes, filled up with padding "
+          "(0 = default padding)", 0, ID3V2_MAX_TAG_SIZE, DEFAULT_TAG_SIZE,
+          (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
   GST_TAG_MUX_CLASS (klass)->render_start_tag =
       GST_DEBUG_FUNCPTR (gst_id3v2_mux_render_tag);
   GST_TAG_MUX_CLASS (klass)->render_end_tag =
@@ -111,7 +150,39 @@ gst_id3v2_mux_class_init (GstId3v2MuxClass * klass)
 static void
 gst_id3v2_mux_init (GstId3v2Mux * id3v2mux)
 {
-  /* nothing to do */
+  id3v2mux->tag_size = DEFAULT_TAG_SIZE;
+}
+
+static void
+gst_id3v2_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstId3v2Mux *mux = GST_ID3V2_MUX (object);
+
+  switch (prop_id) {
+    case PROP_TAG_SIZE:
+      mux->tag_size = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_id3v2_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstId3v2Mux *mux = GST_ID3V2_MUX (object);
+
+  switch (prop_id) {
+    case PROP_TAG_SIZE:
+      g_value_set_uint (value, mux->tag_size);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 #if 0
@@ -765,6 +836,7 @@ foreach_add_tag (const GstTagList * list, const gchar * tag, gpointer userdata)
 static GstBuffer *
 gst_id3v2_mux_render_tag (GstTagMux * mux, const GstTagList * taglist)
 {
+  GstId3v2Mux *id3v2mux = GST_ID3V2_MUX (mux);
   ID3v2::Tag id3v2tag;
   ByteVector rendered_tag;
   GstBuffer *buf;
@@ -789,6 +861,14 @@ gst_id3v2_mux_render_tag (GstTagMux * mux, const GstTagList * taglist)
   }
 #endif
 
+  /* taglib pads the frames up to the size of the tag it was read from, which
+   * excludes the 10 byte header. If the frames don't fit, it adds its
+   * default padding */
+  if (id3v2mux->tag_size > GST_TAG_ID3V2_HEADER_SIZE) {
+    id3v2tag.header ()->setTagSize (id3v2mux->tag_size -
+        GST_TAG_ID3V2_HEADER_SIZE);
+  }
+
   rendered_tag = id3v2tag.render ();
   tag_size = rendered_tag.size ();
 
@@ -30,6 +30,8 @@ typedef struct _GstId3v2MuxClass GstId3v2MuxClass;
 
 struct _GstId3v2Mux {
   GstTagMux  tagmux;
+
+  guint      tag_size;
 };
 
 struct _GstId3v2MuxClass {
@@ -60,6 +60,10 @@ GST_DEBUG_CATEGORY_STATIC (gst_vp8dec_debug);
 #define DEFAULT_NOISE_LEVEL 0
 #define DEFAULT_THREADS 1
 
+/* frames in time before the postprocessing that was turned off because we
+ * were late is turned on again */
+#define QOS_RECOVER_FRAMES 25
+
 enum
 {
   PROP_0,
@@ -205,6 +209,7 @@ gst_vp8_dec_init (GstVP8Dec * gst_vp8_dec)
   gst_vp8_dec->post_processing_flags = DEFAULT_POST_PROCESSING_FLAGS;
   gst_vp8_dec->deblocking_level = DEFAULT_DEBLOCKING_LEVEL;
   gst_vp8_dec->noise_level = DEFAULT_NOISE_LEVEL;
+  gst_vp8_dec->threads = DEFAULT_THREADS;
 
   gst_video_decoder_set_needs_format (decoder, TRUE);
 }
@@ -370,6 +375,7 @@ gst_vp8_dec_image_to_buffer (GstVP8Dec * dec, const vpx_image_t * img,
 
   if (!gst_video_frame_map (&frame, info, buffer, GST_MAP_WRITE)) {
     GST_ERROR_OBJECT (dec, "Could not map video buffer");
+    return;
   }
 
   for (comp = 0; comp < 3; comp++) {
@@ -380,8 +386,13 @@ gst_vp8_dec_image_to_buffer (GstVP8Dec * dec, const vpx_image_t * img,
     deststride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, comp);
     srcstride = img->stride[comp];
 
-    /* FIXME (Edward) : Do a plane memcpy is srcstride == deststride instead
-     * of copying line by line */
+    /* with the strides of libvpx the plane is copied in one go */
+    if (srcstride == deststride) {
+      GST_LOG_OBJECT (dec, "copying plane %d in one go", comp);
+      memcpy (dest, src, srcstride * (height - 1) + width);
+      continue;
+    }
+
     for (line = 0; line < height; line++) {
       memcpy (dest, src, width);
       dest += deststride;
@@ -392,19 +403,77 @@ gst_vp8_dec_image_to_buffer (GstVP8Dec * dec, const vpx_image_t * img,
   gst_video_frame_unmap (&frame);
 }
 
+static void
+gst_vp8_dec_set_postproc (GstVP8Dec * dec, gint flags)
+{
+  vp8_postproc_cfg_t pp_cfg = { 0, };
+  vpx_codec_err_t status;
+
+  pp_cfg.post_proc_flag = flags;
+  pp_cfg.deblocking_level = dec->deblocking_level;
+  pp_cfg.noise_level = dec->noise_level;
+
+  status = vpx_codec_control (&dec->decoder, VP8_SET_POSTPROC, &pp_cfg);
+  if (status != VPX_CODEC_OK) {
+    GST_WARNING_OBJECT (dec, "Couldn't set postprocessing settings: %s",
+        gst_vpx_error_name (status));
+  }
+}
+
 static GstFlowReturn
-open_codec (GstVP8Dec * dec, GstVideoCodecFrame * frame)
+gst_vp8_dec_init_decoder (GstVP8Dec * dec, gint width, gint height)
 {
   int flags = 0;
-  vpx_codec_stream_info_t stream_info;
   vpx_codec_caps_t caps;
   vpx_codec_dec_cfg_t cfg;
+  vpx_codec_err_t status;
+
+  memset (&cfg, 0, sizeof (cfg));
+  cfg.w = width;
+  cfg.h = height;
+  cfg.threads = dec->threads;
+
+  caps = vpx_codec_get_caps (&vpx_codec_vp8_dx_algo);
+
+  dec->can_postproc = FALSE;
+  if (dec->post_processing) {
+    if (!(caps & VPX_CODEC_CAP_POSTPROC)) {
+      GST_WARNING_OBJECT (dec, "Decoder does not support post processing");
+    } else {
+      flags |= VPX_CODEC_USE_POSTPROC;
+      dec->can_postproc = TRUE;
+    }
+  }
+
+  status =
+      vpx_codec_dec_init (&dec->decoder, &vpx_codec_vp8_dx_algo, &cfg, flags);
+  if (status != VPX_CODEC_OK) {
+    GST_ELEMENT_ERROR (dec, LIBRARY, INIT,
+        ("Failed to initialize VP8 decoder"), ("%s",
+            gst_vpx_error_name (status)));
+    return GST_FLOW_ERROR;
+  }
+
+  if (dec->can_postproc)
+    gst_vp8_dec_set_postproc (dec, dec->post_processing_flags);
+
+  dec->decoder_threads = cfg.threads;
+  dec->postproc_suspended = FALSE;
+  dec->on_time_frames = 0;
+  dec->decoder_inited = TRUE;
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+open_codec (GstVP8Dec * dec, GstVideoCodecFrame * frame)
+{
+  vpx_codec_stream_info_t stream_info;
   GstVideoCodecState *state = dec->input_state;
   vpx_codec_err_t status;
   GstMapInfo minfo;
 
   memset (&stream_info, 0, sizeof (stream_info));
-  memset (&cfg, 0, sizeof (cfg));
   stream_info.sz = sizeof (stream_info);
 
   if (!gst_buffer_map (frame->input_buffer, &minfo, GST_MAP_READ)) {
@@ -433,49 +502,188 @@ open_codec (GstVP8Dec * dec, GstVideoCodecFrame * frame)
   dec->output_state =
       gst_video_decoder_set_output_state (GST_VIDEO_DECODER (dec),
       GST_VIDEO_FORMAT_I420, stream_info.w, stream_info.h, state);
+  dec->img_stride = 0;
   gst_video_decoder_negotiate (GST_VIDEO_DECODER (dec));
   gst_vp8_dec_send_tags (dec);
 
-  cfg.w = stream_info.w;
-  cfg.h = stream_info.h;
-  cfg.threads = dec->threads;
+  return gst_vp8_dec_init_decoder (dec, stream_info.w, stream_info.h);
+}
 
-  caps = vpx_codec_get_caps (&vpx_codec_vp8_dx_algo);
+/* boolean entropy decoder of RFC 6386, for the frame header */
+typedef struct
+{
+  const guint8 *data;
+  const guint8 *end;
+  guint value;
+  guint range;
+  gint bit_count;
+} GstVP8BoolDecoder;
 
-  if (dec->post_processing) {
-    if (!(caps & VPX_CODEC_CAP_POSTPROC)) {
-      GST_WARNING_OBJECT (dec, "Decoder does not support post processing");
-    } else {
-      flags |= VPX_CODEC_USE_POSTPROC;
+static void
+gst_vp8_bool_decoder_init (GstVP8BoolDecoder * bd, const guint8 * data,
+    gsize size)
+{
+  bd->data = data;
+  bd->end = data + size;
+  bd->value = 0;
+  bd->range = 255;
+  bd->bit_count = 0;
+
+  /* the decoder works on a two byte window */
+  if (bd->data < bd->end)
+    bd->value = *bd->data++ << 8;
+  if (bd->data < bd->end)
+    bd->value |= *bd->data++;
+}
+
+static guint
+gst_vp8_bool_decoder_read (GstVP8BoolDecoder * bd, guint prob)
+{
+  guint split = 1 + (((bd->range - 1) * prob) >> 8);
+  guint bigsplit = split << 8;
+  guint ret;
+
+  if (bd->value >= bigsplit) {
+    ret = 1;
+    bd->range -= split;
+    bd->value -= bigsplit;
+  } else {
+    ret = 0;
+    bd->range = split;
+  }
+
+  while (bd->range < 128) {
+    bd->value <<= 1;
+    bd->range <<= 1;
+    if (++bd->bit_count == 8) {
+      bd->bit_count = 0;
+      if (bd->data < bd->end)
+        bd->value |= *bd->data++;
     }
   }
 
-  status =
-      vpx_codec_dec_init (&dec->decoder, &vpx_codec_vp8_dx_algo, &cfg, flags);
-  if (status != VPX_CODEC_OK) {
-    GST_ELEMENT_ERROR (dec, LIBRARY, INIT,
-        ("Failed to initialize VP8 decoder"), ("%s",
-            gst_vpx_error_name (status)));
-    return GST_FLOW_ERROR;
+  return ret;
+}
+
+static guint
+gst_vp8_bool_decoder_literal (GstVP8BoolDecoder * bd, gint bits)
+{
+  guint v = 0;
+
+  while (bits--)
+    v = (v << 1) | gst_vp8_bool_decoder_read (bd, 128);
+
+  return v;
+}
+
+/* skip the optional signed values of the header that have a flag, a
+ * magnitude of @bits and a sign */
+static void
+gst_vp8_bool_decoder_skip_deltas (GstVP8BoolDecoder * bd, gint n, gint bits)
+{
+  while (n--) {
+    if (gst_vp8_bool_decoder_literal (bd, 1))
+      gst_vp8_bool_decoder_literal (bd, bits + 1);
   }
+}
+
+/* check if the frame in @data updates none of the reference frames nor
+ * the probabilities, so that skipping it doesn't affect later frames */
+static gboolean
+gst_vp8_dec_frame_is_droppable (const guint8 * data, gsize size)
+{
+  GstVP8BoolDecoder bd;
+  guint32 first_part_size;
+  gboolean refresh_golden, refresh_alt, refresh_entropy, refresh_last;
+  guint copy_golden = 0, copy_alt = 0;
+
+  if (size < 3)
+    return FALSE;
 
-  if ((caps & VPX_CODEC_CAP_POSTPROC) && dec->post_processing) {
-    vp8_postproc_cfg_t pp_cfg = { 0, };
+  /* key frames reset everything */
+  if ((data[0] & 0x1) == 0)
+    return FALSE;
+
+  first_part_size = (data[0] | (data[1] << 8) | (data[2] << 16)) >> 5;
+  if (first_part_size > size - 3)
+    return FALSE;
+
+  gst_vp8_bool_decoder_init (&bd, data + 3, first_part_size);
 
-    pp_cfg.post_proc_flag = dec->post_processing_flags;
-    pp_cfg.deblocking_level = dec->deblocking_level;
-    pp_cfg.noise_level = dec->noise_level;
+  /* segmentation */
+  if (gst_vp8_bool_decoder_literal (&bd, 1)) {
+    gboolean update_map, update_data;
 
-    status = vpx_codec_control (&dec->decoder, VP8_SET_POSTPROC, &pp_cfg);
-    if (status != VPX_CODEC_OK) {
-      GST_WARNING_OBJECT (dec, "Couldn't set postprocessing settings: %s",
-          gst_vpx_error_name (status));
+    update_map = gst_vp8_bool_decoder_literal (&bd, 1);
+    update_data = gst_vp8_bool_decoder_literal (&bd, 1);
+    if (update_data) {
+      gst_vp8_bool_decoder_literal (&bd, 1);
+      /* quantizer and loop filter level per segment */
+      gst_vp8_bool_decoder_skip_deltas (&bd, 4, 7);
+      gst_vp8_bool_decoder_skip_deltas (&bd, 4, 6);
+    }
+    if (update_map) {
+      gint i;
+
+      for (i = 0; i < 3; i++) {
+        if (gst_vp8_bool_decoder_literal (&bd, 1))
+          gst_vp8_bool_decoder_literal (&bd, 8);
+      }
     }
   }
 
-  dec->decoder_inited = TRUE;
+  /* filter type, loop filter level and sharpness */
+  gst_vp8_bool_decoder_literal (&bd, 1 + 6 + 3);
 
-  return GST_FLOW_OK;
+  /* loop filter deltas of the reference frames and modes */
+  if (gst_vp8_bool_decoder_literal (&bd, 1)) {
+    if (gst_vp8_bool_decoder_literal (&bd, 1))
+      gst_vp8_bool_decoder_skip_deltas (&bd, 8, 6);
+  }
+
+  /* number of token partitions */
+  gst_vp8_bool_decoder_literal (&bd, 2);
+
+  /* quantizer index and the deltas */
+  gst_vp8_bool_decoder_literal (&bd, 7);
+  gst_vp8_bool_decoder_skip_deltas (&bd, 5, 4);
+
+  refresh_golden = gst_vp8_bool_decoder_literal (&bd, 1);
+  refresh_alt = gst_vp8_bool_decoder_literal (&bd, 1);
+  if (!refresh_golden)
+    copy_golden = gst_vp8_bool_decoder_literal (&bd, 2);
+  if (!refresh_alt)
+    copy_alt = gst_vp8_bool_decoder_literal (&bd, 2);
+  /* sign bias of the golden and altref frames */
+  gst_vp8_bool_decoder_literal (&bd, 2);
+  refresh_entropy = gst_vp8_bool_decoder_literal (&bd, 1);
+  refresh_last = gst_vp8_bool_decoder_literal (&bd, 1);
+
+  return !refresh_golden && !refresh_alt && copy_golden == 0 &&
+      copy_alt == 0 && !refresh_entropy && !refresh_last;
+}
+
+/* turn off the postprocessing while we are late and turn it on again once
+ * we have been in time for a while */
+static void
+gst_vp8_dec_update_qos (GstVP8Dec * dec, GstClockTimeDiff deadline)
+{
+  if (!dec->can_postproc || dec->post_processing_flags == 0)
+    return;
+
+  if (deadline < 0) {
+    dec->on_time_frames = 0;
+    if (!dec->postproc_suspended) {
+      GST_DEBUG_OBJECT (dec, "late, turning off postprocessing");
+      gst_vp8_dec_set_postproc (dec, 0);
+      dec->postproc_suspended = TRUE;
+    }
+  } else if (dec->postproc_suspended &&
+      ++dec->on_time_frames >= QOS_RECOVER_FRAMES) {
+    GST_DEBUG_OBJECT (dec, "caught up, turning on postprocessing");
+    gst_vp8_dec_set_postproc (dec, dec->post_processing_flags);
+    dec->postproc_suspended = FALSE;
+  }
 }
 
 static GstFlowReturn
@@ -516,6 +724,35 @@ gst_vp8_dec_handle_frame (GstVideoDecoder * decoder, GstVideoCodecFrame * frame)
     return GST_FLOW_ERROR;
   }
 
+  /* the decoder can only start over with another number of threads at a
+   * key frame */
+  if (dec->threads != dec->decoder_threads && minfo.size > 0 &&
+      (minfo.data[0] & 0x1) == 0) {
+    GST_DEBUG_OBJECT (dec, "switching to %d threads", dec->threads);
+    vpx_codec_destroy (&dec->decoder);
+    dec->decoder_inited = FALSE;
+    ret = gst_vp8_dec_init_decoder (dec,
+        GST_VIDEO_INFO_WIDTH (&dec->output_state->info),
+        GST_VIDEO_INFO_HEIGHT (&dec->output_state->info));
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_unmap (frame->input_buffer, &minfo);
+      return ret;
+    }
+  }
+
+  /* a late frame would be dropped after decoding, don't decode it at all
+   * when no other frame needs it */
+  if (deadline < 0 && gst_vp8_dec_frame_is_droppable (minfo.data,
+          minfo.size)) {
+    GST_LOG_OBJECT (dec, "Skipping late non-reference frame (%f s past "
+        "deadline)", (double) -deadline / GST_SECOND);
+    gst_buffer_unmap (frame->input_buffer, &minfo);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_OK;
+  }
+
+  gst_vp8_dec_update_qos (dec, deadline);
+
   status = vpx_codec_decode (&dec->decoder,
       minfo.data, minfo.size, NULL, decoder_deadline);
 
@@ -542,6 +779,15 @@ gst_vp8_dec_handle_frame (GstVideoDecoder * decoder, GstVideoCodecFrame * frame)
           (double) -deadline / GST_SECOND);
       gst_video_decoder_drop_frame (decoder, frame);
     } else {
+      /* ask downstream again for buffers with the layout of libvpx once we
+       * know it, so that the planes can be copied in one go */
+      if (dec->img_stride != img->stride[VPX_PLANE_Y]) {
+        GST_DEBUG_OBJECT (dec, "libvpx uses stride %d",
+            img->stride[VPX_PLANE_Y]);
+        dec->img_stride = img->stride[VPX_PLANE_Y];
+        gst_pad_mark_reconfigure (GST_VIDEO_DECODER_SRC_PAD (dec));
+      }
+
       ret = gst_video_decoder_allocate_output_frame (decoder, frame);
 
       if (ret == GST_FLOW_OK) {
@@ -570,6 +816,7 @@ gst_vp8_dec_handle_frame (GstVideoDecoder * decoder, GstVideoCodecFrame * frame)
 static gboolean
 gst_vp8_dec_decide_allocation (GstVideoDecoder * bdec, GstQuery * query)
 {
+  GstVP8Dec *dec = GST_VP8_DEC (bdec);
   GstBufferPool *pool;
   GstStructure *config;
 
@@ -584,6 +831,24 @@ gst_vp8_dec_decide_allocation (GstVideoDecoder * bdec, GstQuery * query)
   if (gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL)) {
     gst_buffer_pool_config_add_option (config,
         GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+    /* pad the frames to the stride of the libvpx images. The chroma planes
+     * of those have half the luma stride, like the I420 layout of a video
+     * pool */
+    if (dec->img_stride > 0 && dec->output_state &&
+        gst_buffer_pool_has_option (pool,
+            GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT)) {
+      GstVideoAlignment align;
+      gint width = GST_VIDEO_INFO_WIDTH (&dec->output_state->info);
+
+      gst_video_alignment_reset (&align);
+      if (dec->img_stride > width)
+        align.padding_right = dec->img_stride - width;
+
+      gst_buffer_pool_config_add_option (config,
+          GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+      gst_buffer_pool_config_set_video_alignment (config, &align);
+    }
   }
   gst_buffer_pool_set_config (pool, config);
   gst_object_unref (pool);
@@ -66,6 +66,12 @@ struct _GstVP8Dec
 
   /* state */
   gboolean decoder_inited;
+  gint decoder_threads;         /* threads the decoder was opened with */
+  gboolean can_postproc;
+
+  /* QoS */
+  gboolean postproc_suspended;
+  guint on_time_frames;
 
   /* properties */
   gboolean post_processing;
@@ -76,6 +82,9 @@ struct _GstVP8Dec
 
   GstVideoCodecState *input_state;
   GstVideoCodecState *output_state;
+
+  /* luma stride of the images of libvpx, 0 when not known yet */
+  gint img_stride;
 };
 
 struct _GstVP8DecClass
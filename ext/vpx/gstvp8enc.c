@@ -2098,6 +2098,7 @@ static gboolean
 gst_vp8_enc_propose_allocation (GstVideoEncoder * encoder, GstQuery * query)
 {
   gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+  gst_vpx_propose_allocation_pool (query);
 
   return GST_VIDEO_ENCODER_CLASS (parent_class)->propose_allocation (encoder,
       query);
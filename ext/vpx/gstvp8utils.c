@@ -25,6 +25,8 @@
 #endif
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/video/gstvideopool.h>
 
 /* FIXME: Undef HAVE_CONFIG_H because vpx_codec.h uses it,
  * which causes compilation failures */
@@ -62,3 +64,54 @@ gst_vpx_error_name (vpx_codec_err_t status)
       return "unknown";
   }
 }
+
+/* offer upstream a pool of input frames whose rows start on 32 byte
+ * boundaries, the encoders read them without copying */
+void
+gst_vpx_propose_allocation_pool (GstQuery * query)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstVideoAlignment align;
+  GstVideoInfo info;
+  GstCaps *caps;
+  gboolean need_pool;
+  guint size, i;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+  if (!need_pool || caps == NULL || !gst_video_info_from_caps (&info, caps))
+    return;
+
+  pool = gst_video_buffer_pool_new ();
+
+  gst_video_alignment_reset (&align);
+  for (i = 0; i < GST_VIDEO_MAX_PLANES; i++)
+    align.stride_align[i] = 31;
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, info.size, 0, 0);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  gst_buffer_pool_config_add_option (config,
+      GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+  gst_buffer_pool_config_set_video_alignment (config, &align);
+  if (!gst_buffer_pool_set_config (pool, config))
+    goto config_failed;
+
+  /* the pool computes the size of the aligned frames */
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL);
+  gst_structure_free (config);
+
+  gst_query_add_allocation_pool (query, pool, size, 0, 0);
+  gst_object_unref (pool);
+
+  return;
+
+  /* ERRORS */
+config_failed:
+  {
+    GST_WARNING ("failed to configure the input pool");
+    gst_object_unref (pool);
+    return;
+  }
+}
@@ -44,4 +44,6 @@ G_BEGIN_DECLS
 
 const char * gst_vpx_error_name (vpx_codec_err_t status);
 
+void gst_vpx_propose_allocation_pool (GstQuery * query);
+
 G_END_DECLS
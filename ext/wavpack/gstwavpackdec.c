@@ -57,6 +57,35 @@
 GST_DEBUG_CATEGORY_STATIC (gst_wavpack_dec_debug);
 #define GST_CAT_DEFAULT gst_wavpack_dec_debug
 
+#define DEFAULT_N_THREADS 1
+
+enum
+{
+  PROP_0,
+  PROP_N_THREADS
+};
+
+/* one frame of a batch, the context reads the mapped input through
+ * @wv_id so a job has to stay at the same address */
+struct _GstWavpackDecJob
+{
+  WavpackContext *context;
+  read_id wv_id;
+
+  GstBuffer *input;
+  GstMapInfo map;
+  guint32 block_samples;
+
+  GstBuffer *output;
+  GstMapInfo omap;
+
+  /* unpacked samples when they can't go to the output directly */
+  gint32 *samples;
+  gsize n_samples;
+
+  gboolean failed;
+};
+
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -91,9 +120,19 @@ static gboolean gst_wavpack_dec_set_format (GstAudioDecoder * dec,
     GstCaps * caps);
 static GstFlowReturn gst_wavpack_dec_handle_frame (GstAudioDecoder * dec,
     GstBuffer * buffer);
+static void gst_wavpack_dec_flush (GstAudioDecoder * dec, gboolean hard);
 
 static void gst_wavpack_dec_finalize (GObject * object);
+static void gst_wavpack_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_wavpack_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_wavpack_dec_post_tags (GstWavpackDec * dec);
+static void gst_wavpack_dec_decode_job (gpointer data, gpointer context,
+    guint index);
+static GstFlowReturn gst_wavpack_dec_finish_job (gpointer data,
+    gpointer context);
+static void gst_wavpack_dec_clear_job (gpointer data, gpointer context);
 
 #define gst_wavpack_dec_parent_class parent_class
 G_DEFINE_TYPE (GstWavpackDec, gst_wavpack_dec, GST_TYPE_AUDIO_DECODER);
@@ -116,19 +155,34 @@ gst_wavpack_dec_class_init (GstWavpackDecClass * klass)
       "Sebastian Dröge <slomo@circular-chaos.org>");
 
   gobject_class->finalize = gst_wavpack_dec_finalize;
+  gobject_class->set_property = gst_wavpack_dec_set_property;
+  gobject_class->get_property = gst_wavpack_dec_get_property;
+
+  /**
+   * GstWavpackDec:n-threads:
+   *
+   * The number of threads that decode frames. With more than one thread the
+   * frames are decoded in batches of one frame per thread, which adds up to
+   * n-threads - 1 frames of latency. Changes take effect the next time the
+   * element starts.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to decode frames", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   base_class->start = GST_DEBUG_FUNCPTR (gst_wavpack_dec_start);
   base_class->stop = GST_DEBUG_FUNCPTR (gst_wavpack_dec_stop);
   base_class->set_format = GST_DEBUG_FUNCPTR (gst_wavpack_dec_set_format);
   base_class->handle_frame = GST_DEBUG_FUNCPTR (gst_wavpack_dec_handle_frame);
+  base_class->flush = GST_DEBUG_FUNCPTR (gst_wavpack_dec_flush);
 }
 
 static void
 gst_wavpack_dec_reset (GstWavpackDec * dec)
 {
-  dec->wv_id.buffer = NULL;
-  dec->wv_id.position = dec->wv_id.length = 0;
-
   dec->channels = 0;
   dec->channel_mask = 0;
   dec->sample_rate = 0;
@@ -138,8 +192,8 @@ gst_wavpack_dec_reset (GstWavpackDec * dec)
 static void
 gst_wavpack_dec_init (GstWavpackDec * dec)
 {
-  dec->context = NULL;
   dec->stream_reader = gst_wavpack_stream_reader_new ();
+  dec->n_threads = DEFAULT_N_THREADS;
 
   gst_audio_decoder_set_needs_format (GST_AUDIO_DECODER (dec), TRUE);
 
@@ -157,31 +211,103 @@ gst_wavpack_dec_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_wavpack_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstWavpackDec *dec = GST_WAVPACK_DEC (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      dec->n_threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_wavpack_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstWavpackDec *dec = GST_WAVPACK_DEC (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      g_value_set_uint (value, dec->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_wavpack_dec_start (GstAudioDecoder * dec)
 {
+  GstWavpackDec *wpdec = GST_WAVPACK_DEC (dec);
+  guint n;
+
   GST_DEBUG_OBJECT (dec, "start");
 
+  wpdec->batch = gst_work_batch_new (wpdec->n_threads,
+      sizeof (GstWavpackDecJob), gst_wavpack_dec_decode_job,
+      gst_wavpack_dec_finish_job, gst_wavpack_dec_clear_job, wpdec);
+  n = gst_work_batch_get_size (wpdec->batch);
+  GST_DEBUG_OBJECT (dec, "decoding with %u threads", n);
+
   /* never mind a few errors */
   gst_audio_decoder_set_max_errors (dec, 16);
-  /* don't bother us with flushing */
-  gst_audio_decoder_set_drainable (dec, FALSE);
+  /* don't bother us with flushing, unless frames wait for a batch */
+  gst_audio_decoder_set_drainable (dec, n > 1);
   /* aim for some perfect timestamping */
   gst_audio_decoder_set_tolerance (dec, 10 * GST_MSECOND);
 
   return TRUE;
 }
 
+/* forget a frame that waits for a batch */
+static void
+gst_wavpack_dec_clear_job (gpointer data, gpointer context)
+{
+  GstWavpackDecJob *job = context;
+
+  gst_buffer_unmap (job->input, &job->map);
+  gst_buffer_unref (job->input);
+  job->input = NULL;
+  gst_buffer_unmap (job->output, &job->omap);
+  gst_buffer_unref (job->output);
+  job->output = NULL;
+}
+
+static void
+gst_wavpack_dec_close_job (GstWavpackDecJob * job)
+{
+  if (job->context) {
+    WavpackCloseFile (job->context);
+    job->context = NULL;
+  }
+}
+
 static gboolean
 gst_wavpack_dec_stop (GstAudioDecoder * dec)
 {
   GstWavpackDec *wpdec = GST_WAVPACK_DEC (dec);
+  guint i;
 
   GST_DEBUG_OBJECT (dec, "stop");
 
-  if (wpdec->context) {
-    WavpackCloseFile (wpdec->context);
-    wpdec->context = NULL;
+  if (wpdec->batch) {
+    gst_work_batch_clear (wpdec->batch);
+    for (i = 0; i < gst_work_batch_get_size (wpdec->batch); i++) {
+      GstWavpackDecJob *job = gst_work_batch_get_context (wpdec->batch, i);
+
+      gst_wavpack_dec_close_job (job);
+      g_free (job->samples);
+    }
+    gst_work_batch_free (wpdec->batch);
+    wpdec->batch = NULL;
   }
 
   gst_wavpack_dec_reset (wpdec);
@@ -189,12 +315,22 @@ gst_wavpack_dec_stop (GstAudioDecoder * dec)
   return TRUE;
 }
 
+static void
+gst_wavpack_dec_flush (GstAudioDecoder * dec, gboolean hard)
+{
+  GstWavpackDec *wpdec = GST_WAVPACK_DEC (dec);
+
+  if (wpdec->batch)
+    gst_work_batch_clear (wpdec->batch);
+}
+
 static void
 gst_wavpack_dec_negotiate (GstWavpackDec * dec)
 {
   GstAudioInfo info;
   GstAudioFormat fmt;
   GstAudioChannelPosition pos[64] = { GST_AUDIO_CHANNEL_POSITION_INVALID, };
+  gint i;
 
   /* arrange for 1, 2 or 4-byte width == depth output */
   dec->width = dec->depth;
@@ -229,6 +365,12 @@ gst_wavpack_dec_negotiate (GstWavpackDec * dec)
   gst_audio_get_channel_reorder_map (info.channels,
       info.position, pos, dec->channel_reorder_map);
 
+  dec->reorder = FALSE;
+  for (i = 0; i < dec->channels; i++) {
+    if (dec->channel_reorder_map[i] != i)
+      dec->reorder = TRUE;
+  }
+
   /* should always succeed */
   gst_audio_decoder_set_output_format (GST_AUDIO_DECODER (dec), &info);
 }
@@ -266,23 +408,152 @@ gst_wavpack_dec_post_tags (GstWavpackDec * dec)
   }
 }
 
+/* convert the unpacked samples to the output format. libwavpack hands out
+ * every sample in a gint32, without reordering the loops are simple enough
+ * for the compiler to vectorise them */
+static void
+gst_wavpack_dec_pack (GstWavpackDec * dec, GstWavpackDecJob * job,
+    const gint32 * in)
+{
+  const gint *reorder_map = dec->channel_reorder_map;
+  gint channels = dec->channels;
+  gint shift = dec->width - dec->depth;
+  guint i, max = job->block_samples * channels;
+  gint j;
+
+  if (dec->width == 8) {
+    gint8 *out = (gint8 *) job->omap.data;
+
+    if (!dec->reorder) {
+      for (i = 0; i < max; i++)
+        out[i] = (gint8) in[i];
+    } else {
+      for (i = 0; i < max; i += channels) {
+        for (j = 0; j < channels; j++)
+          out[i + j] = (gint8) in[i + reorder_map[j]];
+      }
+    }
+  } else if (dec->width == 16) {
+    gint16 *out = (gint16 *) job->omap.data;
+
+    if (!dec->reorder) {
+      for (i = 0; i < max; i++)
+        out[i] = (gint16) in[i];
+    } else {
+      for (i = 0; i < max; i += channels) {
+        for (j = 0; j < channels; j++)
+          out[i + j] = (gint16) in[i + reorder_map[j]];
+      }
+    }
+  } else if (dec->width == 32) {
+    gint32 *out = (gint32 *) job->omap.data;
+
+    /* without reordering the samples were unpacked into the output */
+    if (!dec->reorder) {
+      if (shift != 0) {
+        for (i = 0; i < max; i++)
+          out[i] = (gint32) ((guint32) in[i] << shift);
+      }
+    } else {
+      for (i = 0; i < max; i += channels) {
+        for (j = 0; j < channels; j++)
+          out[i + j] = (gint32) ((guint32) in[i + reorder_map[j]] << shift);
+      }
+    }
+  } else {
+    g_assert_not_reached ();
+  }
+}
+
+/* decode the frame of @job into its output buffer, this may run on one of
+ * the worker threads so errors are only recorded in @job */
+static void
+gst_wavpack_dec_decode_job (gpointer data, gpointer context, guint index)
+{
+  GstWavpackDec *dec = data;
+  GstWavpackDecJob *job = context;
+  gsize n_samples = (gsize) job->block_samples * dec->channels;
+  int32_t decoded;
+  gint32 *samples;
+
+  if (dec->width == 32 && !dec->reorder) {
+    samples = (gint32 *) job->omap.data;
+  } else {
+    if (job->n_samples < n_samples) {
+      g_free (job->samples);
+      job->samples = g_new (gint32, n_samples);
+      job->n_samples = n_samples;
+    }
+    samples = job->samples;
+  }
+
+  decoded = WavpackUnpackSamples (job->context, samples, job->block_samples);
+  if (decoded != job->block_samples) {
+    job->failed = TRUE;
+    return;
+  }
+
+  gst_wavpack_dec_pack (dec, job, samples);
+}
+
+/* push the decoded frame of @job */
+static GstFlowReturn
+gst_wavpack_dec_finish_job (gpointer data, gpointer context)
+{
+  GstWavpackDec *dec = data;
+  GstWavpackDecJob *job = context;
+  GstAudioDecoder *bdec = GST_AUDIO_DECODER (dec);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *outbuf;
+
+  gst_buffer_unmap (job->input, &job->map);
+  gst_buffer_unref (job->input);
+  job->input = NULL;
+
+  gst_buffer_unmap (job->output, &job->omap);
+  outbuf = job->output;
+  job->output = NULL;
+
+  if (G_UNLIKELY (job->failed))
+    goto decode_error;
+
+  return gst_audio_decoder_finish_frame (bdec, outbuf, 1);
+
+  /* ERRORS */
+decode_error:
+  {
+    const gchar *reason;
+
+#ifdef WAVPACK_OLD_API
+    reason = job->context->error_message;
+#else
+    reason = WavpackGetErrorMessage (job->context);
+#endif
+    GST_AUDIO_DECODER_ERROR (bdec, 1, STREAM, DECODE, (NULL),
+        ("decoding error: %s", reason), ret);
+    gst_buffer_unref (outbuf);
+    if (ret == GST_FLOW_OK)
+      gst_audio_decoder_finish_frame (bdec, NULL, 1);
+    return ret;
+  }
+}
+
 static GstFlowReturn
 gst_wavpack_dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buf)
 {
   GstWavpackDec *dec;
-  GstBuffer *outbuf = NULL;
+  GstWavpackDecJob *job;
   GstFlowReturn ret = GST_FLOW_OK;
   WavpackHeader wph;
-  int32_t decoded, unpacked_size;
+  gint unpacked_size;
   gboolean format_changed;
-  gint width, depth, i, j, max;
-  gint32 *dec_data = NULL;
-  guint8 *out_data;
-  GstMapInfo map, omap;
+  GstMapInfo map;
 
   dec = GST_WAVPACK_DEC (bdec);
 
-  g_return_val_if_fail (buf != NULL, GST_FLOW_ERROR);
+  /* draining, decode the frames that wait for a batch */
+  if (buf == NULL)
+    return gst_work_batch_flush (dec->batch);
 
   gst_buffer_map (buf, &map, GST_MAP_READ);
 
@@ -299,50 +570,66 @@ gst_wavpack_dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buf)
   if (!(wph.flags & INITIAL_BLOCK))
     goto input_not_framed;
 
-  dec->wv_id.buffer = map.data;
-  dec->wv_id.length = map.size;
-  dec->wv_id.position = 0;
+  job = gst_work_batch_peek (dec->batch);
+  job->wv_id.buffer = map.data;
+  job->wv_id.length = map.size;
+  job->wv_id.position = 0;
 
   /* create a new wavpack context if there is none yet but if there
    * was already one (i.e. caps were set on the srcpad) check whether
    * the new one has the same caps */
-  if (!dec->context) {
+  if (!job->context) {
     gchar error_msg[80];
 
-    dec->context = WavpackOpenFileInputEx (dec->stream_reader,
-        &dec->wv_id, NULL, error_msg, OPEN_STREAMING, 0);
+    job->context = WavpackOpenFileInputEx (dec->stream_reader,
+        &job->wv_id, NULL, error_msg, OPEN_STREAMING, 0);
 
     /* expect this to work */
-    if (!dec->context) {
+    if (!job->context) {
       GST_WARNING_OBJECT (dec, "Couldn't decode buffer: %s", error_msg);
       goto context_failed;
     }
   }
 
-  g_assert (dec->context != NULL);
+  g_assert (job->context != NULL);
 
   format_changed =
-      (dec->sample_rate != WavpackGetSampleRate (dec->context)) ||
-      (dec->channels != WavpackGetNumChannels (dec->context)) ||
-      (dec->depth != WavpackGetBytesPerSample (dec->context) * 8) ||
+      (dec->sample_rate != WavpackGetSampleRate (job->context)) ||
+      (dec->channels != WavpackGetNumChannels (job->context)) ||
+      (dec->depth != WavpackGetBytesPerSample (job->context) * 8) ||
 #ifdef WAVPACK_OLD_API
-      (dec->channel_mask != dec->context->config.channel_mask);
+      (dec->channel_mask != job->context->config.channel_mask);
 #else
-      (dec->channel_mask != WavpackGetChannelMask (dec->context));
+      (dec->channel_mask != WavpackGetChannelMask (job->context));
 #endif
 
   if (!gst_pad_has_current_caps (GST_AUDIO_DECODER_SRC_PAD (dec)) ||
       format_changed) {
     gint channel_mask;
+    GstClockTime latency;
+    guint i;
+
+    /* the frames of the old format go out first, the current frame then
+     * starts a new batch */
+    ret = gst_work_batch_flush (dec->batch);
+    if (ret != GST_FLOW_OK)
+      goto out;
+    /* the other contexts were opened on the old format */
+    for (i = 0; i < gst_work_batch_get_size (dec->batch); i++) {
+      GstWavpackDecJob *other = gst_work_batch_get_context (dec->batch, i);
+
+      if (other != job)
+        gst_wavpack_dec_close_job (other);
+    }
 
-    dec->sample_rate = WavpackGetSampleRate (dec->context);
-    dec->channels = WavpackGetNumChannels (dec->context);
-    dec->depth = WavpackGetBytesPerSample (dec->context) * 8;
+    dec->sample_rate = WavpackGetSampleRate (job->context);
+    dec->channels = WavpackGetNumChannels (job->context);
+    dec->depth = WavpackGetBytesPerSample (job->context) * 8;
 
 #ifdef WAVPACK_OLD_API
-    channel_mask = dec->context->config.channel_mask;
+    channel_mask = job->context->config.channel_mask;
 #else
-    channel_mask = WavpackGetChannelMask (dec->context);
+    channel_mask = WavpackGetChannelMask (job->context);
 #endif
     if (channel_mask == 0)
       channel_mask = gst_wavpack_get_default_channel_mask (dec->channels);
@@ -351,74 +638,34 @@ gst_wavpack_dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buf)
 
     gst_wavpack_dec_negotiate (dec);
 
+    /* a frame waits for the rest of its batch */
+    latency = gst_work_batch_get_latency (dec->batch, dec->sample_rate,
+        wph.block_samples);
+    if (latency > 0)
+      gst_audio_decoder_set_latency (bdec, latency, latency);
+
     /* send GST_TAG_AUDIO_CODEC and GST_TAG_BITRATE tags before something
      * is decoded or after the format has changed */
     gst_wavpack_dec_post_tags (dec);
   }
 
   /* alloc output buffer */
-  dec_data = g_malloc (4 * wph.block_samples * dec->channels);
-
-  /* decode */
-  decoded = WavpackUnpackSamples (dec->context, dec_data, wph.block_samples);
-  if (decoded != wph.block_samples)
-    goto decode_error;
-
   unpacked_size = (dec->width / 8) * wph.block_samples * dec->channels;
-  outbuf = gst_buffer_new_and_alloc (unpacked_size);
+  job->output = gst_audio_decoder_allocate_output_buffer (bdec, unpacked_size);
 
   /* legacy; pass along offset, whatever that might entail */
-  GST_BUFFER_OFFSET (outbuf) = GST_BUFFER_OFFSET (buf);
-
-  gst_buffer_map (outbuf, &omap, GST_MAP_WRITE);
-  out_data = omap.data;
-
-  width = dec->width;
-  depth = dec->depth;
-  max = dec->channels * wph.block_samples;
-  if (width == 8) {
-    gint8 *outbuffer = (gint8 *) out_data;
-    gint *reorder_map = dec->channel_reorder_map;
+  GST_BUFFER_OFFSET (job->output) = GST_BUFFER_OFFSET (buf);
 
-    for (i = 0; i < max; i += dec->channels) {
-      for (j = 0; j < dec->channels; j++)
-        *outbuffer++ = (gint8) (dec_data[i + reorder_map[j]]);
-    }
-  } else if (width == 16) {
-    gint16 *outbuffer = (gint16 *) out_data;
-    gint *reorder_map = dec->channel_reorder_map;
-
-    for (i = 0; i < max; i += dec->channels) {
-      for (j = 0; j < dec->channels; j++)
-        *outbuffer++ = (gint16) (dec_data[i + reorder_map[j]]);
-    }
-  } else if (dec->width == 32) {
-    gint32 *outbuffer = (gint32 *) out_data;
-    gint *reorder_map = dec->channel_reorder_map;
-
-    if (width != depth) {
-      for (i = 0; i < max; i += dec->channels) {
-        for (j = 0; j < dec->channels; j++)
-          *outbuffer++ =
-              (gint32) (dec_data[i + reorder_map[j]] << (width - depth));
-      }
-    } else {
-      for (i = 0; i < max; i += dec->channels) {
-        for (j = 0; j < dec->channels; j++)
-          *outbuffer++ = (gint32) (dec_data[i + reorder_map[j]]);
-      }
-    }
-  } else {
-    g_assert_not_reached ();
-  }
+  gst_buffer_map (job->output, &job->omap, GST_MAP_WRITE);
 
-  gst_buffer_unmap (outbuf, &omap);
-  gst_buffer_unmap (buf, &map);
+  /* the job keeps the input mapped until it is decoded */
+  job->input = gst_buffer_ref (buf);
+  job->map = map;
+  job->block_samples = wph.block_samples;
+  job->failed = FALSE;
   buf = NULL;
 
-  g_free (dec_data);
-
-  ret = gst_audio_decoder_finish_frame (bdec, outbuf, 1);
+  ret = gst_work_batch_queue (dec->batch);
 
 out:
   if (buf)
@@ -445,28 +692,11 @@ invalid_header:
   }
 context_failed:
   {
-    GST_AUDIO_DECODER_ERROR (bdec, 1, LIBRARY, INIT, (NULL),
-        ("error creating Wavpack context"), ret);
-    goto out;
-  }
-decode_error:
-  {
-    const gchar *reason = "unknown";
-
-    if (dec->context) {
-#ifdef WAVPACK_OLD_API
-      reason = dec->context->error_message;
-#else
-      reason = WavpackGetErrorMessage (dec->context);
-#endif
-    } else {
-      reason = "couldn't create decoder context";
-    }
-    GST_AUDIO_DECODER_ERROR (bdec, 1, STREAM, DECODE, (NULL),
-        ("decoding error: %s", reason), ret);
-    g_free (dec_data);
+    /* the frames before this one go out first */
+    ret = gst_work_batch_flush (dec->batch);
     if (ret == GST_FLOW_OK)
-      gst_audio_decoder_finish_frame (bdec, NULL, 1);
+      GST_AUDIO_DECODER_ERROR (bdec, 1, LIBRARY, INIT, (NULL),
+          ("error creating Wavpack context"), ret);
     goto out;
   }
 }
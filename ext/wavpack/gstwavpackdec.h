@@ -29,6 +29,7 @@
 #include <wavpack/wavpack.h>
 
 #include "gstwavpackstreamreader.h"
+#include <gst/workers/gstworkbatch.h>
 
 G_BEGIN_DECLS
 #define GST_TYPE_WAVPACK_DEC \
@@ -43,6 +44,7 @@ G_BEGIN_DECLS
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_WAVPACK_DEC))
 typedef struct _GstWavpackDec GstWavpackDec;
 typedef struct _GstWavpackDecClass GstWavpackDecClass;
+typedef struct _GstWavpackDecJob GstWavpackDecJob;
 
 struct _GstWavpackDec
 {
@@ -50,10 +52,12 @@ struct _GstWavpackDec
 
   /*< private > */
 
-  WavpackContext *context;
   WavpackStreamReader *stream_reader;
 
-  read_id wv_id;
+  /* frames are decoded in batches of one frame per thread, every job has
+   * a context of its own */
+  guint n_threads;
+  GstWorkBatch *batch;
 
   gint sample_rate;
   gint depth;
@@ -62,6 +66,7 @@ struct _GstWavpackDec
   gint channel_mask;
 
   gint channel_reorder_map[64];
+  gboolean reorder;
 
 };
 
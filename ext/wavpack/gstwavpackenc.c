@@ -64,8 +64,15 @@ static GstFlowReturn gst_wavpack_enc_handle_frame (GstAudioEncoder * enc,
 static gboolean gst_wavpack_enc_sink_event (GstAudioEncoder * enc,
     GstEvent * event);
 
+static void gst_wavpack_enc_flush (GstAudioEncoder * enc);
+
 static int gst_wavpack_enc_push_block (void *id, void *data, int32_t count);
 static GstFlowReturn gst_wavpack_enc_drain (GstWavpackEnc * enc);
+static void gst_wavpack_enc_encode_job (gpointer data, gpointer context,
+    guint index);
+static GstFlowReturn gst_wavpack_enc_finish_job (gpointer data,
+    gpointer context);
+static void gst_wavpack_enc_clear_job (gpointer data, gpointer context);
 
 static void gst_wavpack_enc_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -81,7 +88,44 @@ enum
   ARG_CORRECTION_MODE,
   ARG_MD5,
   ARG_EXTRA_PROCESSING,
-  ARG_JOINT_STEREO_MODE
+  ARG_JOINT_STEREO_MODE,
+  ARG_N_THREADS
+};
+
+#define DEFAULT_N_THREADS 1
+
+/* seconds of samples in the job of one thread */
+#define JOB_SECONDS 2
+
+typedef struct
+{
+  GstWavpackEncJob *job;
+  gboolean correction;
+} GstWavpackEncJobID;
+
+/* one write of libwavpack, in the output of a job */
+typedef struct
+{
+  gboolean correction;
+  guint offset;
+  guint size;
+} GstWavpackEncChunk;
+
+/* samples that are encoded on one of the threads, the blocks libwavpack
+ * writes are collected until they are pushed in order */
+struct _GstWavpackEncJob
+{
+  GstWavpackEncJobID wv_id;
+  GstWavpackEncJobID wvc_id;
+
+  gint32 *samples;
+  guint n_samples;
+  guint32 sample_index;
+  gboolean final;
+
+  GByteArray *output;
+  GArray *chunks;
+  gboolean failed;
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_wavpack_enc_debug);
@@ -233,6 +277,7 @@ gst_wavpack_enc_class_init (GstWavpackEncClass * klass)
   base_class->set_format = GST_DEBUG_FUNCPTR (gst_wavpack_enc_set_format);
   base_class->handle_frame = GST_DEBUG_FUNCPTR (gst_wavpack_enc_handle_frame);
   base_class->sink_event = GST_DEBUG_FUNCPTR (gst_wavpack_enc_sink_event);
+  base_class->flush = GST_DEBUG_FUNCPTR (gst_wavpack_enc_flush);
 
   /* install all properties */
   g_object_class_install_property (gobject_class, ARG_MODE,
@@ -268,6 +313,21 @@ gst_wavpack_enc_class_init (GstWavpackEncClass * klass)
           "Use this joint-stereo mode.", GST_TYPE_WAVPACK_ENC_JOINT_STEREO_MODE,
           GST_WAVPACK_JS_MODE_AUTO,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWavpackEnc:n-threads:
+   *
+   * The number of threads that encode samples. With more than one thread
+   * the samples are encoded in jobs of two seconds, one job per thread and
+   * every job with an encoder of its own, which adds up to n-threads jobs
+   * of latency. Changes take effect the next time the element starts.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to encode samples", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -344,6 +404,7 @@ gst_wavpack_enc_init (GstWavpackEnc * enc)
   enc->md5 = FALSE;
   enc->extra_processing = 0;
   enc->joint_stereo_mode = GST_WAVPACK_JS_MODE_AUTO;
+  enc->n_threads = DEFAULT_N_THREADS;
 
   /* require perfect ts */
   gst_audio_encoder_set_perfect_timestamp (benc, TRUE);
@@ -353,8 +414,31 @@ gst_wavpack_enc_init (GstWavpackEnc * enc)
 static gboolean
 gst_wavpack_enc_start (GstAudioEncoder * enc)
 {
+  GstWavpackEnc *wpenc = GST_WAVPACK_ENC (enc);
+  guint i;
+
   GST_DEBUG_OBJECT (enc, "start");
 
+  if (wpenc->n_threads > 1) {
+    wpenc->batch = gst_work_batch_new (wpenc->n_threads,
+        sizeof (GstWavpackEncJob), gst_wavpack_enc_encode_job,
+        gst_wavpack_enc_finish_job, gst_wavpack_enc_clear_job, wpenc);
+    GST_DEBUG_OBJECT (enc, "encoding with %u threads",
+        gst_work_batch_get_size (wpenc->batch));
+
+    for (i = 0; i < gst_work_batch_get_size (wpenc->batch); i++) {
+      GstWavpackEncJob *job = gst_work_batch_get_context (wpenc->batch, i);
+
+      job->wv_id.job = job;
+      job->wv_id.correction = FALSE;
+      job->wvc_id.job = job;
+      job->wvc_id.correction = TRUE;
+      job->output = g_byte_array_new ();
+      job->chunks = g_array_new (FALSE, FALSE, sizeof (GstWavpackEncChunk));
+    }
+  }
+  wpenc->n_samples = 0;
+
   return TRUE;
 }
 
@@ -362,8 +446,23 @@ static gboolean
 gst_wavpack_enc_stop (GstAudioEncoder * enc)
 {
   GstWavpackEnc *wpenc = GST_WAVPACK_ENC (enc);
+  guint i;
 
   GST_DEBUG_OBJECT (enc, "stop");
+
+  if (wpenc->batch) {
+    gst_work_batch_clear (wpenc->batch);
+    for (i = 0; i < gst_work_batch_get_size (wpenc->batch); i++) {
+      GstWavpackEncJob *job = gst_work_batch_get_context (wpenc->batch, i);
+
+      g_free (job->samples);
+      g_byte_array_unref (job->output);
+      g_array_unref (job->chunks);
+    }
+    gst_work_batch_free (wpenc->batch);
+    wpenc->batch = NULL;
+  }
+
   gst_wavpack_enc_reset (wpenc);
 
   return TRUE;
@@ -416,6 +515,25 @@ gst_wavpack_enc_set_format (GstAudioEncoder * benc, GstAudioInfo * info)
 
   gst_caps_unref (caps);
 
+  if (enc->batch) {
+    GstClockTime latency;
+    guint i;
+
+    enc->job_samples = enc->samplerate * JOB_SECONDS;
+    for (i = 0; i < gst_work_batch_get_size (enc->batch); i++) {
+      GstWavpackEncJob *job = gst_work_batch_get_context (enc->batch, i);
+
+      g_free (job->samples);
+      job->samples = g_new (gint32, enc->job_samples * enc->channels);
+    }
+
+    /* samples wait until their job is full and then for the rest of
+     * the batch */
+    latency = JOB_SECONDS * GST_SECOND +
+        gst_work_batch_get_latency (enc->batch, 1, JOB_SECONDS);
+    gst_audio_encoder_set_latency (benc, latency, latency);
+  }
+
   /* no special feedback to base class; should provide all available samples */
 
   return TRUE;
@@ -653,6 +771,24 @@ gst_wavpack_enc_push_block (void *id, void *data, int32_t count)
   return TRUE;
 }
 
+/* the flow of the element when a block could not be pushed */
+static GstFlowReturn
+gst_wavpack_enc_combine_flows (GstWavpackEnc * enc)
+{
+  if ((enc->srcpad_last_return == GST_FLOW_OK) ||
+      (enc->wvcsrcpad_last_return == GST_FLOW_OK)) {
+    return GST_FLOW_OK;
+  } else if ((enc->srcpad_last_return == GST_FLOW_NOT_LINKED) &&
+      (enc->wvcsrcpad_last_return == GST_FLOW_NOT_LINKED)) {
+    return GST_FLOW_NOT_LINKED;
+  } else if ((enc->srcpad_last_return == GST_FLOW_FLUSHING) &&
+      (enc->wvcsrcpad_last_return == GST_FLOW_FLUSHING)) {
+    return GST_FLOW_FLUSHING;
+  }
+
+  return GST_FLOW_ERROR;
+}
+
 static void
 gst_wavpack_enc_fix_channel_order (GstWavpackEnc * enc, gint32 * data,
     gint nsamples)
@@ -671,6 +807,192 @@ gst_wavpack_enc_fix_channel_order (GstWavpackEnc * enc, gint32 * data,
   }
 }
 
+/* forget the samples of @job so it can collect the next ones */
+static void
+gst_wavpack_enc_reset_job (GstWavpackEncJob * job)
+{
+  job->n_samples = 0;
+  job->final = FALSE;
+  job->failed = FALSE;
+  g_byte_array_set_size (job->output, 0);
+  g_array_set_size (job->chunks, 0);
+}
+
+/* forget the samples that wait for a batch */
+static void
+gst_wavpack_enc_clear_job (gpointer data, gpointer context)
+{
+  gst_wavpack_enc_reset_job (context);
+}
+
+static int
+gst_wavpack_enc_job_write (void *id, void *data, int32_t count)
+{
+  GstWavpackEncJobID *wid = (GstWavpackEncJobID *) id;
+  GstWavpackEncJob *job = wid->job;
+  GstWavpackEncChunk chunk;
+
+  chunk.correction = wid->correction;
+  chunk.offset = job->output->len;
+  chunk.size = count;
+  g_byte_array_append (job->output, data, count);
+  g_array_append_val (job->chunks, chunk);
+
+  return TRUE;
+}
+
+/* encode the samples of @job with a context of its own, this runs on one
+ * of the worker threads so errors are only recorded in @job */
+static void
+gst_wavpack_enc_encode_job (gpointer data, gpointer ctx, guint index)
+{
+  GstWavpackEnc *enc = data;
+  GstWavpackEncJob *job = ctx;
+  WavpackContext *context;
+  WavpackConfig config;
+
+  context = WavpackOpenFileOutput (gst_wavpack_enc_job_write, &job->wv_id,
+      (enc->correction_mode > 0) ? &job->wvc_id : NULL);
+  if (!context) {
+    job->failed = TRUE;
+    return;
+  }
+
+  /* every job configures its context from a copy */
+  config = *enc->wp_config;
+  if (!WavpackSetConfiguration (context, &config, (uint32_t) (-1))
+      || !WavpackPackInit (context))
+    goto failed;
+
+  if (job->n_samples > 0 &&
+      !WavpackPackSamples (context, job->samples, job->n_samples))
+    goto failed;
+
+  if (!WavpackFlushSamples (context))
+    goto failed;
+
+  if (job->final) {
+    WavpackStoreMD5Sum (context, enc->md5_digest);
+    WavpackFlushSamples (context);
+  }
+
+  WavpackCloseFile (context);
+
+  return;
+
+  /* ERRORS */
+failed:
+  {
+    job->failed = TRUE;
+    WavpackCloseFile (context);
+    return;
+  }
+}
+
+/* push the blocks of @job, they continue the block index where the job
+ * before left off */
+static GstFlowReturn
+gst_wavpack_enc_push_job (GstWavpackEnc * enc, GstWavpackEncJob * job)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  if (G_UNLIKELY (job->failed))
+    goto encoding_failed;
+
+  for (i = 0; i < job->chunks->len; i++) {
+    GstWavpackEncChunk *chunk;
+    guint8 *block;
+
+    chunk = &g_array_index (job->chunks, GstWavpackEncChunk, i);
+    block = job->output->data + chunk->offset;
+
+    /* the blocks of every job count from 0 */
+    if (chunk->size > sizeof (WavpackHeader) && memcmp (block, "wvpk", 4) == 0)
+      GST_WRITE_UINT32_LE (block + 16,
+          GST_READ_UINT32_LE (block + 16) + job->sample_index);
+
+    if (!gst_wavpack_enc_push_block ((chunk->correction) ? &enc->wvc_id :
+            &enc->wv_id, block, chunk->size)) {
+      ret = gst_wavpack_enc_combine_flows (enc);
+      if (ret == GST_FLOW_ERROR)
+        goto encoding_failed;
+      break;
+    }
+  }
+
+  return ret;
+
+  /* ERRORS */
+encoding_failed:
+  {
+    GST_ELEMENT_ERROR (enc, LIBRARY, ENCODE, (NULL),
+        ("encoding samples failed"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* push the blocks of an encoded job, in the order of the batch, and
+ * reuse it for the next samples */
+static GstFlowReturn
+gst_wavpack_enc_finish_job (gpointer data, gpointer context)
+{
+  GstWavpackEncJob *job = context;
+  GstFlowReturn ret;
+
+  ret = gst_wavpack_enc_push_job (data, job);
+  gst_wavpack_enc_reset_job (job);
+
+  return ret;
+}
+
+/* queue @job on the batch, its samples follow the ones queued before */
+static GstFlowReturn
+gst_wavpack_enc_queue_job (GstWavpackEnc * enc, GstWavpackEncJob * job)
+{
+  job->sample_index = enc->n_samples;
+  enc->n_samples += job->n_samples;
+
+  return gst_work_batch_queue (enc->batch);
+}
+
+/* copy @n_samples samples to the jobs, a batch is encoded as soon as every
+ * job is full */
+static GstFlowReturn
+gst_wavpack_enc_queue_samples (GstWavpackEnc * enc, const gint32 * data,
+    guint n_samples)
+{
+  GstFlowReturn ret;
+
+  while (n_samples > 0) {
+    GstWavpackEncJob *job = gst_work_batch_peek (enc->batch);
+    guint count = MIN (n_samples, enc->job_samples - job->n_samples);
+    gint32 *dest = job->samples + job->n_samples * enc->channels;
+    gsize size = count * enc->channels * sizeof (gint32);
+
+    memcpy (dest, data, size);
+    if (enc->need_channel_remap)
+      gst_wavpack_enc_fix_channel_order (enc, dest, count * enc->channels);
+
+    /* if we want to append the MD5 sum to the stream update it here
+     * with the current raw samples */
+    if (enc->md5)
+      g_checksum_update (enc->md5_context, (const guchar *) dest, size);
+
+    job->n_samples += count;
+    data += count * enc->channels;
+    n_samples -= count;
+
+    if (job->n_samples == enc->job_samples) {
+      ret = gst_wavpack_enc_queue_job (enc, job);
+      if (ret != GST_FLOW_OK)
+        return ret;
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_wavpack_enc_handle_frame (GstAudioEncoder * benc, GstBuffer * buf)
 {
@@ -693,6 +1015,18 @@ gst_wavpack_enc_handle_frame (GstAudioEncoder * benc, GstBuffer * buf)
   sample_count = gst_buffer_get_size (buf) / 4;
   GST_DEBUG_OBJECT (enc, "got %u raw samples", sample_count);
 
+  if (enc->batch) {
+    if (!enc->wp_config)
+      gst_wavpack_enc_set_wp_config (enc);
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    ret = gst_wavpack_enc_queue_samples (enc, (const gint32 *) map.data,
+        sample_count / enc->channels);
+    gst_buffer_unmap (buf, &map);
+
+    return ret;
+  }
+
   /* check if we already have a valid WavpackContext, otherwise make one */
   if (!enc->wp_context) {
     /* create raw context */
@@ -739,18 +1073,9 @@ gst_wavpack_enc_handle_frame (GstAudioEncoder * benc, GstBuffer * buf)
     ret = GST_FLOW_OK;
   } else {
     gst_buffer_unmap (buf, &map);
-    if ((enc->srcpad_last_return == GST_FLOW_OK) ||
-        (enc->wvcsrcpad_last_return == GST_FLOW_OK)) {
-      ret = GST_FLOW_OK;
-    } else if ((enc->srcpad_last_return == GST_FLOW_NOT_LINKED) &&
-        (enc->wvcsrcpad_last_return == GST_FLOW_NOT_LINKED)) {
-      ret = GST_FLOW_NOT_LINKED;
-    } else if ((enc->srcpad_last_return == GST_FLOW_FLUSHING) &&
-        (enc->wvcsrcpad_last_return == GST_FLOW_FLUSHING)) {
-      ret = GST_FLOW_FLUSHING;
-    } else {
+    ret = gst_wavpack_enc_combine_flows (enc);
+    if (ret == GST_FLOW_ERROR)
       goto encoding_failed;
-    }
   }
 
 exit:
@@ -791,8 +1116,12 @@ gst_wavpack_enc_rewrite_first_block (GstWavpackEnc * enc)
   g_return_if_fail (enc);
   g_return_if_fail (enc->first_block);
 
-  /* update the sample count in the first block */
-  WavpackUpdateNumSamples (enc->wp_context, enc->first_block);
+  /* update the sample count in the first block, the contexts of the jobs
+   * are gone by now */
+  if (enc->wp_context)
+    WavpackUpdateNumSamples (enc->wp_context, enc->first_block);
+  else
+    GST_WRITE_UINT32_LE ((guint8 *) enc->first_block + 12, enc->n_samples);
 
   /* try to seek to the beginning of the output */
   query = gst_query_new_seeking (GST_FORMAT_BYTES);
@@ -830,9 +1159,59 @@ gst_wavpack_enc_rewrite_first_block (GstWavpackEnc * enc)
   }
 }
 
+static GstFlowReturn
+gst_wavpack_enc_drain_jobs (GstWavpackEnc * enc)
+{
+  GstWavpackEncJob *job;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (!enc->wp_config)
+    return GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (enc, "draining");
+
+  /* the last job also writes the MD5 sum */
+  job = gst_work_batch_peek (enc->batch);
+  if ((enc->md5) && (enc->md5_context)) {
+    gsize digest_len = sizeof (enc->md5_digest);
+
+    g_checksum_get_digest (enc->md5_context, enc->md5_digest, &digest_len);
+    if (digest_len == sizeof (enc->md5_digest))
+      job->final = TRUE;
+    else
+      GST_WARNING_OBJECT (enc, "Calculating MD5 digest failed");
+  }
+  if (job->n_samples > 0 || job->final)
+    ret = gst_wavpack_enc_queue_job (enc, job);
+  if (ret == GST_FLOW_OK)
+    ret = gst_work_batch_flush (enc->batch);
+
+  /* Drop all remaining data, this is no complete block otherwise
+   * it would've been pushed already */
+  if (enc->pending_buffer) {
+    gst_buffer_unref (enc->pending_buffer);
+    enc->pending_buffer = NULL;
+    enc->pending_offset = 0;
+  }
+
+  /* Try to rewrite the first frame with the correct sample number */
+  if (enc->first_block)
+    gst_wavpack_enc_rewrite_first_block (enc);
+
+  /* the next samples start a new stream */
+  g_free (enc->wp_config);
+  enc->wp_config = NULL;
+  enc->n_samples = 0;
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_wavpack_enc_drain (GstWavpackEnc * enc)
 {
+  if (enc->batch)
+    return gst_wavpack_enc_drain_jobs (enc);
+
   if (!enc->wp_context)
     return GST_FLOW_OK;
 
@@ -875,6 +1254,18 @@ gst_wavpack_enc_drain (GstWavpackEnc * enc)
   return GST_FLOW_OK;
 }
 
+static void
+gst_wavpack_enc_flush (GstAudioEncoder * benc)
+{
+  GstWavpackEnc *enc = GST_WAVPACK_ENC (benc);
+
+  if (enc->batch) {
+    gst_work_batch_clear (enc->batch);
+    /* and the samples of the job that is not full yet */
+    gst_wavpack_enc_reset_job (gst_work_batch_peek (enc->batch));
+  }
+}
+
 static gboolean
 gst_wavpack_enc_sink_event (GstAudioEncoder * benc, GstEvent * event)
 {
@@ -948,6 +1339,9 @@ gst_wavpack_enc_set_property (GObject * object, guint prop_id,
     case ARG_JOINT_STEREO_MODE:
       enc->joint_stereo_mode = g_value_get_enum (value);
       break;
+    case ARG_N_THREADS:
+      enc->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -990,6 +1384,9 @@ gst_wavpack_enc_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_JOINT_STEREO_MODE:
       g_value_set_enum (value, enc->joint_stereo_mode);
       break;
+    case ARG_N_THREADS:
+      g_value_set_uint (value, enc->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -27,6 +27,8 @@
 
 #include <wavpack/wavpack.h>
 
+#include <gst/workers/gstworkbatch.h>
+
 G_BEGIN_DECLS
 #define GST_TYPE_WAVPACK_ENC \
   (gst_wavpack_enc_get_type())
@@ -40,6 +42,7 @@ G_BEGIN_DECLS
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_WAVPACK_ENC))
 typedef struct _GstWavpackEnc GstWavpackEnc;
 typedef struct _GstWavpackEncClass GstWavpackEncClass;
+typedef struct _GstWavpackEncJob GstWavpackEncJob;
 
 typedef struct
 {
@@ -90,6 +93,14 @@ struct _GstWavpackEnc
 
   GstClockTime timestamp_offset;
   GstClockTime next_ts;
+
+  /* with more than one thread the samples are encoded in jobs of
+   * job_samples each, every job with a context of its own */
+  guint n_threads;
+  GstWorkBatch *batch;
+  guint job_samples;
+  guint32 n_samples;
+  guint8 md5_digest[16];
 };
 
 struct _GstWavpackEncClass
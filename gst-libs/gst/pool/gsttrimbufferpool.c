@@ -0,0 +1,110 @@
+/* GStreamer
+ *
+ * gsttrimbufferpool.c: buffer pool for trimmed receive buffers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gsttrimbufferpool.h"
+
+GST_DEBUG_CATEGORY_STATIC (trimbufferpool_debug);
+#define GST_CAT_DEFAULT (trimbufferpool_debug)
+
+#define gst_trim_buffer_pool_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstTrimBufferPool, gst_trim_buffer_pool,
+    GST_TYPE_BUFFER_POOL,
+    GST_DEBUG_CATEGORY_INIT (trimbufferpool_debug, "trimbufferpool", 0,
+        "Trimming buffer pool"));
+
+static gboolean
+gst_trim_buffer_pool_set_config (GstBufferPool * bpool, GstStructure * config)
+{
+  GstTrimBufferPool *pool = GST_TRIM_BUFFER_POOL_CAST (bpool);
+  guint size;
+
+  if (!gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL))
+    goto wrong_config;
+
+  pool->size = size;
+
+  GST_LOG_OBJECT (pool, "configured buffers of %u bytes", size);
+
+  return GST_BUFFER_POOL_CLASS (parent_class)->set_config (bpool, config);
+
+  /* ERRORS */
+wrong_config:
+  {
+    GST_WARNING_OBJECT (pool, "invalid config %" GST_PTR_FORMAT, config);
+    return FALSE;
+  }
+}
+
+static void
+gst_trim_buffer_pool_reset_buffer (GstBufferPool * bpool, GstBuffer * buffer)
+{
+  GstTrimBufferPool *pool = GST_TRIM_BUFFER_POOL_CAST (bpool);
+  gsize offset;
+
+  /* drop the memory that was appended for data bigger than our buffers */
+  if (pool->drop_extra_memory && G_UNLIKELY (gst_buffer_n_memory (buffer) > 1))
+    gst_buffer_remove_memory_range (buffer, 1, -1);
+
+  /* undo the trimming to the amount of data received, this only changes the
+   * offset and size of the memory so nothing is copied or reallocated */
+  gst_buffer_get_sizes (buffer, &offset, NULL);
+  gst_buffer_resize (buffer, -(gssize) offset, pool->size);
+
+  GST_BUFFER_POOL_CLASS (parent_class)->reset_buffer (bpool, buffer);
+}
+
+static void
+gst_trim_buffer_pool_init (GstTrimBufferPool * pool)
+{
+}
+
+static void
+gst_trim_buffer_pool_class_init (GstTrimBufferPoolClass * klass)
+{
+  GstBufferPoolClass *bufferpool_class = GST_BUFFER_POOL_CLASS (klass);
+
+  bufferpool_class->set_config = gst_trim_buffer_pool_set_config;
+  bufferpool_class->reset_buffer = gst_trim_buffer_pool_reset_buffer;
+}
+
+/**
+ * gst_trim_buffer_pool_new:
+ * @drop_extra_memory: whether to remove the memory that was appended to a
+ *     buffer when it returns to the pool
+ *
+ * Construct a new buffer pool for received data. Buffers are restored to
+ * their configured size when they are recycled.
+ *
+ * Returns: the new pool, use gst_object_unref() to free resources
+ */
+GstBufferPool *
+gst_trim_buffer_pool_new (gboolean drop_extra_memory)
+{
+  GstTrimBufferPool *pool;
+
+  pool = g_object_new (GST_TYPE_TRIM_BUFFER_POOL, NULL);
+  pool->drop_extra_memory = drop_extra_memory;
+
+  return GST_BUFFER_POOL_CAST (pool);
+}
@@ -0,0 +1,63 @@
+/* GStreamer
+ *
+ * gsttrimbufferpool.h: buffer pool for trimmed receive buffers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_TRIM_BUFFER_POOL_H__
+#define __GST_TRIM_BUFFER_POOL_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TRIM_BUFFER_POOL      (gst_trim_buffer_pool_get_type())
+#define GST_IS_TRIM_BUFFER_POOL(obj)   (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_TRIM_BUFFER_POOL))
+#define GST_TRIM_BUFFER_POOL(obj)      (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_TRIM_BUFFER_POOL, GstTrimBufferPool))
+#define GST_TRIM_BUFFER_POOL_CAST(obj) ((GstTrimBufferPool*)(obj))
+
+typedef struct _GstTrimBufferPool GstTrimBufferPool;
+typedef struct _GstTrimBufferPoolClass GstTrimBufferPoolClass;
+
+/**
+ * GstTrimBufferPool:
+ *
+ * A pool of fixed size receive buffers. Buffers can be trimmed to the amount
+ * of data that was received into them with gst_buffer_resize() and,
+ * optionally, get extra memory appended; both is undone when the buffer
+ * returns to the pool so that the same memory is used over and over again.
+ */
+struct _GstTrimBufferPool
+{
+  GstBufferPool parent;
+
+  guint size;
+  gboolean drop_extra_memory;
+};
+
+struct _GstTrimBufferPoolClass
+{
+  GstBufferPoolClass parent_class;
+};
+
+GType gst_trim_buffer_pool_get_type (void);
+
+GstBufferPool *gst_trim_buffer_pool_new (gboolean drop_extra_memory);
+
+G_END_DECLS
+
+#endif /* __GST_TRIM_BUFFER_POOL_H__ */
@@ -0,0 +1,380 @@
+/* GStreamer
+ *
+ * gstvisualrender.c: schedule video frames rendered from audio samples
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gstvisualrender.h"
+
+#ifndef GST_DISABLE_GST_DEBUG
+#define GST_CAT_DEFAULT gst_visual_render_ensure_debug_category ()
+
+static GstDebugCategory *
+gst_visual_render_ensure_debug_category (void)
+{
+  static gsize cat_gonce = 0;
+
+  if (g_once_init_enter (&cat_gonce)) {
+    GstDebugCategory *cat;
+
+    GST_DEBUG_CATEGORY_INIT (cat, "visualrender", 0,
+        "audio visualisation frame scheduling");
+    g_once_init_leave (&cat_gonce, (gsize) cat);
+  }
+
+  return (GstDebugCategory *) cat_gonce;
+}
+#endif
+
+void
+gst_visual_render_init (GstVisualRender * render, GstElement * element)
+{
+  render->element = element;
+  render->adapter = gst_adapter_new ();
+  render->pool = NULL;
+
+  render->rate = 0;
+  render->bps = 0;
+  render->fps_n = 0;
+  render->fps_d = 1;
+  render->duration = GST_CLOCK_TIME_NONE;
+  render->spf = 0;
+
+  gst_visual_render_reset (render);
+}
+
+void
+gst_visual_render_clear (GstVisualRender * render)
+{
+  gst_visual_render_release_pool (render);
+
+  if (render->adapter) {
+    g_object_unref (render->adapter);
+    render->adapter = NULL;
+  }
+}
+
+void
+gst_visual_render_reset (GstVisualRender * render)
+{
+  gst_adapter_clear (render->adapter);
+  gst_segment_init (&render->segment, GST_FORMAT_UNDEFINED);
+
+  render->base_ts = GST_CLOCK_TIME_NONE;
+  render->frame = 0;
+
+  GST_OBJECT_LOCK (render->element);
+  render->proportion = 1.0;
+  render->earliest_time = -1;
+  GST_OBJECT_UNLOCK (render->element);
+}
+
+/* first sample of @frame, counted from the start of the grid */
+static guint64
+gst_visual_render_frame_offset (GstVisualRender * render, guint64 frame)
+{
+  return gst_util_uint64_scale (frame, (guint64) render->rate * render->fps_d,
+      render->fps_n);
+}
+
+static void
+gst_visual_render_update_spf (GstVisualRender * render)
+{
+  if (render->rate == 0 || render->fps_n == 0) {
+    render->spf = 0;
+    return;
+  }
+
+  render->spf = gst_util_uint64_scale_int_ceil (render->rate, render->fps_d,
+      render->fps_n);
+}
+
+void
+gst_visual_render_set_audio (GstVisualRender * render, gint rate, guint bps)
+{
+  render->rate = rate;
+  render->bps = bps;
+  gst_visual_render_update_spf (render);
+
+  /* the samples of the old format are useless now */
+  gst_adapter_clear (render->adapter);
+  render->base_ts = GST_CLOCK_TIME_NONE;
+  render->frame = 0;
+}
+
+void
+gst_visual_render_set_video (GstVisualRender * render, gint fps_n, gint fps_d)
+{
+  render->fps_n = fps_n;
+  render->fps_d = fps_d;
+  render->duration = gst_util_uint64_scale_int (GST_SECOND, fps_d, fps_n);
+  gst_visual_render_update_spf (render);
+
+  /* start a new grid at the next frame */
+  render->base_ts = GST_CLOCK_TIME_NONE;
+  render->frame = 0;
+}
+
+void
+gst_visual_render_set_segment (GstVisualRender * render, GstEvent * event)
+{
+  /* the segment is used to convert the incomming timestamps to running time
+   * so we can do QoS */
+  gst_event_copy_segment (event, &render->segment);
+}
+
+void
+gst_visual_render_update_qos (GstVisualRender * render, GstEvent * event)
+{
+  gdouble proportion;
+  GstClockTimeDiff diff;
+  GstClockTime timestamp;
+
+  gst_event_parse_qos (event, NULL, &proportion, &diff, &timestamp);
+
+  GST_OBJECT_LOCK (render->element);
+  render->proportion = proportion;
+  if (diff >= 0)
+    /* we're late, this is a good estimate for next displayable
+     * frame (see part-qos.txt) */
+    render->earliest_time = timestamp + 2 * diff + render->duration;
+  else
+    render->earliest_time = timestamp + diff;
+  GST_OBJECT_UNLOCK (render->element);
+}
+
+/* find a pool for the negotiated caps, @size is the frame size in bytes */
+gboolean
+gst_visual_render_setup_pool (GstVisualRender * render, GstPad * srcpad,
+    GstCaps * caps, guint size)
+{
+  GstQuery *query;
+  GstBufferPool *pool;
+  GstStructure *config;
+  guint min, max;
+
+  query = gst_query_new_allocation (caps, TRUE);
+
+  if (!gst_pad_peer_query (srcpad, query)) {
+    /* no problem, we use the query defaults */
+    GST_DEBUG_OBJECT (render->element, "ALLOCATION query failed");
+  }
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    guint pool_size;
+
+    /* we got configuration from our peer, parse them */
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &pool_size, &min,
+        &max);
+    size = MAX (size, pool_size);
+  } else {
+    pool = NULL;
+    min = max = 0;
+  }
+  gst_query_unref (query);
+
+  if (pool == NULL) {
+    /* we did not get a pool, make one ourselves then */
+    pool = gst_buffer_pool_new ();
+  }
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  if (!gst_buffer_pool_set_config (pool, config))
+    goto config_failed;
+
+  gst_visual_render_release_pool (render);
+  render->pool = pool;
+
+  /* and activate */
+  if (!gst_buffer_pool_set_active (pool, TRUE))
+    goto activate_failed;
+
+  return TRUE;
+
+  /* ERRORS */
+config_failed:
+  {
+    GST_WARNING_OBJECT (render->element, "failed to configure buffer pool");
+    gst_object_unref (pool);
+    return FALSE;
+  }
+activate_failed:
+  {
+    GST_WARNING_OBJECT (render->element, "failed to activate buffer pool");
+    gst_visual_render_release_pool (render);
+    return FALSE;
+  }
+}
+
+void
+gst_visual_render_release_pool (GstVisualRender * render)
+{
+  if (render->pool) {
+    gst_buffer_pool_set_active (render->pool, FALSE);
+    gst_object_unref (render->pool);
+    render->pool = NULL;
+  }
+}
+
+void
+gst_visual_render_push (GstVisualRender * render, GstBuffer * buffer)
+{
+  /* don't try to combine samples from discont buffer */
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT)) {
+    gst_adapter_clear (render->adapter);
+    render->base_ts = GST_CLOCK_TIME_NONE;
+    render->frame = 0;
+  }
+
+  GST_LOG_OBJECT (render->element,
+      "in buffer has %" G_GSIZE_FORMAT " samples, ts=%" GST_TIME_FORMAT,
+      gst_buffer_get_size (buffer) / render->bps,
+      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)));
+
+  gst_adapter_push (render->adapter, buffer);
+}
+
+/* timestamp of the first sample in the adapter */
+static GstClockTime
+gst_visual_render_adapter_time (GstVisualRender * render)
+{
+  GstClockTime timestamp;
+  guint64 dist;
+
+  timestamp = gst_adapter_prev_pts (render->adapter, &dist);
+  if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    /* convert bytes to time */
+    dist /= render->bps;
+    timestamp += gst_util_uint64_scale_int (dist, GST_SECOND, render->rate);
+  }
+
+  return timestamp;
+}
+
+/**
+ * gst_visual_render_next_frame:
+ * @render: a #GstVisualRender
+ * @min_samples: the number of samples the renderer looks at
+ * @timestamp: (out): the timestamp of the frame
+ * @n_samples: (out): the number of samples that belong to the frame
+ *
+ * Check if the adapter holds enough samples for the next frame. The data
+ * for the frame is at the start of the adapter, when done with the frame
+ * call gst_visual_render_finish_frame() with @n_samples.
+ *
+ * Returns: %TRUE when the next frame can be rendered.
+ */
+gboolean
+gst_visual_render_next_frame (GstVisualRender * render, guint min_samples,
+    GstClockTime * timestamp, guint * n_samples)
+{
+  GstClockTime ts, grid_ts;
+  guint avail, n;
+
+  avail = gst_adapter_available (render->adapter) / render->bps;
+  if (avail < min_samples || avail == 0)
+    return FALSE;
+
+  ts = gst_visual_render_adapter_time (render);
+  if (GST_CLOCK_TIME_IS_VALID (render->base_ts)) {
+    grid_ts = render->base_ts + gst_util_uint64_scale (render->frame,
+        (guint64) render->fps_d * GST_SECOND, render->fps_n);
+
+    /* upstream made a jump without marking a discont, start over */
+    if (GST_CLOCK_TIME_IS_VALID (ts) &&
+        MAX (ts, grid_ts) - MIN (ts, grid_ts) > render->duration / 2) {
+      GST_DEBUG_OBJECT (render->element, "resync grid at %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (ts));
+      render->base_ts = ts;
+      render->frame = 0;
+      grid_ts = ts;
+    }
+  } else {
+    render->base_ts = ts;
+    render->frame = 0;
+    grid_ts = ts;
+  }
+
+  /* frames alternate between the rounded down and up sample counts so that
+   * they stay on the grid */
+  n = gst_visual_render_frame_offset (render, render->frame + 1) -
+      gst_visual_render_frame_offset (render, render->frame);
+  if (avail < n)
+    return FALSE;
+
+  *timestamp = grid_ts;
+  *n_samples = n;
+
+  return TRUE;
+}
+
+/* check for QoS, don't compute frames that are known to be late */
+gboolean
+gst_visual_render_is_late (GstVisualRender * render, GstClockTime timestamp)
+{
+  GstClockTime qostime;
+  gboolean late;
+
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp))
+    return FALSE;
+
+  qostime = gst_segment_to_running_time (&render->segment, GST_FORMAT_TIME,
+      timestamp);
+  if (!GST_CLOCK_TIME_IS_VALID (qostime))
+    return FALSE;
+  qostime += render->duration;
+
+  GST_OBJECT_LOCK (render->element);
+  late = render->earliest_time != -1 && qostime <= render->earliest_time;
+  if (late) {
+    GST_DEBUG_OBJECT (render->element,
+        "QoS: skip ts: %" GST_TIME_FORMAT ", earliest: %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (qostime), GST_TIME_ARGS (render->earliest_time));
+  }
+  GST_OBJECT_UNLOCK (render->element);
+
+  return late;
+}
+
+GstFlowReturn
+gst_visual_render_acquire_buffer (GstVisualRender * render,
+    GstClockTime timestamp, GstBuffer ** buffer)
+{
+  GstFlowReturn ret;
+
+  GST_LOG_OBJECT (render->element, "allocating output buffer");
+  ret = gst_buffer_pool_acquire_buffer (render->pool, buffer, NULL);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  GST_BUFFER_TIMESTAMP (*buffer) = timestamp;
+  GST_BUFFER_DURATION (*buffer) = render->duration;
+
+  return GST_FLOW_OK;
+}
+
+/* drop the samples of the frame that was rendered or skipped */
+void
+gst_visual_render_finish_frame (GstVisualRender * render, guint n_samples)
+{
+  GST_LOG_OBJECT (render->element, "finished frame, flushing %u samples",
+      n_samples);
+
+  gst_adapter_flush (render->adapter, n_samples * render->bps);
+  render->frame++;
+}
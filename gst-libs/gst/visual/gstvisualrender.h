@@ -0,0 +1,103 @@
+/* GStreamer
+ *
+ * gstvisualrender.h: schedule video frames rendered from audio samples
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_VISUAL_RENDER_H__
+#define __GST_VISUAL_RENDER_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstadapter.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstVisualRender GstVisualRender;
+
+/**
+ * GstVisualRender:
+ *
+ * Collects the audio of a visualisation element and tells it when to
+ * render a frame. Frames are put on a regular time grid that starts at the
+ * first sample after a reset or a discontinuity, every frame takes the
+ * audio samples of its own time span. Output buffers come from a buffer
+ * pool and frames that QoS reports as too late can be skipped.
+ */
+struct _GstVisualRender
+{
+  /* the owner, not reffed, its object lock protects the QoS state */
+  GstElement *element;
+
+  GstAdapter *adapter;
+  GstSegment segment;
+  GstBufferPool *pool;
+
+  /* audio */
+  gint rate;
+  guint bps;                    /* bytes per sample of all channels */
+
+  /* video */
+  gint fps_n;
+  gint fps_d;
+  GstClockTime duration;
+  guint spf;                    /* maximum number of samples per frame */
+
+  /* frame grid, the timestamp of the first frame and the next frame */
+  GstClockTime base_ts;
+  guint64 frame;
+
+  /* QoS stuff *//* with LOCK */
+  gdouble proportion;
+  GstClockTime earliest_time;
+};
+
+void          gst_visual_render_init           (GstVisualRender *render,
+                                                GstElement *element);
+void          gst_visual_render_clear          (GstVisualRender *render);
+void          gst_visual_render_reset          (GstVisualRender *render);
+
+void          gst_visual_render_set_audio      (GstVisualRender *render,
+                                                gint rate, guint bps);
+void          gst_visual_render_set_video      (GstVisualRender *render,
+                                                gint fps_n, gint fps_d);
+void          gst_visual_render_set_segment    (GstVisualRender *render,
+                                                GstEvent *event);
+void          gst_visual_render_update_qos     (GstVisualRender *render,
+                                                GstEvent *event);
+
+gboolean      gst_visual_render_setup_pool     (GstVisualRender *render,
+                                                GstPad *srcpad, GstCaps *caps,
+                                                guint size);
+void          gst_visual_render_release_pool   (GstVisualRender *render);
+
+void          gst_visual_render_push           (GstVisualRender *render,
+                                                GstBuffer *buffer);
+gboolean      gst_visual_render_next_frame     (GstVisualRender *render,
+                                                guint min_samples,
+                                                GstClockTime *timestamp,
+                                                guint *n_samples);
+gboolean      gst_visual_render_is_late        (GstVisualRender *render,
+                                                GstClockTime timestamp);
+GstFlowReturn gst_visual_render_acquire_buffer (GstVisualRender *render,
+                                                GstClockTime timestamp,
+                                                GstBuffer **buffer);
+void          gst_visual_render_finish_frame   (GstVisualRender *render,
+                                                guint n_samples);
+
+G_END_DECLS
+
+#endif /* __GST_VISUAL_RENDER_H__ */
@@ -0,0 +1,318 @@
+/* GStreamer
+ *
+ * gstworkbatch.c: process frames in batches of one frame per thread
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gstworkbatch.h"
+
+/* Codecs that can't split a frame process whole frames on the worker
+ * threads instead. Frames are queued until there is one for every thread,
+ * the batch is then processed at once and the frames are handed over in
+ * their original order. */
+struct _GstWorkBatch
+{
+  GstWorkers *workers;
+
+  /* every context is allocated on its own so that it never moves, codec
+   * libraries keep pointers into them */
+  gpointer *contexts;
+  guint n_contexts;
+  guint n_queued;
+
+  GstWorkBatchFunc func;
+  GstWorkBatchFinishFunc finish;
+  GstWorkBatchClearFunc clear;
+  gpointer user_data;
+};
+
+static void
+run_slice (gpointer data, guint slice, guint n_slices)
+{
+  GstWorkBatch *batch = data;
+
+  if (slice < batch->n_queued)
+    batch->func (batch->user_data, batch->contexts[slice], slice);
+}
+
+/* the queued contexts are free again, the context that gst_work_batch_peek()
+ * returned stays the next one */
+static void
+gst_work_batch_reset (GstWorkBatch * batch)
+{
+  if (batch->n_queued > 0 && batch->n_queued < batch->n_contexts) {
+    gpointer next = batch->contexts[batch->n_queued];
+
+    batch->contexts[batch->n_queued] = batch->contexts[0];
+    batch->contexts[0] = next;
+  }
+  batch->n_queued = 0;
+}
+
+/**
+ * gst_work_batch_new:
+ * @n_threads: the number of frames to process at once
+ * @context_size: the size of a context
+ * @func: the function processing a frame on a worker thread
+ * @finish: the function handing over a processed frame
+ * @clear: the function releasing a frame that is not processed
+ * @user_data: user data for the functions
+ *
+ * Make a new batch with a zeroed context for every thread, the contexts are
+ * the same for the life of the batch. With one thread every frame is
+ * processed as soon as it is queued.
+ *
+ * Returns: a new #GstWorkBatch, free with gst_work_batch_free().
+ */
+GstWorkBatch *
+gst_work_batch_new (guint n_threads, gsize context_size,
+    GstWorkBatchFunc func, GstWorkBatchFinishFunc finish,
+    GstWorkBatchClearFunc clear, gpointer user_data)
+{
+  GstWorkBatch *batch;
+  guint i;
+
+  g_return_val_if_fail (n_threads > 0, NULL);
+  g_return_val_if_fail (context_size > 0, NULL);
+  g_return_val_if_fail (func != NULL, NULL);
+  g_return_val_if_fail (finish != NULL, NULL);
+  g_return_val_if_fail (clear != NULL, NULL);
+
+  batch = g_slice_new0 (GstWorkBatch);
+  batch->func = func;
+  batch->finish = finish;
+  batch->clear = clear;
+  batch->user_data = user_data;
+
+  batch->n_contexts = 1;
+  if (n_threads > 1) {
+    batch->workers = gst_workers_new (n_threads);
+    batch->n_contexts = gst_workers_get_n_threads (batch->workers);
+  }
+
+  batch->contexts = g_new (gpointer, batch->n_contexts);
+  for (i = 0; i < batch->n_contexts; i++)
+    batch->contexts[i] = g_malloc0 (context_size);
+
+  return batch;
+}
+
+/**
+ * gst_work_batch_free:
+ * @batch: a #GstWorkBatch
+ *
+ * Clear the queued frames and free @batch with its contexts. Whatever the
+ * contexts hold besides a frame has to be released before.
+ */
+void
+gst_work_batch_free (GstWorkBatch * batch)
+{
+  guint i;
+
+  g_return_if_fail (batch != NULL);
+
+  gst_work_batch_clear (batch);
+
+  for (i = 0; i < batch->n_contexts; i++)
+    g_free (batch->contexts[i]);
+  g_free (batch->contexts);
+  if (batch->workers)
+    gst_workers_free (batch->workers);
+  g_slice_free (GstWorkBatch, batch);
+}
+
+/**
+ * gst_work_batch_get_size:
+ * @batch: a #GstWorkBatch
+ *
+ * Returns: the number of frames in a full batch, this is also the number of
+ * contexts and of threads.
+ */
+guint
+gst_work_batch_get_size (GstWorkBatch * batch)
+{
+  g_return_val_if_fail (batch != NULL, 0);
+
+  return batch->n_contexts;
+}
+
+/**
+ * gst_work_batch_get_context:
+ * @batch: a #GstWorkBatch
+ * @index: a context, less than gst_work_batch_get_size()
+ *
+ * Get any of the contexts, for setting up and releasing what they hold.
+ * Queuing and flushing reorders the contexts.
+ *
+ * Returns: the context.
+ */
+gpointer
+gst_work_batch_get_context (GstWorkBatch * batch, guint index)
+{
+  g_return_val_if_fail (batch != NULL, NULL);
+  g_return_val_if_fail (index < batch->n_contexts, NULL);
+
+  return batch->contexts[index];
+}
+
+/**
+ * gst_work_batch_get_workers:
+ * @batch: a #GstWorkBatch
+ *
+ * Get the workers that process the batches, they can also be used for other
+ * work while no batch runs.
+ *
+ * Returns: the #GstWorkers of @batch, or %NULL with one thread.
+ */
+GstWorkers *
+gst_work_batch_get_workers (GstWorkBatch * batch)
+{
+  g_return_val_if_fail (batch != NULL, NULL);
+
+  return batch->workers;
+}
+
+/**
+ * gst_work_batch_get_n_queued:
+ * @batch: a #GstWorkBatch
+ *
+ * Returns: the number of frames that wait for the batch to be complete.
+ */
+guint
+gst_work_batch_get_n_queued (GstWorkBatch * batch)
+{
+  g_return_val_if_fail (batch != NULL, 0);
+
+  return batch->n_queued;
+}
+
+/**
+ * gst_work_batch_peek:
+ * @batch: a #GstWorkBatch
+ *
+ * Get the context for the next frame. It is filled in and then queued with
+ * gst_work_batch_queue(), the same context is returned until then.
+ *
+ * Returns: the next free context.
+ */
+gpointer
+gst_work_batch_peek (GstWorkBatch * batch)
+{
+  g_return_val_if_fail (batch != NULL, NULL);
+
+  return batch->contexts[batch->n_queued];
+}
+
+/**
+ * gst_work_batch_queue:
+ * @batch: a #GstWorkBatch
+ *
+ * Queue the context returned by gst_work_batch_peek(). When this completes
+ * the batch it is processed and finished like with gst_work_batch_flush().
+ *
+ * Returns: the first error of finishing the batch, or %GST_FLOW_OK.
+ */
+GstFlowReturn
+gst_work_batch_queue (GstWorkBatch * batch)
+{
+  g_return_val_if_fail (batch != NULL, GST_FLOW_ERROR);
+
+  if (++batch->n_queued < batch->n_contexts)
+    return GST_FLOW_OK;
+
+  return gst_work_batch_flush (batch);
+}
+
+/**
+ * gst_work_batch_flush:
+ * @batch: a #GstWorkBatch
+ *
+ * Process the queued frames, one on every thread, and finish them in the
+ * order they were queued. All frames are finished, also after an error.
+ *
+ * Returns: the first error of finishing the frames, or %GST_FLOW_OK.
+ */
+GstFlowReturn
+gst_work_batch_flush (GstWorkBatch * batch)
+{
+  GstFlowReturn ret = GST_FLOW_OK, res;
+  guint i;
+
+  g_return_val_if_fail (batch != NULL, GST_FLOW_ERROR);
+
+  if (batch->n_queued == 0)
+    return GST_FLOW_OK;
+
+  if (batch->workers && batch->n_queued > 1) {
+    gst_workers_run (batch->workers, run_slice, batch);
+  } else {
+    for (i = 0; i < batch->n_queued; i++)
+      batch->func (batch->user_data, batch->contexts[i], i);
+  }
+
+  for (i = 0; i < batch->n_queued; i++) {
+    res = batch->finish (batch->user_data, batch->contexts[i]);
+    if (ret == GST_FLOW_OK)
+      ret = res;
+  }
+  gst_work_batch_reset (batch);
+
+  return ret;
+}
+
+/**
+ * gst_work_batch_clear:
+ * @batch: a #GstWorkBatch
+ *
+ * Release the queued frames without processing them.
+ */
+void
+gst_work_batch_clear (GstWorkBatch * batch)
+{
+  guint i;
+
+  g_return_if_fail (batch != NULL);
+
+  for (i = 0; i < batch->n_queued; i++)
+    batch->clear (batch->user_data, batch->contexts[i]);
+  gst_work_batch_reset (batch);
+}
+
+/**
+ * gst_work_batch_get_latency:
+ * @batch: a #GstWorkBatch
+ * @rate_n: the numerator of the frame rate
+ * @rate_d: the denominator of the frame rate
+ *
+ * The first frame of a batch waits for the rest of it, which is
+ * gst_work_batch_get_size() - 1 frames at a rate of @rate_n / @rate_d
+ * frames per second.
+ *
+ * Returns: the latency the batches add, 0 with one thread or when the rate
+ * is unknown.
+ */
+GstClockTime
+gst_work_batch_get_latency (GstWorkBatch * batch, gint rate_n, gint rate_d)
+{
+  g_return_val_if_fail (batch != NULL, 0);
+
+  if (batch->n_contexts < 2 || rate_n <= 0 || rate_d <= 0)
+    return 0;
+
+  return gst_util_uint64_scale_ceil ((batch->n_contexts - 1) * GST_SECOND,
+      rate_d, rate_n);
+}
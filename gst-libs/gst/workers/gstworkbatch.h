@@ -0,0 +1,90 @@
+/* GStreamer
+ *
+ * gstworkbatch.h: process frames in batches of one frame per thread
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_WORK_BATCH_H__
+#define __GST_WORK_BATCH_H__
+
+#include <gst/gst.h>
+#include <gst/workers/gstworkers.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstWorkBatch GstWorkBatch;
+
+/**
+ * GstWorkBatchFunc:
+ * @user_data: user data passed to gst_work_batch_new()
+ * @context: the context of one queued frame
+ * @index: the position of @context in the batch
+ *
+ * Process the frame of @context. The frames of a batch are processed
+ * concurrently, each on a thread of its own. Errors can only be recorded in
+ * @context, they are reported when the context is finished.
+ */
+typedef void (*GstWorkBatchFunc) (gpointer user_data, gpointer context,
+    guint index);
+
+/**
+ * GstWorkBatchFinishFunc:
+ * @user_data: user data passed to gst_work_batch_new()
+ * @context: the context of a processed frame
+ *
+ * Hand over the processed frame of @context, called in the order the frames
+ * were queued from the thread that runs the batch.
+ *
+ * Returns: the result of pushing the frame.
+ */
+typedef GstFlowReturn (*GstWorkBatchFinishFunc) (gpointer user_data,
+    gpointer context);
+
+/**
+ * GstWorkBatchClearFunc:
+ * @user_data: user data passed to gst_work_batch_new()
+ * @context: the context of a queued frame
+ *
+ * Release the frame of @context without processing it.
+ */
+typedef void (*GstWorkBatchClearFunc) (gpointer user_data, gpointer context);
+
+GstWorkBatch * gst_work_batch_new           (guint n_threads,
+                                             gsize context_size,
+                                             GstWorkBatchFunc func,
+                                             GstWorkBatchFinishFunc finish,
+                                             GstWorkBatchClearFunc clear,
+                                             gpointer user_data);
+void           gst_work_batch_free          (GstWorkBatch *batch);
+
+guint          gst_work_batch_get_size      (GstWorkBatch *batch);
+gpointer       gst_work_batch_get_context   (GstWorkBatch *batch,
+                                             guint index);
+GstWorkers *   gst_work_batch_get_workers   (GstWorkBatch *batch);
+guint          gst_work_batch_get_n_queued  (GstWorkBatch *batch);
+
+gpointer       gst_work_batch_peek          (GstWorkBatch *batch);
+GstFlowReturn  gst_work_batch_queue         (GstWorkBatch *batch);
+GstFlowReturn  gst_work_batch_flush         (GstWorkBatch *batch);
+void           gst_work_batch_clear         (GstWorkBatch *batch);
+
+GstClockTime   gst_work_batch_get_latency   (GstWorkBatch *batch,
+                                             gint rate_n, gint rate_d);
+
+G_END_DECLS
+
+#endif /* __GST_WORK_BATCH_H__ */
@@ -0,0 +1,173 @@
+/* GStreamer
+ *
+ * gstworkers.c: split work in slices over a pool of threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gstworkers.h"
+
+struct _GstWorkers
+{
+  GThreadPool *pool;
+  guint n_threads;
+  /* what gst_workers_new() was asked for, n_threads may be less */
+  guint n_requested;
+
+  GMutex lock;
+  GCond cond;
+  guint pending;
+
+  /* the work being done, only valid during gst_workers_run() */
+  GstWorkFunc func;
+  gpointer data;
+};
+
+static void
+run_slice (gpointer slice, GstWorkers * workers)
+{
+  workers->func (workers->data, GPOINTER_TO_UINT (slice) - 1,
+      workers->n_threads);
+
+  g_mutex_lock (&workers->lock);
+  if (--workers->pending == 0)
+    g_cond_signal (&workers->cond);
+  g_mutex_unlock (&workers->lock);
+}
+
+/**
+ * gst_workers_new:
+ * @n_threads: the number of threads to split the work over
+ *
+ * Make a new set of workers. The calling thread of gst_workers_run() is
+ * one of the @n_threads, so @n_threads - 1 threads are started.
+ *
+ * Returns: a new #GstWorkers, free with gst_workers_free().
+ */
+GstWorkers *
+gst_workers_new (guint n_threads)
+{
+  GstWorkers *workers;
+
+  g_return_val_if_fail (n_threads > 0, NULL);
+
+  workers = g_slice_new0 (GstWorkers);
+  workers->n_threads = n_threads;
+  workers->n_requested = n_threads;
+  g_mutex_init (&workers->lock);
+  g_cond_init (&workers->cond);
+
+  if (n_threads > 1) {
+    workers->pool = g_thread_pool_new ((GFunc) run_slice, workers,
+        n_threads - 1, TRUE, NULL);
+    /* without threads everything runs in the calling thread */
+    if (workers->pool == NULL)
+      workers->n_threads = 1;
+  }
+
+  return workers;
+}
+
+/**
+ * gst_workers_free:
+ * @workers: a #GstWorkers
+ *
+ * Stop the threads of @workers and free it. No work can be running.
+ */
+void
+gst_workers_free (GstWorkers * workers)
+{
+  g_return_if_fail (workers != NULL);
+
+  if (workers->pool)
+    g_thread_pool_free (workers->pool, TRUE, TRUE);
+  g_mutex_clear (&workers->lock);
+  g_cond_clear (&workers->cond);
+  g_slice_free (GstWorkers, workers);
+}
+
+/**
+ * gst_workers_ensure:
+ * @workers: (inout): location of a #GstWorkers or %NULL
+ * @n_threads: the number of threads the work should be split over
+ *
+ * Replace *@workers when it was made for another number of threads. With
+ * one thread no workers are needed, *@workers is freed and set to %NULL.
+ * This is for elements that let the number of threads change at any time,
+ * and call it before every gst_workers_run().
+ */
+void
+gst_workers_ensure (GstWorkers ** workers, guint n_threads)
+{
+  g_return_if_fail (workers != NULL);
+
+  if (*workers) {
+    if ((*workers)->n_requested == n_threads)
+      return;
+    gst_workers_free (*workers);
+    *workers = NULL;
+  }
+
+  if (n_threads > 1)
+    *workers = gst_workers_new (n_threads);
+}
+
+/**
+ * gst_workers_get_n_threads:
+ * @workers: a #GstWorkers
+ *
+ * Returns: the number of slices gst_workers_run() splits the work in.
+ */
+guint
+gst_workers_get_n_threads (GstWorkers * workers)
+{
+  g_return_val_if_fail (workers != NULL, 0);
+
+  return workers->n_threads;
+}
+
+/**
+ * gst_workers_run:
+ * @workers: a #GstWorkers
+ * @func: the function doing one slice of the work
+ * @data: user data for @func
+ *
+ * Call @func for every slice, concurrently, and wait until all slices are
+ * done. The first slice runs in the calling thread.
+ */
+void
+gst_workers_run (GstWorkers * workers, GstWorkFunc func, gpointer data)
+{
+  guint i;
+
+  g_return_if_fail (workers != NULL);
+  g_return_if_fail (func != NULL);
+
+  workers->func = func;
+  workers->data = data;
+  workers->pending = workers->n_threads - 1;
+
+  /* slices are pushed 1-based so that none of them is a NULL pointer */
+  for (i = 1; i < workers->n_threads; i++)
+    g_thread_pool_push (workers->pool, GUINT_TO_POINTER (i + 1), NULL);
+
+  func (data, 0, workers->n_threads);
+
+  g_mutex_lock (&workers->lock);
+  while (workers->pending > 0)
+    g_cond_wait (&workers->cond, &workers->lock);
+  g_mutex_unlock (&workers->lock);
+}
@@ -0,0 +1,54 @@
+/* GStreamer
+ *
+ * gstworkers.h: split work in slices over a pool of threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_WORKERS_H__
+#define __GST_WORKERS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstWorkers GstWorkers;
+
+/**
+ * GstWorkFunc:
+ * @data: user data passed to gst_workers_run()
+ * @slice: the slice to handle
+ * @n_slices: the total number of slices
+ *
+ * Handle one slice of the work. Slices run concurrently and must not touch
+ * each other's data.
+ */
+typedef void (*GstWorkFunc) (gpointer data, guint slice, guint n_slices);
+
+GstWorkers * gst_workers_new           (guint n_threads);
+void         gst_workers_free          (GstWorkers *workers);
+void         gst_workers_ensure        (GstWorkers **workers,
+                                        guint n_threads);
+
+guint        gst_workers_get_n_threads (GstWorkers *workers);
+
+void         gst_workers_run           (GstWorkers *workers,
+                                        GstWorkFunc func,
+                                        gpointer data);
+
+G_END_DECLS
+
+#endif /* __GST_WORKERS_H__ */
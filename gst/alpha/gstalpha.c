@@ -44,6 +44,7 @@
 #endif
 
 #include "gstalpha.h"
+#include "gstalphaorc.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -107,6 +108,7 @@ enum
 #define DEFAULT_BLACK_SENSITIVITY 100
 #define DEFAULT_WHITE_SENSITIVITY 100
 #define DEFAULT_PREFER_PASSTHROUGH FALSE
+#define DEFAULT_N_THREADS 1
 
 enum
 {
@@ -121,6 +123,7 @@ enum
   PROP_BLACK_SENSITIVITY,
   PROP_WHITE_SENSITIVITY,
   PROP_PREFER_PASSTHROUGH,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
@@ -130,7 +133,8 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ AYUV, "
             "ARGB, BGRA, ABGR, RGBA, Y444, xRGB, BGRx, xBGR, "
-            "RGBx, RGB, BGR, Y42B, YUY2, YVYU, UYVY, I420, YV12, Y41B } "))
+            "RGBx, RGB, BGR, Y42B, YUY2, YVYU, UYVY, I420, YV12, Y41B, "
+            "NV12, NV21 } "))
     );
 
 static GstStaticPadTemplate gst_alpha_sink_template =
@@ -139,7 +143,8 @@ GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ AYUV, "
             "ARGB, BGRA, ABGR, RGBA, Y444, xRGB, BGRx, xBGR, "
-            "RGBx, RGB, BGR, Y42B, YUY2, YVYU, UYVY, I420, YV12, " "Y41B } "))
+            "RGBx, RGB, BGR, Y42B, YUY2, YVYU, UYVY, I420, YV12, Y41B, "
+            "NV12, NV21 } "))
     );
 
 static GstStaticCaps gst_alpha_alpha_caps =
@@ -266,6 +271,20 @@ gst_alpha_class_init (GstAlphaClass * klass)
           DEFAULT_PREFER_PASSTHROUGH,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAlpha:n-threads:
+   *
+   * The number of threads that process a frame. Every thread handles a
+   * horizontal stripe of the frame, so the output does not depend on this
+   * setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to process a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class, "Alpha filter",
       "Filter/Effect/Video",
       "Adds an alpha channel to video - uniform or via chroma-keying",
@@ -299,6 +318,7 @@ gst_alpha_init (GstAlpha * alpha)
   alpha->noise_level = DEFAULT_NOISE_LEVEL;
   alpha->black_sensitivity = DEFAULT_BLACK_SENSITIVITY;
   alpha->white_sensitivity = DEFAULT_WHITE_SENSITIVITY;
+  alpha->n_threads = DEFAULT_N_THREADS;
 
   g_mutex_init (&alpha->lock);
 }
@@ -308,6 +328,8 @@ gst_alpha_finalize (GObject * object)
 {
   GstAlpha *alpha = GST_ALPHA (object);
 
+  if (alpha->workers)
+    gst_workers_free (alpha->workers);
   g_mutex_clear (&alpha->lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -376,6 +398,10 @@ gst_alpha_set_property (GObject * object, guint prop_id,
       alpha->prefer_passthrough = prefer_passthrough;
       break;
     }
+    case PROP_N_THREADS:
+      /* takes effect with the next frame */
+      alpha->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -424,6 +450,9 @@ gst_alpha_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_PREFER_PASSTHROUGH:
       g_value_set_boolean (value, alpha->prefer_passthrough);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, alpha->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1015,6 +1044,19 @@ gst_alpha_set_ayuv_ayuv (const GstVideoFrame * in_frame,
   }
 }
 
+static void
+gst_alpha_set_ayuv_ayuv_orc (const GstVideoFrame * in_frame,
+    GstVideoFrame * out_frame, GstAlpha * alpha)
+{
+  gint s_alpha = CLAMP ((gint) (alpha->alpha * 256), 0, 256);
+
+  alpha_orc_set_ayuv (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0),
+      GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0),
+      GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0),
+      GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0), s_alpha,
+      GST_VIDEO_FRAME_WIDTH (in_frame), GST_VIDEO_FRAME_HEIGHT (in_frame));
+}
+
 static void
 gst_alpha_chroma_key_ayuv_ayuv (const GstVideoFrame * in_frame,
     GstVideoFrame * out_frame, GstAlpha * alpha)
@@ -1351,7 +1393,7 @@ gst_alpha_set_planar_yuv_ayuv (const GstVideoFrame * in_frame,
   const guint8 *srcU, *srcU_tmp;
   const guint8 *srcV, *srcV_tmp;
   gint i, j;
-  gint y_stride, uv_stride;
+  gint y_stride, uv_stride, uv_pstride;
   gint v_subs, h_subs;
 
   dest = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
@@ -1361,6 +1403,7 @@ gst_alpha_set_planar_yuv_ayuv (const GstVideoFrame * in_frame,
 
   y_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0);
   uv_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 1);
+  uv_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, 1);
 
   srcY_tmp = srcY = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
   srcU_tmp = srcU = GST_VIDEO_FRAME_COMP_DATA (in_frame, 1);
@@ -1369,6 +1412,8 @@ gst_alpha_set_planar_yuv_ayuv (const GstVideoFrame * in_frame,
   switch (GST_VIDEO_FRAME_FORMAT (in_frame)) {
     case GST_VIDEO_FORMAT_I420:
     case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
       v_subs = h_subs = 2;
       break;
     case GST_VIDEO_FORMAT_Y444:
@@ -1398,8 +1443,8 @@ gst_alpha_set_planar_yuv_ayuv (const GstVideoFrame * in_frame,
         dest += 4;
         srcY++;
         if ((j + 1) % h_subs == 0) {
-          srcU++;
-          srcV++;
+          srcU += uv_pstride;
+          srcV += uv_pstride;
         }
       }
 
@@ -1435,8 +1480,8 @@ gst_alpha_set_planar_yuv_ayuv (const GstVideoFrame * in_frame,
         dest += 4;
         srcY++;
         if ((j + 1) % h_subs == 0) {
-          srcU++;
-          srcV++;
+          srcU += uv_pstride;
+          srcV += uv_pstride;
         }
       }
 
@@ -1464,7 +1509,7 @@ gst_alpha_chroma_key_planar_yuv_ayuv (const GstVideoFrame * in_frame,
   const guint8 *srcV, *srcV_tmp;
   gint i, j;
   gint a, y, u, v;
-  gint y_stride, uv_stride;
+  gint y_stride, uv_stride, uv_pstride;
   gint v_subs, h_subs;
   gint smin = 128 - alpha->black_sensitivity;
   gint smax = 128 + alpha->white_sensitivity;
@@ -1483,6 +1528,7 @@ gst_alpha_chroma_key_planar_yuv_ayuv (const GstVideoFrame * in_frame,
 
   y_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0);
   uv_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 1);
+  uv_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, 1);
 
   srcY_tmp = srcY = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
   srcU_tmp = srcU = GST_VIDEO_FRAME_COMP_DATA (in_frame, 1);
@@ -1491,6 +1537,8 @@ gst_alpha_chroma_key_planar_yuv_ayuv (const GstVideoFrame * in_frame,
   switch (GST_VIDEO_FRAME_FORMAT (in_frame)) {
     case GST_VIDEO_FORMAT_I420:
     case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
       v_subs = h_subs = 2;
       break;
     case GST_VIDEO_FORMAT_Y444:
@@ -1532,8 +1580,8 @@ gst_alpha_chroma_key_planar_yuv_ayuv (const GstVideoFrame * in_frame,
         dest += 4;
         srcY++;
         if ((j + 1) % h_subs == 0) {
-          srcU++;
-          srcV++;
+          srcU += uv_pstride;
+          srcV += uv_pstride;
         }
       }
 
@@ -1572,8 +1620,8 @@ gst_alpha_chroma_key_planar_yuv_ayuv (const GstVideoFrame * in_frame,
         dest += 4;
         srcY++;
         if ((j + 1) % h_subs == 0) {
-          srcU++;
-          srcV++;
+          srcU += uv_pstride;
+          srcV += uv_pstride;
         }
       }
 
@@ -1600,7 +1648,7 @@ gst_alpha_set_planar_yuv_argb (const GstVideoFrame * in_frame,
   const guint8 *srcU, *srcU_tmp;
   const guint8 *srcV, *srcV_tmp;
   gint i, j;
-  gint y_stride, uv_stride;
+  gint y_stride, uv_stride, uv_pstride;
   gint v_subs, h_subs;
   gint matrix[12];
   gint a, y, u, v;
@@ -1619,6 +1667,7 @@ gst_alpha_set_planar_yuv_argb (const GstVideoFrame * in_frame,
 
   y_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0);
   uv_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 1);
+  uv_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, 1);
 
   srcY_tmp = srcY = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
   srcU_tmp = srcU = GST_VIDEO_FRAME_COMP_DATA (in_frame, 1);
@@ -1627,6 +1676,8 @@ gst_alpha_set_planar_yuv_argb (const GstVideoFrame * in_frame,
   switch (GST_VIDEO_FRAME_FORMAT (in_frame)) {
     case GST_VIDEO_FORMAT_I420:
     case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
       v_subs = h_subs = 2;
       break;
     case GST_VIDEO_FORMAT_Y444:
@@ -1667,8 +1718,8 @@ gst_alpha_set_planar_yuv_argb (const GstVideoFrame * in_frame,
       dest += 4;
       srcY++;
       if ((j + 1) % h_subs == 0) {
-        srcU++;
-        srcV++;
+        srcU += uv_pstride;
+        srcV += uv_pstride;
       }
     }
 
@@ -1696,7 +1747,7 @@ gst_alpha_chroma_key_planar_yuv_argb (const GstVideoFrame * in_frame,
   gint i, j;
   gint a, y, u, v;
   gint r, g, b;
-  gint y_stride, uv_stride;
+  gint y_stride, uv_stride, uv_pstride;
   gint v_subs, h_subs;
   gint smin = 128 - alpha->black_sensitivity;
   gint smax = 128 + alpha->white_sensitivity;
@@ -1722,6 +1773,7 @@ gst_alpha_chroma_key_planar_yuv_argb (const GstVideoFrame * in_frame,
 
   y_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0);
   uv_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 1);
+  uv_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, 1);
 
   srcY_tmp = srcY = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
   srcU_tmp = srcU = GST_VIDEO_FRAME_COMP_DATA (in_frame, 1);
@@ -1730,6 +1782,8 @@ gst_alpha_chroma_key_planar_yuv_argb (const GstVideoFrame * in_frame,
   switch (GST_VIDEO_FRAME_FORMAT (in_frame)) {
     case GST_VIDEO_FORMAT_I420:
     case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
       v_subs = h_subs = 2;
       break;
     case GST_VIDEO_FORMAT_Y444:
@@ -1777,8 +1831,8 @@ gst_alpha_chroma_key_planar_yuv_argb (const GstVideoFrame * in_frame,
       dest += 4;
       srcY++;
       if ((j + 1) % h_subs == 0) {
-        srcU++;
-        srcV++;
+        srcU += uv_pstride;
+        srcV += uv_pstride;
       }
     }
 
@@ -2385,13 +2439,19 @@ gst_alpha_set_process_function_full (GstAlpha * alpha, GstVideoInfo * in_info,
         case GST_VIDEO_FORMAT_AYUV:
           switch (GST_VIDEO_INFO_FORMAT (in_info)) {
             case GST_VIDEO_FORMAT_AYUV:
-              alpha->process = gst_alpha_set_ayuv_ayuv;
+              /* only the alpha is touched without a matrix conversion */
+              if (alpha->in_sdtv == alpha->out_sdtv)
+                alpha->process = gst_alpha_set_ayuv_ayuv_orc;
+              else
+                alpha->process = gst_alpha_set_ayuv_ayuv;
               break;
             case GST_VIDEO_FORMAT_Y444:
             case GST_VIDEO_FORMAT_Y42B:
             case GST_VIDEO_FORMAT_I420:
             case GST_VIDEO_FORMAT_YV12:
             case GST_VIDEO_FORMAT_Y41B:
+            case GST_VIDEO_FORMAT_NV12:
+            case GST_VIDEO_FORMAT_NV21:
               alpha->process = gst_alpha_set_planar_yuv_ayuv;
               break;
             case GST_VIDEO_FORMAT_YUY2:
@@ -2430,6 +2490,8 @@ gst_alpha_set_process_function_full (GstAlpha * alpha, GstVideoInfo * in_info,
             case GST_VIDEO_FORMAT_I420:
             case GST_VIDEO_FORMAT_YV12:
             case GST_VIDEO_FORMAT_Y41B:
+            case GST_VIDEO_FORMAT_NV12:
+            case GST_VIDEO_FORMAT_NV21:
               alpha->process = gst_alpha_set_planar_yuv_argb;
               break;
             case GST_VIDEO_FORMAT_YUY2:
@@ -2474,6 +2536,8 @@ gst_alpha_set_process_function_full (GstAlpha * alpha, GstVideoInfo * in_info,
             case GST_VIDEO_FORMAT_I420:
             case GST_VIDEO_FORMAT_YV12:
             case GST_VIDEO_FORMAT_Y41B:
+            case GST_VIDEO_FORMAT_NV12:
+            case GST_VIDEO_FORMAT_NV21:
               alpha->process = gst_alpha_chroma_key_planar_yuv_ayuv;
               break;
             case GST_VIDEO_FORMAT_YUY2:
@@ -2512,6 +2576,8 @@ gst_alpha_set_process_function_full (GstAlpha * alpha, GstVideoInfo * in_info,
             case GST_VIDEO_FORMAT_I420:
             case GST_VIDEO_FORMAT_YV12:
             case GST_VIDEO_FORMAT_Y41B:
+            case GST_VIDEO_FORMAT_NV12:
+            case GST_VIDEO_FORMAT_NV21:
               alpha->process = gst_alpha_chroma_key_planar_yuv_argb;
               break;
             case GST_VIDEO_FORMAT_YUY2:
@@ -2576,6 +2642,58 @@ gst_alpha_before_transform (GstBaseTransform * btrans, GstBuffer * buf)
     gst_object_sync_values (GST_OBJECT (alpha), timestamp);
 }
 
+/* stripes start on even lines so that they also start on a chroma line of
+ * vertically subsampled input */
+#define STRIPE_ALIGN 2
+
+typedef struct
+{
+  GstAlpha *alpha;
+  const GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+} GstAlphaProcessData;
+
+/* make @stripe a view of the lines [@y, @y + @height) of @frame */
+static void
+gst_alpha_get_stripe (const GstVideoFrame * frame, gint y, gint height,
+    GstVideoFrame * stripe)
+{
+  guint plane;
+
+  *stripe = *frame;
+  stripe->info.height = height;
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (frame); plane++) {
+    gint plane_y = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (frame->info.finfo,
+        plane, y);
+
+    stripe->data[plane] = (guint8 *) frame->data[plane] +
+        plane_y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+  }
+}
+
+/* run the processing function on one horizontal stripe of the frame, the
+ * processing functions only look at the lines they write */
+static void
+gst_alpha_process_stripe (gpointer user_data, guint slice, guint n_slices)
+{
+  GstAlphaProcessData *data = user_data;
+  GstVideoFrame in_stripe, out_stripe;
+  gint height = GST_VIDEO_FRAME_HEIGHT (data->out_frame);
+  gint n_units = (height + STRIPE_ALIGN - 1) / STRIPE_ALIGN;
+  gint start, end;
+
+  start = MIN (height, (n_units * slice / n_slices) * STRIPE_ALIGN);
+  end = MIN (height, (n_units * (slice + 1) / n_slices) * STRIPE_ALIGN);
+  if (start >= end)
+    return;
+
+  gst_alpha_get_stripe (data->in_frame, start, end - start, &in_stripe);
+  gst_alpha_get_stripe (data->out_frame, start, end - start, &out_stripe);
+
+  data->alpha->process (&in_stripe, &out_stripe, data->alpha);
+}
+
 static GstFlowReturn
 gst_alpha_transform_frame (GstVideoFilter * filter, GstVideoFrame * in_frame,
     GstVideoFrame * out_frame)
@@ -2587,7 +2705,18 @@ gst_alpha_transform_frame (GstVideoFilter * filter, GstVideoFrame * in_frame,
   if (G_UNLIKELY (!alpha->process))
     goto not_negotiated;
 
-  alpha->process (in_frame, out_frame, alpha);
+  gst_workers_ensure (&alpha->workers, alpha->n_threads);
+
+  if (alpha->workers) {
+    GstAlphaProcessData data;
+
+    data.alpha = alpha;
+    data.in_frame = in_frame;
+    data.out_frame = out_frame;
+    gst_workers_run (alpha->workers, gst_alpha_process_stripe, &data);
+  } else {
+    alpha->process (in_frame, out_frame, alpha);
+  }
 
   GST_ALPHA_UNLOCK (alpha);
 
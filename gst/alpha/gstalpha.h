@@ -27,6 +27,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_ALPHA \
@@ -89,6 +91,11 @@ struct _GstAlpha
 
   gboolean prefer_passthrough;
 
+  guint n_threads;
+
+  /* row-parallel processing, only touched from the streaming thread */
+  GstWorkers *workers;
+
   /* processing function */
   void (*process) (const GstVideoFrame *in_frame, GstVideoFrame *out_frame, GstAlpha *alpha);
 
@@ -45,6 +45,7 @@
 #include <gst/audio/gstaudiofilter.h>
 
 #include "audioamplify.h"
+#include "audiofxorc.h"
 
 #define GST_CAT_DEFAULT gst_audio_amplify_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -123,18 +124,18 @@ static GstFlowReturn gst_audio_amplify_transform_ip (GstBaseTransform * base,
 #define MIN_gint32 G_MININT32
 #define MAX_gint32 G_MAXINT32
 
-#define MAKE_INT_FUNCS(type,largetype)                                        \
+/* clipping is done by the saturating conversions of the Orc functions,
+ * wrapping around to the negative end is the same as truncating the 8 and
+ * 16 bit samples */
+#define MAKE_ORC_FUNC(type,method,func)                                       \
 static void                                                                   \
-gst_audio_amplify_transform_##type##_clip (GstAudioAmplify * filter,          \
+gst_audio_amplify_transform_##type##_##method (GstAudioAmplify * filter,      \
     void * data, guint num_samples)                                           \
 {                                                                             \
-  type *d = data;                                                             \
-                                                                              \
-  while (num_samples--) {                                                     \
-    largetype val = *d * filter->amplification;                               \
-    *d++ =  CLAMP (val, MIN_##type, MAX_##type);                              \
-  }                                                                           \
-}                                                                             \
+  func (data, filter->amplification, num_samples);                            \
+}
+
+#define MAKE_INT_WRAP_NEGATIVE_FUNC(type,largetype)                           \
 static void                                                                   \
 gst_audio_amplify_transform_##type##_wrap_negative (GstAudioAmplify * filter, \
     void * data, guint num_samples)                                           \
@@ -151,7 +152,9 @@ gst_audio_amplify_transform_##type##_wrap_negative (GstAudioAmplify * filter, \
           MIN_##type);                                                        \
     *d++ = val;                                                               \
   }                                                                           \
-}                                                                             \
+}
+
+#define MAKE_INT_WRAP_POSITIVE_FUNC(type,largetype)                           \
 static void                                                                   \
 gst_audio_amplify_transform_##type##_wrap_positive (GstAudioAmplify * filter, \
     void * data, guint num_samples)                                           \
@@ -170,29 +173,9 @@ gst_audio_amplify_transform_##type##_wrap_positive (GstAudioAmplify * filter, \
     } while (1);                                                              \
     *d++ = val;                                                               \
   }                                                                           \
-}                                                                             \
-static void                                                                   \
-gst_audio_amplify_transform_##type##_noclip (GstAudioAmplify * filter,        \
-    void * data, guint num_samples)                                           \
-{                                                                             \
-  type *d = data;                                                             \
-                                                                              \
-  while (num_samples--)                                                       \
-    *d++ *= filter->amplification;                                            \
 }
 
-#define MAKE_FLOAT_FUNCS(type)                                                \
-static void                                                                   \
-gst_audio_amplify_transform_##type##_clip (GstAudioAmplify * filter,          \
-    void * data, guint num_samples)                                           \
-{                                                                             \
-  type *d = data;                                                             \
-                                                                              \
-  while (num_samples--) {                                                     \
-    type val = *d* filter->amplification;                                     \
-    *d++ = CLAMP (val, -1.0, +1.0);                                           \
-  }                                                                           \
-}                                                                             \
+#define MAKE_FLOAT_WRAP_FUNCS(type)                                           \
 static void                                                                   \
 gst_audio_amplify_transform_##type##_wrap_negative (GstAudioAmplify *         \
     filter, void * data, guint num_samples)                                   \
@@ -230,23 +213,27 @@ gst_audio_amplify_transform_##type##_wrap_positive (GstAudioAmplify * filter, \
     } while (1);                                                              \
     *d++ = val;                                                               \
   }                                                                           \
-}                                                                             \
-static void                                                                   \
-gst_audio_amplify_transform_##type##_noclip (GstAudioAmplify * filter,        \
-    void * data, guint num_samples)                                           \
-{                                                                             \
-  type *d = data;                                                             \
-                                                                              \
-  while (num_samples--)                                                       \
-    *d++ *= filter->amplification;                                            \
 }
 
 /* *INDENT-OFF* */
-MAKE_INT_FUNCS (gint8,gint)
-MAKE_INT_FUNCS (gint16,gint)
-MAKE_INT_FUNCS (gint32,gint64)
-MAKE_FLOAT_FUNCS (gfloat)
-MAKE_FLOAT_FUNCS (gdouble)
+MAKE_ORC_FUNC (gint8, clip, audioamplify_orc_clip_s8)
+MAKE_ORC_FUNC (gint8, wrap_negative, audioamplify_orc_noclip_s8)
+MAKE_INT_WRAP_POSITIVE_FUNC (gint8, gint)
+MAKE_ORC_FUNC (gint8, noclip, audioamplify_orc_noclip_s8)
+MAKE_ORC_FUNC (gint16, clip, audioamplify_orc_clip_s16)
+MAKE_ORC_FUNC (gint16, wrap_negative, audioamplify_orc_noclip_s16)
+MAKE_INT_WRAP_POSITIVE_FUNC (gint16, gint)
+MAKE_ORC_FUNC (gint16, noclip, audioamplify_orc_noclip_s16)
+MAKE_ORC_FUNC (gint32, clip, audioamplify_orc_clip_s32)
+MAKE_INT_WRAP_NEGATIVE_FUNC (gint32, gint64)
+MAKE_INT_WRAP_POSITIVE_FUNC (gint32, gint64)
+MAKE_ORC_FUNC (gint32, noclip, audioamplify_orc_clip_s32)
+MAKE_ORC_FUNC (gfloat, clip, audioamplify_orc_clip_f32)
+MAKE_FLOAT_WRAP_FUNCS (gfloat)
+MAKE_ORC_FUNC (gfloat, noclip, audioamplify_orc_noclip_f32)
+MAKE_ORC_FUNC (gdouble, clip, audioamplify_orc_clip_f64)
+MAKE_FLOAT_WRAP_FUNCS (gdouble)
+MAKE_ORC_FUNC (gdouble, noclip, audioamplify_orc_noclip_f64)
 /* *INDENT-ON* */
 
 /* GObject vmethod implementations */
@@ -436,48 +436,23 @@ generate_coefficients (GstAudioChebBand * filter, const GstAudioInfo * info)
   /* Calculate coefficients for the chebyshev filter */
   {
     gint np = filter->poles;
-    gdouble *a, *b;
+    gint ns = np / 4;
+    gdouble *sections;
     gint i, p;
 
-    a = g_new0 (gdouble, np + 5);
-    b = g_new0 (gdouble, np + 5);
+    /* every four poles make a section with b[0..4] followed by
+     * a[0..4], at high orders the cascade is much more robust
+     * than the multiplied out transfer function */
+    sections = g_new0 (gdouble, ns * 10);
 
-    /* Calculate transfer function coefficients */
-    a[4] = 1.0;
-    b[4] = 1.0;
-
-    for (p = 1; p <= np / 4; p++) {
-      gdouble b0, b1, b2, b3, b4, a1, a2, a3, a4;
-      gdouble *ta = g_new0 (gdouble, np + 5);
-      gdouble *tb = g_new0 (gdouble, np + 5);
+    for (p = 1; p <= ns; p++) {
+      gdouble *s = sections + (p - 1) * 10;
 
       generate_biquad_coefficients (filter, p, rate,
-          &b0, &b1, &b2, &b3, &b4, &a1, &a2, &a3, &a4);
-
-      memcpy (ta, a, sizeof (gdouble) * (np + 5));
-      memcpy (tb, b, sizeof (gdouble) * (np + 5));
-
-      /* add the new coefficients for the new two poles
-       * to the cascade by multiplication of the transfer
-       * functions */
-      for (i = 4; i < np + 5; i++) {
-        b[i] =
-            b0 * tb[i] + b1 * tb[i - 1] + b2 * tb[i - 2] + b3 * tb[i - 3] +
-            b4 * tb[i - 4];
-        a[i] =
-            ta[i] - a1 * ta[i - 1] - a2 * ta[i - 2] - a3 * ta[i - 3] -
-            a4 * ta[i - 4];
-      }
-      g_free (ta);
-      g_free (tb);
-    }
-
-    /* Move coefficients to the beginning of the array to move from
-     * the transfer function's coefficients to the difference
-     * equation's coefficients */
-    for (i = 0; i <= np; i++) {
-      a[i] = a[i + 4];
-      b[i] = b[i + 4];
+          &s[0], &s[1], &s[2], &s[3], &s[4], &s[6], &s[7], &s[8], &s[9]);
+      s[5] = 1.0;
+      for (i = 6; i < 10; i++)
+        s[i] = -s[i];
     }
 
     /* Normalize to unity gain at frequency 0 and frequency
@@ -487,16 +462,16 @@ generate_coefficients (GstAudioChebBand * filter, const GstAudioInfo * info)
       /* gain is sqrt(H(0)*H(0.5)) */
 
       gdouble gain1 =
-          gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b, np + 1,
-          1.0, 0.0);
+          gst_audio_fx_base_iir_filter_calculate_sections_gain (sections, ns,
+          4, 1.0, 0.0);
       gdouble gain2 =
-          gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b, np + 1,
-          -1.0, 0.0);
+          gst_audio_fx_base_iir_filter_calculate_sections_gain (sections, ns,
+          4, -1.0, 0.0);
 
       gain1 = sqrt (gain1 * gain2);
 
-      for (i = 0; i <= np; i++) {
-        b[i] /= gain1;
+      for (i = 0; i < 5; i++) {
+        sections[i] /= gain1;
       }
     } else {
       /* gain is H(wc), wc = center frequency */
@@ -506,16 +481,16 @@ generate_coefficients (GstAudioChebBand * filter, const GstAudioInfo * info)
       gdouble w0 = (w2 + w1) / 2.0;
       gdouble zr = cos (w0), zi = sin (w0);
       gdouble gain =
-          gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b, np + 1, zr,
-          zi);
+          gst_audio_fx_base_iir_filter_calculate_sections_gain (sections, ns,
+          4, zr, zi);
 
-      for (i = 0; i <= np; i++) {
-        b[i] /= gain;
+      for (i = 0; i < 5; i++) {
+        sections[i] /= gain;
       }
     }
 
-    gst_audio_fx_base_iir_filter_set_coefficients (GST_AUDIO_FX_BASE_IIR_FILTER
-        (filter), a, np + 1, b, np + 1);
+    gst_audio_fx_base_iir_filter_set_sections (GST_AUDIO_FX_BASE_IIR_FILTER
+        (filter), sections, ns, 4);
 
     GST_LOG_OBJECT (filter,
         "Generated IIR coefficients for the Chebyshev filter");
@@ -526,8 +501,8 @@ generate_coefficients (GstAudioChebBand * filter, const GstAudioInfo * info)
         filter->upper_frequency, filter->ripple);
 
     GST_LOG_OBJECT (filter, "%.2f dB gain @ 0Hz",
-        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b,
-                np + 1, 1.0, 0.0)));
+        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                (sections, ns, 4, 1.0, 0.0)));
     {
       gdouble w1 = 2.0 * G_PI * (filter->lower_frequency / rate);
       gdouble w2 = 2.0 * G_PI * (filter->upper_frequency / rate);
@@ -537,23 +512,23 @@ generate_coefficients (GstAudioChebBand * filter, const GstAudioInfo * info)
       zr = cos (w1);
       zi = sin (w1);
       GST_LOG_OBJECT (filter, "%.2f dB gain @ %dHz",
-          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1,
-                  b, np + 1, zr, zi)), (int) filter->lower_frequency);
+          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                  (sections, ns, 4, zr, zi)), (int) filter->lower_frequency);
       zr = cos (w0);
       zi = sin (w0);
       GST_LOG_OBJECT (filter, "%.2f dB gain @ %dHz",
-          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1,
-                  b, np + 1, zr, zi)),
+          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                  (sections, ns, 4, zr, zi)),
           (int) ((filter->lower_frequency + filter->upper_frequency) / 2.0));
       zr = cos (w2);
       zi = sin (w2);
       GST_LOG_OBJECT (filter, "%.2f dB gain @ %dHz",
-          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1,
-                  b, np + 1, zr, zi)), (int) filter->upper_frequency);
+          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                  (sections, ns, 4, zr, zi)), (int) filter->upper_frequency);
     }
     GST_LOG_OBJECT (filter, "%.2f dB gain @ %dHz",
-        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b,
-                np + 1, -1.0, 0.0)), rate / 2);
+        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                (sections, ns, 4, -1.0, 0.0)), rate / 2);
   }
 }
 
@@ -392,43 +392,23 @@ generate_coefficients (GstAudioChebLimit * filter, const GstAudioInfo * info)
   /* Calculate coefficients for the chebyshev filter */
   {
     gint np = filter->poles;
-    gdouble *a, *b;
+    gint ns = np / 2;
+    gdouble *sections;
     gint i, p;
 
-    a = g_new0 (gdouble, np + 3);
-    b = g_new0 (gdouble, np + 3);
+    /* every two poles make a biquad section with b[0..2] followed
+     * by a[0..2], at high orders the cascade is much more robust
+     * than the multiplied out transfer function */
+    sections = g_new0 (gdouble, ns * 6);
 
-    /* Calculate transfer function coefficients */
-    a[2] = 1.0;
-    b[2] = 1.0;
+    for (p = 1; p <= ns; p++) {
+      gdouble *s = sections + (p - 1) * 6;
 
-    for (p = 1; p <= np / 2; p++) {
-      gdouble b0, b1, b2, a1, a2;
-      gdouble *ta = g_new0 (gdouble, np + 3);
-      gdouble *tb = g_new0 (gdouble, np + 3);
-
-      generate_biquad_coefficients (filter, p, rate, &b0, &b1, &b2, &a1, &a2);
-
-      memcpy (ta, a, sizeof (gdouble) * (np + 3));
-      memcpy (tb, b, sizeof (gdouble) * (np + 3));
-
-      /* add the new coefficients for the new two poles
-       * to the cascade by multiplication of the transfer
-       * functions */
-      for (i = 2; i < np + 3; i++) {
-        b[i] = b0 * tb[i] + b1 * tb[i - 1] + b2 * tb[i - 2];
-        a[i] = ta[i] - a1 * ta[i - 1] - a2 * ta[i - 2];
-      }
-      g_free (ta);
-      g_free (tb);
-    }
-
-    /* Move coefficients to the beginning of the array to move from
-     * the transfer function's coefficients to the difference
-     * equation's coefficients */
-    for (i = 0; i <= np; i++) {
-      a[i] = a[i + 2];
-      b[i] = b[i + 2];
+      generate_biquad_coefficients (filter, p, rate, &s[0], &s[1], &s[2],
+          &s[4], &s[5]);
+      s[3] = 1.0;
+      s[4] = -s[4];
+      s[5] = -s[5];
     }
 
     /* Normalize to unity gain at frequency 0 for lowpass
@@ -438,20 +418,20 @@ generate_coefficients (GstAudioChebLimit * filter, const GstAudioInfo * info)
 
       if (filter->mode == MODE_LOW_PASS)
         gain =
-            gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b, np + 1,
-            1.0, 0.0);
+            gst_audio_fx_base_iir_filter_calculate_sections_gain (sections,
+            ns, 2, 1.0, 0.0);
       else
         gain =
-            gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b, np + 1,
-            -1.0, 0.0);
+            gst_audio_fx_base_iir_filter_calculate_sections_gain (sections,
+            ns, 2, -1.0, 0.0);
 
-      for (i = 0; i <= np; i++) {
-        b[i] /= gain;
+      for (i = 0; i < 3; i++) {
+        sections[i] /= gain;
       }
     }
 
-    gst_audio_fx_base_iir_filter_set_coefficients (GST_AUDIO_FX_BASE_IIR_FILTER
-        (filter), a, np + 1, b, np + 1);
+    gst_audio_fx_base_iir_filter_set_sections (GST_AUDIO_FX_BASE_IIR_FILTER
+        (filter), sections, ns, 2);
 
     GST_LOG_OBJECT (filter,
         "Generated IIR coefficients for the Chebyshev filter");
@@ -460,8 +440,8 @@ generate_coefficients (GstAudioChebLimit * filter, const GstAudioInfo * info)
         (filter->mode == MODE_LOW_PASS) ? "low-pass" : "high-pass",
         filter->type, filter->poles, filter->cutoff, filter->ripple);
     GST_LOG_OBJECT (filter, "%.2f dB gain @ 0 Hz",
-        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b,
-                np + 1, 1.0, 0.0)));
+        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                (sections, ns, 2, 1.0, 0.0)));
 
 #ifndef GST_DISABLE_GST_DEBUG
     {
@@ -469,14 +449,14 @@ generate_coefficients (GstAudioChebLimit * filter, const GstAudioInfo * info)
       gdouble zr = cos (wc), zi = sin (wc);
 
       GST_LOG_OBJECT (filter, "%.2f dB gain @ %d Hz",
-          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1,
-                  b, np + 1, zr, zi)), (int) filter->cutoff);
+          20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                  (sections, ns, 2, zr, zi)), (int) filter->cutoff);
     }
 #endif
 
     GST_LOG_OBJECT (filter, "%.2f dB gain @ %d Hz",
-        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_gain (a, np + 1, b,
-                np + 1, -1.0, 0.0)), rate);
+        20.0 * log10 (gst_audio_fx_base_iir_filter_calculate_sections_gain
+                (sections, ns, 2, -1.0, 0.0)), rate);
   }
 }
 
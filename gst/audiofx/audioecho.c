@@ -32,6 +32,9 @@
  * will be used. This can only be set before going to the PAUSED or PLAYING
  * state and will be set to the current delay by default.
  *
+ * With the taps property more echoes at multiples of the delay are added,
+ * each one weaker by the intensity than the one before it.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -61,9 +64,17 @@ enum
   PROP_DELAY,
   PROP_MAX_DELAY,
   PROP_INTENSITY,
-  PROP_FEEDBACK
+  PROP_FEEDBACK,
+  PROP_TAPS
 };
 
+#define DEFAULT_TAPS 1
+#define MAX_TAPS 16
+
+/* the number of frames the taps after the first one are summed up
+ * for at once */
+#define SCRATCH_FRAMES 256
+
 #define ALLOWED_CAPS \
     "audio/x-raw,"                                                 \
     " format=(string) {"GST_AUDIO_NE(F32)","GST_AUDIO_NE(F64)"}, " \
@@ -135,6 +146,23 @@ gst_audio_echo_class_init (GstAudioEchoClass * klass)
           0.0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
           | GST_PARAM_CONTROLLABLE));
 
+  /**
+   * GstAudioEcho:taps:
+   *
+   * Number of echoes, the n-th one is delayed by n times the delay and
+   * has the intensity to the power of n. The echoes are computed in the
+   * same pass over the delay line.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_TAPS,
+      g_param_spec_uint ("taps", "Taps",
+          "Number of echoes at multiples of the delay"
+          " (can't be changed in PLAYING or PAUSED state)",
+          1, MAX_TAPS, DEFAULT_TAPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class, "Audio echo",
       "Filter/Effect/Audio",
       "Adds an echo or reverb effect to an audio stream",
@@ -158,6 +186,7 @@ gst_audio_echo_init (GstAudioEcho * self)
   self->max_delay = 1;
   self->intensity = 0.0;
   self->feedback = 0.0;
+  self->taps = DEFAULT_TAPS;
 
   g_mutex_init (&self->lock);
 
@@ -171,6 +200,8 @@ gst_audio_echo_finalize (GObject * object)
 
   g_free (self->buffer);
   self->buffer = NULL;
+  g_free (self->scratch);
+  self->scratch = NULL;
 
   g_mutex_clear (&self->lock);
 
@@ -238,6 +269,17 @@ gst_audio_echo_set_property (GObject * object, guint prop_id,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_TAPS:{
+      g_mutex_lock (&self->lock);
+      if (GST_STATE (self) > GST_STATE_READY) {
+        GST_ERROR_OBJECT (self, "Can't change the number of taps in"
+            " PLAYING or PAUSED state");
+      } else {
+        self->taps = g_value_get_uint (value);
+      }
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -271,6 +313,11 @@ gst_audio_echo_get_property (GObject * object, guint prop_id,
       g_value_set_float (value, self->feedback);
       g_mutex_unlock (&self->lock);
       break;
+    case PROP_TAPS:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->taps);
+      g_mutex_unlock (&self->lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -301,6 +348,8 @@ gst_audio_echo_setup (GstAudioFilter * base, const GstAudioInfo * info)
 
   g_free (self->buffer);
   self->buffer = NULL;
+  g_free (self->scratch);
+  self->scratch = NULL;
   self->buffer_pos = 0;
   self->buffer_size = 0;
   self->buffer_size_frames = 0;
@@ -315,6 +364,8 @@ gst_audio_echo_stop (GstBaseTransform * base)
 
   g_free (self->buffer);
   self->buffer = NULL;
+  g_free (self->scratch);
+  self->scratch = NULL;
   self->buffer_pos = 0;
   self->buffer_size = 0;
   self->buffer_size_frames = 0;
@@ -322,39 +373,104 @@ gst_audio_echo_stop (GstBaseTransform * base)
   return TRUE;
 }
 
+/* The delay line is processed in blocks that are contiguous in the ring
+ * buffer for the output and all the taps. The ring positions and the
+ * interpolation offsets are only calculated once per block instead of
+ * with two modulos for every frame, and the loops over the interleaved
+ * samples of a block need no index arithmetic */
 #define TRANSFORM_FUNC(name, type) \
 static void \
 gst_audio_echo_transform_##name (GstAudioEcho * self, \
     type * data, guint num_samples) \
 { \
   type *buffer = (type *) self->buffer; \
+  type *acc = (type *) self->scratch; \
   guint channels = GST_AUDIO_FILTER_CHANNELS (self); \
   guint rate = GST_AUDIO_FILTER_RATE (self); \
-  guint i, j; \
-  guint echo_index = self->buffer_size_frames - self->delay_frames; \
-  gdouble echo_off = ((((gdouble) self->delay) * rate) / GST_SECOND) - self->delay_frames; \
+  guint size = self->buffer_size_frames; \
+  guint taps = self->taps; \
+  guint echo_index[MAX_TAPS], echo0_pos[MAX_TAPS], echo1_pos[MAX_TAPS]; \
+  gdouble echo_off[MAX_TAPS], gain[MAX_TAPS]; \
+  gdouble intensity = self->intensity, feedback = self->feedback; \
+  guint i, t, n, len, max_len = G_MAXUINT; \
   \
-  if (echo_off < 0.0) \
-    echo_off = 0.0; \
+  for (t = 0; t < taps; t++) { \
+    guint64 delay = self->delay * (t + 1); \
+    guint frames; \
+    \
+    if (t == 0) \
+      frames = self->delay_frames; \
+    else \
+      frames = CLAMP (gst_util_uint64_scale (delay, rate, GST_SECOND), 1, \
+          size); \
+    \
+    echo_index[t] = size - frames; \
+    echo_off[t] = CLAMP ((((gdouble) delay) * rate) / GST_SECOND - frames, \
+        0.0, 1.0); \
+    gain[t] = (t == 0) ? intensity : gain[t - 1] * intensity; \
+    \
+    /* the later taps are summed up before the block is written, they must \
+     * not read what the same block writes */ \
+    if (t > 0) \
+      max_len = MIN (max_len, MAX (frames - 1, 1)); \
+  } \
+  if (taps > 1) \
+    max_len = MIN (max_len, SCRATCH_FRAMES); \
   \
   num_samples /= channels; \
   \
-  for (i = 0; i < num_samples; i++) { \
-    guint echo0_index = ((echo_index + self->buffer_pos) % self->buffer_size_frames) * channels; \
-    guint echo1_index = ((echo_index + self->buffer_pos +1) % self->buffer_size_frames) * channels; \
-    guint rbout_index = (self->buffer_pos % self->buffer_size_frames) * channels; \
-    for (j = 0; j < channels; j++) { \
-      gdouble in = data[i*channels + j]; \
-      gdouble echo0 = buffer[echo0_index + j]; \
-      gdouble echo1 = buffer[echo1_index + j]; \
-      gdouble echo = echo0 + (echo1-echo0)*echo_off; \
-      type out = in + self->intensity * echo; \
-      \
-      data[i*channels + j] = out; \
+  while (num_samples > 0) { \
+    type *out, *e0, *e1; \
+    guint pos = self->buffer_pos; \
+    \
+    len = MIN (num_samples, max_len); \
+    len = MIN (len, size - pos); \
+    for (t = 0; t < taps; t++) { \
+      echo0_pos[t] = (echo_index[t] + pos) % size; \
+      echo1_pos[t] = (echo0_pos[t] + 1) % size; \
+      len = MIN (len, size - echo0_pos[t]); \
+      len = MIN (len, size - echo1_pos[t]); \
+    } \
+    n = len * channels; \
+    \
+    for (t = 1; t < taps; t++) { \
+      gdouble off = echo_off[t], g = gain[t]; \
       \
-      buffer[rbout_index + j] = in + self->feedback * echo; \
+      e0 = buffer + echo0_pos[t] * channels; \
+      e1 = buffer + echo1_pos[t] * channels; \
+      if (t == 1) { \
+        for (i = 0; i < n; i++) \
+          acc[i] = g * (e0[i] + (e1[i] - e0[i]) * off); \
+      } else { \
+        for (i = 0; i < n; i++) \
+          acc[i] += g * (e0[i] + (e1[i] - e0[i]) * off); \
+      } \
     } \
-    self->buffer_pos = (self->buffer_pos + 1) % self->buffer_size_frames; \
+    \
+    out = buffer + pos * channels; \
+    e0 = buffer + echo0_pos[0] * channels; \
+    e1 = buffer + echo1_pos[0] * channels; \
+    if (taps > 1) { \
+      for (i = 0; i < n; i++) { \
+        gdouble in = data[i]; \
+        gdouble echo = e0[i] + (e1[i] - e0[i]) * echo_off[0]; \
+        \
+        data[i] = in + intensity * echo + acc[i]; \
+        out[i] = in + feedback * echo; \
+      } \
+    } else { \
+      for (i = 0; i < n; i++) { \
+        gdouble in = data[i]; \
+        gdouble echo = e0[i] + (e1[i] - e0[i]) * echo_off[0]; \
+        \
+        data[i] = in + intensity * echo; \
+        out[i] = in + feedback * echo; \
+      } \
+    } \
+    \
+    data += n; \
+    num_samples -= len; \
+    self->buffer_pos = (pos + len) % size; \
   } \
 }
 
@@ -390,12 +506,16 @@ gst_audio_echo_transform_ip (GstBaseTransform * base, GstBuffer * buf)
     self->delay_frames =
         MAX (gst_util_uint64_scale (self->delay, rate, GST_SECOND), 1);
     self->buffer_size_frames =
-        MAX (gst_util_uint64_scale (self->max_delay, rate, GST_SECOND), 1);
+        MAX (gst_util_uint64_scale (self->max_delay,
+            (guint64) rate * self->taps, GST_SECOND), 1);
 
     self->buffer_size = self->buffer_size_frames * bpf;
     self->buffer = g_try_malloc0 (self->buffer_size);
     self->buffer_pos = 0;
 
+    if (self->taps > 1)
+      self->scratch = g_malloc (SCRATCH_FRAMES * bpf);
+
     if (self->buffer == NULL) {
       g_mutex_unlock (&self->lock);
       GST_ERROR_OBJECT (self, "Failed to allocate %u bytes", self->buffer_size);
@@ -47,6 +47,7 @@ struct _GstAudioEcho
   guint64 max_delay;
   gfloat intensity;
   gfloat feedback;
+  guint taps;
 
   /* < private > */
   GstAudioEchoProcessFunc process;
@@ -55,6 +56,7 @@ struct _GstAudioEcho
   guint buffer_pos;
   guint buffer_size;
   guint buffer_size_frames;
+  guint8 *scratch;
 
   GMutex lock;
 };
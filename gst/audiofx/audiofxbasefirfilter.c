@@ -50,11 +50,23 @@ enum
 {
   PROP_0 = 0,
   PROP_LOW_LATENCY,
-  PROP_DRAIN_ON_CHANGES
+  PROP_DRAIN_ON_CHANGES,
+  PROP_PARTITION_LENGTH,
+  PROP_N_THREADS
 };
 
 #define DEFAULT_LOW_LATENCY FALSE
 #define DEFAULT_DRAIN_ON_CHANGES TRUE
+#define DEFAULT_PARTITION_LENGTH 0
+#define DEFAULT_N_THREADS 1
+
+struct _GstAudioFXBaseFIRFilterSlice
+{
+  GstFFTF64 *fft;
+  GstFFTF64 *ifft;
+  GstFFTF64Complex *spectrum;
+  gdouble *output;
+};
 
 #define gst_audio_fx_base_fir_filter_parent_class parent_class
 G_DEFINE_TYPE (GstAudioFXBaseFIRFilter, gst_audio_fx_base_fir_filter,
@@ -362,6 +374,206 @@ DEFINE_FFT_PROCESS_FUNC_FIXED_CHANNELS (64, 2, double);
 #undef DEFINE_FFT_PROCESS_FUNC
 #undef DEFINE_FFT_PROCESS_FUNC_FIXED_CHANNELS
 
+/*
+ * The uniformly partitioned FFT convolution splits the kernel in
+ * K partitions of P samples and processes the input in blocks of
+ * P samples. Every block is transformed together with the previous
+ * input with an FFT of length N >= 2 * P and its spectrum is kept in
+ * a frequency domain delay line of the last K spectra. The output
+ * block is then
+ *
+ * Y = IFFT ( \sum_{k=0}^{K-1} X_{-k} * H_k )
+ *
+ * where X_{-k} is the spectrum of k blocks ago and H_k the spectrum
+ * of the k-th kernel partition. The latency is only P samples, the
+ * runtime complexity per sample is O (log N + K). The channels are
+ * independent and are convolved on the worker threads.
+ */
+static void
+gst_audio_fx_base_fir_filter_free_slices (GstAudioFXBaseFIRFilter * self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_slices; i++) {
+    GstAudioFXBaseFIRFilterSlice *slice = &self->slices[i];
+
+    gst_fft_f64_free (slice->fft);
+    gst_fft_f64_free (slice->ifft);
+    g_free (slice->spectrum);
+    g_free (slice->output);
+  }
+  g_free (self->slices);
+  self->slices = NULL;
+  self->n_slices = 0;
+}
+
+static void
+gst_audio_fx_base_fir_filter_convolve_partitioned (GstAudioFXBaseFIRFilter *
+    self, GstAudioFXBaseFIRFilterSlice * slice, guint channel)
+{
+  guint block_length = self->block_length;
+  guint partition_length = self->partition_length;
+  guint n_partitions = self->n_partitions;
+  guint frequency_response_length = self->frequency_response_length;
+  GstFFTF64Complex *frequency_response = self->frequency_response;
+  GstFFTF64Complex *spectrum = slice->spectrum;
+  GstFFTF64Complex *fdl, *x, *h;
+  gdouble *buffer = self->buffer + block_length * channel;
+  guint i, k, pos;
+
+  fdl = self->fdl + n_partitions * frequency_response_length * channel;
+
+  /* Calculate FFT of the newest input block */
+  gst_fft_f64_fft (slice->fft, buffer,
+      fdl + self->fdl_pos * frequency_response_length);
+
+  /* Sum the products of the input spectra and the kernel partitions */
+  memset (spectrum, 0, sizeof (GstFFTF64Complex) * frequency_response_length);
+  for (k = 0, pos = self->fdl_pos; k < n_partitions; k++) {
+    x = fdl + pos * frequency_response_length;
+    h = frequency_response + k * frequency_response_length;
+
+    for (i = 0; i < frequency_response_length; i++) {
+      spectrum[i].r += x[i].r * h[i].r - x[i].i * h[i].i;
+      spectrum[i].i += x[i].r * h[i].i + x[i].i * h[i].r;
+    }
+
+    pos = (pos == 0) ? n_partitions - 1 : pos - 1;
+  }
+
+  /* Calculate inverse FFT of the result, the last partition_length
+   * samples are the output */
+  gst_fft_f64_inverse_fft (slice->ifft, spectrum, slice->output);
+  memcpy (self->partition_output + partition_length * channel,
+      slice->output + block_length - partition_length,
+      sizeof (gdouble) * partition_length);
+
+  /* Make room for the next input block */
+  memmove (buffer, buffer + partition_length,
+      sizeof (gdouble) * (block_length - partition_length));
+}
+
+static void
+gst_audio_fx_base_fir_filter_convolve_slice (gpointer data, guint slice,
+    guint n_slices)
+{
+  GstAudioFXBaseFIRFilter *self = data;
+  gint channels = GST_AUDIO_FILTER_CHANNELS (self);
+  guint j;
+
+  for (j = slice; j < channels; j += n_slices)
+    gst_audio_fx_base_fir_filter_convolve_partitioned (self,
+        &self->slices[slice], j);
+}
+
+#define DEFINE_PARTITIONED_PROCESS_FUNC(width,ctype) \
+static guint \
+process_partitioned_##width (GstAudioFXBaseFIRFilter * self, \
+    const g##ctype * src, g##ctype * dst, guint input_samples) \
+{ \
+  gint channels = GST_AUDIO_FILTER_CHANNELS (self); \
+  guint block_length = self->block_length; \
+  guint partition_length = self->partition_length; \
+  guint buffer_fill = self->buffer_fill; \
+  gdouble *buffer = self->buffer; \
+  guint generated = 0; \
+  guint i, j, pass; \
+  \
+  if (!self->slices) { \
+    self->n_slices = self->workers ? \
+        gst_workers_get_n_threads (self->workers) : 1; \
+    self->slices = g_new0 (GstAudioFXBaseFIRFilterSlice, self->n_slices); \
+    for (i = 0; i < self->n_slices; i++) { \
+      GstAudioFXBaseFIRFilterSlice *slice = &self->slices[i]; \
+      \
+      slice->fft = gst_fft_f64_new (block_length, FALSE); \
+      slice->ifft = gst_fft_f64_new (block_length, TRUE); \
+      slice->spectrum = \
+          g_new (GstFFTF64Complex, self->frequency_response_length); \
+      slice->output = g_new (gdouble, block_length); \
+    } \
+  } \
+  \
+  /* Buffer contains the last block_length input samples of every \
+   * channel, new samples are put into the last partition_length \
+   * samples */ \
+  if (!buffer) { \
+    self->buffer_length = partition_length; \
+    self->buffer = buffer = g_new0 (gdouble, block_length * channels); \
+    self->buffer_fill = buffer_fill = 0; \
+    \
+    g_free (self->fdl); \
+    self->fdl = g_new0 (GstFFTF64Complex, \
+        self->n_partitions * self->frequency_response_length * channels); \
+    self->fdl_pos = 0; \
+    g_free (self->partition_output); \
+    self->partition_output = g_new (gdouble, partition_length * channels); \
+  } \
+  \
+  g_assert (self->buffer_length == partition_length); \
+  \
+  while (input_samples) { \
+    pass = MIN (partition_length - buffer_fill, input_samples); \
+    \
+    /* Deinterleave channels */ \
+    for (i = 0; i < pass; i++) { \
+      for (j = 0; j < channels; j++) { \
+        buffer[block_length * j + block_length - partition_length + \
+            buffer_fill + i] = src[i * channels + j]; \
+      } \
+    } \
+    buffer_fill += pass; \
+    src += channels * pass; \
+    input_samples -= pass; \
+    \
+    /* If we don't have a complete partition go out */ \
+    if (buffer_fill < partition_length) \
+      break; \
+    \
+    if (self->workers && channels > 1) { \
+      gst_workers_run (self->workers, \
+          gst_audio_fx_base_fir_filter_convolve_slice, self); \
+    } else { \
+      for (j = 0; j < channels; j++) \
+        gst_audio_fx_base_fir_filter_convolve_partitioned (self, \
+            &self->slices[0], j); \
+    } \
+    self->fdl_pos = (self->fdl_pos + 1) % self->n_partitions; \
+    \
+    /* Interleave the output of the channels */ \
+    for (i = 0; i < partition_length; i++) { \
+      for (j = 0; j < channels; j++) { \
+        dst[i * channels + j] = \
+            self->partition_output[partition_length * j + i]; \
+      } \
+    } \
+    \
+    generated += partition_length; \
+    dst += channels * partition_length; \
+    buffer_fill = 0; \
+  } \
+  \
+  /* Write back cached buffer_fill value */ \
+  self->buffer_fill = buffer_fill; \
+  \
+  return generated; \
+}
+
+DEFINE_PARTITIONED_PROCESS_FUNC (32, float);
+DEFINE_PARTITIONED_PROCESS_FUNC (64, double);
+
+#undef DEFINE_PARTITIONED_PROCESS_FUNC
+
+/* Number of output samples of every FFT convolution block */
+static guint
+gst_audio_fx_base_fir_filter_block_samples (GstAudioFXBaseFIRFilter * self)
+{
+  if (self->partition_length)
+    return self->partition_length;
+
+  return self->block_length - self->kernel_length + 1;
+}
+
 /* Element class */
 static void
     gst_audio_fx_base_fir_filter_calculate_frequency_response
@@ -375,8 +587,48 @@ static void
   self->frequency_response_length = 0;
   g_free (self->fft_buffer);
   self->fft_buffer = NULL;
+  gst_audio_fx_base_fir_filter_free_slices (self);
+  self->n_partitions = 0;
 
   if (self->kernel && self->kernel_length >= FFT_THRESHOLD
+      && !self->low_latency && self->partition_length) {
+    guint partition_length = self->partition_length;
+    guint block_length, i, k, len;
+    gdouble *kernel_tmp;
+
+    /* Every block of partition_length samples is transformed together
+     * with the previous input, each partition of the kernel with
+     * zeroes */
+    block_length = gst_fft_next_fast_length (2 * partition_length);
+    self->block_length = block_length;
+    self->n_partitions =
+        (self->kernel_length + partition_length - 1) / partition_length;
+
+    self->fft = gst_fft_f64_new (block_length, FALSE);
+    self->ifft = gst_fft_f64_new (block_length, TRUE);
+    self->frequency_response_length = block_length / 2 + 1;
+    self->frequency_response = g_new (GstFFTF64Complex,
+        self->frequency_response_length * self->n_partitions);
+
+    kernel_tmp = g_new (gdouble, block_length);
+    for (k = 0; k < self->n_partitions; k++) {
+      GstFFTF64Complex *h =
+          self->frequency_response + k * self->frequency_response_length;
+
+      len = MIN (partition_length, self->kernel_length - k * partition_length);
+      memset (kernel_tmp, 0, block_length * sizeof (gdouble));
+      memcpy (kernel_tmp, self->kernel + k * partition_length,
+          len * sizeof (gdouble));
+      gst_fft_f64_fft (self->fft, kernel_tmp, h);
+
+      /* Normalize to make sure IFFT(FFT(x)) == x */
+      for (i = 0; i < self->frequency_response_length; i++) {
+        h[i].r /= block_length;
+        h[i].i /= block_length;
+      }
+    }
+    g_free (kernel_tmp);
+  } else if (self->kernel && self->kernel_length >= FFT_THRESHOLD
       && !self->low_latency) {
     guint block_length, i;
     gdouble *kernel_tmp, *kernel = self->kernel;
@@ -412,7 +664,10 @@ gst_audio_fx_base_fir_filter_select_process_function (GstAudioFXBaseFIRFilter *
 {
   switch (format) {
     case GST_AUDIO_FORMAT_F32:
-      if (self->fft && !self->low_latency) {
+      if (self->fft && !self->low_latency && self->partition_length) {
+        self->process =
+            (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_32;
+      } else if (self->fft && !self->low_latency) {
         if (channels == 1)
           self->process = (GstAudioFXBaseFIRFilterProcessFunc) process_fft_1_32;
         else if (channels == 2)
@@ -429,7 +684,10 @@ gst_audio_fx_base_fir_filter_select_process_function (GstAudioFXBaseFIRFilter *
       }
       break;
     case GST_AUDIO_FORMAT_F64:
-      if (self->fft && !self->low_latency) {
+      if (self->fft && !self->low_latency && self->partition_length) {
+        self->process =
+            (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_64;
+      } else if (self->fft && !self->low_latency) {
         if (channels == 1)
           self->process = (GstAudioFXBaseFIRFilterProcessFunc) process_fft_1_64;
         else if (channels == 2)
@@ -462,6 +720,11 @@ gst_audio_fx_base_fir_filter_finalize (GObject * object)
   gst_fft_f64_free (self->ifft);
   g_free (self->frequency_response);
   g_free (self->fft_buffer);
+  g_free (self->fdl);
+  g_free (self->partition_output);
+  gst_audio_fx_base_fir_filter_free_slices (self);
+  if (self->workers)
+    gst_workers_free (self->workers);
   g_mutex_clear (&self->lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -502,6 +765,32 @@ gst_audio_fx_base_fir_filter_set_property (GObject * object, guint prop_id,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_PARTITION_LENGTH:{
+      guint partition_length;
+
+      if (GST_STATE (self) >= GST_STATE_PAUSED) {
+        g_warning ("Changing the \"partition-length\" property "
+            "is only allowed in states < PAUSED");
+        return;
+      }
+
+      g_mutex_lock (&self->lock);
+      partition_length = g_value_get_uint (value);
+
+      if (self->partition_length != partition_length) {
+        self->partition_length = partition_length;
+        gst_audio_fx_base_fir_filter_calculate_frequency_response (self);
+        gst_audio_fx_base_fir_filter_select_process_function (self,
+            GST_AUDIO_FILTER_FORMAT (self), GST_AUDIO_FILTER_CHANNELS (self));
+      }
+      g_mutex_unlock (&self->lock);
+      break;
+    }
+    case PROP_N_THREADS:
+      g_mutex_lock (&self->lock);
+      self->n_threads = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -521,6 +810,12 @@ gst_audio_fx_base_fir_filter_get_property (GObject * object, guint prop_id,
     case PROP_DRAIN_ON_CHANGES:
       g_value_set_boolean (value, self->drain_on_changes);
       break;
+    case PROP_PARTITION_LENGTH:
+      g_value_set_uint (value, self->partition_length);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -569,6 +864,37 @@ gst_audio_fx_base_fir_filter_class_init (GstAudioFXBaseFIRFilterClass * klass)
           DEFAULT_DRAIN_ON_CHANGES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioFXBaseFIRFilter:partition-length:
+   *
+   * Split long filter kernels in partitions of this many samples for the
+   * FFT convolution. The latency is then only the partition length instead
+   * of a multiple of the kernel length, at the cost of more work per sample
+   * for very long kernels. 0 processes the whole kernel in one block.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_PARTITION_LENGTH,
+      g_param_spec_uint ("partition-length", "Partition length",
+          "Number of samples per partition of the FFT convolution, "
+          "0 processes the kernel in one block. "
+          "Can only be changed in states < PAUSED!", 0, G_MAXINT / 4,
+          DEFAULT_PARTITION_LENGTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioFXBaseFIRFilter:n-threads:
+   *
+   * Number of threads that convolve the channels in parallel in the
+   * partitioned FFT convolution. Takes effect when the element is started.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads for the partitioned FFT convolution", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   caps = gst_caps_from_string (ALLOWED_CAPS);
   gst_audio_filter_class_add_pad_templates (GST_AUDIO_FILTER_CLASS (klass),
       caps);
@@ -600,6 +926,8 @@ gst_audio_fx_base_fir_filter_init (GstAudioFXBaseFIRFilter * self)
 
   self->low_latency = DEFAULT_LOW_LATENCY;
   self->drain_on_changes = DEFAULT_DRAIN_ON_CHANGES;
+  self->partition_length = DEFAULT_PARTITION_LENGTH;
+  self->n_threads = DEFAULT_N_THREADS;
 
   g_mutex_init (&self->lock);
 }
@@ -667,7 +995,7 @@ gst_audio_fx_base_fir_filter_push_residue (GstAudioFXBaseFIRFilter * self)
     gst_buffer_map (outbuf, &map, GST_MAP_READWRITE);
 
     while (gensamples < outsamples) {
-      guint step_insamples = self->block_length - self->buffer_fill;
+      guint step_insamples = self->buffer_length - self->buffer_fill;
       guint8 *zeroes = g_new0 (guint8, step_insamples * channels * bps);
       guint8 *out = g_new (guint8, self->block_length * channels * bps);
       guint step_gensamples;
@@ -675,8 +1003,8 @@ gst_audio_fx_base_fir_filter_push_residue (GstAudioFXBaseFIRFilter * self)
       step_gensamples = self->process (self, zeroes, out, step_insamples);
       g_free (zeroes);
 
-      memcpy (map.data + gensamples * bps, out, MIN (step_gensamples,
-              outsamples - gensamples) * bps);
+      memcpy (map.data + gensamples * channels * bps, out,
+          MIN (step_gensamples, outsamples - gensamples) * channels * bps);
       gensamples += MIN (step_gensamples, outsamples - gensamples);
 
       g_free (out);
@@ -775,7 +1103,7 @@ gst_audio_fx_base_fir_filter_transform_size (GstBaseTransform * base,
   bpf = GST_AUDIO_INFO_BPF (&info);
 
   size /= bpf;
-  blocklen = self->block_length - self->kernel_length + 1;
+  blocklen = gst_audio_fx_base_fir_filter_block_samples (self);
   *othersize = ((size + blocklen - 1) / blocklen) * blocklen;
   *othersize *= bpf;
 
@@ -930,6 +1258,16 @@ gst_audio_fx_base_fir_filter_start (GstBaseTransform * base)
   self->nsamples_out = 0;
   self->nsamples_in = 0;
 
+  g_mutex_lock (&self->lock);
+  if (self->n_threads > 1) {
+    self->workers = gst_workers_new (self->n_threads);
+    GST_DEBUG_OBJECT (self, "convolving with %u threads",
+        gst_workers_get_n_threads (self->workers));
+  }
+  /* the FFT state of the workers is made again on demand */
+  gst_audio_fx_base_fir_filter_free_slices (self);
+  g_mutex_unlock (&self->lock);
+
   return TRUE;
 }
 
@@ -942,6 +1280,18 @@ gst_audio_fx_base_fir_filter_stop (GstBaseTransform * base)
   self->buffer = NULL;
   self->buffer_length = 0;
 
+  g_mutex_lock (&self->lock);
+  g_free (self->fdl);
+  self->fdl = NULL;
+  g_free (self->partition_output);
+  self->partition_output = NULL;
+  gst_audio_fx_base_fir_filter_free_slices (self);
+  if (self->workers) {
+    gst_workers_free (self->workers);
+    self->workers = NULL;
+  }
+  g_mutex_unlock (&self->lock);
+
   return TRUE;
 }
 
@@ -971,7 +1321,7 @@ gst_audio_fx_base_fir_filter_query (GstBaseTransform * trans,
             GST_TIME_ARGS (min), GST_TIME_ARGS (max));
 
         if (self->fft && !self->low_latency)
-          latency = self->block_length - self->kernel_length + 1;
+          latency = gst_audio_fx_base_fir_filter_block_samples (self);
         else
           latency = self->latency;
 
@@ -1028,7 +1378,7 @@ gst_audio_fx_base_fir_filter_set_kernel (GstAudioFXBaseFIRFilter * self,
     gdouble * kernel, guint kernel_length, guint64 latency,
     const GstAudioInfo * info)
 {
-  gboolean latency_changed;
+  gboolean latency_changed, partitions_changed = FALSE;
   GstAudioFormat format;
   gint channels;
 
@@ -1043,9 +1393,19 @@ gst_audio_fx_base_fir_filter_set_kernel (GstAudioFXBaseFIRFilter * self,
       || (!self->low_latency && self->kernel_length >= FFT_THRESHOLD
           && kernel_length < FFT_THRESHOLD));
 
+  /* The delay line of the partitioned convolution has one spectrum per
+   * kernel partition, handle a change of their number like a latency
+   * change */
+  if (!self->low_latency && self->partition_length
+      && kernel_length >= FFT_THRESHOLD
+      && (kernel_length + self->partition_length - 1) /
+      self->partition_length != self->n_partitions)
+    partitions_changed = TRUE;
+
   /* FIXME: If the latency changes, the buffer size changes too and we
    * have to drain in any case until this is fixed in the future */
-  if (self->buffer && (!self->drain_on_changes || latency_changed)) {
+  if (self->buffer && (!self->drain_on_changes || latency_changed
+          || partitions_changed)) {
     gst_audio_fx_base_fir_filter_push_residue (self);
     self->start_ts = GST_CLOCK_TIME_NONE;
     self->start_off = GST_BUFFER_OFFSET_NONE;
@@ -1055,7 +1415,7 @@ gst_audio_fx_base_fir_filter_set_kernel (GstAudioFXBaseFIRFilter * self,
   }
 
   g_free (self->kernel);
-  if (!self->drain_on_changes || latency_changed) {
+  if (!self->drain_on_changes || latency_changed || partitions_changed) {
     g_free (self->buffer);
     self->buffer = NULL;
     self->buffer_fill = 0;
@@ -29,6 +29,8 @@
 #include <gst/audio/gstaudiofilter.h>
 #include <gst/fft/gstfftf64.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_AUDIO_FX_BASE_FIR_FILTER \
@@ -45,6 +47,8 @@ G_BEGIN_DECLS
 typedef struct _GstAudioFXBaseFIRFilter GstAudioFXBaseFIRFilter;
 typedef struct _GstAudioFXBaseFIRFilterClass GstAudioFXBaseFIRFilterClass;
 
+typedef struct _GstAudioFXBaseFIRFilterSlice GstAudioFXBaseFIRFilterSlice;
+
 typedef guint (*GstAudioFXBaseFIRFilterProcessFunc) (GstAudioFXBaseFIRFilter *, const guint8 *, guint8 *, guint);
 
 /**
@@ -80,6 +84,18 @@ struct _GstAudioFXBaseFIRFilter {
   GstFFTF64Complex *fft_buffer;          /* FFT buffer, has the length of the frequency response */
   guint block_length;                    /* Length of the processing blocks -- time domain */
 
+  /* partitioned FFT convolution specific data */
+  guint partition_length;                /* samples per partition, 0 for one block */
+  guint n_partitions;                    /* number of kernel partitions */
+  GstFFTF64Complex *fdl;                 /* spectra of the last n_partitions input blocks, per channel */
+  guint fdl_pos;                         /* position of the newest spectrum in fdl */
+  gdouble *partition_output;             /* output of the last block, per channel */
+
+  guint n_threads;
+  GstWorkers *workers;
+  GstAudioFXBaseFIRFilterSlice *slices;  /* FFT state of each worker */
+  guint n_slices;
+
   GstClockTime start_ts;        /* start timestamp after a discont */
   guint64 start_off;            /* start offset after a discont */
   guint64 nsamples_out;         /* number of output samples since last discont */
@@ -89,6 +89,12 @@ gst_audio_fx_base_iir_filter_finalize (GObject * object)
     g_free (filter->channels);
     filter->channels = NULL;
   }
+
+  g_free (filter->sections);
+  filter->sections = NULL;
+  g_free (filter->state);
+  filter->state = NULL;
+
   g_mutex_clear (&filter->lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -131,6 +137,10 @@ gst_audio_fx_base_iir_filter_init (GstAudioFXBaseIIRFilter * filter)
   filter->nb = 0;
   filter->channels = NULL;
   filter->nchannels = 0;
+  filter->sections = NULL;
+  filter->n_sections = 0;
+  filter->order = 0;
+  filter->state = NULL;
 
   g_mutex_init (&filter->lock);
 }
@@ -178,6 +188,27 @@ gst_audio_fx_base_iir_filter_calculate_gain (gdouble * a, guint na, gdouble * b,
   return (sqrt (gain_r * gain_r + gain_i * gain_i));
 }
 
+/* Evaluate the transfer function of the cascade of sections at
+ * (zr + zi*I)^-1 and return the magnitude. This is the product of the
+ * gains of the sections and stays accurate for filters of high order */
+gdouble
+gst_audio_fx_base_iir_filter_calculate_sections_gain (gdouble * sections,
+    guint n_sections, guint order, gdouble zr, gdouble zi)
+{
+  gdouble gain = 1.0;
+  guint i;
+
+  for (i = 0; i < n_sections; i++) {
+    gdouble *b = sections + i * 2 * (order + 1);
+    gdouble *a = b + order + 1;
+
+    gain *= gst_audio_fx_base_iir_filter_calculate_gain (a, order + 1, b,
+        order + 1, zr, zi);
+  }
+
+  return gain;
+}
+
 void
 gst_audio_fx_base_iir_filter_set_coefficients (GstAudioFXBaseIIRFilter * filter,
     gdouble * a, guint na, gdouble * b, guint nb)
@@ -193,6 +224,13 @@ gst_audio_fx_base_iir_filter_set_coefficients (GstAudioFXBaseIIRFilter * filter,
 
   filter->a = filter->b = NULL;
 
+  g_free (filter->sections);
+  filter->sections = NULL;
+  filter->n_sections = 0;
+  filter->order = 0;
+  g_free (filter->state);
+  filter->state = NULL;
+
   if (filter->channels) {
     GstAudioFXBaseIIRFilterChannelCtx *ctx;
     gboolean free = (na != filter->na || nb != filter->nb);
@@ -237,6 +275,72 @@ gst_audio_fx_base_iir_filter_set_coefficients (GstAudioFXBaseIIRFilter * filter,
   g_mutex_unlock (&filter->lock);
 }
 
+/**
+ * gst_audio_fx_base_iir_filter_set_sections:
+ * @filter: a #GstAudioFXBaseIIRFilter
+ * @sections: the coefficients of the sections
+ * @n_sections: the number of sections
+ * @order: the order of each section
+ *
+ * Set the filter to a cascade of @n_sections sections of @order. For every
+ * section @sections holds the b coefficients b[0..order] followed by the
+ * a coefficients a[0..order]. The sections are run in transposed direct
+ * form II on all channels together, which is much faster and numerically
+ * more robust than the expanded polynomial for filters of high order.
+ *
+ * The filter takes ownership of @sections.
+ */
+void
+gst_audio_fx_base_iir_filter_set_sections (GstAudioFXBaseIIRFilter * filter,
+    gdouble * sections, guint n_sections, guint order)
+{
+  guint i, j;
+
+  g_return_if_fail (GST_IS_AUDIO_FX_BASE_IIR_FILTER (filter));
+  g_return_if_fail (sections != NULL && n_sections > 0 && order > 0);
+
+  /* normalize the sections to a[0] == 1 */
+  for (i = 0; i < n_sections; i++) {
+    gdouble *b = sections + i * 2 * (order + 1);
+    gdouble *a = b + order + 1;
+    gdouble a0 = a[0];
+
+    for (j = 0; j <= order; j++) {
+      b[j] /= a0;
+      a[j] /= a0;
+    }
+  }
+
+  g_mutex_lock (&filter->lock);
+
+  g_free (filter->a);
+  g_free (filter->b);
+  filter->a = filter->b = NULL;
+  filter->na = filter->nb = 0;
+
+  if (filter->channels) {
+    for (i = 0; i < filter->nchannels; i++) {
+      g_free (filter->channels[i].x);
+      g_free (filter->channels[i].y);
+    }
+    g_free (filter->channels);
+    filter->channels = NULL;
+  }
+
+  g_free (filter->sections);
+  g_free (filter->state);
+
+  filter->sections = sections;
+  filter->n_sections = n_sections;
+  filter->order = order;
+  filter->state = NULL;
+
+  if (filter->nchannels)
+    filter->state = g_new0 (gdouble, n_sections * order * filter->nchannels);
+
+  g_mutex_unlock (&filter->lock);
+}
+
 /* GstAudioFilter vmethod implementations */
 
 static gboolean
@@ -286,6 +390,12 @@ gst_audio_fx_base_iir_filter_setup (GstAudioFilter * base,
       ctx->y = g_new0 (gdouble, filter->na);
     }
     filter->nchannels = channels;
+
+    g_free (filter->state);
+    filter->state = NULL;
+    if (filter->sections)
+      filter->state =
+          g_new0 (gdouble, filter->n_sections * filter->order * channels);
   }
   g_mutex_unlock (&filter->lock);
 
@@ -331,6 +441,67 @@ process (GstAudioFXBaseIIRFilter * filter,
   return val;
 }
 
+/* number of channels that run through a section together */
+#define SECTION_LANES 8
+
+/* Run the cascade of sections in transposed direct form II. The state of
+ * a section is @order values per channel. A frame goes through all
+ * sections for up to SECTION_LANES channels at once, so the coefficients
+ * of a section are read once per frame for them instead of once per
+ * channel. Unlike the multiplied out polynomial, the coefficients of the
+ * short sections stay well conditioned at high orders */
+#define DEFINE_PROCESS_SECTIONS_FUNC(width,ctype) \
+static void \
+process_sections_##width (GstAudioFXBaseIIRFilter * filter, \
+    g##ctype * data, guint num_samples) \
+{ \
+  const gdouble *sections = filter->sections; \
+  guint n_sections = filter->n_sections, order = filter->order; \
+  guint channels = filter->nchannels; \
+  guint frames = num_samples / channels; \
+  guint c0, n, i, s, k, l; \
+  gdouble v[SECTION_LANES], y[SECTION_LANES]; \
+  \
+  for (c0 = 0; c0 < channels; c0 += SECTION_LANES) { \
+    g##ctype *d = data + c0; \
+    \
+    n = MIN (SECTION_LANES, channels - c0); \
+    \
+    for (i = 0; i < frames; i++, d += channels) { \
+      for (l = 0; l < n; l++) \
+        v[l] = d[l]; \
+      \
+      for (s = 0; s < n_sections; s++) { \
+        const gdouble *b = sections + s * 2 * (order + 1); \
+        const gdouble *a = b + order + 1; \
+        gdouble *z = filter->state + s * order * channels + c0; \
+        gdouble *zk; \
+        \
+        for (l = 0; l < n; l++) \
+          y[l] = b[0] * v[l] + z[l]; \
+        for (k = 1; k < order; k++) { \
+          zk = z + (k - 1) * channels; \
+          for (l = 0; l < n; l++) \
+            zk[l] = b[k] * v[l] - a[k] * y[l] + zk[l + channels]; \
+        } \
+        zk = z + (order - 1) * channels; \
+        for (l = 0; l < n; l++) { \
+          zk[l] = b[order] * v[l] - a[order] * y[l]; \
+          v[l] = y[l]; \
+        } \
+      } \
+      \
+      for (l = 0; l < n; l++) \
+        d[l] = v[l]; \
+    } \
+  } \
+}
+
+DEFINE_PROCESS_SECTIONS_FUNC (32, float);
+DEFINE_PROCESS_SECTIONS_FUNC (64, double);
+
+#undef DEFINE_PROCESS_SECTIONS_FUNC
+
 #define DEFINE_PROCESS_FUNC(width,ctype) \
 static void \
 process_##width (GstAudioFXBaseIIRFilter * filter, \
@@ -339,6 +510,11 @@ process_##width (GstAudioFXBaseIIRFilter * filter, \
   gint i, j, channels = filter->nchannels; \
   gdouble val; \
   \
+  if (filter->sections) { \
+    process_sections_##width (filter, data, num_samples); \
+    return; \
+  } \
+  \
   for (i = 0; i < num_samples / channels; i++) { \
     for (j = 0; j < channels; j++) { \
       val = process (filter, &filter->channels[j], *data); \
@@ -372,7 +548,7 @@ gst_audio_fx_base_iir_filter_transform_ip (GstBaseTransform * base,
   if (GST_CLOCK_TIME_IS_VALID (stream_time))
     gst_object_sync_values (GST_OBJECT (filter), stream_time);
 
-  if (filter->a == NULL || filter->b == NULL) {
+  if (filter->sections == NULL && (filter->a == NULL || filter->b == NULL)) {
     g_return_val_if_fail (filter->a != NULL
         && filter->b != NULL, GST_FLOW_ERROR);
     return GST_FLOW_ERROR;
@@ -412,5 +588,8 @@ gst_audio_fx_base_iir_filter_stop (GstBaseTransform * base)
   filter->channels = NULL;
   filter->nchannels = 0;
 
+  g_free (filter->state);
+  filter->state = NULL;
+
   return TRUE;
 }
@@ -62,6 +62,14 @@ struct _GstAudioFXBaseIIRFilter
   GstAudioFXBaseIIRFilterChannelCtx *channels;
   guint nchannels;
 
+  /* cascade of sections of @order, each section is b[0..order]
+   * followed by a[0..order] with a[0] == 1 */
+  gdouble *sections;
+  guint n_sections;
+  guint order;
+  /* section state, (section * order + k) * nchannels + channel */
+  gdouble *state;
+
   GMutex lock;
 };
 
@@ -72,7 +80,9 @@ struct _GstAudioFXBaseIIRFilterClass
 
 GType gst_audio_fx_base_iir_filter_get_type (void);
 void gst_audio_fx_base_iir_filter_set_coefficients (GstAudioFXBaseIIRFilter *filter, gdouble *a, guint na, gdouble *b, guint nb);
+void gst_audio_fx_base_iir_filter_set_sections (GstAudioFXBaseIIRFilter *filter, gdouble *sections, guint n_sections, guint order);
 gdouble gst_audio_fx_base_iir_filter_calculate_gain (gdouble *a, guint na, gdouble *b, guint nb, gdouble zr, gdouble zi);
+gdouble gst_audio_fx_base_iir_filter_calculate_sections_gain (gdouble *sections, guint n_sections, guint order, gdouble zr, gdouble zi);
 
 G_END_DECLS
 
@@ -1,5 +1,5 @@
 
-/* autogenerated from audiopanoramaorc.orc */
+/* autogenerated from audiofxorc.orc */
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -132,6 +132,17 @@ void audiopanoramam_orc_process_f32_ch2_sim_right (gfloat * ORC_RESTRICT d1,
 void audiopanoramam_orc_process_f32_ch2_sim_left (gfloat * ORC_RESTRICT d1,
     const gfloat * ORC_RESTRICT s1, float p1, int n);
 
+void audioamplify_orc_noclip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s32 (gint32 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n);
+void audioinvert_orc_s16 (gint16 * ORC_RESTRICT d1, float p1, float p2, int n);
+void audioinvert_orc_f32 (gfloat * ORC_RESTRICT d1, float p1, float p2, int n);
 
 /* begin Orc C target preamble */
 #define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
@@ -3975,3 +3986,2081 @@ audiopanoramam_orc_process_f32_ch2_sim_left (gfloat * ORC_RESTRICT d1,
   func (ex);
 }
 #endif
+
+
+/* audioamplify_orc_noclip_s8 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_noclip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union16 var42;
+
+  ptr0 = (orc_int8 *) d1;
+
+  /* 4: loadpl */
+  var35.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr0[i];
+    /* 1: convsbw */
+    var37.i = var34;
+    /* 2: convswl */
+    var38.i = var37.i;
+    /* 3: convlf */
+    var39.f = var38.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convfl */
+    {
+      int tmp;
+      tmp = (int) var40.f;
+      if (tmp == 0x80000000 && !(var40.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var41.i = tmp;
+    }
+    /* 7: convlw */
+    var42.i = var41.i;
+    /* 8: convwb */
+    var36 = var42.i;
+    /* 9: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_noclip_s8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union16 var42;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+
+  /* 4: loadpl */
+  var35.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr0[i];
+    /* 1: convsbw */
+    var37.i = var34;
+    /* 2: convswl */
+    var38.i = var37.i;
+    /* 3: convlf */
+    var39.f = var38.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convfl */
+    {
+      int tmp;
+      tmp = (int) var40.f;
+      if (tmp == 0x80000000 && !(var40.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var41.i = tmp;
+    }
+    /* 7: convlw */
+    var42.i = var41.i;
+    /* 8: convwb */
+    var36 = var42.i;
+    /* 9: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+audioamplify_orc_noclip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 26, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 110, 111, 99, 108, 105, 112, 95, 115, 56, 11, 1, 1,
+        17, 4, 20, 2, 20, 4, 149, 32, 0, 153, 33, 32, 211, 33, 33, 202,
+        33, 33, 24, 210, 33, 33, 163, 32, 33, 157, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_s8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_noclip_s8");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_s8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "convsbw", 0, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_clip_s8 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_clip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union16 var42;
+
+  ptr0 = (orc_int8 *) d1;
+
+  /* 4: loadpl */
+  var35.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr0[i];
+    /* 1: convsbw */
+    var37.i = var34;
+    /* 2: convswl */
+    var38.i = var37.i;
+    /* 3: convlf */
+    var39.f = var38.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convfl */
+    {
+      int tmp;
+      tmp = (int) var40.f;
+      if (tmp == 0x80000000 && !(var40.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var41.i = tmp;
+    }
+    /* 7: convssslw */
+    var42.i = ORC_CLAMP_SW (var41.i);
+    /* 8: convssswb */
+    var36 = ORC_CLAMP_SB (var42.i);
+    /* 9: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_clip_s8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union16 var42;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+
+  /* 4: loadpl */
+  var35.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr0[i];
+    /* 1: convsbw */
+    var37.i = var34;
+    /* 2: convswl */
+    var38.i = var37.i;
+    /* 3: convlf */
+    var39.f = var38.i;
+    /* 5: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var40.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: convfl */
+    {
+      int tmp;
+      tmp = (int) var40.f;
+      if (tmp == 0x80000000 && !(var40.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var41.i = tmp;
+    }
+    /* 7: convssslw */
+    var42.i = ORC_CLAMP_SW (var41.i);
+    /* 8: convssswb */
+    var36 = ORC_CLAMP_SB (var42.i);
+    /* 9: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+audioamplify_orc_clip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 24, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 99, 108, 105, 112, 95, 115, 56, 11, 1, 1, 17, 4,
+        20, 2, 20, 4, 149, 32, 0, 153, 33, 32, 211, 33, 33, 202, 33, 33,
+        24, 210, 33, 33, 165, 32, 33, 159, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_clip_s8");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "convsbw", 0, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convssswb", 0, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_noclip_s16 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_noclip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var33;
+  orc_union32 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union16 *) d1;
+
+  /* 3: loadpl */
+  var34.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr0[i];
+    /* 1: convswl */
+    var36.i = var33.i;
+    /* 2: convlf */
+    var37.f = var36.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var38.f;
+      if (tmp == 0x80000000 && !(var38.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var39.i = tmp;
+    }
+    /* 6: convlw */
+    var35.i = var39.i;
+    /* 7: storew */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_noclip_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var33;
+  orc_union32 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+
+  /* 3: loadpl */
+  var34.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr0[i];
+    /* 1: convswl */
+    var36.i = var33.i;
+    /* 2: convlf */
+    var37.f = var36.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var38.f;
+      if (tmp == 0x80000000 && !(var38.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var39.i = tmp;
+    }
+    /* 6: convlw */
+    var35.i = var39.i;
+    /* 7: storew */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+audioamplify_orc_noclip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 27, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 110, 111, 99, 108, 105, 112, 95, 115, 49, 54, 11, 2,
+        2, 17, 4, 20, 4, 153, 32, 0, 211, 32, 32, 202, 32, 32, 24, 210,
+        32, 32, 163, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_noclip_s16");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_s16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_clip_s16 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_clip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var33;
+  orc_union32 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union16 *) d1;
+
+  /* 3: loadpl */
+  var34.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr0[i];
+    /* 1: convswl */
+    var36.i = var33.i;
+    /* 2: convlf */
+    var37.f = var36.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var38.f;
+      if (tmp == 0x80000000 && !(var38.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var39.i = tmp;
+    }
+    /* 6: convssslw */
+    var35.i = ORC_CLAMP_SW (var39.i);
+    /* 7: storew */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_clip_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var33;
+  orc_union32 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+
+  /* 3: loadpl */
+  var34.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr0[i];
+    /* 1: convswl */
+    var36.i = var33.i;
+    /* 2: convlf */
+    var37.f = var36.i;
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: convfl */
+    {
+      int tmp;
+      tmp = (int) var38.f;
+      if (tmp == 0x80000000 && !(var38.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var39.i = tmp;
+    }
+    /* 6: convssslw */
+    var35.i = ORC_CLAMP_SW (var39.i);
+    /* 7: storew */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+audioamplify_orc_clip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 25, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 99, 108, 105, 112, 95, 115, 49, 54, 11, 2, 2, 17,
+        4, 20, 4, 153, 32, 0, 211, 32, 32, 202, 32, 32, 24, 210, 32, 32,
+        165, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_clip_s16");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_clip_s32 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_clip_s32 (gint32 * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) d1;
+
+  /* 2: loadpl */
+  var34.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr0[i];
+    /* 1: convlf */
+    var36.f = var33.i;
+    /* 3: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var36.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: convfl */
+    {
+      int tmp;
+      tmp = (int) var37.f;
+      if (tmp == 0x80000000 && !(var37.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var35.i = tmp;
+    }
+    /* 5: storel */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_clip_s32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+
+  /* 2: loadpl */
+  var34.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr0[i];
+    /* 1: convlf */
+    var36.f = var33.i;
+    /* 3: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var36.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: convfl */
+    {
+      int tmp;
+      tmp = (int) var37.f;
+      if (tmp == 0x80000000 && !(var37.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var35.i = tmp;
+    }
+    /* 5: storel */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+audioamplify_orc_clip_s32 (gint32 * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 25, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 99, 108, 105, 112, 95, 115, 51, 50, 11, 4, 4, 17,
+        4, 20, 4, 211, 32, 0, 202, 32, 32, 24, 210, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_clip_s32");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_s32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_noclip_f32 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_noclip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+
+  ptr0 = (orc_union32 *) d1;
+
+  /* 1: loadpl */
+  var33.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var32.i);
+      _src2.i = ORC_DENORMAL (var33.i);
+      _dest1.f = _src1.f * _src2.f;
+      var34.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 3: storel */
+    ptr0[i] = var34;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_noclip_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+
+  /* 1: loadpl */
+  var33.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var32.i);
+      _src2.i = ORC_DENORMAL (var33.i);
+      _dest1.f = _src1.f * _src2.f;
+      var34.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 3: storel */
+    ptr0[i] = var34;
+  }
+
+}
+
+void
+audioamplify_orc_noclip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 27, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 110, 111, 99, 108, 105, 112, 95, 102, 51, 50, 11, 4,
+        4, 17, 4, 202, 0, 0, 24, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_noclip_f32");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_f32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_P1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_clip_f32 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_clip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) d1;
+
+  /* 1: loadpl */
+  var34.f = p1;
+  /* 3: loadpl */
+  var35.i = (int) 0xbf800000; /* 3212836864 or 1.58735e-314f */
+  /* 5: loadpl */
+  var36.i = (int) 0x3f800000; /* 1065353216 or 5.26354e-315f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: maxf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      if (ORC_ISNAN (_src1.i))
+        var39.i = _src1.i;
+      else if (ORC_ISNAN (_src2.i))
+        var39.i = _src2.i;
+      else
+        var39.f = (_src1.f > _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 6: minf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      if (ORC_ISNAN (_src1.i))
+        var37.i = _src1.i;
+      else if (ORC_ISNAN (_src2.i))
+        var37.i = _src2.i;
+      else
+        var37.f = (_src1.f < _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_clip_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+
+  /* 1: loadpl */
+  var34.i = ex->params[24];
+  /* 3: loadpl */
+  var35.i = (int) 0xbf800000; /* 3212836864 or 1.58735e-314f */
+  /* 5: loadpl */
+  var36.i = (int) 0x3f800000; /* 1065353216 or 5.26354e-315f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      _src2.i = ORC_DENORMAL (var34.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: maxf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      if (ORC_ISNAN (_src1.i))
+        var39.i = _src1.i;
+      else if (ORC_ISNAN (_src2.i))
+        var39.i = _src2.i;
+      else
+        var39.f = (_src1.f > _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 6: minf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      _src1.i = ORC_DENORMAL (var39.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      if (ORC_ISNAN (_src1.i))
+        var37.i = _src1.i;
+      else if (ORC_ISNAN (_src2.i))
+        var37.i = _src2.i;
+      else
+        var37.f = (_src1.f < _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audioamplify_orc_clip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 25, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 99, 108, 105, 112, 95, 102, 51, 50, 11, 4, 4, 14,
+        4, 0, 0, 128, 191, 14, 4, 0, 0, 128, 63, 17, 4, 20, 4, 202,
+        32, 0, 24, 205, 32, 32, 16, 206, 0, 32, 17, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_clip_f32");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_f32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_constant (p, 4, 0xbf800000, "c1");
+      orc_program_add_constant (p, 4, 0x3f800000, "c2");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxf", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minf", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_noclip_f64 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_noclip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union64 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union64 var34;
+  orc_union64 var35;
+  orc_union64 var36;
+
+  ptr0 = (orc_union64 *) d1;
+
+  /* 0: loadpl */
+  var33.f = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 1: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      var36.f = _src1.f;
+    }
+    /* 2: loadq */
+    var34 = ptr0[i];
+    /* 3: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var34.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var35.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 4: storeq */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_noclip_f64 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union64 *ORC_RESTRICT ptr0;
+  orc_union32 var33;
+  orc_union64 var34;
+  orc_union64 var35;
+  orc_union64 var36;
+
+  ptr0 = (orc_union64 *) ex->arrays[0];
+
+  /* 0: loadpl */
+  var33.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 1: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var33.i);
+      var36.f = _src1.f;
+    }
+    /* 2: loadq */
+    var34 = ptr0[i];
+    /* 3: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var34.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var35.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 4: storeq */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+audioamplify_orc_noclip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 27, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 110, 111, 99, 108, 105, 112, 95, 102, 54, 52, 11, 8,
+        8, 17, 4, 20, 8, 224, 32, 24, 214, 0, 0, 32, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_f64);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_noclip_f64");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_noclip_f64);
+      orc_program_add_destination (p, 8, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 8, "t1");
+
+      orc_program_append_2 (p, "convfd", 0, ORC_VAR_T1, ORC_VAR_P1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "muld", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioamplify_orc_clip_f64 */
+#ifdef DISABLE_ORC
+void
+audioamplify_orc_clip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n)
+{
+  int i;
+  orc_union64 *ORC_RESTRICT ptr0;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union64 var39;
+  orc_union64 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union64 var43;
+  orc_union64 var44;
+  orc_union64 var45;
+
+  ptr0 = (orc_union64 *) d1;
+
+  /* 0: loadpl */
+  var36.f = p1;
+  /* 2: loadpl */
+  var37.i = (int) 0xbf800000; /* 3212836864 or 1.58735e-314f */
+  /* 4: loadpl */
+  var38.i = (int) 0x3f800000; /* 1065353216 or 5.26354e-315f */
+
+  for (i = 0; i < n; i++) {
+    /* 1: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var36.i);
+      var41.f = _src1.f;
+    }
+    /* 3: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      var42.f = _src1.f;
+    }
+    /* 5: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      var43.f = _src1.f;
+    }
+    /* 6: loadq */
+    var39 = ptr0[i];
+    /* 7: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var39.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var41.i);
+      _dest1.f = _src1.f * _src2.f;
+      var44.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 8: maxd */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      _src1.i = ORC_DENORMAL_DOUBLE (var44.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var42.i);
+      if (ORC_ISNAN_DOUBLE (_src1.i))
+        var45.i = _src1.i;
+      else if (ORC_ISNAN_DOUBLE (_src2.i))
+        var45.i = _src2.i;
+      else
+        var45.f = (_src1.f > _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 9: mind */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      _src1.i = ORC_DENORMAL_DOUBLE (var45.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var43.i);
+      if (ORC_ISNAN_DOUBLE (_src1.i))
+        var40.i = _src1.i;
+      else if (ORC_ISNAN_DOUBLE (_src2.i))
+        var40.i = _src2.i;
+      else
+        var40.f = (_src1.f < _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 10: storeq */
+    ptr0[i] = var40;
+  }
+
+}
+
+#else
+static void
+_backup_audioamplify_orc_clip_f64 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union64 *ORC_RESTRICT ptr0;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union64 var39;
+  orc_union64 var40;
+  orc_union64 var41;
+  orc_union64 var42;
+  orc_union64 var43;
+  orc_union64 var44;
+  orc_union64 var45;
+
+  ptr0 = (orc_union64 *) ex->arrays[0];
+
+  /* 0: loadpl */
+  var36.i = ex->params[24];
+  /* 2: loadpl */
+  var37.i = (int) 0xbf800000; /* 3212836864 or 1.58735e-314f */
+  /* 4: loadpl */
+  var38.i = (int) 0x3f800000; /* 1065353216 or 5.26354e-315f */
+
+  for (i = 0; i < n; i++) {
+    /* 1: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var36.i);
+      var41.f = _src1.f;
+    }
+    /* 3: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var37.i);
+      var42.f = _src1.f;
+    }
+    /* 5: convfd */
+    {
+      orc_union32 _src1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      var43.f = _src1.f;
+    }
+    /* 6: loadq */
+    var39 = ptr0[i];
+    /* 7: muld */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      orc_union64 _dest1;
+      _src1.i = ORC_DENORMAL_DOUBLE (var39.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var41.i);
+      _dest1.f = _src1.f * _src2.f;
+      var44.i = ORC_DENORMAL_DOUBLE (_dest1.i);
+    }
+    /* 8: maxd */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      _src1.i = ORC_DENORMAL_DOUBLE (var44.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var42.i);
+      if (ORC_ISNAN_DOUBLE (_src1.i))
+        var45.i = _src1.i;
+      else if (ORC_ISNAN_DOUBLE (_src2.i))
+        var45.i = _src2.i;
+      else
+        var45.f = (_src1.f > _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 9: mind */
+    {
+      orc_union64 _src1;
+      orc_union64 _src2;
+      _src1.i = ORC_DENORMAL_DOUBLE (var45.i);
+      _src2.i = ORC_DENORMAL_DOUBLE (var43.i);
+      if (ORC_ISNAN_DOUBLE (_src1.i))
+        var40.i = _src1.i;
+      else if (ORC_ISNAN_DOUBLE (_src2.i))
+        var40.i = _src2.i;
+      else
+        var40.f = (_src1.f < _src2.f) ? _src1.f : _src2.f;
+    }
+    /* 10: storeq */
+    ptr0[i] = var40;
+  }
+
+}
+
+void
+audioamplify_orc_clip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 25, 97, 117, 100, 105, 111, 97, 109, 112, 108, 105, 102, 121, 95,
+        111, 114, 99, 95, 99, 108, 105, 112, 95, 102, 54, 52, 11, 8, 8, 14,
+        4, 0, 0, 128, 191, 14, 4, 0, 0, 128, 63, 17, 4, 20, 8, 20,
+        8, 20, 8, 20, 8, 224, 32, 24, 224, 33, 16, 224, 34, 17, 214, 35,
+        0, 32, 217, 35, 35, 33, 218, 0, 35, 34, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_f64);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioamplify_orc_clip_f64");
+      orc_program_set_backup_function (p,
+          _backup_audioamplify_orc_clip_f64);
+      orc_program_add_destination (p, 8, "d1");
+      orc_program_add_constant (p, 4, 0xbf800000, "c1");
+      orc_program_add_constant (p, 4, 0x3f800000, "c2");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_temporary (p, 8, "t1");
+      orc_program_add_temporary (p, 8, "t2");
+      orc_program_add_temporary (p, 8, "t3");
+      orc_program_add_temporary (p, 8, "t4");
+
+      orc_program_append_2 (p, "convfd", 0, ORC_VAR_T1, ORC_VAR_P1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfd", 0, ORC_VAR_T2, ORC_VAR_C1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfd", 0, ORC_VAR_T3, ORC_VAR_C2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "muld", 0, ORC_VAR_T4, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxd", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mind", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_T3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioinvert_orc_s16 */
+#ifdef DISABLE_ORC
+void
+audioinvert_orc_s16 (gint16 * ORC_RESTRICT d1, float p1, float p2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+
+  ptr0 = (orc_union16 *) d1;
+
+  /* 1: loadpw */
+  var36.i = (int) 0x0000ffff; /* 65535 or 3.23786e-319f */
+  /* 5: loadpl */
+  var37.f = p1;
+  /* 9: loadpl */
+  var38.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var35 = ptr0[i];
+    /* 2: xorw */
+    var40.i = var35.i ^ var36.i;
+    /* 3: convswl */
+    var41.i = var35.i;
+    /* 4: convlf */
+    var42.f = var41.i;
+    /* 6: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var42.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var43.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 7: convswl */
+    var44.i = var40.i;
+    /* 8: convlf */
+    var45.f = var44.i;
+    /* 10: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var45.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var46.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 11: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var43.i);
+      _src2.i = ORC_DENORMAL (var46.i);
+      _dest1.f = _src1.f + _src2.f;
+      var47.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 12: convfl */
+    {
+      int tmp;
+      tmp = (int) var47.f;
+      if (tmp == 0x80000000 && !(var47.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var48.i = tmp;
+    }
+    /* 13: convssslw */
+    var39.i = ORC_CLAMP_SW (var48.i);
+    /* 14: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_audioinvert_orc_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+
+  /* 1: loadpw */
+  var36.i = (int) 0x0000ffff; /* 65535 or 3.23786e-319f */
+  /* 5: loadpl */
+  var37.i = ex->params[24];
+  /* 9: loadpl */
+  var38.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var35 = ptr0[i];
+    /* 2: xorw */
+    var40.i = var35.i ^ var36.i;
+    /* 3: convswl */
+    var41.i = var35.i;
+    /* 4: convlf */
+    var42.f = var41.i;
+    /* 6: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var42.i);
+      _src2.i = ORC_DENORMAL (var37.i);
+      _dest1.f = _src1.f * _src2.f;
+      var43.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 7: convswl */
+    var44.i = var40.i;
+    /* 8: convlf */
+    var45.f = var44.i;
+    /* 10: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var45.i);
+      _src2.i = ORC_DENORMAL (var38.i);
+      _dest1.f = _src1.f * _src2.f;
+      var46.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 11: addf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var43.i);
+      _src2.i = ORC_DENORMAL (var46.i);
+      _dest1.f = _src1.f + _src2.f;
+      var47.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 12: convfl */
+    {
+      int tmp;
+      tmp = (int) var47.f;
+      if (tmp == 0x80000000 && !(var47.i & 0x80000000))
+        tmp = 0x7fffffff;
+      var48.i = tmp;
+    }
+    /* 13: convssslw */
+    var39.i = ORC_CLAMP_SW (var48.i);
+    /* 14: storew */
+    ptr0[i] = var39;
+  }
+
+}
+
+void
+audioinvert_orc_s16 (gint16 * ORC_RESTRICT d1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 19, 97, 117, 100, 105, 111, 105, 110, 118, 101, 114, 116, 95, 111,
+        114, 99, 95, 115, 49, 54, 11, 2, 2, 14, 2, 255, 255, 0, 0, 17,
+        4, 17, 4, 20, 2, 20, 4, 20, 4, 101, 32, 0, 16, 153, 33, 0,
+        211, 33, 33, 202, 33, 33, 24, 153, 34, 32, 211, 34, 34, 202, 34, 34,
+        25, 200, 33, 33, 34, 210, 33, 33, 165, 0, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioinvert_orc_s16);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioinvert_orc_s16");
+      orc_program_set_backup_function (p,
+          _backup_audioinvert_orc_s16);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_constant (p, 2, 0x0000ffff, "c1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+
+      orc_program_append_2 (p, "xorw", 0, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convswl", 0, ORC_VAR_T3, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addf", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convfl", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* audioinvert_orc_f32 */
+#ifdef DISABLE_ORC
+void
+audioinvert_orc_f32 (gfloat * ORC_RESTRICT d1, float p1, float p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) d1;
+
+  /* 1: loadpl */
+  var35.f = p1;
+  /* 3: loadpl */
+  var36.f = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var34.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var34.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var39.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: subf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var39.i);
+      _dest1.f = _src1.f - _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_audioinvert_orc_f32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+
+  /* 1: loadpl */
+  var35.i = ex->params[24];
+  /* 3: loadpl */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr0[i];
+    /* 2: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var34.i);
+      _src2.i = ORC_DENORMAL (var35.i);
+      _dest1.f = _src1.f * _src2.f;
+      var38.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 4: mulf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var34.i);
+      _src2.i = ORC_DENORMAL (var36.i);
+      _dest1.f = _src1.f * _src2.f;
+      var39.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 5: subf */
+    {
+      orc_union32 _src1;
+      orc_union32 _src2;
+      orc_union32 _dest1;
+      _src1.i = ORC_DENORMAL (var38.i);
+      _src2.i = ORC_DENORMAL (var39.i);
+      _dest1.f = _src1.f - _src2.f;
+      var37.i = ORC_DENORMAL (_dest1.i);
+    }
+    /* 6: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+audioinvert_orc_f32 (gfloat * ORC_RESTRICT d1, float p1, float p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 19, 97, 117, 100, 105, 111, 105, 110, 118, 101, 114, 116, 95, 111,
+        114, 99, 95, 102, 51, 50, 11, 4, 4, 17, 4, 17, 4, 20, 4, 20,
+        4, 202, 32, 0, 24, 202, 33, 0, 25, 201, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p,
+          _backup_audioinvert_orc_f32);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "audioinvert_orc_f32");
+      orc_program_set_backup_function (p,
+          _backup_audioinvert_orc_f32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_parameter_float (p, 4, "p1");
+      orc_program_add_parameter_float (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulf", 0, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subf", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  {
+    orc_union32 tmp;
+    tmp.f = p1;
+    ex->params[ORC_VAR_P1] = tmp.i;
+  }
+  {
+    orc_union32 tmp;
+    tmp.f = p2;
+    ex->params[ORC_VAR_P2] = tmp.i;
+  }
+
+  func = c->exec;
+  func (ex);
+}
+#endif
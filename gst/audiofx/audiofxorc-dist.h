@@ -1,8 +1,8 @@
 
-/* autogenerated from audiopanoramaorc.orc */
+/* autogenerated from audiofxorc.orc */
 
-#ifndef _AUDIOPANORAMAORC_H_
-#define _AUDIOPANORAMAORC_H_
+#ifndef _AUDIOFXORC_H_
+#define _AUDIOFXORC_H_
 
 #include <glib.h>
 
@@ -98,6 +98,17 @@ void audiopanoramam_orc_process_f32_ch1_sim_right (gfloat * ORC_RESTRICT d1, con
 void audiopanoramam_orc_process_f32_ch1_sim_left (gfloat * ORC_RESTRICT d1, const gfloat * ORC_RESTRICT s1, float p1, int n);
 void audiopanoramam_orc_process_f32_ch2_sim_right (gfloat * ORC_RESTRICT d1, const gfloat * ORC_RESTRICT s1, float p1, int n);
 void audiopanoramam_orc_process_f32_ch2_sim_left (gfloat * ORC_RESTRICT d1, const gfloat * ORC_RESTRICT s1, float p1, int n);
+void audioamplify_orc_noclip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s8 (gint8 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s16 (gint16 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_s32 (gint32 * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_f32 (gfloat * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_noclip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n);
+void audioamplify_orc_clip_f64 (gdouble * ORC_RESTRICT d1, float p1, int n);
+void audioinvert_orc_s16 (gint16 * ORC_RESTRICT d1, float p1, float p2, int n);
+void audioinvert_orc_f32 (gfloat * ORC_RESTRICT d1, float p1, float p2, int n);
 
 #ifdef __cplusplus
 }
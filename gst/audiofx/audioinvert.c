@@ -46,6 +46,7 @@
 #include <gst/audio/gstaudiofilter.h>
 
 #include "audioinvert.h"
+#include "audiofxorc.h"
 
 #define GST_CAT_DEFAULT gst_audio_invert_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -199,28 +200,18 @@ static void
 gst_audio_invert_transform_int (GstAudioInvert * filter,
     gint16 * data, guint num_samples)
 {
-  gint i;
   gfloat dry = 1.0 - filter->degree;
-  glong val;
 
-  for (i = 0; i < num_samples; i++) {
-    val = (*data) * dry + (-1 - (*data)) * filter->degree;
-    *data++ = (gint16) CLAMP (val, G_MININT16, G_MAXINT16);
-  }
+  audioinvert_orc_s16 (data, dry, filter->degree, num_samples);
 }
 
 static void
 gst_audio_invert_transform_float (GstAudioInvert * filter,
     gfloat * data, guint num_samples)
 {
-  gint i;
   gfloat dry = 1.0 - filter->degree;
-  glong val;
 
-  for (i = 0; i < num_samples; i++) {
-    val = (*data) * dry - (*data) * filter->degree;
-    *data++ = val;
-  }
+  audioinvert_orc_f32 (data, dry, filter->degree, num_samples);
 }
 
 /* GstBaseTransform vmethod implementations */
@@ -52,7 +52,7 @@
 #endif
 
 #include "audiopanorama.h"
-#include "audiopanoramaorc.h"
+#include "audiofxorc.h"
 
 #define GST_CAT_DEFAULT gst_audio_panorama_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
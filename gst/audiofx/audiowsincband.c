@@ -216,9 +216,74 @@ gst_audio_wsincband_init (GstAudioWSincBand * self)
   self->mode = MODE_BAND_PASS;
   self->window = WINDOW_HAMMING;
 
+  self->window_buf = NULL;
+  self->kernel_rate = 0;
+
   g_mutex_init (&self->lock);
 }
 
+/* re-seed the sine recurrence after this many taps to keep the
+ * rounding errors small */
+#define SINC_RESEED 64
+
+/* fill @window with @len taps of the window of @type. All windows are
+ * symmetric so only the first half is calculated */
+static void
+gst_audio_wsincband_fill_window (gdouble * window, gint len, gint type)
+{
+  gint i;
+
+  for (i = 0; i <= (len - 1) / 2; ++i) {
+    switch (type) {
+      case WINDOW_HAMMING:
+        window[i] = 0.54 - 0.46 * cos (2 * G_PI * i / (len - 1));
+        break;
+      case WINDOW_BLACKMAN:
+        window[i] = 0.42 - 0.5 * cos (2 * G_PI * i / (len - 1)) +
+            0.08 * cos (4 * G_PI * i / (len - 1));
+        break;
+      case WINDOW_GAUSSIAN:
+        window[i] = exp (-0.5 * POW2 (3.0 / len * (2 * i - (len - 1))));
+        break;
+      case WINDOW_COSINE:
+        window[i] = cos (G_PI * i / (len - 1) - G_PI / 2);
+        break;
+      case WINDOW_HANN:
+        window[i] = 0.5 * (1 - cos (2 * G_PI * i / (len - 1)));
+        break;
+      default:
+        window[i] = 1.0;
+        break;
+    }
+    window[len - 1 - i] = window[i];
+  }
+}
+
+/* fill @kernel with the windowed sinc of the odd length @len for the
+ * normalized angular frequency @w. The kernel is symmetric around its
+ * center and the sines of the taps are calculated with the recurrence
+ * sin ((k + 1) w) = 2 cos (w) sin (k w) - sin ((k - 1) w) */
+static void
+gst_audio_wsincband_fill_sinc (gdouble * kernel, const gdouble * window,
+    gint len, gdouble w)
+{
+  gint k, c = (len - 1) / 2;
+  gdouble sk = sin (w), skm1 = 0.0, c2 = 2.0 * cos (w), tmp;
+
+  kernel[c] = w * window[c];
+  for (k = 1; k <= c; ++k) {
+    if (k % SINC_RESEED == 0) {
+      sk = sin (w * k);
+      skm1 = sin (w * (k - 1));
+    }
+    kernel[c + k] = kernel[c - k] = sk / k * window[c + k];
+
+    tmp = c2 * sk - skm1;
+    skm1 = sk;
+    sk = tmp;
+  }
+}
+
 static void
 gst_audio_wsincband_build_kernel (GstAudioWSincBand * self,
     const GstAudioInfo * info)
@@ -227,7 +292,6 @@ gst_audio_wsincband_build_kernel (GstAudioWSincBand * self,
   gdouble sum = 0.0;
   gint len = 0;
   gdouble *kernel_lp, *kernel_hp;
-  gdouble w;
   gdouble *kernel;
   gint rate, channels;
 
@@ -262,41 +326,37 @@ gst_audio_wsincband_build_kernel (GstAudioWSincBand * self,
     self->upper_frequency = tmp;
   }
 
+  /* nothing to do if the kernel would be the same, e.g. when controlled
+   * properties are synced to unchanged values */
+  if (self->kernel_rate == rate
+      && self->kernel_lower_frequency == self->lower_frequency
+      && self->kernel_upper_frequency == self->upper_frequency
+      && self->kernel_mode == self->mode && self->window_buf
+      && self->window_length == len && self->window_type == self->window) {
+    GST_LOG ("kernel unchanged");
+    return;
+  }
+
   GST_DEBUG ("gst_audio_wsincband: initializing filter kernel of length %d "
       "with lower frequency %.2lf Hz "
       ", upper frequency %.2lf Hz for mode %s",
       len, self->lower_frequency, self->upper_frequency,
       (self->mode == MODE_BAND_PASS) ? "band-pass" : "band-reject");
 
+  /* the window only depends on the length and the type */
+  if (!self->window_buf || self->window_length != len
+      || self->window_type != self->window) {
+    g_free (self->window_buf);
+    self->window_buf = g_new (gdouble, len);
+    self->window_length = len;
+    self->window_type = self->window;
+    gst_audio_wsincband_fill_window (self->window_buf, len, self->window);
+  }
+
   /* fill the lp kernel */
-  w = 2 * G_PI * (self->lower_frequency / rate);
   kernel_lp = g_new (gdouble, len);
-  for (i = 0; i < len; ++i) {
-    if (i == (len - 1) / 2.0)
-      kernel_lp[i] = w;
-    else
-      kernel_lp[i] = sin (w * (i - (len - 1) / 2.0)) / (i - (len - 1) / 2.0);
-
-    /* windowing */
-    switch (self->window) {
-      case WINDOW_HAMMING:
-        kernel_lp[i] *= (0.54 - 0.46 * cos (2 * G_PI * i / (len - 1)));
-        break;
-      case WINDOW_BLACKMAN:
-        kernel_lp[i] *= (0.42 - 0.5 * cos (2 * G_PI * i / (len - 1)) +
-            0.08 * cos (4 * G_PI * i / (len - 1)));
-        break;
-      case WINDOW_GAUSSIAN:
-        kernel_lp[i] *= exp (-0.5 * POW2 (3.0 / len * (2 * i - (len - 1))));
-        break;
-      case WINDOW_COSINE:
-        kernel_lp[i] *= cos (G_PI * i / (len - 1) - G_PI / 2);
-        break;
-      case WINDOW_HANN:
-        kernel_lp[i] *= 0.5 * (1 - cos (2 * G_PI * i / (len - 1)));
-        break;
-    }
-  }
+  gst_audio_wsincband_fill_sinc (kernel_lp, self->window_buf, len,
+      2 * G_PI * (self->lower_frequency / rate));
 
   /* normalize for unity gain at DC */
   sum = 0.0;
@@ -306,34 +366,9 @@ gst_audio_wsincband_build_kernel (GstAudioWSincBand * self,
     kernel_lp[i] /= sum;
 
   /* fill the hp kernel */
-  w = 2 * G_PI * (self->upper_frequency / rate);
   kernel_hp = g_new (gdouble, len);
-  for (i = 0; i < len; ++i) {
-    if (i == (len - 1) / 2.0)
-      kernel_hp[i] = w;
-    else
-      kernel_hp[i] = sin (w * (i - (len - 1) / 2.0)) / (i - (len - 1) / 2.0);
-
-    /* Windowing */
-    switch (self->window) {
-      case WINDOW_HAMMING:
-        kernel_hp[i] *= (0.54 - 0.46 * cos (2 * G_PI * i / (len - 1)));
-        break;
-      case WINDOW_BLACKMAN:
-        kernel_hp[i] *= (0.42 - 0.5 * cos (2 * G_PI * i / (len - 1)) +
-            0.08 * cos (4 * G_PI * i / (len - 1)));
-        break;
-      case WINDOW_GAUSSIAN:
-        kernel_hp[i] *= exp (-0.5 * POW2 (3.0 / len * (2 * i - (len - 1))));
-        break;
-      case WINDOW_COSINE:
-        kernel_hp[i] *= cos (G_PI * i / (len - 1) - G_PI / 2);
-        break;
-      case WINDOW_HANN:
-        kernel_hp[i] *= 0.5 * (1 - cos (2 * G_PI * i / (len - 1)));
-        break;
-    }
-  }
+  gst_audio_wsincband_fill_sinc (kernel_hp, self->window_buf, len,
+      2 * G_PI * (self->upper_frequency / rate));
 
   /* normalize for unity gain at DC */
   sum = 0.0;
@@ -370,6 +405,11 @@ gst_audio_wsincband_build_kernel (GstAudioWSincBand * self,
     kernel[len / 2] += 1;
   }
 
+  self->kernel_rate = rate;
+  self->kernel_lower_frequency = self->lower_frequency;
+  self->kernel_upper_frequency = self->upper_frequency;
+  self->kernel_mode = self->mode;
+
   gst_audio_fx_base_fir_filter_set_kernel (GST_AUDIO_FX_BASE_FIR_FILTER (self),
       kernel, self->kernel_length, (len - 1) / 2, info);
 }
@@ -392,6 +432,9 @@ gst_audio_wsincband_finalize (GObject * object)
 {
   GstAudioWSincBand *self = GST_AUDIO_WSINC_BAND (object);
 
+  g_free (self->window_buf);
+  self->window_buf = NULL;
+
   g_mutex_clear (&self->lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
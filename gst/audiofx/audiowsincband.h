@@ -67,6 +67,16 @@ struct _GstAudioWSincBand {
 
   /* < private > */
   GMutex lock;
+
+  /* window of the current kernel length and type */
+  gdouble *window_buf;
+  gint window_length;
+  gint window_type;
+
+  /* parameters of the current kernel, kernel_rate is 0 if there is none */
+  gint kernel_rate;
+  gint kernel_mode;
+  gfloat kernel_lower_frequency, kernel_upper_frequency;
 };
 
 struct _GstAudioWSincBandClass {
@@ -113,13 +113,17 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 G_DEFINE_TYPE_WITH_CODE (GstScaletempo, gst_scaletempo,
     GST_TYPE_BASE_TRANSFORM, DEBUG_INIT (0));
 
+/* use the FFT cross correlation if the direct one needs this many times
+ * more operations */
+#define FFT_SEARCH_COST 8
+
 static guint
 best_overlap_offset_float (GstScaletempo * st)
 {
   gfloat *pw, *po, *ppc, *search_start;
   gfloat best_corr = G_MININT;
   guint best_off = 0;
-  gint i, off;
+  gint i, n, off;
 
   pw = st->table_window;
   po = st->buf_overlap;
@@ -129,14 +133,24 @@ best_overlap_offset_float (GstScaletempo * st)
     *ppc++ = *pw++ * *po++;
   }
 
+  n = st->samples_overlap - st->samples_per_frame;
   search_start = (gfloat *) st->buf_queue + st->samples_per_frame;
   for (off = 0; off < st->frames_search; off++) {
-    gfloat corr = 0;
+    gfloat c0 = 0, c1 = 0, c2 = 0, c3 = 0, corr;
     gfloat *ps = search_start;
     ppc = st->buf_pre_corr;
-    for (i = st->samples_per_frame; i < st->samples_overlap; i++) {
-      corr += *ppc++ * *ps++;
+    /* four independent partial sums, so each addition doesn't have to
+     * wait for the previous one to finish */
+    for (i = 0; i + 4 <= n; i += 4) {
+      c0 += ppc[i + 0] * ps[i + 0];
+      c1 += ppc[i + 1] * ps[i + 1];
+      c2 += ppc[i + 2] * ps[i + 2];
+      c3 += ppc[i + 3] * ps[i + 3];
+    }
+    for (; i < n; i++) {
+      c0 += ppc[i] * ps[i];
     }
+    corr = (c0 + c1) + (c2 + c3);
     if (corr > best_corr) {
       best_corr = corr;
       best_off = off;
@@ -192,6 +206,88 @@ best_overlap_offset_s16 (GstScaletempo * st)
   return best_off * st->bytes_per_frame;
 }
 
+/* Find the offset with the best correlation of the pre-correlated overlap,
+ * whose spectrum is in fft_pre_corr, and the search range of the queue in
+ * fft_buf. The correlations of all offsets are the inverse FFT of the
+ * product of the conjugated overlap spectrum and the search spectrum */
+static guint
+best_overlap_offset_fft (GstScaletempo * st)
+{
+  GstFFTF32Complex *pc = st->fft_pre_corr, *ps = st->fft_search;
+  gfloat best_corr = G_MININT, re;
+  guint best_off = 0;
+  guint i, off;
+
+  gst_fft_f32_fft (st->fft, st->fft_buf, ps);
+  for (i = 0; i < st->fft_length / 2 + 1; i++) {
+    re = pc[i].r * ps[i].r + pc[i].i * ps[i].i;
+    ps[i].i = pc[i].r * ps[i].i - pc[i].i * ps[i].r;
+    ps[i].r = re;
+  }
+  gst_fft_f32_inverse_fft (st->ifft, ps, st->fft_buf);
+
+  for (off = 0; off < st->frames_search; off++) {
+    gfloat corr = st->fft_buf[off * st->samples_per_frame];
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_off = off;
+    }
+  }
+
+  return best_off * st->bytes_per_frame;
+}
+
+static guint
+best_overlap_offset_float_fft (GstScaletempo * st)
+{
+  gfloat *pw, *po, *ps;
+  guint n = st->samples_overlap - st->samples_per_frame;
+  guint len = (st->frames_search - 1) * st->samples_per_frame + n;
+  guint i;
+
+  pw = st->table_window;
+  po = st->buf_overlap;
+  po += st->samples_per_frame;
+  for (i = 0; i < n; i++) {
+    st->fft_buf[i] = pw[i] * po[i];
+  }
+  memset (st->fft_buf + n, 0, (st->fft_length - n) * sizeof (gfloat));
+  gst_fft_f32_fft (st->fft, st->fft_buf, st->fft_pre_corr);
+
+  ps = (gfloat *) st->buf_queue + st->samples_per_frame;
+  memcpy (st->fft_buf, ps, len * sizeof (gfloat));
+  memset (st->fft_buf + len, 0, (st->fft_length - len) * sizeof (gfloat));
+
+  return best_overlap_offset_fft (st);
+}
+
+static guint
+best_overlap_offset_s16_fft (GstScaletempo * st)
+{
+  gint32 *pw;
+  gint16 *po, *ps;
+  guint n = st->samples_overlap - st->samples_per_frame;
+  guint len = (st->frames_search - 1) * st->samples_per_frame + n;
+  guint i;
+
+  pw = st->table_window;
+  po = st->buf_overlap;
+  po += st->samples_per_frame;
+  for (i = 0; i < n; i++) {
+    st->fft_buf[i] = (pw[i] * po[i]) >> 15;
+  }
+  memset (st->fft_buf + n, 0, (st->fft_length - n) * sizeof (gfloat));
+  gst_fft_f32_fft (st->fft, st->fft_buf, st->fft_pre_corr);
+
+  ps = (gint16 *) st->buf_queue + st->samples_per_frame;
+  for (i = 0; i < len; i++) {
+    st->fft_buf[i] = ps[i];
+  }
+  memset (st->fft_buf + len, 0, (st->fft_length - len) * sizeof (gfloat));
+
+  return best_overlap_offset_fft (st);
+}
+
 static void
 output_overlap_float (GstScaletempo * st, gpointer buf_out, guint bytes_off)
 {
@@ -346,6 +442,35 @@ reinit_buffers (GstScaletempo * st)
       }
       st->best_overlap_offset = best_overlap_offset_float;
     }
+
+    /* for long searches, correlate all offsets at once in the frequency
+     * domain */
+    {
+      guint n = st->samples_overlap - st->samples_per_frame;
+      guint len = (st->frames_search - 1) * st->samples_per_frame + n;
+      guint fft_length = 2 * gst_fft_next_fast_length ((len + 1) / 2);
+
+      if ((guint64) st->frames_search * n >
+          (guint64) FFT_SEARCH_COST * fft_length * g_bit_storage (fft_length)) {
+        if (st->fft_length != fft_length) {
+          if (st->fft) {
+            gst_fft_f32_free (st->fft);
+            gst_fft_f32_free (st->ifft);
+          }
+          st->fft = gst_fft_f32_new (fft_length, FALSE);
+          st->ifft = gst_fft_f32_new (fft_length, TRUE);
+          st->fft_length = fft_length;
+          st->fft_buf = g_renew (gfloat, st->fft_buf, fft_length);
+          st->fft_pre_corr = g_renew (GstFFTF32Complex, st->fft_pre_corr,
+              fft_length / 2 + 1);
+          st->fft_search = g_renew (GstFFTF32Complex, st->fft_search,
+              fft_length / 2 + 1);
+        }
+        st->best_overlap_offset = st->use_int ?
+            best_overlap_offset_s16_fft : best_overlap_offset_float_fft;
+        GST_DEBUG ("search with FFTs of length %u", fft_length);
+      }
+    }
   }
 
   new_size =
@@ -619,6 +744,28 @@ gst_scaletempo_query (GstBaseTransform * trans, GstPadDirection direction,
 }
 
 /* GObject vmethod implementations */
+static void
+gst_scaletempo_finalize (GObject * object)
+{
+  GstScaletempo *scaletempo = GST_SCALETEMPO (object);
+
+  g_free (scaletempo->buf_queue);
+  g_free (scaletempo->buf_overlap);
+  g_free (scaletempo->table_blend);
+  g_free (scaletempo->buf_pre_corr);
+  g_free (scaletempo->table_window);
+
+  if (scaletempo->fft) {
+    gst_fft_f32_free (scaletempo->fft);
+    gst_fft_f32_free (scaletempo->ifft);
+  }
+  g_free (scaletempo->fft_buf);
+  g_free (scaletempo->fft_pre_corr);
+  g_free (scaletempo->fft_search);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_scaletempo_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
@@ -688,6 +835,7 @@ gst_scaletempo_class_init (GstScaletempoClass * klass)
   GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
   GstBaseTransformClass *basetransform_class = GST_BASE_TRANSFORM_CLASS (klass);
 
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_scaletempo_finalize);
   gobject_class->get_property = GST_DEBUG_FUNCPTR (gst_scaletempo_get_property);
   gobject_class->set_property = GST_DEBUG_FUNCPTR (gst_scaletempo_set_property);
 
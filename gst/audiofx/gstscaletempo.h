@@ -23,6 +23,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
+#include <gst/fft/gstfftf32.h>
 
 G_BEGIN_DECLS
 
@@ -79,6 +80,14 @@ struct _GstScaletempo
   gpointer table_window;
   guint (*best_overlap_offset) (GstScaletempo * scaletempo);
 
+  /* best overlap with FFT cross correlation, for long searches */
+  GstFFTF32 *fft;
+  GstFFTF32 *ifft;
+  guint fft_length;
+  gfloat *fft_buf;
+  GstFFTF32Complex *fft_pre_corr;
+  GstFFTF32Complex *fft_search;
+
   /* gstreamer */
   gint64 segment_start;
   GstClockTime latency;
@@ -1187,6 +1187,10 @@ gst_flac_parse_process_seektable (GstFlacParse * flacparse, gint64 boffset)
   if (!gst_byte_reader_skip (&br, 4))
     goto done;
 
+  /* the first frame anchors the seekpoints, which are relative to it */
+  gst_base_parse_add_index_entry (GST_BASE_PARSE (flacparse), boffset, 0,
+      TRUE, TRUE);
+
   /* seekpoints */
   while (gst_byte_reader_get_remaining (&br)) {
     if (!gst_byte_reader_get_int64_be (&br, &samples))
@@ -1199,11 +1203,14 @@ gst_flac_parse_process_seektable (GstFlacParse * flacparse, gint64 boffset)
     GST_LOG_OBJECT (flacparse, "samples %" G_GINT64_FORMAT " -> offset %"
         G_GINT64_FORMAT, samples, offset);
 
-    /* sanity check */
+    /* sanity check, this also skips placeholder points */
     if (G_LIKELY (offset > 0 && samples > 0)) {
+      /* the seekpoints are exact frame positions written by the encoder,
+       * add all of them instead of thinning them out like learnt entries
+       * so seeks can go straight to the frame */
       gst_base_parse_add_index_entry (GST_BASE_PARSE (flacparse),
           boffset + offset, gst_util_uint64_scale (samples, GST_SECOND,
-              flacparse->samplerate), TRUE, FALSE);
+              flacparse->samplerate), TRUE, TRUE);
     }
   }
 
@@ -92,6 +92,11 @@ static void gst_mpeg_audio_parse_finalize (GObject * object);
 
 static gboolean gst_mpeg_audio_parse_start (GstBaseParse * parse);
 static gboolean gst_mpeg_audio_parse_stop (GstBaseParse * parse);
+static void gst_mpeg_audio_parse_init_frame_lengths (void);
+static inline guint mp3_type_frame_length_from_header (GstMpegAudioParse *
+    mp3parse, guint32 header, guint * put_version, guint * put_layer,
+    guint * put_channels, guint * put_bitrate, guint * put_samplerate,
+    guint * put_mode, guint * put_crc);
 static GstFlowReturn gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
     GstBaseParseFrame * frame, gint * skipsize);
 static GstFlowReturn gst_mpeg_audio_parse_pre_push_frame (GstBaseParse * parse,
@@ -154,6 +159,8 @@ gst_mpeg_audio_parse_class_init (GstMpegAudioParseClass * klass)
   GST_DEBUG_CATEGORY_INIT (mpeg_audio_parse_debug, "mpegaudioparse", 0,
       "MPEG1 audio stream parser");
 
+  gst_mpeg_audio_parse_init_frame_lengths ();
+
   object_class->finalize = gst_mpeg_audio_parse_finalize;
 
   parse_class->start = GST_DEBUG_FUNCPTR (gst_mpeg_audio_parse_start);
@@ -278,6 +285,73 @@ static const guint mp3types_freqs[3][3] = { {44100, 48000, 32000},
 {11025, 12000, 8000}
 };
 
+/* Frame length without padding for the version, layer, crc, bitrate and
+ * samplerate bits of a header, so that checking and walking over frames
+ * is a lookup. MP3_FRAME_LENGTH_INVALID marks reserved values, 0 free
+ * format bitrate. */
+#define MP3_HEADER_INDEX(h)       (((h) >> 10) & 0x7ff)
+#define MP3_FRAME_LENGTH_INVALID  0xffff
+static guint16 mp3types_frame_lengths[2048];
+
+static void
+gst_mpeg_audio_parse_init_frame_lengths (void)
+{
+  guint idx;
+
+  for (idx = 0; idx < G_N_ELEMENTS (mp3types_frame_lengths); idx++) {
+    guint32 header = idx << 10;
+    guint lsf, mpg25, layer, bitrate, samplerate, length;
+
+    if (((header >> 19) & 3) == 0x1 || !((header >> 17) & 3) ||
+        ((header >> 12) & 0xf) == 0xf || ((header >> 10) & 0x3) == 0x3) {
+      mp3types_frame_lengths[idx] = MP3_FRAME_LENGTH_INVALID;
+      continue;
+    }
+
+    if (header & (1 << 20)) {
+      lsf = (header & (1 << 19)) ? 0 : 1;
+      mpg25 = 0;
+    } else {
+      lsf = 1;
+      mpg25 = 1;
+    }
+    layer = 4 - ((header >> 17) & 0x3);
+    bitrate = mp3types_bitrates[lsf][layer - 1][(header >> 12) & 0xf] * 1000;
+    samplerate = mp3types_freqs[lsf + mpg25][(header >> 10) & 0x3];
+
+    switch (layer) {
+      case 1:
+        length = 4 * ((bitrate * 12) / samplerate);
+        break;
+      case 2:
+        length = (bitrate * 144) / samplerate;
+        break;
+      default:
+        length = (bitrate * 144) / (samplerate << lsf);
+        break;
+    }
+    mp3types_frame_lengths[idx] = length;
+  }
+}
+
+/* the frame length for a header that passed the header check */
+static inline guint
+mp3_type_frame_length (GstMpegAudioParse * mp3parse, guint32 header)
+{
+  guint length = mp3types_frame_lengths[MP3_HEADER_INDEX (header)];
+
+  /* free format depends on the rate found in the stream */
+  if (G_UNLIKELY (length == 0))
+    return mp3_type_frame_length_from_header (mp3parse, header,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+  /* layer I pads with a 4 byte slot */
+  if ((header >> 9) & 0x1)
+    length += (((header >> 17) & 0x3) == 0x3) ? 4 : 1;
+
+  return length;
+}
+
 static inline guint
 mp3_type_frame_length_from_header (GstMpegAudioParse * mp3parse, guint32 header,
     guint * put_version, guint * put_layer, guint * put_channels,
@@ -427,8 +501,7 @@ gst_mp3parse_validate_extended (GstMpegAudioParse * mp3parse, GstBuffer * buf,
       goto cleanup;
     }
 
-    bpf = mp3_type_frame_length_from_header (mp3parse, next_header,
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    bpf = mp3_type_frame_length (mp3parse, next_header);
 
     /* if no bitrate, and no freeform rate known, then fail */
     if (G_UNLIKELY (!bpf)) {
@@ -452,6 +525,12 @@ static gboolean
 gst_mpeg_audio_parse_head_check (GstMpegAudioParse * mp3parse,
     unsigned long head)
 {
+  /* fast path for the common case of a valid header */
+  if (G_LIKELY ((head & 0xffe00000) == 0xffe00000 &&
+          mp3types_frame_lengths[MP3_HEADER_INDEX (head)] !=
+          MP3_FRAME_LENGTH_INVALID && (head & 0x3) != 0x2))
+    return TRUE;
+
   GST_DEBUG_OBJECT (mp3parse, "checking mp3 header 0x%08lx", head);
   /* if it's not a valid sync */
   if ((head & 0xffe00000) != 0xffe00000) {
@@ -83,10 +83,21 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
         GST_AU_PARSE_MULAW_PAD_TEMPLATE_CAPS ";"
         GST_AU_PARSE_ADPCM_PAD_TEMPLATE_CAPS));
 
+#define AU_HEADER_SIZE 24
+
+/* in pull mode the data is read in large blocks and pushed in sub-buffers
+ * of the blocks, both are rounded down to whole samples */
+#define AU_PULL_BLOCK_SIZE (1024 * 1024)
+#define AU_PULL_BUFFER_SIZE (16 * 1024)
 
 static void gst_au_parse_dispose (GObject * object);
 static GstFlowReturn gst_au_parse_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static void gst_au_parse_loop (GstPad * pad);
+static gboolean gst_au_parse_sink_activate (GstPad * sinkpad,
+    GstObject * parent);
+static gboolean gst_au_parse_sink_activate_mode (GstPad * sinkpad,
+    GstObject * parent, GstPadMode mode, gboolean active);
 static GstStateChangeReturn gst_au_parse_change_state (GstElement * element,
     GstStateChange transition);
 static void gst_au_parse_reset (GstAuParse * auparse);
@@ -133,6 +144,10 @@ static void
 gst_au_parse_init (GstAuParse * auparse)
 {
   auparse->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_activate_function (auparse->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_au_parse_sink_activate));
+  gst_pad_set_activatemode_function (auparse->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_au_parse_sink_activate_mode));
   gst_pad_set_chain_function (auparse->sinkpad,
       GST_DEBUG_FUNCPTR (gst_au_parse_chain));
   gst_pad_set_event_function (auparse->sinkpad,
@@ -148,6 +163,7 @@ gst_au_parse_init (GstAuParse * auparse)
   gst_element_add_pad (GST_ELEMENT (auparse), auparse->srcpad);
 
   auparse->adapter = gst_adapter_new ();
+  auparse->streaming = TRUE;
   gst_au_parse_reset (auparse);
 }
 
@@ -160,6 +176,10 @@ gst_au_parse_dispose (GObject * object)
     g_object_unref (au->adapter);
     au->adapter = NULL;
   }
+  if (au->start_segment != NULL) {
+    gst_event_unref (au->start_segment);
+    au->start_segment = NULL;
+  }
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -168,6 +188,7 @@ gst_au_parse_reset (GstAuParse * auparse)
 {
   auparse->offset = 0;
   auparse->buffer_offset = 0;
+  auparse->sample_size = 0;
   auparse->encoding = 0;
   auparse->samplerate = 0;
   auparse->channels = 0;
@@ -176,7 +197,14 @@ gst_au_parse_reset (GstAuParse * auparse)
 
   gst_caps_replace (&auparse->src_caps, NULL);
 
-  /* gst_segment_init (&auparse->segment, GST_FORMAT_TIME); */
+  gst_segment_init (&auparse->segment, GST_FORMAT_TIME);
+  if (auparse->start_segment) {
+    gst_event_unref (auparse->start_segment);
+    auparse->start_segment = NULL;
+  }
+  auparse->pull_offset = 0;
+  auparse->end_offset = -1;
+  auparse->discont = TRUE;
 }
 
 static void
@@ -195,20 +223,18 @@ gst_au_parse_negotiate_srcpad (GstAuParse * auparse, GstCaps * new_caps)
   return;
 }
 
+/* parses the AU_HEADER_SIZE bytes of @head and sets the caps on the source
+ * pad, the sample data starts at auparse->offset afterwards */
 static GstFlowReturn
-gst_au_parse_parse_header (GstAuParse * auparse)
+gst_au_parse_parse_header (GstAuParse * auparse, const guint8 * head)
 {
   GstCaps *tempcaps;
   guint32 size;
-  guint8 *head;
   gchar layout[7] = { 0, };
   GstAudioFormat format = GST_AUDIO_FORMAT_UNKNOWN;
   gint law = 0;
   guint endianness;
 
-  head = (guint8 *) gst_adapter_map (auparse->adapter, 24);
-  g_assert (head != NULL);
-
   GST_DEBUG_OBJECT (auparse, "[%c%c%c%c]", head[0], head[1], head[2], head[3]);
 
   switch (GST_READ_UINT32_BE (head)) {
@@ -374,8 +400,6 @@ gst_au_parse_parse_header (GstAuParse * auparse)
   gst_au_parse_negotiate_srcpad (auparse, tempcaps);
 
   GST_DEBUG_OBJECT (auparse, "offset=%" G_GINT64_FORMAT, auparse->offset);
-  gst_adapter_unmap (auparse->adapter);
-  gst_adapter_flush (auparse->adapter, auparse->offset);
 
   gst_caps_unref (tempcaps);
   return GST_FLOW_OK;
@@ -383,34 +407,60 @@ gst_au_parse_parse_header (GstAuParse * auparse)
   /* ERRORS */
 unknown_header:
   {
-    gst_adapter_unmap (auparse->adapter);
     GST_ELEMENT_ERROR (auparse, STREAM, WRONG_TYPE, (NULL), (NULL));
     return GST_FLOW_ERROR;
   }
 unsupported_sample_rate:
   {
-    gst_adapter_unmap (auparse->adapter);
     GST_ELEMENT_ERROR (auparse, STREAM, FORMAT, (NULL),
         ("Unsupported samplerate: %u", auparse->samplerate));
     return GST_FLOW_ERROR;
   }
 unsupported_number_of_channels:
   {
-    gst_adapter_unmap (auparse->adapter);
     GST_ELEMENT_ERROR (auparse, STREAM, FORMAT, (NULL),
         ("Unsupported number of channels: %u", auparse->channels));
     return GST_FLOW_ERROR;
   }
 unknown_format:
   {
-    gst_adapter_unmap (auparse->adapter);
     GST_ELEMENT_ERROR (auparse, STREAM, FORMAT, (NULL),
         ("Unsupported encoding: %u", auparse->encoding));
     return GST_FLOW_ERROR;
   }
 }
 
-#define AU_HEADER_SIZE 24
+/* timestamps @outbuf, which starts @pos bytes into the sample data, and
+ * pushes it */
+static GstFlowReturn
+gst_au_parse_push_buffer (GstAuParse * auparse, GstBuffer * outbuf, gint64 pos)
+{
+  gint64 timestamp;
+  gint64 duration;
+  gint64 offset;
+
+  if (auparse->sample_size > 0 && auparse->samplerate > 0) {
+    gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES, pos,
+        GST_FORMAT_DEFAULT, &offset);
+    gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES, pos,
+        GST_FORMAT_TIME, &timestamp);
+    gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES,
+        gst_buffer_get_size (outbuf), GST_FORMAT_TIME, &duration);
+
+    GST_BUFFER_OFFSET (outbuf) = offset;
+    GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
+    GST_BUFFER_DURATION (outbuf) = duration;
+
+    auparse->segment.position = timestamp + duration;
+  }
+
+  if (G_UNLIKELY (auparse->discont)) {
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    auparse->discont = FALSE;
+  }
+
+  return gst_pad_push (auparse->srcpad, outbuf);
+}
 
 static GstFlowReturn
 gst_au_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
@@ -418,9 +468,7 @@ gst_au_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GstFlowReturn ret = GST_FLOW_OK;
   GstAuParse *auparse;
   gint avail, sendnow = 0;
-  gint64 timestamp;
-  gint64 duration;
-  gint64 offset;
+  const guint8 *head;
   GstSegment segment;
 
   auparse = GST_AU_PARSE (parent);
@@ -439,10 +487,14 @@ gst_au_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       goto out;
     }
 
-    ret = gst_au_parse_parse_header (auparse);
+    head = gst_adapter_map (auparse->adapter, AU_HEADER_SIZE);
+    ret = gst_au_parse_parse_header (auparse, head);
+    gst_adapter_unmap (auparse->adapter);
     if (ret != GST_FLOW_OK)
       goto out;
 
+    gst_adapter_flush (auparse->adapter, auparse->offset);
+
     gst_segment_init (&segment, GST_FORMAT_TIME);
     gst_pad_push_event (auparse->srcpad, gst_event_new_segment (&segment));
   }
@@ -468,22 +520,9 @@ gst_au_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     pos = auparse->buffer_offset - auparse->offset;
     pos = MAX (pos, 0);
 
-    if (auparse->sample_size > 0 && auparse->samplerate > 0) {
-      gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES, pos,
-          GST_FORMAT_DEFAULT, &offset);
-      gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES, pos,
-          GST_FORMAT_TIME, &timestamp);
-      gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES,
-          sendnow, GST_FORMAT_TIME, &duration);
-
-      GST_BUFFER_OFFSET (outbuf) = offset;
-      GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
-      GST_BUFFER_DURATION (outbuf) = duration;
-    }
-
     auparse->buffer_offset += sendnow;
 
-    ret = gst_pad_push (auparse->srcpad, outbuf);
+    ret = gst_au_parse_push_buffer (auparse, outbuf, pos);
   }
 
 out:
@@ -491,6 +530,166 @@ out:
   return ret;
 }
 
+static GstFlowReturn
+gst_au_parse_pull_header (GstAuParse * auparse)
+{
+  GstFlowReturn ret;
+  GstBuffer *buf = NULL;
+  GstMapInfo map;
+  gint64 len;
+
+  ret = gst_pad_pull_range (auparse->sinkpad, 0, AU_HEADER_SIZE, &buf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  if (map.size < AU_HEADER_SIZE) {
+    GST_DEBUG_OBJECT (auparse, "short read of the header");
+    ret = GST_FLOW_EOS;
+  } else {
+    ret = gst_au_parse_parse_header (auparse, map.data);
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  /* the size in the header cannot be trusted, use the upstream length */
+  if (gst_pad_peer_query_duration (auparse->sinkpad, GST_FORMAT_BYTES, &len)
+      && len > auparse->offset) {
+    gint64 duration;
+
+    if (auparse->end_offset == -1)
+      auparse->end_offset = len;
+    if (gst_au_parse_src_convert (auparse, GST_FORMAT_BYTES,
+            len - auparse->offset, GST_FORMAT_TIME, &duration))
+      auparse->segment.duration = duration;
+  }
+
+  auparse->pull_offset = auparse->offset;
+
+  if (auparse->start_segment == NULL)
+    auparse->start_segment = gst_event_new_segment (&auparse->segment);
+
+  return GST_FLOW_OK;
+}
+
+/* reads a block of sample data from upstream and pushes it in sample-aligned
+ * sub-buffers that share the memory of the block */
+static GstFlowReturn
+gst_au_parse_pull_data (GstAuParse * auparse)
+{
+  GstFlowReturn ret;
+  GstBuffer *buf = NULL;
+  guint sample_size = auparse->sample_size;
+  gsize size, bsize, len, off;
+  gint64 pos;
+
+  size = AU_PULL_BLOCK_SIZE;
+  len = AU_PULL_BUFFER_SIZE;
+  if (sample_size > 0) {
+    size -= size % sample_size;
+    len -= len % sample_size;
+  }
+
+  if (auparse->end_offset != -1) {
+    if (auparse->pull_offset >= auparse->end_offset)
+      return GST_FLOW_EOS;
+    size = MIN (size, auparse->end_offset - auparse->pull_offset);
+  }
+
+  ret = gst_pad_pull_range (auparse->sinkpad, auparse->pull_offset, size,
+      &buf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  bsize = gst_buffer_get_size (buf);
+  if (sample_size > 0)
+    bsize -= bsize % sample_size;
+  if (bsize == 0) {
+    GST_DEBUG_OBJECT (auparse, "no complete sample left");
+    gst_buffer_unref (buf);
+    return GST_FLOW_EOS;
+  }
+
+  GST_LOG_OBJECT (auparse, "read %" G_GSIZE_FORMAT " bytes at %"
+      G_GUINT64_FORMAT, bsize, auparse->pull_offset);
+
+  pos = auparse->pull_offset - auparse->offset;
+  auparse->pull_offset += bsize;
+
+  for (off = 0; off < bsize && ret == GST_FLOW_OK; off += len) {
+    GstBuffer *outbuf;
+
+    outbuf = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, off,
+        MIN (len, bsize - off));
+    ret = gst_au_parse_push_buffer (auparse, outbuf, pos + off);
+  }
+  gst_buffer_unref (buf);
+
+  return ret;
+}
+
+static void
+gst_au_parse_loop (GstPad * pad)
+{
+  GstAuParse *auparse = GST_AU_PARSE (GST_PAD_PARENT (pad));
+  GstFlowReturn ret;
+
+  if (G_UNLIKELY (auparse->src_caps == NULL)) {
+    ret = gst_au_parse_pull_header (auparse);
+    if (ret != GST_FLOW_OK)
+      goto pause;
+  }
+
+  if (G_UNLIKELY (auparse->start_segment)) {
+    gst_pad_push_event (auparse->srcpad, auparse->start_segment);
+    auparse->start_segment = NULL;
+  }
+
+  ret = gst_au_parse_pull_data (auparse);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  return;
+
+  /* ERRORS */
+pause:
+  {
+    const gchar *reason = gst_flow_get_name (ret);
+
+    GST_DEBUG_OBJECT (auparse, "pausing task, reason %s", reason);
+    gst_pad_pause_task (pad);
+
+    if (ret == GST_FLOW_EOS) {
+      if (auparse->src_caps == NULL) {
+        GST_ELEMENT_ERROR (auparse, STREAM, WRONG_TYPE, (NULL),
+            ("No valid input found before end of stream"));
+        gst_pad_push_event (auparse->srcpad, gst_event_new_eos ());
+      } else if (auparse->segment.flags & GST_SEEK_FLAG_SEGMENT) {
+        GstClockTime stop;
+
+        if ((stop = auparse->segment.stop) == -1)
+          stop = auparse->segment.duration;
+
+        gst_element_post_message (GST_ELEMENT_CAST (auparse),
+            gst_message_new_segment_done (GST_OBJECT_CAST (auparse),
+                auparse->segment.format, stop));
+        gst_pad_push_event (auparse->srcpad,
+            gst_event_new_segment_done (auparse->segment.format, stop));
+      } else {
+        gst_pad_push_event (auparse->srcpad, gst_event_new_eos ());
+      }
+    } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_ERROR (auparse, STREAM, FAILED,
+          ("Internal data flow error."),
+          ("streaming task paused, reason %s (%d)", reason, ret));
+      gst_pad_push_event (auparse->srcpad, gst_event_new_eos ());
+    }
+    return;
+  }
+}
+
 static gboolean
 gst_au_parse_src_convert (GstAuParse * auparse, GstFormat src_format,
     gint64 srcval, GstFormat dest_format, gint64 * destval)
@@ -600,6 +799,13 @@ gst_au_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       gint64 pos, val;
 
       gst_query_parse_position (query, &format, NULL);
+      if (!auparse->streaming) {
+        ret = gst_au_parse_src_convert (auparse, GST_FORMAT_TIME,
+            auparse->segment.position, format, &val);
+        if (ret)
+          gst_query_set_position (query, format, val);
+        break;
+      }
       if (!gst_pad_peer_query_position (auparse->sinkpad, GST_FORMAT_BYTES,
               &pos)) {
         GST_DEBUG_OBJECT (auparse, "failed to query upstream position");
@@ -636,6 +842,113 @@ gst_au_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
   return ret;
 }
 
+/* seeks in pull mode by moving the read offset to the sample of the new
+ * position */
+static gboolean
+gst_au_parse_perform_seek (GstAuParse * auparse, GstEvent * event)
+{
+  GstSeekType start_type, stop_type;
+  GstSeekFlags flags;
+  GstFormat format;
+  GstSegment seeksegment;
+  gdouble rate;
+  gint64 start, stop, bytes, last_stop;
+  gboolean flush, update;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+      &stop_type, &stop);
+
+  if (format != GST_FORMAT_TIME)
+    goto wrong_format;
+
+  if (rate <= 0.0)
+    goto negative_rate;
+
+  if (auparse->sample_size == 0 || auparse->samplerate == 0)
+    goto no_sample_size;
+
+  flush = flags & GST_SEEK_FLAG_FLUSH;
+
+  if (flush)
+    gst_pad_push_event (auparse->srcpad, gst_event_new_flush_start ());
+  else
+    gst_pad_pause_task (auparse->sinkpad);
+
+  GST_PAD_STREAM_LOCK (auparse->sinkpad);
+
+  last_stop = auparse->segment.position;
+
+  seeksegment = auparse->segment;
+  gst_segment_do_seek (&seeksegment, rate, format, flags, start_type, start,
+      stop_type, stop, &update);
+
+  /* the byte offsets are whole samples, the conversion rounds down */
+  if (start_type != GST_SEEK_TYPE_NONE &&
+      gst_au_parse_src_convert (auparse, GST_FORMAT_TIME,
+          seeksegment.position, GST_FORMAT_BYTES, &bytes))
+    auparse->pull_offset = auparse->offset + bytes;
+
+  if (stop_type != GST_SEEK_TYPE_NONE) {
+    gint64 len;
+
+    if (seeksegment.stop != -1 &&
+        gst_au_parse_src_convert (auparse, GST_FORMAT_TIME, seeksegment.stop,
+            GST_FORMAT_BYTES, &bytes))
+      auparse->end_offset = auparse->offset + bytes;
+    else
+      auparse->end_offset = -1;
+
+    if (gst_pad_peer_query_duration (auparse->sinkpad, GST_FORMAT_BYTES,
+            &len) && (auparse->end_offset == -1 || auparse->end_offset > len))
+      auparse->end_offset = len;
+  }
+
+  GST_DEBUG_OBJECT (auparse, "seek to offset %" G_GUINT64_FORMAT ", end %"
+      G_GUINT64_FORMAT, auparse->pull_offset, auparse->end_offset);
+
+  if (flush)
+    gst_pad_push_event (auparse->srcpad, gst_event_new_flush_stop (TRUE));
+
+  auparse->segment = seeksegment;
+
+  if (auparse->segment.flags & GST_SEEK_FLAG_SEGMENT) {
+    gst_element_post_message (GST_ELEMENT_CAST (auparse),
+        gst_message_new_segment_start (GST_OBJECT_CAST (auparse),
+            auparse->segment.format, auparse->segment.position));
+  }
+
+  if (auparse->start_segment)
+    gst_event_unref (auparse->start_segment);
+  auparse->start_segment = gst_event_new_segment (&auparse->segment);
+
+  if (last_stop != auparse->segment.position)
+    auparse->discont = TRUE;
+
+  gst_pad_start_task (auparse->sinkpad, (GstTaskFunction) gst_au_parse_loop,
+      auparse->sinkpad, NULL);
+
+  GST_PAD_STREAM_UNLOCK (auparse->sinkpad);
+
+  return TRUE;
+
+  /* ERRORS */
+wrong_format:
+  {
+    GST_DEBUG_OBJECT (auparse, "only support seeks in TIME format");
+    return FALSE;
+  }
+negative_rate:
+  {
+    GST_DEBUG_OBJECT (auparse, "negative playback rates are not supported");
+    return FALSE;
+  }
+no_sample_size:
+  {
+    GST_DEBUG_OBJECT (auparse, "cannot seek, sample size unknown");
+    return FALSE;
+  }
+}
+
 static gboolean
 gst_au_parse_handle_seek (GstAuParse * auparse, GstEvent * event)
 {
@@ -646,6 +959,9 @@ gst_au_parse_handle_seek (GstAuParse * auparse, GstEvent * event)
   gint64 start, stop;
   gboolean res;
 
+  if (!auparse->streaming)
+    return gst_au_parse_perform_seek (auparse, event);
+
   gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
       &stop_type, &stop);
 
@@ -756,6 +1072,7 @@ gst_au_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_SEEK:
       ret = gst_au_parse_handle_seek (auparse, event);
+      gst_event_unref (event);
       break;
     default:
       ret = gst_pad_event_default (pad, parent, event);
@@ -765,6 +1082,64 @@ gst_au_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return ret;
 }
 
+static gboolean
+gst_au_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstAuParse *auparse = GST_AU_PARSE (parent);
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
+
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
+  }
+
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
+
+  if (!pull_mode)
+    goto activate_push;
+
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  auparse->streaming = FALSE;
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  {
+    GST_DEBUG_OBJECT (sinkpad, "activating push");
+    auparse->streaming = TRUE;
+    return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+  }
+}
+
+static gboolean
+gst_au_parse_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  gboolean res;
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      res = TRUE;
+      break;
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        res = gst_pad_start_task (sinkpad, (GstTaskFunction) gst_au_parse_loop,
+            sinkpad, NULL);
+      } else {
+        res = gst_pad_stop_task (sinkpad);
+      }
+      break;
+    default:
+      res = FALSE;
+      break;
+  }
+  return res;
+}
+
 static GstStateChangeReturn
 gst_au_parse_change_state (GstElement * element, GstStateChange transition)
 {
@@ -53,7 +53,14 @@ struct _GstAuParse {
 
   GstAdapter *adapter;
 
-  /* GstSegment  segment; */
+  gboolean    streaming;     /* push mode */
+
+  /* pull mode */
+  GstSegment  segment;
+  GstEvent   *start_segment;
+  guint64     pull_offset;   /* next byte to read */
+  guint64     end_offset;    /* last byte to read or -1 */
+  gboolean    discont;
 
   gint64      offset;        /* where sample data starts */
   gint64      buffer_offset;
@@ -231,17 +231,117 @@ gst_auto_audio_sink_create_element_with_pretty_name (GstAutoAudioSink * sink,
   return element;
 }
 
+/* The factory of the last sink that could be opened in this process and the
+ * filter caps it was selected with. Later sinks with the same filter caps
+ * try it before probing all candidates, which opens every higher ranked
+ * device that doesn't work again */
+static GMutex cache_lock;
+static GstElementFactory *cached_factory = NULL;
+static GstCaps *cached_caps = NULL;
+
+static GstElementFactory *
+gst_auto_audio_sink_get_cached_factory (GstAutoAudioSink * sink)
+{
+  GstElementFactory *factory = NULL;
+
+  g_mutex_lock (&cache_lock);
+  if (cached_factory && (cached_caps == sink->filter_caps || (cached_caps
+              && sink->filter_caps
+              && gst_caps_is_equal (cached_caps, sink->filter_caps))))
+    factory = gst_object_ref (cached_factory);
+  g_mutex_unlock (&cache_lock);
+
+  return factory;
+}
+
+static void
+gst_auto_audio_sink_set_cached_factory (GstAutoAudioSink * sink,
+    GstElementFactory * factory)
+{
+  g_mutex_lock (&cache_lock);
+  gst_object_replace ((GstObject **) & cached_factory, (GstObject *) factory);
+  gst_caps_replace (&cached_caps, factory ? sink->filter_caps : NULL);
+  g_mutex_unlock (&cache_lock);
+}
+
+/* create a sink from @f and bring it to READY. Returns NULL when it doesn't
+ * match the filter caps or can't be opened, the error messages it posted are
+ * appended to @errors */
+static GstElement *
+gst_auto_audio_sink_try_factory (GstAutoAudioSink * sink,
+    GstElementFactory * f, GstBus * bus, GSList ** errors)
+{
+  GstElement *el;
+  GstMessage *message;
+  GstStateChangeReturn ret;
+
+  if (!(el = gst_auto_audio_sink_create_element_with_pretty_name (sink, f)))
+    return NULL;
+
+  GST_DEBUG_OBJECT (sink, "Testing %s", GST_OBJECT_NAME (f));
+
+  /* If autoaudiosink has been provided with filter caps,
+   * accept only sinks that match with the filter caps */
+  if (sink->filter_caps) {
+    GstPad *el_pad;
+    GstCaps *el_caps;
+    gboolean no_match;
+
+    el_pad = gst_element_get_static_pad (GST_ELEMENT (el), "sink");
+    el_caps = gst_pad_query_caps (el_pad, NULL);
+    gst_object_unref (el_pad);
+    GST_DEBUG_OBJECT (sink,
+        "Checking caps: %" GST_PTR_FORMAT " vs. %" GST_PTR_FORMAT,
+        sink->filter_caps, el_caps);
+    no_match = !gst_caps_can_intersect (sink->filter_caps, el_caps);
+    gst_caps_unref (el_caps);
+
+    if (no_match) {
+      GST_DEBUG_OBJECT (sink, "Incompatible caps");
+      gst_object_unref (el);
+      return NULL;
+    } else {
+      GST_DEBUG_OBJECT (sink, "Found compatible caps");
+    }
+  }
+
+  gst_element_set_bus (el, bus);
+  ret = gst_element_set_state (el, GST_STATE_READY);
+  if (ret == GST_STATE_CHANGE_SUCCESS) {
+    GST_DEBUG_OBJECT (sink, "This worked!");
+    return el;
+  }
+
+  /* collect all error messages */
+  while ((message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR))) {
+    GST_DEBUG_OBJECT (sink, "error message %" GST_PTR_FORMAT, message);
+    *errors = g_slist_append (*errors, message);
+  }
+
+  gst_element_set_state (el, GST_STATE_NULL);
+  gst_object_unref (el);
+
+  return NULL;
+}
+
 static GstElement *
 gst_auto_audio_sink_find_best (GstAutoAudioSink * sink)
 {
-  GList *list, *item;
+  GList *list = NULL, *item;
   GstElement *choice = NULL;
-  GstMessage *message = NULL;
   GSList *errors = NULL;
   GstBus *bus = gst_bus_new ();
-  GstPad *el_pad = NULL;
-  GstCaps *el_caps = NULL;
-  gboolean no_match = TRUE;
+  GstElementFactory *cached;
+
+  /* the sink that worked last time is validated by opening it, we only
+   * probe when that fails */
+  if ((cached = gst_auto_audio_sink_get_cached_factory (sink))) {
+    GST_DEBUG_OBJECT (sink, "Trying %s first, it worked before",
+        GST_OBJECT_NAME (cached));
+    choice = gst_auto_audio_sink_try_factory (sink, cached, bus, &errors);
+    if (choice)
+      goto done;
+  }
 
   list = gst_registry_feature_filter (gst_registry_get (),
       (GstPluginFeatureFilter) gst_auto_audio_sink_factory_filter, FALSE, sink);
@@ -255,53 +355,20 @@ gst_auto_audio_sink_find_best (GstAutoAudioSink * sink)
 
   for (item = list; item != NULL; item = item->next) {
     GstElementFactory *f = GST_ELEMENT_FACTORY (item->data);
-    GstElement *el;
-
-    if ((el = gst_auto_audio_sink_create_element_with_pretty_name (sink, f))) {
-      GstStateChangeReturn ret;
-
-      GST_DEBUG_OBJECT (sink, "Testing %s", GST_OBJECT_NAME (f));
-
-      /* If autoaudiosink has been provided with filter caps,
-       * accept only sinks that match with the filter caps */
-      if (sink->filter_caps) {
-        el_pad = gst_element_get_static_pad (GST_ELEMENT (el), "sink");
-        el_caps = gst_pad_query_caps (el_pad, NULL);
-        gst_object_unref (el_pad);
-        GST_DEBUG_OBJECT (sink,
-            "Checking caps: %" GST_PTR_FORMAT " vs. %" GST_PTR_FORMAT,
-            sink->filter_caps, el_caps);
-        no_match = !gst_caps_can_intersect (sink->filter_caps, el_caps);
-        gst_caps_unref (el_caps);
-
-        if (no_match) {
-          GST_DEBUG_OBJECT (sink, "Incompatible caps");
-          gst_object_unref (el);
-          continue;
-        } else {
-          GST_DEBUG_OBJECT (sink, "Found compatible caps");
-        }
-      }
-
-      gst_element_set_bus (el, bus);
-      ret = gst_element_set_state (el, GST_STATE_READY);
-      if (ret == GST_STATE_CHANGE_SUCCESS) {
-        GST_DEBUG_OBJECT (sink, "This worked!");
-        choice = el;
-        break;
-      }
-
-      /* collect all error messages */
-      while ((message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR))) {
-        GST_DEBUG_OBJECT (sink, "error message %" GST_PTR_FORMAT, message);
-        errors = g_slist_append (errors, message);
-      }
-
-      gst_element_set_state (el, GST_STATE_NULL);
-      gst_object_unref (el);
+
+    /* already failed above */
+    if (f == cached)
+      continue;
+
+    if ((choice = gst_auto_audio_sink_try_factory (sink, f, bus, &errors))) {
+      gst_auto_audio_sink_set_cached_factory (sink, f);
+      break;
     }
   }
 
+  if (!choice && cached)
+    gst_auto_audio_sink_set_cached_factory (sink, NULL);
+
   GST_DEBUG_OBJECT (sink, "done trying");
   if (!choice) {
     if (errors) {
@@ -320,6 +387,10 @@ gst_auto_audio_sink_find_best (GstAutoAudioSink * sink)
       gst_element_set_state (choice, GST_STATE_READY);
     }
   }
+
+done:
+  if (cached)
+    gst_object_unref (cached);
   gst_object_unref (bus);
   gst_plugin_feature_list_free (list);
   g_slist_foreach (errors, (GFunc) gst_mini_object_unref, NULL);
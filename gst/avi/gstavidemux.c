@@ -47,6 +47,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "gst/riff/riff-media.h"
 #include "gstavidemux.h"
@@ -122,6 +123,8 @@ static void gst_avi_demux_calculate_durations_from_index (GstAviDemux * avi);
 static void gst_avi_demux_get_buffer_info (GstAviDemux * avi,
     GstAviStream * stream, guint entry_n, GstClockTime * timestamp,
     GstClockTime * ts_end, guint64 * offset, guint64 * offset_end);
+static guint64 gst_avi_stream_entry_total (GstAviStream * stream,
+    guint entry_n);
 
 static void gst_avi_demux_parse_idit (GstAviDemux * avi, GstBuffer * buf);
 static void gst_avi_demux_parse_strd (GstAviDemux * avi, GstBuffer * buf);
@@ -219,6 +222,7 @@ gst_avi_demux_reset_stream (GstAviDemux * avi, GstAviStream * stream)
   g_free (stream->strf.data);
   g_free (stream->name);
   g_free (stream->index);
+  g_free (stream->idx_totals);
   g_free (stream->indexes);
   if (stream->initdata)
     gst_buffer_unref (stream->initdata);
@@ -263,6 +267,8 @@ gst_avi_demux_reset (GstAviDemux * avi)
   avi->state = GST_AVI_DEMUX_START;
   avi->offset = 0;
   avi->building_index = FALSE;
+  g_free (avi->odml_subidxs);
+  avi->odml_subidxs = NULL;
 
   avi->index_offset = 0;
   g_free (avi->avih);
@@ -725,7 +731,7 @@ gst_avi_demux_seek_streams_index (GstAviDemux * avi, guint64 offset,
     GST_DEBUG_OBJECT (avi, "stream %d, next entry at %" G_GUINT64_FORMAT, i,
         val);
 
-    stream->current_total = stream->index[index].total;
+    stream->current_total = gst_avi_stream_entry_total (stream, index);
     stream->current_entry = index;
   }
 
@@ -1313,6 +1319,38 @@ invalid_params:
   }
 }
 
+/* the amount an entry adds to the total of its stream: blocks for VBR
+ * audio, one for every frame of VBR video and bytes otherwise */
+static inline guint64
+gst_avi_stream_entry_units (GstAviStream * stream, GstAviIndexEntry * entry)
+{
+  if (stream->is_vbr) {
+    if (stream->strh->type == GST_RIFF_FCC_auds) {
+      gint blockalign = stream->strf.auds->blockalign;
+
+      if (blockalign > 0)
+        return DIV_ROUND_UP (entry->size, blockalign);
+    }
+    return 1;
+  }
+  return entry->size;
+}
+
+/* the total of the stream before @entry_n, which can be converted to the
+ * timestamp of the entry easily */
+static guint64
+gst_avi_stream_entry_total (GstAviStream * stream, guint entry_n)
+{
+  guint64 total;
+  guint i;
+
+  total = stream->idx_totals[entry_n / GST_AVI_INDEX_TOTALS_STEP];
+  for (i = entry_n - entry_n % GST_AVI_INDEX_TOTALS_STEP; i < entry_n; i++)
+    total += gst_avi_stream_entry_units (stream, &stream->index[i]);
+
+  return total;
+}
+
 /* add an entry to the index of a stream. @num should be an estimate of the
  * total amount of index entries for all streams and is used to dynamically
  * allocate memory for the index entries. */
@@ -1320,10 +1358,13 @@ static inline gboolean
 gst_avi_demux_add_index (GstAviDemux * avi, GstAviStream * stream,
     guint num, GstAviIndexEntry * entry)
 {
+  guint64 total;
+
   /* ensure index memory */
   if (G_UNLIKELY (stream->idx_n >= stream->idx_max)) {
     guint idx_max = stream->idx_max;
     GstAviIndexEntry *new_idx;
+    guint64 *new_totals;
 
     /* we need to make some more room */
     if (idx_max == 0) {
@@ -1331,7 +1372,8 @@ gst_avi_demux_add_index (GstAviDemux * avi, GstAviStream * stream,
        * overshoot with at least 8K */
       idx_max = (num / avi->num_streams) + (8192 / sizeof (GstAviIndexEntry));
     } else {
-      idx_max += 8192 / sizeof (GstAviIndexEntry);
+      /* grow by half, so that large indexes are not copied over and over */
+      idx_max += MAX (idx_max / 2, 8192 / sizeof (GstAviIndexEntry));
       GST_DEBUG_OBJECT (avi, "expanded index from %u to %u",
           stream->idx_max, idx_max);
     }
@@ -1341,18 +1383,22 @@ gst_avi_demux_add_index (GstAviDemux * avi, GstAviStream * stream,
       return FALSE;
     /* use new index */
     stream->index = new_idx;
+    new_totals = g_try_renew (guint64, stream->idx_totals,
+        idx_max / GST_AVI_INDEX_TOTALS_STEP + 1);
+    if (G_UNLIKELY (!new_totals))
+      return FALSE;
+    stream->idx_totals = new_totals;
     stream->idx_max = idx_max;
   }
 
-  /* update entry total and stream stats. The entry total can be converted to
-   * the timestamp of the entry easily. */
+  /* update entry total and stream stats */
   if (stream->strh->type == GST_RIFF_FCC_auds) {
     gint blockalign;
 
     if (stream->is_vbr) {
-      entry->total = stream->total_blocks;
+      total = stream->total_blocks;
     } else {
-      entry->total = stream->total_bytes;
+      total = stream->total_bytes;
     }
     blockalign = stream->strf.auds->blockalign;
     if (blockalign > 0)
@@ -1361,11 +1407,13 @@ gst_avi_demux_add_index (GstAviDemux * avi, GstAviStream * stream,
       stream->total_blocks++;
   } else {
     if (stream->is_vbr) {
-      entry->total = stream->idx_n;
+      total = stream->idx_n;
     } else {
-      entry->total = stream->total_bytes;
+      total = stream->total_bytes;
     }
   }
+  if (stream->idx_n % GST_AVI_INDEX_TOTALS_STEP == 0)
+    stream->idx_totals[stream->idx_n / GST_AVI_INDEX_TOTALS_STEP] = total;
   stream->total_bytes += entry->size;
   if (ENTRY_IS_KEYFRAME (entry))
     stream->n_keyframes++;
@@ -1375,7 +1423,7 @@ gst_avi_demux_add_index (GstAviDemux * avi, GstAviStream * stream,
       "Adding stream %u, index entry %d, kf %d, size %u "
       ", offset %" G_GUINT64_FORMAT ", total %" G_GUINT64_FORMAT, stream->num,
       stream->idx_n, ENTRY_IS_KEYFRAME (entry), entry->size, entry->offset,
-      entry->total);
+      total);
   stream->index[stream->idx_n++] = *entry;
 
   return TRUE;
@@ -1395,15 +1443,16 @@ gst_avi_demux_get_buffer_info (GstAviDemux * avi, GstAviStream * stream,
   if (stream->is_vbr) {
     /* VBR stream next timestamp */
     if (stream->strh->type == GST_RIFF_FCC_auds) {
+      guint64 total = gst_avi_stream_entry_total (stream, entry_n);
+
       if (timestamp)
-        *timestamp =
-            avi_stream_convert_frames_to_time_unchecked (stream, entry->total);
+        *timestamp = avi_stream_convert_frames_to_time_unchecked (stream, total);
       if (ts_end) {
         gint size = 1;
         if (G_LIKELY (entry_n + 1 < stream->idx_n))
-          size = stream->index[entry_n + 1].total - entry->total;
+          size = gst_avi_stream_entry_units (stream, entry);
         *ts_end = avi_stream_convert_frames_to_time_unchecked (stream,
-            entry->total + size);
+            total + size);
       }
     } else {
       if (timestamp)
@@ -1415,12 +1464,13 @@ gst_avi_demux_get_buffer_info (GstAviDemux * avi, GstAviStream * stream,
     }
   } else if (stream->strh->type == GST_RIFF_FCC_auds) {
     /* constant rate stream */
+    guint64 total = gst_avi_stream_entry_total (stream, entry_n);
+
     if (timestamp)
-      *timestamp =
-          avi_stream_convert_bytes_to_time_unchecked (stream, entry->total);
+      *timestamp = avi_stream_convert_bytes_to_time_unchecked (stream, total);
     if (ts_end)
       *ts_end = avi_stream_convert_bytes_to_time_unchecked (stream,
-          entry->total + entry->size);
+          total + entry->size);
   }
   if (stream->strh->type == GST_RIFF_FCC_vids) {
     /* video offsets are the frame number */
@@ -1467,6 +1517,23 @@ gst_avi_demux_do_index_stats (GstAviDemux * avi)
     gst_avi_demux_get_buffer_info (avi, stream, stream->idx_n - 1,
         NULL, &stream->idx_duration, NULL, NULL);
 
+    /* the index is complete now, give back the unused room */
+    if (stream->idx_max > stream->idx_n) {
+      GstAviIndexEntry *new_idx;
+      guint64 *new_totals;
+
+      /* a failed shrink leaves the old, larger, memory in place */
+      new_idx = g_try_renew (GstAviIndexEntry, stream->index, stream->idx_n);
+      if (new_idx) {
+        stream->index = new_idx;
+        stream->idx_max = stream->idx_n;
+        new_totals = g_try_renew (guint64, stream->idx_totals,
+            stream->idx_n / GST_AVI_INDEX_TOTALS_STEP + 1);
+        if (new_totals)
+          stream->idx_totals = new_totals;
+      }
+    }
+
     total_idx += stream->idx_n;
 #ifndef GST_DISABLE_GST_DEBUG
     total_max += stream->idx_max;
@@ -1640,6 +1707,45 @@ perform_seek_to_offset (GstAviDemux * demux, guint64 offset)
   return res;
 }
 
+static gint
+gst_avi_demux_offset_compare (gconstpointer a, gconstpointer b)
+{
+  guint64 off_a = *(const guint64 *) a;
+  guint64 off_b = *(const guint64 *) b;
+
+  return (off_a > off_b) - (off_a < off_b);
+}
+
+/* collect the subindex offsets of all streams in file order, terminated
+ * with GST_BUFFER_OFFSET_NONE, so that they can be read in a single forward
+ * pass over the file */
+static guint64 *
+gst_avi_demux_collect_subindexes (GstAviDemux * avi)
+{
+  guint64 *offsets;
+  guint i, j, n = 0;
+
+  for (i = 0; i < avi->num_streams; i++) {
+    for (j = 0; avi->stream[i].indexes &&
+        avi->stream[i].indexes[j] != GST_BUFFER_OFFSET_NONE; j++)
+      n++;
+  }
+
+  offsets = g_new (guint64, n + 1);
+  n = 0;
+  for (i = 0; i < avi->num_streams; i++) {
+    for (j = 0; avi->stream[i].indexes &&
+        avi->stream[i].indexes[j] != GST_BUFFER_OFFSET_NONE; j++)
+      offsets[n++] = avi->stream[i].indexes[j];
+  }
+  qsort (offsets, n, sizeof (guint64), gst_avi_demux_offset_compare);
+  offsets[n] = GST_BUFFER_OFFSET_NONE;
+
+  GST_DEBUG_OBJECT (avi, "%u subindexes to read", n);
+
+  return offsets;
+}
+
 /*
  * Read AVI index when streaming
  */
@@ -1652,23 +1758,28 @@ gst_avi_demux_read_subindexes_push (GstAviDemux * avi)
 
   GST_DEBUG_OBJECT (avi, "read subindexes for %d streams", avi->num_streams);
 
-  if (avi->odml_subidxs[avi->odml_subidx] != avi->offset)
+  if (avi->odml_subidxs == NULL ||
+      avi->odml_subidxs[avi->odml_subidx] != avi->offset)
     return FALSE;
 
   if (!gst_avi_demux_peek_chunk (avi, &tag, &size))
     return TRUE;
 
-  /* this is the ODML chunk we expect */
-  odml_stream = avi->odml_stream;
-
-  if ((tag != GST_MAKE_FOURCC ('i', 'x', '0' + odml_stream / 10,
-              '0' + odml_stream % 10)) &&
-      (tag != GST_MAKE_FOURCC ('0' + odml_stream / 10,
-              '0' + odml_stream % 10, 'i', 'x'))) {
+  /* the subindexes are read in file order, so get the stream from the tag.
+   * Some ODML files have a ##ix format instead of the 'official' ix## */
+  if ((tag & 0xffff) == GST_MAKE_FOURCC ('i', 'x', 0, 0)) {
+    odml_stream = CHUNKID_TO_STREAMNR (tag >> 16);
+  } else if ((tag >> 16) == GST_MAKE_FOURCC ('i', 'x', 0, 0)) {
+    odml_stream = CHUNKID_TO_STREAMNR (tag);
+  } else {
     GST_WARNING_OBJECT (avi, "Not an ix## chunk (%" GST_FOURCC_FORMAT ")",
         GST_FOURCC_ARGS (tag));
     return FALSE;
   }
+  if (odml_stream >= avi->num_streams) {
+    GST_WARNING_OBJECT (avi, "subindex for unknown stream %u", odml_stream);
+    return FALSE;
+  }
 
   avi->offset += 8 + GST_ROUND_UP_2 (size);
   /* flush chunk header so we get just the 'size' payload data */
@@ -1682,22 +1793,19 @@ gst_avi_demux_read_subindexes_push (GstAviDemux * avi)
   avi->odml_subidx++;
 
   if (avi->odml_subidxs[avi->odml_subidx] == GST_BUFFER_OFFSET_NONE) {
-    /* we reached the end of the indexes for this stream, move to the next
-     * stream to handle the first index */
-    avi->odml_stream++;
-    avi->odml_subidx = 0;
-
-    if (avi->odml_stream < avi->num_streams) {
-      /* there are more indexes */
-      avi->odml_subidxs = avi->stream[avi->odml_stream].indexes;
-    } else {
-      /* we're done, get stream stats now */
-      avi->have_index = gst_avi_demux_do_index_stats (avi);
+    /* we're done, get stream stats now */
+    g_free (avi->odml_subidxs);
+    avi->odml_subidxs = NULL;
+    avi->have_index = gst_avi_demux_do_index_stats (avi);
 
-      return TRUE;
-    }
+    return TRUE;
   }
 
+  /* subindexes written next to each other need no seek, the data is
+   * already coming in */
+  if (avi->odml_subidxs[avi->odml_subidx] == avi->offset)
+    return TRUE;
+
   /* seek to next index */
   return perform_seek_to_offset (avi, avi->odml_subidxs[avi->odml_subidx]);
 }
@@ -2576,16 +2684,48 @@ gst_avi_demux_index_next (GstAviDemux * avi, GstAviStream * stream,
   return stream->idx_n - 1;
 }
 
-static guint
-gst_avi_demux_index_entry_search (GstAviIndexEntry * entry, guint64 * total)
+static gint
+gst_avi_demux_index_total_search (guint64 * total, guint64 * target)
 {
-  if (entry->total < *total)
+  if (*total < *target)
     return -1;
-  else if (entry->total > *total)
+  else if (*total > *target)
     return 1;
   return 0;
 }
 
+/* find the last entry with a total less or equal than @total. First finds
+ * the run of entries with a stored total, then walks that run. */
+static guint
+gst_avi_demux_index_for_total (GstAviStream * stream, guint64 total)
+{
+  guint64 *found, cur;
+  guint index, end;
+
+  found = gst_util_array_binary_search (stream->idx_totals,
+      (stream->idx_n + GST_AVI_INDEX_TOTALS_STEP - 1) /
+      GST_AVI_INDEX_TOTALS_STEP, sizeof (guint64),
+      (GCompareDataFunc) gst_avi_demux_index_total_search,
+      GST_SEARCH_MODE_BEFORE, &total, NULL);
+  if (found == NULL)
+    return -1;
+
+  index = (found - stream->idx_totals) * GST_AVI_INDEX_TOTALS_STEP;
+  end = MIN (index + GST_AVI_INDEX_TOTALS_STEP, stream->idx_n);
+  cur = *found;
+  while (index + 1 < end) {
+    guint64 next = cur + gst_avi_stream_entry_units (stream,
+        &stream->index[index]);
+
+    if (next > total)
+      break;
+    cur = next;
+    index++;
+  }
+
+  return index;
+}
+
 /*
  * gst_avi_demux_index_for_time:
  * @avi: Avi object
@@ -2629,22 +2769,16 @@ gst_avi_demux_index_for_time (GstAviDemux * avi,
     return -1;
 
   if (index == -1) {
-    GstAviIndexEntry *entry;
-
     /* no index, find index with binary search on total */
     GST_LOG_OBJECT (avi, "binary search for entry with total %"
         G_GUINT64_FORMAT, total);
 
-    entry = gst_util_array_binary_search (stream->index,
-        stream->idx_n, sizeof (GstAviIndexEntry),
-        (GCompareDataFunc) gst_avi_demux_index_entry_search,
-        GST_SEARCH_MODE_BEFORE, &total, NULL);
+    index = gst_avi_demux_index_for_total (stream, total);
 
-    if (entry == NULL) {
+    if (index == -1) {
       GST_LOG_OBJECT (avi, "not found, assume index 0");
       index = 0;
     } else {
-      index = entry - stream->index;
       GST_LOG_OBJECT (avi, "found at %u", index);
     }
   } else {
@@ -4835,6 +4969,14 @@ gst_avi_demux_handle_seek_push (GstAviDemux * avi, GstPad * pad,
     guint64 offset = 0;
     gboolean building_index;
 
+    /* nothing to build a seek index from, don't go looking for one at the
+     * end of the file and wait for it forever */
+    if (!avi->stream[0].indexes &&
+        !(avi->avih->flags & GST_RIFF_AVIH_HASINDEX)) {
+      GST_DEBUG_OBJECT (avi, "file has no index, can't seek");
+      return FALSE;
+    }
+
     GST_OBJECT_LOCK (avi);
     /* handle the seek event in the chain function */
     avi->state = GST_AVI_DEMUX_SEEK;
@@ -4850,8 +4992,9 @@ gst_avi_demux_handle_seek_push (GstAviDemux * avi, GstPad * pad,
     if (!building_index) {
       avi->building_index = TRUE;
       if (avi->stream[0].indexes) {
-        avi->odml_stream = 0;
-        avi->odml_subidxs = avi->stream[avi->odml_stream].indexes;
+        g_free (avi->odml_subidxs);
+        avi->odml_subidxs = gst_avi_demux_collect_subindexes (avi);
+        avi->odml_subidx = 0;
         offset = avi->odml_subidxs[0];
       } else {
         offset = avi->idx1_offset;
@@ -5062,7 +5205,7 @@ gst_avi_demux_advance (GstAviDemux * avi, GstAviStream * stream,
 
   if (new_entry != old_entry) {
     stream->current_entry = new_entry;
-    stream->current_total = stream->index[new_entry].total;
+    stream->current_total = gst_avi_stream_entry_total (stream, new_entry);
 
     if (new_entry == old_entry + 1) {
       GST_DEBUG_OBJECT (avi, "moved forwards from %u to %u",
@@ -48,14 +48,17 @@ G_BEGIN_DECLS
    (((chunkid) >> 8) & 0xff) - '0')
 
 
-/* new index entries 24 bytes */
+/* new index entries 16 bytes. The total bytes (or blocks) before an entry
+ * are only stored for every GST_AVI_INDEX_TOTALS_STEP entries and summed up
+ * from the entry sizes in between. */
 typedef struct {
   guint32        flags;
   guint32        size;    /* bytes of the data */
   guint64        offset;  /* data offset in file */
-  guint64        total;   /* total bytes before */
 } GstAviIndexEntry;
 
+#define GST_AVI_INDEX_TOTALS_STEP       32
+
 typedef struct {
   /* index of this streamcontext */
   guint          num;
@@ -115,6 +118,7 @@ typedef struct {
   GstAviIndexEntry *index;     /* array with index entries */
   guint             idx_n;     /* number of entries */
   guint             idx_max;   /* max allocated size of entries */
+  guint64          *idx_totals; /* total before every TOTALS_STEP entries */
 
   GstTagList	*taglist;
 
@@ -197,7 +201,6 @@ typedef struct _GstAviDemux {
   GstEvent      *seek_event;
 
   gboolean       building_index;
-  guint          odml_stream;
   guint          odml_subidx;
   guint64       *odml_subidxs;
 
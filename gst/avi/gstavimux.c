@@ -1435,12 +1435,11 @@ gst_avi_mux_riff_get_header (GstAviPad * avipad, guint32 video_frame_size)
 }
 
 /* write an odml index chunk in the movi list */
-static GstFlowReturn
-gst_avi_mux_write_avix_index (GstAviMux * avimux, GstAviPad * avipad,
-    gchar * code, gchar * chunk, gst_avi_superindex_entry * super_index,
-    gint * super_index_count)
+static void
+gst_avi_mux_write_avix_index (GstAviMux * avimux, GstBufferList * list,
+    GstAviPad * avipad, gchar * code, gchar * chunk,
+    gst_avi_superindex_entry * super_index, gint * super_index_count)
 {
-  GstFlowReturn res;
   GstBuffer *buffer;
   guint8 *data;
   gst_riff_index_entry *entry;
@@ -1502,9 +1501,8 @@ gst_avi_mux_write_avix_index (GstAviMux * avimux, GstAviPad * avipad,
   gst_buffer_unmap (buffer, &map);
   gst_buffer_resize (buffer, 0, size);
 
-  /* send */
-  if ((res = gst_pad_push (avimux->srcpad, buffer)) != GST_FLOW_OK)
-    return res;
+  /* queue for sending along with the other streams' indexes */
+  gst_buffer_list_add (list, buffer);
 
   /* keep track of this in superindex (if room) ... */
   if (*super_index_count < GST_AVI_SUPERINDEX_COUNT) {
@@ -1527,8 +1525,6 @@ gst_avi_mux_write_avix_index (GstAviMux * avimux, GstAviPad * avipad,
     avimux->datax_size += size;
   else
     avimux->data_size += size;
-
-  return GST_FLOW_OK;
 }
 
 /* some other usable functions (thankyou xawtv ;-) ) */
@@ -1539,7 +1535,8 @@ gst_avi_mux_add_index (GstAviMux * avimux, GstAviPad * avipad, guint32 flags,
 {
   gchar *code = avipad->tag;
   if (avimux->idx_index == avimux->idx_count) {
-    avimux->idx_count += 256;
+    /* grow geometrically, long captures add millions of entries */
+    avimux->idx_count += MAX (256, avimux->idx_count / 2);
     avimux->idx =
         g_realloc (avimux->idx,
         avimux->idx_count * sizeof (gst_riff_index_entry));
@@ -1578,18 +1575,16 @@ gst_avi_mux_write_index (GstAviMux * avimux)
       avimux->idx_index * sizeof (gst_riff_index_entry));
   gst_buffer_unmap (buffer, &map);
 
-  res = gst_pad_push (avimux->srcpad, buffer);
-  if (res != GST_FLOW_OK)
-    return res;
-
-  buffer = gst_buffer_new ();
-
   size = avimux->idx_index * sizeof (gst_riff_index_entry);
   data = (guint8 *) avimux->idx;
   avimux->idx = NULL;           /* will be free()'ed by gst_buffer_unref() */
 
-  gst_buffer_append_memory (buffer,
-      gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
+  /* chunk header and entries go out in one buffer */
+  if (size > 0)
+    gst_buffer_append_memory (buffer,
+        gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
+  else
+    g_free (data);
 
   avimux->total_data += size + 8;
 
@@ -1609,20 +1604,23 @@ gst_avi_mux_bigfile (GstAviMux * avimux, gboolean last)
 {
   GstFlowReturn res = GST_FLOW_OK;
   GstBuffer *header;
+  GstBufferList *list;
   GSList *node;
 
-  /* first some odml standard index chunks in the movi list */
+  /* first some odml standard index chunks in the movi list, these complete
+   * the current RIFF segment and go out together */
+  list = gst_buffer_list_new ();
   node = avimux->sinkpads;
   while (node) {
     GstAviPad *avipad = (GstAviPad *) node->data;
 
     node = node->next;
 
-    res = gst_avi_mux_write_avix_index (avimux, avipad, avipad->tag,
+    gst_avi_mux_write_avix_index (avimux, list, avipad, avipad->tag,
         avipad->idx_tag, avipad->idx, &avipad->idx_index);
-    if (res != GST_FLOW_OK)
-      return res;
   }
+  if ((res = gst_pad_push_list (avimux->srcpad, list)) != GST_FLOW_OK)
+    return res;
 
   if (avimux->is_bigfile) {
     GstSegment segment;
@@ -1916,15 +1914,15 @@ gst_avi_mux_handle_event (GstCollectPads * pads, GstCollectData * data,
 }
 
 /* send extra 'padding' data */
-static GstFlowReturn
-gst_avi_mux_send_pad_data (GstAviMux * avimux, gulong num_bytes)
+static GstBuffer *
+gst_avi_mux_get_pad_data (GstAviMux * avimux, gulong num_bytes)
 {
   GstBuffer *buffer;
 
   buffer = gst_buffer_new_and_alloc (num_bytes);
   gst_buffer_memset (buffer, 0, 0, num_bytes);
 
-  return gst_pad_push (avimux->srcpad, buffer);
+  return buffer;
 }
 
 #define gst_avi_mux_is_uncompressed(fourcc)		\
@@ -1995,6 +1993,7 @@ gst_avi_mux_do_buffer (GstAviMux * avimux, GstAviPad * avipad)
 {
   GstFlowReturn res;
   GstBuffer *data, *header;
+  GstBufferList *list;
   gulong total_size, pad_bytes = 0;
   guint flags;
   gsize datasize;
@@ -2090,21 +2089,18 @@ gst_avi_mux_do_buffer (GstAviMux * avimux, GstAviPad * avipad)
 
   gst_avi_mux_add_index (avimux, avipad, flags, datasize);
 
-  /* send buffers */
-  GST_LOG_OBJECT (avimux, "pushing buffers: head, data");
+  /* send buffers, chunk header, payload and padding in one go */
+  GST_LOG_OBJECT (avimux, "pushing buffer list: head, data");
 
-  if ((res = gst_pad_push (avimux->srcpad, header)) != GST_FLOW_OK)
-    goto done;
+  list = gst_buffer_list_new_sized (3);
+  gst_buffer_list_add (list, header);
+  gst_buffer_list_add (list, gst_buffer_ref (data));
+  if (pad_bytes)
+    gst_buffer_list_add (list, gst_avi_mux_get_pad_data (avimux, pad_bytes));
 
-  gst_buffer_ref (data);
-  if ((res = gst_pad_push (avimux->srcpad, data)) != GST_FLOW_OK)
+  if ((res = gst_pad_push_list (avimux->srcpad, list)) != GST_FLOW_OK)
     goto done;
 
-  if (pad_bytes) {
-    if ((res = gst_avi_mux_send_pad_data (avimux, pad_bytes)) != GST_FLOW_OK)
-      goto done;
-  }
-
   /* if any push above fails, we're in trouble with file consistency anyway */
   avimux->total_data += total_size;
   avimux->idx_offset += total_size;
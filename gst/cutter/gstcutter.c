@@ -42,6 +42,27 @@
  * </listitem>
  * </itemizedlist>
  *
+ * The messages for the end of silence (with "above" %TRUE) also carry the
+ * statistics of the silence that just ended:
+ * <itemizedlist>
+ * <listitem>
+ *   <para>
+ *   #GstClockTime
+ *   <classname>&quot;silence-duration&quot;</classname>:
+ *   the length of the silence, from the message that started it.
+ *   </para>
+ * </listitem>
+ * <listitem>
+ *   <para>
+ *   #GstClockTime
+ *   <classname>&quot;dropped-duration&quot;</classname>:
+ *   how much of the silence was dropped when #GstCutter:leaky is set.
+ *   </para>
+ * </listitem>
+ * </itemizedlist>
+ * Totals over all silences are available from the #GstCutter:silent-runs
+ * and #GstCutter:silent-time properties.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -91,12 +112,15 @@ enum
   PROP_THRESHOLD_DB,
   PROP_RUN_LENGTH,
   PROP_PRE_LENGTH,
-  PROP_LEAKY
+  PROP_LEAKY,
+  PROP_SILENT_RUNS,
+  PROP_SILENT_TIME
 };
 
 #define gst_cutter_parent_class parent_class
 G_DEFINE_TYPE (GstCutter, gst_cutter, GST_TYPE_ELEMENT);
 
+static void gst_cutter_finalize (GObject * object);
 static void gst_cutter_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_cutter_get_property (GObject * object, guint prop_id,
@@ -116,6 +140,7 @@ gst_cutter_class_init (GstCutterClass * klass)
   gobject_class = (GObjectClass *) klass;
   element_class = (GstElementClass *) klass;
 
+  gobject_class->finalize = gst_cutter_finalize;
   gobject_class->set_property = gst_cutter_set_property;
   gobject_class->get_property = gst_cutter_get_property;
 
@@ -141,6 +166,28 @@ gst_cutter_class_init (GstCutterClass * klass)
       g_param_spec_boolean ("leaky", "Leaky",
           "do we leak buffers when below threshold ?",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstCutter:silent-runs:
+   *
+   * The number of silences that have ended so far.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_SILENT_RUNS,
+      g_param_spec_uint ("silent-runs", "Silent runs",
+          "Number of silences that have ended", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstCutter:silent-time:
+   *
+   * The total length of the silences that have ended so far.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_SILENT_TIME,
+      g_param_spec_uint64 ("silent-time", "Silent time",
+          "Total length of the silences that have ended (in nanoseconds)",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   GST_DEBUG_CATEGORY_INIT (cutter_debug, "cutter", 0, "Audio cutting");
 
@@ -177,8 +224,25 @@ gst_cutter_init (GstCutter * filter)
 
   filter->pre_length = CUTTER_DEFAULT_PRE_LENGTH;
   filter->pre_run_length = 0 * GST_SECOND;
-  filter->pre_buffer = NULL;
+  g_queue_init (&filter->pre_buffer);
   filter->leaky = FALSE;
+
+  filter->silence_duration = 0;
+  filter->dropped_duration = 0;
+  filter->silent_runs = 0;
+  filter->silent_time = 0;
+}
+
+static void
+gst_cutter_finalize (GObject * object)
+{
+  GstCutter *filter = GST_CUTTER (object);
+  GstBuffer *prebuf;
+
+  while ((prebuf = g_queue_pop_head (&filter->pre_buffer)))
+    gst_buffer_unref (prebuf);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static GstMessage *
@@ -190,32 +254,33 @@ gst_cutter_message_new (GstCutter * c, gboolean above, GstClockTime timestamp)
       "above", G_TYPE_BOOLEAN, above,
       "timestamp", GST_TYPE_CLOCK_TIME, timestamp, NULL);
 
+  /* the silence that just ended */
+  if (above)
+    gst_structure_set (s,
+        "silence-duration", GST_TYPE_CLOCK_TIME, c->silence_duration,
+        "dropped-duration", GST_TYPE_CLOCK_TIME, c->dropped_duration, NULL);
+
   return gst_message_new_element (GST_OBJECT (c), s);
 }
 
 /* Calculate the Normalized Cumulative Square over a buffer of the given type
- * and over all channels combined */
+ * and over all channels combined. The square of a sample fits in 32 bits and
+ * the sum in 64 bits, so it is exact without converting every sample to a
+ * double */
 
 #define DEFINE_CUTTER_CALCULATOR(TYPE, RESOLUTION)                            \
 static void inline                                                            \
 gst_cutter_calculate_##TYPE (TYPE * in, guint num,                            \
                             double *NCS)                                      \
 {                                                                             \
-  register int j;                                                             \
-  double squaresum = 0.0;           /* square sum of the integer samples */   \
-  register double square = 0.0;     /* Square */                              \
+  guint j;                                                                    \
+  gint64 squaresum = 0;             /* square sum of the integer samples */   \
   gdouble normalizer;               /* divisor to get a [-1.0, 1.0] range */  \
                                                                               \
-  *NCS = 0.0;                       /* Normalized Cumulative Square */        \
-                                                                              \
   normalizer = (double) (1 << (RESOLUTION * 2));                              \
                                                                               \
   for (j = 0; j < num; j++)                                                   \
-  {                                                                           \
-    square = ((double) in[j]) * in[j];                                        \
-    squaresum += square;                                                      \
-  }                                                                           \
-                                                                              \
+    squaresum += (gint32) in[j] * in[j];                                      \
                                                                               \
   *NCS = squaresum / normalizer;                                              \
 }
@@ -343,20 +408,25 @@ gst_cutter_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
           gst_cutter_message_new (filter, FALSE, GST_BUFFER_TIMESTAMP (buf));
       GST_DEBUG_OBJECT (filter, "signaling CUT_STOP");
       gst_element_post_message (GST_ELEMENT (filter), m);
+      filter->silence_duration = 0;
+      filter->dropped_duration = 0;
     } else {
       gint count = 0;
       GstMessage *m =
           gst_cutter_message_new (filter, TRUE, GST_BUFFER_TIMESTAMP (buf));
 
-      GST_DEBUG_OBJECT (filter, "signaling CUT_START");
+      GST_DEBUG_OBJECT (filter, "signaling CUT_START after %" GST_TIME_FORMAT
+          " of silence", GST_TIME_ARGS (filter->silence_duration));
       gst_element_post_message (GST_ELEMENT (filter), m);
+      GST_OBJECT_LOCK (filter);
+      filter->silent_runs++;
+      filter->silent_time += filter->silence_duration;
+      GST_OBJECT_UNLOCK (filter);
       /* first of all, flush current buffer */
       GST_DEBUG_OBJECT (filter, "flushing buffer of length %" GST_TIME_FORMAT,
           GST_TIME_ARGS (filter->pre_run_length));
 
-      while (filter->pre_buffer) {
-        prebuf = (g_list_first (filter->pre_buffer))->data;
-        filter->pre_buffer = g_list_remove (filter->pre_buffer, prebuf);
+      while ((prebuf = g_queue_pop_head (&filter->pre_buffer))) {
         gst_pad_push (filter->srcpad, prebuf);
         ++count;
       }
@@ -367,27 +437,29 @@ gst_cutter_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   /* now check if we have to send the new buffer to the internal buffer cache
    * or to the srcpad */
   if (filter->silent) {
-    filter->pre_buffer = g_list_append (filter->pre_buffer, buf);
+    g_queue_push_tail (&filter->pre_buffer, buf);
     filter->pre_run_length += gst_guint64_to_gdouble (duration);
+    filter->silence_duration += duration;
 
     while (filter->pre_run_length > filter->pre_length) {
       GstClockTime pduration;
       gsize psize;
 
-      prebuf = (g_list_first (filter->pre_buffer))->data;
+      prebuf = g_queue_pop_head (&filter->pre_buffer);
       g_assert (GST_IS_BUFFER (prebuf));
 
       psize = gst_buffer_get_size (prebuf);
       pduration = gst_util_uint64_scale (psize / bpf, GST_SECOND, rate);
 
-      filter->pre_buffer = g_list_remove (filter->pre_buffer, prebuf);
       filter->pre_run_length -= gst_guint64_to_gdouble (pduration);
 
       /* only pass buffers if we don't leak */
-      if (!filter->leaky)
+      if (!filter->leaky) {
         ret = gst_pad_push (filter->srcpad, prebuf);
-      else
+      } else {
         gst_buffer_unref (prebuf);
+        filter->dropped_duration += pduration;
+      }
     }
   } else
     ret = gst_pad_push (filter->srcpad, buf);
@@ -468,6 +540,16 @@ gst_cutter_get_property (GObject * object, guint prop_id,
     case PROP_LEAKY:
       g_value_set_boolean (value, filter->leaky);
       break;
+    case PROP_SILENT_RUNS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->silent_runs);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    case PROP_SILENT_TIME:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint64 (value, filter->silent_time);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -60,9 +60,14 @@ struct _GstCutter
 
   double pre_length;            /* how long can the pre-record buffer be ? */
   double pre_run_length;        /* how long is it currently ? */
-  GList *pre_buffer;            /* list of GstBuffers in pre-record buffer */
+  GQueue pre_buffer;            /* GstBuffers in pre-record buffer */
   gboolean leaky;               /* do we leak an overflowing prebuffer ? */
 
+  GstClockTime silence_duration;        /* length of the current silence */
+  GstClockTime dropped_duration;        /* how much of it was leaked */
+  guint silent_runs;            /* number of silences that have ended */
+  GstClockTime silent_time;     /* total length of those silences */
+
   GstAudioInfo info;
 };
 
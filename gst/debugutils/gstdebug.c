@@ -36,6 +36,7 @@ GType gst_push_file_src_get_type (void);
 GType gst_gst_negotiation_get_type (void);
 */
 GType gst_cpu_report_get_type (void);
+GType gst_latency_report_get_type (void);
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -62,7 +63,9 @@ plugin_init (GstPlugin * plugin)
           gst_caps_debug_get_type ())
 #endif
       || !gst_element_register (plugin, "cpureport", GST_RANK_NONE,
-          gst_cpu_report_get_type ()))
+          gst_cpu_report_get_type ())
+      || !gst_element_register (plugin, "latencyreport", GST_RANK_NONE,
+          gst_latency_report_get_type ()))
 
     return FALSE;
 
@@ -0,0 +1,491 @@
+/* GStreamer Latency Report Element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-latencyreport
+ *
+ * The latencyreport element passes data through unchanged and collects
+ * statistics about the buffers flowing through it. Every
+ * #GstLatencyReport:interval an element message containing a
+ * "latency-report" structure is posted on the bus with the following fields:
+ * <itemizedlist>
+ * <listitem>
+ *   <para>
+ *   #guint64
+ *   <classname>&quot;buffers&quot;</classname>,
+ *   #guint64
+ *   <classname>&quot;bytes&quot;</classname>:
+ *   the amount of data seen in the interval.
+ *   </para>
+ * </listitem>
+ * <listitem>
+ *   <para>
+ *   #guint64
+ *   <classname>&quot;processing-p50&quot;</classname>,
+ *   <classname>&quot;processing-p99&quot;</classname>,
+ *   <classname>&quot;processing-max&quot;</classname>:
+ *   the time in nanoseconds it took downstream to return from a push. Put
+ *   one element before and one after a stage to see what the stage costs.
+ *   </para>
+ * </listitem>
+ * <listitem>
+ *   <para>
+ *   #guint64
+ *   <classname>&quot;jitter-p50&quot;</classname>,
+ *   <classname>&quot;jitter-p99&quot;</classname>,
+ *   <classname>&quot;jitter-max&quot;</classname>:
+ *   the variation in nanoseconds of the time between two consecutive buffers.
+ *   </para>
+ * </listitem>
+ * <listitem>
+ *   <para>
+ *   #guint64
+ *   <classname>&quot;latency-p50&quot;</classname>,
+ *   <classname>&quot;latency-p99&quot;</classname>,
+ *   <classname>&quot;latency-max&quot;</classname>:
+ *   how far in nanoseconds the running time of the buffers lags behind the
+ *   clock running time. Placed after a queue the growth of this value
+ *   compared to an element before the queue is the time spent in the queue.
+ *   Only available when the element has a clock, zero otherwise.
+ *   </para>
+ * </listitem>
+ * <listitem>
+ *   <para>
+ *   #guint64
+ *   <classname>&quot;size-p50&quot;</classname>,
+ *   <classname>&quot;size-p99&quot;</classname>,
+ *   <classname>&quot;size-max&quot;</classname>:
+ *   the buffer sizes in bytes.
+ *   </para>
+ * </listitem>
+ * </itemizedlist>
+ *
+ * Percentiles are taken from histograms with four buckets per power of two,
+ * so they are accurate to within 25% of the reported value.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 -m videotestsrc is-live=true ! latencyreport name=before ! videoconvert ! latencyreport name=after ! queue ! xvimagesink
+ * ]| Report the cost of videoconvert and the time buffers spend in the queue.
+ * </refsect2>
+ *
+ * Since: 1.4
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "latencyreport.h"
+
+GST_DEBUG_CATEGORY_STATIC (latency_report_debug);
+#define GST_CAT_DEFAULT latency_report_debug
+
+enum
+{
+  ARG_0,
+  ARG_INTERVAL
+};
+
+#define DEFAULT_INTERVAL        GST_SECOND
+
+GstStaticPadTemplate latency_report_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+GstStaticPadTemplate latency_report_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static void gst_latency_report_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_latency_report_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static GstFlowReturn gst_latency_report_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buf);
+static gboolean gst_latency_report_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
+static GstStateChangeReturn gst_latency_report_change_state (GstElement *
+    element, GstStateChange transition);
+
+#define gst_latency_report_parent_class parent_class
+G_DEFINE_TYPE (GstLatencyReport, gst_latency_report, GST_TYPE_ELEMENT);
+
+static void
+gst_latency_report_class_init (GstLatencyReportClass * g_class)
+{
+  GstElementClass *element_class;
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (g_class);
+  element_class = GST_ELEMENT_CLASS (g_class);
+
+  gobject_class->set_property = gst_latency_report_set_property;
+  gobject_class->get_property = gst_latency_report_get_property;
+
+  /**
+   * GstLatencyReport:interval:
+   *
+   * Time in nanoseconds between two reports.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_INTERVAL,
+      g_param_spec_uint64 ("interval", "Interval",
+          "Time between reports in nanoseconds", 1, G_MAXUINT64,
+          DEFAULT_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&latency_report_sink_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&latency_report_src_template));
+
+  gst_element_class_set_static_metadata (element_class, "Latency report",
+      "Testing",
+      "Periodically report processing time, jitter and latency statistics",
+      "GStreamer maintainers <gstreamer-devel@lists.sourceforge.net>");
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_latency_report_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (latency_report_debug, "latencyreport", 0,
+      "latencyreport element");
+}
+
+static void
+gst_latency_report_histogram_reset (GstLatencyReportHistogram * hist)
+{
+  memset (hist, 0, sizeof (GstLatencyReportHistogram));
+}
+
+static void
+gst_latency_report_histogram_add (GstLatencyReportHistogram * hist,
+    guint64 value)
+{
+  guint idx;
+
+  if (value < 4) {
+    idx = value;
+  } else {
+    guint msb = g_bit_storage (value) - 1;
+
+    idx = (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+  }
+  hist->bins[idx]++;
+  hist->count++;
+  if (value > hist->max)
+    hist->max = value;
+}
+
+/* returns the upper bound of the bucket holding the @percent percentile */
+static guint64
+gst_latency_report_histogram_percentile (GstLatencyReportHistogram * hist,
+    guint percent)
+{
+  guint64 target, seen = 0;
+  guint idx;
+
+  if (hist->count == 0)
+    return 0;
+
+  target = (hist->count * percent + 99) / 100;
+
+  for (idx = 0; idx < GST_LATENCY_REPORT_N_BINS; idx++) {
+    seen += hist->bins[idx];
+    if (seen >= target)
+      break;
+  }
+
+  if (idx >= 4) {
+    guint shift = idx / 4 - 1;
+    guint64 upper;
+
+    upper = (((guint64) (4 + idx % 4 + 1)) << shift) - 1;
+    return MIN (upper, hist->max);
+  }
+  return idx;
+}
+
+static void
+gst_latency_report_reset_stats (GstLatencyReport * filter)
+{
+  filter->bytes = 0;
+  gst_latency_report_histogram_reset (&filter->processing);
+  gst_latency_report_histogram_reset (&filter->jitter);
+  gst_latency_report_histogram_reset (&filter->latency);
+  gst_latency_report_histogram_reset (&filter->size);
+}
+
+static void
+gst_latency_report_reset (GstLatencyReport * filter)
+{
+  gst_segment_init (&filter->segment, GST_FORMAT_UNDEFINED);
+  filter->last_arrival = GST_CLOCK_TIME_NONE;
+  filter->last_delta = GST_CLOCK_TIME_NONE;
+  filter->last_report = GST_CLOCK_TIME_NONE;
+  gst_latency_report_reset_stats (filter);
+}
+
+static void
+gst_latency_report_init (GstLatencyReport * filter)
+{
+  filter->sinkpad =
+      gst_pad_new_from_static_template (&latency_report_sink_template,
+      "sink");
+  gst_pad_set_chain_function (filter->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_latency_report_chain));
+  gst_pad_set_event_function (filter->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_latency_report_sink_event));
+  GST_PAD_SET_PROXY_CAPS (filter->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (filter->sinkpad);
+  GST_PAD_SET_PROXY_SCHEDULING (filter->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (filter), filter->sinkpad);
+
+  filter->srcpad =
+      gst_pad_new_from_static_template (&latency_report_src_template, "src");
+  GST_PAD_SET_PROXY_CAPS (filter->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION (filter->srcpad);
+  GST_PAD_SET_PROXY_SCHEDULING (filter->srcpad);
+  gst_element_add_pad (GST_ELEMENT (filter), filter->srcpad);
+
+  filter->interval = DEFAULT_INTERVAL;
+
+  gst_latency_report_reset (filter);
+}
+
+static void
+gst_latency_report_post_report (GstLatencyReport * filter)
+{
+  GstStructure *s;
+
+  if (filter->size.count == 0)
+    return;
+
+  s = gst_structure_new ("latency-report",
+      "buffers", G_TYPE_UINT64, filter->size.count,
+      "bytes", G_TYPE_UINT64, filter->bytes,
+      "processing-p50", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->processing, 50),
+      "processing-p99", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->processing, 99),
+      "processing-max", G_TYPE_UINT64, filter->processing.max,
+      "jitter-p50", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->jitter, 50),
+      "jitter-p99", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->jitter, 99),
+      "jitter-max", G_TYPE_UINT64, filter->jitter.max,
+      "latency-p50", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->latency, 50),
+      "latency-p99", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->latency, 99),
+      "latency-max", G_TYPE_UINT64, filter->latency.max,
+      "size-p50", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->size, 50),
+      "size-p99", G_TYPE_UINT64,
+      gst_latency_report_histogram_percentile (&filter->size, 99),
+      "size-max", G_TYPE_UINT64, filter->size.max, NULL);
+
+  GST_LOG_OBJECT (filter, "posting %" GST_PTR_FORMAT, s);
+
+  gst_element_post_message (GST_ELEMENT_CAST (filter),
+      gst_message_new_element (GST_OBJECT_CAST (filter), s));
+
+  gst_latency_report_reset_stats (filter);
+}
+
+/* how far the running time of @buf lags behind the clock */
+static gboolean
+gst_latency_report_get_latency (GstLatencyReport * filter, GstBuffer * buf,
+    GstClockTime * latency)
+{
+  GstClock *clock;
+  GstClockTime ts, running_time, base_time, now;
+
+  ts = GST_BUFFER_PTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_DTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts) ||
+      filter->segment.format != GST_FORMAT_TIME)
+    return FALSE;
+
+  running_time = gst_segment_to_running_time (&filter->segment,
+      GST_FORMAT_TIME, ts);
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return FALSE;
+
+  GST_OBJECT_LOCK (filter);
+  if ((clock = GST_ELEMENT_CLOCK (filter)) == NULL) {
+    GST_OBJECT_UNLOCK (filter);
+    return FALSE;
+  }
+  gst_object_ref (clock);
+  base_time = GST_ELEMENT_CAST (filter)->base_time;
+  GST_OBJECT_UNLOCK (filter);
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  if (now < base_time)
+    return FALSE;
+  now -= base_time;
+
+  *latency = now > running_time ? now - running_time : 0;
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_latency_report_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstLatencyReport *filter = GST_LATENCY_REPORT (parent);
+  GstClockTime arrival, done, latency, interval;
+  GstFlowReturn ret;
+  gsize size;
+
+  arrival = gst_util_get_timestamp ();
+  size = gst_buffer_get_size (buf);
+
+  if (GST_CLOCK_TIME_IS_VALID (filter->last_arrival)) {
+    GstClockTime delta = arrival - filter->last_arrival;
+
+    if (GST_CLOCK_TIME_IS_VALID (filter->last_delta)) {
+      gst_latency_report_histogram_add (&filter->jitter,
+          delta > filter->last_delta ? delta - filter->last_delta :
+          filter->last_delta - delta);
+    }
+    filter->last_delta = delta;
+  }
+  filter->last_arrival = arrival;
+
+  if (gst_latency_report_get_latency (filter, buf, &latency))
+    gst_latency_report_histogram_add (&filter->latency, latency);
+
+  gst_latency_report_histogram_add (&filter->size, size);
+  filter->bytes += size;
+
+  ret = gst_pad_push (filter->srcpad, buf);
+
+  done = gst_util_get_timestamp ();
+  gst_latency_report_histogram_add (&filter->processing, done - arrival);
+
+  GST_OBJECT_LOCK (filter);
+  interval = filter->interval;
+  GST_OBJECT_UNLOCK (filter);
+
+  if (!GST_CLOCK_TIME_IS_VALID (filter->last_report)) {
+    filter->last_report = done;
+  } else if (done - filter->last_report >= interval) {
+    gst_latency_report_post_report (filter);
+    filter->last_report = done;
+  }
+
+  return ret;
+}
+
+static gboolean
+gst_latency_report_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstLatencyReport *filter = GST_LATENCY_REPORT (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &filter->segment);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_segment_init (&filter->segment, GST_FORMAT_UNDEFINED);
+      filter->last_arrival = GST_CLOCK_TIME_NONE;
+      filter->last_delta = GST_CLOCK_TIME_NONE;
+      break;
+    case GST_EVENT_EOS:
+      /* report what was collected since the last report */
+      gst_latency_report_post_report (filter);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static GstStateChangeReturn
+gst_latency_report_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstLatencyReport *filter = GST_LATENCY_REPORT (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_latency_report_reset (filter);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  return ret;
+}
+
+static void
+gst_latency_report_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstLatencyReport *filter;
+
+  filter = GST_LATENCY_REPORT (object);
+
+  switch (prop_id) {
+    case ARG_INTERVAL:
+      GST_OBJECT_LOCK (filter);
+      filter->interval = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_latency_report_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstLatencyReport *filter;
+
+  filter = GST_LATENCY_REPORT (object);
+
+  switch (prop_id) {
+    case ARG_INTERVAL:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint64 (value, filter->interval);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
@@ -0,0 +1,79 @@
+/* GStreamer Latency Report Element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_LATENCY_REPORT_H__
+#define __GST_LATENCY_REPORT_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_LATENCY_REPORT \
+  (gst_latency_report_get_type())
+#define GST_LATENCY_REPORT(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_LATENCY_REPORT,GstLatencyReport))
+#define GST_LATENCY_REPORT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_LATENCY_REPORT,GstLatencyReportClass))
+#define GST_IS_LATENCY_REPORT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_LATENCY_REPORT))
+#define GST_IS_LATENCY_REPORT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_LATENCY_REPORT))
+typedef struct _GstLatencyReport GstLatencyReport;
+typedef struct _GstLatencyReportClass GstLatencyReportClass;
+
+/* log-linear buckets: 4 per power of two, covers the full guint64 range */
+#define GST_LATENCY_REPORT_N_BINS 256
+
+typedef struct
+{
+  guint64 count;
+  guint64 max;
+  guint32 bins[GST_LATENCY_REPORT_N_BINS];
+} GstLatencyReportHistogram;
+
+struct _GstLatencyReport
+{
+  GstElement element;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  GstSegment segment;
+
+  GstClockTime last_arrival;
+  GstClockTime last_delta;
+  GstClockTime last_report;
+  guint64 bytes;
+
+  GstLatencyReportHistogram processing;
+  GstLatencyReportHistogram jitter;
+  GstLatencyReportHistogram latency;
+  GstLatencyReportHistogram size;
+
+  /* properties, protected by the object lock */
+  GstClockTime interval;
+};
+
+struct _GstLatencyReportClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_latency_report_get_type (void);
+
+G_END_DECLS
+#endif /* __GST_LATENCY_REPORT_H__ */
@@ -65,6 +65,8 @@ GST_DEBUG_CATEGORY_STATIC (deinterlace_debug);
 #define DEFAULT_LOCKING         GST_DEINTERLACE_LOCKING_NONE
 #define DEFAULT_IGNORE_OBSCURE  TRUE
 #define DEFAULT_DROP_ORPHANS    TRUE
+#define DEFAULT_N_THREADS       1
+#define DEFAULT_COMB_THRESHOLD  0
 
 enum
 {
@@ -76,6 +78,8 @@ enum
   PROP_LOCKING,
   PROP_IGNORE_OBSCURE,
   PROP_DROP_ORPHANS,
+  PROP_N_THREADS,
+  PROP_COMB_THRESHOLD,
   PROP_LAST
 };
 
@@ -428,6 +432,9 @@ gst_deinterlace_set_method (GstDeinterlace * self, GstDeinterlaceMethods method)
 
   self->method = g_object_new (method_type, "name", "method", NULL);
   self->method_id = method;
+  gst_deinterlace_method_set_n_threads (self->method, self->n_threads);
+  gst_deinterlace_method_set_comb_threshold (self->method,
+      self->comb_threshold);
 
   gst_object_set_parent (GST_OBJECT (self->method), GST_OBJECT (self));
 #if 0
@@ -664,6 +671,38 @@ gst_deinterlace_class_init (GstDeinterlaceClass * klass)
           "active locking mode.", DEFAULT_DROP_ORPHANS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDeinterlace:n-threads:
+   *
+   * The number of threads that deinterlace a frame. Every thread handles a
+   * consecutive band of lines of the output frame.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to deinterlace a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDeinterlace:comb-threshold:
+   *
+   * Check every interpolated line for combing before running the method on
+   * it. Blocks where no pixel of the other field is brighter or darker than
+   * both lines around it by more than this threshold are static or
+   * progressive and are woven instead. 0 always runs the method.
+   *
+   * This is only done by the simple methods (all but tomsmocomp and
+   * greedyh).
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_COMB_THRESHOLD,
+      g_param_spec_uint ("comb-threshold", "Comb threshold",
+          "Weave blocks that do not comb by more than this (0 = disabled)",
+          0, 255, DEFAULT_COMB_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class->change_state =
       GST_DEBUG_FUNCPTR (gst_deinterlace_change_state);
 }
@@ -720,6 +759,8 @@ gst_deinterlace_init (GstDeinterlace * self)
 
   self->mode = DEFAULT_MODE;
   self->user_set_method_id = DEFAULT_METHOD;
+  self->n_threads = DEFAULT_N_THREADS;
+  self->comb_threshold = DEFAULT_COMB_THRESHOLD;
   gst_video_info_init (&self->vinfo);
   gst_deinterlace_set_method (self, self->user_set_method_id);
   self->fields = DEFAULT_FIELDS;
@@ -740,20 +781,45 @@ gst_deinterlace_init (GstDeinterlace * self)
   gst_deinterlace_reset (self);
 }
 
+/* A mapped frame that can be shared by several entries of the field history,
+ * so that both fields of a buffer use the same mapping. The frame is unmapped
+ * when the last field referencing it is freed. */
+typedef struct
+{
+  GstVideoFrame frame;
+  gint ref_count;
+} GstDeinterlaceMappedFrame;
+
 static GstVideoFrame *
 gst_video_frame_new_and_map (GstVideoInfo * vinfo, GstBuffer * buffer,
     GstMapFlags flags)
 {
-  GstVideoFrame *frame = g_malloc0 (sizeof (GstVideoFrame));
-  gst_video_frame_map (frame, vinfo, buffer, flags);
+  GstDeinterlaceMappedFrame *mapped = g_slice_new0 (GstDeinterlaceMappedFrame);
+
+  mapped->ref_count = 1;
+  gst_video_frame_map (&mapped->frame, vinfo, buffer, flags);
+  return &mapped->frame;
+}
+
+static GstVideoFrame *
+gst_video_frame_ref_mapped (GstVideoFrame * frame)
+{
+  GstDeinterlaceMappedFrame *mapped = (GstDeinterlaceMappedFrame *) frame;
+
+  mapped->ref_count++;
   return frame;
 }
 
 static void
 gst_video_frame_unmap_and_free (GstVideoFrame * frame)
 {
-  gst_video_frame_unmap (frame);
-  g_free (frame);
+  GstDeinterlaceMappedFrame *mapped = (GstDeinterlaceMappedFrame *) frame;
+
+  if (--mapped->ref_count > 0)
+    return;
+
+  gst_video_frame_unmap (&mapped->frame);
+  g_slice_free (GstDeinterlaceMappedFrame, mapped);
 }
 
 static void
@@ -902,6 +968,17 @@ gst_deinterlace_set_property (GObject * object, guint prop_id,
     case PROP_DROP_ORPHANS:
       self->drop_orphans = g_value_get_boolean (value);
       break;
+    case PROP_N_THREADS:
+      self->n_threads = g_value_get_uint (value);
+      if (self->method)
+        gst_deinterlace_method_set_n_threads (self->method, self->n_threads);
+      break;
+    case PROP_COMB_THRESHOLD:
+      self->comb_threshold = g_value_get_uint (value);
+      if (self->method)
+        gst_deinterlace_method_set_comb_threshold (self->method,
+            self->comb_threshold);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -938,6 +1015,12 @@ gst_deinterlace_get_property (GObject * object, guint prop_id,
     case PROP_DROP_ORPHANS:
       g_value_set_boolean (value, self->drop_orphans);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->n_threads);
+      break;
+    case PROP_COMB_THRESHOLD:
+      g_value_set_uint (value, self->comb_threshold);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -1151,7 +1234,7 @@ gst_deinterlace_push_history (GstDeinterlace * self, GstBuffer * buffer)
   }
 
   field1 = frame;
-  field2 = gst_video_frame_new_and_map (&self->vinfo, buffer, GST_MAP_READ);
+  field2 = gst_video_frame_ref_mapped (frame);
   if (field_layout == GST_DEINTERLACE_LAYOUT_TFF) {
     GST_DEBUG_OBJECT (self, "Top field first");
     field1_flags = PICTURE_INTERLACED_TOP;
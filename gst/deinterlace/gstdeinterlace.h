@@ -175,6 +175,8 @@ struct _GstDeinterlace
   GstDeinterlaceLocking locking;
   gint low_latency;
   gboolean drop_orphans;
+  guint n_threads;
+  guint comb_threshold;
   gboolean ignore_obscure;
   gboolean pattern_lock;
   gboolean pattern_refresh;
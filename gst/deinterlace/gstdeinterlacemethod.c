@@ -177,9 +177,24 @@ gst_deinterlace_method_setup_impl (GstDeinterlaceMethod * self,
   }
 }
 
+static void
+gst_deinterlace_method_finalize (GObject * object)
+{
+  GstDeinterlaceMethod *self = GST_DEINTERLACE_METHOD (object);
+
+  if (self->workers)
+    gst_workers_free (self->workers);
+
+  G_OBJECT_CLASS (gst_deinterlace_method_parent_class)->finalize (object);
+}
+
 static void
 gst_deinterlace_method_class_init (GstDeinterlaceMethodClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_deinterlace_method_finalize;
+
   klass->setup = gst_deinterlace_method_setup_impl;
   klass->supported = gst_deinterlace_method_supported_impl;
 }
@@ -188,6 +203,7 @@ static void
 gst_deinterlace_method_init (GstDeinterlaceMethod * self)
 {
   self->vinfo = NULL;
+  self->n_threads = 1;
 }
 
 void
@@ -196,10 +212,53 @@ gst_deinterlace_method_deinterlace_frame (GstDeinterlaceMethod * self,
     GstVideoFrame * outframe, int cur_field_idx)
 {
   g_assert (self->deinterlace_frame != NULL);
+
+  gst_workers_ensure (&self->workers, g_atomic_int_get (&self->n_threads));
+
   self->deinterlace_frame (self, history, history_count, outframe,
       cur_field_idx);
 }
 
+/* can be called from any thread, takes effect with the next frame */
+void
+gst_deinterlace_method_set_n_threads (GstDeinterlaceMethod * self,
+    guint n_threads)
+{
+  g_return_if_fail (n_threads > 0);
+
+  g_atomic_int_set (&self->n_threads, n_threads);
+}
+
+/* can be called from any thread, takes effect with the next frame */
+void
+gst_deinterlace_method_set_comb_threshold (GstDeinterlaceMethod * self,
+    guint threshold)
+{
+  g_atomic_int_set (&self->comb_threshold, threshold);
+}
+
+/* call @func for every slice of the work on the workers of @self, or
+ * once in the calling thread when there is only one thread. Methods doing
+ * this must produce the same output for any number of slices. */
+void
+gst_deinterlace_method_run_slices (GstDeinterlaceMethod * self,
+    GstWorkFunc func, gpointer data)
+{
+  if (self->workers)
+    gst_workers_run (self->workers, func, data);
+  else
+    func (data, 0, 1);
+}
+
+/* the range of lines [@start, @end) out of @n_lines that @slice handles */
+void
+gst_deinterlace_method_get_slice_lines (guint slice, guint n_slices,
+    gint n_lines, gint * start, gint * end)
+{
+  *start = ((guint64) n_lines * slice) / n_slices;
+  *end = ((guint64) n_lines * (slice + 1)) / n_slices;
+}
+
 gint
 gst_deinterlace_method_get_fields_required (GstDeinterlaceMethod * self)
 {
@@ -304,54 +363,159 @@ gst_deinterlace_simple_method_copy_scanline_packed (GstDeinterlaceSimpleMethod *
   memcpy (out, scanlines->m0, stride);
 }
 
-static void
-gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
-    method, const GstDeinterlaceField * history, guint history_count,
-    GstVideoFrame * outframe, gint cur_field_idx)
+/* the frames and scanline functions of one output frame, shared by all
+ * slices */
+typedef struct
 {
-  GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
-  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  GstDeinterlaceScanlineData scanlines;
+  GstDeinterlaceSimpleMethod *self;
+  GstVideoFrame *dest;
+  const GstVideoFrame *frame0, *frame1, *frame2, *framep;
   guint cur_field_flags;
-  gint i;
-  gint frame_height, frame_width;
-  GstVideoFrame *framep, *frame0, *frame1, *frame2;
+  guint comb_threshold;
 
-  g_assert (self->interpolate_scanline_packed != NULL);
-  g_assert (self->copy_scanline_packed != NULL);
+  gint n_planes;
+  gint width[3];
+  gint height[3];
+  GstDeinterlaceSimpleMethodFunction copy_scanline[3];
+  GstDeinterlaceSimpleMethodFunction interpolate_scanline[3];
+} GstDeinterlaceSimpleMethodFrame;
 
-  frame_height = GST_VIDEO_FRAME_HEIGHT (outframe);
-  frame_width = GST_VIDEO_FRAME_PLANE_STRIDE (outframe, 0);
-
-  frame0 = history[cur_field_idx].frame;
-  frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (frame0, 0));
-  cur_field_flags = history[cur_field_idx].flags;
-
-  framep = (cur_field_idx > 0 ? history[cur_field_idx - 1].frame : NULL);
-  if (framep)
-    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (framep, 0));
+static void
+gst_deinterlace_simple_method_init_frame (GstDeinterlaceSimpleMethodFrame * f,
+    GstDeinterlaceSimpleMethod * self, const GstDeinterlaceField * history,
+    guint history_count, GstVideoFrame * outframe, gint cur_field_idx)
+{
+  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
 
   g_assert (dm_class->fields_required <= 4);
 
-  frame1 =
+  f->self = self;
+  f->dest = outframe;
+  f->cur_field_flags = history[cur_field_idx].flags;
+  f->comb_threshold =
+      g_atomic_int_get (&GST_DEINTERLACE_METHOD (self)->comb_threshold);
+
+  f->framep = (cur_field_idx > 0 ? history[cur_field_idx - 1].frame : NULL);
+  f->frame0 = history[cur_field_idx].frame;
+  f->frame1 =
       (cur_field_idx + 1 <
       history_count ? history[cur_field_idx + 1].frame : NULL);
-  if (frame1)
-    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (frame1, 0));
-
-  frame2 =
+  f->frame2 =
       (cur_field_idx + 2 <
       history_count ? history[cur_field_idx + 2].frame : NULL);
-  if (frame2)
-    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (frame2, 0));
+
+  f->n_planes = 0;
+}
+
+/* size in bytes of the blocks that are checked for combing */
+#define COMB_BLOCK_SIZE 32
+
+/* a pixel of the other field combs if it is brighter or darker than both
+ * lines of the current field around it by more than @threshold */
+static gboolean
+gst_deinterlace_simple_method_block_is_combed (const guint8 * t,
+    const guint8 * m, const guint8 * b, gint size, gint threshold)
+{
+  gint i, dt, db;
+
+  for (i = 0; i < size; i++) {
+    dt = t[i] - m[i];
+    db = b[i] - m[i];
+    if ((dt > threshold && db > threshold) ||
+        (dt < -threshold && db < -threshold))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+#define OFFSET_LINE(l) (block.l = scanlines->l ? scanlines->l + offset : NULL)
+
+/* interpolate only the runs of combed blocks of a line and weave the rest.
+ * The scanline functions treat every byte of a line on its own, so they can
+ * be called on a part of it. */
+static void
+    gst_deinterlace_simple_method_interpolate_combed
+    (GstDeinterlaceSimpleMethod * self, guint8 * out,
+    const GstDeinterlaceScanlineData * scanlines, gint size, gint threshold,
+    GstDeinterlaceSimpleMethodFunction interpolate_scanline)
+{
+  GstDeinterlaceScanlineData block;
+  gint start, end, offset, len;
+  gboolean combed, next = FALSE;
+
+  len = MIN (COMB_BLOCK_SIZE, size);
+  combed = gst_deinterlace_simple_method_block_is_combed (scanlines->t0,
+      scanlines->m1, scanlines->b0, len, threshold);
+
+  for (start = 0; start < size; start = end) {
+    /* extend the run over all following blocks of the same kind */
+    for (end = start + len; end < size; end += len) {
+      len = MIN (COMB_BLOCK_SIZE, size - end);
+      next = gst_deinterlace_simple_method_block_is_combed (scanlines->t0 + end,
+          scanlines->m1 + end, scanlines->b0 + end, len, threshold);
+      if (next != combed)
+        break;
+    }
+
+    if (combed) {
+      offset = start;
+      OFFSET_LINE (ttp);
+      OFFSET_LINE (tp);
+      OFFSET_LINE (mp);
+      OFFSET_LINE (bp);
+      OFFSET_LINE (bbp);
+      OFFSET_LINE (tt0);
+      OFFSET_LINE (t0);
+      OFFSET_LINE (m0);
+      OFFSET_LINE (b0);
+      OFFSET_LINE (bb0);
+      OFFSET_LINE (tt1);
+      OFFSET_LINE (t1);
+      OFFSET_LINE (m1);
+      OFFSET_LINE (b1);
+      OFFSET_LINE (bb1);
+      OFFSET_LINE (tt2);
+      OFFSET_LINE (t2);
+      OFFSET_LINE (m2);
+      OFFSET_LINE (b2);
+      OFFSET_LINE (bb2);
+      block.bottom_field = scanlines->bottom_field;
+
+      interpolate_scanline (self, out + start, &block, end - start);
+    } else {
+      memcpy (out + start, scanlines->m1 + start, end - start);
+    }
+
+    combed = next;
+  }
+}
+
+#undef OFFSET_LINE
+
+static void
+    gst_deinterlace_simple_method_deinterlace_lines
+    (GstDeinterlaceSimpleMethod * self, GstVideoFrame * dest,
+    const GstVideoFrame * frame0, const GstVideoFrame * frame1,
+    const GstVideoFrame * frame2, const GstVideoFrame * framep,
+    guint cur_field_flags, guint comb_threshold, gint plane, gint frame_width,
+    gint frame_height, gint start, gint end,
+    GstDeinterlaceSimpleMethodFunction copy_scanline,
+    GstDeinterlaceSimpleMethodFunction interpolate_scanline)
+{
+  GstDeinterlaceScanlineData scanlines;
+  gint i;
+
+  g_assert (interpolate_scanline != NULL);
+  g_assert (copy_scanline != NULL);
 
 #define CLAMP_LOW(i) (((i)<0) ? (i+2) : (i))
 #define CLAMP_HI(i) (((i)>=(frame_height)) ? (i-2) : (i))
-#define LINE(x,i) (((guint8*)GST_VIDEO_FRAME_PLANE_DATA((x),0)) + CLAMP_HI(CLAMP_LOW(i)) * \
-    GST_VIDEO_FRAME_PLANE_STRIDE((x),0))
+#define LINE(x,i) (((guint8*)GST_VIDEO_FRAME_PLANE_DATA((x),plane)) + CLAMP_HI(CLAMP_LOW(i)) * \
+    GST_VIDEO_FRAME_PLANE_STRIDE((x),plane))
 #define LINE2(x,i) ((x) ? LINE(x,i) : NULL)
 
-  for (i = 0; i < frame_height; i++) {
+  for (i = start; i < end; i++) {
     memset (&scanlines, 0, sizeof (scanlines));
     scanlines.bottom_field = (cur_field_flags == PICTURE_INTERLACED_BOTTOM);
 
@@ -371,8 +535,7 @@ gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
       scanlines.m2 = LINE2 (frame2, i);
       scanlines.bb2 = LINE2 (frame2, (i + 2 < frame_height ? i + 2 : i));
 
-      self->copy_scanline_packed (self, LINE (outframe, i), &scanlines,
-          frame_width);
+      copy_scanline (self, LINE (dest, i), &scanlines, frame_width);
     } else {
       /* interpolating */
       scanlines.ttp = LINE2 (framep, (i - 2 >= 0) ? i - 2 : i);
@@ -389,14 +552,74 @@ gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
       scanlines.t2 = LINE2 (frame2, i - 1);
       scanlines.b2 = LINE2 (frame2, i + 1);
 
-      self->interpolate_scanline_packed (self, LINE (outframe, i), &scanlines,
-          frame_width);
+      if (comb_threshold > 0 && scanlines.m1 && scanlines.t0 && scanlines.b0)
+        gst_deinterlace_simple_method_interpolate_combed (self, LINE (dest, i),
+            &scanlines, frame_width, comb_threshold, interpolate_scanline);
+      else
+        interpolate_scanline (self, LINE (dest, i), &scanlines, frame_width);
     }
+  }
 #undef LINE
 #undef LINE2
+#undef CLAMP_HI
+#undef CLAMP_LOW
+}
+
+/* every line only depends on the input frames, so each slice handles a band
+ * of every plane */
+static void
+gst_deinterlace_simple_method_deinterlace_slice (gpointer data, guint slice,
+    guint n_slices)
+{
+  GstDeinterlaceSimpleMethodFrame *f = data;
+  gint i, start, end;
+
+  for (i = 0; i < f->n_planes; i++) {
+    gst_deinterlace_method_get_slice_lines (slice, n_slices, f->height[i],
+        &start, &end);
+
+    gst_deinterlace_simple_method_deinterlace_lines (f->self, f->dest,
+        f->frame0, f->frame1, f->frame2, f->framep, f->cur_field_flags,
+        f->comb_threshold, i, f->width[i], f->height[i], start, end,
+        f->copy_scanline[i], f->interpolate_scanline[i]);
   }
 }
 
+static void
+gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
+    method, const GstDeinterlaceField * history, guint history_count,
+    GstVideoFrame * outframe, gint cur_field_idx)
+{
+  GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
+  GstDeinterlaceSimpleMethodFrame f;
+  gint frame_width;
+
+  g_assert (self->interpolate_scanline_packed != NULL);
+  g_assert (self->copy_scanline_packed != NULL);
+
+  gst_deinterlace_simple_method_init_frame (&f, self, history, history_count,
+      outframe, cur_field_idx);
+
+  frame_width = GST_VIDEO_FRAME_PLANE_STRIDE (outframe, 0);
+  frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (f.frame0, 0));
+  if (f.framep)
+    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (f.framep, 0));
+  if (f.frame1)
+    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (f.frame1, 0));
+  if (f.frame2)
+    frame_width = MIN (frame_width, GST_VIDEO_FRAME_PLANE_STRIDE (f.frame2, 0));
+
+  f.n_planes = 1;
+  f.width[0] = frame_width;
+  f.height[0] = GST_VIDEO_FRAME_HEIGHT (outframe);
+  f.copy_scanline[0] = self->copy_scanline_packed;
+  f.interpolate_scanline[0] = self->interpolate_scanline_packed;
+
+  gst_deinterlace_method_run_slices (method,
+      gst_deinterlace_simple_method_deinterlace_slice, &f);
+}
+
+
 static void
     gst_deinterlace_simple_method_interpolate_scanline_planar_y
     (GstDeinterlaceSimpleMethod * self, guint8 * out,
@@ -446,71 +669,17 @@ gst_deinterlace_simple_method_copy_scanline_planar_v (GstDeinterlaceSimpleMethod
 }
 
 static void
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane
-    (GstDeinterlaceSimpleMethod * self, GstVideoFrame * dest,
-    const GstVideoFrame * frame0, const GstVideoFrame * frame1,
-    const GstVideoFrame * frame2, const GstVideoFrame * framep,
-    guint cur_field_flags, gint plane,
+gst_deinterlace_simple_method_add_plane (GstDeinterlaceSimpleMethodFrame * f,
     GstDeinterlaceSimpleMethodFunction copy_scanline,
     GstDeinterlaceSimpleMethodFunction interpolate_scanline)
 {
-  GstDeinterlaceScanlineData scanlines;
-  gint i;
-  gint frame_height, frame_width;
-
-  frame_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, plane);
-  frame_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, plane) *
-      GST_VIDEO_FRAME_COMP_PSTRIDE (dest, plane);
-
-  g_assert (interpolate_scanline != NULL);
-  g_assert (copy_scanline != NULL);
-
-#define LINE(x,i) (((guint8*)GST_VIDEO_FRAME_PLANE_DATA((x),plane)) + CLAMP_HI(CLAMP_LOW(i)) * \
-    GST_VIDEO_FRAME_PLANE_STRIDE((x),plane))
-#define LINE2(x,i) ((x) ? LINE(x,i) : NULL)
-
-  for (i = 0; i < frame_height; i++) {
-    memset (&scanlines, 0, sizeof (scanlines));
-    scanlines.bottom_field = (cur_field_flags == PICTURE_INTERLACED_BOTTOM);
-
-    if (!((i & 1) ^ scanlines.bottom_field)) {
-      /* copying */
-      scanlines.tp = LINE2 (framep, i - 1);
-      scanlines.bp = LINE2 (framep, i + 1);
-
-      scanlines.tt0 = LINE2 (frame0, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m0 = LINE2 (frame0, i);
-      scanlines.bb0 = LINE2 (frame0, (i + 2 < frame_height ? i + 2 : i));
-
-      scanlines.t1 = LINE2 (frame1, i - 1);
-      scanlines.b1 = LINE2 (frame1, i + 1);
-
-      scanlines.tt2 = LINE2 (frame2, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m2 = LINE2 (frame2, i);
-      scanlines.bb2 = LINE2 (frame2, (i + 2 < frame_height ? i + 2 : i));
-
-      copy_scanline (self, LINE (dest, i), &scanlines, frame_width);
-    } else {
-      /* interpolating */
-      scanlines.ttp = LINE2 (framep, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.mp = LINE2 (framep, i);
-      scanlines.bbp = LINE2 (framep, (i + 2 < frame_height ? i + 2 : i));
+  gint plane = f->n_planes++;
 
-      scanlines.t0 = LINE2 (frame0, i - 1);
-      scanlines.b0 = LINE2 (frame0, i + 1);
-
-      scanlines.tt1 = LINE2 (frame1, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m1 = LINE2 (frame1, i);
-      scanlines.bb1 = LINE2 (frame1, (i + 2 < frame_height ? i + 2 : i));
-
-      scanlines.t2 = LINE2 (frame2, i - 1);
-      scanlines.b2 = LINE2 (frame2, i + 1);
-
-      interpolate_scanline (self, LINE (dest, i), &scanlines, frame_width);
-    }
-#undef LINE
-#undef LINE2
-  }
+  f->width[plane] = GST_VIDEO_FRAME_COMP_WIDTH (f->dest, plane) *
+      GST_VIDEO_FRAME_COMP_PSTRIDE (f->dest, plane);
+  f->height[plane] = GST_VIDEO_FRAME_COMP_HEIGHT (f->dest, plane);
+  f->copy_scanline[plane] = copy_scanline;
+  f->interpolate_scanline[plane] = interpolate_scanline;
 }
 
 static void
@@ -519,12 +688,8 @@ gst_deinterlace_simple_method_deinterlace_frame_planar (GstDeinterlaceMethod *
     GstVideoFrame * outframe, gint cur_field_idx)
 {
   GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
-  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  const GstVideoFrame *frame0, *frame1, *frame2, *framep;
-  guint cur_field_flags = history[cur_field_idx].flags;
+  GstDeinterlaceSimpleMethodFrame f;
   gint i;
-  GstDeinterlaceSimpleMethodFunction copy_scanline;
-  GstDeinterlaceSimpleMethodFunction interpolate_scanline;
 
   g_assert (self->interpolate_scanline_planar[0] != NULL);
   g_assert (self->interpolate_scanline_planar[1] != NULL);
@@ -533,27 +698,15 @@ gst_deinterlace_simple_method_deinterlace_frame_planar (GstDeinterlaceMethod *
   g_assert (self->copy_scanline_planar[1] != NULL);
   g_assert (self->copy_scanline_planar[2] != NULL);
 
-  for (i = 0; i < 3; i++) {
-    copy_scanline = self->copy_scanline_planar[i];
-    interpolate_scanline = self->interpolate_scanline_planar[i];
+  gst_deinterlace_simple_method_init_frame (&f, self, history, history_count,
+      outframe, cur_field_idx);
 
-    framep = (cur_field_idx > 0 ? history[cur_field_idx - 1].frame : NULL);
+  for (i = 0; i < 3; i++)
+    gst_deinterlace_simple_method_add_plane (&f, self->copy_scanline_planar[i],
+        self->interpolate_scanline_planar[i]);
 
-    frame0 = history[cur_field_idx].frame;
-
-    g_assert (dm_class->fields_required <= 4);
-
-    frame1 =
-        (cur_field_idx + 1 <
-        history_count ? history[cur_field_idx + 1].frame : NULL);
-    frame2 =
-        (cur_field_idx + 2 <
-        history_count ? history[cur_field_idx + 2].frame : NULL);
-
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane (self,
-        outframe, frame0, frame1, frame2, framep, cur_field_flags, i,
-        copy_scanline, interpolate_scanline);
-  }
+  gst_deinterlace_method_run_slices (method,
+      gst_deinterlace_simple_method_deinterlace_slice, &f);
 }
 
 static void
@@ -562,34 +715,24 @@ gst_deinterlace_simple_method_deinterlace_frame_nv12 (GstDeinterlaceMethod *
     GstVideoFrame * outframe, gint cur_field_idx)
 {
   GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
-  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  const GstVideoFrame *frame0, *frame1, *frame2, *framep;
-  guint cur_field_flags = history[cur_field_idx].flags;
+  GstDeinterlaceSimpleMethodFrame f;
   gint i;
 
   g_assert (self->interpolate_scanline_packed != NULL);
   g_assert (self->copy_scanline_packed != NULL);
 
-  for (i = 0; i < 2; i++) {
-    framep = (cur_field_idx > 0 ? history[cur_field_idx - 1].frame : NULL);
-
-    frame0 = history[cur_field_idx].frame;
-
-    g_assert (dm_class->fields_required <= 4);
+  gst_deinterlace_simple_method_init_frame (&f, self, history, history_count,
+      outframe, cur_field_idx);
 
-    frame1 =
-        (cur_field_idx + 1 <
-        history_count ? history[cur_field_idx + 1].frame : NULL);
-    frame2 =
-        (cur_field_idx + 2 <
-        history_count ? history[cur_field_idx + 2].frame : NULL);
+  for (i = 0; i < 2; i++)
+    gst_deinterlace_simple_method_add_plane (&f, self->copy_scanline_packed,
+        self->interpolate_scanline_packed);
 
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane (self,
-        outframe, frame0, frame1, frame2, framep, cur_field_flags, i,
-        self->copy_scanline_packed, self->interpolate_scanline_packed);
-  }
+  gst_deinterlace_method_run_slices (method,
+      gst_deinterlace_simple_method_deinterlace_slice, &f);
 }
 
+
 static void
 gst_deinterlace_simple_method_setup (GstDeinterlaceMethod * method,
     GstVideoInfo * vinfo)
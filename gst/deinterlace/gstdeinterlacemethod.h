@@ -24,6 +24,8 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
+#include <gst/workers/gstworkers.h>
+
 #if defined(HAVE_GCC_ASM) && defined(HAVE_ORC)
 #if defined(HAVE_CPU_I386) || defined(HAVE_CPU_X86_64)
 #define BUILD_X86_ASM
@@ -70,6 +72,15 @@ struct _GstDeinterlaceMethod {
   GstVideoInfo *vinfo;
 
   GstDeinterlaceMethodDeinterlaceFunction deinterlace_frame;
+
+  /* number of threads the line loops of a frame are split over, the
+   * workers are only touched from the streaming thread */
+  guint n_threads;
+  GstWorkers *workers;
+
+  /* simple methods weave blocks that don't comb by more than this,
+   * 0 disables the detection */
+  guint comb_threshold;
 };
 
 struct _GstDeinterlaceMethodClass {
@@ -111,6 +122,10 @@ void gst_deinterlace_method_deinterlace_frame (GstDeinterlaceMethod * self, cons
     int cur_field_idx);
 gint gst_deinterlace_method_get_fields_required (GstDeinterlaceMethod * self);
 gint gst_deinterlace_method_get_latency (GstDeinterlaceMethod * self);
+void gst_deinterlace_method_set_n_threads (GstDeinterlaceMethod * self, guint n_threads);
+void gst_deinterlace_method_set_comb_threshold (GstDeinterlaceMethod * self, guint threshold);
+void gst_deinterlace_method_run_slices (GstDeinterlaceMethod * self, GstWorkFunc func, gpointer data);
+void gst_deinterlace_method_get_slice_lines (guint slice, guint n_slices, gint n_lines, gint * start, gint * end);
 
 #define GST_TYPE_DEINTERLACE_SIMPLE_METHOD		(gst_deinterlace_simple_method_get_type ())
 #define GST_IS_DEINTERLACE_SIMPLE_METHOD(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_DEINTERLACE_SIMPLE_METHOD))
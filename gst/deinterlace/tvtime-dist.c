@@ -108,6 +108,12 @@ void deinterlace_line_greedy (orc_uint8 * ORC_RESTRICT d1,
     const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
     const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
     int p1, int n);
+void deinterlace_line_greedyh (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6,
+    const guint8 * ORC_RESTRICT s7, const guint8 * ORC_RESTRICT s8, int p1,
+    int p2, int p3, int n);
 
 
 /* begin Orc C target preamble */
@@ -1137,3 +1143,632 @@ deinterlace_line_greedy (orc_uint8 * ORC_RESTRICT d1,
   func (ex);
 }
 #endif
+
+
+/* deinterlace_line_greedyh */
+#ifdef DISABLE_ORC
+void
+deinterlace_line_greedyh (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6,
+    const guint8 * ORC_RESTRICT s7, const guint8 * ORC_RESTRICT s8, int p1,
+    int p2, int p3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  const orc_int8 *ORC_RESTRICT ptr11;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+  orc_int8 var47;
+  orc_int8 var48;
+  orc_int8 var49;
+  orc_int8 var50;
+  orc_union16 var51;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var52;
+#else
+  orc_union16 var52;
+#endif
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var56;
+#else
+  orc_union16 var56;
+#endif
+  orc_int8 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+  orc_union16 var75;
+  orc_union16 var76;
+  orc_union16 var77;
+  orc_union16 var78;
+  orc_union16 var79;
+  orc_union16 var80;
+  orc_union16 var81;
+  orc_union16 var82;
+  orc_union16 var83;
+  orc_union16 var84;
+  orc_union16 var85;
+  orc_union16 var86;
+  orc_union16 var87;
+  orc_union16 var88;
+  orc_union16 var89;
+  orc_union16 var90;
+  orc_union16 var91;
+  orc_union16 var92;
+  orc_union16 var93;
+  orc_union16 var94;
+  orc_union16 var95;
+  orc_union16 var96;
+  orc_union16 var97;
+  orc_union16 var98;
+  orc_union16 var99;
+  orc_union16 var100;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+  ptr9 = (orc_int8 *) s6;
+  ptr10 = (orc_int8 *) s7;
+  ptr11 = (orc_int8 *) s8;
+
+  /* 36: loadpw */
+  var51.i = p1;
+  /* 38: loadpw */
+  var52.i = (int) 0x000000ff;   /* 255 or 1.25987e-321f */
+  /* 40: loadpw */
+  var53.i = p1;
+  /* 46: loadpw */
+  var54.i = p2;
+  /* 48: loadpw */
+  var55.i = p3;
+  /* 50: loadpw */
+  var56.i = (int) 0x00000100;   /* 256 or 1.26481e-321f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var43 = ptr4[i];
+    /* 1: convubw */
+    var58.i = (orc_uint8) var43;
+    /* 2: loadb */
+    var44 = ptr5[i];
+    /* 3: convubw */
+    var59.i = (orc_uint8) var44;
+    /* 4: loadb */
+    var45 = ptr10[i];
+    /* 5: convubw */
+    var60.i = (orc_uint8) var45;
+    /* 6: loadb */
+    var46 = ptr11[i];
+    /* 7: convubw */
+    var61.i = (orc_uint8) var46;
+    /* 8: addw */
+    var62.i = var58.i + var59.i;
+    /* 9: shruw */
+    var63.i = ((orc_uint16) var62.i) >> 1;
+    /* 10: loadb */
+    var47 = ptr6[i];
+    /* 11: convubw */
+    var64.i = (orc_uint8) var47;
+    /* 12: loadb */
+    var48 = ptr7[i];
+    /* 13: convubw */
+    var65.i = (orc_uint8) var48;
+    /* 14: addw */
+    var66.i = var64.i + var65.i;
+    /* 15: shruw */
+    var67.i = ((orc_uint16) var66.i) >> 1;
+    /* 16: loadb */
+    var49 = ptr8[i];
+    /* 17: convubw */
+    var68.i = (orc_uint8) var49;
+    /* 18: loadb */
+    var50 = ptr9[i];
+    /* 19: convubw */
+    var69.i = (orc_uint8) var50;
+    /* 20: addw */
+    var70.i = var68.i + var69.i;
+    /* 21: shruw */
+    var71.i = ((orc_uint16) var70.i) >> 1;
+    /* 22: addw */
+    var72.i = var67.i + var71.i;
+    /* 23: shruw */
+    var73.i = ((orc_uint16) var72.i) >> 1;
+    /* 24: addw */
+    var74.i = var63.i + var73.i;
+    /* 25: shruw */
+    var75.i = ((orc_uint16) var74.i) >> 1;
+    /* 26: subw */
+    var76.i = var60.i - var75.i;
+    /* 27: absw */
+    var77.i = ORC_ABS (var76.i);
+    /* 28: subw */
+    var78.i = var61.i - var75.i;
+    /* 29: absw */
+    var79.i = ORC_ABS (var78.i);
+    /* 30: cmpgtsw */
+    var80.i = (var77.i > var79.i) ? (~0) : 0;
+    /* 31: andw */
+    var81.i = var61.i & var80.i;
+    /* 32: andnw */
+    var82.i = (~var80.i) & var60.i;
+    /* 33: orw */
+    var83.i = var81.i | var82.i;
+    /* 34: maxuw */
+    var84.i = ORC_MAX ((orc_uint16) var58.i, (orc_uint16) var59.i);
+    /* 35: minuw */
+    var85.i = ORC_MIN ((orc_uint16) var58.i, (orc_uint16) var59.i);
+    /* 37: addw */
+    var86.i = var84.i + var51.i;
+    /* 39: minuw */
+    var87.i = ORC_MIN ((orc_uint16) var86.i, (orc_uint16) var52.i);
+    /* 41: subusw */
+    var88.i = ORC_CLAMP_UW ((orc_uint16) var85.i - (orc_uint16) var53.i);
+    /* 42: minuw */
+    var89.i = ORC_MIN ((orc_uint16) var83.i, (orc_uint16) var87.i);
+    /* 43: maxuw */
+    var90.i = ORC_MAX ((orc_uint16) var89.i, (orc_uint16) var88.i);
+    /* 44: subw */
+    var91.i = var60.i - var61.i;
+    /* 45: absw */
+    var92.i = ORC_ABS (var91.i);
+    /* 47: subusw */
+    var93.i = ORC_CLAMP_UW ((orc_uint16) var92.i - (orc_uint16) var54.i);
+    /* 49: mullw */
+    var94.i = (var93.i * var55.i) & 0xffff;
+    /* 51: minuw */
+    var95.i = ORC_MIN ((orc_uint16) var94.i, (orc_uint16) var56.i);
+    /* 52: subw */
+    var96.i = var75.i - var90.i;
+    /* 53: mullw */
+    var97.i = (var96.i * var95.i) & 0xffff;
+    /* 54: shlw */
+    var98.i = var90.i << 8;
+    /* 55: addw */
+    var99.i = var98.i + var97.i;
+    /* 56: shruw */
+    var100.i = ((orc_uint16) var99.i) >> 8;
+    /* 57: convsuswb */
+    var57 = ORC_CLAMP_UB (var100.i);
+    /* 58: storeb */
+    ptr0[i] = var57;
+  }
+
+}
+
+#else
+static void
+_backup_deinterlace_line_greedyh (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  const orc_int8 *ORC_RESTRICT ptr10;
+  const orc_int8 *ORC_RESTRICT ptr11;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+  orc_int8 var47;
+  orc_int8 var48;
+  orc_int8 var49;
+  orc_int8 var50;
+  orc_union16 var51;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var52;
+#else
+  orc_union16 var52;
+#endif
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var56;
+#else
+  orc_union16 var56;
+#endif
+  orc_int8 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_union16 var69;
+  orc_union16 var70;
+  orc_union16 var71;
+  orc_union16 var72;
+  orc_union16 var73;
+  orc_union16 var74;
+  orc_union16 var75;
+  orc_union16 var76;
+  orc_union16 var77;
+  orc_union16 var78;
+  orc_union16 var79;
+  orc_union16 var80;
+  orc_union16 var81;
+  orc_union16 var82;
+  orc_union16 var83;
+  orc_union16 var84;
+  orc_union16 var85;
+  orc_union16 var86;
+  orc_union16 var87;
+  orc_union16 var88;
+  orc_union16 var89;
+  orc_union16 var90;
+  orc_union16 var91;
+  orc_union16 var92;
+  orc_union16 var93;
+  orc_union16 var94;
+  orc_union16 var95;
+  orc_union16 var96;
+  orc_union16 var97;
+  orc_union16 var98;
+  orc_union16 var99;
+  orc_union16 var100;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+  ptr9 = (orc_int8 *) ex->arrays[9];
+  ptr10 = (orc_int8 *) ex->arrays[10];
+  ptr11 = (orc_int8 *) ex->arrays[11];
+
+  /* 36: loadpw */
+  var51.i = ex->params[24];
+  /* 38: loadpw */
+  var52.i = (int) 0x000000ff;   /* 255 or 1.25987e-321f */
+  /* 40: loadpw */
+  var53.i = ex->params[24];
+  /* 46: loadpw */
+  var54.i = ex->params[25];
+  /* 48: loadpw */
+  var55.i = ex->params[26];
+  /* 50: loadpw */
+  var56.i = (int) 0x00000100;   /* 256 or 1.26481e-321f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var43 = ptr4[i];
+    /* 1: convubw */
+    var58.i = (orc_uint8) var43;
+    /* 2: loadb */
+    var44 = ptr5[i];
+    /* 3: convubw */
+    var59.i = (orc_uint8) var44;
+    /* 4: loadb */
+    var45 = ptr10[i];
+    /* 5: convubw */
+    var60.i = (orc_uint8) var45;
+    /* 6: loadb */
+    var46 = ptr11[i];
+    /* 7: convubw */
+    var61.i = (orc_uint8) var46;
+    /* 8: addw */
+    var62.i = var58.i + var59.i;
+    /* 9: shruw */
+    var63.i = ((orc_uint16) var62.i) >> 1;
+    /* 10: loadb */
+    var47 = ptr6[i];
+    /* 11: convubw */
+    var64.i = (orc_uint8) var47;
+    /* 12: loadb */
+    var48 = ptr7[i];
+    /* 13: convubw */
+    var65.i = (orc_uint8) var48;
+    /* 14: addw */
+    var66.i = var64.i + var65.i;
+    /* 15: shruw */
+    var67.i = ((orc_uint16) var66.i) >> 1;
+    /* 16: loadb */
+    var49 = ptr8[i];
+    /* 17: convubw */
+    var68.i = (orc_uint8) var49;
+    /* 18: loadb */
+    var50 = ptr9[i];
+    /* 19: convubw */
+    var69.i = (orc_uint8) var50;
+    /* 20: addw */
+    var70.i = var68.i + var69.i;
+    /* 21: shruw */
+    var71.i = ((orc_uint16) var70.i) >> 1;
+    /* 22: addw */
+    var72.i = var67.i + var71.i;
+    /* 23: shruw */
+    var73.i = ((orc_uint16) var72.i) >> 1;
+    /* 24: addw */
+    var74.i = var63.i + var73.i;
+    /* 25: shruw */
+    var75.i = ((orc_uint16) var74.i) >> 1;
+    /* 26: subw */
+    var76.i = var60.i - var75.i;
+    /* 27: absw */
+    var77.i = ORC_ABS (var76.i);
+    /* 28: subw */
+    var78.i = var61.i - var75.i;
+    /* 29: absw */
+    var79.i = ORC_ABS (var78.i);
+    /* 30: cmpgtsw */
+    var80.i = (var77.i > var79.i) ? (~0) : 0;
+    /* 31: andw */
+    var81.i = var61.i & var80.i;
+    /* 32: andnw */
+    var82.i = (~var80.i) & var60.i;
+    /* 33: orw */
+    var83.i = var81.i | var82.i;
+    /* 34: maxuw */
+    var84.i = ORC_MAX ((orc_uint16) var58.i, (orc_uint16) var59.i);
+    /* 35: minuw */
+    var85.i = ORC_MIN ((orc_uint16) var58.i, (orc_uint16) var59.i);
+    /* 37: addw */
+    var86.i = var84.i + var51.i;
+    /* 39: minuw */
+    var87.i = ORC_MIN ((orc_uint16) var86.i, (orc_uint16) var52.i);
+    /* 41: subusw */
+    var88.i = ORC_CLAMP_UW ((orc_uint16) var85.i - (orc_uint16) var53.i);
+    /* 42: minuw */
+    var89.i = ORC_MIN ((orc_uint16) var83.i, (orc_uint16) var87.i);
+    /* 43: maxuw */
+    var90.i = ORC_MAX ((orc_uint16) var89.i, (orc_uint16) var88.i);
+    /* 44: subw */
+    var91.i = var60.i - var61.i;
+    /* 45: absw */
+    var92.i = ORC_ABS (var91.i);
+    /* 47: subusw */
+    var93.i = ORC_CLAMP_UW ((orc_uint16) var92.i - (orc_uint16) var54.i);
+    /* 49: mullw */
+    var94.i = (var93.i * var55.i) & 0xffff;
+    /* 51: minuw */
+    var95.i = ORC_MIN ((orc_uint16) var94.i, (orc_uint16) var56.i);
+    /* 52: subw */
+    var96.i = var75.i - var90.i;
+    /* 53: mullw */
+    var97.i = (var96.i * var95.i) & 0xffff;
+    /* 54: shlw */
+    var98.i = var90.i << 8;
+    /* 55: addw */
+    var99.i = var98.i + var97.i;
+    /* 56: shruw */
+    var100.i = ((orc_uint16) var99.i) >> 8;
+    /* 57: convsuswb */
+    var57 = ORC_CLAMP_UB (var100.i);
+    /* 58: storeb */
+    ptr0[i] = var57;
+  }
+
+}
+
+void
+deinterlace_line_greedyh (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6,
+    const guint8 * ORC_RESTRICT s7, const guint8 * ORC_RESTRICT s8, int p1,
+    int p2, int p3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 24, 100, 101, 105, 110, 116, 101, 114, 108, 97, 99, 101, 95, 108,
+        105, 110, 101, 95, 103, 114, 101, 101, 100, 121, 104, 11, 1, 1, 12, 1,
+        1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1,
+        12, 1, 1, 12, 1, 1, 14, 4, 1, 0, 0, 0, 14, 4, 255, 0,
+        0, 0, 14, 4, 0, 1, 0, 0, 14, 4, 8, 0, 0, 0, 16, 2,
+        16, 2, 16, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 20, 2,
+        20, 2, 20, 2, 20, 2, 20, 2, 20, 2, 150, 32, 4, 150, 33, 5,
+        150, 37, 10, 150, 38, 11, 70, 34, 32, 33, 95, 34, 34, 16, 150, 35,
+        6, 150, 36, 7, 70, 35, 35, 36, 95, 35, 35, 16, 150, 36, 8, 150,
+        42, 9, 70, 36, 36, 42, 95, 36, 36, 16, 70, 35, 35, 36, 95, 35,
+        35, 16, 70, 34, 34, 35, 95, 34, 34, 16, 98, 35, 37, 34, 69, 35,
+        35, 98, 36, 38, 34, 69, 36, 36, 78, 35, 35, 36, 73, 36, 38, 35,
+        74, 35, 35, 37, 92, 39, 36, 35, 86, 40, 32, 33, 88, 41, 32, 33,
+        70, 40, 40, 24, 88, 40, 40, 17, 100, 41, 41, 24, 88, 39, 39, 40,
+        86, 39, 39, 41, 98, 42, 37, 38, 69, 42, 42, 100, 42, 42, 25, 89,
+        42, 42, 26, 88, 42, 42, 18, 98, 35, 34, 39, 89, 35, 35, 42, 93,
+        39, 39, 19, 70, 39, 39, 35, 95, 39, 39, 19, 160, 0, 39, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_deinterlace_line_greedyh);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "deinterlace_line_greedyh");
+      orc_program_set_backup_function (p, _backup_deinterlace_line_greedyh);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_source (p, 1, "s6");
+      orc_program_add_source (p, 1, "s7");
+      orc_program_add_source (p, 1, "s8");
+      orc_program_add_constant (p, 4, 0x00000001, "c1");
+      orc_program_add_constant (p, 4, 0x000000ff, "c2");
+      orc_program_add_constant (p, 4, 0x00000100, "c3");
+      orc_program_add_constant (p, 4, 0x00000008, "c4");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 2, "p3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+      orc_program_add_temporary (p, 2, "t7");
+      orc_program_add_temporary (p, 2, "t8");
+      orc_program_add_temporary (p, 2, "t9");
+      orc_program_add_temporary (p, 2, "t10");
+      orc_program_add_temporary (p, 2, "t11");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T6, ORC_VAR_S7,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T7, ORC_VAR_S8,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T4, ORC_VAR_S3,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T5, ORC_VAR_S4,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T5, ORC_VAR_S5,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T11, ORC_VAR_S6,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T11,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T4, ORC_VAR_T6, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T5, ORC_VAR_T7, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T4,
+          ORC_VAR_T5, ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T7, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andnw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T8, ORC_VAR_T5, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxuw", 0, ORC_VAR_T9, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T10, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T9, ORC_VAR_T9, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subusw", 0, ORC_VAR_T10, ORC_VAR_T10,
+          ORC_VAR_P1, ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T9,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxuw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T10,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T11, ORC_VAR_T6, ORC_VAR_T7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T11, ORC_VAR_T11, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subusw", 0, ORC_VAR_T11, ORC_VAR_T11,
+          ORC_VAR_P2, ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T11, ORC_VAR_T11,
+          ORC_VAR_P3, ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T11, ORC_VAR_T11,
+          ORC_VAR_C3, ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T4, ORC_VAR_T3, ORC_VAR_T8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T11,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_C4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shruw", 0, ORC_VAR_T8, ORC_VAR_T8, ORC_VAR_C4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_D1, ORC_VAR_T8,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+  ex->arrays[ORC_VAR_S8] = (void *) s8;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
@@ -37,6 +37,7 @@
 #include <gst/gst.h>
 #include "plugins.h"
 #include "gstdeinterlacemethod.h"
+#include "tvtime.h"
 #ifdef HAVE_ORC
 #include <orc/orc.h>
 #endif
@@ -68,6 +69,7 @@ typedef struct
   ScanlineFunction scanline_ayuv;
   ScanlineFunction scanline_planar_y;
   ScanlineFunction scanline_planar_uv;
+  ScanlineFunction scanline_nv_uv;
 } GstDeinterlaceMethodGreedyHClass;
 
 static void
@@ -469,198 +471,70 @@ greedyh_scanline_C_uyvy (GstDeinterlaceMethodGreedyH * self, const guint8 * L1,
   }
 }
 
+/* The planar (and NV12/NV21 chroma) lines go through an Orc kernel that gets
+ * the left and right neighbours of every pixel as separate lines. The first
+ * and last pixel of each component use themselves as the missing neighbour,
+ * which is exactly what the C version of this loop did. */
 static void
-greedyh_scanline_C_planar_y (GstDeinterlaceMethodGreedyH * self,
-    const guint8 * L1, const guint8 * L2, const guint8 * L3, const guint8 * L2P,
-    guint8 * Dest, gint width)
+greedyh_scanline_orc (GstDeinterlaceMethodGreedyH * self, const guint8 * L1,
+    const guint8 * L2, const guint8 * L3, const guint8 * L2P, guint8 * Dest,
+    gint width, gint step, gint motion_threshold, gint motion_sense)
 {
-  gint Pos;
-  guint8 l1, l1_1, l3, l3_1;
-  guint8 avg, avg_1;
-  guint8 avg__1 = 0;
-  guint8 avg_s;
-  guint8 avg_sc;
-  guint8 best;
-  guint16 mov;
-  guint8 out;
-  guint8 l2, lp2;
-  guint8 l2_diff, lp2_diff;
-  guint8 min, max;
-  guint max_comb = self->max_comb;
-  guint motion_sense = self->motion_sense;
-  guint motion_threshold = self->motion_threshold;
-
-  for (Pos = 0; Pos < width; Pos++) {
-    l1 = L1[0];
-    l3 = L3[0];
-
-    if (Pos == width - 1) {
-      l1_1 = l1;
-      l3_1 = l3;
-    } else {
-      l1_1 = L1[1];
-      l3_1 = L3[1];
-    }
-
-    /* Average of L1 and L3 */
-    avg = (l1 + l3) / 2;
-
-    if (Pos == 0) {
-      avg__1 = avg;
+  gint max_comb = self->max_comb;
+  gint i, prev, next;
+
+  if (G_UNLIKELY (width < 2 * step)) {
+    for (i = 0; i < width; i++) {
+      prev = (i >= step) ? step : 0;
+      next = (i + step < width) ? step : 0;
+      deinterlace_line_greedyh (Dest + i, L1 + i, L3 + i, L1 + i + next,
+          L3 + i + next, L1 + i - prev, L3 + i - prev, L2 + i, L2P + i,
+          max_comb, motion_threshold, motion_sense, 1);
     }
+    return;
+  }
 
-    /* Average of next L1 and next L3 */
-    avg_1 = (l1_1 + l3_1) / 2;
-
-    /* Calculate average of one pixel forward and previous */
-    avg_s = (avg__1 + avg_1) / 2;
-
-    /* Calculate average of center and surrounding pixels */
-    avg_sc = (avg + avg_s) / 2;
-
-    /* move forward */
-    avg__1 = avg;
-
-    /* Get best L2/L2P, i.e. least diff from above average */
-    l2 = L2[0];
-    lp2 = L2P[0];
-
-    l2_diff = ABS (l2 - avg_sc);
-
-    lp2_diff = ABS (lp2 - avg_sc);
-
-    if (l2_diff > lp2_diff)
-      best = lp2;
-    else
-      best = l2;
-
-    /* Clip this best L2/L2P by L1/L3 and allow to differ by GreedyMaxComb */
-    max = MAX (l1, l3);
-    min = MIN (l1, l3);
-
-    if (max < 256 - max_comb)
-      max += max_comb;
-    else
-      max = 255;
-
-    if (min > max_comb)
-      min -= max_comb;
-    else
-      min = 0;
-
-    out = CLAMP (best, min, max);
-
-    /* Do motion compensation for luma, i.e. how much
-     * the weave pixel differs */
-    mov = ABS (l2 - lp2);
-    if (mov > motion_threshold)
-      mov -= motion_threshold;
-    else
-      mov = 0;
-
-    mov = mov * motion_sense;
-    if (mov > 256)
-      mov = 256;
-
-    /* Weighted sum on clipped weave pixel and average */
-    out = (out * (256 - mov) + avg_sc * mov) / 256;
+  /* first pixel of every component */
+  deinterlace_line_greedyh (Dest, L1, L3, L1 + step, L3 + step, L1, L3, L2,
+      L2P, max_comb, motion_threshold, motion_sense, step);
 
-    Dest[0] = out;
+  if (width > 2 * step)
+    deinterlace_line_greedyh (Dest + step, L1 + step, L3 + step,
+        L1 + 2 * step, L3 + 2 * step, L1, L3, L2 + step, L2P + step,
+        max_comb, motion_threshold, motion_sense, width - 2 * step);
 
-    Dest += 1;
-    L1 += 1;
-    L2 += 1;
-    L3 += 1;
-    L2P += 1;
-  }
+  /* last pixel of every component */
+  i = width - step;
+  deinterlace_line_greedyh (Dest + i, L1 + i, L3 + i, L1 + i, L3 + i,
+      L1 + i - step, L3 + i - step, L2 + i, L2P + i, max_comb,
+      motion_threshold, motion_sense, step);
 }
 
 static void
-greedyh_scanline_C_planar_uv (GstDeinterlaceMethodGreedyH * self,
+greedyh_scanline_ORC_planar_y (GstDeinterlaceMethodGreedyH * self,
     const guint8 * L1, const guint8 * L2, const guint8 * L3, const guint8 * L2P,
     guint8 * Dest, gint width)
 {
-  gint Pos;
-  guint8 l1, l1_1, l3, l3_1;
-  guint8 avg, avg_1;
-  guint8 avg__1 = 0;
-  guint8 avg_s;
-  guint8 avg_sc;
-  guint8 best;
-  guint8 out;
-  guint8 l2, lp2;
-  guint8 l2_diff, lp2_diff;
-  guint8 min, max;
-  guint max_comb = self->max_comb;
-
-  for (Pos = 0; Pos < width; Pos++) {
-    l1 = L1[0];
-    l3 = L3[0];
-
-    if (Pos == width - 1) {
-      l1_1 = l1;
-      l3_1 = l3;
-    } else {
-      l1_1 = L1[1];
-      l3_1 = L3[1];
-    }
-
-    /* Average of L1 and L3 */
-    avg = (l1 + l3) / 2;
-
-    if (Pos == 0) {
-      avg__1 = avg;
-    }
-
-    /* Average of next L1 and next L3 */
-    avg_1 = (l1_1 + l3_1) / 2;
-
-    /* Calculate average of one pixel forward and previous */
-    avg_s = (avg__1 + avg_1) / 2;
-
-    /* Calculate average of center and surrounding pixels */
-    avg_sc = (avg + avg_s) / 2;
-
-    /* move forward */
-    avg__1 = avg;
-
-    /* Get best L2/L2P, i.e. least diff from above average */
-    l2 = L2[0];
-    lp2 = L2P[0];
-
-    l2_diff = ABS (l2 - avg_sc);
-
-    lp2_diff = ABS (lp2 - avg_sc);
-
-    if (l2_diff > lp2_diff)
-      best = lp2;
-    else
-      best = l2;
-
-    /* Clip this best L2/L2P by L1/L3 and allow to differ by GreedyMaxComb */
-    max = MAX (l1, l3);
-    min = MIN (l1, l3);
-
-    if (max < 256 - max_comb)
-      max += max_comb;
-    else
-      max = 255;
-
-    if (min > max_comb)
-      min -= max_comb;
-    else
-      min = 0;
-
-    out = CLAMP (best, min, max);
+  greedyh_scanline_orc (self, L1, L2, L3, L2P, Dest, width, 1,
+      self->motion_threshold, self->motion_sense);
+}
 
-    Dest[0] = out;
+/* no motion compensation for chroma, a motion sense of 0 keeps the clipped
+ * weave pixel as is */
+static void
+greedyh_scanline_ORC_planar_uv (GstDeinterlaceMethodGreedyH * self,
+    const guint8 * L1, const guint8 * L2, const guint8 * L3, const guint8 * L2P,
+    guint8 * Dest, gint width)
+{
+  greedyh_scanline_orc (self, L1, L2, L3, L2P, Dest, width, 1, 0, 0);
+}
 
-    Dest += 1;
-    L1 += 1;
-    L2 += 1;
-    L3 += 1;
-    L2P += 1;
-  }
+static void
+greedyh_scanline_ORC_nv_uv (GstDeinterlaceMethodGreedyH * self,
+    const guint8 * L1, const guint8 * L2, const guint8 * L3, const guint8 * L2P,
+    guint8 * Dest, gint width)
+{
+  greedyh_scanline_orc (self, L1, L2, L3, L2P, Dest, width, 2, 0, 0);
 }
 
 #ifdef BUILD_X86_ASM
@@ -669,8 +543,6 @@ greedyh_scanline_C_planar_uv (GstDeinterlaceMethodGreedyH * self,
 #define SIMD_TYPE MMXEXT
 #define C_FUNCT_YUY2 greedyh_scanline_C_yuy2
 #define C_FUNCT_UYVY greedyh_scanline_C_uyvy
-#define C_FUNCT_PLANAR_Y greedyh_scanline_C_planar_y
-#define C_FUNCT_PLANAR_UV greedyh_scanline_C_planar_uv
 #define FUNCT_NAME_YUY2 greedyh_scanline_MMXEXT_yuy2
 #define FUNCT_NAME_UYVY greedyh_scanline_MMXEXT_uyvy
 #define FUNCT_NAME_PLANAR_Y greedyh_scanline_MMXEXT_planar_y
@@ -711,11 +583,115 @@ greedyh_scanline_C_planar_uv (GstDeinterlaceMethodGreedyH * self,
 #undef FUNCT_NAME_PLANAR_Y
 #undef FUNCT_NAME_PLANAR_UV
 #undef C_FUNCT_YUY2
-#undef C_FUNCT_PLANAR_Y
-#undef C_FUNCT_PLANAR_UV
 
 #endif
 
+/* the pointers of every plane at the start of the line loop, shared by all
+ * slices */
+typedef struct
+{
+  GstDeinterlaceMethodGreedyH *self;
+
+  gint n_planes;
+  const guint8 *L1[3];
+  const guint8 *L2[3];
+  const guint8 *L3[3];
+  const guint8 *L2P[3];
+  guint8 *Dest[3];
+  gint RowStride[3];
+  gint FieldHeight[3];
+  ScanlineFunction scanline[3];
+} GreedyHFrame;
+
+static void
+deinterlace_frame_di_greedyh_slice (gpointer data, guint slice, guint n_slices)
+{
+  GreedyHFrame *f = data;
+  gint i, Line, start, end;
+
+  for (i = 0; i < f->n_planes; i++) {
+    gint RowStride = f->RowStride[i];
+    gint Pitch = RowStride * 2;
+    const guint8 *L1, *L2, *L3, *L2P;
+    guint8 *Dest;
+
+    gst_deinterlace_method_get_slice_lines (slice, n_slices,
+        f->FieldHeight[i] - 1, &start, &end);
+
+    L1 = f->L1[i] + start * Pitch;
+    L2 = f->L2[i] + start * Pitch;
+    L3 = f->L3[i] + start * Pitch;
+    L2P = f->L2P[i] + start * Pitch;
+    Dest = f->Dest[i] + start * Pitch;
+
+    for (Line = start; Line < end; ++Line) {
+      f->scanline[i] (f->self, L1, L2, L3, L2P, Dest, RowStride);
+      Dest += RowStride;
+      memcpy (Dest, L3, RowStride);
+      Dest += RowStride;
+
+      L1 += Pitch;
+      L2 += Pitch;
+      L3 += Pitch;
+      L2P += Pitch;
+    }
+  }
+}
+
+/* copy the first lines of a plane and remember where the line loop starts */
+static void
+deinterlace_frame_di_greedyh_add_plane (GreedyHFrame * f, const guint8 * L1,
+    const guint8 * L2, const guint8 * L3, const guint8 * L2P, guint8 * Dest,
+    gint RowStride, gint FieldHeight, gint InfoIsOdd, ScanlineFunction scanline)
+{
+  gint plane = f->n_planes++;
+
+  // copy first even line no matter what, and the first odd line if we're
+  // processing an EVEN field. (note diff from other deint rtns.)
+
+  if (InfoIsOdd) {
+    // copy first even line
+    memcpy (Dest, L1, RowStride);
+    Dest += RowStride;
+  } else {
+    // copy first even line
+    memcpy (Dest, L1, RowStride);
+    Dest += RowStride;
+    // then first odd line
+    memcpy (Dest, L1, RowStride);
+    Dest += RowStride;
+  }
+
+  f->L1[plane] = L1;
+  f->L2[plane] = L2;
+  f->L3[plane] = L3;
+  f->L2P[plane] = L2P;
+  f->Dest[plane] = Dest;
+  f->RowStride[plane] = RowStride;
+  f->FieldHeight[plane] = FieldHeight;
+  f->scanline[plane] = scanline;
+}
+
+static void
+deinterlace_frame_di_greedyh_run (GstDeinterlaceMethod * method,
+    GreedyHFrame * f, gint InfoIsOdd)
+{
+  gint i;
+
+  gst_deinterlace_method_run_slices (method,
+      deinterlace_frame_di_greedyh_slice, f);
+
+  if (InfoIsOdd) {
+    for (i = 0; i < f->n_planes; i++) {
+      gint Lines = MAX (f->FieldHeight[i] - 1, 0);
+      gint Pitch = f->RowStride[i] * 2;
+
+      memcpy (f->Dest[i] + Lines * Pitch, f->L2[i] + Lines * Pitch,
+          f->RowStride[i]);
+    }
+  }
+}
+
 static void
 deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
     const GstDeinterlaceField * history, guint history_count,
@@ -725,7 +701,6 @@ deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
   GstDeinterlaceMethodGreedyHClass *klass =
       GST_DEINTERLACE_METHOD_GREEDY_H_GET_CLASS (self);
   gint InfoIsOdd = 0;
-  gint Line;
   gint RowStride = GST_VIDEO_FRAME_COMP_STRIDE (outframe, 0);
   gint FieldHeight = GST_VIDEO_FRAME_HEIGHT (outframe) / 2;
   gint Pitch = RowStride * 2;
@@ -735,6 +710,7 @@ deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
   const guint8 *L2P;            // ptr to prev Line2
   guint8 *Dest = GST_VIDEO_FRAME_COMP_DATA (outframe, 0);
   ScanlineFunction scanline;
+  GreedyHFrame f;
 
   if (cur_field_idx + 2 > history_count || cur_field_idx < 1) {
     GstDeinterlaceMethod *backup_method;
@@ -768,9 +744,6 @@ deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
       return;
   }
 
-  // copy first even line no matter what, and the first odd line if we're
-  // processing an EVEN field. (note diff from other deint rtns.)
-
   if (history[cur_field_idx - 1].flags == PICTURE_INTERLACED_BOTTOM) {
     InfoIsOdd = 1;
 
@@ -786,10 +759,6 @@ deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
     L2P = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 3].frame, 0);
     if (history[cur_field_idx - 3].flags & PICTURE_INTERLACED_BOTTOM)
       L2P += RowStride;
-
-    // copy first even line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
   } else {
     InfoIsOdd = 0;
     L1 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 2].frame, 0);
@@ -807,71 +776,14 @@ deinterlace_frame_di_greedyh_packed (GstDeinterlaceMethod * method,
         0) + Pitch;
     if (history[cur_field_idx - 3].flags & PICTURE_INTERLACED_BOTTOM)
       L2P += RowStride;
-
-    // copy first even line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
-    // then first odd line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
   }
 
-  for (Line = 0; Line < (FieldHeight - 1); ++Line) {
-    scanline (self, L1, L2, L3, L2P, Dest, RowStride);
-    Dest += RowStride;
-    memcpy (Dest, L3, RowStride);
-    Dest += RowStride;
-
-    L1 += Pitch;
-    L2 += Pitch;
-    L3 += Pitch;
-    L2P += Pitch;
-  }
+  f.self = self;
+  f.n_planes = 0;
+  deinterlace_frame_di_greedyh_add_plane (&f, L1, L2, L3, L2P, Dest,
+      RowStride, FieldHeight, InfoIsOdd, scanline);
 
-  if (InfoIsOdd) {
-    memcpy (Dest, L2, RowStride);
-  }
-}
-
-static void
-deinterlace_frame_di_greedyh_planar_plane (GstDeinterlaceMethodGreedyH * self,
-    const guint8 * L1, const guint8 * L2, const guint8 * L3, const guint8 * L2P,
-    guint8 * Dest, gint RowStride, gint FieldHeight, gint Pitch, gint InfoIsOdd,
-    ScanlineFunction scanline)
-{
-  gint Line;
-
-  // copy first even line no matter what, and the first odd line if we're
-  // processing an EVEN field. (note diff from other deint rtns.)
-
-  if (InfoIsOdd) {
-    // copy first even line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
-  } else {
-    // copy first even line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
-    // then first odd line
-    memcpy (Dest, L1, RowStride);
-    Dest += RowStride;
-  }
-
-  for (Line = 0; Line < (FieldHeight - 1); ++Line) {
-    scanline (self, L1, L2, L3, L2P, Dest, RowStride);
-    Dest += RowStride;
-    memcpy (Dest, L3, RowStride);
-    Dest += RowStride;
-
-    L1 += Pitch;
-    L2 += Pitch;
-    L3 += Pitch;
-    L2P += Pitch;
-  }
-
-  if (InfoIsOdd) {
-    memcpy (Dest, L2, RowStride);
-  }
+  deinterlace_frame_di_greedyh_run (method, &f, InfoIsOdd);
 }
 
 static void
@@ -891,8 +803,9 @@ deinterlace_frame_di_greedyh_planar (GstDeinterlaceMethod * method,
   const guint8 *L3;             // ptr to Line3
   const guint8 *L2P;            // ptr to prev Line2
   guint8 *Dest;
-  gint i;
+  gint i, n_planes;
   ScanlineFunction scanline;
+  GreedyHFrame f;
 
   if (cur_field_idx + 2 > history_count || cur_field_idx < 1) {
     GstDeinterlaceMethod *backup_method;
@@ -910,35 +823,46 @@ deinterlace_frame_di_greedyh_planar (GstDeinterlaceMethod * method,
 
   cur_field_idx += 2;
 
-  for (i = 0; i < 3; i++) {
-    InfoIsOdd = (history[cur_field_idx - 1].flags == PICTURE_INTERLACED_BOTTOM);
-    RowStride = GST_VIDEO_FRAME_COMP_STRIDE (outframe, i);
+  InfoIsOdd = (history[cur_field_idx - 1].flags == PICTURE_INTERLACED_BOTTOM);
+
+  f.self = self;
+  f.n_planes = 0;
+
+  /* the chroma of NV12/NV21 is a single plane of interleaved U and V */
+  n_planes = GST_VIDEO_FRAME_N_PLANES (outframe);
+
+  for (i = 0; i < n_planes; i++) {
+    RowStride = GST_VIDEO_FRAME_PLANE_STRIDE (outframe, i);
     FieldHeight = GST_VIDEO_FRAME_COMP_HEIGHT (outframe, i) / 2;
     Pitch = RowStride * 2;
 
     if (i == 0)
       scanline = klass->scanline_planar_y;
+    else if (n_planes == 2)
+      scanline = klass->scanline_nv_uv;
     else
       scanline = klass->scanline_planar_uv;
 
-    Dest = GST_VIDEO_FRAME_COMP_DATA (outframe, i);
+    Dest = GST_VIDEO_FRAME_PLANE_DATA (outframe, i);
 
-    L1 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 2].frame, i);
+    L1 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 2].frame, i);
     if (history[cur_field_idx - 2].flags & PICTURE_INTERLACED_BOTTOM)
       L1 += RowStride;
 
-    L2 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 1].frame, i);
+    L2 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 1].frame, i);
     if (history[cur_field_idx - 1].flags & PICTURE_INTERLACED_BOTTOM)
       L2 += RowStride;
 
     L3 = L1 + Pitch;
-    L2P = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 3].frame, i);
+    L2P = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 3].frame, i);
     if (history[cur_field_idx - 3].flags & PICTURE_INTERLACED_BOTTOM)
       L2P += RowStride;
 
-    deinterlace_frame_di_greedyh_planar_plane (self, L1, L2, L3, L2P, Dest,
-        RowStride, FieldHeight, Pitch, InfoIsOdd, scanline);
+    deinterlace_frame_di_greedyh_add_plane (&f, L1, L2, L3, L2P, Dest,
+        RowStride, FieldHeight, InfoIsOdd, scanline);
   }
+
+  deinterlace_frame_di_greedyh_run (method, &f, InfoIsOdd);
 }
 
 G_DEFINE_TYPE (GstDeinterlaceMethodGreedyH, gst_deinterlace_method_greedy_h,
@@ -1042,6 +966,8 @@ gst_deinterlace_method_greedy_h_class_init (GstDeinterlaceMethodGreedyHClass *
   dim_class->deinterlace_frame_yv12 = deinterlace_frame_di_greedyh_planar;
   dim_class->deinterlace_frame_y42b = deinterlace_frame_di_greedyh_planar;
   dim_class->deinterlace_frame_y41b = deinterlace_frame_di_greedyh_planar;
+  dim_class->deinterlace_frame_nv12 = deinterlace_frame_di_greedyh_planar;
+  dim_class->deinterlace_frame_nv21 = deinterlace_frame_di_greedyh_planar;
 
 #ifdef BUILD_X86_ASM
   if (cpu_flags & ORC_TARGET_MMX_MMXEXT) {
@@ -1061,10 +987,11 @@ gst_deinterlace_method_greedy_h_class_init (GstDeinterlaceMethodGreedyHClass *
   klass->scanline_yuy2 = greedyh_scanline_C_yuy2;
   klass->scanline_uyvy = greedyh_scanline_C_uyvy;
 #endif
-  /* TODO: MMX implementation of these two */
+  /* TODO: MMX implementation of this one */
   klass->scanline_ayuv = greedyh_scanline_C_ayuv;
-  klass->scanline_planar_y = greedyh_scanline_C_planar_y;
-  klass->scanline_planar_uv = greedyh_scanline_C_planar_uv;
+  klass->scanline_planar_y = greedyh_scanline_ORC_planar_y;
+  klass->scanline_planar_uv = greedyh_scanline_ORC_planar_uv;
+  klass->scanline_nv_uv = greedyh_scanline_ORC_nv_uv;
 }
 
 static void
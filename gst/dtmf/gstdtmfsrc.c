@@ -215,6 +215,7 @@ GST_STATIC_PAD_TEMPLATE ("src",
 G_DEFINE_TYPE (GstDTMFSrc, gst_dtmf_src, GST_TYPE_BASE_SRC);
 
 static void gst_dtmf_src_finalize (GObject * object);
+static void gst_dtmf_src_free_pool (GstDTMFSrc * dtmfsrc);
 
 static void gst_dtmf_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -315,6 +316,8 @@ gst_dtmf_src_finalize (GObject * object)
     dtmfsrc->event_queue = NULL;
   }
 
+  gst_dtmf_src_free_pool (dtmfsrc);
+
   G_OBJECT_CLASS (gst_dtmf_src_parent_class)->finalize (object);
 }
 
@@ -539,52 +542,134 @@ gst_dtmf_src_add_stop_event (GstDTMFSrc * dtmfsrc)
   g_async_queue_push (dtmfsrc->event_queue, event);
 }
 
-static GstBuffer *
-gst_dtmf_src_generate_silence (float duration, gint sample_rate)
+/* One period of the summed tones of a key at a sample rate. The frequencies
+ * are whole numbers of Hz, so the tone repeats after
+ * rate / gcd (rate, low, high) samples. The tables are shared by all the
+ * elements and kept for the lifetime of the process. There is one per key
+ * and sample rate in use, so generating a packet never calls sin() */
+typedef struct
 {
-  gint buf_size;
+  gint sample_rate;
+  guint period;
+  gfloat *samples;
+} DTMFToneTable;
+
+static GMutex tone_tables_lock;
+static GSList *tone_tables[MAX_DTMF_EVENTS];
+
+static const DTMFToneTable *
+gst_dtmf_src_get_tone_table (guint16 event_number, gint sample_rate)
+{
+  const DTMF_KEY *key = &DTMF_KEYS[event_number];
+  DTMFToneTable *table;
+  GSList *walk;
+  gint gcd;
+  guint i;
+
+  g_mutex_lock (&tone_tables_lock);
+  for (walk = tone_tables[event_number]; walk; walk = walk->next) {
+    table = walk->data;
+    if (table->sample_rate == sample_rate)
+      goto done;
+  }
+
+  gcd = gst_util_greatest_common_divisor (key->low_frequency,
+      key->high_frequency);
+  gcd = gst_util_greatest_common_divisor (gcd, sample_rate);
 
-  /* Create a buffer with data set to 0 */
-  buf_size = ((duration / 1000) * sample_rate * SAMPLE_SIZE * CHANNELS) / 8;
+  table = g_new (DTMFToneTable, 1);
+  table->sample_rate = sample_rate;
+  table->period = sample_rate / gcd;
+  table->samples = g_new (gfloat, table->period);
 
-  return gst_buffer_new_wrapped (g_malloc0 (buf_size), buf_size);
+  /* We add the fundamental frequencies together */
+  for (i = 0; i < table->period; i++) {
+    double t = (double) i / sample_rate;
+
+    table->samples[i] = (sin (2 * M_PI * key->low_frequency * t) +
+        sin (2 * M_PI * key->high_frequency * t)) / 2;
+  }
+  tone_tables[event_number] = g_slist_prepend (tone_tables[event_number],
+      table);
+
+done:
+  g_mutex_unlock (&tone_tables_lock);
+
+  return table;
 }
 
+/* The packets all have the same size as long as the interval and the rate
+ * do not change, they come from a pool so that an element running all day
+ * does not allocate for every packet */
 static GstBuffer *
-gst_dtmf_src_generate_tone (GstDTMFSrcEvent * event, DTMF_KEY key,
-    float duration, gint sample_rate)
+gst_dtmf_src_alloc_buffer (GstDTMFSrc * dtmfsrc, gint size)
+{
+  GstBuffer *buffer = NULL;
+  GstStructure *config;
+
+  if (dtmfsrc->pool && dtmfsrc->pool_size != size)
+    gst_dtmf_src_free_pool (dtmfsrc);
+
+  if (dtmfsrc->pool == NULL) {
+    static GstAllocationParams params = { 0, 1, 0, 0, };
+
+    dtmfsrc->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (dtmfsrc->pool);
+    gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+    gst_buffer_pool_config_set_allocator (config, NULL, &params);
+    if (!gst_buffer_pool_set_config (dtmfsrc->pool, config) ||
+        !gst_buffer_pool_set_active (dtmfsrc->pool, TRUE)) {
+      GST_WARNING_OBJECT (dtmfsrc, "could not activate the buffer pool");
+      gst_object_unref (dtmfsrc->pool);
+      dtmfsrc->pool = NULL;
+    }
+    dtmfsrc->pool_size = size;
+  }
+
+  if (dtmfsrc->pool)
+    gst_buffer_pool_acquire_buffer (dtmfsrc->pool, &buffer, NULL);
+  if (buffer == NULL)
+    buffer = gst_buffer_new_allocate (NULL, size, NULL);
+
+  return buffer;
+}
+
+static void
+gst_dtmf_src_free_pool (GstDTMFSrc * dtmfsrc)
+{
+  if (dtmfsrc->pool) {
+    /* buffers that are still in use are freed when they return */
+    gst_buffer_pool_set_active (dtmfsrc->pool, FALSE);
+    gst_object_unref (dtmfsrc->pool);
+    dtmfsrc->pool = NULL;
+  }
+}
+
+static void
+gst_dtmf_src_generate_silence (GstBuffer * buffer)
+{
+  gst_buffer_memset (buffer, 0, 0, gst_buffer_get_size (buffer));
+}
+
+static void
+gst_dtmf_src_generate_tone (GstDTMFSrcEvent * event,
+    const DTMFToneTable * table, GstBuffer * buffer)
 {
-  GstBuffer *buffer;
   GstMapInfo map;
   gint16 *p;
-  gint tone_size;
-  double i = 0;
-  double amplitude, f1, f2;
+  guint i, n_samples, pos;
+  double amplitude;
   double volume_factor;
-  static GstAllocationParams params = { 0, 1, 0, 0, };
-
-  /* Create a buffer for the tone */
-  tone_size = ((duration / 1000) * sample_rate * SAMPLE_SIZE * CHANNELS) / 8;
 
-  buffer = gst_buffer_new_allocate (NULL, tone_size, &params);
-
-  gst_buffer_map (buffer, &map, GST_MAP_READWRITE);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
   p = (gint16 *) map.data;
+  n_samples = map.size / (SAMPLE_SIZE / 8);
 
   volume_factor = pow (10, (-event->volume) / 20);
 
-  /*
-   * For each sample point we calculate 'x' as the
-   * the amplitude value.
-   */
-  for (i = 0; i < (tone_size / (SAMPLE_SIZE / 8)); i++) {
-    /*
-     * We add the fundamental frequencies together.
-     */
-    f1 = sin (2 * M_PI * key.low_frequency * (event->sample / sample_rate));
-    f2 = sin (2 * M_PI * key.high_frequency * (event->sample / sample_rate));
-
-    amplitude = (f1 + f2) / 2;
+  pos = event->sample % table->period;
+  for (i = 0; i < n_samples; i++) {
+    amplitude = table->samples[pos];
 
     /* Adjust the volume */
     amplitude *= volume_factor;
@@ -593,14 +678,14 @@ gst_dtmf_src_generate_tone (GstDTMFSrcEvent * event, DTMF_KEY key,
     amplitude *= 32767;
 
     /* Store it in the data buffer */
-    *(p++) = (gint16) amplitude;
+    p[i] = (gint16) amplitude;
 
-    (event->sample)++;
+    if (++pos == table->period)
+      pos = 0;
   }
+  event->sample += n_samples;
 
   gst_buffer_unmap (buffer, &map);
-
-  return buffer;
 }
 
 
@@ -611,6 +696,7 @@ gst_dtmf_src_create_next_tone_packet (GstDTMFSrc * dtmfsrc,
 {
   GstBuffer *buf = NULL;
   gboolean send_silence = FALSE;
+  gint buf_size;
 
   GST_LOG_OBJECT (dtmfsrc, "Creating buffer for tone %s",
       DTMF_KEYS[event->event_number].event_name);
@@ -619,14 +705,18 @@ gst_dtmf_src_create_next_tone_packet (GstDTMFSrc * dtmfsrc,
     send_silence = TRUE;
   }
 
+  buf_size = (((float) dtmfsrc->interval / 1000) * dtmfsrc->sample_rate *
+      SAMPLE_SIZE * CHANNELS) / 8;
+  buf = gst_dtmf_src_alloc_buffer (dtmfsrc, buf_size);
+
   if (send_silence) {
     GST_LOG_OBJECT (dtmfsrc, "Generating silence");
-    buf = gst_dtmf_src_generate_silence (dtmfsrc->interval,
-        dtmfsrc->sample_rate);
+    gst_dtmf_src_generate_silence (buf);
   } else {
     GST_LOG_OBJECT (dtmfsrc, "Generating tone");
-    buf = gst_dtmf_src_generate_tone (event, DTMF_KEYS[event->event_number],
-        dtmfsrc->interval, dtmfsrc->sample_rate);
+    gst_dtmf_src_generate_tone (event,
+        gst_dtmf_src_get_tone_table (event->event_number,
+            dtmfsrc->sample_rate), buf);
   }
   event->packet_count++;
 
@@ -943,6 +1033,7 @@ gst_dtmf_src_change_state (GstElement * element, GstStateChange transition)
       }
       dtmfsrc->last_event_was_start = FALSE;
 
+      gst_dtmf_src_free_pool (dtmfsrc);
       break;
     default:
       break;
@@ -54,7 +54,7 @@ typedef enum _GstDTMFEventType GstDTMFEventType;
 struct _GstDTMFSrcEvent
 {
   GstDTMFEventType event_type;
-  double sample;
+  guint64 sample;
   guint16 event_number;
   guint16 volume;
   guint32 packet_count;
@@ -85,6 +85,9 @@ struct _GstDTMFSrc
   GstClockTime last_stop;
 
   gint sample_rate;
+
+  GstBufferPool *pool;
+  gint pool_size;
 };
 
 
@@ -178,6 +178,7 @@ GST_STATIC_PAD_TEMPLATE ("src",
 G_DEFINE_TYPE (GstRTPDTMFSrc, gst_rtp_dtmf_src, GST_TYPE_BASE_SRC);
 
 static void gst_rtp_dtmf_src_finalize (GObject * object);
+static void gst_rtp_dtmf_src_free_pool (GstRTPDTMFSrc * dtmfsrc);
 
 static void gst_rtp_dtmf_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -319,6 +320,7 @@ gst_rtp_dtmf_src_finalize (GObject * object)
     dtmfsrc->event_queue = NULL;
   }
 
+  gst_rtp_dtmf_src_free_pool (dtmfsrc);
 
   G_OBJECT_CLASS (gst_rtp_dtmf_src_parent_class)->finalize (object);
 }
@@ -585,6 +587,57 @@ gst_rtp_dtmf_prepare_rtp_headers (GstRTPDTMFSrc * dtmfsrc,
   gst_rtp_buffer_set_timestamp (rtpbuf, dtmfsrc->rtp_timestamp);
 }
 
+/* All the packets have the same size, they come from a pool so that an
+ * element running all day does not allocate for every packet */
+static GstBuffer *
+gst_rtp_dtmf_src_alloc_packet (GstRTPDTMFSrc * dtmfsrc)
+{
+  GstBuffer *buf = NULL;
+  GstMapInfo map;
+  guint size;
+
+  size = gst_rtp_buffer_calc_packet_len (sizeof (GstRTPDTMFPayload), 0, 0);
+
+  if (dtmfsrc->pool == NULL) {
+    GstStructure *config;
+
+    dtmfsrc->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (dtmfsrc->pool);
+    gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+    if (!gst_buffer_pool_set_config (dtmfsrc->pool, config) ||
+        !gst_buffer_pool_set_active (dtmfsrc->pool, TRUE)) {
+      GST_WARNING_OBJECT (dtmfsrc, "could not activate the buffer pool");
+      gst_object_unref (dtmfsrc->pool);
+      dtmfsrc->pool = NULL;
+    }
+  }
+
+  if (dtmfsrc->pool == NULL ||
+      gst_buffer_pool_acquire_buffer (dtmfsrc->pool, &buf, NULL) !=
+      GST_FLOW_OK)
+    return gst_rtp_buffer_new_allocate (sizeof (GstRTPDTMFPayload), 0, 0);
+
+  /* a recycled packet still has the old header, start from the empty
+   * header gst_rtp_buffer_new_allocate() would write */
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  map.data[0] = GST_RTP_VERSION << 6;
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+gst_rtp_dtmf_src_free_pool (GstRTPDTMFSrc * dtmfsrc)
+{
+  if (dtmfsrc->pool) {
+    /* packets that are still in use are freed when they return */
+    gst_buffer_pool_set_active (dtmfsrc->pool, FALSE);
+    gst_object_unref (dtmfsrc->pool);
+    dtmfsrc->pool = NULL;
+  }
+}
+
 static GstBuffer *
 gst_rtp_dtmf_src_create_next_rtp_packet (GstRTPDTMFSrc * dtmfsrc)
 {
@@ -592,7 +645,7 @@ gst_rtp_dtmf_src_create_next_rtp_packet (GstRTPDTMFSrc * dtmfsrc)
   GstRTPDTMFPayload *payload;
   GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
 
-  buf = gst_rtp_buffer_new_allocate (sizeof (GstRTPDTMFPayload), 0, 0);
+  buf = gst_rtp_dtmf_src_alloc_packet (dtmfsrc);
 
   gst_rtp_buffer_map (buf, GST_MAP_READWRITE, &rtpbuffer);
 
@@ -1089,6 +1142,8 @@ gst_rtp_dtmf_src_change_state (GstElement * element, GstStateChange transition)
       }
       dtmfsrc->last_event_was_start = FALSE;
 
+      gst_rtp_dtmf_src_free_pool (dtmfsrc);
+
       /* Indicate that we don't do PRE_ROLL */
       break;
 
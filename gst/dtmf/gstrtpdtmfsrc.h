@@ -99,6 +99,8 @@ struct _GstRTPDTMFSrc
 
   gboolean dirty;
   guint16 redundancy_count;
+
+  GstBufferPool *pool;
 };
 
 struct _GstRTPDTMFSrcClass
@@ -0,0 +1,182 @@
+/* GStreamer
+ *
+ * gsteffectvhistory.c: ring of past frames for the effects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "gsteffectvhistory.h"
+
+/* The frames are kept as packed 32 bit pixels, width * height each, in one
+ * allocation. The ring is refcounted so that it can be replaced from the
+ * application thread while the streaming thread still uses the old one. */
+struct _GstEffectvHistory
+{
+  gint refcount;
+
+  guint n_frames;
+  guint width, height;
+  gsize frame_size;
+  guint32 *frames;
+
+  /* slot of the newest frame and the number of frames pushed so far */
+  guint head;
+  guint n_filled;
+};
+
+/**
+ * gst_effectv_history_new:
+ * @n_frames: the number of frames to keep
+ * @width: the width of a frame in pixels
+ * @height: the height of a frame in pixels
+ *
+ * Make a new ring of @n_frames frames of @width x @height 32 bit pixels.
+ * All frames start out black.
+ *
+ * Returns: a new #GstEffectvHistory, unref with gst_effectv_history_unref()
+ */
+GstEffectvHistory *
+gst_effectv_history_new (guint n_frames, guint width, guint height)
+{
+  GstEffectvHistory *history;
+
+  g_return_val_if_fail (n_frames > 0, NULL);
+
+  history = g_slice_new0 (GstEffectvHistory);
+  history->refcount = 1;
+  history->n_frames = n_frames;
+  history->width = width;
+  history->height = height;
+  history->frame_size = (gsize) width * height;
+  history->frames = g_new0 (guint32, history->frame_size * n_frames);
+
+  return history;
+}
+
+GstEffectvHistory *
+gst_effectv_history_ref (GstEffectvHistory * history)
+{
+  g_return_val_if_fail (history != NULL, NULL);
+
+  g_atomic_int_inc (&history->refcount);
+
+  return history;
+}
+
+void
+gst_effectv_history_unref (GstEffectvHistory * history)
+{
+  g_return_if_fail (history != NULL);
+
+  if (g_atomic_int_dec_and_test (&history->refcount)) {
+    g_free (history->frames);
+    g_slice_free (GstEffectvHistory, history);
+  }
+}
+
+/**
+ * gst_effectv_history_is_compatible:
+ * @history: a #GstEffectvHistory
+ * @n_frames: the number of frames
+ * @width: the width of a frame
+ * @height: the height of a frame
+ *
+ * Returns: %TRUE if @history has the given layout, so that it can be
+ * reused with gst_effectv_history_clear() instead of allocating a new one.
+ */
+gboolean
+gst_effectv_history_is_compatible (GstEffectvHistory * history,
+    guint n_frames, guint width, guint height)
+{
+  return history->n_frames == n_frames && history->width == width
+      && history->height == height;
+}
+
+/**
+ * gst_effectv_history_clear:
+ * @history: a #GstEffectvHistory
+ *
+ * Forget all frames and make them black again.
+ */
+void
+gst_effectv_history_clear (GstEffectvHistory * history)
+{
+  memset (history->frames, 0,
+      history->frame_size * history->n_frames * sizeof (guint32));
+  history->head = 0;
+  history->n_filled = 0;
+}
+
+guint
+gst_effectv_history_get_n_frames (GstEffectvHistory * history)
+{
+  return history->n_frames;
+}
+
+/**
+ * gst_effectv_history_get_n_filled:
+ * @history: a #GstEffectvHistory
+ *
+ * Returns: the number of frames that were pushed since the creation or the
+ * last clear, at most the number of frames of the ring.
+ */
+guint
+gst_effectv_history_get_n_filled (GstEffectvHistory * history)
+{
+  return history->n_filled;
+}
+
+/**
+ * gst_effectv_history_push:
+ * @history: a #GstEffectvHistory
+ *
+ * Make room for a new frame, replacing the oldest one. All frames age by
+ * one.
+ *
+ * Returns: the memory of the new frame, with age 0. It still contains the
+ * oldest frame and has to be filled by the caller.
+ */
+guint32 *
+gst_effectv_history_push (GstEffectvHistory * history)
+{
+  history->head = (history->head + 1) % history->n_frames;
+  if (history->n_filled < history->n_frames)
+    history->n_filled++;
+
+  return history->frames + history->head * history->frame_size;
+}
+
+/**
+ * gst_effectv_history_get_frame:
+ * @history: a #GstEffectvHistory
+ * @age: how many frames to go back, 0 is the newest frame
+ *
+ * Returns: the frame pushed @age frames ago. Frames that were never pushed
+ * are black.
+ */
+guint32 *
+gst_effectv_history_get_frame (GstEffectvHistory * history, guint age)
+{
+  guint slot;
+
+  g_return_val_if_fail (age < history->n_frames, NULL);
+
+  slot = (history->head + history->n_frames - age) % history->n_frames;
+
+  return history->frames + slot * history->frame_size;
+}
@@ -0,0 +1,49 @@
+/* GStreamer
+ *
+ * gsteffectvhistory.h: ring of past frames for the effects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_EFFECTV_HISTORY_H__
+#define __GST_EFFECTV_HISTORY_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstEffectvHistory GstEffectvHistory;
+
+GstEffectvHistory * gst_effectv_history_new   (guint n_frames, guint width,
+                                               guint height);
+GstEffectvHistory * gst_effectv_history_ref   (GstEffectvHistory *history);
+void      gst_effectv_history_unref           (GstEffectvHistory *history);
+
+gboolean  gst_effectv_history_is_compatible   (GstEffectvHistory *history,
+                                               guint n_frames, guint width,
+                                               guint height);
+void      gst_effectv_history_clear           (GstEffectvHistory *history);
+
+guint     gst_effectv_history_get_n_frames    (GstEffectvHistory *history);
+guint     gst_effectv_history_get_n_filled    (GstEffectvHistory *history);
+
+guint32 * gst_effectv_history_push            (GstEffectvHistory *history);
+guint32 * gst_effectv_history_get_frame       (GstEffectvHistory *history,
+                                               guint age);
+
+G_END_DECLS
+
+#endif /* __GST_EFFECTV_HISTORY_H__ */
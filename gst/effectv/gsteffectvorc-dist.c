@@ -0,0 +1,1019 @@
+
+/* autogenerated from gsteffectvorc.orc */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <glib.h>
+
+#ifndef _ORC_INTEGER_TYPEDEFS_
+#define _ORC_INTEGER_TYPEDEFS_
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#include <stdint.h>
+typedef int8_t orc_int8;
+typedef int16_t orc_int16;
+typedef int32_t orc_int32;
+typedef int64_t orc_int64;
+typedef uint8_t orc_uint8;
+typedef uint16_t orc_uint16;
+typedef uint32_t orc_uint32;
+typedef uint64_t orc_uint64;
+#define ORC_UINT64_C(x) UINT64_C(x)
+#elif defined(_MSC_VER)
+typedef signed __int8 orc_int8;
+typedef signed __int16 orc_int16;
+typedef signed __int32 orc_int32;
+typedef signed __int64 orc_int64;
+typedef unsigned __int8 orc_uint8;
+typedef unsigned __int16 orc_uint16;
+typedef unsigned __int32 orc_uint32;
+typedef unsigned __int64 orc_uint64;
+#define ORC_UINT64_C(x) (x##Ui64)
+#define inline __inline
+#else
+#include <limits.h>
+typedef signed char orc_int8;
+typedef short orc_int16;
+typedef int orc_int32;
+typedef unsigned char orc_uint8;
+typedef unsigned short orc_uint16;
+typedef unsigned int orc_uint32;
+#if INT_MAX == LONG_MAX
+typedef long long orc_int64;
+typedef unsigned long long orc_uint64;
+#define ORC_UINT64_C(x) (x##ULL)
+#else
+typedef long orc_int64;
+typedef unsigned long orc_uint64;
+#define ORC_UINT64_C(x) (x##UL)
+#endif
+#endif
+typedef union
+{
+  orc_int16 i;
+  orc_int8 x2[2];
+} orc_union16;
+typedef union
+{
+  orc_int32 i;
+  float f;
+  orc_int16 x2[2];
+  orc_int8 x4[4];
+} orc_union32;
+typedef union
+{
+  orc_int64 i;
+  double f;
+  orc_int32 x2[2];
+  float x2f[2];
+  orc_int16 x4[4];
+} orc_union64;
+#endif
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+
+#ifndef ORC_INTERNAL
+#if defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x550)
+#define ORC_INTERNAL __hidden
+#elif defined (__GNUC__)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define ORC_INTERNAL
+#endif
+#endif
+
+
+#ifndef DISABLE_ORC
+#include <orc/orc.h>
+#endif
+void effectv_orc_streak_mask4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n);
+void effectv_orc_streak_mask8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n);
+void effectv_orc_streak_sum4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4, int n);
+void effectv_orc_streak_sum8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4,
+    const guint32 * ORC_RESTRICT s5, const guint32 * ORC_RESTRICT s6,
+    const guint32 * ORC_RESTRICT s7, const guint32 * ORC_RESTRICT s8, int n);
+void effectv_orc_vertigo_blend (guint32 * ORC_RESTRICT d1,
+    guint32 * ORC_RESTRICT d2, const guint32 * ORC_RESTRICT s1,
+    const guint32 * ORC_RESTRICT s2, int n);
+
+
+/* begin Orc C target preamble */
+#define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
+#define ORC_ABS(a) ((a)<0 ? -(a) : (a))
+#define ORC_MIN(a,b) ((a)<(b) ? (a) : (b))
+#define ORC_MAX(a,b) ((a)>(b) ? (a) : (b))
+#define ORC_SB_MAX 127
+#define ORC_SB_MIN (-1-ORC_SB_MAX)
+#define ORC_UB_MAX 255
+#define ORC_UB_MIN 0
+#define ORC_SW_MAX 32767
+#define ORC_SW_MIN (-1-ORC_SW_MAX)
+#define ORC_UW_MAX 65535
+#define ORC_UW_MIN 0
+#define ORC_SL_MAX 2147483647
+#define ORC_SL_MIN (-1-ORC_SL_MAX)
+#define ORC_UL_MAX 4294967295U
+#define ORC_UL_MIN 0
+#define ORC_CLAMP_SB(x) ORC_CLAMP(x,ORC_SB_MIN,ORC_SB_MAX)
+#define ORC_CLAMP_UB(x) ORC_CLAMP(x,ORC_UB_MIN,ORC_UB_MAX)
+#define ORC_CLAMP_SW(x) ORC_CLAMP(x,ORC_SW_MIN,ORC_SW_MAX)
+#define ORC_CLAMP_UW(x) ORC_CLAMP(x,ORC_UW_MIN,ORC_UW_MAX)
+#define ORC_CLAMP_SL(x) ORC_CLAMP(x,ORC_SL_MIN,ORC_SL_MAX)
+#define ORC_CLAMP_UL(x) ORC_CLAMP(x,ORC_UL_MIN,ORC_UL_MAX)
+#define ORC_SWAP_W(x) ((((x)&0xff)<<8) | (((x)&0xff00)>>8))
+#define ORC_SWAP_L(x) ((((x)&0xff)<<24) | (((x)&0xff00)<<8) | (((x)&0xff0000)>>8) | (((x)&0xff000000)>>24))
+#define ORC_SWAP_Q(x) ((((x)&ORC_UINT64_C(0xff))<<56) | (((x)&ORC_UINT64_C(0xff00))<<40) | (((x)&ORC_UINT64_C(0xff0000))<<24) | (((x)&ORC_UINT64_C(0xff000000))<<8) | (((x)&ORC_UINT64_C(0xff00000000))>>8) | (((x)&ORC_UINT64_C(0xff0000000000))>>24) | (((x)&ORC_UINT64_C(0xff000000000000))>>40) | (((x)&ORC_UINT64_C(0xff00000000000000))>>56))
+#define ORC_PTR_OFFSET(ptr,offset) ((void *)(((unsigned char *)(ptr)) + (offset)))
+#define ORC_DENORMAL(x) ((x) & ((((x)&0x7f800000) == 0) ? 0xff800000 : 0xffffffff))
+#define ORC_ISNAN(x) ((((x)&0x7f800000) == 0x7f800000) && (((x)&0x007fffff) != 0))
+#define ORC_DENORMAL_DOUBLE(x) ((x) & ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == 0) ? ORC_UINT64_C(0xfff0000000000000) : ORC_UINT64_C(0xffffffffffffffff)))
+#define ORC_ISNAN_DOUBLE(x) ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == ORC_UINT64_C(0x7ff0000000000000)) && (((x)&ORC_UINT64_C(0x000fffffffffffff)) != 0))
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+/* end Orc C target preamble */
+
+/* effectv_orc_streak_mask4 */
+#ifdef DISABLE_ORC
+void
+effectv_orc_streak_mask4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var34.i = (int) 0xfcfcfcfc; /* -50529028 or 2.09703e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 2: andl */
+    var35.i = var32.i & var34.i;
+    /* 3: shrul */
+    var33.i = ((orc_uint32) var35.i) >> 2;
+    /* 4: storel */
+    ptr0[i] = var33;
+  }
+
+}
+
+#else
+static void
+_backup_effectv_orc_streak_mask4 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var34.i = (int) 0xfcfcfcfc; /* -50529028 or 2.09703e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 2: andl */
+    var35.i = var32.i & var34.i;
+    /* 3: shrul */
+    var33.i = ((orc_uint32) var35.i) >> 2;
+    /* 4: storel */
+    ptr0[i] = var33;
+  }
+
+}
+
+void
+effectv_orc_streak_mask4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 24, 101, 102, 102, 101, 99, 116, 118, 95, 111, 114, 99, 95, 115,
+        116, 114, 101, 97, 107, 95, 109, 97, 115, 107, 52, 11, 4, 4, 12, 4,
+        4, 14, 4, 252, 252, 252, 252, 14, 4, 2, 0, 0, 0, 20, 4, 106,
+        32, 4, 16, 126, 0, 32, 17, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_mask4);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "effectv_orc_streak_mask4");
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_mask4);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0xfcfcfcfc, "c1");
+      orc_program_add_constant (p, 4, 0x00000002, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "andl", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_C2, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* effectv_orc_streak_mask8 */
+#ifdef DISABLE_ORC
+void
+effectv_orc_streak_mask8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var34.i = (int) 0xf8f8f8f8; /* -117901064 or 2.06374e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 2: andl */
+    var35.i = var32.i & var34.i;
+    /* 3: shrul */
+    var33.i = ((orc_uint32) var35.i) >> 3;
+    /* 4: storel */
+    ptr0[i] = var33;
+  }
+
+}
+
+#else
+static void
+_backup_effectv_orc_streak_mask8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var34.i = (int) 0xf8f8f8f8; /* -117901064 or 2.06374e-314f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 2: andl */
+    var35.i = var32.i & var34.i;
+    /* 3: shrul */
+    var33.i = ((orc_uint32) var35.i) >> 3;
+    /* 4: storel */
+    ptr0[i] = var33;
+  }
+
+}
+
+void
+effectv_orc_streak_mask8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 24, 101, 102, 102, 101, 99, 116, 118, 95, 111, 114, 99, 95, 115,
+        116, 114, 101, 97, 107, 95, 109, 97, 115, 107, 56, 11, 4, 4, 12, 4,
+        4, 14, 4, 248, 248, 248, 248, 14, 4, 3, 0, 0, 0, 20, 4, 106,
+        32, 4, 16, 126, 0, 32, 17, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_mask8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "effectv_orc_streak_mask8");
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_mask8);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0xf8f8f8f8, "c1");
+      orc_program_add_constant (p, 4, 0x00000003, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "andl", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_C2, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* effectv_orc_streak_sum4 */
+#ifdef DISABLE_ORC
+void
+effectv_orc_streak_sum4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+  ptr6 = (orc_union32 *) s3;
+  ptr7 = (orc_union32 *) s4;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 2: loadl */
+    var34 = ptr6[i];
+    /* 3: loadl */
+    var35 = ptr7[i];
+    /* 4: addl */
+    var37.i = var32.i + var33.i;
+    /* 5: addl */
+    var38.i = var34.i + var35.i;
+    /* 6: addl */
+    var36.i = var37.i + var38.i;
+    /* 7: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_effectv_orc_streak_sum4 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+  ptr6 = (orc_union32 *) ex->arrays[6];
+  ptr7 = (orc_union32 *) ex->arrays[7];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 2: loadl */
+    var34 = ptr6[i];
+    /* 3: loadl */
+    var35 = ptr7[i];
+    /* 4: addl */
+    var37.i = var32.i + var33.i;
+    /* 5: addl */
+    var38.i = var34.i + var35.i;
+    /* 6: addl */
+    var36.i = var37.i + var38.i;
+    /* 7: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+effectv_orc_streak_sum4 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 23, 101, 102, 102, 101, 99, 116, 118, 95, 111, 114, 99, 95, 115,
+        116, 114, 101, 97, 107, 95, 115, 117, 109, 52, 11, 4, 4, 12, 4, 4,
+        12, 4, 4, 12, 4, 4, 12, 4, 4, 20, 4, 20, 4, 103, 32, 4,
+        5, 103, 33, 6, 7, 103, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_sum4);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "effectv_orc_streak_sum4");
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_sum4);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_source (p, 4, "s3");
+      orc_program_add_source (p, 4, "s4");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_S2, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T2, ORC_VAR_S3,
+          ORC_VAR_S4, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_T2, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* effectv_orc_streak_sum8 */
+#ifdef DISABLE_ORC
+void
+effectv_orc_streak_sum8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4,
+    const guint32 * ORC_RESTRICT s5, const guint32 * ORC_RESTRICT s6,
+    const guint32 * ORC_RESTRICT s7, const guint32 * ORC_RESTRICT s8, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  const orc_union32 *ORC_RESTRICT ptr8;
+  const orc_union32 *ORC_RESTRICT ptr9;
+  const orc_union32 *ORC_RESTRICT ptr10;
+  const orc_union32 *ORC_RESTRICT ptr11;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+  ptr6 = (orc_union32 *) s3;
+  ptr7 = (orc_union32 *) s4;
+  ptr8 = (orc_union32 *) s5;
+  ptr9 = (orc_union32 *) s6;
+  ptr10 = (orc_union32 *) s7;
+  ptr11 = (orc_union32 *) s8;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 2: loadl */
+    var34 = ptr6[i];
+    /* 3: loadl */
+    var35 = ptr7[i];
+    /* 4: loadl */
+    var36 = ptr8[i];
+    /* 5: loadl */
+    var37 = ptr9[i];
+    /* 6: loadl */
+    var38 = ptr10[i];
+    /* 7: loadl */
+    var39 = ptr11[i];
+    /* 8: addl */
+    var41.i = var32.i + var33.i;
+    /* 9: addl */
+    var42.i = var34.i + var35.i;
+    /* 10: addl */
+    var43.i = var36.i + var37.i;
+    /* 11: addl */
+    var44.i = var38.i + var39.i;
+    /* 12: addl */
+    var45.i = var41.i + var42.i;
+    /* 13: addl */
+    var46.i = var43.i + var44.i;
+    /* 14: addl */
+    var40.i = var45.i + var46.i;
+    /* 15: storel */
+    ptr0[i] = var40;
+  }
+
+}
+
+#else
+static void
+_backup_effectv_orc_streak_sum8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  const orc_union32 *ORC_RESTRICT ptr8;
+  const orc_union32 *ORC_RESTRICT ptr9;
+  const orc_union32 *ORC_RESTRICT ptr10;
+  const orc_union32 *ORC_RESTRICT ptr11;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+  ptr6 = (orc_union32 *) ex->arrays[6];
+  ptr7 = (orc_union32 *) ex->arrays[7];
+  ptr8 = (orc_union32 *) ex->arrays[8];
+  ptr9 = (orc_union32 *) ex->arrays[9];
+  ptr10 = (orc_union32 *) ex->arrays[10];
+  ptr11 = (orc_union32 *) ex->arrays[11];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 2: loadl */
+    var34 = ptr6[i];
+    /* 3: loadl */
+    var35 = ptr7[i];
+    /* 4: loadl */
+    var36 = ptr8[i];
+    /* 5: loadl */
+    var37 = ptr9[i];
+    /* 6: loadl */
+    var38 = ptr10[i];
+    /* 7: loadl */
+    var39 = ptr11[i];
+    /* 8: addl */
+    var41.i = var32.i + var33.i;
+    /* 9: addl */
+    var42.i = var34.i + var35.i;
+    /* 10: addl */
+    var43.i = var36.i + var37.i;
+    /* 11: addl */
+    var44.i = var38.i + var39.i;
+    /* 12: addl */
+    var45.i = var41.i + var42.i;
+    /* 13: addl */
+    var46.i = var43.i + var44.i;
+    /* 14: addl */
+    var40.i = var45.i + var46.i;
+    /* 15: storel */
+    ptr0[i] = var40;
+  }
+
+}
+
+void
+effectv_orc_streak_sum8 (guint32 * ORC_RESTRICT d1,
+    const guint32 * ORC_RESTRICT s1, const guint32 * ORC_RESTRICT s2,
+    const guint32 * ORC_RESTRICT s3, const guint32 * ORC_RESTRICT s4,
+    const guint32 * ORC_RESTRICT s5, const guint32 * ORC_RESTRICT s6,
+    const guint32 * ORC_RESTRICT s7, const guint32 * ORC_RESTRICT s8, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 23, 101, 102, 102, 101, 99, 116, 118, 95, 111, 114, 99, 95, 115,
+        116, 114, 101, 97, 107, 95, 115, 117, 109, 56, 11, 4, 4, 12, 4, 4,
+        12, 4, 4, 12, 4, 4, 12, 4, 4, 12, 4, 4, 12, 4, 4, 12,
+        4, 4, 12, 4, 4, 20, 4, 20, 4, 20, 4, 20, 4, 20, 4, 20,
+        4, 103, 32, 4, 5, 103, 33, 6, 7, 103, 34, 8, 9, 103, 35, 10,
+        11, 103, 36, 32, 33, 103, 37, 34, 35, 103, 0, 36, 37, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_sum8);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "effectv_orc_streak_sum8");
+      orc_program_set_backup_function (p, _backup_effectv_orc_streak_sum8);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_source (p, 4, "s3");
+      orc_program_add_source (p, 4, "s4");
+      orc_program_add_source (p, 4, "s5");
+      orc_program_add_source (p, 4, "s6");
+      orc_program_add_source (p, 4, "s7");
+      orc_program_add_source (p, 4, "s8");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+      orc_program_add_temporary (p, 4, "t4");
+      orc_program_add_temporary (p, 4, "t5");
+      orc_program_add_temporary (p, 4, "t6");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_S2, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T2, ORC_VAR_S3,
+          ORC_VAR_S4, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T3, ORC_VAR_S5,
+          ORC_VAR_S6, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T4, ORC_VAR_S7,
+          ORC_VAR_S8, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T5, ORC_VAR_T1,
+          ORC_VAR_T2, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T6, ORC_VAR_T3,
+          ORC_VAR_T4, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_T5,
+          ORC_VAR_T6, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+  ex->arrays[ORC_VAR_S8] = (void *) s8;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* effectv_orc_vertigo_blend */
+#ifdef DISABLE_ORC
+void
+effectv_orc_vertigo_blend (guint32 * ORC_RESTRICT d1,
+    guint32 * ORC_RESTRICT d2, const guint32 * ORC_RESTRICT s1,
+    const guint32 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 *ORC_RESTRICT ptr1;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr1 = (orc_union32 *) d2;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+  /* 2: loadpl */
+  var36.i = (int) 0x00fcfcff; /* 16579839 or 8.19153e-317f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 3: andl */
+    var37.i = var32.i & var36.i;
+    /* 4: shll */
+    var38.i = ((orc_uint32) var37.i) << 1;
+    /* 5: addl */
+    var39.i = var38.i + var37.i;
+    /* 6: andl */
+    var40.i = var33.i & var36.i;
+    /* 7: addl */
+    var41.i = var39.i + var40.i;
+    /* 8: shrul */
+    var42.i = ((orc_uint32) var41.i) >> 2;
+    /* 9: copyl */
+    var34.i = var42.i;
+    /* 10: copyl */
+    var35.i = var42.i;
+    /* 11: storel */
+    ptr0[i] = var34;
+    /* 12: storel */
+    ptr1[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_effectv_orc_vertigo_blend (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  orc_union32 *ORC_RESTRICT ptr1;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var32;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr1 = (orc_union32 *) ex->arrays[1];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+  /* 2: loadpl */
+  var36.i = (int) 0x00fcfcff; /* 16579839 or 8.19153e-317f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var32 = ptr4[i];
+    /* 1: loadl */
+    var33 = ptr5[i];
+    /* 3: andl */
+    var37.i = var32.i & var36.i;
+    /* 4: shll */
+    var38.i = ((orc_uint32) var37.i) << 1;
+    /* 5: addl */
+    var39.i = var38.i + var37.i;
+    /* 6: andl */
+    var40.i = var33.i & var36.i;
+    /* 7: addl */
+    var41.i = var39.i + var40.i;
+    /* 8: shrul */
+    var42.i = ((orc_uint32) var41.i) >> 2;
+    /* 9: copyl */
+    var34.i = var42.i;
+    /* 10: copyl */
+    var35.i = var42.i;
+    /* 11: storel */
+    ptr0[i] = var34;
+    /* 12: storel */
+    ptr1[i] = var35;
+  }
+
+}
+
+void
+effectv_orc_vertigo_blend (guint32 * ORC_RESTRICT d1,
+    guint32 * ORC_RESTRICT d2, const guint32 * ORC_RESTRICT s1,
+    const guint32 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 25, 101, 102, 102, 101, 99, 116, 118, 95, 111, 114, 99, 95, 118,
+        101, 114, 116, 105, 103, 111, 95, 98, 108, 101, 110, 100, 11, 4, 4, 11,
+        4, 4, 12, 4, 4, 12, 4, 4, 14, 4, 255, 252, 252, 0, 14, 4,
+        1, 0, 0, 0, 14, 4, 2, 0, 0, 0, 20, 4, 20, 4, 20, 4,
+        20, 4, 20, 4, 20, 4, 106, 32, 4, 16, 124, 33, 32, 17, 103, 34,
+        33, 32, 106, 35, 5, 16, 103, 36, 34, 35, 126, 37, 36, 18, 112, 0,
+        37, 112, 1, 37, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_effectv_orc_vertigo_blend);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "effectv_orc_vertigo_blend");
+      orc_program_set_backup_function (p, _backup_effectv_orc_vertigo_blend);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_destination (p, 4, "d2");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_constant (p, 4, 0x00fcfcff, "c1");
+      orc_program_add_constant (p, 4, 0x00000001, "c2");
+      orc_program_add_constant (p, 4, 0x00000002, "c3");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+      orc_program_add_temporary (p, 4, "t4");
+      orc_program_add_temporary (p, 4, "t5");
+      orc_program_add_temporary (p, 4, "t6");
+
+      orc_program_append_2 (p, "andl", 0, ORC_VAR_T1, ORC_VAR_S1,
+          ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "shll", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_C2, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T3, ORC_VAR_T2,
+          ORC_VAR_T1, ORC_VAR_D1);
+      orc_program_append_2 (p, "andl", 0, ORC_VAR_T4, ORC_VAR_S2,
+          ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T5, ORC_VAR_T3,
+          ORC_VAR_T4, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_T6, ORC_VAR_T5,
+          ORC_VAR_C3, ORC_VAR_D1);
+      orc_program_append_2 (p, "copyl", 0, ORC_VAR_D1, ORC_VAR_T6,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "copyl", 0, ORC_VAR_D2, ORC_VAR_T6,
+          ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
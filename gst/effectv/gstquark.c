@@ -51,6 +51,7 @@
 /* number of frames of time-buffer. It should be as a configurable paramater */
 /* This number also must be 2^n just for the speed. */
 #define PLANES 16
+#define MAX_PLANES 64
 
 enum
 {
@@ -61,8 +62,6 @@ enum
 #define gst_quarktv_parent_class parent_class
 G_DEFINE_TYPE (GstQuarkTV, gst_quarktv, GST_TYPE_VIDEO_FILTER);
 
-static void gst_quarktv_planetable_clear (GstQuarkTV * filter);
-
 static GstStaticPadTemplate gst_quarktv_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -82,13 +81,14 @@ gst_quarktv_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
   GstQuarkTV *filter = GST_QUARKTV (vfilter);
-  gint width, height;
-
-  width = GST_VIDEO_INFO_WIDTH (in_info);
-  height = GST_VIDEO_INFO_HEIGHT (in_info);
 
-  gst_quarktv_planetable_clear (filter);
-  filter->area = width * height;
+  /* the history is made for the new size on the next frame */
+  GST_OBJECT_LOCK (filter);
+  if (filter->history) {
+    gst_effectv_history_unref (filter->history);
+    filter->history = NULL;
+  }
+  GST_OBJECT_UNLOCK (filter);
 
   return TRUE;
 }
@@ -98,11 +98,12 @@ gst_quarktv_transform_frame (GstVideoFilter * vfilter, GstVideoFrame * in_frame,
     GstVideoFrame * out_frame)
 {
   GstQuarkTV *filter = GST_QUARKTV (vfilter);
-  gint area;
-  guint32 *src, *dest;
+  gint x, y, i, width, height, sstride, dstride;
+  guint8 *src, *dest;
+  guint32 *d, *frame;
+  const guint32 *frames[MAX_PLANES];
   GstClockTime timestamp;
-  GstBuffer **planetable;
-  gint planes, current_plane;
+  gint planes, n_filled;
 
   timestamp = GST_BUFFER_TIMESTAMP (in_frame->buffer);
   timestamp =
@@ -115,71 +116,57 @@ gst_quarktv_transform_frame (GstVideoFilter * vfilter, GstVideoFrame * in_frame,
   if (GST_CLOCK_TIME_IS_VALID (timestamp))
     gst_object_sync_values (GST_OBJECT (filter), timestamp);
 
-  if (G_UNLIKELY (filter->planetable == NULL))
-    return GST_FLOW_FLUSHING;
-
   src = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
+  sstride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0);
   dest = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
+  dstride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
+
+  width = GST_VIDEO_FRAME_WIDTH (in_frame);
+  height = GST_VIDEO_FRAME_HEIGHT (in_frame);
 
   GST_OBJECT_LOCK (filter);
-  area = filter->area;
-  planetable = filter->planetable;
-  planes = filter->planes;
-  current_plane = filter->current_plane;
-
-  if (planetable[current_plane])
-    gst_buffer_unref (planetable[current_plane]);
-  planetable[current_plane] = gst_buffer_ref (in_frame->buffer);
-
-  /* For each pixel */
-  while (--area) {
-    GstBuffer *rand;
-
-    /* pick a random buffer */
-    rand = planetable[(current_plane + (fastrand () >> 24)) % planes];
-
-    /* Copy the pixel from the random buffer to dest, FIXME, slow */
-    if (rand)
-      gst_buffer_extract (rand, area * 4, &dest[area], 4);
-    else
-      dest[area] = src[area];
+  planes = MAX (filter->planes, 1);
+
+  if (filter->history == NULL
+      || !gst_effectv_history_is_compatible (filter->history, planes, width,
+          height)) {
+    if (filter->history)
+      gst_effectv_history_unref (filter->history);
+    filter->history = gst_effectv_history_new (planes, width, height);
   }
 
-  filter->current_plane--;
-  if (filter->current_plane < 0)
-    filter->current_plane = planes - 1;
+  /* keep a copy of the frame instead of a ref to the buffer, so that the
+   * pixels can be read directly and the buffers go back to their pool */
+  frame = gst_effectv_history_push (filter->history);
+  for (y = 0; y < height; y++)
+    memcpy (frame + y * width, src + y * sstride, width * 4);
+
+  /* the frames that were not seen yet are replaced by the current one */
+  n_filled = gst_effectv_history_get_n_filled (filter->history);
+  for (i = 0; i < planes; i++)
+    frames[i] = gst_effectv_history_get_frame (filter->history,
+        i < n_filled ? i : 0);
+
+  /* For each pixel pick a random frame */
+  for (y = 0; y < height; y++) {
+    d = (guint32 *) (dest + y * dstride);
+    for (x = 0; x < width; x++)
+      d[x] = frames[(fastrand () >> 24) % planes][y * width + x];
+  }
   GST_OBJECT_UNLOCK (filter);
 
   return GST_FLOW_OK;
 }
 
-static void
-gst_quarktv_planetable_clear (GstQuarkTV * filter)
-{
-  gint i;
-
-  if (filter->planetable == NULL)
-    return;
-
-  for (i = 0; i < filter->planes; i++) {
-    if (GST_IS_BUFFER (filter->planetable[i])) {
-      gst_buffer_unref (filter->planetable[i]);
-    }
-    filter->planetable[i] = NULL;
-  }
-}
-
 static gboolean
 gst_quarktv_start (GstBaseTransform * trans)
 {
   GstQuarkTV *filter = GST_QUARKTV (trans);
 
-  if (filter->planetable) {
-    gst_quarktv_planetable_clear (filter);
-    g_free (filter->planetable);
-  }
-  filter->planetable =
-      (GstBuffer **) g_malloc0 (filter->planes * sizeof (GstBuffer *));
+  GST_OBJECT_LOCK (filter);
+  if (filter->history)
+    gst_effectv_history_clear (filter->history);
+  GST_OBJECT_UNLOCK (filter);
 
   return TRUE;
 }
@@ -189,10 +176,9 @@ gst_quarktv_finalize (GObject * object)
 {
   GstQuarkTV *filter = GST_QUARKTV (object);
 
-  if (filter->planetable) {
-    gst_quarktv_planetable_clear (filter);
-    g_free (filter->planetable);
-    filter->planetable = NULL;
+  if (filter->history) {
+    gst_effectv_history_unref (filter->history);
+    filter->history = NULL;
   }
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -207,33 +193,9 @@ gst_quarktv_set_property (GObject * object, guint prop_id, const GValue * value,
   GST_OBJECT_LOCK (filter);
   switch (prop_id) {
     case PROP_PLANES:
-    {
-      gint new_n_planes = g_value_get_int (value);
-      GstBuffer **new_planetable;
-      gint i;
-
-      /* If the number of planes changed, copy across any existing planes */
-      if (new_n_planes != filter->planes) {
-        new_planetable =
-            (GstBuffer **) g_malloc0 (new_n_planes * sizeof (GstBuffer *));
-
-        if (filter->planetable) {
-          for (i = 0; (i < new_n_planes) && (i < filter->planes); i++) {
-            new_planetable[i] = filter->planetable[i];
-          }
-          for (; i < filter->planes; i++) {
-            if (filter->planetable[i])
-              gst_buffer_unref (filter->planetable[i]);
-          }
-          g_free (filter->planetable);
-        }
-
-        filter->planetable = new_planetable;
-        filter->planes = new_n_planes;
-        filter->current_plane = filter->planes - 1;
-      }
+      /* the history is resized on the next frame */
+      filter->planes = g_value_get_int (value);
       break;
-    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -272,7 +234,7 @@ gst_quarktv_class_init (GstQuarkTVClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_PLANES,
       g_param_spec_int ("planes", "Planes",
-          "Number of planes", 0, 64, PLANES,
+          "Number of planes", 0, MAX_PLANES, PLANES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE));
 
   gst_element_class_set_static_metadata (gstelement_class, "QuarkTV effect",
@@ -295,5 +257,4 @@ static void
 gst_quarktv_init (GstQuarkTV * filter)
 {
   filter->planes = PLANES;
-  filter->current_plane = filter->planes - 1;
 }
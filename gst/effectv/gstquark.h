@@ -32,6 +32,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include "gsteffectvhistory.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_QUARKTV \
@@ -53,10 +55,8 @@ struct _GstQuarkTV
   GstVideoFilter element;
 
   /* < private > */
-  gint area;
   gint planes;
-  gint current_plane;
-  GstBuffer **planetable;
+  GstEffectvHistory *history;
 };
 
 struct _GstQuarkTVClass
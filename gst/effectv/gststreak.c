@@ -50,6 +50,7 @@
 
 #include "gststreak.h"
 #include "gsteffectv.h"
+#include "gsteffectvorc.h"
 
 #define DEFAULT_FEEDBACK FALSE
 
@@ -82,60 +83,54 @@ gst_streaktv_transform_frame (GstVideoFilter * vfilter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstStreakTV *filter = GST_STREAKTV (vfilter);
-  guint32 *src, *dest;
-  gint i, cf;
-  gint video_area, width, height;
-  guint32 **planetable = filter->planetable;
-  gint plane = filter->plane;
-  guint stride_mask, stride_shift, stride;
+  guint8 *src, *dest;
+  guint32 *s, *d, *frame;
+  const guint32 *past[8];
+  gint i, y, width, height, sstride, dstride;
+  GstEffectvHistory *history;
 
   src = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
+  sstride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0);
   dest = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
+  dstride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
 
   width = GST_VIDEO_FRAME_WIDTH (in_frame);
   height = GST_VIDEO_FRAME_HEIGHT (in_frame);
 
-  video_area = width * height;
-
   GST_OBJECT_LOCK (filter);
-  if (filter->feedback) {
-    stride_mask = 0xfcfcfcfc;
-    stride = 8;
-    stride_shift = 2;
-  } else {
-    stride_mask = 0xf8f8f8f8;
-    stride = 4;
-    stride_shift = 3;
-  }
+  history = filter->history;
+  frame = gst_effectv_history_push (history);
 
-  for (i = 0; i < video_area; i++) {
-    planetable[plane][i] = (src[i] & stride_mask) >> stride_shift;
-  }
-
-  cf = plane & (stride - 1);
   if (filter->feedback) {
-    for (i = 0; i < video_area; i++) {
-      dest[i] = planetable[cf][i]
-          + planetable[cf + stride][i]
-          + planetable[cf + stride * 2][i]
-          + planetable[cf + stride * 3][i];
-      planetable[plane][i] = (dest[i] & stride_mask) >> stride_shift;
+    /* the sum of every 8th frame, the result is fed back into the history */
+    for (i = 0; i < 4; i++)
+      past[i] = gst_effectv_history_get_frame (history, i * 8);
+
+    for (y = 0; y < height; y++) {
+      s = (guint32 *) (src + y * sstride);
+      d = (guint32 *) (dest + y * dstride);
+
+      effectv_orc_streak_mask4 (frame + y * width, s, width);
+      effectv_orc_streak_sum4 (d, past[0] + y * width, past[1] + y * width,
+          past[2] + y * width, past[3] + y * width, width);
+      effectv_orc_streak_mask4 (frame + y * width, d, width);
     }
   } else {
-    for (i = 0; i < video_area; i++) {
-      dest[i] = planetable[cf][i]
-          + planetable[cf + stride][i]
-          + planetable[cf + stride * 2][i]
-          + planetable[cf + stride * 3][i]
-          + planetable[cf + stride * 4][i]
-          + planetable[cf + stride * 5][i]
-          + planetable[cf + stride * 6][i]
-          + planetable[cf + stride * 7][i];
+    /* the sum of every 4th frame */
+    for (i = 0; i < 8; i++)
+      past[i] = gst_effectv_history_get_frame (history, i * 4);
+
+    for (y = 0; y < height; y++) {
+      s = (guint32 *) (src + y * sstride);
+      d = (guint32 *) (dest + y * dstride);
+
+      effectv_orc_streak_mask8 (frame + y * width, s, width);
+      effectv_orc_streak_sum8 (d, past[0] + y * width, past[1] + y * width,
+          past[2] + y * width, past[3] + y * width, past[4] + y * width,
+          past[5] + y * width, past[6] + y * width, past[7] + y * width,
+          width);
     }
   }
-
-  plane++;
-  filter->plane = plane & (PLANES - 1);
   GST_OBJECT_UNLOCK (filter);
 
   return GST_FLOW_OK;
@@ -146,18 +141,22 @@ gst_streaktv_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
   GstStreakTV *filter = GST_STREAKTV (vfilter);
-  gint i, width, height;
+  gint width, height;
 
   width = GST_VIDEO_INFO_WIDTH (in_info);
   height = GST_VIDEO_INFO_HEIGHT (in_info);
 
-  if (filter->planebuffer)
-    g_free (filter->planebuffer);
-
-  filter->planebuffer = g_new0 (guint32, width * height * 4 * PLANES);
-
-  for (i = 0; i < PLANES; i++)
-    filter->planetable[i] = &filter->planebuffer[width * height * i];
+  GST_OBJECT_LOCK (filter);
+  if (filter->history
+      && gst_effectv_history_is_compatible (filter->history, PLANES, width,
+          height)) {
+    gst_effectv_history_clear (filter->history);
+  } else {
+    if (filter->history)
+      gst_effectv_history_unref (filter->history);
+    filter->history = gst_effectv_history_new (PLANES, width, height);
+  }
+  GST_OBJECT_UNLOCK (filter);
 
   return TRUE;
 }
@@ -167,7 +166,10 @@ gst_streaktv_start (GstBaseTransform * trans)
 {
   GstStreakTV *filter = GST_STREAKTV (trans);
 
-  filter->plane = 0;
+  GST_OBJECT_LOCK (filter);
+  if (filter->history)
+    gst_effectv_history_clear (filter->history);
+  GST_OBJECT_UNLOCK (filter);
 
   return TRUE;
 }
@@ -177,9 +179,9 @@ gst_streaktv_finalize (GObject * object)
 {
   GstStreakTV *filter = GST_STREAKTV (object);
 
-  if (filter->planebuffer) {
-    g_free (filter->planebuffer);
-    filter->planebuffer = NULL;
+  if (filter->history) {
+    gst_effectv_history_unref (filter->history);
+    filter->history = NULL;
   }
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
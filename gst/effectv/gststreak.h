@@ -32,6 +32,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include "gsteffectvhistory.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_STREAKTV \
@@ -57,9 +59,7 @@ struct _GstStreakTV
   /* < private > */
   gboolean feedback;
 
-  guint32 *planebuffer;
-  guint32 *planetable[PLANES];
-  gint plane;
+  GstEffectvHistory *history;
 };
 
 struct _GstStreakTVClass
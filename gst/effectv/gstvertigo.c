@@ -42,6 +42,7 @@
 #include <string.h>
 
 #include "gstvertigo.h"
+#include "gsteffectvorc.h"
 
 #define gst_vertigotv_parent_class parent_class
 G_DEFINE_TYPE (GstVertigoTV, gst_vertigotv, GST_TYPE_VIDEO_FILTER);
@@ -79,18 +80,23 @@ gst_vertigotv_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
   GstVertigoTV *filter = GST_VERTIGOTV (vfilter);
-  gint area, width, height;
+  gint width, height;
 
   width = GST_VIDEO_INFO_WIDTH (in_info);
   height = GST_VIDEO_INFO_HEIGHT (in_info);
 
-  area = width * height;
-
-  g_free (filter->buffer);
-  filter->buffer = (guint32 *) g_malloc0 (area * 2 * sizeof (guint32));
+  if (filter->history
+      && gst_effectv_history_is_compatible (filter->history, 2, width,
+          height)) {
+    gst_effectv_history_clear (filter->history);
+  } else {
+    if (filter->history)
+      gst_effectv_history_unref (filter->history);
+    filter->history = gst_effectv_history_new (2, width, height);
+  }
 
-  filter->current_buffer = filter->buffer;
-  filter->alt_buffer = filter->buffer + area;
+  g_free (filter->line);
+  filter->line = g_new (guint32, width);
   filter->phase = 0;
 
   return TRUE;
@@ -156,8 +162,7 @@ gst_vertigotv_transform_frame (GstVideoFilter * vfilter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstVertigoTV *filter = GST_VERTIGOTV (vfilter);
-  guint32 *src, *dest, *p;
-  guint32 v;
+  guint32 *src, *dest, *p, *prev, *line;
   gint x, y, ox, oy, i, width, height, area, sstride, dstride;
   GstClockTime timestamp, stream_time;
 
@@ -186,7 +191,9 @@ gst_vertigotv_transform_frame (GstVideoFilter * vfilter,
   dstride /= 4;
 
   gst_vertigotv_set_parms (filter);
-  p = filter->alt_buffer;
+  p = gst_effectv_history_push (filter->history);
+  prev = gst_effectv_history_get_frame (filter->history, 1);
+  line = filter->line;
 
   for (y = 0; y < height; y++) {
     ox = filter->sx;
@@ -197,26 +204,23 @@ gst_vertigotv_transform_frame (GstVideoFilter * vfilter,
       if (i < 0)
         i = 0;
       if (i >= area)
-        i = area;
+        i = area - 1;
 
-      v = filter->current_buffer[i] & 0xfcfcff;
-      v = (v * 3) + (src[x] & 0xfcfcff);
-
-      *p++ = dest[x] = (v >> 2);
+      line[x] = prev[i];
       ox += filter->dx;
       oy += filter->dy;
     }
     filter->sx -= filter->dy;
     filter->sy += filter->dx;
 
+    /* 3/4 of the zoomed previous output and 1/4 of the input */
+    effectv_orc_vertigo_blend (dest, p, line, src, width);
+
     src += sstride;
     dest += dstride;
+    p += width;
   }
 
-  p = filter->current_buffer;
-  filter->current_buffer = filter->alt_buffer;
-  filter->alt_buffer = p;
-
   return GST_FLOW_OK;
 }
 
@@ -274,8 +278,12 @@ gst_vertigotv_finalize (GObject * object)
 {
   GstVertigoTV *filter = GST_VERTIGOTV (object);
 
-  g_free (filter->buffer);
-  filter->buffer = NULL;
+  if (filter->history) {
+    gst_effectv_history_unref (filter->history);
+    filter->history = NULL;
+  }
+  g_free (filter->line);
+  filter->line = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -320,7 +328,6 @@ gst_vertigotv_class_init (GstVertigoTVClass * klass)
 static void
 gst_vertigotv_init (GstVertigoTV * filter)
 {
-  filter->buffer = NULL;
   filter->phase = 0.0;
   filter->phase_increment = 0.02;
   filter->zoomrate = 1.01;
@@ -29,6 +29,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include "gsteffectvhistory.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_VERTIGOTV \
@@ -50,8 +52,10 @@ struct _GstVertigoTV
   GstVideoFilter videofilter;
 
   /* < private > */
-  guint32 *buffer;
-  guint32 *current_buffer, *alt_buffer;
+  /* the previous and the current output */
+  GstEffectvHistory *history;
+  /* one line of pixels picked from the previous output */
+  guint32 *line;
   gint dx, dy;
   gint sx, sy;
   gdouble phase;
@@ -44,6 +44,10 @@ static void gst_iir_equalizer_child_proxy_interface_init (gpointer g_iface,
     gpointer iface_data);
 
 static void gst_iir_equalizer_finalize (GObject * object);
+static void gst_iir_equalizer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_iir_equalizer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_iir_equalizer_setup (GstAudioFilter * filter,
     const GstAudioInfo * info);
@@ -58,6 +62,14 @@ static GstFlowReturn gst_iir_equalizer_transform_ip (GstBaseTransform * btrans,
     " channels=(int)[1,MAX],"                                     \
     " layout=(string)interleaved"
 
+#define DEFAULT_SINGLE_PRECISION FALSE
+
+enum
+{
+  PROP_0,
+  PROP_SINGLE_PRECISION
+};
+
 #define gst_iir_equalizer_parent_class parent_class
 G_DEFINE_TYPE_WITH_CODE (GstIirEqualizer, gst_iir_equalizer,
     GST_TYPE_AUDIO_FILTER,
@@ -360,9 +372,26 @@ gst_iir_equalizer_class_init (GstIirEqualizerClass * klass)
   GstCaps *caps;
 
   gobject_class->finalize = gst_iir_equalizer_finalize;
+  gobject_class->set_property = gst_iir_equalizer_set_property;
+  gobject_class->get_property = gst_iir_equalizer_get_property;
   audio_filter_class->setup = gst_iir_equalizer_setup;
   btrans_class->transform_ip = gst_iir_equalizer_transform_ip;
 
+  /**
+   * GstIirEqualizer:single-precision:
+   *
+   * Run the filters in the transposed direct form II with coefficients and
+   * state in single precision. This is faster and needs half the state,
+   * but for low frequencies at high sample rates the coefficients lose
+   * precision, which slightly changes the response of those bands.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_SINGLE_PRECISION,
+      g_param_spec_boolean ("single-precision", "Single precision",
+          "Run the filters in single precision", DEFAULT_SINGLE_PRECISION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   caps = gst_caps_from_string (ALLOWED_CAPS);
   gst_audio_filter_class_add_pad_templates (audio_filter_class, caps);
   gst_caps_unref (caps);
@@ -373,6 +402,43 @@ gst_iir_equalizer_init (GstIirEqualizer * eq)
 {
   g_mutex_init (&eq->bands_lock);
   eq->need_new_coefficients = TRUE;
+  eq->single_precision = DEFAULT_SINGLE_PRECISION;
+}
+
+static void
+gst_iir_equalizer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstIirEqualizer *equ = GST_IIR_EQUALIZER (object);
+
+  switch (prop_id) {
+    case PROP_SINGLE_PRECISION:
+      BANDS_LOCK (equ);
+      equ->single_precision = g_value_get_boolean (value);
+      /* the process function is picked again for the next buffer */
+      equ->need_new_coefficients = TRUE;
+      BANDS_UNLOCK (equ);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_iir_equalizer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstIirEqualizer *equ = GST_IIR_EQUALIZER (object);
+
+  switch (prop_id) {
+    case PROP_SINGLE_PRECISION:
+      g_value_set_boolean (value, equ->single_precision);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static void
@@ -711,109 +777,201 @@ gst_iir_equalizer_compute_frequencies (GstIirEqualizer * equ, guint new_count)
 
 /* start of code that is type specific */
 
+/* The history is kept per band, with the values of all channels next to
+ * each other. Up to EQ_LANES channels of a frame are run through a band
+ * together, so the coefficients of a band are loaded once for all of
+ * them instead of once per channel. Every channel still goes through
+ * exactly the same operations in the same order as before, so the output
+ * does not change */
+#define EQ_LANES 8
+
 #define CREATE_OPTIMIZED_FUNCTIONS_INT(TYPE,BIG_TYPE,MIN_VAL,MAX_VAL)   \
-typedef struct {                                                        \
-  BIG_TYPE x1, x2;          /* history of input values for a filter */  \
-  BIG_TYPE y1, y2;          /* history of output values for a filter */ \
-} SecondOrderHistory ## TYPE;                                           \
-                                                                        \
-static inline BIG_TYPE                                                  \
-one_step_ ## TYPE (GstIirEqualizerBand *filter,                         \
-    SecondOrderHistory ## TYPE *history, BIG_TYPE input)                \
-{                                                                       \
-  /* calculate output */                                                \
-  BIG_TYPE output = filter->a0 * input +                                \
-      filter->a1 * history->x1 + filter->a2 * history->x2 +             \
-      filter->b1 * history->y1 + filter->b2 * history->y2;              \
-  /* update history */                                                  \
-  history->y2 = history->y1;                                            \
-  history->y1 = output;                                                 \
-  history->x2 = history->x1;                                            \
-  history->x1 = input;                                                  \
-                                                                        \
-  return output;                                                        \
-}                                                                       \
-                                                                        \
 static const guint                                                      \
-history_size_ ## TYPE = sizeof (SecondOrderHistory ## TYPE);            \
+history_size_ ## TYPE = 4 * sizeof (BIG_TYPE);                          \
                                                                         \
 static void                                                             \
 gst_iir_equ_process_ ## TYPE (GstIirEqualizer *equ, guint8 *data,       \
 guint size, guint channels)                                             \
 {                                                                       \
   guint frames = size / channels / sizeof (TYPE);                       \
-  guint i, c, f, nf = equ->freq_band_count;                             \
-  BIG_TYPE cur;                                                         \
+  guint i, c, f, l, n, nf = equ->freq_band_count;                       \
+  BIG_TYPE cur[EQ_LANES];                                               \
   GstIirEqualizerBand **filters = equ->bands;                           \
                                                                         \
-  for (i = 0; i < frames; i++) {                                        \
-    SecondOrderHistory ## TYPE *history = equ->history;                 \
-    for (c = 0; c < channels; c++) {                                    \
-      cur = *((TYPE *) data);                                           \
+  for (c = 0; c < channels; c += n) {                                   \
+    n = MIN (channels - c, EQ_LANES);                                   \
+    for (i = 0; i < frames; i++) {                                      \
+      TYPE *samples = ((TYPE *) data) + i * channels + c;               \
+                                                                        \
+      for (l = 0; l < n; l++)                                           \
+        cur[l] = samples[l];                                            \
       for (f = 0; f < nf; f++) {                                        \
-        cur = one_step_ ## TYPE (filters[f], history, cur);             \
-        history++;                                                      \
+        GstIirEqualizerBand *filter = filters[f];                       \
+        gdouble a0 = filter->a0, a1 = filter->a1, a2 = filter->a2;      \
+        gdouble b1 = filter->b1, b2 = filter->b2;                       \
+        /* history of input and output values for the filter */        \
+        BIG_TYPE *x1 = (BIG_TYPE *) equ->history + 4 * f * channels + c; \
+        BIG_TYPE *x2 = x1 + channels;                                   \
+        BIG_TYPE *y1 = x2 + channels;                                   \
+        BIG_TYPE *y2 = y1 + channels;                                   \
+                                                                        \
+        for (l = 0; l < n; l++) {                                       \
+          BIG_TYPE output = a0 * cur[l] + a1 * x1[l] + a2 * x2[l] +     \
+              b1 * y1[l] + b2 * y2[l];                                  \
+          /* update history */                                          \
+          y2[l] = y1[l];                                                \
+          y1[l] = output;                                               \
+          x2[l] = x1[l];                                                \
+          x1[l] = cur[l];                                               \
+          cur[l] = output;                                              \
+        }                                                               \
       }                                                                 \
-      cur = CLAMP (cur, MIN_VAL, MAX_VAL);                              \
-      *((TYPE *) data) = (TYPE) floor (cur);                            \
-      data += sizeof (TYPE);                                            \
+      for (l = 0; l < n; l++)                                           \
+        samples[l] = (TYPE) floor (CLAMP (cur[l], MIN_VAL, MAX_VAL));   \
     }                                                                   \
   }                                                                     \
 }
 
 #define CREATE_OPTIMIZED_FUNCTIONS(TYPE)                                \
-typedef struct {                                                        \
-  TYPE x1, x2;          /* history of input values for a filter */  \
-  TYPE y1, y2;          /* history of output values for a filter */ \
-} SecondOrderHistory ## TYPE;                                           \
+static const guint                                                      \
+history_size_ ## TYPE = 4 * sizeof (TYPE);                              \
                                                                         \
-static inline TYPE                                                      \
-one_step_ ## TYPE (GstIirEqualizerBand *filter,                         \
-    SecondOrderHistory ## TYPE *history, TYPE input)                    \
+static void                                                             \
+gst_iir_equ_process_ ## TYPE (GstIirEqualizer *equ, guint8 *data,       \
+guint size, guint channels)                                             \
 {                                                                       \
-  /* calculate output */                                                \
-  TYPE output = filter->a0 * input + filter->a1 * history->x1 +         \
-      filter->a2 * history->x2 + filter->b1 * history->y1 +             \
-      filter->b2 * history->y2;                                         \
-  /* update history */                                                  \
-  history->y2 = history->y1;                                            \
-  history->y1 = output;                                                 \
-  history->x2 = history->x1;                                            \
-  history->x1 = input;                                                  \
+  guint frames = size / channels / sizeof (TYPE);                       \
+  guint i, c, f, l, n, nf = equ->freq_band_count;                       \
+  TYPE cur[EQ_LANES];                                                   \
+  GstIirEqualizerBand **filters = equ->bands;                           \
                                                                         \
-  return output;                                                        \
-}                                                                       \
+  for (c = 0; c < channels; c += n) {                                   \
+    n = MIN (channels - c, EQ_LANES);                                   \
+    for (i = 0; i < frames; i++) {                                      \
+      TYPE *samples = ((TYPE *) data) + i * channels + c;               \
                                                                         \
-static const guint                                                      \
-history_size_ ## TYPE = sizeof (SecondOrderHistory ## TYPE);            \
+      for (l = 0; l < n; l++)                                           \
+        cur[l] = samples[l];                                            \
+      for (f = 0; f < nf; f++) {                                        \
+        GstIirEqualizerBand *filter = filters[f];                       \
+        gdouble a0 = filter->a0, a1 = filter->a1, a2 = filter->a2;      \
+        gdouble b1 = filter->b1, b2 = filter->b2;                       \
+        /* history of input and output values for the filter */        \
+        TYPE *x1 = (TYPE *) equ->history + 4 * f * channels + c;        \
+        TYPE *x2 = x1 + channels;                                       \
+        TYPE *y1 = x2 + channels;                                       \
+        TYPE *y2 = y1 + channels;                                       \
                                                                         \
+        for (l = 0; l < n; l++) {                                       \
+          TYPE output = a0 * cur[l] + a1 * x1[l] + a2 * x2[l] +         \
+              b1 * y1[l] + b2 * y2[l];                                  \
+          /* update history */                                          \
+          y2[l] = y1[l];                                                \
+          y1[l] = output;                                               \
+          x2[l] = x1[l];                                                \
+          x1[l] = cur[l];                                               \
+          cur[l] = output;                                              \
+        }                                                               \
+      }                                                                 \
+      for (l = 0; l < n; l++)                                           \
+        samples[l] = (TYPE) cur[l];                                     \
+    }                                                                   \
+  }                                                                     \
+}
+
+/* transposed direct form II in single precision. It only keeps two state
+ * values per filter and channel and does all the math in floats */
+#define CREATE_TDF2_FUNCTIONS(TYPE,STORE)                               \
 static void                                                             \
-gst_iir_equ_process_ ## TYPE (GstIirEqualizer *equ, guint8 *data,       \
+gst_iir_equ_process_tdf2_ ## TYPE (GstIirEqualizer *equ, guint8 *data,  \
 guint size, guint channels)                                             \
 {                                                                       \
   guint frames = size / channels / sizeof (TYPE);                       \
-  guint i, c, f, nf = equ->freq_band_count;                             \
-  TYPE cur;                                                             \
+  guint i, c, f, l, n, nf = equ->freq_band_count;                       \
+  gfloat cur[EQ_LANES];                                                 \
   GstIirEqualizerBand **filters = equ->bands;                           \
                                                                         \
-  for (i = 0; i < frames; i++) {                                        \
-    SecondOrderHistory ## TYPE *history = equ->history;                 \
-    for (c = 0; c < channels; c++) {                                    \
-      cur = *((TYPE *) data);                                           \
+  for (c = 0; c < channels; c += n) {                                   \
+    n = MIN (channels - c, EQ_LANES);                                   \
+    for (i = 0; i < frames; i++) {                                      \
+      TYPE *samples = ((TYPE *) data) + i * channels + c;               \
+                                                                        \
+      for (l = 0; l < n; l++)                                           \
+        cur[l] = samples[l];                                            \
       for (f = 0; f < nf; f++) {                                        \
-        cur = one_step_ ## TYPE (filters[f], history, cur);             \
-        history++;                                                      \
+        GstIirEqualizerBand *filter = filters[f];                       \
+        gfloat a0 = filter->a0, a1 = filter->a1, a2 = filter->a2;       \
+        gfloat b1 = filter->b1, b2 = filter->b2;                        \
+        gfloat *s1 = (gfloat *) equ->history + 2 * f * channels + c;    \
+        gfloat *s2 = s1 + channels;                                     \
+                                                                        \
+        for (l = 0; l < n; l++) {                                       \
+          gfloat input = cur[l];                                        \
+          gfloat output = a0 * input + s1[l];                           \
+                                                                        \
+          s1[l] = a1 * input + b1 * output + s2[l];                     \
+          s2[l] = a2 * input + b2 * output;                             \
+          cur[l] = output;                                              \
+        }                                                               \
       }                                                                 \
-      *((TYPE *) data) = (TYPE) cur;                                    \
-      data += sizeof (TYPE);                                            \
+      for (l = 0; l < n; l++)                                           \
+        samples[l] = STORE (cur[l]);                                    \
     }                                                                   \
   }                                                                     \
 }
 
+static const guint history_size_tdf2 = 2 * sizeof (gfloat);
+
+#define STORE_INT16(v) ((gint16) floor (CLAMP ((v), -32768.0, 32767.0)))
+#define STORE_FLOAT(v) (v)
+
 CREATE_OPTIMIZED_FUNCTIONS_INT (gint16, gfloat, -32768.0, 32767.0);
 CREATE_OPTIMIZED_FUNCTIONS (gfloat);
 CREATE_OPTIMIZED_FUNCTIONS (gdouble);
 
+CREATE_TDF2_FUNCTIONS (gint16, STORE_INT16);
+CREATE_TDF2_FUNCTIONS (gfloat, STORE_FLOAT);
+CREATE_TDF2_FUNCTIONS (gdouble, STORE_FLOAT);
+
+/* pick the process function for the format and precision, the history is
+ * allocated again when its layout changes.
+ * Must be called with bands_lock and transform lock! */
+static gboolean
+select_process (GstIirEqualizer * equ, const GstAudioInfo * info)
+{
+  gboolean single = equ->single_precision;
+  ProcessFunc process;
+  guint history_size;
+
+  switch (GST_AUDIO_INFO_FORMAT (info)) {
+    case GST_AUDIO_FORMAT_S16:
+      history_size = single ? history_size_tdf2 : history_size_gint16;
+      process = single ? gst_iir_equ_process_tdf2_gint16 :
+          gst_iir_equ_process_gint16;
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      history_size = single ? history_size_tdf2 : history_size_gfloat;
+      process = single ? gst_iir_equ_process_tdf2_gfloat :
+          gst_iir_equ_process_gfloat;
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      history_size = single ? history_size_tdf2 : history_size_gdouble;
+      process = single ? gst_iir_equ_process_tdf2_gdouble :
+          gst_iir_equ_process_gdouble;
+      break;
+    default:
+      return FALSE;
+  }
+
+  if (process != equ->process || history_size != equ->history_size) {
+    equ->process = process;
+    equ->history_size = history_size;
+    alloc_history (equ, info);
+  }
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_iir_equalizer_transform_ip (GstBaseTransform * btrans, GstBuffer * buf)
 {
@@ -855,6 +1013,8 @@ gst_iir_equalizer_transform_ip (GstBaseTransform * btrans, GstBuffer * buf)
   if (need_new_coefficients) {
     update_coefficients (equ);
     set_passthrough (equ);
+    /* the precision might have changed too */
+    select_process (equ, GST_AUDIO_FILTER_INFO (filter));
   }
   BANDS_UNLOCK (equ);
 
@@ -869,26 +1029,15 @@ static gboolean
 gst_iir_equalizer_setup (GstAudioFilter * audio, const GstAudioInfo * info)
 {
   GstIirEqualizer *equ = GST_IIR_EQUALIZER (audio);
+  gboolean res;
 
-  switch (GST_AUDIO_INFO_FORMAT (info)) {
-    case GST_AUDIO_FORMAT_S16:
-      equ->history_size = history_size_gint16;
-      equ->process = gst_iir_equ_process_gint16;
-      break;
-    case GST_AUDIO_FORMAT_F32:
-      equ->history_size = history_size_gfloat;
-      equ->process = gst_iir_equ_process_gfloat;
-      break;
-    case GST_AUDIO_FORMAT_F64:
-      equ->history_size = history_size_gdouble;
-      equ->process = gst_iir_equ_process_gdouble;
-      break;
-    default:
-      return FALSE;
-  }
+  BANDS_LOCK (equ);
+  /* the history of the old format is useless */
+  equ->process = NULL;
+  res = select_process (equ, info);
+  BANDS_UNLOCK (equ);
 
-  alloc_history (equ, info);
-  return TRUE;
+  return res;
 }
 
 
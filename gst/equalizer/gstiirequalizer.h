@@ -60,6 +60,7 @@ struct _GstIirEqualizer
   guint history_size;
 
   gboolean need_new_coefficients;
+  gboolean single_precision;
 
   ProcessFunc process;
 };
@@ -96,6 +96,10 @@ G_DEFINE_TYPE (GstFlvDemux, gst_flv_demux, GST_TYPE_ELEMENT);
 /* two seconds - consider pts are resynced to another base if this different */
 #define RESYNC_THRESHOLD 2000
 
+/* tag headers scanned per loop iteration when building the index for a
+ * seek, so a new seek does not have to wait for the whole scan */
+#define FLV_INDEX_SCAN_TAGS 512
+
 static gboolean flv_demux_handle_seek_push (GstFlvDemux * demux,
     GstEvent * event);
 static gboolean gst_flv_demux_handle_seek_pull (GstFlvDemux * demux,
@@ -1825,6 +1829,7 @@ gst_flv_demux_cleanup (GstFlvDemux * demux)
 
   demux->index_max_pos = 0;
   demux->index_max_time = 0;
+  demux->index_scan_pos = 0;
 
   demux->audio_start = demux->video_start = GST_CLOCK_TIME_NONE;
   demux->last_audio_pts = demux->last_video_pts = 0;
@@ -2350,8 +2355,12 @@ done:
   return ret;
 }
 
+/* Walks at most FLV_INDEX_SCAN_TAGS tag headers starting at @pos, adding
+ * them to the index. @pos is updated to where the scan should continue, or
+ * set to -1 once time @ts or the end of the file was reached. */
 static GstFlowReturn
-gst_flv_demux_create_index (GstFlvDemux * demux, gint64 pos, GstClockTime ts)
+gst_flv_demux_create_index (GstFlvDemux * demux, gint64 * pos,
+    GstClockTime ts)
 {
   gint64 size;
   size_t tag_size;
@@ -2359,15 +2368,18 @@ gst_flv_demux_create_index (GstFlvDemux * demux, gint64 pos, GstClockTime ts)
   GstBuffer *buffer;
   GstClockTime tag_time;
   GstFlowReturn ret = GST_FLOW_OK;
+  guint n_tags = 0;
 
-  if (!gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size))
+  if (!gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size)) {
+    *pos = -1;
     return GST_FLOW_OK;
+  }
 
   GST_DEBUG_OBJECT (demux, "building index at %" G_GINT64_FORMAT
-      " looking for time %" GST_TIME_FORMAT, pos, GST_TIME_ARGS (ts));
+      " looking for time %" GST_TIME_FORMAT, *pos, GST_TIME_ARGS (ts));
 
   old_offset = demux->offset;
-  demux->offset = pos;
+  demux->offset = *pos;
 
   buffer = NULL;
   while ((ret = gst_flv_demux_pull_range (demux, demux->sinkpad, demux->offset,
@@ -2378,12 +2390,21 @@ gst_flv_demux_create_index (GstFlvDemux * demux, gint64 pos, GstClockTime ts)
     gst_buffer_unref (buffer);
     buffer = NULL;
 
-    if (G_UNLIKELY (tag_time == GST_CLOCK_TIME_NONE || tag_time > ts))
+    if (G_UNLIKELY (tag_time == GST_CLOCK_TIME_NONE || tag_time > ts)) {
+      *pos = -1;
       goto exit;
+    }
 
     demux->offset += tag_size;
+
+    if (++n_tags == FLV_INDEX_SCAN_TAGS) {
+      /* pick up from here in the next loop iteration */
+      *pos = demux->offset;
+      goto exit;
+    }
   }
 
+  *pos = -1;
   if (ret == GST_FLOW_EOS) {
     /* file ran out, so mark we have complete index */
     demux->indexed = TRUE;
@@ -2493,10 +2514,15 @@ gst_flv_demux_loop (GstPad * pad)
        * scan for index in task thread from current maximum offset to
        * desired time and then perform seek */
       /* TODO maybe some buffering message or so to indicate scan progress */
-      ret = gst_flv_demux_create_index (demux, demux->index_max_pos,
+      ret = gst_flv_demux_create_index (demux, &demux->index_scan_pos,
           demux->seek_time);
       if (ret != GST_FLOW_OK)
         goto pause;
+      /* the scan is done in steps, making the partial index usable and
+       * letting a new seek in between */
+      if (demux->index_scan_pos != -1)
+        goto beach;
+      demux->index_scan_pos = 0;
       /* position and state arranged by seek,
        * also unrefs event */
       gst_flv_demux_handle_seek_pull (demux, demux->seek_event, FALSE);
@@ -2504,8 +2530,9 @@ gst_flv_demux_loop (GstPad * pad)
       break;
     default:
       ret = gst_flv_demux_pull_header (pad, demux);
-      /* index scans start after header */
-      demux->index_max_pos = demux->offset;
+      /* index scans start after header, or where a cached index ended */
+      if (demux->index_max_pos < demux->offset)
+        demux->index_max_pos = demux->offset;
       break;
   }
 
@@ -2527,6 +2554,7 @@ gst_flv_demux_loop (GstPad * pad)
   if (G_UNLIKELY (ret != GST_FLOW_OK))
     goto pause;
 
+beach:
   gst_object_unref (demux);
 
   return;
@@ -2880,6 +2908,9 @@ gst_flv_demux_handle_seek_pull (GstFlvDemux * demux, GstEvent * event,
         gst_event_unref (demux->seek_event);
       demux->seek_event = gst_event_ref (event);
       demux->seek_time = seeksegment.position;
+      /* continue a scan interrupted by this seek */
+      demux->index_scan_pos =
+          MAX (demux->index_scan_pos, demux->index_max_pos);
       demux->state = FLV_STATE_SEEK;
       /* do not know about succes yet, but we did care and handled it */
       ret = TRUE;
@@ -2990,6 +3021,43 @@ activate_push:
   }
 }
 
+/* Our own index is kept between runs on the same file, identified by the
+ * upstream URI and size, so that it does not have to be built again */
+static void
+gst_flv_demux_check_cached_index (GstFlvDemux * demux, gboolean pull_mode)
+{
+  GstQuery *query;
+  gchar *uri = NULL;
+  gint64 size = -1;
+
+  if (pull_mode) {
+    query = gst_query_new_uri ();
+    if (gst_pad_peer_query (demux->sinkpad, query))
+      gst_query_parse_uri (query, &uri);
+    gst_query_unref (query);
+    gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size);
+  }
+
+  if (demux->own_index && uri && size > 0 && size == demux->cache_size &&
+      g_strcmp0 (uri, demux->cache_uri) == 0) {
+    GST_DEBUG_OBJECT (demux, "reusing index of %s up to %" GST_TIME_FORMAT,
+        uri, GST_TIME_ARGS (demux->cache_max_time));
+    demux->indexed = demux->cache_indexed;
+    demux->index_max_pos = demux->cache_max_pos;
+    demux->index_max_time = demux->cache_max_time;
+  } else if (demux->own_index) {
+    /* the old entries might be wrong for the new stream */
+    gst_object_unref (demux->index);
+    demux->index = g_object_new (gst_mem_index_get_type (), NULL);
+    gst_index_get_writer_id (demux->index, GST_OBJECT (demux),
+        &demux->index_id);
+  }
+
+  g_free (demux->cache_uri);
+  demux->cache_uri = uri;
+  demux->cache_size = size;
+}
+
 static gboolean
 gst_flv_demux_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
     GstPadMode mode, gboolean active)
@@ -3001,11 +3069,14 @@ gst_flv_demux_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
 
   switch (mode) {
     case GST_PAD_MODE_PUSH:
+      if (active)
+        gst_flv_demux_check_cached_index (demux, FALSE);
       demux->random_access = FALSE;
       res = TRUE;
       break;
     case GST_PAD_MODE_PULL:
       if (active) {
+        gst_flv_demux_check_cached_index (demux, TRUE);
         demux->random_access = TRUE;
         res = gst_pad_start_task (sinkpad, (GstTaskFunction) gst_flv_demux_loop,
             sinkpad, NULL);
@@ -3265,15 +3336,9 @@ gst_flv_demux_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
-      /* If this is our own index destroy it as the
-       * old entries might be wrong for the new stream */
-      if (demux->own_index) {
-        gst_object_unref (demux->index);
-        demux->index = NULL;
-        demux->own_index = FALSE;
-      }
-
-      /* If no index was created, generate one */
+      /* If this is our own index it is kept or replaced when the sinkpad
+       * activates and we know whether upstream is the same file.
+       * If no index was created, generate one */
       if (G_UNLIKELY (!demux->index)) {
         GST_DEBUG_OBJECT (demux, "no index provided creating our own");
 
@@ -3295,6 +3360,10 @@ gst_flv_demux_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* remember how far our index got for the next run */
+      demux->cache_indexed = demux->indexed;
+      demux->cache_max_pos = demux->index_max_pos;
+      demux->cache_max_time = demux->index_max_time;
       gst_flv_demux_cleanup (demux);
       break;
     default:
@@ -3401,6 +3470,9 @@ gst_flv_demux_dispose (GObject * object)
     demux->index = NULL;
   }
 
+  g_free (demux->cache_uri);
+  demux->cache_uri = NULL;
+
   if (demux->times) {
     g_array_free (demux->times, TRUE);
     demux->times = NULL;
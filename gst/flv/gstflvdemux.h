@@ -138,6 +138,14 @@ struct _GstFlvDemux
 
   GstClockTime index_max_time;
   gint64 index_max_pos;
+  gint64 index_scan_pos;
+
+  /* identity of the file our own index was built for */
+  gchar *cache_uri;
+  gint64 cache_size;
+  gboolean cache_indexed;
+  gint64 cache_max_pos;
+  GstClockTime cache_max_time;
 
   /* reverse playback */
   GstClockTime video_first_ts;
@@ -49,10 +49,12 @@ GST_DEBUG_CATEGORY_STATIC (flvmux_debug);
 enum
 {
   PROP_0,
-  PROP_STREAMABLE
+  PROP_STREAMABLE,
+  PROP_ZERO_COPY
 };
 
 #define DEFAULT_STREAMABLE FALSE
+#define DEFAULT_ZERO_COPY FALSE
 #define MAX_INDEX_ENTRIES 128
 
 static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
@@ -123,12 +125,6 @@ typedef struct
   gdouble time;
 } GstFlvMuxIndexEntry;
 
-static void
-gst_flv_mux_index_entry_free (GstFlvMuxIndexEntry * entry)
-{
-  g_slice_free (GstFlvMuxIndexEntry, entry);
-}
-
 static GstBuffer *
 _gst_buffer_new_wrapped (gpointer mem, gsize size, GFreeFunc free_func)
 {
@@ -181,6 +177,21 @@ gst_flv_mux_class_init (GstFlvMuxClass * klass)
           "and hence no indexes written or duration written.",
           DEFAULT_STREAMABLE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFlvMux:zero-copy
+   *
+   * If True, media tags are output as a buffer made of the tag header, the
+   * memory of the input buffer and the PreviousTagSize trailer, instead of
+   * copying the payload into one contiguous tag.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy",
+          "Reference the input memory in the output tags instead of copying "
+          "it, the tags are then not contiguous in memory",
+          DEFAULT_ZERO_COPY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_flv_mux_change_state);
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_flv_mux_request_new_pad);
@@ -209,9 +220,13 @@ gst_flv_mux_init (GstFlvMux * mux)
 
   /* property */
   mux->streamable = DEFAULT_STREAMABLE;
+  mux->zero_copy = DEFAULT_ZERO_COPY;
 
   mux->new_tags = FALSE;
 
+  /* the seek points are appended in order, the array grows as needed */
+  mux->index = g_array_new (FALSE, FALSE, sizeof (GstFlvMuxIndexEntry));
+
   mux->collect = gst_collect_pads_new ();
   gst_collect_pads_set_buffer_function (mux->collect,
       GST_DEBUG_FUNCPTR (gst_flv_mux_handle_buffer), mux);
@@ -229,6 +244,7 @@ gst_flv_mux_finalize (GObject * object)
   GstFlvMux *mux = GST_FLV_MUX (object);
 
   gst_object_unref (mux->collect);
+  g_array_free (mux->index, TRUE);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -245,9 +261,7 @@ gst_flv_mux_reset (GstElement * element)
     gst_flv_mux_reset_pad (mux, cpad, cpad->video);
   }
 
-  g_list_foreach (mux->index, (GFunc) gst_flv_mux_index_entry_free, NULL);
-  g_list_free (mux->index);
-  mux->index = NULL;
+  g_array_set_size (mux->index, 0);
   mux->byte_count = 0;
 
   mux->have_audio = mux->have_video = FALSE;
@@ -998,37 +1012,35 @@ gst_flv_mux_buffer_to_tag_internal (GstFlvMux * mux, GstBuffer * buffer,
     GstFlvPad * cpad, gboolean is_codec_data)
 {
   GstBuffer *tag;
-  GstMapInfo map;
-  guint size;
+  guint size, hsize;
   guint32 timestamp =
       (GST_BUFFER_TIMESTAMP_IS_VALID (buffer)) ? GST_BUFFER_TIMESTAMP (buffer) /
       GST_MSECOND : cpad->last_timestamp / GST_MSECOND;
-  guint8 *data, *bdata;
+  guint8 *data;
   gsize bsize;
+  gboolean zero_copy;
 
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  bdata = map.data;
-  bsize = map.size;
+  bsize = gst_buffer_get_size (buffer);
 
-  size = 11;
+  hsize = 11;
   if (cpad->video) {
-    size += 1;
+    hsize += 1;
     if (cpad->video_codec == 7)
-      size += 4 + bsize;
-    else
-      size += bsize;
+      hsize += 4;
   } else {
-    size += 1;
+    hsize += 1;
     if (cpad->audio_codec == 10)
-      size += 1 + bsize;
-    else
-      size += bsize;
+      hsize += 1;
   }
-  size += 4;
+  size = hsize + bsize + 4;
+
+  /* codec data ends up in the streamheader, keep those tags contiguous */
+  zero_copy = mux->zero_copy && !is_codec_data;
 
-  _gst_buffer_new_and_alloc (size, &tag, &data);
+  /* only allocate the header if the payload memory is shared */
+  _gst_buffer_new_and_alloc (zero_copy ? hsize : size, &tag, &data);
   GST_BUFFER_TIMESTAMP (tag) = timestamp * GST_MSECOND;
-  memset (data, 0, size);
+  memset (data, 0, hsize);
 
   data[0] = (cpad->video) ? 9 : 8;
 
@@ -1058,10 +1070,6 @@ gst_flv_mux_buffer_to_tag_internal (GstFlvMux * mux, GstBuffer * buffer,
 
       /* FIXME: what to do about composition time */
       data[13] = data[14] = data[15] = 0;
-
-      memcpy (data + 11 + 1 + 4, bdata, bsize);
-    } else {
-      memcpy (data + 11 + 1, bdata, bsize);
     }
   } else {
     data[11] |= (cpad->audio_codec << 4) & 0xf0;
@@ -1069,18 +1077,22 @@ gst_flv_mux_buffer_to_tag_internal (GstFlvMux * mux, GstBuffer * buffer,
     data[11] |= (cpad->width << 1) & 0x02;
     data[11] |= (cpad->channels << 0) & 0x01;
 
-    if (cpad->audio_codec == 10) {
+    if (cpad->audio_codec == 10)
       data[12] = is_codec_data ? 0 : 1;
-
-      memcpy (data + 11 + 1 + 1, bdata, bsize);
-    } else {
-      memcpy (data + 11 + 1, bdata, bsize);
-    }
   }
 
-  gst_buffer_unmap (buffer, &map);
+  if (zero_copy) {
+    GstBuffer *trailer;
 
-  GST_WRITE_UINT32_BE (data + size - 4, size - 4);
+    /* header memory, payload memory and trailer memory in one buffer */
+    gst_buffer_copy_into (tag, buffer, GST_BUFFER_COPY_MEMORY, 0, -1);
+    _gst_buffer_new_and_alloc (4, &trailer, &data);
+    GST_WRITE_UINT32_BE (data, size - 4);
+    tag = gst_buffer_append (tag, trailer);
+  } else {
+    gst_buffer_extract (buffer, 0, data + hsize, bsize);
+    GST_WRITE_UINT32_BE (data + size - 4, size - 4);
+  }
 
   GST_BUFFER_TIMESTAMP (tag) = GST_BUFFER_TIMESTAMP (buffer);
   GST_BUFFER_DURATION (tag) = GST_BUFFER_DURATION (buffer);
@@ -1267,11 +1279,12 @@ gst_flv_mux_update_index (GstFlvMux * mux, GstBuffer * buffer, GstFlvPad * cpad)
     return;
 
   if (GST_BUFFER_TIMESTAMP_IS_VALID (buffer)) {
-    GstFlvMuxIndexEntry *entry = g_slice_new (GstFlvMuxIndexEntry);
-    entry->position = mux->byte_count;
-    entry->time =
+    GstFlvMuxIndexEntry entry;
+
+    entry.position = mux->byte_count;
+    entry.time =
         gst_guint64_to_gdouble (GST_BUFFER_TIMESTAMP (buffer)) / GST_SECOND;
-    mux->index = g_list_prepend (mux->index, entry);
+    g_array_append_val (mux->index, entry);
   }
 }
 
@@ -1328,7 +1341,6 @@ gst_flv_mux_rewrite_header (GstFlvMux * mux)
   GstEvent *event;
   guint8 *data;
   gdouble d;
-  GList *l;
   guint32 index_len, allocate_size;
   guint32 i, index_skip;
   GstSegment segment;
@@ -1369,14 +1381,13 @@ gst_flv_mux_rewrite_header (GstFlvMux * mux)
   tmp = gst_flv_mux_create_number_script_value ("filesize", d);
   rewrite = gst_buffer_append (rewrite, tmp);
 
-  if (!mux->index) {
+  if (mux->index->len == 0) {
     /* no index, so push buffer and return */
     return gst_flv_mux_push (mux, rewrite);
   }
 
   /* rewrite the index */
-  mux->index = g_list_reverse (mux->index);
-  index_len = g_list_length (mux->index);
+  index_len = mux->index->len;
 
   /* We write at most MAX_INDEX_ENTRIES elements */
   if (index_len > MAX_INDEX_ENTRIES) {
@@ -1403,11 +1414,10 @@ gst_flv_mux_rewrite_header (GstFlvMux * mux)
   data += 28;
 
   /* the keyframes' times */
-  for (i = 0, l = mux->index; l; l = l->next, i++) {
-    GstFlvMuxIndexEntry *entry = l->data;
+  for (i = 0; i < mux->index->len; i += index_skip) {
+    GstFlvMuxIndexEntry *entry =
+        &g_array_index (mux->index, GstFlvMuxIndexEntry, i);
 
-    if (i % index_skip != 0)
-      continue;
     GST_WRITE_UINT8 (data, 0);  /* numeric (aka double) */
     GST_WRITE_DOUBLE_BE (data + 1, entry->time);
     data += 9;
@@ -1420,11 +1430,10 @@ gst_flv_mux_rewrite_header (GstFlvMux * mux)
   data += 20;
 
   /* the keyframes' file positions */
-  for (i = 0, l = mux->index; l; l = l->next, i++) {
-    GstFlvMuxIndexEntry *entry = l->data;
+  for (i = 0; i < mux->index->len; i += index_skip) {
+    GstFlvMuxIndexEntry *entry =
+        &g_array_index (mux->index, GstFlvMuxIndexEntry, i);
 
-    if (i % index_skip != 0)
-      continue;
     GST_WRITE_UINT8 (data, 0);
     GST_WRITE_DOUBLE_BE (data + 1, entry->position);
     data += 9;
@@ -1526,6 +1535,9 @@ gst_flv_mux_get_property (GObject * object,
     case PROP_STREAMABLE:
       g_value_set_boolean (value, mux->streamable);
       break;
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, mux->zero_copy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1548,6 +1560,9 @@ gst_flv_mux_set_property (GObject * object,
         gst_tag_setter_set_tag_merge_mode (GST_TAG_SETTER (mux),
             GST_TAG_MERGE_KEEP);
       break;
+    case PROP_ZERO_COPY:
+      mux->zero_copy = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
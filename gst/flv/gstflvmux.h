@@ -72,10 +72,11 @@ typedef struct _GstFlvMux {
   gboolean have_audio;
   gboolean have_video;
   gboolean streamable;
+  gboolean zero_copy;
 
   GstTagList *tags;
   gboolean new_tags;
-  GList *index;
+  GArray *index;
   guint64 byte_count;
   guint64 duration;
 } GstFlvMux;
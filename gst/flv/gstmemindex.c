@@ -19,6 +19,8 @@
 
 #include <gst/gst.h>
 
+#include <string.h>
+
 #define GST_TYPE_MEM_INDEX              \
   (gst_index_get_type ())
 #define GST_MEM_INDEX(obj)              \
@@ -33,7 +35,7 @@
 /*
  * Object model:
  *
- * All entries are simply added to a GList first. Then we build
+ * All entries are simply added to an array first. Then we build
  * an index to each entry for each id/format
  *
  *
@@ -45,7 +47,7 @@
  *    !          !
  *   format1  format2
  *    !          !
- *   GTree      GTree
+ *   array      array
  *
  *
  * The memindex creates a MemIndexId object for each writer id, a
@@ -54,18 +56,19 @@
  * The MemIndexId keeps a MemIndexFormatIndex for each format the
  * specific writer wants indexed.
  *
- * The MemIndexFormatIndex keeps all the values of the particular
- * format in a GTree, The values of the GTree point back to the entry.
+ * The MemIndexFormatIndex keeps the entries of the particular format in an
+ * array that is sorted on their value of that format. Entries mostly come
+ * in increasing order and are then appended, the array grows in steps.
  *
- * Finding a value for an id/format requires locating the correct GTree,
- * then do a lookup in the Tree to get the required value.
+ * Finding a value for an id/format requires locating the correct array,
+ * then do a binary search in it to get the required value.
  */
 
 typedef struct
 {
   GstFormat format;
   gint offset;
-  GTree *tree;
+  GPtrArray *entries;
 }
 GstMemIndexFormatIndex;
 
@@ -83,7 +86,7 @@ struct _GstMemIndex
 {
   GstIndex parent;
 
-  GList *associations;
+  GPtrArray *associations;
 
   GHashTable *id_index;
 };
@@ -129,7 +132,7 @@ gst_mem_index_init (GstMemIndex * index)
 {
   GST_DEBUG ("created new mem index");
 
-  index->associations = NULL;
+  index->associations = g_ptr_array_new ();
   index->id_index = g_hash_table_new (g_int_hash, g_int_equal);
 }
 
@@ -138,8 +141,8 @@ gst_mem_index_free_format (gpointer key, gpointer value, gpointer user_data)
 {
   GstMemIndexFormatIndex *index = (GstMemIndexFormatIndex *) value;
 
-  if (index->tree) {
-    g_tree_destroy (index->tree);
+  if (index->entries) {
+    g_ptr_array_free (index->entries, TRUE);
   }
 
   g_slice_free (GstMemIndexFormatIndex, index);
@@ -174,8 +177,9 @@ gst_mem_index_finalize (GObject * object)
 
   /* Then delete the associations themselves */
   if (memindex->associations) {
-    g_list_foreach (memindex->associations, (GFunc) gst_index_entry_free, NULL);
-    g_list_free (memindex->associations);
+    g_ptr_array_foreach (memindex->associations, (GFunc) gst_index_entry_free,
+        NULL);
+    g_ptr_array_free (memindex->associations, TRUE);
     memindex->associations = NULL;
   }
 
@@ -199,19 +203,25 @@ gst_mem_index_add_id (GstIndex * index, GstIndexEntry * entry)
   }
 }
 
-static gint
-mem_index_compare (gconstpointer a, gconstpointer b, gpointer user_data)
-{
-  GstMemIndexFormatIndex *index = user_data;
-  gint64 val1, val2;
-  gint64 diff;
+#define FORMAT_VALUE(index,i) \
+  GST_INDEX_ASSOC_VALUE ((GstIndexEntry *) \
+      g_ptr_array_index ((index)->entries, (i)), (index)->offset)
 
-  val1 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) a), index->offset);
-  val2 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) b), index->offset);
+/* position of the first entry with a value not smaller than @value */
+static guint
+mem_index_lower_bound (GstMemIndexFormatIndex * index, gint64 value)
+{
+  guint lo = 0, hi = index->entries->len;
 
-  diff = (val2 - val1);
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
 
-  return (diff == 0 ? 0 : (diff > 0 ? 1 : -1));
+    if (FORMAT_VALUE (index, mid) < value)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
 }
 
 static void
@@ -220,6 +230,8 @@ gst_mem_index_index_format (GstMemIndexId * id_index, GstIndexEntry * entry,
 {
   GstMemIndexFormatIndex *index;
   GstFormat *format;
+  gint64 value;
+  guint len, pos;
 
   format = &GST_INDEX_ASSOC_FORMAT (entry, assoc);
 
@@ -230,12 +242,31 @@ gst_mem_index_index_format (GstMemIndexId * id_index, GstIndexEntry * entry,
 
     index->format = *format;
     index->offset = assoc;
-    index->tree = g_tree_new_with_data (mem_index_compare, index);
+    index->entries = g_ptr_array_new ();
 
     g_hash_table_insert (id_index->format_index, &index->format, index);
   }
 
-  g_tree_insert (index->tree, entry, entry);
+  value = GST_INDEX_ASSOC_VALUE (entry, assoc);
+  len = index->entries->len;
+
+  /* common case, the entry goes at the end */
+  if (len == 0 || FORMAT_VALUE (index, len - 1) < value) {
+    g_ptr_array_add (index->entries, entry);
+    return;
+  }
+
+  pos = mem_index_lower_bound (index, value);
+  if (pos < len && FORMAT_VALUE (index, pos) == value) {
+    /* an entry with the same value is replaced */
+    g_ptr_array_index (index->entries, pos) = entry;
+    return;
+  }
+
+  g_ptr_array_add (index->entries, NULL);
+  memmove (&index->entries->pdata[pos + 1], &index->entries->pdata[pos],
+      (len - pos) * sizeof (gpointer));
+  g_ptr_array_index (index->entries, pos) = entry;
 }
 
 static void
@@ -244,7 +275,7 @@ gst_mem_index_add_association (GstIndex * index, GstIndexEntry * entry)
   GstMemIndex *memindex = GST_MEM_INDEX (index);
   GstMemIndexId *id_index;
 
-  memindex->associations = g_list_prepend (memindex->associations, entry);
+  g_ptr_array_add (memindex->associations, entry);
 
   id_index = g_hash_table_lookup (memindex->id_index, &entry->id);
   if (id_index) {
@@ -289,54 +320,6 @@ gst_mem_index_add_entry (GstIndex * index, GstIndexEntry * entry)
   }
 }
 
-typedef struct
-{
-  gint64 value;
-  GstMemIndexFormatIndex *index;
-  gboolean exact;
-  GstIndexEntry *lower;
-  gint64 low_diff;
-  GstIndexEntry *higher;
-  gint64 high_diff;
-}
-GstMemIndexSearchData;
-
-static gint
-mem_index_search (gconstpointer a, gconstpointer b)
-{
-  GstMemIndexSearchData *data = (GstMemIndexSearchData *) b;
-  GstMemIndexFormatIndex *index = data->index;
-  gint64 val1, val2;
-  gint64 diff;
-
-  val1 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) a), index->offset);
-  val2 = data->value;
-
-  diff = (val1 - val2);
-  if (diff == 0)
-    return 0;
-
-  /* exact matching, don't update low/high */
-  if (data->exact)
-    return (diff > 0 ? 1 : -1);
-
-  if (diff < 0) {
-    if (diff > data->low_diff) {
-      data->low_diff = diff;
-      data->lower = (GstIndexEntry *) a;
-    }
-    diff = -1;
-  } else {
-    if (diff < data->high_diff) {
-      data->high_diff = diff;
-      data->higher = (GstIndexEntry *) a;
-    }
-    diff = 1;
-  }
-
-  return diff;
-}
-
 static GstIndexEntry *
 gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
     GstIndexLookupMethod method,
@@ -347,7 +330,8 @@ gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
   GstMemIndexId *id_index;
   GstMemIndexFormatIndex *format_index;
   GstIndexEntry *entry;
-  GstMemIndexSearchData data;
+  guint len, pos;
+  gint i;
 
   id_index = g_hash_table_lookup (memindex->id_index, &id);
   if (!id_index)
@@ -357,54 +341,36 @@ gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
   if (!format_index)
     return NULL;
 
-  data.value = value;
-  data.index = format_index;
-  data.exact = (method == GST_INDEX_LOOKUP_EXACT);
-
-  /* setup data for low/high checks if we are not looking
-   * for an exact match */
-  if (!data.exact) {
-    data.low_diff = G_MININT64;
-    data.lower = NULL;
-    data.high_diff = G_MAXINT64;
-    data.higher = NULL;
-  }
-
-  entry = g_tree_search (format_index->tree, mem_index_search, &data);
+  len = format_index->entries->len;
+  pos = mem_index_lower_bound (format_index, value);
 
-  /* get the low/high values if we're not exact */
-  if (entry == NULL && !data.exact) {
-    if (method == GST_INDEX_LOOKUP_BEFORE)
-      entry = data.lower;
-    else if (method == GST_INDEX_LOOKUP_AFTER) {
-      entry = data.higher;
-    }
+  if (pos < len && FORMAT_VALUE (format_index, pos) == value) {
+    /* exact match */
+    i = pos;
+  } else if (method == GST_INDEX_LOOKUP_BEFORE) {
+    i = (gint) pos - 1;
+  } else if (method == GST_INDEX_LOOKUP_AFTER) {
+    i = pos;
+  } else {
+    return NULL;
   }
 
-  if (entry && ((GST_INDEX_ASSOC_FLAGS (entry) & flags) != flags)) {
-    if (method != GST_INDEX_LOOKUP_EXACT) {
-      GList *l_entry = g_list_find (memindex->associations, entry);
-
-      entry = NULL;
+  /* walk to the nearest entry with the requested flags */
+  while (i >= 0 && (guint) i < len) {
+    entry = g_ptr_array_index (format_index->entries, i);
 
-      while (l_entry) {
-        entry = (GstIndexEntry *) l_entry->data;
+    if ((GST_INDEX_ASSOC_FLAGS (entry) & flags) == flags)
+      return entry;
 
-        if (entry->id == id && (GST_INDEX_ASSOC_FLAGS (entry) & flags) == flags)
-          break;
-
-        if (method == GST_INDEX_LOOKUP_BEFORE)
-          l_entry = g_list_next (l_entry);
-        else if (method == GST_INDEX_LOOKUP_AFTER) {
-          l_entry = g_list_previous (l_entry);
-        }
-      }
-    } else {
-      entry = NULL;
-    }
+    if (method == GST_INDEX_LOOKUP_BEFORE)
+      i--;
+    else if (method == GST_INDEX_LOOKUP_AFTER)
+      i++;
+    else
+      break;
   }
 
-  return entry;
+  return NULL;
 }
 
 #if 0
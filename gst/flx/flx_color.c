@@ -35,6 +35,7 @@ flx_colorspace_converter_new (gint width, gint height)
   new->height = height;
 
   memset (new->palvec, 0, sizeof (new->palvec));
+  memset (new->pal32, 0, sizeof (new->pal32));
   return new;
 }
 
@@ -46,34 +47,44 @@ flx_colorspace_converter_destroy (FlxColorSpaceConverter * flxpal)
   g_free (flxpal);
 }
 
+/* xRGB on big endian and BGRx on little endian are both 0x00RRGGBB when
+ * read as a native 32 bit word */
+static void
+flx_update_pal32 (FlxColorSpaceConverter * flxpal, guint start, guint num)
+{
+  guint i;
+
+  for (i = start; i < start + num; i++) {
+    flxpal->pal32[i] = (flxpal->palvec[i * 3] << 16) |
+        (flxpal->palvec[i * 3 + 1] << 8) | flxpal->palvec[i * 3 + 2];
+  }
+}
+
 void
 flx_colorspace_convert (FlxColorSpaceConverter * flxpal, guchar * src,
     guchar * dest)
 {
-  guint size, col;
+  const guint32 *pal32;
+  guint32 *out;
+  guint i, size;
 
   g_return_if_fail (flxpal != NULL);
   g_return_if_fail (src != dest);
 
-
   size = flxpal->width * flxpal->height;
-
-  while (size--) {
-    col = (*src++ * 3);
-
-#if G_BYTE_ORDER == G_BIG_ENDIAN
-    *dest++ = 0;
-    *dest++ = flxpal->palvec[col];
-    *dest++ = flxpal->palvec[col + 1];
-    *dest++ = flxpal->palvec[col + 2];
-#else
-    *dest++ = flxpal->palvec[col + 2];
-    *dest++ = flxpal->palvec[col + 1];
-    *dest++ = flxpal->palvec[col];
-    *dest++ = 0;
-#endif
+  pal32 = flxpal->pal32;
+  out = (guint32 *) dest;
+
+  /* one table lookup and one 32 bit store per pixel, unrolled so that the
+   * loads of the indices and the stores overlap */
+  for (i = 0; i + 4 <= size; i += 4) {
+    out[i] = pal32[src[i]];
+    out[i + 1] = pal32[src[i + 1]];
+    out[i + 2] = pal32[src[i + 2]];
+    out[i + 3] = pal32[src[i + 3]];
   }
-
+  for (; i < size; i++)
+    out[i] = pal32[src[i]];
 }
 
 
@@ -89,19 +100,18 @@ flx_set_palette_vector (FlxColorSpaceConverter * flxpal, guint start, guint num,
   grab = ((start + num) > 0x100 ? 0x100 - start : num);
 
   if (scale) {
-    gint i = 0;
-
-    start *= 3;
-    while (grab) {
-      flxpal->palvec[start++] = newpal[i++] << scale;
-      flxpal->palvec[start++] = newpal[i++] << scale;
-      flxpal->palvec[start++] = newpal[i++] << scale;
-      grab--;
+    guint i = 0, pos = start * 3;
+
+    while (i < grab * 3) {
+      flxpal->palvec[pos++] = newpal[i++] << scale;
+      flxpal->palvec[pos++] = newpal[i++] << scale;
+      flxpal->palvec[pos++] = newpal[i++] << scale;
     }
   } else {
     memcpy (&flxpal->palvec[start * 3], newpal, grab * 3);
   }
 
+  flx_update_pal32 (flxpal, start, grab);
 }
 
 void
@@ -115,4 +125,6 @@ flx_set_color (FlxColorSpaceConverter * flxpal, guint colr, guint red,
   flxpal->palvec[(colr * 3)] = red << scale;
   flxpal->palvec[(colr * 3) + 1] = green << scale;
   flxpal->palvec[(colr * 3) + 2] = blue << scale;
+
+  flx_update_pal32 (flxpal, colr, 1);
 }
@@ -36,6 +36,8 @@ struct _FlxColorSpaceConverter {
   guint      width;
   guint      height;
   guchar      palvec[768];
+  /* the palette as pixels of the output format */
+  guint32     pal32[256];
 };
 
 void flx_colorspace_converter_destroy(FlxColorSpaceConverter *flxpal);
@@ -71,6 +71,8 @@ static GstStateChangeReturn gst_flxdec_change_state (GstElement * element,
 static gboolean gst_flxdec_src_query_handler (GstPad * pad, GstObject * parent,
     GstQuery * query);
 
+static void gst_flxdec_negotiate_pool (GstFlxDec * flxdec, GstCaps * caps);
+
 static void flx_decode_color (GstFlxDec *, guchar *, guchar *, gint);
 static void flx_decode_brun (GstFlxDec *, guchar *, guchar *);
 static void flx_decode_delta_fli (GstFlxDec *, guchar *, guchar *);
@@ -335,10 +337,8 @@ flx_decode_delta_fli (GstFlxDec * flxdec, guchar * data, guchar * dest)
   guchar *start_p, x;
 
   g_return_if_fail (flxdec != NULL);
-  g_return_if_fail (flxdec->delta_data != NULL);
 
-  /* use last frame for delta */
-  memcpy (dest, flxdec->delta_data, flxdec->size);
+  /* dest still holds the last frame, the delta is applied in place */
 
   start_line = (data[0] + (data[1] << 8));
   lines = (data[2] + (data[3] << 8));
@@ -385,10 +385,8 @@ flx_decode_delta_flc (GstFlxDec * flxdec, guchar * data, guchar * dest)
   guchar *start_p;
 
   g_return_if_fail (flxdec != NULL);
-  g_return_if_fail (flxdec->delta_data != NULL);
 
-  /* use last frame for delta */
-  memcpy (dest, flxdec->delta_data, flxdec->size);
+  /* dest still holds the last frame, the delta is applied in place */
 
   lines = (data[0] + (data[1] << 8));
   data += 2;
@@ -442,6 +440,52 @@ flx_decode_delta_flc (GstFlxDec * flxdec, guchar * data, guchar * dest)
   }
 }
 
+static void
+gst_flxdec_negotiate_pool (GstFlxDec * flxdec, GstCaps * caps)
+{
+  GstQuery *query;
+  GstBufferPool *pool;
+  guint size, min, max;
+  GstStructure *config;
+
+  /* find a pool for the negotiated caps now */
+  query = gst_query_new_allocation (caps, TRUE);
+
+  if (!gst_pad_peer_query (flxdec->srcpad, query)) {
+    GST_DEBUG_OBJECT (flxdec, "didn't get downstream ALLOCATION hints");
+  }
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    /* we got configuration from our peer, parse them */
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    size = MAX (size, flxdec->size * 4);
+  } else {
+    pool = NULL;
+    size = flxdec->size * 4;
+    min = max = 0;
+  }
+
+  if (pool == NULL) {
+    /* we did not get a pool, make one ourselves then */
+    pool = gst_buffer_pool_new ();
+  }
+
+  if (flxdec->pool) {
+    gst_buffer_pool_set_active (flxdec->pool, FALSE);
+    gst_object_unref (flxdec->pool);
+  }
+  flxdec->pool = pool;
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  gst_buffer_pool_set_config (pool, config);
+
+  /* and activate */
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  gst_query_unref (query);
+}
+
 static GstFlowReturn
 gst_flxdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -506,7 +550,10 @@ gst_flxdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
           "framerate", GST_TYPE_FRACTION, (gint) GST_MSECOND,
           (gint) flxdec->frame_time / 1000, NULL);
 
+      flxdec->size = (flxh->width * flxh->height);
+
       gst_pad_set_caps (flxdec->srcpad, caps);
+      gst_flxdec_negotiate_pool (flxdec, caps);
       gst_caps_unref (caps);
 
       if (flxh->depth <= 8)
@@ -520,11 +567,9 @@ gst_flxdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
         GST_LOG ("(FLC) oframe2   :  0x%08x", flxh->oframe2);
       }
 
-      flxdec->size = (flxh->width * flxh->height);
-
-      /* create delta and output frame */
-      flxdec->frame_data = g_malloc (flxdec->size);
-      flxdec->delta_data = g_malloc (flxdec->size);
+      /* create the frame the deltas are applied to */
+      g_free (flxdec->frame_data);
+      flxdec->frame_data = g_malloc0 (flxdec->size);
 
       flxdec->state = GST_FLXDEC_PLAYING;
     }
@@ -560,22 +605,15 @@ gst_flxdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
             break;
 
           /* create 32 bits output frame */
-//          res = gst_pad_alloc_buffer_and_set_caps (flxdec->srcpad,
-//              GST_BUFFER_OFFSET_NONE,
-//              flxdec->size * 4, GST_PAD_CAPS (flxdec->srcpad), &out);
-//          if (res != GST_FLOW_OK)
-//            break;
-
-          out = gst_buffer_new_and_alloc (flxdec->size * 4);
+          res = gst_buffer_pool_acquire_buffer (flxdec->pool, &out, NULL);
+          if (res != GST_FLOW_OK)
+            break;
 
           /* decode chunks */
           flx_decode_chunks (flxdec,
               ((FlxFrameType *) chunk)->chunks,
               chunk + FlxFrameTypeSize, flxdec->frame_data);
 
-          /* save copy of the current frame for possible delta. */
-          memcpy (flxdec->delta_data, flxdec->frame_data, flxdec->size);
-
           gst_buffer_map (out, &map, GST_MAP_WRITE);
           /* convert current frame. */
           flx_colorspace_convert (flxdec->converter, flxdec->frame_data,
@@ -646,9 +684,10 @@ gst_flxdec_change_state (GstElement * element, GstStateChange transition)
         g_free (flxdec->frame_data);
         flxdec->frame_data = NULL;
       }
-      if (flxdec->delta_data) {
-        g_free (flxdec->delta_data);
-        flxdec->delta_data = NULL;
+      if (flxdec->pool) {
+        gst_buffer_pool_set_active (flxdec->pool, FALSE);
+        gst_object_unref (flxdec->pool);
+        flxdec->pool = NULL;
       }
       if (flxdec->converter) {
         flx_colorspace_converter_destroy (flxdec->converter);
@@ -43,8 +43,11 @@ struct _GstFlxDec {
 
   gboolean active, new_meta;
 
-  guint8 *delta_data, *frame_data;
+  /* the palette indices of the current frame, the deltas of the next frame
+   * are applied to it in place */
+  guint8 *frame_data;
   GstAdapter *adapter;
+  GstBufferPool *pool;
   gulong size;
   GstFlxDecState state;
   gint64 frame_time;
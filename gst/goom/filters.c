@@ -51,6 +51,8 @@
 #include "goom_plugin_info.h"
 #include "goom_fx.h"
 #include "v3d.h"
+#include "gstgoomorc.h"
+#include <gst/workers/gstworkers.h>
 
 /* TODO : MOVE THIS AWAY !!! */
 /* jeko: j'ai essayer de le virer, mais si on veut les laisser inline c'est un peu lourdo... */
@@ -115,17 +117,25 @@ getPixelRGB_ (Pixel * buffer, Uint x, Color * c)
 /* faire : a / sqrtperte <=> a >> PERTEDEC */
 #define PERTEDEC 4
 
-/* pure c version of the zoom filter */
+/* number of pixels whose source position is computed at once */
+#define ZOOM_CHUNK 256
+
+/* pure c version of the zoom filter, lines y_start to y_end */
 static void c_zoom (Pixel * expix1, Pixel * expix2, unsigned int prevX,
     unsigned int prevY, signed int *brutS, signed int *brutD, int buffratio,
-    int precalCoef[BUFFPOINTNB][BUFFPOINTNB]);
+    int precalCoef[BUFFPOINTNB][BUFFPOINTNB], unsigned int y_start,
+    unsigned int y_end);
+static void c_zoom_clear_corners (Pixel * expix1, unsigned int prevX,
+    unsigned int prevY);
 
 /* simple wrapper to give it the same proto than the others */
 void
 zoom_filter_c (int sizeX, int sizeY, Pixel * src, Pixel * dest, int *brutS,
     int *brutD, int buffratio, int precalCoef[16][16])
 {
-  c_zoom (src, dest, sizeX, sizeY, brutS, brutD, buffratio, precalCoef);
+  c_zoom_clear_corners (src, sizeX, sizeY);
+  c_zoom (src, dest, sizeX, sizeY, brutS, brutD, buffratio, precalCoef, 0,
+      sizeY);
 }
 
 static void generatePrecalCoef (int precalCoef[BUFFPOINTNB][BUFFPOINTNB]);
@@ -142,6 +152,9 @@ typedef struct _ZOOM_FILTER_FX_WRAPPER_DATA
   signed int *brutS, *freebrutS;        /* source */
   signed int *brutD, *freebrutD;        /* dest */
   signed int *brutT, *freebrutT;        /* temp (en cours de generation) */
+  /* number of ints the brut buffers have room for, they are kept when the
+   * size goes down */
+  unsigned int brut_size;
 
   guint32 zoom_width;
 
@@ -163,6 +176,10 @@ typedef struct _ZOOM_FILTER_FX_WRAPPER_DATA
     /** modif by jeko : fixedpoint : buffration = (16:16) (donc 0<=buffration<=2^16) */
   int buffratio;
   int *firedec;
+  unsigned int firedec_size;
+
+  /* the C zoom is split in bands of lines over these */
+  GstWorkers *workers;
 
     /** modif d'optim by Jeko : precalcul des 4 coefs resultant des 2 pos */
   int precalCoef[BUFFPOINTNB][BUFFPOINTNB];
@@ -451,72 +468,99 @@ makeZoomBufferStripe (ZoomFilterFXWrapperData * data, int INTERLACE_INCR)
 
 
 
+static void
+c_zoom_clear_corners (Pixel * expix1, unsigned int prevX, unsigned int prevY)
+{
+  expix1[0].val = expix1[prevX - 1].val = expix1[prevX * prevY - 1].val =
+      expix1[prevX * prevY - prevX].val = 0;
+}
+
 static void
 c_zoom (Pixel * expix1, Pixel * expix2, unsigned int prevX, unsigned int prevY,
-    signed int *brutS, signed int *brutD, int buffratio, int precalCoef[16][16])
+    signed int *brutS, signed int *brutD, int buffratio, int precalCoef[16][16],
+    unsigned int y_start, unsigned int y_end)
 {
-  int myPos, myPos2;
+  int myPos;
   Color couleur;
 
   unsigned int ax = (prevX - 1) << PERTEDEC, ay = (prevY - 1) << PERTEDEC;
 
-  int bufsize = prevX * prevY * 2;
   int bufwidth = prevX;
+  gint32 coords[ZOOM_CHUNK * 2];
+  unsigned int x, y, i, n;
+
+  for (y = y_start; y < y_end; y++) {
+    for (x = 0; x < prevX; x += n) {
+      n = MIN (ZOOM_CHUNK, prevX - x);
+      myPos = y * prevX + x;
+
+      /* position between the source and the destination of the move */
+      goom_orc_zoom_coords (coords, brutS + myPos * 2, brutD + myPos * 2,
+          buffratio, n * 2);
+
+      for (i = 0; i < n; i++) {
+        Color col1, col2, col3, col4;
+        int c1, c2, c3, c4, px, py;
+        int pos;
+        int coeffs;
+
+        px = coords[i * 2];
+        py = coords[i * 2 + 1];
+
+        if ((py >= ay) || (px >= ax)) {
+          pos = coeffs = 0;
+        } else {
+          pos = ((px >> PERTEDEC) + prevX * (py >> PERTEDEC));
+          /* coef en modulo 15 */
+          coeffs = precalCoef[px & PERTEMASK][py & PERTEMASK];
+        }
+        getPixelRGB_ (expix1, pos, &col1);
+        getPixelRGB_ (expix1, pos + 1, &col2);
+        getPixelRGB_ (expix1, pos + bufwidth, &col3);
+        getPixelRGB_ (expix1, pos + bufwidth + 1, &col4);
+
+        c1 = coeffs;
+        c2 = (c1 >> 8) & 0xFF;
+        c3 = (c1 >> 16) & 0xFF;
+        c4 = (c1 >> 24) & 0xFF;
+        c1 = c1 & 0xff;
+
+        couleur.r = col1.r * c1 + col2.r * c2 + col3.r * c3 + col4.r * c4;
+        if (couleur.r > 5)
+          couleur.r -= 5;
+        couleur.r >>= 8;
+
+        couleur.v = col1.v * c1 + col2.v * c2 + col3.v * c3 + col4.v * c4;
+        if (couleur.v > 5)
+          couleur.v -= 5;
+        couleur.v >>= 8;
+
+        couleur.b = col1.b * c1 + col2.b * c2 + col3.b * c3 + col4.b * c4;
+        if (couleur.b > 5)
+          couleur.b -= 5;
+        couleur.b >>= 8;
+
+        setPixelRGB_ (expix2, myPos + i, couleur);
+      }
+    }
+  }
+}
 
-  expix1[0].val = expix1[prevX - 1].val = expix1[prevX * prevY - 1].val =
-      expix1[prevX * prevY - prevX].val = 0;
-
-  for (myPos = 0; myPos < bufsize; myPos += 2) {
-    Color col1, col2, col3, col4;
-    int c1, c2, c3, c4, px, py;
-    int pos;
-    int coeffs;
-
-    int brutSmypos = brutS[myPos];
-
-    myPos2 = myPos + 1;
+typedef struct
+{
+  ZoomFilterFXWrapperData *data;
+  Pixel *src, *dest;
+} ZoomFilterBand;
 
-    px = brutSmypos + (((brutD[myPos] -
-                brutSmypos) * buffratio) >> BUFFPOINTNB);
-    brutSmypos = brutS[myPos2];
-    py = brutSmypos + (((brutD[myPos2] -
-                brutSmypos) * buffratio) >> BUFFPOINTNB);
+static void
+zoom_filter_c_band (gpointer user_data, guint slice, guint n_slices)
+{
+  ZoomFilterBand *band = user_data;
+  ZoomFilterFXWrapperData *data = band->data;
 
-    if ((py >= ay) || (px >= ax)) {
-      pos = coeffs = 0;
-    } else {
-      pos = ((px >> PERTEDEC) + prevX * (py >> PERTEDEC));
-      /* coef en modulo 15 */
-      coeffs = precalCoef[px & PERTEMASK][py & PERTEMASK];
-    }
-    getPixelRGB_ (expix1, pos, &col1);
-    getPixelRGB_ (expix1, pos + 1, &col2);
-    getPixelRGB_ (expix1, pos + bufwidth, &col3);
-    getPixelRGB_ (expix1, pos + bufwidth + 1, &col4);
-
-    c1 = coeffs;
-    c2 = (c1 >> 8) & 0xFF;
-    c3 = (c1 >> 16) & 0xFF;
-    c4 = (c1 >> 24) & 0xFF;
-    c1 = c1 & 0xff;
-
-    couleur.r = col1.r * c1 + col2.r * c2 + col3.r * c3 + col4.r * c4;
-    if (couleur.r > 5)
-      couleur.r -= 5;
-    couleur.r >>= 8;
-
-    couleur.v = col1.v * c1 + col2.v * c2 + col3.v * c3 + col4.v * c4;
-    if (couleur.v > 5)
-      couleur.v -= 5;
-    couleur.v >>= 8;
-
-    couleur.b = col1.b * c1 + col2.b * c2 + col3.b * c3 + col4.b * c4;
-    if (couleur.b > 5)
-      couleur.b -= 5;
-    couleur.b >>= 8;
-
-    setPixelRGB_ (expix2, myPos >> 1, couleur);
-  }
+  c_zoom (band->src, band->dest, data->prevX, data->prevY, data->brutS,
+      data->brutD, data->buffratio, data->precalCoef,
+      data->prevY * slice / n_slices, data->prevY * (slice + 1) / n_slices);
 }
 
 /** generate the water fx horizontal direction buffer */
@@ -585,8 +629,6 @@ void
 zoomFilterFastRGB (PluginInfo * goomInfo, Pixel * pix1, Pixel * pix2,
     ZoomFilterData * zf, Uint resx, Uint resy, int switchIncr, float switchMult)
 {
-  Uint x, y;
-
   ZoomFilterFXWrapperData *data =
       (ZoomFilterFXWrapperData *) goomInfo->zoomFilter_fx.fx_data;
 
@@ -598,22 +640,10 @@ zoomFilterFastRGB (PluginInfo * goomInfo, Pixel * pix1, Pixel * pix2,
     data->prevX = resx;
     data->prevY = resy;
 
-    if (data->brutS)
-      free (data->freebrutS);
-    data->brutS = 0;
-    if (data->brutD)
-      free (data->freebrutD);
-    data->brutD = 0;
-    if (data->brutT)
-      free (data->freebrutT);
-    data->brutT = 0;
-
+    /* the buffers are only made bigger when the buffers are initialised */
     data->middleX = resx / 2;
     data->middleY = resy / 2;
     data->mustInitBuffers = 1;
-    if (data->firedec)
-      free (data->firedec);
-    data->firedec = 0;
   }
 
   if (data->interlace_start != -2)
@@ -640,24 +670,35 @@ zoomFilterFastRGB (PluginInfo * goomInfo, Pixel * pix1, Pixel * pix2,
   if (data->mustInitBuffers) {
 
     data->mustInitBuffers = 0;
-    data->freebrutS =
-        (signed int *) calloc (resx * resy * 2 + 128, sizeof (unsigned int));
-    data->brutS =
-        (gint32 *) ((1 + ((uintptr_t) (data->freebrutS)) / 128) * 128);
-
-    data->freebrutD =
-        (signed int *) calloc (resx * resy * 2 + 128, sizeof (unsigned int));
-    data->brutD =
-        (gint32 *) ((1 + ((uintptr_t) (data->freebrutD)) / 128) * 128);
-
-    data->freebrutT =
-        (signed int *) calloc (resx * resy * 2 + 128, sizeof (unsigned int));
-    data->brutT =
-        (gint32 *) ((1 + ((uintptr_t) (data->freebrutT)) / 128) * 128);
+    if (resx * resy * 2 > data->brut_size) {
+      free (data->freebrutS);
+      free (data->freebrutD);
+      free (data->freebrutT);
+      data->brut_size = resx * resy * 2;
+
+      data->freebrutS =
+          (signed int *) calloc (data->brut_size + 128, sizeof (unsigned int));
+      data->brutS =
+          (gint32 *) ((1 + ((uintptr_t) (data->freebrutS)) / 128) * 128);
+
+      data->freebrutD =
+          (signed int *) calloc (data->brut_size + 128, sizeof (unsigned int));
+      data->brutD =
+          (gint32 *) ((1 + ((uintptr_t) (data->freebrutD)) / 128) * 128);
+
+      data->freebrutT =
+          (signed int *) calloc (data->brut_size + 128, sizeof (unsigned int));
+      data->brutT =
+          (gint32 *) ((1 + ((uintptr_t) (data->freebrutT)) / 128) * 128);
+    }
 
     data->buffratio = 0;
 
-    data->firedec = (int *) malloc (data->prevY * sizeof (int));
+    if (data->prevY > data->firedec_size) {
+      free (data->firedec);
+      data->firedec = (int *) malloc (data->prevY * sizeof (int));
+      data->firedec_size = data->prevY;
+    }
     generateTheWaterFXHorizontalDirectionBuffer (goomInfo, data);
 
     data->interlace_start = 0;
@@ -673,19 +714,8 @@ zoomFilterFastRGB (PluginInfo * goomInfo, Pixel * pix1, Pixel * pix2,
 
     /* sauvegarde de l'etat actuel dans la nouvelle source
      * TODO: write that in MMX (has been done in previous version, but did not follow some new fonctionnalities) */
-    y = data->prevX * data->prevY * 2;
-    for (x = 0; x < y; x += 2) {
-      int brutSmypos = data->brutS[x];
-      int x2 = x + 1;
-
-      data->brutS[x] =
-          brutSmypos + (((data->brutD[x] -
-                  brutSmypos) * data->buffratio) >> BUFFPOINTNB);
-      brutSmypos = data->brutS[x2];
-      data->brutS[x2] =
-          brutSmypos + (((data->brutD[x2] -
-                  brutSmypos) * data->buffratio) >> BUFFPOINTNB);
-    }
+    goom_orc_zoom_coords (data->brutS, data->brutS, data->brutD,
+        data->buffratio, data->prevX * data->prevY * 2);
     data->buffratio = 0;
   }
 
@@ -719,8 +749,22 @@ zoomFilterFastRGB (PluginInfo * goomInfo, Pixel * pix1, Pixel * pix2,
 
   data->zoom_width = data->prevX;
 
-  goomInfo->methods.zoom_filter (data->prevX, data->prevY, pix1, pix2,
-      data->brutS, data->brutD, data->buffratio, data->precalCoef);
+  gst_workers_ensure (&data->workers, goomInfo->n_threads);
+
+  /* the asm versions always do the complete frame */
+  if (data->workers && goomInfo->methods.zoom_filter == zoom_filter_c) {
+    ZoomFilterBand band;
+
+    band.data = data;
+    band.src = pix1;
+    band.dest = pix2;
+
+    c_zoom_clear_corners (pix1, data->prevX, data->prevY);
+    gst_workers_run (data->workers, zoom_filter_c_band, &band);
+  } else {
+    goomInfo->methods.zoom_filter (data->prevX, data->prevY, pix1, pix2,
+        data->brutS, data->brutD, data->buffratio, data->precalCoef);
+  }
 }
 
 static void
@@ -781,6 +825,7 @@ zoomFilterVisualFXWrapper_init (struct _VISUAL_FX *_this, PluginInfo * info)
   data->freebrutD = 0;
   data->brutT = 0;
   data->freebrutT = 0;
+  data->brut_size = 0;
   data->prevX = 0;
   data->prevY = 0;
 
@@ -799,6 +844,9 @@ zoomFilterVisualFXWrapper_init (struct _VISUAL_FX *_this, PluginInfo * info)
     /** modif by jeko : fixedpoint : buffration = (16:16) (donc 0<=buffration<=2^16) */
   data->buffratio = 0;
   data->firedec = 0;
+  data->firedec_size = 0;
+
+  data->workers = NULL;
 
   data->wave = data->wavesp = 0;
 
@@ -827,6 +875,8 @@ zoomFilterVisualFXWrapper_free (struct _VISUAL_FX *_this)
     free (data->freebrutD);
   if (data->firedec)
     free (data->firedec);
+  if (data->workers)
+    gst_workers_free (data->workers);
 
   goom_plugin_parameters_free (_this->params);
 
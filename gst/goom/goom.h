@@ -27,6 +27,9 @@
 PluginInfo *goom_init (guint32 resx, guint32 resy);
 void goom_set_resolution (PluginInfo *goomInfo, guint32 resx, guint32 resy);
 
+/* split the zoom filter over n_threads threads, 1 by default */
+void goom_set_n_threads (PluginInfo *goomInfo, guint n_threads);
+
 /*
  * forceMode == 0 : do nothing
  * forceMode == -1 : lock the FX
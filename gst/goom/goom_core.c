@@ -146,6 +146,12 @@ goom_set_resolution (PluginInfo * goomInfo, guint32 resx, guint32 resy)
   goom_lines_set_res (goomInfo->gmline2, resx, goomInfo->screen.height);
 }
 
+void
+goom_set_n_threads (PluginInfo * goomInfo, guint n_threads)
+{
+  goomInfo->n_threads = MAX (n_threads, 1);
+}
+
 int
 goom_set_screenbuffer (PluginInfo * goomInfo, void *buffer)
 {
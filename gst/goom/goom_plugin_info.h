@@ -170,6 +170,9 @@ struct _PLUGIN_INFO {
 	} methods;
 	
 	GoomRandom *gRandom;
+
+	/** number of threads the zoom filter is split over */
+	guint n_threads;
 };
 
 void plugin_info_init(PluginInfo *p, int nbVisual); 
@@ -56,6 +56,7 @@ GST_DEBUG_CATEGORY (goom_debug);
 #define DEFAULT_HEIGHT 240
 #define DEFAULT_FPS_N  25
 #define DEFAULT_FPS_D  1
+#define DEFAULT_N_THREADS 1
 
 /* signals and args */
 enum
@@ -66,8 +67,8 @@ enum
 
 enum
 {
-  ARG_0
-      /* FILL ME */
+  PROP_0,
+  PROP_N_THREADS
 };
 
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
@@ -97,6 +98,10 @@ static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
 
 
 static void gst_goom_finalize (GObject * object);
+static void gst_goom_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_goom_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static GstStateChangeReturn gst_goom_change_state (GstElement * element,
     GstStateChange transition);
@@ -126,6 +131,22 @@ gst_goom_class_init (GstGoomClass * klass)
   gstelement_class = (GstElementClass *) klass;
 
   gobject_class->finalize = gst_goom_finalize;
+  gobject_class->set_property = gst_goom_set_property;
+  gobject_class->get_property = gst_goom_get_property;
+
+  /**
+   * GstGoom:n-threads:
+   *
+   * The number of threads that run the zoom filter, each of them does a
+   * band of lines of the output. The asm versions of the filter always use
+   * one thread.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to zoom a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class, "GOOM: what a GOOM!",
       "Visualization",
@@ -157,15 +178,12 @@ gst_goom_init (GstGoom * goom)
       GST_DEBUG_FUNCPTR (gst_goom_src_query));
   gst_element_add_pad (GST_ELEMENT (goom), goom->srcpad);
 
-  goom->adapter = gst_adapter_new ();
+  gst_visual_render_init (&goom->render, GST_ELEMENT (goom));
 
   goom->width = DEFAULT_WIDTH;
   goom->height = DEFAULT_HEIGHT;
-  goom->fps_n = DEFAULT_FPS_N;  /* desired frame rate */
-  goom->fps_d = DEFAULT_FPS_D;  /* desired frame rate */
   goom->channels = 0;
-  goom->rate = 0;
-  goom->duration = 0;
+  goom->n_threads = DEFAULT_N_THREADS;
 
   goom->plugin = goom_init (goom->width, goom->height);
 }
@@ -178,36 +196,66 @@ gst_goom_finalize (GObject * object)
   goom_close (goom->plugin);
   goom->plugin = NULL;
 
-  g_object_unref (goom->adapter);
-  if (goom->pool)
-    gst_object_unref (goom->pool);
+  gst_visual_render_clear (&goom->render);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static void
-gst_goom_reset (GstGoom * goom)
+gst_goom_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
 {
-  gst_adapter_clear (goom->adapter);
-  gst_segment_init (&goom->segment, GST_FORMAT_UNDEFINED);
+  GstGoom *goom = GST_GOOM (object);
 
-  GST_OBJECT_LOCK (goom);
-  goom->proportion = 1.0;
-  goom->earliest_time = -1;
-  GST_OBJECT_UNLOCK (goom);
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (goom);
+      goom->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (goom);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_goom_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGoom *goom = GST_GOOM (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (goom);
+      g_value_set_uint (value, goom->n_threads);
+      GST_OBJECT_UNLOCK (goom);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_goom_reset (GstGoom * goom)
+{
+  gst_visual_render_reset (&goom->render);
 }
 
 static gboolean
 gst_goom_sink_setcaps (GstGoom * goom, GstCaps * caps)
 {
   GstStructure *structure;
+  gint rate = 0;
 
   structure = gst_caps_get_structure (caps, 0);
 
   gst_structure_get_int (structure, "channels", &goom->channels);
-  gst_structure_get_int (structure, "rate", &goom->rate);
+  gst_structure_get_int (structure, "rate", &rate);
 
-  goom->bps = goom->channels * sizeof (gint16);
+  gst_visual_render_set_audio (&goom->render, rate,
+      goom->channels * sizeof (gint16));
 
   return gst_goom_src_negotiate (goom);
 }
@@ -216,26 +264,23 @@ static gboolean
 gst_goom_src_setcaps (GstGoom * goom, GstCaps * caps)
 {
   GstStructure *structure;
+  gint fps_n, fps_d;
   gboolean res;
 
   structure = gst_caps_get_structure (caps, 0);
   if (!gst_structure_get_int (structure, "width", &goom->width) ||
       !gst_structure_get_int (structure, "height", &goom->height) ||
-      !gst_structure_get_fraction (structure, "framerate", &goom->fps_n,
-          &goom->fps_d))
+      !gst_structure_get_fraction (structure, "framerate", &fps_n, &fps_d))
     goto error;
 
   goom_set_resolution (goom->plugin, goom->width, goom->height);
 
   /* size of the output buffer in bytes, depth is always 4 bytes */
   goom->outsize = goom->width * goom->height * 4;
-  goom->duration =
-      gst_util_uint64_scale_int (GST_SECOND, goom->fps_d, goom->fps_n);
-  goom->spf = gst_util_uint64_scale_int (goom->rate, goom->fps_d, goom->fps_n);
-  goom->bpf = goom->spf * goom->bps;
+  gst_visual_render_set_video (&goom->render, fps_n, fps_d);
 
   GST_DEBUG_OBJECT (goom, "dimension %dx%d, framerate %d/%d, spf %d",
-      goom->width, goom->height, goom->fps_n, goom->fps_d, goom->spf);
+      goom->width, goom->height, fps_n, fps_d, goom->render.spf);
 
   res = gst_pad_set_caps (goom->srcpad, caps);
 
@@ -255,10 +300,7 @@ gst_goom_src_negotiate (GstGoom * goom)
   GstCaps *othercaps, *target;
   GstStructure *structure;
   GstCaps *templ;
-  GstQuery *query;
-  GstBufferPool *pool;
-  GstStructure *config;
-  guint size, min, max;
+  gboolean res;
 
   templ = gst_pad_get_pad_template_caps (goom->srcpad);
 
@@ -288,45 +330,13 @@ gst_goom_src_negotiate (GstGoom * goom)
 
   gst_goom_src_setcaps (goom, target);
 
-  /* try to get a bufferpool now */
   /* find a pool for the negotiated caps now */
-  query = gst_query_new_allocation (target, TRUE);
-
-  if (!gst_pad_peer_query (goom->srcpad, query)) {
-    /* no problem, we use the query defaults */
-    GST_DEBUG_OBJECT (goom, "ALLOCATION query failed");
-  }
-
-  if (gst_query_get_n_allocation_pools (query) > 0) {
-    /* we got configuration from our peer, parse them */
-    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
-  } else {
-    pool = NULL;
-    size = goom->outsize;
-    min = max = 0;
-  }
-
-  if (pool == NULL) {
-    /* we did not get a pool, make one ourselves then */
-    pool = gst_buffer_pool_new ();
-  }
-
-  config = gst_buffer_pool_get_config (pool);
-  gst_buffer_pool_config_set_params (config, target, size, min, max);
-  gst_buffer_pool_set_config (pool, config);
-
-  if (goom->pool) {
-    gst_buffer_pool_set_active (goom->pool, FALSE);
-    gst_object_unref (goom->pool);
-  }
-  goom->pool = pool;
-
-  /* and activate */
-  gst_buffer_pool_set_active (pool, TRUE);
+  res = gst_visual_render_setup_pool (&goom->render, goom->srcpad, target,
+      goom->outsize);
 
   gst_caps_unref (target);
 
-  return TRUE;
+  return res;
 
 no_format:
   {
@@ -345,27 +355,10 @@ gst_goom_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_QOS:
-    {
-      gdouble proportion;
-      GstClockTimeDiff diff;
-      GstClockTime timestamp;
-
-      gst_event_parse_qos (event, NULL, &proportion, &diff, &timestamp);
-
       /* save stuff for the _chain() function */
-      GST_OBJECT_LOCK (goom);
-      goom->proportion = proportion;
-      if (diff >= 0)
-        /* we're late, this is a good estimate for next displayable
-         * frame (see part-qos.txt) */
-        goom->earliest_time = timestamp + 2 * diff + goom->duration;
-      else
-        goom->earliest_time = timestamp + diff;
-      GST_OBJECT_UNLOCK (goom);
-
+      gst_visual_render_update_qos (&goom->render, event);
       res = gst_pad_event_default (pad, parent, event);
       break;
-    }
     default:
       res = gst_pad_event_default (pad, parent, event);
       break;
@@ -397,15 +390,9 @@ gst_goom_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       res = gst_pad_event_default (pad, parent, event);
       break;
     case GST_EVENT_SEGMENT:
-    {
-      /* the newsegment values are used to clip the input samples
-       * and to convert the incomming timestamps to running time so
-       * we can do QoS */
-      gst_event_copy_segment (event, &goom->segment);
-
+      gst_visual_render_set_segment (&goom->render, event);
       res = gst_pad_event_default (pad, parent, event);
       break;
-    }
     default:
       res = gst_pad_event_default (pad, parent, event);
       break;
@@ -432,7 +419,7 @@ gst_goom_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       GstClockTime our_latency;
       guint max_samples;
 
-      if (goom->rate == 0)
+      if (goom->render.rate == 0)
         break;
 
       if ((res = gst_pad_peer_query (goom->sinkpad, query))) {
@@ -443,9 +430,9 @@ gst_goom_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
             GST_TIME_ARGS (min_latency), GST_TIME_ARGS (max_latency));
 
         /* the max samples we must buffer buffer */
-        max_samples = MAX (GOOM_SAMPLES, goom->spf);
-        our_latency =
-            gst_util_uint64_scale_int (max_samples, GST_SECOND, goom->rate);
+        max_samples = MAX (GOOM_SAMPLES, goom->render.spf);
+        our_latency = gst_util_uint64_scale_int (max_samples, GST_SECOND,
+            goom->render.rate);
 
         GST_DEBUG_OBJECT (goom, "Our latency: %" GST_TIME_FORMAT,
             GST_TIME_ARGS (our_latency));
@@ -490,9 +477,11 @@ gst_goom_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstGoom *goom;
   GstFlowReturn ret;
   GstBuffer *outbuf = NULL;
+  GstClockTime timestamp;
+  guint n_samples;
 
   goom = GST_GOOM (parent);
-  if (goom->bps == 0) {
+  if (goom->render.bps == 0) {
     gst_buffer_unref (buffer);
     ret = GST_FLOW_NOT_NEGOTIATED;
     goto beach;
@@ -505,72 +494,28 @@ gst_goom_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     goto beach;
   }
 
-  /* don't try to combine samples from discont buffer */
-  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT)) {
-    gst_adapter_clear (goom->adapter);
-  }
-
-  GST_DEBUG_OBJECT (goom,
-      "Input buffer has %" G_GSIZE_FORMAT " samples, time=%" G_GUINT64_FORMAT,
-      gst_buffer_get_size (buffer) / goom->bps, GST_BUFFER_TIMESTAMP (buffer));
-
   /* Collect samples until we have enough for an output frame */
-  gst_adapter_push (goom->adapter, buffer);
+  gst_visual_render_push (&goom->render, buffer);
 
   ret = GST_FLOW_OK;
 
-  while (TRUE) {
+  /* we need GOOM_SAMPLES to get a meaningful result from goom, a frame
+   * might need more */
+  while (gst_visual_render_next_frame (&goom->render, GOOM_SAMPLES, &timestamp,
+          &n_samples)) {
     const guint16 *data;
     guchar *out_frame;
     gint i;
-    guint avail, to_flush;
-    guint64 dist, timestamp;
-
-    avail = gst_adapter_available (goom->adapter);
-    GST_DEBUG_OBJECT (goom, "avail now %u", avail);
-
-    /* we need GOOM_SAMPLES to get a meaningful result from goom. */
-    if (avail < (GOOM_SAMPLES * goom->bps))
-      break;
-
-    /* we also need enough samples to produce one frame at least */
-    if (avail < goom->bpf)
-      break;
-
-    GST_DEBUG_OBJECT (goom, "processing buffer");
-
-    /* get timestamp of the current adapter byte */
-    timestamp = gst_adapter_prev_pts (goom->adapter, &dist);
-    if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
-      /* convert bytes to time */
-      dist /= goom->bps;
-      timestamp += gst_util_uint64_scale_int (dist, GST_SECOND, goom->rate);
-    }
-
-    if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
-      gint64 qostime;
-      gboolean need_skip;
 
-      qostime = gst_segment_to_running_time (&goom->segment, GST_FORMAT_TIME,
-          timestamp) + goom->duration;
+    GST_DEBUG_OBJECT (goom, "processing frame of %u samples", n_samples);
 
-      GST_OBJECT_LOCK (goom);
-      /* check for QoS, don't compute buffers that are known to be late */
-      need_skip = goom->earliest_time != -1 && qostime <= goom->earliest_time;
-      GST_OBJECT_UNLOCK (goom);
-
-      if (need_skip) {
-        GST_WARNING_OBJECT (goom,
-            "QoS: skip ts: %" GST_TIME_FORMAT ", earliest: %" GST_TIME_FORMAT,
-            GST_TIME_ARGS (qostime), GST_TIME_ARGS (goom->earliest_time));
-        goto skip;
-      }
-    }
+    if (gst_visual_render_is_late (&goom->render, timestamp))
+      goto skip;
 
     /* get next GOOM_SAMPLES, we have at least this amount of samples */
     data =
-        (const guint16 *) gst_adapter_map (goom->adapter,
-        GOOM_SAMPLES * goom->bps);
+        (const guint16 *) gst_adapter_map (goom->render.adapter,
+        GOOM_SAMPLES * goom->render.bps);
 
     if (goom->channels == 2) {
       for (i = 0; i < GOOM_SAMPLES; i++) {
@@ -584,48 +529,35 @@ gst_goom_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       }
     }
 
-    /* alloc a buffer if we don't have one yet, this happens
-     * when we pushed a buffer in this while loop before */
-    if (outbuf == NULL) {
-      GST_DEBUG_OBJECT (goom, "allocating output buffer");
-      ret = gst_buffer_pool_acquire_buffer (goom->pool, &outbuf, NULL);
-      if (ret != GST_FLOW_OK) {
-        gst_adapter_unmap (goom->adapter);
-        goto beach;
-      }
-    }
+    gst_adapter_unmap (goom->render.adapter);
+
+    ret = gst_visual_render_acquire_buffer (&goom->render, timestamp, &outbuf);
+    if (ret != GST_FLOW_OK)
+      goto beach;
 
-    GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
-    GST_BUFFER_DURATION (outbuf) = goom->duration;
+    GST_OBJECT_LOCK (goom);
+    goom_set_n_threads (goom->plugin, goom->n_threads);
+    GST_OBJECT_UNLOCK (goom);
 
     out_frame = (guchar *) goom_update (goom->plugin, goom->datain, 0, 0);
     gst_buffer_fill (outbuf, 0, out_frame, goom->outsize);
 
-    gst_adapter_unmap (goom->adapter);
-
     GST_DEBUG ("Pushing frame with time=%" GST_TIME_FORMAT ", duration=%"
         GST_TIME_FORMAT, GST_TIME_ARGS (timestamp),
-        GST_TIME_ARGS (goom->duration));
+        GST_TIME_ARGS (goom->render.duration));
 
     ret = gst_pad_push (goom->srcpad, outbuf);
     outbuf = NULL;
 
   skip:
-    /* Now flush the samples we needed for this frame, which might be more than
-     * the samples we used (GOOM_SAMPLES). */
-    to_flush = goom->bpf;
-
-    GST_DEBUG_OBJECT (goom, "finished frame, flushing %u bytes from input",
-        to_flush);
-    gst_adapter_flush (goom->adapter, to_flush);
+    /* Now flush the samples of this frame, which might be more than the
+     * samples we used (GOOM_SAMPLES). */
+    gst_visual_render_finish_frame (&goom->render, n_samples);
 
     if (ret != GST_FLOW_OK)
       break;
   }
 
-  if (outbuf != NULL)
-    gst_buffer_unref (outbuf);
-
 beach:
 
   return ret;
@@ -651,10 +583,7 @@ gst_goom_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      if (goom->pool) {
-        gst_buffer_pool_set_active (goom->pool, FALSE);
-        gst_object_replace ((GstObject **) & goom->pool, NULL);
-      }
+      gst_visual_render_release_pool (&goom->render);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
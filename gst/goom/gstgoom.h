@@ -23,8 +23,8 @@
 G_BEGIN_DECLS
 
 #include <gst/gst.h>
-#include <gst/base/gstadapter.h>
 #include "goom.h"
+#include <gst/visual/gstvisualrender.h>
 
 #define GOOM_SAMPLES 512
 
@@ -43,37 +43,22 @@ struct _GstGoom
 
   /* pads */
   GstPad *sinkpad, *srcpad;
-  GstAdapter *adapter;
+
+  /* audio collection, frame timing, QoS and output buffers */
+  GstVisualRender render;
 
   /* input tracking */
-  gint rate;
   gint channels;
-  guint bps;
 
   /* video state */
-  gint fps_n;
-  gint fps_d;
   gint width;
   gint height;
-  GstClockTime duration;
   guint outsize;
-  GstBufferPool *pool;
-
-  /* samples per frame */
-  guint spf;
-  /* bytes per frame */
-  guint bpf;
 
   /* goom stuff */
   gint16 datain[2][GOOM_SAMPLES];
   PluginInfo *plugin;
-
-  /* segment state */
-  GstSegment segment;
-
-  /* QoS stuff *//* with LOCK */
-  gdouble proportion;
-  GstClockTime earliest_time;
+  guint n_threads;
 };
 
 struct _GstGoomClass
@@ -152,6 +152,7 @@ plugin_info_init (PluginInfo * pp, int nbVisuals)
   pp->params = NULL;
   pp->nbVisuals = nbVisuals;
   pp->visuals = (VisualFX **) malloc (sizeof (VisualFX *) * nbVisuals);
+  pp->n_threads = 1;
 
   pp->sound.params.params[0] = &pp->sound.biggoom_speed_limit_p;
   pp->sound.params.params[1] = &pp->sound.biggoom_factor_p;
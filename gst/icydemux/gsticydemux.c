@@ -290,13 +290,13 @@ gst_icydemux_remove_srcpad (GstICYDemux * icydemux)
 };
 
 static gchar *
-gst_icydemux_unicodify (const gchar * str)
+gst_icydemux_unicodify (const gchar * str, gint len)
 {
   const gchar *env_vars[] = { "GST_ICY_TAG_ENCODING",
     "GST_TAG_ENCODING", NULL
   };
 
-  return gst_tag_freeform_string_to_utf8 (str, -1, env_vars);
+  return gst_tag_freeform_string_to_utf8 (str, len, env_vars);
 }
 
 /* takes ownership of tag list */
@@ -319,50 +319,51 @@ gst_icydemux_tag_found (GstICYDemux * icydemux, GstTagList * tags)
   return TRUE;
 }
 
+/* parses the fields of the metadata block in @data in place, only the
+ * values that end up in the tags are copied */
 static void
-gst_icydemux_parse_and_send_tags (GstICYDemux * icydemux)
+gst_icydemux_parse_and_send_tags (GstICYDemux * icydemux, const guint8 * data,
+    gsize length)
 {
   GstTagList *tags;
-  const guint8 *data;
-  int length, i;
-  gchar *buffer;
-  gchar **strings;
-
-  length = gst_adapter_available (icydemux->meta_adapter);
-
-  data = gst_adapter_map (icydemux->meta_adapter, length);
+  const gchar *str = (const gchar *) data;
+  const gchar *end, *field_end;
+  gint field_len;
 
-  /* Now, copy this to a buffer where we can NULL-terminate it to make things
-   * a bit easier, then do that parsing. */
-  buffer = g_strndup ((const gchar *) data, length);
+  /* the block is padded with zeroes */
+  end = memchr (str, '\0', length);
+  if (end == NULL)
+    end = str + length;
 
   tags = gst_tag_list_new_empty ();
-  strings = g_strsplit (buffer, "';", 0);
 
-  for (i = 0; strings[i]; i++) {
-    if (!g_ascii_strncasecmp (strings[i], "StreamTitle=", 12)) {
-      char *title = gst_icydemux_unicodify (strings[i] + 13);
+  /* fields look like Key='value'; */
+  while (str < end) {
+    field_end = g_strstr_len (str, end - str, "';");
+    if (field_end == NULL)
+      field_end = end;
+    field_len = field_end - str;
+
+    if (field_len > 13 && !g_ascii_strncasecmp (str, "StreamTitle=", 12)) {
+      char *title = gst_icydemux_unicodify (str + 13, field_len - 13);
 
       if (title && *title) {
         gst_tag_list_add (tags, GST_TAG_MERGE_REPLACE, GST_TAG_TITLE,
             title, NULL);
-        g_free (title);
       }
-    } else if (!g_ascii_strncasecmp (strings[i], "StreamUrl=", 10)) {
-      char *url = gst_icydemux_unicodify (strings[i] + 11);
+      g_free (title);
+    } else if (field_len > 11 && !g_ascii_strncasecmp (str, "StreamUrl=", 10)) {
+      char *url = gst_icydemux_unicodify (str + 11, field_len - 11);
 
       if (url && *url) {
         gst_tag_list_add (tags, GST_TAG_MERGE_REPLACE, GST_TAG_HOMEPAGE,
             url, NULL);
-        g_free (url);
       }
+      g_free (url);
     }
-  }
 
-  g_strfreev (strings);
-  g_free (buffer);
-  gst_adapter_unmap (icydemux->meta_adapter);
-  gst_adapter_flush (icydemux->meta_adapter, length);
+    str = field_end + 2;
+  }
 
   if (!gst_tag_list_is_empty (tags))
     gst_icydemux_tag_found (icydemux, tags);
@@ -370,67 +371,18 @@ gst_icydemux_parse_and_send_tags (GstICYDemux * icydemux)
     gst_tag_list_unref (tags);
 }
 
-static gboolean
-gst_icydemux_handle_event (GstPad * pad, GstObject * parent, GstEvent * event)
-{
-  GstICYDemux *icydemux = GST_ICYDEMUX (parent);
-  gboolean result;
-
-  switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_TAG:
-    {
-      GstTagList *tags;
-
-      gst_event_parse_tag (event, &tags);
-      result = gst_icydemux_tag_found (icydemux, gst_tag_list_copy (tags));
-      gst_event_unref (event);
-      return result;
-    }
-    case GST_EVENT_CAPS:
-    {
-      GstCaps *caps;
-
-      gst_event_parse_caps (event, &caps);
-      result = gst_icydemux_sink_setcaps (pad, caps);
-      gst_event_unref (event);
-      return result;
-    }
-    default:
-      break;
-  }
-
-  if (icydemux->typefinding) {
-    switch (GST_EVENT_TYPE (event)) {
-      case GST_EVENT_FLUSH_STOP:
-        g_list_foreach (icydemux->cached_events,
-            (GFunc) gst_mini_object_unref, NULL);
-        g_list_free (icydemux->cached_events);
-        icydemux->cached_events = NULL;
-
-        return gst_pad_event_default (pad, parent, event);
-      default:
-        if (!GST_EVENT_IS_STICKY (event))
-          icydemux->cached_events =
-              g_list_append (icydemux->cached_events, event);
-        return TRUE;
-    }
-  } else {
-    return gst_pad_event_default (pad, parent, event);
-  }
-}
-
+/* parses the metadata block collected in the adapter */
 static void
-gst_icydemux_send_cached_events (GstICYDemux * icydemux)
+gst_icydemux_parse_meta_adapter (GstICYDemux * icydemux)
 {
-  GList *l;
-
-  for (l = icydemux->cached_events; l != NULL; l = l->next) {
-    GstEvent *event = GST_EVENT (l->data);
+  const guint8 *data;
+  gsize length;
 
-    gst_pad_push_event (icydemux->srcpad, event);
-  }
-  g_list_free (icydemux->cached_events);
-  icydemux->cached_events = NULL;
+  length = gst_adapter_available (icydemux->meta_adapter);
+  data = gst_adapter_map (icydemux->meta_adapter, length);
+  gst_icydemux_parse_and_send_tags (icydemux, data, length);
+  gst_adapter_unmap (icydemux->meta_adapter);
+  gst_adapter_flush (icydemux->meta_adapter, length);
 }
 
 static GstFlowReturn
@@ -576,20 +528,35 @@ gst_icydemux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     } else if (icydemux->meta_remaining) {
       chunk = (size <= icydemux->meta_remaining) ?
           size : icydemux->meta_remaining;
-      sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL, offset, chunk);
-      gst_icydemux_add_meta (icydemux, sub);
+
+      if (chunk == icydemux->meta_remaining && (!icydemux->meta_adapter ||
+              gst_adapter_available (icydemux->meta_adapter) == 0)) {
+        GstMapInfo map;
+
+        /* the whole block is in this buffer, parse it from there */
+        GST_DEBUG_OBJECT (icydemux, "Got complete metadata, parsing for tags");
+        gst_buffer_map (buf, &map, GST_MAP_READ);
+        gst_icydemux_parse_and_send_tags (icydemux, map.data + offset, chunk);
+        gst_buffer_unmap (buf, &map);
+      } else {
+        sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, offset,
+            chunk);
+        gst_icydemux_add_meta (icydemux, sub);
+
+        if (chunk == icydemux->meta_remaining) {
+          /* Parse tags from meta_adapter, send off as tag messages */
+          GST_DEBUG_OBJECT (icydemux,
+              "No remaining metadata, parsing for tags");
+          gst_icydemux_parse_meta_adapter (icydemux);
+        }
+      }
 
       offset += chunk;
       icydemux->meta_remaining -= chunk;
       size -= chunk;
 
-      if (icydemux->meta_remaining == 0) {
-        /* Parse tags from meta_adapter, send off as tag messages */
-        GST_DEBUG_OBJECT (icydemux, "No remaining metadata, parsing for tags");
-        gst_icydemux_parse_and_send_tags (icydemux);
-
+      if (icydemux->meta_remaining == 0)
         icydemux->remaining = icydemux->meta_interval;
-      }
     } else {
       guint8 byte;
       /* We need to read a single byte (always safe at this point in the loop)
@@ -59,10 +59,12 @@
 enum
 {
   ARG_0,
-  ARG_PREFER_V1
+  ARG_PREFER_V1,
+  ARG_SKIP_IMAGES
 };
 
 #define DEFAULT_PREFER_V1  FALSE
+#define DEFAULT_SKIP_IMAGES FALSE
 
 GST_DEBUG_CATEGORY (id3demux_debug);
 #define GST_CAT_DEFAULT (id3demux_debug)
@@ -108,6 +110,20 @@ gst_id3demux_class_init (GstID3DemuxClass * klass)
           "and ID3v2 tags are present", DEFAULT_PREFER_V1,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstID3Demux:skip-images:
+   *
+   * Don't extract the attached pictures (APIC frames) from the ID3v2 tag,
+   * which avoids copying embedded cover art for applications that only
+   * need the text tags.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_SKIP_IMAGES,
+      g_param_spec_boolean ("skip-images", "Skip images",
+          "Don't extract attached pictures from ID3v2 tags",
+          DEFAULT_SKIP_IMAGES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&sink_factory));
 
@@ -128,6 +144,7 @@ static void
 gst_id3demux_init (GstID3Demux * id3demux)
 {
   id3demux->prefer_v1 = DEFAULT_PREFER_V1;
+  id3demux->skip_images = DEFAULT_SKIP_IMAGES;
 }
 
 static gboolean
@@ -173,13 +190,104 @@ gst_id3demux_add_container_format (GstTagList * tags)
   gst_caps_unref (sink_caps);
 }
 
+/* Make a copy of an ID3v2.3 or ID3v2.4 tag without its APIC frames, so the
+ * pictures are not parsed and copied into the tag list. Returns NULL for
+ * tag layouts that are not rewritten (unsynchronisation, extended header,
+ * footer, ID3v2.2). */
+static GstBuffer *
+gst_id3demux_strip_pictures (GstID3Demux * id3demux, GstBuffer * buffer)
+{
+  GstBuffer *stripped = NULL;
+  GstMapInfo map;
+  guint8 *data;
+  guint tag_size, pos, out_pos, size;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+
+  if (map.size < ID3V2_HDR_SIZE || (map.data[3] != 3 && map.data[3] != 4) ||
+      (map.data[5] & 0xd0) != 0)
+    goto done;
+
+  tag_size = gst_tag_get_id3v2_tag_size (buffer);
+  if (tag_size < ID3V2_HDR_SIZE || tag_size > map.size)
+    goto done;
+
+  data = g_malloc (tag_size);
+  memcpy (data, map.data, ID3V2_HDR_SIZE);
+  pos = out_pos = ID3V2_HDR_SIZE;
+
+  /* walk the frame headers until the padding */
+  while (pos + 10 <= tag_size && map.data[pos] != 0) {
+    const guint8 *frame = map.data + pos;
+    guint frame_size;
+
+    if (map.data[3] == 4)
+      frame_size = ((frame[4] & 0x7f) << 21) | ((frame[5] & 0x7f) << 14) |
+          ((frame[6] & 0x7f) << 7) | (frame[7] & 0x7f);
+    else
+      frame_size = GST_READ_UINT32_BE (frame + 4);
+
+    if (frame_size > tag_size - pos - 10) {
+      GST_DEBUG_OBJECT (id3demux, "frame size %u too big, not stripping",
+          frame_size);
+      g_free (data);
+      goto done;
+    }
+
+    if (memcmp (frame, "APIC", 4) != 0) {
+      memcpy (data + out_pos, frame, 10 + frame_size);
+      out_pos += 10 + frame_size;
+    } else {
+      GST_DEBUG_OBJECT (id3demux, "skipping %u bytes picture", frame_size);
+    }
+    pos += 10 + frame_size;
+  }
+
+  /* the syncsafe tag size excludes the header */
+  size = out_pos - ID3V2_HDR_SIZE;
+  data[6] = (size >> 21) & 0x7f;
+  data[7] = (size >> 14) & 0x7f;
+  data[8] = (size >> 7) & 0x7f;
+  data[9] = size & 0x7f;
+
+  stripped = gst_buffer_new_wrapped (data, out_pos);
+
+done:
+  gst_buffer_unmap (buffer, &map);
+  return stripped;
+}
+
 static GstTagDemuxResult
 gst_id3demux_parse_tag (GstTagDemux * demux, GstBuffer * buffer,
     gboolean start_tag, guint * tag_size, GstTagList ** tags)
 {
+  GstID3Demux *id3demux = GST_ID3DEMUX (demux);
+
   if (start_tag) {
+    gboolean skip_images;
+    GstBuffer *stripped = NULL;
+
+    GST_OBJECT_LOCK (id3demux);
+    skip_images = id3demux->skip_images;
+    GST_OBJECT_UNLOCK (id3demux);
+
     *tag_size = gst_tag_get_id3v2_tag_size (buffer);
-    *tags = gst_tag_list_from_id3v2_tag (buffer);
+
+    if (skip_images)
+      stripped = gst_id3demux_strip_pictures (id3demux, buffer);
+
+    if (stripped) {
+      *tags = gst_tag_list_from_id3v2_tag (stripped);
+      gst_buffer_unref (stripped);
+    } else {
+      *tags = gst_tag_list_from_id3v2_tag (buffer);
+    }
+
+    /* pictures from tags we did not rewrite */
+    if (skip_images && *tags != NULL) {
+      gst_tag_list_remove_tag (*tags, GST_TAG_IMAGE);
+      gst_tag_list_remove_tag (*tags, GST_TAG_PREVIEW_IMAGE);
+    }
 
     if (G_LIKELY (*tags != NULL)) {
       gst_id3demux_add_container_format (*tags);
@@ -245,6 +353,12 @@ gst_id3demux_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (id3demux);
       break;
     }
+    case ARG_SKIP_IMAGES:{
+      GST_OBJECT_LOCK (id3demux);
+      id3demux->skip_images = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (id3demux);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -265,6 +379,11 @@ gst_id3demux_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, id3demux->prefer_v1);
       GST_OBJECT_UNLOCK (id3demux);
       break;
+    case ARG_SKIP_IMAGES:
+      GST_OBJECT_LOCK (id3demux);
+      g_value_set_boolean (value, id3demux->skip_images);
+      GST_OBJECT_UNLOCK (id3demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -152,6 +152,7 @@ gst_image_freeze_reset (GstImageFreeze * self)
 
   g_mutex_lock (&self->lock);
   gst_buffer_replace (&self->buffer, NULL);
+  gst_buffer_replace (&self->output, NULL);
 
   gst_segment_init (&self->segment, GST_FORMAT_TIME);
   self->need_segment = TRUE;
@@ -688,7 +689,7 @@ static void
 gst_image_freeze_src_loop (GstPad * pad)
 {
   GstImageFreeze *self = GST_IMAGE_FREEZE (GST_PAD_PARENT (pad));
-  GstBuffer *buffer;
+  GstBuffer *source, *buffer;
   guint64 offset;
   GstClockTime timestamp, timestamp_end;
   guint64 cstart, cstop;
@@ -701,10 +702,20 @@ gst_image_freeze_src_loop (GstPad * pad)
     gst_pad_pause_task (self->srcpad);
     return;
   }
-  buffer = gst_buffer_ref (self->buffer);
-  buffer = gst_buffer_make_writable (buffer);
+  /* Output buffers only reference the memory of the stored frame, a
+   * writable mapping downstream will copy it. Once downstream released the
+   * last output buffer we reuse it and only update the metadata */
+  source = gst_buffer_ref (self->buffer);
+  buffer = self->output;
+  self->output = NULL;
   g_mutex_unlock (&self->lock);
 
+  if (buffer == NULL || !gst_buffer_is_writable (buffer)) {
+    if (buffer)
+      gst_buffer_unref (buffer);
+    buffer = gst_buffer_copy (source);
+  }
+
   if (self->need_segment) {
     GstEvent *e;
 
@@ -776,6 +787,12 @@ gst_image_freeze_src_loop (GstPad * pad)
     GST_BUFFER_DURATION (buffer) = cstop - cstart;
     GST_BUFFER_OFFSET (buffer) = offset;
     GST_BUFFER_OFFSET_END (buffer) = offset + 1;
+
+    g_mutex_lock (&self->lock);
+    if (self->buffer == source && self->output == NULL)
+      self->output = gst_buffer_ref (buffer);
+    g_mutex_unlock (&self->lock);
+
     ret = gst_pad_push (self->srcpad, buffer);
     GST_DEBUG_OBJECT (pad, "Pushing buffer resulted in %s",
         gst_flow_get_name (ret));
@@ -784,6 +801,7 @@ gst_image_freeze_src_loop (GstPad * pad)
   } else {
     gst_buffer_unref (buffer);
   }
+  gst_buffer_unref (source);
 
   if (eos) {
     if ((self->segment.flags & GST_SEEK_FLAG_SEGMENT)) {
@@ -49,6 +49,8 @@ struct _GstImageFreeze
 
   GMutex lock;
   GstBuffer *buffer;
+  /* last pushed buffer, reused once downstream is done with it */
+  GstBuffer *output;
   gint fps_n, fps_d;
 
   GstSegment segment;
@@ -114,6 +114,34 @@ deinterleave_24 (guint8 * out, guint8 * in, guint stride, guint nframes)
   }
 }
 
+/* deinterleaves @lanes neighbouring channels at once. The samples of the
+ * group are read as one run from every input frame, where the per-channel
+ * function walks over the whole block once for each of the channels. The
+ * lanes are 8 to 32 bytes of a frame, so a run never spans more than two
+ * cache lines */
+#define MAKE_GROUP_FUNC(type, lanes) \
+static void deinterleave_group_##type (guint##type **out, guint##type *in, \
+    guint offset, guint stride, guint nframes) \
+{ \
+  guint i, j; \
+  \
+  for (i = 0; i < nframes; i++) { \
+    for (j = 0; j < lanes; j++) \
+      out[j][offset + i] = in[j]; \
+    in += stride; \
+  } \
+}
+
+MAKE_GROUP_FUNC (8, 8);
+MAKE_GROUP_FUNC (16, 8);
+MAKE_GROUP_FUNC (32, 4);
+MAKE_GROUP_FUNC (64, 4);
+
+/* the frames are deinterleaved in blocks of about this size so that the
+ * part of the input that is read stays in the cache while all the channels
+ * are taken out of it */
+#define BLOCK_SIZE 16384
+
 #define gst_deinterleave_parent_class parent_class
 G_DEFINE_TYPE (GstDeinterleave, gst_deinterleave, GST_TYPE_ELEMENT);
 
@@ -332,18 +360,28 @@ gst_deinterleave_set_process_function (GstDeinterleave * self)
   switch (GST_AUDIO_INFO_WIDTH (&self->audio_info)) {
     case 8:
       self->func = (GstDeinterleaveFunc) deinterleave_8;
+      self->group_func = (GstDeinterleaveGroupFunc) deinterleave_group_8;
+      self->group_lanes = 8;
       break;
     case 16:
       self->func = (GstDeinterleaveFunc) deinterleave_16;
+      self->group_func = (GstDeinterleaveGroupFunc) deinterleave_group_16;
+      self->group_lanes = 8;
       break;
     case 24:
       self->func = (GstDeinterleaveFunc) deinterleave_24;
+      self->group_func = NULL;
+      self->group_lanes = 0;
       break;
     case 32:
       self->func = (GstDeinterleaveFunc) deinterleave_32;
+      self->group_func = (GstDeinterleaveGroupFunc) deinterleave_group_32;
+      self->group_lanes = 4;
       break;
     case 64:
       self->func = (GstDeinterleaveFunc) deinterleave_64;
+      self->group_func = (GstDeinterleaveGroupFunc) deinterleave_group_64;
+      self->group_lanes = 4;
       break;
     default:
       return FALSE;
@@ -680,12 +718,14 @@ gst_deinterleave_process (GstDeinterleave * self, GstBuffer * buf)
       gst_buffer_get_size (buf) / channels /
       (GST_AUDIO_INFO_WIDTH (&self->audio_info) / 8);
   guint bufsize = nframes * (GST_AUDIO_INFO_WIDTH (&self->audio_info) / 8);
-  guint i;
+  guint width = GST_AUDIO_INFO_WIDTH (&self->audio_info) / 8;
+  guint i, l, block, offset;
   GList *srcs;
-  GstBuffer **buffers_out = g_new0 (GstBuffer *, channels);
-  guint8 *in, *out;
+  GstBuffer **buffers_out;
+  GstMapInfo *write_infos;
+  guint8 **out;
   GstMapInfo read_info;
-  GList *pending_events, *l;
+  GList *pending_events, *p;
 
   /* Send any pending events to all src pads */
   GST_OBJECT_LOCK (self);
@@ -697,8 +737,8 @@ gst_deinterleave_process (GstDeinterleave * self, GstBuffer * buf)
     GstEvent *event;
 
     GST_DEBUG_OBJECT (self, "Sending pending events to all src pads");
-    for (l = pending_events; l; l = l->next) {
-      event = l->data;
+    for (p = pending_events; p; p = p->next) {
+      event = p->data;
       for (srcs = self->srcpads; srcs != NULL; srcs = srcs->next)
         gst_pad_push_event (GST_PAD (srcs->data), gst_event_ref (event));
       gst_event_unref (event);
@@ -706,6 +746,11 @@ gst_deinterleave_process (GstDeinterleave * self, GstBuffer * buf)
     g_list_free (pending_events);
   }
 
+  /* a mono stream is already deinterleaved, pass the buffer on as is */
+  if (channels == 1 && self->srcpads)
+    return gst_pad_push (GST_PAD (self->srcpads->data), buf);
+
+  buffers_out = g_new0 (GstBuffer *, channels);
   gst_buffer_map (buf, &read_info, GST_MAP_READ);
 
   /* Allocate buffers */
@@ -734,28 +779,49 @@ gst_deinterleave_process (GstDeinterleave * self, GstBuffer * buf)
     goto done;
   }
 
-  /* deinterleave */
+  /* deinterleave all the channels of a block of frames before moving on to
+   * the next one. Runs of channels are taken out together by the group
+   * function */
+  write_infos = g_new (GstMapInfo, channels);
+  out = g_new (guint8 *, channels);
+  for (i = 0; i < channels; i++) {
+    gst_buffer_map (buffers_out[i], &write_infos[i], GST_MAP_WRITE);
+    out[i] = write_infos[i].data;
+  }
+
+  block = MAX (BLOCK_SIZE / (width * channels), 16);
+  for (offset = 0; offset < nframes; offset += block) {
+    guint n = MIN (block, nframes - offset);
+    guint8 *in = read_info.data + offset * width * channels;
+
+    for (i = 0; i < channels; i += l) {
+      if (self->group_func && i + self->group_lanes <= channels) {
+        l = self->group_lanes;
+        self->group_func ((gpointer *) out + i, in + i * width, offset,
+            channels, n);
+      } else {
+        l = 1;
+        self->func (out[i] + offset * width, in + i * width, channels, n);
+      }
+    }
+  }
+
+  for (i = 0; i < channels; i++)
+    gst_buffer_unmap (buffers_out[i], &write_infos[i]);
+  g_free (write_infos);
+  g_free (out);
+
   for (srcs = self->srcpads, i = 0; srcs; srcs = srcs->next, i++) {
     GstPad *pad = (GstPad *) srcs->data;
-    GstMapInfo write_info;
 
-    in = (guint8 *) read_info.data;
-    in += i * (GST_AUDIO_INFO_WIDTH (&self->audio_info) / 8);
-    if (buffers_out[i]) {
-      gst_buffer_map (buffers_out[i], &write_info, GST_MAP_WRITE);
-      out = (guint8 *) write_info.data;
-      self->func (out, in, channels, nframes);
-      gst_buffer_unmap (buffers_out[i], &write_info);
-
-      ret = gst_pad_push (pad, buffers_out[i]);
-      buffers_out[i] = NULL;
-      if (ret == GST_FLOW_OK)
-        pads_pushed++;
-      else if (ret == GST_FLOW_NOT_LINKED)
-        ret = GST_FLOW_OK;
-      else
-        goto push_failed;
-    }
+    ret = gst_pad_push (pad, buffers_out[i]);
+    buffers_out[i] = NULL;
+    if (ret == GST_FLOW_OK)
+      pads_pushed++;
+    else if (ret == GST_FLOW_NOT_LINKED)
+      ret = GST_FLOW_OK;
+    else
+      goto push_failed;
   }
 
   /* Return NOT_LINKED if no pad was linked */
@@ -43,6 +43,7 @@ typedef struct _GstDeinterleave GstDeinterleave;
 typedef struct _GstDeinterleaveClass GstDeinterleaveClass;
 
 typedef void (*GstDeinterleaveFunc) (gpointer out, gpointer in, guint stride, guint nframes);
+typedef void (*GstDeinterleaveGroupFunc) (gpointer * out, gpointer in, guint offset, guint stride, guint nframes);
 
 struct _GstDeinterleave
 {
@@ -57,6 +58,8 @@ struct _GstDeinterleave
   GstPad *sink;
 
   GstDeinterleaveFunc func;
+  GstDeinterleaveGroupFunc group_func;
+  guint group_lanes;
 
   GList *pending_events;
 };
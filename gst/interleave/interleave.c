@@ -124,6 +124,34 @@ interleave_24 (guint8 * out, guint8 * in, guint stride, guint nframes)
   }
 }
 
+/* interleaves @lanes neighbouring channels at once. The samples of the
+ * group are written as one run into every output frame, where the
+ * per-channel function walks over the whole block once for each of the
+ * channels. The lanes are 8 to 32 bytes of a frame, so a run never spans
+ * more than two cache lines */
+#define MAKE_GROUP_FUNC(type, lanes) \
+static void interleave_group_##type (guint##type *out, guint##type **in, \
+    guint offset, guint stride, guint nframes) \
+{ \
+  guint i, j; \
+  \
+  for (i = 0; i < nframes; i++) { \
+    for (j = 0; j < lanes; j++) \
+      out[j] = in[j][offset + i]; \
+    out += stride; \
+  } \
+}
+
+MAKE_GROUP_FUNC (8, 8);
+MAKE_GROUP_FUNC (16, 8);
+MAKE_GROUP_FUNC (32, 4);
+MAKE_GROUP_FUNC (64, 4);
+
+/* the frames are interleaved in blocks of about this size so that the part
+ * of the output that is written stays in the cache while all the channels
+ * are filled in */
+#define BLOCK_SIZE 16384
+
 typedef struct
 {
   GstPad parent;
@@ -732,18 +760,28 @@ gst_interleave_set_process_function (GstInterleave * self)
   switch (self->width) {
     case 8:
       self->func = (GstInterleaveFunc) interleave_8;
+      self->group_func = (GstInterleaveGroupFunc) interleave_group_8;
+      self->group_lanes = 8;
       break;
     case 16:
       self->func = (GstInterleaveFunc) interleave_16;
+      self->group_func = (GstInterleaveGroupFunc) interleave_group_16;
+      self->group_lanes = 8;
       break;
     case 24:
       self->func = (GstInterleaveFunc) interleave_24;
+      self->group_func = NULL;
+      self->group_lanes = 0;
       break;
     case 32:
       self->func = (GstInterleaveFunc) interleave_32;
+      self->group_func = (GstInterleaveGroupFunc) interleave_group_32;
+      self->group_lanes = 4;
       break;
     case 64:
       self->func = (GstInterleaveFunc) interleave_64;
+      self->group_func = (GstInterleaveGroupFunc) interleave_group_64;
+      self->group_lanes = 4;
       break;
     default:
       g_assert_not_reached ();
@@ -1200,10 +1238,14 @@ gst_interleave_collected (GstCollectPads * pads, GstInterleave * self)
   GSList *collected;
   guint nsamples;
   guint ncollected = 0;
-  gboolean empty = TRUE;
+  gboolean empty = TRUE, missing = FALSE;
   gint width = self->width / 8;
   GstMapInfo write_info;
   GstClockTime timestamp = -1;
+  GstBuffer **inbufs;
+  GstMapInfo *inmaps;
+  guint8 **indata;
+  guint c, l, block, offset;
 
   size = gst_collect_pads_available (pads);
   if (size == 0)
@@ -1228,42 +1270,89 @@ gst_interleave_collected (GstCollectPads * pads, GstInterleave * self)
     return GST_FLOW_NOT_NEGOTIATED;
   }
 
-  gst_buffer_map (outbuf, &write_info, GST_MAP_WRITE);
-  memset (write_info.data, 0, size * self->channels);
+  /* the data of every channel or NULL if there is nothing to copy */
+  inbufs = g_new0 (GstBuffer *, self->channels);
+  inmaps = g_new (GstMapInfo, self->channels);
+  indata = g_new0 (guint8 *, self->channels);
 
   for (collected = pads->data; collected != NULL; collected = collected->next) {
     GstCollectData *cdata;
     GstBuffer *inbuf;
-    guint8 *outdata;
-    GstMapInfo input_info;
+    guint channel;
 
     cdata = (GstCollectData *) collected->data;
 
     inbuf = gst_collect_pads_take_buffer (pads, cdata, size);
     if (inbuf == NULL) {
       GST_DEBUG_OBJECT (cdata->pad, "No buffer available");
-      goto next;
+      continue;
     }
     ncollected++;
-    gst_buffer_map (inbuf, &input_info, GST_MAP_READ);
 
     if (timestamp == -1)
       timestamp = GST_BUFFER_TIMESTAMP (inbuf);
 
-    if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP))
-      goto next;
+    channel = GST_INTERLEAVE_PAD_CAST (cdata->pad)->channel;
+    if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP) ||
+        channel >= self->channels) {
+      gst_buffer_unref (inbuf);
+      continue;
+    }
+
+    gst_buffer_map (inbuf, &inmaps[channel], GST_MAP_READ);
+    inbufs[channel] = inbuf;
+    indata[channel] = inmaps[channel].data;
+  }
+
+  gst_buffer_map (outbuf, &write_info, GST_MAP_WRITE);
 
-    empty = FALSE;
-    outdata =
-        write_info.data + width * GST_INTERLEAVE_PAD_CAST (cdata->pad)->channel;
+  /* silence for the channels without data */
+  for (c = 0; c < self->channels; c++) {
+    if (indata[c])
+      empty = FALSE;
+    else
+      missing = TRUE;
+  }
+  if (missing)
+    memset (write_info.data, 0, size * self->channels);
+
+  /* fill in all the channels of a block of frames before moving on to the
+   * next one. Runs of channels that all have data are interleaved together
+   * by the group function */
+  block = MAX (BLOCK_SIZE / (width * self->channels), 16);
+  for (offset = 0; !empty && offset < nsamples; offset += block) {
+    guint nframes = MIN (block, nsamples - offset);
+    guint8 *outdata = write_info.data + offset * width * self->channels;
+
+    for (c = 0; c < self->channels;) {
+      l = 0;
+      if (self->group_func && c + self->group_lanes <= self->channels) {
+        while (l < self->group_lanes && indata[c + l])
+          l++;
+      }
 
-    self->func (outdata, input_info.data, self->channels, nsamples);
-    gst_buffer_unmap (inbuf, &input_info);
+      if (self->group_func && l == self->group_lanes) {
+        self->group_func (outdata + c * width, (gpointer *) indata + c,
+            offset, self->channels, nframes);
+        c += l;
+      } else {
+        if (indata[c])
+          self->func (outdata + c * width, indata[c] + offset * width,
+              self->channels, nframes);
+        c++;
+      }
+    }
+  }
 
-  next:
-    if (inbuf)
-      gst_buffer_unref (inbuf);
+  for (c = 0; c < self->channels; c++) {
+    if (inbufs[c]) {
+      gst_buffer_unmap (inbufs[c], &inmaps[c]);
+      gst_buffer_unref (inbufs[c]);
+    }
   }
+  g_free (inbufs);
+  g_free (inmaps);
+  g_free (indata);
 
   if (ncollected == 0) {
     gst_buffer_unmap (outbuf, &write_info);
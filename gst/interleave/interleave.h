@@ -43,6 +43,7 @@ typedef struct _GstInterleave GstInterleave;
 typedef struct _GstInterleaveClass GstInterleaveClass;
 
 typedef void (*GstInterleaveFunc) (gpointer out, gpointer in, guint stride, guint nframes);
+typedef void (*GstInterleaveGroupFunc) (gpointer out, gpointer * in, guint offset, guint stride, guint nframes);
 
 struct _GstInterleave
 {
@@ -71,6 +72,8 @@ struct _GstInterleave
   GstPadEventFunction collect_event;
 
   GstInterleaveFunc func;
+  GstInterleaveGroupFunc group_func;
+  guint group_lanes;
 
   GstPad *src;
 
@@ -532,6 +532,70 @@ atom_stsd_clear (AtomSTSD * stsd)
   atom_full_clear (&stsd->header);
 }
 
+static void
+atom_spill_init (AtomSpill * spill)
+{
+  spill->file = NULL;
+  spill->len = 0;
+}
+
+static void
+atom_spill_clear (AtomSpill * spill)
+{
+  if (spill->file)
+    fclose (spill->file);
+  atom_spill_init (spill);
+}
+
+/* appends @n entries of @entry_size bytes from @data to the temporary file of
+ * @spill */
+static gboolean
+atom_spill_write (AtomSpill * spill, gconstpointer data, guint n,
+    gsize entry_size)
+{
+  if (spill->file == NULL) {
+    spill->file = tmpfile ();
+    if (spill->file == NULL)
+      return FALSE;
+  }
+  /* the file might have been read back in the meantime */
+  if (fseek (spill->file, 0, SEEK_END) != 0)
+    return FALSE;
+  if (fwrite (data, entry_size, n, spill->file) != n)
+    return FALSE;
+
+  spill->len += n;
+  return TRUE;
+}
+
+/* serializes the @n guint32 values stored in @spill */
+static gboolean
+atom_spill_copy_uint32 (AtomSpill * spill, guint64 n, guint8 ** buffer,
+    guint64 * size, guint64 * offset)
+{
+  guint32 values[1024];
+
+  if (!buffer || n == 0) {
+    *offset += n * sizeof (guint32);
+    return TRUE;
+  }
+
+  if (fseek (spill->file, 0, SEEK_SET) != 0)
+    return FALSE;
+
+  prop_copy_ensure_buffer (buffer, size, offset, n * sizeof (guint32));
+  while (n > 0) {
+    guint i, len = MIN (n, G_N_ELEMENTS (values));
+
+    if (fread (values, sizeof (guint32), len, spill->file) != len)
+      return FALSE;
+    for (i = 0; i < len; i++)
+      prop_copy_uint32 (values[i], buffer, size, offset);
+    n -= len;
+  }
+  return TRUE;
+}
+
 static void
 atom_ctts_init (AtomCTTS * ctts)
 {
@@ -539,6 +603,7 @@ atom_ctts_init (AtomCTTS * ctts)
 
   atom_full_init (&ctts->header, FOURCC_ctts, 0, 0, 0, flags);
   atom_array_init (&ctts->entries, 128);
+  atom_spill_init (&ctts->spill);
   ctts->do_pts = FALSE;
 }
 
@@ -556,6 +621,7 @@ atom_ctts_free (AtomCTTS * ctts)
 {
   atom_full_clear (&ctts->header);
   atom_array_clear (&ctts->entries);
+  atom_spill_clear (&ctts->spill);
   g_free (ctts);
 }
 
@@ -582,6 +648,7 @@ atom_stsz_init (AtomSTSZ * stsz)
 
   atom_full_init (&stsz->header, FOURCC_stsz, 0, 0, 0, flags);
   atom_array_init (&stsz->entries, 1024);
+  atom_spill_init (&stsz->spill);
   stsz->sample_size = 0;
   stsz->table_size = 0;
 }
@@ -591,6 +658,7 @@ atom_stsz_clear (AtomSTSZ * stsz)
 {
   atom_full_clear (&stsz->header);
   atom_array_clear (&stsz->entries);
+  atom_spill_clear (&stsz->spill);
   stsz->table_size = 0;
 }
 
@@ -617,6 +685,8 @@ atom_co64_init (AtomSTCO64 * co64)
 
   atom_full_init (&co64->header, FOURCC_stco, 0, 0, 0, flags);
   atom_array_init (&co64->entries, 256);
+  atom_spill_init (&co64->spill);
+  co64->spill_offset = 0;
 }
 
 static void
@@ -624,6 +694,8 @@ atom_stco64_clear (AtomSTCO64 * stco64)
 {
   atom_full_clear (&stco64->header);
   atom_array_clear (&stco64->entries);
+  atom_spill_clear (&stco64->spill);
+  stco64->spill_offset = 0;
 }
 
 static void
@@ -655,6 +727,7 @@ atom_stbl_init (AtomSTBL * stbl)
   stbl->ctts = NULL;
 
   atom_co64_init (&stbl->stco64);
+  stbl->spill_threshold = 0;
 }
 
 void
@@ -1812,7 +1885,11 @@ atom_stsz_copy_data (AtomSTSZ * stsz, guint8 ** buffer, guint64 * size,
     /* minimize realloc */
     prop_copy_ensure_buffer (buffer, size, offset, 4 * stsz->table_size);
     /* entry count must match sample count */
-    g_assert (atom_array_get_len (&stsz->entries) == stsz->table_size);
+    g_assert (stsz->spill.len + atom_array_get_len (&stsz->entries) ==
+        stsz->table_size);
+    if (!atom_spill_copy_uint32 (&stsz->spill, stsz->spill.len, buffer, size,
+            offset))
+      return 0;
     for (i = 0; i < atom_array_get_len (&stsz->entries); i++) {
       prop_copy_uint32 (atom_array_index (&stsz->entries, i), buffer, size,
           offset);
@@ -1862,10 +1939,15 @@ atom_ctts_copy_data (AtomCTTS * ctts, guint8 ** buffer, guint64 * size,
     return 0;
   }
 
-  prop_copy_uint32 (atom_array_get_len (&ctts->entries), buffer, size, offset);
+  prop_copy_uint32 (ctts->spill.len + atom_array_get_len (&ctts->entries),
+      buffer, size, offset);
   /* minimize realloc */
   prop_copy_ensure_buffer (buffer, size, offset,
       8 * atom_array_get_len (&ctts->entries));
+  /* count and offset of each entry are stored one after the other */
+  if (!atom_spill_copy_uint32 (&ctts->spill, 2 * ctts->spill.len, buffer, size,
+          offset))
+    return 0;
   for (i = 0; i < atom_array_get_len (&ctts->entries); i++) {
     CTTSEntry *entry = &atom_array_index (&ctts->entries, i);
 
@@ -1877,6 +1959,48 @@ atom_ctts_copy_data (AtomCTTS * ctts, guint8 ** buffer, guint64 * size,
   return *offset - original_offset;
 }
 
+static guint32
+atom_stco64_get_entry_count (AtomSTCO64 * stco64)
+{
+  return stco64->spill.len + atom_array_get_len (&stco64->entries);
+}
+
+/* serializes the chunk offsets that were moved to the spill file */
+static gboolean
+atom_stco64_copy_spill (AtomSTCO64 * stco64, gboolean trunc_to_32,
+    guint8 ** buffer, guint64 * size, guint64 * offset)
+{
+  AtomSpill *spill = &stco64->spill;
+  guint64 values[512];
+  guint64 n = spill->len;
+
+  if (!buffer || n == 0) {
+    *offset += n * (trunc_to_32 ? sizeof (guint32) : sizeof (guint64));
+    return TRUE;
+  }
+
+  if (fseek (spill->file, 0, SEEK_SET) != 0)
+    return FALSE;
+
+  while (n > 0) {
+    guint i, len = MIN (n, G_N_ELEMENTS (values));
+
+    if (fread (values, sizeof (guint64), len, spill->file) != len)
+      return FALSE;
+    for (i = 0; i < len; i++) {
+      guint64 value = values[i] + stco64->spill_offset;
+
+      if (trunc_to_32) {
+        prop_copy_uint32 ((guint32) value, buffer, size, offset);
+      } else {
+        prop_copy_uint64 (value, buffer, size, offset);
+      }
+    }
+    n -= len;
+  }
+  return TRUE;
+}
+
 guint64
 atom_stco64_copy_data (AtomSTCO64 * stco64, guint8 ** buffer, guint64 * size,
     guint64 * offset)
@@ -1889,12 +2013,14 @@ atom_stco64_copy_data (AtomSTCO64 * stco64, guint8 ** buffer, guint64 * size,
     return 0;
   }
 
-  prop_copy_uint32 (atom_array_get_len (&stco64->entries), buffer, size,
+  prop_copy_uint32 (atom_stco64_get_entry_count (stco64), buffer, size,
       offset);
 
   /* minimize realloc */
   prop_copy_ensure_buffer (buffer, size, offset,
       8 * atom_array_get_len (&stco64->entries));
+  if (!atom_stco64_copy_spill (stco64, trunc_to_32, buffer, size, offset))
+    return 0;
   for (i = 0; i < atom_array_get_len (&stco64->entries); i++) {
     guint64 *value = &atom_array_index (&stco64->entries, i);
 
@@ -2520,12 +2646,6 @@ atom_stsz_add_entry (AtomSTSZ * stsz, guint32 nsamples, guint32 size)
   }
 }
 
-static guint32
-atom_stco64_get_entry_count (AtomSTCO64 * stco64)
-{
-  return atom_array_get_len (&stco64->entries);
-}
-
 static void
 atom_stco64_add_entry (AtomSTCO64 * stco64, guint64 entry)
 {
@@ -2579,6 +2699,49 @@ atom_stbl_add_ctts_entry (AtomSTBL * stbl, guint32 nsamples, guint32 offset)
   atom_ctts_add_entry (stbl->ctts, nsamples, offset);
 }
 
+/* moves the stsz, stco and ctts entries that exceed the threshold to their
+ * spill files; the last ctts entry stays in memory as it may still grow */
+static void
+atom_stbl_spill (AtomSTBL * stbl)
+{
+  guint len;
+
+  len = atom_array_get_len (&stbl->stsz.entries);
+  if (len >= stbl->spill_threshold) {
+    if (!atom_spill_write (&stbl->stsz.spill, stbl->stsz.entries.data, len,
+            sizeof (guint32)))
+      goto spill_failed;
+    stbl->stsz.entries.len = 0;
+  }
+
+  len = atom_array_get_len (&stbl->stco64.entries);
+  if (len >= stbl->spill_threshold) {
+    if (!atom_spill_write (&stbl->stco64.spill, stbl->stco64.entries.data,
+            len, sizeof (guint64)))
+      goto spill_failed;
+    stbl->stco64.entries.len = 0;
+  }
+
+  len = stbl->ctts ? atom_array_get_len (&stbl->ctts->entries) : 0;
+  if (len > stbl->spill_threshold) {
+    AtomCTTS *ctts = stbl->ctts;
+
+    if (!atom_spill_write (&ctts->spill, ctts->entries.data, len - 1,
+            sizeof (CTTSEntry)))
+      goto spill_failed;
+    ctts->entries.data[0] = ctts->entries.data[len - 1];
+    ctts->entries.len = 1;
+  }
+  return;
+
+spill_failed:
+  {
+    /* keep everything in memory from now on */
+    GST_WARNING ("Failed to write sample table to temporary file");
+    stbl->spill_threshold = 0;
+  }
+}
+
 void
 atom_stbl_add_samples (AtomSTBL * stbl, guint32 nsamples, guint32 delta,
     guint32 size, guint64 chunk_offset, gboolean sync, gint64 pts_offset)
@@ -2592,6 +2755,9 @@ atom_stbl_add_samples (AtomSTBL * stbl, guint32 nsamples, guint32 delta,
     atom_stbl_add_stss_entry (stbl);
   /* always store to arrange for consistent content */
   atom_stbl_add_ctts_entry (stbl, nsamples, pts_offset);
+
+  if (stbl->spill_threshold)
+    atom_stbl_spill (stbl);
 }
 
 void
@@ -2611,6 +2777,12 @@ atom_trak_get_timescale (AtomTRAK * trak)
   return trak->mdia.mdhd.time_info.timescale;
 }
 
+void
+atom_trak_set_spill_threshold (AtomTRAK * trak, guint32 entries)
+{
+  trak->mdia.minf.stbl.spill_threshold = entries;
+}
+
 guint32
 atom_trak_get_id (AtomTRAK * trak)
 {
@@ -2736,6 +2908,7 @@ atom_stco64_chunks_add_offset (AtomSTCO64 * stco64, guint32 offset)
 
     *value += offset;
   }
+  stco64->spill_offset += offset;
 }
 
 void
@@ -3447,7 +3620,24 @@ atom_mfhd_copy_data (AtomMFHD * mfhd, guint8 ** buffer, guint64 * size,
   return *offset - original_offset;
 }
 
-static guint64
+static static guint64
+atom_tfdt_copy_data (AtomTFDT * tfdt, guint8 ** buffer, guint64 * size,
+    guint64 * offset)
+{
+  guint64 original_offset = *offset;
+
+  if (!atom_full_copy_data (&tfdt->header, buffer, size, offset)) {
+    return 0;
+  }
+
+  /* version 1 carries a 64-bit decode time */
+  prop_copy_uint64 (tfdt->base_media_decode_time, buffer, size, offset);
+
+  atom_write_size (buffer, size, offset, original_offset);
+  return *offset - original_offset;
+}
+
+guint64
 atom_tfhd_copy_data (AtomTFHD * tfhd, guint8 ** buffer, guint64 * size,
     guint64 * offset)
 {
@@ -3558,6 +3748,9 @@ atom_traf_copy_data (AtomTRAF * traf, guint8 ** buffer, guint64 * size,
   if (!atom_tfhd_copy_data (&traf->tfhd, buffer, size, offset)) {
     return 0;
   }
+  if (!atom_tfdt_copy_data (&traf->tfdt, buffer, size, offset)) {
+    return 0;
+  }
 
   walker = g_list_first (traf->truns);
   while (walker != NULL) {
@@ -3607,7 +3800,7 @@ atom_moof_copy_data (AtomMOOF * moof, guint8 ** buffer,
 
   atom_write_size (buffer, size, offset, original_offset);
 
-  if (*buffer && data_offset) {
+  if (buffer && *buffer && data_offset) {
     /* first trun needs a data-offset relative to moof start
      *   = moof size + mdat prefix */
     GST_WRITE_UINT32_BE (*buffer + data_offset, *offset - original_offset + 8);
@@ -3630,6 +3823,15 @@ atom_tfhd_init (AtomTFHD * tfhd, guint32 track_ID)
   tfhd->default_sample_flags = 0;
 }
 
+static void
+atom_tfdt_init (AtomTFDT * tfdt)
+{
+  guint8 flags[3] = { 0, 0, 0 };
+
+  atom_full_init (&tfdt->header, FOURCC_tfdt, 0, 0, 1, flags);
+  tfdt->base_media_decode_time = 0;
+}
+
 static void
 atom_trun_init (AtomTRUN * trun)
 {
@@ -3705,6 +3907,7 @@ atom_traf_init (AtomTRAF * traf, AtomsContext * context, guint32 track_ID)
 {
   atom_header_set (&traf->header, FOURCC_traf, 0, 0);
   atom_tfhd_init (&traf->tfhd, track_ID);
+  atom_tfdt_init (&traf->tfdt);
   traf->truns = NULL;
 
   if (context->flavor == ATOMS_TREE_FLAVOR_ISML)
@@ -3780,6 +3983,12 @@ atom_traf_add_samples (AtomTRAF * traf, guint32 delta, guint32 size,
     atom_sdtp_add_samples (traf->sdtps->data, 0x10 | ((flags & 0xff) >> 4));
 }
 
+void
+atom_traf_set_base_decode_time (AtomTRAF * traf, guint64 base_decode_time)
+{
+  traf->tfdt.base_media_decode_time = base_decode_time;
+}
+
 guint32
 atom_traf_get_sample_num (AtomTRAF * traf)
 {
@@ -44,6 +44,7 @@
 #define __ATOMS_H__
 
 #include <glib.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "descriptors.h"
@@ -72,7 +73,7 @@ G_STMT_START {                                                                \
   g_assert ((array)->data);                                                   \
   g_assert (inc > 0);                                                         \
   if (G_UNLIKELY ((array)->len == (array)->size)) {                           \
-    (array)->size += inc;                                                     \
+    (array)->size += MAX (inc, (array)->size / 2);                            \
     (array)->data =                                                           \
         g_realloc ((array)->data, sizeof (*((array)->data)) * (array)->size); \
   }                                                                           \
@@ -90,6 +91,14 @@ G_STMT_START {                                                                \
   (array)->data = NULL;                                                       \
 } G_STMT_END
 
+/* entries of a sample table that were moved out of memory to a temporary
+ * file, in their native layout, see atom_trak_set_spill_threshold() */
+typedef struct _AtomSpill
+{
+  FILE *file;
+  guint64 len;                  /* number of entries in the file */
+} AtomSpill;
+
 /* light-weight context that may influence header atom tree construction */
 typedef enum _AtomsTreeFlavor
 {
@@ -440,6 +449,7 @@ typedef struct _AtomSTSZ
    * the list is empty */
   guint32 table_size;
   ATOM_ARRAY (guint32) entries;
+  AtomSpill spill;              /* entries preceding the ones in memory */
 } AtomSTSZ;
 
 typedef struct _STSCEntry
@@ -466,6 +476,8 @@ typedef struct _AtomSTCO64
   AtomFull header;
 
   ATOM_ARRAY (guint64) entries;
+  AtomSpill spill;              /* entries preceding the ones in memory */
+  guint64 spill_offset;         /* still to be added to the spilled entries */
 } AtomSTCO64;
 
 typedef struct _CTTSEntry
@@ -480,6 +492,7 @@ typedef struct _AtomCTTS
 
   /* also entry count here */
   ATOM_ARRAY (CTTSEntry) entries;
+  AtomSpill spill;              /* entries preceding the ones in memory */
   gboolean do_pts;
 } AtomCTTS;
 
@@ -496,6 +509,9 @@ typedef struct _AtomSTBL
   AtomCTTS *ctts;
 
   AtomSTCO64 stco64;
+
+  /* max. number of stsz/stco/ctts entries kept in memory, 0 for no limit */
+  guint32 spill_threshold;
 } AtomSTBL;
 
 typedef struct _AtomMINF
@@ -666,6 +682,13 @@ typedef struct _AtomTFHD
   guint32 default_sample_flags;
 } AtomTFHD;
 
+typedef struct _AtomTFDT
+{
+  AtomFull header;
+
+  guint64 base_media_decode_time;
+} AtomTFDT;
+
 typedef struct _TRUNSampleEntry
 {
   guint32 sample_duration;
@@ -702,6 +725,7 @@ typedef struct _AtomTRAF
   Atom header;
 
   AtomTFHD tfhd;
+  AtomTFDT tfdt;
 
   /* list of AtomTRUN */
   GList *truns;
@@ -812,6 +836,7 @@ void       atom_trak_add_samples       (AtomTRAK * trak, guint32 nsamples, guint
 void       atom_trak_add_elst_entry    (AtomTRAK * trak, guint32 duration,
                                         guint32 media_time, guint32 rate);
 guint32    atom_trak_get_timescale     (AtomTRAK *trak);
+void       atom_trak_set_spill_threshold (AtomTRAK * trak, guint32 entries);
 guint32    atom_trak_get_id            (AtomTRAK * trak);
 void       atom_stbl_add_samples       (AtomSTBL * stbl, guint32 nsamples,
                                         guint32 delta, guint32 size,
@@ -855,6 +880,7 @@ void       atom_traf_add_samples       (AtomTRAF * traf, guint32 delta,
                                         guint32 size, gboolean sync, gint64 pts_offset,
                                         gboolean sdtp_sync);
 guint32    atom_traf_get_sample_num    (AtomTRAF * traf);
+void       atom_traf_set_base_decode_time (AtomTRAF * traf, guint64 base_decode_time);
 void       atom_moof_add_traf          (AtomMOOF *moof, AtomTRAF *traf);
 
 AtomMFRA*  atom_mfra_new               (AtomsContext *context);
@@ -726,16 +726,12 @@ moov_recov_file_free (MoovRecovFile * moovrf)
   g_free (moovrf);
 }
 
-static gboolean
-moov_recov_parse_buffer_entry (MoovRecovFile * moovrf, TrakBufferEntryInfo * b)
-{
-  guint8 data[TRAK_BUFFER_ENTRY_INFO_SIZE];
-  gint read;
-
-  read = fread (data, 1, TRAK_BUFFER_ENTRY_INFO_SIZE, moovrf->file);
-  if (read != TRAK_BUFFER_ENTRY_INFO_SIZE)
-    return FALSE;
+/* number of buffer entries that are read from the file at once */
+#define TRAK_BUFFER_ENTRIES_READ 1024
 
+static void
+moov_recov_parse_buffer_entry (const guint8 * data, TrakBufferEntryInfo * b)
+{
   b->track_id = GST_READ_UINT32_BE (data);
   b->nsamples = GST_READ_UINT32_BE (data + 4);
   b->delta = GST_READ_UINT32_BE (data + 8);
@@ -744,7 +740,6 @@ moov_recov_parse_buffer_entry (MoovRecovFile * moovrf, TrakBufferEntryInfo * b)
   b->sync = data[24] != 0;
   b->do_pts = data[25] != 0;
   b->pts_offset = GST_READ_UINT64_BE (data + 26);
-  return TRUE;
 }
 
 static gboolean
@@ -789,21 +784,36 @@ moov_recov_parse_buffers (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
 {
   TrakBufferEntryInfo entry;
   TrakRecovData *trak;
+  guint8 *data;
+  gsize i, n;
+
+  data = g_malloc (TRAK_BUFFER_ENTRY_INFO_SIZE * TRAK_BUFFER_ENTRIES_READ);
 
   /* we assume both moovrf and mdatrf are at the starting points of their
-   * data reading */
-  while (moov_recov_parse_buffer_entry (moovrf, &entry)) {
-    /* be sure we still have this data in mdat */
-    trak = moov_recov_get_trak (moovrf, entry.track_id);
-    if (trak == NULL) {
-      g_set_error (err, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_PARSING,
-          "Invalid trak id found in buffer entry");
-      return FALSE;
+   * data reading. The entries are read in blocks, a partly written entry at
+   * the end of the file is left out */
+  while ((n = fread (data, TRAK_BUFFER_ENTRY_INFO_SIZE,
+              TRAK_BUFFER_ENTRIES_READ, moovrf->file)) > 0) {
+    for (i = 0; i < n; i++) {
+      moov_recov_parse_buffer_entry (data + i * TRAK_BUFFER_ENTRY_INFO_SIZE,
+          &entry);
+
+      /* be sure we still have this data in mdat */
+      trak = moov_recov_get_trak (moovrf, entry.track_id);
+      if (trak == NULL) {
+        g_set_error (err, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_PARSING,
+            "Invalid trak id found in buffer entry");
+        g_free (data);
+        return FALSE;
+      }
+      if (!mdat_recov_add_sample (mdatrf, entry.size))
+        goto done;
+      trak_recov_data_add_sample (trak, &entry);
     }
-    if (!mdat_recov_add_sample (mdatrf, entry.size))
-      break;
-    trak_recov_data_add_sample (trak, &entry);
   }
+
+done:
+  g_free (data);
   return TRUE;
 }
 
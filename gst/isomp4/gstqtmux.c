@@ -184,11 +184,23 @@ enum
   PROP_DTS_METHOD,
 #endif
   PROP_DO_CTTS,
+  PROP_MAX_TABLE_ENTRIES,
+  PROP_RESERVED_MAX_DURATION,
+  PROP_RESERVED_BYTES_PER_SEC,
+  PROP_CHUNK_DURATION,
+  PROP_MOOV_RECOV_FLUSH_INTERVAL,
 };
 
 /* some spare for header size as well */
 #define MDAT_LARGE_FILE_LIMIT           ((guint64) 1024 * 1024 * 1024 * 2)
 
+/* room for the parts of a reserved moov that don't grow with the duration,
+ * such as track headers, sample descriptions and tags */
+#define RESERVED_MOOV_BASE_SIZE         (16 * 1024)
+
+/* size of the reads when moving the faststart temporary file downstream */
+#define FAST_START_COPY_SIZE            (1024 * 1024)
+
 #define DEFAULT_MOVIE_TIMESCALE         1000
 #define DEFAULT_TRAK_TIMESCALE          0
 #define DEFAULT_DO_CTTS                 TRUE
@@ -197,6 +209,15 @@ enum
 #define DEFAULT_MOOV_RECOV_FILE         NULL
 #define DEFAULT_FRAGMENT_DURATION       0
 #define DEFAULT_STREAMABLE              TRUE
+#define DEFAULT_MAX_TABLE_ENTRIES       0
+#define DEFAULT_RESERVED_MAX_DURATION   GST_CLOCK_TIME_NONE
+#define DEFAULT_RESERVED_BYTES_PER_SEC  550
+#define DEFAULT_CHUNK_DURATION          0
+#define DEFAULT_MOOV_RECOV_FLUSH_INTERVAL 1000
+
+/* the recovery file gets a small entry per buffer, these are collected in a
+ * buffer of this size before they are written */
+#define MOOV_RECOV_BUFFER_SIZE          (64 * 1024)
 #ifndef GST_REMOVE_DEPRECATED
 #define DEFAULT_DTS_METHOD              DTS_METHOD_REORDER
 #endif
@@ -353,6 +374,92 @@ gst_qt_mux_class_init (GstQTMuxClass * klass)
       g_param_spec_boolean ("streamable", "Streamable", streamable_desc,
           streamable,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstQTMux:max-table-entries
+   *
+   * Maximum number of sample size, chunk offset and composition offset
+   * entries kept in memory per stream. Older entries are moved to a
+   * temporary file and read back when the moov atom is written, which
+   * bounds the memory used for long recordings. 0 means no limit.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_TABLE_ENTRIES,
+      g_param_spec_uint ("max-table-entries", "Max table entries",
+          "Maximum number of sample table entries kept in memory per stream, "
+          "the rest is stored in a temporary file (0 = unlimited)",
+          0, G_MAXUINT32, DEFAULT_MAX_TABLE_ENTRIES,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstQTMux:reserved-max-duration
+   *
+   * When set, space for the moov atom is reserved at the start of the file,
+   * sized for a recording of up to this duration. At the end the moov atom
+   * is written into that space, which gives a file with the headers up
+   * front without rewriting the media data as #GstQTMux:faststart does.
+   * If the moov atom does not fit, it is written at the end of the file as
+   * usual. Requires seekable downstream.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_RESERVED_MAX_DURATION,
+      g_param_spec_uint64 ("reserved-max-duration",
+          "Reserved maximum file duration (ns)",
+          "When set, reserve space for the moov atom at the start of the file "
+          "for recordings up to this duration (GST_CLOCK_TIME_NONE = disabled)",
+          0, G_MAXUINT64, DEFAULT_RESERVED_MAX_DURATION,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstQTMux:reserved-bytes-per-sec
+   *
+   * Estimate of the moov atom bytes needed per second of media and per
+   * stream, used together with #GstQTMux:reserved-max-duration to size the
+   * reserved space.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_RESERVED_BYTES_PER_SEC,
+      g_param_spec_uint ("reserved-bytes-per-sec",
+          "Reserved moov bytes per second, per stream",
+          "Multiplier for converting reserved-max-duration into bytes of "
+          "moov space to reserve, per stream",
+          0, 10000, DEFAULT_RESERVED_BYTES_PER_SEC,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstQTMux:chunk-duration
+   *
+   * When producing a fragmented file, split each fragment into chunks of
+   * this duration, each written out as its own moof/mdat pair, so that data
+   * leaves the muxer before the fragment is complete. A value smaller than
+   * the sample duration gives one chunk per sample.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CHUNK_DURATION,
+      g_param_spec_uint ("chunk-duration", "Chunk duration",
+          "Chunk durations in ms within a fragment, for low latency output "
+          "(0 = one chunk per fragment)",
+          0, G_MAXUINT32, DEFAULT_CHUNK_DURATION,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstQTMux:moov-recovery-flush-interval
+   *
+   * The sample entries of #GstQTMux:moov-recovery-file are buffered and
+   * written out at most this often, bounding what a crash loses from the
+   * recovery file. Entries are fixed size records that are only appended,
+   * a partly written last entry is ignored on recovery. 0 only writes the
+   * entries when the buffer is full.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_MOOV_RECOV_FLUSH_INTERVAL,
+      g_param_spec_uint ("moov-recovery-flush-interval",
+          "Moov recovery flush interval",
+          "Interval in ms to write out the buffered entries of the moov "
+          "recovery file (0 = when the buffer is full)",
+          0, G_MAXUINT32, DEFAULT_MOOV_RECOV_FLUSH_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_qt_mux_request_new_pad);
@@ -390,11 +497,72 @@ gst_qt_mux_pad_reset (GstQTPad * qtpad)
     qtpad->traf = NULL;
   }
   atom_array_clear (&qtpad->fragment_buffers);
+  qtpad->fragment_start = TRUE;
+  qtpad->fragment_decode_time = 0;
 
   /* reference owned elsewhere */
   qtpad->tfra = NULL;
 }
 
+static void
+gst_qt_mux_clear_header_pool (GstQTMux * qtmux)
+{
+  if (qtmux->header_pool) {
+    /* buffers still downstream keep the pool alive until they are freed */
+    gst_buffer_pool_set_active (qtmux->header_pool, FALSE);
+    gst_object_unref (qtmux->header_pool);
+    qtmux->header_pool = NULL;
+  }
+  qtmux->header_pool_size = 0;
+}
+
+/*
+ * Returns a buffer of @size bytes to serialize fragment headers into.
+ * These are written for every fragment, so the buffers are recycled through a
+ * pool, which is replaced by a larger one when a header does not fit anymore.
+ */
+static GstBuffer *
+gst_qt_mux_acquire_header_buffer (GstQTMux * qtmux, guint size)
+{
+  GstBuffer *buf = NULL;
+
+  if (size > qtmux->header_pool_size)
+    gst_qt_mux_clear_header_pool (qtmux);
+
+  if (!qtmux->header_pool) {
+    GstBufferPool *pool;
+    GstStructure *config;
+    guint pool_size;
+
+    /* some headroom, fragment headers grow with the number of samples */
+    pool_size = size + size / 2;
+
+    pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, NULL, pool_size, 0, 0);
+    if (gst_buffer_pool_set_config (pool, config) &&
+        gst_buffer_pool_set_active (pool, TRUE)) {
+      GST_DEBUG_OBJECT (qtmux, "new header pool of size %u", pool_size);
+      qtmux->header_pool = pool;
+      qtmux->header_pool_size = pool_size;
+    } else {
+      GST_WARNING_OBJECT (qtmux, "failed to configure header pool");
+      gst_object_unref (pool);
+    }
+  }
+
+  if (qtmux->header_pool &&
+      gst_buffer_pool_acquire_buffer (qtmux->header_pool, &buf,
+          NULL) == GST_FLOW_OK) {
+    /* might still have the size of its previous use */
+    gst_buffer_set_size (buf, size);
+  } else {
+    buf = gst_buffer_new_allocate (NULL, size, NULL);
+  }
+
+  return buf;
+}
+
 /*
  * Takes GstQTMux back to its initial state
  */
@@ -407,6 +575,8 @@ gst_qt_mux_reset (GstQTMux * qtmux, gboolean alloc)
   qtmux->header_size = 0;
   qtmux->mdat_size = 0;
   qtmux->mdat_pos = 0;
+  qtmux->moov_pos = 0;
+  qtmux->reserved_moov_size = 0;
   qtmux->longest_chunk = GST_CLOCK_TIME_NONE;
   qtmux->video_pads = 0;
   qtmux->audio_pads = 0;
@@ -424,6 +594,7 @@ gst_qt_mux_reset (GstQTMux * qtmux, gboolean alloc)
     atom_mfra_free (qtmux->mfra);
     qtmux->mfra = NULL;
   }
+  gst_qt_mux_clear_header_pool (qtmux);
   if (qtmux->fast_start_file) {
     fclose (qtmux->fast_start_file);
     g_remove (qtmux->fast_start_file_path);
@@ -1267,7 +1438,7 @@ gst_qt_mux_send_buffered_data (GstQTMux * qtmux, guint64 * offset)
    * (somehow optimize copy?) */
   GST_DEBUG_OBJECT (qtmux, "Sending buffered data");
   while (ret == GST_FLOW_OK) {
-    const int bufsize = 4096;
+    const int bufsize = FAST_START_COPY_SIZE;
     GstMapInfo map;
     gsize size;
 
@@ -1410,6 +1581,28 @@ gst_qt_mux_update_mdat_size (GstQTMux * qtmux, guint64 mdat_pos,
   return gst_qt_mux_send_buffer (qtmux, buf, offset, FALSE);
 }
 
+/*
+ * Sends a free atom of @size bytes (header included), used as placeholder
+ * for the space reserved for the moov atom
+ */
+static GstFlowReturn
+gst_qt_mux_send_free_atom (GstQTMux * qtmux, guint64 * off, guint32 size)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  GST_DEBUG_OBJECT (qtmux, "Sending free atom of size %u", size);
+
+  buf = gst_buffer_new_and_alloc (size);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, size);
+  GST_WRITE_UINT32_BE (map.data, size);
+  GST_WRITE_UINT32_LE (map.data + 4, FOURCC_free);
+  gst_buffer_unmap (buf, &map);
+
+  return gst_qt_mux_send_buffer (qtmux, buf, off, FALSE);
+}
+
 static GstFlowReturn
 gst_qt_mux_send_ftyp (GstQTMux * qtmux, guint64 * off)
 {
@@ -1547,9 +1740,16 @@ gst_qt_mux_send_moov (GstQTMux * qtmux, guint64 * _offset, gboolean mind_fast)
   GstBuffer *buf;
   GstFlowReturn ret = GST_FLOW_OK;
 
-  /* serialize moov */
+  /* calculate the size first, so the moov is serialized into a single
+   * allocation rather than being grown while copying */
   offset = size = 0;
-  data = NULL;
+  if (!atom_moov_copy_data (qtmux->moov, NULL, &size, &offset))
+    goto serialize_error;
+
+  /* serialize moov */
+  size = offset;
+  offset = 0;
+  data = g_malloc (size);
   GST_LOG_OBJECT (qtmux, "Copying movie header into buffer");
   if (!atom_moov_copy_data (qtmux->moov, &data, &size, &offset))
     goto serialize_error;
@@ -1673,6 +1873,16 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
   gst_segment_init (&segment, GST_FORMAT_BYTES);
   gst_pad_push_event (qtmux->srcpad, gst_event_new_segment (&segment));
 
+  if (qtmux->max_table_entries) {
+    GSList *walk;
+
+    for (walk = qtmux->sinkpads; walk; walk = g_slist_next (walk)) {
+      GstQTPad *qpad = (GstQTPad *) walk->data;
+
+      atom_trak_set_spill_threshold (qpad->trak, qtmux->max_table_entries);
+    }
+  }
+
   /* initialize our moov recovery file */
   GST_OBJECT_LOCK (qtmux);
   if (qtmux->moov_recov_file_path) {
@@ -1688,6 +1898,8 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
       AtomFTYP *ftyp = NULL;
       GstBuffer *prefix = NULL;
 
+      setvbuf (qtmux->moov_recov_file, NULL, _IOFBF, MOOV_RECOV_BUFFER_SIZE);
+
       gst_qt_mux_prepare_ftyp (qtmux, &ftyp, &prefix);
 
       if (!atoms_recov_write_headers (qtmux->moov_recov_file, ftyp, prefix,
@@ -1718,6 +1930,10 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
         qtmux->moov_recov_file = NULL;
         GST_WARNING_OBJECT (qtmux, "An error was detected while writing to "
             "recover file, moov recovery won't work");
+      } else {
+        /* the headers are needed for any recovery, write them out now */
+        fflush (qtmux->moov_recov_file);
+        qtmux->moov_recov_last_flush = g_get_monotonic_time ();
       }
     }
   }
@@ -1770,6 +1986,25 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
       if (!qtmux->streamable)
         qtmux->mfra = atom_mfra_new (qtmux->context);
     } else {
+      if (GST_CLOCK_TIME_IS_VALID (qtmux->reserved_max_duration) &&
+          !qtmux->streamable) {
+        guint64 reserved;
+
+        reserved = gst_util_uint64_scale (qtmux->reserved_max_duration,
+            (guint64) qtmux->reserved_bytes_per_sec *
+            g_slist_length (qtmux->sinkpads), GST_SECOND);
+        reserved = MIN (reserved + RESERVED_MOOV_BASE_SIZE, G_MAXUINT32);
+        GST_DEBUG_OBJECT (qtmux, "reserving %" G_GUINT64_FORMAT " bytes for "
+            "moov atom", reserved);
+
+        qtmux->reserved_moov_size = reserved;
+        qtmux->moov_pos = qtmux->header_size;
+        ret = gst_qt_mux_send_free_atom (qtmux, &qtmux->header_size,
+            qtmux->reserved_moov_size);
+        if (ret != GST_FLOW_OK)
+          goto exit;
+        qtmux->mdat_pos = qtmux->header_size;
+      }
       /* extended to ensure some spare space */
       ret = gst_qt_mux_send_mdat_header (qtmux, &qtmux->header_size, 0, TRUE);
     }
@@ -1961,6 +2196,50 @@ gst_qt_mux_stop_file (GstQTMux * qtmux)
   }
   atom_moov_chunks_add_offset (qtmux->moov, offset);
 
+  if (qtmux->reserved_moov_size) {
+    GstSegment segment;
+    guint64 moov_size = 0;
+
+    size = 0;
+    if (!atom_moov_copy_data (qtmux->moov, NULL, &size, &moov_size))
+      goto serialize_error;
+    ret = gst_qt_mux_send_extra_atoms (qtmux, FALSE, &moov_size, FALSE);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
+    /* a leftover free atom needs at least its 8 bytes header */
+    if (moov_size == qtmux->reserved_moov_size ||
+        moov_size + 8 <= qtmux->reserved_moov_size) {
+      GST_DEBUG_OBJECT (qtmux, "moov of size %" G_GUINT64_FORMAT " fits in "
+          "reserved space of %u bytes", moov_size, qtmux->reserved_moov_size);
+
+      gst_segment_init (&segment, GST_FORMAT_BYTES);
+      segment.start = qtmux->moov_pos;
+      gst_pad_push_event (qtmux->srcpad, gst_event_new_segment (&segment));
+
+      ret = gst_qt_mux_send_moov (qtmux, NULL, FALSE);
+      if (ret != GST_FLOW_OK)
+        return ret;
+      ret = gst_qt_mux_send_extra_atoms (qtmux, TRUE, NULL, FALSE);
+      if (ret != GST_FLOW_OK)
+        return ret;
+      if (moov_size < qtmux->reserved_moov_size) {
+        ret = gst_qt_mux_send_free_atom (qtmux, NULL,
+            qtmux->reserved_moov_size - moov_size);
+        if (ret != GST_FLOW_OK)
+          return ret;
+      }
+
+      GST_DEBUG_OBJECT (qtmux, "updating mdat size");
+      return gst_qt_mux_update_mdat_size (qtmux, qtmux->mdat_pos,
+          qtmux->mdat_size, NULL);
+    }
+
+    GST_WARNING_OBJECT (qtmux, "moov of size %" G_GUINT64_FORMAT " does not "
+        "fit in reserved space of %u bytes, writing it at the end",
+        moov_size, qtmux->reserved_moov_size);
+  }
+
   /* moov */
   /* note: as of this point, we no longer care about tracking written data size,
    * since there is no more use for it anyway */
@@ -2014,6 +2293,7 @@ gst_qt_mux_pad_fragment_add_buffer (GstQTMux * qtmux, GstQTPad * pad,
     guint32 delta, guint32 size, gboolean sync, gint64 pts_offset)
 {
   GstFlowReturn ret = GST_FLOW_OK;
+  AtomMOOF *moof;
 
   /* setup if needed */
   if (G_UNLIKELY (!pad->traf || force))
@@ -2021,41 +2301,60 @@ gst_qt_mux_pad_fragment_add_buffer (GstQTMux * qtmux, GstQTPad * pad,
 
 flush:
   /* flush pad fragment if threshold reached,
-   * or at new keyframe if we should be minding those in the first place */
+   * or at new keyframe if we should be minding those in the first place;
+   * a chunk only ends the current moof/mdat pair, not the fragment */
   if (G_UNLIKELY (force || (sync && pad->sync) ||
-          pad->fragment_duration < (gint64) delta)) {
-    AtomMOOF *moof;
+          pad->fragment_duration < (gint64) delta ||
+          (qtmux->chunk_duration && pad->chunk_duration < (gint64) delta))) {
     guint64 size = 0, offset = 0;
     guint8 *data = NULL;
     GstBuffer *buffer;
+    GstMapInfo map;
     guint i, total_size;
 
+    pad->fragment_start = force || (sync && pad->sync) ||
+        pad->fragment_duration < (gint64) delta;
+
     /* now we know where moof ends up, update offset in tfra */
     if (pad->tfra)
       atom_tfra_update_offset (pad->tfra, qtmux->header_size);
 
+    /* size of the actual data */
+    total_size = 0;
+    for (i = 0; i < atom_array_get_len (&pad->fragment_buffers); i++) {
+      total_size +=
+          gst_buffer_get_size (atom_array_index (&pad->fragment_buffers, i));
+    }
+
     moof = atom_moof_new (qtmux->context, qtmux->fragment_sequence);
     /* takes ownership */
     atom_moof_add_traf (moof, pad->traf);
     pad->traf = NULL;
-    atom_moof_copy_data (moof, &data, &size, &offset);
-    buffer = _gst_buffer_new_take_data (data, offset);
-    GST_LOG_OBJECT (qtmux, "writing moof size %" G_GSIZE_FORMAT,
-        gst_buffer_get_size (buffer));
-    ret = gst_qt_mux_send_buffer (qtmux, buffer, &qtmux->header_size, FALSE);
 
-    /* and actual data */
-    total_size = 0;
-    for (i = 0; i < atom_array_get_len (&pad->fragment_buffers); i++) {
-      total_size +=
-          gst_buffer_get_size (atom_array_index (&pad->fragment_buffers, i));
+    /* serialize moof and mdat header into a single buffer of the exact size,
+     * this happens for every chunk so avoid growing it while copying */
+    if (!atom_moof_copy_data (moof, NULL, &size, &offset))
+      goto serialize_error;
+    buffer = gst_qt_mux_acquire_header_buffer (qtmux, offset + 8);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    data = map.data;
+    size = map.size;
+    offset = 0;
+    if (!atom_moof_copy_data (moof, &data, &size, &offset)) {
+      gst_buffer_unmap (buffer, &map);
+      gst_buffer_unref (buffer);
+      goto serialize_error;
     }
+    g_assert (data == map.data);
+    GST_WRITE_UINT32_BE (data + offset, total_size + 8);
+    GST_WRITE_UINT32_LE (data + offset + 4, FOURCC_mdat);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_set_size (buffer, offset + 8);
+    GST_LOG_OBJECT (qtmux, "writing moof size %" G_GUINT64_FORMAT, offset);
 
     GST_LOG_OBJECT (qtmux, "writing %d buffers, total_size %d",
         atom_array_get_len (&pad->fragment_buffers), total_size);
-    if (ret == GST_FLOW_OK)
-      ret = gst_qt_mux_send_mdat_header (qtmux, &qtmux->header_size, total_size,
-          FALSE);
+    ret = gst_qt_mux_send_buffer (qtmux, buffer, &qtmux->header_size, FALSE);
     for (i = 0; i < atom_array_get_len (&pad->fragment_buffers); i++) {
       if (G_LIKELY (ret == GST_FLOW_OK))
         ret = gst_qt_mux_send_buffer (qtmux,
@@ -2075,8 +2374,15 @@ init:
   if (G_UNLIKELY (!pad->traf)) {
     GST_LOG_OBJECT (qtmux, "setting up new fragment");
     pad->traf = atom_traf_new (qtmux->context, atom_trak_get_id (pad->trak));
+    atom_traf_set_base_decode_time (pad->traf, pad->fragment_decode_time);
     atom_array_init (&pad->fragment_buffers, 512);
-    pad->fragment_duration = gst_util_uint64_scale (qtmux->fragment_duration,
+    if (pad->fragment_start) {
+      pad->fragment_duration =
+          gst_util_uint64_scale (qtmux->fragment_duration,
+          atom_trak_get_timescale (pad->trak), 1000);
+      pad->fragment_start = FALSE;
+    }
+    pad->chunk_duration = gst_util_uint64_scale (qtmux->chunk_duration,
         atom_trak_get_timescale (pad->trak), 1000);
 
     if (G_UNLIKELY (qtmux->mfra && !pad->tfra)) {
@@ -2090,6 +2396,8 @@ init:
       pad->sync && sync);
   atom_array_append (&pad->fragment_buffers, buf, 256);
   pad->fragment_duration -= delta;
+  pad->chunk_duration -= delta;
+  pad->fragment_decode_time += delta;
 
   if (pad->tfra) {
     guint32 sn = atom_traf_get_sample_num (pad->traf);
@@ -2102,6 +2410,20 @@ init:
     goto flush;
 
   return ret;
+
+  /* ERRORS */
+serialize_error:
+  {
+    guint i;
+
+    for (i = 0; i < atom_array_get_len (&pad->fragment_buffers); i++)
+      gst_buffer_unref (atom_array_index (&pad->fragment_buffers, i));
+    atom_array_clear (&pad->fragment_buffers);
+    atom_moof_free (moof);
+    GST_ELEMENT_ERROR (qtmux, STREAM, MUX, (NULL),
+        ("Failed to serialize moof"));
+    return GST_FLOW_ERROR;
+  }
 }
 
 static void
@@ -2367,6 +2689,15 @@ gst_qt_mux_add_buffer (GstQTMux * qtmux, GstQTPad * pad, GstBuffer * buf)
           "recovery file, disabling recovery");
       fclose (qtmux->moov_recov_file);
       qtmux->moov_recov_file = NULL;
+    } else if (qtmux->moov_recov_flush_interval > 0) {
+      gint64 now = g_get_monotonic_time ();
+
+      if (now - qtmux->moov_recov_last_flush >=
+          (gint64) qtmux->moov_recov_flush_interval * 1000) {
+        GST_LOG_OBJECT (qtmux, "writing out recovery file entries");
+        fflush (qtmux->moov_recov_file);
+        qtmux->moov_recov_last_flush = now;
+      }
     }
   }
 
@@ -3358,9 +3689,24 @@ gst_qt_mux_get_property (GObject * object,
     case PROP_FRAGMENT_DURATION:
       g_value_set_uint (value, qtmux->fragment_duration);
       break;
+    case PROP_CHUNK_DURATION:
+      g_value_set_uint (value, qtmux->chunk_duration);
+      break;
+    case PROP_MOOV_RECOV_FLUSH_INTERVAL:
+      g_value_set_uint (value, qtmux->moov_recov_flush_interval);
+      break;
     case PROP_STREAMABLE:
       g_value_set_boolean (value, qtmux->streamable);
       break;
+    case PROP_MAX_TABLE_ENTRIES:
+      g_value_set_uint (value, qtmux->max_table_entries);
+      break;
+    case PROP_RESERVED_MAX_DURATION:
+      g_value_set_uint64 (value, qtmux->reserved_max_duration);
+      break;
+    case PROP_RESERVED_BYTES_PER_SEC:
+      g_value_set_uint (value, qtmux->reserved_bytes_per_sec);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3421,6 +3767,21 @@ gst_qt_mux_set_property (GObject * object,
     case PROP_FRAGMENT_DURATION:
       qtmux->fragment_duration = g_value_get_uint (value);
       break;
+    case PROP_CHUNK_DURATION:
+      qtmux->chunk_duration = g_value_get_uint (value);
+      break;
+    case PROP_MOOV_RECOV_FLUSH_INTERVAL:
+      qtmux->moov_recov_flush_interval = g_value_get_uint (value);
+      break;
+    case PROP_MAX_TABLE_ENTRIES:
+      qtmux->max_table_entries = g_value_get_uint (value);
+      break;
+    case PROP_RESERVED_MAX_DURATION:
+      qtmux->reserved_max_duration = g_value_get_uint64 (value);
+      break;
+    case PROP_RESERVED_BYTES_PER_SEC:
+      qtmux->reserved_bytes_per_sec = g_value_get_uint (value);
+      break;
     case PROP_STREAMABLE:{
       GstQTMuxClass *qtmux_klass =
           (GstQTMuxClass *) (G_OBJECT_GET_CLASS (qtmux));
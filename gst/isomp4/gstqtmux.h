@@ -121,6 +121,12 @@ struct _GstQTPad
   ATOM_ARRAY (GstBuffer *) fragment_buffers;
   /* running fragment duration */
   gint64 fragment_duration;
+  /* running chunk duration, a chunk being a moof/mdat pair within a fragment */
+  gint64 chunk_duration;
+  /* whether the next moof starts a new fragment */
+  gboolean fragment_start;
+  /* decode time of the next moof, for tfdt */
+  guint64 fragment_decode_time;
   /* optional fragment index book-keeping */
   AtomTFRA *tfra;
 
@@ -154,6 +160,9 @@ struct _GstQTMux
   guint64 mdat_size;
   /* position of mdat atom (for later updating) */
   guint64 mdat_pos;
+  /* position and size of the space reserved for the moov atom, if any */
+  guint64 moov_pos;
+  guint32 reserved_moov_size;
 
   /* keep track of the largest chunk to fine-tune brands */
   GstClockTime longest_chunk;
@@ -168,11 +177,16 @@ struct _GstQTMux
   /* fragmented file index */
   AtomMFRA *mfra;
 
+  /* recycled buffers for fragment headers */
+  GstBufferPool *header_pool;
+  guint header_pool_size;
+
   /* fast start */
   FILE *fast_start_file;
 
   /* moov recovery */
   FILE *moov_recov_file;
+  gint64 moov_recov_last_flush;
 
   /* fragment sequence */
   guint32 fragment_sequence;
@@ -188,8 +202,13 @@ struct _GstQTMux
 #endif
   gchar *fast_start_file_path;
   gchar *moov_recov_file_path;
+  guint moov_recov_flush_interval;
   guint32 fragment_duration;
+  guint32 chunk_duration;
   gboolean streamable;
+  guint32 max_table_entries;
+  GstClockTime reserved_max_duration;
+  guint reserved_bytes_per_sec;
 
   /* for request pad naming */
   guint video_pads, audio_pads;
@@ -51,6 +51,7 @@
 #include "gst/gst-i18n-plugin.h"
 
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
 #include <gst/tag/tag.h>
 #include <gst/audio/audio.h>
 #include <gst/video/video.h>
@@ -86,6 +87,31 @@
 /* if the sample index is larger than this, something is likely wrong */
 #define QTDEMUX_MAX_SAMPLE_INDEX_SIZE (50*1024*1024)
 
+/* number of samples expanded past a seek target so that nearby lookups can
+ * use the binary search on the already parsed range */
+#define QTDEMUX_EXPAND_CHUNK 1024
+
+/* max. number of threads building the sample tables of different streams */
+#define QTDEMUX_MAX_INDEX_THREADS 4
+
+/* header of the files in the sample index cache, followed by the samples and
+ * the durations if the stream has them; stored in native layout */
+#define QTDEMUX_INDEX_CACHE_MAGIC GST_MAKE_FOURCC ('q', 'd', 'i', '1')
+
+#define QTDEMUX_INDEX_CACHE_ALL_KEYFRAME     (1 << 0)
+#define QTDEMUX_INDEX_CACHE_DURATIONS        (1 << 1)
+#define QTDEMUX_INDEX_CACHE_OFFSETS_UNSORTED (1 << 2)
+
+typedef struct
+{
+  guint32 magic;
+  guint32 sample_size;          /* sizeof (QtDemuxSample) */
+  guint32 n_samples;
+  guint32 sample_duration;
+  guint32 flags;
+  guint32 padding;
+} QtDemuxIndexCacheHeader;
+
 /* For converting qt creation times to unix epoch times */
 #define QTDEMUX_SECONDS_PER_DAY (60 * 60 * 24)
 #define QTDEMUX_LEAP_YEARS_FROM_1904_TO_1970 17
@@ -107,14 +133,15 @@ typedef struct _QtDemuxSample QtDemuxSample;
   gint len;
 };*/
 
+/* the duration is not stored per sample, most tracks have a constant sample
+ * duration and only keep stream->sample_duration, see QTSAMPLE_DURATION */
 struct _QtDemuxSample
 {
   guint32 size;
   gint32 pts_offset;            /* Add this value to timestamp to get the pts */
   guint64 offset;
-  guint64 timestamp;            /* DTS In mov time */
-  guint32 duration;             /* In mov time */
-  gboolean keyframe;            /* TRUE when this packet is a keyframe */
+  guint64 timestamp:63;         /* DTS In mov time */
+  guint64 keyframe:1;           /* TRUE when this packet is a keyframe */
 };
 
 /* timestamp is the DTS */
@@ -123,9 +150,12 @@ struct _QtDemuxSample
 /* timestamp + offset is the PTS */
 #define QTSAMPLE_PTS(stream,sample) gst_util_uint64_scale ((sample)->timestamp + \
     (sample)->pts_offset, GST_SECOND, (stream)->timescale)
+/* duration in mov time, from the per-sample table if the track has one */
+#define QTSAMPLE_DURATION(stream,sample) ((stream)->durations ? \
+    (stream)->durations[(sample) - (stream)->samples] : (stream)->sample_duration)
 /* timestamp + duration - dts is the duration */
 #define QTSAMPLE_DUR_DTS(stream,sample,dts) (gst_util_uint64_scale ((sample)->timestamp + \
-    (sample)->duration, GST_SECOND, (stream)->timescale) - (dts));
+    QTSAMPLE_DURATION (stream, sample), GST_SECOND, (stream)->timescale) - (dts));
 
 #define QTSAMPLE_KEYFRAME(stream,sample) ((stream)->all_keyframe || (sample)->keyframe)
 
@@ -232,6 +262,11 @@ struct _QtDemuxStream
   /* our samples */
   guint32 n_samples;
   QtDemuxSample *samples;
+  guint32 n_samples_alloc;      /* allocated entries in samples */
+  guint32 *durations;           /* per-sample durations, NULL when constant */
+  guint32 sample_duration;      /* duration of all samples if durations is NULL */
+  gboolean offsets_unsorted;    /* TRUE when sample offsets are not increasing */
+  GMappedFile *index_cache;     /* holds samples/durations when loaded from cache */
   gboolean all_keyframe;        /* TRUE when all samples are keyframes (no stss) */
   guint32 min_duration;         /* duration in timescale of first sample, used for figuring out
                                    the framerate, in timescale units */
@@ -377,6 +412,14 @@ enum QtDemuxState
   QTDEMUX_STATE_BUFFER_MDAT     /* Buffering the mdat atom */
 };
 
+#define DEFAULT_INDEX_CACHE_DIR NULL
+
+enum
+{
+  PROP_0,
+  PROP_INDEX_CACHE_DIR
+};
+
 static GNode *qtdemux_tree_get_child_by_type (GNode * node, guint32 fourcc);
 static GNode *qtdemux_tree_get_child_by_type_full (GNode * node,
     guint32 fourcc, GstByteReader * parser);
@@ -414,6 +457,10 @@ GST_STATIC_PAD_TEMPLATE ("subtitle_%u",
 G_DEFINE_TYPE (GstQTDemux, gst_qtdemux, GST_TYPE_ELEMENT);
 
 static void gst_qtdemux_dispose (GObject * object);
+static void gst_qtdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_qtdemux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static guint32
 gst_qtdemux_find_index_linear (GstQTDemux * qtdemux, QtDemuxStream * str,
@@ -466,6 +513,8 @@ static GstCaps *qtdemux_generic_caps (GstQTDemux * qtdemux,
 
 static gboolean qtdemux_parse_samples (GstQTDemux * qtdemux,
     QtDemuxStream * stream, guint32 n);
+static gboolean qtdemux_parse_samples_unlocked (GstQTDemux * qtdemux,
+    QtDemuxStream * stream, guint32 n);
 static GstFlowReturn qtdemux_expose_streams (GstQTDemux * qtdemux);
 static void gst_qtdemux_stream_free (GstQTDemux * qtdemux,
     QtDemuxStream * stream);
@@ -487,6 +536,23 @@ gst_qtdemux_class_init (GstQTDemuxClass * klass)
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->dispose = gst_qtdemux_dispose;
+  gobject_class->set_property = gst_qtdemux_set_property;
+  gobject_class->get_property = gst_qtdemux_get_property;
+
+  /**
+   * GstQTDemux:index-cache-dir:
+   *
+   * Directory in which the expanded sample tables are cached, keyed by a
+   * hash of the moov atom. Opening the same non-fragmented file again then
+   * maps the cached tables instead of building them. %NULL disables the
+   * cache.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_CACHE_DIR,
+      g_param_spec_string ("index-cache-dir", "Index cache directory",
+          "Directory to cache sample tables in (NULL = no cache)",
+          DEFAULT_INDEX_CACHE_DIR, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_qtdemux_change_state);
 #if 0
@@ -561,10 +627,49 @@ gst_qtdemux_dispose (GObject * object)
     g_object_unref (G_OBJECT (qtdemux->adapter));
     qtdemux->adapter = NULL;
   }
+  g_free (qtdemux->index_cache_dir);
+  qtdemux->index_cache_dir = NULL;
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_qtdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstQTDemux *qtdemux = GST_QTDEMUX (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_CACHE_DIR:
+      GST_OBJECT_LOCK (qtdemux);
+      g_free (qtdemux->index_cache_dir);
+      qtdemux->index_cache_dir = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (qtdemux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_qtdemux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstQTDemux *qtdemux = GST_QTDEMUX (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_CACHE_DIR:
+      GST_OBJECT_LOCK (qtdemux);
+      g_value_set_string (value, qtdemux->index_cache_dir);
+      GST_OBJECT_UNLOCK (qtdemux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_qtdemux_post_no_playable_stream_error (GstQTDemux * qtdemux)
 {
@@ -958,8 +1063,30 @@ gst_qtdemux_find_index (GstQTDemux * qtdemux, QtDemuxStream * str,
 
 
 
-/* find the index of the sample that includes the data for @media_offset using a
- * linear search
+/* find the first of the first @n samples of @str with an offset of at least
+ * @offset using a binary search, the sample offsets must be increasing
+ *
+ * Returns @n if all samples are before @offset.
+ */
+static guint32
+gst_qtdemux_find_offset_bound (QtDemuxStream * str, guint32 n, guint64 offset)
+{
+  guint32 low = 0, high = n;
+
+  while (low < high) {
+    guint32 mid = low + (high - low) / 2;
+
+    if (str->samples[mid].offset < offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+/* find the index of the sample that includes the data for @media_offset,
+ * keeping in mind that not all samples may have been parsed yet.  Uses a
+ * binary search unless the sample offsets are not increasing.
  *
  * Returns the index of the sample.
  */
@@ -976,6 +1103,24 @@ gst_qtdemux_find_index_for_given_media_offset_linear (GstQTDemux * qtdemux,
   if (media_offset == result->offset)
     return index;
 
+  /* expand the samples in chunks until the parsed range goes past the
+   * requested offset */
+  while (!str->offsets_unsorted && str->stbl_index < str->n_samples - 1 &&
+      (str->stbl_index < 0 ||
+          str->samples[str->stbl_index].offset <= media_offset)) {
+    index = MIN (str->stbl_index + QTDEMUX_EXPAND_CHUNK, str->n_samples - 1);
+    if (!qtdemux_parse_samples (qtdemux, str, index))
+      goto parse_failed;
+  }
+
+  if (!str->offsets_unsorted) {
+    index = gst_qtdemux_find_offset_bound (str, str->stbl_index + 1,
+        media_offset + 1);
+    return index > 0 ? index - 1 : 0;
+  }
+
+  /* samples are not stored in file order, fall back to scanning them */
+  index = 0;
   result++;
   while (index < str->n_samples - 1) {
     if (!qtdemux_parse_samples (qtdemux, str, index + 1))
@@ -997,9 +1142,55 @@ parse_failed:
   }
 }
 
-/* find the index of the sample that includes the data for @media_time using a
- * linear search, and keeping in mind that not all samples may have been parsed
- * yet.  If possible, it will delegate to binary search.
+/* find the index of the sample that includes @mov_time by walking the stts
+ * entries, without expanding the sample table
+ *
+ * Returns FALSE if the stts atom is not available (anymore).
+ */
+static gboolean
+qtdemux_stts_find_index (QtDemuxStream * str, guint64 mov_time,
+    guint32 * index)
+{
+  GstByteReader stts;
+  guint64 time;
+  guint32 n = 0;
+  guint32 i;
+
+  if (str->stts.data == NULL || str->chunks_are_samples || str->n_samples == 0)
+    return FALSE;
+
+  /* skip version + flags and the entry count */
+  gst_byte_reader_init (&stts, str->stts.data, str->stts.size);
+  if (!gst_byte_reader_skip (&stts, 8))
+    return FALSE;
+
+  time = gst_util_uint64_scale (str->elst_offset, str->timescale, GST_SECOND);
+
+  for (i = 0; i < str->n_sample_times; i++) {
+    guint32 count, duration;
+
+    if (!gst_byte_reader_get_uint32_be (&stts, &count) ||
+        !gst_byte_reader_get_uint32_be (&stts, &duration))
+      break;
+
+    if (duration > 0 && mov_time < time + (guint64) count * duration) {
+      if (mov_time > time)
+        n += (mov_time - time) / duration;
+      break;
+    }
+    time += (guint64) count * duration;
+    n += count;
+  }
+
+  *index = MIN (n, str->n_samples - 1);
+
+  return TRUE;
+}
+
+/* find the index of the sample that includes the data for @media_time,
+ * keeping in mind that not all samples may have been parsed yet.  The samples
+ * are expanded up to the requested time, which is then looked up with a
+ * binary search.
  *
  * Returns the index of the sample.
  */
@@ -1009,6 +1200,7 @@ gst_qtdemux_find_index_linear (GstQTDemux * qtdemux, QtDemuxStream * str,
 {
   guint32 index = 0;
   guint64 mov_time;
+  gboolean found;
 
   /* convert media_time to mov format */
   mov_time =
@@ -1022,21 +1214,37 @@ gst_qtdemux_find_index_linear (GstQTDemux * qtdemux, QtDemuxStream * str,
       mov_time <= str->samples[str->stbl_index].timestamp)
     return gst_qtdemux_find_index (qtdemux, str, media_time);
 
-  while (index < str->n_samples - 1) {
-    if (!qtdemux_parse_samples (qtdemux, str, index + 1))
+  /* locate the target in the stts table and only expand the samples up to a
+   * chunk past it, instead of stepping through them one by one */
+  GST_OBJECT_LOCK (qtdemux);
+  found = qtdemux_stts_find_index (str, mov_time, &index);
+  GST_OBJECT_UNLOCK (qtdemux);
+  if (found) {
+    GST_LOG_OBJECT (qtdemux, "stts lookup gives sample %u, expanding", index);
+    index = MIN (index + QTDEMUX_EXPAND_CHUNK, str->n_samples - 1);
+    if (!qtdemux_parse_samples (qtdemux, str, index))
       goto parse_failed;
 
-    if (mov_time < str->samples[index + 1].timestamp)
-      break;
+    if (mov_time <= str->samples[str->stbl_index].timestamp)
+      return gst_qtdemux_find_index (qtdemux, str, media_time);
+  }
 
-    index++;
+  /* otherwise expand in chunks until the parsed range goes past the
+   * requested time */
+  while (str->stbl_index < str->n_samples - 1 &&
+      (str->stbl_index < 0 ||
+          mov_time > str->samples[str->stbl_index].timestamp)) {
+    index = MIN (str->stbl_index + QTDEMUX_EXPAND_CHUNK, str->n_samples - 1);
+    if (!qtdemux_parse_samples (qtdemux, str, index))
+      goto parse_failed;
   }
-  return index;
+
+  return gst_qtdemux_find_index (qtdemux, str, media_time);
 
   /* ERRORS */
 parse_failed:
   {
-    GST_LOG_OBJECT (qtdemux, "Parsing of index %u failed!", index + 1);
+    GST_LOG_OBJECT (qtdemux, "Parsing up to index %u failed!", index);
     return -1;
   }
 }
@@ -1519,13 +1727,91 @@ no_format:
   }
 }
 
+typedef struct
+{
+  QtDemuxStream *stream;
+  gboolean res;
+} QtDemuxIndexJob;
+
+static void
+qtdemux_index_job_func (QtDemuxIndexJob * job, GstQTDemux * qtdemux)
+{
+  QtDemuxStream *stream = job->stream;
+
+  job->res = stream->n_samples > 0 &&
+      qtdemux_parse_samples_unlocked (qtdemux, stream, stream->n_samples - 1);
+}
+
+/* build the complete index of all streams on a pool of threads, each stream
+ * has its own parsing state so they can be expanded in parallel.
+ *
+ * Returns FALSE if the pool could not be set up, @res is set to FALSE when
+ * the index of one of the streams could not be built.
+ */
+static gboolean
+qtdemux_ensure_index_parallel (GstQTDemux * qtdemux, gboolean * res)
+{
+  QtDemuxIndexJob *jobs;
+  GThreadPool *pool;
+  GError *err = NULL;
+  guint i;
+
+  /* hold the lock for all workers, against the streaming thread */
+  GST_OBJECT_LOCK (qtdemux);
+  pool = g_thread_pool_new ((GFunc) qtdemux_index_job_func, qtdemux,
+      MIN (qtdemux->n_streams, QTDEMUX_MAX_INDEX_THREADS), FALSE, &err);
+  if (pool == NULL)
+    goto no_pool;
+
+  jobs = g_new0 (QtDemuxIndexJob, qtdemux->n_streams);
+  for (i = 0; i < qtdemux->n_streams; i++) {
+    jobs[i].stream = qtdemux->streams[i];
+    g_thread_pool_push (pool, &jobs[i], NULL);
+  }
+  /* waits for all streams to be done */
+  g_thread_pool_free (pool, FALSE, TRUE);
+  GST_OBJECT_UNLOCK (qtdemux);
+
+  *res = TRUE;
+  for (i = 0; i < qtdemux->n_streams; i++) {
+    if (!jobs[i].res) {
+      GST_LOG_OBJECT (qtdemux,
+          "Building complete index of stream %u for seeking failed!", i);
+      *res = FALSE;
+    }
+  }
+  g_free (jobs);
+
+  if (!*res)
+    GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
+        (_("This file is corrupt and cannot be played.")), (NULL));
+
+  return TRUE;
+
+  /* ERRORS */
+no_pool:
+  {
+    GST_OBJECT_UNLOCK (qtdemux);
+    GST_WARNING_OBJECT (qtdemux, "could not create index threads: %s",
+        err->message);
+    g_error_free (err);
+    return FALSE;
+  }
+}
+
 static gboolean
 qtdemux_ensure_index (GstQTDemux * qtdemux)
 {
+  gboolean res;
   guint i;
 
   GST_DEBUG_OBJECT (qtdemux, "collecting all metadata for all streams");
 
+  /* many-track files get their streams indexed in parallel */
+  if (!qtdemux->fragmented && qtdemux->n_streams > 1 &&
+      qtdemux_ensure_index_parallel (qtdemux, &res))
+    return res;
+
   /* Build complete index */
   for (i = 0; i < qtdemux->n_streams; i++) {
     QtDemuxStream *stream = qtdemux->streams[i];
@@ -1566,8 +1852,10 @@ gst_qtdemux_handle_src_event (GstPad * pad, GstObject * parent,
       }
 
       /* Build complete index for seeking;
-       * if not a fragmented file at least */
-      if (!qtdemux->fragmented)
+       * if not a fragmented file at least.  In pull mode the sample tables
+       * are expanded on demand up to the seek target, only push mode needs
+       * the complete index to map byte offsets back to samples */
+      if (!qtdemux->fragmented && !qtdemux->pullbased)
         if (!qtdemux_ensure_index (qtdemux))
           goto index_failed;
 #ifndef GST_DISABLE_GST_DEBUG
@@ -1646,6 +1934,17 @@ gst_qtdemux_find_sample (GstQTDemux * qtdemux, gint64 byte_pos, gboolean fw,
       inc = -1;
     }
 
+    /* skip the samples that cannot match with a binary search; whatever is
+     * not filled in yet has no size and is skipped by the scan anyway */
+    if (!str->offsets_unsorted) {
+      guint32 filled;
+
+      filled = str->stsz.data ? str->stbl_index + 1 : str->n_samples;
+      i = gst_qtdemux_find_offset_bound (str, filled, byte_pos);
+      if (!fw)
+        i--;
+    }
+
     for (; (i >= 0) && (i < str->n_samples); i += inc) {
       if (str->samples[i].size == 0)
         continue;
@@ -1872,6 +2171,8 @@ gst_qtdemux_reset (GstQTDemux * qtdemux, gboolean hard)
     gst_caps_replace (&qtdemux->media_caps, NULL);
     qtdemux->timescale = 0;
     qtdemux->got_moov = FALSE;
+    g_free (qtdemux->moov_hash);
+    qtdemux->moov_hash = NULL;
   } else if (qtdemux->mss_mode) {
     for (n = 0; n < qtdemux->n_streams; n++)
       gst_qtdemux_stream_clear (qtdemux->streams[n]);
@@ -2105,6 +2406,256 @@ gst_qtdemux_get_index (GstElement * element)
 }
 #endif
 
+/* record @duration for sample @index of @stream, switching from a constant
+ * duration to a per-sample table as soon as the durations differ */
+static gboolean
+qtdemux_set_sample_duration (QtDemuxStream * stream, guint32 index,
+    guint32 duration)
+{
+  guint32 i;
+
+  if (stream->durations) {
+    stream->durations[index] = duration;
+    return TRUE;
+  }
+
+  if (index == 0) {
+    stream->sample_duration = duration;
+    return TRUE;
+  }
+
+  if (duration == stream->sample_duration)
+    return TRUE;
+
+  stream->durations = g_try_new (guint32, stream->n_samples_alloc);
+  if (stream->durations == NULL)
+    return FALSE;
+
+  for (i = 0; i < index; i++)
+    stream->durations[i] = stream->sample_duration;
+  stream->durations[index] = duration;
+
+  return TRUE;
+}
+
+/* flag @stream if the offsets of samples @from to @to are not increasing,
+ * offset lookups can only use a binary search when they are */
+static void
+qtdemux_check_sample_offsets (QtDemuxStream * stream, guint32 from,
+    guint32 to)
+{
+  guint32 i;
+
+  for (i = MAX (from, 1); i <= to && !stream->offsets_unsorted; i++) {
+    if (stream->samples[i].offset < stream->samples[i - 1].offset)
+      stream->offsets_unsorted = TRUE;
+  }
+}
+
+/* check if all samples of @stream get the same duration from the stts atom
+ * and if so, return it in @duration */
+static gboolean
+qtdemux_stts_constant_duration (QtDemuxStream * stream, guint32 * duration)
+{
+  GstByteReader stts;
+  guint64 total = 0;
+  guint32 i;
+
+  if (stream->chunks_are_samples || stream->n_sample_times == 0)
+    return FALSE;
+
+  /* skip version + flags and the entry count */
+  gst_byte_reader_init (&stts, stream->stts.data, stream->stts.size);
+  if (!gst_byte_reader_skip (&stts, 8))
+    return FALSE;
+
+  for (i = 0; i < stream->n_sample_times; i++) {
+    guint32 count, dur;
+
+    if (!gst_byte_reader_get_uint32_be (&stts, &count) ||
+        !gst_byte_reader_get_uint32_be (&stts, &dur))
+      return FALSE;
+
+    if (i == 0)
+      *duration = dur;
+    else if (dur != *duration)
+      return FALSE;
+
+    total += count;
+  }
+
+  /* samples not covered by stts get a duration of -1 */
+  return total >= stream->n_samples;
+}
+
+static void gst_qtdemux_stbl_free (QtDemuxStream * stream);
+
+static gchar *
+qtdemux_index_cache_path (GstQTDemux * qtdemux, QtDemuxStream * stream)
+{
+  gchar *name, *path;
+
+  name = g_strdup_printf ("%s-%u.idx", qtdemux->moov_hash, stream->track_id);
+  path = g_build_filename (qtdemux->index_cache_dir, name, NULL);
+  g_free (name);
+
+  return path;
+}
+
+/* replace the (not yet expanded) sample table of @stream with the one from the
+ * index cache, if there is a matching one */
+static gboolean
+qtdemux_index_cache_load (GstQTDemux * qtdemux, QtDemuxStream * stream)
+{
+  QtDemuxIndexCacheHeader header;
+  GMappedFile *file;
+  gchar *path, *data;
+  gsize size, expected;
+
+  if (qtdemux->moov_hash == NULL || qtdemux->fragmented ||
+      stream->n_samples == 0)
+    return FALSE;
+
+  GST_OBJECT_LOCK (qtdemux);
+  path = qtdemux_index_cache_path (qtdemux, stream);
+  GST_OBJECT_UNLOCK (qtdemux);
+
+  /* a private writable mapping, the cache file itself is never modified */
+  file = g_mapped_file_new (path, TRUE, NULL);
+  if (file == NULL) {
+    GST_DEBUG_OBJECT (qtdemux, "no index cached in %s", path);
+    g_free (path);
+    return FALSE;
+  }
+
+  data = g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+  if (size < sizeof (header))
+    goto invalid;
+
+  memcpy (&header, data, sizeof (header));
+  if (header.magic != QTDEMUX_INDEX_CACHE_MAGIC ||
+      header.sample_size != sizeof (QtDemuxSample) ||
+      header.n_samples != stream->n_samples)
+    goto invalid;
+
+  expected = sizeof (header) + (gsize) header.n_samples * sizeof (QtDemuxSample);
+  if (header.flags & QTDEMUX_INDEX_CACHE_DURATIONS)
+    expected += (gsize) header.n_samples * sizeof (guint32);
+  if (size != expected)
+    goto invalid;
+
+  g_free (stream->samples);
+  g_free (stream->durations);
+  stream->samples = (QtDemuxSample *) (data + sizeof (header));
+  if (header.flags & QTDEMUX_INDEX_CACHE_DURATIONS)
+    stream->durations = (guint32 *) (data + sizeof (header) +
+        (gsize) header.n_samples * sizeof (QtDemuxSample));
+  else
+    stream->durations = NULL;
+  stream->sample_duration = header.sample_duration;
+  stream->all_keyframe =
+      (header.flags & QTDEMUX_INDEX_CACHE_ALL_KEYFRAME) ? TRUE : FALSE;
+  stream->offsets_unsorted =
+      (header.flags & QTDEMUX_INDEX_CACHE_OFFSETS_UNSORTED) ? TRUE : FALSE;
+  stream->index_cache = file;
+
+  /* everything is parsed now */
+  stream->stbl_index = stream->n_samples - 1;
+  gst_qtdemux_stbl_free (stream);
+
+  GST_DEBUG_OBJECT (qtdemux, "loaded index of %u samples from %s",
+      stream->n_samples, path);
+  g_free (path);
+
+  return TRUE;
+
+  /* ERRORS */
+invalid:
+  {
+    GST_WARNING_OBJECT (qtdemux, "ignoring invalid index cache %s", path);
+    g_mapped_file_unref (file);
+    g_free (path);
+    return FALSE;
+  }
+}
+
+/* store the sample table of @stream in the index cache, if it was completely
+ * expanded */
+static void
+qtdemux_index_cache_save (GstQTDemux * qtdemux, QtDemuxStream * stream)
+{
+  QtDemuxIndexCacheHeader header;
+  GError *err = NULL;
+  gchar *path, *dir, *data;
+  gsize samples_size, size;
+
+  if (stream->index_cache || qtdemux->fragmented || stream->n_samples == 0 ||
+      stream->stbl_index != (gint64) stream->n_samples - 1)
+    return;
+
+  GST_OBJECT_LOCK (qtdemux);
+  if (qtdemux->moov_hash == NULL || qtdemux->index_cache_dir == NULL) {
+    GST_OBJECT_UNLOCK (qtdemux);
+    return;
+  }
+  path = qtdemux_index_cache_path (qtdemux, stream);
+  dir = g_strdup (qtdemux->index_cache_dir);
+  GST_OBJECT_UNLOCK (qtdemux);
+
+  memset (&header, 0, sizeof (header));
+  header.magic = QTDEMUX_INDEX_CACHE_MAGIC;
+  header.sample_size = sizeof (QtDemuxSample);
+  header.n_samples = stream->n_samples;
+  header.sample_duration = stream->sample_duration;
+  if (stream->all_keyframe)
+    header.flags |= QTDEMUX_INDEX_CACHE_ALL_KEYFRAME;
+  if (stream->durations)
+    header.flags |= QTDEMUX_INDEX_CACHE_DURATIONS;
+  if (stream->offsets_unsorted)
+    header.flags |= QTDEMUX_INDEX_CACHE_OFFSETS_UNSORTED;
+
+  samples_size = (gsize) stream->n_samples * sizeof (QtDemuxSample);
+  size = sizeof (header) + samples_size;
+  if (stream->durations)
+    size += (gsize) stream->n_samples * sizeof (guint32);
+
+  data = g_try_malloc (size);
+  if (data == NULL)
+    goto out_of_memory;
+
+  memcpy (data, &header, sizeof (header));
+  memcpy (data + sizeof (header), stream->samples, samples_size);
+  if (stream->durations)
+    memcpy (data + sizeof (header) + samples_size, stream->durations,
+        (gsize) stream->n_samples * sizeof (guint32));
+
+  /* written to a temporary file and renamed, so readers never see a partial
+   * index */
+  g_mkdir_with_parents (dir, 0755);
+  if (!g_file_set_contents (path, data, size, &err)) {
+    GST_WARNING_OBJECT (qtdemux, "could not write index cache %s: %s", path,
+        err->message);
+    g_error_free (err);
+  } else {
+    GST_DEBUG_OBJECT (qtdemux, "stored index of %u samples in %s",
+        stream->n_samples, path);
+  }
+  g_free (data);
+
+done:
+  g_free (dir);
+  g_free (path);
+  return;
+
+  /* ERRORS */
+out_of_memory:
+  {
+    GST_WARNING_OBJECT (qtdemux, "not enough memory to store index cache");
+    goto done;
+  }
+}
+
 static void
 gst_qtdemux_stbl_free (QtDemuxStream * stream)
 {
@@ -2137,8 +2688,17 @@ gst_qtdemux_stream_clear (QtDemuxStream * stream)
     gst_memory_unref (stream->rgb8_palette);
     stream->rgb8_palette = NULL;
   }
-  g_free (stream->samples);
+  if (stream->index_cache) {
+    g_mapped_file_unref (stream->index_cache);
+    stream->index_cache = NULL;
+  } else {
+    g_free (stream->samples);
+    g_free (stream->durations);
+  }
   stream->samples = NULL;
+  stream->durations = NULL;
+  stream->n_samples_alloc = 0;
+  stream->offsets_unsorted = FALSE;
   g_free (stream->segments);
   stream->segments = NULL;
   if (stream->pending_tags)
@@ -2162,6 +2722,7 @@ gst_qtdemux_stream_clear (QtDemuxStream * stream)
 static void
 gst_qtdemux_stream_free (GstQTDemux * qtdemux, QtDemuxStream * stream)
 {
+  qtdemux_index_cache_save (qtdemux, stream);
   gst_qtdemux_stream_clear (stream);
   if (stream->caps)
     gst_caps_unref (stream->caps);
@@ -2550,6 +3111,14 @@ qtdemux_parse_trun (GstQTDemux * qtdemux, GstByteReader * trun,
         stream->n_samples + samples_count);
   if (stream->samples == NULL)
     goto out_of_memory;
+  stream->n_samples_alloc = stream->n_samples + samples_count;
+
+  if (stream->durations) {
+    stream->durations = g_try_renew (guint32, stream->durations,
+        stream->n_samples_alloc);
+    if (stream->durations == NULL)
+      goto out_of_memory;
+  }
 
   if (qtdemux->fragment_start != -1) {
     timestamp = gst_util_uint64_scale_int (qtdemux->fragment_start,
@@ -2562,9 +3131,8 @@ qtdemux_parse_trun (GstQTDemux * qtdemux, GstByteReader * trun,
       timestamp = 0;
     } else {
       /* subsequent fragments extend stream */
-      timestamp =
-          stream->samples[stream->n_samples - 1].timestamp +
-          stream->samples[stream->n_samples - 1].duration;
+      sample = &stream->samples[stream->n_samples - 1];
+      timestamp = sample->timestamp + QTSAMPLE_DURATION (stream, sample);
     }
   }
   sample = stream->samples + stream->n_samples;
@@ -2607,7 +3175,8 @@ qtdemux_parse_trun (GstQTDemux * qtdemux, GstByteReader * trun,
     sample->pts_offset = ct;
     sample->size = size;
     sample->timestamp = timestamp + elst_timestamp;
-    sample->duration = dur;
+    if (!qtdemux_set_sample_duration (stream, stream->n_samples + i, dur))
+      goto out_of_memory;
     /* sample-is-difference-sample */
     /* ismv seems to use 0x40 for keyframe, 0xc0 for non-keyframe,
      * now idea how it relates to bitfield other than massive LE/BE confusion */
@@ -2617,6 +3186,8 @@ qtdemux_parse_trun (GstQTDemux * qtdemux, GstByteReader * trun,
     sample++;
   }
 
+  qtdemux_check_sample_offsets (stream, stream->n_samples,
+      stream->n_samples + samples_count - 1);
   stream->n_samples += samples_count;
 
   return TRUE;
@@ -4872,7 +5443,8 @@ gst_qtdemux_process_adapter (GstQTDemux * demux, gboolean force)
           if (remaining_data_size > 0) {
             g_assert (demux->restoredata_buffer == NULL);
             demux->restoredata_buffer =
-                gst_adapter_take_buffer (demux->adapter, remaining_data_size);
+                gst_adapter_take_buffer_fast (demux->adapter,
+                remaining_data_size);
             demux->restoredata_offset = demux->offset + demux->neededbytes;
             GST_DEBUG_OBJECT (demux,
                 "Stored %" G_GSIZE_FORMAT " post mdat bytes at offset %"
@@ -4917,7 +5489,8 @@ gst_qtdemux_process_adapter (GstQTDemux * demux, gboolean force)
 
         GST_DEBUG_OBJECT (demux, "Got our buffer at offset %" G_GUINT64_FORMAT,
             demux->offset);
-        buf = gst_adapter_take_buffer (demux->adapter, demux->neededbytes);
+        /* only pushed back into the adapter later, no need to merge */
+        buf = gst_adapter_take_buffer_fast (demux->adapter, demux->neededbytes);
         gst_buffer_extract (buf, 0, fourcc, 4);
         GST_DEBUG_OBJECT (demux, "mdatbuffer starts with %" GST_FOURCC_FORMAT,
             GST_FOURCC_ARGS (QT_FOURCC (fourcc)));
@@ -5031,7 +5604,11 @@ gst_qtdemux_process_adapter (GstQTDemux * demux, gboolean force)
         sample = &stream->samples[stream->sample_index];
 
         if (G_LIKELY (!(STREAM_IS_EOS (stream)))) {
-          outbuf = gst_adapter_take_buffer (demux->adapter, demux->neededbytes);
+          /* samples spanning several upstream buffers are pushed as
+           * multi-memory buffers instead of being merged here; elements that
+           * need contiguous data get it when mapping the buffer */
+          outbuf =
+              gst_adapter_take_buffer_fast (demux->adapter, demux->neededbytes);
           GST_DEBUG_OBJECT (demux, "stream : %" GST_FOURCC_FORMAT,
               GST_FOURCC_ARGS (stream->fourcc));
 
@@ -5257,6 +5834,14 @@ qtdemux_parse_moov (GstQTDemux * qtdemux, const guint8 * buffer, guint length)
   /* counts as header data */
   qtdemux->header_size += length;
 
+  GST_OBJECT_LOCK (qtdemux);
+  g_free (qtdemux->moov_hash);
+  qtdemux->moov_hash = NULL;
+  if (qtdemux->index_cache_dir)
+    qtdemux->moov_hash =
+        g_compute_checksum_for_data (G_CHECKSUM_SHA1, buffer, length);
+  GST_OBJECT_UNLOCK (qtdemux);
+
   GST_DEBUG_OBJECT (qtdemux, "parsing 'moov' atom");
   qtdemux_parse_node (qtdemux, qtdemux->moov_node, buffer, length);
 
@@ -6276,6 +6861,18 @@ qtdemux_stbl_init (GstQTDemux * qtdemux, QtDemuxStream * stream, GNode * stbl)
         stream->n_samples);
     return FALSE;
   }
+  stream->n_samples_alloc = stream->n_samples;
+
+  /* only keep a table of durations when they are not all the same */
+  if (!qtdemux_stts_constant_duration (stream, &stream->sample_duration)) {
+    GST_DEBUG_OBJECT (qtdemux, "allocating table of sample durations");
+    stream->durations = g_try_new (guint32, stream->n_samples);
+    if (!stream->durations) {
+      GST_WARNING_OBJECT (qtdemux, "failed to allocate %d durations",
+          stream->n_samples);
+      return FALSE;
+    }
+  }
 
 
   /* composition time-to-sample */
@@ -6297,6 +6894,9 @@ qtdemux_stbl_init (GstQTDemux * qtdemux, QtDemuxStream * stream, GNode * stbl)
       goto corrupt_file;
   }
 
+  /* skip building the sample table if it was cached before */
+  qtdemux_index_cache_load (qtdemux, stream);
+
   return TRUE;
 
 corrupt_file:
@@ -6319,30 +6919,26 @@ no_samples:
   }
 }
 
-/* collect samples from the next sample to be parsed up to sample @n for @stream
- * by reading the info from @stbl
+/* collect samples from the next sample to be parsed up to sample @n < n_samples
+ * for @stream by reading the info from @stbl
  *
- * This code can be executed from both the streaming thread and the seeking
- * thread so it takes the object lock to protect itself
+ * Must be called with the object lock held, or from the index build in
+ * qtdemux_ensure_index(), which holds it on behalf of the workers.
+ *
+ * Returns FALSE if the sample tables are corrupt.
  */
 static gboolean
-qtdemux_parse_samples (GstQTDemux * qtdemux, QtDemuxStream * stream, guint32 n)
+qtdemux_parse_samples_unlocked (GstQTDemux * qtdemux, QtDemuxStream * stream,
+    guint32 n)
 {
   gint i, j, k;
   QtDemuxSample *samples, *first, *cur, *last;
   guint32 n_samples_per_chunk;
   guint32 n_samples;
-
-  GST_LOG_OBJECT (qtdemux, "parsing samples for stream fourcc %"
-      GST_FOURCC_FORMAT ", pad %s", GST_FOURCC_ARGS (stream->fourcc),
-      stream->pad ? GST_PAD_NAME (stream->pad) : "(NULL)");
+  guint32 from;
 
   n_samples = stream->n_samples;
-
-  if (n >= n_samples)
-    goto out_of_samples;
-
-  GST_OBJECT_LOCK (qtdemux);
+  from = stream->stbl_index + 1;
   if (n <= stream->stbl_index)
     goto already_parsed;
 
@@ -6477,7 +7073,8 @@ qtdemux_parse_samples (GstQTDemux * qtdemux, QtDemuxStream * stream, guint32 n)
                     GST_SECOND, stream->timescale)), cur->size);
 
         cur->timestamp = stream->stco_sample_index + elst_timestamp;
-        cur->duration = stream->samples_per_chunk;
+        if (stream->durations)
+          stream->durations[cur - samples] = stream->samples_per_chunk;
         cur->keyframe = TRUE;
         cur++;
 
@@ -6565,7 +7162,8 @@ done2:
                     stream->timescale)));
 
         cur->timestamp = stts_time + elst_offset;
-        cur->duration = stts_duration;
+        if (stream->durations)
+          stream->durations[cur - samples] = stts_duration;
 
         /* avoid 32-bit wrap-around,
          * but still mind possible 'negative' duration */
@@ -6594,7 +7192,8 @@ done2:
           GST_TIME_ARGS (gst_util_uint64_scale (stream->stts_time, GST_SECOND,
                   stream->timescale)));
       cur->timestamp = stream->stts_time + elst_offset;
-      cur->duration = -1;
+      if (stream->durations)
+        stream->durations[cur - samples] = -1;
     }
   }
 done3:
@@ -6706,6 +7305,9 @@ ctts:
     }
   }
 done:
+  /* fragmented samples were checked when they were added */
+  if (stream->stsz.data)
+    qtdemux_check_sample_offsets (stream, from, n);
   stream->stbl_index = n;
   /* if index has been completely parsed, free data that is no-longer needed */
   if (n + 1 == stream->n_samples) {
@@ -6716,7 +7318,6 @@ done:
       if (qtdemux_add_fragmented_samples (qtdemux) != GST_FLOW_OK)
         break;
   }
-  GST_OBJECT_UNLOCK (qtdemux);
 
   return TRUE;
 
@@ -6729,9 +7330,43 @@ already_parsed:
     /* if fragmented, there may be more */
     if (qtdemux->fragmented && n == stream->stbl_index)
       goto done;
-    GST_OBJECT_UNLOCK (qtdemux);
     return TRUE;
   }
+  /* ERRORS */
+corrupt_file:
+  {
+    GST_WARNING_OBJECT (qtdemux, "corrupt sample tables");
+    return FALSE;
+  }
+}
+
+/* collect samples from the next sample to be parsed up to sample @n for @stream
+ * by reading the info from @stbl
+ *
+ * This code can be executed from both the streaming thread and the seeking
+ * thread so it takes the object lock to protect itself
+ */
+static gboolean
+qtdemux_parse_samples (GstQTDemux * qtdemux, QtDemuxStream * stream, guint32 n)
+{
+  gboolean res;
+
+  GST_LOG_OBJECT (qtdemux, "parsing samples for stream fourcc %"
+      GST_FOURCC_FORMAT ", pad %s", GST_FOURCC_ARGS (stream->fourcc),
+      stream->pad ? GST_PAD_NAME (stream->pad) : "(NULL)");
+
+  if (n >= stream->n_samples)
+    goto out_of_samples;
+
+  GST_OBJECT_LOCK (qtdemux);
+  res = qtdemux_parse_samples_unlocked (qtdemux, stream, n);
+  GST_OBJECT_UNLOCK (qtdemux);
+
+  if (!res)
+    goto corrupt_file;
+
+  return TRUE;
+
   /* ERRORS */
 out_of_samples:
   {
@@ -6744,7 +7379,6 @@ out_of_samples:
   }
 corrupt_file:
   {
-    GST_OBJECT_UNLOCK (qtdemux);
     GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
         (_("This file is corrupt and cannot be played.")), (NULL));
     return FALSE;
@@ -8783,7 +9417,10 @@ qtdemux_prepare_streams (GstQTDemux * qtdemux)
       durations = g_array_sized_new (FALSE, FALSE, sizeof (guint32), samples);
       sample_num = 0;
       while (sample_num < samples) {
-        g_array_append_val (durations, stream->samples[sample_num].duration);
+        guint32 duration =
+            QTSAMPLE_DURATION (stream, &stream->samples[sample_num]);
+
+        g_array_append_val (durations, duration);
         sample_num++;
       }
       g_array_sort (durations, less_than);
@@ -144,6 +144,10 @@ struct _GstQTDemux {
   gint64 chapters_track_id;
 
   GstClockTime min_elst_offset;
+
+  /* persistent sample index cache */
+  gchar *index_cache_dir;
+  gchar *moov_hash;             /* identifies the file in the cache */
 };
 
 struct _GstQTDemuxClass {
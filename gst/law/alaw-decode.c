@@ -41,6 +41,8 @@ static gboolean gst_alaw_dec_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstFlowReturn gst_alaw_dec_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_alaw_dec_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 
 #define gst_alaw_dec_parent_class parent_class
 G_DEFINE_TYPE (GstALawDec, gst_alaw_dec, GST_TYPE_ELEMENT);
@@ -51,7 +53,7 @@ G_DEFINE_TYPE (GstALawDec, gst_alaw_dec, GST_TYPE_ELEMENT);
 
 #ifdef GST_ALAW_DEC_USE_TABLE
 
-static const gint alaw_to_s16_table[256] = {
+static const gint16 alaw_to_s16_table[256] = {
   -5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
   -7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
   -2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
@@ -265,6 +267,8 @@ gst_alaw_dec_init (GstALawDec * alawdec)
       GST_DEBUG_FUNCPTR (gst_alaw_dec_event));
   gst_pad_set_chain_function (alawdec->sinkpad,
       GST_DEBUG_FUNCPTR (gst_alaw_dec_chain));
+  gst_pad_set_chain_list_function (alawdec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_alaw_dec_chain_list));
   gst_element_add_pad (GST_ELEMENT (alawdec), alawdec->sinkpad);
 
   alawdec->srcpad =
@@ -302,22 +306,16 @@ gst_alaw_dec_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
-static GstFlowReturn
-gst_alaw_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+/* decode @buffer, the returned buffer replaces it */
+static GstBuffer *
+gst_alaw_dec_convert (GstALawDec * alawdec, GstBuffer * buffer)
 {
-  GstALawDec *alawdec;
   GstMapInfo inmap, outmap;
   gint16 *linear_data;
   guint8 *alaw_data;
   gsize alaw_size, linear_size;
   GstBuffer *outbuf;
   gint i;
-  GstFlowReturn ret;
-
-  alawdec = GST_ALAW_DEC (parent);
-
-  if (G_UNLIKELY (!GST_AUDIO_INFO_IS_VALID (&alawdec->info)))
-    goto not_negotiated;
 
   GST_LOG_OBJECT (alawdec, "buffer with ts=%" GST_TIME_FORMAT,
       GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)));
@@ -354,9 +352,23 @@ gst_alaw_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   gst_buffer_unmap (buffer, &inmap);
   gst_buffer_unref (buffer);
 
-  ret = gst_pad_push (alawdec->srcpad, outbuf);
+  return outbuf;
+}
 
-  return ret;
+static GstFlowReturn
+gst_alaw_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstALawDec *alawdec;
+  GstBuffer *outbuf;
+
+  alawdec = GST_ALAW_DEC (parent);
+
+  if (G_UNLIKELY (!GST_AUDIO_INFO_IS_VALID (&alawdec->info)))
+    goto not_negotiated;
+
+  outbuf = gst_alaw_dec_convert (alawdec, buffer);
+
+  return gst_pad_push (alawdec->srcpad, outbuf);
 
 not_negotiated:
   {
@@ -366,6 +378,40 @@ not_negotiated:
   }
 }
 
+static gboolean
+gst_alaw_dec_convert_func (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  *buffer = gst_alaw_dec_convert (GST_ALAW_DEC (user_data), *buffer);
+
+  return TRUE;
+}
+
+/* RTP depayloaders hand out lists of small packets, the whole list is
+ * decoded and pushed at once */
+static GstFlowReturn
+gst_alaw_dec_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstALawDec *alawdec;
+
+  alawdec = GST_ALAW_DEC (parent);
+
+  if (G_UNLIKELY (!GST_AUDIO_INFO_IS_VALID (&alawdec->info)))
+    goto not_negotiated;
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, gst_alaw_dec_convert_func, alawdec);
+
+  return gst_pad_push_list (alawdec->srcpad, list);
+
+not_negotiated:
+  {
+    gst_buffer_list_unref (list);
+    GST_WARNING_OBJECT (alawdec, "no input format set: not-negotiated");
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+}
+
 static GstStateChangeReturn
 gst_alaw_dec_change_state (GstElement * element, GstStateChange transition)
 {
@@ -39,6 +39,8 @@ static gboolean gst_alaw_enc_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstFlowReturn gst_alaw_enc_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_alaw_enc_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 
 G_DEFINE_TYPE (GstALawEnc, gst_alaw_enc, GST_TYPE_ELEMENT);
 
@@ -300,6 +302,10 @@ s16_to_alaw (gint pcm_val)
 
 #endif /* GST_ALAW_ENC_USE_TABLE */
 
+/* s16_to_alaw() of every possible sample, this saves the sign handling and
+ * the division of the table above. Filled in class_init */
+static guint8 alaw_enc_table[65536];
+
 static GstCaps *
 gst_alaw_enc_getcaps (GstPad * pad, GstCaps * filter)
 {
@@ -424,6 +430,7 @@ static void
 gst_alaw_enc_class_init (GstALawEncClass * klass)
 {
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  guint i;
 
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&alaw_enc_src_factory));
@@ -436,6 +443,9 @@ gst_alaw_enc_class_init (GstALawEncClass * klass)
       "Zaheer Abbas Merali <zaheerabbas at merali dot org>");
 
   GST_DEBUG_CATEGORY_INIT (alaw_enc_debug, "alawenc", 0, "A Law audio encoder");
+
+  for (i = 0; i < G_N_ELEMENTS (alaw_enc_table); i++)
+    alaw_enc_table[i] = s16_to_alaw ((gint16) i);
 }
 
 static void
@@ -449,6 +459,8 @@ gst_alaw_enc_init (GstALawEnc * alawenc)
       GST_DEBUG_FUNCPTR (gst_alaw_enc_event));
   gst_pad_set_chain_function (alawenc->sinkpad,
       GST_DEBUG_FUNCPTR (gst_alaw_enc_chain));
+  gst_pad_set_chain_list_function (alawenc->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_alaw_enc_chain_list));
   gst_element_add_pad (GST_ELEMENT (alawenc), alawenc->sinkpad);
 
   alawenc->srcpad =
@@ -490,10 +502,12 @@ gst_alaw_enc_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
-static GstFlowReturn
-gst_alaw_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+/* encode @buffer, the returned buffer replaces it. A writable buffer is
+ * encoded in place, each A-law byte is written over a sample that was
+ * already read */
+static GstBuffer *
+gst_alaw_enc_convert (GstALawEnc * alawenc, GstBuffer * buffer)
 {
-  GstALawEnc *alawenc;
   GstMapInfo inmap, outmap;
   gint16 *linear_data;
   gsize linear_size;
@@ -501,59 +515,114 @@ gst_alaw_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   guint alaw_size;
   GstBuffer *outbuf;
   gint i;
-  GstFlowReturn ret;
   GstClockTime timestamp, duration;
 
-  alawenc = GST_ALAW_ENC (parent);
-
-  if (G_UNLIKELY (alawenc->rate == 0 || alawenc->channels == 0))
-    goto not_negotiated;
-
-  gst_buffer_map (buffer, &inmap, GST_MAP_READ);
-  linear_data = (gint16 *) inmap.data;
-  linear_size = inmap.size;
-
-  alaw_size = linear_size / 2;
-
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   duration = GST_BUFFER_DURATION (buffer);
 
   GST_LOG_OBJECT (alawenc, "buffer with ts=%" GST_TIME_FORMAT,
       GST_TIME_ARGS (timestamp));
 
-  outbuf = gst_buffer_new_allocate (NULL, alaw_size, NULL);
+  if (gst_buffer_is_writable (buffer)) {
+    gst_buffer_map (buffer, &inmap, GST_MAP_READWRITE);
+    linear_data = (gint16 *) inmap.data;
+    alaw_data = inmap.data;
+    alaw_size = inmap.size / 2;
+
+    for (i = 0; i < alaw_size; i++)
+      alaw_data[i] = alaw_enc_table[(guint16) linear_data[i]];
+
+    gst_buffer_unmap (buffer, &inmap);
+    gst_buffer_resize (buffer, 0, alaw_size);
+    outbuf = buffer;
+  } else {
+    gst_buffer_map (buffer, &inmap, GST_MAP_READ);
+    linear_data = (gint16 *) inmap.data;
+    linear_size = inmap.size;
+
+    alaw_size = linear_size / 2;
+
+    outbuf = gst_buffer_new_allocate (NULL, alaw_size, NULL);
+
+    gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
+    alaw_data = outmap.data;
+    alaw_size = outmap.size;
+
+    /* copy discont flag */
+    if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT))
+      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+
+    GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
+
+    for (i = 0; i < alaw_size; i++)
+      alaw_data[i] = alaw_enc_table[(guint16) linear_data[i]];
+
+    gst_buffer_unmap (outbuf, &outmap);
+    gst_buffer_unmap (buffer, &inmap);
+    gst_buffer_unref (buffer);
+  }
 
   if (duration == GST_CLOCK_TIME_NONE) {
     duration = gst_util_uint64_scale_int (alaw_size,
         GST_SECOND, alawenc->rate * alawenc->channels);
   }
+  GST_BUFFER_DURATION (outbuf) = duration;
+
+  return outbuf;
+}
+
+static GstFlowReturn
+gst_alaw_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstALawEnc *alawenc;
+  GstBuffer *outbuf;
 
-  gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
-  alaw_data = outmap.data;
-  alaw_size = outmap.size;
+  alawenc = GST_ALAW_ENC (parent);
 
-  /* copy discont flag */
-  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT))
-    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+  if (G_UNLIKELY (alawenc->rate == 0 || alawenc->channels == 0))
+    goto not_negotiated;
 
-  GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
-  GST_BUFFER_DURATION (outbuf) = duration;
+  outbuf = gst_alaw_enc_convert (alawenc, buffer);
 
-  for (i = 0; i < alaw_size; i++) {
-    alaw_data[i] = s16_to_alaw (linear_data[i]);
+  return gst_pad_push (alawenc->srcpad, outbuf);
+
+not_negotiated:
+  {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_NOT_NEGOTIATED;
   }
+}
 
-  gst_buffer_unmap (outbuf, &outmap);
-  gst_buffer_unmap (buffer, &inmap);
-  gst_buffer_unref (buffer);
+static gboolean
+gst_alaw_enc_convert_func (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  *buffer = gst_alaw_enc_convert (GST_ALAW_ENC (user_data), *buffer);
 
-  ret = gst_pad_push (alawenc->srcpad, outbuf);
+  return TRUE;
+}
 
-  return ret;
+/* RTP depayloaders hand out lists of small packets, the whole list is
+ * encoded and pushed at once. The list owns its buffers so they can usually
+ * be encoded in place */
+static GstFlowReturn
+gst_alaw_enc_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstALawEnc *alawenc;
+
+  alawenc = GST_ALAW_ENC (parent);
+
+  if (G_UNLIKELY (alawenc->rate == 0 || alawenc->channels == 0))
+    goto not_negotiated;
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, gst_alaw_enc_convert_func, alawenc);
+
+  return gst_pad_push_list (alawenc->srcpad, list);
 
 not_negotiated:
   {
-    gst_buffer_unref (buffer);
+    gst_buffer_list_unref (list);
     return GST_FLOW_NOT_NEGOTIATED;
   }
 }
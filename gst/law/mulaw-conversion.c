@@ -31,8 +31,8 @@
 #define BIAS 0x84               /* define the add-in bias for 16 bit samples */
 #define CLIP 32635
 
-void
-mulaw_encode (gint16 * in, guint8 * out, gint numsamples)
+static inline guint8
+mulaw_encode_sample (gint16 sample)
 {
   static const gint16 exp_lut[256] = {
     0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
@@ -53,33 +53,28 @@ mulaw_encode (gint16 * in, guint8 * out, gint numsamples)
     7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
   };
   gint16 sign, exponent, mantissa;
-  gint16 sample;
   guint8 ulawbyte;
-  gint i;
 
-  for (i = 0; i < numsamples; i++) {
-    sample = in[i];
-      /** get the sample into sign-magnitude **/
-    sign = (sample >> 8) & 0x80;        /* set aside the sign */
-    if (sign != 0) {
-      sample = -sample;         /* get magnitude */
-    }
-    /* sample can be zero because we can overflow in the inversion,
-     * checking against the unsigned version solves this */
-    if (((guint16) sample) > CLIP)
-      sample = CLIP;            /* clip the magnitude */
-
-      /** convert from 16 bit linear to ulaw **/
-    sample = sample + BIAS;
-    exponent = exp_lut[(sample >> 7) & 0xFF];
-    mantissa = (sample >> (exponent + 3)) & 0x0F;
-    ulawbyte = ~(sign | (exponent << 4) | mantissa);
+    /** get the sample into sign-magnitude **/
+  sign = (sample >> 8) & 0x80;  /* set aside the sign */
+  if (sign != 0) {
+    sample = -sample;           /* get magnitude */
+  }
+  /* sample can be zero because we can overflow in the inversion,
+   * checking against the unsigned version solves this */
+  if (((guint16) sample) > CLIP)
+    sample = CLIP;              /* clip the magnitude */
+
+    /** convert from 16 bit linear to ulaw **/
+  sample = sample + BIAS;
+  exponent = exp_lut[(sample >> 7) & 0xFF];
+  mantissa = (sample >> (exponent + 3)) & 0x0F;
+  ulawbyte = ~(sign | (exponent << 4) | mantissa);
 #ifdef ZEROTRAP
-    if (ulawbyte == 0)
-      ulawbyte = 0x02;          /* optional CCITT trap */
+  if (ulawbyte == 0)
+    ulawbyte = 0x02;            /* optional CCITT trap */
 #endif
-    out[i] = ulawbyte;
-  }
+  return ulawbyte;
 }
 
 /*
@@ -98,25 +93,67 @@ mulaw_encode (gint16 * in, guint8 * out, gint numsamples)
  * Output: signed 16 bit linear sample
  */
 
-void
-mulaw_decode (guint8 * in, gint16 * out, gint numsamples)
+static inline gint16
+mulaw_decode_sample (guint8 ulawbyte)
 {
   static const gint16 exp_lut[8] =
       { 0, 132, 396, 924, 1980, 4092, 8316, 16764 };
   gint16 sign, exponent, mantissa;
-  guint8 ulawbyte;
   gint16 linear;
-  gint i;
 
-  for (i = 0; i < numsamples; i++) {
-    ulawbyte = in[i];
-    ulawbyte = ~ulawbyte;
-    sign = (ulawbyte & 0x80);
-    exponent = (ulawbyte >> 4) & 0x07;
-    mantissa = ulawbyte & 0x0F;
-    linear = exp_lut[exponent] + (mantissa << (exponent + 3));
-    if (sign != 0)
-      linear = -linear;
-    out[i] = linear;
+  ulawbyte = ~ulawbyte;
+  sign = (ulawbyte & 0x80);
+  exponent = (ulawbyte >> 4) & 0x07;
+  mantissa = ulawbyte & 0x0F;
+  linear = exp_lut[exponent] + (mantissa << (exponent + 3));
+  if (sign != 0)
+    linear = -linear;
+  return linear;
+}
+
+/* Both directions are a plain table lookup, one entry for every possible
+ * input value. The tables are filled from the conversions above the first
+ * time they are needed, the 64kB encode table is too big to ship in the
+ * binary. Most of the time only the small magnitudes around 0 are hit so
+ * the part of the table that is in use easily stays in the cache. */
+static guint8 encode_table[65536];
+static gint16 decode_table[256];
+
+static void
+mulaw_init_tables (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized)) {
+    gint i;
+
+    for (i = 0; i < 65536; i++)
+      encode_table[i] = mulaw_encode_sample ((gint16) i);
+    for (i = 0; i < 256; i++)
+      decode_table[i] = mulaw_decode_sample (i);
+
+    g_once_init_leave (&initialized, 1);
   }
 }
+
+void
+mulaw_encode (gint16 * in, guint8 * out, gint numsamples)
+{
+  gint i;
+
+  mulaw_init_tables ();
+
+  for (i = 0; i < numsamples; i++)
+    out[i] = encode_table[(guint16) in[i]];
+}
+
+void
+mulaw_decode (guint8 * in, gint16 * out, gint numsamples)
+{
+  gint i;
+
+  mulaw_init_tables ();
+
+  for (i = 0; i < numsamples; i++)
+    out[i] = decode_table[in[i]];
+}
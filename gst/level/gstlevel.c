@@ -243,6 +243,7 @@ static void
 gst_level_init (GstLevel * filter)
 {
   filter->CS = NULL;
+  filter->block_CS = NULL;
   filter->peak = NULL;
   filter->last_peak = NULL;
   filter->decay_peak = NULL;
@@ -268,6 +269,7 @@ gst_level_finalize (GObject * obj)
   GstLevel *filter = GST_LEVEL (obj);
 
   g_free (filter->CS);
+  g_free (filter->block_CS);
   g_free (filter->peak);
   g_free (filter->last_peak);
   g_free (filter->decay_peak);
@@ -275,6 +277,7 @@ gst_level_finalize (GObject * obj)
   g_free (filter->decay_peak_age);
 
   filter->CS = NULL;
+  filter->block_CS = NULL;
   filter->peak = NULL;
   filter->last_peak = NULL;
   filter->decay_peak = NULL;
@@ -345,12 +348,13 @@ gst_level_get_property (GObject * object, guint prop_id,
 }
 
 
-/* process one (interleaved) channel of incoming samples
+/* process all the (interleaved) channels of incoming samples in one pass
  * calculate square sum of samples
  * normalize and average over number of samples
  * returns a normalized cumulative square value, which can be averaged
  * to return the average power as a double between 0 and 1
  * also returns the normalized peak power (square of the highest amplitude)
+ * the values of channel i are stored in NCS[i] and NPS[i]
  *
  * caller must assure num is a multiple of channels
  * samples for multiple channels are interleaved
@@ -359,76 +363,70 @@ gst_level_get_property (GObject * object, guint prop_id,
  *
  * for integers, this code considers the non-existant positive max value to be
  * full-scale; so max-1 will not map to 1.0
+ *
+ * the squares are summed up in ACC. For 8 and 16 bit samples that is a
+ * 64 bit integer: a square fits in 31 bits, so the sum is exact and no
+ * sample has to be converted to a double. Interleaved data is read once,
+ * frame by frame, with the sums of up to LEVEL_CHANNEL_GROUP channels kept
+ * side by side instead of one strided pass per channel; larger layouts take
+ * one pass per group of channels. The sums of every channel are built in
+ * the same order as before, so the results do not change
  */
+#define LEVEL_CHANNEL_GROUP 8
 
-#define DEFINE_INT_LEVEL_CALCULATOR(TYPE, RESOLUTION)                         \
-static void inline                                                            \
+#define DEFINE_LEVEL_CALCULATOR(TYPE, ACC, NORMALIZER)                        \
+static void                                                                   \
 gst_level_calculate_##TYPE (gpointer data, guint num, guint channels,         \
                             gdouble *NCS, gdouble *NPS)                       \
 {                                                                             \
   TYPE * in = (TYPE *)data;                                                   \
-  register guint j;                                                           \
-  gdouble squaresum = 0.0;           /* square sum of the input samples */    \
-  register gdouble square = 0.0;     /* Square */                             \
-  register gdouble peaksquare = 0.0; /* Peak Square Sample */                 \
-  gdouble normalizer;                /* divisor to get a [-1.0, 1.0] range */ \
+  ACC squaresum[LEVEL_CHANNEL_GROUP];  /* square sum of the input samples */  \
+  ACC peaksquare[LEVEL_CHANNEL_GROUP]; /* Peak Square Sample */               \
+  ACC square;                          /* Square */                           \
+  gdouble normalizer = NORMALIZER;     /* divisor for a [-1.0, 1.0] range */  \
+  guint i, j, c, n;                                                           \
                                                                               \
-  /* *NCS = 0.0; Normalized Cumulative Square */                              \
-  /* *NPS = 0.0; Normalized Peak Square */                                    \
+  if (channels == 1) {                                                        \
+    ACC sum = 0, peak = 0;                                                    \
                                                                               \
-  for (j = 0; j < num; j += channels) {                                       \
-    square = ((gdouble) in[j]) * in[j];                                       \
-    if (square > peaksquare) peaksquare = square;                             \
-    squaresum += square;                                                      \
+    for (j = 0; j < num; j++) {                                               \
+      square = ((ACC) in[j]) * in[j];                                         \
+      peak = MAX (peak, square);                                              \
+      sum += square;                                                          \
+    }                                                                         \
+    NCS[0] = sum / normalizer;                                                \
+    NPS[0] = peak / normalizer;                                               \
+    return;                                                                   \
   }                                                                           \
                                                                               \
-  normalizer = (gdouble) (G_GINT64_CONSTANT(1) << (RESOLUTION * 2));          \
-  *NCS = squaresum / normalizer;                                              \
-  *NPS = peaksquare / normalizer;                                             \
-}
-
-DEFINE_INT_LEVEL_CALCULATOR (gint32, 31);
-DEFINE_INT_LEVEL_CALCULATOR (gint16, 15);
-DEFINE_INT_LEVEL_CALCULATOR (gint8, 7);
-
-/* FIXME: use orc to calculate squaresums? */
-#define DEFINE_FLOAT_LEVEL_CALCULATOR(TYPE)                                   \
-static void inline                                                            \
-gst_level_calculate_##TYPE (gpointer data, guint num, guint channels,         \
-                            gdouble *NCS, gdouble *NPS)                       \
-{                                                                             \
-  TYPE * in = (TYPE *)data;                                                   \
-  register guint j;                                                           \
-  gdouble squaresum = 0.0;           /* square sum of the input samples */    \
-  register gdouble square = 0.0;     /* Square */                             \
-  register gdouble peaksquare = 0.0; /* Peak Square Sample */                 \
+  for (c = 0; c < channels; c += n) {                                         \
+    n = MIN (channels - c, LEVEL_CHANNEL_GROUP);                              \
+    for (i = 0; i < n; i++)                                                   \
+      squaresum[i] = peaksquare[i] = 0;                                       \
                                                                               \
-  /* *NCS = 0.0; Normalized Cumulative Square */                              \
-  /* *NPS = 0.0; Normalized Peak Square */                                    \
+    for (j = c; j < num; j += channels) {                                     \
+      for (i = 0; i < n; i++) {                                               \
+        square = ((ACC) in[j + i]) * in[j + i];                               \
+        peaksquare[i] = MAX (peaksquare[i], square);                          \
+        squaresum[i] += square;                                               \
+      }                                                                       \
+    }                                                                         \
                                                                               \
-  /* orc_level_squaresum_f64(&squaresum,in,num); */                           \
-  for (j = 0; j < num; j += channels) {                                       \
-    square = ((gdouble) in[j]) * in[j];                                       \
-    if (square > peaksquare) peaksquare = square;                             \
-    squaresum += square;                                                      \
+    for (i = 0; i < n; i++) {                                                 \
+      NCS[c + i] = squaresum[i] / normalizer;                                 \
+      NPS[c + i] = peaksquare[i] / normalizer;                                \
+    }                                                                         \
   }                                                                           \
-                                                                              \
-  *NCS = squaresum;                                                           \
-  *NPS = peaksquare;                                                          \
 }
 
-DEFINE_FLOAT_LEVEL_CALCULATOR (gfloat);
-DEFINE_FLOAT_LEVEL_CALCULATOR (gdouble);
+#define INT_NORMALIZER(RESOLUTION) \
+    ((gdouble) (G_GINT64_CONSTANT(1) << (RESOLUTION * 2)))
 
-/* we would need stride to deinterleave also
-static void inline
-gst_level_calculate_gdouble (gpointer data, guint num, guint channels,
-                            gdouble *NCS, gdouble *NPS)
-{
-  orc_level_squaresum_f64(NCS,(gdouble *)data,num);
-  *NPS = 0.0;
-}
-*/
+DEFINE_LEVEL_CALCULATOR (gint32, gdouble, INT_NORMALIZER (31));
+DEFINE_LEVEL_CALCULATOR (gint16, gint64, INT_NORMALIZER (15));
+DEFINE_LEVEL_CALCULATOR (gint8, gint64, INT_NORMALIZER (7));
+DEFINE_LEVEL_CALCULATOR (gfloat, gdouble, 1.0);
+DEFINE_LEVEL_CALCULATOR (gdouble, gdouble, 1.0);
 
 
 static gboolean
@@ -469,12 +467,14 @@ gst_level_set_caps (GstBaseTransform * trans, GstCaps * in, GstCaps * out)
 
   /* allocate channel variable arrays */
   g_free (filter->CS);
+  g_free (filter->block_CS);
   g_free (filter->peak);
   g_free (filter->last_peak);
   g_free (filter->decay_peak);
   g_free (filter->decay_peak_base);
   g_free (filter->decay_peak_age);
   filter->CS = g_new (gdouble, channels);
+  filter->block_CS = g_new (gdouble, channels);
   filter->peak = g_new (gdouble, channels);
   filter->last_peak = g_new (gdouble, channels);
   filter->decay_peak = g_new (gdouble, channels);
@@ -573,6 +573,66 @@ gst_level_message_append_channel (GstMessage * m, gdouble rms, gdouble peak,
   g_value_unset (&v);
 }
 
+/* update the running and decaying peaks of all channels after a block of
+ * @duration was analyzed */
+static void
+gst_level_update_decay_peaks (GstLevel * filter, GstClockTime duration)
+{
+  gint channels = GST_AUDIO_INFO_CHANNELS (&filter->info);
+  GstClockTime ttl = gst_gdouble_to_guint64 (filter->decay_peak_ttl);
+  GstClockTimeDiff falloff_time, last_falloff_time = 0;
+  gdouble falloff = 1.0;
+  gint i;
+
+  for (i = 0; i < channels; ++i) {
+    filter->decay_peak_age[i] += duration;
+    GST_LOG_OBJECT (filter,
+        "[%d]: peak %f, last peak %f, decay peak %f, age %" GST_TIME_FORMAT,
+        i, filter->peak[i], filter->last_peak[i], filter->decay_peak[i],
+        GST_TIME_ARGS (filter->decay_peak_age[i]));
+
+    /* update running peak */
+    if (filter->peak[i] > filter->last_peak[i])
+      filter->last_peak[i] = filter->peak[i];
+
+    /* make decay peak fall off if too old */
+    falloff_time = GST_CLOCK_DIFF (ttl, filter->decay_peak_age[i]);
+    if (falloff_time > 0) {
+      /* the peaks of the channels usually have the same age, the factor
+       * is only calculated again when it changes */
+      if (falloff_time != last_falloff_time) {
+        gdouble falloff_dB;
+        gdouble length;         /* length of falloff time in seconds */
+
+        length = (gdouble) falloff_time / (gdouble) GST_SECOND;
+        falloff_dB = filter->decay_peak_falloff * length;
+        falloff = pow (10, falloff_dB / -20.0);
+        last_falloff_time = falloff_time;
+
+        GST_LOG_OBJECT (filter,
+            "falloff: interval %" GST_TIME_FORMAT
+            ", dB falloff %f, factor %e",
+            GST_TIME_ARGS (falloff_time), falloff_dB, falloff);
+      }
+      filter->decay_peak[i] = filter->decay_peak_base[i] * falloff;
+      GST_LOG_OBJECT (filter,
+          "peak is %" GST_TIME_FORMAT " old, decayed with factor %e to %f",
+          GST_TIME_ARGS (filter->decay_peak_age[i]), falloff,
+          filter->decay_peak[i]);
+    } else {
+      GST_LOG_OBJECT (filter, "peak not old enough, not decaying");
+    }
+
+    /* if the peak of this run is higher, the decay peak gets reset */
+    if (filter->peak[i] >= filter->decay_peak[i]) {
+      GST_LOG_OBJECT (filter, "new peak, %f", filter->peak[i]);
+      filter->decay_peak[i] = filter->peak[i];
+      filter->decay_peak_base[i] = filter->peak[i];
+      filter->decay_peak_age[i] = G_GINT64_CONSTANT (0);
+    }
+  }
+}
+
 static GstFlowReturn
 gst_level_transform_ip (GstBaseTransform * trans, GstBuffer * in)
 {
@@ -580,14 +640,12 @@ gst_level_transform_ip (GstBaseTransform * trans, GstBuffer * in)
   GstMapInfo map;
   guint8 *in_data;
   gsize in_size;
-  gdouble CS;
   guint i;
   guint num_frames;
   guint num_int_samples = 0;    /* number of interleaved samples
                                  * ie. total count for all channels combined */
   guint block_size, block_int_size;     /* we subdivide buffers to not skip message
                                          * intervals */
-  GstClockTimeDiff falloff_time;
   gint channels, rate, bps;
 
   filter = GST_LEVEL (trans);
@@ -621,65 +679,23 @@ gst_level_transform_ip (GstBaseTransform * trans, GstBuffer * in)
     block_size = MIN (block_size, num_frames);
     block_int_size = block_size * channels;
 
-    for (i = 0; i < channels; ++i) {
-      if (!GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_GAP)) {
-        filter->process (in_data, block_int_size, channels, &CS,
-            &filter->peak[i]);
+    if (!GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_GAP)) {
+      filter->process (in_data, block_int_size, channels, filter->block_CS,
+          filter->peak);
+      for (i = 0; i < channels; ++i) {
         GST_LOG_OBJECT (filter,
             "[%d]: cumulative squares %lf, over %d samples/%d channels",
-            i, CS, block_int_size, channels);
-        filter->CS[i] += CS;
-      } else {
-        filter->peak[i] = 0.0;
-      }
-      in_data += bps;
-
-      filter->decay_peak_age[i] += GST_FRAMES_TO_CLOCK_TIME (num_frames, rate);
-      GST_LOG_OBJECT (filter,
-          "[%d]: peak %f, last peak %f, decay peak %f, age %" GST_TIME_FORMAT,
-          i, filter->peak[i], filter->last_peak[i], filter->decay_peak[i],
-          GST_TIME_ARGS (filter->decay_peak_age[i]));
-
-      /* update running peak */
-      if (filter->peak[i] > filter->last_peak[i])
-        filter->last_peak[i] = filter->peak[i];
-
-      /* make decay peak fall off if too old */
-      falloff_time =
-          GST_CLOCK_DIFF (gst_gdouble_to_guint64 (filter->decay_peak_ttl),
-          filter->decay_peak_age[i]);
-      if (falloff_time > 0) {
-        gdouble falloff_dB;
-        gdouble falloff;
-        gdouble length;         /* length of falloff time in seconds */
-
-        length = (gdouble) falloff_time / (gdouble) GST_SECOND;
-        falloff_dB = filter->decay_peak_falloff * length;
-        falloff = pow (10, falloff_dB / -20.0);
-
-        GST_LOG_OBJECT (filter,
-            "falloff: current %f, base %f, interval %" GST_TIME_FORMAT
-            ", dB falloff %f, factor %e",
-            filter->decay_peak[i], filter->decay_peak_base[i],
-            GST_TIME_ARGS (falloff_time), falloff_dB, falloff);
-        filter->decay_peak[i] = filter->decay_peak_base[i] * falloff;
-        GST_LOG_OBJECT (filter,
-            "peak is %" GST_TIME_FORMAT " old, decayed with factor %e to %f",
-            GST_TIME_ARGS (filter->decay_peak_age[i]), falloff,
-            filter->decay_peak[i]);
-      } else {
-        GST_LOG_OBJECT (filter, "peak not old enough, not decaying");
-      }
-
-      /* if the peak of this run is higher, the decay peak gets reset */
-      if (filter->peak[i] >= filter->decay_peak[i]) {
-        GST_LOG_OBJECT (filter, "new peak, %f", filter->peak[i]);
-        filter->decay_peak[i] = filter->peak[i];
-        filter->decay_peak_base[i] = filter->peak[i];
-        filter->decay_peak_age[i] = G_GINT64_CONSTANT (0);
+            i, filter->block_CS[i], block_int_size, channels);
+        filter->CS[i] += filter->block_CS[i];
       }
+    } else {
+      for (i = 0; i < channels; ++i)
+        filter->peak[i] = 0.0;
     }
-    in_data += ((block_int_size * bps) - bps);
+    in_data += block_int_size * bps;
+
+    gst_level_update_decay_peaks (filter,
+        GST_FRAMES_TO_CLOCK_TIME (num_frames, rate));
 
     filter->num_frames += block_size;
     num_frames -= block_size;
@@ -36,6 +36,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_ebml_write_debug);
 #define _do_init \
       GST_DEBUG_CATEGORY_INIT (gst_ebml_write_debug, "ebmlwrite", 0, "Write EBML structured data")
 #define parent_class gst_ebml_write_parent_class
+
+/* push a batch early once it holds this much data */
+#define GST_EBML_WRITE_MAX_BATCH_SIZE (8 * 1024 * 1024)
 G_DEFINE_TYPE_WITH_CODE (GstEbmlWrite, gst_ebml_write, GST_TYPE_OBJECT,
     _do_init);
 
@@ -57,6 +60,8 @@ gst_ebml_write_init (GstEbmlWrite * ebml)
   ebml->last_pos = G_MAXUINT64; /* force segment event */
 
   ebml->cache = NULL;
+  ebml->batch = NULL;
+  ebml->batch_size = 0;
   ebml->streamheader = NULL;
   ebml->streamheader_pos = 0;
   ebml->writing_streamheader = FALSE;
@@ -75,6 +80,11 @@ gst_ebml_write_finalize (GObject * object)
     ebml->cache = NULL;
   }
 
+  if (ebml->batch) {
+    gst_buffer_list_unref (ebml->batch);
+    ebml->batch = NULL;
+  }
+
   if (ebml->streamheader) {
     gst_byte_writer_free (ebml->streamheader);
     ebml->streamheader = NULL;
@@ -129,6 +139,12 @@ gst_ebml_write_reset (GstEbmlWrite * ebml)
     ebml->cache = NULL;
   }
 
+  if (ebml->batch) {
+    gst_buffer_list_unref (ebml->batch);
+    ebml->batch = NULL;
+  }
+  ebml->batch_size = 0;
+
   if (ebml->caps) {
     gst_caps_unref (ebml->caps);
     ebml->caps = NULL;
@@ -228,6 +244,158 @@ gst_ebml_writer_send_segment_event (GstEbmlWrite * ebml, guint64 new_pos)
   return res;
 }
 
+/* push the pending batch, but keep batching */
+static void
+gst_ebml_write_push_batch (GstEbmlWrite * ebml)
+{
+  GstBufferList *list;
+
+  if (gst_buffer_list_length (ebml->batch) == 0)
+    return;
+
+  list = ebml->batch;
+  ebml->batch = gst_buffer_list_new ();
+  GST_DEBUG ("Pushing batch of %u buffers, %" G_GUINT64_FORMAT " bytes",
+      gst_buffer_list_length (list), ebml->batch_size);
+  ebml->batch_size = 0;
+
+  if (ebml->last_write_result == GST_FLOW_OK)
+    ebml->last_write_result = gst_pad_push_list (ebml->srcpad, list);
+  else
+    gst_buffer_list_unref (list);
+}
+
+/* the writable buffer of the batch that contains offset to offset_end */
+static GstBuffer *
+gst_ebml_write_find_in_batch (GstEbmlWrite * ebml, guint64 offset,
+    guint64 offset_end)
+{
+  guint i, len;
+
+  len = gst_buffer_list_length (ebml->batch);
+  for (i = 0; i < len; i++) {
+    GstBuffer *cur = gst_buffer_list_get (ebml->batch, i);
+
+    if (offset < GST_BUFFER_OFFSET (cur) ||
+        offset_end > GST_BUFFER_OFFSET_END (cur))
+      continue;
+
+    return gst_buffer_is_writable (cur) ? cur : NULL;
+  }
+
+  return NULL;
+}
+
+/* Overwrite data that is still in the batch, which is what happens when
+ * a master element gets its size filled in. Returns FALSE if the data is
+ * not contained in a single writable buffer of the batch. */
+static gboolean
+gst_ebml_write_patch_batch (GstEbmlWrite * ebml, GstBuffer * buf)
+{
+  GstBuffer *cur;
+  GstMapInfo map;
+
+  cur = gst_ebml_write_find_in_batch (ebml, GST_BUFFER_OFFSET (buf),
+      GST_BUFFER_OFFSET_END (buf));
+  if (cur == NULL)
+    return FALSE;
+
+  GST_LOG ("patching batch at %" G_GUINT64_FORMAT, GST_BUFFER_OFFSET (buf));
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  gst_buffer_fill (cur, GST_BUFFER_OFFSET (buf) - GST_BUFFER_OFFSET (cur),
+      map.data, map.size);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  return TRUE;
+}
+
+/**
+ * gst_ebml_write_master_in_batch:
+ * @ebml: a #GstEbmlWrite.
+ * @startpos: Master starting position.
+ *
+ * Returns: TRUE if the size of the master element at @startpos is still
+ * in the batch, so gst_ebml_write_master_finish() does not need to seek
+ * downstream.
+ */
+gboolean
+gst_ebml_write_master_in_batch (GstEbmlWrite * ebml, guint64 startpos)
+{
+  if (!ebml->batch)
+    return FALSE;
+
+  return gst_ebml_write_find_in_batch (ebml, startpos, startpos + 8) != NULL;
+}
+
+/* Send out @buf, which has its offsets and flags set, or add it
+ * to the batch */
+static void
+gst_ebml_write_output (GstEbmlWrite * ebml, GstBuffer * buf)
+{
+  if (ebml->batch) {
+    if (gst_ebml_write_patch_batch (ebml, buf))
+      return;
+    /* the batch must go out before anything that does not follow it */
+    if (GST_BUFFER_OFFSET (buf) != ebml->last_pos)
+      gst_ebml_write_push_batch (ebml);
+  }
+
+  if (GST_BUFFER_OFFSET (buf) != ebml->last_pos) {
+    gst_ebml_writer_send_segment_event (ebml, GST_BUFFER_OFFSET (buf));
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+  }
+  ebml->last_pos = GST_BUFFER_OFFSET_END (buf);
+
+  if (ebml->batch) {
+    ebml->batch_size += gst_buffer_get_size (buf);
+    gst_buffer_list_add (ebml->batch, buf);
+    if (ebml->batch_size >= GST_EBML_WRITE_MAX_BATCH_SIZE)
+      gst_ebml_write_push_batch (ebml);
+  } else {
+    ebml->last_write_result = gst_pad_push (ebml->srcpad, buf);
+  }
+}
+
+/**
+ * gst_ebml_write_start_batch:
+ * @ebml: a #GstEbmlWrite.
+ *
+ * Start collecting the written data, e.g. a whole cluster, in a
+ * #GstBufferList instead of pushing every cache flush and media buffer
+ * separately. Media buffers are added as they are, without copying.
+ * Size updates of master elements that are still in the batch are done
+ * in place, without seeking downstream. Pushing is deferred, so write
+ * errors only show up after gst_ebml_write_flush_batch().
+ */
+void
+gst_ebml_write_start_batch (GstEbmlWrite * ebml)
+{
+  g_return_if_fail (ebml->batch == NULL);
+
+  GST_DEBUG ("Starting batch at %" G_GUINT64_FORMAT, ebml->pos);
+  ebml->batch = gst_buffer_list_new ();
+  ebml->batch_size = 0;
+}
+
+/**
+ * gst_ebml_write_flush_batch:
+ * @ebml: a #GstEbmlWrite.
+ *
+ * Push everything collected since gst_ebml_write_start_batch() and stop
+ * batching.
+ */
+void
+gst_ebml_write_flush_batch (GstEbmlWrite * ebml)
+{
+  if (!ebml->batch)
+    return;
+
+  gst_ebml_write_push_batch (ebml);
+  gst_buffer_list_unref (ebml->batch);
+  ebml->batch = NULL;
+}
+
 /**
  * gst_ebml_write_flush_cache:
  * @ebml:      a #GstEbmlWrite.
@@ -252,18 +420,13 @@ gst_ebml_write_flush_cache (GstEbmlWrite * ebml, gboolean is_keyframe,
   GST_BUFFER_OFFSET (buffer) = ebml->pos - gst_buffer_get_size (buffer);
   GST_BUFFER_OFFSET_END (buffer) = ebml->pos;
   if (ebml->last_write_result == GST_FLOW_OK) {
-    if (GST_BUFFER_OFFSET (buffer) != ebml->last_pos) {
-      gst_ebml_writer_send_segment_event (ebml, GST_BUFFER_OFFSET (buffer));
-      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
-    }
     if (ebml->writing_streamheader) {
       GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_HEADER);
     }
     if (!is_keyframe) {
       GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
     }
-    ebml->last_pos = ebml->pos;
-    ebml->last_write_result = gst_pad_push (ebml->srcpad, buffer);
+    gst_ebml_write_output (ebml, buffer);
   } else {
     gst_buffer_unref (buffer);
   }
@@ -455,12 +618,7 @@ gst_ebml_write_element_push (GstEbmlWrite * ebml, GstBuffer * buf,
     }
     GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
 
-    if (GST_BUFFER_OFFSET (buf) != ebml->last_pos) {
-      gst_ebml_writer_send_segment_event (ebml, GST_BUFFER_OFFSET (buf));
-      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
-    }
-    ebml->last_pos = ebml->pos;
-    ebml->last_write_result = gst_pad_push (ebml->srcpad, buf);
+    gst_ebml_write_output (ebml, buf);
   } else {
     gst_buffer_unref (buf);
   }
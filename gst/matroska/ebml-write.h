@@ -53,6 +53,9 @@ typedef struct _GstEbmlWrite {
   GstByteWriter *cache;
   guint64 cache_pos;
 
+  GstBufferList *batch;
+  guint64 batch_size;
+
   GstFlowReturn last_write_result;
 
   gboolean writing_streamheader;
@@ -87,6 +90,15 @@ void    gst_ebml_write_flush_cache   (GstEbmlWrite *ebml,
                                       gboolean is_keyframe,
                                       GstClockTime timestamp);
 
+/*
+ * Batching collects everything written, including media
+ * buffers, in a buffer list that is pushed at once on flush.
+ */
+void    gst_ebml_write_start_batch   (GstEbmlWrite *ebml);
+void    gst_ebml_write_flush_batch   (GstEbmlWrite *ebml);
+gboolean gst_ebml_write_master_in_batch (GstEbmlWrite *ebml,
+                                      guint64       startpos);
+
 /*
  * Seeking.
  */
@@ -83,10 +83,20 @@ enum
   ARG_0,
   ARG_METADATA,
   ARG_STREAMINFO,
-  ARG_MAX_GAP_TIME
+  ARG_MAX_GAP_TIME,
+  ARG_INDEX_SCAN,
+  ARG_N_THREADS
 };
 
 #define  DEFAULT_MAX_GAP_TIME      (2 * GST_SECOND)
+#define  DEFAULT_INDEX_SCAN        FALSE
+#define  DEFAULT_N_THREADS         1
+
+/* enough for a cluster header followed by its timecode */
+#define  INDEX_SCAN_READ_SIZE      64
+
+/* largest cluster we pull in a single read in pull mode */
+#define  MAX_CLUSTER_READ_AHEAD    (4 * 1024 * 1024)
 
 static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -139,6 +149,8 @@ static gboolean gst_matroska_demux_sink_activate_mode (GstPad * sinkpad,
 
 static gboolean gst_matroska_demux_handle_seek_event (GstMatroskaDemux * demux,
     GstPad * pad, GstEvent * event);
+static void gst_matroska_demux_start_index_scan (GstMatroskaDemux * demux);
+static void gst_matroska_demux_stop_index_scan (GstMatroskaDemux * demux);
 static gboolean gst_matroska_demux_handle_src_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
 static gboolean gst_matroska_demux_handle_src_query (GstPad * pad,
@@ -201,6 +213,11 @@ gst_matroska_demux_finalize (GObject * object)
 
   g_object_unref (demux->common.adapter);
 
+  if (demux->decode_pool) {
+    g_thread_pool_free (demux->decode_pool, FALSE, TRUE);
+    demux->decode_pool = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -223,6 +240,36 @@ gst_matroska_demux_class_init (GstMatroskaDemuxClass * klass)
           "The demuxer sends out segment events for skipping "
           "gaps longer than this (0 = disabled).", 0, G_MAXUINT64,
           DEFAULT_MAX_GAP_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMatroskaDemux:index-scan
+   *
+   * When the file has no Cues, build a seek index in a background thread
+   * by walking the cluster headers, skipping the block data. Seeks before
+   * the scanned part of the file use the index, others still scan the file.
+   * Only used in pull mode.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_INDEX_SCAN,
+      g_param_spec_boolean ("index-scan", "Index scan",
+          "Build a seek index from the cluster headers in the background "
+          "when the file has no Cues", DEFAULT_INDEX_SCAN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMatroskaDemux:n-threads
+   *
+   * Number of threads used to decompress the frames of laced blocks on
+   * zlib, bzip2 or lzo compressed tracks, the streaming thread being one of
+   * them. The frames are still output in order. 1 decompresses everything
+   * in the streaming thread.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads decompressing laced frames of compressed "
+          "tracks", 1, 64, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_matroska_demux_change_state);
@@ -279,6 +326,8 @@ gst_matroska_demux_init (GstMatroskaDemux * demux)
 
   /* property defaults */
   demux->max_gap_time = DEFAULT_MAX_GAP_TIME;
+  demux->index_scan = DEFAULT_INDEX_SCAN;
+  demux->n_threads = DEFAULT_N_THREADS;
 
   GST_OBJECT_FLAG_SET (demux, GST_ELEMENT_FLAG_INDEXABLE);
 
@@ -408,6 +457,10 @@ gst_matroska_demux_reset (GstElement * element)
   demux->common.muxing_app = NULL;
 
   /* reset indexes */
+  gst_matroska_demux_stop_index_scan (demux);
+  demux->index_from_scan = FALSE;
+  demux->index_scan_complete = FALSE;
+  demux->index_scan_time = GST_CLOCK_TIME_NONE;
   if (demux->common.index) {
     g_array_free (demux->common.index, TRUE);
     demux->common.index = NULL;
@@ -500,6 +553,32 @@ gst_matroska_demux_reset (GstElement * element)
   demux->invalid_duration = FALSE;
 }
 
+/* Header stripping only prepends a few bytes of constant data to each frame,
+ * so if that is all the frame scope encodings do we can prepend those bytes
+ * as extra memory instead of copying the whole block */
+static gboolean
+gst_matroska_encodings_are_header_strip (GArray * encodings)
+{
+  gboolean found = FALSE;
+  gint i;
+
+  for (i = 0; i < encodings->len; i++) {
+    GstMatroskaTrackEncoding *enc =
+        &g_array_index (encodings, GstMatroskaTrackEncoding, i);
+
+    if ((enc->scope & GST_MATROSKA_TRACK_ENCODING_SCOPE_FRAME) == 0)
+      continue;
+
+    if (enc->type != 0 ||
+        enc->comp_algo != GST_MATROSKA_TRACK_COMPRESSION_ALGORITHM_HEADERSTRIP)
+      return FALSE;
+
+    found = TRUE;
+  }
+
+  return found;
+}
+
 static GstBuffer *
 gst_matroska_decode_buffer (GstMatroskaTrackContext * context, GstBuffer * buf)
 {
@@ -511,6 +590,27 @@ gst_matroska_decode_buffer (GstMatroskaTrackContext * context, GstBuffer * buf)
 
   GST_DEBUG ("decoding buffer %p", buf);
 
+  if (gst_matroska_encodings_are_header_strip (context->encodings)) {
+    gint i;
+
+    buf = gst_buffer_make_writable (buf);
+    for (i = 0; i < context->encodings->len; i++) {
+      GstMatroskaTrackEncoding *enc =
+          &g_array_index (context->encodings, GstMatroskaTrackEncoding, i);
+      guint len = enc->comp_settings_length;
+      gpointer header;
+
+      if ((enc->scope & GST_MATROSKA_TRACK_ENCODING_SCOPE_FRAME) == 0 ||
+          len == 0)
+        continue;
+
+      header = g_memdup (enc->comp_settings, len);
+      gst_buffer_prepend_memory (buf,
+          gst_memory_new_wrapped (0, header, len, 0, len, header, g_free));
+    }
+    return buf;
+  }
+
   gst_buffer_map (buf, &map, GST_MAP_READ);
   data = map.data;
   size = map.size;
@@ -530,6 +630,123 @@ gst_matroska_decode_buffer (GstMatroskaTrackContext * context, GstBuffer * buf)
   }
 }
 
+typedef struct
+{
+  GstMatroskaTrackContext *stream;
+  GstBuffer **frames;
+  gint pending;
+  GMutex lock;
+  GCond cond;
+} GstMatroskaDecodeBatch;
+
+typedef struct
+{
+  GstMatroskaDecodeBatch *batch;
+  gint n;
+} GstMatroskaDecodeTask;
+
+static void
+gst_matroska_demux_decode_func (gpointer data, gpointer user_data)
+{
+  GstMatroskaDecodeTask *task = data;
+  GstMatroskaDecodeBatch *batch = task->batch;
+
+  batch->frames[task->n] =
+      gst_matroska_decode_buffer (batch->stream, batch->frames[task->n]);
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Splits a laced block into its frames and decompresses them in the decode
+ * pool. Returns the decoded frames in lace order, NULL entries are frames
+ * that failed to decode or lie beyond an invalid lace size. Returns NULL if
+ * the pool can't be used, in which case the caller decodes inline. */
+static GstBuffer **
+gst_matroska_demux_decode_laces (GstMatroskaDemux * demux,
+    GstMatroskaTrackContext * stream, GstBuffer * buf, gint laces,
+    const gint * lace_size, guint size, gboolean delta_unit,
+    gboolean invisible_frame)
+{
+  GstMatroskaDecodeBatch batch;
+  GstMatroskaDecodeTask *tasks;
+  GstBuffer **frames;
+  guint threads;
+  gint n, i;
+
+  GST_OBJECT_LOCK (demux);
+  threads = demux->n_threads;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (threads <= 1 || laces < 2 ||
+      gst_matroska_encodings_are_header_strip (stream->encodings))
+    return NULL;
+
+  if (G_UNLIKELY (demux->decode_pool == NULL)) {
+    GError *err = NULL;
+
+    demux->decode_pool = g_thread_pool_new (gst_matroska_demux_decode_func,
+        NULL, threads - 1, FALSE, &err);
+    if (demux->decode_pool == NULL) {
+      GST_WARNING_OBJECT (demux, "failed to create decode pool: %s",
+          err->message);
+      g_error_free (err);
+      return NULL;
+    }
+  }
+
+  frames = g_new0 (GstBuffer *, laces);
+  tasks = g_new (GstMatroskaDecodeTask, laces);
+
+  batch.stream = stream;
+  batch.frames = frames;
+  batch.pending = 0;
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+
+  for (n = 0; n < laces && lace_size[n] <= size; n++) {
+    GstBuffer *sub;
+
+    sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL,
+        gst_buffer_get_size (buf) - size, lace_size[n]);
+    size -= lace_size[n];
+
+    if (delta_unit)
+      GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
+    else
+      GST_BUFFER_FLAG_UNSET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    if (invisible_frame)
+      GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DECODE_ONLY);
+
+    frames[n] = sub;
+    tasks[n].batch = &batch;
+    tasks[n].n = n;
+  }
+
+  /* the streaming thread is one of the threads and takes the last frame */
+  batch.pending = n;
+  for (i = 0; i + 1 < n; i++)
+    g_thread_pool_push (demux->decode_pool, &tasks[i], NULL);
+  if (n > 0)
+    gst_matroska_demux_decode_func (&tasks[n - 1], NULL);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+  g_free (tasks);
+
+  GST_LOG_OBJECT (demux, "decoded %d laces in the decode pool", n);
+
+  return frames;
+}
+
 static void
 gst_matroska_demux_add_stream_headers_to_caps (GstMatroskaDemux * demux,
     GstBufferList * list, GstCaps * caps)
@@ -2011,6 +2228,222 @@ exit:
   return entry;
 }
 
+/* reads an EBML element id from @br */
+static gboolean
+gst_matroska_demux_scan_read_id (GstByteReader * br, guint32 * id)
+{
+  guint8 b;
+  guint len = 1, i;
+
+  if (!gst_byte_reader_get_uint8 (br, &b) || b == 0)
+    return FALSE;
+  while (!(b & (0x80 >> (len - 1))))
+    len++;
+  if (len > 4 || gst_byte_reader_get_remaining (br) < len - 1)
+    return FALSE;
+
+  *id = b;
+  for (i = 1; i < len; i++)
+    *id = (*id << 8) | gst_byte_reader_get_uint8_unchecked (br);
+
+  return TRUE;
+}
+
+/* reads an EBML element size from @br, @unknown is set if all size
+ * bits are set */
+static gboolean
+gst_matroska_demux_scan_read_size (GstByteReader * br, guint64 * size,
+    gboolean * unknown)
+{
+  guint8 b;
+  guint len = 1, i, num_ffs;
+
+  if (!gst_byte_reader_get_uint8 (br, &b) || b == 0)
+    return FALSE;
+  while (!(b & (0x80 >> (len - 1))))
+    len++;
+  if (gst_byte_reader_get_remaining (br) < len - 1)
+    return FALSE;
+
+  *size = b & (0xff >> len);
+  num_ffs = (*size == (0xff >> len));
+  for (i = 1; i < len; i++) {
+    b = gst_byte_reader_get_uint8_unchecked (br);
+    if (b == 0xff)
+      num_ffs++;
+    *size = (*size << 8) | b;
+  }
+  *unknown = (num_ffs == len);
+
+  return TRUE;
+}
+
+/* walks the cluster headers from index_scan_offset, skipping the clusters by
+ * their size, and adds an index entry for each cluster timecode found */
+static gpointer
+gst_matroska_demux_index_scan_func (GstMatroskaDemux * demux)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint64 offset;
+
+  GST_OBJECT_LOCK (demux);
+  offset = demux->index_scan_offset;
+  GST_OBJECT_UNLOCK (demux);
+
+  GST_DEBUG_OBJECT (demux, "scanning clusters from offset %" G_GUINT64_FORMAT,
+      offset);
+
+  while (TRUE) {
+    GstBuffer *buf = NULL;
+    GstMapInfo map;
+    GstByteReader reader;
+    GstClockTime time = GST_CLOCK_TIME_NONE;
+    guint64 length;
+    gboolean unknown;
+    guint32 id;
+    guint header;
+
+    GST_OBJECT_LOCK (demux);
+    if (demux->index_scan_stop) {
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    }
+    GST_OBJECT_UNLOCK (demux);
+
+    ret = gst_pad_pull_range (demux->common.sinkpad, offset,
+        INDEX_SCAN_READ_SIZE, &buf);
+    if (ret == GST_FLOW_FLUSHING) {
+      /* probably seeking, try again once that is done */
+      g_usleep (G_USEC_PER_SEC / 100);
+      continue;
+    } else if (ret != GST_FLOW_OK) {
+      break;
+    }
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    gst_byte_reader_init (&reader, map.data, map.size);
+    if (!gst_matroska_demux_scan_read_id (&reader, &id) ||
+        !gst_matroska_demux_scan_read_size (&reader, &length, &unknown)) {
+      GST_DEBUG_OBJECT (demux, "no valid element at offset %" G_GUINT64_FORMAT,
+          offset);
+      gst_buffer_unmap (buf, &map);
+      gst_buffer_unref (buf);
+      break;
+    }
+    header = gst_byte_reader_get_pos (&reader);
+
+    /* the timecode comes before any block in the cluster */
+    while (id == GST_MATROSKA_ID_CLUSTER) {
+      guint64 clength, timecode = 0;
+      gboolean cunknown;
+      guint32 cid;
+      guint i;
+
+      if (!gst_matroska_demux_scan_read_id (&reader, &cid) ||
+          !gst_matroska_demux_scan_read_size (&reader, &clength, &cunknown) ||
+          cunknown || cid == GST_MATROSKA_ID_BLOCKGROUP ||
+          cid == GST_MATROSKA_ID_SIMPLEBLOCK)
+        break;
+
+      if (cid != GST_MATROSKA_ID_CLUSTERTIMECODE) {
+        if (clength > gst_byte_reader_get_remaining (&reader) ||
+            !gst_byte_reader_skip (&reader, clength))
+          break;
+        continue;
+      }
+
+      if (clength > 8 || clength > gst_byte_reader_get_remaining (&reader))
+        break;
+      for (i = 0; i < clength; i++)
+        timecode = (timecode << 8) | gst_byte_reader_get_uint8_unchecked (&reader);
+      time = timecode * demux->common.time_scale;
+      break;
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+
+    GST_OBJECT_LOCK (demux);
+    if (GST_CLOCK_TIME_IS_VALID (time) &&
+        (!GST_CLOCK_TIME_IS_VALID (demux->index_scan_time) ||
+            time >= demux->index_scan_time)) {
+      GstMatroskaIndex entry;
+
+      GST_LOG_OBJECT (demux, "cluster at offset %" G_GUINT64_FORMAT
+          " with time %" GST_TIME_FORMAT, offset, GST_TIME_ARGS (time));
+      entry.pos = offset - demux->common.ebml_segment_start;
+      entry.track = 0;
+      entry.time = time;
+      entry.block = 0;
+      if (!demux->common.index)
+        demux->common.index =
+            g_array_sized_new (FALSE, FALSE, sizeof (GstMatroskaIndex), 128);
+      g_array_append_val (demux->common.index, entry);
+      demux->index_scan_time = time;
+    }
+    demux->index_scan_offset = offset = offset + header + length;
+    GST_OBJECT_UNLOCK (demux);
+
+    if (unknown) {
+      GST_DEBUG_OBJECT (demux, "element of unknown size, stopping scan");
+      break;
+    }
+  }
+
+  GST_DEBUG_OBJECT (demux, "cluster scan stopped at offset %" G_GUINT64_FORMAT
+      ": %s", offset, gst_flow_get_name (ret));
+
+  GST_OBJECT_LOCK (demux);
+  if (ret == GST_FLOW_EOS)
+    demux->index_scan_complete = TRUE;
+  GST_OBJECT_UNLOCK (demux);
+
+  return NULL;
+}
+
+static void
+gst_matroska_demux_start_index_scan (GstMatroskaDemux * demux)
+{
+  GError *err = NULL;
+
+  GST_OBJECT_LOCK (demux);
+  if (!demux->index_scan || demux->common.index ||
+      demux->index_scan_thread) {
+    GST_OBJECT_UNLOCK (demux);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (demux, "no cues, starting background cluster scan");
+  demux->index_from_scan = TRUE;
+  demux->index_scan_complete = FALSE;
+  demux->index_scan_stop = FALSE;
+  demux->index_scan_time = GST_CLOCK_TIME_NONE;
+  demux->index_scan_offset = demux->first_cluster_offset;
+  demux->index_scan_thread = g_thread_try_new ("matroska-index-scan",
+      (GThreadFunc) gst_matroska_demux_index_scan_func, demux, &err);
+  if (!demux->index_scan_thread) {
+    GST_WARNING_OBJECT (demux, "could not start index scan: %s",
+        err->message);
+    g_error_free (err);
+    demux->index_from_scan = FALSE;
+  }
+  GST_OBJECT_UNLOCK (demux);
+}
+
+static void
+gst_matroska_demux_stop_index_scan (GstMatroskaDemux * demux)
+{
+  GThread *thread;
+
+  GST_OBJECT_LOCK (demux);
+  thread = demux->index_scan_thread;
+  demux->index_scan_thread = NULL;
+  demux->index_scan_stop = TRUE;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (thread)
+    g_thread_join (thread);
+}
+
 static gboolean
 gst_matroska_demux_handle_seek_event (GstMatroskaDemux * demux,
     GstPad * pad, GstEvent * event)
@@ -2050,7 +2483,8 @@ gst_matroska_demux_handle_seek_event (GstMatroskaDemux * demux,
    * we might be playing a file that's still being recorded
    * so, invalidate our current duration, which is only a moving target,
    * and should not be used to clamp anything */
-  if (!demux->streaming && !demux->common.index && demux->invalid_duration) {
+  if (!demux->streaming && (!demux->common.index || demux->index_from_scan)
+      && demux->invalid_duration) {
     seeksegment.duration = GST_CLOCK_TIME_NONE;
   }
 
@@ -2096,9 +2530,19 @@ gst_matroska_demux_handle_seek_event (GstMatroskaDemux * demux,
     snap_next = !snap_next;
   GST_OBJECT_LOCK (demux);
   track = gst_matroska_read_common_get_seek_track (&demux->common, track);
-  if ((entry = gst_matroska_read_common_do_index_seek (&demux->common, track,
-              seeksegment.position, &demux->seek_index, &demux->seek_entry,
-              snap_next)) == NULL) {
+  entry = gst_matroska_read_common_do_index_seek (&demux->common, track,
+      seeksegment.position, &demux->seek_index, &demux->seek_entry, snap_next);
+  if (entry && demux->index_from_scan) {
+    /* the background scan may still grow (and reallocate) the index */
+    scan_entry = *entry;
+    entry = &scan_entry;
+    if (!demux->index_scan_complete && rate > 0.0 &&
+        seeksegment.position > demux->index_scan_time) {
+      GST_DEBUG_OBJECT (demux, "seek target not covered by scanned index yet");
+      entry = NULL;
+    }
+  }
+  if (entry == NULL) {
     /* pull mode without index can scan later on */
     if (demux->streaming) {
       GST_DEBUG_OBJECT (demux, "No matching seek entry in index");
@@ -2489,11 +2933,14 @@ gst_matroska_demux_seek_to_previous_keyframe (GstMatroskaDemux * demux)
   }
 
   if (!done) {
-    GstMatroskaIndex *entry;
+    GstMatroskaIndex entry;
 
-    entry = &g_array_index (demux->seek_index, GstMatroskaIndex,
+    /* copy, the index might be extended by a background scan */
+    GST_OBJECT_LOCK (demux);
+    entry = g_array_index (demux->seek_index, GstMatroskaIndex,
         --demux->seek_entry);
-    if (!gst_matroska_demux_move_to_entry (demux, entry, FALSE, TRUE))
+    GST_OBJECT_UNLOCK (demux);
+    if (!gst_matroska_demux_move_to_entry (demux, &entry, FALSE, TRUE))
       goto exit;
 
     ret = GST_FLOW_OK;
@@ -3194,6 +3641,7 @@ gst_matroska_demux_parse_blockgroup_or_simpleblock (GstMatroskaDemux * demux,
   gint stream_num = -1, n, laces = 0;
   guint size = 0;
   gint *lace_size = NULL;
+  GstBuffer **frames = NULL;
   gint64 time = 0;
   gint flags = 0;
   gint64 referenceblock = 0;
@@ -3529,6 +3977,10 @@ gst_matroska_demux_parse_blockgroup_or_simpleblock (GstMatroskaDemux * demux,
       goto done;
     }
 
+    if (stream->encodings != NULL && stream->encodings->len > 0)
+      frames = gst_matroska_demux_decode_laces (demux, stream, buf, laces,
+          lace_size, size, delta_unit, invisible_frame);
+
     for (n = 0; n < laces; n++) {
       GstBuffer *sub;
 
@@ -3576,20 +4028,25 @@ gst_matroska_demux_parse_blockgroup_or_simpleblock (GstMatroskaDemux * demux,
         }
       }
 
-      sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL,
-          gst_buffer_get_size (buf) - size, lace_size[n]);
-      GST_DEBUG_OBJECT (demux, "created subbuffer %p", sub);
+      if (frames) {
+        sub = frames[n];
+        frames[n] = NULL;
+      } else {
+        sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL,
+            gst_buffer_get_size (buf) - size, lace_size[n]);
+        GST_DEBUG_OBJECT (demux, "created subbuffer %p", sub);
 
-      if (delta_unit)
-        GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
-      else
-        GST_BUFFER_FLAG_UNSET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
+        if (delta_unit)
+          GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
+        else
+          GST_BUFFER_FLAG_UNSET (sub, GST_BUFFER_FLAG_DELTA_UNIT);
 
-      if (invisible_frame)
-        GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DECODE_ONLY);
+        if (invisible_frame)
+          GST_BUFFER_FLAG_SET (sub, GST_BUFFER_FLAG_DECODE_ONLY);
 
-      if (stream->encodings != NULL && stream->encodings->len > 0)
-        sub = gst_matroska_decode_buffer (stream, sub);
+        if (stream->encodings != NULL && stream->encodings->len > 0)
+          sub = gst_matroska_decode_buffer (stream, sub);
+      }
 
       if (sub == NULL) {
         GST_WARNING_OBJECT (demux, "Decoding buffer failed");
@@ -3794,6 +4251,13 @@ done:
     gst_buffer_unmap (buf, &map);
     gst_buffer_unref (buf);
   }
+  if (frames) {
+    for (n = 0; n < laces; n++) {
+      if (frames[n])
+        gst_buffer_unref (frames[n]);
+    }
+    g_free (frames);
+  }
   g_free (lace_size);
 
   return ret;
@@ -4345,6 +4809,8 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
                   == GST_MATROSKA_READ_STATE_HEADER)) {
             demux->common.state = GST_MATROSKA_READ_STATE_DATA;
             demux->first_cluster_offset = demux->common.offset;
+            if (!demux->streaming && !demux->common.index_parsed)
+              gst_matroska_demux_start_index_scan (demux);
             GST_DEBUG_OBJECT (demux, "signaling no more pads");
             gst_element_no_more_pads (GST_ELEMENT (demux));
             /* send initial segment - we wait till we know the first
@@ -4362,8 +4828,14 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
           }
           demux->seek_first = FALSE;
           /* record next cluster for recovery */
-          if (read != G_MAXUINT64)
+          if (read != G_MAXUINT64) {
             demux->next_cluster_offset = demux->cluster_offset + read;
+            /* pull the whole cluster in one go, so all its blocks are then
+             * handed out as sub-buffers of that single read */
+            if (!demux->streaming && needed + read <= MAX_CLUSTER_READ_AHEAD)
+              gst_matroska_read_common_peek_bytes (&demux->common,
+                  demux->common.offset, needed + read, NULL, NULL);
+          }
           /* eat cluster prefix */
           gst_matroska_demux_flush (demux, needed);
           break;
@@ -4451,6 +4923,11 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
             break;
           }
           GST_READ_CHECK (gst_matroska_demux_take (demux, read, &ebml));
+          /* real cues after all, these replace any scanned index */
+          if (demux->index_from_scan) {
+            gst_matroska_demux_stop_index_scan (demux);
+            demux->index_from_scan = FALSE;
+          }
           ret = gst_matroska_read_common_parse_index (&demux->common, &ebml);
           /* only push based; delayed index building */
           if (ret == GST_FLOW_OK
@@ -4908,6 +5385,7 @@ gst_matroska_demux_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
         gst_pad_start_task (sinkpad, (GstTaskFunction) gst_matroska_demux_loop,
             sinkpad, NULL);
       } else {
+        gst_matroska_demux_stop_index_scan (GST_MATROSKA_DEMUX (parent));
         gst_pad_stop_task (sinkpad);
       }
       return TRUE;
@@ -5809,6 +6287,21 @@ gst_matroska_demux_set_property (GObject * object,
       demux->max_gap_time = g_value_get_uint64 (value);
       GST_OBJECT_UNLOCK (demux);
       break;
+    case ARG_INDEX_SCAN:
+      GST_OBJECT_LOCK (demux);
+      demux->index_scan = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    case ARG_N_THREADS:
+      GST_OBJECT_LOCK (demux);
+      demux->n_threads = g_value_get_uint (value);
+      /* an existing pool keeps its threads with one thread, it is simply
+       * not used anymore */
+      if (demux->decode_pool && demux->n_threads > 1)
+        g_thread_pool_set_max_threads (demux->decode_pool,
+            demux->n_threads - 1, NULL);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -5830,6 +6323,16 @@ gst_matroska_demux_get_property (GObject * object,
       g_value_set_uint64 (value, demux->max_gap_time);
       GST_OBJECT_UNLOCK (demux);
       break;
+    case ARG_INDEX_SCAN:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_boolean (value, demux->index_scan);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    case ARG_N_THREADS:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_uint (value, demux->n_threads);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
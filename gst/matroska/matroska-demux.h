@@ -104,6 +104,19 @@ typedef struct _GstMatroskaDemux {
 
   /* for non-finalized files, with invalid segment duration */
   gboolean                 invalid_duration;
+
+  /* background cluster scan for files without cues */
+  gboolean                 index_scan;
+  GThread                 *index_scan_thread;
+  gboolean                 index_scan_stop;
+  gboolean                 index_from_scan;
+  gboolean                 index_scan_complete;
+  guint64                  index_scan_offset;
+  GstClockTime             index_scan_time;
+
+  /* parallel decompression of laced blocks */
+  guint                    n_threads;
+  GThreadPool             *decode_pool;
 } GstMatroskaDemux;
 
 typedef struct _GstMatroskaDemuxClass {
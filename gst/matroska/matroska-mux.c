@@ -68,13 +68,17 @@ enum
   ARG_WRITING_APP,
   ARG_DOCTYPE_VERSION,
   ARG_MIN_INDEX_INTERVAL,
-  ARG_STREAMABLE
+  ARG_STREAMABLE,
+  ARG_STREAMABLE_INDEX,
+  ARG_CLUSTER_DURATION
 };
 
 #define  DEFAULT_DOCTYPE_VERSION         2
 #define  DEFAULT_WRITING_APP             "GStreamer Matroska muxer"
 #define  DEFAULT_MIN_INDEX_INTERVAL      0
 #define  DEFAULT_STREAMABLE              FALSE
+#define  DEFAULT_STREAMABLE_INDEX        FALSE
+#define  DEFAULT_CLUSTER_DURATION        0
 
 /* WAVEFORMATEX is gst_riff_strf_auds + an extra guint16 extension size */
 #define WAVEFORMATEX_SIZE  (2 + sizeof (gst_riff_strf_auds))
@@ -331,6 +335,36 @@ gst_matroska_mux_class_init (GstMatroskaMuxClass * klass)
           "to be streamed and hence no indexes written or duration written.",
           DEFAULT_STREAMABLE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMatroskaMux:streamable-index
+   *
+   * For streamable output, hold back each cluster until it is complete and
+   * push it with its size filled in, and write Cues followed by a SeekHead
+   * pointing to them at the end of the stream. Nothing is ever rewritten,
+   * so this also works for pipes, while the result can still be indexed.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_STREAMABLE_INDEX,
+      g_param_spec_boolean ("streamable-index", "Streamable index",
+          "For streamable output, push complete clusters with known sizes "
+          "and write Cues at the end", DEFAULT_STREAMABLE_INDEX,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMatroskaMux:cluster-duration
+   *
+   * Start a new cluster once the current one spans this much time, in
+   * addition to starting one at every video keyframe. Together with
+   * #GstMatroskaMux:streamable-index this bounds the output latency.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_CLUSTER_DURATION,
+      g_param_spec_uint64 ("cluster-duration", "Cluster duration",
+          "Start a new cluster after this many nanoseconds (0 = only at "
+          "keyframes and when the cluster timecode range is used up)",
+          0, G_MAXUINT64, DEFAULT_CLUSTER_DURATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_matroska_mux_change_state);
@@ -469,6 +503,8 @@ gst_matroska_mux_init (GstMatroskaMux * mux, gpointer g_class)
   mux->writing_app = g_strdup (DEFAULT_WRITING_APP);
   mux->min_index_interval = DEFAULT_MIN_INDEX_INTERVAL;
   mux->streamable = DEFAULT_STREAMABLE;
+  mux->streamable_index = DEFAULT_STREAMABLE_INDEX;
+  mux->cluster_duration = DEFAULT_CLUSTER_DURATION;
 
   /* initialize internal variables */
   mux->index = NULL;
@@ -2857,6 +2893,117 @@ gst_matroska_mux_write_toc_entry_tags (GstMatroskaMux * mux,
 }
 #endif
 
+/**
+ * gst_matroska_mux_finish_cluster:
+ * @mux: #GstMatroskaMux
+ *
+ * Write the size of the current cluster and push it out. For streamable
+ * output this is only done where no seek is needed, otherwise the cluster
+ * keeps its unknown size.
+ */
+static void
+gst_matroska_mux_finish_cluster (GstMatroskaMux * mux)
+{
+  GstEbmlWrite *ebml = mux->ebml_write;
+
+  if (!mux->cluster)
+    return;
+
+  if (!mux->streamable) {
+    gst_ebml_write_master_finish (ebml, mux->cluster);
+  } else if (mux->streamable_index) {
+    if (gst_ebml_write_master_in_batch (ebml, mux->cluster))
+      gst_ebml_write_master_finish (ebml, mux->cluster);
+    else
+      GST_DEBUG_OBJECT (mux, "cluster already pushed, keeping unknown size");
+  }
+  gst_ebml_write_flush_batch (ebml);
+}
+
+/**
+ * gst_matroska_mux_write_cues:
+ * @mux: #GstMatroskaMux
+ *
+ * Write the Cues for the index collected so far at the current position.
+ */
+static void
+gst_matroska_mux_write_cues (GstMatroskaMux * mux)
+{
+  GstEbmlWrite *ebml = mux->ebml_write;
+  guint64 master, pointentry_master, trackpos_master;
+  guint n;
+
+  if (mux->index == NULL)
+    return;
+
+  mux->cues_pos = ebml->pos;
+  gst_ebml_write_set_cache (ebml, 12 + 41 * mux->num_indexes);
+  master = gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_CUES);
+
+  for (n = 0; n < mux->num_indexes; n++) {
+    GstMatroskaIndex *idx = &mux->index[n];
+
+    pointentry_master = gst_ebml_write_master_start (ebml,
+        GST_MATROSKA_ID_POINTENTRY);
+    gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUETIME,
+        idx->time / mux->time_scale);
+    trackpos_master = gst_ebml_write_master_start (ebml,
+        GST_MATROSKA_ID_CUETRACKPOSITIONS);
+    gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUETRACK, idx->track);
+    gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUECLUSTERPOSITION,
+        idx->pos - mux->segment_master);
+    gst_ebml_write_master_finish (ebml, trackpos_master);
+    gst_ebml_write_master_finish (ebml, pointentry_master);
+  }
+
+  gst_ebml_write_master_finish (ebml, master);
+  gst_ebml_write_flush_cache (ebml, FALSE, GST_CLOCK_TIME_NONE);
+}
+
+/**
+ * gst_matroska_mux_finish_streamable:
+ * @mux: #GstMatroskaMux
+ *
+ * Finish streamable output with an index: write the Cues and a SeekHead
+ * pointing to the top-level elements after the last cluster. All sizes
+ * are filled in within the cache, so nothing before the current position
+ * is rewritten.
+ */
+static void
+gst_matroska_mux_finish_streamable (GstMatroskaMux * mux)
+{
+  GstEbmlWrite *ebml = mux->ebml_write;
+  guint64 master, child;
+  guint32 ids[3];
+  guint64 positions[3];
+  guint i, n = 0;
+
+  gst_matroska_mux_finish_cluster (mux);
+  gst_matroska_mux_write_cues (mux);
+
+  ids[n] = GST_MATROSKA_ID_SEGMENTINFO;
+  positions[n++] = mux->info_pos;
+  ids[n] = GST_MATROSKA_ID_TRACKS;
+  positions[n++] = mux->tracks_pos;
+  if (mux->index != NULL) {
+    ids[n] = GST_MATROSKA_ID_CUES;
+    positions[n++] = mux->cues_pos;
+  }
+
+  GST_DEBUG_OBJECT (mux, "writing trailing seekhead with %u entries", n);
+  gst_ebml_write_set_cache (ebml, 0x80);
+  master = gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_SEEKHEAD);
+  for (i = 0; i < n; i++) {
+    child = gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_SEEKENTRY);
+    gst_ebml_write_uint (ebml, GST_MATROSKA_ID_SEEKID, ids[i]);
+    gst_ebml_write_uint (ebml, GST_MATROSKA_ID_SEEKPOSITION,
+        positions[i] - mux->segment_master);
+    gst_ebml_write_master_finish (ebml, child);
+  }
+  gst_ebml_write_master_finish (ebml, master);
+  gst_ebml_write_flush_cache (ebml, FALSE, GST_CLOCK_TIME_NONE);
+}
+
 /**
  * gst_matroska_mux_finish:
  * @mux: #GstMatroskaMux
@@ -2873,38 +3020,10 @@ gst_matroska_mux_finish (GstMatroskaMux * mux)
   const GstTagList *tags;
 
   /* finish last cluster */
-  if (mux->cluster) {
-    gst_ebml_write_master_finish (ebml, mux->cluster);
-  }
+  gst_matroska_mux_finish_cluster (mux);
 
   /* cues */
-  if (mux->index != NULL) {
-    guint n;
-    guint64 master, pointentry_master, trackpos_master;
-
-    mux->cues_pos = ebml->pos;
-    gst_ebml_write_set_cache (ebml, 12 + 41 * mux->num_indexes);
-    master = gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_CUES);
-
-    for (n = 0; n < mux->num_indexes; n++) {
-      GstMatroskaIndex *idx = &mux->index[n];
-
-      pointentry_master = gst_ebml_write_master_start (ebml,
-          GST_MATROSKA_ID_POINTENTRY);
-      gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUETIME,
-          idx->time / mux->time_scale);
-      trackpos_master = gst_ebml_write_master_start (ebml,
-          GST_MATROSKA_ID_CUETRACKPOSITIONS);
-      gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUETRACK, idx->track);
-      gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CUECLUSTERPOSITION,
-          idx->pos - mux->segment_master);
-      gst_ebml_write_master_finish (ebml, trackpos_master);
-      gst_ebml_write_master_finish (ebml, pointentry_master);
-    }
-
-    gst_ebml_write_master_finish (ebml, master);
-    gst_ebml_write_flush_cache (ebml, FALSE, GST_CLOCK_TIME_NONE);
-  }
+  gst_matroska_mux_write_cues (mux);
 
   /* tags */
   tags = gst_tag_setter_get_tag_list (GST_TAG_SETTER (mux));
@@ -3278,9 +3397,10 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
      * or when we may be reaching the limit of the relative timestamp */
     if (mux->cluster_time +
         mux->max_cluster_duration < GST_BUFFER_TIMESTAMP (buf)
+        || (mux->cluster_duration && mux->cluster_time +
+            mux->cluster_duration <= GST_BUFFER_TIMESTAMP (buf))
         || is_video_keyframe || mux->force_key_unit_event) {
-      if (!mux->streamable)
-        gst_ebml_write_master_finish (ebml, mux->cluster);
+      gst_matroska_mux_finish_cluster (mux);
 
       /* Forward the GstForceKeyUnit event after finishing the cluster */
       if (mux->force_key_unit_event) {
@@ -3290,6 +3410,10 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
 
       mux->prev_cluster_size = ebml->pos - mux->cluster_pos;
       mux->cluster_pos = ebml->pos;
+      /* collect the whole cluster and push it at once, its size is then
+       * filled in without a seek */
+      if (!mux->streamable || mux->streamable_index)
+        gst_ebml_write_start_batch (ebml);
       gst_ebml_write_set_cache (ebml, 0x20);
       mux->cluster =
           gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_CLUSTER);
@@ -3308,6 +3432,8 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
     /* first cluster */
 
     mux->cluster_pos = ebml->pos;
+    if (!mux->streamable || mux->streamable_index)
+      gst_ebml_write_start_batch (ebml);
     gst_ebml_write_set_cache (ebml, 0x20);
     mux->cluster = gst_ebml_write_master_start (ebml, GST_MATROSKA_ID_CLUSTER);
     gst_ebml_write_uint (ebml, GST_MATROSKA_ID_CLUSTERTIMECODE,
@@ -3328,7 +3454,7 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
    * the block in the cluster which contains the timestamp, should also work
    * for files with multiple audio tracks.
    */
-  if (!mux->streamable &&
+  if ((!mux->streamable || mux->streamable_index) &&
       (is_video_keyframe ||
           ((collect_pad->track->type == GST_MATROSKA_TRACK_TYPE_AUDIO) &&
               (mux->num_streams == 1)))) {
@@ -3471,6 +3597,8 @@ gst_matroska_mux_handle_buffer (GstCollectPads * pads, GstCollectData * data,
     GST_DEBUG_OBJECT (mux, "No best pad. Finishing...");
     if (!mux->streamable) {
       gst_matroska_mux_finish (mux);
+    } else if (mux->streamable_index) {
+      gst_matroska_mux_finish_streamable (mux);
     } else {
       GST_DEBUG_OBJECT (mux, "... but streamable, nothing to finish");
     }
@@ -3588,6 +3716,12 @@ gst_matroska_mux_set_property (GObject * object,
     case ARG_STREAMABLE:
       mux->streamable = g_value_get_boolean (value);
       break;
+    case ARG_STREAMABLE_INDEX:
+      mux->streamable_index = g_value_get_boolean (value);
+      break;
+    case ARG_CLUSTER_DURATION:
+      mux->cluster_duration = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3616,6 +3750,12 @@ gst_matroska_mux_get_property (GObject * object,
     case ARG_STREAMABLE:
       g_value_set_boolean (value, mux->streamable);
       break;
+    case ARG_STREAMABLE_INDEX:
+      g_value_set_boolean (value, mux->streamable_index);
+      break;
+    case ARG_CLUSTER_DURATION:
+      g_value_set_uint64 (value, mux->cluster_duration);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -100,6 +100,8 @@ typedef struct _GstMatroskaMux {
   guint          num_indexes;
   GstClockTimeDiff min_index_interval;
   gboolean       streamable;
+  gboolean       streamable_index;
+  GstClockTime   cluster_duration;
  
   /* timescale in the file */
   guint64        time_scale;
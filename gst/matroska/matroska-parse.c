@@ -81,9 +81,12 @@ enum
 {
   ARG_0,
   ARG_METADATA,
-  ARG_STREAMINFO
+  ARG_STREAMINFO,
+  ARG_PASSTHROUGH
 };
 
+#define DEFAULT_PASSTHROUGH FALSE
+
 static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -104,6 +107,8 @@ static GstFlowReturn gst_matroska_parse_parse_id (GstMatroskaParse * parse,
 /* element functions */
 //static void gst_matroska_parse_loop (GstPad * pad);
 
+static GstFlowReturn gst_matroska_parse_output (GstMatroskaParse * parse,
+    GstBuffer * buffer, gboolean keyframe);
 static gboolean gst_matroska_parse_element_send_event (GstElement * element,
     GstEvent * event);
 static gboolean gst_matroska_parse_element_query (GstElement * element,
@@ -133,6 +138,10 @@ static GstIndex *gst_matroska_parse_get_index (GstElement * element);
 
 /* stream methods */
 static void gst_matroska_parse_reset (GstElement * element);
+static void gst_matroska_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_matroska_parse_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static gboolean perform_seek_to_offset (GstMatroskaParse * parse,
     guint64 offset);
 
@@ -170,6 +179,22 @@ gst_matroska_parse_class_init (GstMatroskaParseClass * klass)
       "Matroska parser");
 
   gobject_class->finalize = gst_matroska_parse_finalize;
+  gobject_class->set_property = gst_matroska_parse_set_property;
+  gobject_class->get_property = gst_matroska_parse_get_property;
+
+  /**
+   * GstMatroskaParse:passthrough:
+   *
+   * Forward the blocks of the Clusters as they are without parsing them.
+   * The data is passed on without copies and timestamps are only updated
+   * per Cluster.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_PASSTHROUGH,
+      g_param_spec_boolean ("passthrough", "Passthrough",
+          "Forward the Cluster contents without parsing the blocks",
+          DEFAULT_PASSTHROUGH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_matroska_parse_change_state);
@@ -228,10 +253,44 @@ gst_matroska_parse_init (GstMatroskaParse * parse)
 
   GST_OBJECT_FLAG_SET (parse, GST_ELEMENT_FLAG_INDEXABLE);
 
+  parse->passthrough = DEFAULT_PASSTHROUGH;
+
   /* finish off */
   gst_matroska_parse_reset (GST_ELEMENT (parse));
 }
 
+static void
+gst_matroska_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMatroskaParse *parse = GST_MATROSKA_PARSE (object);
+
+  switch (prop_id) {
+    case ARG_PASSTHROUGH:
+      parse->passthrough = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_matroska_parse_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstMatroskaParse *parse = GST_MATROSKA_PARSE (object);
+
+  switch (prop_id) {
+    case ARG_PASSTHROUGH:
+      g_value_set_boolean (value, parse->passthrough);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_matroska_track_free (GstMatroskaTrackContext * track)
 {
@@ -2386,7 +2445,7 @@ gst_matroska_parse_take (GstMatroskaParse * parse, guint64 bytes,
     goto exit;
   }
   if (gst_adapter_available (parse->common.adapter) >= bytes)
-    buffer = gst_adapter_take_buffer (parse->common.adapter, bytes);
+    buffer = gst_adapter_take_buffer_fast (parse->common.adapter, bytes);
   else
     ret = GST_FLOW_EOS;
   if (G_LIKELY (buffer)) {
@@ -2398,6 +2457,33 @@ exit:
   return ret;
 }
 
+/* forwards @bytes from the input stream at the current offset as they are,
+ * the buffer shares the memory of the input buffers.
+ * Returns EOS if insufficient available,
+ * ERROR if too much was attempted to read. */
+static GstFlowReturn
+gst_matroska_parse_forward (GstMatroskaParse * parse, guint64 bytes)
+{
+  GstBuffer *buffer;
+  GstFlowReturn ret;
+
+  ret = gst_matroska_parse_check_read_size (parse, bytes);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    return ret;
+
+  if (gst_adapter_available (parse->common.adapter) < bytes)
+    return GST_FLOW_EOS;
+
+  GST_LOG_OBJECT (parse, "forwarding %" G_GUINT64_FORMAT " bytes", bytes);
+  buffer = gst_adapter_take_buffer_fast (parse->common.adapter, bytes);
+  parse->common.offset += bytes;
+
+  ret = gst_matroska_parse_output (parse, buffer, FALSE);
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
 static void
 gst_matroska_parse_check_seekability (GstMatroskaParse * parse)
 {
@@ -2713,6 +2799,9 @@ gst_matroska_parse_parse_id (GstMatroskaParse * parse, guint32 id,
             goto parse_failed;
           GST_DEBUG_OBJECT (parse, "ClusterTimeCode: %" G_GUINT64_FORMAT, num);
           parse->cluster_time = num;
+          /* the blocks are not parsed, they go out with the cluster time */
+          if (parse->passthrough)
+            parse->last_timestamp = num * parse->common.time_scale;
 #if 0
           if (parse->common.element_index) {
             if (parse->common.element_index_writer_id == -1)
@@ -2735,6 +2824,8 @@ gst_matroska_parse_parse_id (GstMatroskaParse * parse, guint32 id,
         case GST_MATROSKA_ID_BLOCKGROUP:
           if (!gst_matroska_parse_seek_block (parse))
             goto skip;
+          if (parse->passthrough)
+            goto forward;
           GST_READ_CHECK (gst_matroska_parse_take (parse, read, &ebml));
           DEBUG_ELEMENT_START (parse, &ebml, "BlockGroup");
           if ((ret = gst_ebml_read_master (&ebml, &id)) == GST_FLOW_OK) {
@@ -2747,6 +2838,8 @@ gst_matroska_parse_parse_id (GstMatroskaParse * parse, guint32 id,
         case GST_MATROSKA_ID_SIMPLEBLOCK:
           if (!gst_matroska_parse_seek_block (parse))
             goto skip;
+          if (parse->passthrough)
+            goto forward;
           GST_READ_CHECK (gst_matroska_parse_take (parse, read, &ebml));
           DEBUG_ELEMENT_START (parse, &ebml, "SimpleBlock");
           ret = gst_matroska_parse_parse_blockgroup_or_simpleblock (parse,
@@ -2814,8 +2907,8 @@ gst_matroska_parse_parse_id (GstMatroskaParse * parse, guint32 id,
         default:
         skip:
           GST_DEBUG_OBJECT (parse, "skipping Element 0x%x", id);
-          GST_READ_CHECK (gst_matroska_parse_take (parse, read, &ebml));
-          gst_matroska_parse_output (parse, ebml.buf, FALSE);
+        forward:
+          GST_READ_CHECK (gst_matroska_parse_forward (parse, read));
           break;
       }
       break;
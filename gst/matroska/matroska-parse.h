@@ -59,6 +59,7 @@ typedef struct _GstMatroskaParse {
   GstBuffer *streamheader;
   gboolean pushed_headers;
   GstClockTime last_timestamp;
+  gboolean passthrough;
 
   /* state */
   //gboolean                 streaming;
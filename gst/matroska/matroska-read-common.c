@@ -69,6 +69,39 @@ typedef struct
 } TargetTypeContext;
 
 
+#ifdef HAVE_ZLIB
+static void
+gst_matroska_zstream_free (gpointer data)
+{
+  z_stream *zstream = data;
+
+  inflateEnd (zstream);
+  g_free (zstream);
+}
+
+/* inflate contexts are kept per thread and reset for every block, which is
+ * a lot cheaper than setting up a new one each time */
+static GPrivate zstream_key = G_PRIVATE_INIT (gst_matroska_zstream_free);
+
+static z_stream *
+gst_matroska_get_zstream (void)
+{
+  z_stream *zstream = g_private_get (&zstream_key);
+
+  if (zstream)
+    return inflateReset (zstream) == Z_OK ? zstream : NULL;
+
+  zstream = g_new0 (z_stream, 1);
+  if (inflateInit (zstream) != Z_OK) {
+    g_free (zstream);
+    return NULL;
+  }
+  g_private_set (&zstream_key, zstream);
+
+  return zstream;
+}
+#endif
+
 static gboolean
 gst_matroska_decompress_data (GstMatroskaTrackEncoding * enc,
     gpointer * data_out, gsize * size_out,
@@ -83,46 +116,42 @@ gst_matroska_decompress_data (GstMatroskaTrackEncoding * enc,
   if (algo == GST_MATROSKA_TRACK_COMPRESSION_ALGORITHM_ZLIB) {
 #ifdef HAVE_ZLIB
     /* zlib encoded data */
-    z_stream zstream;
+    z_stream *zstream;
     guint orig_size;
     int result;
 
     orig_size = size;
-    zstream.zalloc = (alloc_func) 0;
-    zstream.zfree = (free_func) 0;
-    zstream.opaque = (voidpf) 0;
-    if (inflateInit (&zstream) != Z_OK) {
+    zstream = gst_matroska_get_zstream ();
+    if (zstream == NULL) {
       GST_WARNING ("zlib initialization failed.");
       ret = FALSE;
       goto out;
     }
-    zstream.next_in = (Bytef *) data;
-    zstream.avail_in = orig_size;
+    zstream->next_in = (Bytef *) data;
+    zstream->avail_in = orig_size;
     new_size = orig_size;
     new_data = g_malloc (new_size);
-    zstream.avail_out = new_size;
-    zstream.next_out = (Bytef *) new_data;
+    zstream->avail_out = new_size;
+    zstream->next_out = (Bytef *) new_data;
 
     do {
-      result = inflate (&zstream, Z_NO_FLUSH);
+      result = inflate (zstream, Z_NO_FLUSH);
       if (result != Z_OK && result != Z_STREAM_END) {
         GST_WARNING ("zlib decompression failed.");
         g_free (new_data);
-        inflateEnd (&zstream);
         break;
       }
       new_size += 4000;
       new_data = g_realloc (new_data, new_size);
-      zstream.next_out = (Bytef *) (new_data + zstream.total_out);
-      zstream.avail_out += 4000;
-    } while (zstream.avail_in != 0 && result != Z_STREAM_END);
+      zstream->next_out = (Bytef *) (new_data + zstream->total_out);
+      zstream->avail_out += 4000;
+    } while (zstream->avail_in != 0 && result != Z_STREAM_END);
 
     if (result != Z_STREAM_END) {
       ret = FALSE;
       goto out;
     } else {
-      new_size = zstream.total_out;
-      inflateEnd (&zstream);
+      new_size = zstream->total_out;
     }
 #else
     GST_WARNING ("zlib encoded tracks not supported.");
@@ -359,6 +388,33 @@ gst_matroska_index_compare (GstMatroskaIndex * i1, GstMatroskaIndex * i2)
     return 0;
 }
 
+/* inserts @idx into the sorted @index, cues normally come in order so this
+ * mostly appends */
+static void
+gst_matroska_index_insert (GArray * index, GstMatroskaIndex * idx)
+{
+  guint lo = 0, hi = index->len;
+
+  if (hi == 0
+      || gst_matroska_index_compare (&g_array_index (index, GstMatroskaIndex,
+              hi - 1), idx) <= 0) {
+    g_array_append_vals (index, idx, 1);
+    return;
+  }
+
+  /* first entry sorting after @idx */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (gst_matroska_index_compare (&g_array_index (index, GstMatroskaIndex,
+                mid), idx) <= 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  g_array_insert_vals (index, lo, idx, 1);
+}
+
 gint
 gst_matroska_index_seek_find (GstMatroskaIndex * i1, GstClockTime * time,
     gpointer user_data)
@@ -1399,13 +1455,13 @@ gst_matroska_read_common_parse_index_cuetrack (GstMatroskaReadCommon * common,
         }
 
         GST_DEBUG_OBJECT (common, "CueBlockNumber: %" G_GUINT64_FORMAT, num);
-        idx.block = num;
 
         /* mild sanity check, disregard strange cases ... */
-        if (idx.block > G_MAXUINT16) {
+        if (num > G_MAXUINT16) {
           GST_DEBUG_OBJECT (common, "... looks suspicious, ignoring");
-          idx.block = 1;
+          num = 1;
         }
+        idx.block = num;
         break;
       }
 
@@ -1506,9 +1562,11 @@ gst_matroska_read_common_parse_index_pointentry (GstMatroskaReadCommon *
       g_array_remove_range (common->index, common->index->len - nentries,
           nentries);
     } else {
-      gint i;
+      GstMatroskaIndex *entries;
+      gboolean sorted = TRUE;
+      guint i, first = common->index->len - nentries;
 
-      for (i = common->index->len - nentries; i < common->index->len; i++) {
+      for (i = first; i < common->index->len; i++) {
         GstMatroskaIndex *idx =
             &g_array_index (common->index, GstMatroskaIndex, i);
 
@@ -1516,6 +1574,36 @@ gst_matroska_read_common_parse_index_pointentry (GstMatroskaReadCommon *
         GST_DEBUG_OBJECT (common, "Index entry: pos=%" G_GUINT64_FORMAT
             ", time=%" GST_TIME_FORMAT ", track=%u, block=%u", idx->pos,
             GST_TIME_ARGS (idx->time), (guint) idx->track, (guint) idx->block);
+
+        if (i > 0 && gst_matroska_index_compare (idx - 1, idx) > 0)
+          sorted = FALSE;
+      }
+
+      /* keep the index sorted by time while building it, moving out of order
+       * entries into place; also file them in their track's index */
+      entries = &g_array_index (common->index, GstMatroskaIndex, first);
+      if (!sorted)
+        entries = g_memdup (entries, nentries * sizeof (GstMatroskaIndex));
+      for (i = 0; i < nentries; i++) {
+        GstMatroskaTrackContext *ctx;
+        gint track_num;
+
+        track_num = gst_matroska_read_common_stream_from_num (common,
+            entries[i].track);
+        if (track_num == -1)
+          continue;
+
+        ctx = g_ptr_array_index (common->src, track_num);
+        if (ctx->index_table == NULL)
+          ctx->index_table =
+              g_array_sized_new (FALSE, FALSE, sizeof (GstMatroskaIndex), 128);
+        gst_matroska_index_insert (ctx->index_table, &entries[i]);
+      }
+      if (!sorted) {
+        g_array_set_size (common->index, first);
+        for (i = 0; i < nentries; i++)
+          gst_matroska_index_insert (common->index, &entries[i]);
+        g_free (entries);
       }
     }
   } else {
@@ -1553,7 +1641,6 @@ gst_matroska_read_common_parse_index (GstMatroskaReadCommon * common,
 {
   guint32 id;
   GstFlowReturn ret = GST_FLOW_OK;
-  guint i;
 
   if (common->index)
     g_array_free (common->index, TRUE);
@@ -1584,62 +1671,6 @@ gst_matroska_read_common_parse_index (GstMatroskaReadCommon * common,
   }
   DEBUG_ELEMENT_STOP (common, ebml, "Cues", ret);
 
-  /* Sort index by time, smallest time first, for easier searching */
-  g_array_sort (common->index, (GCompareFunc) gst_matroska_index_compare);
-
-  /* Now sort the track specific index entries into their own arrays */
-  for (i = 0; i < common->index->len; i++) {
-    GstMatroskaIndex *idx = &g_array_index (common->index, GstMatroskaIndex,
-        i);
-    gint track_num;
-    GstMatroskaTrackContext *ctx;
-
-#if 0
-    if (common->element_index) {
-      gint writer_id;
-
-      if (idx->track != 0 &&
-          (track_num =
-              gst_matroska_read_common_stream_from_num (common,
-                  idx->track)) != -1) {
-        ctx = g_ptr_array_index (common->src, track_num);
-
-        if (ctx->index_writer_id == -1)
-          gst_index_get_writer_id (common->element_index,
-              GST_OBJECT (ctx->pad), &ctx->index_writer_id);
-        writer_id = ctx->index_writer_id;
-      } else {
-        if (common->element_index_writer_id == -1)
-          gst_index_get_writer_id (common->element_index, GST_OBJECT (common),
-              &common->element_index_writer_id);
-        writer_id = common->element_index_writer_id;
-      }
-
-      GST_LOG_OBJECT (common, "adding association %" GST_TIME_FORMAT "-> %"
-          G_GUINT64_FORMAT " for writer id %d", GST_TIME_ARGS (idx->time),
-          idx->pos, writer_id);
-      gst_index_add_association (common->element_index, writer_id,
-          GST_ASSOCIATION_FLAG_KEY_UNIT, GST_FORMAT_TIME, idx->time,
-          GST_FORMAT_BYTES, idx->pos + common->ebml_segment_start, NULL);
-    }
-#endif
-
-    if (idx->track == 0)
-      continue;
-
-    track_num = gst_matroska_read_common_stream_from_num (common, idx->track);
-    if (track_num == -1)
-      continue;
-
-    ctx = g_ptr_array_index (common->src, track_num);
-
-    if (ctx->index_table == NULL)
-      ctx->index_table =
-          g_array_sized_new (FALSE, FALSE, sizeof (GstMatroskaIndex), 128);
-
-    g_array_append_vals (ctx->index_table, idx, 1);
-  }
-
   common->index_parsed = TRUE;
 
   /* sanity check; empty index normalizes to no index */
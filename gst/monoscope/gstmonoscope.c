@@ -44,7 +44,7 @@
 #include "gstmonoscope.h"
 #include "monoscope.h"
 
-GST_DEBUG_CATEGORY_STATIC (monoscope_debug);
+GST_DEBUG_CATEGORY (monoscope_debug);
 #define GST_CAT_DEFAULT monoscope_debug
 
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
@@ -128,19 +128,16 @@ gst_monoscope_init (GstMonoscope * monoscope)
       GST_DEBUG_FUNCPTR (gst_monoscope_src_event));
   gst_element_add_pad (GST_ELEMENT (monoscope), monoscope->srcpad);
 
-  monoscope->adapter = gst_adapter_new ();
-  monoscope->next_ts = GST_CLOCK_TIME_NONE;
-  monoscope->bps = sizeof (gint16);
+  gst_visual_render_init (&monoscope->render, GST_ELEMENT (monoscope));
 
   /* reset the initial video state */
   monoscope->width = 256;
   monoscope->height = 128;
-  monoscope->fps_num = 25;      /* desired frame rate */
-  monoscope->fps_denom = 1;
   monoscope->visstate = NULL;
 
   /* reset the initial audio state */
-  monoscope->rate = GST_AUDIO_DEF_RATE;
+  gst_visual_render_set_audio (&monoscope->render, GST_AUDIO_DEF_RATE,
+      sizeof (gint16));
 }
 
 static void
@@ -151,7 +148,7 @@ gst_monoscope_finalize (GObject * object)
   if (monoscope->visstate)
     monoscope_close (monoscope->visstate);
 
-  g_object_unref (monoscope->adapter);
+  gst_visual_render_clear (&monoscope->render);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -159,27 +156,21 @@ gst_monoscope_finalize (GObject * object)
 static void
 gst_monoscope_reset (GstMonoscope * monoscope)
 {
-  monoscope->next_ts = GST_CLOCK_TIME_NONE;
-
-  gst_adapter_clear (monoscope->adapter);
-  gst_segment_init (&monoscope->segment, GST_FORMAT_UNDEFINED);
-
-  GST_OBJECT_LOCK (monoscope);
-  monoscope->proportion = 1.0;
-  monoscope->earliest_time = -1;
-  GST_OBJECT_UNLOCK (monoscope);
+  gst_visual_render_reset (&monoscope->render);
 }
 
 static gboolean
 gst_monoscope_sink_setcaps (GstMonoscope * monoscope, GstCaps * caps)
 {
   GstStructure *structure;
+  gint rate = 0;
 
   structure = gst_caps_get_structure (caps, 0);
 
-  gst_structure_get_int (structure, "rate", &monoscope->rate);
+  gst_structure_get_int (structure, "rate", &rate);
+  gst_visual_render_set_audio (&monoscope->render, rate, sizeof (gint16));
 
-  GST_DEBUG_OBJECT (monoscope, "sample rate = %d", monoscope->rate);
+  GST_DEBUG_OBJECT (monoscope, "sample rate = %d", rate);
   return TRUE;
 }
 
@@ -187,25 +178,21 @@ static gboolean
 gst_monoscope_src_setcaps (GstMonoscope * monoscope, GstCaps * caps)
 {
   GstStructure *structure;
+  gint fps_n = 25, fps_d = 1;
   gboolean res;
 
   structure = gst_caps_get_structure (caps, 0);
 
   gst_structure_get_int (structure, "width", &monoscope->width);
   gst_structure_get_int (structure, "height", &monoscope->height);
-  gst_structure_get_fraction (structure, "framerate", &monoscope->fps_num,
-      &monoscope->fps_denom);
+  gst_structure_get_fraction (structure, "framerate", &fps_n, &fps_d);
 
   monoscope->outsize = monoscope->width * monoscope->height * 4;
-  monoscope->frame_duration = gst_util_uint64_scale_int (GST_SECOND,
-      monoscope->fps_denom, monoscope->fps_num);
-  monoscope->spf =
-      gst_util_uint64_scale_int (monoscope->rate, monoscope->fps_denom,
-      monoscope->fps_num);
+  gst_visual_render_set_video (&monoscope->render, fps_n, fps_d);
 
   GST_DEBUG_OBJECT (monoscope, "dimension %dx%d, framerate %d/%d, spf %d",
-      monoscope->width, monoscope->height, monoscope->fps_num,
-      monoscope->fps_denom, monoscope->spf);
+      monoscope->width, monoscope->height, fps_n, fps_d,
+      monoscope->render.spf);
 
   if (monoscope->visstate) {
     monoscope_close (monoscope->visstate);
@@ -225,10 +212,7 @@ gst_monoscope_src_negotiate (GstMonoscope * monoscope)
   GstCaps *othercaps, *target;
   GstStructure *structure;
   GstCaps *templ;
-  GstQuery *query;
-  GstBufferPool *pool;
-  GstStructure *config;
-  guint size, min, max;
+  gboolean res;
 
   templ = gst_pad_get_pad_template_caps (monoscope->srcpad);
 
@@ -257,43 +241,13 @@ gst_monoscope_src_negotiate (GstMonoscope * monoscope)
 
   gst_monoscope_src_setcaps (monoscope, target);
 
-  /* try to get a bufferpool now */
   /* find a pool for the negotiated caps now */
-  query = gst_query_new_allocation (target, TRUE);
-
-  if (!gst_pad_peer_query (monoscope->srcpad, query)) {
-  }
-
-  if (gst_query_get_n_allocation_pools (query) > 0) {
-    /* we got configuration from our peer, parse them */
-    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
-  } else {
-    pool = NULL;
-    size = monoscope->outsize;
-    min = max = 0;
-  }
-
-  if (pool == NULL) {
-    /* we did not get a pool, make one ourselves then */
-    pool = gst_buffer_pool_new ();
-  }
-
-  config = gst_buffer_pool_get_config (pool);
-  gst_buffer_pool_config_set_params (config, target, size, min, max);
-  gst_buffer_pool_set_config (pool, config);
-
-  if (monoscope->pool) {
-    gst_buffer_pool_set_active (monoscope->pool, TRUE);
-    gst_object_unref (monoscope->pool);
-  }
-  monoscope->pool = pool;
-
-  /* and activate */
-  gst_buffer_pool_set_active (pool, TRUE);
+  res = gst_visual_render_setup_pool (&monoscope->render, monoscope->srcpad,
+      target, monoscope->outsize);
 
   gst_caps_unref (target);
 
-  return TRUE;
+  return res;
 
 no_format:
   {
@@ -323,10 +277,12 @@ gst_monoscope_chain (GstPad * pad, GstObject * parent, GstBuffer * inbuf)
 {
   GstFlowReturn flow_ret = GST_FLOW_OK;
   GstMonoscope *monoscope;
+  GstClockTime timestamp;
+  guint n_samples;
 
   monoscope = GST_MONOSCOPE (parent);
 
-  if (monoscope->rate == 0) {
+  if (monoscope->render.rate == 0) {
     gst_buffer_unref (inbuf);
     flow_ret = GST_FLOW_NOT_NEGOTIATED;
     goto out;
@@ -339,73 +295,31 @@ gst_monoscope_chain (GstPad * pad, GstObject * parent, GstBuffer * inbuf)
     goto out;
   }
 
-  /* don't try to combine samples from discont buffer */
-  if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_DISCONT)) {
-    gst_adapter_clear (monoscope->adapter);
-    monoscope->next_ts = GST_CLOCK_TIME_NONE;
-  }
-
-  /* Match timestamps from the incoming audio */
-  if (GST_BUFFER_TIMESTAMP (inbuf) != GST_CLOCK_TIME_NONE)
-    monoscope->next_ts = GST_BUFFER_TIMESTAMP (inbuf);
-
-  GST_LOG_OBJECT (monoscope,
-      "in buffer has %" G_GSIZE_FORMAT " samples, ts=%" GST_TIME_FORMAT,
-      gst_buffer_get_size (inbuf) / monoscope->bps,
-      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (inbuf)));
-
-  gst_adapter_push (monoscope->adapter, inbuf);
+  gst_visual_render_push (&monoscope->render, inbuf);
   inbuf = NULL;
 
   /* Collect samples until we have enough for an output frame */
-  while (flow_ret == GST_FLOW_OK) {
+  while (flow_ret == GST_FLOW_OK &&
+      gst_visual_render_next_frame (&monoscope->render, 0, &timestamp,
+          &n_samples)) {
     gint16 *samples;
     GstBuffer *outbuf = NULL;
-    guint32 *pixels, avail, bytesperframe;
-
-    avail = gst_adapter_available (monoscope->adapter);
-    GST_LOG_OBJECT (monoscope, "bytes avail now %u", avail);
+    guint32 *pixels;
 
-    bytesperframe = monoscope->spf * monoscope->bps;
-    if (avail < bytesperframe)
-      break;
-
-    /* FIXME: something is wrong with QoS, we are skipping way too much
-     * stuff even with very low CPU loads */
-#if 0
-    if (monoscope->next_ts != -1) {
-      gboolean need_skip;
-      gint64 qostime;
-
-      qostime = gst_segment_to_running_time (&monoscope->segment,
-          GST_FORMAT_TIME, monoscope->next_ts);
-
-      GST_OBJECT_LOCK (monoscope);
-      /* check for QoS, don't compute buffers that are known to be late */
-      need_skip =
-          GST_CLOCK_TIME_IS_VALID (monoscope->earliest_time) &&
-          qostime <= monoscope->earliest_time;
-      GST_OBJECT_UNLOCK (monoscope);
-
-      if (need_skip) {
-        GST_WARNING_OBJECT (monoscope,
-            "QoS: skip ts: %" GST_TIME_FORMAT ", earliest: %" GST_TIME_FORMAT,
-            GST_TIME_ARGS (qostime), GST_TIME_ARGS (monoscope->earliest_time));
-        goto skip;
-      }
-    }
-#endif
+    if (gst_visual_render_is_late (&monoscope->render, timestamp))
+      goto skip;
 
-    samples = (gint16 *) gst_adapter_map (monoscope->adapter, bytesperframe);
+    samples = (gint16 *) gst_adapter_map (monoscope->render.adapter,
+        n_samples * monoscope->render.bps);
 
-    if (monoscope->spf < 512) {
+    if (n_samples < 512) {
       gint16 in_data[512], i;
 
       for (i = 0; i < 512; ++i) {
         gdouble off;
 
-        off = ((gdouble) i * (gdouble) monoscope->spf) / 512.0;
-        in_data[i] = samples[MIN ((guint) off, monoscope->spf)];
+        off = ((gdouble) i * (gdouble) n_samples) / 512.0;
+        in_data[i] = samples[MIN ((guint) off, n_samples - 1)];
       }
       pixels = monoscope_update (monoscope->visstate, in_data);
     } else {
@@ -413,28 +327,20 @@ gst_monoscope_chain (GstPad * pad, GstObject * parent, GstBuffer * inbuf)
       pixels = monoscope_update (monoscope->visstate, samples);
     }
 
-    GST_LOG_OBJECT (monoscope, "allocating output buffer");
-    flow_ret = gst_buffer_pool_acquire_buffer (monoscope->pool, &outbuf, NULL);
+    flow_ret = gst_visual_render_acquire_buffer (&monoscope->render,
+        timestamp, &outbuf);
     if (flow_ret != GST_FLOW_OK) {
-      gst_adapter_unmap (monoscope->adapter);
+      gst_adapter_unmap (monoscope->render.adapter);
       goto out;
     }
 
     gst_buffer_fill (outbuf, 0, pixels, monoscope->outsize);
-
-    GST_BUFFER_TIMESTAMP (outbuf) = monoscope->next_ts;
-    GST_BUFFER_DURATION (outbuf) = monoscope->frame_duration;
+    gst_adapter_unmap (monoscope->render.adapter);
 
     flow_ret = gst_pad_push (monoscope->srcpad, outbuf);
 
-#if 0
   skip:
-#endif
-
-    if (GST_CLOCK_TIME_IS_VALID (monoscope->next_ts))
-      monoscope->next_ts += monoscope->frame_duration;
-
-    gst_adapter_flush (monoscope->adapter, bytesperframe);
+    gst_visual_render_finish_frame (&monoscope->render, n_samples);
   }
 
 out:
@@ -459,15 +365,9 @@ gst_monoscope_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       res = gst_pad_push_event (monoscope->srcpad, event);
       break;
     case GST_EVENT_SEGMENT:
-    {
-      /* the newsegment values are used to clip the input samples
-       * and to convert the incomming timestamps to running time so
-       * we can do QoS */
-      gst_event_copy_segment (event, &monoscope->segment);
-
+      gst_visual_render_set_segment (&monoscope->render, event);
       res = gst_pad_push_event (monoscope->srcpad, event);
       break;
-    }
     case GST_EVENT_CAPS:
     {
       GstCaps *caps;
@@ -495,28 +395,11 @@ gst_monoscope_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   monoscope = GST_MONOSCOPE (parent);
 
   switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_QOS:{
-      gdouble proportion;
-      GstClockTimeDiff diff;
-      GstClockTime timestamp;
-
-      gst_event_parse_qos (event, NULL, &proportion, &diff, &timestamp);
-
+    case GST_EVENT_QOS:
       /* save stuff for the _chain() function */
-      GST_OBJECT_LOCK (monoscope);
-      monoscope->proportion = proportion;
-      if (diff >= 0)
-        /* we're late, this is a good estimate for next displayable
-         * frame (see part-qos.txt) */
-        monoscope->earliest_time =
-            timestamp + 2 * diff + monoscope->frame_duration;
-      else
-        monoscope->earliest_time = timestamp + diff;
-      GST_OBJECT_UNLOCK (monoscope);
-
+      gst_visual_render_update_qos (&monoscope->render, event);
       res = gst_pad_push_event (monoscope->sinkpad, event);
       break;
-    }
     default:
       res = gst_pad_push_event (monoscope->sinkpad, event);
       break;
@@ -545,10 +428,7 @@ gst_monoscope_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      if (monoscope->pool) {
-        gst_buffer_pool_set_active (monoscope->pool, FALSE);
-        gst_object_replace ((GstObject **) & monoscope->pool, NULL);
-      }
+      gst_visual_render_release_pool (&monoscope->render);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
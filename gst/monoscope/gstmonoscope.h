@@ -25,7 +25,7 @@
 G_BEGIN_DECLS
 
 #include <gst/gst.h>
-#include <gst/base/gstadapter.h>
+#include <gst/visual/gstvisualrender.h>
 
 #define GST_TYPE_MONOSCOPE            (gst_monoscope_get_type())
 #define GST_MONOSCOPE(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_MONOSCOPE,GstMonoscope))
@@ -44,24 +44,10 @@ struct _GstMonoscope
   GstPad      *sinkpad;
   GstPad      *srcpad;
 
-  GstAdapter  *adapter;
-
-  guint64      next_ts;             /* expected timestamp of the next frame */
-  guint64      frame_duration;      /* video frame duration    */
-  gint         rate;                /* sample rate             */
-  guint        bps;                 /* bytes per sample        */
-  guint        spf;                 /* samples per video frame */
-  GstBufferPool *pool;
-
-  GstSegment   segment;
-
-  /* QoS stuff *//* with LOCK */
-  gdouble      proportion;
-  GstClockTime earliest_time;
+  /* audio collection, frame timing, QoS and output buffers */
+  GstVisualRender render;
 
   /* video state */
-  gint         fps_num;
-  gint         fps_denom;
   gint         width;
   gint         height;
   guint        outsize;
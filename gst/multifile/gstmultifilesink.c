@@ -96,6 +96,13 @@
  * </listitem>
  * </itemizedlist>
  *
+ * When #GstMultiFileSink:async-write is enabled, opening, writing and closing
+ * files is done by a separate writer thread so that slow storage does not
+ * stall the streaming thread. Up to #GstMultiFileSink:max-queued-bytes of
+ * data are queued for that thread; upstream only blocks once the queue is
+ * full. The messages described above are then posted after the data was
+ * handed to the operating system.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -106,6 +113,9 @@
  *
  * Last reviewed on 2009-09-11 (0.10.17)
  */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* O_DIRECT, fallocate */
+#endif
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
@@ -129,6 +139,16 @@ GST_DEBUG_CATEGORY_STATIC (gst_multi_file_sink_debug);
 #define DEFAULT_NEXT_FILE GST_MULTI_FILE_SINK_NEXT_BUFFER
 #define DEFAULT_MAX_FILES 0
 #define DEFAULT_MAX_FILE_SIZE G_GUINT64_CONSTANT(2*1024*1024*1024)
+#define DEFAULT_ASYNC_WRITE FALSE
+#define DEFAULT_MAX_QUEUED_BYTES (8 * 1024 * 1024)
+#define DEFAULT_PREALLOCATE 0
+#define DEFAULT_DIRECT_IO FALSE
+#define DEFAULT_DATA_SYNC GST_MULTI_FILE_SINK_DATA_SYNC_NONE
+
+/* O_DIRECT needs block aligned memory, offsets and sizes, so writes are
+ * staged in an aligned buffer and only submitted in whole chunks */
+#define DIRECT_ALIGN 4096
+#define DIRECT_BUFFER_SIZE (1024 * 1024)
 
 enum
 {
@@ -139,9 +159,34 @@ enum
   PROP_NEXT_FILE,
   PROP_MAX_FILES,
   PROP_MAX_FILE_SIZE,
+  PROP_ASYNC_WRITE,
+  PROP_MAX_QUEUED_BYTES,
+  PROP_PREALLOCATE,
+  PROP_DIRECT_IO,
+  PROP_DATA_SYNC,
   PROP_LAST
 };
 
+/* file operations, either executed in place or queued for the writer
+ * thread in async mode */
+typedef enum
+{
+  GST_MULTI_FILE_SINK_OP_OPEN,
+  GST_MULTI_FILE_SINK_OP_WRITE,
+  GST_MULTI_FILE_SINK_OP_CLOSE,
+  GST_MULTI_FILE_SINK_OP_WRITE_FILE,
+  GST_MULTI_FILE_SINK_OP_REMOVE
+} GstMultiFileSinkOpType;
+
+typedef struct
+{
+  GstMultiFileSinkOpType type;
+  gchar *filename;
+  GstBuffer *buffer;
+  /* posted once the operation succeeded */
+  GstMessage *message;
+} GstMultiFileSinkOp;
+
 static void gst_multi_file_sink_finalize (GObject * object);
 
 static void gst_multi_file_sink_set_property (GObject * object, guint prop_id,
@@ -149,17 +194,20 @@ static void gst_multi_file_sink_set_property (GObject * object, guint prop_id,
 static void gst_multi_file_sink_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
+static gboolean gst_multi_file_sink_start (GstBaseSink * sink);
 static gboolean gst_multi_file_sink_stop (GstBaseSink * sink);
+static gboolean gst_multi_file_sink_unlock (GstBaseSink * sink);
+static gboolean gst_multi_file_sink_unlock_stop (GstBaseSink * sink);
 static GstFlowReturn gst_multi_file_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
 static GstFlowReturn gst_multi_file_sink_render_list (GstBaseSink * sink,
     GstBufferList * buffer_list);
 static gboolean gst_multi_file_sink_set_caps (GstBaseSink * sink,
     GstCaps * caps);
-static gboolean gst_multi_file_sink_open_next_file (GstMultiFileSink *
+static GstFlowReturn gst_multi_file_sink_open_next_file (GstMultiFileSink *
     multifilesink);
 static void gst_multi_file_sink_close_file (GstMultiFileSink * multifilesink,
-    GstBuffer * buffer);
+    GstMessage * message);
 static void gst_multi_file_sink_ensure_max_files (GstMultiFileSink *
     multifilesink);
 static gboolean gst_multi_file_sink_event (GstBaseSink * sink,
@@ -192,6 +240,30 @@ gst_multi_file_sink_next_get_type (void)
   return multi_file_sync_next_type;
 }
 
+#define GST_TYPE_MULTI_FILE_SINK_DATA_SYNC \
+    (gst_multi_file_sink_data_sync_get_type ())
+static GType
+gst_multi_file_sink_data_sync_get_type (void)
+{
+  static GType multi_file_sink_data_sync_type = 0;
+  static const GEnumValue data_sync_types[] = {
+    {GST_MULTI_FILE_SINK_DATA_SYNC_NONE, "Leave writeback to the kernel",
+        "none"},
+    {GST_MULTI_FILE_SINK_DATA_SYNC_CLOSE,
+        "Flush each file to disk before closing it", "close"},
+    {GST_MULTI_FILE_SINK_DATA_SYNC_WRITE, "Flush to disk after every write",
+        "write"},
+    {0, NULL, NULL}
+  };
+
+  if (!multi_file_sink_data_sync_type) {
+    multi_file_sink_data_sync_type =
+        g_enum_register_static ("GstMultiFileSinkDataSync", data_sync_types);
+  }
+
+  return multi_file_sink_data_sync_type;
+}
+
 #define gst_multi_file_sink_parent_class parent_class
 G_DEFINE_TYPE (GstMultiFileSink, gst_multi_file_sink, GST_TYPE_BASE_SINK);
 
@@ -261,9 +333,82 @@ gst_multi_file_sink_class_init (GstMultiFileSinkClass * klass)
           0, G_MAXUINT64, DEFAULT_MAX_FILE_SIZE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiFileSink:async-write:
+   *
+   * Open, write and close files from a separate writer thread instead of the
+   * streaming thread. Only takes effect when the element is started.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_ASYNC_WRITE,
+      g_param_spec_boolean ("async-write", "Async Write",
+          "Do file I/O from a separate writer thread",
+          DEFAULT_ASYNC_WRITE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiFileSink:max-queued-bytes:
+   *
+   * Maximum amount of data queued for the writer thread in async mode before
+   * upstream is blocked, 0 for no limit.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUED_BYTES,
+      g_param_spec_uint64 ("max-queued-bytes", "Max Queued Bytes",
+          "Maximum bytes queued for the writer thread in async mode "
+          "(0 = unlimited)", 0, G_MAXUINT64, DEFAULT_MAX_QUEUED_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiFileSink:preallocate:
+   *
+   * Reserve this many bytes of disk space when opening a file, to reduce
+   * fragmentation and metadata updates while writing. The file size is not
+   * changed and unused space is released again when the file is closed.
+   * Only supported where fallocate() is available.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_PREALLOCATE,
+      g_param_spec_uint64 ("preallocate", "Preallocate",
+          "Disk space to reserve for each new file in bytes (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_PREALLOCATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiFileSink:direct-io:
+   *
+   * Open files with O_DIRECT to bypass the page cache. Falls back to normal
+   * I/O when the file system does not support it.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when writing files (O_DIRECT)",
+          DEFAULT_DIRECT_IO, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiFileSink:data-sync:
+   *
+   * When to force written data out to the storage device.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_DATA_SYNC,
+      g_param_spec_enum ("data-sync", "Data Sync",
+          "When to flush written data to disk",
+          GST_TYPE_MULTI_FILE_SINK_DATA_SYNC, DEFAULT_DATA_SYNC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_multi_file_sink_finalize;
 
+  gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_multi_file_sink_start);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_multi_file_sink_stop);
+  gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_multi_file_sink_unlock);
+  gstbasesink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_multi_file_sink_unlock_stop);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_multi_file_sink_render);
   gstbasesink_class->render_list =
       GST_DEBUG_FUNCPTR (gst_multi_file_sink_render_list);
@@ -293,6 +438,18 @@ gst_multi_file_sink_init (GstMultiFileSink * multifilesink)
   multifilesink->files = NULL;
   multifilesink->n_files = 0;
 
+  multifilesink->async_write = DEFAULT_ASYNC_WRITE;
+  multifilesink->max_queued_bytes = DEFAULT_MAX_QUEUED_BYTES;
+  multifilesink->preallocate = DEFAULT_PREALLOCATE;
+  multifilesink->direct_io = DEFAULT_DIRECT_IO;
+  multifilesink->data_sync = DEFAULT_DATA_SYNC;
+  multifilesink->direct_fd = -1;
+
+  g_mutex_init (&multifilesink->queue_lock);
+  g_cond_init (&multifilesink->queue_cond);
+  g_queue_init (&multifilesink->queue);
+  multifilesink->writer_ret = GST_FLOW_OK;
+
   gst_base_sink_set_sync (GST_BASE_SINK (multifilesink), FALSE);
 
   multifilesink->next_segment = GST_CLOCK_TIME_NONE;
@@ -308,6 +465,9 @@ gst_multi_file_sink_finalize (GObject * object)
   g_slist_foreach (sink->files, (GFunc) g_free, NULL);
   g_slist_free (sink->files);
 
+  g_mutex_clear (&sink->queue_lock);
+  g_cond_clear (&sink->queue_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -347,6 +507,24 @@ gst_multi_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_FILE_SIZE:
       sink->max_file_size = g_value_get_uint64 (value);
       break;
+    case PROP_ASYNC_WRITE:
+      sink->async_write = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_QUEUED_BYTES:
+      g_mutex_lock (&sink->queue_lock);
+      sink->max_queued_bytes = g_value_get_uint64 (value);
+      g_cond_broadcast (&sink->queue_cond);
+      g_mutex_unlock (&sink->queue_lock);
+      break;
+    case PROP_PREALLOCATE:
+      sink->preallocate = g_value_get_uint64 (value);
+      break;
+    case PROP_DIRECT_IO:
+      sink->direct_io = g_value_get_boolean (value);
+      break;
+    case PROP_DATA_SYNC:
+      sink->data_sync = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -378,12 +556,481 @@ gst_multi_file_sink_get_property (GObject * object, guint prop_id,
     case PROP_MAX_FILE_SIZE:
       g_value_set_uint64 (value, sink->max_file_size);
       break;
+    case PROP_ASYNC_WRITE:
+      g_value_set_boolean (value, sink->async_write);
+      break;
+    case PROP_MAX_QUEUED_BYTES:
+      g_value_set_uint64 (value, sink->max_queued_bytes);
+      break;
+    case PROP_PREALLOCATE:
+      g_value_set_uint64 (value, sink->preallocate);
+      break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, sink->direct_io);
+      break;
+    case PROP_DATA_SYNC:
+      g_value_set_enum (value, sink->data_sync);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static GstMultiFileSinkOp *
+gst_multi_file_sink_op_new (GstMultiFileSinkOpType type,
+    const gchar * filename, GstBuffer * buffer, GstMessage * message)
+{
+  GstMultiFileSinkOp *op;
+
+  op = g_slice_new (GstMultiFileSinkOp);
+  op->type = type;
+  op->filename = g_strdup (filename);
+  op->buffer = buffer ? gst_buffer_ref (buffer) : NULL;
+  op->message = message;
+
+  return op;
+}
+
+static void
+gst_multi_file_sink_op_free (GstMultiFileSinkOp * op)
+{
+  g_free (op->filename);
+  if (op->buffer)
+    gst_buffer_unref (op->buffer);
+  if (op->message)
+    gst_message_unref (op->message);
+  g_slice_free (GstMultiFileSinkOp, op);
+}
+
+static gsize
+gst_multi_file_sink_op_size (GstMultiFileSinkOp * op)
+{
+  return op->buffer ? gst_buffer_get_size (op->buffer) : 0;
+}
+
+static void
+gst_multi_file_sink_post_write_error (GstMultiFileSink * sink, gint err)
+{
+  switch (err) {
+    case ENOSPC:
+      GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT,
+          ("Error while writing to file."), ("%s", g_strerror (err)));
+      break;
+    default:
+      GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+          ("Error while writing to file."), ("%s", g_strerror (err)));
+  }
+}
+
+static gboolean
+gst_multi_file_sink_write_fd (gint fd, const guint8 * data, gsize size)
+{
+  while (size > 0) {
+    gssize ret;
+
+    ret = write (fd, data, size);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+      return FALSE;
+    }
+    data += ret;
+    size -= ret;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_sink_sync_fd (GstMultiFileSink * sink, gint fd)
+{
+#if defined (HAVE_FDATASYNC)
+  return fdatasync (fd) == 0;
+#elif defined (HAVE_FSYNC)
+  return fsync (fd) == 0;
+#else
+  GST_WARNING_OBJECT (sink, "syncing data to disk is not supported");
+  return TRUE;
+#endif
+}
+
+static void
+gst_multi_file_sink_preallocate (GstMultiFileSink * sink, gint fd)
+{
+#if defined (HAVE_FALLOCATE) && defined (FALLOC_FL_KEEP_SIZE)
+  if (fallocate (fd, FALLOC_FL_KEEP_SIZE, 0, sink->preallocate) == 0) {
+    sink->preallocated = TRUE;
+  } else {
+    GST_WARNING_OBJECT (sink, "failed to preallocate %" G_GUINT64_FORMAT
+        " bytes: %s", sink->preallocate, g_strerror (errno));
+  }
+#else
+  GST_WARNING_OBJECT (sink, "preallocation is not supported");
+#endif
+}
+
+static gboolean
+gst_multi_file_sink_open_writer_file (GstMultiFileSink * sink,
+    const gchar * filename)
+{
+  g_return_val_if_fail (sink->file == NULL && sink->direct_fd == -1, FALSE);
+
+  sink->written = 0;
+  sink->preallocated = FALSE;
+
+#ifdef O_DIRECT
+  if (sink->direct_io) {
+    sink->direct_fd =
+        g_open (filename, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0666);
+    if (sink->direct_fd == -1) {
+      if (errno != EINVAL)
+        return FALSE;
+      GST_WARNING_OBJECT (sink, "%s does not support O_DIRECT, using "
+          "buffered I/O", filename);
+    } else if (sink->direct_mem == NULL) {
+      sink->direct_mem = g_malloc (DIRECT_BUFFER_SIZE + DIRECT_ALIGN - 1);
+      sink->direct_data = (guint8 *) (((guintptr) sink->direct_mem +
+              DIRECT_ALIGN - 1) & ~(guintptr) (DIRECT_ALIGN - 1));
+    }
+    sink->direct_fill = 0;
+  }
+#endif
+
+  if (sink->direct_fd == -1) {
+    sink->file = g_fopen (filename, "wb");
+    if (sink->file == NULL)
+      return FALSE;
+  }
+
+  if (sink->preallocate > 0)
+    gst_multi_file_sink_preallocate (sink,
+        sink->file ? fileno (sink->file) : sink->direct_fd);
+
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_sink_write_data (GstMultiFileSink * sink, const guint8 * data,
+    gsize size)
+{
+  if (size == 0)
+    return TRUE;
+
+  sink->written += size;
+
+  if (sink->file)
+    return fwrite (data, size, 1, sink->file) == 1;
+
+  while (size > 0) {
+    gsize n;
+
+    n = MIN (size, DIRECT_BUFFER_SIZE - sink->direct_fill);
+    memcpy (sink->direct_data + sink->direct_fill, data, n);
+    sink->direct_fill += n;
+    data += n;
+    size -= n;
+
+    if (sink->direct_fill == DIRECT_BUFFER_SIZE) {
+      if (!gst_multi_file_sink_write_fd (sink->direct_fd, sink->direct_data,
+              DIRECT_BUFFER_SIZE))
+        return FALSE;
+      sink->direct_fill = 0;
+    }
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_sink_sync_writer_file (GstMultiFileSink * sink)
+{
+  if (sink->file) {
+    if (fflush (sink->file) != 0)
+      return FALSE;
+    return gst_multi_file_sink_sync_fd (sink, fileno (sink->file));
+  }
+
+  /* data still staged for alignment is synced when the file is closed */
+  return gst_multi_file_sink_sync_fd (sink, sink->direct_fd);
+}
+
+static gboolean
+gst_multi_file_sink_close_writer_file (GstMultiFileSink * sink)
+{
+  gboolean ret = TRUE;
+  gint err = 0;
+  gint fd;
+
+  if (sink->file) {
+    if (fflush (sink->file) != 0) {
+      err = errno;
+      ret = FALSE;
+    }
+    fd = fileno (sink->file);
+  } else if (sink->direct_fd != -1) {
+    fd = sink->direct_fd;
+    if (sink->direct_fill > 0) {
+#ifdef O_DIRECT
+      gint flags;
+
+      /* the tail is not block sized, finish it through the page cache */
+      flags = fcntl (fd, F_GETFL);
+      if (flags != -1)
+        fcntl (fd, F_SETFL, flags & ~O_DIRECT);
+#endif
+      if (!gst_multi_file_sink_write_fd (fd, sink->direct_data,
+              sink->direct_fill)) {
+        err = errno;
+        ret = FALSE;
+      }
+      sink->direct_fill = 0;
+    }
+  } else {
+    return TRUE;
+  }
+
+#if defined (HAVE_FALLOCATE) && defined (FALLOC_FL_KEEP_SIZE)
+  /* give back the reserved space we did not use */
+  if (ret && sink->preallocated && sink->written < sink->preallocate) {
+    if (ftruncate (fd, sink->written) != 0)
+      GST_WARNING_OBJECT (sink, "failed to release preallocated space: %s",
+          g_strerror (errno));
+  }
+#endif
+
+  if (ret && sink->data_sync != GST_MULTI_FILE_SINK_DATA_SYNC_NONE &&
+      !gst_multi_file_sink_sync_fd (sink, fd)) {
+    err = errno;
+    ret = FALSE;
+  }
+
+  if (sink->file) {
+    if (fclose (sink->file) != 0 && ret) {
+      err = errno;
+      ret = FALSE;
+    }
+    sink->file = NULL;
+  } else {
+    if (close (fd) != 0 && ret) {
+      err = errno;
+      ret = FALSE;
+    }
+    sink->direct_fd = -1;
+  }
+
+  if (!ret)
+    errno = err;
+
+  return ret;
+}
+
+/* executed from the writer thread in async mode, from the streaming
+ * thread otherwise */
+static gboolean
+gst_multi_file_sink_do_op (GstMultiFileSink * sink, GstMultiFileSinkOp * op)
+{
+  GstMapInfo map;
+  GError *error = NULL;
+  gboolean ret = TRUE;
+
+  switch (op->type) {
+    case GST_MULTI_FILE_SINK_OP_OPEN:
+      GST_INFO_OBJECT (sink, "opening file %s", op->filename);
+      ret = gst_multi_file_sink_open_writer_file (sink, op->filename);
+      break;
+    case GST_MULTI_FILE_SINK_OP_WRITE:
+      gst_buffer_map (op->buffer, &map, GST_MAP_READ);
+      ret = gst_multi_file_sink_write_data (sink, map.data, map.size);
+      gst_buffer_unmap (op->buffer, &map);
+
+      if (ret && sink->data_sync == GST_MULTI_FILE_SINK_DATA_SYNC_WRITE)
+        ret = gst_multi_file_sink_sync_writer_file (sink);
+      break;
+    case GST_MULTI_FILE_SINK_OP_CLOSE:
+      ret = gst_multi_file_sink_close_writer_file (sink);
+      break;
+    case GST_MULTI_FILE_SINK_OP_WRITE_FILE:
+      gst_buffer_map (op->buffer, &map, GST_MAP_READ);
+      ret = g_file_set_contents (op->filename, (char *) map.data, map.size,
+          &error);
+      gst_buffer_unmap (op->buffer, &map);
+      if (!ret)
+        goto write_file_error;
+      break;
+    case GST_MULTI_FILE_SINK_OP_REMOVE:
+      GST_DEBUG_OBJECT (sink, "removing file %s", op->filename);
+      g_remove (op->filename);
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+
+  if (!ret)
+    goto stdio_write_error;
+
+  if (op->message) {
+    gst_element_post_message (GST_ELEMENT_CAST (sink), op->message);
+    op->message = NULL;
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+write_file_error:
+  {
+    switch (error->code) {
+      case G_FILE_ERROR_NOSPC:{
+        GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+        break;
+      }
+      default:{
+        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+            ("Error while writing to file \"%s\".", op->filename),
+            ("%s", error->message));
+      }
+    }
+    g_error_free (error);
+    return FALSE;
+  }
+stdio_write_error:
+  {
+    gst_multi_file_sink_post_write_error (sink, errno);
+    return FALSE;
+  }
+}
+
+static gpointer
+gst_multi_file_sink_writer_func (gpointer data)
+{
+  GstMultiFileSink *sink = data;
+  GstMultiFileSinkOp *op;
+  gboolean skip, ret;
+  gsize size;
+
+  g_mutex_lock (&sink->queue_lock);
+  while (TRUE) {
+    while (g_queue_is_empty (&sink->queue) && !sink->writer_stop)
+      g_cond_wait (&sink->queue_cond, &sink->queue_lock);
+
+    /* the queue is always drained before the thread stops */
+    op = g_queue_pop_head (&sink->queue);
+    if (op == NULL)
+      break;
+
+    /* after an error only closing the file is still useful */
+    skip = sink->writer_ret != GST_FLOW_OK &&
+        op->type != GST_MULTI_FILE_SINK_OP_CLOSE;
+    g_mutex_unlock (&sink->queue_lock);
+
+    size = gst_multi_file_sink_op_size (op);
+    ret = skip || gst_multi_file_sink_do_op (sink, op);
+    gst_multi_file_sink_op_free (op);
+
+    g_mutex_lock (&sink->queue_lock);
+    if (!ret)
+      sink->writer_ret = GST_FLOW_ERROR;
+    sink->queued_bytes -= size;
+    sink->pending--;
+    g_cond_broadcast (&sink->queue_cond);
+  }
+  g_mutex_unlock (&sink->queue_lock);
+
+  return NULL;
+}
+
+/* takes ownership of @op. In async mode errors of earlier operations are
+ * reported here, as they are only noticed by the writer thread. */
+static GstFlowReturn
+gst_multi_file_sink_push_op (GstMultiFileSink * sink, GstMultiFileSinkOp * op)
+{
+  GstFlowReturn ret;
+  gsize size;
+
+  if (sink->writer == NULL) {
+    ret = gst_multi_file_sink_do_op (sink, op) ? GST_FLOW_OK : GST_FLOW_ERROR;
+    gst_multi_file_sink_op_free (op);
+    return ret;
+  }
+
+  size = gst_multi_file_sink_op_size (op);
+
+  g_mutex_lock (&sink->queue_lock);
+  /* only data blocks, and a single oversized buffer is always let through */
+  while (size > 0 && sink->max_queued_bytes > 0 && sink->queued_bytes > 0 &&
+      sink->queued_bytes + size > sink->max_queued_bytes &&
+      !sink->flushing && sink->writer_ret == GST_FLOW_OK) {
+    GST_LOG_OBJECT (sink, "queue full (%" G_GUINT64_FORMAT " bytes), waiting",
+        sink->queued_bytes);
+    g_cond_wait (&sink->queue_cond, &sink->queue_lock);
+  }
+
+  ret = sink->writer_ret;
+  if (ret == GST_FLOW_OK && size > 0 && sink->flushing)
+    ret = GST_FLOW_FLUSHING;
+
+  if (ret == GST_FLOW_OK) {
+    g_queue_push_tail (&sink->queue, op);
+    sink->queued_bytes += size;
+    sink->pending++;
+    g_cond_broadcast (&sink->queue_cond);
+  }
+  g_mutex_unlock (&sink->queue_lock);
+
+  if (ret != GST_FLOW_OK)
+    gst_multi_file_sink_op_free (op);
+
+  return ret;
+}
+
+/* wait until the writer thread has handled everything queued so far */
+static void
+gst_multi_file_sink_drain (GstMultiFileSink * sink)
+{
+  if (sink->writer == NULL)
+    return;
+
+  g_mutex_lock (&sink->queue_lock);
+  while (sink->pending > 0 && !sink->flushing)
+    g_cond_wait (&sink->queue_cond, &sink->queue_lock);
+  g_mutex_unlock (&sink->queue_lock);
+}
+
+static gboolean
+gst_multi_file_sink_start (GstBaseSink * sink)
+{
+  GstMultiFileSink *multifilesink;
+  GError *error = NULL;
+
+  multifilesink = GST_MULTI_FILE_SINK (sink);
+
+#ifndef O_DIRECT
+  if (multifilesink->direct_io)
+    GST_WARNING_OBJECT (multifilesink, "O_DIRECT is not supported");
+#endif
+
+  if (!multifilesink->async_write)
+    return TRUE;
+
+  multifilesink->writer_ret = GST_FLOW_OK;
+  multifilesink->writer_stop = FALSE;
+  multifilesink->writer = g_thread_try_new ("multifilesink-writer",
+      gst_multi_file_sink_writer_func, multifilesink, &error);
+  if (multifilesink->writer == NULL)
+    goto no_thread;
+
+  return TRUE;
+
+  /* ERRORS */
+no_thread:
+  {
+    GST_ELEMENT_ERROR (multifilesink, RESOURCE, FAILED,
+        ("Could not create writer thread."), ("%s", error->message));
+    g_error_free (error);
+    return FALSE;
+  }
+}
+
 static gboolean
 gst_multi_file_sink_stop (GstBaseSink * sink)
 {
@@ -392,10 +1039,25 @@ gst_multi_file_sink_stop (GstBaseSink * sink)
 
   multifilesink = GST_MULTI_FILE_SINK (sink);
 
-  if (multifilesink->file != NULL) {
-    fclose (multifilesink->file);
-    multifilesink->file = NULL;
+  if (multifilesink->writer) {
+    g_mutex_lock (&multifilesink->queue_lock);
+    multifilesink->writer_stop = TRUE;
+    g_cond_broadcast (&multifilesink->queue_cond);
+    g_mutex_unlock (&multifilesink->queue_lock);
+
+    g_thread_join (multifilesink->writer);
+    multifilesink->writer = NULL;
+    multifilesink->queued_bytes = 0;
+    multifilesink->pending = 0;
   }
+  multifilesink->flushing = FALSE;
+
+  gst_multi_file_sink_close_writer_file (multifilesink);
+  multifilesink->file_open = FALSE;
+
+  g_free (multifilesink->direct_mem);
+  multifilesink->direct_mem = NULL;
+  multifilesink->direct_data = NULL;
 
   if (multifilesink->streamheaders) {
     for (i = 0; i < multifilesink->n_streamheaders; i++) {
@@ -410,9 +1072,34 @@ gst_multi_file_sink_stop (GstBaseSink * sink)
   return TRUE;
 }
 
+static gboolean
+gst_multi_file_sink_unlock (GstBaseSink * sink)
+{
+  GstMultiFileSink *multifilesink = GST_MULTI_FILE_SINK (sink);
+
+  g_mutex_lock (&multifilesink->queue_lock);
+  multifilesink->flushing = TRUE;
+  g_cond_broadcast (&multifilesink->queue_cond);
+  g_mutex_unlock (&multifilesink->queue_lock);
 
-static void
-gst_multi_file_sink_post_message_full (GstMultiFileSink * multifilesink,
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_sink_unlock_stop (GstBaseSink * sink)
+{
+  GstMultiFileSink *multifilesink = GST_MULTI_FILE_SINK (sink);
+
+  g_mutex_lock (&multifilesink->queue_lock);
+  multifilesink->flushing = FALSE;
+  g_mutex_unlock (&multifilesink->queue_lock);
+
+  return TRUE;
+}
+
+
+static GstMessage *
+gst_multi_file_sink_new_message_full (GstMultiFileSink * multifilesink,
     GstClockTime timestamp, GstClockTime duration, GstClockTime offset,
     GstClockTime offset_end, GstClockTime running_time,
     GstClockTime stream_time, const char *filename)
@@ -420,7 +1107,7 @@ gst_multi_file_sink_post_message_full (GstMultiFileSink * multifilesink,
   GstStructure *s;
 
   if (!multifilesink->post_messages)
-    return;
+    return NULL;
 
   s = gst_structure_new ("GstMultiFileSink",
       "filename", G_TYPE_STRING, filename,
@@ -432,13 +1119,12 @@ gst_multi_file_sink_post_message_full (GstMultiFileSink * multifilesink,
       "offset", G_TYPE_UINT64, offset,
       "offset-end", G_TYPE_UINT64, offset_end, NULL);
 
-  gst_element_post_message (GST_ELEMENT_CAST (multifilesink),
-      gst_message_new_element (GST_OBJECT_CAST (multifilesink), s));
+  return gst_message_new_element (GST_OBJECT_CAST (multifilesink), s);
 }
 
 
-static void
-gst_multi_file_sink_post_message (GstMultiFileSink * multifilesink,
+static GstMessage *
+gst_multi_file_sink_new_message (GstMultiFileSink * multifilesink,
     GstBuffer * buffer, const char *filename)
 {
   GstClockTime duration, timestamp;
@@ -448,7 +1134,7 @@ gst_multi_file_sink_post_message (GstMultiFileSink * multifilesink,
   GstFormat format;
 
   if (!multifilesink->post_messages)
-    return;
+    return NULL;
 
   segment = &GST_BASE_SINK (multifilesink)->segment;
   format = segment->format;
@@ -461,53 +1147,74 @@ gst_multi_file_sink_post_message (GstMultiFileSink * multifilesink,
   running_time = gst_segment_to_running_time (segment, format, timestamp);
   stream_time = gst_segment_to_stream_time (segment, format, timestamp);
 
-  gst_multi_file_sink_post_message_full (multifilesink, timestamp, duration,
-      offset, offset_end, running_time, stream_time, filename);
+  return gst_multi_file_sink_new_message_full (multifilesink, timestamp,
+      duration, offset, offset_end, running_time, stream_time, filename);
 }
 
-static gboolean
+/* message for the file currently being written */
+static GstMessage *
+gst_multi_file_sink_file_message (GstMultiFileSink * multifilesink,
+    GstBuffer * buffer)
+{
+  GstMessage *message;
+  gchar *filename;
+
+  if (!multifilesink->post_messages)
+    return NULL;
+
+  filename = g_strdup_printf (multifilesink->filename, multifilesink->index);
+  message = gst_multi_file_sink_new_message (multifilesink, buffer, filename);
+  g_free (filename);
+
+  return message;
+}
+
+static GstFlowReturn
+gst_multi_file_sink_write_buffer (GstMultiFileSink * sink, GstBuffer * buffer)
+{
+  return gst_multi_file_sink_push_op (sink,
+      gst_multi_file_sink_op_new (GST_MULTI_FILE_SINK_OP_WRITE, NULL, buffer,
+          NULL));
+}
+
+static GstFlowReturn
 gst_multi_file_sink_write_stream_headers (GstMultiFileSink * sink)
 {
+  GstFlowReturn ret;
   int i;
 
   if (sink->streamheaders == NULL)
-    return TRUE;
+    return GST_FLOW_OK;
 
   /* we want to write these at the beginning */
   g_assert (sink->cur_file_size == 0);
 
   for (i = 0; i < sink->n_streamheaders; i++) {
     GstBuffer *hdr;
-    GstMapInfo map;
-    int ret;
 
     hdr = sink->streamheaders[i];
-    gst_buffer_map (hdr, &map, GST_MAP_READ);
-    ret = fwrite (map.data, map.size, 1, sink->file);
-    gst_buffer_unmap (hdr, &map);
+    ret = gst_multi_file_sink_write_buffer (sink, hdr);
+    if (ret != GST_FLOW_OK)
+      return ret;
 
-    if (ret != 1)
-      return FALSE;
-
-    sink->cur_file_size += map.size;
+    sink->cur_file_size += gst_buffer_get_size (hdr);
   }
 
-  return TRUE;
+  return GST_FLOW_OK;
 }
 
 static GstFlowReturn
 gst_multi_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstMultiFileSink *multifilesink;
-  GstMapInfo map;
   gchar *filename;
-  gboolean ret;
-  GError *error = NULL;
+  GstMessage *message;
+  GstFlowReturn ret;
   gboolean first_file = TRUE;
-
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  gsize size;
 
   multifilesink = GST_MULTI_FILE_SINK (sink);
+  size = gst_buffer_get_size (buffer);
 
   switch (multifilesink->next_file) {
     case GST_MULTI_FILE_SINK_NEXT_BUFFER:
@@ -515,31 +1222,38 @@ gst_multi_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
       filename = g_strdup_printf (multifilesink->filename,
           multifilesink->index);
-      ret = g_file_set_contents (filename, (char *) map.data, map.size, &error);
-      if (!ret)
-        goto write_error;
+      message = gst_multi_file_sink_new_message (multifilesink, buffer,
+          filename);
+      ret = gst_multi_file_sink_push_op (multifilesink,
+          gst_multi_file_sink_op_new (GST_MULTI_FILE_SINK_OP_WRITE_FILE,
+              filename, buffer, message));
+      if (ret != GST_FLOW_OK) {
+        g_free (filename);
+        return ret;
+      }
 
       multifilesink->files = g_slist_append (multifilesink->files, filename);
       multifilesink->n_files += 1;
 
-      gst_multi_file_sink_post_message (multifilesink, buffer, filename);
       multifilesink->index++;
 
       break;
     case GST_MULTI_FILE_SINK_NEXT_DISCONT:
       if (GST_BUFFER_IS_DISCONT (buffer)) {
-        if (multifilesink->file)
-          gst_multi_file_sink_close_file (multifilesink, buffer);
+        if (multifilesink->file_open)
+          gst_multi_file_sink_close_file (multifilesink,
+              gst_multi_file_sink_file_message (multifilesink, buffer));
       }
 
-      if (multifilesink->file == NULL) {
-        if (!gst_multi_file_sink_open_next_file (multifilesink))
-          goto stdio_write_error;
+      if (!multifilesink->file_open) {
+        ret = gst_multi_file_sink_open_next_file (multifilesink);
+        if (ret != GST_FLOW_OK)
+          return ret;
       }
 
-      ret = fwrite (map.data, map.size, 1, multifilesink->file);
-      if (ret != 1)
-        goto stdio_write_error;
+      ret = gst_multi_file_sink_write_buffer (multifilesink, buffer);
+      if (ret != GST_FLOW_OK)
+        return ret;
 
       break;
     case GST_MULTI_FILE_SINK_NEXT_KEY_FRAME:
@@ -553,30 +1267,33 @@ gst_multi_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
       if (GST_BUFFER_TIMESTAMP_IS_VALID (buffer) &&
           GST_BUFFER_TIMESTAMP (buffer) >= multifilesink->next_segment &&
           !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
-        if (multifilesink->file) {
+        if (multifilesink->file_open) {
           first_file = FALSE;
-          gst_multi_file_sink_close_file (multifilesink, buffer);
+          gst_multi_file_sink_close_file (multifilesink,
+              gst_multi_file_sink_file_message (multifilesink, buffer));
         }
         multifilesink->next_segment += 10 * GST_SECOND;
       }
 
-      if (multifilesink->file == NULL) {
-        if (!gst_multi_file_sink_open_next_file (multifilesink))
-          goto stdio_write_error;
+      if (!multifilesink->file_open) {
+        ret = gst_multi_file_sink_open_next_file (multifilesink);
+        if (ret != GST_FLOW_OK)
+          return ret;
 
         if (!first_file)
           gst_multi_file_sink_write_stream_headers (multifilesink);
       }
 
-      ret = fwrite (map.data, map.size, 1, multifilesink->file);
-      if (ret != 1)
-        goto stdio_write_error;
+      ret = gst_multi_file_sink_write_buffer (multifilesink, buffer);
+      if (ret != GST_FLOW_OK)
+        return ret;
 
       break;
     case GST_MULTI_FILE_SINK_NEXT_KEY_UNIT_EVENT:
-      if (multifilesink->file == NULL) {
-        if (!gst_multi_file_sink_open_next_file (multifilesink))
-          goto stdio_write_error;
+      if (!multifilesink->file_open) {
+        ret = gst_multi_file_sink_open_next_file (multifilesink);
+        if (ret != GST_FLOW_OK)
+          return ret;
 
         /* we don't need to write stream headers here, they will be inserted in
          * the stream by upstream elements if key unit events have
@@ -584,16 +1301,15 @@ gst_multi_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
          */
       }
 
-      ret = fwrite (map.data, map.size, 1, multifilesink->file);
-
-      if (ret != 1)
-        goto stdio_write_error;
+      ret = gst_multi_file_sink_write_buffer (multifilesink, buffer);
+      if (ret != GST_FLOW_OK)
+        return ret;
 
       break;
     case GST_MULTI_FILE_SINK_NEXT_MAX_SIZE:{
       guint64 new_size;
 
-      new_size = multifilesink->cur_file_size + map.size;
+      new_size = multifilesink->cur_file_size + size;
       if (new_size > multifilesink->max_file_size) {
 
         GST_INFO_OBJECT (multifilesink, "current size: %" G_GUINT64_FORMAT
@@ -601,68 +1317,34 @@ gst_multi_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
             multifilesink->cur_file_size, new_size,
             multifilesink->max_file_size);
 
-        if (multifilesink->file != NULL) {
+        if (multifilesink->file_open) {
           first_file = FALSE;
-          gst_multi_file_sink_close_file (multifilesink, buffer);
+          gst_multi_file_sink_close_file (multifilesink,
+              gst_multi_file_sink_file_message (multifilesink, buffer));
         }
       }
 
-      if (multifilesink->file == NULL) {
-        if (!gst_multi_file_sink_open_next_file (multifilesink))
-          goto stdio_write_error;
+      if (!multifilesink->file_open) {
+        ret = gst_multi_file_sink_open_next_file (multifilesink);
+        if (ret != GST_FLOW_OK)
+          return ret;
 
         if (!first_file)
           gst_multi_file_sink_write_stream_headers (multifilesink);
       }
 
-      ret = fwrite (map.data, map.size, 1, multifilesink->file);
-
-      if (ret != 1)
-        goto stdio_write_error;
+      ret = gst_multi_file_sink_write_buffer (multifilesink, buffer);
+      if (ret != GST_FLOW_OK)
+        return ret;
 
-      multifilesink->cur_file_size += map.size;
+      multifilesink->cur_file_size += size;
       break;
     }
     default:
       g_assert_not_reached ();
   }
 
-  gst_buffer_unmap (buffer, &map);
   return GST_FLOW_OK;
-
-  /* ERRORS */
-write_error:
-  {
-    switch (error->code) {
-      case G_FILE_ERROR_NOSPC:{
-        GST_ELEMENT_ERROR (multifilesink, RESOURCE, NO_SPACE_LEFT, (NULL),
-            (NULL));
-        break;
-      }
-      default:{
-        GST_ELEMENT_ERROR (multifilesink, RESOURCE, WRITE,
-            ("Error while writing to file \"%s\".", filename),
-            ("%s", g_strerror (errno)));
-      }
-    }
-    g_error_free (error);
-    g_free (filename);
-
-    gst_buffer_unmap (buffer, &map);
-    return GST_FLOW_ERROR;
-  }
-stdio_write_error:
-  switch (errno) {
-    case ENOSPC:
-      GST_ELEMENT_ERROR (multifilesink, RESOURCE, NO_SPACE_LEFT,
-          ("Error while writing to file."), ("%s", g_strerror (errno)));
-      break;
-    default:
-      GST_ELEMENT_ERROR (multifilesink, RESOURCE, WRITE,
-          ("Error while writing to file."), ("%s", g_strerror (errno)));
-  }
-  gst_buffer_unmap (buffer, &map);
-  return GST_FLOW_ERROR;
 }
 
 static gboolean
@@ -705,6 +1387,7 @@ static GstFlowReturn
 gst_multi_file_sink_render_list (GstBaseSink * sink, GstBufferList * list)
 {
   GstBuffer *buf;
+  GstFlowReturn ret;
   guint size = 0;
 
   gst_buffer_list_foreach (list, buffer_list_calc_size, &size);
@@ -716,10 +1399,10 @@ gst_multi_file_sink_render_list (GstBaseSink * sink, GstBufferList * list)
   gst_buffer_list_foreach (list, buffer_list_copy_data, buf);
   g_assert (gst_buffer_get_size (buf) == size);
 
-  gst_multi_file_sink_render (sink, buf);
+  ret = gst_multi_file_sink_render (sink, buf);
   gst_buffer_unref (buf);
 
-  return GST_FLOW_OK;
+  return ret;
 }
 
 static gboolean
@@ -769,7 +1452,9 @@ gst_multi_file_sink_ensure_max_files (GstMultiFileSink * multifilesink)
   while (multifilesink->max_files &&
       multifilesink->n_files >= multifilesink->max_files) {
     filename = multifilesink->files->data;
-    g_remove (filename);
+    gst_multi_file_sink_push_op (multifilesink,
+        gst_multi_file_sink_op_new (GST_MULTI_FILE_SINK_OP_REMOVE, filename,
+            NULL, NULL));
     g_free (filename);
     multifilesink->files = g_slist_delete_link (multifilesink->files,
         multifilesink->files);
@@ -793,6 +1478,7 @@ gst_multi_file_sink_event (GstBaseSink * sink, GstEvent * event)
       guint64 offset, offset_end;
       gboolean all_headers;
       guint count;
+      GstMessage *message;
 
       if (multifilesink->next_file != GST_MULTI_FILE_SINK_NEXT_KEY_UNIT_EVENT ||
           !gst_video_event_is_force_key_unit (event))
@@ -807,27 +1493,32 @@ gst_multi_file_sink_event (GstBaseSink * sink, GstEvent * event)
 
       multifilesink->force_key_unit_count = count;
 
-      if (multifilesink->file) {
+      if (multifilesink->file_open) {
         duration = GST_CLOCK_TIME_NONE;
         offset = offset_end = -1;
         filename = g_strdup_printf (multifilesink->filename,
             multifilesink->index);
-        gst_multi_file_sink_post_message_full (multifilesink, timestamp,
-            duration, offset, offset_end, running_time, stream_time, filename);
+        message = gst_multi_file_sink_new_message_full (multifilesink,
+            timestamp, duration, offset, offset_end, running_time, stream_time,
+            filename);
 
         g_free (filename);
 
-        gst_multi_file_sink_close_file (multifilesink, NULL);
+        gst_multi_file_sink_close_file (multifilesink, message);
 
       }
 
-      if (multifilesink->file == NULL) {
-        if (!gst_multi_file_sink_open_next_file (multifilesink))
-          goto stdio_write_error;
+      if (!multifilesink->file_open) {
+        if (gst_multi_file_sink_open_next_file (multifilesink) != GST_FLOW_OK)
+          goto open_failed;
       }
 
       break;
     }
+    case GST_EVENT_EOS:
+      /* make sure everything is written before EOS is posted */
+      gst_multi_file_sink_drain (multifilesink);
+      break;
     default:
       break;
   }
@@ -836,52 +1527,49 @@ out:
   return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
 
   /* ERRORS */
-stdio_write_error:
+open_failed:
   {
-    GST_ELEMENT_ERROR (multifilesink, RESOURCE, WRITE,
-        ("Error while writing to file."), (NULL));
+    /* error was already posted */
     gst_event_unref (event);
     return FALSE;
   }
 }
 
-static gboolean
+static GstFlowReturn
 gst_multi_file_sink_open_next_file (GstMultiFileSink * multifilesink)
 {
+  GstFlowReturn ret;
   char *filename;
 
-  g_return_val_if_fail (multifilesink->file == NULL, FALSE);
+  g_return_val_if_fail (!multifilesink->file_open, GST_FLOW_ERROR);
 
   gst_multi_file_sink_ensure_max_files (multifilesink);
   filename = g_strdup_printf (multifilesink->filename, multifilesink->index);
-  multifilesink->file = g_fopen (filename, "wb");
-  if (multifilesink->file == NULL) {
+  ret = gst_multi_file_sink_push_op (multifilesink,
+      gst_multi_file_sink_op_new (GST_MULTI_FILE_SINK_OP_OPEN, filename, NULL,
+          NULL));
+  if (ret != GST_FLOW_OK) {
     g_free (filename);
-    return FALSE;
+    return ret;
   }
 
-  GST_INFO_OBJECT (multifilesink, "opening file %s", filename);
   multifilesink->files = g_slist_append (multifilesink->files, filename);
   multifilesink->n_files += 1;
 
+  multifilesink->file_open = TRUE;
   multifilesink->cur_file_size = 0;
-  return TRUE;
+  return GST_FLOW_OK;
 }
 
+/* takes ownership of @message, which is posted once the file is closed */
 static void
 gst_multi_file_sink_close_file (GstMultiFileSink * multifilesink,
-    GstBuffer * buffer)
+    GstMessage * message)
 {
-  char *filename;
-
-  fclose (multifilesink->file);
-  multifilesink->file = NULL;
-
-  if (buffer) {
-    filename = g_strdup_printf (multifilesink->filename, multifilesink->index);
-    gst_multi_file_sink_post_message (multifilesink, buffer, filename);
-    g_free (filename);
-  }
+  gst_multi_file_sink_push_op (multifilesink,
+      gst_multi_file_sink_op_new (GST_MULTI_FILE_SINK_OP_CLOSE, NULL, NULL,
+          message));
+  multifilesink->file_open = FALSE;
 
   multifilesink->index++;
 }
@@ -28,6 +28,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -73,6 +74,21 @@ typedef enum {
   GST_MULTI_FILE_SINK_NEXT_MAX_SIZE
 } GstMultiFileSinkNext;
 
+/**
+ * GstMultiFileSinkDataSync:
+ * @GST_MULTI_FILE_SINK_DATA_SYNC_NONE: Leave writeback to the kernel
+ * @GST_MULTI_FILE_SINK_DATA_SYNC_CLOSE: Flush each file to disk before
+ *  closing it
+ * @GST_MULTI_FILE_SINK_DATA_SYNC_WRITE: Flush to disk after every write
+ *
+ * When written data is forced out to the storage device.
+ */
+typedef enum {
+  GST_MULTI_FILE_SINK_DATA_SYNC_NONE,
+  GST_MULTI_FILE_SINK_DATA_SYNC_CLOSE,
+  GST_MULTI_FILE_SINK_DATA_SYNC_WRITE
+} GstMultiFileSinkDataSync;
+
 struct _GstMultiFileSink
 {
   GstBaseSink parent;
@@ -81,7 +97,7 @@ struct _GstMultiFileSink
   gint index;
   gboolean post_messages;
   GstMultiFileSinkNext next_file;
-  FILE *file;
+  gboolean file_open;
   guint max_files;
   GSList *files;
   guint n_files;
@@ -94,6 +110,32 @@ struct _GstMultiFileSink
 
   guint64 cur_file_size;
   guint64 max_file_size;
+
+  gboolean async_write;
+  guint64 max_queued_bytes;
+  guint64 preallocate;
+  gboolean direct_io;
+  GstMultiFileSinkDataSync data_sync;
+
+  /* file being written; owned by the writer thread in async mode */
+  FILE *file;
+  gint direct_fd;
+  gpointer direct_mem;
+  guint8 *direct_data;
+  gsize direct_fill;
+  guint64 written;
+  gboolean preallocated;
+
+  /* async writer */
+  GThread *writer;
+  GMutex queue_lock;
+  GCond queue_cond;
+  GQueue queue;
+  guint64 queued_bytes;
+  guint pending;
+  gboolean writer_stop;
+  gboolean flushing;
+  GstFlowReturn writer_ret;
 };
 
 struct _GstMultiFileSinkClass
@@ -47,11 +47,35 @@
 
 #include "gstmultifilesrc.h"
 
+#ifdef HAVE_MADVISE
+#include <sys/mman.h>
+#endif
+
+typedef struct
+{
+  gint index;
+  GMappedFile *file;
+} GstMultiFileSrcMapped;
+
+/* a file being read by the prefetch threads */
+typedef struct
+{
+  gint index;
+  gchar *filename;
+  GstBuffer *buffer;
+  GError *error;
+  gboolean done;
+  gboolean cancelled;           /* freed by the prefetch thread when done */
+} GstMultiFileSrcPrefetch;
 
 static GstFlowReturn gst_multi_file_src_create (GstPushSrc * src,
     GstBuffer ** buffer);
 
 static void gst_multi_file_src_dispose (GObject * object);
+static void gst_multi_file_src_finalize (GObject * object);
+static gboolean gst_multi_file_src_stop (GstBaseSrc * src);
+static gboolean gst_multi_file_src_unlock (GstBaseSrc * src);
+static gboolean gst_multi_file_src_unlock_stop (GstBaseSrc * src);
 
 static void gst_multi_file_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -59,6 +83,7 @@ static void gst_multi_file_src_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static GstCaps *gst_multi_file_src_getcaps (GstBaseSrc * src, GstCaps * filter);
 static gboolean gst_multi_file_src_query (GstBaseSrc * src, GstQuery * query);
+static void gst_multi_file_src_clear_mapped (GstMultiFileSrc * src);
 
 
 static GstStaticPadTemplate gst_multi_file_src_pad_template =
@@ -78,11 +103,19 @@ enum
   ARG_START_INDEX,
   ARG_STOP_INDEX,
   ARG_CAPS,
-  ARG_LOOP
+  ARG_LOOP,
+  ARG_USE_MMAP,
+  ARG_READ_AHEAD,
+  ARG_PREFETCH
 };
 
 #define DEFAULT_LOCATION "%05d"
 #define DEFAULT_INDEX 0
+#define DEFAULT_USE_MMAP FALSE
+#define DEFAULT_READ_AHEAD 0
+#define MAX_READ_AHEAD 64
+#define DEFAULT_PREFETCH 0
+#define MAX_PREFETCH 64
 
 #define gst_multi_file_src_parent_class parent_class
 G_DEFINE_TYPE (GstMultiFileSrc, gst_multi_file_src, GST_TYPE_PUSH_SRC);
@@ -175,13 +208,58 @@ gst_multi_file_src_class_init (GstMultiFileSrcClass * klass)
       g_param_spec_boolean ("loop", "Loop",
           "Whether to repeat from the beginning when all files have been read.",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMultiFileSrc:use-mmap:
+   *
+   * Map the files into memory and push the mapped pages downstream instead
+   * of copying the file contents into newly allocated buffers. The files
+   * must not be truncated while they are being read.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Map the files into memory instead of reading them",
+          DEFAULT_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMultiFileSrc:read-ahead:
+   *
+   * Number of upcoming files to map in advance and hint to the kernel for
+   * read-ahead. Only used together with #GstMultiFileSrc:use-mmap, and
+   * superseded by #GstMultiFileSrc:prefetch.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_READ_AHEAD,
+      g_param_spec_uint ("read-ahead", "Read Ahead",
+          "Number of upcoming files to map and prefetch in mmap mode",
+          0, MAX_READ_AHEAD, DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMultiFileSrc:prefetch:
+   *
+   * Number of upcoming files to read in parallel on background threads.
+   * This hides the open and read latency of network storage, at the cost
+   * of keeping up to this many files in memory.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, ARG_PREFETCH,
+      g_param_spec_uint ("prefetch", "Prefetch",
+          "Number of upcoming files to read in parallel (0 = disabled)",
+          0, MAX_PREFETCH, DEFAULT_PREFETCH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gobject_class->dispose = gst_multi_file_src_dispose;
+  gobject_class->finalize = gst_multi_file_src_finalize;
 
   gstbasesrc_class->get_caps = gst_multi_file_src_getcaps;
   gstbasesrc_class->query = gst_multi_file_src_query;
   gstbasesrc_class->is_seekable = is_seekable;
   gstbasesrc_class->do_seek = do_seek;
+  gstbasesrc_class->stop = gst_multi_file_src_stop;
+  gstbasesrc_class->unlock = gst_multi_file_src_unlock;
+  gstbasesrc_class->unlock_stop = gst_multi_file_src_unlock_stop;
 
   gstpushsrc_class->create = gst_multi_file_src_create;
 
@@ -205,7 +283,13 @@ gst_multi_file_src_init (GstMultiFileSrc * multifilesrc)
   multifilesrc->filename = g_strdup (DEFAULT_LOCATION);
   multifilesrc->successful_read = FALSE;
   multifilesrc->fps_n = multifilesrc->fps_d = -1;
-
+  multifilesrc->use_mmap = DEFAULT_USE_MMAP;
+  multifilesrc->read_ahead = DEFAULT_READ_AHEAD;
+  g_queue_init (&multifilesrc->mapped);
+  multifilesrc->prefetch = DEFAULT_PREFETCH;
+  g_mutex_init (&multifilesrc->prefetch_lock);
+  g_cond_init (&multifilesrc->prefetch_cond);
+  g_queue_init (&multifilesrc->prefetched);
 }
 
 static void
@@ -217,10 +301,22 @@ gst_multi_file_src_dispose (GObject * object)
   src->filename = NULL;
   if (src->caps)
     gst_caps_unref (src->caps);
+  gst_multi_file_src_clear_mapped (src);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_multi_file_src_finalize (GObject * object)
+{
+  GstMultiFileSrc *src = GST_MULTI_FILE_SRC (object);
+
+  g_mutex_clear (&src->prefetch_lock);
+  g_cond_clear (&src->prefetch_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static GstCaps *
 gst_multi_file_src_getcaps (GstBaseSrc * src, GstCaps * filter)
 {
@@ -336,6 +432,15 @@ gst_multi_file_src_set_property (GObject * object, guint prop_id,
     case ARG_LOOP:
       src->loop = g_value_get_boolean (value);
       break;
+    case ARG_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
+    case ARG_READ_AHEAD:
+      src->read_ahead = g_value_get_uint (value);
+      break;
+    case ARG_PREFETCH:
+      src->prefetch = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -367,6 +472,15 @@ gst_multi_file_src_get_property (GObject * object, guint prop_id,
     case ARG_LOOP:
       g_value_set_boolean (value, src->loop);
       break;
+    case ARG_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
+    case ARG_READ_AHEAD:
+      g_value_set_uint (value, src->read_ahead);
+      break;
+    case ARG_PREFETCH:
+      g_value_set_uint (value, src->prefetch);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -384,15 +498,380 @@ gst_multi_file_src_get_filename (GstMultiFileSrc * multifilesrc)
   return filename;
 }
 
+static void
+gst_multi_file_src_advise (GstMultiFileSrc * src, GMappedFile * file)
+{
+#ifdef HAVE_MADVISE
+  gchar *data;
+  gsize size;
+
+  data = g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+  if (data == NULL || size == 0)
+    return;
+
+  if (madvise (data, size, MADV_SEQUENTIAL) != 0 ||
+      madvise (data, size, MADV_WILLNEED) != 0)
+    GST_DEBUG_OBJECT (src, "madvise failed: %s", g_strerror (errno));
+#endif
+}
+
+static GMappedFile *
+gst_multi_file_src_map_file (GstMultiFileSrc * src, const gchar * filename,
+    GError ** error)
+{
+  GMappedFile *file;
+
+  file = g_mapped_file_new (filename, FALSE, error);
+  if (file != NULL)
+    gst_multi_file_src_advise (src, file);
+
+  return file;
+}
+
+static void
+gst_multi_file_src_clear_mapped (GstMultiFileSrc * src)
+{
+  GstMultiFileSrcMapped *mapped;
+
+  while ((mapped = g_queue_pop_head (&src->mapped))) {
+    g_mapped_file_unref (mapped->file);
+    g_slice_free (GstMultiFileSrcMapped, mapped);
+  }
+}
+
+/* returns the file mapped in advance for @index, if any */
+static GMappedFile *
+gst_multi_file_src_take_mapped (GstMultiFileSrc * src, gint index)
+{
+  GstMultiFileSrcMapped *mapped;
+  GMappedFile *file;
+
+  mapped = g_queue_peek_head (&src->mapped);
+  if (mapped == NULL)
+    return NULL;
+
+  if (mapped->index != index) {
+    /* we seeked or looped, start over */
+    GST_DEBUG_OBJECT (src, "dropping files mapped from index %d",
+        mapped->index);
+    gst_multi_file_src_clear_mapped (src);
+    return NULL;
+  }
+
+  g_queue_pop_head (&src->mapped);
+  file = mapped->file;
+  g_slice_free (GstMultiFileSrcMapped, mapped);
+
+  return file;
+}
+
+/* map the files following the current index so that the kernel starts
+ * reading them in the background */
+static void
+gst_multi_file_src_read_ahead (GstMultiFileSrc * src)
+{
+  GstMultiFileSrcMapped *mapped;
+  gint index;
+
+  mapped = g_queue_peek_tail (&src->mapped);
+  index = mapped ? mapped->index + 1 : src->index;
+
+  while (g_queue_get_length (&src->mapped) < src->read_ahead) {
+    GMappedFile *file;
+    gchar *filename;
+
+    if (src->stop_index != -1 && index > src->stop_index)
+      break;
+
+    filename = g_strdup_printf (src->filename, index);
+    file = gst_multi_file_src_map_file (src, filename, NULL);
+    g_free (filename);
+
+    /* most likely the end of the sequence */
+    if (file == NULL)
+      break;
+
+    GST_LOG_OBJECT (src, "mapped index %d in advance", index);
+
+    mapped = g_slice_new (GstMultiFileSrcMapped);
+    mapped->index = index++;
+    mapped->file = file;
+    g_queue_push_tail (&src->mapped, mapped);
+  }
+}
+
+static GstBuffer *
+gst_multi_file_src_wrap_mapped (GMappedFile * file)
+{
+  GstBuffer *buf;
+  gsize size;
+
+  size = g_mapped_file_get_length (file);
+
+  buf = gst_buffer_new ();
+  if (size > 0) {
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+            g_mapped_file_get_contents (file), size, 0, size, file,
+            (GDestroyNotify) g_mapped_file_unref));
+  } else {
+    g_mapped_file_unref (file);
+  }
+
+  return buf;
+}
+
+/* does not touch any state besides the properties, so it can also be used
+ * from the prefetch threads */
+static gboolean
+gst_multi_file_src_load_file (GstMultiFileSrc * src, const gchar * filename,
+    GstBuffer ** buffer, GError ** error)
+{
+  GstBuffer *buf;
+  gchar *data;
+  gsize size;
+
+  if (src->use_mmap) {
+    GMappedFile *file;
+
+    file = gst_multi_file_src_map_file (src, filename, error);
+    if (file == NULL)
+      return FALSE;
+
+    buf = gst_multi_file_src_wrap_mapped (file);
+  } else {
+    if (!g_file_get_contents (filename, &data, &size, error))
+      return FALSE;
+
+    buf = gst_buffer_new ();
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
+  }
+
+  *buffer = buf;
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_src_read_file (GstMultiFileSrc * src, const gchar * filename,
+    GstBuffer ** buffer, GError ** error)
+{
+  GMappedFile *file;
+
+  if (src->use_mmap) {
+    file = gst_multi_file_src_take_mapped (src, src->index);
+    if (file != NULL) {
+      *buffer = gst_multi_file_src_wrap_mapped (file);
+      return TRUE;
+    }
+  }
+
+  return gst_multi_file_src_load_file (src, filename, buffer, error);
+}
+
+static void
+gst_multi_file_src_prefetch_free (GstMultiFileSrcPrefetch * entry)
+{
+  g_free (entry->filename);
+  if (entry->buffer)
+    gst_buffer_unref (entry->buffer);
+  if (entry->error)
+    g_error_free (entry->error);
+  g_slice_free (GstMultiFileSrcPrefetch, entry);
+}
+
+static void
+gst_multi_file_src_prefetch_func (gpointer data, gpointer user_data)
+{
+  GstMultiFileSrcPrefetch *entry = data;
+  GstMultiFileSrc *src = user_data;
+  GstBuffer *buf = NULL;
+  GError *error = NULL;
+  gboolean cancelled;
+
+  g_mutex_lock (&src->prefetch_lock);
+  cancelled = entry->cancelled;
+  g_mutex_unlock (&src->prefetch_lock);
+
+  if (!cancelled) {
+    GST_LOG_OBJECT (src, "prefetching \"%s\"", entry->filename);
+    gst_multi_file_src_load_file (src, entry->filename, &buf, &error);
+  }
+
+  g_mutex_lock (&src->prefetch_lock);
+  entry->buffer = buf;
+  entry->error = error;
+  entry->done = TRUE;
+  if (entry->cancelled)
+    gst_multi_file_src_prefetch_free (entry);
+  else
+    g_cond_broadcast (&src->prefetch_cond);
+  g_mutex_unlock (&src->prefetch_lock);
+}
+
+/* call with prefetch_lock */
+static void
+gst_multi_file_src_clear_prefetched (GstMultiFileSrc * src)
+{
+  GstMultiFileSrcPrefetch *entry;
+
+  while ((entry = g_queue_pop_head (&src->prefetched))) {
+    if (entry->done)
+      gst_multi_file_src_prefetch_free (entry);
+    else
+      entry->cancelled = TRUE;
+  }
+}
+
+/* call with prefetch_lock */
+static void
+gst_multi_file_src_prefetch_index (GstMultiFileSrc * src, gint index)
+{
+  GstMultiFileSrcPrefetch *entry;
+
+  entry = g_slice_new0 (GstMultiFileSrcPrefetch);
+  entry->index = index;
+  entry->filename = g_strdup_printf (src->filename, index);
+  g_queue_push_tail (&src->prefetched, entry);
+
+  g_thread_pool_push (src->prefetch_pool, entry, NULL);
+}
+
+/* the index create() will use after @index, or -1 at the end */
+static gint
+gst_multi_file_src_next_index (GstMultiFileSrc * src, gint index)
+{
+  index++;
+  if (src->stop_index != -1 && index > src->stop_index) {
+    if (!src->loop)
+      return -1;
+    index = src->start_index;
+  }
+
+  return index;
+}
+
+static GstFlowReturn
+gst_multi_file_src_fetch_file (GstMultiFileSrc * src, const gchar * filename,
+    GstBuffer ** buffer, GError ** error)
+{
+  GstMultiFileSrcPrefetch *entry, *tail;
+  gint index;
+
+  if (src->prefetch == 0) {
+    if (!gst_multi_file_src_read_file (src, filename, buffer, error))
+      return GST_FLOW_ERROR;
+    return GST_FLOW_OK;
+  }
+
+  if (src->prefetch_pool == NULL) {
+    src->prefetch_pool = g_thread_pool_new (gst_multi_file_src_prefetch_func,
+        src, src->prefetch, FALSE, error);
+    if (src->prefetch_pool == NULL)
+      return GST_FLOW_ERROR;
+  } else if (g_thread_pool_get_max_threads (src->prefetch_pool) !=
+      (gint) src->prefetch) {
+    g_thread_pool_set_max_threads (src->prefetch_pool, src->prefetch, NULL);
+  }
+
+  g_mutex_lock (&src->prefetch_lock);
+  entry = g_queue_peek_head (&src->prefetched);
+  if (entry == NULL || entry->index != src->index) {
+    /* first file, or we seeked or looped */
+    if (entry != NULL)
+      GST_DEBUG_OBJECT (src, "dropping files prefetched from index %d",
+          entry->index);
+    gst_multi_file_src_clear_prefetched (src);
+    gst_multi_file_src_prefetch_index (src, src->index);
+    entry = g_queue_peek_head (&src->prefetched);
+  }
+
+  /* keep the next files in flight, but don't read on past a missing one */
+  while (g_queue_get_length (&src->prefetched) <= src->prefetch) {
+    tail = g_queue_peek_tail (&src->prefetched);
+    if (tail->done && tail->buffer == NULL)
+      break;
+    index = gst_multi_file_src_next_index (src, tail->index);
+    if (index < 0)
+      break;
+    gst_multi_file_src_prefetch_index (src, index);
+  }
+
+  while (!entry->done && !src->flushing)
+    g_cond_wait (&src->prefetch_cond, &src->prefetch_lock);
+
+  if (!entry->done) {
+    g_mutex_unlock (&src->prefetch_lock);
+    return GST_FLOW_FLUSHING;
+  }
+
+  g_queue_pop_head (&src->prefetched);
+  g_mutex_unlock (&src->prefetch_lock);
+
+  *buffer = entry->buffer;
+  entry->buffer = NULL;
+  g_propagate_error (error, entry->error);
+  entry->error = NULL;
+  gst_multi_file_src_prefetch_free (entry);
+
+  return *buffer ? GST_FLOW_OK : GST_FLOW_ERROR;
+}
+
+static gboolean
+gst_multi_file_src_stop (GstBaseSrc * src)
+{
+  GstMultiFileSrc *multifilesrc = GST_MULTI_FILE_SRC (src);
+
+  gst_multi_file_src_clear_mapped (multifilesrc);
+
+  g_mutex_lock (&multifilesrc->prefetch_lock);
+  gst_multi_file_src_clear_prefetched (multifilesrc);
+  g_mutex_unlock (&multifilesrc->prefetch_lock);
+
+  /* the cancelled entries are skipped, so this returns quickly */
+  if (multifilesrc->prefetch_pool) {
+    g_thread_pool_free (multifilesrc->prefetch_pool, FALSE, TRUE);
+    multifilesrc->prefetch_pool = NULL;
+  }
+  multifilesrc->flushing = FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_src_unlock (GstBaseSrc * src)
+{
+  GstMultiFileSrc *multifilesrc = GST_MULTI_FILE_SRC (src);
+
+  g_mutex_lock (&multifilesrc->prefetch_lock);
+  multifilesrc->flushing = TRUE;
+  g_cond_broadcast (&multifilesrc->prefetch_cond);
+  g_mutex_unlock (&multifilesrc->prefetch_lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_multi_file_src_unlock_stop (GstBaseSrc * src)
+{
+  GstMultiFileSrc *multifilesrc = GST_MULTI_FILE_SRC (src);
+
+  g_mutex_lock (&multifilesrc->prefetch_lock);
+  multifilesrc->flushing = FALSE;
+  g_mutex_unlock (&multifilesrc->prefetch_lock);
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_multi_file_src_create (GstPushSrc * src, GstBuffer ** buffer)
 {
   GstMultiFileSrc *multifilesrc;
   gsize size;
-  gchar *data;
   gchar *filename;
   GstBuffer *buf;
-  gboolean ret;
+  GstFlowReturn ret;
   GError *error = NULL;
 
   multifilesrc = GST_MULTI_FILE_SRC (src);
@@ -413,8 +892,10 @@ gst_multi_file_src_create (GstPushSrc * src, GstBuffer ** buffer)
 
   GST_DEBUG_OBJECT (multifilesrc, "reading from file \"%s\".", filename);
 
-  ret = g_file_get_contents (filename, &data, &size, &error);
-  if (!ret) {
+  ret = gst_multi_file_src_fetch_file (multifilesrc, filename, &buf, &error);
+  if (ret == GST_FLOW_FLUSHING)
+    goto flushing;
+  if (ret != GST_FLOW_OK) {
     if (multifilesrc->successful_read) {
       /* If we've read at least one buffer successfully, not finding the
        * next file is EOS. */
@@ -427,8 +908,11 @@ gst_multi_file_src_create (GstPushSrc * src, GstBuffer ** buffer)
         multifilesrc->index = multifilesrc->start_index;
 
         filename = gst_multi_file_src_get_filename (multifilesrc);
-        ret = g_file_get_contents (filename, &data, &size, &error);
-        if (!ret) {
+        ret = gst_multi_file_src_fetch_file (multifilesrc, filename, &buf,
+            &error);
+        if (ret == GST_FLOW_FLUSHING)
+          goto flushing;
+        if (ret != GST_FLOW_OK) {
           g_free (filename);
           if (error != NULL)
             g_error_free (error);
@@ -446,9 +930,11 @@ gst_multi_file_src_create (GstPushSrc * src, GstBuffer ** buffer)
   multifilesrc->successful_read = TRUE;
   multifilesrc->index++;
 
-  buf = gst_buffer_new ();
-  gst_buffer_append_memory (buf,
-      gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
+  if (multifilesrc->use_mmap && multifilesrc->read_ahead > 0 &&
+      multifilesrc->prefetch == 0)
+    gst_multi_file_src_read_ahead (multifilesrc);
+
+  size = gst_buffer_get_size (buf);
   GST_BUFFER_OFFSET (buf) = multifilesrc->offset;
   GST_BUFFER_OFFSET_END (buf) = multifilesrc->offset + size;
   multifilesrc->offset += size;
@@ -474,4 +960,10 @@ handle_error:
     g_free (filename);
     return GST_FLOW_ERROR;
   }
+flushing:
+  {
+    GST_DEBUG_OBJECT (multifilesrc, "flushing");
+    g_free (filename);
+    return GST_FLOW_FLUSHING;
+  }
 }
@@ -58,6 +58,17 @@ struct _GstMultiFileSrc
   gboolean successful_read;
 
   gint fps_n, fps_d;
+
+  gboolean use_mmap;
+  guint read_ahead;
+  GQueue mapped;  /* GstMultiFileSrcMapped for upcoming indices */
+
+  guint prefetch;
+  GThreadPool *prefetch_pool;
+  GMutex prefetch_lock;
+  GCond prefetch_cond;
+  GQueue prefetched;  /* GstMultiFileSrcPrefetch, in index order */
+  gboolean flushing;
 };
 
 struct _GstMultiFileSrcClass
@@ -49,6 +49,11 @@
 
 #include <string.h>
 
+#ifdef HAVE_MADVISE
+#include <errno.h>
+#include <sys/mman.h>
+#endif
+
 #ifdef G_OS_WIN32
 #define DEFAULT_PATTERN_MATCH_MODE MATCH_MODE_UTF8
 #else
@@ -57,10 +62,12 @@
 
 enum
 {
-  PROP_LOCATION = 1
+  PROP_LOCATION = 1,
+  PROP_USE_MMAP
 };
 
 #define DEFAULT_LOCATION NULL
+#define DEFAULT_USE_MMAP FALSE
 
 static void gst_split_file_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -117,6 +124,20 @@ gst_split_file_src_class_init (GstSplitFileSrcClass * klass)
           "matching. The results will be sorted." WIN32_BLURB,
           DEFAULT_LOCATION, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSplitFileSrc:use-mmap:
+   *
+   * Map the file parts into memory and push the mapped pages downstream
+   * instead of reading into newly allocated buffers. The files must not be
+   * truncated while they are being read.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Map the files into memory instead of reading them",
+          DEFAULT_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_split_file_src_start);
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_split_file_src_stop);
   gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_split_file_src_create);
@@ -140,6 +161,7 @@ gst_split_file_src_class_init (GstSplitFileSrcClass * klass)
 static void
 gst_split_file_src_init (GstSplitFileSrc * splitfilesrc)
 {
+  splitfilesrc->use_mmap = DEFAULT_USE_MMAP;
 }
 
 static void
@@ -213,6 +235,9 @@ gst_split_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_split_file_src_set_location (src, g_value_get_string (value));
       break;
+    case PROP_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -231,6 +256,9 @@ gst_split_file_src_get_property (GObject * object, guint prop_id,
       g_value_set_string (value, src->location);
       GST_OBJECT_UNLOCK (src);
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -315,6 +343,65 @@ no_matches:
   }
 }
 
+static void
+gst_split_file_src_unmap_parts (GstSplitFileSrc * src)
+{
+  guint i;
+
+  for (i = 0; i < src->num_parts; ++i) {
+    if (src->parts[i].mapped != NULL) {
+      g_mapped_file_unref (src->parts[i].mapped);
+      src->parts[i].mapped = NULL;
+    }
+  }
+  src->mapped = FALSE;
+}
+
+static gboolean
+gst_split_file_src_map_parts (GstSplitFileSrc * src)
+{
+  GstFilePart *part;
+  GError *err = NULL;
+  guint i;
+
+  for (i = 0; i < src->num_parts; ++i) {
+    part = &src->parts[i];
+
+    part->mapped = g_mapped_file_new (part->path, FALSE, &err);
+    if (part->mapped == NULL)
+      goto map_failed;
+
+    if (g_mapped_file_get_length (part->mapped) != part->stop + 1 - part->start)
+      goto size_changed;
+
+#ifdef HAVE_MADVISE
+    if (g_mapped_file_get_length (part->mapped) > 0 &&
+        madvise (g_mapped_file_get_contents (part->mapped),
+            g_mapped_file_get_length (part->mapped), MADV_SEQUENTIAL) != 0)
+      GST_DEBUG_OBJECT (src, "madvise failed: %s", g_strerror (errno));
+#endif
+  }
+
+  src->mapped = TRUE;
+  return TRUE;
+
+/* ERRORS */
+map_failed:
+  {
+    GST_WARNING_OBJECT (src, "Failed to map file '%s': %s", part->path,
+        err->message);
+    g_error_free (err);
+    gst_split_file_src_unmap_parts (src);
+    return FALSE;
+  }
+size_changed:
+  {
+    GST_WARNING_OBJECT (src, "File '%s' changed size", part->path);
+    gst_split_file_src_unmap_parts (src);
+    return FALSE;
+  }
+}
+
 static gboolean
 gst_split_file_src_start (GstBaseSrc * basesrc)
 {
@@ -383,6 +470,9 @@ gst_split_file_src_start (GstBaseSrc * basesrc)
 
   src->cur_part = 0;
 
+  if (src->use_mmap && !gst_split_file_src_map_parts (src))
+    GST_WARNING_OBJECT (src, "Could not map file parts, reading them instead");
+
   src->cancellable = g_cancellable_new ();
 
   ret = TRUE;
@@ -437,6 +527,8 @@ gst_split_file_src_stop (GstBaseSrc * basesrc)
   GstSplitFileSrc *src = GST_SPLIT_FILE_SRC (basesrc);
   guint i;
 
+  gst_split_file_src_unmap_parts (src);
+
   for (i = 0; i < src->num_parts; ++i) {
     if (src->parts[i].stream != NULL)
       g_object_unref (src->parts[i].stream);
@@ -472,6 +564,57 @@ gst_split_file_src_find_part_for_offset (GstSplitFileSrc * src, guint64 offset,
   return FALSE;
 }
 
+/* wraps the mapped pages of the file parts, no copying involved */
+static GstFlowReturn
+gst_split_file_src_create_mapped (GstSplitFileSrc * src, guint64 offset,
+    guint size, GstBuffer ** buffer)
+{
+  GstFilePart *part;
+  GstBuffer *buf;
+
+  buf = gst_buffer_new ();
+  GST_BUFFER_OFFSET (buf) = offset;
+
+  while (size > 0) {
+    guint64 bytes_to_end_of_part;
+    guint64 read_offset;
+    guint to_read;
+
+    part = &src->parts[src->cur_part];
+    read_offset = offset - part->start;
+    bytes_to_end_of_part = (part->stop - part->start) + 1 - read_offset;
+    to_read = MIN (size, bytes_to_end_of_part);
+
+    GST_LOG_OBJECT (src, "wrapping %u bytes from part %u at offset %"
+        G_GUINT64_FORMAT, to_read, src->cur_part, read_offset);
+
+    if (to_read > 0) {
+      gst_buffer_append_memory (buf,
+          gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+              g_mapped_file_get_contents (part->mapped),
+              g_mapped_file_get_length (part->mapped), read_offset, to_read,
+              g_mapped_file_ref (part->mapped),
+              (GDestroyNotify) g_mapped_file_unref));
+    }
+
+    size -= to_read;
+    offset += to_read;
+
+    /* are we done? */
+    if (size == 0 || src->cur_part == src->num_parts - 1)
+      break;
+
+    ++src->cur_part;
+  }
+
+  GST_BUFFER_OFFSET_END (buf) = offset;
+
+  *buffer = buf;
+  GST_LOG_OBJECT (src, "wrapped %" G_GSIZE_FORMAT " bytes into buf %p",
+      gst_buffer_get_size (buf), buf);
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_split_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint size,
     GstBuffer ** buffer)
@@ -499,6 +642,9 @@ gst_split_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint size,
       "%" G_GUINT64_FORMAT ", %s)", src->cur_part, cur_part.start,
       cur_part.stop, cur_part.path);
 
+  if (src->mapped)
+    return gst_split_file_src_create_mapped (src, offset, size, buffer);
+
   buf = gst_buffer_new_allocate (NULL, size, NULL);
 
   GST_BUFFER_OFFSET (buf) = offset;
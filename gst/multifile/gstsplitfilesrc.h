@@ -43,6 +43,7 @@ typedef struct _GstSplitFileSrcClass GstSplitFileSrcClass;
 struct _GstFilePart
 {
   GFileInputStream  *stream;
+  GMappedFile       *mapped;
   gchar             *path;
   guint64            start; /* inclusive */
   guint64            stop;  /* inclusive */
@@ -60,6 +61,9 @@ struct _GstSplitFileSrc
   guint        cur_part;  /* part used last (likely also to be used next) */
 
   GCancellable *cancellable; /* so we can interrupt blocking operations */
+
+  gboolean     use_mmap;
+  gboolean     mapped;    /* all parts are mapped into memory */
 };
 
 struct _GstSplitFileSrcClass
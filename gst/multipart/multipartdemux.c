@@ -486,8 +486,10 @@ static gint
 multipart_find_boundary (GstMultipartDemux * multipart, gint * datalen)
 {
   /* Adaptor is positioned at the start of the data */
-  const guint8 *data, *pos;
-  const guint8 *dataend;
+  const guint8 *data;
+  guint8 *cmp;
+  guint32 pattern, mask;
+  gboolean found;
   gint len;
 
   if (multipart->content_length >= 0) {
@@ -514,31 +516,67 @@ multipart_find_boundary (GstMultipartDemux * multipart, gint * datalen)
   }
 
   len = gst_adapter_available (multipart->adapter);
-  if (len == 0)
-    return MULTIPART_NEED_MORE_DATA;
-  data = gst_adapter_map (multipart->adapter, len);
-  dataend = data + len;
-
-  for (pos = data + multipart->scanpos;
-      pos <= dataend - multipart->boundary_len - 2; pos++) {
-    if (*pos == '-' && pos[1] == '-' &&
-        !strncmp ((gchar *) pos + 2,
-            multipart->boundary, multipart->boundary_len)) {
+
+  /* scan for "--" and the first two bytes of the boundary without merging
+   * the adapter, only candidates are copied out and compared in full */
+  mask = 0xffffffff;
+  pattern = ('-' << 24) | ('-' << 16);
+  if (multipart->boundary_len > 0)
+    pattern |= (guint8) multipart->boundary[0] << 8;
+  else
+    mask &= 0xffff00ff;
+  if (multipart->boundary_len > 1)
+    pattern |= (guint8) multipart->boundary[1];
+  else
+    mask &= 0xffffff00;
+
+  while (len - multipart->scanpos >= 4) {
+    gint off;
+
+    off = gst_adapter_masked_scan_uint32 (multipart->adapter, mask, pattern,
+        multipart->scanpos, len - multipart->scanpos);
+    if (off < 0) {
+      /* no match starting before the last 3 bytes, continue from there
+       * when more data arrives */
+      multipart->scanpos = len - 3;
+      return MULTIPART_NEED_MORE_DATA;
+    }
+
+    if (off + 2 + multipart->boundary_len > len) {
+      /* candidate needs more data to be checked */
+      multipart->scanpos = off;
+      return MULTIPART_NEED_MORE_DATA;
+    }
+
+    cmp = g_malloc (multipart->boundary_len);
+    gst_adapter_copy (multipart->adapter, cmp, off + 2,
+        multipart->boundary_len);
+    found = memcmp (cmp, multipart->boundary, multipart->boundary_len) == 0;
+    g_free (cmp);
+
+    if (found) {
+      guint8 nl[2];
+
       /* Found the boundary! Check if there was a newline before the boundary */
-      len = pos - data;
-      if (pos - 2 > data && pos[-2] == '\r')
-        len -= 2;
-      else if (pos - 1 > data && pos[-1] == '\n')
-        len -= 1;
+      len = off;
+      if (off > 2) {
+        gst_adapter_copy (multipart->adapter, nl, off - 2, 2);
+        if (nl[0] == '\r')
+          len -= 2;
+        else if (nl[1] == '\n')
+          len -= 1;
+      } else if (off > 1) {
+        gst_adapter_copy (multipart->adapter, nl, off - 1, 1);
+        if (nl[0] == '\n')
+          len -= 1;
+      }
       *datalen = len;
 
-      gst_adapter_unmap (multipart->adapter);
       multipart->scanpos = 0;
-      return pos - data;
+      return off;
     }
+    multipart->scanpos = off + 1;
   }
-  gst_adapter_unmap (multipart->adapter);
-  multipart->scanpos = pos - data;
   return MULTIPART_NEED_MORE_DATA;
 }
 
@@ -564,6 +602,7 @@ gst_multipart_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       srcpad->discont = TRUE;
     }
     gst_adapter_clear (adapter);
+    multipart->scanpos = 0;
   }
   gst_adapter_push (adapter, buf);
 
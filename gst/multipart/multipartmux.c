@@ -175,6 +175,13 @@ gst_multipart_mux_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_multipart_mux_pad_data_free (GstMultipartPadData * data)
+{
+  g_free (data->header_prefix);
+  data->header_prefix = NULL;
+}
+
 static GstPad *
 gst_multipart_mux_request_new_pad (GstElement * element,
     GstPadTemplate * templ, const gchar * req_name, const GstCaps * caps)
@@ -201,7 +208,8 @@ gst_multipart_mux_request_new_pad (GstElement * element,
 
     multipartpad = (GstMultipartPadData *)
         gst_collect_pads_add_pad (multipart_mux->collect, newpad,
-        sizeof (GstMultipartPadData), NULL, TRUE);
+        sizeof (GstMultipartPadData),
+        (GstCollectDataDestroyNotify) gst_multipart_mux_pad_data_free, TRUE);
 
     /* save a pointer to our data in the pad */
     multipartpad->pad = newpad;
@@ -415,9 +423,8 @@ gst_multipart_mux_collected (GstCollectPads * pads, GstMultipartMux * mux)
   GstMultipartPadData *best;
   GstFlowReturn ret = GST_FLOW_OK;
   gchar *header = NULL;
-  size_t headerlen;
-  GstBuffer *headerbuf = NULL;
-  GstBuffer *footerbuf = NULL;
+  gsize headerlen;
+  GstBuffer *partbuf = NULL;
   GstBuffer *databuf = NULL;
   GstStructure *structure = NULL;
   GstCaps *caps;
@@ -493,65 +500,49 @@ gst_multipart_mux_collected (GstCollectPads * pads, GstMultipartMux * mux)
   mime = gst_multipart_mux_get_mime (mux, structure);
   gst_caps_unref (caps);
 
-  header = g_strdup_printf ("--%s\r\nContent-Type: %s\r\n"
-      "Content-Length: %" G_GSIZE_FORMAT "\r\n\r\n",
-      mux->boundary, mime, gst_buffer_get_size (best->buffer));
-  headerlen = strlen (header);
-
-  headerbuf = gst_buffer_new_allocate (NULL, headerlen, NULL);
-  gst_buffer_fill (headerbuf, 0, header, headerlen);
-  g_free (header);
-
-  /* the header has the same timestamp as the data buffer (which we will push
-   * below) and has a duration of 0 */
-  GST_BUFFER_TIMESTAMP (headerbuf) = best->timestamp;
-  GST_BUFFER_DURATION (headerbuf) = 0;
-  GST_BUFFER_OFFSET (headerbuf) = mux->offset;
-  mux->offset += headerlen;
-  GST_BUFFER_OFFSET_END (headerbuf) = mux->offset;
+  /* the part header only changes with the mime type and boundary, keep
+   * everything up to the Content-Length value around */
+  if (best->mime != mime) {
+    g_free (best->header_prefix);
+    best->header_prefix = g_strdup_printf ("--%s\r\nContent-Type: %s\r\n"
+        "Content-Length: ", mux->boundary, mime);
+    best->header_prefix_len = strlen (best->header_prefix);
+    best->mime = mime;
+  }
 
-  GST_DEBUG_OBJECT (mux, "pushing %" G_GSIZE_FORMAT " bytes header buffer",
-      headerlen);
-  ret = gst_pad_push (mux->srcpad, headerbuf);
-  if (ret != GST_FLOW_OK)
-    /* push always takes ownership of the buffer, even after an error, so we
-     * don't need to unref headerbuf here. */
-    goto beach;
+  header = g_malloc (best->header_prefix_len + 24);
+  memcpy (header, best->header_prefix, best->header_prefix_len);
+  headerlen = best->header_prefix_len +
+      g_snprintf (header + best->header_prefix_len, 24,
+      "%" G_GSIZE_FORMAT "\r\n\r\n", gst_buffer_get_size (best->buffer));
 
   /* take best->buffer, we don't need to unref it later as we will push it
    * now. */
-  databuf = gst_buffer_make_writable (best->buffer);
+  databuf = best->buffer;
   best->buffer = NULL;
 
-  /* we need to updated the timestamp to match the running_time */
-  GST_BUFFER_TIMESTAMP (databuf) = best->timestamp;
-  GST_BUFFER_OFFSET (databuf) = mux->offset;
-  mux->offset += gst_buffer_get_size (databuf);
-  GST_BUFFER_OFFSET_END (databuf) = mux->offset;
-  GST_BUFFER_FLAG_SET (databuf, GST_BUFFER_FLAG_DELTA_UNIT);
-
-  GST_DEBUG_OBJECT (mux, "pushing %" G_GSIZE_FORMAT " bytes data buffer",
-      gst_buffer_get_size (databuf));
-  ret = gst_pad_push (mux->srcpad, databuf);
-  if (ret != GST_FLOW_OK)
-    /* push always takes ownership of the buffer, even after an error, so we
-     * don't need to unref headerbuf here. */
-    goto beach;
-
-  footerbuf = gst_buffer_new_allocate (NULL, 2, NULL);
-  gst_buffer_fill (footerbuf, 0, "\r\n", 2);
-
-  /* the footer has the same timestamp as the data buffer and has a
-   * duration of 0 */
-  GST_BUFFER_TIMESTAMP (footerbuf) = best->timestamp;
-  GST_BUFFER_DURATION (footerbuf) = 0;
-  GST_BUFFER_OFFSET (footerbuf) = mux->offset;
-  mux->offset += 2;
-  GST_BUFFER_OFFSET_END (footerbuf) = mux->offset;
-  GST_BUFFER_FLAG_SET (footerbuf, GST_BUFFER_FLAG_DELTA_UNIT);
-
-  GST_DEBUG_OBJECT (mux, "pushing 2 bytes footer buffer");
-  ret = gst_pad_push (mux->srcpad, footerbuf);
+  /* the part is the header, the memory of the data buffer and the footer
+   * in one buffer, the payload is not copied */
+  partbuf = gst_buffer_new_wrapped_full (0, header,
+      best->header_prefix_len + 24, 0, headerlen, header, g_free);
+  gst_buffer_copy_into (partbuf, databuf, GST_BUFFER_COPY_MEMORY, 0, -1);
+  gst_buffer_append_memory (partbuf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) "\r\n", 2,
+          0, 2, NULL, NULL));
+
+  /* we need to updated the timestamp to match the running_time, the part
+   * starts with a header so it is where a client can start */
+  GST_BUFFER_TIMESTAMP (partbuf) = best->timestamp;
+  GST_BUFFER_DURATION (partbuf) = GST_BUFFER_DURATION (databuf);
+  GST_BUFFER_OFFSET (partbuf) = mux->offset;
+  mux->offset += gst_buffer_get_size (partbuf);
+  GST_BUFFER_OFFSET_END (partbuf) = mux->offset;
+  gst_buffer_unref (databuf);
+
+  GST_DEBUG_OBJECT (mux, "pushing %" G_GSIZE_FORMAT " bytes part buffer "
+      "with %" G_GSIZE_FORMAT " bytes header", gst_buffer_get_size (partbuf),
+      headerlen);
+  ret = gst_pad_push (mux->srcpad, partbuf);
 
 beach:
   if (best && best->buffer) {
@@ -618,10 +609,19 @@ gst_multipart_mux_set_property (GObject * object,
   mux = GST_MULTIPART_MUX (object);
 
   switch (prop_id) {
-    case ARG_BOUNDARY:
+    case ARG_BOUNDARY:{
+      GSList *walk;
+
       g_free (mux->boundary);
       mux->boundary = g_strdup (g_value_get_string (value));
+
+      /* part headers need to be rebuilt with the new boundary */
+      GST_COLLECT_PADS_STREAM_LOCK (mux->collect);
+      for (walk = mux->collect->data; walk; walk = walk->next)
+        ((GstMultipartPadData *) walk->data)->mime = NULL;
+      GST_COLLECT_PADS_STREAM_UNLOCK (mux->collect);
       break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
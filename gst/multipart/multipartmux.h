@@ -48,6 +48,10 @@ typedef struct
   GstClockTime timestamp;       /* its timestamp, converted to running_time so that we can
                                    correctly sort over multiple segments. */
   GstPad *pad;
+
+  const gchar *mime;            /* mime type the header prefix was made for */
+  gchar *header_prefix;         /* part header up to the Content-Length value */
+  gsize header_prefix_len;
 }
 GstMultipartPadData;
 
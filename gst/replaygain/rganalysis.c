@@ -31,16 +31,13 @@
  * "gain_analysis.c" from vorbisgain version 0.34.
  */
 
-/* Room for future improvement: Mono data is currently in fact copied
- * to two channels which get processed normally.  This means that mono
- * input data is processed twice.
- */
-
 /* Helpful information for understanding this code: The two IIR
  * filters depend on previous input _and_ previous output samples (up
  * to the filter's order number of samples).  This explains the whole
- * lot of memcpy'ing done in rg_analysis_analyze and why the context
- * holds so many buffers.
+ * lot of memcpy'ing done in analyze_frames and why the context holds
+ * so many buffers.  The buffers hold interleaved frames of one lane for
+ * mono or of two lanes for stereo data, both channels of a stereo
+ * frame are filtered side by side.
  */
 
 #include <math.h>
@@ -83,20 +80,16 @@ typedef struct _RgAnalysisAcc RgAnalysisAcc;
 
 struct _RgAnalysisCtx
 {
-  /* Filter buffers for left channel. */
-  gfloat inprebuf_l[MAX_ORDER * 2];
-  gfloat *inpre_l;
-  gfloat stepbuf_l[MAX_SAMPLE_WINDOW + MAX_ORDER];
-  gfloat *step_l;
-  gfloat outbuf_l[MAX_SAMPLE_WINDOW + MAX_ORDER];
-  gfloat *out_l;
-  /* Filter buffers for right channel. */
-  gfloat inprebuf_r[MAX_ORDER * 2];
-  gfloat *inpre_r;
-  gfloat stepbuf_r[MAX_SAMPLE_WINDOW + MAX_ORDER];
-  gfloat *step_r;
-  gfloat outbuf_r[MAX_SAMPLE_WINDOW + MAX_ORDER];
-  gfloat *out_r;
+  /* Filter buffers, in frames of ctx->lanes samples.  The pointers are
+   * placed so that there is room for MAX_ORDER stereo frames before
+   * them. */
+  guint lanes;
+  gfloat inprebuf[MAX_ORDER * 2 * 2];
+  gfloat *inpre;
+  gfloat stepbuf[(MAX_SAMPLE_WINDOW + MAX_ORDER) * 2];
+  gfloat *step;
+  gfloat outbuf[(MAX_SAMPLE_WINDOW + MAX_ORDER) * 2];
+  gfloat *out;
 
   /* Number of samples to reach duration of the RMS window: */
   guint window_n_samples;
@@ -228,81 +221,94 @@ static const gfloat BButter[9][3] = {
 #endif
 
 /* Filter functions.  These access elements with negative indices of
- * the input and output arrays (up to the filter's order). */
+ * the input and output arrays (up to the filter's order).  Input and
+ * output hold interleaved frames of @lanes samples, so the previous
+ * sample of a channel is @lanes elements back.  All lanes go through
+ * the same operations. */
 
 /* For much better performance, the function below has been
  * implemented by unrolling the inner loop for our two use cases. */
 
 /*
  * static inline void
- * apply_filter (const gfloat * input, gfloat * output, guint n_samples,
- *     const gfloat * a, const gfloat * b, guint order)
+ * apply_filter (const gfloat * input, gfloat * output, guint n_frames,
+ *     const gfloat * a, const gfloat * b, guint order, guint lanes)
  * {
  *   gfloat y;
  *   gint i, k;
  * 
- *   for (i = 0; i < n_samples; i++) {
+ *   for (i = 0; i < n_frames * lanes; i++) {
  *     y = input[i] * b[0];
  *     for (k = 1; k <= order; k++)
- *       y += input[i - k] * b[k] - output[i - k] * a[k];
+ *       y += input[i - k * lanes] * b[k] - output[i - k * lanes] * a[k];
  *     output[i] = y;
  *   }
  * }
  */
 
-static inline void
-yule_filter (const gfloat * input, gfloat * output,
-    const gfloat * a, const gfloat * b)
-{
-  /* 1e-10 is added below to avoid running into denormals when operating on
-   * near silence. */
-
-  output[0] = 1e-10 + input[0] * b[0]
-      + input[-1] * b[1] - output[-1] * a[1]
-      + input[-2] * b[2] - output[-2] * a[2]
-      + input[-3] * b[3] - output[-3] * a[3]
-      + input[-4] * b[4] - output[-4] * a[4]
-      + input[-5] * b[5] - output[-5] * a[5]
-      + input[-6] * b[6] - output[-6] * a[6]
-      + input[-7] * b[7] - output[-7] * a[7]
-      + input[-8] * b[8] - output[-8] * a[8]
-      + input[-9] * b[9] - output[-9] * a[9]
-      + input[-10] * b[10] - output[-10] * a[10];
-}
-
-static inline void
-butter_filter (const gfloat * input, gfloat * output,
-    const gfloat * a, const gfloat * b)
-{
-  output[0] = input[0] * b[0]
-      + input[-1] * b[1] - output[-1] * a[1]
-      + input[-2] * b[2] - output[-2] * a[2];
-}
-
-/* Because butter_filter and yule_filter are inlined, this function is
+/* Because butter_filter and yule_filter are inlined, apply_filters is
  * a bit blown-up (code-size wise), but not inlining gives a ca. 40%
  * performance penalty. */
 
-static inline void
-apply_filters (const RgAnalysisCtx * ctx, const gfloat * input_l,
-    const gfloat * input_r, guint n_samples)
-{
-  const gfloat *ayule = AYule[ctx->sample_rate_index];
-  const gfloat *byule = BYule[ctx->sample_rate_index];
-  const gfloat *abutter = AButter[ctx->sample_rate_index];
-  const gfloat *bbutter = BButter[ctx->sample_rate_index];
-  gint pos = ctx->window_n_samples_done;
-  gint i;
-
-  for (i = 0; i < n_samples; i++, pos++) {
-    yule_filter (input_l + i, ctx->step_l + pos, ayule, byule);
-    butter_filter (ctx->step_l + pos, ctx->out_l + pos, abutter, bbutter);
-
-    yule_filter (input_r + i, ctx->step_r + pos, ayule, byule);
-    butter_filter (ctx->step_r + pos, ctx->out_r + pos, abutter, bbutter);
-  }
+#define MAKE_FILTER_FUNCS(lanes) \
+static inline void \
+yule_filter_##lanes (const gfloat * input, gfloat * output, \
+    const gfloat * a, const gfloat * b) \
+{ \
+  gint c; \
+  \
+  /* 1e-10 is added below to avoid running into denormals when operating \
+   * on near silence. */ \
+  \
+  for (c = 0; c < lanes; c++) { \
+    output[c] = 1e-10 + input[c] * b[0] \
+        + input[c - lanes] * b[1] - output[c - lanes] * a[1] \
+        + input[c - 2 * lanes] * b[2] - output[c - 2 * lanes] * a[2] \
+        + input[c - 3 * lanes] * b[3] - output[c - 3 * lanes] * a[3] \
+        + input[c - 4 * lanes] * b[4] - output[c - 4 * lanes] * a[4] \
+        + input[c - 5 * lanes] * b[5] - output[c - 5 * lanes] * a[5] \
+        + input[c - 6 * lanes] * b[6] - output[c - 6 * lanes] * a[6] \
+        + input[c - 7 * lanes] * b[7] - output[c - 7 * lanes] * a[7] \
+        + input[c - 8 * lanes] * b[8] - output[c - 8 * lanes] * a[8] \
+        + input[c - 9 * lanes] * b[9] - output[c - 9 * lanes] * a[9] \
+        + input[c - 10 * lanes] * b[10] - output[c - 10 * lanes] * a[10]; \
+  } \
+} \
+\
+static inline void \
+butter_filter_##lanes (const gfloat * input, gfloat * output, \
+    const gfloat * a, const gfloat * b) \
+{ \
+  gint c; \
+  \
+  for (c = 0; c < lanes; c++) { \
+    output[c] = input[c] * b[0] \
+        + input[c - lanes] * b[1] - output[c - lanes] * a[1] \
+        + input[c - 2 * lanes] * b[2] - output[c - 2 * lanes] * a[2]; \
+  } \
+} \
+\
+static void \
+apply_filters_##lanes (const RgAnalysisCtx * ctx, const gfloat * input, \
+    guint n_frames) \
+{ \
+  const gfloat *ayule = AYule[ctx->sample_rate_index]; \
+  const gfloat *byule = BYule[ctx->sample_rate_index]; \
+  const gfloat *abutter = AButter[ctx->sample_rate_index]; \
+  const gfloat *bbutter = BButter[ctx->sample_rate_index]; \
+  gfloat *step = ctx->step + lanes * ctx->window_n_samples_done; \
+  gfloat *out = ctx->out + lanes * ctx->window_n_samples_done; \
+  guint i; \
+  \
+  for (i = 0; i < n_frames * lanes; i += lanes) { \
+    yule_filter_##lanes (input + i, step + i, ayule, byule); \
+    butter_filter_##lanes (step + i, out + i, abutter, bbutter); \
+  } \
 }
 
+MAKE_FILTER_FUNCS (1);
+MAKE_FILTER_FUNCS (2);
+
 /* Clear filter buffer state and current RMS window. */
 
 static void
@@ -310,16 +316,13 @@ reset_filters (RgAnalysisCtx * ctx)
 {
   gint i;
 
-  for (i = 0; i < MAX_ORDER; i++) {
-
-    ctx->inprebuf_l[i] = 0.;
-    ctx->stepbuf_l[i] = 0.;
-    ctx->outbuf_l[i] = 0.;
-
-    ctx->inprebuf_r[i] = 0.;
-    ctx->stepbuf_r[i] = 0.;
-    ctx->outbuf_r[i] = 0.;
+  for (i = 0; i < MAX_ORDER * 2; i++) {
+    ctx->inprebuf[i] = 0.;
+    ctx->stepbuf[i] = 0.;
+    ctx->outbuf[i] = 0.;
   }
+  /* Without any history, both layouts can be used. */
+  ctx->lanes = 0;
 
   ctx->window_square_sum = 0.;
   ctx->window_n_samples_done = 0;
@@ -398,13 +401,9 @@ rg_analysis_new (void)
 
   ctx = g_new (RgAnalysisCtx, 1);
 
-  ctx->inpre_l = ctx->inprebuf_l + MAX_ORDER;
-  ctx->step_l = ctx->stepbuf_l + MAX_ORDER;
-  ctx->out_l = ctx->outbuf_l + MAX_ORDER;
-
-  ctx->inpre_r = ctx->inprebuf_r + MAX_ORDER;
-  ctx->step_r = ctx->stepbuf_r + MAX_ORDER;
-  ctx->out_r = ctx->outbuf_r + MAX_ORDER;
+  ctx->inpre = ctx->inprebuf + MAX_ORDER * 2;
+  ctx->step = ctx->stepbuf + MAX_ORDER * 2;
+  ctx->out = ctx->outbuf + MAX_ORDER * 2;
 
   ctx->sample_rate = 0;
 
@@ -501,6 +500,154 @@ rg_analysis_destroy (RgAnalysisCtx * ctx)
   g_free (ctx);
 }
 
+/* Spread the @n_samples samples of a mono buffer that end just before
+ * @buf over two lanes, in place. */
+
+static void
+expand_mono_history (gfloat * buf, gint n_samples)
+{
+  gint i;
+
+  for (i = -n_samples; i < 0; i++)
+    buf[2 * i] = buf[2 * i + 1] = buf[i];
+}
+
+/* Switch the context to the given number of lanes if possible and
+ * return the number of lanes the data has to be passed in.  Mono data
+ * is filtered in one lane, but once stereo data has been analyzed, the
+ * histories of the two channels differ and mono data then has to be
+ * copied to both lanes until the filters are reset. */
+
+static guint
+set_lanes (RgAnalysisCtx * ctx, guint lanes)
+{
+  gint i;
+
+  if (ctx->lanes == 0) {
+    ctx->lanes = lanes;
+  } else if (ctx->lanes == 1 && lanes == 2) {
+    /* Both channels of the mono data had the same history so far. */
+    expand_mono_history (ctx->inpre, MAX_ORDER);
+    for (i = ctx->window_n_samples_done; i--;) {
+      ctx->step[2 * i] = ctx->step[2 * i + 1] = ctx->step[i];
+      ctx->out[2 * i] = ctx->out[2 * i + 1] = ctx->out[i];
+    }
+    expand_mono_history (ctx->step, MAX_ORDER);
+    expand_mono_history (ctx->out, MAX_ORDER);
+    ctx->lanes = 2;
+  }
+
+  return ctx->lanes;
+}
+
+/* Analyze interleaved frames of ctx->lanes samples, scaled as for
+ * rg_analysis_analyze. */
+
+static void
+analyze_frames (RgAnalysisCtx * ctx, const gfloat * frames, guint n_frames)
+{
+  guint lanes = ctx->lanes;
+  guint n_frames_done;
+  guint i;
+
+  g_return_if_fail (ctx->sample_rate != 0);
+
+  if (n_frames == 0)
+    return;
+
+  memcpy (ctx->inpre, frames, MIN (n_frames, MAX_ORDER) * lanes
+      * sizeof (gfloat));
+
+  n_frames_done = 0;
+  while (n_frames_done < n_frames) {
+    /* Limit number of frames to be processed in this iteration to
+     * the number needed to complete the next window: */
+    guint n_frames_current = MIN (n_frames - n_frames_done,
+        ctx->window_n_samples - ctx->window_n_samples_done);
+    const gfloat *input, *out;
+
+    if (n_frames_done < MAX_ORDER) {
+      input = ctx->inpre + n_frames_done * lanes;
+      n_frames_current = MIN (n_frames_current, MAX_ORDER - n_frames_done);
+    } else {
+      input = frames + n_frames_done * lanes;
+    }
+
+    if (lanes == 1)
+      apply_filters_1 (ctx, input, n_frames_current);
+    else
+      apply_filters_2 (ctx, input, n_frames_current);
+
+    /* Update the square sum.  A mono sample counts for both channels,
+     * which gives the same sum as the stereo lanes. */
+    out = ctx->out + ctx->window_n_samples_done * lanes;
+    if (lanes == 1) {
+      for (i = 0; i < n_frames_current; i++)
+        ctx->window_square_sum += out[i] * out[i] + out[i] * out[i];
+    } else {
+      for (i = 0; i < n_frames_current * 2; i += 2)
+        ctx->window_square_sum += out[i] * out[i] + out[i + 1] * out[i + 1];
+    }
+
+    ctx->window_n_samples_done += n_frames_current;
+    ctx->buffer_n_samples_done += n_frames_current;
+
+    g_return_if_fail (ctx->window_n_samples_done <= ctx->window_n_samples);
+
+    if (ctx->window_n_samples_done == ctx->window_n_samples) {
+      /* Get the Root Mean Square (RMS) for this set of samples. */
+      gdouble val = STEPS_PER_DB * 10. * log10 (ctx->window_square_sum /
+          ctx->window_n_samples * 0.5 + 1.e-37);
+      gint ival = CLAMP ((gint) val, 0,
+          (gint) G_N_ELEMENTS (ctx->track.histogram) - 1);
+      /* Compute the per-window gain */
+      const gdouble gain = PINK_REF - (gdouble) ival / STEPS_PER_DB;
+      const GstClockTime timestamp = ctx->buffer_timestamp
+          + gst_util_uint64_scale_int_ceil (GST_SECOND,
+          ctx->buffer_n_samples_done,
+          ctx->sample_rate)
+          - RMS_WINDOW_MSECS * GST_MSECOND;
+
+      ctx->post_message (ctx->analysis, timestamp,
+          RMS_WINDOW_MSECS * GST_MSECOND, -gain);
+
+
+      ctx->track.histogram[ival]++;
+      ctx->window_square_sum = 0.;
+      ctx->window_n_samples_done = 0;
+
+      /* No need for memmove here, the areas never overlap: Even for
+       * the smallest sample rate, the number of samples needed for
+       * the window is greater than MAX_ORDER. */
+
+      memcpy (ctx->step - MAX_ORDER * lanes,
+          ctx->step + (ctx->window_n_samples - MAX_ORDER) * lanes,
+          MAX_ORDER * lanes * sizeof (gfloat));
+      memcpy (ctx->out - MAX_ORDER * lanes,
+          ctx->out + (ctx->window_n_samples - MAX_ORDER) * lanes,
+          MAX_ORDER * lanes * sizeof (gfloat));
+    }
+
+    n_frames_done += n_frames_current;
+  }
+
+  if (n_frames >= MAX_ORDER) {
+
+    memcpy (ctx->inpre - MAX_ORDER * lanes,
+        frames + (n_frames - MAX_ORDER) * lanes,
+        MAX_ORDER * lanes * sizeof (gfloat));
+
+  } else {
+
+    memmove (ctx->inpre - MAX_ORDER * lanes,
+        ctx->inpre - (MAX_ORDER - n_frames) * lanes,
+        (MAX_ORDER - n_frames) * lanes * sizeof (gfloat));
+    memcpy (ctx->inpre - n_frames * lanes, frames,
+        n_frames * lanes * sizeof (gfloat));
+
+  }
+}
+
 /* Entry points for analyzing sample data in common raw data formats.
  * The stereo format functions expect interleaved frames.  It is
  * possible to pass data in different formats for the same context,
@@ -512,25 +659,27 @@ void
 rg_analysis_analyze_mono_float (RgAnalysisCtx * ctx, gconstpointer data,
     gsize size, guint depth)
 {
-  gfloat conv_samples[512];
+  gfloat conv_frames[512];
   const gfloat *samples = (gfloat *) data;
   guint n_samples = size / sizeof (gfloat);
+  guint lanes = set_lanes (ctx, 1);
   gint i;
 
   g_return_if_fail (depth == 32);
   g_return_if_fail (size % sizeof (gfloat) == 0);
 
   while (n_samples) {
-    gint n = MIN (n_samples, G_N_ELEMENTS (conv_samples));
+    gint n = MIN (n_samples, G_N_ELEMENTS (conv_frames) / lanes);
 
     n_samples -= n;
-    memcpy (conv_samples, samples, n * sizeof (gfloat));
     for (i = 0; i < n; i++) {
-      ctx->track.peak = MAX (ctx->track.peak, fabs (conv_samples[i]));
-      conv_samples[i] *= 32768.;
+      gfloat sample = samples[i] * 32768.;
+
+      ctx->track.peak = MAX (ctx->track.peak, fabs (samples[i]));
+      conv_frames[i * lanes] = conv_frames[i * lanes + lanes - 1] = sample;
     }
     samples += n;
-    rg_analysis_analyze (ctx, conv_samples, NULL, n);
+    analyze_frames (ctx, conv_frames, n);
   }
 }
 
@@ -538,8 +687,7 @@ void
 rg_analysis_analyze_stereo_float (RgAnalysisCtx * ctx, gconstpointer data,
     gsize size, guint depth)
 {
-  gfloat conv_samples_l[256];
-  gfloat conv_samples_r[256];
+  gfloat conv_frames[512];
   const gfloat *samples = (gfloat *) data;
   guint n_frames = size / (sizeof (gfloat) * 2);
   gint i;
@@ -547,23 +695,18 @@ rg_analysis_analyze_stereo_float (RgAnalysisCtx * ctx, gconstpointer data,
   g_return_if_fail (depth == 32);
   g_return_if_fail (size % (sizeof (gfloat) * 2) == 0);
 
+  set_lanes (ctx, 2);
+
   while (n_frames) {
-    gint n = MIN (n_frames, G_N_ELEMENTS (conv_samples_l));
+    gint n = MIN (n_frames, G_N_ELEMENTS (conv_frames) / 2);
 
     n_frames -= n;
-    for (i = 0; i < n; i++) {
-      gfloat old_sample;
-
-      old_sample = samples[2 * i];
-      ctx->track.peak = MAX (ctx->track.peak, fabs (old_sample));
-      conv_samples_l[i] = old_sample * 32768.;
-
-      old_sample = samples[2 * i + 1];
-      ctx->track.peak = MAX (ctx->track.peak, fabs (old_sample));
-      conv_samples_r[i] = old_sample * 32768.;
+    for (i = 0; i < 2 * n; i++) {
+      ctx->track.peak = MAX (ctx->track.peak, fabs (samples[i]));
+      conv_frames[i] = samples[i] * 32768.;
     }
     samples += 2 * n;
-    rg_analysis_analyze (ctx, conv_samples_l, conv_samples_r, n);
+    analyze_frames (ctx, conv_frames, n);
   }
 }
 
@@ -571,28 +714,30 @@ void
 rg_analysis_analyze_mono_int16 (RgAnalysisCtx * ctx, gconstpointer data,
     gsize size, guint depth)
 {
-  gfloat conv_samples[512];
+  gfloat conv_frames[512];
   gint32 peak_sample = 0;
   const gint16 *samples = (gint16 *) data;
   guint n_samples = size / sizeof (gint16);
   gint shift = sizeof (gint16) * 8 - depth;
+  guint lanes = set_lanes (ctx, 1);
   gint i;
 
   g_return_if_fail (depth <= (sizeof (gint16) * 8));
   g_return_if_fail (size % sizeof (gint16) == 0);
 
   while (n_samples) {
-    gint n = MIN (n_samples, G_N_ELEMENTS (conv_samples));
+    gint n = MIN (n_samples, G_N_ELEMENTS (conv_frames) / lanes);
 
     n_samples -= n;
     for (i = 0; i < n; i++) {
       gint16 old_sample = samples[i] << shift;
 
       peak_sample = MAX (peak_sample, ABS ((gint32) old_sample));
-      conv_samples[i] = (gfloat) old_sample;
+      conv_frames[i * lanes] = conv_frames[i * lanes + lanes - 1] =
+          (gfloat) old_sample;
     }
     samples += n;
-    rg_analysis_analyze (ctx, conv_samples, NULL, n);
+    analyze_frames (ctx, conv_frames, n);
   }
   ctx->track.peak = MAX (ctx->track.peak,
       (gdouble) peak_sample / ((gdouble) (1u << 15)));
@@ -602,8 +747,7 @@ void
 rg_analysis_analyze_stereo_int16 (RgAnalysisCtx * ctx, gconstpointer data,
     gsize size, guint depth)
 {
-  gfloat conv_samples_l[256];
-  gfloat conv_samples_r[256];
+  gfloat conv_frames[512];
   gint32 peak_sample = 0;
   const gint16 *samples = (gint16 *) data;
   guint n_frames = size / (sizeof (gint16) * 2);
@@ -613,23 +757,28 @@ rg_analysis_analyze_stereo_int16 (RgAnalysisCtx * ctx, gconstpointer data,
   g_return_if_fail (depth <= (sizeof (gint16) * 8));
   g_return_if_fail (size % (sizeof (gint16) * 2) == 0);
 
+  set_lanes (ctx, 2);
+
   while (n_frames) {
-    gint n = MIN (n_frames, G_N_ELEMENTS (conv_samples_l));
+    gint n = MIN (n_frames, G_N_ELEMENTS (conv_frames) / 2);
 
     n_frames -= n;
-    for (i = 0; i < n; i++) {
-      gint16 old_sample;
-
-      old_sample = samples[2 * i] << shift;
-      peak_sample = MAX (peak_sample, ABS ((gint32) old_sample));
-      conv_samples_l[i] = (gfloat) old_sample;
+    if (shift == 0) {
+      /* Full depth, the samples are converted without a shift. */
+      for (i = 0; i < 2 * n; i++) {
+        peak_sample = MAX (peak_sample, ABS ((gint32) samples[i]));
+        conv_frames[i] = (gfloat) samples[i];
+      }
+    } else {
+      for (i = 0; i < 2 * n; i++) {
+        gint16 old_sample = samples[i] << shift;
 
-      old_sample = samples[2 * i + 1] << shift;
-      peak_sample = MAX (peak_sample, ABS ((gint32) old_sample));
-      conv_samples_r[i] = (gfloat) old_sample;
+        peak_sample = MAX (peak_sample, ABS ((gint32) old_sample));
+        conv_frames[i] = (gfloat) old_sample;
+      }
     }
     samples += 2 * n;
-    rg_analysis_analyze (ctx, conv_samples_l, conv_samples_r, n);
+    analyze_frames (ctx, conv_frames, n);
   }
   ctx->track.peak = MAX (ctx->track.peak,
       (gdouble) peak_sample / ((gdouble) (1u << 15)));
@@ -652,116 +801,31 @@ void
 rg_analysis_analyze (RgAnalysisCtx * ctx, const gfloat * samples_l,
     const gfloat * samples_r, guint n_samples)
 {
-  const gfloat *input_l, *input_r;
-  guint n_samples_done;
+  gfloat frames[512];
+  guint lanes;
   gint i;
 
   g_return_if_fail (ctx != NULL);
   g_return_if_fail (samples_l != NULL);
   g_return_if_fail (ctx->sample_rate != 0);
 
-  if (n_samples == 0)
-    return;
+  lanes = set_lanes (ctx, samples_r ? 2 : 1);
 
   if (samples_r == NULL)
     /* Mono. */
     samples_r = samples_l;
 
-  memcpy (ctx->inpre_l, samples_l,
-      MIN (n_samples, MAX_ORDER) * sizeof (gfloat));
-  memcpy (ctx->inpre_r, samples_r,
-      MIN (n_samples, MAX_ORDER) * sizeof (gfloat));
-
-  n_samples_done = 0;
-  while (n_samples_done < n_samples) {
-    /* Limit number of samples to be processed in this iteration to
-     * the number needed to complete the next window: */
-    guint n_samples_current = MIN (n_samples - n_samples_done,
-        ctx->window_n_samples - ctx->window_n_samples_done);
-
-    if (n_samples_done < MAX_ORDER) {
-      input_l = ctx->inpre_l + n_samples_done;
-      input_r = ctx->inpre_r + n_samples_done;
-      n_samples_current = MIN (n_samples_current, MAX_ORDER - n_samples_done);
-    } else {
-      input_l = samples_l + n_samples_done;
-      input_r = samples_r + n_samples_done;
-    }
-
-    apply_filters (ctx, input_l, input_r, n_samples_current);
-
-    /* Update the square sum. */
-    for (i = 0; i < n_samples_current; i++)
-      ctx->window_square_sum += ctx->out_l[ctx->window_n_samples_done + i]
-          * ctx->out_l[ctx->window_n_samples_done + i]
-          + ctx->out_r[ctx->window_n_samples_done + i]
-          * ctx->out_r[ctx->window_n_samples_done + i];
-
-    ctx->window_n_samples_done += n_samples_current;
-    ctx->buffer_n_samples_done += n_samples_current;
-
-    g_return_if_fail (ctx->window_n_samples_done <= ctx->window_n_samples);
-
-    if (ctx->window_n_samples_done == ctx->window_n_samples) {
-      /* Get the Root Mean Square (RMS) for this set of samples. */
-      gdouble val = STEPS_PER_DB * 10. * log10 (ctx->window_square_sum /
-          ctx->window_n_samples * 0.5 + 1.e-37);
-      gint ival = CLAMP ((gint) val, 0,
-          (gint) G_N_ELEMENTS (ctx->track.histogram) - 1);
-      /* Compute the per-window gain */
-      const gdouble gain = PINK_REF - (gdouble) ival / STEPS_PER_DB;
-      const GstClockTime timestamp = ctx->buffer_timestamp
-          + gst_util_uint64_scale_int_ceil (GST_SECOND,
-          ctx->buffer_n_samples_done,
-          ctx->sample_rate)
-          - RMS_WINDOW_MSECS * GST_MSECOND;
-
-      ctx->post_message (ctx->analysis, timestamp,
-          RMS_WINDOW_MSECS * GST_MSECOND, -gain);
-
-
-      ctx->track.histogram[ival]++;
-      ctx->window_square_sum = 0.;
-      ctx->window_n_samples_done = 0;
-
-      /* No need for memmove here, the areas never overlap: Even for
-       * the smallest sample rate, the number of samples needed for
-       * the window is greater than MAX_ORDER. */
-
-      memcpy (ctx->stepbuf_l, ctx->stepbuf_l + ctx->window_n_samples,
-          MAX_ORDER * sizeof (gfloat));
-      memcpy (ctx->outbuf_l, ctx->outbuf_l + ctx->window_n_samples,
-          MAX_ORDER * sizeof (gfloat));
+  while (n_samples) {
+    gint n = MIN (n_samples, G_N_ELEMENTS (frames) / lanes);
 
-      memcpy (ctx->stepbuf_r, ctx->stepbuf_r + ctx->window_n_samples,
-          MAX_ORDER * sizeof (gfloat));
-      memcpy (ctx->outbuf_r, ctx->outbuf_r + ctx->window_n_samples,
-          MAX_ORDER * sizeof (gfloat));
+    n_samples -= n;
+    for (i = 0; i < n; i++) {
+      frames[i * lanes] = samples_l[i];
+      frames[i * lanes + lanes - 1] = samples_r[i];
     }
-
-    n_samples_done += n_samples_current;
-  }
-
-  if (n_samples >= MAX_ORDER) {
-
-    memcpy (ctx->inprebuf_l, samples_l + n_samples - MAX_ORDER,
-        MAX_ORDER * sizeof (gfloat));
-
-    memcpy (ctx->inprebuf_r, samples_r + n_samples - MAX_ORDER,
-        MAX_ORDER * sizeof (gfloat));
-
-  } else {
-
-    memmove (ctx->inprebuf_l, ctx->inprebuf_l + n_samples,
-        (MAX_ORDER - n_samples) * sizeof (gfloat));
-    memcpy (ctx->inprebuf_l + MAX_ORDER - n_samples, samples_l,
-        n_samples * sizeof (gfloat));
-
-    memmove (ctx->inprebuf_r, ctx->inprebuf_r + n_samples,
-        (MAX_ORDER - n_samples) * sizeof (gfloat));
-    memcpy (ctx->inprebuf_r + MAX_ORDER - n_samples, samples_r,
-        n_samples * sizeof (gfloat));
-
+    samples_l += n;
+    samples_r += n;
+    analyze_frames (ctx, frames, n);
   }
 }
 
@@ -803,6 +867,20 @@ rg_analysis_album_result (RgAnalysisCtx * ctx, gdouble * gain, gdouble * peak)
   return result;
 }
 
+/* Add the album accumulator of @other to the one of @ctx.  The tracks
+ * of an album can be analyzed in parallel with a context per thread;
+ * merging the album accumulators of all contexts into one of them gives
+ * the album result.  The accumulator of @other is left as it is. */
+
+void
+rg_analysis_merge_album (RgAnalysisCtx * ctx, const RgAnalysisCtx * other)
+{
+  g_return_if_fail (ctx != NULL);
+  g_return_if_fail (other != NULL);
+
+  accumulator_add (&ctx->album, &other->album);
+}
+
 void
 rg_analysis_reset_album (RgAnalysisCtx * ctx)
 {
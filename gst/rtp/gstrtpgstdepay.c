@@ -194,7 +194,7 @@ gst_rtp_gst_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
 }
 
 static gboolean
-read_length (GstRtpGSTDepay * rtpgstdepay, guint8 * data, guint size,
+read_length (GstRtpGSTDepay * rtpgstdepay, const guint8 * data, guint size,
     guint * length, guint * skip)
 {
   guint b, len, offset;
@@ -218,25 +218,53 @@ read_length (GstRtpGSTDepay * rtpgstdepay, guint8 * data, guint size,
   return TRUE;
 }
 
+/* map the length and the string of the inline caps or event at the start of
+ * the adapter. Only these bytes get merged when they span several packets,
+ * the data that follows stays in the memory of the packets */
+static const guint8 *
+map_inline_data (GstRtpGSTDepay * rtpgstdepay, guint * size)
+{
+  const guint8 *data;
+  guint avail, max, len, i;
+
+  avail = gst_adapter_available (rtpgstdepay->adapter);
+
+  /* a 32 bits length takes at most 5 bytes */
+  max = MIN (avail, 5);
+  data = gst_adapter_map (rtpgstdepay->adapter, max);
+  len = 0;
+  for (i = 0; i < max; i++) {
+    len = (len << 7) | (data[i] & 0x7f);
+    if (!(data[i] & 0x80))
+      break;
+  }
+  gst_adapter_unmap (rtpgstdepay->adapter);
+
+  /* with an invalid length, read_length() fails on all the data */
+  if (i < max && len <= avail - i - 1)
+    *size = i + 1 + len;
+  else
+    *size = avail;
+
+  return gst_adapter_map (rtpgstdepay->adapter, *size);
+}
+
 static GstCaps *
-read_caps (GstRtpGSTDepay * rtpgstdepay, GstBuffer * buf, guint * skip)
+read_caps (GstRtpGSTDepay * rtpgstdepay, const guint8 * data, guint size,
+    guint * skip)
 {
   guint offset, length;
   GstCaps *caps;
-  GstMapInfo map;
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
+  GST_DEBUG_OBJECT (rtpgstdepay, "buffer size %u", size);
 
-  GST_DEBUG_OBJECT (rtpgstdepay, "buffer size %" G_GSIZE_FORMAT, map.size);
-
-  if (!read_length (rtpgstdepay, map.data, map.size, &length, &offset))
+  if (!read_length (rtpgstdepay, data, size, &length, &offset))
     goto too_small;
 
-  GST_DEBUG_OBJECT (rtpgstdepay, "parsing caps %s", &map.data[offset]);
+  GST_DEBUG_OBJECT (rtpgstdepay, "parsing caps %s", &data[offset]);
 
   /* parse and store in cache */
-  caps = gst_caps_from_string ((gchar *) & map.data[offset]);
-  gst_buffer_unmap (buf, &map);
+  caps = gst_caps_from_string ((gchar *) & data[offset]);
 
   *skip = length + offset;
 
@@ -246,34 +274,29 @@ too_small:
   {
     GST_ELEMENT_WARNING (rtpgstdepay, STREAM, DECODE,
         ("Buffer too small."), (NULL));
-    gst_buffer_unmap (buf, &map);
     return NULL;
   }
 }
 
 static GstEvent *
 read_event (GstRtpGSTDepay * rtpgstdepay, guint type,
-    GstBuffer * buf, guint * skip)
+    const guint8 * data, guint size, guint * skip)
 {
   guint offset, length;
   GstStructure *s;
   GstEvent *event;
   GstEventType etype;
   gchar *end;
-  GstMapInfo map;
-
-  gst_buffer_map (buf, &map, GST_MAP_READ);
 
-  GST_DEBUG_OBJECT (rtpgstdepay, "buffer size %" G_GSIZE_FORMAT, map.size);
+  GST_DEBUG_OBJECT (rtpgstdepay, "buffer size %u", size);
 
-  if (!read_length (rtpgstdepay, map.data, map.size, &length, &offset))
+  if (!read_length (rtpgstdepay, data, size, &length, &offset))
     goto too_small;
 
-  GST_DEBUG_OBJECT (rtpgstdepay, "parsing event %s", &map.data[offset]);
+  GST_DEBUG_OBJECT (rtpgstdepay, "parsing event %s", &data[offset]);
 
   /* parse */
-  s = gst_structure_from_string ((gchar *) & map.data[offset], &end);
-  gst_buffer_unmap (buf, &map);
+  s = gst_structure_from_string ((gchar *) & data[offset], &end);
 
   if (s == NULL)
     goto parse_failed;
@@ -304,7 +327,6 @@ too_small:
   {
     GST_ELEMENT_WARNING (rtpgstdepay, STREAM, DECODE,
         ("Buffer too small."), (NULL));
-    gst_buffer_unmap (buf, &map);
     return NULL;
   }
 parse_failed:
@@ -378,7 +400,7 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   GstBuffer *subbuf, *outbuf = NULL;
   gint payload_len;
   guint8 *payload;
-  guint CV, frag_offset, avail, offset;
+  guint CV, frag_offset, avail;
   GstRTPBuffer rtp = { NULL };
 
   rtpgstdepay = GST_RTP_GST_DEPAY (depayload);
@@ -418,14 +440,12 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   subbuf = gst_rtp_buffer_get_payload_subbuffer (&rtp, 8, -1);
   gst_adapter_push (rtpgstdepay->adapter, subbuf);
 
-  offset = 0;
   if (gst_rtp_buffer_get_marker (&rtp)) {
     guint avail;
     GstCaps *outcaps;
+    const guint8 *data;
 
-    /* take the buffer */
     avail = gst_adapter_available (rtpgstdepay->adapter);
-    outbuf = gst_adapter_take_buffer (rtpgstdepay->adapter, avail);
 
     CV = (payload[0] >> 4) & 0x7;
 
@@ -433,7 +453,9 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
       guint size;
 
       /* C bit, we have inline caps */
-      outcaps = read_caps (rtpgstdepay, outbuf, &size);
+      data = map_inline_data (rtpgstdepay, &size);
+      outcaps = read_caps (rtpgstdepay, data, size, &size);
+      gst_adapter_unmap (rtpgstdepay->adapter);
       if (outcaps == NULL)
         goto no_caps;
 
@@ -443,7 +465,7 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
       store_cache (rtpgstdepay, CV, outcaps);
 
       /* skip caps */
-      offset += size;
+      gst_adapter_flush (rtpgstdepay->adapter, size);
       avail -= size;
     }
     if (payload[1]) {
@@ -451,7 +473,9 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
       GstEvent *event;
 
       /* we have an event */
-      event = read_event (rtpgstdepay, payload[1], outbuf, &size);
+      data = map_inline_data (rtpgstdepay, &size);
+      event = read_event (rtpgstdepay, payload[1], data, size, &size);
+      gst_adapter_unmap (rtpgstdepay->adapter);
       if (event == NULL)
         goto no_event;
 
@@ -461,22 +485,14 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
       store_event (rtpgstdepay, event);
 
       /* no buffer after event */
+      gst_adapter_clear (rtpgstdepay->adapter);
       avail = 0;
     }
 
     if (avail) {
-      if (offset != 0) {
-        GstBuffer *temp;
-
-        GST_DEBUG_OBJECT (rtpgstdepay, "sub buffer: offset %u, size %u", offset,
-            avail);
-
-        temp =
-            gst_buffer_copy_region (outbuf, GST_BUFFER_COPY_ALL, offset, avail);
-
-        gst_buffer_unref (outbuf);
-        outbuf = temp;
-      }
+      /* take the buffer, it references the memory of the packets */
+      GST_DEBUG_OBJECT (rtpgstdepay, "take buffer of size %u", avail);
+      outbuf = gst_adapter_take_buffer_fast (rtpgstdepay->adapter, avail);
 
       /* see what caps we need */
       if (CV != rtpgstdepay->current_CV) {
@@ -495,9 +511,6 @@ gst_rtp_gst_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
       if (payload[0] & 0x8)
         GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
-    } else {
-      gst_buffer_unref (outbuf);
-      outbuf = NULL;
     }
   }
   gst_rtp_buffer_unmap (&rtp);
@@ -522,14 +535,14 @@ wrong_frag:
 no_caps:
   {
     GST_WARNING_OBJECT (rtpgstdepay, "failed to parse caps");
-    gst_buffer_unref (outbuf);
+    gst_adapter_clear (rtpgstdepay->adapter);
     gst_rtp_buffer_unmap (&rtp);
     return NULL;
   }
 no_event:
   {
     GST_WARNING_OBJECT (rtpgstdepay, "failed to parse event");
-    gst_buffer_unref (outbuf);
+    gst_adapter_clear (rtpgstdepay->adapter);
     gst_rtp_buffer_unmap (&rtp);
     return NULL;
   }
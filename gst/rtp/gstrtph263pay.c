@@ -667,15 +667,20 @@ gst_rtp_h263_pay_gobfinder (GstRtpH263Pay * rtph263pay,
   if (current >= rtph263pay->data + rtph263pay->available_data)
     return FALSE;
 
-  for (i = 3; i < range - 3; i++) {
-    if ((current[i] == 0x0) &&
-        (current[i + 1] == 0x0) && (current[i + 2] >> 7 == 0x1)) {
+  i = 3;
+  while (i + 3 < range) {
+    if (current[i + 1] != 0x0) {
+      /* neither i nor i + 1 can start a GBSC */
+      i += 2;
+    } else if ((current[i] == 0x0) && (current[i + 2] >> 7 == 0x1)) {
       GST_LOG ("GOB end found at: %p start: %p len: %u", current + i - 1,
           boundry->end + 1, (guint) (current + i - boundry->end + 2));
       gst_rtp_h263_pay_boundry_init (boundry, boundry->end + 1,
           current + i - 1, 0, 0);
 
       return TRUE;
+    } else {
+      i++;
     }
   }
 
@@ -1234,14 +1239,16 @@ gst_rtp_h263_pay_push (GstRtpH263Pay * rtph263pay,
    * Splat the payload header values
    */
   guint8 *header;
-  guint8 *payload;
-  GstFlowReturn ret;
+  GstBuffer *payload;
   GstRTPBuffer rtp = { NULL };
 
+  /* the packet only holds the payload header, the payload is added as a
+   * region of the frame below */
+  package->outbuf = gst_rtp_buffer_new_allocate (package->mode, 0, 0);
+
   gst_rtp_buffer_map (package->outbuf, GST_MAP_WRITE, &rtp);
 
   header = gst_rtp_buffer_get_payload (&rtp);
-  payload = header + package->mode;
 
   switch (package->mode) {
     case GST_RTP_H263_PAYLOAD_HEADER_MODE_A:
@@ -1256,16 +1263,12 @@ gst_rtp_h263_pay_push (GstRtpH263Pay * rtph263pay,
       //gst_rtp_h263_pay_splat_header_C(header, package, context->piclayer);
       //break;
     default:
+      gst_rtp_buffer_unmap (&rtp);
+      gst_buffer_unref (package->outbuf);
+      gst_rtp_h263_pay_package_destroy (package);
       return GST_FLOW_ERROR;
   }
 
-
-  /*
-   * Copy the payload data in the buffer
-   */
-  GST_DEBUG ("Copying memory");
-  memcpy (payload, (guint8 *) package->payload_start, package->payload_len);
-
   /*
    * timestamp the buffer
    */
@@ -1277,14 +1280,20 @@ gst_rtp_h263_pay_push (GstRtpH263Pay * rtph263pay,
 
   gst_rtp_buffer_unmap (&rtp);
 
-  ret =
-      gst_rtp_base_payload_push (GST_RTP_BASE_PAYLOAD (rtph263pay),
-      package->outbuf);
-  GST_DEBUG ("Package pushed, returning");
+  /*
+   * Reference the payload data of the frame
+   */
+  payload = gst_buffer_copy_region (rtph263pay->frame, GST_BUFFER_COPY_MEMORY,
+      package->payload_start - rtph263pay->data, package->payload_len);
+  package->outbuf = gst_buffer_append (package->outbuf, payload);
+
+  /* all the packets of the frame are pushed together */
+  gst_buffer_list_add (rtph263pay->list, package->outbuf);
+  GST_DEBUG ("Package queued, returning");
 
   gst_rtp_h263_pay_package_destroy (package);
 
-  return ret;
+  return GST_FLOW_OK;
 }
 
 static GstFlowReturn
@@ -1309,8 +1318,6 @@ gst_rtp_h263_pay_A_fragment_push (GstRtpH263Pay * rtph263pay,
 
   pack->gobn = context->gobs[first]->gobn;
   pack->mode = GST_RTP_H263_PAYLOAD_HEADER_MODE_A;
-  pack->outbuf =
-      gst_rtp_buffer_new_allocate (pack->payload_len + pack->mode, 0, 0);
 
   GST_DEBUG ("Sending len:%d data to push function", pack->payload_len);
 
@@ -1366,8 +1373,6 @@ gst_rtp_h263_pay_B_fragment_push (GstRtpH263Pay * rtph263pay,
   }
 
   pack->payload_len = pack->payload_end - pack->payload_start + 1;
-  pack->outbuf =
-      gst_rtp_buffer_new_allocate (pack->payload_len + pack->mode, 0, 0);
 
   return gst_rtp_h263_pay_push (rtph263pay, context, pack);
 }
@@ -1408,7 +1413,6 @@ gst_rtp_h263_pay_mode_B_fragment (GstRtpH263Pay * rtph263pay,
           &boundry.end, &gob->end) != 0) {
     GST_ERROR
         ("The rest of the bits should be 0, exiting, because something bad happend");
-    gst_adapter_flush (rtph263pay->adapter, rtph263pay->available_data);
     goto decode_error;
   }
   //The first GOB of a frame "has no" actual header - PICTURE header is his header
@@ -1577,10 +1581,6 @@ gst_rtp_h263_send_entire_frame (GstRtpH263Pay * rtph263pay,
 
   GST_DEBUG ("Available data: %d", rtph263pay->available_data);
 
-  pack->outbuf =
-      gst_rtp_buffer_new_allocate (pack->payload_len +
-      GST_RTP_H263_PAYLOAD_HEADER_MODE_A, 0, 0);
-
   return gst_rtp_h263_pay_push (rtph263pay, context, pack);
 }
 
@@ -1610,10 +1610,14 @@ gst_rtp_h263_pay_flush (GstRtpH263Pay * rtph263pay)
     goto end;
   }
 
-  /* Get a pointer to all the data for the frame */
-  rtph263pay->data =
-      (guint8 *) gst_adapter_map (rtph263pay->adapter,
+  /* Get a pointer to all the data for the frame, the packets reference
+   * regions of the frame instead of copying them */
+  rtph263pay->frame =
+      gst_adapter_take_buffer (rtph263pay->adapter,
       rtph263pay->available_data);
+  gst_buffer_map (rtph263pay->frame, &rtph263pay->map, GST_MAP_READ);
+  rtph263pay->data = rtph263pay->map.data;
+  rtph263pay->list = gst_buffer_list_new ();
 
   /* Picture header */
   context->piclayer = (GstRtpH263PayPic *) rtph263pay->data;
@@ -1709,7 +1713,8 @@ gst_rtp_h263_pay_flush (GstRtpH263Pay * rtph263pay)
             if (!gst_rtp_h263_pay_mode_B_fragment (rtph263pay, context,
                     context->gobs[i])) {
               GST_ERROR ("There was an error fragmenting in mode B");
-              return GST_FLOW_ERROR;
+              ret = GST_FLOW_ERROR;
+              goto end;
             }
           } else {
             //IMPLEMENT C mode
@@ -1766,10 +1771,23 @@ gst_rtp_h263_pay_flush (GstRtpH263Pay * rtph263pay)
   /* Flush the input buffer data */
 
 end:
-  gst_rtp_h263_pay_context_destroy (context,
-      context->piclayer->ptype_srcformat);
-  gst_adapter_unmap (rtph263pay->adapter);
-  gst_adapter_flush (rtph263pay->adapter, rtph263pay->available_data);
+  if (rtph263pay->frame) {
+    gst_rtp_h263_pay_context_destroy (context,
+        context->piclayer->ptype_srcformat);
+    gst_buffer_unmap (rtph263pay->frame, &rtph263pay->map);
+    gst_buffer_unref (rtph263pay->frame);
+    rtph263pay->frame = NULL;
+    rtph263pay->data = NULL;
+
+    if (gst_buffer_list_length (rtph263pay->list) > 0 && ret == GST_FLOW_OK)
+      ret = gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD (rtph263pay),
+          rtph263pay->list);
+    else
+      gst_buffer_list_unref (rtph263pay->list);
+    rtph263pay->list = NULL;
+  } else {
+    g_free (context);
+  }
 
   return ret;
 }
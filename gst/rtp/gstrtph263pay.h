@@ -69,6 +69,10 @@ struct _GstRtpH263Pay
   guint8 *data;
   guint available_data;
 
+  /* the picture that is packetised, the packets reference its memory */
+  GstBuffer *frame;
+  GstMapInfo map;
+  GstBufferList *list;
 };
 
 struct _GstRtpH263PayContext
@@ -641,14 +641,17 @@ static GstFlowReturn
 gst_rtp_h263p_pay_flush (GstRtpH263PPay * rtph263ppay)
 {
   guint avail;
-  GstBuffer *outbuf;
-  GstFlowReturn ret;
+  GstBuffer *outbuf, *paybuf;
+  GstBufferList *list;
   gboolean fragmented;
 
   avail = gst_adapter_available (rtph263ppay->adapter);
   if (avail == 0)
     return GST_FLOW_OK;
 
+  /* the packets of the picture are pushed together */
+  list = gst_buffer_list_new ();
+
   fragmented = FALSE;
   /* This algorithm assumes the H263/+/++ encoder sends complete frames in each
    * buffer */
@@ -664,8 +667,8 @@ gst_rtp_h263p_pay_flush (GstRtpH263PPay * rtph263ppay)
   while (avail > 0) {
     guint towrite;
     guint8 *payload;
-    guint payload_len;
     gint header_len;
+    guint skip;
     guint next_gop = 0;
     gboolean found_gob = FALSE;
     GstRTPBuffer rtp = { NULL };
@@ -710,9 +713,11 @@ gst_rtp_h263p_pay_flush (GstRtpH263PPay * rtph263ppay)
     if (next_gop > 0)
       towrite = MIN (next_gop, towrite);
 
-    payload_len = header_len + towrite;
-
-    outbuf = gst_rtp_buffer_new_allocate (payload_len, 0, 0);
+    /* the packet holds the payload header, the payload references the
+     * memory of the input. Without header_len, the payload header replaces
+     * the first two bytes of the picture start code */
+    outbuf = gst_rtp_buffer_new_allocate (2, 0, 0);
+    skip = header_len ? 0 : MIN (2, towrite);
 
     gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
     /* last fragment gets the marker bit set */
@@ -720,8 +725,6 @@ gst_rtp_h263p_pay_flush (GstRtpH263PPay * rtph263ppay)
 
     payload = gst_rtp_buffer_get_payload (&rtp);
 
-    gst_adapter_copy (rtph263ppay->adapter, &payload[header_len], 0, towrite);
-
     /*  0                   1
      *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5
      * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -736,16 +739,20 @@ gst_rtp_h263p_pay_flush (GstRtpH263PPay * rtph263ppay)
     GST_BUFFER_DURATION (outbuf) = rtph263ppay->first_duration;
     gst_rtp_buffer_unmap (&rtp);
 
-    gst_adapter_flush (rtph263ppay->adapter, towrite);
+    gst_adapter_flush (rtph263ppay->adapter, skip);
+    if (towrite > skip) {
+      paybuf = gst_adapter_take_buffer (rtph263ppay->adapter, towrite - skip);
+      outbuf = gst_buffer_append (outbuf, paybuf);
+    }
 
-    ret =
-        gst_rtp_base_payload_push (GST_RTP_BASE_PAYLOAD (rtph263ppay), outbuf);
+    gst_buffer_list_add (list, outbuf);
 
     avail -= towrite;
     fragmented = TRUE;
   }
 
-  return ret;
+  return gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD (rtph263ppay),
+      list);
 }
 
 static GstFlowReturn
@@ -137,8 +137,10 @@ static void
 gst_rtp_h264_depay_reset (GstRtpH264Depay * rtph264depay)
 {
   gst_adapter_clear (rtph264depay->adapter);
+  rtph264depay->adapter_n_memory = 0;
   rtph264depay->wait_start = TRUE;
   gst_adapter_clear (rtph264depay->picture_adapter);
+  rtph264depay->picture_n_memory = 0;
   rtph264depay->picture_start = FALSE;
   rtph264depay->last_keyframe = FALSE;
   rtph264depay->last_ts = 0;
@@ -634,17 +636,34 @@ incomplete_caps:
   }
 }
 
+/* Take everything from @adapter. The adapter holds sub-buffers of the RTP
+ * packets, @n_memory in total. As long as they fit in one buffer, the result
+ * references their memory and nothing is copied. Beyond that, the buffer would
+ * merge its memory again and again while it is built, so copy once instead. */
+static GstBuffer *
+gst_rtp_h264_depay_take_buffer (GstAdapter * adapter, guint n_memory)
+{
+  guint outsize;
+
+  outsize = gst_adapter_available (adapter);
+
+  if (n_memory <= gst_buffer_get_max_memory ())
+    return gst_adapter_take_buffer_fast (adapter, outsize);
+
+  return gst_adapter_take_buffer (adapter, outsize);
+}
+
 static GstBuffer *
 gst_rtp_h264_complete_au (GstRtpH264Depay * rtph264depay,
     GstClockTime * out_timestamp, gboolean * out_keyframe)
 {
-  guint outsize;
   GstBuffer *outbuf;
 
   /* we had a picture in the adapter and we completed it */
   GST_DEBUG_OBJECT (rtph264depay, "taking completed AU");
-  outsize = gst_adapter_available (rtph264depay->picture_adapter);
-  outbuf = gst_adapter_take_buffer (rtph264depay->picture_adapter, outsize);
+  outbuf = gst_rtp_h264_depay_take_buffer (rtph264depay->picture_adapter,
+      rtph264depay->picture_n_memory);
+  rtph264depay->picture_n_memory = 0;
 
   *out_timestamp = rtph264depay->last_ts;
   *out_keyframe = rtph264depay->last_keyframe;
@@ -665,16 +684,16 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 {
   GstRTPBaseDepayload *depayload = GST_RTP_BASE_DEPAYLOAD (rtph264depay);
   gint nal_type;
-  GstMapInfo map;
+  guint8 header[6] = { 0, };
   GstBuffer *outbuf = NULL;
   GstClockTime out_timestamp;
   gboolean keyframe, out_keyframe;
 
-  gst_buffer_map (nal, &map, GST_MAP_READ);
-  if (G_UNLIKELY (map.size < 5))
+  /* only look at the start, mapping the NAL would merge its memory */
+  if (G_UNLIKELY (gst_buffer_extract (nal, 0, header, sizeof (header)) < 5))
     goto short_nal;
 
-  nal_type = map.data[4] & 0x1f;
+  nal_type = header[4] & 0x1f;
   GST_DEBUG_OBJECT (rtph264depay, "handle NAL type %d", nal_type);
 
   keyframe = NAL_TYPE_IS_KEY (nal_type);
@@ -687,7 +706,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
       gst_rtp_h264_depay_add_sps_pps (rtph264depay,
           gst_buffer_copy_region (nal, GST_BUFFER_COPY_ALL,
               4, gst_buffer_get_size (nal) - 4));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return NULL;
     } else if (rtph264depay->sps->len == 0 || rtph264depay->pps->len == 0) {
@@ -698,7 +716,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
           gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
               gst_structure_new ("GstForceKeyUnit",
                   "all-headers", G_TYPE_BOOLEAN, TRUE, NULL)));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return NULL;
     }
@@ -721,7 +738,7 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     if (nal_type == 1 || nal_type == 2 || nal_type == 5) {
       /* we have a picture start */
       start = TRUE;
-      if (map.data[5] & 0x80) {
+      if (header[5] & 0x80) {
         /* first_mb_in_slice == 0 completes a picture */
         complete = TRUE;
       }
@@ -736,9 +753,8 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
           &out_keyframe);
 
     /* add to adapter */
-    gst_buffer_unmap (nal, &map);
-
     GST_DEBUG_OBJECT (depayload, "adding NAL to picture adapter");
+    rtph264depay->picture_n_memory += gst_buffer_n_memory (nal);
     gst_adapter_push (rtph264depay->picture_adapter, nal);
     rtph264depay->last_ts = in_timestamp;
     rtph264depay->last_keyframe |= keyframe;
@@ -751,7 +767,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     /* no merge, output is input nal */
     GST_DEBUG_OBJECT (depayload, "using NAL as output");
     outbuf = nal;
-    gst_buffer_unmap (nal, &map);
   }
 
   if (outbuf) {
@@ -778,7 +793,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 short_nal:
   {
     GST_WARNING_OBJECT (depayload, "dropping short NAL");
-    gst_buffer_unmap (nal, &map);
     gst_buffer_unref (nal);
     return NULL;
   }
@@ -793,9 +807,13 @@ gst_rtp_h264_push_fragmentation_unit (GstRtpH264Depay * rtph264depay,
   GstBuffer *outbuf;
 
   outsize = gst_adapter_available (rtph264depay->adapter);
-  outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
+  outbuf = gst_rtp_h264_depay_take_buffer (rtph264depay->adapter,
+      rtph264depay->adapter_n_memory);
+  rtph264depay->adapter_n_memory = 0;
 
-  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+  /* the first memory holds the reconstructed NAL header, only map that one
+   * so that the fragments stay where they are */
+  gst_buffer_map_range (outbuf, 0, 1, &map, GST_MAP_WRITE);
   GST_DEBUG_OBJECT (rtph264depay, "output %d bytes", outsize);
 
   if (rtph264depay->byte_stream) {
@@ -834,6 +852,7 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   /* flush remaining data on discont */
   if (GST_BUFFER_IS_DISCONT (buf)) {
     gst_adapter_clear (rtph264depay->adapter);
+    rtph264depay->adapter_n_memory = 0;
     rtph264depay->wait_start = TRUE;
     rtph264depay->current_fu_type = 0;
   }
@@ -938,14 +957,16 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
           gst_buffer_unmap (outbuf, &map);
 
+          rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
           gst_adapter_push (rtph264depay->adapter, outbuf);
 
           payload += nalu_size;
           payload_len -= nalu_size;
         }
 
-        outsize = gst_adapter_available (rtph264depay->adapter);
-        outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
+        outbuf = gst_rtp_h264_depay_take_buffer (rtph264depay->adapter,
+            rtph264depay->adapter_n_memory);
+        rtph264depay->adapter_n_memory = 0;
 
         outbuf = gst_rtp_h264_depay_handle_nal (rtph264depay, outbuf, timestamp,
             marker);
@@ -998,39 +1019,31 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
           rtph264depay->wait_start = FALSE;
 
-          /* reconstruct NAL header */
+          /* reconstruct NAL header, it goes in front of the fragments
+           * after the sync bytes or NAL length */
           nal_header = (payload[0] & 0xe0) | (payload[1] & 0x1f);
 
-          /* strip type header, keep FU header, we'll reuse it to reconstruct
-           * the NAL header. */
-          payload += 1;
-          payload_len -= 1;
-
-          nalu_size = payload_len;
-          outsize = nalu_size + sizeof (sync_bytes);
+          outsize = sizeof (sync_bytes) + 1;
           outbuf = gst_buffer_new_and_alloc (outsize);
-
-          gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
-          memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
-          map.data[sizeof (sync_bytes)] = nal_header;
-          gst_buffer_unmap (outbuf, &map);
+          gst_buffer_fill (outbuf, sizeof (sync_bytes), &nal_header, 1);
 
           GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
 
           /* and assemble in the adapter */
+          rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
           gst_adapter_push (rtph264depay->adapter, outbuf);
-        } else {
-          /* strip off FU indicator and FU header bytes */
-          payload += 2;
-          payload_len -= 2;
+        }
 
-          outsize = payload_len;
-          outbuf = gst_buffer_new_and_alloc (outsize);
-          gst_buffer_fill (outbuf, 0, payload, outsize);
+        /* strip off FU indicator and FU header bytes, the rest of the payload
+         * is queued without copying */
+        if (payload_len > 2) {
+          outbuf = gst_rtp_buffer_get_payload_subbuffer (&rtp, 2, -1);
 
-          GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
+          GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes",
+              payload_len - 2);
 
           /* and assemble in the adapter */
+          rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
           gst_adapter_push (rtph264depay->adapter, outbuf);
         }
 
@@ -1049,7 +1062,7 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
         /* 1-23   NAL unit  Single NAL unit packet per H.264   5.6 */
         /* the entire payload is the output buffer */
         nalu_size = payload_len;
-        outsize = nalu_size + sizeof (sync_bytes);
+        outsize = sizeof (sync_bytes);
         outbuf = gst_buffer_new_and_alloc (outsize);
 
         gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
@@ -1060,9 +1073,12 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           map.data[2] = nalu_size >> 8;
           map.data[3] = nalu_size & 0xff;
         }
-        memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
         gst_buffer_unmap (outbuf, &map);
 
+        /* the payload follows the prefix without being copied */
+        outbuf = gst_buffer_append (outbuf,
+            gst_rtp_buffer_get_payload_subbuffer (&rtp, 0, -1));
+
         outbuf = gst_rtp_h264_depay_handle_nal (rtph264depay, outbuf, timestamp,
             marker);
         break;
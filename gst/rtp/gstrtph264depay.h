@@ -48,11 +48,13 @@ struct _GstRtpH264Depay
 
   GstBuffer  *codec_data;
   GstAdapter *adapter;
+  guint       adapter_n_memory;
   gboolean    wait_start;
 
   /* nal merging */
   gboolean    merge;
   GstAdapter *picture_adapter;
+  guint       picture_n_memory;
   gboolean    picture_start;
   GstClockTime last_ts;
   gboolean    last_keyframe;
@@ -938,7 +938,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
   const guint8 *data;
   GstClockTime dts, pts;
   GArray *nal_queue;
-  gboolean avc;
+  gboolean avc, aligned;
   GstBuffer *paybuf = NULL;
   gsize skip;
 
@@ -948,6 +948,12 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
 
   avc = rtph264pay->stream_format == GST_H264_STREAM_FORMAT_AVC;
 
+  /* with nal or au alignment every buffer ends with a complete NAL, so the
+   * last NAL does not need to wait for the next start code. The adapter then
+   * only ever contains one input buffer, so mapping it and taking the NALs
+   * from it does not copy any data. */
+  aligned = rtph264pay->alignment != GST_H264_ALIGNMENT_UNKNOWN;
+
   if (avc) {
     /* In AVC mode, there is no adapter, so nothign to flush */
     if (buffer == NULL)
@@ -1068,7 +1074,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
        */
       next = next_start_code (data, size);
 
-      if (next == size && buffer != NULL) {
+      if (next == size && buffer != NULL && !aligned) {
         /* Didn't find the start of next NAL and it's not EOS,
          * handle it next time */
         break;
@@ -1135,7 +1141,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
        * trailing 0x0 that can be discarded */
       size = nal_len;
       data = gst_adapter_map (rtph264pay->adapter, size);
-      if (i + 1 != nal_queue->len || buffer != NULL)
+      if (i + 1 != nal_queue->len || (buffer != NULL && !aligned))
         for (; size > 1 && data[size - 1] == 0x0; size--)
           /* skip */ ;
 
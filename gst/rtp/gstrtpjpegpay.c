@@ -220,6 +220,8 @@ typedef struct
 
 /* FIXME: restart marker header currently unsupported */
 
+static void gst_rtp_jpeg_pay_finalize (GObject * object);
+
 static void gst_rtp_jpeg_pay_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 
@@ -246,6 +248,7 @@ gst_rtp_jpeg_pay_class_init (GstRtpJPEGPayClass * klass)
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasepayload_class = (GstRTPBasePayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_jpeg_pay_finalize;
   gobject_class->set_property = gst_rtp_jpeg_pay_set_property;
   gobject_class->get_property = gst_rtp_jpeg_pay_get_property;
 
@@ -286,6 +289,16 @@ gst_rtp_jpeg_pay_init (GstRtpJPEGPay * pay)
   pay->height = -1;
 }
 
+static void gst_rtp_jpeg_pay_clear_headers (GstRtpJPEGPay * pay);
+
+static void
+gst_rtp_jpeg_pay_finalize (GObject * object)
+{
+  gst_rtp_jpeg_pay_clear_headers (GST_RTP_JPEG_PAY (object));
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 gst_rtp_jpeg_pay_setcaps (GstRTPBasePayload * basepayload, GstCaps * caps)
 {
@@ -300,6 +313,9 @@ gst_rtp_jpeg_pay_setcaps (GstRTPBasePayload * basepayload, GstCaps * caps)
 
   pay = GST_RTP_JPEG_PAY (basepayload);
 
+  /* the dimensions might change, parse the headers of the next frame again */
+  gst_rtp_jpeg_pay_clear_headers (pay);
+
   /* these properties are mandatory, but they might be adjusted by the SOF, if there
    * is one. */
   if (!gst_structure_get_int (caps_structure, "height", &height) || height <= 0) {
@@ -662,44 +678,41 @@ gst_rtp_jpeg_pay_scan_marker (const guint8 * data, guint size, guint * offset)
   }
 }
 
-static GstFlowReturn
-gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
-    GstBuffer * buffer)
+static void
+gst_rtp_jpeg_pay_clear_headers (GstRtpJPEGPay * pay)
+{
+  g_free (pay->frame_header);
+  pay->frame_header = NULL;
+  pay->frame_header_size = 0;
+  g_free (pay->packet_header);
+  pay->packet_header = NULL;
+  pay->packet_header_size = 0;
+  pay->first_packet_header_size = 0;
+}
+
+/* parse the jpeg header for 'start of scan' and read quant tables if needed.
+ * The RTP payload headers made from it are kept in pay->packet_header, the
+ * JPEG headers themselves in pay->frame_header so that following frames with
+ * the same headers do not need to be parsed again. */
+static gboolean
+gst_rtp_jpeg_pay_parse_headers (GstRtpJPEGPay * pay, const guint8 * data,
+    guint size)
 {
-  GstRtpJPEGPay *pay;
-  GstClockTime timestamp;
-  GstFlowReturn ret = GST_FLOW_ERROR;
   RtpJpegHeader jpeg_header;
   RtpQuantHeader quant_header;
   RtpRestartMarkerHeader restart_marker_header;
   RtpQuantTable tables[15] = { {0, NULL}, };
   CompInfo info[3] = { {0,}, };
   guint quant_data_size;
-  GstMapInfo map;
-  guint8 *data;
-  gsize size;
-  guint mtu;
-  guint bytes_left;
   guint jpeg_header_size = 0;
   guint offset;
-  gboolean frame_done;
   gboolean sos_found, sof_found, dqt_found, dri_found;
+  guint8 *header;
   gint i;
-  GstBufferList *list = NULL;
 
-  pay = GST_RTP_JPEG_PAY (basepayload);
-  mtu = GST_RTP_BASE_PAYLOAD_MTU (pay);
+  gst_rtp_jpeg_pay_clear_headers (pay);
 
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  data = map.data;
-  size = map.size;
-  timestamp = GST_BUFFER_TIMESTAMP (buffer);
   offset = 0;
-
-  GST_LOG_OBJECT (pay, "got buffer size %" G_GSIZE_FORMAT
-      " , timestamp %" GST_TIME_FORMAT, size, GST_TIME_ARGS (timestamp));
-
-  /* parse the jpeg header for 'start of scan' and read quant tables if needed */
   sos_found = FALSE;
   dqt_found = FALSE;
   sof_found = FALSE;
@@ -758,15 +771,12 @@ gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
 
   GST_LOG_OBJECT (pay, "header size %u", jpeg_header_size);
 
-  size -= jpeg_header_size;
-  data += jpeg_header_size;
-  offset = 0;
-
   if (dri_found)
     pay->type += 64;
 
   /* prepare stuff for the jpeg header */
   jpeg_header.type_spec = 0;
+  jpeg_header.offset = 0;
   jpeg_header.type = pay->type;
   jpeg_header.q = pay->quant;
   jpeg_header.width = pay->width;
@@ -802,26 +812,132 @@ gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
 
   GST_LOG_OBJECT (pay, "quant_data size %u", quant_data_size);
 
-  list = gst_buffer_list_new ();
+  /* every packet starts with the jpeg header and the restart marker header,
+   * only the first packet has the quant tables */
+  pay->packet_header_size = sizeof (jpeg_header);
+  if (dri_found)
+    pay->packet_header_size += sizeof (restart_marker_header);
+  pay->first_packet_header_size = pay->packet_header_size + quant_data_size;
 
-  bytes_left = sizeof (jpeg_header) + quant_data_size + size;
+  header = pay->packet_header = g_malloc (pay->first_packet_header_size);
 
-  if (dri_found)
-    bytes_left += sizeof (restart_marker_header);
+  memcpy (header, &jpeg_header, sizeof (jpeg_header));
+  header += sizeof (jpeg_header);
+
+  if (dri_found) {
+    memcpy (header, &restart_marker_header, sizeof (restart_marker_header));
+    header += sizeof (restart_marker_header);
+  }
+
+  if (quant_data_size > 0) {
+    memcpy (header, &quant_header, sizeof (quant_header));
+    header += sizeof (quant_header);
+
+    /* copy the quant tables for luma and chrominance */
+    for (i = 0; i < 2; i++) {
+      guint qsize;
+      guint qt;
+
+      qt = info[i].qt;
+      qsize = tables[qt].size;
+      memcpy (header, tables[qt].data, qsize);
+
+      GST_LOG_OBJECT (pay, "component %d using quant %d, size %d", i, qt,
+          qsize);
+
+      header += qsize;
+    }
+  }
+
+  /* without SOS the whole frame is the scan data and there is nothing to
+   * compare the next frame with */
+  if (sos_found) {
+    pay->frame_header = g_memdup (data, jpeg_header_size);
+    pay->frame_header_size = jpeg_header_size;
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+unsupported_jpeg:
+  {
+    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("Unsupported JPEG"), (NULL));
+    return FALSE;
+  }
+no_dimension:
+  {
+    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("No size given"), (NULL));
+    return FALSE;
+  }
+invalid_format:
+  {
+    /* error was posted */
+    return FALSE;
+  }
+invalid_quant:
+  {
+    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("Invalid quant tables"), (NULL));
+    return FALSE;
+  }
+}
+
+static GstFlowReturn
+gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
+    GstBuffer * buffer)
+{
+  GstRtpJPEGPay *pay;
+  GstClockTime timestamp;
+  GstFlowReturn ret = GST_FLOW_ERROR;
+  GstMapInfo map;
+  guint8 *data;
+  gsize size;
+  guint mtu;
+  guint bytes_left;
+  guint jpeg_header_size;
+  guint header_size;
+  guint offset;
+  gboolean frame_done;
+  GstBufferList *list = NULL;
+
+  pay = GST_RTP_JPEG_PAY (basepayload);
+  mtu = GST_RTP_BASE_PAYLOAD_MTU (pay);
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  data = map.data;
+  size = map.size;
+  timestamp = GST_BUFFER_TIMESTAMP (buffer);
+
+  GST_LOG_OBJECT (pay, "got buffer size %" G_GSIZE_FORMAT
+      " , timestamp %" GST_TIME_FORMAT, size, GST_TIME_ARGS (timestamp));
+
+  /* cameras send the same headers in every frame, only parse them when they
+   * changed */
+  if (pay->frame_header_size > 0 && size >= pay->frame_header_size &&
+      memcmp (data, pay->frame_header, pay->frame_header_size) == 0) {
+    GST_LOG_OBJECT (pay, "headers did not change");
+  } else if (!gst_rtp_jpeg_pay_parse_headers (pay, data, size)) {
+    goto invalid_headers;
+  }
+
+  jpeg_header_size = pay->frame_header_size;
+
+  size -= jpeg_header_size;
+  data += jpeg_header_size;
+  offset = 0;
+
+  list = gst_buffer_list_new ();
+
+  bytes_left = pay->first_packet_header_size + size;
+  header_size = pay->first_packet_header_size;
 
   frame_done = FALSE;
   do {
     GstBuffer *outbuf;
     guint8 *payload;
     guint payload_size = (bytes_left < mtu ? bytes_left : mtu);
-    guint header_size;
     GstBuffer *paybuf;
     GstRTPBuffer rtp = { NULL };
 
-    header_size = sizeof (jpeg_header) + quant_data_size;
-    if (dri_found)
-      header_size += sizeof (restart_marker_header);
-
     outbuf = gst_rtp_buffer_new_allocate (header_size, 0, 0);
 
     gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
@@ -834,46 +950,18 @@ gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
 
     payload = gst_rtp_buffer_get_payload (&rtp);
 
-    /* update offset */
-#if (G_BYTE_ORDER == G_LITTLE_ENDIAN)
-    jpeg_header.offset = ((offset & 0x0000FF) << 16) |
-        ((offset & 0xFF0000) >> 16) | (offset & 0x00FF00);
-#else
-    jpeg_header.offset = offset;
-#endif
-    memcpy (payload, &jpeg_header, sizeof (jpeg_header));
-    payload += sizeof (jpeg_header);
-    payload_size -= sizeof (jpeg_header);
-
-    if (dri_found) {
-      memcpy (payload, &restart_marker_header, sizeof (restart_marker_header));
-      payload += sizeof (restart_marker_header);
-      payload_size -= sizeof (restart_marker_header);
-    }
-
-    /* only send quant table with first packet */
-    if (G_UNLIKELY (quant_data_size > 0)) {
-      memcpy (payload, &quant_header, sizeof (quant_header));
-      payload += sizeof (quant_header);
-
-      /* copy the quant tables for luma and chrominance */
-      for (i = 0; i < 2; i++) {
-        guint qsize;
-        guint qt;
+    /* the quant tables are only sent with the first packet */
+    memcpy (payload, pay->packet_header, header_size);
 
-        qt = info[i].qt;
-        qsize = tables[qt].size;
-        memcpy (payload, tables[qt].data, qsize);
+    /* update the 24 bits fragment offset */
+    payload[1] = (offset >> 16) & 0xff;
+    payload[2] = (offset >> 8) & 0xff;
+    payload[3] = offset & 0xff;
 
-        GST_LOG_OBJECT (pay, "component %d using quant %d, size %d", i, qt,
-            qsize);
+    payload_size -= header_size;
+    bytes_left -= header_size - pay->packet_header_size;
+    header_size = pay->packet_header_size;
 
-        payload += qsize;
-      }
-      payload_size -= quant_data_size;
-      bytes_left -= quant_data_size;
-      quant_data_size = 0;
-    }
     GST_LOG_OBJECT (pay, "sending payload size %d", payload_size);
     gst_rtp_buffer_unmap (&rtp);
 
@@ -904,30 +992,8 @@ gst_rtp_jpeg_pay_handle_buffer (GstRTPBasePayload * basepayload,
   return ret;
 
   /* ERRORS */
-unsupported_jpeg:
+invalid_headers:
   {
-    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("Unsupported JPEG"), (NULL));
-    gst_buffer_unmap (buffer, &map);
-    gst_buffer_unref (buffer);
-    return GST_FLOW_OK;
-  }
-no_dimension:
-  {
-    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("No size given"), (NULL));
-    gst_buffer_unmap (buffer, &map);
-    gst_buffer_unref (buffer);
-    return GST_FLOW_OK;
-  }
-invalid_format:
-  {
-    /* error was posted */
-    gst_buffer_unmap (buffer, &map);
-    gst_buffer_unref (buffer);
-    return GST_FLOW_OK;
-  }
-invalid_quant:
-  {
-    GST_ELEMENT_WARNING (pay, STREAM, FORMAT, ("Invalid quant tables"), (NULL));
     gst_buffer_unmap (buffer, &map);
     gst_buffer_unref (buffer);
     return GST_FLOW_OK;
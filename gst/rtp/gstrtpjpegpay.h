@@ -48,6 +48,14 @@ struct _GstRtpJPEGPay
   gint width;
 
   guint8 quant;
+
+  /* the JPEG headers of the last frame and the RTP payload headers made
+   * from them */
+  guint8 *frame_header;
+  guint frame_header_size;
+  guint8 *packet_header;
+  guint packet_header_size;
+  guint first_packet_header_size;
 };
 
 struct _GstRtpJPEGPayClass
@@ -76,6 +76,9 @@ static gboolean gst_rtp_mp2t_depay_setcaps (GstRTPBaseDepayload * depayload,
 static GstBuffer *gst_rtp_mp2t_depay_process (GstRTPBaseDepayload * depayload,
     GstBuffer * buf);
 
+static GstFlowReturn gst_rtp_mp2t_depay_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
+
 static void gst_rtp_mp2t_depay_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_rtp_mp2t_depay_get_property (GObject * object, guint prop_id,
@@ -120,7 +123,15 @@ gst_rtp_mp2t_depay_class_init (GstRtpMP2TDepayClass * klass)
 static void
 gst_rtp_mp2t_depay_init (GstRtpMP2TDepay * rtpmp2tdepay)
 {
+  GstPad *sinkpad = GST_RTP_BASE_DEPAYLOAD_SINKPAD (rtpmp2tdepay);
+
   rtpmp2tdepay->skip_first_bytes = DEFAULT_SKIP_FIRST_BYTES;
+
+  /* lists of RTP packets go through the base class one packet at a time, the
+   * TS of all of them is pushed downstream as one list */
+  rtpmp2tdepay->chain = GST_PAD_CHAINFUNC (sinkpad);
+  gst_pad_set_chain_list_function (sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_depay_chain_list));
 }
 
 static gboolean
@@ -183,10 +194,17 @@ gst_rtp_mp2t_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
       rtpmp2tdepay->skip_first_bytes, payload_len);
 
   gst_rtp_buffer_unmap (&rtp);
-  if (outbuf)
+  if (outbuf) {
     GST_DEBUG ("gst_rtp_mp2t_depay_chain: pushing buffer of size %"
         G_GSIZE_FORMAT, gst_buffer_get_size (outbuf));
 
+    /* collect the TS of a list of RTP packets */
+    if (rtpmp2tdepay->out_list) {
+      gst_buffer_list_add (rtpmp2tdepay->out_list, outbuf);
+      outbuf = NULL;
+    }
+  }
+
   return outbuf;
 
   /* ERRORS */
@@ -199,6 +217,40 @@ empty_packet:
   }
 }
 
+static GstFlowReturn
+gst_rtp_mp2t_depay_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpMP2TDepay *rtpmp2tdepay;
+  GstBufferList *out_list;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  rtpmp2tdepay = GST_RTP_MP2T_DEPAY (parent);
+
+  len = gst_buffer_list_length (list);
+  rtpmp2tdepay->out_list = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+    ret = rtpmp2tdepay->chain (pad, parent,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+
+  out_list = rtpmp2tdepay->out_list;
+  rtpmp2tdepay->out_list = NULL;
+  gst_buffer_list_unref (list);
+
+  if (ret != GST_FLOW_OK || gst_buffer_list_length (out_list) == 0) {
+    gst_buffer_list_unref (out_list);
+    return ret;
+  }
+
+  GST_LOG_OBJECT (rtpmp2tdepay, "pushing list of %u buffers",
+      gst_buffer_list_length (out_list));
+
+  return gst_rtp_base_depayload_push_list (GST_RTP_BASE_DEPAYLOAD (parent),
+      out_list);
+}
+
 static void
 gst_rtp_mp2t_depay_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -44,6 +44,10 @@ struct _GstRtpMP2TDepay
   GstRTPBaseDepayload depayload;
 
   guint8 skip_first_bytes;
+
+  /* base class chain function and the TS collected from a list */
+  GstPadChainFunction chain;
+  GstBufferList *out_list;
 };
 
 struct _GstRtpMP2TDepayClass
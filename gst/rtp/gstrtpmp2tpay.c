@@ -27,6 +27,15 @@
 
 #include "gstrtpmp2tpay.h"
 
+#define DEFAULT_TS_PACKETS      0
+
+enum
+{
+  PROP_0,
+  PROP_TS_PACKETS,
+  PROP_LAST
+};
+
 static GstStaticPadTemplate gst_rtp_mp2t_pay_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -51,6 +60,10 @@ static GstFlowReturn gst_rtp_mp2t_pay_handle_buffer (GstRTPBasePayload *
     payload, GstBuffer * buffer);
 static GstFlowReturn gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay);
 static void gst_rtp_mp2t_pay_finalize (GObject * object);
+static void gst_rtp_mp2t_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_mp2t_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 #define gst_rtp_mp2t_pay_parent_class parent_class
 G_DEFINE_TYPE (GstRTPMP2TPay, gst_rtp_mp2t_pay, GST_TYPE_RTP_BASE_PAYLOAD);
@@ -67,6 +80,8 @@ gst_rtp_mp2t_pay_class_init (GstRTPMP2TPayClass * klass)
   gstrtpbasepayload_class = (GstRTPBasePayloadClass *) klass;
 
   gobject_class->finalize = gst_rtp_mp2t_pay_finalize;
+  gobject_class->set_property = gst_rtp_mp2t_pay_set_property;
+  gobject_class->get_property = gst_rtp_mp2t_pay_get_property;
 
   gstrtpbasepayload_class->set_caps = gst_rtp_mp2t_pay_setcaps;
   gstrtpbasepayload_class->handle_buffer = gst_rtp_mp2t_pay_handle_buffer;
@@ -79,6 +94,20 @@ gst_rtp_mp2t_pay_class_init (GstRTPMP2TPayClass * klass)
       "RTP MPEG2 Transport Stream payloader", "Codec/Payloader/Network/RTP",
       "Payload-encodes MPEG2 TS into RTP packets (RFC 2250)",
       "Wim Taymans <wim.taymans@gmail.com>");
+
+  /**
+   * GstRTPMP2TPay:ts-packets:
+   *
+   * The number of MPEG TS packets in one RTP packet. With 0 as many TS
+   * packets as fit in the MTU are put in an RTP packet.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_TS_PACKETS,
+      g_param_spec_uint ("ts-packets", "TS packets",
+          "Number of TS packets per RTP packet (0 = fill the MTU)",
+          0, G_MAXUINT / 188, DEFAULT_TS_PACKETS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -88,6 +117,7 @@ gst_rtp_mp2t_pay_init (GstRTPMP2TPay * rtpmp2tpay)
   GST_RTP_BASE_PAYLOAD_PT (rtpmp2tpay) = GST_RTP_PAYLOAD_MP2T;
 
   rtpmp2tpay->adapter = gst_adapter_new ();
+  rtpmp2tpay->ts_packets = DEFAULT_TS_PACKETS;
 }
 
 static void
@@ -114,31 +144,45 @@ gst_rtp_mp2t_pay_setcaps (GstRTPBasePayload * payload, GstCaps * caps)
   return res;
 }
 
+/* the maximum payload size of one RTP packet */
+static guint
+gst_rtp_mp2t_pay_get_max_payload (GstRTPMP2TPay * rtpmp2tpay)
+{
+  guint max_payload, ts_packets;
+
+  GST_OBJECT_LOCK (rtpmp2tpay);
+  ts_packets = rtpmp2tpay->ts_packets;
+  GST_OBJECT_UNLOCK (rtpmp2tpay);
+
+  max_payload =
+      gst_rtp_buffer_calc_payload_len (GST_RTP_BASE_PAYLOAD_MTU (rtpmp2tpay),
+      0, 0);
+  if (ts_packets > 0)
+    max_payload = MIN (max_payload, ts_packets * 188);
+
+  return max_payload - max_payload % 188;
+}
+
 static GstFlowReturn
 gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay)
 {
-  guint avail, mtu;
+  guint avail, max_payload;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *outbuf;
+  GstBufferList *list;
 
   avail = gst_adapter_available (rtpmp2tpay->adapter);
 
-  mtu = GST_RTP_BASE_PAYLOAD_MTU (rtpmp2tpay);
+  max_payload = gst_rtp_mp2t_pay_get_max_payload (rtpmp2tpay);
 
-  while (avail > 0 && (ret == GST_FLOW_OK)) {
-    guint towrite;
+  list = gst_buffer_list_new ();
+
+  while (avail > 0) {
     guint payload_len;
-    guint packet_len;
     GstBuffer *paybuf;
 
-    /* this will be the total length of the packet */
-    packet_len = gst_rtp_buffer_calc_packet_len (avail, 0, 0);
-
-    /* fill one MTU or all available bytes */
-    towrite = MIN (packet_len, mtu);
-
-    /* this is the payload length */
-    payload_len = gst_rtp_buffer_calc_payload_len (towrite, 0, 0);
+    /* fill one packet or take all available whole TS packets */
+    payload_len = MIN (avail, max_payload);
     payload_len -= payload_len % 188;
 
     /* need whole packets */
@@ -148,7 +192,7 @@ gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay)
     /* create buffer to hold the payload */
     outbuf = gst_rtp_buffer_new_allocate (0, 0, 0);
 
-    /* get payload */
+    /* get payload, this refers to the memory of the input buffers */
     paybuf = gst_adapter_take_buffer_fast (rtpmp2tpay->adapter, payload_len);
     outbuf = gst_buffer_append (outbuf, paybuf);
     avail -= payload_len;
@@ -156,12 +200,19 @@ gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay)
     GST_BUFFER_TIMESTAMP (outbuf) = rtpmp2tpay->first_ts;
     GST_BUFFER_DURATION (outbuf) = rtpmp2tpay->duration;
 
-    GST_DEBUG_OBJECT (rtpmp2tpay, "pushing buffer of size %u",
+    GST_DEBUG_OBJECT (rtpmp2tpay, "queueing buffer of size %u",
         (guint) gst_buffer_get_size (outbuf));
 
-    ret = gst_rtp_base_payload_push (GST_RTP_BASE_PAYLOAD (rtpmp2tpay), outbuf);
+    gst_buffer_list_add (list, outbuf);
   }
 
+  /* push all packets made from the available data at once */
+  if (gst_buffer_list_length (list) > 0)
+    ret = gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD (rtpmp2tpay),
+        list);
+  else
+    gst_buffer_list_unref (list);
+
   return ret;
 }
 
@@ -170,7 +221,7 @@ gst_rtp_mp2t_pay_handle_buffer (GstRTPBasePayload * basepayload,
     GstBuffer * buffer)
 {
   GstRTPMP2TPay *rtpmp2tpay;
-  guint size, avail, packet_len;
+  guint size, avail, packet_len, max_payload;
   GstClockTime timestamp, duration;
   GstFlowReturn ret;
 
@@ -193,10 +244,13 @@ again:
   /* get packet length of previous data and this new data */
   packet_len = gst_rtp_buffer_calc_packet_len (avail + size, 0, 0);
 
+  max_payload = gst_rtp_mp2t_pay_get_max_payload (rtpmp2tpay);
+
   /* if this buffer is going to overflow the packet, flush what we have,
    * or if upstream is handing us several packets, to keep latency low */
-  if (!size || gst_rtp_base_payload_is_filled (basepayload,
-          packet_len, rtpmp2tpay->duration + duration)) {
+  if (!size || avail + size > max_payload ||
+      gst_rtp_base_payload_is_filled (basepayload, packet_len,
+          rtpmp2tpay->duration + duration)) {
     ret = gst_rtp_mp2t_pay_flush (rtpmp2tpay);
     rtpmp2tpay->first_ts = timestamp;
     rtpmp2tpay->duration = duration;
@@ -222,6 +276,46 @@ again:
 
 }
 
+static void
+gst_rtp_mp2t_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRTPMP2TPay *rtpmp2tpay;
+
+  rtpmp2tpay = GST_RTP_MP2T_PAY (object);
+
+  switch (prop_id) {
+    case PROP_TS_PACKETS:
+      GST_OBJECT_LOCK (rtpmp2tpay);
+      rtpmp2tpay->ts_packets = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rtpmp2tpay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_mp2t_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRTPMP2TPay *rtpmp2tpay;
+
+  rtpmp2tpay = GST_RTP_MP2T_PAY (object);
+
+  switch (prop_id) {
+    case PROP_TS_PACKETS:
+      GST_OBJECT_LOCK (rtpmp2tpay);
+      g_value_set_uint (value, rtpmp2tpay->ts_packets);
+      GST_OBJECT_UNLOCK (rtpmp2tpay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 gboolean
 gst_rtp_mp2t_pay_plugin_init (GstPlugin * plugin)
 {
@@ -48,6 +48,8 @@ struct _GstRTPMP2TPay
   GstAdapter  *adapter;
   GstClockTime first_ts;
   GstClockTime duration;
+
+  guint ts_packets;
 };
 
 struct _GstRTPMP2TPayClass
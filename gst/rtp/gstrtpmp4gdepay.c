@@ -179,7 +179,6 @@ static void
 gst_rtp_mp4g_depay_init (GstRtpMP4GDepay * rtpmp4gdepay)
 {
   rtpmp4gdepay->adapter = gst_adapter_new ();
-  rtpmp4gdepay->packets = g_queue_new ();
 }
 
 static void
@@ -191,8 +190,6 @@ gst_rtp_mp4g_depay_finalize (GObject * object)
 
   g_object_unref (rtpmp4gdepay->adapter);
   rtpmp4gdepay->adapter = NULL;
-  g_queue_free (rtpmp4gdepay->packets);
-  rtpmp4gdepay->packets = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -302,13 +299,20 @@ unknown_media:
   }
 }
 
+#define AU_SLOT(idx) ((idx) % GST_RTP_MP4G_DEPAY_MAX_REORDER)
+
 static void
 gst_rtp_mp4g_depay_clear_queue (GstRtpMP4GDepay * rtpmp4gdepay)
 {
-  GstBuffer *outbuf;
+  guint i;
 
-  while ((outbuf = g_queue_pop_head (rtpmp4gdepay->packets)))
-    gst_buffer_unref (outbuf);
+  for (i = 0; rtpmp4gdepay->n_packets > 0; i++) {
+    if (rtpmp4gdepay->packets[i]) {
+      gst_buffer_unref (rtpmp4gdepay->packets[i]);
+      rtpmp4gdepay->packets[i] = NULL;
+      rtpmp4gdepay->n_packets--;
+    }
+  }
 }
 
 static void
@@ -323,32 +327,53 @@ gst_rtp_mp4g_depay_reset (GstRtpMP4GDepay * rtpmp4gdepay)
   gst_rtp_mp4g_depay_clear_queue (rtpmp4gdepay);
 }
 
+/* push @outbuf and mark it DISCONT when it was not the next expected AU */
 static void
-gst_rtp_mp4g_depay_flush_queue (GstRtpMP4GDepay * rtpmp4gdepay)
+gst_rtp_mp4g_depay_push_AU (GstRtpMP4GDepay * rtpmp4gdepay, GstBuffer * outbuf)
 {
-  GstBuffer *outbuf;
-  gboolean discont = FALSE;
-  guint AU_index;
+  guint AU_index = GST_BUFFER_OFFSET (outbuf);
 
-  while ((outbuf = g_queue_pop_head (rtpmp4gdepay->packets))) {
-    AU_index = GST_BUFFER_OFFSET (outbuf);
+  if (rtpmp4gdepay->next_AU_index != AU_index) {
+    GST_DEBUG_OBJECT (rtpmp4gdepay, "discont, expected AU_index %u",
+        rtpmp4gdepay->next_AU_index);
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+  }
 
-    GST_DEBUG_OBJECT (rtpmp4gdepay, "next available AU_index %u", AU_index);
+  GST_DEBUG_OBJECT (rtpmp4gdepay, "pushing AU_index %u", AU_index);
+  gst_rtp_base_depayload_push (GST_RTP_BASE_DEPAYLOAD (rtpmp4gdepay), outbuf);
+  rtpmp4gdepay->next_AU_index = AU_index + 1;
+}
 
-    if (rtpmp4gdepay->next_AU_index != AU_index) {
-      GST_DEBUG_OBJECT (rtpmp4gdepay, "discont, expected AU_index %u",
-          rtpmp4gdepay->next_AU_index);
-      discont = TRUE;
-    }
+/* the lowest queued AU_index, the queue must not be empty */
+static guint
+gst_rtp_mp4g_depay_first_queued (GstRtpMP4GDepay * rtpmp4gdepay)
+{
+  guint base = rtpmp4gdepay->next_AU_index;
+  guint i;
 
-    if (discont) {
-      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
-      discont = FALSE;
-    }
+  for (i = 0; !rtpmp4gdepay->packets[AU_SLOT (base + i)]; i++);
 
-    GST_DEBUG_OBJECT (rtpmp4gdepay, "pushing AU_index %u", AU_index);
-    gst_rtp_base_depayload_push (GST_RTP_BASE_DEPAYLOAD (rtpmp4gdepay), outbuf);
-    rtpmp4gdepay->next_AU_index = AU_index + 1;
+  return base + i;
+}
+
+static void
+gst_rtp_mp4g_depay_flush_queue (GstRtpMP4GDepay * rtpmp4gdepay)
+{
+  GstBuffer *outbuf;
+  guint base = rtpmp4gdepay->next_AU_index;
+  guint i;
+
+  /* all queued AUs are less than MAX_REORDER after the next expected one */
+  for (i = 0; rtpmp4gdepay->n_packets > 0; i++) {
+    outbuf = rtpmp4gdepay->packets[AU_SLOT (base + i)];
+    if (outbuf == NULL)
+      continue;
+
+    rtpmp4gdepay->packets[AU_SLOT (base + i)] = NULL;
+    rtpmp4gdepay->n_packets--;
+
+    GST_DEBUG_OBJECT (rtpmp4gdepay, "next available AU_index %u", base + i);
+    gst_rtp_mp4g_depay_push_AU (rtpmp4gdepay, outbuf);
   }
 }
 
@@ -356,6 +381,7 @@ static void
 gst_rtp_mp4g_depay_queue (GstRtpMP4GDepay * rtpmp4gdepay, GstBuffer * outbuf)
 {
   guint AU_index = GST_BUFFER_OFFSET (outbuf);
+  gint gap;
 
   if (rtpmp4gdepay->next_AU_index == -1) {
     GST_DEBUG_OBJECT (rtpmp4gdepay, "Init AU counter %u", AU_index);
@@ -370,50 +396,48 @@ gst_rtp_mp4g_depay_queue (GstRtpMP4GDepay * rtpmp4gdepay, GstBuffer * outbuf)
     gst_rtp_base_depayload_push (GST_RTP_BASE_DEPAYLOAD (rtpmp4gdepay), outbuf);
     rtpmp4gdepay->next_AU_index++;
 
-    while ((outbuf = g_queue_peek_head (rtpmp4gdepay->packets))) {
-      AU_index = GST_BUFFER_OFFSET (outbuf);
-
-      GST_DEBUG_OBJECT (rtpmp4gdepay, "next available AU_index %u", AU_index);
+    while (rtpmp4gdepay->n_packets > 0) {
+      guint slot = AU_SLOT (rtpmp4gdepay->next_AU_index);
 
-      if (rtpmp4gdepay->next_AU_index == AU_index) {
-        GST_DEBUG_OBJECT (rtpmp4gdepay, "pushing expected AU_index %u",
-            AU_index);
-        outbuf = g_queue_pop_head (rtpmp4gdepay->packets);
-        gst_rtp_base_depayload_push (GST_RTP_BASE_DEPAYLOAD (rtpmp4gdepay),
-            outbuf);
-        rtpmp4gdepay->next_AU_index++;
-      } else {
+      if ((outbuf = rtpmp4gdepay->packets[slot]) == NULL) {
         GST_DEBUG_OBJECT (rtpmp4gdepay, "waiting for next AU_index %u",
             rtpmp4gdepay->next_AU_index);
         break;
       }
-    }
-  } else {
-    GList *list;
+      rtpmp4gdepay->packets[slot] = NULL;
+      rtpmp4gdepay->n_packets--;
 
-    GST_DEBUG_OBJECT (rtpmp4gdepay, "queueing AU_index %u", AU_index);
-
-    /* loop the list to skip strictly smaller AU_index buffers */
-    for (list = rtpmp4gdepay->packets->head; list; list = g_list_next (list)) {
-      guint idx;
-      gint gap;
+      GST_DEBUG_OBJECT (rtpmp4gdepay, "pushing expected AU_index %u",
+          rtpmp4gdepay->next_AU_index);
+      gst_rtp_base_depayload_push (GST_RTP_BASE_DEPAYLOAD (rtpmp4gdepay),
+          outbuf);
+      rtpmp4gdepay->next_AU_index++;
+    }
+    return;
+  }
 
-      idx = GST_BUFFER_OFFSET (GST_BUFFER_CAST (list->data));
+  gap = (gint) (AU_index - rtpmp4gdepay->next_AU_index);
 
-      /* compare the new seqnum to the one in the buffer */
-      gap = (gint) (idx - AU_index);
+  if (G_LIKELY (gap > 0 && gap < GST_RTP_MP4G_DEPAY_MAX_REORDER)) {
+    guint slot = AU_SLOT (AU_index);
 
-      GST_DEBUG_OBJECT (rtpmp4gdepay, "compare with AU_index %u, gap %d", idx,
-          gap);
+    GST_DEBUG_OBJECT (rtpmp4gdepay, "queueing AU_index %u", AU_index);
 
-      /* AU_index <= idx, we can stop looking */
-      if (G_LIKELY (gap > 0))
-        break;
+    if (G_UNLIKELY (rtpmp4gdepay->packets[slot])) {
+      GST_DEBUG_OBJECT (rtpmp4gdepay, "dropping duplicate AU_index %u",
+          AU_index);
+      gst_buffer_unref (rtpmp4gdepay->packets[slot]);
+      rtpmp4gdepay->n_packets--;
     }
-    if (G_LIKELY (list))
-      g_queue_insert_before (rtpmp4gdepay->packets, list, outbuf);
-    else
-      g_queue_push_tail (rtpmp4gdepay->packets, outbuf);
+    rtpmp4gdepay->packets[slot] = outbuf;
+    rtpmp4gdepay->n_packets++;
+  } else {
+    /* too far ahead of or behind the expected AU for the reorder array, push
+     * what we have and continue from this AU */
+    GST_DEBUG_OBJECT (rtpmp4gdepay, "AU_index %u out of reorder range, gap %d",
+        AU_index, gap);
+    gst_rtp_mp4g_depay_flush_queue (rtpmp4gdepay);
+    gst_rtp_mp4g_depay_push_AU (rtpmp4gdepay, outbuf);
   }
 }
 
@@ -594,16 +618,14 @@ gst_rtp_mp4g_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           if (G_UNLIKELY (!rtpmp4gdepay->maxDisplacement &&
                   rtpmp4gdepay->max_AU_index != -1
                   && rtpmp4gdepay->max_AU_index >= AU_index)) {
-            GstBuffer *outbuf;
-
             /* some broken non-interleaved streams have AU-index jumping around
              * all over the place, apparently assuming receiver disregards */
             GST_DEBUG_OBJECT (rtpmp4gdepay, "non-interleaved broken AU indices;"
                 " forcing continuous flush");
             /* reset AU to avoid repeated DISCONT in such case */
-            outbuf = g_queue_peek_head (rtpmp4gdepay->packets);
-            if (G_LIKELY (outbuf)) {
-              rtpmp4gdepay->next_AU_index = GST_BUFFER_OFFSET (outbuf);
+            if (G_LIKELY (rtpmp4gdepay->n_packets > 0)) {
+              rtpmp4gdepay->next_AU_index =
+                  gst_rtp_mp4g_depay_first_queued (rtpmp4gdepay);
               gst_rtp_mp4g_depay_flush_queue (rtpmp4gdepay);
             }
             /* rebase next_AU_index to current rtp's first AU_index */
@@ -647,19 +669,25 @@ gst_rtp_mp4g_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
         if (AU_size > payload_AU_size)
           AU_size = payload_AU_size;
 
-        /* collect stuff in the adapter, strip header from payload and push in
-         * the adapter */
+        /* strip header from payload, the AU references the memory of the
+         * packet */
         outbuf =
             gst_rtp_buffer_get_payload_subbuffer (&rtp, payload_AU, AU_size);
-        gst_adapter_push (rtpmp4gdepay->adapter, outbuf);
 
-        if (M) {
+        if (!M) {
+          /* collect the fragments in the adapter */
+          gst_adapter_push (rtpmp4gdepay->adapter, outbuf);
+        } else {
           guint avail;
 
-          /* packet is complete, flush */
+          /* packet is complete, the fragments are combined without merging
+           * their memory. An AU that is not fragmented is used as is */
           avail = gst_adapter_available (rtpmp4gdepay->adapter);
-
-          outbuf = gst_adapter_take_buffer (rtpmp4gdepay->adapter, avail);
+          if (avail > 0) {
+            gst_adapter_push (rtpmp4gdepay->adapter, outbuf);
+            outbuf = gst_adapter_take_buffer_fast (rtpmp4gdepay->adapter,
+                avail + AU_size);
+          }
 
           /* copy some of the fields we calculated above on the buffer. We also
            * copy the AU_index so that we can sort the packets in our queue. */
@@ -691,7 +719,7 @@ gst_rtp_mp4g_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
         avail = gst_adapter_available (rtpmp4gdepay->adapter);
 
-        outbuf = gst_adapter_take_buffer (rtpmp4gdepay->adapter, avail);
+        outbuf = gst_adapter_take_buffer_fast (rtpmp4gdepay->adapter, avail);
 
         GST_DEBUG ("gst_rtp_mp4g_depay_chain: pushing buffer of size %"
             G_GSIZE_FORMAT, gst_buffer_get_size (outbuf));
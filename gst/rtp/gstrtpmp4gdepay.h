@@ -37,6 +37,10 @@ G_BEGIN_DECLS
 #define GST_IS_RTP_MP4G_DEPAY_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_MP4G_DEPAY))
 
+/* the maximum distance from the next expected AU of an AU that is kept for
+ * reordering */
+#define GST_RTP_MP4G_DEPAY_MAX_REORDER 64
+
 typedef struct _GstRtpMP4GDepay GstRtpMP4GDepay;
 typedef struct _GstRtpMP4GDepayClass GstRtpMP4GDepayClass;
 
@@ -67,8 +71,10 @@ struct _GstRtpMP4GDepay
   guint32 prev_rtptime;
   guint prev_AU_num;
 
-  GQueue *packets;
-  
+  /* AUs waiting for reordering, at AU_index % MAX_REORDER */
+  GstBuffer *packets[GST_RTP_MP4G_DEPAY_MAX_REORDER];
+  guint n_packets;
+
   GstAdapter *adapter;
 };
 
@@ -201,9 +201,14 @@ gst_rtp_stream_depay_handle_frame (GstBaseParse * parse,
   size = GUINT16_FROM_BE (size);
   buf_size = gst_buffer_get_size (frame->buffer);
 
-  /* Need more data */
-  if (size + 2 > buf_size)
+  /* Need more data. Let baseparse wait for the complete packet instead of
+   * calling us with every chunk that arrives, which merges the data collected
+   * so far each time */
+  if (size + 2 > buf_size) {
+    gst_base_parse_set_min_frame_size (parse, size + 2);
     return GST_FLOW_OK;
+  }
+  gst_base_parse_set_min_frame_size (parse, 2);
 
   frame->out_buffer =
       gst_buffer_copy_region (frame->buffer, GST_BUFFER_COPY_ALL, 2, size);
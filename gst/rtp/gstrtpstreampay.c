@@ -62,6 +62,8 @@ static gboolean gst_rtp_stream_pay_sink_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 static GstFlowReturn gst_rtp_stream_pay_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * inbuf);
+static GstFlowReturn gst_rtp_stream_pay_sink_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static gboolean gst_rtp_stream_pay_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 
@@ -92,6 +94,8 @@ gst_rtp_stream_pay_init (GstRtpStreamPay * self)
   self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
   gst_pad_set_chain_function (self->sinkpad,
       GST_DEBUG_FUNCPTR (gst_rtp_stream_pay_sink_chain));
+  gst_pad_set_chain_list_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_stream_pay_sink_chain_list));
   gst_pad_set_event_function (self->sinkpad,
       GST_DEBUG_FUNCPTR (gst_rtp_stream_pay_sink_event));
   gst_pad_set_query_function (self->sinkpad,
@@ -279,6 +283,66 @@ gst_rtp_stream_pay_sink_chain (GstPad * pad, GstObject * parent,
   return gst_pad_push (self->srcpad, outbuf);
 }
 
+static GstFlowReturn
+gst_rtp_stream_pay_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpStreamPay *self = GST_RTP_STREAM_PAY (parent);
+  GstBufferList *outlist;
+  GstMemory *headers;
+  GstMapInfo map;
+  GstBuffer *inbuf, *outbuf;
+  gsize size;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  if (len == 0) {
+    gst_buffer_list_unref (list);
+    return GST_FLOW_OK;
+  }
+
+  /* the length headers of all packets are written into one memory, every
+   * output buffer then gets its 2 bytes of it without copying */
+  headers = gst_allocator_alloc (NULL, 2 * len, NULL);
+  gst_memory_map (headers, &map, GST_MAP_WRITE);
+  for (i = 0; i < len; i++) {
+    size = gst_buffer_get_size (gst_buffer_list_get (list, i));
+    if (size > G_MAXUINT16)
+      goto too_big;
+    GST_WRITE_UINT16_BE (map.data + 2 * i, size);
+  }
+  gst_memory_unmap (headers, &map);
+
+  outlist = gst_buffer_list_new_sized (len);
+  for (i = 0; i < len; i++) {
+    inbuf = gst_buffer_list_get (list, i);
+
+    outbuf = gst_buffer_new ();
+    gst_buffer_append_memory (outbuf, gst_memory_share (headers, 2 * i, 2));
+    gst_buffer_copy_into (outbuf, inbuf, GST_BUFFER_COPY_ALL, 0, -1);
+
+    gst_buffer_list_add (outlist, outbuf);
+  }
+  gst_memory_unref (headers);
+  gst_buffer_list_unref (list);
+
+  GST_LOG_OBJECT (self, "pushing list of %u packets", len);
+
+  return gst_pad_push_list (self->srcpad, outlist);
+
+  /* ERRORS */
+too_big:
+  {
+    GST_ELEMENT_ERROR (self, CORE, FAILED, (NULL),
+        ("Only buffers up to %d bytes supported, got %" G_GSIZE_FORMAT,
+            G_MAXUINT16, size));
+    gst_memory_unmap (headers, &map);
+    gst_memory_unref (headers);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
+}
+
 gboolean
 gst_rtp_stream_pay_plugin_init (GstPlugin * plugin)
 {
@@ -153,6 +153,18 @@ gst_rtp_theora_pay_clear_packet (GstRtpTheoraPay * rtptheorapay)
   rtptheorapay->packet = NULL;
 }
 
+static void
+gst_rtp_theora_pay_free_pool (GstRtpTheoraPay * rtptheorapay)
+{
+  if (rtptheorapay->pool == NULL)
+    return;
+
+  gst_buffer_pool_set_active (rtptheorapay->pool, FALSE);
+  gst_object_unref (rtptheorapay->pool);
+  rtptheorapay->pool = NULL;
+  rtptheorapay->pool_size = 0;
+}
+
 static void
 gst_rtp_theora_pay_cleanup (GstRtpTheoraPay * rtptheorapay)
 {
@@ -161,6 +173,7 @@ gst_rtp_theora_pay_cleanup (GstRtpTheoraPay * rtptheorapay)
   rtptheorapay->headers = NULL;
 
   gst_rtp_theora_pay_clear_packet (rtptheorapay);
+  gst_rtp_theora_pay_free_pool (rtptheorapay);
 
   if (rtptheorapay->config_data)
     g_free (rtptheorapay->config_data);
@@ -270,6 +283,49 @@ gst_rtp_theora_pay_reset_packet (GstRtpTheoraPay * rtptheorapay, guint8 TDT)
   rtptheorapay->payload_pkts = 0;
 }
 
+/* get a packet of mtu bytes with an empty RTP header. The packets come from
+ * a pool so that a stream of small frames doesn't allocate every packet */
+static GstBuffer *
+gst_rtp_theora_pay_alloc_packet (GstRtpTheoraPay * rtptheorapay)
+{
+  guint mtu = GST_RTP_BASE_PAYLOAD_MTU (rtptheorapay);
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+
+  if (rtptheorapay->pool && rtptheorapay->pool_size != mtu)
+    gst_rtp_theora_pay_free_pool (rtptheorapay);
+
+  if (rtptheorapay->pool == NULL) {
+    GstStructure *config;
+
+    rtptheorapay->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (rtptheorapay->pool);
+    gst_buffer_pool_config_set_params (config, NULL, mtu, 0, 0);
+    if (!gst_buffer_pool_set_config (rtptheorapay->pool, config) ||
+        !gst_buffer_pool_set_active (rtptheorapay->pool, TRUE)) {
+      GST_WARNING_OBJECT (rtptheorapay, "could not activate packet pool");
+      gst_object_unref (rtptheorapay->pool);
+      rtptheorapay->pool = NULL;
+      return gst_rtp_buffer_new_allocate_len (mtu, 0, 0);
+    }
+    rtptheorapay->pool_size = mtu;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (rtptheorapay->pool, &buffer,
+          NULL) != GST_FLOW_OK)
+    return gst_rtp_buffer_new_allocate_len (mtu, 0, 0);
+
+  /* the packet was trimmed when it was pushed before, write the header that
+   * gst_rtp_buffer_new_allocate_len() makes: version 2 and all zeroes */
+  gst_buffer_set_size (buffer, mtu);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0, gst_rtp_buffer_calc_header_len (0));
+  map.data[0] = 0x80;
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
 static void
 gst_rtp_theora_pay_init_packet (GstRtpTheoraPay * rtptheorapay, guint8 TDT,
     GstClockTime timestamp)
@@ -280,9 +336,7 @@ gst_rtp_theora_pay_init_packet (GstRtpTheoraPay * rtptheorapay, guint8 TDT,
     gst_buffer_unref (rtptheorapay->packet);
 
   /* new packet allocate max packet size */
-  rtptheorapay->packet =
-      gst_rtp_buffer_new_allocate_len (GST_RTP_BASE_PAYLOAD_MTU
-      (rtptheorapay), 0, 0);
+  rtptheorapay->packet = gst_rtp_theora_pay_alloc_packet (rtptheorapay);
   gst_rtp_theora_pay_reset_packet (rtptheorapay, TDT);
 
   GST_BUFFER_TIMESTAMP (rtptheorapay->packet) = timestamp;
@@ -503,6 +557,18 @@ gst_rtp_theora_pay_finish_headers (GstRTPBasePayload * basepayload)
   rtptheorapay->headers = NULL;
   rtptheorapay->need_headers = FALSE;
 
+  /* the same headers are often seen again, in new caps or in-band. When they
+   * give the configuration we already announced, keep the current caps */
+  if (rtptheorapay->config_data &&
+      rtptheorapay->config_size == configlen - 4 - 3 - 2 &&
+      !memcmp (rtptheorapay->config_data, config + 4 + 3 + 2,
+          rtptheorapay->config_size) &&
+      gst_pad_has_current_caps (GST_RTP_BASE_PAYLOAD_SRCPAD (basepayload))) {
+    GST_DEBUG_OBJECT (rtptheorapay, "configuration unchanged");
+    g_free (config);
+    return TRUE;
+  }
+
   /* serialize to base64 */
   configuration = g_base64_encode (config, configlen);
 
@@ -50,6 +50,8 @@ struct _GstRtpTheoraPay
 
   /* queues of buffers along with some stats. */
   GstBuffer    *packet;
+  GstBufferPool *pool;
+  guint         pool_size;
   guint         payload_pos;
   guint         payload_left;
   guint32       payload_ident;
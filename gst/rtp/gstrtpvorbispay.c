@@ -145,6 +145,18 @@ gst_rtp_vorbis_pay_clear_packet (GstRtpVorbisPay * rtpvorbispay)
   rtpvorbispay->packet = NULL;
 }
 
+static void
+gst_rtp_vorbis_pay_free_pool (GstRtpVorbisPay * rtpvorbispay)
+{
+  if (rtpvorbispay->pool == NULL)
+    return;
+
+  gst_buffer_pool_set_active (rtpvorbispay->pool, FALSE);
+  gst_object_unref (rtpvorbispay->pool);
+  rtpvorbispay->pool = NULL;
+  rtpvorbispay->pool_size = 0;
+}
+
 static void
 gst_rtp_vorbis_pay_cleanup (GstRtpVorbisPay * rtpvorbispay)
 {
@@ -153,6 +165,7 @@ gst_rtp_vorbis_pay_cleanup (GstRtpVorbisPay * rtpvorbispay)
   rtpvorbispay->headers = NULL;
 
   gst_rtp_vorbis_pay_clear_packet (rtpvorbispay);
+  gst_rtp_vorbis_pay_free_pool (rtpvorbispay);
 
   if (rtpvorbispay->config_data)
     g_free (rtpvorbispay->config_data);
@@ -265,6 +278,49 @@ gst_rtp_vorbis_pay_reset_packet (GstRtpVorbisPay * rtpvorbispay, guint8 VDT)
   rtpvorbispay->payload_pkts = 0;
 }
 
+/* get a packet of mtu bytes with an empty RTP header. The packets come from
+ * a pool so that a stream of small frames doesn't allocate every packet */
+static GstBuffer *
+gst_rtp_vorbis_pay_alloc_packet (GstRtpVorbisPay * rtpvorbispay)
+{
+  guint mtu = GST_RTP_BASE_PAYLOAD_MTU (rtpvorbispay);
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+
+  if (rtpvorbispay->pool && rtpvorbispay->pool_size != mtu)
+    gst_rtp_vorbis_pay_free_pool (rtpvorbispay);
+
+  if (rtpvorbispay->pool == NULL) {
+    GstStructure *config;
+
+    rtpvorbispay->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (rtpvorbispay->pool);
+    gst_buffer_pool_config_set_params (config, NULL, mtu, 0, 0);
+    if (!gst_buffer_pool_set_config (rtpvorbispay->pool, config) ||
+        !gst_buffer_pool_set_active (rtpvorbispay->pool, TRUE)) {
+      GST_WARNING_OBJECT (rtpvorbispay, "could not activate packet pool");
+      gst_object_unref (rtpvorbispay->pool);
+      rtpvorbispay->pool = NULL;
+      return gst_rtp_buffer_new_allocate_len (mtu, 0, 0);
+    }
+    rtpvorbispay->pool_size = mtu;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (rtpvorbispay->pool, &buffer,
+          NULL) != GST_FLOW_OK)
+    return gst_rtp_buffer_new_allocate_len (mtu, 0, 0);
+
+  /* the packet was trimmed when it was pushed before, write the header that
+   * gst_rtp_buffer_new_allocate_len() makes: version 2 and all zeroes */
+  gst_buffer_set_size (buffer, mtu);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0, gst_rtp_buffer_calc_header_len (0));
+  map.data[0] = 0x80;
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
 static void
 gst_rtp_vorbis_pay_init_packet (GstRtpVorbisPay * rtpvorbispay, guint8 VDT,
     GstClockTime timestamp)
@@ -275,9 +331,7 @@ gst_rtp_vorbis_pay_init_packet (GstRtpVorbisPay * rtpvorbispay, guint8 VDT,
     gst_buffer_unref (rtpvorbispay->packet);
 
   /* new packet allocate max packet size */
-  rtpvorbispay->packet =
-      gst_rtp_buffer_new_allocate_len (GST_RTP_BASE_PAYLOAD_MTU
-      (rtpvorbispay), 0, 0);
+  rtpvorbispay->packet = gst_rtp_vorbis_pay_alloc_packet (rtpvorbispay);
   gst_rtp_vorbis_pay_reset_packet (rtpvorbispay, VDT);
 
   GST_BUFFER_TIMESTAMP (rtpvorbispay->packet) = timestamp;
@@ -496,6 +550,18 @@ gst_rtp_vorbis_pay_finish_headers (GstRTPBasePayload * basepayload)
   rtpvorbispay->headers = NULL;
   rtpvorbispay->need_headers = FALSE;
 
+  /* the same headers are often seen again, in new caps or in-band. When they
+   * give the configuration we already announced, keep the current caps */
+  if (rtpvorbispay->config_data &&
+      rtpvorbispay->config_size == configlen - 4 - 3 - 2 &&
+      !memcmp (rtpvorbispay->config_data, config + 4 + 3 + 2,
+          rtpvorbispay->config_size) &&
+      gst_pad_has_current_caps (GST_RTP_BASE_PAYLOAD_SRCPAD (basepayload))) {
+    GST_DEBUG_OBJECT (rtpvorbispay, "configuration unchanged");
+    g_free (config);
+    return TRUE;
+  }
+
   /* serialize to base64 */
   configuration = g_base64_encode (config, configlen);
 
@@ -30,6 +30,15 @@
 GST_DEBUG_CATEGORY_STATIC (rtpvrawdepay_debug);
 #define GST_CAT_DEFAULT (rtpvrawdepay_debug)
 
+#define DEFAULT_N_THREADS       1
+
+enum
+{
+  PROP_0,
+  PROP_N_THREADS,
+  PROP_LAST
+};
+
 static GstStaticPadTemplate gst_rtp_vraw_depay_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -50,6 +59,21 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 G_DEFINE_TYPE (GstRtpVRawDepay, gst_rtp_vraw_depay,
     GST_TYPE_RTP_BASE_DEPAYLOAD);
 
+static void gst_rtp_vraw_depay_finalize (GObject * object);
+static void gst_rtp_vraw_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_vraw_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static void unpack_copy (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length);
+static void unpack_ayuv (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length);
+static void unpack_i420 (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length);
+static void unpack_y41b (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length);
+
 static gboolean gst_rtp_vraw_depay_setcaps (GstRTPBaseDepayload * depayload,
     GstCaps * caps);
 static GstBuffer *gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload,
@@ -64,12 +88,32 @@ static gboolean gst_rtp_vraw_depay_handle_event (GstRTPBaseDepayload * filter,
 static void
 gst_rtp_vraw_depay_class_init (GstRtpVRawDepayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstRTPBaseDepayloadClass *gstrtpbasedepayload_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasedepayload_class = (GstRTPBaseDepayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_vraw_depay_finalize;
+  gobject_class->set_property = gst_rtp_vraw_depay_set_property;
+  gobject_class->get_property = gst_rtp_vraw_depay_get_property;
+
+  /**
+   * GstRtpVRawDepay:n-threads:
+   *
+   * The number of threads that unpack the pixel data of the RTP packets.
+   * With more than one thread the packets of a frame are kept until the
+   * frame is complete and are then unpacked together.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to unpack the pixel data", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_rtp_vraw_depay_change_state;
 
   gstrtpbasedepayload_class->set_caps = gst_rtp_vraw_depay_setcaps;
@@ -93,6 +137,21 @@ gst_rtp_vraw_depay_class_init (GstRtpVRawDepayClass * klass)
 static void
 gst_rtp_vraw_depay_init (GstRtpVRawDepay * rtpvrawdepay)
 {
+  rtpvrawdepay->n_threads = DEFAULT_N_THREADS;
+  rtpvrawdepay->pending =
+      g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+}
+
+static void
+gst_rtp_vraw_depay_finalize (GObject * object)
+{
+  GstRtpVRawDepay *rtpvrawdepay = GST_RTP_VRAW_DEPAY (object);
+
+  if (rtpvrawdepay->workers)
+    gst_workers_free (rtpvrawdepay->workers);
+  g_ptr_array_free (rtpvrawdepay->pending, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static void
@@ -102,6 +161,7 @@ gst_rtp_vraw_depay_reset (GstRtpVRawDepay * rtpvrawdepay)
     gst_buffer_unref (rtpvrawdepay->outbuf);
     rtpvrawdepay->outbuf = NULL;
   }
+  g_ptr_array_set_size (rtpvrawdepay->pending, 0);
   rtpvrawdepay->timestamp = -1;
   if (rtpvrawdepay->pool) {
     gst_buffer_pool_set_active (rtpvrawdepay->pool, FALSE);
@@ -172,6 +232,7 @@ gst_rtp_vraw_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
   gint clock_rate;
   const gchar *str;
   gint format, width, height, depth, pgroup, xinc, yinc;
+  GstRtpVRawUnpackFunc unpack = unpack_copy;
   GstCaps *srccaps;
   gboolean res;
   GstFlowReturn ret;
@@ -221,6 +282,7 @@ gst_rtp_vraw_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
   } else if (!strcmp (str, "YCbCr-4:4:4")) {
     format = GST_VIDEO_FORMAT_AYUV;
     pgroup = 3;
+    unpack = unpack_ayuv;
   } else if (!strcmp (str, "YCbCr-4:2:2")) {
     if (depth == 8) {
       format = GST_VIDEO_FORMAT_UYVY;
@@ -235,10 +297,12 @@ gst_rtp_vraw_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
     format = GST_VIDEO_FORMAT_I420;
     pgroup = 6;
     xinc = yinc = 2;
+    unpack = unpack_i420;
   } else if (!strcmp (str, "YCbCr-4:1:1")) {
     format = GST_VIDEO_FORMAT_Y41B;
     pgroup = 6;
     xinc = 4;
+    unpack = unpack_y41b;
   } else
     goto unknown_format;
 
@@ -250,6 +314,7 @@ gst_rtp_vraw_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
   rtpvrawdepay->pgroup = pgroup;
   rtpvrawdepay->xinc = xinc;
   rtpvrawdepay->yinc = yinc;
+  rtpvrawdepay->unpack = unpack;
 
   srccaps = gst_video_info_to_caps (&rtpvrawdepay->vinfo);
   res = gst_pad_set_caps (GST_RTP_BASE_DEPAYLOAD_SRCPAD (depayload), srccaps);
@@ -305,68 +370,162 @@ no_bufferpool:
   }
 }
 
-static GstBuffer *
-gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
+/* unpack @length bytes of pixel groups from @payload into line @line starting
+ * at pixel @offs of @frame */
+static void
+unpack_copy (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length)
 {
-  GstRtpVRawDepay *rtpvrawdepay;
-  guint8 *payload, *yp, *up, *vp, *headers;
-  guint32 timestamp;
-  guint cont, ystride, uvstride, pgroup, payload_len;
-  gint width, height, xinc, yinc;
-  GstRTPBuffer rtp = { NULL };
-  GstVideoFrame frame;
-  gboolean marker;
-  GstBuffer *outbuf = NULL;
+  guint8 *datap;
 
-  rtpvrawdepay = GST_RTP_VRAW_DEPAY (depayload);
+  /* samples are packed just like gstreamer packs them */
+  datap = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  datap += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  datap += (offs / depay->xinc) * depay->pgroup;
 
-  gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+  memcpy (datap, payload, length);
+}
 
-  timestamp = gst_rtp_buffer_get_timestamp (&rtp);
+static void
+unpack_ayuv (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length)
+{
+  guint8 *datap;
+  guint i, pixels;
+
+  datap = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  datap += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) + offs * 4;
+  pixels = length / 3;
+
+  /* samples are packed in order Cb-Y-Cr for both interlaced and
+   * progressive frames */
+  for (i = 0; i < pixels; i++) {
+    datap[4 * i + 0] = 0;
+    datap[4 * i + 1] = payload[3 * i + 1];
+    datap[4 * i + 2] = payload[3 * i + 0];
+    datap[4 * i + 3] = payload[3 * i + 2];
+  }
+}
 
-  if (timestamp != rtpvrawdepay->timestamp || rtpvrawdepay->outbuf == NULL) {
-    GstBuffer *outbuf;
-    GstFlowReturn ret;
+static void
+unpack_i420 (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length)
+{
+  guint8 *yd1p, *yd2p, *udp, *vdp;
+  guint i, pgroups, ystride, uvstride;
+
+  ystride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+
+  yd1p = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  yd1p += line * ystride + offs;
+  yd2p = yd1p + ystride;
+  udp = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
+  udp += (line / depay->yinc) * uvstride + offs / depay->xinc;
+  vdp = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
+  vdp += (line / depay->yinc) * uvstride + offs / depay->xinc;
+  pgroups = length / 6;
+
+  /* line 0/1: Y00-Y01-Y10-Y11-Cb00-Cr00 Y02-Y03-Y12-Y13-Cb01-Cr01 ...  */
+  for (i = 0; i < pgroups; i++) {
+    yd1p[2 * i + 0] = payload[6 * i + 0];
+    yd1p[2 * i + 1] = payload[6 * i + 1];
+    yd2p[2 * i + 0] = payload[6 * i + 2];
+    yd2p[2 * i + 1] = payload[6 * i + 3];
+    udp[i] = payload[6 * i + 4];
+    vdp[i] = payload[6 * i + 5];
+  }
+}
 
-    GST_LOG_OBJECT (depayload, "new frame with timestamp %u", timestamp);
-    /* new timestamp, flush old buffer and create new output buffer */
-    if (rtpvrawdepay->outbuf) {
-      gst_rtp_base_depayload_push (depayload, rtpvrawdepay->outbuf);
-      rtpvrawdepay->outbuf = NULL;
-    }
+static void
+unpack_y41b (GstRtpVRawDepay * depay, GstVideoFrame * frame,
+    const guint8 * payload, guint line, guint offs, guint length)
+{
+  guint8 *ydp, *udp, *vdp;
+  guint i, pgroups, uvstride;
+
+  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+
+  ydp = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  ydp += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) + offs;
+  udp = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
+  udp += (line / depay->yinc) * uvstride + offs / depay->xinc;
+  vdp = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
+  vdp += (line / depay->yinc) * uvstride + offs / depay->xinc;
+  pgroups = length / 6;
+
+  /* Samples are packed in order Cb0-Y0-Y1-Cr0-Y2-Y3 for both interlaced
+   * and progressive scan lines */
+  for (i = 0; i < pgroups; i++) {
+    udp[i] = payload[6 * i + 0];
+    ydp[4 * i + 0] = payload[6 * i + 1];
+    ydp[4 * i + 1] = payload[6 * i + 2];
+    vdp[i] = payload[6 * i + 3];
+    ydp[4 * i + 2] = payload[6 * i + 4];
+    ydp[4 * i + 3] = payload[6 * i + 5];
+  }
+}
 
-    if (gst_pad_check_reconfigure (GST_RTP_BASE_DEPAYLOAD_SRCPAD (depayload))) {
-      GstCaps *caps;
+/* check that the headers of the packet are complete and that all lengths
+ * are a multiple of pgroup */
+static gboolean
+gst_rtp_vraw_depay_check_packet (GstRtpVRawDepay * rtpvrawdepay,
+    GstRTPBuffer * rtp)
+{
+  guint8 *payload;
+  guint payload_len, cont;
 
-      caps =
-          gst_pad_get_current_caps (GST_RTP_BASE_DEPAYLOAD_SRCPAD (depayload));
-      gst_rtp_vraw_depay_negotiate_pool (rtpvrawdepay, caps,
-          &rtpvrawdepay->vinfo);
-      gst_caps_unref (caps);
-    }
+  payload = gst_rtp_buffer_get_payload (rtp);
+  payload_len = gst_rtp_buffer_get_payload_len (rtp);
 
-    ret = gst_buffer_pool_acquire_buffer (rtpvrawdepay->pool, &outbuf, NULL);
-    if (G_UNLIKELY (ret != GST_FLOW_OK))
-      goto alloc_failed;
+  if (payload_len < 3)
+    goto short_packet;
 
-    /* clear timestamp from alloc... */
-    GST_BUFFER_TIMESTAMP (outbuf) = -1;
+  /* skip extended seqnum */
+  payload += 2;
+  payload_len -= 2;
 
-    rtpvrawdepay->outbuf = outbuf;
-    rtpvrawdepay->timestamp = timestamp;
-  }
+  do {
+    guint length;
+
+    if (payload_len < 6)
+      goto short_packet;
 
-  if (!gst_video_frame_map (&frame, &rtpvrawdepay->vinfo, rtpvrawdepay->outbuf,
-          GST_MAP_WRITE))
-    goto invalid_frame;
+    length = (payload[0] << 8) | payload[1];
+    cont = payload[4] & 0x80;
+
+    /* length must be a multiple of pgroup */
+    if (length % rtpvrawdepay->pgroup != 0)
+      goto wrong_length;
 
-  /* get pointer and strides of the planes */
-  yp = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
-  up = GST_VIDEO_FRAME_COMP_DATA (&frame, 1);
-  vp = GST_VIDEO_FRAME_COMP_DATA (&frame, 2);
+    payload += 6;
+    payload_len -= 6;
+  } while (cont);
 
-  ystride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
-  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+  return TRUE;
+
+  /* ERRORS */
+wrong_length:
+  {
+    GST_WARNING_OBJECT (rtpvrawdepay, "length not multiple of pgroup");
+    return FALSE;
+  }
+short_packet:
+  {
+    GST_WARNING_OBJECT (rtpvrawdepay, "short packet");
+    return FALSE;
+  }
+}
+
+/* write the pixel data of a packet that passed
+ * gst_rtp_vraw_depay_check_packet() into @frame */
+static void
+gst_rtp_vraw_depay_unpack_packet (GstRtpVRawDepay * rtpvrawdepay,
+    GstVideoFrame * frame, GstRTPBuffer * rtp)
+{
+  guint8 *payload, *headers;
+  guint cont, pgroup, payload_len;
+  gint width, height, xinc, yinc;
 
   pgroup = rtpvrawdepay->pgroup;
   width = GST_VIDEO_INFO_WIDTH (&rtpvrawdepay->vinfo);
@@ -374,11 +533,8 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   xinc = rtpvrawdepay->xinc;
   yinc = rtpvrawdepay->yinc;
 
-  payload = gst_rtp_buffer_get_payload (&rtp);
-  payload_len = gst_rtp_buffer_get_payload_len (&rtp);
-
-  if (payload_len < 3)
-    goto short_packet;
+  payload = gst_rtp_buffer_get_payload (rtp);
+  payload_len = gst_rtp_buffer_get_payload_len (rtp);
 
   /* skip extended seqnum */
   payload += 2;
@@ -389,9 +545,6 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
   /* find data start */
   do {
-    if (payload_len < 6)
-      goto short_packet;
-
     cont = payload[4] & 0x80;
 
     payload += 6;
@@ -400,7 +553,6 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
   while (TRUE) {
     guint length, line, offs, plen;
-    guint8 *datap;
 
     /* stop when we run out of data */
     if (payload_len == 0)
@@ -414,122 +566,34 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
     cont = headers[4] & 0x80;
     headers += 6;
 
-    /* length must be a multiple of pgroup */
-    if (length % pgroup != 0)
-      goto wrong_length;
-
     if (length > payload_len)
       length = payload_len;
 
     /* sanity check */
     if (line > (height - yinc)) {
-      GST_WARNING_OBJECT (depayload, "skipping line %d: out of range", line);
+      GST_WARNING_OBJECT (rtpvrawdepay, "skipping line %d: out of range",
+          line);
       goto next;
     }
     if (offs > (width - xinc)) {
-      GST_WARNING_OBJECT (depayload, "skipping offset %d: out of range", offs);
+      GST_WARNING_OBJECT (rtpvrawdepay, "skipping offset %d: out of range",
+          offs);
       goto next;
     }
 
     /* calculate the maximim amount of bytes we can use per line */
     if (offs + ((length / pgroup) * xinc) > width) {
       plen = ((width - offs) * pgroup) / xinc;
-      GST_WARNING_OBJECT (depayload, "clipping length %d, offset %d, plen %d",
-          length, offs, plen);
+      GST_WARNING_OBJECT (rtpvrawdepay,
+          "clipping length %d, offset %d, plen %d", length, offs, plen);
     } else
       plen = length;
 
-    GST_LOG_OBJECT (depayload,
+    GST_LOG_OBJECT (rtpvrawdepay,
         "writing length %u/%u, line %u, offset %u, remaining %u", plen, length,
         line, offs, payload_len);
 
-    switch (GST_VIDEO_INFO_FORMAT (&rtpvrawdepay->vinfo)) {
-      case GST_VIDEO_FORMAT_RGB:
-      case GST_VIDEO_FORMAT_RGBA:
-      case GST_VIDEO_FORMAT_BGR:
-      case GST_VIDEO_FORMAT_BGRA:
-      case GST_VIDEO_FORMAT_UYVY:
-      case GST_VIDEO_FORMAT_UYVP:
-        /* samples are packed just like gstreamer packs them */
-        offs /= xinc;
-        datap = yp + (line * ystride) + (offs * pgroup);
-
-        memcpy (datap, payload, plen);
-        break;
-      case GST_VIDEO_FORMAT_AYUV:
-      {
-        gint i;
-        guint8 *p;
-
-        datap = yp + (line * ystride) + (offs * 4);
-        p = payload;
-
-        /* samples are packed in order Cb-Y-Cr for both interlaced and
-         * progressive frames */
-        for (i = 0; i < plen; i += pgroup) {
-          *datap++ = 0;
-          *datap++ = p[1];
-          *datap++ = p[0];
-          *datap++ = p[2];
-          p += pgroup;
-        }
-        break;
-      }
-      case GST_VIDEO_FORMAT_I420:
-      {
-        gint i;
-        guint uvoff;
-        guint8 *yd1p, *yd2p, *udp, *vdp, *p;
-
-        yd1p = yp + (line * ystride) + (offs);
-        yd2p = yd1p + ystride;
-        uvoff = (line / yinc * uvstride) + (offs / xinc);
-
-        udp = up + uvoff;
-        vdp = vp + uvoff;
-        p = payload;
-
-        /* line 0/1: Y00-Y01-Y10-Y11-Cb00-Cr00 Y02-Y03-Y12-Y13-Cb01-Cr01 ...  */
-        for (i = 0; i < plen; i += pgroup) {
-          *yd1p++ = p[0];
-          *yd1p++ = p[1];
-          *yd2p++ = p[2];
-          *yd2p++ = p[3];
-          *udp++ = p[4];
-          *vdp++ = p[5];
-          p += pgroup;
-        }
-        break;
-      }
-      case GST_VIDEO_FORMAT_Y41B:
-      {
-        gint i;
-        guint uvoff;
-        guint8 *ydp, *udp, *vdp, *p;
-
-        ydp = yp + (line * ystride) + (offs);
-        uvoff = (line / yinc * uvstride) + (offs / xinc);
-
-        udp = up + uvoff;
-        vdp = vp + uvoff;
-        p = payload;
-
-        /* Samples are packed in order Cb0-Y0-Y1-Cr0-Y2-Y3 for both interlaced
-         * and progressive scan lines */
-        for (i = 0; i < plen; i += pgroup) {
-          *udp++ = p[0];
-          *ydp++ = p[1];
-          *ydp++ = p[2];
-          *vdp++ = p[3];
-          *ydp++ = p[4];
-          *ydp++ = p[5];
-          p += pgroup;
-        }
-        break;
-      }
-      default:
-        goto unknown_sampling;
-    }
+    rtpvrawdepay->unpack (rtpvrawdepay, frame, payload, line, offs, plen);
 
   next:
     if (!cont)
@@ -538,13 +602,145 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
     payload += length;
     payload_len -= length;
   }
+}
+
+typedef struct
+{
+  GstRtpVRawDepay *rtpvrawdepay;
+  GstVideoFrame *frame;
+} UnpackData;
+
+/* every worker unpacks a consecutive range of the pending packets */
+static void
+unpack_slice (UnpackData * data, guint slice, guint n_slices)
+{
+  GPtrArray *pending = data->rtpvrawdepay->pending;
+  GstRTPBuffer rtp = { NULL };
+  guint i, start, end;
+
+  start = pending->len * slice / n_slices;
+  end = pending->len * (slice + 1) / n_slices;
+
+  for (i = start; i < end; i++) {
+    gst_rtp_buffer_map (g_ptr_array_index (pending, i), GST_MAP_READ, &rtp);
+    gst_rtp_vraw_depay_unpack_packet (data->rtpvrawdepay, data->frame, &rtp);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+}
+
+/* unpack the packets that were queued for the current frame */
+static void
+gst_rtp_vraw_depay_unpack_pending (GstRtpVRawDepay * rtpvrawdepay)
+{
+  GstVideoFrame frame;
+  UnpackData data;
+
+  if (rtpvrawdepay->pending->len == 0)
+    return;
+
+  if (gst_video_frame_map (&frame, &rtpvrawdepay->vinfo, rtpvrawdepay->outbuf,
+          GST_MAP_WRITE)) {
+    GST_LOG_OBJECT (rtpvrawdepay, "unpacking %u packets",
+        rtpvrawdepay->pending->len);
+
+    data.rtpvrawdepay = rtpvrawdepay;
+    data.frame = &frame;
+    gst_workers_run (rtpvrawdepay->workers, (GstWorkFunc) unpack_slice, &data);
+
+    gst_video_frame_unmap (&frame);
+  } else {
+    GST_ERROR_OBJECT (rtpvrawdepay, "could not map video frame");
+  }
+
+  g_ptr_array_set_size (rtpvrawdepay->pending, 0);
+}
+
+static GstBuffer *
+gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
+{
+  GstRtpVRawDepay *rtpvrawdepay;
+  guint32 timestamp;
+  guint n_threads;
+  GstRTPBuffer rtp = { NULL };
+  GstVideoFrame frame;
+  gboolean marker;
+  GstBuffer *outbuf = NULL;
+
+  rtpvrawdepay = GST_RTP_VRAW_DEPAY (depayload);
+
+  gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+
+  timestamp = gst_rtp_buffer_get_timestamp (&rtp);
+
+  if (timestamp != rtpvrawdepay->timestamp || rtpvrawdepay->outbuf == NULL) {
+    GstBuffer *outbuf;
+    GstFlowReturn ret;
+
+    GST_LOG_OBJECT (depayload, "new frame with timestamp %u", timestamp);
+    /* new timestamp, flush old buffer and create new output buffer */
+    if (rtpvrawdepay->outbuf) {
+      gst_rtp_vraw_depay_unpack_pending (rtpvrawdepay);
+      gst_rtp_base_depayload_push (depayload, rtpvrawdepay->outbuf);
+      rtpvrawdepay->outbuf = NULL;
+    }
+
+    if (gst_pad_check_reconfigure (GST_RTP_BASE_DEPAYLOAD_SRCPAD (depayload))) {
+      GstCaps *caps;
+
+      caps =
+          gst_pad_get_current_caps (GST_RTP_BASE_DEPAYLOAD_SRCPAD (depayload));
+      gst_rtp_vraw_depay_negotiate_pool (rtpvrawdepay, caps,
+          &rtpvrawdepay->vinfo);
+      gst_caps_unref (caps);
+    }
+
+    ret = gst_buffer_pool_acquire_buffer (rtpvrawdepay->pool, &outbuf, NULL);
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      goto alloc_failed;
+
+    /* clear timestamp from alloc... */
+    GST_BUFFER_TIMESTAMP (outbuf) = -1;
+
+    rtpvrawdepay->outbuf = outbuf;
+    rtpvrawdepay->timestamp = timestamp;
+
+    /* the number of threads only changes between frames */
+    GST_OBJECT_LOCK (rtpvrawdepay);
+    n_threads = rtpvrawdepay->n_threads;
+    GST_OBJECT_UNLOCK (rtpvrawdepay);
+
+    if (rtpvrawdepay->workers &&
+        gst_workers_get_n_threads (rtpvrawdepay->workers) != n_threads) {
+      gst_workers_free (rtpvrawdepay->workers);
+      rtpvrawdepay->workers = NULL;
+    }
+    if (rtpvrawdepay->workers == NULL && n_threads > 1)
+      rtpvrawdepay->workers = gst_workers_new (n_threads);
+  }
+
+  if (!gst_rtp_vraw_depay_check_packet (rtpvrawdepay, &rtp))
+    goto invalid_packet;
+
+  if (rtpvrawdepay->workers) {
+    /* keep the packet, the whole frame is unpacked by the workers at once */
+    g_ptr_array_add (rtpvrawdepay->pending, gst_buffer_ref (buf));
+  } else {
+    if (!gst_video_frame_map (&frame, &rtpvrawdepay->vinfo,
+            rtpvrawdepay->outbuf, GST_MAP_WRITE))
+      goto invalid_frame;
+
+    gst_rtp_vraw_depay_unpack_packet (rtpvrawdepay, &frame, &rtp);
+
+    gst_video_frame_unmap (&frame);
+  }
 
-  gst_video_frame_unmap (&frame);
   marker = gst_rtp_buffer_get_marker (&rtp);
   gst_rtp_buffer_unmap (&rtp);
 
   if (marker) {
     GST_LOG_OBJECT (depayload, "marker, flushing frame");
+    if (rtpvrawdepay->workers)
+      gst_rtp_vraw_depay_unpack_pending (rtpvrawdepay);
     outbuf = rtpvrawdepay->outbuf;
     rtpvrawdepay->outbuf = NULL;
     rtpvrawdepay->timestamp = -1;
@@ -552,14 +748,6 @@ gst_rtp_vraw_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   return outbuf;
 
   /* ERRORS */
-unknown_sampling:
-  {
-    GST_ELEMENT_ERROR (depayload, STREAM, FORMAT,
-        (NULL), ("unimplemented sampling"));
-    gst_video_frame_unmap (&frame);
-    gst_rtp_buffer_unmap (&rtp);
-    return NULL;
-  }
 alloc_failed:
   {
     GST_WARNING_OBJECT (depayload, "failed to alloc output buffer");
@@ -572,17 +760,8 @@ invalid_frame:
     gst_rtp_buffer_unmap (&rtp);
     return NULL;
   }
-wrong_length:
-  {
-    GST_WARNING_OBJECT (depayload, "length not multiple of pgroup");
-    gst_video_frame_unmap (&frame);
-    gst_rtp_buffer_unmap (&rtp);
-    return NULL;
-  }
-short_packet:
+invalid_packet:
   {
-    GST_WARNING_OBJECT (depayload, "short packet");
-    gst_video_frame_unmap (&frame);
     gst_rtp_buffer_unmap (&rtp);
     return NULL;
   }
@@ -643,6 +822,42 @@ gst_rtp_vraw_depay_change_state (GstElement * element,
   return ret;
 }
 
+static void
+gst_rtp_vraw_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpVRawDepay *rtpvrawdepay = GST_RTP_VRAW_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (rtpvrawdepay);
+      rtpvrawdepay->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rtpvrawdepay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_vraw_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpVRawDepay *rtpvrawdepay = GST_RTP_VRAW_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (rtpvrawdepay);
+      g_value_set_uint (value, rtpvrawdepay->n_threads);
+      GST_OBJECT_UNLOCK (rtpvrawdepay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 gboolean
 gst_rtp_vraw_depay_plugin_init (GstPlugin * plugin)
 {
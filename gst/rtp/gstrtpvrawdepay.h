@@ -26,6 +26,8 @@
 #include <gst/video/gstvideopool.h>
 #include <gst/rtp/gstrtpbasedepayload.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_RTP_VRAW_DEPAY \
@@ -42,6 +44,10 @@ G_BEGIN_DECLS
 typedef struct _GstRtpVRawDepay GstRtpVRawDepay;
 typedef struct _GstRtpVRawDepayClass GstRtpVRawDepayClass;
 
+typedef void (*GstRtpVRawUnpackFunc) (GstRtpVRawDepay *depay,
+    GstVideoFrame *frame, const guint8 *payload, guint line, guint offs,
+    guint length);
+
 struct _GstRtpVRawDepay
 {
   GstRTPBaseDepayload payload;
@@ -55,6 +61,14 @@ struct _GstRtpVRawDepay
 
   gint pgroup;
   gint xinc, yinc;
+  GstRtpVRawUnpackFunc unpack;
+
+  /* properties */
+  guint n_threads;
+
+  /* packets of the current frame, with more than one thread */
+  GstWorkers *workers;
+  GPtrArray *pending;
 };
 
 struct _GstRtpVRawDepayClass
@@ -30,6 +30,15 @@
 GST_DEBUG_CATEGORY_STATIC (rtpvrawpay_debug);
 #define GST_CAT_DEFAULT (rtpvrawpay_debug)
 
+#define DEFAULT_N_THREADS       1
+
+enum
+{
+  PROP_0,
+  PROP_N_THREADS,
+  PROP_LAST
+};
+
 static GstStaticPadTemplate gst_rtp_vraw_pay_sink_template =
     GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -66,21 +75,48 @@ GST_STATIC_PAD_TEMPLATE ("src",
     )
     );
 
+static void gst_rtp_vraw_pay_finalize (GObject * object);
+static void gst_rtp_vraw_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_vraw_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
 static gboolean gst_rtp_vraw_pay_setcaps (GstRTPBasePayload * payload,
     GstCaps * caps);
 static GstFlowReturn gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload *
     payload, GstBuffer * buffer);
 
-G_DEFINE_TYPE (GstRtpVRawPay, gst_rtp_vraw_pay, GST_TYPE_RTP_BASE_PAYLOAD)
+#define gst_rtp_vraw_pay_parent_class parent_class
+G_DEFINE_TYPE (GstRtpVRawPay, gst_rtp_vraw_pay, GST_TYPE_RTP_BASE_PAYLOAD);
 
-     static void gst_rtp_vraw_pay_class_init (GstRtpVRawPayClass * klass)
+static void
+gst_rtp_vraw_pay_class_init (GstRtpVRawPayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstRTPBasePayloadClass *gstrtpbasepayload_class;
   GstElementClass *gstelement_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasepayload_class = (GstRTPBasePayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_vraw_pay_finalize;
+  gobject_class->set_property = gst_rtp_vraw_pay_set_property;
+  gobject_class->get_property = gst_rtp_vraw_pay_get_property;
+
+  /**
+   * GstRtpVRawPay:n-threads:
+   *
+   * The number of threads that pack the pixel data of a frame into the RTP
+   * packets. Every thread handles a consecutive range of the packets.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to pack the pixel data", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstrtpbasepayload_class->set_caps = gst_rtp_vraw_pay_setcaps;
   gstrtpbasepayload_class->handle_buffer = gst_rtp_vraw_pay_handle_buffer;
 
@@ -101,14 +137,36 @@ G_DEFINE_TYPE (GstRtpVRawPay, gst_rtp_vraw_pay, GST_TYPE_RTP_BASE_PAYLOAD)
 static void
 gst_rtp_vraw_pay_init (GstRtpVRawPay * rtpvrawpay)
 {
+  rtpvrawpay->n_threads = DEFAULT_N_THREADS;
+}
+
+static void
+gst_rtp_vraw_pay_finalize (GObject * object)
+{
+  GstRtpVRawPay *rtpvrawpay = GST_RTP_VRAW_PAY (object);
+
+  if (rtpvrawpay->workers)
+    gst_workers_free (rtpvrawpay->workers);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void pack_copy (GstRtpVRawPay * pay, GstVideoFrame * frame,
+    guint8 * outdata, guint line, guint offs, guint length);
+static void pack_ayuv (GstRtpVRawPay * pay, GstVideoFrame * frame,
+    guint8 * outdata, guint line, guint offs, guint length);
+static void pack_i420 (GstRtpVRawPay * pay, GstVideoFrame * frame,
+    guint8 * outdata, guint line, guint offs, guint length);
+static void pack_y41b (GstRtpVRawPay * pay, GstVideoFrame * frame,
+    guint8 * outdata, guint line, guint offs, guint length);
+
 static gboolean
 gst_rtp_vraw_pay_setcaps (GstRTPBasePayload * payload, GstCaps * caps)
 {
   GstRtpVRawPay *rtpvrawpay;
   gboolean res;
   gint pgroup, xinc, yinc;
+  GstRtpVRawPackFunc pack = pack_copy;
   const gchar *depthstr, *samplingstr, *colorimetrystr;
   gchar *wstr, *hstr;
   gint depth;
@@ -160,6 +218,7 @@ gst_rtp_vraw_pay_setcaps (GstRTPBasePayload * payload, GstCaps * caps)
     case GST_VIDEO_FORMAT_AYUV:
       samplingstr = "YCbCr-4:4:4";
       pgroup = 3;
+      pack = pack_ayuv;
       break;
     case GST_VIDEO_FORMAT_UYVY:
       samplingstr = "YCbCr-4:2:2";
@@ -170,11 +229,13 @@ gst_rtp_vraw_pay_setcaps (GstRTPBasePayload * payload, GstCaps * caps)
       samplingstr = "YCbCr-4:1:1";
       pgroup = 6;
       xinc = 4;
+      pack = pack_y41b;
       break;
     case GST_VIDEO_FORMAT_I420:
       samplingstr = "YCbCr-4:2:0";
       pgroup = 6;
       xinc = yinc = 2;
+      pack = pack_i420;
       break;
     case GST_VIDEO_FORMAT_UYVP:
       samplingstr = "YCbCr-4:2:2";
@@ -196,6 +257,7 @@ gst_rtp_vraw_pay_setcaps (GstRTPBasePayload * payload, GstCaps * caps)
   rtpvrawpay->xinc = xinc;
   rtpvrawpay->yinc = yinc;
   rtpvrawpay->depth = depth;
+  rtpvrawpay->pack = pack;
 
   GST_DEBUG_OBJECT (payload, "width %d, height %d, sampling %s",
       GST_VIDEO_INFO_WIDTH (&info), GST_VIDEO_INFO_HEIGHT (&info), samplingstr);
@@ -234,20 +296,179 @@ unknown_format:
   }
 }
 
+/* pack @length bytes of pixel groups of line @line starting at pixel @offs
+ * into @outdata. The layouts of the RTP pixel groups are in RFC 4175
+ * section 4.3 */
+static void
+pack_copy (GstRtpVRawPay * pay, GstVideoFrame * frame, guint8 * outdata,
+    guint line, guint offs, guint length)
+{
+  guint8 *yp;
+
+  /* samples are packed just like gstreamer packs them */
+  yp = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  yp += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  yp += (offs / pay->xinc) * pay->pgroup;
+
+  memcpy (outdata, yp, length);
+}
+
+static void
+pack_ayuv (GstRtpVRawPay * pay, GstVideoFrame * frame, guint8 * outdata,
+    guint line, guint offs, guint length)
+{
+  const guint8 *datap;
+  guint i, pixels;
+
+  datap = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  datap += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) + offs * 4;
+  pixels = length / 3;
+
+  /* Cb-Y-Cr from A-Y-U-V */
+  for (i = 0; i < pixels; i++) {
+    outdata[3 * i + 0] = datap[4 * i + 2];
+    outdata[3 * i + 1] = datap[4 * i + 1];
+    outdata[3 * i + 2] = datap[4 * i + 3];
+  }
+}
+
+static void
+pack_i420 (GstRtpVRawPay * pay, GstVideoFrame * frame, guint8 * outdata,
+    guint line, guint offs, guint length)
+{
+  const guint8 *yd1p, *yd2p, *udp, *vdp;
+  guint i, pgroups, ystride, uvstride;
+
+  ystride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+
+  yd1p = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  yd1p += line * ystride + offs;
+  yd2p = yd1p + ystride;
+  udp = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
+  udp += (line / pay->yinc) * uvstride + offs / pay->xinc;
+  vdp = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
+  vdp += (line / pay->yinc) * uvstride + offs / pay->xinc;
+  pgroups = length / 6;
+
+  /* line 0/1: Y00-Y01-Y10-Y11-Cb00-Cr00 Y02-Y03-Y12-Y13-Cb01-Cr01 ...  */
+  for (i = 0; i < pgroups; i++) {
+    outdata[6 * i + 0] = yd1p[2 * i + 0];
+    outdata[6 * i + 1] = yd1p[2 * i + 1];
+    outdata[6 * i + 2] = yd2p[2 * i + 0];
+    outdata[6 * i + 3] = yd2p[2 * i + 1];
+    outdata[6 * i + 4] = udp[i];
+    outdata[6 * i + 5] = vdp[i];
+  }
+}
+
+static void
+pack_y41b (GstRtpVRawPay * pay, GstVideoFrame * frame, guint8 * outdata,
+    guint line, guint offs, guint length)
+{
+  const guint8 *ydp, *udp, *vdp;
+  guint i, pgroups, uvstride;
+
+  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+
+  ydp = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  ydp += line * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) + offs;
+  udp = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
+  udp += (line / pay->yinc) * uvstride + offs / pay->xinc;
+  vdp = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
+  vdp += (line / pay->yinc) * uvstride + offs / pay->xinc;
+  pgroups = length / 6;
+
+  /* Cb0-Y0-Y1-Cr0-Y2-Y3 */
+  for (i = 0; i < pgroups; i++) {
+    outdata[6 * i + 0] = udp[i];
+    outdata[6 * i + 1] = ydp[4 * i + 0];
+    outdata[6 * i + 2] = ydp[4 * i + 1];
+    outdata[6 * i + 3] = vdp[i];
+    outdata[6 * i + 4] = ydp[4 * i + 2];
+    outdata[6 * i + 5] = ydp[4 * i + 3];
+  }
+}
+
+/* write the pixel data of the packet @out after its headers */
+static void
+gst_rtp_vraw_pay_pack_packet (GstRtpVRawPay * rtpvrawpay,
+    GstVideoFrame * frame, GstBuffer * out)
+{
+  GstRTPBuffer rtp = { NULL, };
+  guint8 *outdata, *headers;
+  guint cont;
+
+  gst_rtp_buffer_map (out, GST_MAP_WRITE, &rtp);
+
+  /* skip the extended sequence number and find the data start */
+  headers = outdata = (guint8 *) gst_rtp_buffer_get_payload (&rtp) + 2;
+  do {
+    cont = outdata[4] & 0x80;
+    outdata += 6;
+  } while (cont);
+
+  while (TRUE) {
+    guint length, lin, offs;
+
+    /* read length and cont */
+    length = (headers[0] << 8) | headers[1];
+    lin = ((headers[2] & 0x7f) << 8) | headers[3];
+    offs = ((headers[4] & 0x7f) << 8) | headers[5];
+    cont = headers[4] & 0x80;
+    headers += 6;
+
+    GST_LOG_OBJECT (rtpvrawpay,
+        "writing length %u, line %u, offset %u, cont %d", length, lin, offs,
+        cont);
+
+    rtpvrawpay->pack (rtpvrawpay, frame, outdata, lin, offs, length);
+    outdata += length;
+
+    if (!cont)
+      break;
+  }
+
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+typedef struct
+{
+  GstRtpVRawPay *rtpvrawpay;
+  GstVideoFrame *frame;
+  GstBufferList *list;
+} PackData;
+
+/* every worker packs a consecutive range of the packets */
+static void
+pack_slice (PackData * data, guint slice, guint n_slices)
+{
+  guint i, len, start, end;
+
+  len = gst_buffer_list_length (data->list);
+  start = len * slice / n_slices;
+  end = len * (slice + 1) / n_slices;
+
+  for (i = start; i < end; i++)
+    gst_rtp_vraw_pay_pack_packet (data->rtpvrawpay, data->frame,
+        gst_buffer_list_get (data->list, i));
+}
+
 static GstFlowReturn
 gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
 {
   GstRtpVRawPay *rtpvrawpay;
   GstFlowReturn ret = GST_FLOW_OK;
   guint line, offset;
-  guint8 *yp, *up, *vp;
-  guint ystride, uvstride;
   guint pgroup;
   guint mtu;
   guint width, height;
   gint field;
   GstVideoFrame frame;
   gint interlaced;
+  guint n_threads;
+  GstBufferList *list;
+  PackData data;
   GstRTPBuffer rtp = { NULL, };
 
   rtpvrawpay = GST_RTP_VRAW_PAY (payload);
@@ -257,14 +478,6 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
   GST_LOG_OBJECT (rtpvrawpay, "new frame of %" G_GSIZE_FORMAT " bytes",
       gst_buffer_get_size (buffer));
 
-  /* get pointer and strides of the planes */
-  yp = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
-  up = GST_VIDEO_FRAME_COMP_DATA (&frame, 1);
-  vp = GST_VIDEO_FRAME_COMP_DATA (&frame, 2);
-
-  ystride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
-  uvstride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
-
   mtu = GST_RTP_BASE_PAYLOAD_MTU (payload);
 
   /* amount of bytes for one pixel */
@@ -274,7 +487,11 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
 
   interlaced = GST_VIDEO_INFO_IS_INTERLACED (&rtpvrawpay->vinfo);
 
-  /* start with line 0, offset 0 */
+  list = gst_buffer_list_new ();
+
+  /* first pass, make all packets of the frame and write their headers. The
+   * headers define which part of the frame goes in which packet so the data
+   * can be packed in any order after this. */
   for (field = 0; field < 1 + interlaced; field++) {
     line = field;
     offset = 0;
@@ -388,103 +605,6 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
       GST_LOG_OBJECT (rtpvrawpay, "consumed %u bytes",
           (guint) (outdata - headers));
 
-      /* second pass, read headers and write the data */
-      while (TRUE) {
-        guint offs, lin;
-
-        /* read length and cont */
-        length = (headers[0] << 8) | headers[1];
-        lin = ((headers[2] & 0x7f) << 8) | headers[3];
-        offs = ((headers[4] & 0x7f) << 8) | headers[5];
-        cont = headers[4] & 0x80;
-        pixels = length / pgroup;
-        headers += 6;
-
-        GST_LOG_OBJECT (payload,
-            "writing length %u, line %u, offset %u, cont %d", length, lin, offs,
-            cont);
-
-        switch (GST_VIDEO_INFO_FORMAT (&rtpvrawpay->vinfo)) {
-          case GST_VIDEO_FORMAT_RGB:
-          case GST_VIDEO_FORMAT_RGBA:
-          case GST_VIDEO_FORMAT_BGR:
-          case GST_VIDEO_FORMAT_BGRA:
-          case GST_VIDEO_FORMAT_UYVY:
-          case GST_VIDEO_FORMAT_UYVP:
-            offs /= rtpvrawpay->xinc;
-            memcpy (outdata, yp + (lin * ystride) + (offs * pgroup), length);
-            outdata += length;
-            break;
-          case GST_VIDEO_FORMAT_AYUV:
-          {
-            gint i;
-            guint8 *datap;
-
-            datap = yp + (lin * ystride) + (offs * 4);
-
-            for (i = 0; i < pixels; i++) {
-              *outdata++ = datap[2];
-              *outdata++ = datap[1];
-              *outdata++ = datap[3];
-              datap += 4;
-            }
-            break;
-          }
-          case GST_VIDEO_FORMAT_I420:
-          {
-            gint i;
-            guint uvoff;
-            guint8 *yd1p, *yd2p, *udp, *vdp;
-
-            yd1p = yp + (lin * ystride) + (offs);
-            yd2p = yd1p + ystride;
-            uvoff =
-                (lin / rtpvrawpay->yinc * uvstride) + (offs / rtpvrawpay->xinc);
-            udp = up + uvoff;
-            vdp = vp + uvoff;
-
-            for (i = 0; i < pixels; i++) {
-              *outdata++ = *yd1p++;
-              *outdata++ = *yd1p++;
-              *outdata++ = *yd2p++;
-              *outdata++ = *yd2p++;
-              *outdata++ = *udp++;
-              *outdata++ = *vdp++;
-            }
-            break;
-          }
-          case GST_VIDEO_FORMAT_Y41B:
-          {
-            gint i;
-            guint uvoff;
-            guint8 *ydp, *udp, *vdp;
-
-            ydp = yp + (lin * ystride) + offs;
-            uvoff =
-                (lin / rtpvrawpay->yinc * uvstride) + (offs / rtpvrawpay->xinc);
-            udp = up + uvoff;
-            vdp = vp + uvoff;
-
-            for (i = 0; i < pixels; i++) {
-              *outdata++ = *udp++;
-              *outdata++ = *ydp++;
-              *outdata++ = *ydp++;
-              *outdata++ = *vdp++;
-              *outdata++ = *ydp++;
-              *outdata++ = *ydp++;
-            }
-            break;
-          }
-          default:
-            gst_rtp_buffer_unmap (&rtp);
-            gst_buffer_unref (out);
-            goto unknown_sampling;
-        }
-
-        if (!cont)
-          break;
-      }
-
       if (line >= height) {
         GST_LOG_OBJECT (rtpvrawpay, "field/frame complete, set marker");
         gst_rtp_buffer_set_marker (&rtp, TRUE);
@@ -495,25 +615,73 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
         gst_buffer_resize (out, 0, gst_buffer_get_size (out) - left);
       }
 
-      /* push buffer */
-      ret = gst_rtp_base_payload_push (payload, out);
+      gst_buffer_list_add (list, out);
     }
+  }
+
+  GST_OBJECT_LOCK (rtpvrawpay);
+  n_threads = rtpvrawpay->n_threads;
+  GST_OBJECT_UNLOCK (rtpvrawpay);
 
+  if (rtpvrawpay->workers &&
+      gst_workers_get_n_threads (rtpvrawpay->workers) != n_threads) {
+    gst_workers_free (rtpvrawpay->workers);
+    rtpvrawpay->workers = NULL;
   }
+  if (rtpvrawpay->workers == NULL && n_threads > 1)
+    rtpvrawpay->workers = gst_workers_new (n_threads);
+
+  /* second pass, read the headers and write the data */
+  data.rtpvrawpay = rtpvrawpay;
+  data.frame = &frame;
+  data.list = list;
+  if (rtpvrawpay->workers)
+    gst_workers_run (rtpvrawpay->workers, (GstWorkFunc) pack_slice, &data);
+  else
+    pack_slice (&data, 0, 1);
 
   gst_video_frame_unmap (&frame);
   gst_buffer_unref (buffer);
 
+  /* push buffers */
+  ret = gst_rtp_base_payload_push_list (payload, list);
+
   return ret;
+}
 
-  /* ERRORS */
-unknown_sampling:
-  {
-    GST_ELEMENT_ERROR (payload, STREAM, FORMAT,
-        (NULL), ("unimplemented sampling"));
-    gst_video_frame_unmap (&frame);
-    gst_buffer_unref (buffer);
-    return GST_FLOW_NOT_SUPPORTED;
+static void
+gst_rtp_vraw_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpVRawPay *rtpvrawpay = GST_RTP_VRAW_PAY (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (rtpvrawpay);
+      rtpvrawpay->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rtpvrawpay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_vraw_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpVRawPay *rtpvrawpay = GST_RTP_VRAW_PAY (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (rtpvrawpay);
+      g_value_set_uint (value, rtpvrawpay->n_threads);
+      GST_OBJECT_UNLOCK (rtpvrawpay);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
   }
 }
 
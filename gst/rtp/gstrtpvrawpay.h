@@ -24,6 +24,8 @@
 #include <gst/video/video.h>
 #include <gst/rtp/gstrtpbasepayload.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_RTP_VRAW_PAY \
@@ -40,6 +42,9 @@ G_BEGIN_DECLS
 typedef struct _GstRtpVRawPay GstRtpVRawPay;
 typedef struct _GstRtpVRawPayClass GstRtpVRawPayClass;
 
+typedef void (*GstRtpVRawPackFunc) (GstRtpVRawPay *pay, GstVideoFrame *frame,
+    guint8 *outdata, guint line, guint offs, guint length);
+
 struct _GstRtpVRawPay
 {
   GstRTPBasePayload payload;
@@ -53,6 +58,12 @@ struct _GstRtpVRawPay
 //   gint uvstride;
 //   gboolean interlaced;
   gint depth;
+  GstRtpVRawPackFunc pack;
+
+  /* properties */
+  guint n_threads;
+
+  GstWorkers *workers;
 };
 
 struct _GstRtpVRawPayClass
@@ -236,10 +236,14 @@ struct _GstRtpBinPrivate
   gint shutdown;
 
   gboolean autoremove;
+  gboolean shared_rtcp_thread;
 
   /* UNIX (ntp) time of last SR sync used */
   guint64 last_unix;
 
+  /* the clients indexed by their CNAME */
+  GHashTable *client_table;
+
   /* list of extra elements */
   GList *elements;
 };
@@ -290,6 +294,7 @@ enum
 #define DEFAULT_RTCP_SYNC_INTERVAL   0
 #define DEFAULT_DO_SYNC_EVENT        FALSE
 #define DEFAULT_DO_RETRANSMISSION    FALSE
+#define DEFAULT_SHARED_RTCP_THREAD   FALSE
 
 enum
 {
@@ -307,6 +312,7 @@ enum
   PROP_USE_PIPELINE_CLOCK,
   PROP_DO_SYNC_EVENT,
   PROP_DO_RETRANSMISSION,
+  PROP_SHARED_RTCP_THREAD,
   PROP_LAST
 };
 
@@ -392,6 +398,11 @@ struct _GstRtpBinStream
   gint64 rtp_delta;
   /* base rtptime in gst time */
   gint64 clock_base;
+
+  /* the client this stream is associated with, if any */
+  GstRtpBinClient *client;
+  /* the ts-offset last configured on the jitterbuffer */
+  gint64 ts_offset;
 };
 
 #define GST_RTP_SESSION_LOCK(sess)   g_mutex_lock (&(sess)->lock)
@@ -631,7 +642,8 @@ create_session (GstRtpBin * rtpbin, gint id)
   /* configure SDES items */
   GST_OBJECT_LOCK (rtpbin);
   g_object_set (session, "sdes", rtpbin->sdes, "use-pipeline-clock",
-      rtpbin->use_pipeline_clock, NULL);
+      rtpbin->use_pipeline_clock, "shared-rtcp-thread",
+      rtpbin->priv->shared_rtcp_thread, NULL);
   GST_OBJECT_UNLOCK (rtpbin);
 
   /* provide clock_rate to the session manager when needed */
@@ -960,32 +972,29 @@ gst_rtp_bin_propagate_property_to_jitterbuffer (GstRtpBin * bin,
 static GstRtpBinClient *
 get_client (GstRtpBin * bin, guint8 len, guint8 * data, gboolean * created)
 {
-  GstRtpBinClient *result = NULL;
-  GSList *walk;
+  GstRtpBinClient *result;
+  gchar cname[256];
 
-  for (walk = bin->clients; walk; walk = g_slist_next (walk)) {
-    GstRtpBinClient *client = (GstRtpBinClient *) walk->data;
+  /* the SDES item is not terminated, look it up with a terminated copy */
+  memcpy (cname, data, len);
+  cname[len] = '\0';
 
-    if (len != client->cname_len)
-      continue;
-
-    if (!strncmp ((gchar *) data, client->cname, client->cname_len)) {
-      GST_DEBUG_OBJECT (bin, "found existing client %p with CNAME %s", client,
-          client->cname);
-      result = client;
-      break;
-    }
+  result = g_hash_table_lookup (bin->priv->client_table, cname);
+  if (result) {
+    GST_DEBUG_OBJECT (bin, "found existing client %p with CNAME %s", result,
+        result->cname);
+    return result;
   }
 
   /* nothing found, create one */
-  if (result == NULL) {
-    result = g_new0 (GstRtpBinClient, 1);
-    result->cname = g_strndup ((gchar *) data, len);
-    result->cname_len = len;
-    bin->clients = g_slist_prepend (bin->clients, result);
-    GST_DEBUG_OBJECT (bin, "created new client %p with CNAME %s", result,
-        result->cname);
-  }
+  result = g_new0 (GstRtpBinClient, 1);
+  result->cname = g_strndup ((gchar *) data, len);
+  result->cname_len = len;
+  bin->clients = g_slist_prepend (bin->clients, result);
+  g_hash_table_insert (bin->priv->client_table, result->cname, result);
+  GST_DEBUG_OBJECT (bin, "created new client %p with CNAME %s", result,
+      result->cname);
+
   return result;
 }
 
@@ -993,6 +1002,7 @@ static void
 free_client (GstRtpBinClient * client, GstRtpBin * bin)
 {
   GST_DEBUG_OBJECT (bin, "freeing client %p", client);
+  g_hash_table_remove (bin->priv->client_table, client->cname);
   g_slist_free (client->streams);
   g_free (client->cname);
   g_free (client);
@@ -1042,13 +1052,34 @@ get_current_times (GstRtpBin * bin, GstClockTime * running_time,
     *ntpnstime = ntpns;
 }
 
+/* remove @stream from the client it is associated with, the client is freed
+ * with its last stream. Must be called with GST_RTP_BIN_LOCK */
+static void
+stream_remove_from_client (GstRtpBin * bin, GstRtpBinStream * stream)
+{
+  GstRtpBinClient *client = stream->client;
+
+  if (client == NULL)
+    return;
+
+  stream->client = NULL;
+  client->streams = g_slist_remove (client->streams, stream);
+  if (--client->nstreams == 0) {
+    bin->clients = g_slist_remove (bin->clients, client);
+    free_client (client, bin);
+  }
+}
+
+/* only rtpbin configures the ts-offset of its jitterbuffers, so the last
+ * value we set is the current one and the property only needs to be set
+ * when the offset changes */
 static void
 stream_set_ts_offset (GstRtpBin * bin, GstRtpBinStream * stream,
     gint64 ts_offset, gboolean check)
 {
   gint64 prev_ts_offset;
 
-  g_object_get (stream->buffer, "ts-offset", &prev_ts_offset, NULL);
+  prev_ts_offset = stream->ts_offset;
 
   /* delta changed, see how much */
   if (prev_ts_offset != ts_offset) {
@@ -1074,6 +1105,7 @@ stream_set_ts_offset (GstRtpBin * bin, GstRtpBinStream * stream,
       }
     }
     g_object_set (stream->buffer, "ts-offset", ts_offset, NULL);
+    stream->ts_offset = ts_offset;
   }
   GST_DEBUG_OBJECT (bin, "stream SSRC %08x, delta %" G_GINT64_FORMAT,
       stream->ssrc, ts_offset);
@@ -1120,20 +1152,16 @@ gst_rtp_bin_associate (GstRtpBin * bin, GstRtpBinStream * stream, guint8 len,
   /* first find or create the CNAME */
   client = get_client (bin, len, data, &created);
 
-  /* find stream in the client */
-  for (walk = client->streams; walk; walk = g_slist_next (walk)) {
-    GstRtpBinStream *ostream = (GstRtpBinStream *) walk->data;
-
-    if (ostream == stream)
-      break;
-  }
-  /* not found, add it to the list */
-  if (walk == NULL) {
+  /* the stream knows its client, a stream that changed its CNAME moves to
+   * the new client */
+  if (stream->client != client) {
     GST_DEBUG_OBJECT (bin,
         "new association of SSRC %08x with client %p with CNAME %s",
         stream->ssrc, client, client->cname);
+    stream_remove_from_client (bin, stream);
     client->streams = g_slist_prepend (client->streams, stream);
     client->nstreams++;
+    stream->client = client;
   } else {
     GST_DEBUG_OBJECT (bin,
         "found association of SSRC %08x with client %p with CNAME %s",
@@ -1584,8 +1612,6 @@ no_demux:
 static void
 free_stream (GstRtpBinStream * stream, GstRtpBin * bin)
 {
-  GSList *clients, *next_client;
-
   GST_DEBUG_OBJECT (bin, "freeing stream %p", stream);
 
   if (stream->demux) {
@@ -1614,29 +1640,7 @@ free_stream (GstRtpBinStream * stream, GstRtpBin * bin)
   if (stream->demux)
     gst_bin_remove (GST_BIN_CAST (bin), stream->demux);
 
-  for (clients = bin->clients; clients; clients = next_client) {
-    GstRtpBinClient *client = (GstRtpBinClient *) clients->data;
-    GSList *streams, *next_stream;
-
-    next_client = g_slist_next (clients);
-
-    for (streams = client->streams; streams; streams = next_stream) {
-      GstRtpBinStream *ostream = (GstRtpBinStream *) streams->data;
-
-      next_stream = g_slist_next (streams);
-
-      if (ostream == stream) {
-        client->streams = g_slist_delete_link (client->streams, streams);
-        /* If this was the last stream belonging to this client,
-         * clean up the client. */
-        if (--client->nstreams == 0) {
-          bin->clients = g_slist_delete_link (bin->clients, clients);
-          free_client (client, bin);
-          break;
-        }
-      }
-    }
-  }
+  stream_remove_from_client (bin, stream);
   g_free (stream);
 }
 
@@ -2111,6 +2115,21 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
           DEFAULT_DO_RETRANSMISSION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpBin:shared-rtcp-thread:
+   *
+   * Make the sessions run their RTCP timeouts from a thread pool shared by
+   * all the sessions of the process instead of starting an RTCP thread for
+   * each session, see #GstRtpSession:shared-rtcp-thread.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_RTCP_THREAD,
+      g_param_spec_boolean ("shared-rtcp-thread", "Shared RTCP thread",
+          "Run the RTCP timeouts from a thread pool shared between sessions",
+          DEFAULT_SHARED_RTCP_THREAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_rtp_bin_change_state);
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_rtp_bin_request_new_pad);
@@ -2159,6 +2178,7 @@ gst_rtp_bin_init (GstRtpBin * rtpbin)
   rtpbin->priv = GST_RTP_BIN_GET_PRIVATE (rtpbin);
   g_mutex_init (&rtpbin->priv->bin_lock);
   g_mutex_init (&rtpbin->priv->dyn_lock);
+  rtpbin->priv->client_table = g_hash_table_new (g_str_hash, g_str_equal);
 
   rtpbin->latency_ms = DEFAULT_LATENCY_MS;
   rtpbin->latency_ns = DEFAULT_LATENCY_MS * GST_MSECOND;
@@ -2169,6 +2189,7 @@ gst_rtp_bin_init (GstRtpBin * rtpbin)
   rtpbin->rtcp_sync = DEFAULT_RTCP_SYNC;
   rtpbin->rtcp_sync_interval = DEFAULT_RTCP_SYNC_INTERVAL;
   rtpbin->priv->autoremove = DEFAULT_AUTOREMOVE;
+  rtpbin->priv->shared_rtcp_thread = DEFAULT_SHARED_RTCP_THREAD;
   rtpbin->buffer_mode = DEFAULT_BUFFER_MODE;
   rtpbin->use_pipeline_clock = DEFAULT_USE_PIPELINE_CLOCK;
   rtpbin->send_sync_event = DEFAULT_DO_SYNC_EVENT;
@@ -2210,6 +2231,7 @@ gst_rtp_bin_finalize (GObject * object)
 
   g_mutex_clear (&rtpbin->priv->bin_lock);
   g_mutex_clear (&rtpbin->priv->dyn_lock);
+  g_hash_table_destroy (rtpbin->priv->client_table);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -2333,6 +2355,21 @@ gst_rtp_bin_set_property (GObject * object, guint prop_id,
       gst_rtp_bin_propagate_property_to_jitterbuffer (rtpbin,
           "do-retransmission", value);
       break;
+    case PROP_SHARED_RTCP_THREAD:
+    {
+      GSList *sessions;
+      GST_RTP_BIN_LOCK (rtpbin);
+      rtpbin->priv->shared_rtcp_thread = g_value_get_boolean (value);
+      for (sessions = rtpbin->sessions; sessions;
+          sessions = g_slist_next (sessions)) {
+        GstRtpBinSession *session = (GstRtpBinSession *) sessions->data;
+
+        g_object_set (G_OBJECT (session->session),
+            "shared-rtcp-thread", rtpbin->priv->shared_rtcp_thread, NULL);
+      }
+      GST_RTP_BIN_UNLOCK (rtpbin);
+    }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2395,6 +2432,11 @@ gst_rtp_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, rtpbin->do_retransmission);
       GST_RTP_BIN_UNLOCK (rtpbin);
       break;
+    case PROP_SHARED_RTCP_THREAD:
+      GST_RTP_BIN_LOCK (rtpbin);
+      g_value_set_boolean (value, rtpbin->priv->shared_rtcp_thread);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -63,7 +63,7 @@ static GstStateChangeReturn gst_rtp_dtmf_mux_change_state (GstElement * element,
     GstStateChange transition);
 
 static gboolean gst_rtp_dtmf_mux_accept_buffer_locked (GstRTPMux * rtp_mux,
-    GstRTPMuxPadPrivate * padpriv, GstRTPBuffer * rtpbuffer);
+    GstRTPMuxPadPrivate * padpriv, GstBuffer * buffer);
 static gboolean gst_rtp_dtmf_mux_src_event (GstRTPMux * rtp_mux,
     GstEvent * event);
 
@@ -102,46 +102,45 @@ gst_rtp_dtmf_mux_class_init (GstRTPDTMFMuxClass * klass)
 
 static gboolean
 gst_rtp_dtmf_mux_accept_buffer_locked (GstRTPMux * rtp_mux,
-    GstRTPMuxPadPrivate * padpriv, GstRTPBuffer * rtpbuffer)
+    GstRTPMuxPadPrivate * padpriv, GstBuffer * buffer)
 {
   GstRTPDTMFMux *mux = GST_RTP_DTMF_MUX (rtp_mux);
   GstClockTime running_ts;
 
-  running_ts = GST_BUFFER_PTS (rtpbuffer->buffer);
+  running_ts = GST_BUFFER_PTS (buffer);
 
   if (GST_CLOCK_TIME_IS_VALID (running_ts)) {
     if (padpriv && padpriv->segment.format == GST_FORMAT_TIME)
       running_ts = gst_segment_to_running_time (&padpriv->segment,
-          GST_FORMAT_TIME, GST_BUFFER_PTS (rtpbuffer->buffer));
+          GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
 
     if (padpriv && padpriv->priority) {
-      if (GST_BUFFER_PTS_IS_VALID (rtpbuffer->buffer)) {
+      if (GST_BUFFER_PTS_IS_VALID (buffer)) {
         if (GST_CLOCK_TIME_IS_VALID (mux->last_priority_end))
           mux->last_priority_end =
-              MAX (running_ts + GST_BUFFER_DURATION (rtpbuffer->buffer),
+              MAX (running_ts + GST_BUFFER_DURATION (buffer),
               mux->last_priority_end);
         else
-          mux->last_priority_end = running_ts +
-              GST_BUFFER_DURATION (rtpbuffer->buffer);
+          mux->last_priority_end = running_ts + GST_BUFFER_DURATION (buffer);
         GST_LOG_OBJECT (mux, "Got buffer %p on priority pad, "
-            " blocking regular pads until %" GST_TIME_FORMAT, rtpbuffer->buffer,
+            " blocking regular pads until %" GST_TIME_FORMAT, buffer,
             GST_TIME_ARGS (mux->last_priority_end));
       } else {
         GST_WARNING_OBJECT (mux, "Buffer %p has an invalid duration,"
-            " not blocking other pad", rtpbuffer->buffer);
+            " not blocking other pad", buffer);
       }
     } else {
       if (GST_CLOCK_TIME_IS_VALID (mux->last_priority_end) &&
           running_ts < mux->last_priority_end) {
         GST_LOG_OBJECT (mux, "Dropping buffer %p because running time"
-            " %" GST_TIME_FORMAT " < %" GST_TIME_FORMAT, rtpbuffer->buffer,
+            " %" GST_TIME_FORMAT " < %" GST_TIME_FORMAT, buffer,
             GST_TIME_ARGS (running_ts), GST_TIME_ARGS (mux->last_priority_end));
         return FALSE;
       }
     }
   } else {
     GST_LOG_OBJECT (mux, "Buffer %p has an invalid timestamp,"
-        " letting through", rtpbuffer->buffer);
+        " letting through", buffer);
   }
 
   return TRUE;
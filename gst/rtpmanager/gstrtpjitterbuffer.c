@@ -134,6 +134,7 @@ enum
 #define DEFAULT_RTX_DELAY_REORDER   3
 #define DEFAULT_RTX_RETRY_TIMEOUT   -1
 #define DEFAULT_RTX_RETRY_PERIOD    -1
+#define DEFAULT_BUFFER_LIST         FALSE
 
 #define DEFAULT_AUTO_RTX_DELAY (20 * GST_MSECOND)
 #define DEFAULT_AUTO_RTX_TIMEOUT (40 * GST_MSECOND)
@@ -152,6 +153,7 @@ enum
   PROP_RTX_DELAY_REORDER,
   PROP_RTX_RETRY_TIMEOUT,
   PROP_RTX_RETRY_PERIOD,
+  PROP_BUFFER_LIST,
   PROP_STATS,
   PROP_LAST
 };
@@ -195,6 +197,15 @@ enum
   }                                                      \
 } G_STMT_END
 
+/* a binary min-heap of timers, the position of a timer in the heap is kept
+ * in the gint field at idx_offset of the TimerData */
+typedef struct
+{
+  GPtrArray *array;
+  GCompareFunc compare;
+  glong idx_offset;
+} TimerQueue;
+
 struct _GstRtpJitterBufferPrivate
 {
   GstPad *sinkpad, *srcpad;
@@ -225,6 +236,7 @@ struct _GstRtpJitterBufferPrivate
   gint rtx_delay_reorder;
   gint rtx_retry_timeout;
   gint rtx_retry_period;
+  gboolean buffer_list;
 
   /* the last seqnum we pushed out */
   guint32 last_popped_seqnum;
@@ -242,7 +254,14 @@ struct _GstRtpJitterBufferPrivate
   guint32 last_in_seqnum;
   guint32 next_in_seqnum;
 
-  GArray *timers;
+  /* timers ordered by timeout, EXPECTED timers are kept apart because the
+   * other timers are scheduled relative to the latency and offset */
+  TimerQueue expected_timers;
+  TimerQueue timers;
+  /* EXPECTED timers without retransmission requests, ordered by seqnum */
+  TimerQueue reorder_timers;
+  /* (type, seqnum) -> TimerData chained on the next field */
+  GHashTable *timer_lookup;
 
   /* start and stop ranges */
   GstClockTime npt_start;
@@ -299,9 +318,16 @@ typedef enum
   TIMER_TYPE_EOS
 } TimerType;
 
-typedef struct
+typedef struct _TimerData TimerData;
+
+struct _TimerData
 {
-  guint idx;
+  TimerQueue *queue;
+  gint idx;
+  gint reorder_idx;
+  guint key;
+  TimerData *next;
+
   guint16 seqnum;
   guint num;
   TimerType type;
@@ -312,7 +338,7 @@ typedef struct
   GstClockTime rtx_retry;
   GstClockTime rtx_last;
   guint num_rtx_retry;
-} TimerData;
+};
 
 #define GST_RTP_JITTER_BUFFER_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), GST_TYPE_RTP_JITTER_BUFFER, \
@@ -405,6 +431,10 @@ static void do_handle_sync (GstRtpJitterBuffer * jitterbuffer);
 
 static void unschedule_current_timer (GstRtpJitterBuffer * jitterbuffer);
 static void remove_all_timers (GstRtpJitterBuffer * jitterbuffer);
+static void timer_queue_init (TimerQueue * queue, GCompareFunc compare,
+    glong idx_offset);
+static gint compare_timer_timeout (const TimerData * a, const TimerData * b);
+static gint compare_timer_seqnum (const TimerData * a, const TimerData * b);
 
 static void wait_next_timeout (GstRtpJitterBuffer * jitterbuffer);
 
@@ -564,6 +594,19 @@ gst_rtp_jitter_buffer_class_init (GstRtpJitterBufferClass * klass)
           "Try to get a retransmission for this many ms "
           "(-1 automatic)", -1, G_MAXINT, DEFAULT_RTX_RETRY_PERIOD,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer:buffer-list:
+   *
+   * Push all consecutive packets that are ready to be sent, for example
+   * because a retransmission filled a gap, downstream in one #GstBufferList
+   * instead of one buffer at a time.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_BUFFER_LIST,
+      g_param_spec_boolean ("buffer-list", "Buffer List",
+          "Push consecutive packets downstream as a buffer list",
+          DEFAULT_BUFFER_LIST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   /**
    * GstRtpJitterBuffer:stats:
    *
@@ -574,6 +617,7 @@ gst_rtp_jitter_buffer_class_init (GstRtpJitterBufferClass * klass)
    *  "rtx-success-count" G_TYPE_UINT64 The number of successful retransmissions
    *  "rtx-per-packet"    G_TYPE_DOUBLE Average number of RTX per packet
    *  "rtx-rtt"           G_TYPE_UINT64 Average round trip time per RTX
+   *  "num-timers"        G_TYPE_UINT   The number of pending timers
    *
    * Since: 1.4
    */
@@ -695,11 +739,19 @@ gst_rtp_jitter_buffer_init (GstRtpJitterBuffer * jitterbuffer)
   priv->rtx_delay_reorder = DEFAULT_RTX_DELAY_REORDER;
   priv->rtx_retry_timeout = DEFAULT_RTX_RETRY_TIMEOUT;
   priv->rtx_retry_period = DEFAULT_RTX_RETRY_PERIOD;
+  priv->buffer_list = DEFAULT_BUFFER_LIST;
 
   priv->last_dts = -1;
   priv->last_rtptime = -1;
   priv->avg_jitter = 0;
-  priv->timers = g_array_new (FALSE, TRUE, sizeof (TimerData));
+  timer_queue_init (&priv->expected_timers,
+      (GCompareFunc) compare_timer_timeout, G_STRUCT_OFFSET (TimerData, idx));
+  timer_queue_init (&priv->timers,
+      (GCompareFunc) compare_timer_timeout, G_STRUCT_OFFSET (TimerData, idx));
+  timer_queue_init (&priv->reorder_timers,
+      (GCompareFunc) compare_timer_seqnum,
+      G_STRUCT_OFFSET (TimerData, reorder_idx));
+  priv->timer_lookup = g_hash_table_new (NULL, NULL);
   priv->jbuf = rtp_jitter_buffer_new ();
   g_mutex_init (&priv->jbuf_lock);
   g_cond_init (&priv->jbuf_timer);
@@ -780,7 +832,11 @@ gst_rtp_jitter_buffer_finalize (GObject * object)
   jitterbuffer = GST_RTP_JITTER_BUFFER (object);
   priv = jitterbuffer->priv;
 
-  g_array_free (priv->timers, TRUE);
+  remove_all_timers (jitterbuffer);
+  g_ptr_array_free (priv->expected_timers.array, TRUE);
+  g_ptr_array_free (priv->timers.array, TRUE);
+  g_ptr_array_free (priv->reorder_timers.array, TRUE);
+  g_hash_table_destroy (priv->timer_lookup);
   g_mutex_clear (&priv->jbuf_lock);
   g_cond_clear (&priv->jbuf_timer);
   g_cond_clear (&priv->jbuf_event);
@@ -1582,22 +1638,237 @@ apply_offset (GstRtpJitterBuffer * jitterbuffer, GstClockTime timestamp)
   return timestamp;
 }
 
-static TimerData *
-find_timer (GstRtpJitterBuffer * jitterbuffer, TimerType type, guint16 seqnum)
+#define TIMER_KEY(type,seqnum) (((type) << 16) | (seqnum))
+#define TIMER_IDX(queue,timer) G_STRUCT_MEMBER (gint, timer, (queue)->idx_offset)
+
+static void
+timer_queue_init (TimerQueue * queue, GCompareFunc compare, glong idx_offset)
 {
-  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
-  TimerData *timer = NULL;
-  gint i, len;
+  queue->array = g_ptr_array_new ();
+  queue->compare = compare;
+  queue->idx_offset = idx_offset;
+}
+
+static inline TimerData *
+timer_queue_peek (TimerQueue * queue)
+{
+  if (queue->array->len == 0)
+    return NULL;
+
+  return g_ptr_array_index (queue->array, 0);
+}
 
-  len = priv->timers->len;
-  for (i = 0; i < len; i++) {
-    TimerData *test = &g_array_index (priv->timers, TimerData, i);
-    if (test->seqnum == seqnum && test->type == type) {
-      timer = test;
+static inline void
+timer_queue_set (TimerQueue * queue, gint idx, TimerData * timer)
+{
+  g_ptr_array_index (queue->array, idx) = timer;
+  TIMER_IDX (queue, timer) = idx;
+}
+
+static void
+timer_queue_sift_up (TimerQueue * queue, gint idx)
+{
+  TimerData *timer = g_ptr_array_index (queue->array, idx);
+
+  while (idx > 0) {
+    gint parent = (idx - 1) / 2;
+    TimerData *test = g_ptr_array_index (queue->array, parent);
+
+    if (queue->compare (test, timer) <= 0)
       break;
+
+    timer_queue_set (queue, idx, test);
+    idx = parent;
+  }
+  timer_queue_set (queue, idx, timer);
+}
+
+static void
+timer_queue_sift_down (TimerQueue * queue, gint idx)
+{
+  TimerData *timer = g_ptr_array_index (queue->array, idx);
+  gint len = queue->array->len;
+
+  while (TRUE) {
+    gint child = 2 * idx + 1;
+    TimerData *test;
+
+    if (child >= len)
+      break;
+
+    test = g_ptr_array_index (queue->array, child);
+    if (child + 1 < len) {
+      TimerData *right = g_ptr_array_index (queue->array, child + 1);
+
+      if (queue->compare (right, test) < 0) {
+        child++;
+        test = right;
+      }
     }
+    if (queue->compare (timer, test) <= 0)
+      break;
+
+    timer_queue_set (queue, idx, test);
+    idx = child;
   }
-  return timer;
+  timer_queue_set (queue, idx, timer);
+}
+
+static void
+timer_queue_push (TimerQueue * queue, TimerData * timer)
+{
+  g_ptr_array_add (queue->array, timer);
+  timer_queue_sift_up (queue, queue->array->len - 1);
+}
+
+/* the sort key of @timer changed, move it to its new position */
+static void
+timer_queue_update (TimerQueue * queue, TimerData * timer)
+{
+  gint idx = TIMER_IDX (queue, timer);
+
+  timer_queue_sift_up (queue, idx);
+  timer_queue_sift_down (queue, TIMER_IDX (queue, timer));
+}
+
+static void
+timer_queue_remove (TimerQueue * queue, TimerData * timer)
+{
+  gint idx = TIMER_IDX (queue, timer);
+  TimerData *last;
+
+  TIMER_IDX (queue, timer) = -1;
+  last = g_ptr_array_remove_index (queue->array, queue->array->len - 1);
+  if (last == timer)
+    return;
+
+  timer_queue_set (queue, idx, last);
+  timer_queue_update (queue, last);
+}
+
+/* immediate timers first, then by timeout and seqnum */
+static gint
+compare_timer_timeout (const TimerData * a, const TimerData * b)
+{
+  if (a->timeout != b->timeout) {
+    if (a->timeout == -1)
+      return -1;
+    if (b->timeout == -1)
+      return 1;
+    return a->timeout < b->timeout ? -1 : 1;
+  }
+  return (gint) a->seqnum - (gint) b->seqnum;
+}
+
+/* oldest seqnum first */
+static gint
+compare_timer_seqnum (const TimerData * a, const TimerData * b)
+{
+  return gst_rtp_buffer_compare_seqnum (b->seqnum, a->seqnum);
+}
+
+static void
+timer_lookup_add (GstRtpJitterBuffer * jitterbuffer, TimerData * timer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  TimerData *head;
+
+  timer->next = NULL;
+  head = g_hash_table_lookup (priv->timer_lookup, GUINT_TO_POINTER (timer->key));
+  if (head == NULL) {
+    g_hash_table_insert (priv->timer_lookup, GUINT_TO_POINTER (timer->key),
+        timer);
+  } else {
+    /* keep the oldest timer first, like the order they were added in */
+    while (head->next)
+      head = head->next;
+    head->next = timer;
+  }
+}
+
+static void
+timer_lookup_remove (GstRtpJitterBuffer * jitterbuffer, TimerData * timer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  TimerData *head;
+
+  head = g_hash_table_lookup (priv->timer_lookup, GUINT_TO_POINTER (timer->key));
+  if (head == timer) {
+    if (timer->next)
+      g_hash_table_insert (priv->timer_lookup, GUINT_TO_POINTER (timer->key),
+          timer->next);
+    else
+      g_hash_table_remove (priv->timer_lookup, GUINT_TO_POINTER (timer->key));
+  } else if (head) {
+    while (head->next && head->next != timer)
+      head = head->next;
+    if (head->next)
+      head->next = timer->next;
+  }
+  timer->next = NULL;
+}
+
+/* put @timer in the right queues after its type, seqnum, timeout or number of
+ * retries changed */
+static void
+update_timer_queues (GstRtpJitterBuffer * jitterbuffer, TimerData * timer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  TimerQueue *queue;
+  gboolean reorder;
+  guint key;
+
+  key = TIMER_KEY (timer->type, timer->seqnum);
+  if (timer->key != key) {
+    timer_lookup_remove (jitterbuffer, timer);
+    timer->key = key;
+    timer_lookup_add (jitterbuffer, timer);
+  }
+
+  if (timer->type == TIMER_TYPE_EXPECTED)
+    queue = &priv->expected_timers;
+  else
+    queue = &priv->timers;
+
+  if (timer->queue != queue) {
+    if (timer->queue)
+      timer_queue_remove (timer->queue, timer);
+    timer->queue = queue;
+    timer_queue_push (queue, timer);
+  } else {
+    timer_queue_update (queue, timer);
+  }
+
+  /* only fresh EXPECTED timers are rescheduled when we see too much
+   * reordering, see update_timers() */
+  reorder = timer->type == TIMER_TYPE_EXPECTED && timer->num_rtx_retry == 0
+      && timer->timeout != -1;
+
+  if (timer->reorder_idx != -1) {
+    if (reorder)
+      timer_queue_update (&priv->reorder_timers, timer);
+    else
+      timer_queue_remove (&priv->reorder_timers, timer);
+  } else if (reorder) {
+    timer_queue_push (&priv->reorder_timers, timer);
+  }
+}
+
+static TimerData *
+find_timer (GstRtpJitterBuffer * jitterbuffer, TimerType type, guint16 seqnum)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+
+  return g_hash_table_lookup (priv->timer_lookup,
+      GUINT_TO_POINTER (TIMER_KEY (type, seqnum)));
+}
+
+static guint
+get_num_timers (GstRtpJitterBuffer * jitterbuffer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+
+  return priv->expected_timers.array->len + priv->timers.array->len;
 }
 
 static void
@@ -1652,16 +1923,15 @@ add_timer (GstRtpJitterBuffer * jitterbuffer, TimerType type,
 {
   GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
   TimerData *timer;
-  gint len;
 
   GST_DEBUG_OBJECT (jitterbuffer,
       "add timer for seqnum %d to %" GST_TIME_FORMAT ", delay %"
       GST_TIME_FORMAT, seqnum, GST_TIME_ARGS (timeout), GST_TIME_ARGS (delay));
 
-  len = priv->timers->len;
-  g_array_set_size (priv->timers, len + 1);
-  timer = &g_array_index (priv->timers, TimerData, len);
-  timer->idx = len;
+  timer = g_slice_new0 (TimerData);
+  timer->idx = -1;
+  timer->reorder_idx = -1;
+  timer->key = G_MAXUINT;
   timer->type = type;
   timer->seqnum = seqnum;
   timer->num = num;
@@ -1673,6 +1943,7 @@ add_timer (GstRtpJitterBuffer * jitterbuffer, TimerType type,
     timer->rtx_retry = 0;
   }
   timer->num_rtx_retry = 0;
+  update_timer_queues (jitterbuffer, timer);
   recalculate_timer (jitterbuffer, timer);
   JBUF_SIGNAL_TIMER (priv);
 
@@ -1706,6 +1977,7 @@ reschedule_timer (GstRtpJitterBuffer * jitterbuffer, TimerData * timer,
     timer->rtx_delay = delay;
     timer->rtx_retry = 0;
   }
+  update_timer_queues (jitterbuffer, timer);
 
   if (priv->clock_id) {
     /* we changed the seqnum and there is a timer currently waiting with this
@@ -1739,15 +2011,27 @@ static void
 remove_timer (GstRtpJitterBuffer * jitterbuffer, TimerData * timer)
 {
   GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
-  guint idx;
 
   if (priv->clock_id && priv->timer_seqnum == timer->seqnum)
     unschedule_current_timer (jitterbuffer);
 
-  idx = timer->idx;
-  GST_DEBUG_OBJECT (jitterbuffer, "removed index %d", idx);
-  g_array_remove_index_fast (priv->timers, idx);
-  timer->idx = idx;
+  GST_DEBUG_OBJECT (jitterbuffer, "removed timer for seqnum %d",
+      timer->seqnum);
+  timer_lookup_remove (jitterbuffer, timer);
+  timer_queue_remove (timer->queue, timer);
+  if (timer->reorder_idx != -1)
+    timer_queue_remove (&priv->reorder_timers, timer);
+  g_slice_free (TimerData, timer);
+}
+
+static void
+free_timers (TimerQueue * queue)
+{
+  guint i;
+
+  for (i = 0; i < queue->array->len; i++)
+    g_slice_free (TimerData, g_ptr_array_index (queue->array, i));
+  g_ptr_array_set_size (queue->array, 0);
 }
 
 static void
@@ -1755,7 +2039,10 @@ remove_all_timers (GstRtpJitterBuffer * jitterbuffer)
 {
   GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
   GST_DEBUG_OBJECT (jitterbuffer, "removed all timers");
-  g_array_set_size (priv->timers, 0);
+  g_hash_table_remove_all (priv->timer_lookup);
+  g_ptr_array_set_size (priv->reorder_timers.array, 0);
+  free_timers (&priv->expected_timers);
+  free_timers (&priv->timers);
   unschedule_current_timer (jitterbuffer);
 }
 
@@ -1774,31 +2061,35 @@ update_timers (GstRtpJitterBuffer * jitterbuffer, guint16 seqnum,
     GstClockTime dts, gboolean do_next_seqnum)
 {
   GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
-  TimerData *timer = NULL;
-  gint i, len;
-
-  /* go through all timers and unschedule the ones with a large gap, also find
-   * the timer for the seqnum */
-  len = priv->timers->len;
-  for (i = 0; i < len; i++) {
-    TimerData *test = &g_array_index (priv->timers, TimerData, i);
+  TimerData *timer = NULL, *test;
+  TimerType type;
+  gint max_gap;
+
+  /* find the timer for the seqnum */
+  for (type = TIMER_TYPE_EXPECTED; type <= TIMER_TYPE_EOS && !timer; type++)
+    timer = find_timer (jitterbuffer, type, seqnum);
+
+  if (timer)
+    GST_DEBUG ("found timer for current seqnum");
+
+  /* unschedule the EXPECTED timers with a large gap, they are ordered by
+   * seqnum so we only need to look at the oldest ones */
+  max_gap = MAX (priv->rtx_delay_reorder, 0);
+  while ((test = timer_queue_peek (&priv->reorder_timers))) {
     gint gap;
 
     gap = gst_rtp_buffer_compare_seqnum (test->seqnum, seqnum);
 
-    GST_DEBUG_OBJECT (jitterbuffer, "%d, #%d<->#%d gap %d", i,
-        test->seqnum, seqnum, gap);
-
-    if (gap == 0) {
-      GST_DEBUG ("found timer for current seqnum");
-      /* the timer for the current seqnum */
-      timer = test;
-    } else if (gap > priv->rtx_delay_reorder) {
-      /* max gap, we exceeded the max reorder distance and we don't expect the
-       * missing packet to be this reordered */
-      if (test->num_rtx_retry == 0 && test->type == TIMER_TYPE_EXPECTED)
-        reschedule_timer (jitterbuffer, test, test->seqnum, -1, 0, FALSE);
-    }
+    GST_DEBUG_OBJECT (jitterbuffer, "#%d<->#%d gap %d", test->seqnum,
+        seqnum, gap);
+
+    if (gap <= max_gap)
+      break;
+
+    /* max gap, we exceeded the max reorder distance and we don't expect the
+     * missing packet to be this reordered. This removes the timer from the
+     * reorder queue. */
+    reschedule_timer (jitterbuffer, test, test->seqnum, -1, 0, FALSE);
   }
 
   if (priv->packet_spacing > 0 && do_next_seqnum && priv->do_retransmission) {
@@ -2380,6 +2671,84 @@ update_estimated_eos (GstRtpJitterBuffer * jitterbuffer,
   }
 }
 
+/* set flags and timestamps on the buffer of @item for pushing it */
+static GstBuffer *
+prepare_output_buffer (GstRtpJitterBuffer * jitterbuffer,
+    RTPJitterBufferItem * item)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GstBuffer *outbuf;
+  GstClockTime dts, pts;
+
+  /* we need to make writable to change the flags and timestamps */
+  outbuf = gst_buffer_make_writable (item->data);
+  item->data = NULL;
+
+  if (G_UNLIKELY (priv->discont)) {
+    /* set DISCONT flag when we missed a packet. We pushed the buffer writable
+     * into the jitterbuffer so we can modify now. */
+    GST_DEBUG_OBJECT (jitterbuffer, "mark output buffer discont");
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    priv->discont = FALSE;
+  }
+  if (G_UNLIKELY (priv->ts_discont)) {
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_RESYNC);
+    priv->ts_discont = FALSE;
+  }
+
+  dts = gst_segment_to_position (&priv->segment, GST_FORMAT_TIME, item->dts);
+  pts = gst_segment_to_position (&priv->segment, GST_FORMAT_TIME, item->pts);
+
+  /* apply timestamp with offset to buffer now */
+  GST_BUFFER_DTS (outbuf) = apply_offset (jitterbuffer, dts);
+  GST_BUFFER_PTS (outbuf) = apply_offset (jitterbuffer, pts);
+
+  /* update the elapsed time when we need to check against the npt stop time. */
+  update_estimated_eos (jitterbuffer, item);
+
+  priv->last_out_time = GST_BUFFER_PTS (outbuf);
+
+  return outbuf;
+}
+
+/* after popping @outbuf, also pop all the packets that directly follow it and
+ * collect them in a buffer list */
+static GstBufferList *
+pop_next_buffers (GstRtpJitterBuffer * jitterbuffer, GstBuffer * outbuf,
+    gint * percent)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GstBufferList *list = NULL;
+  RTPJitterBufferItem *item;
+
+  while ((item = rtp_jitter_buffer_peek (priv->jbuf))) {
+    gint item_percent = -1;
+
+    if (!GST_IS_BUFFER (item->data) || item->seqnum != priv->next_seqnum)
+      break;
+    /* stop when popping the previous packet made us start buffering */
+    if (rtp_jitter_buffer_is_buffering (priv->jbuf))
+      break;
+
+    if (list == NULL) {
+      list = gst_buffer_list_new ();
+      gst_buffer_list_add (list, outbuf);
+    }
+
+    item = rtp_jitter_buffer_pop (priv->jbuf, &item_percent);
+    check_buffering_percent (jitterbuffer, &item_percent);
+    if (item_percent != -1)
+      *percent = item_percent;
+
+    gst_buffer_list_add (list, prepare_output_buffer (jitterbuffer, item));
+
+    priv->last_popped_seqnum = item->seqnum;
+    priv->next_seqnum = (item->seqnum + item->count) & 0xffff;
+    free_item (item);
+  }
+  return list;
+}
+
 /* take a buffer from the queue and push it */
 static GstFlowReturn
 pop_and_push_next (GstRtpJitterBuffer * jitterbuffer, guint seqnum)
@@ -2387,9 +2756,9 @@ pop_and_push_next (GstRtpJitterBuffer * jitterbuffer, guint seqnum)
   GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
   GstFlowReturn result;
   RTPJitterBufferItem *item;
-  GstBuffer *outbuf;
-  GstEvent *outevent;
-  GstClockTime dts, pts;
+  GstBuffer *outbuf = NULL;
+  GstBufferList *outlist = NULL;
+  GstEvent *outevent = NULL;
   gint percent = -1;
   gboolean is_buffer, do_push = TRUE;
 
@@ -2400,35 +2769,10 @@ pop_and_push_next (GstRtpJitterBuffer * jitterbuffer, guint seqnum)
 
   if (is_buffer) {
     check_buffering_percent (jitterbuffer, &percent);
-
-    /* we need to make writable to change the flags and timestamps */
-    outbuf = gst_buffer_make_writable (item->data);
-
-    if (G_UNLIKELY (priv->discont)) {
-      /* set DISCONT flag when we missed a packet. We pushed the buffer writable
-       * into the jitterbuffer so we can modify now. */
-      GST_DEBUG_OBJECT (jitterbuffer, "mark output buffer discont");
-      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
-      priv->discont = FALSE;
-    }
-    if (G_UNLIKELY (priv->ts_discont)) {
-      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_RESYNC);
-      priv->ts_discont = FALSE;
-    }
-
-    dts = gst_segment_to_position (&priv->segment, GST_FORMAT_TIME, item->dts);
-    pts = gst_segment_to_position (&priv->segment, GST_FORMAT_TIME, item->pts);
-
-    /* apply timestamp with offset to buffer now */
-    GST_BUFFER_DTS (outbuf) = apply_offset (jitterbuffer, dts);
-    GST_BUFFER_PTS (outbuf) = apply_offset (jitterbuffer, pts);
-
-    /* update the elapsed time when we need to check against the npt stop time. */
-    update_estimated_eos (jitterbuffer, item);
-
-    priv->last_out_time = GST_BUFFER_PTS (outbuf);
+    outbuf = prepare_output_buffer (jitterbuffer, item);
   } else {
     outevent = item->data;
+    item->data = NULL;
     if (item->type == ITEM_TYPE_LOST) {
       priv->discont = TRUE;
       if (!priv->do_lost)
@@ -2442,21 +2786,32 @@ pop_and_push_next (GstRtpJitterBuffer * jitterbuffer, guint seqnum)
     priv->last_popped_seqnum = seqnum;
     priv->next_seqnum = (seqnum + item->count) & 0xffff;
   }
-  JBUF_UNLOCK (priv);
-
-  item->data = NULL;
   free_item (item);
 
+  if (is_buffer && priv->buffer_list)
+    outlist = pop_next_buffers (jitterbuffer, outbuf, &percent);
+
+  JBUF_UNLOCK (priv);
+
   if (is_buffer) {
     /* push buffer */
     if (percent != -1)
       post_buffering_percent (jitterbuffer, percent);
 
-    GST_DEBUG_OBJECT (jitterbuffer,
-        "Pushing buffer %d, dts %" GST_TIME_FORMAT ", pts %" GST_TIME_FORMAT,
-        seqnum, GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)),
-        GST_TIME_ARGS (GST_BUFFER_PTS (outbuf)));
-    result = gst_pad_push (priv->srcpad, outbuf);
+    if (outlist) {
+      GST_DEBUG_OBJECT (jitterbuffer,
+          "Pushing list of %u buffers from %d, dts %" GST_TIME_FORMAT ", pts %"
+          GST_TIME_FORMAT, gst_buffer_list_length (outlist), seqnum,
+          GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)),
+          GST_TIME_ARGS (GST_BUFFER_PTS (outbuf)));
+      result = gst_pad_push_list (priv->srcpad, outlist);
+    } else {
+      GST_DEBUG_OBJECT (jitterbuffer,
+          "Pushing buffer %d, dts %" GST_TIME_FORMAT ", pts %" GST_TIME_FORMAT,
+          seqnum, GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)),
+          GST_TIME_ARGS (GST_BUFFER_PTS (outbuf)));
+      result = gst_pad_push (priv->srcpad, outbuf);
+    }
   } else {
     GST_DEBUG_OBJECT (jitterbuffer, "Pushing event %d", seqnum);
 
@@ -2641,6 +2996,8 @@ do_expected_timeout (GstRtpJitterBuffer * jitterbuffer, TimerData * timer,
     timer->rtx_delay = 0;
     timer->rtx_retry = 0;
   }
+  /* the retry count or type changed, even if the timeout would not */
+  update_timer_queues (jitterbuffer, timer);
   reschedule_timer (jitterbuffer, timer, timer->seqnum,
       timer->rtx_base + timer->rtx_retry, timer->rtx_delay, FALSE);
 
@@ -2754,7 +3111,7 @@ do_timeout (GstRtpJitterBuffer * jitterbuffer, TimerData * timer,
 
 /* called when we need to wait for the next timeout.
  *
- * We loop over the array of recorded timeouts and wait for the earliest one.
+ * We take the earliest timer of the timer queues and wait for it.
  * When it timed out, do the logic associated with the timer.
  *
  * If there are no timers, we wait on a gcond until something new happens.
@@ -2769,17 +3126,26 @@ wait_next_timeout (GstRtpJitterBuffer * jitterbuffer)
   while (priv->timer_running) {
     TimerData *timer = NULL;
     GstClockTime timer_timeout = -1;
-    gint i, len;
+    TimerData *first[2];
+    gint i;
 
     GST_DEBUG_OBJECT (jitterbuffer, "now %" GST_TIME_FORMAT,
         GST_TIME_ARGS (now));
 
-    len = priv->timers->len;
-    for (i = 0; i < len; i++) {
-      TimerData *test = &g_array_index (priv->timers, TimerData, i);
-      GstClockTime test_timeout = get_timeout (jitterbuffer, test);
+    /* the queues are ordered on timeout, within a queue the offset and
+     * latency are the same for all timers */
+    first[0] = timer_queue_peek (&priv->expected_timers);
+    first[1] = timer_queue_peek (&priv->timers);
+    for (i = 0; i < 2; i++) {
+      TimerData *test = first[i];
+      GstClockTime test_timeout;
       gboolean save_best = FALSE;
 
+      if (test == NULL)
+        continue;
+
+      test_timeout = get_timeout (jitterbuffer, test);
+
       GST_DEBUG_OBJECT (jitterbuffer, "%d, %d, %d, %" GST_TIME_FORMAT,
           i, test->type, test->seqnum, GST_TIME_ARGS (test_timeout));
 
@@ -3298,6 +3664,11 @@ gst_rtp_jitter_buffer_set_property (GObject * object,
       priv->rtx_retry_period = g_value_get_int (value);
       JBUF_UNLOCK (priv);
       break;
+    case PROP_BUFFER_LIST:
+      JBUF_LOCK (priv);
+      priv->buffer_list = g_value_get_boolean (value);
+      JBUF_UNLOCK (priv);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3379,6 +3750,11 @@ gst_rtp_jitter_buffer_get_property (GObject * object,
       g_value_set_int (value, priv->rtx_retry_period);
       JBUF_UNLOCK (priv);
       break;
+    case PROP_BUFFER_LIST:
+      JBUF_LOCK (priv);
+      g_value_set_boolean (value, priv->buffer_list);
+      JBUF_UNLOCK (priv);
+      break;
     case PROP_STATS:
       g_value_take_boxed (value,
           gst_rtp_jitter_buffer_create_stats (jitterbuffer));
@@ -3399,7 +3775,8 @@ gst_rtp_jitter_buffer_create_stats (GstRtpJitterBuffer * jbuf)
       "rtx-count", G_TYPE_UINT64, jbuf->priv->num_rtx_requests,
       "rtx-success-count", G_TYPE_UINT64, jbuf->priv->num_rtx_success,
       "rtx-per-packet", G_TYPE_DOUBLE, jbuf->priv->avg_rtx_num,
-      "rtx-rtt", G_TYPE_UINT64, jbuf->priv->avg_rtx_rtt, NULL);
+      "rtx-rtt", G_TYPE_UINT64, jbuf->priv->avg_rtx_rtt,
+      "num-timers", G_TYPE_UINT, get_num_timers (jbuf), NULL);
   JBUF_UNLOCK (jbuf->priv);
 
   return s;
@@ -257,6 +257,12 @@ gst_rtp_mux_init (GstRTPMux * rtp_mux)
   rtp_mux->last_stop = GST_CLOCK_TIME_NONE;
 }
 
+static void
+gst_rtp_mux_pad_private_free (GstRTPMuxPadPrivate * padpriv)
+{
+  g_slice_free (GstRTPMuxPadPrivate, padpriv);
+}
+
 static void
 gst_rtp_mux_setup_sinkpad (GstRTPMux * rtp_mux, GstPad * sinkpad)
 {
@@ -274,7 +280,11 @@ gst_rtp_mux_setup_sinkpad (GstRTPMux * rtp_mux, GstPad * sinkpad)
 
   gst_segment_init (&padpriv->segment, GST_FORMAT_UNDEFINED);
 
+  /* the fast path reads the private data without the object lock, so it
+   * must stay valid for as long as the pad itself */
   gst_pad_set_element_private (sinkpad, padpriv);
+  g_object_set_data_full (G_OBJECT (sinkpad), "rtp-mux-pad-private", padpriv,
+      (GDestroyNotify) gst_rtp_mux_pad_private_free);
 
   gst_pad_set_active (sinkpad, TRUE);
   gst_element_add_pad (GST_ELEMENT (rtp_mux), sinkpad);
@@ -309,18 +319,12 @@ gst_rtp_mux_request_new_pad (GstElement * element,
 static void
 gst_rtp_mux_release_pad (GstElement * element, GstPad * pad)
 {
-  GstRTPMuxPadPrivate *padpriv;
-
+  /* the private data itself is freed together with the pad */
   GST_OBJECT_LOCK (element);
-  padpriv = gst_pad_get_element_private (pad);
   gst_pad_set_element_private (pad, NULL);
   GST_OBJECT_UNLOCK (element);
 
   gst_element_remove_pad (element, pad);
-
-  if (padpriv) {
-    g_slice_free (GstRTPMuxPadPrivate, padpriv);
-  }
 }
 
 /* Put our own clock-base on the buffer */
@@ -341,66 +345,151 @@ gst_rtp_mux_readjust_rtp_timestamp_locked (GstRTPMux * rtp_mux,
   gst_rtp_buffer_set_timestamp (rtpbuffer, ts);
 }
 
+/* Rewrite seqnum, SSRC and timestamp of the writable @buffer. The fixed
+ * header normally sits in the first memory, so it is patched there directly
+ * instead of mapping and parsing the whole packet. */
 static gboolean
-process_buffer_locked (GstRTPMux * rtp_mux, GstRTPMuxPadPrivate * padpriv,
-    GstRTPBuffer * rtpbuffer)
+gst_rtp_mux_stamp_buffer (GstRTPMux * rtp_mux, GstRTPMuxPadPrivate * padpriv,
+    GstBuffer * buffer)
 {
-  GstRTPMuxClass *klass = GST_RTP_MUX_GET_CLASS (rtp_mux);
+  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
+  GstMapInfo map;
+  guint16 seqnum;
 
-  if (klass->accept_buffer_locked)
-    if (!klass->accept_buffer_locked (rtp_mux, padpriv, rtpbuffer))
-      return FALSE;
+  if (gst_buffer_n_memory (buffer) > 0 &&
+      gst_buffer_map_range (buffer, 0, 1, &map, GST_MAP_READWRITE)) {
+    if (map.size >= 12 && (map.data[0] >> 6) == 2) {
+      guint32 ts, sink_ts_base = 0;
+
+      if (padpriv && padpriv->have_clock_base)
+        sink_ts_base = padpriv->clock_base;
+
+      seqnum = g_atomic_int_add (&rtp_mux->seqnum, 1) + 1;
+      ts = GST_READ_UINT32_BE (map.data + 4) - sink_ts_base + rtp_mux->ts_base;
+
+      GST_WRITE_UINT16_BE (map.data + 2, seqnum);
+      GST_WRITE_UINT32_BE (map.data + 4, ts);
+      GST_WRITE_UINT32_BE (map.data + 8, rtp_mux->current_ssrc);
+      gst_buffer_unmap (buffer, &map);
+      goto done;
+    }
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  /* header is split over memories or not valid, let the RTP library check */
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtpbuffer))
+    return FALSE;
 
-  rtp_mux->seqnum++;
-  gst_rtp_buffer_set_seq (rtpbuffer, rtp_mux->seqnum);
+  seqnum = g_atomic_int_add (&rtp_mux->seqnum, 1) + 1;
+  gst_rtp_buffer_set_seq (&rtpbuffer, seqnum);
+  gst_rtp_buffer_set_ssrc (&rtpbuffer, rtp_mux->current_ssrc);
+  gst_rtp_mux_readjust_rtp_timestamp_locked (rtp_mux, padpriv, &rtpbuffer);
+  gst_rtp_buffer_unmap (&rtpbuffer);
 
-  gst_rtp_buffer_set_ssrc (rtpbuffer, rtp_mux->current_ssrc);
-  gst_rtp_mux_readjust_rtp_timestamp_locked (rtp_mux, padpriv, rtpbuffer);
+done:
   GST_LOG_OBJECT (rtp_mux,
-      "Pushing packet size %" G_GSIZE_FORMAT ", seq=%d, ts=%u",
-      rtpbuffer->map[0].size, rtp_mux->seqnum,
-      gst_rtp_buffer_get_timestamp (rtpbuffer));
+      "Pushing packet size %" G_GSIZE_FORMAT ", seq=%d",
+      gst_buffer_get_size (buffer), seqnum);
 
   if (padpriv) {
     if (padpriv->segment.format == GST_FORMAT_TIME)
-      GST_BUFFER_PTS (rtpbuffer->buffer) =
+      GST_BUFFER_PTS (buffer) =
           gst_segment_to_running_time (&padpriv->segment, GST_FORMAT_TIME,
-          GST_BUFFER_PTS (rtpbuffer->buffer));
+          GST_BUFFER_PTS (buffer));
   }
 
   return TRUE;
 }
 
+static void
+update_last_stop (GstRTPMux * rtp_mux, GstBuffer * buffer)
+{
+  if (GST_BUFFER_DURATION_IS_VALID (buffer) &&
+      GST_BUFFER_TIMESTAMP_IS_VALID (buffer))
+    rtp_mux->last_stop = GST_BUFFER_TIMESTAMP (buffer) +
+        GST_BUFFER_DURATION (buffer);
+  else
+    rtp_mux->last_stop = GST_CLOCK_TIME_NONE;
+}
+
+/* With a single sink pad that already pushed the sticky events downstream,
+ * no other streaming thread can stamp buffers concurrently, so the object
+ * lock is not needed. Subclasses that filter buffers share their state with
+ * other threads and always take the lock. */
+static gboolean
+gst_rtp_mux_can_skip_lock (GstRTPMux * rtp_mux, GstPad * pad)
+{
+  GstRTPMuxClass *klass = GST_RTP_MUX_GET_CLASS (rtp_mux);
+
+  return klass->accept_buffer_locked == NULL &&
+      GST_ELEMENT_CAST (rtp_mux)->numsinkpads == 1 &&
+      rtp_mux->last_pad == pad;
+}
+
+/* Returns %FALSE if @pad changed since the last buffer and its sticky events
+ * need to be resent */
+static gboolean
+update_last_pad_locked (GstRTPMux * rtp_mux, GstPad * pad)
+{
+  if (pad == rtp_mux->last_pad)
+    return TRUE;
+
+  g_clear_object (&rtp_mux->last_pad);
+  rtp_mux->last_pad = g_object_ref (pad);
+
+  return FALSE;
+}
+
 struct BufferListData
 {
   GstRTPMux *rtp_mux;
   GstRTPMuxPadPrivate *padpriv;
-  gboolean drop;
+  gboolean have_buffers;
+  GstFlowReturn ret;
 };
 
 static gboolean
 process_list_item (GstBuffer ** buffer, guint idx, gpointer user_data)
 {
   struct BufferListData *bd = user_data;
-  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
+  GstRTPMux *rtp_mux = bd->rtp_mux;
+  GstRTPMuxClass *klass = GST_RTP_MUX_GET_CLASS (rtp_mux);
 
   *buffer = gst_buffer_make_writable (*buffer);
 
-  gst_rtp_buffer_map (*buffer, GST_MAP_READWRITE, &rtpbuffer);
+  if (klass->accept_buffer_locked &&
+      !klass->accept_buffer_locked (rtp_mux, bd->padpriv, *buffer)) {
+    /* removes the buffer from the list */
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return TRUE;
+  }
 
-  bd->drop = !process_buffer_locked (bd->rtp_mux, bd->padpriv, &rtpbuffer);
+  if (!gst_rtp_mux_stamp_buffer (rtp_mux, bd->padpriv, *buffer)) {
+    GST_ERROR_OBJECT (rtp_mux, "Invalid RTP buffer");
+    bd->ret = GST_FLOW_ERROR;
+    return FALSE;
+  }
 
-  gst_rtp_buffer_unmap (&rtpbuffer);
+  update_last_stop (rtp_mux, *buffer);
+  bd->have_buffers = TRUE;
 
-  if (bd->drop)
-    return FALSE;
+  return TRUE;
+}
 
-  if (GST_BUFFER_DURATION_IS_VALID (*buffer) &&
-      GST_BUFFER_TIMESTAMP_IS_VALID (*buffer))
-    bd->rtp_mux->last_stop = GST_BUFFER_TIMESTAMP (*buffer) +
-        GST_BUFFER_DURATION (*buffer);
-  else
-    bd->rtp_mux->last_stop = GST_CLOCK_TIME_NONE;
+static gboolean
+resend_events (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstRTPMux *rtp_mux = user_data;
+
+  if (GST_EVENT_TYPE (*event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (*event, &caps);
+    gst_rtp_mux_setcaps (pad, rtp_mux, caps);
+  } else {
+    gst_pad_push_event (rtp_mux->srcpad, gst_event_ref (*event));
+  }
 
   return TRUE;
 }
@@ -412,16 +501,20 @@ gst_rtp_mux_chain_list (GstPad * pad, GstObject * parent,
   GstRTPMux *rtp_mux;
   GstFlowReturn ret;
   GstRTPMuxPadPrivate *padpriv;
-  gboolean drop = TRUE;
+  gboolean locked;
+  gboolean changed = FALSE;
   struct BufferListData bd;
 
   rtp_mux = GST_RTP_MUX (parent);
 
-  GST_OBJECT_LOCK (rtp_mux);
+  locked = !gst_rtp_mux_can_skip_lock (rtp_mux, pad);
+  if (locked)
+    GST_OBJECT_LOCK (rtp_mux);
 
   padpriv = gst_pad_get_element_private (pad);
   if (!padpriv) {
-    GST_OBJECT_UNLOCK (rtp_mux);
+    if (locked)
+      GST_OBJECT_UNLOCK (rtp_mux);
     ret = GST_FLOW_NOT_LINKED;
     gst_buffer_list_unref (bufferlist);
     goto out;
@@ -429,16 +522,24 @@ gst_rtp_mux_chain_list (GstPad * pad, GstObject * parent,
 
   bd.rtp_mux = rtp_mux;
   bd.padpriv = padpriv;
-  bd.drop = FALSE;
+  bd.have_buffers = FALSE;
+  bd.ret = GST_FLOW_OK;
 
   bufferlist = gst_buffer_list_make_writable (bufferlist);
   gst_buffer_list_foreach (bufferlist, process_list_item, &bd);
 
-  GST_OBJECT_UNLOCK (rtp_mux);
+  if (locked) {
+    if (bd.have_buffers && bd.ret == GST_FLOW_OK)
+      changed = !update_last_pad_locked (rtp_mux, pad);
+    GST_OBJECT_UNLOCK (rtp_mux);
+  }
 
-  if (drop) {
+  if (changed)
+    gst_pad_sticky_events_foreach (pad, resend_events, rtp_mux);
+
+  if (bd.ret != GST_FLOW_OK || !bd.have_buffers) {
     gst_buffer_list_unref (bufferlist);
-    ret = GST_FLOW_OK;
+    ret = bd.ret;
   } else {
     ret = gst_pad_push_list (rtp_mux->srcpad, bufferlist);
   }
@@ -448,34 +549,36 @@ out:
   return ret;
 }
 
-static gboolean
-resend_events (GstPad * pad, GstEvent ** event, gpointer user_data)
-{
-  GstRTPMux *rtp_mux = user_data;
-
-  if (GST_EVENT_TYPE (*event) == GST_EVENT_CAPS) {
-    GstCaps *caps;
-
-    gst_event_parse_caps (*event, &caps);
-    gst_rtp_mux_setcaps (pad, rtp_mux, caps);
-  } else {
-    gst_pad_push_event (rtp_mux->srcpad, gst_event_ref (*event));
-  }
-
-  return TRUE;
-}
-
 static GstFlowReturn
 gst_rtp_mux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstRTPMux *rtp_mux;
+  GstRTPMuxClass *klass;
   GstFlowReturn ret;
   GstRTPMuxPadPrivate *padpriv;
-  gboolean drop;
+  gboolean drop = FALSE;
   gboolean changed = FALSE;
-  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
 
   rtp_mux = GST_RTP_MUX (GST_OBJECT_PARENT (pad));
+  klass = GST_RTP_MUX_GET_CLASS (rtp_mux);
+
+  /* does not copy when we hold the only reference */
+  buffer = gst_buffer_make_writable (buffer);
+
+  if (gst_rtp_mux_can_skip_lock (rtp_mux, pad)) {
+    padpriv = gst_pad_get_element_private (pad);
+    if (!padpriv) {
+      gst_buffer_unref (buffer);
+      return GST_FLOW_NOT_LINKED;
+    }
+
+    if (!gst_rtp_mux_stamp_buffer (rtp_mux, padpriv, buffer))
+      goto invalid_buffer;
+
+    update_last_stop (rtp_mux, buffer);
+
+    return gst_pad_push (rtp_mux->srcpad, buffer);
+  }
 
   GST_OBJECT_LOCK (rtp_mux);
   padpriv = gst_pad_get_element_private (pad);
@@ -486,32 +589,17 @@ gst_rtp_mux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     return GST_FLOW_NOT_LINKED;
   }
 
-  buffer = gst_buffer_make_writable (buffer);
-
-  if (!gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtpbuffer)) {
-    GST_OBJECT_UNLOCK (rtp_mux);
-    gst_buffer_unref (buffer);
-    GST_ERROR_OBJECT (rtp_mux, "Invalid RTP buffer");
-    return GST_FLOW_ERROR;
-  }
-
-  drop = !process_buffer_locked (rtp_mux, padpriv, &rtpbuffer);
-
-  gst_rtp_buffer_unmap (&rtpbuffer);
+  if (klass->accept_buffer_locked)
+    drop = !klass->accept_buffer_locked (rtp_mux, padpriv, buffer);
 
   if (!drop) {
-    if (pad != rtp_mux->last_pad) {
-      changed = TRUE;
-      g_clear_object (&rtp_mux->last_pad);
-      rtp_mux->last_pad = g_object_ref (pad);
+    if (!gst_rtp_mux_stamp_buffer (rtp_mux, padpriv, buffer)) {
+      GST_OBJECT_UNLOCK (rtp_mux);
+      goto invalid_buffer;
     }
 
-    if (GST_BUFFER_DURATION_IS_VALID (buffer) &&
-        GST_BUFFER_TIMESTAMP_IS_VALID (buffer))
-      rtp_mux->last_stop = GST_BUFFER_TIMESTAMP (buffer) +
-          GST_BUFFER_DURATION (buffer);
-    else
-      rtp_mux->last_stop = GST_CLOCK_TIME_NONE;
+    changed = !update_last_pad_locked (rtp_mux, pad);
+    update_last_stop (rtp_mux, buffer);
   }
 
   GST_OBJECT_UNLOCK (rtp_mux);
@@ -527,6 +615,13 @@ gst_rtp_mux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   }
 
   return ret;
+
+invalid_buffer:
+  {
+    gst_buffer_unref (buffer);
+    GST_ERROR_OBJECT (rtp_mux, "Invalid RTP buffer");
+    return GST_FLOW_ERROR;
+  }
 }
 
 static gboolean
@@ -725,9 +820,7 @@ gst_rtp_mux_get_property (GObject * object,
       g_value_set_int (value, rtp_mux->seqnum_offset);
       break;
     case PROP_SEQNUM:
-      GST_OBJECT_LOCK (rtp_mux);
-      g_value_set_uint (value, rtp_mux->seqnum);
-      GST_OBJECT_UNLOCK (rtp_mux);
+      g_value_set_uint (value, (guint16) g_atomic_int_get (&rtp_mux->seqnum));
       break;
     case PROP_SSRC:
       g_value_set_uint (value, rtp_mux->ssrc);
@@ -68,7 +68,7 @@ struct _GstRTPMux
 
   gint32 ts_offset;
   gint16 seqnum_offset;
-  guint16 seqnum;               /* protected by object lock */
+  gint seqnum;                  /* updated atomically */
   guint ssrc;
   guint current_ssrc;
 
@@ -83,7 +83,7 @@ struct _GstRTPMuxClass
   GstElementClass parent_class;
 
   gboolean (*accept_buffer_locked) (GstRTPMux *rtp_mux,
-      GstRTPMuxPadPrivate * padpriv, GstRTPBuffer * buffer);
+      GstRTPMuxPadPrivate * padpriv, GstBuffer * buffer);
 
   gboolean (*src_event) (GstRTPMux *rtp_mux, GstEvent *event);
 };
@@ -296,17 +296,11 @@ gst_rtp_pt_demux_clear_pt_map (GstRtpPtDemux * rtpdemux)
 static gboolean
 need_caps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
-  GSList *walk;
   gboolean ret = FALSE;
 
   GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
-
-    if (pad->pt == pt) {
-      ret = pad->newcaps;
-    }
-  }
+  if (rtpdemux->pads[pt])
+    ret = rtpdemux->pads[pt]->newcaps;
   GST_OBJECT_UNLOCK (rtpdemux);
 
   return ret;
@@ -316,17 +310,9 @@ need_caps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 static void
 clear_newcaps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
-  GSList *walk;
-
   GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
-
-    if (pad->pt == pt) {
-      pad->newcaps = FALSE;
-      break;
-    }
-  }
+  if (rtpdemux->pads[pt])
+    rtpdemux->pads[pt]->newcaps = FALSE;
   GST_OBJECT_UNLOCK (rtpdemux);
 }
 
@@ -350,6 +336,7 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   guint8 pt;
   GstPad *srcpad;
   GstCaps *caps;
+  gboolean newcaps;
   GstRTPBuffer rtp = { NULL };
 
   rtpdemux = GST_RTP_PT_DEMUX (parent);
@@ -362,7 +349,18 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   GST_DEBUG_OBJECT (rtpdemux, "received buffer for pt %d", pt);
 
-  srcpad = find_pad_for_pt (rtpdemux, pt);
+  /* the pad and whether it needs new caps are looked up together, packets of
+   * known payload types don't do any other work before they are pushed */
+  GST_OBJECT_LOCK (rtpdemux);
+  if (rtpdemux->pads[pt]) {
+    srcpad = gst_object_ref (rtpdemux->pads[pt]->pad);
+    newcaps = rtpdemux->pads[pt]->newcaps;
+  } else {
+    srcpad = NULL;
+    newcaps = FALSE;
+  }
+  GST_OBJECT_UNLOCK (rtpdemux);
+
   if (srcpad == NULL) {
     /* new PT, create a src pad */
     GstRtpPtDemuxPad *rtpdemuxpad;
@@ -390,6 +388,7 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     gst_object_ref (srcpad);
     GST_OBJECT_LOCK (rtpdemux);
     rtpdemux->srcpads = g_slist_append (rtpdemux->srcpads, rtpdemuxpad);
+    rtpdemux->pads[pt] = rtpdemuxpad;
     GST_OBJECT_UNLOCK (rtpdemux);
 
     gst_pad_set_active (srcpad, TRUE);
@@ -426,7 +425,7 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
         gst_rtp_pt_demux_signals[SIGNAL_PAYLOAD_TYPE_CHANGE], 0, emit_pt);
   }
 
-  while (need_caps_for_pt (rtpdemux, pt)) {
+  while (newcaps) {
     GST_DEBUG ("need new caps for %d", pt);
     caps = gst_rtp_pt_demux_get_caps (rtpdemux, pt);
     if (!caps)
@@ -438,6 +437,9 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     gst_caps_set_simple (caps, "payload", G_TYPE_INT, pt, NULL);
     gst_pad_set_caps (srcpad, caps);
     gst_caps_unref (caps);
+
+    /* the pt map could have been cleared again meanwhile */
+    newcaps = need_caps_for_pt (rtpdemux, pt);
   }
 
   /* push to srcpad */
@@ -471,17 +473,14 @@ static GstPad *
 find_pad_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
   GstPad *respad = NULL;
-  GSList *walk;
 
-  GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
+  /* last_pt is 0xFFFF before the first packet */
+  if (pt >= G_N_ELEMENTS (rtpdemux->pads))
+    return NULL;
 
-    if (pad->pt == pt) {
-      respad = gst_object_ref (pad->pad);
-      break;
-    }
-  }
+  GST_OBJECT_LOCK (rtpdemux);
+  if (rtpdemux->pads[pt])
+    respad = gst_object_ref (rtpdemux->pads[pt]->pad);
   GST_OBJECT_UNLOCK (rtpdemux);
 
   return respad;
@@ -583,6 +582,7 @@ static gboolean
 gst_rtp_pt_demux_setup (GstRtpPtDemux * ptdemux)
 {
   ptdemux->srcpads = NULL;
+  memset (ptdemux->pads, 0, sizeof (ptdemux->pads));
   ptdemux->last_pt = 0xFFFF;
 
   return TRUE;
@@ -600,6 +600,7 @@ gst_rtp_pt_demux_release (GstRtpPtDemux * ptdemux)
   GST_OBJECT_LOCK (ptdemux);
   tmppads = ptdemux->srcpads;
   ptdemux->srcpads = NULL;
+  memset (ptdemux->pads, 0, sizeof (ptdemux->pads));
   GST_OBJECT_UNLOCK (ptdemux);
 
   for (walk = tmppads; walk; walk = g_slist_next (walk)) {
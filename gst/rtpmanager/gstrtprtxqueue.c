@@ -22,6 +22,16 @@
 
 /**
  * SECTION:element-rtprtxqueue
+ *
+ * rtprtxqueue keeps the last sent RTP packets and pushes them again when an
+ * upstream GstRTPRetransmissionRequest event is received for their seqnum.
+ * Packets are found with a seqnum index, so the cost of a request does not
+ * depend on the size of the queue. The queue can be bounded in packets, in
+ * bytes and in time, the latter uses the clock-rate from the caps.
+ *
+ * Besides the requested "seqnum", the event can contain a "blp" field with
+ * the bitmask of following lost packets as in the generic NACK of RFC 4585.
+ * All the packets of such a request are then looked up at once.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -39,12 +49,14 @@ GST_DEBUG_CATEGORY_STATIC (gst_rtp_rtx_queue_debug);
 
 #define DEFAULT_MAX_SIZE_TIME    0
 #define DEFAULT_MAX_SIZE_PACKETS 100
+#define DEFAULT_MAX_SIZE_BYTES   0
 
 enum
 {
   PROP_0,
   PROP_MAX_SIZE_TIME,
   PROP_MAX_SIZE_PACKETS,
+  PROP_MAX_SIZE_BYTES,
   PROP_LAST
 };
 
@@ -62,6 +74,8 @@ static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
 
 static gboolean gst_rtp_rtx_queue_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_rtp_rtx_queue_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
 static GstFlowReturn gst_rtp_rtx_queue_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 
@@ -100,6 +114,18 @@ gst_rtp_rtx_queue_class_init (GstRTPRtxQueueClass * klass)
           DEFAULT_MAX_SIZE_PACKETS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRTPRtxQueue:max-size-bytes:
+   *
+   * Amount of bytes to queue.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_BYTES,
+      g_param_spec_uint ("max-size-bytes", "Max Size Bytes",
+          "Amount of bytes to queue (0 = unlimited)", 0, G_MAXUINT,
+          DEFAULT_MAX_SIZE_BYTES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -118,8 +144,7 @@ static void
 gst_rtp_rtx_queue_reset (GstRTPRtxQueue * rtx, gboolean full)
 {
   g_mutex_lock (&rtx->lock);
-  g_queue_foreach (rtx->queue, (GFunc) gst_buffer_unref, NULL);
-  g_queue_clear (rtx->queue);
+  rtp_packet_history_clear (rtx->history);
   g_list_foreach (rtx->pending, (GFunc) gst_buffer_unref, NULL);
   g_list_free (rtx->pending);
   rtx->pending = NULL;
@@ -132,7 +157,7 @@ gst_rtp_rtx_queue_finalize (GObject * object)
   GstRTPRtxQueue *rtx = GST_RTP_RTX_QUEUE (object);
 
   gst_rtp_rtx_queue_reset (rtx, TRUE);
-  g_queue_free (rtx->queue);
+  rtp_packet_history_free (rtx->history);
   g_mutex_clear (&rtx->lock);
 
   G_OBJECT_CLASS (gst_rtp_rtx_queue_parent_class)->finalize (object);
@@ -157,45 +182,37 @@ gst_rtp_rtx_queue_init (GstRTPRtxQueue * rtx)
           "sink"), "sink");
   GST_PAD_SET_PROXY_CAPS (rtx->sinkpad);
   GST_PAD_SET_PROXY_ALLOCATION (rtx->sinkpad);
+  gst_pad_set_event_function (rtx->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_queue_sink_event));
   gst_pad_set_chain_function (rtx->sinkpad,
       GST_DEBUG_FUNCPTR (gst_rtp_rtx_queue_chain));
   gst_element_add_pad (GST_ELEMENT (rtx), rtx->sinkpad);
 
-  rtx->queue = g_queue_new ();
+  rtx->history = rtp_packet_history_new ();
   g_mutex_init (&rtx->lock);
 
   rtx->max_size_time = DEFAULT_MAX_SIZE_TIME;
   rtx->max_size_packets = DEFAULT_MAX_SIZE_PACKETS;
+  rtx->max_size_bytes = DEFAULT_MAX_SIZE_BYTES;
+  rtp_packet_history_set_max_time (rtx->history, rtx->max_size_time);
+  rtp_packet_history_set_max_packets (rtx->history, rtx->max_size_packets);
+  rtp_packet_history_set_max_bytes (rtx->history, rtx->max_size_bytes);
 }
 
-typedef struct
-{
-  GstRTPRtxQueue *rtx;
-  guint seqnum;
-  gboolean found;
-} RTXData;
-
+/* call with rtx->lock */
 static void
-push_seqnum (GstBuffer * buffer, RTXData * data)
+push_seqnum (GstRTPRtxQueue * rtx, guint16 seqnum)
 {
-  GstRTPRtxQueue *rtx = data->rtx;
-  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
-  guint16 seqnum;
-
-  if (data->found)
-    return;
+  GstBuffer *buffer;
 
-  if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtpbuffer))
+  buffer = rtp_packet_history_lookup (rtx->history, seqnum);
+  if (buffer == NULL) {
+    GST_DEBUG_OBJECT (rtx, "%d not in queue", seqnum);
     return;
-
-  seqnum = gst_rtp_buffer_get_seq (&rtpbuffer);
-  gst_rtp_buffer_unmap (&rtpbuffer);
-
-  if (seqnum == data->seqnum) {
-    data->found = TRUE;
-    GST_DEBUG_OBJECT (rtx, "found %d", seqnum);
-    rtx->pending = g_list_prepend (rtx->pending, gst_buffer_ref (buffer));
   }
+
+  GST_DEBUG_OBJECT (rtx, "found %d", seqnum);
+  rtx->pending = g_list_prepend (rtx->pending, buffer);
 }
 
 static gboolean
@@ -211,20 +228,23 @@ gst_rtp_rtx_queue_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
       s = gst_event_get_structure (event);
       if (gst_structure_has_name (s, "GstRTPRetransmissionRequest")) {
-        guint seqnum;
-        RTXData data;
+        guint seqnum, blp;
 
-        if (!gst_structure_get_uint (s, "seqnum", &seqnum))
-          seqnum = -1;
+        if (!gst_structure_get_uint (s, "blp", &blp))
+          blp = 0;
 
-        GST_DEBUG_OBJECT (rtx, "request %d", seqnum);
+        if (gst_structure_get_uint (s, "seqnum", &seqnum)) {
+          GST_DEBUG_OBJECT (rtx, "request %d, blp 0x%04x", seqnum, blp);
 
-        g_mutex_lock (&rtx->lock);
-        data.rtx = rtx;
-        data.seqnum = seqnum;
-        data.found = FALSE;
-        g_queue_foreach (rtx->queue, (GFunc) push_seqnum, &data);
-        g_mutex_unlock (&rtx->lock);
+          g_mutex_lock (&rtx->lock);
+          push_seqnum (rtx, seqnum);
+          for (; blp; blp >>= 1) {
+            seqnum++;
+            if (blp & 1)
+              push_seqnum (rtx, seqnum);
+          }
+          g_mutex_unlock (&rtx->lock);
+        }
 
         gst_event_unref (event);
         res = TRUE;
@@ -240,6 +260,37 @@ gst_rtp_rtx_queue_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+static gboolean
+gst_rtp_rtx_queue_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRTPRtxQueue *rtx = GST_RTP_RTX_QUEUE (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      GstStructure *s;
+      gint clock_rate;
+
+      gst_event_parse_caps (event, &caps);
+      s = gst_caps_get_structure (caps, 0);
+      if (!gst_structure_get_int (s, "clock-rate", &clock_rate))
+        clock_rate = -1;
+
+      GST_DEBUG_OBJECT (rtx, "got clock-rate from caps: %d", clock_rate);
+
+      g_mutex_lock (&rtx->lock);
+      rtp_packet_history_set_clock_rate (rtx->history, clock_rate);
+      g_mutex_unlock (&rtx->lock);
+      break;
+    }
+    default:
+      break;
+  }
+  return gst_pad_event_default (pad, parent, event);
+}
+
 static void
 do_push (GstBuffer * buffer, GstRTPRtxQueue * rtx)
 {
@@ -250,20 +301,29 @@ static GstFlowReturn
 gst_rtp_rtx_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstRTPRtxQueue *rtx;
+  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
+  gboolean valid;
+  guint16 seqnum = 0;
+  guint32 rtptime = 0;
   GstFlowReturn ret;
   GList *pending;
 
   rtx = GST_RTP_RTX_QUEUE (parent);
 
-  g_mutex_lock (&rtx->lock);
-  g_queue_push_head (rtx->queue, gst_buffer_ref (buffer));
-
-  if (rtx->max_size_packets) {
-    while (g_queue_get_length (rtx->queue) > rtx->max_size_packets)
-      gst_buffer_unref (g_queue_pop_tail (rtx->queue));
+  valid = gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtpbuffer);
+  if (valid) {
+    seqnum = gst_rtp_buffer_get_seq (&rtpbuffer);
+    rtptime = gst_rtp_buffer_get_timestamp (&rtpbuffer);
+    gst_rtp_buffer_unmap (&rtpbuffer);
   }
 
-  pending = rtx->pending;
+  g_mutex_lock (&rtx->lock);
+  if (valid)
+    rtp_packet_history_add (rtx->history, gst_buffer_ref (buffer), seqnum,
+        rtptime);
+
+  /* push in the order of the requests */
+  pending = g_list_reverse (rtx->pending);
   rtx->pending = NULL;
   g_mutex_unlock (&rtx->lock);
 
@@ -288,6 +348,9 @@ gst_rtp_rtx_queue_get_property (GObject * object,
     case PROP_MAX_SIZE_PACKETS:
       g_value_set_uint (value, rtx->max_size_packets);
       break;
+    case PROP_MAX_SIZE_BYTES:
+      g_value_set_uint (value, rtx->max_size_bytes);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -302,10 +365,22 @@ gst_rtp_rtx_queue_set_property (GObject * object,
 
   switch (prop_id) {
     case PROP_MAX_SIZE_TIME:
+      g_mutex_lock (&rtx->lock);
       rtx->max_size_time = g_value_get_uint (value);
+      rtp_packet_history_set_max_time (rtx->history, rtx->max_size_time);
+      g_mutex_unlock (&rtx->lock);
       break;
     case PROP_MAX_SIZE_PACKETS:
+      g_mutex_lock (&rtx->lock);
       rtx->max_size_packets = g_value_get_uint (value);
+      rtp_packet_history_set_max_packets (rtx->history, rtx->max_size_packets);
+      g_mutex_unlock (&rtx->lock);
+      break;
+    case PROP_MAX_SIZE_BYTES:
+      g_mutex_lock (&rtx->lock);
+      rtx->max_size_bytes = g_value_get_uint (value);
+      rtp_packet_history_set_max_bytes (rtx->history, rtx->max_size_bytes);
+      g_mutex_unlock (&rtx->lock);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -29,6 +29,8 @@
 #include <gst/gst.h>
 #include <gst/rtp/gstrtpbuffer.h>
 
+#include "rtppackethistory.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_RTP_RTX_QUEUE (gst_rtp_rtx_queue_get_type())
 #define GST_RTP_RTX_QUEUE(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_RTX_QUEUE, GstRTPRtxQueue))
@@ -53,11 +55,12 @@ struct _GstRTPRtxQueue
   GstPad *srcpad;
 
   GMutex lock;
-  GQueue *queue;
+  RTPPacketHistory *history;
   GList *pending;
 
   guint max_size_time;
   guint max_size_packets;
+  guint max_size_bytes;
 };
 
 struct _GstRTPRtxQueueClass
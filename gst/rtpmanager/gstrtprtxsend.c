@@ -45,6 +45,7 @@
 #include <stdlib.h>
 
 #include "gstrtprtxsend.h"
+#include "rtppackethistory.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtp_rtx_send_debug);
 #define GST_CAT_DEFAULT gst_rtp_rtx_send_debug
@@ -52,6 +53,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_rtp_rtx_send_debug);
 #define DEFAULT_RTX_PAYLOAD_TYPE 0
 #define DEFAULT_MAX_SIZE_TIME    0
 #define DEFAULT_MAX_SIZE_PACKETS 100
+#define DEFAULT_MAX_SIZE_BYTES   0
 
 enum
 {
@@ -60,6 +62,7 @@ enum
   PROP_PAYLOAD_TYPE_MAP,
   PROP_MAX_SIZE_TIME,
   PROP_MAX_SIZE_PACKETS,
+  PROP_MAX_SIZE_BYTES,
   PROP_NUM_RTX_REQUESTS,
   PROP_NUM_RTX_PACKETS,
   PROP_LAST
@@ -95,20 +98,6 @@ static void gst_rtp_rtx_send_finalize (GObject * object);
 
 G_DEFINE_TYPE (GstRtpRtxSend, gst_rtp_rtx_send, GST_TYPE_ELEMENT);
 
-typedef struct
-{
-  guint16 seqnum;
-  guint32 timestamp;
-  GstBuffer *buffer;
-} BufferQueueItem;
-
-static void
-buffer_queue_item_free (BufferQueueItem * item)
-{
-  gst_buffer_unref (item->buffer);
-  g_free (item);
-}
-
 typedef struct
 {
   guint32 rtx_ssrc;
@@ -116,17 +105,20 @@ typedef struct
   gint clock_rate;
 
   /* history of rtp packets */
-  GSequence *queue;
+  RTPPacketHistory *history;
 } SSRCRtxData;
 
 static SSRCRtxData *
-ssrc_rtx_data_new (guint32 rtx_ssrc)
+ssrc_rtx_data_new (GstRtpRtxSend * rtx, guint32 rtx_ssrc)
 {
   SSRCRtxData *data = g_new0 (SSRCRtxData, 1);
 
   data->rtx_ssrc = rtx_ssrc;
   data->next_seqnum = g_random_int_range (0, G_MAXUINT16);
-  data->queue = g_sequence_new ((GDestroyNotify) buffer_queue_item_free);
+  data->history = rtp_packet_history_new ();
+  rtp_packet_history_set_max_time (data->history, rtx->max_size_time);
+  rtp_packet_history_set_max_packets (data->history, rtx->max_size_packets);
+  rtp_packet_history_set_max_bytes (data->history, rtx->max_size_bytes);
 
   return data;
 }
@@ -134,7 +126,7 @@ ssrc_rtx_data_new (guint32 rtx_ssrc)
 static void
 ssrc_rtx_data_free (SSRCRtxData * data)
 {
-  g_sequence_free (data->queue);
+  rtp_packet_history_free (data->history);
   g_free (data);
 }
 
@@ -173,6 +165,18 @@ gst_rtp_rtx_send_class_init (GstRtpRtxSendClass * klass)
           DEFAULT_MAX_SIZE_PACKETS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpRtxSend:max-size-bytes:
+   *
+   * Amount of bytes to queue per SSRC.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_BYTES,
+      g_param_spec_uint ("max-size-bytes", "Max Size Bytes",
+          "Amount of bytes to queue (0 = unlimited)", 0, G_MAXUINT,
+          DEFAULT_MAX_SIZE_BYTES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_NUM_RTX_REQUESTS,
       g_param_spec_uint ("num-rtx-requests", "Num RTX Requests",
           "Number of retransmission events received", 0, G_MAXUINT,
@@ -265,6 +269,7 @@ gst_rtp_rtx_send_init (GstRtpRtxSend * rtx)
 
   rtx->max_size_time = DEFAULT_MAX_SIZE_TIME;
   rtx->max_size_packets = DEFAULT_MAX_SIZE_PACKETS;
+  rtx->max_size_bytes = DEFAULT_MAX_SIZE_BYTES;
 }
 
 static guint32
@@ -299,7 +304,7 @@ gst_rtp_rtx_send_get_ssrc_data (GstRtpRtxSend * rtx, guint32 ssrc)
       g_free (ssrc_str);
     }
     rtx_ssrc = gst_rtp_rtx_send_choose_ssrc (rtx, rtx_ssrc, consider);
-    data = ssrc_rtx_data_new (rtx_ssrc);
+    data = ssrc_rtx_data_new (rtx, rtx_ssrc);
     g_hash_table_insert (rtx->ssrc_data, GUINT_TO_POINTER (ssrc), data);
     g_hash_table_insert (rtx->rtx_ssrcs, GUINT_TO_POINTER (rtx_ssrc),
         GUINT_TO_POINTER (ssrc));
@@ -309,16 +314,6 @@ gst_rtp_rtx_send_get_ssrc_data (GstRtpRtxSend * rtx, guint32 ssrc)
   return data;
 }
 
-static gint
-buffer_queue_items_cmp (BufferQueueItem * a, BufferQueueItem * b,
-    gpointer user_data)
-{
-  /* gst_rtp_buffer_compare_seqnum returns the opposite of what we want,
-   * it returns negative when seqnum1 > seqnum2 and we want negative
-   * when b > a, i.e. a is smaller, so it comes first in the sequence */
-  return gst_rtp_buffer_compare_seqnum (b->seqnum, a->seqnum);
-}
-
 static gboolean
 gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -351,21 +346,17 @@ gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         /* check if request is for us */
         if (g_hash_table_contains (rtx->ssrc_data, GUINT_TO_POINTER (ssrc))) {
           SSRCRtxData *data;
-          GSequenceIter *iter;
-          BufferQueueItem search_item;
+          GstBuffer *buffer;
 
           /* update statistics */
           ++rtx->num_rtx_requests;
 
           data = gst_rtp_rtx_send_get_ssrc_data (rtx, ssrc);
 
-          search_item.seqnum = seqnum;
-          iter = g_sequence_lookup (data->queue, &search_item,
-              (GCompareDataFunc) buffer_queue_items_cmp, NULL);
-          if (iter) {
-            BufferQueueItem *item = g_sequence_get (iter);
-            GST_DEBUG_OBJECT (rtx, "found %" G_GUINT16_FORMAT, item->seqnum);
-            g_queue_push_tail (rtx->pending, gst_buffer_ref (item->buffer));
+          buffer = rtp_packet_history_lookup (data->history, seqnum);
+          if (buffer) {
+            GST_DEBUG_OBJECT (rtx, "found %" G_GUINT16_FORMAT, seqnum);
+            g_queue_push_tail (rtx->pending, buffer);
           }
         }
         g_mutex_unlock (&rtx->lock);
@@ -456,6 +447,7 @@ gst_rtp_rtx_send_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_structure_get_uint (s, "ssrc", &ssrc);
       data = gst_rtp_rtx_send_get_ssrc_data (rtx, ssrc);
       gst_structure_get_int (s, "clock-rate", &data->clock_rate);
+      rtp_packet_history_set_clock_rate (data->history, data->clock_rate);
 
       GST_DEBUG_OBJECT (rtx, "got clock-rate from caps: %d for ssrc: %u",
           data->clock_rate, ssrc);
@@ -484,36 +476,6 @@ structure_to_hash_table (GQuark field_id, const GValue * value, gpointer hash)
   return TRUE;
 }
 
-/* like rtp_jitter_buffer_get_ts_diff() */
-static guint32
-gst_rtp_rtx_send_get_ts_diff (SSRCRtxData * data)
-{
-  guint64 high_ts, low_ts;
-  BufferQueueItem *high_buf, *low_buf;
-  guint32 result;
-
-  high_buf =
-      g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter
-          (data->queue)));
-  low_buf = g_sequence_get (g_sequence_get_begin_iter (data->queue));
-
-  if (!high_buf || !low_buf || high_buf == low_buf)
-    return 0;
-
-  high_ts = high_buf->timestamp;
-  low_ts = low_buf->timestamp;
-
-  /* it needs to work if ts wraps */
-  if (high_ts >= low_ts) {
-    result = (guint32) (high_ts - low_ts);
-  } else {
-    result = (guint32) (high_ts + G_MAXUINT32 + 1 - low_ts);
-  }
-
-  /* return value in ms instead of clock ticks */
-  return (guint32) gst_util_uint64_scale_int (result, 1000, data->clock_rate);
-}
-
 /* Copy fixed header and extension. Add OSN before to copy payload
  * Copy memory to avoid to manually copy each rtp buffer field.
  */
@@ -604,7 +566,6 @@ gst_rtp_rtx_send_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstFlowReturn ret = GST_FLOW_ERROR;
   GQueue *pending = NULL;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  BufferQueueItem *item;
   SSRCRtxData *data;
   guint16 seqnum;
   guint8 payload_type;
@@ -632,22 +593,10 @@ gst_rtp_rtx_send_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   if (g_hash_table_contains (rtx->rtx_pt_map, GUINT_TO_POINTER (payload_type))) {
     data = gst_rtp_rtx_send_get_ssrc_data (rtx, ssrc);
 
-    /* add current rtp buffer to queue history */
-    item = g_new0 (BufferQueueItem, 1);
-    item->seqnum = seqnum;
-    item->timestamp = rtptime;
-    item->buffer = gst_buffer_ref (buffer);
-    g_sequence_append (data->queue, item);
-
-    /* remove oldest packets from history if they are too many */
-    if (rtx->max_size_packets) {
-      while (g_sequence_get_length (data->queue) > rtx->max_size_packets)
-        g_sequence_remove (g_sequence_get_begin_iter (data->queue));
-    }
-    if (rtx->max_size_time) {
-      while (gst_rtp_rtx_send_get_ts_diff (data) > rtx->max_size_time)
-        g_sequence_remove (g_sequence_get_begin_iter (data->queue));
-    }
+    /* add current rtp buffer to queue history, this removes the oldest
+     * packets when there are too many */
+    rtp_packet_history_add (data->history, gst_buffer_ref (buffer), seqnum,
+        rtptime);
   }
 
   /* within lock, get packets that have to be retransmited */
@@ -700,6 +649,11 @@ gst_rtp_rtx_send_get_property (GObject * object,
       g_value_set_uint (value, rtx->max_size_packets);
       g_mutex_unlock (&rtx->lock);
       break;
+    case PROP_MAX_SIZE_BYTES:
+      g_mutex_lock (&rtx->lock);
+      g_value_set_uint (value, rtx->max_size_bytes);
+      g_mutex_unlock (&rtx->lock);
+      break;
     case PROP_NUM_RTX_REQUESTS:
       g_mutex_lock (&rtx->lock);
       g_value_set_uint (value, rtx->num_rtx_requests);
@@ -716,6 +670,14 @@ gst_rtp_rtx_send_get_property (GObject * object,
   }
 }
 
+static void
+update_history_limits (gpointer key, SSRCRtxData * data, GstRtpRtxSend * rtx)
+{
+  rtp_packet_history_set_max_time (data->history, rtx->max_size_time);
+  rtp_packet_history_set_max_packets (data->history, rtx->max_size_packets);
+  rtp_packet_history_set_max_bytes (data->history, rtx->max_size_bytes);
+}
+
 static void
 gst_rtp_rtx_send_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
@@ -741,11 +703,22 @@ gst_rtp_rtx_send_set_property (GObject * object,
     case PROP_MAX_SIZE_TIME:
       g_mutex_lock (&rtx->lock);
       rtx->max_size_time = g_value_get_uint (value);
+      g_hash_table_foreach (rtx->ssrc_data, (GHFunc) update_history_limits,
+          rtx);
       g_mutex_unlock (&rtx->lock);
       break;
     case PROP_MAX_SIZE_PACKETS:
       g_mutex_lock (&rtx->lock);
       rtx->max_size_packets = g_value_get_uint (value);
+      g_hash_table_foreach (rtx->ssrc_data, (GHFunc) update_history_limits,
+          rtx);
+      g_mutex_unlock (&rtx->lock);
+      break;
+    case PROP_MAX_SIZE_BYTES:
+      g_mutex_lock (&rtx->lock);
+      rtx->max_size_bytes = g_value_get_uint (value);
+      g_hash_table_foreach (rtx->ssrc_data, (GHFunc) update_history_limits,
+          rtx);
       g_mutex_unlock (&rtx->lock);
       break;
     default:
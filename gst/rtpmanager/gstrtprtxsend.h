@@ -67,6 +67,7 @@ struct _GstRtpRtxSend
   /* buffering control properties */
   guint max_size_time;
   guint max_size_packets;
+  guint max_size_bytes;
 
   /* statistics */
   guint num_rtx_requests;
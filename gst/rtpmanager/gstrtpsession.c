@@ -203,6 +203,10 @@ enum
 #define DEFAULT_USE_PIPELINE_CLOCK   FALSE
 #define DEFAULT_RTCP_MIN_INTERVAL    (RTP_STATS_MIN_INTERVAL * GST_SECOND)
 #define DEFAULT_PROBATION            RTP_DEFAULT_PROBATION
+#define DEFAULT_SHARED_RTCP_THREAD   FALSE
+
+/* worker threads of the RTCP pool that is shared between sessions */
+#define RTCP_POOL_MAX_THREADS        4
 
 enum
 {
@@ -219,6 +223,7 @@ enum
   PROP_RTCP_MIN_INTERVAL,
   PROP_PROBATION,
   PROP_STATS,
+  PROP_SHARED_RTCP_THREAD,
   PROP_LAST
 };
 
@@ -246,6 +251,13 @@ struct _GstRtpSessionPrivate
   gboolean thread_stopped;
   gboolean wait_send;
 
+  /* RTCP scheduled from the shared pool instead of our thread */
+  gboolean shared_rtcp_thread;
+  gboolean rtcp_shared;
+  gboolean rtcp_started;
+  gboolean rtcp_pending;
+  gboolean rtcp_waiting;
+
   /* caps mapping */
   GHashTable *ptmap;
 
@@ -312,6 +324,12 @@ static GstStructure *gst_rtp_session_create_stats (GstRtpSession * rtpsession);
 
 static guint gst_rtp_session_signals[LAST_SIGNAL] = { 0 };
 
+/* the pool that runs the RTCP timeouts of all sessions with
+ * shared-rtcp-thread, the system clock has one thread for the async waits
+ * and the pool threads do the work that might block */
+static GMutex rtcp_pool_lock;
+static GThreadPool *rtcp_pool = NULL;
+
 static void
 on_new_ssrc (RTPSession * session, RTPSource * src, GstRtpSession * sess)
 {
@@ -646,6 +664,23 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
           "Various statistics", GST_TYPE_STRUCTURE,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpSession::shared-rtcp-thread:
+   *
+   * Schedule the RTCP timeouts on the system clock and run them from a
+   * small pool of threads shared by all the sessions of the process
+   * instead of starting one RTCP thread per session. This saves a thread
+   * per session when there are many sessions. Only takes effect the next
+   * time the element goes to PLAYING.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_RTCP_THREAD,
+      g_param_spec_boolean ("shared-rtcp-thread", "Shared RTCP thread",
+          "Run the RTCP timeouts from a thread pool shared between sessions",
+          DEFAULT_SHARED_RTCP_THREAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_rtp_session_change_state);
   gstelement_class->request_new_pad =
@@ -690,6 +725,7 @@ gst_rtp_session_init (GstRtpSession * rtpsession)
   rtpsession->priv->sysclock = gst_system_clock_obtain ();
   rtpsession->priv->session = rtp_session_new ();
   rtpsession->priv->use_pipeline_clock = DEFAULT_USE_PIPELINE_CLOCK;
+  rtpsession->priv->shared_rtcp_thread = DEFAULT_SHARED_RTCP_THREAD;
 
   /* configure callbacks */
   rtp_session_set_callbacks (rtpsession->priv->session, &callbacks, rtpsession);
@@ -777,6 +813,11 @@ gst_rtp_session_set_property (GObject * object, guint prop_id,
     case PROP_PROBATION:
       g_object_set_property (G_OBJECT (priv->session), "probation", value);
       break;
+    case PROP_SHARED_RTCP_THREAD:
+      GST_RTP_SESSION_LOCK (rtpsession);
+      priv->shared_rtcp_thread = g_value_get_boolean (value);
+      GST_RTP_SESSION_UNLOCK (rtpsession);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -831,6 +872,11 @@ gst_rtp_session_get_property (GObject * object, guint prop_id,
     case PROP_PROBATION:
       g_object_get_property (G_OBJECT (priv->session), "probation", value);
       break;
+    case PROP_SHARED_RTCP_THREAD:
+      GST_RTP_SESSION_LOCK (rtpsession);
+      g_value_set_boolean (value, priv->shared_rtcp_thread);
+      GST_RTP_SESSION_UNLOCK (rtpsession);
+      break;
     case PROP_STATS:
       g_value_take_boxed (value, gst_rtp_session_create_stats (rtpsession));
       break;
@@ -974,6 +1020,130 @@ rtcp_thread (GstRtpSession * rtpsession)
   GST_DEBUG_OBJECT (rtpsession, "leaving RTCP thread");
 }
 
+/* queue a job for the session in the shared pool, called with the session
+ * lock. There is at most one job per session so that the timeouts of a
+ * session never run concurrently, a job that is already queued or running
+ * computes a new timeout anyway */
+static void
+rtcp_shared_push (GstRtpSession * rtpsession)
+{
+  if (rtpsession->priv->rtcp_pending)
+    return;
+
+  rtpsession->priv->rtcp_pending = TRUE;
+  g_thread_pool_push (rtcp_pool, gst_object_ref (rtpsession), NULL);
+}
+
+/* called from the system clock thread when the RTCP timeout expired, the
+ * pool runs the timeout because it might block */
+static gboolean
+rtcp_shared_wakeup (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstRtpSession *rtpsession = user_data;
+
+  GST_RTP_SESSION_LOCK (rtpsession);
+  rtcp_shared_push (rtpsession);
+  GST_RTP_SESSION_UNLOCK (rtpsession);
+
+  return TRUE;
+}
+
+/* runs in the shared pool, this is one iteration of rtcp_thread(). Every
+ * job holds a ref to the session */
+static void
+rtcp_shared_func (GstRtpSession * rtpsession, gpointer user_data)
+{
+  GstRtpSessionPrivate *priv = rtpsession->priv;
+  GstClockTime current_time;
+  GstClockTime next_timeout;
+  guint64 ntpnstime;
+  GstClockTime running_time;
+  RTPSession *session;
+
+  GST_RTP_SESSION_LOCK (rtpsession);
+  if (priv->id) {
+    gst_clock_id_unref (priv->id);
+    priv->id = NULL;
+  }
+  if (priv->stop_thread)
+    goto stopped;
+
+  if (priv->wait_send) {
+    /* the RTP thread schedules us again when it sent the first packet */
+    GST_LOG_OBJECT (rtpsession, "waiting for RTP thread");
+    priv->rtcp_waiting = TRUE;
+    priv->rtcp_pending = FALSE;
+    GST_RTP_SESSION_UNLOCK (rtpsession);
+    gst_object_unref (rtpsession);
+    return;
+  }
+
+  session = priv->session;
+  current_time = gst_clock_get_time (priv->sysclock);
+
+  if (!priv->rtcp_started) {
+    GST_DEBUG_OBJECT (rtpsession, "starting at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (current_time));
+    session->start_time = current_time;
+    priv->rtcp_started = TRUE;
+  } else {
+    get_current_times (rtpsession, &running_time, &ntpnstime);
+
+    GST_DEBUG_OBJECT (rtpsession, "timeout at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (current_time));
+
+    /* perform actions, release lock because it might push. */
+    GST_RTP_SESSION_UNLOCK (rtpsession);
+    rtp_session_on_timeout (session, current_time, ntpnstime, running_time);
+    GST_RTP_SESSION_LOCK (rtpsession);
+
+    if (priv->stop_thread)
+      goto stopped;
+  }
+
+  next_timeout = rtp_session_next_timeout (session, current_time);
+
+  GST_DEBUG_OBJECT (rtpsession, "next check time %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (next_timeout));
+
+  /* leave if no more timeouts, the session ended */
+  if (next_timeout == GST_CLOCK_TIME_NONE)
+    goto stopped;
+
+  priv->id = gst_clock_new_single_shot_id (priv->sysclock, next_timeout);
+  gst_clock_id_wait_async (priv->id, rtcp_shared_wakeup,
+      gst_object_ref (rtpsession), (GDestroyNotify) gst_object_unref);
+  priv->rtcp_pending = FALSE;
+  GST_RTP_SESSION_UNLOCK (rtpsession);
+
+  gst_object_unref (rtpsession);
+  return;
+
+stopped:
+  {
+    GST_DEBUG_OBJECT (rtpsession, "leaving shared RTCP scheduling");
+    priv->thread_stopped = TRUE;
+    priv->rtcp_pending = FALSE;
+    GST_RTP_SESSION_SIGNAL (rtpsession);
+    GST_RTP_SESSION_UNLOCK (rtpsession);
+    gst_object_unref (rtpsession);
+    return;
+  }
+}
+
+static GThreadPool *
+rtcp_shared_pool_get (GError ** error)
+{
+  g_mutex_lock (&rtcp_pool_lock);
+  if (rtcp_pool == NULL)
+    rtcp_pool = g_thread_pool_new ((GFunc) rtcp_shared_func, NULL,
+        RTCP_POOL_MAX_THREADS, FALSE, error);
+  g_mutex_unlock (&rtcp_pool_lock);
+
+  return rtcp_pool;
+}
+
 static gboolean
 start_rtcp_thread (GstRtpSession * rtpsession)
 {
@@ -984,7 +1154,24 @@ start_rtcp_thread (GstRtpSession * rtpsession)
 
   GST_RTP_SESSION_LOCK (rtpsession);
   rtpsession->priv->stop_thread = FALSE;
-  if (rtpsession->priv->thread_stopped) {
+  if (rtpsession->priv->thread_stopped &&
+      rtpsession->priv->shared_rtcp_thread) {
+    GThreadPool *pool;
+
+    if (rtpsession->priv->thread) {
+      g_thread_join (rtpsession->priv->thread);
+      rtpsession->priv->thread = NULL;
+    }
+    if ((pool = rtcp_shared_pool_get (&error))) {
+      GST_DEBUG_OBJECT (rtpsession, "scheduling RTCP from the shared pool");
+      rtpsession->priv->rtcp_shared = TRUE;
+      rtpsession->priv->rtcp_started = FALSE;
+      rtpsession->priv->rtcp_waiting = FALSE;
+      rtpsession->priv->thread_stopped = FALSE;
+      rtcp_shared_push (rtpsession);
+    }
+  } else if (rtpsession->priv->thread_stopped) {
+    rtpsession->priv->rtcp_shared = FALSE;
     /* if the thread stopped, and we still have a handle to the thread, join it
      * now. We can safely join with the lock held, the thread will not take it
      * anymore. */
@@ -1019,6 +1206,11 @@ stop_rtcp_thread (GstRtpSession * rtpsession)
   GST_RTP_SESSION_SIGNAL (rtpsession);
   if (rtpsession->priv->id)
     gst_clock_id_unschedule (rtpsession->priv->id);
+  /* an unscheduled async wait does not call us back, let a job notice */
+  if (rtpsession->priv->rtcp_shared && !rtpsession->priv->thread_stopped) {
+    rtpsession->priv->rtcp_waiting = FALSE;
+    rtcp_shared_push (rtpsession);
+  }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 }
 
@@ -1026,8 +1218,13 @@ static void
 join_rtcp_thread (GstRtpSession * rtpsession)
 {
   GST_RTP_SESSION_LOCK (rtpsession);
-  /* don't try to join when we have no thread */
-  if (rtpsession->priv->thread != NULL) {
+  if (rtpsession->priv->rtcp_shared) {
+    /* wait for the pool to run the last job of this session */
+    GST_DEBUG_OBJECT (rtpsession, "waiting for shared RTCP scheduling");
+    while (!rtpsession->priv->thread_stopped)
+      GST_RTP_SESSION_WAIT (rtpsession);
+  } else if (rtpsession->priv->thread != NULL) {
+    /* don't try to join when we have no thread */
     GST_DEBUG_OBJECT (rtpsession, "joining RTCP thread");
     GST_RTP_SESSION_UNLOCK (rtpsession);
 
@@ -1108,6 +1305,7 @@ static void
 gst_rtp_session_clear_pt_map (GstRtpSession * rtpsession)
 {
   g_hash_table_foreach_remove (rtpsession->priv->ptmap, return_true, NULL);
+  rtp_session_clear_clock_rates (rtpsession->priv->session);
 }
 
 /* called when the session manager has an RTP packet or a list of packets
@@ -1158,6 +1356,10 @@ gst_rtp_session_send_rtp (RTPSession * sess, RTPSource * src,
     GST_LOG_OBJECT (rtpsession, "signal RTCP thread");
     rtpsession->priv->wait_send = FALSE;
     GST_RTP_SESSION_SIGNAL (rtpsession);
+    if (rtpsession->priv->rtcp_waiting) {
+      rtpsession->priv->rtcp_waiting = FALSE;
+      rtcp_shared_push (rtpsession);
+    }
   }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 
@@ -1446,6 +1648,9 @@ gst_rtp_session_reconsider (RTPSession * sess, gpointer user_data)
   GST_DEBUG_OBJECT (rtpsession, "unlock timer for reconsideration");
   if (rtpsession->priv->id)
     gst_clock_id_unschedule (rtpsession->priv->id);
+  if (rtpsession->priv->rtcp_shared && !rtpsession->priv->thread_stopped &&
+      !rtpsession->priv->rtcp_waiting)
+    rtcp_shared_push (rtpsession);
   GST_RTP_SESSION_UNLOCK (rtpsession);
 }
 
@@ -1742,6 +1947,53 @@ push_error:
   }
 }
 
+/* receive a list of packets from a sender, the running time of the first
+ * buffer is used for the list, the session manager derives the others from
+ * the buffer timestamps */
+static GstFlowReturn
+gst_rtp_session_chain_recv_rtp_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpSession *rtpsession;
+  GstRtpSessionPrivate *priv;
+  GstFlowReturn ret;
+  GstClockTime current_time, running_time;
+  GstClockTime timestamp;
+  GstBuffer *buffer;
+  guint64 ntpnstime;
+
+  rtpsession = GST_RTP_SESSION (parent);
+  priv = rtpsession->priv;
+
+  GST_LOG_OBJECT (rtpsession, "received RTP list of %u packets",
+      gst_buffer_list_length (list));
+
+  buffer = gst_buffer_list_get (list, 0);
+  if (buffer == NULL) {
+    gst_buffer_list_unref (list);
+    return GST_FLOW_OK;
+  }
+
+  timestamp = GST_BUFFER_TIMESTAMP (buffer);
+  if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    running_time =
+        gst_segment_to_running_time (&rtpsession->recv_rtp_seg, GST_FORMAT_TIME,
+        timestamp);
+    ntpnstime = GST_CLOCK_TIME_NONE;
+  } else {
+    get_current_times (rtpsession, &running_time, &ntpnstime);
+  }
+  current_time = gst_clock_get_time (priv->sysclock);
+
+  ret = rtp_session_process_rtp_list (priv->session, list, current_time,
+      running_time, ntpnstime);
+  if (ret != GST_FLOW_OK)
+    GST_DEBUG_OBJECT (rtpsession, "process returned %s",
+        gst_flow_get_name (ret));
+
+  return ret;
+}
+
 static gboolean
 gst_rtp_session_event_recv_rtcp_sink (GstPad * pad, GstObject * parent,
     GstEvent * event)
@@ -2116,6 +2368,8 @@ create_recv_rtp_sink (GstRtpSession * rtpsession)
       "recv_rtp_sink");
   gst_pad_set_chain_function (rtpsession->recv_rtp_sink,
       gst_rtp_session_chain_recv_rtp);
+  gst_pad_set_chain_list_function (rtpsession->recv_rtp_sink,
+      gst_rtp_session_chain_recv_rtp_list);
   gst_pad_set_event_function (rtpsession->recv_rtp_sink,
       gst_rtp_session_event_recv_rtp_sink);
   gst_pad_set_iterate_internal_links_function (rtpsession->recv_rtp_sink,
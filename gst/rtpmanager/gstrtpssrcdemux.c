@@ -165,6 +165,151 @@ find_demux_pad_for_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc)
   return NULL;
 }
 
+/*
+ * Read-only snapshot of the SSRC -> pads mapping, sorted on SSRC. A pad is
+ * only in the table after its initial events were pushed.
+ */
+typedef struct
+{
+  guint32 ssrc;
+  GstPad *rtp_pad;
+  GstPad *rtcp_pad;
+} PadTableEntry;
+
+typedef struct
+{
+  guint n_entries;
+  PadTableEntry entries[1];
+} PadTable;
+
+static void
+pad_table_free (PadTable * table)
+{
+  guint i;
+
+  for (i = 0; i < table->n_entries; i++) {
+    if (table->entries[i].rtp_pad)
+      gst_object_unref (table->entries[i].rtp_pad);
+    if (table->entries[i].rtcp_pad)
+      gst_object_unref (table->entries[i].rtcp_pad);
+  }
+  g_free (table);
+}
+
+static gint
+pad_table_entry_compare (const PadTableEntry * a, const PadTableEntry * b,
+    gpointer user_data)
+{
+  if (a->ssrc < b->ssrc)
+    return -1;
+  if (a->ssrc > b->ssrc)
+    return 1;
+  return 0;
+}
+
+/* free the retired tables when no streaming thread can see them anymore.
+ * A reader that arrives after the check loads the current table. When
+ * readers are active, the last one of them calls this again when it leaves.
+ * Must be called with the PAD_LOCK. */
+static void
+reclaim_pad_tables (GstRtpSsrcDemux * demux)
+{
+  GSList *retired;
+
+  if (g_atomic_int_get (&demux->pad_table_readers) != 0)
+    return;
+
+  retired = demux->retired_pad_tables;
+  g_atomic_pointer_set (&demux->retired_pad_tables, NULL);
+  g_slist_free_full (retired, (GDestroyNotify) pad_table_free);
+}
+
+/* publish a new snapshot of srcpads, must be called with the PAD_LOCK */
+static void
+update_pad_table (GstRtpSsrcDemux * demux)
+{
+  PadTable *table, *old;
+  GSList *walk;
+  guint n;
+
+  n = g_slist_length (demux->srcpads);
+  table = g_malloc0 (sizeof (PadTable) + MAX (n, 1) * sizeof (PadTableEntry));
+
+  for (walk = demux->srcpads; walk; walk = g_slist_next (walk)) {
+    GstRtpSsrcDemuxPad *dpad = (GstRtpSsrcDemuxPad *) walk->data;
+    PadTableEntry *entry = &table->entries[table->n_entries++];
+
+    entry->ssrc = dpad->ssrc;
+    if (dpad->pushed_initial_rtp_events)
+      entry->rtp_pad = gst_object_ref (dpad->rtp_pad);
+    if (dpad->pushed_initial_rtcp_events)
+      entry->rtcp_pad = gst_object_ref (dpad->rtcp_pad);
+  }
+  g_qsort_with_data (table->entries, table->n_entries, sizeof (PadTableEntry),
+      (GCompareDataFunc) pad_table_entry_compare, NULL);
+
+  old = g_atomic_pointer_get (&demux->pad_table);
+  g_atomic_pointer_set (&demux->pad_table, table);
+  if (old)
+    g_atomic_pointer_set (&demux->retired_pad_tables,
+        g_slist_prepend (demux->retired_pad_tables, old));
+
+  reclaim_pad_tables (demux);
+}
+
+/* find the srcpad for @ssrc without taking the PAD_LOCK. Returns a ref to
+ * the pad or NULL when the pad does not exist yet or needs its initial
+ * events. */
+static GstPad *
+find_demux_pad_fast (GstRtpSsrcDemux * demux, guint32 ssrc, PadType padtype)
+{
+  PadTable *table;
+  PadTableEntry *entry = NULL;
+  GstPad *pad = NULL;
+
+  g_atomic_int_inc (&demux->pad_table_readers);
+  table = g_atomic_pointer_get (&demux->pad_table);
+  if (table && table->n_entries > 0) {
+    guint idx;
+
+    /* most of the time the packet is for the same SSRC as the previous one */
+    idx = g_atomic_int_get (&demux->last_index);
+    if (idx < table->n_entries && table->entries[idx].ssrc == ssrc) {
+      entry = &table->entries[idx];
+    } else {
+      guint lo = 0, hi = table->n_entries;
+
+      while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (table->entries[mid].ssrc < ssrc)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo < table->n_entries && table->entries[lo].ssrc == ssrc) {
+        entry = &table->entries[lo];
+        g_atomic_int_set (&demux->last_index, lo);
+      }
+    }
+    if (entry) {
+      pad = padtype == RTP_PAD ? entry->rtp_pad : entry->rtcp_pad;
+      if (pad)
+        gst_object_ref (pad);
+    }
+  }
+  /* the last reader out frees the tables that were retired while it was
+   * reading, the writer could not do that */
+  if (g_atomic_int_dec_and_test (&demux->pad_table_readers) &&
+      g_atomic_pointer_get (&demux->retired_pad_tables) != NULL) {
+    GST_PAD_LOCK (demux);
+    reclaim_pad_tables (demux);
+    GST_PAD_UNLOCK (demux);
+  }
+
+  return pad;
+}
+
 static GstEvent *
 add_ssrc_and_ref (GstEvent * event, guint32 ssrc)
 {
@@ -272,8 +417,14 @@ find_or_create_demux_pad_for_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc,
 
     GST_PAD_UNLOCK (demux);
 
-    if (forward)
+    if (forward) {
       forward_initial_events (demux, ssrc, retpad, padtype);
+
+      /* the pad can now be found without the lock */
+      GST_PAD_LOCK (demux);
+      update_pad_table (demux);
+      GST_PAD_UNLOCK (demux);
+    }
     return retpad;
   }
 
@@ -355,6 +506,10 @@ find_or_create_demux_pad_for_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc,
   gst_pad_remove_probe (rtp_pad, rtp_block);
   gst_pad_remove_probe (rtcp_pad, rtcp_block);
 
+  GST_PAD_LOCK (demux);
+  update_pad_table (demux);
+  GST_PAD_UNLOCK (demux);
+
   gst_object_unref (rtp_pad);
   gst_object_unref (rtcp_pad);
 
@@ -484,6 +639,15 @@ gst_rtp_ssrc_demux_reset (GstRtpSsrcDemux * demux)
   }
   g_slist_free (demux->srcpads);
   demux->srcpads = NULL;
+
+  /* no streaming threads anymore */
+  if (demux->pad_table) {
+    pad_table_free (demux->pad_table);
+    demux->pad_table = NULL;
+  }
+  g_slist_free_full (demux->retired_pad_tables,
+      (GDestroyNotify) pad_table_free);
+  demux->retired_pad_tables = NULL;
 }
 
 static void
@@ -524,6 +688,7 @@ gst_rtp_ssrc_demux_clear_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc)
   GST_DEBUG_OBJECT (demux, "clearing pad for SSRC %08x", ssrc);
 
   demux->srcpads = g_slist_remove (demux->srcpads, dpad);
+  update_pad_table (demux);
   GST_PAD_UNLOCK (demux);
 
   gst_pad_set_active (dpad->rtp_pad, FALSE);
@@ -626,7 +791,9 @@ gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   GST_DEBUG_OBJECT (demux, "received buffer of SSRC %08x", ssrc);
 
-  srcpad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTP_PAD);
+  srcpad = find_demux_pad_fast (demux, ssrc, RTP_PAD);
+  if (srcpad == NULL)
+    srcpad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTP_PAD);
   if (srcpad == NULL)
     goto create_failed;
 
@@ -703,7 +870,9 @@ gst_rtp_ssrc_demux_rtcp_chain (GstPad * pad, GstObject * parent,
 
   GST_DEBUG_OBJECT (demux, "received RTCP of SSRC %08x", ssrc);
 
-  srcpad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTCP_PAD);
+  srcpad = find_demux_pad_fast (demux, ssrc, RTCP_PAD);
+  if (srcpad == NULL)
+    srcpad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTCP_PAD);
   if (srcpad == NULL)
     goto create_failed;
 
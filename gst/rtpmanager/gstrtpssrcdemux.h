@@ -41,6 +41,14 @@ struct _GstRtpSsrcDemux
 
   GRecMutex padlock;
   GSList *srcpads;
+
+  /* snapshot of the srcpads for the lock-free lookup in the streaming
+   * threads. Replaced atomically with the padlock, old snapshots are freed
+   * by the writer or by the last streaming thread that stops reading */
+  gpointer pad_table;
+  gint pad_table_readers;
+  GSList *retired_pad_tables;
+  gint last_index;
 };
 
 struct _GstRtpSsrcDemuxClass
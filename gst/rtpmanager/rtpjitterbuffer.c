@@ -30,6 +30,11 @@ GST_DEBUG_CATEGORY_STATIC (rtp_jitter_buffer_debug);
 #define MAX_WINDOW	RTP_JITTER_BUFFER_MAX_WINDOW
 #define MAX_TIME	(2 * GST_SECOND)
 
+/* initial size of the seqnum index, it grows when the packets in the
+ * jitterbuffer span more seqnums, up to the full 16 bits seqnum range */
+#define MIN_INDEX_SIZE	512
+#define MAX_INDEX_SIZE	65536
+
 /* signals and args */
 enum
 {
@@ -86,6 +91,8 @@ static void
 rtp_jitter_buffer_init (RTPJitterBuffer * jbuf)
 {
   jbuf->packets = g_queue_new ();
+  jbuf->index_size = MIN_INDEX_SIZE;
+  jbuf->index = g_new0 (RTPJitterBufferItem *, jbuf->index_size);
   jbuf->mode = RTP_JITTER_BUFFER_MODE_SLAVE;
 
   rtp_jitter_buffer_reset_skew (jbuf);
@@ -99,6 +106,7 @@ rtp_jitter_buffer_finalize (GObject * object)
   jbuf = RTP_JITTER_BUFFER_CAST (object);
 
   g_queue_free (jbuf->packets);
+  g_free (jbuf->index);
 
   G_OBJECT_CLASS (rtp_jitter_buffer_parent_class)->finalize (object);
 }
@@ -603,6 +611,158 @@ no_skew:
   return out_time;
 }
 
+#define INDEX_SLOT(jbuf,seqnum) ((jbuf)->index[(seqnum) & ((jbuf)->index_size - 1)])
+
+/* the packet with the lowest seqnum, is almost always the head */
+static RTPJitterBufferItem *
+index_get_low (RTPJitterBuffer * jbuf)
+{
+  GList *list;
+
+  for (list = jbuf->packets->head; list; list = g_list_next (list)) {
+    RTPJitterBufferItem *item = (RTPJitterBufferItem *) list;
+
+    if (item->seqnum != -1)
+      return item;
+  }
+  return NULL;
+}
+
+/* make sure the index has room for all packets from the lowest seqnum up to
+ * @seqnum without two of them sharing a slot */
+static void
+index_ensure_size (RTPJitterBuffer * jbuf, guint16 seqnum)
+{
+  RTPJitterBufferItem *low;
+  guint16 low_seqnum, high_seqnum;
+  guint span, size;
+  GList *list;
+
+  if ((low = index_get_low (jbuf)) == NULL)
+    return;
+
+  low_seqnum = low->seqnum;
+  high_seqnum = jbuf->high_seqnum;
+
+  if (gst_rtp_buffer_compare_seqnum (seqnum, low_seqnum) > 0)
+    low_seqnum = seqnum;
+  if (gst_rtp_buffer_compare_seqnum (high_seqnum, seqnum) > 0)
+    high_seqnum = seqnum;
+
+  span = ((guint16) (high_seqnum - low_seqnum)) + 1;
+  if (G_LIKELY (span <= jbuf->index_size))
+    return;
+
+  size = jbuf->index_size;
+  while (size < span && size < MAX_INDEX_SIZE)
+    size <<= 1;
+
+  GST_DEBUG ("growing seqnum index from %u to %u for span of %u",
+      jbuf->index_size, size, span);
+
+  g_free (jbuf->index);
+  jbuf->index_size = size;
+  jbuf->index = g_new0 (RTPJitterBufferItem *, size);
+
+  for (list = jbuf->packets->head; list; list = g_list_next (list)) {
+    RTPJitterBufferItem *item = (RTPJitterBufferItem *) list;
+
+    if (item->seqnum != -1)
+      INDEX_SLOT (jbuf, item->seqnum) = item;
+  }
+}
+
+static void
+index_add (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item)
+{
+  guint16 seqnum = item->seqnum;
+
+  if (jbuf->n_indexed == 0) {
+    jbuf->high_seqnum = seqnum;
+  } else {
+    index_ensure_size (jbuf, seqnum);
+    if (gst_rtp_buffer_compare_seqnum (jbuf->high_seqnum, seqnum) > 0)
+      jbuf->high_seqnum = seqnum;
+  }
+  INDEX_SLOT (jbuf, seqnum) = item;
+  jbuf->n_indexed++;
+}
+
+static void
+index_remove (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item)
+{
+  if (item->seqnum == -1)
+    return;
+
+  if (INDEX_SLOT (jbuf, item->seqnum) == item)
+    INDEX_SLOT (jbuf, item->seqnum) = NULL;
+  jbuf->n_indexed--;
+}
+
+/* find the packet before which a packet with @seqnum should be inserted, the
+ * first packet with a higher seqnum, and place it in @position. %NULL means
+ * that the packet should be appended. Instead of walking the whole queue,
+ * this only looks at the index slots between @seqnum and its closest
+ * neighbour in the direction to the nearest end of the queue.
+ *
+ * Returns: %FALSE if a packet with @seqnum is already in @jbuf. */
+static gboolean
+index_find_position (RTPJitterBuffer * jbuf, guint16 seqnum, GList ** position)
+{
+  RTPJitterBufferItem *slot, *low;
+  gint to_high, from_low;
+  guint16 s;
+
+  *position = NULL;
+
+  if (jbuf->n_indexed == 0)
+    return TRUE;
+
+  slot = INDEX_SLOT (jbuf, seqnum);
+  if (slot && slot->seqnum == seqnum)
+    return FALSE;
+
+  /* newer than all packets we have, the common case */
+  to_high = gst_rtp_buffer_compare_seqnum (seqnum, jbuf->high_seqnum);
+  if (G_LIKELY (to_high < 0))
+    return TRUE;
+
+  /* older than all packets we have, goes before the lowest one */
+  low = index_get_low (jbuf);
+  from_low = gst_rtp_buffer_compare_seqnum (low->seqnum, seqnum);
+  if (from_low < 0) {
+    *position = (GList *) low;
+    return TRUE;
+  }
+
+  if (to_high <= from_low) {
+    /* look for the next higher seqnum, we stop at high_seqnum at the latest */
+    for (s = seqnum + 1;; s++) {
+      slot = INDEX_SLOT (jbuf, s);
+      if (slot && slot->seqnum == s)
+        break;
+    }
+    *position = (GList *) slot;
+  } else {
+    GList *list;
+
+    /* look for the next lower seqnum, we stop at the low seqnum at the
+     * latest, the packet we need is the one after that, skipping the
+     * events that are in between */
+    for (s = seqnum - 1;; s--) {
+      slot = INDEX_SLOT (jbuf, s);
+      if (slot && slot->seqnum == s)
+        break;
+    }
+    for (list = ((GList *) slot)->next; list; list = g_list_next (list)) {
+      if (((RTPJitterBufferItem *) list)->seqnum != -1)
+        break;
+    }
+    *position = list;
+  }
+  return TRUE;
+}
+
 static void
 queue_do_insert (RTPJitterBuffer * jbuf, GList * list, GList * item)
 {
@@ -660,28 +820,9 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item,
 
   seqnum = item->seqnum;
 
-  /* loop the list to skip strictly smaller seqnum buffers */
-  for (list = jbuf->packets->head; list; list = g_list_next (list)) {
-    guint16 qseq;
-    gint gap;
-    RTPJitterBufferItem *qitem = (RTPJitterBufferItem *) list;
-
-    if (qitem->seqnum == -1)
-      continue;
-
-    qseq = qitem->seqnum;
-
-    /* compare the new seqnum to the one in the buffer */
-    gap = gst_rtp_buffer_compare_seqnum (seqnum, qseq);
-
-    /* we hit a packet with the same seqnum, notify a duplicate */
-    if (G_UNLIKELY (gap == 0))
-      goto duplicate;
-
-    /* seqnum < qseq, we can stop looking */
-    if (G_LIKELY (gap > 0))
-      break;
-  }
+  /* find the first packet with a bigger seqnum, we insert before that one */
+  if (G_UNLIKELY (!index_find_position (jbuf, seqnum, &list)))
+    goto duplicate;
 
   dts = item->dts;
   if (item->rtptime == -1)
@@ -737,6 +878,8 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item,
 
 append:
   queue_do_insert (jbuf, list, (GList *) item);
+  if (item->seqnum != -1)
+    index_add (jbuf, item);
 
   /* buffering mode, update buffer stats */
   if (jbuf->mode == RTP_JITTER_BUFFER_MODE_BUFFER)
@@ -788,6 +931,8 @@ rtp_jitter_buffer_pop (RTPJitterBuffer * jbuf, gint * percent)
     else
       queue->tail = NULL;
     queue->length--;
+
+    index_remove (jbuf, (RTPJitterBufferItem *) item);
   }
 
   /* buffering mode, update buffer stats */
@@ -834,8 +979,10 @@ rtp_jitter_buffer_flush (RTPJitterBuffer * jbuf, GFunc free_func,
   g_return_if_fail (jbuf != NULL);
   g_return_if_fail (free_func != NULL);
 
-  while ((item = g_queue_pop_head_link (jbuf->packets)))
+  while ((item = g_queue_pop_head_link (jbuf->packets))) {
+    index_remove (jbuf, (RTPJitterBufferItem *) item);
     free_func ((RTPJitterBufferItem *) item, user_data);
+  }
 }
 
 /**
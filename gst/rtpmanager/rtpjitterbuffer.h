@@ -76,6 +76,13 @@ struct _RTPJitterBuffer {
 
   GQueue        *packets;
 
+  /* seqnum index into packets, a ring of index_size (a power of 2) slots
+   * addressed by seqnum modulo index_size */
+  RTPJitterBufferItem **index;
+  guint          index_size;
+  guint          n_indexed;
+  guint16        high_seqnum;
+
   RTPJitterBufferMode mode;
 
   GstClockTime   delay;
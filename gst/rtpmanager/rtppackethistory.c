@@ -0,0 +1,299 @@
+/* GStreamer
+ *
+ * rtppackethistory.c: history of sent RTP packets for retransmission
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "rtppackethistory.h"
+
+typedef struct
+{
+  GstBuffer *buffer;
+  guint16 seqnum;
+  guint32 rtptime;
+  gsize size;
+} RTPPacketHistoryItem;
+
+struct _RTPPacketHistory
+{
+  /* items, oldest at the head */
+  GQueue items;
+  /* seqnum -> item */
+  GHashTable *seqnums;
+  guint bytes;
+
+  guint max_packets;
+  guint max_time;
+  guint max_bytes;
+  gint clock_rate;
+};
+
+/**
+ * rtp_packet_history_new:
+ *
+ * Create a new empty #RTPPacketHistory without limits.
+ *
+ * Returns: a new #RTPPacketHistory, free with rtp_packet_history_free().
+ */
+RTPPacketHistory *
+rtp_packet_history_new (void)
+{
+  RTPPacketHistory *history;
+
+  history = g_slice_new0 (RTPPacketHistory);
+  g_queue_init (&history->items);
+  history->seqnums = g_hash_table_new (NULL, NULL);
+  history->clock_rate = -1;
+
+  return history;
+}
+
+/**
+ * rtp_packet_history_free:
+ * @history: an #RTPPacketHistory
+ *
+ * Release all packets and free @history.
+ */
+void
+rtp_packet_history_free (RTPPacketHistory * history)
+{
+  g_return_if_fail (history != NULL);
+
+  rtp_packet_history_clear (history);
+  g_hash_table_destroy (history->seqnums);
+  g_slice_free (RTPPacketHistory, history);
+}
+
+static void
+drop_oldest (RTPPacketHistory * history)
+{
+  RTPPacketHistoryItem *item;
+
+  item = g_queue_pop_head (&history->items);
+
+  /* a newer packet with the same seqnum could have replaced this one in the
+   * index after a wraparound */
+  if (g_hash_table_lookup (history->seqnums,
+          GUINT_TO_POINTER (item->seqnum)) == item)
+    g_hash_table_remove (history->seqnums, GUINT_TO_POINTER (item->seqnum));
+
+  history->bytes -= item->size;
+  gst_buffer_unref (item->buffer);
+  g_slice_free (RTPPacketHistoryItem, item);
+}
+
+/* the duration in ms between the oldest and the newest packet */
+static guint
+get_duration (RTPPacketHistory * history)
+{
+  RTPPacketHistoryItem *high, *low;
+
+  if (history->clock_rate <= 0 || history->items.length < 2)
+    return 0;
+
+  high = g_queue_peek_tail (&history->items);
+  low = g_queue_peek_head (&history->items);
+
+  /* works when the timestamp wraps */
+  return gst_util_uint64_scale_int ((guint32) (high->rtptime - low->rtptime),
+      1000, history->clock_rate);
+}
+
+static void
+evict (RTPPacketHistory * history)
+{
+  if (history->max_packets) {
+    while (history->items.length > history->max_packets)
+      drop_oldest (history);
+  }
+  /* always keep the newest packet for the other limits */
+  if (history->max_bytes) {
+    while (history->items.length > 1 && history->bytes > history->max_bytes)
+      drop_oldest (history);
+  }
+  if (history->max_time) {
+    while (get_duration (history) > history->max_time)
+      drop_oldest (history);
+  }
+}
+
+/**
+ * rtp_packet_history_set_max_packets:
+ * @history: an #RTPPacketHistory
+ * @max_packets: the maximum number of packets, 0 for unlimited
+ *
+ * Limit the number of packets in @history.
+ */
+void
+rtp_packet_history_set_max_packets (RTPPacketHistory * history,
+    guint max_packets)
+{
+  g_return_if_fail (history != NULL);
+
+  history->max_packets = max_packets;
+  evict (history);
+}
+
+/**
+ * rtp_packet_history_set_max_time:
+ * @history: an #RTPPacketHistory
+ * @max_time: the maximum duration in milliseconds, 0 for unlimited
+ *
+ * Limit the RTP time between the oldest and newest packet in @history. This
+ * needs the clock-rate, see rtp_packet_history_set_clock_rate().
+ */
+void
+rtp_packet_history_set_max_time (RTPPacketHistory * history, guint max_time)
+{
+  g_return_if_fail (history != NULL);
+
+  history->max_time = max_time;
+  evict (history);
+}
+
+/**
+ * rtp_packet_history_set_max_bytes:
+ * @history: an #RTPPacketHistory
+ * @max_bytes: the maximum size in bytes, 0 for unlimited
+ *
+ * Limit the total size of the packets in @history.
+ */
+void
+rtp_packet_history_set_max_bytes (RTPPacketHistory * history, guint max_bytes)
+{
+  g_return_if_fail (history != NULL);
+
+  history->max_bytes = max_bytes;
+  evict (history);
+}
+
+/**
+ * rtp_packet_history_set_clock_rate:
+ * @history: an #RTPPacketHistory
+ * @clock_rate: the clock-rate of the RTP timestamps, -1 when unknown
+ *
+ * Set the clock-rate used to limit @history in time.
+ */
+void
+rtp_packet_history_set_clock_rate (RTPPacketHistory * history,
+    gint clock_rate)
+{
+  g_return_if_fail (history != NULL);
+
+  history->clock_rate = clock_rate;
+  evict (history);
+}
+
+/**
+ * rtp_packet_history_add:
+ * @history: an #RTPPacketHistory
+ * @buffer: (transfer full): an RTP buffer
+ * @seqnum: the seqnum of @buffer
+ * @rtptime: the RTP timestamp of @buffer
+ *
+ * Add @buffer as the newest packet in @history and evict the oldest packets
+ * that exceed the limits. Only a reference to @buffer is kept, the data is
+ * not copied.
+ */
+void
+rtp_packet_history_add (RTPPacketHistory * history, GstBuffer * buffer,
+    guint16 seqnum, guint32 rtptime)
+{
+  RTPPacketHistoryItem *item;
+
+  g_return_if_fail (history != NULL);
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+
+  item = g_slice_new (RTPPacketHistoryItem);
+  item->buffer = buffer;
+  item->seqnum = seqnum;
+  item->rtptime = rtptime;
+  item->size = gst_buffer_get_size (buffer);
+
+  g_queue_push_tail (&history->items, item);
+  g_hash_table_insert (history->seqnums, GUINT_TO_POINTER (seqnum), item);
+  history->bytes += item->size;
+
+  evict (history);
+}
+
+/**
+ * rtp_packet_history_lookup:
+ * @history: an #RTPPacketHistory
+ * @seqnum: a seqnum
+ *
+ * Find the newest packet with @seqnum in @history.
+ *
+ * Returns: (transfer full): a new reference to the packet or %NULL when
+ * @seqnum is not in @history.
+ */
+GstBuffer *
+rtp_packet_history_lookup (RTPPacketHistory * history, guint16 seqnum)
+{
+  RTPPacketHistoryItem *item;
+
+  g_return_val_if_fail (history != NULL, NULL);
+
+  item = g_hash_table_lookup (history->seqnums, GUINT_TO_POINTER (seqnum));
+  if (item == NULL)
+    return NULL;
+
+  return gst_buffer_ref (item->buffer);
+}
+
+/**
+ * rtp_packet_history_get_length:
+ * @history: an #RTPPacketHistory
+ *
+ * Returns: the number of packets in @history.
+ */
+guint
+rtp_packet_history_get_length (RTPPacketHistory * history)
+{
+  g_return_val_if_fail (history != NULL, 0);
+
+  return history->items.length;
+}
+
+/**
+ * rtp_packet_history_get_bytes:
+ * @history: an #RTPPacketHistory
+ *
+ * Returns: the total size in bytes of the packets in @history.
+ */
+guint
+rtp_packet_history_get_bytes (RTPPacketHistory * history)
+{
+  g_return_val_if_fail (history != NULL, 0);
+
+  return history->bytes;
+}
+
+/**
+ * rtp_packet_history_clear:
+ * @history: an #RTPPacketHistory
+ *
+ * Release all packets in @history.
+ */
+void
+rtp_packet_history_clear (RTPPacketHistory * history)
+{
+  g_return_if_fail (history != NULL);
+
+  while (history->items.length > 0)
+    drop_oldest (history);
+}
@@ -0,0 +1,58 @@
+/* GStreamer
+ *
+ * rtppackethistory.h: history of sent RTP packets for retransmission
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __RTP_PACKET_HISTORY_H__
+#define __RTP_PACKET_HISTORY_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * RTPPacketHistory:
+ *
+ * A history of RTP packets of one stream that can be looked up by seqnum.
+ * Only references to the buffers are kept. The oldest packets are evicted
+ * when the history holds more than a maximum number of packets, a maximum
+ * number of bytes, or a maximum duration in RTP time.
+ *
+ * The history is not thread safe, the caller should provide locking.
+ */
+typedef struct _RTPPacketHistory RTPPacketHistory;
+
+RTPPacketHistory * rtp_packet_history_new              (void);
+void               rtp_packet_history_free             (RTPPacketHistory *history);
+
+void               rtp_packet_history_set_max_packets  (RTPPacketHistory *history, guint max_packets);
+void               rtp_packet_history_set_max_time     (RTPPacketHistory *history, guint max_time);
+void               rtp_packet_history_set_max_bytes    (RTPPacketHistory *history, guint max_bytes);
+void               rtp_packet_history_set_clock_rate   (RTPPacketHistory *history, gint clock_rate);
+
+void               rtp_packet_history_add              (RTPPacketHistory *history, GstBuffer *buffer,
+                                                        guint16 seqnum, guint32 rtptime);
+GstBuffer *        rtp_packet_history_lookup           (RTPPacketHistory *history, guint16 seqnum);
+
+guint              rtp_packet_history_get_length       (RTPPacketHistory *history);
+guint              rtp_packet_history_get_bytes        (RTPPacketHistory *history);
+void               rtp_packet_history_clear            (RTPPacketHistory *history);
+
+G_END_DECLS
+
+#endif /* __RTP_PACKET_HISTORY_H__ */
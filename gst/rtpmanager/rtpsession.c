@@ -107,6 +107,7 @@ enum
 
 /* GObject vmethods */
 static void rtp_session_finalize (GObject * object);
+static void rtp_session_free_rtcp_pool (RTPSession * sess);
 static void rtp_session_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void rtp_session_get_property (GObject * object, guint prop_id,
@@ -471,19 +472,12 @@ rtp_session_class_init (RTPSessionClass * klass)
 static void
 rtp_session_init (RTPSession * sess)
 {
-  gint i;
   gchar *str;
 
   g_mutex_init (&sess->lock);
-  sess->key = g_random_int ();
-  sess->mask_idx = 0;
-  sess->mask = 0;
-
-  for (i = 0; i < 32; i++) {
-    sess->ssrcs[i] =
-        g_hash_table_new_full (NULL, NULL, NULL,
-        (GDestroyNotify) g_object_unref);
-  }
+  g_rw_lock_init (&sess->ssrcs_lock);
+  sess->ssrcs = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) g_object_unref);
 
   rtp_stats_init_defaults (&sess->stats);
   INIT_AVG (sess->stats.avg_rtcp_packet_size, 100);
@@ -540,15 +534,16 @@ static void
 rtp_session_finalize (GObject * object)
 {
   RTPSession *sess;
-  gint i;
 
   sess = RTP_SESSION_CAST (object);
 
   gst_structure_free (sess->sdes);
 
-  for (i = 0; i < 32; i++)
-    g_hash_table_destroy (sess->ssrcs[i]);
+  g_hash_table_destroy (sess->ssrcs);
 
+  rtp_session_free_rtcp_pool (sess);
+
+  g_rw_lock_clear (&sess->ssrcs_lock);
   g_mutex_clear (&sess->lock);
 
   G_OBJECT_CLASS (rtp_session_parent_class)->finalize (object);
@@ -573,12 +568,12 @@ rtp_session_create_sources (RTPSession * sess)
 
   RTP_SESSION_LOCK (sess);
   /* get number of elements in the table */
-  size = g_hash_table_size (sess->ssrcs[sess->mask_idx]);
+  size = g_hash_table_size (sess->ssrcs);
   /* create the result value array */
   res = g_value_array_new (size);
 
   /* and copy all values into the array */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx], (GHFunc) copy_source, res);
+  g_hash_table_foreach (sess->ssrcs, (GHFunc) copy_source, res);
   RTP_SESSION_UNLOCK (sess);
 
   return res;
@@ -1313,12 +1308,6 @@ check_collision (RTPSession * sess, RTPSource * source,
   return TRUE;
 }
 
-typedef struct
-{
-  gboolean is_doing_ptp;
-  GSocketAddress *new_addr;
-} CompareAddrData;
-
 /* check if the two given ip addr are the same (do not care about the port) */
 static gboolean
 ip_addr_equal (GSocketAddress * a, GSocketAddress * b)
@@ -1329,34 +1318,20 @@ ip_addr_equal (GSocketAddress * a, GSocketAddress * b)
       g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (b)));
 }
 
-static void
-compare_rtp_source_addr (const gchar * key, RTPSource * source,
-    CompareAddrData * data)
-{
-  /* only compare ip addr of remote sources which are also not closing */
-  if (!source->internal && !source->closing && source->rtp_from) {
-    /* look for the first rtp source */
-    if (!data->new_addr)
-      data->new_addr = source->rtp_from;
-    /* compare current ip addr with the first one */
-    else
-      data->is_doing_ptp &= ip_addr_equal (data->new_addr, source->rtp_from);
-  }
-}
+/* compare @addr with the first address @first that was seen, returns FALSE
+ * when they differ */
+static gboolean
+update_ptp_addr (GSocketAddress ** first, GSocketAddress * addr)
+{
+  if (addr == NULL)
+    return TRUE;
 
-static void
-compare_rtcp_source_addr (const gchar * key, RTPSource * source,
-    CompareAddrData * data)
-{
-  /* only compare ip addr of remote sources which are also not closing */
-  if (!source->internal && !source->closing && source->rtcp_from) {
-    /* look for the first rtcp source */
-    if (!data->new_addr)
-      data->new_addr = source->rtcp_from;
-    else
-      /* compare current ip addr with the first one */
-      data->is_doing_ptp &= ip_addr_equal (data->new_addr, source->rtcp_from);
+  if (*first == NULL) {
+    *first = addr;
+    return TRUE;
   }
+
+  return ip_addr_equal (*first, addr);
 }
 
 /* loop over our non-internal source to know if the session
@@ -1366,33 +1341,30 @@ session_update_ptp (RTPSession * sess)
 {
   /* to know if the session is doing point to point, the ip addr
    * of each non-internal (=remotes) source have to be compared
-   * to each other.
+   * to each other. Comparing with the first remote address is enough because
+   * the session just needs to know if they are all equal or not, so we can
+   * stop at the first one that differs.
    */
-  gboolean is_doing_rtp_ptp = FALSE;
-  gboolean is_doing_rtcp_ptp = FALSE;
-  CompareAddrData data;
-
-  /* compare the first remote source's ip addr that receive rtp packets
-   * with other remote rtp source.
-   * it's enough because the session just needs to know if they are all
-   * equals or not
-   */
-  data.is_doing_ptp = TRUE;
-  data.new_addr = NULL;
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
-      (GHFunc) compare_rtp_source_addr, (gpointer) & data);
-  is_doing_rtp_ptp = data.is_doing_ptp;
-
-  /* same but about rtcp */
-  data.is_doing_ptp = TRUE;
-  data.new_addr = NULL;
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
-      (GHFunc) compare_rtcp_source_addr, (gpointer) & data);
-  is_doing_rtcp_ptp = data.is_doing_ptp;
-
-  /* the session is doing point-to-point if all rtp remote have the same
-   * ip addr and if all rtcp remote sources have the same ip addr */
-  sess->is_doing_ptp = is_doing_rtp_ptp && is_doing_rtcp_ptp;
+  GSocketAddress *rtp_addr = NULL, *rtcp_addr = NULL;
+  GHashTableIter iter;
+  gpointer value;
+
+  sess->is_doing_ptp = TRUE;
+
+  g_hash_table_iter_init (&iter, sess->ssrcs);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    RTPSource *source = value;
+
+    /* only compare ip addr of remote sources which are also not closing */
+    if (source->internal || source->closing)
+      continue;
+
+    if (!update_ptp_addr (&rtp_addr, source->rtp_from) ||
+        !update_ptp_addr (&rtcp_addr, source->rtcp_from)) {
+      sess->is_doing_ptp = FALSE;
+      break;
+    }
+  }
 
   GST_DEBUG ("doing point-to-point: %d", sess->is_doing_ptp);
 }
@@ -1400,8 +1372,10 @@ session_update_ptp (RTPSession * sess)
 static void
 add_source (RTPSession * sess, RTPSource * src)
 {
-  g_hash_table_insert (sess->ssrcs[sess->mask_idx],
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
+  g_hash_table_insert (sess->ssrcs,
       GINT_TO_POINTER (src->ssrc), src);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
   /* report the new source ASAP */
   src->generation = sess->generation;
   /* we have one more source now */
@@ -1422,7 +1396,7 @@ add_source (RTPSession * sess, RTPSource * src)
 static RTPSource *
 find_source (RTPSession * sess, guint32 ssrc)
 {
-  return g_hash_table_lookup (sess->ssrcs[sess->mask_idx],
+  return g_hash_table_lookup (sess->ssrcs,
       GINT_TO_POINTER (ssrc));
 }
 
@@ -1474,9 +1448,11 @@ obtain_source (RTPSession * sess, guint32 ssrc, gboolean * created,
       g_object_set (source, "probation", 0, NULL);
   }
   /* update last activity */
+  RTP_SOURCE_LOCK (source);
   source->last_activity = pinfo->current_time;
   if (rtp)
     source->last_rtp_activity = pinfo->current_time;
+  RTP_SOURCE_UNLOCK (source);
   g_object_ref (source);
 
   return source;
@@ -1586,6 +1562,30 @@ rtp_session_get_num_sources (RTPSession * sess)
   return result;
 }
 
+static void
+clear_clock_rates (const gchar * key, RTPSource * source, gpointer user_data)
+{
+  rtp_source_clear_clock_rates (source);
+}
+
+/**
+ * rtp_session_clear_clock_rates:
+ * @sess: an #RTPSession
+ *
+ * Make all sources of @sess forget the clock-rates of the payload types they
+ * have seen, for when the payload type map changed.
+ */
+void
+rtp_session_clear_clock_rates (RTPSession * sess)
+{
+  g_return_if_fail (RTP_IS_SESSION (sess));
+
+  RTP_SESSION_LOCK (sess);
+  g_hash_table_foreach (sess->ssrcs,
+      (GHFunc) clear_clock_rates, NULL);
+  RTP_SESSION_UNLOCK (sess);
+}
+
 /**
  * rtp_session_get_num_active_sources:
  * @sess: an #RTPSession
@@ -1735,7 +1735,8 @@ invalid_packet:
 /* update the RTPPacketInfo structure with the current time and other bits
  * about the current buffer we are handling.
  * This function is typically called when a validated packet is received.
- * This function should be called with the SESSION_LOCK
+ * This function only reads the header_len of the session and can be called
+ * without the SESSION_LOCK
  */
 static gboolean
 update_packet_info (RTPSession * sess, RTPPacketInfo * pinfo,
@@ -1827,46 +1828,71 @@ source_update_sender (RTPSession * sess, RTPSource * source,
   return TRUE;
 }
 
-/**
- * rtp_session_process_rtp:
- * @sess: and #RTPSession
- * @buffer: an RTP buffer
- * @current_time: the current system time
- * @running_time: the running_time of @buffer
- *
- * Process an RTP buffer in the session manager. This function takes ownership
- * of @buffer.
- *
- * Returns: a #GstFlowReturn.
- */
-GstFlowReturn
-rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
-    GstClockTime current_time, GstClockTime running_time, guint64 ntpnstime)
+/* handle packets of a known and validated source without taking the session
+ * lock, this is the common case for an established stream. All @pinfos
+ * should be for the same SSRC. Returns the number of handled packets, the
+ * remaining ones need to go through the full processing. */
+static guint
+process_rtp_fast (RTPSession * sess, RTPPacketInfo * pinfos, guint n_pinfos,
+    GstFlowReturn * result)
+{
+  RTPSource *source;
+  gboolean bitrate_changed;
+  guint i, handled;
+
+  g_rw_lock_reader_lock (&sess->ssrcs_lock);
+  source = find_source (sess, pinfos[0].ssrc);
+  if (source)
+    g_object_ref (source);
+  g_rw_lock_reader_unlock (&sess->ssrcs_lock);
+
+  if (source == NULL)
+    return 0;
+
+  handled = rtp_source_process_rtp_fast (source, pinfos, n_pinfos,
+      &bitrate_changed);
+
+  if (bitrate_changed)
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
+
+  *result = GST_FLOW_OK;
+  for (i = 0; i < handled; i++) {
+    RTPPacketInfo *pinfo = &pinfos[i];
+
+    if (pinfo->data == NULL)
+      continue;
+
+    if (*result == GST_FLOW_OK && sess->callbacks.process_rtp) {
+      GST_LOG ("source %08x pushed receiver RTP packet", source->ssrc);
+      *result =
+          sess->callbacks.process_rtp (sess, source,
+          GST_BUFFER_CAST (pinfo->data), sess->process_rtp_user_data);
+    } else {
+      gst_buffer_unref (GST_BUFFER_CAST (pinfo->data));
+    }
+    pinfo->data = NULL;
+  }
+  g_object_unref (source);
+
+  return handled;
+}
+
+/* handle a packet with the session lock, creating the source when needed */
+static GstFlowReturn
+process_rtp_slow (RTPSession * sess, RTPPacketInfo * pinfo)
 {
   GstFlowReturn result;
   guint32 ssrc;
   RTPSource *source;
   gboolean created;
   gboolean prevsender, prevactive;
-  RTPPacketInfo pinfo = { 0, };
   guint64 oldrate;
 
-  g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
-  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
-
   RTP_SESSION_LOCK (sess);
 
-  /* update pinfo stats */
-  if (!update_packet_info (sess, &pinfo, FALSE, TRUE, FALSE, buffer,
-          current_time, running_time, ntpnstime)) {
-    GST_DEBUG ("invalid RTP packet received");
-    RTP_SESSION_UNLOCK (sess);
-    return rtp_session_process_rtcp (sess, buffer, current_time, ntpnstime);
-  }
-
-  ssrc = pinfo.ssrc;
+  ssrc = pinfo->ssrc;
 
-  source = obtain_source (sess, ssrc, &created, &pinfo, TRUE);
+  source = obtain_source (sess, ssrc, &created, pinfo, TRUE);
   if (!source)
     goto collision;
 
@@ -1875,7 +1901,7 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   oldrate = source->bitrate;
 
   /* let source process the packet */
-  result = rtp_source_process_rtp (source, &pinfo);
+  result = rtp_source_process_rtp (source, pinfo);
 
   /* source became active */
   if (source_update_active (sess, source, prevactive))
@@ -1894,14 +1920,14 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
     gint i;
 
     /* for validated sources, we add the CSRCs as well */
-    for (i = 0; i < pinfo.csrc_count; i++) {
+    for (i = 0; i < pinfo->csrc_count; i++) {
       guint32 csrc;
       RTPSource *csrc_src;
 
-      csrc = pinfo.csrcs[i];
+      csrc = pinfo->csrcs[i];
 
       /* get source */
-      csrc_src = obtain_source (sess, csrc, &created, &pinfo, TRUE);
+      csrc_src = obtain_source (sess, csrc, &created, pinfo, TRUE);
       if (!csrc_src)
         continue;
 
@@ -1918,20 +1944,154 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
 
   RTP_SESSION_UNLOCK (sess);
 
-  clean_packet_info (&pinfo);
-
   return result;
 
   /* ERRORS */
 collision:
   {
     RTP_SESSION_UNLOCK (sess);
-    clean_packet_info (&pinfo);
     GST_DEBUG ("ignoring packet because its collisioning");
     return GST_FLOW_OK;
   }
 }
 
+/**
+ * rtp_session_process_rtp:
+ * @sess: and #RTPSession
+ * @buffer: an RTP buffer
+ * @current_time: the current system time
+ * @running_time: the running_time of @buffer
+ *
+ * Process an RTP buffer in the session manager. This function takes ownership
+ * of @buffer.
+ *
+ * Returns: a #GstFlowReturn.
+ */
+GstFlowReturn
+rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
+    GstClockTime current_time, GstClockTime running_time, guint64 ntpnstime)
+{
+  GstFlowReturn result;
+  RTPPacketInfo pinfo = { 0, };
+
+  g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
+
+  /* update pinfo stats */
+  if (!update_packet_info (sess, &pinfo, FALSE, TRUE, FALSE, buffer,
+          current_time, running_time, ntpnstime)) {
+    GST_DEBUG ("invalid RTP packet received");
+    return rtp_session_process_rtcp (sess, buffer, current_time, ntpnstime);
+  }
+
+  if (process_rtp_fast (sess, &pinfo, 1, &result) == 0)
+    result = process_rtp_slow (sess, &pinfo);
+
+  clean_packet_info (&pinfo);
+
+  return result;
+}
+
+/**
+ * rtp_session_process_rtp_list:
+ * @sess: and #RTPSession
+ * @list: a list of RTP buffers
+ * @current_time: the current system time
+ * @running_time: the running_time of the first buffer in @list
+ *
+ * Process all RTP buffers in @list in the session manager. Consecutive
+ * packets of the same SSRC are handled together with one source lookup and
+ * one update of the source statistics. The running_time of the other
+ * buffers is derived from the difference of their timestamp with that of
+ * the first buffer.
+ *
+ * This function takes ownership of @list.
+ *
+ * Returns: a #GstFlowReturn.
+ */
+GstFlowReturn
+rtp_session_process_rtp_list (RTPSession * sess, GstBufferList * list,
+    GstClockTime current_time, GstClockTime running_time, guint64 ntpnstime)
+{
+  GstFlowReturn result = GST_FLOW_OK;
+  RTPPacketInfo *pinfos;
+  gboolean *valid;
+  GstClockTime first_ts = GST_CLOCK_TIME_NONE;
+  guint i, j, len;
+
+  g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
+
+  len = gst_buffer_list_length (list);
+  if (len == 0)
+    goto done;
+
+  pinfos = g_new0 (RTPPacketInfo, len);
+  valid = g_new (gboolean, len);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_ref (gst_buffer_list_get (list, i));
+    GstClockTime timestamp = GST_BUFFER_TIMESTAMP (buffer);
+    GstClockTime rt = running_time;
+
+    if (i == 0)
+      first_ts = timestamp;
+    else if (GST_CLOCK_TIME_IS_VALID (rt) &&
+        GST_CLOCK_TIME_IS_VALID (timestamp) &&
+        GST_CLOCK_TIME_IS_VALID (first_ts) && timestamp >= first_ts)
+      rt += timestamp - first_ts;
+
+    valid[i] = update_packet_info (sess, &pinfos[i], FALSE, TRUE, FALSE,
+        buffer, current_time, rt, ntpnstime);
+  }
+
+  for (i = 0; i < len && result == GST_FLOW_OK; i = j) {
+    guint handled;
+
+    if (!valid[i]) {
+      GST_DEBUG ("invalid RTP packet received");
+      result =
+          rtp_session_process_rtcp (sess, GST_BUFFER_CAST (pinfos[i].data),
+          current_time, ntpnstime);
+      pinfos[i].data = NULL;
+      j = i + 1;
+      continue;
+    }
+
+    /* collect the following packets of the same SSRC */
+    for (j = i + 1; j < len; j++) {
+      if (!valid[j] || pinfos[j].ssrc != pinfos[i].ssrc)
+        break;
+    }
+
+    handled = process_rtp_fast (sess, &pinfos[i], j - i, &result);
+    if (result != GST_FLOW_OK)
+      break;
+
+    if (i + handled < j) {
+      /* the first packet that could not be handled, take the slow path for
+       * it and try again for the ones after it */
+      j = i + handled;
+      result = process_rtp_slow (sess, &pinfos[j]);
+      j++;
+    }
+  }
+
+  for (i = 0; i < len; i++) {
+    if (valid[i])
+      clean_packet_info (&pinfos[i]);
+    else if (pinfos[i].data)
+      gst_buffer_unref (GST_BUFFER_CAST (pinfos[i].data));
+  }
+  g_free (valid);
+  g_free (pinfos);
+
+done:
+  gst_buffer_list_unref (list);
+
+  return result;
+}
+
 static void
 rtp_session_process_rb (RTPSession * sess, RTPSource * source,
     GstRTCPPacket * packet, RTPPacketInfo * pinfo)
@@ -2324,7 +2484,7 @@ rtp_session_process_fir (RTPSession * sess, guint32 sender_ssrc,
     if (sess->stats.sender_sources > sess->stats.internal_sender_sources + 1)
       return;
 
-    g_hash_table_iter_init (&iter, sess->ssrcs[sess->mask_idx]);
+    g_hash_table_iter_init (&iter, sess->ssrcs);
     while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & src)) {
       if (!src->internal && rtp_source_is_sender (src))
         break;
@@ -2691,7 +2851,7 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
       /* If it is <= 0, then try to estimate the actual bandwidth */
       bandwidth = 0;
 
-      g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+      g_hash_table_foreach (sess->ssrcs,
           (GHFunc) add_bitrates, &bandwidth);
       bandwidth /= 8.0;
     }
@@ -2744,7 +2904,7 @@ rtp_session_mark_all_bye (RTPSession * sess, const gchar * reason)
   g_return_if_fail (RTP_IS_SESSION (sess));
 
   RTP_SESSION_LOCK (sess);
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  g_hash_table_foreach (sess->ssrcs,
       (GHFunc) source_mark_bye, (gpointer) reason);
   RTP_SESSION_UNLOCK (sess);
 }
@@ -2918,6 +3078,57 @@ typedef struct
   guint nacked_seqnums;
 } ReportData;
 
+static void
+rtp_session_free_rtcp_pool (RTPSession * sess)
+{
+  if (sess->rtcp_pool == NULL)
+    return;
+
+  gst_buffer_pool_set_active (sess->rtcp_pool, FALSE);
+  gst_object_unref (sess->rtcp_pool);
+  sess->rtcp_pool = NULL;
+  sess->rtcp_pool_size = 0;
+}
+
+/* get an empty buffer of mtu bytes for a new RTCP packet. The buffers come
+ * from a pool so that the periodic reports of many sessions don't allocate
+ * all the time. Must be called with the session lock */
+static GstBuffer *
+session_alloc_rtcp (RTPSession * sess)
+{
+  GstBuffer *buffer = NULL;
+
+  if (sess->rtcp_pool && sess->rtcp_pool_size != sess->mtu)
+    rtp_session_free_rtcp_pool (sess);
+
+  if (sess->rtcp_pool == NULL) {
+    GstStructure *config;
+
+    sess->rtcp_pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (sess->rtcp_pool);
+    gst_buffer_pool_config_set_params (config, NULL, sess->mtu, 0, 0);
+    if (!gst_buffer_pool_set_config (sess->rtcp_pool, config) ||
+        !gst_buffer_pool_set_active (sess->rtcp_pool, TRUE)) {
+      GST_WARNING ("could not activate RTCP buffer pool");
+      gst_object_unref (sess->rtcp_pool);
+      sess->rtcp_pool = NULL;
+      return gst_rtcp_buffer_new (sess->mtu);
+    }
+    sess->rtcp_pool_size = sess->mtu;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (sess->rtcp_pool, &buffer,
+          NULL) != GST_FLOW_OK)
+    return gst_rtcp_buffer_new (sess->mtu);
+
+  /* the buffer was trimmed to the previous packet, the RTCP buffer API finds
+   * the end of the packets it holds by parsing, so clear it completely */
+  gst_buffer_set_size (buffer, sess->mtu);
+  gst_buffer_memset (buffer, 0, 0, sess->mtu);
+
+  return buffer;
+}
+
 static void
 session_start_rtcp (RTPSession * sess, ReportData * data)
 {
@@ -2925,7 +3136,7 @@ session_start_rtcp (RTPSession * sess, ReportData * data)
   RTPSource *own = data->source;
   GstRTCPBuffer *rtcp = &data->rtcpbuf;
 
-  data->rtcp = gst_rtcp_buffer_new (sess->mtu);
+  data->rtcp = session_alloc_rtcp (sess);
   data->has_sdes = FALSE;
 
   gst_rtcp_buffer_map (data->rtcp, GST_MAP_READWRITE, rtcp);
@@ -3059,7 +3270,7 @@ session_fir (RTPSession * sess, ReportData * data)
   gst_rtcp_packet_fb_set_sender_ssrc (packet, data->source->ssrc);
   gst_rtcp_packet_fb_set_media_ssrc (packet, 0);
 
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  g_hash_table_foreach (sess->ssrcs,
       (GHFunc) session_add_fir, data);
 
   if (gst_rtcp_packet_fb_get_fci_length (packet) == 0)
@@ -3219,7 +3430,9 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
     /* sources that were inactive for more than 5 times the deterministic reporting
      * interval get timed out. the min timeout is 5 seconds. */
     /* mind old time that might pre-date last time going to PLAYING */
+    RTP_SOURCE_LOCK (source);
     btime = MAX (source->last_activity, sess->start_time);
+    RTP_SOURCE_UNLOCK (source);
     if (data->current_time > btime) {
       interval = MAX (binterval * 5, 5 * GST_SECOND);
       if (data->current_time - btime > interval) {
@@ -3234,7 +3447,9 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
    * holds for our own sources. */
   if (is_sender) {
     /* mind old time that might pre-date last time going to PLAYING */
+    RTP_SOURCE_LOCK (source);
     btime = MAX (source->last_rtp_activity, sess->start_time);
+    RTP_SOURCE_UNLOCK (source);
     if (data->current_time > btime) {
       interval = MAX (binterval * 2, 5 * GST_SECOND);
       if (data->current_time - btime > interval) {
@@ -3271,7 +3486,9 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
       on_timeout (sess, source);
   } else {
     if (sendertimeout) {
+      RTP_SOURCE_LOCK (source);
       source->is_sender = FALSE;
+      RTP_SOURCE_UNLOCK (source);
       sess->stats.sender_sources--;
       if (source->internal)
         sess->stats.internal_sender_sources--;
@@ -3507,7 +3724,7 @@ generate_rtcp (const gchar * key, RTPSource * source, ReportData * data)
   } else if (!data->is_early) {
     /* loop over all known sources and add report blocks. If we are early, we
      * just make a minimal RTCP packet and skip this step */
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    g_hash_table_foreach (sess->ssrcs,
         (GHFunc) session_report_blocks, data);
   }
   if (!data->has_sdes)
@@ -3517,11 +3734,11 @@ generate_rtcp (const gchar * key, RTPSource * source, ReportData * data)
     session_fir (sess, data);
 
   if (data->have_pli)
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    g_hash_table_foreach (sess->ssrcs,
         (GHFunc) session_pli, data);
 
   if (data->have_nack)
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    g_hash_table_foreach (sess->ssrcs,
         (GHFunc) session_nack, data);
 
   gst_rtcp_buffer_unmap (&data->rtcpbuf);
@@ -3617,7 +3834,7 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
    * cleanup stage below releases the session lock. */
   table_copy = g_hash_table_new_full (NULL, NULL, NULL,
       (GDestroyNotify) g_object_unref);
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  g_hash_table_foreach (sess->ssrcs,
       (GHFunc) clone_ssrcs_hashtable, table_copy);
 
   /* Clean up the session, mark the source for removing, this might release the
@@ -3626,8 +3843,10 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
   g_hash_table_destroy (table_copy);
 
   /* Now remove the marked sources */
-  g_hash_table_foreach_remove (sess->ssrcs[sess->mask_idx],
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
+  g_hash_table_foreach_remove (sess->ssrcs,
       (GHRFunc) remove_closing_sources, &data);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
 
   /* update point-to-point status */
   session_update_ptp (sess);
@@ -3640,11 +3859,11 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
       sess->generation, data.num_to_report, data.is_early);
 
   /* generate RTCP for all internal sources */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  g_hash_table_foreach (sess->ssrcs,
       (GHFunc) generate_rtcp, &data);
 
   /* update the generation for all the sources that have been reported */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  g_hash_table_foreach (sess->ssrcs,
       (GHFunc) update_generation, &data);
 
   /* we keep track of the last report time in order to timeout inactive
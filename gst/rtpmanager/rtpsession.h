@@ -216,11 +216,12 @@ struct _RTPSession {
 
   guint32       suggested_ssrc;
 
-  /* for sender/receiver counting */
-  guint32       key;
-  guint32       mask_idx;
-  guint32       mask;
-  GHashTable   *ssrcs[32];
+  /* the ssrcs table is only changed with both the session lock and the
+   * write lock of ssrcs_lock. Lookups either take the session lock or the
+   * read lock, the latter is used to handle RTP packets of validated sources
+   * without taking the session lock */
+  GRWLock       ssrcs_lock;
+  GHashTable   *ssrcs;
   guint         total_sources;
 
   guint16       generation;
@@ -256,6 +257,10 @@ struct _RTPSession {
   gboolean     last_keyframe_all_headers;
 
   gboolean      is_doing_ptp;
+
+  /* recycled buffers of mtu bytes for the RTCP packets we generate */
+  GstBufferPool *rtcp_pool;
+  guint          rtcp_pool_size;
 };
 
 /**
@@ -331,6 +336,7 @@ guint32         rtp_session_suggest_ssrc           (RTPSession *sess);
 gboolean        rtp_session_add_source             (RTPSession *sess, RTPSource *src);
 guint           rtp_session_get_num_sources        (RTPSession *sess);
 guint           rtp_session_get_num_active_sources (RTPSession *sess);
+void            rtp_session_clear_clock_rates      (RTPSession *sess);
 RTPSource*      rtp_session_get_source_by_ssrc     (RTPSession *sess, guint32 ssrc);
 RTPSource*      rtp_session_create_source          (RTPSession *sess);
 
@@ -339,6 +345,10 @@ GstFlowReturn   rtp_session_process_rtp            (RTPSession *sess, GstBuffer
                                                     GstClockTime current_time,
 						    GstClockTime running_time,
                                                     guint64 ntpnstime);
+GstFlowReturn   rtp_session_process_rtp_list       (RTPSession *sess, GstBufferList *list,
+                                                    GstClockTime current_time,
+                                                    GstClockTime running_time,
+                                                    guint64 ntpnstime);
 GstFlowReturn   rtp_session_process_rtcp           (RTPSession *sess, GstBuffer *buffer,
                                                     GstClockTime current_time,
                                                     guint64 ntpnstime);
@@ -264,6 +264,8 @@ rtp_source_init (RTPSource * src)
 
   src->reported_in_sr_of = g_hash_table_new (g_direct_hash, g_direct_equal);
 
+  g_mutex_init (&src->lock);
+
   rtp_source_reset (src);
 }
 
@@ -309,6 +311,8 @@ rtp_source_finalize (GObject * object)
 
   g_hash_table_unref (src->reported_in_sr_of);
 
+  g_mutex_clear (&src->lock);
+
   G_OBJECT_CLASS (rtp_source_parent_class)->finalize (object);
 }
 
@@ -358,6 +362,7 @@ rtp_source_create_stats (RTPSource * src)
     g_free (address_str);
   }
 
+  RTP_SOURCE_LOCK (src);
   gst_structure_set (s,
       "octets-sent", G_TYPE_UINT64, src->stats.octets_sent,
       "packets-sent", G_TYPE_UINT64, src->stats.packets_sent,
@@ -367,6 +372,7 @@ rtp_source_create_stats (RTPSource * src)
       "packets-lost", G_TYPE_INT,
       (gint) rtp_stats_get_packets_lost (&src->stats), "jitter", G_TYPE_UINT,
       (guint) (src->stats.jitter >> 4), NULL);
+  RTP_SOURCE_UNLOCK (src);
 
   /* get the last SR. */
   have_sr = rtp_source_get_last_sr (src, &time, &ntptime, &rtptime,
@@ -763,6 +769,9 @@ rtp_source_update_caps (RTPSource * src, GstCaps * caps)
 
   GST_DEBUG ("got clock-rate %d", src->clock_rate);
 
+  if (src->payload >= 0 && src->payload < 128 && src->clock_rate > 0)
+    src->pt_clock_rates[src->payload] = src->clock_rate;
+
   if (gst_structure_get_uint (s, "seqnum-base", &val))
     src->seqnum_base = val;
   else
@@ -773,6 +782,24 @@ rtp_source_update_caps (RTPSource * src, GstCaps * caps)
   gst_caps_replace (&src->caps, caps);
 }
 
+
+/**
+ * rtp_source_clear_clock_rates:
+ * @src: an #RTPSource
+ *
+ * Forget the clock-rates that @src remembered for the payload types it has
+ * seen, so that they are requested again when the payload type changes.
+ */
+void
+rtp_source_clear_clock_rates (RTPSource * src)
+{
+  g_return_if_fail (RTP_IS_SOURCE (src));
+
+  RTP_SOURCE_LOCK (src);
+  memset (src->pt_clock_rates, 0, sizeof (src->pt_clock_rates));
+  RTP_SOURCE_UNLOCK (src);
+}
+
 /**
  * rtp_source_set_rtp_from:
  * @src: an #RTPSource
@@ -784,11 +811,17 @@ rtp_source_update_caps (RTPSource * src, GstCaps * caps)
 void
 rtp_source_set_rtp_from (RTPSource * src, GSocketAddress * address)
 {
+  GSocketAddress *old;
+
   g_return_if_fail (RTP_IS_SOURCE (src));
 
-  if (src->rtp_from)
-    g_object_unref (src->rtp_from);
+  RTP_SOURCE_LOCK (src);
+  old = src->rtp_from;
   src->rtp_from = G_SOCKET_ADDRESS (g_object_ref (address));
+  RTP_SOURCE_UNLOCK (src);
+
+  if (old)
+    g_object_unref (old);
 }
 
 /**
@@ -834,32 +867,64 @@ push_packet (RTPSource * src, GstBuffer * buffer)
   return ret;
 }
 
-static gint
-get_clock_rate (RTPSource * src, guint8 payload)
+/* switch @src to @payload, using the clock-rate we remember for it. Returns
+ * FALSE when the clock-rate is not known. Must be called with the source
+ * lock */
+static gboolean
+switch_payload (RTPSource * src, guint8 payload)
 {
+  if (payload == src->payload)
+    return src->clock_rate != -1;
+
   if (src->payload == -1) {
-    /* first payload received, nothing was in the caps, lock on to this payload */
-    src->payload = payload;
+    /* first payload received, nothing was in the caps, lock on to this
+     * payload and keep the clock-rate the caps might have had */
     GST_DEBUG ("first payload %d", payload);
-  } else if (payload != src->payload) {
-    /* we have a different payload than before, reset the clock-rate */
+    src->payload = payload;
+    if (src->clock_rate > 0)
+      src->pt_clock_rates[payload & 0x7f] = src->clock_rate;
+  } else {
+    /* we have a different payload than before, take its clock-rate */
     GST_DEBUG ("new payload %d", payload);
     src->payload = payload;
-    src->clock_rate = -1;
     src->stats.transit = -1;
   }
 
-  if (src->clock_rate == -1) {
-    gint clock_rate = -1;
+  src->clock_rate = src->pt_clock_rates[payload & 0x7f];
+  if (src->clock_rate == 0)
+    src->clock_rate = -1;
+
+  return src->clock_rate != -1;
+}
 
+/* must be called without the source lock, the clock-rate callback releases
+ * the session lock. The callback is only used the first time a payload type
+ * is seen, switching between known payload types only needs the source */
+static gint
+get_clock_rate (RTPSource * src, guint8 payload)
+{
+  gint clock_rate;
+
+  RTP_SOURCE_LOCK (src);
+  switch_payload (src, payload);
+  clock_rate = src->clock_rate;
+  RTP_SOURCE_UNLOCK (src);
+
+  if (clock_rate == -1) {
     if (src->callbacks.clock_rate)
       clock_rate = src->callbacks.clock_rate (src, payload, src->user_data);
 
     GST_DEBUG ("got clock-rate %d", clock_rate);
 
-    src->clock_rate = clock_rate;
+    RTP_SOURCE_LOCK (src);
+    /* the payload could have changed while we were unlocked */
+    if (src->payload == payload)
+      src->clock_rate = clock_rate;
+    if (clock_rate > 0)
+      src->pt_clock_rates[payload & 0x7f] = clock_rate;
+    RTP_SOURCE_UNLOCK (src);
   }
-  return src->clock_rate;
+  return clock_rate;
 }
 
 /* Jitter is the variation in the delay of received packets in a flow. It is
@@ -868,12 +933,11 @@ get_clock_rate (RTPSource * src, guint8 payload)
  * 50 milliseconds apart and arrive 60 milliseconds apart, then the jitter is 10
  * milliseconds. */
 static void
-calculate_jitter (RTPSource * src, RTPPacketInfo * pinfo)
+calculate_jitter (RTPSource * src, RTPPacketInfo * pinfo, gint clock_rate)
 {
   GstClockTime running_time;
   guint32 rtparrival, transit, rtptime;
   gint32 diff;
-  gint clock_rate;
   guint8 pt;
 
   /* get arrival time */
@@ -884,8 +948,7 @@ calculate_jitter (RTPSource * src, RTPPacketInfo * pinfo)
 
   GST_LOG ("SSRC %08x got payload %d", src->ssrc, pt);
 
-  /* get clockrate */
-  if ((clock_rate = get_clock_rate (src, pt)) == -1)
+  if (clock_rate == -1)
     goto no_clock_rate;
 
   rtptime = pinfo->rtptime;
@@ -1101,12 +1164,20 @@ GstFlowReturn
 rtp_source_process_rtp (RTPSource * src, RTPPacketInfo * pinfo)
 {
   GstFlowReturn result;
+  gint clock_rate = -1;
 
   g_return_val_if_fail (RTP_IS_SOURCE (src), GST_FLOW_ERROR);
   g_return_val_if_fail (pinfo != NULL, GST_FLOW_ERROR);
 
-  if (!update_receiver_stats (src, pinfo))
+  /* get clockrate */
+  if (pinfo->running_time != GST_CLOCK_TIME_NONE)
+    clock_rate = get_clock_rate (src, pinfo->pt);
+
+  RTP_SOURCE_LOCK (src);
+  if (!update_receiver_stats (src, pinfo)) {
+    RTP_SOURCE_UNLOCK (src);
     return GST_FLOW_OK;
+  }
 
   /* the source that sent the packet must be a sender */
   src->is_sender = TRUE;
@@ -1115,7 +1186,8 @@ rtp_source_process_rtp (RTPSource * src, RTPPacketInfo * pinfo)
   do_bitrate_estimation (src, pinfo->running_time, &src->bytes_received);
 
   /* calculate jitter for the stats */
-  calculate_jitter (src, pinfo);
+  calculate_jitter (src, pinfo, clock_rate);
+  RTP_SOURCE_UNLOCK (src);
 
   /* we're ready to push the RTP packet now */
   result = push_packet (src, pinfo->data);
@@ -1124,6 +1196,85 @@ rtp_source_process_rtp (RTPSource * src, RTPPacketInfo * pinfo)
   return result;
 }
 
+/**
+ * rtp_source_process_rtp_fast:
+ * @src: an #RTPSource
+ * @pinfos: an array of #RTPPacketInfo
+ * @n_pinfos: the number of packets in @pinfos
+ * @bitrate_changed: set to %TRUE when the bitrate estimation changed
+ *
+ * Update the receiver statistics of @src for the RTP packets described in
+ * @pinfos without requiring the session lock. The source lock is taken only
+ * once for all packets. This is only possible for validated remote senders
+ * that have nothing queued, for packets with a known clock-rate for the
+ * payload, a matching source address and without CSRCs. Processing stops at
+ * the first packet that does not qualify, that packet and the ones after it
+ * need to be handled with rtp_source_process_rtp().
+ *
+ * For the handled packets that should be pushed, the data is left in the
+ * #RTPPacketInfo for the caller, the others were dropped.
+ *
+ * Returns: the number of handled packets.
+ */
+guint
+rtp_source_process_rtp_fast (RTPSource * src, RTPPacketInfo * pinfos,
+    guint n_pinfos, gboolean * bitrate_changed)
+{
+  GstClockTime running_time = GST_CLOCK_TIME_NONE;
+  guint64 oldrate;
+  guint i = 0;
+
+  g_return_val_if_fail (RTP_IS_SOURCE (src), 0);
+  g_return_val_if_fail (pinfos != NULL, 0);
+
+  *bitrate_changed = FALSE;
+
+  RTP_SOURCE_LOCK (src);
+  if (src->internal || !src->validated || !src->is_sender || src->marked_bye)
+    goto done;
+  if (src->curr_probation || !g_queue_is_empty (src->packets))
+    goto done;
+
+  for (i = 0; i < n_pinfos; i++) {
+    RTPPacketInfo *pinfo = &pinfos[i];
+
+    if (pinfo->csrc_count > 0)
+      break;
+    /* switching to a payload type with a known clock-rate needs no
+     * session */
+    if (!switch_payload (src, pinfo->pt))
+      break;
+    /* collision checking needs the session */
+    if (pinfo->address && (src->rtp_from == NULL ||
+            !__g_socket_address_equal (src->rtp_from, pinfo->address)))
+      break;
+
+    src->last_activity = pinfo->current_time;
+    src->last_rtp_activity = pinfo->current_time;
+
+    if (update_receiver_stats (src, pinfo)) {
+      calculate_jitter (src, pinfo, src->clock_rate);
+      running_time = pinfo->running_time;
+    } else {
+      gst_mini_object_unref (pinfo->data);
+      pinfo->data = NULL;
+    }
+  }
+
+  /* the bitrate is estimated over an interval, once for all packets is
+   * enough */
+  if (running_time != GST_CLOCK_TIME_NONE) {
+    oldrate = src->bitrate;
+    do_bitrate_estimation (src, running_time, &src->bytes_received);
+    *bitrate_changed = oldrate != src->bitrate;
+  }
+
+done:
+  RTP_SOURCE_UNLOCK (src);
+
+  return i;
+}
+
 /**
  * rtp_source_mark_bye:
  * @src: an #RTPSource
@@ -1453,6 +1604,7 @@ rtp_source_get_new_rb (RTPSource * src, GstClockTime time,
 
   stats = &src->stats;
 
+  RTP_SOURCE_LOCK (src);
   extended_max = stats->cycles + stats->max_seq;
   expected = extended_max - stats->base_seq + 1;
 
@@ -1481,6 +1633,10 @@ rtp_source_get_new_rb (RTPSource * src, GstClockTime time,
       ", extseq %" G_GUINT64_FORMAT ", jitter %d", fraction, lost,
       extended_max, stats->jitter >> 4);
 
+  if (jitter)
+    *jitter = stats->jitter >> 4;
+  RTP_SOURCE_UNLOCK (src);
+
   if (rtp_source_get_last_sr (src, &sr_time, &ntptime, NULL, NULL, NULL)) {
     GstClockTime diff;
 
@@ -1505,8 +1661,6 @@ rtp_source_get_new_rb (RTPSource * src, GstClockTime time,
     *packetslost = lost;
   if (exthighestseq)
     *exthighestseq = extended_max;
-  if (jitter)
-    *jitter = stats->jitter >> 4;
   if (lsr)
     *lsr = LSR;
   if (dlsr)
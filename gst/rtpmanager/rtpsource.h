@@ -68,6 +68,19 @@ typedef struct _RTPSourceClass RTPSourceClass;
  */
 #define RTP_SOURCE_IS_MARKED_BYE(src)  (src->marked_bye)
 
+/**
+ * RTP_SOURCE_LOCK:
+ * @src: an #RTPSource
+ *
+ * Lock the receiver statistics of @src. RTP packets of validated sources are
+ * handled without the session lock, so the fields that are updated for each
+ * received packet are only accessed with this lock taken. Fields that are
+ * read without the session lock are changed with both locks taken. The
+ * session lock is always taken first.
+ */
+#define RTP_SOURCE_LOCK(src)     (g_mutex_lock (&(src)->lock))
+#define RTP_SOURCE_UNLOCK(src)   (g_mutex_unlock (&(src)->lock))
+
 
 /**
  * RTPSourcePushRTP:
@@ -133,6 +146,8 @@ struct _RTPSource {
   GObject       object;
 
   /*< private >*/
+  GMutex        lock;
+
   guint32       ssrc;
 
   guint16       generation;
@@ -160,6 +175,9 @@ struct _RTPSource {
   gint          clock_rate;
   gint32        seqnum_base;
 
+  /* clock-rates of the payload types seen so far, 0 if unknown */
+  gint          pt_clock_rates[128];
+
   GstClockTime  bye_time;
   GstClockTime  last_activity;
   GstClockTime  last_rtp_activity;
@@ -220,6 +238,7 @@ gboolean        rtp_source_is_marked_bye       (RTPSource *src);
 gchar *         rtp_source_get_bye_reason      (RTPSource *src);
 
 void            rtp_source_update_caps         (RTPSource *src, GstCaps *caps);
+void            rtp_source_clear_clock_rates   (RTPSource *src);
 
 /* SDES info */
 const GstStructure *
@@ -232,6 +251,8 @@ void            rtp_source_set_rtcp_from       (RTPSource *src, GSocketAddress *
 
 /* handling RTP */
 GstFlowReturn   rtp_source_process_rtp         (RTPSource *src, RTPPacketInfo *pinfo);
+guint           rtp_source_process_rtp_fast    (RTPSource *src, RTPPacketInfo *pinfos,
+                                                guint n_pinfos, gboolean *bitrate_changed);
 
 GstFlowReturn   rtp_source_send_rtp            (RTPSource *src, RTPPacketInfo *pinfo);
 
@@ -189,6 +189,7 @@ gst_rtsp_src_buffer_mode_get_type (void)
 #define DEFAULT_NTP_SYNC         FALSE
 #define DEFAULT_USE_PIPELINE_CLOCK      FALSE
 #define DEFAULT_TLS_VALIDATION_FLAGS G_TLS_CERTIFICATE_VALIDATE_ALL
+#define DEFAULT_PIPELINE_SETUP   FALSE
 
 enum
 {
@@ -222,6 +223,7 @@ enum
   PROP_USE_PIPELINE_CLOCK,
   PROP_SDES,
   PROP_TLS_VALIDATION_FLAGS,
+  PROP_PIPELINE_SETUP,
   PROP_LAST
 };
 
@@ -584,6 +586,22 @@ gst_rtspsrc_class_init (GstRTSPSrcClass * klass)
           G_TYPE_TLS_CERTIFICATE_FLAGS, DEFAULT_TLS_VALIDATION_FLAGS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRTSPSrc::pipeline-setup:
+   *
+   * Once the first stream has been set up, send the SETUP requests of all
+   * other streams without waiting for each reply. The replies are matched
+   * to the requests by their CSeq. This saves a round trip per stream on
+   * high latency links.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_PIPELINE_SETUP,
+      g_param_spec_boolean ("pipeline-setup", "Pipeline SETUP",
+          "Send the SETUP requests of the streams without waiting for "
+          "each reply", DEFAULT_PIPELINE_SETUP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstRTSPSrc::handle-request:
    * @rtspsrc: a #GstRTSPSrc
@@ -697,6 +715,7 @@ gst_rtspsrc_init (GstRTSPSrc * src)
   src->use_pipeline_clock = DEFAULT_USE_PIPELINE_CLOCK;
   src->sdes = NULL;
   src->tls_validation_flags = DEFAULT_TLS_VALIDATION_FLAGS;
+  src->pipeline_setup = DEFAULT_PIPELINE_SETUP;
 
   /* get a list of all extensions */
   src->extensions = gst_rtsp_ext_list_get ();
@@ -954,6 +973,9 @@ gst_rtspsrc_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_TLS_VALIDATION_FLAGS:
       rtspsrc->tls_validation_flags = g_value_get_flags (value);
       break;
+    case PROP_PIPELINE_SETUP:
+      rtspsrc->pipeline_setup = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1082,6 +1104,9 @@ gst_rtspsrc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_TLS_VALIDATION_FLAGS:
       g_value_set_flags (value, rtspsrc->tls_validation_flags);
       break;
+    case PROP_PIPELINE_SETUP:
+      g_value_set_boolean (value, rtspsrc->pipeline_setup);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1390,6 +1415,58 @@ gst_rtspsrc_create_stream (GstRTSPSrc * src, GstSDPMessage * sdp, gint idx)
   /* ERRORS */
 }
 
+/* UDP port pairs handed out to the streams of all rtspsrc instances in the
+ * process. Without it, many instances sharing a port-range all start probing
+ * at the bottom of the range and run out of retries on each other's ports
+ * long before the range is used up. */
+G_LOCK_DEFINE_STATIC (used_ports);
+static GHashTable *used_ports = NULL;
+
+/* Reserve the first RTP/RTCP port pair from @start that is not used by
+ * another stream in this process. Returns the RTP port or 0 when the range
+ * is exhausted. */
+static gint
+gst_rtspsrc_reserve_ports (GstRTSPSrc * src, gint start)
+{
+  gint port, max;
+
+  max = src->client_port_range.max > 0 ? src->client_port_range.max : 65535;
+
+  G_LOCK (used_ports);
+  if (used_ports == NULL)
+    used_ports = g_hash_table_new (NULL, NULL);
+
+  /* RTP must be on an even port, RTCP on the next one */
+  for (port = start + (start & 1); port + 1 <= max; port += 2) {
+    if (!g_hash_table_contains (used_ports, GINT_TO_POINTER (port)))
+      break;
+  }
+  if (port + 1 <= max)
+    g_hash_table_add (used_ports, GINT_TO_POINTER (port));
+  else
+    port = 0;
+  G_UNLOCK (used_ports);
+
+  return port;
+}
+
+static void
+gst_rtspsrc_release_ports (gint port)
+{
+  G_LOCK (used_ports);
+  g_hash_table_remove (used_ports, GINT_TO_POINTER (port));
+  G_UNLOCK (used_ports);
+}
+
+static void
+gst_rtspsrc_stream_release_ports (GstRTSPStream * stream)
+{
+  if (stream->reserved_port != 0) {
+    gst_rtspsrc_release_ports (stream->reserved_port);
+    stream->reserved_port = 0;
+  }
+}
+
 static void
 gst_rtspsrc_stream_free (GstRTSPSrc * src, GstRTSPStream * stream)
 {
@@ -1404,6 +1481,8 @@ gst_rtspsrc_stream_free (GstRTSPSrc * src, GstRTSPStream * stream)
   g_free (stream->control_url);
   g_free (stream->conninfo.location);
 
+  gst_rtspsrc_stream_release_ports (stream);
+
   for (i = 0; i < 2; i++) {
     if (stream->udpsrc[i]) {
       gst_element_set_state (stream->udpsrc[i], GST_STATE_NULL);
@@ -1415,6 +1494,10 @@ gst_rtspsrc_stream_free (GstRTSPSrc * src, GstRTSPStream * stream)
       gst_object_unref (stream->channelpad[i]);
       stream->channelpad[i] = NULL;
     }
+    if (stream->queued[i]) {
+      gst_buffer_list_unref (stream->queued[i]);
+      stream->queued[i] = NULL;
+    }
     if (stream->udpsink[i]) {
       gst_element_set_state (stream->udpsink[i], GST_STATE_NULL);
       gst_bin_remove (GST_BIN_CAST (src), stream->udpsink[i]);
@@ -1787,6 +1870,7 @@ gst_rtspsrc_alloc_udp_ports (GstRTSPStream * stream,
   GstStateChangeReturn ret;
   GstElement *udpsrc0, *udpsrc1;
   gint tmp_rtp, tmp_rtcp;
+  gint reserved = 0;
   guint count;
   const gchar *host;
 
@@ -1807,11 +1891,22 @@ gst_rtspsrc_alloc_udp_ports (GstRTSPStream * stream,
   /* try to allocate 2 UDP ports, the RTP port should be an even
    * number and the RTCP port should be the next (uneven) port */
 again:
+  if (reserved != 0) {
+    gst_rtspsrc_release_ports (reserved);
+    reserved = 0;
+  }
 
   if (tmp_rtp != 0 && src->client_port_range.max > 0 &&
       tmp_rtp >= src->client_port_range.max)
     goto no_ports;
 
+  if (tmp_rtp != 0) {
+    /* skip the ports used by other streams in this process */
+    if ((reserved = gst_rtspsrc_reserve_ports (src, tmp_rtp)) == 0)
+      goto no_ports;
+    tmp_rtp = reserved;
+  }
+
   udpsrc0 = gst_element_make_from_uri (GST_URI_SRC, host, NULL, NULL);
   if (udpsrc0 == NULL)
     goto no_udp_protocol;
@@ -1912,6 +2007,7 @@ again:
   stream->udpsrc[1] = gst_object_ref_sink (udpsrc1);
   gst_element_set_locked_state (stream->udpsrc[0], TRUE);
   gst_element_set_locked_state (stream->udpsrc[1], TRUE);
+  stream->reserved_port = reserved;
 
   /* keep track of next available port number when we have a range
    * configured */
@@ -1953,6 +2049,8 @@ cleanup:
       gst_element_set_state (udpsrc1, GST_STATE_NULL);
       gst_object_unref (udpsrc1);
     }
+    if (reserved != 0)
+      gst_rtspsrc_release_ports (reserved);
     return FALSE;
   }
 }
@@ -2887,6 +2985,7 @@ gst_rtspsrc_stream_free_udp (GstRTSPStream * stream)
       stream->udpsrc[i] = NULL;
     }
   }
+  gst_rtspsrc_stream_release_ports (stream);
 }
 
 /* for TCP, create pads to send and receive data to and from the manager and to
@@ -3913,8 +4012,12 @@ send_error:
   }
 }
 
+/* Turn the interleaved data in @message into a buffer for the channel pad.
+ * With @queue the buffer is added to the list of its channel, to be pushed
+ * with gst_rtspsrc_push_queued(), instead of pushing it right away. */
 static GstFlowReturn
-gst_rtspsrc_handle_data (GstRTSPSrc * src, GstRTSPMessage * message)
+gst_rtspsrc_handle_data_full (GstRTSPSrc * src, GstRTSPMessage * message,
+    gboolean queue)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   gint channel;
@@ -4044,6 +4147,15 @@ gst_rtspsrc_handle_data (GstRTSPSrc * src, GstRTSPMessage * message)
     GST_BUFFER_TIMESTAMP (buf) = src->base_time;
   }
 
+  if (queue) {
+    GstBufferList **list = &stream->queued[is_rtcp ? 1 : 0];
+
+    if (*list == NULL)
+      *list = gst_buffer_list_new ();
+    gst_buffer_list_add (*list, buf);
+    return GST_FLOW_OK;
+  }
+
   /* chain to the peer pad */
   if (GST_PAD_IS_SINK (outpad))
     ret = gst_pad_chain (outpad, buf);
@@ -4072,6 +4184,94 @@ invalid_length:
   }
 }
 
+static GstFlowReturn
+gst_rtspsrc_handle_data (GstRTSPSrc * src, GstRTSPMessage * message)
+{
+  return gst_rtspsrc_handle_data_full (src, message, FALSE);
+}
+
+/* push the buffers queued by gst_rtspsrc_handle_data_full() as lists */
+static GstFlowReturn
+gst_rtspsrc_push_queued (GstRTSPSrc * src)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GList *walk;
+
+  for (walk = src->streams; walk; walk = g_list_next (walk)) {
+    GstRTSPStream *stream = (GstRTSPStream *) walk->data;
+    gint i;
+
+    for (i = 0; i < 2; i++) {
+      GstBufferList *list = stream->queued[i];
+      GstPad *outpad = stream->channelpad[i];
+      GstFlowReturn res;
+
+      if (list == NULL)
+        continue;
+      stream->queued[i] = NULL;
+
+      if (outpad == NULL) {
+        gst_buffer_list_unref (list);
+        continue;
+      }
+
+      GST_DEBUG_OBJECT (src, "pushing list of %u buffers on channel %d",
+          gst_buffer_list_length (list), stream->channel[i]);
+
+      if (GST_PAD_IS_SINK (outpad))
+        res = gst_pad_chain_list (outpad, list);
+      else
+        res = gst_pad_push_list (outpad, list);
+
+      /* combine all stream flows for the data transport */
+      if (i == 0)
+        res = gst_rtspsrc_combine_flows (src, stream, res);
+
+      if (ret == GST_FLOW_OK)
+        ret = res;
+    }
+  }
+  return ret;
+}
+
+static void
+gst_rtspsrc_stream_clear_queued (GstRTSPStream * stream)
+{
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    if (stream->queued[i]) {
+      gst_buffer_list_unref (stream->queued[i]);
+      stream->queued[i] = NULL;
+    }
+  }
+}
+
+static void
+gst_rtspsrc_clear_queued (GstRTSPSrc * src)
+{
+  GList *walk;
+
+  for (walk = src->streams; walk; walk = g_list_next (walk))
+    gst_rtspsrc_stream_clear_queued ((GstRTSPStream *) walk->data);
+}
+
+/* Upper bound on the data messages collected before pushing them */
+#define MAX_QUEUED_DATA 64
+
+/* whether the next message can be read without waiting for the server */
+static gboolean
+gst_rtspsrc_have_pending_data (GstRTSPSrc * src)
+{
+  GSocket *socket;
+
+  socket = gst_rtsp_connection_get_read_socket (src->conninfo.connection);
+  if (socket == NULL)
+    return FALSE;
+
+  return (g_socket_condition_check (socket, G_IO_IN) & G_IO_IN) != 0;
+}
+
 static GstFlowReturn
 gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
 {
@@ -4079,6 +4279,7 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
   GstRTSPResult res;
   GstFlowReturn ret = GST_FLOW_OK;
   GTimeVal tv_timeout;
+  guint n_queued = 0;
 
   while (TRUE) {
     /* get the next timeout interval */
@@ -4112,6 +4313,12 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
         /* we got interrupted this means we need to stop */
         goto interrupt;
       case GST_RTSP_ETIMEOUT:
+        /* don't hold on to data while the server is quiet */
+        if (n_queued > 0) {
+          n_queued = 0;
+          if ((ret = gst_rtspsrc_push_queued (src)) != GST_FLOW_OK)
+            goto handle_data_failed;
+        }
         /* no reply, send keep alive */
         GST_DEBUG_OBJECT (src, "timeout, sending keep-alive");
         if ((res = gst_rtspsrc_send_keep_alive (src)) == GST_RTSP_EINTR)
@@ -4143,15 +4350,25 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
         break;
       case GST_RTSP_MESSAGE_DATA:
         GST_DEBUG_OBJECT (src, "got data message");
-        ret = gst_rtspsrc_handle_data (src, &message);
+        /* collect what the server already sent and push it in one go */
+        ret = gst_rtspsrc_handle_data_full (src, &message, TRUE);
         if (ret != GST_FLOW_OK)
           goto handle_data_failed;
+        n_queued++;
         break;
       default:
         GST_WARNING_OBJECT (src, "ignoring unknown message type %d",
             message.type);
         break;
     }
+
+    if (n_queued > 0 && (n_queued >= MAX_QUEUED_DATA ||
+            !gst_rtspsrc_have_pending_data (src))) {
+      n_queued = 0;
+      ret = gst_rtspsrc_push_queued (src);
+      if (ret != GST_FLOW_OK)
+        goto handle_data_failed;
+    }
   }
   g_assert_not_reached ();
 
@@ -4163,10 +4380,13 @@ server_eof:
         ("The server closed the connection."));
     src->conninfo.connected = FALSE;
     gst_rtsp_message_unset (&message);
+    /* what we got before the server closed is still valid */
+    gst_rtspsrc_push_queued (src);
     return GST_FLOW_EOS;
   }
 interrupt:
   {
+    gst_rtspsrc_clear_queued (src);
     gst_rtsp_message_unset (&message);
     GST_DEBUG_OBJECT (src, "got interrupted");
     return GST_FLOW_FLUSHING;
@@ -4179,6 +4399,7 @@ receive_error:
         ("Could not receive message. (%s)", str));
     g_free (str);
 
+    gst_rtspsrc_clear_queued (src);
     gst_rtsp_message_unset (&message);
     return GST_FLOW_ERROR;
   }
@@ -4189,12 +4410,14 @@ handle_request_failed:
     GST_ELEMENT_ERROR (src, RESOURCE, WRITE, (NULL),
         ("Could not handle server message. (%s)", str));
     g_free (str);
+    gst_rtspsrc_clear_queued (src);
     gst_rtsp_message_unset (&message);
     return GST_FLOW_ERROR;
   }
 handle_data_failed:
   {
     GST_DEBUG_OBJECT (src, "could no handle data message");
+    gst_rtspsrc_clear_queued (src);
     return ret;
   }
 }
@@ -4904,6 +5127,23 @@ no_user_pass:
   }
 }
 
+/* bookkeeping for a successful reply to @request */
+static void
+gst_rtspsrc_handle_response_ok (GstRTSPSrc * src, GstRTSPMessage * request,
+    GstRTSPMessage * response)
+{
+  gchar *content_base = NULL;
+
+  /* store new content base if any */
+  gst_rtsp_message_get_header (response, GST_RTSP_HDR_CONTENT_BASE,
+      &content_base, 0);
+  if (content_base) {
+    g_free (src->content_base);
+    src->content_base = g_strdup (content_base);
+  }
+  gst_rtsp_ext_list_after_send (src->extensions, request, response);
+}
+
 static GstRTSPResult
 gst_rtspsrc_try_send (GstRTSPSrc * src, GstRTSPConnection * conn,
     GstRTSPMessage * request, GstRTSPMessage * response,
@@ -4911,7 +5151,6 @@ gst_rtspsrc_try_send (GstRTSPSrc * src, GstRTSPConnection * conn,
 {
   GstRTSPResult res;
   GstRTSPStatusCode thecode;
-  gchar *content_base = NULL;
   gint try = 0;
 
 again:
@@ -4972,14 +5211,7 @@ next:
   if (thecode != GST_RTSP_STS_OK)
     return GST_RTSP_OK;
 
-  /* store new content base if any */
-  gst_rtsp_message_get_header (response, GST_RTSP_HDR_CONTENT_BASE,
-      &content_base, 0);
-  if (content_base) {
-    g_free (src->content_base);
-    src->content_base = g_strdup (content_base);
-  }
-  gst_rtsp_ext_list_after_send (src->extensions, request, response);
+  gst_rtspsrc_handle_response_ok (src, request, response);
 
   return GST_RTSP_OK;
 
@@ -5043,6 +5275,129 @@ server_eof:
   }
 }
 
+/* A request that was sent without waiting for its reply */
+typedef struct
+{
+  GstRTSPStream *stream;
+  GstRTSPMessage request;
+  GstRTSPMessage response;
+  gboolean have_response;
+} GstRTSPPendingRequest;
+
+static void
+gst_rtspsrc_pending_request_clear (GstRTSPPendingRequest * pending)
+{
+  gst_rtsp_message_unset (&pending->request);
+  gst_rtsp_message_unset (&pending->response);
+}
+
+/* Send @request on @conn and append it to @pending, which takes ownership of
+ * the request. The reply is collected later with
+ * gst_rtspsrc_receive_pipelined(). */
+static GstRTSPResult
+gst_rtspsrc_send_pipelined (GstRTSPSrc * src, GstRTSPConnection * conn,
+    GstRTSPStream * stream, GstRTSPMessage * request, GArray * pending)
+{
+  GstRTSPPendingRequest entry = { NULL, };
+  GstRTSPResult res;
+
+  if (!src->short_header)
+    gst_rtsp_ext_list_before_send (src->extensions, request);
+
+  GST_DEBUG_OBJECT (src, "sending pipelined message");
+
+  if (src->debug)
+    gst_rtsp_message_dump (request);
+
+  res = gst_rtspsrc_connection_send (src, conn, request, src->ptcp_timeout);
+  if (res < 0)
+    return res;
+
+  entry.stream = stream;
+  entry.request = *request;
+  memset (request, 0, sizeof (GstRTSPMessage));
+  g_array_append_val (pending, entry);
+
+  return GST_RTSP_OK;
+}
+
+/* Wait for the replies to all requests in @pending. The connection numbers
+ * requests consecutively, so the request at index i was sent with CSeq
+ * @first_cseq + i. Server requests and interleaved data that arrive in
+ * between are handled like in gst_rtspsrc_try_send(). */
+static GstRTSPResult
+gst_rtspsrc_receive_pipelined (GstRTSPSrc * src, GstRTSPConnection * conn,
+    GArray * pending, gint first_cseq)
+{
+  GstRTSPMessage message = { 0 };
+  GstRTSPResult res;
+  guint missing = pending->len;
+
+  while (missing > 0) {
+    GstRTSPPendingRequest *entry;
+    gchar *hval;
+    guint idx;
+
+    res = gst_rtspsrc_connection_receive (src, conn, &message,
+        src->ptcp_timeout);
+    if (res < 0)
+      goto done;
+
+    if (src->debug)
+      gst_rtsp_message_dump (&message);
+
+    switch (message.type) {
+      case GST_RTSP_MESSAGE_REQUEST:
+        res = gst_rtspsrc_handle_request (src, conn, &message);
+        if (res < 0)
+          goto done;
+        gst_rtsp_message_unset (&message);
+        continue;
+      case GST_RTSP_MESSAGE_RESPONSE:
+        break;
+      case GST_RTSP_MESSAGE_DATA:
+        GST_DEBUG_OBJECT (src, "handle data response message");
+        gst_rtspsrc_handle_data (src, &message);
+        gst_rtsp_message_unset (&message);
+        continue;
+      default:
+        GST_WARNING_OBJECT (src, "ignoring unknown message type %d",
+            message.type);
+        gst_rtsp_message_unset (&message);
+        continue;
+    }
+
+    if (gst_rtsp_message_get_header (&message, GST_RTSP_HDR_CSEQ, &hval,
+            0) == GST_RTSP_OK) {
+      idx = atoi (hval) - first_cseq;
+    } else {
+      /* no CSeq, assume the server replies in order */
+      idx = pending->len - missing;
+    }
+
+    if (idx >= pending->len
+        || g_array_index (pending, GstRTSPPendingRequest, idx).have_response) {
+      GST_WARNING_OBJECT (src, "ignoring unexpected response");
+      gst_rtsp_message_unset (&message);
+      continue;
+    }
+
+    GST_DEBUG_OBJECT (src, "got response %u of %u", idx + 1, pending->len);
+
+    entry = &g_array_index (pending, GstRTSPPendingRequest, idx);
+    entry->response = message;
+    entry->have_response = TRUE;
+    memset (&message, 0, sizeof (GstRTSPMessage));
+    missing--;
+  }
+  res = GST_RTSP_OK;
+
+done:
+  gst_rtsp_message_unset (&message);
+
+  return res;
+}
+
 /**
  * gst_rtspsrc_send:
  * @src: the rtsp source
@@ -5444,6 +5799,88 @@ gst_rtspsrc_stream_is_real_media (GstRTSPStream * stream)
   return res;
 }
 
+/* Configure @stream with the transport the server selected in the SETUP
+ * reply @response and narrow down @protocols for the other streams.
+ *
+ * Returns: %FALSE when the server did not select a transport.
+ */
+static gboolean
+gst_rtspsrc_stream_setup_reply (GstRTSPSrc * src, GstRTSPStream * stream,
+    GstRTSPMessage * response, GstRTSPLowerTrans * protocols, gint retry,
+    gint * rtpport, gint * rtcpport)
+{
+  gchar *resptrans = NULL;
+  GstRTSPTransport transport = { 0 };
+
+  gst_rtsp_message_get_header (response, GST_RTSP_HDR_TRANSPORT,
+      &resptrans, 0);
+  if (!resptrans) {
+    gst_rtspsrc_stream_free_udp (stream);
+    return FALSE;
+  }
+
+  /* parse transport, go to next stream on parse error */
+  if (gst_rtsp_transport_parse (resptrans, &transport) != GST_RTSP_OK) {
+    GST_WARNING_OBJECT (src, "failed to parse transport %s", resptrans);
+    goto done;
+  }
+
+  /* update allowed transports for other streams. once the transport of
+   * one stream has been determined, we make sure that all other streams
+   * are configured in the same way */
+  switch (transport.lower_transport) {
+    case GST_RTSP_LOWER_TRANS_TCP:
+      GST_DEBUG_OBJECT (src, "stream %p as TCP interleaved", stream);
+      *protocols = GST_RTSP_LOWER_TRANS_TCP;
+      src->interleaved = TRUE;
+      /* update free channels */
+      src->free_channel = MAX (transport.interleaved.min, src->free_channel);
+      src->free_channel = MAX (transport.interleaved.max, src->free_channel);
+      src->free_channel++;
+      break;
+    case GST_RTSP_LOWER_TRANS_UDP_MCAST:
+      /* only allow multicast for other streams */
+      GST_DEBUG_OBJECT (src, "stream %p as UDP multicast", stream);
+      *protocols = GST_RTSP_LOWER_TRANS_UDP_MCAST;
+      /* if the server selected our ports, increment our counters so that
+       * we select a new port later */
+      if (src->next_port_num == transport.port.min &&
+          src->next_port_num + 1 == transport.port.max) {
+        src->next_port_num += 2;
+      }
+      break;
+    case GST_RTSP_LOWER_TRANS_UDP:
+      /* only allow unicast for other streams */
+      GST_DEBUG_OBJECT (src, "stream %p as UDP unicast", stream);
+      *protocols = GST_RTSP_LOWER_TRANS_UDP;
+      break;
+    default:
+      GST_DEBUG_OBJECT (src, "stream %p unknown transport %d", stream,
+          transport.lower_transport);
+      break;
+  }
+
+  if (!stream->container || (!src->interleaved && !retry)) {
+    /* now configure the stream with the selected transport */
+    if (!gst_rtspsrc_stream_configure_transport (stream, &transport)) {
+      GST_DEBUG_OBJECT (src,
+          "could not configure stream %p transport, skipping stream", stream);
+      goto done;
+    } else if (stream->udpsrc[0] && stream->udpsrc[1]) {
+      /* retain the first allocated UDP port pair */
+      g_object_get (G_OBJECT (stream->udpsrc[0]), "port", rtpport, NULL);
+      g_object_get (G_OBJECT (stream->udpsrc[1]), "port", rtcpport, NULL);
+    }
+  }
+  /* we need to activate at least one streams when we detect activity */
+  src->need_activate = TRUE;
+done:
+  /* clean up our transport struct */
+  gst_rtsp_transport_init (&transport);
+
+  return TRUE;
+}
+
 /* Perform the SETUP request for all the streams.
  *
  * We ask the server for a specific transport, which initially includes all the
@@ -5470,6 +5907,8 @@ gst_rtspsrc_setup_streams (GstRTSPSrc * src, gboolean async)
   gint rtpport, rtcpport;
   GstRTSPUrl *url;
   gchar *hval;
+  GArray *pending = NULL;
+  gint first_cseq = 0;
 
   if (src->conninfo.connection) {
     url = gst_rtsp_connection_get_url (src->conninfo.connection);
@@ -5623,6 +6062,17 @@ gst_rtspsrc_setup_streams (GstRTSPSrc * src, gboolean async)
       GST_ELEMENT_PROGRESS (src, CONTINUE, "request", ("SETUP stream %d",
               stream->id));
 
+    /* the reply is handled after all the other requests were sent */
+    if (pending && !stream->container && !retry) {
+      if ((res = gst_rtspsrc_send_pipelined (src, conn, stream, &request,
+                  pending)) < 0)
+        goto send_error;
+      /* the reply that moves the free channel along is not parsed yet */
+      if (src->interleaved)
+        src->free_channel += 2;
+      continue;
+    }
+
     /* handle the code ourselves */
     if ((res = gst_rtspsrc_send (src, conn, &request, &response, &code) < 0))
       goto send_error;
@@ -5663,84 +6113,65 @@ gst_rtspsrc_setup_streams (GstRTSPSrc * src, gboolean async)
         goto response_error;
     }
 
-    /* parse response transport */
-    {
-      gchar *resptrans = NULL;
-      GstRTSPTransport transport = { 0 };
+    if (!gst_rtspsrc_stream_setup_reply (src, stream, &response, &protocols,
+            retry, &rtpport, &rtcpport))
+      goto no_transport;
 
-      gst_rtsp_message_get_header (&response, GST_RTSP_HDR_TRANSPORT,
-          &resptrans, 0);
-      if (!resptrans) {
-        gst_rtspsrc_stream_free_udp (stream);
-        goto no_transport;
-      }
+    /* the transport and the session are known now, the following requests
+     * can be sent back to back */
+    if (src->pipeline_setup && pending == NULL && src->conninfo.connection &&
+        gst_rtsp_message_get_header (&response, GST_RTSP_HDR_CSEQ, &hval,
+            0) == GST_RTSP_OK) {
+      first_cseq = atoi (hval) + 1;
+      pending = g_array_new (FALSE, TRUE, sizeof (GstRTSPPendingRequest));
+      g_array_set_clear_func (pending,
+          (GDestroyNotify) gst_rtspsrc_pending_request_clear);
+    }
 
-      /* parse transport, go to next stream on parse error */
-      if (gst_rtsp_transport_parse (resptrans, &transport) != GST_RTSP_OK) {
-        GST_WARNING_OBJECT (src, "failed to parse transport %s", resptrans);
-        goto next;
-      }
+    /* clean up used RTSP messages */
+    gst_rtsp_message_unset (&request);
+    gst_rtsp_message_unset (&response);
+  }
 
-      /* update allowed transports for other streams. once the transport of
-       * one stream has been determined, we make sure that all other streams
-       * are configured in the same way */
-      switch (transport.lower_transport) {
-        case GST_RTSP_LOWER_TRANS_TCP:
-          GST_DEBUG_OBJECT (src, "stream %p as TCP interleaved", stream);
-          protocols = GST_RTSP_LOWER_TRANS_TCP;
-          src->interleaved = TRUE;
-          /* update free channels */
-          src->free_channel =
-              MAX (transport.interleaved.min, src->free_channel);
-          src->free_channel =
-              MAX (transport.interleaved.max, src->free_channel);
-          src->free_channel++;
-          break;
-        case GST_RTSP_LOWER_TRANS_UDP_MCAST:
-          /* only allow multicast for other streams */
-          GST_DEBUG_OBJECT (src, "stream %p as UDP multicast", stream);
-          protocols = GST_RTSP_LOWER_TRANS_UDP_MCAST;
-          /* if the server selected our ports, increment our counters so that
-           * we select a new port later */
-          if (src->next_port_num == transport.port.min &&
-              src->next_port_num + 1 == transport.port.max) {
-            src->next_port_num += 2;
-          }
-          break;
-        case GST_RTSP_LOWER_TRANS_UDP:
-          /* only allow unicast for other streams */
-          GST_DEBUG_OBJECT (src, "stream %p as UDP unicast", stream);
-          protocols = GST_RTSP_LOWER_TRANS_UDP;
+  if (pending && pending->len > 0) {
+    guint i;
+
+    if ((res = gst_rtspsrc_receive_pipelined (src, src->conninfo.connection,
+                pending, first_cseq)) < 0)
+      goto receive_error;
+
+    for (i = 0; i < pending->len; i++) {
+      GstRTSPPendingRequest *entry =
+          &g_array_index (pending, GstRTSPPendingRequest, i);
+
+      stream = entry->stream;
+      code = entry->response.type_data.response.code;
+
+      switch (code) {
+        case GST_RTSP_STS_OK:
           break;
+        case GST_RTSP_STS_UNSUPPORTED_TRANSPORT:
+          /* the first stream fixed the transport, nothing left to try */
+          GST_DEBUG_OBJECT (src, "skipping stream %p, transport unsupported",
+              stream);
+          gst_rtspsrc_stream_free_udp (stream);
+          continue;
         default:
-          GST_DEBUG_OBJECT (src, "stream %p unknown transport %d", stream,
-              transport.lower_transport);
-          break;
+          gst_rtspsrc_stream_free_udp (stream);
+          goto response_error;
       }
 
-      if (!stream->container || (!src->interleaved && !retry)) {
-        /* now configure the stream with the selected transport */
-        if (!gst_rtspsrc_stream_configure_transport (stream, &transport)) {
-          GST_DEBUG_OBJECT (src,
-              "could not configure stream %p transport, skipping stream",
-              stream);
-          goto next;
-        } else if (stream->udpsrc[0] && stream->udpsrc[1]) {
-          /* retain the first allocated UDP port pair */
-          g_object_get (G_OBJECT (stream->udpsrc[0]), "port", &rtpport, NULL);
-          g_object_get (G_OBJECT (stream->udpsrc[1]), "port", &rtcpport, NULL);
-        }
-      }
-      /* we need to activate at least one streams when we detect activity */
-      src->need_activate = TRUE;
-    next:
-      /* clean up our transport struct */
-      gst_rtsp_transport_init (&transport);
-      /* clean up used RTSP messages */
-      gst_rtsp_message_unset (&request);
-      gst_rtsp_message_unset (&response);
+      gst_rtspsrc_handle_response_ok (src, &entry->request, &entry->response);
+
+      if (!gst_rtspsrc_stream_setup_reply (src, stream, &entry->response,
+              &protocols, 0, &rtpport, &rtcpport))
+        goto no_transport;
     }
   }
+  if (pending) {
+    g_array_free (pending, TRUE);
+    pending = NULL;
+  }
 
   /* store the transport protocol that was configured */
   src->cur_protocols = protocols;
@@ -5759,7 +6190,8 @@ no_protocols:
     /* no transport possible, post an error and stop */
     GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
         ("Could not connect to server, no protocols left"));
-    return GST_RTSP_ERROR;
+    res = GST_RTSP_ERROR;
+    goto cleanup_error;
   }
 no_streams:
   {
@@ -5805,6 +6237,19 @@ send_error:
     g_free (str);
     goto cleanup_error;
   }
+receive_error:
+  {
+    gchar *str = gst_rtsp_strresult (res);
+
+    if (res != GST_RTSP_EINTR) {
+      GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+          ("Could not receive message. (%s)", str));
+    } else {
+      GST_WARNING_OBJECT (src, "receive interrupted");
+    }
+    g_free (str);
+    goto cleanup_error;
+  }
 no_transport:
   {
     GST_ELEMENT_ERROR (src, RESOURCE, SETTINGS, (NULL),
@@ -5830,6 +6275,8 @@ nothing_to_activate:
   }
 cleanup_error:
   {
+    if (pending)
+      g_array_free (pending, TRUE);
     gst_rtsp_message_unset (&request);
     gst_rtsp_message_unset (&response);
     return res;
@@ -110,12 +110,15 @@ struct _GstRTSPStream {
   guint8        channel[2];
   GstCaps      *caps;
   GstPad       *channelpad[2];
+  GstBufferList *queued[2];    /* received on the channels, not pushed yet */
 
   /* our udp sources */
   GstElement   *udpsrc[2];
   GstPad       *blockedpad;
   gulong        blockid;
   gboolean      is_ipv6;
+  gint          reserved_port; /* RTP port of the pair taken from the process
+                                * wide pool, 0 if none */
 
   /* our udp sinks back to the server */
   GstElement   *udpsink[2];
@@ -228,6 +231,7 @@ struct _GstRTSPSrc {
   gboolean          use_pipeline_clock;
   GstStructure     *sdes;
   GTlsCertificateFlags tls_validation_flags;
+  gboolean          pipeline_setup;
 
   /* state */
   GstRTSPState       state;
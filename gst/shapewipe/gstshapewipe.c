@@ -94,11 +94,13 @@ enum
 {
   PROP_0,
   PROP_POSITION,
-  PROP_BORDER
+  PROP_BORDER,
+  PROP_N_THREADS
 };
 
 #define DEFAULT_POSITION 0.0
 #define DEFAULT_BORDER 0.0
+#define DEFAULT_N_THREADS 1
 
 static GstStaticPadTemplate video_sink_pad_template =
 GST_STATIC_PAD_TEMPLATE ("video_sink",
@@ -147,6 +149,20 @@ gst_shape_wipe_class_init (GstShapeWipeClass * klass)
           0.0, 1.0, DEFAULT_BORDER,
           G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
 
+  /**
+   * GstShapeWipe:n-threads:
+   *
+   * The number of threads that blend a frame. Every thread handles a
+   * horizontal stripe of the frame, so the output does not depend on this
+   * setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to blend a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_shape_wipe_change_state);
 
@@ -197,6 +213,8 @@ gst_shape_wipe_init (GstShapeWipe * self)
   g_mutex_init (&self->mask_mutex);
   g_cond_init (&self->mask_cond);
 
+  self->n_threads = DEFAULT_N_THREADS;
+
   gst_shape_wipe_reset (self);
 }
 
@@ -213,6 +231,9 @@ gst_shape_wipe_get_property (GObject * object, guint prop_id,
     case PROP_BORDER:
       g_value_set_float (value, self->mask_border);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, g_atomic_int_get (&self->n_threads));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -240,6 +261,10 @@ gst_shape_wipe_set_property (GObject * object, guint prop_id,
       self->mask_border = f;
       break;
     }
+    case PROP_N_THREADS:
+      /* takes effect with the next frame */
+      g_atomic_int_set (&self->n_threads, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -253,6 +278,10 @@ gst_shape_wipe_finalize (GObject * object)
 
   gst_shape_wipe_reset (self);
 
+  g_free (self->lut);
+  if (self->workers)
+    gst_workers_free (self->workers);
+
   g_cond_clear (&self->mask_cond);
   g_mutex_clear (&self->mask_mutex);
 
@@ -275,6 +304,7 @@ gst_shape_wipe_reset (GstShapeWipe * self)
   gst_video_info_init (&self->vinfo);
   gst_video_info_init (&self->minfo);
   self->mask_bpp = 0;
+  self->lut_bpp = 0;
 
   gst_segment_init (&self->segment, GST_FORMAT_TIME);
 
@@ -752,77 +782,153 @@ gst_shape_wipe_do_qos (GstShapeWipe * self, GstClockTime timestamp)
   return TRUE;
 }
 
-#define CREATE_ARGB_FUNCTIONS(depth, name, shift, a, r, g, b) \
+/* fill the lookup table from mask value to blend factor, so that the
+ * blend functions don't need a division per pixel. The factor is 16.16
+ * fixed point, 65536 keeps the input alpha. */
+static void
+gst_shape_wipe_update_lut (GstShapeWipe * self)
+{
+  gfloat position = self->mask_position;
+  gfloat border = self->mask_border;
+  gint bpp = self->mask_bpp;
+  gfloat low = position - (border / 2.0f);
+  gfloat high = position + (border / 2.0f);
+  guint32 low_i, high_i, round_i;
+  guint i, n_values, shift;
+
+  if (self->lut_bpp == bpp && self->lut_position == position &&
+      self->lut_border == border)
+    return;
+
+  GST_LOG_OBJECT (self, "Updating blend table for position %f, border %f",
+      position, border);
+
+  n_values = (bpp == 16) ? 65536 : 256;
+  shift = (bpp == 16) ? 0 : 8;
+
+  if (self->lut_bpp != bpp) {
+    g_free (self->lut);
+    self->lut = g_new (guint32, n_values);
+  }
+
+  if (low < 0.0f) {
+    high = 0.0f;
+    low = 0.0f;
+  }
+
+  if (high > 1.0f) {
+    low = 1.0f;
+    high = 1.0f;
+  }
+
+  low_i = low * 65536;
+  high_i = high * 65536;
+  round_i = (high_i - low_i) >> 1;
+
+  for (i = 0; i < n_values; i++) {
+    guint32 in = i << shift;
+
+    if (in < low_i)
+      self->lut[i] = 0;
+    else if (in >= high_i)
+      self->lut[i] = 65536;
+    else
+      /* Note: This will never overflow or be larger than 65535! */
+      self->lut[i] = (((in - low_i) << 16) + round_i) / (high_i - low_i);
+  }
+
+  self->lut_bpp = bpp;
+  self->lut_position = position;
+  self->lut_border = border;
+}
+
+/* The video frame is blended in place, only the alpha of the lines
+ * [y_start, y_end) is touched */
+#define CREATE_ARGB_FUNCTIONS(depth, name, a) \
 static void \
-gst_shape_wipe_blend_##name##_##depth (GstShapeWipe * self, GstVideoFrame * inframe, \
-    GstVideoFrame * maskframe, GstVideoFrame * outframe) \
+gst_shape_wipe_blend_##name##_##depth (GstShapeWipe * self, \
+    GstVideoFrame * frame, GstVideoFrame * maskframe, gint y_start, \
+    gint y_end) \
 { \
-  const guint##depth *mask = (const guint##depth *) GST_VIDEO_FRAME_PLANE_DATA (maskframe, 0); \
-  const guint8 *input = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (inframe, 0); \
-  guint8 *output = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (outframe, 0); \
-  guint i, j; \
-  gint width = GST_VIDEO_FRAME_WIDTH (inframe); \
-  gint height = GST_VIDEO_FRAME_HEIGHT (inframe); \
-  guint mask_increment = ((depth == 16) ? GST_ROUND_UP_2 (width) : \
-                           GST_ROUND_UP_4 (width)) - width; \
-  gfloat position = self->mask_position; \
-  gfloat low = position - (self->mask_border / 2.0f); \
-  gfloat high = position + (self->mask_border / 2.0f); \
-  guint32 low_i, high_i, round_i; \
-  \
-  if (low < 0.0f) { \
-    high = 0.0f; \
-    low = 0.0f; \
-  } \
-  \
-  if (high > 1.0f) { \
-    low = 1.0f; \
-    high = 1.0f; \
-  } \
+  const guint8 *mask_line = GST_VIDEO_FRAME_PLANE_DATA (maskframe, 0); \
+  guint8 *line = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
+  gint mask_stride = GST_VIDEO_FRAME_PLANE_STRIDE (maskframe, 0); \
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0); \
+  gint width = GST_VIDEO_FRAME_WIDTH (frame); \
+  const guint32 *lut = self->lut; \
+  gint i, j; \
   \
-  low_i = low * 65536; \
-  high_i = high * 65536; \
-  round_i = (high_i - low_i) >> 1; \
+  mask_line += y_start * mask_stride; \
+  line += y_start * stride; \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
+    const guint##depth *mask = (const guint##depth *) mask_line; \
+    guint8 *pixel = line; \
+    \
     for (j = 0; j < width; j++) { \
-      guint32 in = *mask << shift; \
+      guint32 factor = lut[mask[j]]; \
       \
-      if (in < low_i) { \
-        output[a] = 0x00;       /* A */ \
-        output[r] = input[r];   /* R */ \
-        output[g] = input[g];   /* G */ \
-        output[b] = input[b];   /* B */ \
-      } else if (in >= high_i) { \
-        output[a] = input[a];   /* A */ \
-        output[r] = input[r];   /* R */ \
-        output[g] = input[g];   /* G */ \
-        output[b] = input[b];   /* B */ \
-      } else { \
-        guint32 val; \
-        /* Note: This will never overflow or be larger than 255! */ \
-        val = (((in - low_i) << 16) + round_i) / (high_i - low_i); \
-        val = (val * input[a] + 32768) >> 16; \
-        \
-        output[a] = val;        /* A */ \
-        output[r] = input[r];   /* R */ \
-        output[g] = input[g];   /* G */ \
-        output[b] = input[b];   /* B */ \
-      } \
+      /* most of the frame is either fully shown or fully hidden */ \
+      if (factor == 0) \
+        pixel[a] = 0x00; \
+      else if (factor != 65536) \
+        pixel[a] = (factor * pixel[a] + 32768) >> 16; \
       \
-      mask++; \
-      input += 4; \
-      output += 4; \
+      pixel += 4; \
     } \
-    mask += mask_increment; \
+    mask_line += mask_stride; \
+    line += stride; \
   } \
 }
 
-CREATE_ARGB_FUNCTIONS (16, argb, 0, 0, 1, 2, 3);
-CREATE_ARGB_FUNCTIONS (8, argb, 8, 0, 1, 2, 3);
+CREATE_ARGB_FUNCTIONS (16, argb, 0);
+CREATE_ARGB_FUNCTIONS (8, argb, 0);
 
-CREATE_ARGB_FUNCTIONS (16, bgra, 0, 3, 2, 1, 0);
-CREATE_ARGB_FUNCTIONS (8, bgra, 8, 3, 2, 1, 0);
+CREATE_ARGB_FUNCTIONS (16, bgra, 3);
+CREATE_ARGB_FUNCTIONS (8, bgra, 3);
+
+typedef struct
+{
+  GstShapeWipe *self;
+  GstVideoFrame *frame;
+  GstVideoFrame *maskframe;
+} GstShapeWipeBlendData;
+
+/* blend one horizontal stripe of the frame */
+static void
+gst_shape_wipe_blend_stripe (gpointer user_data, guint slice, guint n_slices)
+{
+  GstShapeWipeBlendData *data = user_data;
+  GstShapeWipe *self = data->self;
+  gint height = GST_VIDEO_FRAME_HEIGHT (data->frame);
+  gint y_start = height * slice / n_slices;
+  gint y_end = height * (slice + 1) / n_slices;
+
+  switch (GST_VIDEO_FRAME_FORMAT (data->frame)) {
+    case GST_VIDEO_FORMAT_AYUV:
+    case GST_VIDEO_FORMAT_ARGB:
+    case GST_VIDEO_FORMAT_ABGR:
+      if (self->mask_bpp == 16)
+        gst_shape_wipe_blend_argb_16 (self, data->frame, data->maskframe,
+            y_start, y_end);
+      else
+        gst_shape_wipe_blend_argb_8 (self, data->frame, data->maskframe,
+            y_start, y_end);
+      break;
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_RGBA:
+      if (self->mask_bpp == 16)
+        gst_shape_wipe_blend_bgra_16 (self, data->frame, data->maskframe,
+            y_start, y_end);
+      else
+        gst_shape_wipe_blend_bgra_8 (self, data->frame, data->maskframe,
+            y_start, y_end);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
 
 static GstFlowReturn
 gst_shape_wipe_video_sink_chain (GstPad * pad, GstObject * parent,
@@ -832,7 +938,8 @@ gst_shape_wipe_video_sink_chain (GstPad * pad, GstObject * parent,
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *mask = NULL, *outbuf = NULL;
   GstClockTime timestamp;
-  GstVideoFrame inframe, outframe, maskframe;
+  GstVideoFrame frame, maskframe;
+  GstShapeWipeBlendData data;
 
   if (G_UNLIKELY (GST_VIDEO_INFO_FORMAT (&self->vinfo) ==
           GST_VIDEO_FORMAT_UNKNOWN))
@@ -868,34 +975,22 @@ gst_shape_wipe_video_sink_chain (GstPad * pad, GstObject * parent,
 
   /* Will blend inplace if buffer is writable */
   outbuf = gst_buffer_make_writable (buffer);
-  gst_video_frame_map (&outframe, &self->vinfo, outbuf, GST_MAP_READWRITE);
-  gst_video_frame_map (&inframe, &self->vinfo, outbuf, GST_MAP_READ);
+  gst_video_frame_map (&frame, &self->vinfo, outbuf, GST_MAP_READWRITE);
 
   gst_video_frame_map (&maskframe, &self->minfo, mask, GST_MAP_READ);
 
-  switch (GST_VIDEO_INFO_FORMAT (&self->vinfo)) {
-    case GST_VIDEO_FORMAT_AYUV:
-    case GST_VIDEO_FORMAT_ARGB:
-    case GST_VIDEO_FORMAT_ABGR:
-      if (self->mask_bpp == 16)
-        gst_shape_wipe_blend_argb_16 (self, &inframe, &maskframe, &outframe);
-      else
-        gst_shape_wipe_blend_argb_8 (self, &inframe, &maskframe, &outframe);
-      break;
-    case GST_VIDEO_FORMAT_BGRA:
-    case GST_VIDEO_FORMAT_RGBA:
-      if (self->mask_bpp == 16)
-        gst_shape_wipe_blend_bgra_16 (self, &inframe, &maskframe, &outframe);
-      else
-        gst_shape_wipe_blend_bgra_8 (self, &inframe, &maskframe, &outframe);
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
-  }
+  gst_shape_wipe_update_lut (self);
+  gst_workers_ensure (&self->workers, g_atomic_int_get (&self->n_threads));
+
+  data.self = self;
+  data.frame = &frame;
+  data.maskframe = &maskframe;
+  if (self->workers)
+    gst_workers_run (self->workers, gst_shape_wipe_blend_stripe, &data);
+  else
+    gst_shape_wipe_blend_stripe (&data, 0, 1);
 
-  gst_video_frame_unmap (&outframe);
-  gst_video_frame_unmap (&inframe);
+  gst_video_frame_unmap (&frame);
 
   gst_video_frame_unmap (&maskframe);
 
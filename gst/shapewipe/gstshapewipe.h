@@ -23,6 +23,8 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_SHAPE_WIPE \
@@ -59,6 +61,16 @@ struct _GstShapeWipe
   GCond mask_cond;
   gint mask_bpp;
 
+  /* blend factor in 16.16 for every mask value, for lut_position,
+   * lut_border and lut_bpp. Only touched from the video streaming thread */
+  guint32 *lut;
+  gfloat lut_position;
+  gfloat lut_border;
+  gint lut_bpp;
+
+  guint n_threads;
+  GstWorkers *workers;
+
   GstVideoInfo vinfo;
   GstVideoInfo minfo;
 
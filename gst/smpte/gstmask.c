@@ -26,6 +26,12 @@
 
 static GList *masks = NULL;
 
+/* masks only depend on their type, size and depth, so elements using the
+ * same transition share a single copy instead of drawing their own, which
+ * for large frames is both slow and a lot of memory */
+static GMutex mask_cache_lock;
+static GList *mask_cache = NULL;
+
 void
 _gst_mask_init (void)
 {
@@ -74,12 +80,30 @@ gst_mask_factory_new (gint type, gboolean invert, gint bpp, gint width,
 {
   GstMaskDefinition *definition;
   GstMask *mask = NULL;
+  GList *walk;
+
+  invert = ! !invert;
+
+  g_mutex_lock (&mask_cache_lock);
+  for (walk = mask_cache; walk; walk = g_list_next (walk)) {
+    GstMask *cached = (GstMask *) walk->data;
+
+    if (cached->type == type && cached->invert == invert &&
+        cached->bpp == bpp && cached->width == width &&
+        cached->height == height) {
+      cached->refcount++;
+      g_mutex_unlock (&mask_cache_lock);
+      return cached;
+    }
+  }
 
   definition = gst_mask_find_definition (type);
   if (definition) {
     mask = g_new0 (GstMask, 1);
 
     mask->type = definition->type;
+    mask->invert = invert;
+    mask->refcount = 1;
     mask->bpp = bpp;
     mask->width = width;
     mask->height = height;
@@ -101,7 +125,9 @@ gst_mask_factory_new (gint type, gboolean invert, gint bpp, gint width,
         }
       }
     }
+    mask_cache = g_list_prepend (mask_cache, mask);
   }
+  g_mutex_unlock (&mask_cache_lock);
 
   return mask;
 }
@@ -116,6 +142,14 @@ _gst_mask_default_destroy (GstMask * mask)
 void
 gst_mask_destroy (GstMask * mask)
 {
+  g_mutex_lock (&mask_cache_lock);
+  if (--mask->refcount > 0) {
+    g_mutex_unlock (&mask_cache_lock);
+    return;
+  }
+  mask_cache = g_list_remove (mask_cache, mask);
+  g_mutex_unlock (&mask_cache_lock);
+
   if (mask->destroy_func)
     mask->destroy_func (mask);
 }
@@ -46,8 +46,12 @@ struct _GstMask {
   gint                   width;
   gint                   height;
   gint                   bpp;
+  gboolean               invert;
 
   GstMaskDestroyFunc     destroy_func;
+
+  /* private, masks are shared through the mask cache */
+  gint                   refcount;
 };
 
 void                    _gst_mask_init                  (void);
@@ -55,6 +55,7 @@
 
 #include "gstsmptealpha.h"
 #include "paint.h"
+#include "gstsmpteorc.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_smpte_alpha_debug);
 #define GST_CAT_DEFAULT gst_smpte_alpha_debug
@@ -272,72 +273,38 @@ gst_smpte_alpha_init (GstSMPTEAlpha * smpte)
   smpte->invert = DEFAULT_PROP_INVERT;
 }
 
-#define CREATE_ARGB_FUNC(name, A, R, G, B) \
-static void \
-gst_smpte_alpha_process_##name##_##name (GstSMPTEAlpha * smpte, \
-    const GstVideoFrame * in_frame, GstVideoFrame * out_frame, GstMask * mask, \
-    gint border, gint pos) \
-{ \
-  gint i, j; \
-  const guint32 *maskp; \
-  gint value; \
-  gint min, max; \
-  gint width, height; \
-  guint8 *in, *out; \
-  gint src_wrap, dest_wrap; \
-  \
-  if (border == 0) \
-    border++; \
-  \
-  min = pos - border; \
-  max = pos; \
-  GST_DEBUG_OBJECT (smpte, "pos %d, min %d, max %d, border %d", pos, min, max, \
-      border); \
-  \
-  maskp = mask->data; \
-  \
-  width = GST_VIDEO_FRAME_WIDTH (out_frame); \
-  height = GST_VIDEO_FRAME_HEIGHT (out_frame); \
-  \
-  in = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0); \
-  out = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0); \
-  src_wrap = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0) - (width << 2); \
-  dest_wrap = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0) - (width << 2); \
-  \
-  /* we basically copy the source to dest but we scale the alpha channel with \
-   * the mask */ \
-  for (i = 0; i < height; i++) { \
-    for (j = 0; j < width; j++) { \
-      value = *maskp++; \
-      out[A] = (in[A] * ((CLAMP (value, min, max) - min) << 8) / border) >> 8; \
-      out[R] = in[R]; \
-      out[G] = in[G]; \
-      out[B] = in[B]; \
-      out += 4; \
-      in += 4; \
-    } \
-    in += src_wrap; \
-    out += dest_wrap; \
-  } \
-}
+/* scales the alpha of @width pixels of 4 bytes, starting at @out, with the
+ * mask. Pixels past the border keep their alpha and pixels before it
+ * become transparent, only the ones in the border need the division. */
+static inline void
+gst_smpte_alpha_mask_line (guint8 * out, const guint32 * maskp, gint width,
+    gint min, gint max, gint border)
+{
+  gint j;
+  gint value;
 
-CREATE_ARGB_FUNC (argb, 0, 1, 2, 3);
-CREATE_ARGB_FUNC (bgra, 3, 2, 1, 0);
-CREATE_ARGB_FUNC (abgr, 0, 3, 2, 1);
-CREATE_ARGB_FUNC (rgba, 3, 0, 1, 2);
+  for (j = 0; j < width; j++) {
+    value = maskp[j];
+    if (value <= min)
+      *out = 0;
+    else if (value < max)
+      *out = (*out * ((value - min) << 8) / border) >> 8;
+    out += 4;
+  }
+}
 
 static void
-gst_smpte_alpha_process_ayuv_ayuv (GstSMPTEAlpha * smpte,
+gst_smpte_alpha_process_packed (GstSMPTEAlpha * smpte,
     const GstVideoFrame * in_frame, GstVideoFrame * out_frame, GstMask * mask,
-    gint border, gint pos)
+    gint border, gint pos, gint A)
 {
-  gint i, j;
+  gint i;
   const guint32 *maskp;
-  gint value;
   gint min, max;
   gint width, height;
-  guint8 *in, *out;
-  gint src_wrap, dest_wrap;
+  const guint8 *in;
+  guint8 *out;
+  gint src_stride, dest_stride;
 
   if (border == 0)
     border++;
@@ -354,24 +321,36 @@ gst_smpte_alpha_process_ayuv_ayuv (GstSMPTEAlpha * smpte,
 
   in = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
   out = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-  src_wrap = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0) - (width << 2);
-  dest_wrap = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0) - (width << 2);
+  src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0);
+  dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
 
   /* we basically copy the source to dest but we scale the alpha channel with
    * the mask */
   for (i = 0; i < height; i++) {
-    for (j = 0; j < width; j++) {
-      value = *maskp++;
-      *out++ = (*in++ * ((CLAMP (value, min, max) - min) << 8) / border) >> 8;
-      *out++ = *in++;
-      *out++ = *in++;
-      *out++ = *in++;
-    }
-    in += src_wrap;
-    out += dest_wrap;
+    memcpy (out, in, width << 2);
+    gst_smpte_alpha_mask_line (out + A, maskp, width, min, max, border);
+    maskp += width;
+    in += src_stride;
+    out += dest_stride;
   }
 }
 
+#define CREATE_ARGB_FUNC(name, A) \
+static void \
+gst_smpte_alpha_process_##name##_##name (GstSMPTEAlpha * smpte, \
+    const GstVideoFrame * in_frame, GstVideoFrame * out_frame, GstMask * mask, \
+    gint border, gint pos) \
+{ \
+  gst_smpte_alpha_process_packed (smpte, in_frame, out_frame, mask, border, \
+      pos, A); \
+}
+
+CREATE_ARGB_FUNC (argb, 0);
+CREATE_ARGB_FUNC (bgra, 3);
+CREATE_ARGB_FUNC (abgr, 0);
+CREATE_ARGB_FUNC (rgba, 3);
+CREATE_ARGB_FUNC (ayuv, 0);
+
 static void
 gst_smpte_alpha_process_i420_ayuv (GstSMPTEAlpha * smpte,
     const GstVideoFrame * in_frame, GstVideoFrame * out_frame, GstMask * mask,
@@ -381,12 +360,9 @@ gst_smpte_alpha_process_i420_ayuv (GstSMPTEAlpha * smpte,
   const guint8 *srcU;
   const guint8 *srcV;
   guint8 *out;
-  gint i, j;
-  gint src_wrap, src_u_wrap, src_v_wrap, dest_wrap;
-  gint y_stride, u_stride, v_stride;
-  gboolean odd_width;
+  gint i;
+  gint y_stride, u_stride, v_stride, dest_stride;
   const guint32 *maskp;
-  gint value;
   gint min, max;
   gint width, height;
 
@@ -407,49 +383,20 @@ gst_smpte_alpha_process_i420_ayuv (GstSMPTEAlpha * smpte,
   u_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 1);
   v_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 2);
 
-  src_wrap = y_stride - width;
-  src_u_wrap = u_stride - (width / 2);
-  src_v_wrap = v_stride - (width / 2);
-
   srcY = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
   srcU = GST_VIDEO_FRAME_COMP_DATA (in_frame, 1);
   srcV = GST_VIDEO_FRAME_COMP_DATA (in_frame, 2);
 
   out = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-  dest_wrap = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0) - (width << 2);
-
-  odd_width = (width % 2 != 0);
+  dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
 
+  /* convert to opaque AYUV, then scale the alpha with the mask */
   for (i = 0; i < height; i++) {
-    for (j = 0; j < width / 2; j++) {
-      value = *maskp++;
-      *out++ = (0xff * ((CLAMP (value, min, max) - min) << 8) / border) >> 8;
-      *out++ = *srcY++;
-      *out++ = *srcU;
-      *out++ = *srcV;
-      value = *maskp++;
-      *out++ = (0xff * ((CLAMP (value, min, max) - min) << 8) / border) >> 8;
-      *out++ = *srcY++;
-      *out++ = *srcU++;
-      *out++ = *srcV++;
-    }
-    /* Might have one odd column left to do */
-    if (odd_width) {
-      value = *maskp++;
-      *out++ = (0xff * ((CLAMP (value, min, max) - min) << 8) / border) >> 8;
-      *out++ = *srcY++;
-      *out++ = *srcU;
-      *out++ = *srcV;
-    }
-    if (i % 2 == 0) {
-      srcU -= width / 2;
-      srcV -= width / 2;
-    } else {
-      srcU += src_u_wrap;
-      srcV += src_v_wrap;
-    }
-    srcY += src_wrap;
-    out += dest_wrap;
+    smpte_orc_convert_I420_AYUV (out, srcY + i * y_stride,
+        srcU + (i / 2) * u_stride, srcV + (i / 2) * v_stride, width);
+    gst_smpte_alpha_mask_line (out, maskp, width, min, max, border);
+    maskp += width;
+    out += dest_stride;
   }
 }
 
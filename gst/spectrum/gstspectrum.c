@@ -128,6 +128,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_spectrum_debug);
 #define DEFAULT_BANDS			128
 #define DEFAULT_THRESHOLD		-60
 #define DEFAULT_MULTI_CHANNEL		FALSE
+#define DEFAULT_FAST_DB			FALSE
 
 enum
 {
@@ -138,7 +139,8 @@ enum
   PROP_INTERVAL,
   PROP_BANDS,
   PROP_THRESHOLD,
-  PROP_MULTI_CHANNEL
+  PROP_MULTI_CHANNEL,
+  PROP_FAST_DB
 };
 
 #define gst_spectrum_parent_class parent_class
@@ -217,6 +219,21 @@ gst_spectrum_class_init (GstSpectrumClass * klass)
           "Send separate results for each channel",
           DEFAULT_MULTI_CHANNEL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSpectrum:fast-db:
+   *
+   * Convert the magnitudes to dB with a polynomial approximation of the
+   * logarithm instead of log10(). The error stays below 0.005 dB, which is
+   * far below what can be displayed, and helps when many channels are
+   * analysed with many bands.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_FAST_DB,
+      g_param_spec_boolean ("fast-db", "Fast dB",
+          "Use a fast approximation to convert the magnitudes to dB",
+          DEFAULT_FAST_DB, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (gst_spectrum_debug, "spectrum", 0,
       "audio spectrum analyser element");
 
@@ -241,6 +258,7 @@ gst_spectrum_init (GstSpectrum * spectrum)
   spectrum->interval = DEFAULT_INTERVAL;
   spectrum->bands = DEFAULT_BANDS;
   spectrum->threshold = DEFAULT_THRESHOLD;
+  spectrum->fast_db = DEFAULT_FAST_DB;
 
   g_mutex_init (&spectrum->lock);
 }
@@ -261,13 +279,23 @@ gst_spectrum_alloc_channel_data (GstSpectrum * spectrum)
   GST_DEBUG_OBJECT (spectrum, "allocating data for %d channels",
       spectrum->num_channels);
 
+  /* the channels are transformed one after the other, so they can share
+   * the FFT context and its buffers */
+  spectrum->fft_ctx = gst_fft_f32_new (nfft, FALSE);
+  spectrum->input = g_new0 (gfloat, nfft * spectrum->num_channels);
+  spectrum->input_tmp = g_new0 (gfloat, nfft);
+  spectrum->freqdata = g_new0 (GstFFTF32Complex, bands);
+
+  /* the same as gst_fft_f32_window() with GST_FFT_WINDOW_HAMMING, but the
+   * cosines are only calculated once */
+  spectrum->window = g_new (gfloat, nfft);
+  for (i = 0; i < nfft; i++)
+    spectrum->window[i] = 0.53836 - 0.46164 * cos (2.0 * G_PI * i / nfft);
+
   spectrum->channel_data = g_new (GstSpectrumChannel, spectrum->num_channels);
   for (i = 0; i < spectrum->num_channels; i++) {
     cd = &spectrum->channel_data[i];
-    cd->fft_ctx = gst_fft_f32_new (nfft, FALSE);
-    cd->input = g_new0 (gfloat, nfft);
-    cd->input_tmp = g_new0 (gfloat, nfft);
-    cd->freqdata = g_new0 (GstFFTF32Complex, bands);
+    cd->input = spectrum->input + i * nfft;
     cd->spect_magnitude = g_new0 (gfloat, bands);
     cd->spect_phase = g_new0 (gfloat, bands);
   }
@@ -285,16 +313,23 @@ gst_spectrum_free_channel_data (GstSpectrum * spectrum)
 
     for (i = 0; i < spectrum->num_channels; i++) {
       cd = &spectrum->channel_data[i];
-      if (cd->fft_ctx)
-        gst_fft_f32_free (cd->fft_ctx);
-      g_free (cd->input);
-      g_free (cd->input_tmp);
-      g_free (cd->freqdata);
       g_free (cd->spect_magnitude);
       g_free (cd->spect_phase);
     }
     g_free (spectrum->channel_data);
     spectrum->channel_data = NULL;
+
+    if (spectrum->fft_ctx)
+      gst_fft_f32_free (spectrum->fft_ctx);
+    spectrum->fft_ctx = NULL;
+    g_free (spectrum->input);
+    spectrum->input = NULL;
+    g_free (spectrum->input_tmp);
+    spectrum->input_tmp = NULL;
+    g_free (spectrum->window);
+    spectrum->window = NULL;
+    g_free (spectrum->freqdata);
+    spectrum->freqdata = NULL;
   }
 }
 
@@ -366,6 +401,9 @@ gst_spectrum_set_property (GObject * object, guint prop_id,
     case PROP_THRESHOLD:
       filter->threshold = g_value_get_int (value);
       break;
+    case PROP_FAST_DB:
+      filter->fast_db = g_value_get_boolean (value);
+      break;
     case PROP_MULTI_CHANNEL:{
       gboolean multi_channel = g_value_get_boolean (value);
       g_mutex_lock (&filter->lock);
@@ -407,6 +445,9 @@ gst_spectrum_get_property (GObject * object, guint prop_id,
     case PROP_THRESHOLD:
       g_value_set_int (value, filter->threshold);
       break;
+    case PROP_FAST_DB:
+      g_value_set_boolean (value, filter->fast_db);
+      break;
     case PROP_MULTI_CHANNEL:
       g_value_set_boolean (value, filter->multi_channel);
       break;
@@ -530,18 +571,21 @@ input_data_mixed_int16_max (const guint8 * _in, gfloat * out, guint len,
   }
 }
 
-/* non mixing data readers */
+/* non mixing data readers, all channels are copied into their ringbuffers
+ * in one pass over the interleaved samples */
 
 static void
 input_data_float (const guint8 * _in, gfloat * out, guint len, guint channels,
     gfloat max_value, guint op, guint nfft)
 {
-  guint j, ip;
+  guint j, c, ip;
   gfloat *in = (gfloat *) _in;
 
-  for (j = 0, ip = 0; j < len; j++, ip += channels) {
-    out[op] = in[ip];
-    op = (op + 1) % nfft;
+  for (j = 0, ip = 0; j < len; j++) {
+    for (c = 0; c < channels; c++)
+      out[c * nfft + op] = in[ip++];
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -549,12 +593,14 @@ static void
 input_data_double (const guint8 * _in, gfloat * out, guint len, guint channels,
     gfloat max_value, guint op, guint nfft)
 {
-  guint j, ip;
+  guint j, c, ip;
   gdouble *in = (gdouble *) _in;
 
-  for (j = 0, ip = 0; j < len; j++, ip += channels) {
-    out[op] = in[ip];
-    op = (op + 1) % nfft;
+  for (j = 0, ip = 0; j < len; j++) {
+    for (c = 0; c < channels; c++)
+      out[c * nfft + op] = in[ip++];
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -562,12 +608,14 @@ static void
 input_data_int32_max (const guint8 * _in, gfloat * out, guint len,
     guint channels, gfloat max_value, guint op, guint nfft)
 {
-  guint j, ip;
+  guint j, c, ip;
   gint32 *in = (gint32 *) _in;
 
-  for (j = 0, ip = 0; j < len; j++, ip += channels) {
-    out[op] = in[ip] / max_value;
-    op = (op + 1) % nfft;
+  for (j = 0, ip = 0; j < len; j++) {
+    for (c = 0; c < channels; c++)
+      out[c * nfft + op] = in[ip++] / max_value;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -575,19 +623,22 @@ static void
 input_data_int24_max (const guint8 * _in, gfloat * out, guint len,
     guint channels, gfloat max_value, guint op, guint nfft)
 {
-  guint j;
+  guint j, c;
 
   for (j = 0; j < len; j++) {
+    for (c = 0; c < channels; c++) {
 #if G_BYTE_ORDER == G_BIG_ENDIAN
-    gint32 v = GST_READ_UINT24_BE (_in);
+      gint32 v = GST_READ_UINT24_BE (_in);
 #else
-    gint32 v = GST_READ_UINT24_LE (_in);
+      gint32 v = GST_READ_UINT24_LE (_in);
 #endif
-    if (v & 0x00800000)
-      v |= 0xff000000;
-    _in += 3 * channels;
-    out[op] = v / max_value;
-    op = (op + 1) % nfft;
+      if (v & 0x00800000)
+        v |= 0xff000000;
+      _in += 3;
+      out[c * nfft + op] = v / max_value;
+    }
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -595,12 +646,14 @@ static void
 input_data_int16_max (const guint8 * _in, gfloat * out, guint len,
     guint channels, gfloat max_value, guint op, guint nfft)
 {
-  guint j, ip;
+  guint j, c, ip;
   gint16 *in = (gint16 *) _in;
 
-  for (j = 0, ip = 0; j < len; j++, ip += channels) {
-    out[op] = in[ip] / max_value;
-    op = (op + 1) % nfft;
+  for (j = 0, ip = 0; j < len; j++) {
+    for (c = 0; c < channels; c++)
+      out[c * nfft + op] = in[ip++] / max_value;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -756,39 +809,91 @@ gst_spectrum_message_new (GstSpectrum * spectrum, GstClockTime timestamp,
   return gst_message_new_element (GST_OBJECT (spectrum), s);
 }
 
+/* 10 * log10 (val) for val > 0, from the exponent of the float and a cubic
+ * polynomial for the logarithm of its mantissa. The error is below 0.005 dB */
+static inline gfloat
+gst_spectrum_fast_db (gfloat val)
+{
+  union
+  {
+    gfloat f;
+    guint32 i;
+  } u;
+  gfloat m, log2;
+
+  u.f = val;
+  log2 = (gfloat) ((gint) ((u.i >> 23) & 0xff) - 127);
+  /* mantissa in [1, 2) */
+  u.i = (u.i & 0x007fffff) | 0x3f800000;
+  m = u.f;
+  log2 += ((0.15391848f * m - 1.02952195f) * m + 3.01078397f) * m -
+      2.13384771f;
+
+  return 3.01029996f * log2;
+}
+
 static void
 gst_spectrum_run_fft (GstSpectrum * spectrum, GstSpectrumChannel * cd,
     guint input_pos)
 {
-  guint i;
+  guint i, n;
   guint bands = spectrum->bands;
   guint nfft = 2 * bands - 2;
   gint threshold = spectrum->threshold;
   gfloat *input = cd->input;
-  gfloat *input_tmp = cd->input_tmp;
+  gfloat *input_tmp = spectrum->input_tmp;
+  gfloat *window = spectrum->window;
   gfloat *spect_magnitude = cd->spect_magnitude;
   gfloat *spect_phase = cd->spect_phase;
-  GstFFTF32Complex *freqdata = cd->freqdata;
-  GstFFTF32 *fft_ctx = cd->fft_ctx;
-
-  for (i = 0; i < nfft; i++)
-    input_tmp[i] = input[(input_pos + i) % nfft];
+  GstFFTF32Complex *freqdata = spectrum->freqdata;
+  GstFFTF32 *fft_ctx = spectrum->fft_ctx;
 
-  gst_fft_f32_window (fft_ctx, input_tmp, GST_FFT_WINDOW_HAMMING);
+  /* unroll the ringbuffer and apply the window in one go */
+  n = nfft - input_pos;
+  for (i = 0; i < n; i++)
+    input_tmp[i] = input[input_pos + i] * window[i];
+  for (i = 0; i < input_pos; i++)
+    input_tmp[n + i] = input[i] * window[n + i];
 
   gst_fft_f32_fft (fft_ctx, input_tmp, freqdata);
 
   if (spectrum->message_magnitude) {
-    gdouble val;
+    gdouble val, norm, min_power;
+
+    norm = 1.0 / ((gdouble) nfft * nfft);
+    /* everything below the threshold ends up at the threshold, no need to
+     * take the logarithm of it */
+    min_power = pow (10.0, threshold / 10.0);
+
     /* Calculate magnitude in db */
-    for (i = 0; i < bands; i++) {
-      val = freqdata[i].r * freqdata[i].r;
-      val += freqdata[i].i * freqdata[i].i;
-      val /= nfft * nfft;
-      val = 10.0 * log10 (val);
-      if (val < threshold)
-        val = threshold;
-      spect_magnitude[i] += val;
+    if (spectrum->fast_db) {
+      for (i = 0; i < bands; i++) {
+        val = freqdata[i].r * freqdata[i].r;
+        val += freqdata[i].i * freqdata[i].i;
+        val *= norm;
+        if (val > min_power) {
+          val = gst_spectrum_fast_db (val);
+          if (val < threshold)
+            val = threshold;
+        } else {
+          val = threshold;
+        }
+        spect_magnitude[i] += val;
+      }
+    } else {
+      for (i = 0; i < bands; i++) {
+        val = freqdata[i].r * freqdata[i].r;
+        val += freqdata[i].i * freqdata[i].i;
+        val *= norm;
+        if (val > min_power) {
+          val = 10.0 * log10 (val);
+          if (val < threshold)
+            val = threshold;
+        } else {
+          val = threshold;
+        }
+        spect_magnitude[i] += val;
+      }
     }
   }
 
@@ -847,7 +952,6 @@ gst_spectrum_transform_ip (GstBaseTransform * trans, GstBuffer * buffer)
   guint bands = spectrum->bands;
   guint nfft = 2 * bands - 2;
   guint input_pos;
-  gfloat *input;
   GstMapInfo map;
   const guint8 *data;
   gsize size;
@@ -916,13 +1020,9 @@ gst_spectrum_transform_ip (GstBaseTransform * trans, GstBuffer * buffer)
     if (block_size > fft_todo)
       block_size = fft_todo;
 
-    for (c = 0; c < output_channels; c++) {
-      cd = &spectrum->channel_data[c];
-      input = cd->input;
-      /* Move the current frames into our ringbuffers */
-      input_data (data + c * bps, input, block_size, channels, max_value,
-          input_pos, nfft);
-    }
+    /* Move the current frames into our ringbuffers */
+    input_data (data, spectrum->input, block_size, channels, max_value,
+        input_pos, nfft);
     data += block_size * bpf;
     size -= block_size * bpf;
     input_pos = (input_pos + block_size) % nfft;
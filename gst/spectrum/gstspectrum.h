@@ -37,17 +37,15 @@ typedef struct _GstSpectrum GstSpectrum;
 typedef struct _GstSpectrumClass GstSpectrumClass;
 typedef struct _GstSpectrumChannel GstSpectrumChannel;
 
+/* the ringbuffers of the channels follow each other in @out, @nfft apart */
 typedef void (*GstSpectrumInputData)(const guint8 * in, gfloat * out,
     guint len, guint channels, gfloat max_value, guint op, guint nfft);
 
 struct _GstSpectrumChannel
 {
-  gfloat *input;
-  gfloat *input_tmp;
-  GstFFTF32Complex *freqdata;
+  gfloat *input;                /* ringbuffer, part of GstSpectrum::input */
   gfloat *spect_magnitude;      /* accumulated mangitude and phase */
   gfloat *spect_phase;          /* will be scaled by num_fft before sending */
-  GstFFTF32 *fft_ctx;
 };
 
 struct _GstSpectrum
@@ -64,6 +62,7 @@ struct _GstSpectrum
   guint bands;                  /* number of spectrum bands */
   gint threshold;               /* energy level treshold */
   gboolean multi_channel;       /* send separate channel results */
+  gboolean fast_db;             /* approximate the magnitudes in dB */
 
   guint64 num_frames;           /* frame count (1 sample per channel)
                                  * since last emit */
@@ -74,6 +73,14 @@ struct _GstSpectrum
   GstSpectrumChannel *channel_data;
   guint num_channels;
 
+  /* the ringbuffers of all channels and the scratch space for the FFT,
+   * which is shared by the channels */
+  gfloat *input;
+  gfloat *input_tmp;
+  gfloat *window;
+  GstFFTF32Complex *freqdata;
+  GstFFTF32 *fft_ctx;
+
   guint input_pos;
   guint64 error_per_interval;
   guint64 accumulated_error;
@@ -25,11 +25,21 @@
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* sendmmsg */
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 #include "gstdynudpsink.h"
 
+#include <string.h>
+#include <errno.h>
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+
 #include <gst/net/gstnetaddressmeta.h>
 
 GST_DEBUG_CATEGORY_STATIC (dynudpsink_debug);
@@ -57,6 +67,9 @@ enum
 #define UDP_DEFAULT_BIND_ADDRESS	NULL
 #define UDP_DEFAULT_BIND_PORT   	0
 
+/* the cached destinations are dropped when there are more than this */
+#define UDP_MAX_DESTS 1024
+
 enum
 {
   PROP_0,
@@ -71,6 +84,8 @@ static void gst_dynudpsink_finalize (GObject * object);
 
 static GstFlowReturn gst_dynudpsink_render (GstBaseSink * sink,
     GstBuffer * buffer);
+static GstFlowReturn gst_dynudpsink_render_list (GstBaseSink * bsink,
+    GstBufferList * list);
 static gboolean gst_dynudpsink_stop (GstBaseSink * bsink);
 static gboolean gst_dynudpsink_start (GstBaseSink * bsink);
 static gboolean gst_dynudpsink_unlock (GstBaseSink * bsink);
@@ -83,6 +98,44 @@ static void gst_dynudpsink_get_property (GObject * object, guint prop_id,
 static GstStructure *gst_dynudpsink_get_stats (GstDynUDPSink * sink,
     const gchar * host, gint port);
 
+/* a destination of the sink, the socket is the one of used_socket and
+ * used_socket_v6 to send from */
+typedef struct
+{
+  GSocketAddress *addr;
+  GSocket *socket;
+#ifdef HAVE_SENDMMSG
+  struct sockaddr_storage native;
+  gssize native_len;
+#endif
+} GstDynUDPDest;
+
+/* a packet to send, the vectors point into sink->vec */
+typedef struct
+{
+  GstDynUDPDest *dest;
+  GOutputVector *vec;
+  guint n_vec;
+  gsize size;
+} GstDynUDPPacket;
+
+#ifdef HAVE_SENDMMSG
+/* we pass our GOutputVectors to the kernel as struct iovec, like GSocket
+ * does in g_socket_send_message() */
+G_STATIC_ASSERT (sizeof (struct iovec) == sizeof (GOutputVector));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (struct iovec, iov_base) ==
+    G_STRUCT_OFFSET (GOutputVector, buffer));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (struct iovec, iov_len) ==
+    G_STRUCT_OFFSET (GOutputVector, size));
+#endif
+
+static void
+gst_dynudpsink_dest_free (GstDynUDPDest * dest)
+{
+  g_object_unref (dest->addr);
+  g_slice_free (GstDynUDPDest, dest);
+}
+
 static guint gst_dynudpsink_signals[LAST_SIGNAL] = { 0 };
 
 #define gst_dynudpsink_parent_class parent_class
@@ -143,6 +196,7 @@ gst_dynudpsink_class_init (GstDynUDPSinkClass * klass)
       "Philippe Khalaf <burger@speedy.org>");
 
   gstbasesink_class->render = gst_dynudpsink_render;
+  gstbasesink_class->render_list = gst_dynudpsink_render_list;
   gstbasesink_class->start = gst_dynudpsink_start;
   gstbasesink_class->stop = gst_dynudpsink_stop;
   gstbasesink_class->unlock = gst_dynudpsink_unlock;
@@ -166,6 +220,9 @@ gst_dynudpsink_init (GstDynUDPSink * sink)
   sink->used_socket = NULL;
   sink->used_socket_v6 = NULL;
   sink->cancellable = g_cancellable_new ();
+
+  sink->dests = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) gst_dynudpsink_dest_free);
 }
 
 static void
@@ -198,40 +255,53 @@ gst_dynudpsink_finalize (GObject * object)
   g_free (sink->bind_address);
   sink->bind_address = NULL;
 
+  g_hash_table_destroy (sink->dests);
+  sink->dests = NULL;
+
+  g_free (sink->vec);
+  sink->vec = NULL;
+  g_free (sink->map);
+  sink->map = NULL;
+  g_free (sink->packets);
+  sink->packets = NULL;
+  g_free (sink->msgs);
+  sink->msgs = NULL;
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-static GstFlowReturn
-gst_dynudpsink_render (GstBaseSink * bsink, GstBuffer * buffer)
+/* looks up the destination of @addr, converting it first if it is new */
+static GstDynUDPDest *
+gst_dynudpsink_get_dest (GstDynUDPSink * sink, GSocketAddress * addr)
 {
-  GstDynUDPSink *sink;
-  gssize ret;
-  GstMapInfo map;
-  GstNetAddressMeta *meta;
-  GSocketAddress *addr;
-  GError *err = NULL;
+  GstDynUDPDest *dest;
   GSocketFamily family;
-  GSocket *socket;
 
-  meta = gst_buffer_get_net_address_meta (buffer);
-
-  if (meta == NULL) {
-    GST_DEBUG ("Received buffer without GstNetAddressMeta, skipping");
-    return GST_FLOW_OK;
-  }
-
-  sink = GST_DYNUDPSINK (bsink);
-
-  /* let's get the address from the metadata */
-  addr = meta->addr;
+  dest = g_hash_table_lookup (sink->dests, addr);
+  if (G_LIKELY (dest != NULL))
+    return dest;
 
   family = g_socket_address_get_family (addr);
   if (family == G_SOCKET_FAMILY_IPV6 && !sink->used_socket_v6)
     goto invalid_family;
 
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  dest = g_slice_new0 (GstDynUDPDest);
+  dest->addr = g_object_ref (addr);
 
-  GST_DEBUG ("about to send %" G_GSIZE_FORMAT " bytes", map.size);
+  /* Select socket to send from for this address */
+  if (family == G_SOCKET_FAMILY_IPV6 || !sink->used_socket)
+    dest->socket = sink->used_socket_v6;
+  else
+    dest->socket = sink->used_socket;
+
+#ifdef HAVE_SENDMMSG
+  dest->native_len = g_socket_address_get_native_size (addr);
+  if (dest->native_len <= 0 || !g_socket_address_to_native (addr,
+          &dest->native, sizeof (dest->native), NULL)) {
+    gst_dynudpsink_dest_free (dest);
+    goto invalid_address;
+  }
+#endif
 
 #ifndef GST_DISABLE_GST_DEBUG
   {
@@ -240,42 +310,315 @@ gst_dynudpsink_render (GstBaseSink * bsink, GstBuffer * buffer)
     host =
         g_inet_address_to_string (g_inet_socket_address_get_address
         (G_INET_SOCKET_ADDRESS (addr)));
-    GST_DEBUG ("sending %" G_GSIZE_FORMAT " bytes to client %s port %d",
-        map.size, host,
+    GST_DEBUG ("new client %s port %d", host,
         g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr)));
     g_free (host);
   }
 #endif
 
-  /* Select socket to send from for this address */
-  if (family == G_SOCKET_FAMILY_IPV6 || !sink->used_socket)
-    socket = sink->used_socket_v6;
-  else
-    socket = sink->used_socket;
+  g_hash_table_insert (sink->dests, dest->addr, dest);
+
+  return dest;
+
+invalid_family:
+  {
+    GST_DEBUG ("invalid address family (got %d)", family);
+    return NULL;
+  }
+#ifdef HAVE_SENDMMSG
+invalid_address:
+  {
+    GST_DEBUG ("could not convert address");
+    return NULL;
+  }
+#endif
+}
+
+/* the addresses of the metas are kept alive by the cache, drop them all
+ * when there are too many. Only done before a render call looks up any
+ * destinations, so that the packets it builds keep valid pointers */
+static void
+gst_dynudpsink_trim_dests (GstDynUDPSink * sink)
+{
+  if (g_hash_table_size (sink->dests) > UDP_MAX_DESTS) {
+    GST_DEBUG ("dropping %u cached destinations",
+        g_hash_table_size (sink->dests));
+    g_hash_table_remove_all (sink->dests);
+  }
+}
+
+static void
+gst_dynudpsink_ensure_vecs (GstDynUDPSink * sink, guint n_vec)
+{
+  if (n_vec > sink->n_vec) {
+    sink->vec = g_renew (GOutputVector, sink->vec, n_vec);
+    sink->map = g_renew (GstMapInfo, sink->map, n_vec);
+    sink->n_vec = n_vec;
+  }
+}
+
+/* map the memory of @buffer into the vectors starting at @vec */
+static gsize
+gst_dynudpsink_map_buffer (GstDynUDPSink * sink, GstBuffer * buffer,
+    GOutputVector * vec, GstMapInfo * map)
+{
+  guint n_mem, i;
+  gsize size = 0;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  for (i = 0; i < n_mem; i++) {
+    GstMemory *mem = gst_buffer_get_memory (buffer, i);
+
+    gst_memory_map (mem, &map[i], GST_MAP_READ);
+    vec[i].buffer = map[i].data;
+    vec[i].size = map[i].size;
+    size += map[i].size;
+  }
+
+  return size;
+}
+
+static void
+gst_dynudpsink_unmap (GstDynUDPSink * sink, guint n_vec)
+{
+  guint i;
+
+  for (i = 0; i < n_vec; i++) {
+    gst_memory_unmap (sink->map[i].memory, &sink->map[i]);
+    gst_memory_unref (sink->map[i].memory);
+  }
+}
+
+#ifdef HAVE_SENDMMSG
+/* send all packets whose destination uses @socket with as few sendmmsg()
+ * calls as possible */
+static GstFlowReturn
+gst_dynudpsink_send_mmsg (GstDynUDPSink * sink, GSocket * socket,
+    GstDynUDPPacket * packets, guint n_packets)
+{
+  struct mmsghdr *msgs;
+  guint n_msgs, sent, i;
+  gint fd;
+
+  if (socket == NULL)
+    return GST_FLOW_OK;
+
+  if (n_packets > sink->n_msgs) {
+    sink->msgs = g_renew (struct mmsghdr, sink->msgs, n_packets);
+    sink->n_msgs = n_packets;
+  }
+  msgs = sink->msgs;
+
+  n_msgs = 0;
+  for (i = 0; i < n_packets; i++) {
+    GstDynUDPDest *dest = packets[i].dest;
+    struct msghdr *hdr = &msgs[n_msgs].msg_hdr;
+
+    if (dest->socket != socket)
+      continue;
+
+    memset (&msgs[n_msgs], 0, sizeof (struct mmsghdr));
+    hdr->msg_name = &dest->native;
+    hdr->msg_namelen = dest->native_len;
+    hdr->msg_iov = (struct iovec *) packets[i].vec;
+    hdr->msg_iovlen = packets[i].n_vec;
+    n_msgs++;
+  }
+
+  fd = g_socket_get_fd (socket);
+  sent = 0;
+  while (sent < n_msgs) {
+    gint ret;
+
+    ret = sendmmsg (fd, msgs + sent, n_msgs - sent, 0);
+
+    if (G_UNLIKELY (ret < 0)) {
+      gint errsv = errno;
+
+      if (errsv == EINTR)
+        continue;
+
+      if (errsv == EAGAIN || errsv == EWOULDBLOCK) {
+        GError *err = NULL;
+
+        /* the sockets of GSocket are non-blocking, wait until the kernel
+         * has room for more packets */
+        if (g_socket_condition_wait (socket, G_IO_OUT, sink->cancellable,
+                &err))
+          continue;
+
+        if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+          g_clear_error (&err);
+          return GST_FLOW_FLUSHING;
+        }
+        g_clear_error (&err);
+      }
+
+      GST_DEBUG ("got send error %s", g_strerror (errsv));
+      return GST_FLOW_ERROR;
+    }
+    sent += ret;
+  }
+
+  GST_LOG ("sent %u packets in %u messages", n_packets, n_msgs);
+
+  return GST_FLOW_OK;
+}
+#endif
+
+static GstFlowReturn
+gst_dynudpsink_send_packets (GstDynUDPSink * sink, GstDynUDPPacket * packets,
+    guint n_packets)
+{
+#ifdef HAVE_SENDMMSG
+  GstFlowReturn ret;
+
+  ret = gst_dynudpsink_send_mmsg (sink, sink->used_socket, packets,
+      n_packets);
+  if (ret == GST_FLOW_OK && sink->used_socket_v6 != sink->used_socket)
+    ret = gst_dynudpsink_send_mmsg (sink, sink->used_socket_v6, packets,
+        n_packets);
 
-  ret =
-      g_socket_send_to (socket, addr, (gchar *) map.data, map.size,
-      sink->cancellable, &err);
-  gst_buffer_unmap (buffer, &map);
+  return ret;
+#else
+  GError *err = NULL;
+  guint i;
 
-  if (ret < 0)
-    goto send_error;
+  for (i = 0; i < n_packets; i++) {
+    GstDynUDPDest *dest = packets[i].dest;
+    gssize ret;
 
-  GST_DEBUG ("sent %" G_GSSIZE_FORMAT " bytes", ret);
+    GST_DEBUG ("about to send %" G_GSIZE_FORMAT " bytes", packets[i].size);
+
+    ret = g_socket_send_message (dest->socket, dest->addr, packets[i].vec,
+        packets[i].n_vec, NULL, 0, 0, sink->cancellable, &err);
+
+    if (ret < 0)
+      goto send_error;
+
+    GST_DEBUG ("sent %" G_GSSIZE_FORMAT " bytes", ret);
+  }
 
   return GST_FLOW_OK;
 
 send_error:
   {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_clear_error (&err);
+      return GST_FLOW_FLUSHING;
+    }
     GST_DEBUG ("got send error %s", err->message);
     g_clear_error (&err);
     return GST_FLOW_ERROR;
   }
-invalid_family:
-  {
-    GST_DEBUG ("invalid address family (got %d)", family);
+#endif
+}
+
+static GstFlowReturn
+gst_dynudpsink_render (GstBaseSink * bsink, GstBuffer * buffer)
+{
+  GstDynUDPSink *sink;
+  GstNetAddressMeta *meta;
+  GstDynUDPPacket packet;
+  GstFlowReturn ret;
+  guint n_mem;
+
+  meta = gst_buffer_get_net_address_meta (buffer);
+
+  if (meta == NULL) {
+    GST_DEBUG ("Received buffer without GstNetAddressMeta, skipping");
+    return GST_FLOW_OK;
+  }
+
+  sink = GST_DYNUDPSINK (bsink);
+
+  gst_dynudpsink_trim_dests (sink);
+
+  /* let's get the address from the metadata */
+  packet.dest = gst_dynudpsink_get_dest (sink, meta->addr);
+  if (packet.dest == NULL)
     return GST_FLOW_ERROR;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  gst_dynudpsink_ensure_vecs (sink, n_mem);
+
+  packet.vec = sink->vec;
+  packet.n_vec = n_mem;
+  packet.size = gst_dynudpsink_map_buffer (sink, buffer, sink->vec, sink->map);
+
+  ret = gst_dynudpsink_send_packets (sink, &packet, 1);
+
+  gst_dynudpsink_unmap (sink, n_mem);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_dynudpsink_render_list (GstBaseSink * bsink, GstBufferList * list)
+{
+  GstDynUDPSink *sink;
+  GstDynUDPPacket *packets;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint n_buffers, n_packets, n_mem, i;
+
+  sink = GST_DYNUDPSINK (bsink);
+
+  n_buffers = gst_buffer_list_length (list);
+  if (n_buffers == 0)
+    return GST_FLOW_OK;
+
+  /* make room for the memory of all buffers, so that all packets of the
+   * list can be handed to the kernel at once */
+  n_mem = 0;
+  for (i = 0; i < n_buffers; i++)
+    n_mem += gst_buffer_n_memory (gst_buffer_list_get (list, i));
+
+  gst_dynudpsink_ensure_vecs (sink, n_mem);
+  if (n_buffers > sink->n_packets) {
+    sink->packets = g_renew (GstDynUDPPacket, sink->packets, n_buffers);
+    sink->n_packets = n_buffers;
   }
+  packets = sink->packets;
+
+  gst_dynudpsink_trim_dests (sink);
+
+  n_mem = 0;
+  n_packets = 0;
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    GstDynUDPPacket *packet = &packets[n_packets];
+    GstNetAddressMeta *meta;
+
+    meta = gst_buffer_get_net_address_meta (buffer);
+    if (meta == NULL) {
+      GST_DEBUG ("Received buffer without GstNetAddressMeta, skipping");
+      continue;
+    }
+
+    packet->dest = gst_dynudpsink_get_dest (sink, meta->addr);
+    if (packet->dest == NULL) {
+      ret = GST_FLOW_ERROR;
+      goto done;
+    }
+
+    packet->vec = &sink->vec[n_mem];
+    packet->n_vec = gst_buffer_n_memory (buffer);
+    packet->size = gst_dynudpsink_map_buffer (sink, buffer, packet->vec,
+        &sink->map[n_mem]);
+    n_mem += packet->n_vec;
+    n_packets++;
+  }
+
+  GST_LOG ("sending %u packets of a list of %u buffers", n_packets,
+      n_buffers);
+
+  if (n_packets > 0)
+    ret = gst_dynudpsink_send_packets (sink, packets, n_packets);
+
+done:
+  gst_dynudpsink_unmap (sink, n_mem);
+
+  return ret;
 }
 
 static void
@@ -518,6 +861,9 @@ gst_dynudpsink_stop (GstBaseSink * bsink)
 
   udpsink = GST_DYNUDPSINK (bsink);
 
+  /* the destinations refer to the sockets */
+  g_hash_table_remove_all (udpsink->dests);
+
   if (udpsink->used_socket) {
     if (udpsink->close_socket || !udpsink->external_socket) {
       GError *err = NULL;
@@ -53,6 +53,22 @@ struct _GstDynUDPSink {
   GSocket *used_socket, *used_socket_v6;
   gboolean external_socket;
   GCancellable *cancellable;
+
+  /* destinations, keyed by the address of the GstNetAddressMeta */
+  GHashTable *dests;
+
+  /* memory of the buffers that are sent together */
+  GOutputVector *vec;
+  GstMapInfo *map;
+  guint n_vec;
+
+  /* packets of a buffer list, pointing into vec */
+  gpointer packets;
+  guint n_packets;
+
+  /* sendmmsg() messages, reused between render calls */
+  gpointer msgs;
+  guint n_msgs;
 };
 
 struct _GstDynUDPSinkClass {
@@ -27,18 +27,32 @@
  * multiudpsink is a network sink that sends UDP packets to multiple
  * clients.
  * It can be combined with rtp payload encoders to implement RTP streaming.
+ *
+ * On systems that support sendmmsg(), a packet is sent to all clients that
+ * share a socket with a single system call. Buffer lists are handled
+ * natively: the memory of all buffers in the list is mapped once and all
+ * packets of the list are sent to all clients together.
+ *
+ * On Linux, the #GstMultiUDPSink:gso property lets the kernel split runs of
+ * equally sized packets of a buffer list, so that each run only passes
+ * through the network stack once per client.
  */
 
 /* FIXME 0.11: suppress warnings for deprecated API such as GValueArray
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* sendmmsg */
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 #include "gstmultiudpsink.h"
 
 #include <string.h>
+#include <errno.h>
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
@@ -47,6 +61,19 @@
 #include <netinet/in.h>
 #endif
 
+#if defined (HAVE_SENDMMSG) && defined (__linux__)
+#define HAVE_UDP_GSO
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+/* limits of the kernel for a segmented message */
+#define UDP_GSO_MAX_SEGMENTS 64
+#define UDP_GSO_MAX_VEC 1024
+#endif
+
 #include "gst/glib-compat-private.h"
 
 GST_DEBUG_CATEGORY_STATIC (multiudpsink_debug);
@@ -94,6 +121,7 @@ enum
 #define DEFAULT_BUFFER_SIZE        0
 #define DEFAULT_BIND_ADDRESS       NULL
 #define DEFAULT_BIND_PORT          0
+#define DEFAULT_GSO                FALSE
 
 enum
 {
@@ -117,6 +145,7 @@ enum
   PROP_BUFFER_SIZE,
   PROP_BIND_ADDRESS,
   PROP_BIND_PORT,
+  PROP_GSO,
   PROP_LAST
 };
 
@@ -124,6 +153,8 @@ static void gst_multiudpsink_finalize (GObject * object);
 
 static GstFlowReturn gst_multiudpsink_render (GstBaseSink * sink,
     GstBuffer * buffer);
+static GstFlowReturn gst_multiudpsink_render_list (GstBaseSink * bsink,
+    GstBufferList * list);
 
 static gboolean gst_multiudpsink_start (GstBaseSink * bsink);
 static gboolean gst_multiudpsink_stop (GstBaseSink * bsink);
@@ -139,6 +170,9 @@ static void gst_multiudpsink_add_internal (GstMultiUDPSink * sink,
     const gchar * host, gint port, gboolean lock);
 static void gst_multiudpsink_clear_internal (GstMultiUDPSink * sink,
     gboolean lock);
+#ifdef HAVE_SENDMMSG
+static void gst_multiudpsink_free_messages (GstMultiUDPSink * sink);
+#endif
 
 static guint gst_multiudpsink_signals[LAST_SIGNAL] = { 0 };
 
@@ -351,6 +385,21 @@ gst_multiudpsink_class_init (GstMultiUDPSinkClass * klass)
           "Port to bind the socket to", 0, G_MAXUINT16,
           DEFAULT_BIND_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiUDPSink:gso:
+   *
+   * Hand runs of equally sized packets of a buffer list to the kernel as one
+   * message per client and let it split them with UDP generic segmentation
+   * offload. This is only available on Linux and is silently not used when
+   * the kernel or the network interface does not support it.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_GSO,
+      g_param_spec_boolean ("gso", "GSO",
+          "Let the kernel segment runs of equally sized packets (Linux only)",
+          DEFAULT_GSO, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&sink_template));
 
@@ -360,6 +409,7 @@ gst_multiudpsink_class_init (GstMultiUDPSinkClass * klass)
       "Wim Taymans <wim.taymans@gmail.com>");
 
   gstbasesink_class->render = gst_multiudpsink_render;
+  gstbasesink_class->render_list = gst_multiudpsink_render_list;
   gstbasesink_class->start = gst_multiudpsink_start;
   gstbasesink_class->stop = gst_multiudpsink_stop;
   gstbasesink_class->unlock = gst_multiudpsink_unlock;
@@ -392,6 +442,7 @@ gst_multiudpsink_init (GstMultiUDPSink * sink)
   sink->force_ipv4 = DEFAULT_FORCE_IPV4;
   sink->qos_dscp = DEFAULT_QOS_DSCP;
   sink->send_duplicates = DEFAULT_SEND_DUPLICATES;
+  sink->gso = DEFAULT_GSO;
   sink->multi_iface = g_strdup (DEFAULT_MULTICAST_IFACE);
 
   sink->cancellable = g_cancellable_new ();
@@ -403,6 +454,7 @@ gst_multiudpsink_init (GstMultiUDPSink * sink)
 
   sink->vec = g_new (GOutputVector, max_mem);
   sink->map = g_new (GstMapInfo, max_mem);
+  sink->n_vec = max_mem;
 }
 
 static GstUDPClient *
@@ -507,6 +559,12 @@ gst_multiudpsink_finalize (GObject * object)
   sink->vec = NULL;
   g_free (sink->map);
   sink->map = NULL;
+  g_free (sink->packets);
+  sink->packets = NULL;
+
+#ifdef HAVE_SENDMMSG
+  gst_multiudpsink_free_messages (sink);
+#endif
 
   g_free (sink->bind_address);
   sink->bind_address = NULL;
@@ -516,18 +574,432 @@ gst_multiudpsink_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* a packet to send to every client, the vectors point into sink->vec */
+typedef struct
+{
+  GOutputVector *vec;
+  guint n_vec;
+  gsize size;
+} GstUDPPacket;
+
+#ifdef HAVE_SENDMMSG
+/* we pass our GOutputVectors to the kernel as struct iovec, like GSocket
+ * does in g_socket_send_message() */
+G_STATIC_ASSERT (sizeof (struct iovec) == sizeof (GOutputVector));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (struct iovec, iov_base) ==
+    G_STRUCT_OFFSET (GOutputVector, buffer));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (struct iovec, iov_len) ==
+    G_STRUCT_OFFSET (GOutputVector, size));
+
+/* packets that are sent as one message */
+typedef struct
+{
+  guint first;
+  guint n_packets;
+  guint n_vec;
+} GstUDPRun;
+
+#ifdef HAVE_UDP_GSO
+typedef union
+{
+  struct cmsghdr hdr;
+  guint8 buf[CMSG_SPACE (sizeof (guint16))];
+} GstUDPControl;
+#endif
+
+/* messages of one sendmmsg() call, grown on demand */
+typedef struct
+{
+  struct mmsghdr *msgs;
+  GstUDPClient **clients;
+  GstUDPRun **runs;
+  guint n_msgs;
+
+  struct sockaddr_storage *addrs;
+  guint n_addrs;
+
+  GstUDPRun *run_list;
+  guint n_run_list;
+
+#ifdef HAVE_UDP_GSO
+  GstUDPControl *controls;
+  guint n_controls;
+#endif
+} GstUDPMessages;
+#endif
+
+static GSocket *
+gst_multiudpsink_get_client_socket (GstMultiUDPSink * sink,
+    GstUDPClient * client)
+{
+  GSocketFamily family;
+
+  family = g_socket_address_get_family (G_SOCKET_ADDRESS (client->addr));
+  /* Select socket to send from for this address */
+  if (family == G_SOCKET_FAMILY_IPV6 || !sink->used_socket)
+    return sink->used_socket_v6;
+  else
+    return sink->used_socket;
+}
+
+static void
+gst_multiudpsink_send_failed (GstMultiUDPSink * sink, gsize size,
+    const gchar * reason)
+{
+  /* we continue after posting a warning, next packets might be ok
+   * again */
+  if (size > UDP_MAX_SIZE) {
+    GST_ELEMENT_WARNING (sink, RESOURCE, WRITE,
+        ("Attempting to send a UDP packet larger than maximum size "
+            "(%" G_GSIZE_FORMAT " > %d)", size, UDP_MAX_SIZE),
+        ("Reason: %s", reason ? reason : "unknown reason"));
+  } else {
+    GST_ELEMENT_WARNING (sink, RESOURCE, WRITE,
+        ("Error sending UDP packet"), ("Reason: %s",
+            reason ? reason : "unknown reason"));
+  }
+}
+
+#ifdef HAVE_SENDMMSG
+static void
+gst_multiudpsink_free_messages (GstMultiUDPSink * sink)
+{
+  GstUDPMessages *messages = sink->messages;
+
+  if (messages == NULL)
+    return;
+
+  g_free (messages->msgs);
+  g_free (messages->clients);
+  g_free (messages->runs);
+  g_free (messages->addrs);
+  g_free (messages->run_list);
+#ifdef HAVE_UDP_GSO
+  g_free (messages->controls);
+#endif
+  g_slice_free (GstUDPMessages, messages);
+  sink->messages = NULL;
+}
+
+/* split @packets into the runs that are sent as one message. Without GSO
+ * every packet is a run of its own, with GSO a run holds packets of the same
+ * size, only its last packet may be smaller. The vectors of consecutive
+ * packets are consecutive as well, so a run can point to the vectors of its
+ * first packet */
+static guint
+gst_multiudpsink_make_runs (GstMultiUDPSink * sink, GstUDPMessages * messages,
+    GstUDPPacket * packets, guint n_packets, gboolean gso)
+{
+  guint i, n_runs;
+
+  if (n_packets > messages->n_run_list) {
+    messages->run_list = g_renew (GstUDPRun, messages->run_list, n_packets);
+    messages->n_run_list = n_packets;
+  }
+
+  n_runs = 0;
+  for (i = 0; i < n_packets;) {
+    GstUDPRun *run = &messages->run_list[n_runs++];
+    guint j = i + 1;
+
+    run->first = i;
+    run->n_vec = packets[i].n_vec;
+
+#ifdef HAVE_UDP_GSO
+    if (gso && packets[i].size > 0) {
+      gsize seg_size = packets[i].size, size = seg_size;
+
+      while (j < n_packets && j - i < UDP_GSO_MAX_SEGMENTS &&
+          packets[j - 1].size == seg_size && packets[j].size > 0 &&
+          packets[j].size <= seg_size &&
+          size + packets[j].size <= UDP_MAX_SIZE &&
+          run->n_vec + packets[j].n_vec <= UDP_GSO_MAX_VEC) {
+        size += packets[j].size;
+        run->n_vec += packets[j].n_vec;
+        j++;
+      }
+    }
+#endif
+
+    run->n_packets = j - i;
+    i = j;
+  }
+
+  return n_runs;
+}
+
+#ifdef HAVE_UDP_GSO
+/* errors for a segmented message that mean the kernel can't segment it */
+static gboolean
+gst_multiudpsink_is_gso_error (gint errsv)
+{
+  return errsv == EIO || errsv == EINVAL || errsv == ENOPROTOOPT ||
+      errsv == EOPNOTSUPP;
+}
+#endif
+
+/* send all packets to all clients that use @socket with as few sendmmsg()
+ * calls as possible. Must be called with the client lock */
+static GstFlowReturn
+gst_multiudpsink_send_mmsg (GstMultiUDPSink * sink, GSocket * socket,
+    GstUDPPacket * packets, guint n_packets, gint * num)
+{
+  GstUDPMessages *messages;
+  GList *clients;
+  guint n_msgs, n_addrs, n_runs, sent, done, skip, i;
+  gint fd;
+
+  if (socket == NULL)
+    return GST_FLOW_OK;
+
+  if (sink->messages == NULL)
+    sink->messages = g_slice_new0 (GstUDPMessages);
+  messages = sink->messages;
+
+  /* packets that were already sent to clients before GSO was disabled */
+  skip = 0;
+
+again:
+  n_runs = gst_multiudpsink_make_runs (sink, messages, packets, n_packets,
+      sink->gso_active);
+
+  /* first figure out how many messages we need */
+  n_msgs = n_addrs = 0;
+  for (clients = sink->clients; clients; clients = g_list_next (clients)) {
+    GstUDPClient *client = (GstUDPClient *) clients->data;
+
+    if (gst_multiudpsink_get_client_socket (sink, client) != socket)
+      continue;
+
+    n_addrs++;
+    n_msgs += (sink->send_duplicates ? client->refcount : 1) * n_runs;
+  }
+
+  if (n_msgs == 0)
+    return GST_FLOW_OK;
+
+  if (n_msgs > messages->n_msgs) {
+    messages->msgs = g_renew (struct mmsghdr, messages->msgs, n_msgs);
+    messages->clients = g_renew (GstUDPClient *, messages->clients, n_msgs);
+    messages->runs = g_renew (GstUDPRun *, messages->runs, n_msgs);
+    messages->n_msgs = n_msgs;
+  }
+  if (n_addrs > messages->n_addrs) {
+    messages->addrs = g_renew (struct sockaddr_storage, messages->addrs,
+        n_addrs);
+    messages->n_addrs = n_addrs;
+  }
+#ifdef HAVE_UDP_GSO
+  if (n_runs < n_packets && n_msgs > messages->n_controls) {
+    messages->controls = g_renew (GstUDPControl, messages->controls, n_msgs);
+    messages->n_controls = n_msgs;
+  }
+#endif
+
+  /* now fill in the messages, all messages for the same client share the
+   * native address and all messages of the same run its vectors */
+  memset (messages->msgs, 0, n_msgs * sizeof (struct mmsghdr));
+  n_msgs = n_addrs = 0;
+  for (clients = sink->clients; clients; clients = g_list_next (clients)) {
+    GstUDPClient *client = (GstUDPClient *) clients->data;
+    struct sockaddr_storage *addr;
+    gssize addr_len;
+    gint count;
+
+    if (gst_multiudpsink_get_client_socket (sink, client) != socket)
+      continue;
+
+    addr = &messages->addrs[n_addrs];
+    addr_len = g_socket_address_get_native_size (client->addr);
+    if (addr_len < 0 || !g_socket_address_to_native (client->addr, addr,
+            sizeof (struct sockaddr_storage), NULL)) {
+      GST_WARNING_OBJECT (sink, "could not convert address of client %p",
+          client);
+      continue;
+    }
+    n_addrs++;
+
+    count = sink->send_duplicates ? client->refcount : 1;
+    while (count--) {
+      for (i = 0; i < n_runs; i++) {
+        GstUDPRun *run = &messages->run_list[i];
+        struct msghdr *hdr = &messages->msgs[n_msgs].msg_hdr;
+
+        hdr->msg_name = addr;
+        hdr->msg_namelen = addr_len;
+        hdr->msg_iov = (struct iovec *) packets[run->first].vec;
+        hdr->msg_iovlen = run->n_vec;
+
+#ifdef HAVE_UDP_GSO
+        if (run->n_packets > 1) {
+          GstUDPControl *control = &messages->controls[n_msgs];
+          struct cmsghdr *cmsg = &control->hdr;
+          guint16 seg_size = packets[run->first].size;
+
+          memset (control, 0, sizeof (GstUDPControl));
+          hdr->msg_control = control->buf;
+          hdr->msg_controllen = sizeof (control->buf);
+          cmsg->cmsg_level = SOL_UDP;
+          cmsg->cmsg_type = UDP_SEGMENT;
+          cmsg->cmsg_len = CMSG_LEN (sizeof (guint16));
+          memcpy (CMSG_DATA (cmsg), &seg_size, sizeof (guint16));
+        }
+#endif
+
+        messages->clients[n_msgs] = client;
+        messages->runs[n_msgs] = run;
+        n_msgs++;
+      }
+    }
+  }
+
+  GST_LOG_OBJECT (sink, "sending %u messages with %u runs of %u packets to "
+      "%u clients", n_msgs, n_runs, n_packets, n_addrs);
+
+  fd = g_socket_get_fd (socket);
+  /* without GSO there is one message for every packet */
+  sent = done = skip;
+  while (sent < n_msgs) {
+    gint ret;
+
+    ret = sendmmsg (fd, messages->msgs + sent, n_msgs - sent, 0);
+
+    if (G_UNLIKELY (ret < 0)) {
+      gint errsv = errno;
+
+      if (errsv == EINTR)
+        continue;
+
+      if (errsv == EAGAIN || errsv == EWOULDBLOCK) {
+        GError *err = NULL;
+
+        /* our sockets are non-blocking, wait until the kernel has room for
+         * more packets */
+        if (g_socket_condition_wait (socket, G_IO_OUT, sink->cancellable,
+                &err))
+          continue;
+
+        if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+          g_clear_error (&err);
+          return GST_FLOW_FLUSHING;
+        }
+        g_clear_error (&err);
+      }
+#ifdef HAVE_UDP_GSO
+      /* the device can't do it after all, send everything that is left one
+       * packet per message from now on */
+      if (messages->runs[sent]->n_packets > 1 &&
+          gst_multiudpsink_is_gso_error (errsv)) {
+        GST_INFO_OBJECT (sink, "disabling UDP GSO: %s", g_strerror (errsv));
+        sink->gso_active = FALSE;
+        skip = done;
+        goto again;
+      }
+#endif
+
+      /* the kernel failed on the first message it was given, skip that one
+       * and try again with the remaining ones */
+      gst_multiudpsink_send_failed (sink,
+          packets[messages->runs[sent]->first].size, g_strerror (errsv));
+      done += messages->runs[sent]->n_packets;
+      sent++;
+      continue;
+    }
+
+    for (i = sent; i < sent + ret; i++) {
+      GstUDPClient *client = messages->clients[i];
+      guint n = messages->runs[i]->n_packets;
+
+      client->bytes_sent += messages->msgs[i].msg_len;
+      client->packets_sent += n;
+      sink->bytes_served += messages->msgs[i].msg_len;
+      done += n;
+      *num += n;
+    }
+    sent += ret;
+  }
+
+  return GST_FLOW_OK;
+}
+#endif
+
+/* send all packets to all clients. Must be called with the client lock */
+static GstFlowReturn
+gst_multiudpsink_send_packets (GstMultiUDPSink * sink, GstUDPPacket * packets,
+    guint n_packets, gint * num)
+{
+#ifdef HAVE_SENDMMSG
+  GstFlowReturn ret;
+
+  ret = gst_multiudpsink_send_mmsg (sink, sink->used_socket, packets,
+      n_packets, num);
+  if (ret == GST_FLOW_OK && sink->used_socket_v6 != sink->used_socket)
+    ret = gst_multiudpsink_send_mmsg (sink, sink->used_socket_v6, packets,
+        n_packets, num);
+
+  return ret;
+#else
+  GList *clients;
+  GError *err = NULL;
+
+  for (clients = sink->clients; clients; clients = g_list_next (clients)) {
+    GstUDPClient *client;
+    GSocket *socket;
+    gint count;
+
+    client = (GstUDPClient *) clients->data;
+    socket = gst_multiudpsink_get_client_socket (sink, client);
+
+    count = sink->send_duplicates ? client->refcount : 1;
+
+    while (count--) {
+      guint i;
+
+      for (i = 0; i < n_packets; i++) {
+        gssize ret;
+
+        GST_LOG_OBJECT (sink, "sending %" G_GSIZE_FORMAT " bytes to client %p",
+            packets[i].size, client);
+
+        ret =
+            g_socket_send_message (socket, client->addr, packets[i].vec,
+            packets[i].n_vec, NULL, 0, 0, sink->cancellable, &err);
+
+        if (G_UNLIKELY (ret < 0)) {
+          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_clear_error (&err);
+            return GST_FLOW_FLUSHING;
+          }
+
+          gst_multiudpsink_send_failed (sink, packets[i].size,
+              err ? err->message : NULL);
+          g_clear_error (&err);
+        } else {
+          (*num)++;
+          client->bytes_sent += ret;
+          client->packets_sent++;
+          sink->bytes_served += ret;
+        }
+      }
+    }
+  }
+
+  return GST_FLOW_OK;
+#endif
+}
+
 static GstFlowReturn
 gst_multiudpsink_render (GstBaseSink * bsink, GstBuffer * buffer)
 {
   GstMultiUDPSink *sink;
-  GList *clients;
+  GstUDPPacket packet;
+  GstFlowReturn ret;
   GOutputVector *vec;
   GstMapInfo *map;
   guint n_mem, i;
   gsize size;
   GstMemory *mem;
   gint num, no_clients;
-  GError *err = NULL;
 
   sink = GST_MULTIUDPSINK (bsink);
 
@@ -553,76 +1025,139 @@ gst_multiudpsink_render (GstBaseSink * bsink, GstBuffer * buffer)
 
   sink->bytes_to_serve += size;
 
+  packet.vec = vec;
+  packet.n_vec = n_mem;
+  packet.size = size;
+
   /* grab lock while iterating and sending to clients, this should be
    * fast as UDP never blocks */
   g_mutex_lock (&sink->client_lock);
   GST_LOG_OBJECT (bsink, "about to send %" G_GSIZE_FORMAT " bytes in %u blocks",
       size, n_mem);
 
-  no_clients = 0;
+  no_clients = g_list_length (sink->clients);
   num = 0;
-  for (clients = sink->clients; clients; clients = g_list_next (clients)) {
-    GstUDPClient *client;
-    GSocket *socket;
-    GSocketFamily family;
-    gint count;
+  ret = gst_multiudpsink_send_packets (sink, &packet, 1, &num);
+  g_mutex_unlock (&sink->client_lock);
 
-    client = (GstUDPClient *) clients->data;
-    no_clients++;
-    GST_LOG_OBJECT (sink, "sending %" G_GSIZE_FORMAT " bytes to client %p",
-        size, client);
+  /* unmap all memory again */
+  for (i = 0; i < n_mem; i++) {
+    gst_memory_unmap (map[i].memory, &map[i]);
+    gst_memory_unref (map[i].memory);
+  }
 
-    family = g_socket_address_get_family (G_SOCKET_ADDRESS (client->addr));
-    /* Select socket to send from for this address */
-    if (family == G_SOCKET_FAMILY_IPV6 || !sink->used_socket)
-      socket = sink->used_socket_v6;
-    else
-      socket = sink->used_socket;
+  if (ret == GST_FLOW_FLUSHING)
+    goto flushing;
 
-    count = sink->send_duplicates ? client->refcount : 1;
+  GST_LOG_OBJECT (sink, "sent %" G_GSIZE_FORMAT " bytes to %d (of %d) clients",
+      size, num, no_clients);
 
-    while (count--) {
-      gssize ret;
+  return GST_FLOW_OK;
 
-      ret =
-          g_socket_send_message (socket, client->addr, vec, n_mem,
-          NULL, 0, 0, sink->cancellable, &err);
-
-      if (G_UNLIKELY (ret < 0)) {
-        if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-          goto flushing;
-
-        /* we continue after posting a warning, next packets might be ok
-         * again */
-        if (size > UDP_MAX_SIZE) {
-          GST_ELEMENT_WARNING (sink, RESOURCE, WRITE,
-              ("Attempting to send a UDP packet larger than maximum size "
-                  "(%" G_GSIZE_FORMAT " > %d)", size, UDP_MAX_SIZE),
-              ("Reason: %s", err ? err->message : "unknown reason"));
-        } else {
-          GST_ELEMENT_WARNING (sink, RESOURCE, WRITE,
-              ("Error sending UDP packet"), ("Reason: %s",
-                  err ? err->message : "unknown reason"));
-        }
-        g_clear_error (&err);
-      } else {
-        num++;
-        client->bytes_sent += ret;
-        client->packets_sent++;
-        sink->bytes_served += ret;
-      }
+no_data:
+  {
+    return GST_FLOW_OK;
+  }
+flushing:
+  {
+    GST_DEBUG ("we are flushing");
+    return GST_FLOW_FLUSHING;
+  }
+}
+
+static GstFlowReturn
+gst_multiudpsink_render_list (GstBaseSink * bsink, GstBufferList * list)
+{
+  GstMultiUDPSink *sink;
+  GstUDPPacket *packets;
+  GstFlowReturn ret;
+  GOutputVector *vec;
+  GstMapInfo *map;
+  guint n_buffers, n_packets, n_mem, i, j;
+  gsize size;
+  gint num, no_clients;
+
+  sink = GST_MULTIUDPSINK (bsink);
+
+  n_buffers = gst_buffer_list_length (list);
+  if (n_buffers == 0)
+    goto no_data;
+
+  /* make room for the memory of all buffers, so that everything only needs
+   * to be mapped once and not again for every client */
+  n_mem = 0;
+  for (i = 0; i < n_buffers; i++)
+    n_mem += gst_buffer_n_memory (gst_buffer_list_get (list, i));
+
+  if (n_mem == 0)
+    goto no_data;
+
+  if (n_mem > sink->n_vec) {
+    sink->vec = g_renew (GOutputVector, sink->vec, n_mem);
+    sink->map = g_renew (GstMapInfo, sink->map, n_mem);
+    sink->n_vec = n_mem;
+  }
+  if (n_buffers > sink->n_packets) {
+    sink->packets = g_renew (GstUDPPacket, sink->packets, n_buffers);
+    sink->n_packets = n_buffers;
+  }
+
+  vec = sink->vec;
+  map = sink->map;
+  packets = sink->packets;
+
+  size = 0;
+  n_mem = 0;
+  n_packets = 0;
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    GstUDPPacket *packet = &packets[n_packets];
+    guint n;
+
+    n = gst_buffer_n_memory (buffer);
+    if (n == 0)
+      continue;
+
+    packet->vec = &vec[n_mem];
+    packet->n_vec = n;
+    packet->size = 0;
+
+    for (j = 0; j < n; j++) {
+      GstMemory *mem = gst_buffer_get_memory (buffer, j);
+
+      gst_memory_map (mem, &map[n_mem], GST_MAP_READ);
+
+      vec[n_mem].buffer = map[n_mem].data;
+      vec[n_mem].size = map[n_mem].size;
+
+      packet->size += map[n_mem].size;
+      n_mem++;
     }
+    size += packet->size;
+    n_packets++;
   }
+
+  sink->bytes_to_serve += size;
+
+  g_mutex_lock (&sink->client_lock);
+  GST_LOG_OBJECT (bsink, "about to send %u packets with %" G_GSIZE_FORMAT
+      " bytes in %u blocks", n_packets, size, n_mem);
+
+  no_clients = g_list_length (sink->clients);
+  num = 0;
+  ret = gst_multiudpsink_send_packets (sink, packets, n_packets, &num);
   g_mutex_unlock (&sink->client_lock);
 
-  /* unmap all memory again */
   for (i = 0; i < n_mem; i++) {
     gst_memory_unmap (map[i].memory, &map[i]);
     gst_memory_unref (map[i].memory);
   }
 
-  GST_LOG_OBJECT (sink, "sent %" G_GSIZE_FORMAT " bytes to %d (of %d) clients",
-      size, num, no_clients);
+  if (ret == GST_FLOW_FLUSHING)
+    goto flushing;
+
+  GST_LOG_OBJECT (sink, "sent %d packets of %u to %d clients", num,
+      n_packets, no_clients);
 
   return GST_FLOW_OK;
 
@@ -633,15 +1168,6 @@ no_data:
 flushing:
   {
     GST_DEBUG ("we are flushing");
-    g_mutex_unlock (&sink->client_lock);
-    g_clear_error (&err);
-
-    /* unmap all memory */
-    for (i = 0; i < n_mem; i++) {
-      gst_memory_unmap (map[i].memory, &map[i]);
-      gst_memory_unref (map[i].memory);
-    }
-
     return GST_FLOW_FLUSHING;
   }
 }
@@ -705,6 +1231,30 @@ gst_multiudpsink_get_clients_string (GstMultiUDPSink * sink)
   return g_string_free (str, FALSE);
 }
 
+/* older kernels ignore the UDP_SEGMENT control message and would send a
+ * whole run as one packet, so check that they know the socket option */
+static gboolean
+gst_multiudpsink_setup_gso (GstMultiUDPSink * sink, GSocket * socket)
+{
+#ifdef HAVE_UDP_GSO
+  gint val = 0;
+
+  if (socket == NULL)
+    return TRUE;
+
+  if (setsockopt (g_socket_get_fd (socket), SOL_UDP, UDP_SEGMENT, &val,
+          sizeof (val)) < 0) {
+    GST_INFO_OBJECT (sink, "no UDP GSO support: %s", g_strerror (errno));
+    return FALSE;
+  }
+
+  return TRUE;
+#else
+  GST_INFO_OBJECT (sink, "no UDP GSO support on this platform");
+  return FALSE;
+#endif
+}
+
 static void
 gst_multiudpsink_setup_qos_dscp (GstMultiUDPSink * sink, GSocket * socket)
 {
@@ -828,6 +1378,9 @@ gst_multiudpsink_set_property (GObject * object, guint prop_id,
     case PROP_BIND_PORT:
       udpsink->bind_port = g_value_get_int (value);
       break;
+    case PROP_GSO:
+      udpsink->gso = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -901,6 +1454,9 @@ gst_multiudpsink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_BIND_PORT:
       g_value_set_int (value, udpsink->bind_port);
       break;
+    case PROP_GSO:
+      g_value_set_boolean (value, udpsink->gso);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1160,6 +1716,10 @@ gst_multiudpsink_start (GstBaseSink * bsink)
   gst_multiudpsink_setup_qos_dscp (sink, sink->used_socket);
   gst_multiudpsink_setup_qos_dscp (sink, sink->used_socket_v6);
 
+  sink->gso_active = sink->gso && gst_multiudpsink_setup_gso (sink,
+      sink->used_socket) && gst_multiudpsink_setup_gso (sink,
+      sink->used_socket_v6);
+
   /* look for multicast clients and join multicast groups appropriately
      set also ttl and multicast loopback delivery appropriately  */
   for (clients = sink->clients; clients; clients = g_list_next (clients)) {
@@ -64,6 +64,14 @@ struct _GstMultiUDPSink {
 
   GOutputVector *vec;
   GstMapInfo *map;
+  guint          n_vec;
+
+  /* packets of a buffer list, all pointing into vec */
+  gpointer       packets;
+  guint          n_packets;
+
+  /* sendmmsg() messages, reused between render calls */
+  gpointer       messages;
 
   /* properties */
   guint64        bytes_to_serve;
@@ -85,6 +93,10 @@ struct _GstMultiUDPSink {
   gint           buffer_size;
   gchar         *bind_address;
   gint           bind_port;
+  gboolean       gso;
+
+  /* GSO is requested and works with our sockets */
+  gboolean       gso_active;
 };
 
 struct _GstMultiUDPSinkClass {
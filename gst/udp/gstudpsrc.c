@@ -59,6 +59,31 @@
  * (such as an MPEG demuxer). As with all live sources, the captured buffers
  * will have their timestamp set to the current running time of the pipeline.
  *
+ * When receiving high packet rates, the #GstUDPSrc:batch-size property can be
+ * set to read up to that many packets from the socket every time it becomes
+ * readable. On Linux this is done with a single recvmmsg() call, elsewhere the
+ * packets are read one after another without waiting on the socket again. All
+ * packets of a batch are timestamped with the running time at which they were
+ * read and are then pushed downstream one by one. Packets bigger than
+ * #GstUDPSrc:mtu are still received completely, but need an extra copy.
+ *
+ * With #GstUDPSrc:kernel-timestamps enabled, packets are timestamped with the
+ * time at which the kernel received them instead of the time at which udpsrc
+ * read them from the socket, which removes the scheduling jitter of the
+ * streaming thread from the timestamps. This is only supported on Linux.
+ *
+ * With #GstUDPSrc:gro enabled, the kernel may coalesce consecutive packets of
+ * the same size from the same sender into one datagram, which is read with a
+ * single copy into one buffer. udpsrc then splits it again into one buffer
+ * per original packet, all sharing the memory of the coalesced datagram, so
+ * downstream elements see the same packets as without it. This is only
+ * supported on Linux.
+ *
+ * Packets are received into buffers of #GstUDPSrc:mtu bytes from a buffer
+ * pool. The buffers are trimmed to the size of the packet they hold and are
+ * restored to their full size when they are returned to the pool, so the
+ * same memory is reused for every packet in steady state.
+ *
  * udpsrc implements a #GstURIHandler interface that handles udp://host:port
  * type URIs.
  *
@@ -104,11 +129,19 @@
  *
  * Last reviewed on 2007-09-20 (0.10.7)
  */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* recvmmsg */
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <string.h>
+#include <errno.h>
+
 #include "gstudpsrc.h"
+#include <gst/pool/gsttrimbufferpool.h>
 
 #include <gst/net/gstnetaddressmeta.h>
 
@@ -131,9 +164,35 @@
 #endif
 #endif
 
+#ifdef HAVE_RECVMMSG
+#include <sys/socket.h>
+#if defined (SO_TIMESTAMPNS) && defined (SCM_TIMESTAMPNS)
+#define HAVE_KERNEL_TIMESTAMPS 1
+#endif
+#ifdef __linux__
+#define HAVE_UDP_GRO 1
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+#endif
+
+#if defined (HAVE_KERNEL_TIMESTAMPS) || defined (HAVE_UDP_GRO)
+#define HAVE_CONTROL_MESSAGES 1
+/* room for a receive timestamp and the segment size of a GRO datagram */
+#define CONTROL_SIZE (CMSG_SPACE (sizeof (struct timespec)) + \
+    CMSG_SPACE (sizeof (gint)))
+#endif
+
 /* not 100% correct, but a good upper bound for memory allocation purposes */
 #define MAX_IPV4_UDP_PACKET_SIZE (65536 - 8)
 
+/* the kernel does not accept more messages per recvmmsg() call */
+#define MAX_BATCH_SIZE 1024
+
 GST_DEBUG_CATEGORY_STATIC (udpsrc_debug);
 #define GST_CAT_DEFAULT (udpsrc_debug)
 
@@ -155,6 +214,10 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 #define UDP_DEFAULT_USED_SOCKET        NULL
 #define UDP_DEFAULT_AUTO_MULTICAST     TRUE
 #define UDP_DEFAULT_REUSE              TRUE
+#define UDP_DEFAULT_BATCH_SIZE         1
+#define UDP_DEFAULT_MTU                1500
+#define UDP_DEFAULT_KERNEL_TIMESTAMPS  FALSE
+#define UDP_DEFAULT_GRO                FALSE
 
 enum
 {
@@ -174,6 +237,10 @@ enum
   PROP_AUTO_MULTICAST,
   PROP_REUSE,
   PROP_ADDRESS,
+  PROP_BATCH_SIZE,
+  PROP_MTU,
+  PROP_KERNEL_TIMESTAMPS,
+  PROP_GRO,
 
   PROP_LAST
 };
@@ -192,6 +259,9 @@ static gboolean gst_udpsrc_unlock (GstBaseSrc * bsrc);
 
 static gboolean gst_udpsrc_unlock_stop (GstBaseSrc * bsrc);
 
+static gboolean gst_udpsrc_decide_allocation (GstBaseSrc * bsrc,
+    GstQuery * query);
+
 static void gst_udpsrc_finalize (GObject * object);
 
 static void gst_udpsrc_set_property (GObject * object, guint prop_id,
@@ -285,6 +355,26 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
           "Address to receive packets for. This is equivalent to the "
           "multicast-group property for now", UDP_DEFAULT_MULTICAST_GROUP,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Maximum number of packets to read from the socket per wakeup "
+          "(1 = read one packet at a time)", 1, MAX_BATCH_SIZE,
+          UDP_DEFAULT_BATCH_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MTU,
+      g_param_spec_uint ("mtu", "MTU",
+          "Expected maximum packet size, used to size the receive buffers",
+          1, G_MAXINT, UDP_DEFAULT_MTU,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_KERNEL_TIMESTAMPS,
+      g_param_spec_boolean ("kernel-timestamps", "Kernel Timestamps",
+          "Timestamp packets with the time the kernel received them "
+          "(Linux only)", UDP_DEFAULT_KERNEL_TIMESTAMPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_GRO,
+      g_param_spec_boolean ("gro", "GRO",
+          "Let the kernel coalesce packets and split them again in udpsrc "
+          "(Linux only)", UDP_DEFAULT_GRO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_template));
@@ -300,6 +390,7 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
   gstbasesrc_class->unlock = gst_udpsrc_unlock;
   gstbasesrc_class->unlock_stop = gst_udpsrc_unlock_stop;
   gstbasesrc_class->get_caps = gst_udpsrc_getcaps;
+  gstbasesrc_class->decide_allocation = gst_udpsrc_decide_allocation;
 
   gstpushsrc_class->create = gst_udpsrc_create;
 }
@@ -323,6 +414,12 @@ gst_udpsrc_init (GstUDPSrc * udpsrc)
   udpsrc->auto_multicast = UDP_DEFAULT_AUTO_MULTICAST;
   udpsrc->used_socket = UDP_DEFAULT_USED_SOCKET;
   udpsrc->reuse = UDP_DEFAULT_REUSE;
+  udpsrc->batch_size = UDP_DEFAULT_BATCH_SIZE;
+  udpsrc->mtu = UDP_DEFAULT_MTU;
+  udpsrc->kernel_timestamps = UDP_DEFAULT_KERNEL_TIMESTAMPS;
+  udpsrc->gro = UDP_DEFAULT_GRO;
+
+  g_queue_init (&udpsrc->pending);
 
   udpsrc->cancellable = g_cancellable_new ();
 
@@ -385,6 +482,445 @@ gst_udpsrc_getcaps (GstBaseSrc * src, GstCaps * filter)
   }
 }
 
+/* one receive slot of a batch: a buffer of mtu bytes that stays mapped until
+ * a packet was read into it, and an overflow area for packets that turn out
+ * to be bigger than the mtu */
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint8 *extra;
+  gsize extra_size;
+#ifdef HAVE_RECVMMSG
+  struct iovec iov[2];
+  struct sockaddr_storage addr;
+#ifdef HAVE_CONTROL_MESSAGES
+  union
+  {
+    struct cmsghdr align;
+    gchar buf[CONTROL_SIZE];
+  } control;
+#endif
+#endif
+} GstUDPSrcSlot;
+
+typedef struct
+{
+  GstUDPSrcSlot *slots;
+#ifdef HAVE_RECVMMSG
+  struct mmsghdr *msgs;
+#endif
+} GstUDPSrcBatch;
+
+static void
+gst_udpsrc_free_batch (GstUDPSrc * src)
+{
+  GstUDPSrcBatch *batch = src->batch;
+  guint i;
+
+  if (batch == NULL)
+    return;
+
+  for (i = 0; i < src->n_batch; i++) {
+    GstUDPSrcSlot *slot = &batch->slots[i];
+
+    if (slot->buffer) {
+      gst_buffer_unmap (slot->buffer, &slot->map);
+      gst_buffer_unref (slot->buffer);
+    }
+    g_free (slot->extra);
+  }
+  g_free (batch->slots);
+#ifdef HAVE_RECVMMSG
+  g_free (batch->msgs);
+#endif
+  g_slice_free (GstUDPSrcBatch, batch);
+
+  src->batch = NULL;
+  src->n_batch = 0;
+}
+
+static void
+gst_udpsrc_flush_pending (GstUDPSrc * src)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&src->pending)))
+    gst_buffer_unref (buf);
+}
+
+/* make sure we have batch_size slots with a mapped buffer each */
+static GstFlowReturn
+gst_udpsrc_prepare_batch (GstUDPSrc * src)
+{
+  GstUDPSrcBatch *batch;
+  GstFlowReturn ret;
+  guint i;
+
+  if (src->batch && src->n_batch != src->batch_size)
+    gst_udpsrc_free_batch (src);
+
+  if (src->batch == NULL) {
+    batch = g_slice_new0 (GstUDPSrcBatch);
+    batch->slots = g_new0 (GstUDPSrcSlot, src->batch_size);
+#ifdef HAVE_RECVMMSG
+    batch->msgs = g_new0 (struct mmsghdr, src->batch_size);
+#endif
+    src->batch = batch;
+    src->n_batch = src->batch_size;
+  }
+  batch = src->batch;
+
+  for (i = 0; i < src->n_batch; i++) {
+    GstUDPSrcSlot *slot = &batch->slots[i];
+
+    if (slot->buffer != NULL)
+      continue;
+
+    /* coalesced datagrams are much bigger than the pool buffers, they are
+     * received in one piece and then shared by the packets they hold */
+    if (src->gro_active) {
+      slot->buffer = gst_buffer_new_allocate (NULL, MAX_IPV4_UDP_PACKET_SIZE,
+          NULL);
+    } else {
+      ret = GST_BASE_SRC_CLASS (parent_class)->alloc (GST_BASE_SRC_CAST (src),
+          -1, src->mtu, &slot->buffer);
+      if (ret != GST_FLOW_OK) {
+        slot->buffer = NULL;
+        return ret;
+      }
+    }
+    gst_buffer_map (slot->buffer, &slot->map, GST_MAP_WRITE);
+
+    if (slot->extra == NULL && slot->map.size < MAX_IPV4_UDP_PACKET_SIZE) {
+      slot->extra_size = MAX_IPV4_UDP_PACKET_SIZE - slot->map.size;
+      slot->extra = g_malloc (slot->extra_size);
+    }
+#ifdef HAVE_RECVMMSG
+    slot->iov[0].iov_base = slot->map.data;
+    slot->iov[0].iov_len = slot->map.size;
+    slot->iov[1].iov_base = slot->extra;
+    slot->iov[1].iov_len = slot->extra_size;
+    batch->msgs[i].msg_hdr.msg_iov = slot->iov;
+    batch->msgs[i].msg_hdr.msg_iovlen = slot->extra ? 2 : 1;
+    batch->msgs[i].msg_hdr.msg_name = &slot->addr;
+#ifdef HAVE_CONTROL_MESSAGES
+    batch->msgs[i].msg_hdr.msg_control = &slot->control;
+#endif
+#endif
+  }
+
+  return GST_FLOW_OK;
+}
+
+/* trim @outbuf to the packet of @size bytes it holds and queue it */
+static GstFlowReturn
+gst_udpsrc_queue_packet (GstUDPSrc * src, GstBuffer * outbuf, gsize size,
+    GSocketAddress * saddr, GstClockTime timestamp)
+{
+  if (G_UNLIKELY (src->skip_first_bytes != 0)) {
+    if (G_UNLIKELY (size < (gsize) src->skip_first_bytes))
+      goto skip_error;
+
+    gst_buffer_resize (outbuf, src->skip_first_bytes,
+        size - src->skip_first_bytes);
+  } else {
+    gst_buffer_resize (outbuf, 0, size);
+  }
+
+  if (saddr)
+    gst_buffer_add_net_address_meta (outbuf, saddr);
+
+  GST_BUFFER_PTS (outbuf) = timestamp;
+  GST_BUFFER_DTS (outbuf) = timestamp;
+
+  g_queue_push_tail (&src->pending, outbuf);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+skip_error:
+  {
+    gst_buffer_unref (outbuf);
+
+    GST_ELEMENT_ERROR (src, STREAM, DECODE, (NULL),
+        ("UDP buffer to small to skip header"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* turn the packet of @size bytes that was read into @slot into an output
+ * buffer and queue it. When the kernel coalesced packets of @seg_size bytes
+ * into it, queue one buffer for each of them instead */
+static GstFlowReturn
+gst_udpsrc_finish_slot (GstUDPSrc * src, GstUDPSrcSlot * slot, gsize size,
+    gsize seg_size, GSocketAddress * saddr, GstClockTime timestamp)
+{
+  GstBuffer *outbuf;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gsize avail, offset;
+
+  outbuf = slot->buffer;
+  avail = slot->map.size;
+  gst_buffer_unmap (outbuf, &slot->map);
+  slot->buffer = NULL;
+
+  if (G_UNLIKELY (size == 0)) {
+    /* like in the non-batched case we don't want 0 sized buffers */
+    gst_buffer_unref (outbuf);
+    return GST_FLOW_OK;
+  }
+
+  if (G_UNLIKELY (size > avail)) {
+    GstMemory *mem;
+    GstMapInfo info;
+
+    GST_LOG_OBJECT (src, "packet of %" G_GSIZE_FORMAT " bytes bigger than "
+        "mtu %u, copying remainder", size, src->mtu);
+
+    mem = gst_allocator_alloc (NULL, size - avail, NULL);
+    gst_memory_map (mem, &info, GST_MAP_WRITE);
+    memcpy (info.data, slot->extra, size - avail);
+    gst_memory_unmap (mem, &info);
+    gst_buffer_append_memory (outbuf, mem);
+  }
+
+  if (seg_size == 0 || size <= seg_size)
+    return gst_udpsrc_queue_packet (src, outbuf, size, saddr, timestamp);
+
+  GST_LOG_OBJECT (src, "splitting %" G_GSIZE_FORMAT " bytes into packets of %"
+      G_GSIZE_FORMAT " bytes", size, seg_size);
+
+  /* the packets only share the memory of the coalesced datagram */
+  for (offset = 0; offset < size && ret == GST_FLOW_OK; offset += seg_size) {
+    gsize len = MIN (seg_size, size - offset);
+    GstBuffer *sub;
+
+    sub = gst_buffer_copy_region (outbuf, GST_BUFFER_COPY_MEMORY, offset, len);
+    ret = gst_udpsrc_queue_packet (src, sub, len, saddr, timestamp);
+  }
+  gst_buffer_unref (outbuf);
+
+  return ret;
+}
+
+/* running time of the packets of the current batch. basesrc only
+ * timestamps buffers that don't have a timestamp yet, so without this all
+ * but the first packet of a batch would get the time they were dequeued */
+static GstClockTime
+gst_udpsrc_get_running_time (GstUDPSrc * src)
+{
+  GstClock *clock;
+  GstClockTime base_time, now;
+
+  GST_OBJECT_LOCK (src);
+  if ((clock = GST_ELEMENT_CLOCK (src)) == NULL) {
+    GST_OBJECT_UNLOCK (src);
+    return GST_CLOCK_TIME_NONE;
+  }
+  base_time = GST_ELEMENT_CAST (src)->base_time;
+  gst_object_ref (clock);
+  GST_OBJECT_UNLOCK (src);
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  if (now < base_time)
+    return GST_CLOCK_TIME_NONE;
+
+  return now - base_time;
+}
+
+#ifdef HAVE_KERNEL_TIMESTAMPS
+/* running time of a packet the kernel received at @ts, given the current
+ * running time @now. The kernel uses the system's realtime clock, which is
+ * not necessarily the pipeline clock, so we only take the age of the packet
+ * from it */
+static GstClockTime
+gst_udpsrc_kernel_running_time (struct msghdr *hdr, GstClockTime now,
+    GstClockTime now_real)
+{
+  struct cmsghdr *cmsg;
+
+  if (!GST_CLOCK_TIME_IS_VALID (now))
+    return now;
+
+  for (cmsg = CMSG_FIRSTHDR (hdr); cmsg; cmsg = CMSG_NXTHDR (hdr, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      struct timespec ts;
+      GstClockTime received, age;
+
+      memcpy (&ts, CMSG_DATA (cmsg), sizeof (ts));
+      received = GST_TIMESPEC_TO_TIME (ts);
+
+      /* realtime clock jumps could make packets appear to be from the
+       * future */
+      age = (now_real > received) ? now_real - received : 0;
+
+      return (now > age) ? now - age : 0;
+    }
+  }
+
+  /* no timestamp from the kernel, use the current time */
+  return now;
+}
+#endif
+
+#ifdef HAVE_UDP_GRO
+/* size of the packets the kernel coalesced into the datagram of @hdr, or 0
+ * if it holds a single packet */
+static gsize
+gst_udpsrc_gro_segment_size (struct msghdr *hdr)
+{
+  struct cmsghdr *cmsg;
+
+  for (cmsg = CMSG_FIRSTHDR (hdr); cmsg; cmsg = CMSG_NXTHDR (hdr, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      gint seg_size;
+
+      memcpy (&seg_size, CMSG_DATA (cmsg), sizeof (seg_size));
+      return seg_size > 0 ? seg_size : 0;
+    }
+  }
+
+  return 0;
+}
+#endif
+
+/* read as many packets as are available, up to batch-size, and queue them.
+ * Must only be called when the socket is readable. Returns GST_FLOW_OK
+ * without queueing anything when nothing could be read, and GST_FLOW_ERROR
+ * with @err set on receive errors */
+static GstFlowReturn
+gst_udpsrc_receive_batch (GstUDPSrc * src, GError ** err)
+{
+  GstUDPSrcBatch *batch;
+  GstClockTime timestamp;
+  GstFlowReturn ret;
+  guint i;
+
+  if ((ret = gst_udpsrc_prepare_batch (src)) != GST_FLOW_OK)
+    return ret;
+
+  batch = src->batch;
+
+#ifdef HAVE_RECVMMSG
+  {
+    gint fd, n;
+#ifdef HAVE_KERNEL_TIMESTAMPS
+    GstClockTime now_real;
+#endif
+
+    for (i = 0; i < src->n_batch; i++) {
+      batch->msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+#ifdef HAVE_CONTROL_MESSAGES
+      batch->msgs[i].msg_hdr.msg_controllen =
+          (src->kernel_timestamps || src->gro_active) ?
+          sizeof (batch->slots[i].control) : 0;
+#endif
+      batch->msgs[i].msg_hdr.msg_flags = 0;
+      batch->msgs[i].msg_len = 0;
+    }
+
+    fd = g_socket_get_fd (src->used_socket);
+    do {
+      n = recvmmsg (fd, batch->msgs, src->n_batch, MSG_DONTWAIT, NULL);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+      gint errsv = errno;
+
+      /* EHOSTUNREACH and ECONNREFUSED are how the ICMP "port unreachable"
+       * responses to packets we sent ourselves show up, ignore those like in
+       * the non-batched case */
+      if (errsv == EAGAIN || errsv == EWOULDBLOCK || errsv == EHOSTUNREACH
+          || errsv == ECONNREFUSED)
+        return GST_FLOW_OK;
+
+      g_set_error (err, G_IO_ERROR, g_io_error_from_errno (errsv),
+          "Error receiving messages: %s", g_strerror (errsv));
+      return GST_FLOW_ERROR;
+    }
+
+    GST_LOG_OBJECT (src, "recvmmsg returned %d packets", n);
+
+    timestamp = gst_udpsrc_get_running_time (src);
+#ifdef HAVE_KERNEL_TIMESTAMPS
+    now_real = g_get_real_time () * GST_USECOND;
+#endif
+
+    for (i = 0; i < (guint) n; i++) {
+      struct msghdr *hdr = &batch->msgs[i].msg_hdr;
+      GSocketAddress *saddr = NULL;
+      GstClockTime pkt_time = timestamp;
+      gsize seg_size = 0;
+
+      if (hdr->msg_namelen > 0)
+        saddr = g_socket_address_new_from_native (hdr->msg_name,
+            hdr->msg_namelen);
+
+#ifdef HAVE_KERNEL_TIMESTAMPS
+      if (src->kernel_timestamps)
+        pkt_time = gst_udpsrc_kernel_running_time (hdr, timestamp, now_real);
+#endif
+#ifdef HAVE_UDP_GRO
+      if (src->gro_active)
+        seg_size = gst_udpsrc_gro_segment_size (hdr);
+#endif
+
+      ret = gst_udpsrc_finish_slot (src, &batch->slots[i],
+          batch->msgs[i].msg_len, seg_size, saddr, pkt_time);
+
+      if (saddr)
+        g_object_unref (saddr);
+
+      if (ret != GST_FLOW_OK)
+        return ret;
+    }
+  }
+#else
+  timestamp = gst_udpsrc_get_running_time (src);
+
+  for (i = 0; i < src->n_batch; i++) {
+    GstUDPSrcSlot *slot = &batch->slots[i];
+    GInputVector vec[2];
+    GSocketAddress *saddr = NULL;
+    gssize res;
+
+    /* the caller waited for the first packet, for the others only read what
+     * is there already */
+    if (i > 0 && g_socket_get_available_bytes (src->used_socket) <= 0)
+      break;
+
+    vec[0].buffer = slot->map.data;
+    vec[0].size = slot->map.size;
+    vec[1].buffer = slot->extra;
+    vec[1].size = slot->extra_size;
+
+    res = g_socket_receive_message (src->used_socket, &saddr, vec,
+        slot->extra ? 2 : 1, NULL, NULL, NULL, src->cancellable, err);
+
+    if (G_UNLIKELY (res < 0)) {
+      if (g_error_matches (*err, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE)) {
+        g_clear_error (err);
+        break;
+      }
+      return GST_FLOW_ERROR;
+    }
+
+    ret = gst_udpsrc_finish_slot (src, slot, res, 0, saddr, timestamp);
+
+    if (saddr)
+      g_object_unref (saddr);
+
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+#endif
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_udpsrc_create (GstPushSrc * psrc, GstBuffer ** buf)
 {
@@ -401,6 +937,11 @@ gst_udpsrc_create (GstPushSrc * psrc, GstBuffer ** buf)
 
   udpsrc = GST_UDPSRC_CAST (psrc);
 
+  /* packets left over from the last batch are pushed without touching the
+   * socket */
+  if (!g_queue_is_empty (&udpsrc->pending))
+    goto have_pending;
+
 retry:
   /* quick check, avoid going in select when we already have data */
   readsize = g_socket_get_available_bytes (udpsrc->used_socket);
@@ -468,6 +1009,25 @@ retry:
 no_select:
   GST_LOG_OBJECT (udpsrc, "ioctl says %d bytes available", (int) readsize);
 
+  /* kernel timestamps and GRO segment sizes come as control messages, which
+   * only the batch code path can read */
+  if (udpsrc->batch_size > 1 || udpsrc->kernel_timestamps ||
+      udpsrc->gro_active) {
+    ret = gst_udpsrc_receive_batch (udpsrc, &err);
+    if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+      if (err == NULL)
+        return ret;
+      res = -1;
+      goto receive_error;
+    }
+
+    /* only port unreachable errors or empty packets, poll again */
+    if (g_queue_is_empty (&udpsrc->pending))
+      goto retry;
+
+    goto have_pending;
+  }
+
   /* sanity check value from _get_available_bytes(), which might be as
    * large as the kernel-side buffer on some operating systems */
   if (g_socket_get_family (udpsrc->used_socket) == G_SOCKET_FAMILY_IPV4)
@@ -478,6 +1038,13 @@ no_select:
   if (ret != GST_FLOW_OK)
     goto alloc_failed;
 
+  /* buffers from the pool are mtu sized, don't truncate bigger packets */
+  if (G_UNLIKELY (gst_buffer_get_size (outbuf) < (gsize) readsize)) {
+    GST_LOG_OBJECT (udpsrc, "packet bigger than pool buffers, allocating");
+    gst_buffer_unref (outbuf);
+    outbuf = gst_buffer_new_allocate (NULL, readsize, NULL);
+  }
+
   gst_buffer_map (outbuf, &info, GST_MAP_WRITE);
   offset = 0;
 
@@ -528,6 +1095,17 @@ no_select:
 
   return ret;
 
+have_pending:
+  {
+    *buf = g_queue_pop_head (&udpsrc->pending);
+
+    GST_LOG_OBJECT (udpsrc, "pushing queued packet of %" G_GSIZE_FORMAT
+        " bytes, %u left", gst_buffer_get_size (*buf),
+        g_queue_get_length (&udpsrc->pending));
+
+    return GST_FLOW_OK;
+  }
+
   /* ERRORS */
 select_error:
   {
@@ -582,6 +1160,69 @@ skip_error:
   }
 }
 
+static gboolean
+gst_udpsrc_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
+{
+  GstUDPSrc *src;
+  GstBufferPool *pool;
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstStructure *config;
+  guint size, min, max;
+  gboolean update;
+
+  src = GST_UDPSRC (bsrc);
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    update = TRUE;
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+    update = FALSE;
+  }
+
+  GST_DEBUG_OBJECT (src, "allocation: size:%u min:%u max:%u pool:%"
+      GST_PTR_FORMAT, size, min, max, pool);
+
+  /* other pools don't undo our trimming of the buffers when they are
+   * recycled, always use our own */
+  if (pool)
+    gst_object_unref (pool);
+  /* packets bigger than our buffers get extra memory appended */
+  pool = gst_trim_buffer_pool_new (TRUE);
+
+  size = MAX (size, src->mtu);
+  /* one buffer for every slot of a batch and one that is pushed */
+  min = MAX (min, src->batch_size + 1);
+  if (max != 0 && max < min)
+    max = min;
+
+  if (gst_query_get_n_allocation_params (query) > 0) {
+    gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+  } else {
+    allocator = NULL;
+    gst_allocation_params_init (&params);
+  }
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, min, max);
+  gst_buffer_pool_config_set_allocator (config, allocator, &params);
+  gst_buffer_pool_set_config (pool, config);
+
+  if (allocator)
+    gst_object_unref (allocator);
+
+  if (update)
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+
+  gst_object_unref (pool);
+
+  return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (bsrc, query);
+}
+
 static gboolean
 gst_udpsrc_set_uri (GstUDPSrc * src, const gchar * uri, GError ** error)
 {
@@ -709,6 +1350,18 @@ gst_udpsrc_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_REUSE:
       udpsrc->reuse = g_value_get_boolean (value);
       break;
+    case PROP_BATCH_SIZE:
+      udpsrc->batch_size = g_value_get_uint (value);
+      break;
+    case PROP_MTU:
+      udpsrc->mtu = g_value_get_uint (value);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      udpsrc->kernel_timestamps = g_value_get_boolean (value);
+      break;
+    case PROP_GRO:
+      udpsrc->gro = g_value_get_boolean (value);
+      break;
     default:
       break;
   }
@@ -761,6 +1414,18 @@ gst_udpsrc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_REUSE:
       g_value_set_boolean (value, udpsrc->reuse);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, udpsrc->batch_size);
+      break;
+    case PROP_MTU:
+      g_value_set_uint (value, udpsrc->mtu);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      g_value_set_boolean (value, udpsrc->kernel_timestamps);
+      break;
+    case PROP_GRO:
+      g_value_set_boolean (value, udpsrc->gro);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -960,6 +1625,38 @@ gst_udpsrc_start (GstBaseSrc * bsrc)
 
   g_socket_set_broadcast (src->used_socket, TRUE);
 
+  if (src->kernel_timestamps) {
+#ifdef HAVE_KERNEL_TIMESTAMPS
+    gint on = 1;
+
+    if (setsockopt (g_socket_get_fd (src->used_socket), SOL_SOCKET,
+            SO_TIMESTAMPNS, &on, sizeof (on)) < 0) {
+      GST_ELEMENT_WARNING (src, RESOURCE, SETTINGS, (NULL),
+          ("Could not enable kernel timestamps: %s", g_strerror (errno)));
+    }
+#else
+    GST_WARNING_OBJECT (src, "kernel timestamps are not supported on this "
+        "platform, using the time the packets were read");
+#endif
+  }
+
+  src->gro_active = FALSE;
+  if (src->gro) {
+#ifdef HAVE_UDP_GRO
+    gint on = 1;
+
+    if (setsockopt (g_socket_get_fd (src->used_socket), SOL_UDP, UDP_GRO,
+            &on, sizeof (on)) < 0) {
+      GST_INFO_OBJECT (src, "kernel does not support UDP GRO: %s",
+          g_strerror (errno));
+    } else {
+      src->gro_active = TRUE;
+    }
+#else
+    GST_WARNING_OBJECT (src, "UDP GRO is not supported on this platform");
+#endif
+  }
+
   if (src->auto_multicast
       &&
       g_inet_address_get_is_multicast (g_inet_socket_address_get_address
@@ -1058,6 +1755,8 @@ gst_udpsrc_unlock_stop (GstBaseSrc * bsrc)
   GST_LOG_OBJECT (src, "No longer flushing");
   g_cancellable_reset (src->cancellable);
 
+  gst_udpsrc_flush_pending (src);
+
   return TRUE;
 }
 
@@ -1070,6 +1769,9 @@ gst_udpsrc_stop (GstBaseSrc * bsrc)
 
   GST_DEBUG ("stopping, closing sockets");
 
+  gst_udpsrc_flush_pending (src);
+  gst_udpsrc_free_batch (src);
+
   if (src->used_socket) {
     if (src->auto_multicast
         &&
@@ -60,12 +60,23 @@ struct _GstUDPSrc {
   gboolean   close_socket;
   gboolean   auto_multicast;
   gboolean   reuse;
+  guint      batch_size;
+  guint      mtu;
+  gboolean   kernel_timestamps;
+  gboolean   gro;
 
   /* our sockets */
   GSocket   *used_socket;
   GCancellable *cancellable;
   GInetSocketAddress *addr;
   gboolean   external_socket;
+  gboolean   gro_active;
+
+  /* batched receive: packets read but not pushed yet, and the per-slot
+   * receive state that is kept around between wakeups */
+  GQueue     pending;
+  gpointer   batch;
+  guint      n_batch;
 
   gchar     *uri;
 };
@@ -3215,6 +3215,70 @@ gst_video_box_src_event (GstBaseTransform * trans, GstEvent * event)
   return GST_BASE_TRANSFORM_CLASS (parent_class)->src_event (trans, event);
 }
 
+/* Fill the rectangle at @x, @y of @frame. @x and @y have to be multiples of
+ * the chroma subsampling, which is at most 4 for the supported formats. */
+static void
+gst_video_box_fill_rect (GstVideoBox * video_box, GstVideoBoxFill fill_type,
+    guint b_alpha, GstVideoFrame * frame, gint x, gint y, gint w, gint h)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  GstVideoFrame rect;
+  guint plane, comp;
+  gboolean done[GST_VIDEO_MAX_PLANES] = { FALSE, };
+
+  if (w <= 0 || h <= 0)
+    return;
+
+  rect = *frame;
+  rect.info.width = w;
+  rect.info.height = h;
+
+  for (comp = 0; comp < GST_VIDEO_FRAME_N_COMPONENTS (frame); comp++) {
+    plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, comp);
+    if (done[plane])
+      continue;
+
+    rect.data[plane] = (guint8 *) frame->data[plane] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, comp, y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane) +
+        GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, comp, x) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (frame, comp);
+    done[plane] = TRUE;
+  }
+
+  video_box->fill (fill_type, b_alpha, &rect, video_box->out_sdtv);
+}
+
+/* Fill only the border around the frame that is copied to @dest_x, @dest_y
+ * instead of the whole output, so every output pixel is written once. The
+ * border rectangles are extended inwards to the subsampling alignment, the
+ * copy functions blend partial macro pixels with what is filled there and
+ * overwrite the rest. */
+static void
+gst_video_box_fill_border (GstVideoBox * video_box, GstVideoBoxFill fill_type,
+    guint b_alpha, GstVideoFrame * out, gint dest_x, gint dest_y, gint w,
+    gint h)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (out);
+  gint height = GST_VIDEO_FRAME_HEIGHT (out);
+  gint middle_top, middle_bottom, right;
+
+  middle_top = GST_ROUND_DOWN_4 (dest_y);
+  middle_bottom = (dest_y + h >= height) ? height :
+      GST_ROUND_DOWN_4 (dest_y + h);
+  right = (dest_x + w >= width) ? width : GST_ROUND_DOWN_4 (dest_x + w);
+
+  /* top, left, right and bottom */
+  gst_video_box_fill_rect (video_box, fill_type, b_alpha, out, 0, 0, width,
+      dest_y);
+  gst_video_box_fill_rect (video_box, fill_type, b_alpha, out, 0, middle_top,
+      dest_x, middle_bottom - middle_top);
+  gst_video_box_fill_rect (video_box, fill_type, b_alpha, out, right,
+      middle_top, width - right, middle_bottom - middle_top);
+  gst_video_box_fill_rect (video_box, fill_type, b_alpha, out, 0,
+      middle_bottom, width, height - middle_bottom);
+}
+
 static void
 gst_video_box_process (GstVideoBox * video_box, GstVideoFrame * in,
     GstVideoFrame * out)
@@ -3266,10 +3330,6 @@ gst_video_box_process (GstVideoBox * video_box, GstVideoFrame * in,
     gint src_x = 0, src_y = 0;
     gint dest_x = 0, dest_y = 0;
 
-    /* Fill everything if a border should be added somewhere */
-    if (bt < 0 || bb < 0 || br < 0 || bl < 0)
-      video_box->fill (fill_type, b_alpha, out, video_box->out_sdtv);
-
     /* Top border */
     if (bt < 0) {
       dest_y += -bt;
@@ -3284,6 +3344,11 @@ gst_video_box_process (GstVideoBox * video_box, GstVideoFrame * in,
       src_x += bl;
     }
 
+    /* Fill the border if one should be added somewhere */
+    if (bt < 0 || bb < 0 || br < 0 || bl < 0)
+      gst_video_box_fill_border (video_box, fill_type, b_alpha, out, dest_x,
+          dest_y, crop_w, crop_h);
+
     /* Frame */
     video_box->copy (i_alpha, out, video_box->out_sdtv, dest_x, dest_y,
         in, video_box->in_sdtv, src_x, src_y, crop_w, crop_h);
@@ -33,6 +33,12 @@
  *
  * If there is nothing to crop, the element will operate in pass-through mode.
  *
+ * If downstream supports #GstVideoMeta and #GstVideoCropMeta, the input
+ * buffers are pushed unmodified with a crop meta describing the region. If
+ * it only supports #GstVideoMeta and the crop offsets are aligned to the
+ * chroma subsampling, the plane offsets of the video meta are moved to the
+ * cropped region instead. Only otherwise the region is copied.
+ *
  * Note that no special efforts are made to handle chroma-subsampled formats
  * in the case of odd-valued cropping and compensate for sub-unit chroma plane
  * shifts for such formats in the case where the #GstVideoCrop:left or
@@ -113,6 +119,12 @@ static gboolean gst_video_crop_src_event (GstBaseTransform * trans,
 
 static gboolean gst_video_crop_set_info (GstVideoFilter * vfilter, GstCaps * in,
     GstVideoInfo * in_info, GstCaps * out, GstVideoInfo * out_info);
+static gboolean gst_video_crop_decide_allocation (GstBaseTransform * trans,
+    GstQuery * query);
+static gboolean gst_video_crop_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query);
+static GstFlowReturn gst_video_crop_transform_ip (GstBaseTransform * trans,
+    GstBuffer * buf);
 static GstFlowReturn gst_video_crop_transform_frame (GstVideoFilter * vfilter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame);
 
@@ -209,6 +221,12 @@ gst_video_crop_class_init (GstVideoCropClass * klass)
   basetransform_class->transform_caps =
       GST_DEBUG_FUNCPTR (gst_video_crop_transform_caps);
   basetransform_class->src_event = GST_DEBUG_FUNCPTR (gst_video_crop_src_event);
+  basetransform_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_crop_decide_allocation);
+  basetransform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_crop_propose_allocation);
+  basetransform_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_video_crop_transform_ip);
 
   vfilter_class->set_info = GST_DEBUG_FUNCPTR (gst_video_crop_set_info);
   vfilter_class->transform_frame =
@@ -222,6 +240,7 @@ gst_video_crop_init (GstVideoCrop * vcrop)
   vcrop->crop_left = 0;
   vcrop->crop_top = 0;
   vcrop->crop_bottom = 0;
+  vcrop->mode = VIDEO_CROP_MODE_COPY;
 
   g_mutex_init (&vcrop->lock);
 }
@@ -444,6 +463,141 @@ gst_video_crop_transform_frame (GstVideoFilter * vfilter,
   return GST_FLOW_OK;
 }
 
+/* Instead of copying, push the input buffer with metadata that describes the
+ * cropped region. The caps already have the cropped size, so downstream has
+ * to support GstVideoMeta to find the planes in the larger buffer. */
+static GstFlowReturn
+gst_video_crop_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstVideoCrop *vcrop = GST_VIDEO_CROP (trans);
+  GstVideoFilter *vfilter = GST_VIDEO_FILTER (trans);
+  GstVideoInfo *in_info = &vfilter->in_info;
+  GstVideoInfo *out_info = &vfilter->out_info;
+  GstVideoMeta *video_meta;
+
+  video_meta = gst_buffer_get_video_meta (buf);
+  if (!video_meta)
+    video_meta = gst_buffer_add_video_meta_full (buf, GST_VIDEO_FRAME_FLAG_NONE,
+        GST_VIDEO_INFO_FORMAT (in_info), GST_VIDEO_INFO_WIDTH (in_info),
+        GST_VIDEO_INFO_HEIGHT (in_info), GST_VIDEO_INFO_N_PLANES (in_info),
+        in_info->offset, in_info->stride);
+
+  g_mutex_lock (&vcrop->lock);
+  if (vcrop->mode == VIDEO_CROP_MODE_CROP_META) {
+    GstVideoCropMeta *crop_meta;
+
+    crop_meta = gst_buffer_get_video_crop_meta (buf);
+    if (!crop_meta)
+      crop_meta = gst_buffer_add_video_crop_meta (buf);
+
+    crop_meta->x += vcrop->crop_left;
+    crop_meta->y += vcrop->crop_top;
+    crop_meta->width = GST_VIDEO_INFO_WIDTH (out_info);
+    crop_meta->height = GST_VIDEO_INFO_HEIGHT (out_info);
+  } else {
+    const GstVideoFormatInfo *finfo = in_info->finfo;
+    gboolean done[GST_VIDEO_MAX_PLANES] = { FALSE, };
+    guint comp;
+
+    /* decide_allocation made sure that the offsets are on whole pixels of
+     * every component, so any component of a plane gives its offset */
+    for (comp = 0; comp < GST_VIDEO_INFO_N_COMPONENTS (in_info); comp++) {
+      guint plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, comp);
+
+      if (done[plane])
+        continue;
+
+      video_meta->offset[plane] +=
+          GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, comp,
+          vcrop->crop_top) * video_meta->stride[plane] +
+          GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, comp,
+          vcrop->crop_left) * GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, comp);
+      done[plane] = TRUE;
+    }
+    video_meta->width = GST_VIDEO_INFO_WIDTH (out_info);
+    video_meta->height = GST_VIDEO_INFO_HEIGHT (out_info);
+  }
+  g_mutex_unlock (&vcrop->lock);
+
+  return GST_FLOW_OK;
+}
+
+/* TRUE if the crop offsets are on whole pixels of every component, so that
+ * the planes of the cropped region can be described by offsets alone */
+static gboolean
+gst_video_crop_offsets_aligned (GstVideoCrop * vcrop, GstVideoInfo * info)
+{
+  const GstVideoFormatInfo *finfo = info->finfo;
+  guint comp;
+
+  /* packed 4:2:2 has the chroma shared between two pixels */
+  if (vcrop->packing == VIDEO_CROP_PIXEL_FORMAT_PACKED_COMPLEX &&
+      (vcrop->crop_left & 1))
+    return FALSE;
+
+  for (comp = 0; comp < GST_VIDEO_INFO_N_COMPONENTS (info); comp++) {
+    if (vcrop->crop_left & ((1 << GST_VIDEO_FORMAT_INFO_W_SUB (finfo,
+                    comp)) - 1))
+      return FALSE;
+    if (vcrop->crop_top & ((1 << GST_VIDEO_FORMAT_INFO_H_SUB (finfo,
+                    comp)) - 1))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_crop_decide_allocation (GstBaseTransform * trans, GstQuery * query)
+{
+  GstVideoCrop *vcrop = GST_VIDEO_CROP (trans);
+  GstVideoFilter *vfilter = GST_VIDEO_FILTER (trans);
+  gboolean video_meta, crop_meta;
+  VideoCropMode mode = VIDEO_CROP_MODE_COPY;
+
+  video_meta = gst_query_find_allocation_meta (query,
+      GST_VIDEO_META_API_TYPE, NULL);
+  crop_meta = gst_query_find_allocation_meta (query,
+      GST_VIDEO_CROP_META_API_TYPE, NULL);
+
+  g_mutex_lock (&vcrop->lock);
+  if ((vcrop->crop_left | vcrop->crop_right | vcrop->crop_top |
+          vcrop->crop_bottom) == 0) {
+    /* passthrough was already set up in set_info */
+  } else if (video_meta && crop_meta) {
+    GST_INFO_OBJECT (vcrop, "downstream supports crop meta, not copying");
+    mode = VIDEO_CROP_MODE_CROP_META;
+  } else if (video_meta && gst_video_crop_offsets_aligned (vcrop,
+          &vfilter->in_info)) {
+    GST_INFO_OBJECT (vcrop, "downstream supports video meta, cropping by "
+        "shifting the plane offsets");
+    mode = VIDEO_CROP_MODE_VIDEO_META;
+  } else {
+    GST_INFO_OBJECT (vcrop, "copying the cropped region");
+  }
+  vcrop->mode = mode;
+  g_mutex_unlock (&vcrop->lock);
+
+  if (!gst_base_transform_is_passthrough (trans))
+    gst_base_transform_set_in_place (trans, mode != VIDEO_CROP_MODE_COPY);
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->decide_allocation (trans,
+      query);
+}
+
+static gboolean
+gst_video_crop_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query)
+{
+  /* when not in passthrough the frames are mapped with their video meta, or
+   * the video meta is adjusted, so any layout upstream picks is fine */
+  if (decide_query)
+    gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->propose_allocation (trans,
+      decide_query, query);
+}
+
 static gint
 gst_video_crop_transform_dimension (gint val, gint delta)
 {
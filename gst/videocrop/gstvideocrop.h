@@ -42,6 +42,12 @@ typedef enum {
   VIDEO_CROP_PIXEL_FORMAT_SEMI_PLANAR         /* NV12, NV21 */
 } VideoCropPixelFormat;
 
+typedef enum {
+  VIDEO_CROP_MODE_COPY = 0,     /* copy the cropped region into a new buffer */
+  VIDEO_CROP_MODE_CROP_META,    /* push the input with a GstVideoCropMeta */
+  VIDEO_CROP_MODE_VIDEO_META    /* push the input with shifted plane offsets */
+} VideoCropMode;
+
 typedef struct _GstVideoCropImageDetails GstVideoCropImageDetails;
 
 typedef struct _GstVideoCrop GstVideoCrop;
@@ -65,6 +71,8 @@ struct _GstVideoCrop
   VideoCropPixelFormat  packing;
   gint macro_y_off;
 
+  VideoCropMode mode;
+
   GMutex lock;
 };
 
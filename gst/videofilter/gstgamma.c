@@ -76,7 +76,9 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ AYUV, "
             "ARGB, BGRA, ABGR, RGBA, Y444, "
             "xRGB, RGBx, xBGR, BGRx, RGB, BGR, Y42B, NV12, "
-            "NV21, YUY2, UYVY, YVYU, I420, YV12, IYUV, Y41B }"))
+            "NV21, YUY2, UYVY, YVYU, I420, YV12, IYUV, Y41B, "
+            "I420_10LE, I420_10BE, I422_10LE, I422_10BE, Y444_10LE, "
+            "Y444_10BE, AYUV64 }"))
     );
 
 static GstStaticPadTemplate gst_gamma_sink_template =
@@ -86,9 +88,12 @@ GST_STATIC_PAD_TEMPLATE ("sink",
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ AYUV, "
             "ARGB, BGRA, ABGR, RGBA, Y444, "
             "xRGB, RGBx, xBGR, BGRx, RGB, BGR, Y42B, NV12, "
-            "NV21, YUY2, UYVY, YVYU, I420, YV12, IYUV, Y41B }"))
+            "NV21, YUY2, UYVY, YVYU, I420, YV12, IYUV, Y41B, "
+            "I420_10LE, I420_10BE, I422_10LE, I422_10BE, Y444_10LE, "
+            "Y444_10BE, AYUV64 }"))
     );
 
+static void gst_gamma_finalize (GObject * object);
 static void gst_gamma_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_gamma_get_property (GObject * object, guint prop_id,
@@ -115,6 +120,7 @@ gst_gamma_class_init (GstGammaClass * g_class)
 
   GST_DEBUG_CATEGORY_INIT (gamma_debug, "gamma", 0, "gamma");
 
+  gobject_class->finalize = gst_gamma_finalize;
   gobject_class->set_property = gst_gamma_set_property;
   gobject_class->get_property = gst_gamma_get_property;
 
@@ -149,6 +155,16 @@ gst_gamma_init (GstGamma * gamma)
   gst_gamma_calculate_tables (gamma);
 }
 
+static void
+gst_gamma_finalize (GObject * object)
+{
+  GstGamma *gamma = GST_GAMMA (object);
+
+  g_free (gamma->gamma_table16);
+
+  G_OBJECT_CLASS (gst_gamma_parent_class)->finalize (object);
+}
+
 static void
 gst_gamma_set_property (GObject * object, guint prop_id, const GValue * value,
     GParamSpec * pspec)
@@ -192,7 +208,7 @@ gst_gamma_get_property (GObject * object, guint prop_id, GValue * value,
 static void
 gst_gamma_calculate_tables (GstGamma * gamma)
 {
-  gint n;
+  gint n, max;
   gdouble val;
   gdouble exp;
   gboolean passthrough = FALSE;
@@ -208,17 +224,79 @@ gst_gamma_calculate_tables (GstGamma * gamma)
       val = 255.0 * val;
       gamma->gamma_table[n] = (guint8) floor (val + 0.5);
     }
+
+    if (gamma->gamma_table16) {
+      max = (1 << gamma->gamma_table16_depth) - 1;
+      for (n = 0; n <= max; n++) {
+        val = n / (gdouble) max;
+        val = pow (val, exp);
+        val = max * val;
+        gamma->gamma_table16[n] = (guint16) floor (val + 0.5);
+      }
+    }
   }
   GST_OBJECT_UNLOCK (gamma);
 
   gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (gamma), passthrough);
 }
 
+/* looks up @n pixels @pstride bytes apart in @table. The table does not
+ * fit in vector registers, so instead of a shuffle the loop is unrolled to
+ * keep four independent loads in flight. */
+static inline void
+gst_gamma_apply_table (guint8 * data, gint pstride, gint n,
+    const guint8 * table)
+{
+  guint8 p0, p1, p2, p3;
+
+  for (; n >= 4; n -= 4) {
+    p0 = table[data[0]];
+    p1 = table[data[pstride]];
+    p2 = table[data[2 * pstride]];
+    p3 = table[data[3 * pstride]];
+    data[0] = p0;
+    data[pstride] = p1;
+    data[2 * pstride] = p2;
+    data[3 * pstride] = p3;
+    data += 4 * pstride;
+  }
+  for (; n > 0; n--) {
+    *data = table[*data];
+    data += pstride;
+  }
+}
+
+/* same for 16 bit samples, values beyond @max are clamped */
+static inline void
+gst_gamma_apply_table16 (guint8 * data, gint pstride, gint n,
+    const guint16 * table, guint max, gboolean swap)
+{
+  guint16 *p;
+  guint v;
+
+  if (swap) {
+    for (; n > 0; n--) {
+      p = (guint16 *) data;
+      v = MIN (GUINT16_SWAP_LE_BE (*p), max);
+      *p = GUINT16_SWAP_LE_BE (table[v]);
+      data += pstride;
+    }
+  } else {
+    for (; n > 0; n--) {
+      p = (guint16 *) data;
+      v = MIN (*p, max);
+      *p = table[v];
+      data += pstride;
+    }
+  }
+}
+
+/* only the luma is changed, the chroma is left where it is */
 static void
 gst_gamma_planar_yuv_ip (GstGamma * gamma, GstVideoFrame * frame)
 {
-  gint i, j, height;
-  gint width, stride, row_wrap;
+  gint i, height;
+  gint width, stride;
   const guint8 *table = gamma->gamma_table;
   guint8 *data;
 
@@ -226,22 +304,18 @@ gst_gamma_planar_yuv_ip (GstGamma * gamma, GstVideoFrame * frame)
   stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
   width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0);
   height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0);
-  row_wrap = stride - width;
 
   for (i = 0; i < height; i++) {
-    for (j = 0; j < width; j++) {
-      *data = table[*data];
-      data++;
-    }
-    data += row_wrap;
+    gst_gamma_apply_table (data, 1, width, table);
+    data += stride;
   }
 }
 
 static void
 gst_gamma_packed_yuv_ip (GstGamma * gamma, GstVideoFrame * frame)
 {
-  gint i, j, height;
-  gint width, stride, row_wrap;
+  gint i, height;
+  gint width, stride;
   gint pixel_stride;
   const guint8 *table = gamma->gamma_table;
   guint8 *data;
@@ -251,14 +325,34 @@ gst_gamma_packed_yuv_ip (GstGamma * gamma, GstVideoFrame * frame)
   width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0);
   height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0);
   pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
-  row_wrap = stride - pixel_stride * width;
 
   for (i = 0; i < height; i++) {
-    for (j = 0; j < width; j++) {
-      *data = table[*data];
-      data += pixel_stride;
-    }
-    data += row_wrap;
+    gst_gamma_apply_table (data, pixel_stride, width, table);
+    data += stride;
+  }
+}
+
+/* planar and packed YUV with more than 8 bits per luma sample */
+static void
+gst_gamma_yuv16_ip (GstGamma * gamma, GstVideoFrame * frame)
+{
+  gint i, height;
+  gint width, stride;
+  gint pixel_stride;
+  const guint16 *table = gamma->gamma_table16;
+  guint max = (1 << gamma->gamma_table16_depth) - 1;
+  gboolean swap = gamma->gamma_table16_swap;
+  guint8 *data;
+
+  data = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0);
+  height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0);
+  pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
+
+  for (i = 0; i < height; i++) {
+    gst_gamma_apply_table16 (data, pixel_stride, width, table, max, swap);
+    data += stride;
   }
 }
 
@@ -350,6 +444,15 @@ gst_gamma_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     case GST_VIDEO_FORMAT_YVYU:
       gamma->process = gst_gamma_packed_yuv_ip;
       break;
+    case GST_VIDEO_FORMAT_I420_10LE:
+    case GST_VIDEO_FORMAT_I420_10BE:
+    case GST_VIDEO_FORMAT_I422_10LE:
+    case GST_VIDEO_FORMAT_I422_10BE:
+    case GST_VIDEO_FORMAT_Y444_10LE:
+    case GST_VIDEO_FORMAT_Y444_10BE:
+    case GST_VIDEO_FORMAT_AYUV64:
+      gamma->process = gst_gamma_yuv16_ip;
+      break;
     case GST_VIDEO_FORMAT_ARGB:
     case GST_VIDEO_FORMAT_ABGR:
     case GST_VIDEO_FORMAT_RGBA:
@@ -366,6 +469,27 @@ gst_gamma_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
       goto invalid_caps;
       break;
   }
+
+  if (gamma->process == gst_gamma_yuv16_ip) {
+    const GstVideoFormatInfo *finfo = in_info->finfo;
+    gint depth = GST_VIDEO_FORMAT_INFO_DEPTH (finfo, 0);
+
+    GST_OBJECT_LOCK (gamma);
+    if (depth != gamma->gamma_table16_depth) {
+      gamma->gamma_table16 = g_renew (guint16, gamma->gamma_table16,
+          1 << depth);
+      gamma->gamma_table16_depth = depth;
+    }
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    gamma->gamma_table16_swap = !GST_VIDEO_FORMAT_INFO_IS_LE (finfo);
+#else
+    gamma->gamma_table16_swap = GST_VIDEO_FORMAT_INFO_IS_LE (finfo);
+#endif
+    GST_OBJECT_UNLOCK (gamma);
+
+    gst_gamma_calculate_tables (gamma);
+  }
+
   return TRUE;
 
   /* ERRORS */
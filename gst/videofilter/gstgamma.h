@@ -59,6 +59,11 @@ struct _GstGamma
 
   /* tables */
   guint8 gamma_table[256];
+  /* for the formats with more than 8 bits of luma, 1 << gamma_table16_depth
+   * entries */
+  guint16 *gamma_table16;
+  gint gamma_table16_depth;
+  gboolean gamma_table16_swap;
 
   void (*process) (GstGamma *gamma, GstVideoFrame *frame);
 };
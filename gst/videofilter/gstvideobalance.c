@@ -143,6 +143,28 @@ gst_video_balance_update_tables (GstVideoBalance * vb)
       vb->tablev[i + 128][j + 128] = rint (v);
     }
   }
+
+  /* without a hue change U only depends on U and V only on V, with the same
+   * mapping for both, so a single table per byte does */
+  for (i = 0; i < 256; i++)
+    vb->tablesat[i] = vb->tableu[i][128];
+
+  vb->luma_identity = vb->contrast == 1.0 && vb->brightness == 0.0;
+  vb->chroma_identity = vb->hue == 0.0 && vb->saturation == 1.0;
+  vb->chroma_separable = vb->hue == 0.0;
+}
+
+/* replace @n bytes @pstride apart through @lut */
+static inline void
+gst_video_balance_apply_lut (guint8 * data, gint pstride, gint n,
+    const guint8 * lut)
+{
+  gint x;
+
+  for (x = 0; x < n; x++) {
+    *data = lut[*data];
+    data += pstride;
+  }
 }
 
 static gboolean
@@ -188,16 +210,14 @@ gst_video_balance_planar_yuv (GstVideoBalance * videobalance,
   ydata = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
   ystride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
 
-  for (y = 0; y < height; y++) {
-    guint8 *yptr;
-
-    yptr = ydata + y * ystride;
-    for (x = 0; x < width; x++) {
-      *yptr = tabley[*yptr];
-      yptr++;
-    }
+  if (!videobalance->luma_identity) {
+    for (y = 0; y < height; y++)
+      gst_video_balance_apply_lut (ydata + y * ystride, 1, width, tabley);
   }
 
+  if (videobalance->chroma_identity)
+    return;
+
   width2 = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
   height2 = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1);
 
@@ -206,6 +226,16 @@ gst_video_balance_planar_yuv (GstVideoBalance * videobalance,
   ustride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 1);
   vstride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 2);
 
+  if (videobalance->chroma_separable) {
+    for (y = 0; y < height2; y++) {
+      gst_video_balance_apply_lut (udata + y * ustride, 1, width2,
+          videobalance->tablesat);
+      gst_video_balance_apply_lut (vdata + y * vstride, 1, width2,
+          videobalance->tablesat);
+    }
+    return;
+  }
+
   for (y = 0; y < height2; y++) {
     guint8 *uptr, *vptr;
     guint8 u1, v1;
@@ -244,22 +274,28 @@ gst_video_balance_semiplanar_yuv (GstVideoBalance * videobalance,
   ydata = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
   ystride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
 
-  for (y = 0; y < height; y++) {
-    guint8 *yptr;
-
-    yptr = ydata + y * ystride;
-    for (x = 0; x < width; x++) {
-      *yptr = tabley[*yptr];
-      yptr++;
-    }
+  if (!videobalance->luma_identity) {
+    for (y = 0; y < height; y++)
+      gst_video_balance_apply_lut (ydata + y * ystride, 1, width, tabley);
   }
 
+  if (videobalance->chroma_identity)
+    return;
+
   width2 = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
   height2 = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1);
 
   uvdata = GST_VIDEO_FRAME_PLANE_DATA (frame, 1);
   uvstride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 1);
 
+  /* U and V use the same table, the interleaved line is a single run */
+  if (videobalance->chroma_separable) {
+    for (y = 0; y < height2; y++)
+      gst_video_balance_apply_lut (uvdata + y * uvstride, 1, width2 * 2,
+          videobalance->tablesat);
+    return;
+  }
+
   upos = GST_VIDEO_INFO_FORMAT (&frame->info) == GST_VIDEO_FORMAT_NV12 ? 0 : 1;
   vpos = GST_VIDEO_INFO_FORMAT (&frame->info) == GST_VIDEO_FORMAT_NV12 ? 1 : 0;
 
@@ -300,16 +336,14 @@ gst_video_balance_packed_yuv (GstVideoBalance * videobalance,
   ydata = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
   yoff = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
 
-  for (y = 0; y < height; y++) {
-    guint8 *yptr;
-
-    yptr = ydata + y * stride;
-    for (x = 0; x < width; x++) {
-      *yptr = tabley[*yptr];
-      yptr += yoff;
-    }
+  if (!videobalance->luma_identity) {
+    for (y = 0; y < height; y++)
+      gst_video_balance_apply_lut (ydata + y * stride, yoff, width, tabley);
   }
 
+  if (videobalance->chroma_identity)
+    return;
+
   width2 = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
   height2 = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1);
 
@@ -318,6 +352,16 @@ gst_video_balance_packed_yuv (GstVideoBalance * videobalance,
   uoff = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 1);
   voff = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 2);
 
+  if (videobalance->chroma_separable) {
+    for (y = 0; y < height2; y++) {
+      gst_video_balance_apply_lut (udata + y * stride, uoff, width2,
+          videobalance->tablesat);
+      gst_video_balance_apply_lut (vdata + y * stride, voff, width2,
+          videobalance->tablesat);
+    }
+    return;
+  }
+
   for (y = 0; y < height2; y++) {
     guint8 *uptr, *vptr;
     guint8 u1, v1;
@@ -64,6 +64,12 @@ struct _GstVideoBalance {
   guint8 tabley[256];
   guint8 *tableu[256];
   guint8 *tablev[256];
+  guint8 tablesat[256];
+
+  /* fast paths for the tables, see gst_video_balance_update_tables() */
+  gboolean luma_identity;
+  gboolean chroma_identity;
+  gboolean chroma_separable;
 
   void (*process) (GstVideoBalance *balance, GstVideoFrame *frame);
 };
@@ -0,0 +1,1018 @@
+
+/* autogenerated from gstvideofilterorc.orc */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <glib.h>
+
+#ifndef _ORC_INTEGER_TYPEDEFS_
+#define _ORC_INTEGER_TYPEDEFS_
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#include <stdint.h>
+typedef int8_t orc_int8;
+typedef int16_t orc_int16;
+typedef int32_t orc_int32;
+typedef int64_t orc_int64;
+typedef uint8_t orc_uint8;
+typedef uint16_t orc_uint16;
+typedef uint32_t orc_uint32;
+typedef uint64_t orc_uint64;
+#define ORC_UINT64_C(x) UINT64_C(x)
+#elif defined(_MSC_VER)
+typedef signed __int8 orc_int8;
+typedef signed __int16 orc_int16;
+typedef signed __int32 orc_int32;
+typedef signed __int64 orc_int64;
+typedef unsigned __int8 orc_uint8;
+typedef unsigned __int16 orc_uint16;
+typedef unsigned __int32 orc_uint32;
+typedef unsigned __int64 orc_uint64;
+#define ORC_UINT64_C(x) (x##Ui64)
+#define inline __inline
+#else
+#include <limits.h>
+typedef signed char orc_int8;
+typedef short orc_int16;
+typedef int orc_int32;
+typedef unsigned char orc_uint8;
+typedef unsigned short orc_uint16;
+typedef unsigned int orc_uint32;
+#if INT_MAX == LONG_MAX
+typedef long long orc_int64;
+typedef unsigned long long orc_uint64;
+#define ORC_UINT64_C(x) (x##ULL)
+#else
+typedef long orc_int64;
+typedef unsigned long orc_uint64;
+#define ORC_UINT64_C(x) (x##UL)
+#endif
+#endif
+typedef union
+{
+  orc_int16 i;
+  orc_int8 x2[2];
+} orc_union16;
+typedef union
+{
+  orc_int32 i;
+  float f;
+  orc_int16 x2[2];
+  orc_int8 x4[4];
+} orc_union32;
+typedef union
+{
+  orc_int64 i;
+  double f;
+  orc_int32 x2[2];
+  float x2f[2];
+  orc_int16 x4[4];
+} orc_union64;
+#endif
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+
+#ifndef ORC_INTERNAL
+#if defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x550)
+#define ORC_INTERNAL __hidden
+#elif defined (__GNUC__)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define ORC_INTERNAL
+#endif
+#endif
+
+
+#ifndef DISABLE_ORC
+#include <orc/orc.h>
+#endif
+void video_median_orc_median5 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n);
+void video_median_orc_sort3 (guint8 * ORC_RESTRICT d1,
+    guint8 * ORC_RESTRICT d2, guint8 * ORC_RESTRICT d3,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, int n);
+void video_median_orc_max3_med3 (guint8 * ORC_RESTRICT d1,
+    guint8 * ORC_RESTRICT d2, const guint8 * ORC_RESTRICT s1,
+    const guint8 * ORC_RESTRICT s2, const guint8 * ORC_RESTRICT s3,
+    const guint8 * ORC_RESTRICT s4, const guint8 * ORC_RESTRICT s5,
+    const guint8 * ORC_RESTRICT s6, int n);
+void video_median_orc_med3_min3 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n);
+
+
+/* begin Orc C target preamble */
+#define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
+#define ORC_ABS(a) ((a)<0 ? -(a) : (a))
+#define ORC_MIN(a,b) ((a)<(b) ? (a) : (b))
+#define ORC_MAX(a,b) ((a)>(b) ? (a) : (b))
+#define ORC_SB_MAX 127
+#define ORC_SB_MIN (-1-ORC_SB_MAX)
+#define ORC_UB_MAX 255
+#define ORC_UB_MIN 0
+#define ORC_SW_MAX 32767
+#define ORC_SW_MIN (-1-ORC_SW_MAX)
+#define ORC_UW_MAX 65535
+#define ORC_UW_MIN 0
+#define ORC_SL_MAX 2147483647
+#define ORC_SL_MIN (-1-ORC_SL_MAX)
+#define ORC_UL_MAX 4294967295U
+#define ORC_UL_MIN 0
+#define ORC_CLAMP_SB(x) ORC_CLAMP(x,ORC_SB_MIN,ORC_SB_MAX)
+#define ORC_CLAMP_UB(x) ORC_CLAMP(x,ORC_UB_MIN,ORC_UB_MAX)
+#define ORC_CLAMP_SW(x) ORC_CLAMP(x,ORC_SW_MIN,ORC_SW_MAX)
+#define ORC_CLAMP_UW(x) ORC_CLAMP(x,ORC_UW_MIN,ORC_UW_MAX)
+#define ORC_CLAMP_SL(x) ORC_CLAMP(x,ORC_SL_MIN,ORC_SL_MAX)
+#define ORC_CLAMP_UL(x) ORC_CLAMP(x,ORC_UL_MIN,ORC_UL_MAX)
+#define ORC_SWAP_W(x) ((((x)&0xff)<<8) | (((x)&0xff00)>>8))
+#define ORC_SWAP_L(x) ((((x)&0xff)<<24) | (((x)&0xff00)<<8) | (((x)&0xff0000)>>8) | (((x)&0xff000000)>>24))
+#define ORC_SWAP_Q(x) ((((x)&ORC_UINT64_C(0xff))<<56) | (((x)&ORC_UINT64_C(0xff00))<<40) | (((x)&ORC_UINT64_C(0xff0000))<<24) | (((x)&ORC_UINT64_C(0xff000000))<<8) | (((x)&ORC_UINT64_C(0xff00000000))>>8) | (((x)&ORC_UINT64_C(0xff0000000000))>>24) | (((x)&ORC_UINT64_C(0xff000000000000))>>40) | (((x)&ORC_UINT64_C(0xff00000000000000))>>56))
+#define ORC_PTR_OFFSET(ptr,offset) ((void *)(((unsigned char *)(ptr)) + (offset)))
+#define ORC_DENORMAL(x) ((x) & ((((x)&0x7f800000) == 0) ? 0xff800000 : 0xffffffff))
+#define ORC_ISNAN(x) ((((x)&0x7f800000) == 0x7f800000) && (((x)&0x007fffff) != 0))
+#define ORC_DENORMAL_DOUBLE(x) ((x) & ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == 0) ? ORC_UINT64_C(0xfff0000000000000) : ORC_UINT64_C(0xffffffffffffffff)))
+#define ORC_ISNAN_DOUBLE(x) ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == ORC_UINT64_C(0x7ff0000000000000)) && (((x)&ORC_UINT64_C(0x000fffffffffffff)) != 0))
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+/* end Orc C target preamble */
+
+/* video_median_orc_median5 */
+#ifdef DISABLE_ORC
+void
+video_median_orc_median5 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: minub */
+    var38 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 6: maxub */
+    var39 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 7: minub */
+    var40 = ORC_MIN ((orc_uint8) var35, (orc_uint8) var36);
+    /* 8: maxub */
+    var41 = ORC_MAX ((orc_uint8) var35, (orc_uint8) var36);
+    /* 9: maxub */
+    var42 = ORC_MAX ((orc_uint8) var38, (orc_uint8) var40);
+    /* 10: minub */
+    var43 = ORC_MIN ((orc_uint8) var39, (orc_uint8) var41);
+    /* 11: minub */
+    var44 = ORC_MIN ((orc_uint8) var43, (orc_uint8) var34);
+    /* 12: maxub */
+    var45 = ORC_MAX ((orc_uint8) var43, (orc_uint8) var34);
+    /* 13: minub */
+    var46 = ORC_MIN ((orc_uint8) var45, (orc_uint8) var42);
+    /* 14: maxub */
+    var37 = ORC_MAX ((orc_uint8) var44, (orc_uint8) var46);
+    /* 15: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_video_median_orc_median5 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+  orc_int8 var44;
+  orc_int8 var45;
+  orc_int8 var46;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: minub */
+    var38 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 6: maxub */
+    var39 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 7: minub */
+    var40 = ORC_MIN ((orc_uint8) var35, (orc_uint8) var36);
+    /* 8: maxub */
+    var41 = ORC_MAX ((orc_uint8) var35, (orc_uint8) var36);
+    /* 9: maxub */
+    var42 = ORC_MAX ((orc_uint8) var38, (orc_uint8) var40);
+    /* 10: minub */
+    var43 = ORC_MIN ((orc_uint8) var39, (orc_uint8) var41);
+    /* 11: minub */
+    var44 = ORC_MIN ((orc_uint8) var43, (orc_uint8) var34);
+    /* 12: maxub */
+    var45 = ORC_MAX ((orc_uint8) var43, (orc_uint8) var34);
+    /* 13: minub */
+    var46 = ORC_MIN ((orc_uint8) var45, (orc_uint8) var42);
+    /* 14: maxub */
+    var37 = ORC_MAX ((orc_uint8) var44, (orc_uint8) var46);
+    /* 15: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+video_median_orc_median5 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 24, 118, 105, 100, 101, 111, 95, 109, 101, 100, 105, 97, 110, 95,
+        111, 114, 99, 95, 109, 101, 100, 105, 97, 110, 53, 11, 1, 1, 12, 1,
+        1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 20, 1, 20,
+        1, 20, 1, 20, 1, 20, 1, 20, 1, 20, 1, 20, 1, 20, 1, 55,
+        32, 4, 5, 53, 33, 4, 5, 55, 34, 7, 8, 53, 35, 7, 8, 53,
+        36, 32, 34, 55, 37, 33, 35, 55, 38, 37, 6, 53, 39, 37, 6, 55,
+        40, 39, 36, 53, 0, 38, 40, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_video_median_orc_median5);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_median_orc_median5");
+      orc_program_set_backup_function (p, _backup_video_median_orc_median5);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+      orc_program_add_temporary (p, 1, "t3");
+      orc_program_add_temporary (p, 1, "t4");
+      orc_program_add_temporary (p, 1, "t5");
+      orc_program_add_temporary (p, 1, "t6");
+      orc_program_add_temporary (p, 1, "t7");
+      orc_program_add_temporary (p, 1, "t8");
+      orc_program_add_temporary (p, 1, "t9");
+
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T4, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T5, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T6, ORC_VAR_T2, ORC_VAR_T4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T7, ORC_VAR_T6, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T8, ORC_VAR_T6, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T9, ORC_VAR_T8, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_D1, ORC_VAR_T7, ORC_VAR_T9,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* video_median_orc_sort3 */
+#ifdef DISABLE_ORC
+void
+video_median_orc_sort3 (guint8 * ORC_RESTRICT d1, guint8 * ORC_RESTRICT d2,
+    guint8 * ORC_RESTRICT d3, const guint8 * ORC_RESTRICT s1,
+    const guint8 * ORC_RESTRICT s2, const guint8 * ORC_RESTRICT s3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 *ORC_RESTRICT ptr1;
+  orc_int8 *ORC_RESTRICT ptr2;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr1 = (orc_int8 *) d2;
+  ptr2 = (orc_int8 *) d3;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: minub */
+    var38 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 4: maxub */
+    var39 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 5: minub */
+    var35 = ORC_MIN ((orc_uint8) var38, (orc_uint8) var34);
+    /* 6: maxub */
+    var40 = ORC_MAX ((orc_uint8) var38, (orc_uint8) var34);
+    /* 7: minub */
+    var36 = ORC_MIN ((orc_uint8) var39, (orc_uint8) var40);
+    /* 8: maxub */
+    var37 = ORC_MAX ((orc_uint8) var39, (orc_uint8) var40);
+    /* 9: storeb */
+    ptr0[i] = var35;
+    /* 10: storeb */
+    ptr1[i] = var36;
+    /* 11: storeb */
+    ptr2[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_video_median_orc_sort3 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 *ORC_RESTRICT ptr1;
+  orc_int8 *ORC_RESTRICT ptr2;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr1 = (orc_int8 *) ex->arrays[1];
+  ptr2 = (orc_int8 *) ex->arrays[2];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: minub */
+    var38 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 4: maxub */
+    var39 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 5: minub */
+    var35 = ORC_MIN ((orc_uint8) var38, (orc_uint8) var34);
+    /* 6: maxub */
+    var40 = ORC_MAX ((orc_uint8) var38, (orc_uint8) var34);
+    /* 7: minub */
+    var36 = ORC_MIN ((orc_uint8) var39, (orc_uint8) var40);
+    /* 8: maxub */
+    var37 = ORC_MAX ((orc_uint8) var39, (orc_uint8) var40);
+    /* 9: storeb */
+    ptr0[i] = var35;
+    /* 10: storeb */
+    ptr1[i] = var36;
+    /* 11: storeb */
+    ptr2[i] = var37;
+  }
+
+}
+
+void
+video_median_orc_sort3 (guint8 * ORC_RESTRICT d1, guint8 * ORC_RESTRICT d2,
+    guint8 * ORC_RESTRICT d3, const guint8 * ORC_RESTRICT s1,
+    const guint8 * ORC_RESTRICT s2, const guint8 * ORC_RESTRICT s3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 22, 118, 105, 100, 101, 111, 95, 109, 101, 100, 105, 97, 110, 95,
+        111, 114, 99, 95, 115, 111, 114, 116, 51, 11, 1, 1, 11, 1, 1, 11,
+        1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 20, 1, 20, 1, 20,
+        1, 55, 32, 4, 5, 53, 33, 4, 5, 55, 0, 32, 6, 53, 34, 32,
+        6, 55, 1, 33, 34, 53, 2, 33, 34, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_video_median_orc_sort3);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_median_orc_sort3");
+      orc_program_set_backup_function (p, _backup_video_median_orc_sort3);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_destination (p, 1, "d2");
+      orc_program_add_destination (p, 1, "d3");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+      orc_program_add_temporary (p, 1, "t3");
+
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T3, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_D2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_D3, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->arrays[ORC_VAR_D3] = d3;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* video_median_orc_max3_med3 */
+#ifdef DISABLE_ORC
+void
+video_median_orc_max3_med3 (guint8 * ORC_RESTRICT d1, guint8 * ORC_RESTRICT d2,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 *ORC_RESTRICT ptr1;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr1 = (orc_int8 *) d2;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+  ptr9 = (orc_int8 *) s6;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: maxub */
+    var40 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 7: maxub */
+    var38 = ORC_MAX ((orc_uint8) var40, (orc_uint8) var34);
+    /* 8: minub */
+    var41 = ORC_MIN ((orc_uint8) var35, (orc_uint8) var36);
+    /* 9: maxub */
+    var42 = ORC_MAX ((orc_uint8) var35, (orc_uint8) var36);
+    /* 10: minub */
+    var43 = ORC_MIN ((orc_uint8) var42, (orc_uint8) var37);
+    /* 11: maxub */
+    var39 = ORC_MAX ((orc_uint8) var41, (orc_uint8) var43);
+    /* 12: storeb */
+    ptr0[i] = var38;
+    /* 13: storeb */
+    ptr1[i] = var39;
+  }
+
+}
+
+#else
+static void
+_backup_video_median_orc_max3_med3 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  orc_int8 *ORC_RESTRICT ptr1;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  const orc_int8 *ORC_RESTRICT ptr9;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+  orc_int8 var43;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr1 = (orc_int8 *) ex->arrays[1];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+  ptr9 = (orc_int8 *) ex->arrays[9];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: loadb */
+    var37 = ptr9[i];
+    /* 6: maxub */
+    var40 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 7: maxub */
+    var38 = ORC_MAX ((orc_uint8) var40, (orc_uint8) var34);
+    /* 8: minub */
+    var41 = ORC_MIN ((orc_uint8) var35, (orc_uint8) var36);
+    /* 9: maxub */
+    var42 = ORC_MAX ((orc_uint8) var35, (orc_uint8) var36);
+    /* 10: minub */
+    var43 = ORC_MIN ((orc_uint8) var42, (orc_uint8) var37);
+    /* 11: maxub */
+    var39 = ORC_MAX ((orc_uint8) var41, (orc_uint8) var43);
+    /* 12: storeb */
+    ptr0[i] = var38;
+    /* 13: storeb */
+    ptr1[i] = var39;
+  }
+
+}
+
+void
+video_median_orc_max3_med3 (guint8 * ORC_RESTRICT d1, guint8 * ORC_RESTRICT d2,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 26, 118, 105, 100, 101, 111, 95, 109, 101, 100, 105, 97, 110, 95,
+        111, 114, 99, 95, 109, 97, 120, 51, 95, 109, 101, 100, 51, 11, 1, 1,
+        11, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12,
+        1, 1, 12, 1, 1, 20, 1, 20, 1, 20, 1, 20, 1, 53, 32, 4,
+        5, 53, 0, 32, 6, 55, 33, 7, 8, 53, 34, 7, 8, 55, 35, 34,
+        9, 53, 1, 33, 35, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_video_median_orc_max3_med3);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_median_orc_max3_med3");
+      orc_program_set_backup_function (p, _backup_video_median_orc_max3_med3);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_destination (p, 1, "d2");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_source (p, 1, "s6");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+      orc_program_add_temporary (p, 1, "t3");
+      orc_program_add_temporary (p, 1, "t4");
+
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T2, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T4, ORC_VAR_T3, ORC_VAR_S6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_D2, ORC_VAR_T2, ORC_VAR_T4,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+/* video_median_orc_med3_min3 */
+#ifdef DISABLE_ORC
+void
+video_median_orc_med3_min3 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: minub */
+    var38 = ORC_MIN ((orc_uint8) var34, (orc_uint8) var35);
+    /* 6: minub */
+    var39 = ORC_MIN ((orc_uint8) var38, (orc_uint8) var36);
+    /* 7: minub */
+    var40 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 8: maxub */
+    var41 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 9: minub */
+    var42 = ORC_MIN ((orc_uint8) var41, (orc_uint8) var39);
+    /* 10: maxub */
+    var37 = ORC_MAX ((orc_uint8) var40, (orc_uint8) var42);
+    /* 11: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_video_median_orc_med3_min3 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var32;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_int8 var38;
+  orc_int8 var39;
+  orc_int8 var40;
+  orc_int8 var41;
+  orc_int8 var42;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var32 = ptr4[i];
+    /* 1: loadb */
+    var33 = ptr5[i];
+    /* 2: loadb */
+    var34 = ptr6[i];
+    /* 3: loadb */
+    var35 = ptr7[i];
+    /* 4: loadb */
+    var36 = ptr8[i];
+    /* 5: minub */
+    var38 = ORC_MIN ((orc_uint8) var34, (orc_uint8) var35);
+    /* 6: minub */
+    var39 = ORC_MIN ((orc_uint8) var38, (orc_uint8) var36);
+    /* 7: minub */
+    var40 = ORC_MIN ((orc_uint8) var32, (orc_uint8) var33);
+    /* 8: maxub */
+    var41 = ORC_MAX ((orc_uint8) var32, (orc_uint8) var33);
+    /* 9: minub */
+    var42 = ORC_MIN ((orc_uint8) var41, (orc_uint8) var39);
+    /* 10: maxub */
+    var37 = ORC_MAX ((orc_uint8) var40, (orc_uint8) var42);
+    /* 11: storeb */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+video_median_orc_med3_min3 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
+    const guint8 * ORC_RESTRICT s5, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 26, 118, 105, 100, 101, 111, 95, 109, 101, 100, 105, 97, 110, 95,
+        111, 114, 99, 95, 109, 101, 100, 51, 95, 109, 105, 110, 51, 11, 1, 1,
+        12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 12, 1, 1, 20,
+        1, 20, 1, 20, 1, 20, 1, 20, 1, 55, 32, 6, 7, 55, 33, 32,
+        8, 55, 34, 4, 5, 53, 35, 4, 5, 55, 36, 35, 33, 53, 0, 34,
+        36, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_video_median_orc_med3_min3);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_median_orc_med3_min3");
+      orc_program_set_backup_function (p, _backup_video_median_orc_med3_min3);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+      orc_program_add_temporary (p, 1, "t3");
+      orc_program_add_temporary (p, 1, "t4");
+      orc_program_add_temporary (p, 1, "t5");
+
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T1, ORC_VAR_S3, ORC_VAR_S4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T3, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_T4, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "minub", 0, ORC_VAR_T5, ORC_VAR_T4, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "maxub", 0, ORC_VAR_D1, ORC_VAR_T3, ORC_VAR_T5,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
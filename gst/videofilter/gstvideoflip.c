@@ -54,11 +54,13 @@
 enum
 {
   PROP_0,
-  PROP_METHOD
+  PROP_METHOD,
+  PROP_N_THREADS
       /* FILL ME */
 };
 
 #define PROP_METHOD_DEFAULT GST_VIDEO_FLIP_METHOD_IDENTITY
+#define PROP_N_THREADS_DEFAULT 1
 
 GST_DEBUG_CATEGORY_STATIC (video_flip_debug);
 #define GST_CAT_DEFAULT video_flip_debug
@@ -184,445 +186,115 @@ gst_video_flip_transform_caps (GstBaseTransform * trans,
   return ret;
 }
 
-static void
-gst_video_flip_planar_yuv (GstVideoFlip * videoflip, GstVideoFrame * dest,
-    const GstVideoFrame * src)
-{
-  gint x, y;
-  guint8 const *s;
-  guint8 *d;
-  gint src_y_stride, src_u_stride, src_v_stride;
-  gint src_y_height, src_u_height, src_v_height;
-  gint src_y_width, src_u_width, src_v_width;
-  gint dest_y_stride, dest_u_stride, dest_v_stride;
-  gint dest_y_height, dest_u_height, dest_v_height;
-  gint dest_y_width, dest_u_width, dest_v_width;
-
-  src_y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 0);
-  src_u_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 1);
-  src_v_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 2);
-
-  dest_y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 0);
-  dest_u_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 1);
-  dest_v_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 2);
-
-  src_y_width = GST_VIDEO_FRAME_COMP_WIDTH (src, 0);
-  src_u_width = GST_VIDEO_FRAME_COMP_WIDTH (src, 1);
-  src_v_width = GST_VIDEO_FRAME_COMP_WIDTH (src, 2);
-
-  dest_y_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, 0);
-  dest_u_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, 1);
-  dest_v_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, 2);
+/* rotations read the source column-wise, copying in tiles of this many
+ * pixels in each direction keeps the source lines of a tile in the cache */
+#define TILE_SIZE 16
+
+/* copies pixels of @pstride bytes to lines @y_start to @y_end of @d, the
+ * source of destination pixel (x, y) is at s + x * x_step + y * y_step */
+#define DEFINE_FLIP_TILED(pstride) \
+static void \
+gst_video_flip_tiled_##pstride (guint8 * d, gint d_stride, gint width, \
+    gint y_start, gint y_end, const guint8 * s, gint x_step, gint y_step) \
+{ \
+  gint x, y, bx, by, bw, bh; \
+  guint8 *dp; \
+  const guint8 *sp; \
+  \
+  for (by = y_start; by < y_end; by += TILE_SIZE) { \
+    bh = MIN (TILE_SIZE, y_end - by); \
+    for (bx = 0; bx < width; bx += TILE_SIZE) { \
+      bw = MIN (TILE_SIZE, width - bx); \
+      for (y = by; y < by + bh; y++) { \
+        dp = d + y * d_stride + bx * pstride; \
+        sp = s + bx * x_step + y * y_step; \
+        for (x = 0; x < bw; x++) { \
+          memcpy (dp, sp, pstride); \
+          dp += pstride; \
+          sp += x_step; \
+        } \
+      } \
+    } \
+  } \
+}
 
-  src_y_height = GST_VIDEO_FRAME_COMP_HEIGHT (src, 0);
-  src_u_height = GST_VIDEO_FRAME_COMP_HEIGHT (src, 1);
-  src_v_height = GST_VIDEO_FRAME_COMP_HEIGHT (src, 2);
+DEFINE_FLIP_TILED (1);
+DEFINE_FLIP_TILED (2);
+DEFINE_FLIP_TILED (3);
+DEFINE_FLIP_TILED (4);
 
-  dest_y_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, 0);
-  dest_u_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, 1);
-  dest_v_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, 2);
+static void
+gst_video_flip_plane (GstVideoFlipMethod method, guint8 * d, gint d_stride,
+    gint d_width, gint y_start, gint y_end, const guint8 * s, gint s_stride,
+    gint s_width, gint s_height, gint pstride)
+{
+  gint x_step, y_step;
+  gint y;
 
-  switch (videoflip->active_method) {
+  switch (method) {
     case GST_VIDEO_FLIP_METHOD_90R:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - x) * src_y_stride + y];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[(src_u_height - 1 - x) * src_u_stride + y];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[(src_v_height - 1 - x) * src_v_stride + y];
-        }
-      }
+      s += (s_height - 1) * s_stride;
+      x_step = -s_stride;
+      y_step = pstride;
       break;
     case GST_VIDEO_FLIP_METHOD_90L:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[x * src_y_stride + (src_y_width - 1 - y)];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[x * src_u_stride + (src_u_width - 1 - y)];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[x * src_v_stride + (src_v_width - 1 - y)];
-        }
-      }
+      s += (s_width - 1) * pstride;
+      x_step = s_stride;
+      y_step = -pstride;
       break;
     case GST_VIDEO_FLIP_METHOD_180:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - y) * src_y_stride + (src_y_width - 1 - x)];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[(src_u_height - 1 - y) * src_u_stride + (src_u_width - 1 - x)];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[(src_v_height - 1 - y) * src_v_stride + (src_v_width - 1 - x)];
-        }
-      }
+      s += (s_height - 1) * s_stride + (s_width - 1) * pstride;
+      x_step = -pstride;
+      y_step = -s_stride;
       break;
     case GST_VIDEO_FLIP_METHOD_HORIZ:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[y * src_y_stride + (src_y_width - 1 - x)];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[y * src_u_stride + (src_u_width - 1 - x)];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[y * src_v_stride + (src_v_width - 1 - x)];
-        }
-      }
+      s += (s_width - 1) * pstride;
+      x_step = -pstride;
+      y_step = s_stride;
       break;
     case GST_VIDEO_FLIP_METHOD_VERT:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - y) * src_y_stride + x];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[(src_u_height - 1 - y) * src_u_stride + x];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[(src_v_height - 1 - y) * src_v_stride + x];
-        }
-      }
+      s += (s_height - 1) * s_stride;
+      x_step = pstride;
+      y_step = -s_stride;
       break;
     case GST_VIDEO_FLIP_METHOD_TRANS:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] = s[x * src_y_stride + y];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] = s[x * src_u_stride + y];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_v_stride + x] = s[x * src_v_stride + y];
-        }
-      }
+      x_step = s_stride;
+      y_step = pstride;
       break;
     case GST_VIDEO_FLIP_METHOD_OTHER:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - x) * src_y_stride + (src_y_width - 1 - y)];
-        }
-      }
-      /* Flip U */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_u_height; y++) {
-        for (x = 0; x < dest_u_width; x++) {
-          d[y * dest_u_stride + x] =
-              s[(src_u_height - 1 - x) * src_u_stride + (src_u_width - 1 - y)];
-        }
-      }
-      /* Flip V */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 2);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 2);
-      for (y = 0; y < dest_v_height; y++) {
-        for (x = 0; x < dest_v_width; x++) {
-          d[y * dest_v_stride + x] =
-              s[(src_v_height - 1 - x) * src_v_stride + (src_v_width - 1 - y)];
-        }
-      }
+      s += (s_height - 1) * s_stride + (s_width - 1) * pstride;
+      x_step = -s_stride;
+      y_step = -pstride;
       break;
     case GST_VIDEO_FLIP_METHOD_IDENTITY:
-      g_assert_not_reached ();
-      break;
     default:
       g_assert_not_reached ();
-      break;
+      return;
   }
-}
 
-static void
-gst_video_flip_semi_planar_yuv (GstVideoFlip * videoflip, GstVideoFrame * dest,
-    const GstVideoFrame * src)
-{
-  gint x, y;
-  guint8 const *s;
-  guint8 *d;
-  gint s_off, d_off;
-  gint src_y_stride, src_uv_stride;
-  gint src_y_height, src_uv_height;
-  gint src_y_width, src_uv_width;
-  gint dest_y_stride, dest_uv_stride;
-  gint dest_y_height, dest_uv_height;
-  gint dest_y_width, dest_uv_width;
-
-
-  src_y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 0);
-  src_uv_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 1);
-
-  dest_y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 0);
-  dest_uv_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 1);
-
-  src_y_width = GST_VIDEO_FRAME_COMP_WIDTH (src, 0);
-  src_uv_width = GST_VIDEO_FRAME_COMP_WIDTH (src, 1);
-
-  dest_y_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, 0);
-  dest_uv_width = GST_VIDEO_FRAME_COMP_WIDTH (dest, 1);
-
-  src_y_height = GST_VIDEO_FRAME_COMP_HEIGHT (src, 0);
-  src_uv_height = GST_VIDEO_FRAME_COMP_HEIGHT (src, 1);
-
-  dest_y_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, 0);
-  dest_uv_height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, 1);
+  /* the source lines are not reversed, just copy them */
+  if (x_step == pstride) {
+    for (y = y_start; y < y_end; y++)
+      memcpy (d + y * d_stride, s + y * y_step, d_width * pstride);
+    return;
+  }
 
-  switch (videoflip->active_method) {
-    case GST_VIDEO_FLIP_METHOD_90R:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - x) * src_y_stride + y];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = (src_uv_height - 1 - x) * src_uv_stride + y * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
+  switch (pstride) {
+    case 1:
+      gst_video_flip_tiled_1 (d, d_stride, d_width, y_start, y_end, s,
+          x_step, y_step);
       break;
-    case GST_VIDEO_FLIP_METHOD_90L:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[x * src_y_stride + (src_y_width - 1 - y)];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = x * src_uv_stride + (src_uv_width - 1 - y) * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
+    case 2:
+      gst_video_flip_tiled_2 (d, d_stride, d_width, y_start, y_end, s,
+          x_step, y_step);
       break;
-    case GST_VIDEO_FLIP_METHOD_180:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - y) * src_y_stride + (src_y_width - 1 - x)];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = (src_uv_height - 1 - y) * src_uv_stride + (src_uv_width - 1 -
-              x) * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
+    case 3:
+      gst_video_flip_tiled_3 (d, d_stride, d_width, y_start, y_end, s,
+          x_step, y_step);
       break;
-    case GST_VIDEO_FLIP_METHOD_HORIZ:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[y * src_y_stride + (src_y_width - 1 - x)];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = y * src_uv_stride + (src_uv_width - 1 - x) * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_VERT:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - y) * src_y_stride + x];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = (src_uv_height - 1 - y) * src_uv_stride + x * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_TRANS:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] = s[x * src_y_stride + y];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = x * src_uv_stride + y * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
-    case GST_VIDEO_FLIP_METHOD_OTHER:
-      /* Flip Y */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-      for (y = 0; y < dest_y_height; y++) {
-        for (x = 0; x < dest_y_width; x++) {
-          d[y * dest_y_stride + x] =
-              s[(src_y_height - 1 - x) * src_y_stride + (src_y_width - 1 - y)];
-        }
-      }
-      /* Flip UV */
-      s = GST_VIDEO_FRAME_PLANE_DATA (src, 1);
-      d = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
-      for (y = 0; y < dest_uv_height; y++) {
-        for (x = 0; x < dest_uv_width; x++) {
-          d_off = y * dest_uv_stride + x * 2;
-          s_off = (src_uv_height - 1 - x) * src_uv_stride + (src_uv_width - 1 -
-              y) * 2;
-          d[d_off] = s[s_off];
-          d[d_off + 1] = s[s_off + 1];
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_IDENTITY:
-      g_assert_not_reached ();
+    case 4:
+      gst_video_flip_tiled_4 (d, d_stride, d_width, y_start, y_end, s,
+          x_step, y_step);
       break;
     default:
       g_assert_not_reached ();
@@ -630,111 +302,40 @@ gst_video_flip_semi_planar_yuv (GstVideoFlip * videoflip, GstVideoFrame * dest,
   }
 }
 
+/* formats without subsampling inside a plane, the pixels of every plane are
+ * moved as a whole */
 static void
-gst_video_flip_packed_simple (GstVideoFlip * videoflip, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+gst_video_flip_planes (GstVideoFlip * videoflip, GstVideoFrame * dest,
+    const GstVideoFrame * src, guint slice, guint n_slices)
 {
-  gint x, y, z;
-  guint8 const *s;
-  guint8 *d;
-  gint sw = GST_VIDEO_FRAME_WIDTH (src);
-  gint sh = GST_VIDEO_FRAME_HEIGHT (src);
-  gint dw = GST_VIDEO_FRAME_WIDTH (dest);
-  gint dh = GST_VIDEO_FRAME_HEIGHT (dest);
-  gint src_stride, dest_stride;
-  gint bpp;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
-
-  src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, 0);
-  dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, 0);
-  /* This is only true for non-subsampled formats! */
-  bpp = GST_VIDEO_FRAME_COMP_PSTRIDE (src, 0);
-
-  switch (videoflip->active_method) {
-    case GST_VIDEO_FLIP_METHOD_90R:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[(sh - 1 - x) * src_stride + y * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_90L:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[x * src_stride + (sw - 1 - y) * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_180:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[(sh - 1 - y) * src_stride + (sw - 1 - x) * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_HORIZ:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[y * src_stride + (sw - 1 - x) * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_VERT:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[(sh - 1 - y) * src_stride + x * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_TRANS:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] = s[x * src_stride + y * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_OTHER:
-      for (y = 0; y < dh; y++) {
-        for (x = 0; x < dw; x++) {
-          for (z = 0; z < bpp; z++) {
-            d[y * dest_stride + x * bpp + z] =
-                s[(sh - 1 - x) * src_stride + (sw - 1 - y) * bpp + z];
-          }
-        }
-      }
-      break;
-    case GST_VIDEO_FLIP_METHOD_IDENTITY:
-      g_assert_not_reached ();
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
+  guint done = 0;
+  gint comp, plane, height;
+
+  for (comp = 0; comp < GST_VIDEO_FRAME_N_COMPONENTS (dest); comp++) {
+    plane = GST_VIDEO_FRAME_COMP_PLANE (dest, comp);
+    /* the chroma of NV12 and all components of packed formats share a
+     * plane, its pixel stride covers all of them */
+    if (done & (1 << plane))
+      continue;
+    done |= 1 << plane;
+
+    height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, comp);
+    gst_video_flip_plane (videoflip->active_method,
+        GST_VIDEO_FRAME_PLANE_DATA (dest, plane),
+        GST_VIDEO_FRAME_PLANE_STRIDE (dest, plane),
+        GST_VIDEO_FRAME_COMP_WIDTH (dest, comp),
+        height * slice / n_slices, height * (slice + 1) / n_slices,
+        GST_VIDEO_FRAME_PLANE_DATA (src, plane),
+        GST_VIDEO_FRAME_PLANE_STRIDE (src, plane),
+        GST_VIDEO_FRAME_COMP_WIDTH (src, comp),
+        GST_VIDEO_FRAME_COMP_HEIGHT (src, comp),
+        GST_VIDEO_FRAME_COMP_PSTRIDE (src, comp));
   }
 }
 
-
 static void
 gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, guint slice, guint n_slices)
 {
   gint x, y;
   guint8 const *s;
@@ -749,6 +350,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
   gint u_offset;
   gint v_offset;
   gint y_stride;
+  gint y_start, y_end;
 
   s = GST_VIDEO_FRAME_PLANE_DATA (src, 0);
   d = GST_VIDEO_FRAME_PLANE_DATA (dest, 0);
@@ -762,9 +364,12 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
   y_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (src, 0);
   bpp = y_stride;
 
+  y_start = dh * slice / n_slices;
+  y_end = dh * (slice + 1) / n_slices;
+
   switch (videoflip->active_method) {
     case GST_VIDEO_FLIP_METHOD_90R:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -791,7 +396,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_90L:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -816,7 +421,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_180:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -840,7 +445,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_HORIZ:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -863,7 +468,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_VERT:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -886,7 +491,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_TRANS:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -911,7 +516,7 @@ gst_video_flip_y422 (GstVideoFlip * videoflip, GstVideoFrame * dest,
       }
       break;
     case GST_VIDEO_FLIP_METHOD_OTHER:
-      for (y = 0; y < dh; y++) {
+      for (y = y_start; y < y_end; y++) {
         for (x = 0; x < dw; x += 2) {
           guint8 u;
           guint8 v;
@@ -996,11 +601,6 @@ gst_video_flip_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   ret = TRUE;
 
   switch (GST_VIDEO_INFO_FORMAT (in_info)) {
-    case GST_VIDEO_FORMAT_I420:
-    case GST_VIDEO_FORMAT_YV12:
-    case GST_VIDEO_FORMAT_Y444:
-      vf->process = gst_video_flip_planar_yuv;
-      break;
     case GST_VIDEO_FORMAT_YUY2:
     case GST_VIDEO_FORMAT_UYVY:
     case GST_VIDEO_FORMAT_YVYU:
@@ -1020,11 +620,12 @@ gst_video_flip_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     case GST_VIDEO_FORMAT_GRAY8:
     case GST_VIDEO_FORMAT_GRAY16_BE:
     case GST_VIDEO_FORMAT_GRAY16_LE:
-      vf->process = gst_video_flip_packed_simple;
-      break;
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_Y444:
     case GST_VIDEO_FORMAT_NV12:
     case GST_VIDEO_FORMAT_NV21:
-      vf->process = gst_video_flip_semi_planar_yuv;
+      vf->process = gst_video_flip_planes;
       break;
     default:
       break;
@@ -1093,6 +694,22 @@ gst_video_flip_before_transform (GstBaseTransform * trans, GstBuffer * in)
     gst_object_sync_values (GST_OBJECT (videoflip), stream_time);
 }
 
+typedef struct
+{
+  GstVideoFlip *videoflip;
+  GstVideoFrame *dest;
+  const GstVideoFrame *src;
+} GstVideoFlipProcessData;
+
+static void
+gst_video_flip_process_slice (gpointer user_data, guint slice, guint n_slices)
+{
+  GstVideoFlipProcessData *data = user_data;
+
+  data->videoflip->process (data->videoflip, data->dest, data->src, slice,
+      n_slices);
+}
+
 static GstFlowReturn
 gst_video_flip_transform_frame (GstVideoFilter * vfilter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
@@ -1106,7 +723,17 @@ gst_video_flip_transform_frame (GstVideoFilter * vfilter,
       video_flip_methods[videoflip->active_method].value_nick);
 
   GST_OBJECT_LOCK (videoflip);
-  videoflip->process (videoflip, out_frame, in_frame);
+  gst_workers_ensure (&videoflip->workers, videoflip->n_threads);
+  if (videoflip->workers) {
+    GstVideoFlipProcessData data;
+
+    data.videoflip = videoflip;
+    data.dest = out_frame;
+    data.src = in_frame;
+    gst_workers_run (videoflip->workers, gst_video_flip_process_slice, &data);
+  } else {
+    videoflip->process (videoflip, out_frame, in_frame, 0, 1);
+  }
   GST_OBJECT_UNLOCK (videoflip);
 
   return GST_FLOW_OK;
@@ -1240,6 +867,12 @@ gst_video_flip_set_property (GObject * object, guint prop_id,
     case PROP_METHOD:
       gst_video_flip_set_method (videoflip, g_value_get_enum (value), FALSE);
       break;
+    case PROP_N_THREADS:
+      /* takes effect with the next frame */
+      GST_OBJECT_LOCK (videoflip);
+      videoflip->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (videoflip);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1256,12 +889,28 @@ gst_video_flip_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_METHOD:
       g_value_set_enum (value, videoflip->method);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (videoflip);
+      g_value_set_uint (value, videoflip->n_threads);
+      GST_OBJECT_UNLOCK (videoflip);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_video_flip_finalize (GObject * object)
+{
+  GstVideoFlip *videoflip = GST_VIDEO_FLIP (object);
+
+  if (videoflip->workers)
+    gst_workers_free (videoflip->workers);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_video_flip_class_init (GstVideoFlipClass * klass)
 {
@@ -1274,6 +923,7 @@ gst_video_flip_class_init (GstVideoFlipClass * klass)
 
   gobject_class->set_property = gst_video_flip_set_property;
   gobject_class->get_property = gst_video_flip_get_property;
+  gobject_class->finalize = gst_video_flip_finalize;
 
   g_object_class_install_property (gobject_class, PROP_METHOD,
       g_param_spec_enum ("method", "method", "method",
@@ -1281,6 +931,20 @@ gst_video_flip_class_init (GstVideoFlipClass * klass)
           GST_PARAM_CONTROLLABLE | G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVideoFlip:n-threads:
+   *
+   * The number of threads that flip a frame. Every thread writes a
+   * horizontal stripe of the output, so the output does not depend on this
+   * setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to flip a frame", 1, 64,
+          PROP_N_THREADS_DEFAULT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class, "Video flipper",
       "Filter/Effect/Video",
       "Flips and rotates video", "David Schleef <ds@schleef.org>");
@@ -1308,4 +972,5 @@ gst_video_flip_init (GstVideoFlip * videoflip)
   /* AUTO is not valid for active method, this is just to ensure we setup the
    * method in gst_video_flip_set_method() */
   videoflip->active_method = GST_VIDEO_FLIP_METHOD_AUTO;
+  videoflip->n_threads = PROP_N_THREADS_DEFAULT;
 }
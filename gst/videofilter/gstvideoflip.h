@@ -24,6 +24,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 /**
@@ -78,7 +80,11 @@ struct _GstVideoFlip {
   GstVideoFlipMethod method;
   GstVideoFlipMethod tag_method;
   GstVideoFlipMethod active_method;
-  void (*process) (GstVideoFlip *videoflip, GstVideoFrame *dest, const GstVideoFrame *src);
+  void (*process) (GstVideoFlip *videoflip, GstVideoFrame *dest,
+      const GstVideoFrame *src, guint slice, guint n_slices);
+
+  guint n_threads;
+  GstWorkers *workers;
 };
 
 struct _GstVideoFlipClass {
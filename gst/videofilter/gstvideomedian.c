@@ -22,6 +22,7 @@
 #endif
 #include <string.h>
 #include "gstvideomedian.h"
+#include "gstvideofilterorc.h"
 
 static GstStaticPadTemplate video_median_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
@@ -47,11 +48,13 @@ enum
 
 #define DEFAULT_FILTERSIZE   5
 #define DEFAULT_LUM_ONLY     TRUE
+#define DEFAULT_N_THREADS    1
 enum
 {
   PROP_0,
   PROP_FILTERSIZE,
-  PROP_LUM_ONLY
+  PROP_LUM_ONLY,
+  PROP_N_THREADS
 };
 
 #define GST_TYPE_VIDEO_MEDIAN_SIZE (gst_video_median_size_get_type())
@@ -84,6 +87,7 @@ static void gst_video_median_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_video_median_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_video_median_finalize (GObject * object);
 
 static void
 gst_video_median_class_init (GstVideoMedianClass * klass)
@@ -98,6 +102,7 @@ gst_video_median_class_init (GstVideoMedianClass * klass)
 
   gobject_class->set_property = gst_video_median_set_property;
   gobject_class->get_property = gst_video_median_get_property;
+  gobject_class->finalize = gst_video_median_finalize;
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_FILTERSIZE,
       g_param_spec_enum ("filtersize", "Filtersize", "The size of the filter",
@@ -109,6 +114,20 @@ gst_video_median_class_init (GstVideoMedianClass * klass)
           "luminance", DEFAULT_LUM_ONLY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVideoMedian:n-threads:
+   *
+   * The number of threads that filter a frame. Every thread handles a
+   * horizontal stripe of each plane, so the output does not depend on this
+   * setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to filter a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&video_median_sink_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -127,100 +146,126 @@ gst_video_median_init (GstVideoMedian * median)
 {
   median->filtersize = DEFAULT_FILTERSIZE;
   median->lum_only = DEFAULT_LUM_ONLY;
+  median->n_threads = DEFAULT_N_THREADS;
 }
 
-#define PIX_SORT(a,b) { if ((a)>(b)) PIX_SWAP((a),(b)); }
-#define PIX_SWAP(a,b) { unsigned char temp=(a);(a)=(b);(b)=temp; }
+static void
+gst_video_median_finalize (GObject * object)
+{
+  GstVideoMedian *median = GST_VIDEO_MEDIAN (object);
+
+  if (median->workers)
+    gst_workers_free (median->workers);
 
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/* lines @y_start to @y_end of a plane, the outer lines and columns are
+ * copied */
 static void
 median_5 (guint8 * dest, gint dstride, const guint8 * src, gint sstride,
-    gint width, gint height)
+    gint width, gint height, gint y_start, gint y_end)
 {
-  unsigned char p[5];
-  int i, j, k;
+  guint8 *d;
+  const guint8 *s;
+  gint y;
 
-  /* copy the top and bottom rows into the result array */
-  for (i = 0; i < width; i++) {
-    dest[i] = src[i];
-    dest[(height - 1) * dstride + i] = src[(height - 1) * sstride + i];
-  }
+  for (y = y_start; y < y_end; y++) {
+    d = dest + y * dstride;
+    s = src + y * sstride;
 
-  /* process the interior pixels */
-  for (k = 2; k < height; k++) {
-    dest += dstride;
-    src += sstride;
-
-    dest[0] = src[0];
-    for (j = 2, i = 1; j < width; j++, i++) {
-      p[0] = src[i - sstride];
-      p[1] = src[i - 1];
-      p[2] = src[i];
-      p[3] = src[i + 1];
-      p[4] = src[i + sstride];
-      PIX_SORT (p[0], p[1]);
-      PIX_SORT (p[3], p[4]);
-      PIX_SORT (p[0], p[3]);
-      PIX_SORT (p[1], p[4]);
-      PIX_SORT (p[1], p[2]);
-      PIX_SORT (p[2], p[3]);
-      PIX_SORT (p[1], p[2]);
-      dest[i] = p[2];
+    if (y == 0 || y == height - 1 || width < 3) {
+      memcpy (d, s, width);
+      continue;
     }
-    dest[i] = src[i];
+
+    d[0] = s[0];
+    video_median_orc_median5 (d + 1, s + 1 - sstride, s, s + 1, s + 2,
+        s + 1 + sstride, width - 2);
+    d[width - 1] = s[width - 1];
   }
 }
 
+/* the 3x3 median is the median of the largest column minimum, the median of
+ * the column medians and the smallest column maximum. @tmp holds 5 lines of
+ * @width bytes for the sorted columns and the partial results. */
 static void
 median_9 (guint8 * dest, gint dstride, const guint8 * src, gint sstride,
-    gint width, gint height)
+    gint width, gint height, gint y_start, gint y_end, guint8 * tmp)
 {
-  unsigned char p[9];
-  int i, j, k;
+  guint8 *lo = tmp, *mid = tmp + width, *hi = tmp + 2 * width;
+  guint8 *max_lo = tmp + 3 * width, *med_mid = tmp + 4 * width;
+  guint8 *d;
+  const guint8 *s;
+  gint y;
+
+  for (y = y_start; y < y_end; y++) {
+    d = dest + y * dstride;
+    s = src + y * sstride;
+
+    if (y == 0 || y == height - 1 || width < 3) {
+      memcpy (d, s, width);
+      continue;
+    }
+
+    video_median_orc_sort3 (lo, mid, hi, s - sstride, s, s + sstride, width);
+    video_median_orc_max3_med3 (max_lo, med_mid, lo, lo + 1, lo + 2, mid,
+        mid + 1, mid + 2, width - 2);
 
-  /*copy the top and bottom rows into the result array */
-  for (i = 0; i < width; i++) {
-    dest[i] = src[i];
-    dest[(height - 1) * dstride + i] = src[(height - 1) * sstride + i];
+    d[0] = s[0];
+    video_median_orc_med3_min3 (d + 1, max_lo, med_mid, hi, hi + 1, hi + 2,
+        width - 2);
+    d[width - 1] = s[width - 1];
   }
-  /* process the interior pixels */
-  for (k = 2; k < height; k++) {
-    dest += dstride;
-    src += sstride;
-
-    dest[0] = src[0];
-    for (j = 2, i = 1; j < width; j++, i++) {
-      p[0] = src[i - sstride - 1];
-      p[1] = src[i - sstride];
-      p[2] = src[i - sstride + 1];
-      p[3] = src[i - 1];
-      p[4] = src[i];
-      p[5] = src[i + 1];
-      p[6] = src[i + sstride - 1];
-      p[7] = src[i + sstride];
-      p[8] = src[i + sstride + 1];
-      PIX_SORT (p[1], p[2]);
-      PIX_SORT (p[4], p[5]);
-      PIX_SORT (p[7], p[8]);
-      PIX_SORT (p[0], p[1]);
-      PIX_SORT (p[3], p[4]);
-      PIX_SORT (p[6], p[7]);
-      PIX_SORT (p[1], p[2]);
-      PIX_SORT (p[4], p[5]);
-      PIX_SORT (p[7], p[8]);
-      PIX_SORT (p[0], p[3]);
-      PIX_SORT (p[5], p[8]);
-      PIX_SORT (p[4], p[7]);
-      PIX_SORT (p[3], p[6]);
-      PIX_SORT (p[1], p[4]);
-      PIX_SORT (p[2], p[5]);
-      PIX_SORT (p[4], p[7]);
-      PIX_SORT (p[4], p[2]);
-      PIX_SORT (p[6], p[4]);
-      PIX_SORT (p[4], p[2]);
-      dest[i] = p[4];
+}
+
+typedef struct
+{
+  GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+  GstVideoMedianSize filtersize;
+  gboolean lum_only;
+} GstVideoMedianProcessData;
+
+static void
+gst_video_median_process_slice (gpointer user_data, guint slice,
+    guint n_slices)
+{
+  GstVideoMedianProcessData *data = user_data;
+  GstVideoFrame *in_frame = data->in_frame;
+  GstVideoFrame *out_frame = data->out_frame;
+  guint8 *tmp = NULL;
+  guint8 *dest;
+  const guint8 *src;
+  gint dstride, sstride;
+  gint plane, width, height, y_start, y_end, y;
+
+  if (data->filtersize == GST_VIDEO_MEDIAN_SIZE_9)
+    tmp = g_malloc (5 * GST_VIDEO_FRAME_WIDTH (in_frame));
+
+  for (plane = 0; plane < 3; plane++) {
+    dest = GST_VIDEO_FRAME_PLANE_DATA (out_frame, plane);
+    dstride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, plane);
+    src = GST_VIDEO_FRAME_PLANE_DATA (in_frame, plane);
+    sstride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, plane);
+    /* both chroma planes have the same size */
+    width = GST_VIDEO_FRAME_COMP_WIDTH (in_frame, plane);
+    height = GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, plane);
+    y_start = height * slice / n_slices;
+    y_end = height * (slice + 1) / n_slices;
+
+    if (plane > 0 && data->lum_only) {
+      for (y = y_start; y < y_end; y++)
+        memcpy (dest + y * dstride, src + y * sstride, width);
+    } else if (data->filtersize == GST_VIDEO_MEDIAN_SIZE_5) {
+      median_5 (dest, dstride, src, sstride, width, height, y_start, y_end);
+    } else {
+      median_9 (dest, dstride, src, sstride, width, height, y_start, y_end,
+          tmp);
     }
-    dest[i] = src[i];
   }
+
+  g_free (tmp);
 }
 
 static GstFlowReturn
@@ -228,56 +273,20 @@ gst_video_median_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstVideoMedian *median = GST_VIDEO_MEDIAN (filter);
+  GstVideoMedianProcessData data;
 
-  if (median->filtersize == 5) {
-    median_5 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0),
-        GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0),
-        GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0),
-        GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-        GST_VIDEO_FRAME_WIDTH (in_frame), GST_VIDEO_FRAME_HEIGHT (in_frame));
+  data.in_frame = in_frame;
+  data.out_frame = out_frame;
+  data.filtersize = median->filtersize;
+  data.lum_only = median->lum_only;
 
-    if (median->lum_only) {
-      gst_video_frame_copy_plane (out_frame, in_frame, 1);
-      gst_video_frame_copy_plane (out_frame, in_frame, 2);
-    } else {
-      median_5 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 1),
-          GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 1),
-          GST_VIDEO_FRAME_PLANE_DATA (in_frame, 1),
-          GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 1),
-          GST_VIDEO_FRAME_WIDTH (in_frame) / 2,
-          GST_VIDEO_FRAME_HEIGHT (in_frame) / 2);
-      median_5 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 2),
-          GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 2),
-          GST_VIDEO_FRAME_PLANE_DATA (in_frame, 2),
-          GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 2),
-          GST_VIDEO_FRAME_WIDTH (in_frame) / 2,
-          GST_VIDEO_FRAME_HEIGHT (in_frame) / 2);
-    }
-  } else {
-    median_9 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0),
-        GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0),
-        GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0),
-        GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-        GST_VIDEO_FRAME_WIDTH (in_frame), GST_VIDEO_FRAME_HEIGHT (in_frame));
-
-    if (median->lum_only) {
-      gst_video_frame_copy_plane (out_frame, in_frame, 1);
-      gst_video_frame_copy_plane (out_frame, in_frame, 2);
-    } else {
-      median_9 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 1),
-          GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 1),
-          GST_VIDEO_FRAME_PLANE_DATA (in_frame, 1),
-          GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 1),
-          GST_VIDEO_FRAME_WIDTH (in_frame) / 2,
-          GST_VIDEO_FRAME_HEIGHT (in_frame) / 2);
-      median_9 (GST_VIDEO_FRAME_PLANE_DATA (out_frame, 2),
-          GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 2),
-          GST_VIDEO_FRAME_PLANE_DATA (in_frame, 2),
-          GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 2),
-          GST_VIDEO_FRAME_WIDTH (in_frame) / 2,
-          GST_VIDEO_FRAME_HEIGHT (in_frame) / 2);
-    }
-  }
+  GST_OBJECT_LOCK (median);
+  gst_workers_ensure (&median->workers, median->n_threads);
+  if (median->workers)
+    gst_workers_run (median->workers, gst_video_median_process_slice, &data);
+  else
+    gst_video_median_process_slice (&data, 0, 1);
+  GST_OBJECT_UNLOCK (median);
 
   return GST_FLOW_OK;
 }
@@ -297,6 +306,12 @@ gst_video_median_set_property (GObject * object, guint prop_id,
     case PROP_LUM_ONLY:
       median->lum_only = g_value_get_boolean (value);
       break;
+    case PROP_N_THREADS:
+      /* takes effect with the next frame */
+      GST_OBJECT_LOCK (median);
+      median->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (median);
+      break;
     default:
       break;
   }
@@ -317,6 +332,11 @@ gst_video_median_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LUM_ONLY:
       g_value_set_boolean (value, median->lum_only);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (median);
+      g_value_set_uint (value, median->n_threads);
+      GST_OBJECT_UNLOCK (median);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -26,6 +26,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include <gst/workers/gstworkers.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_VIDEO_MEDIAN \
@@ -53,6 +55,9 @@ struct _GstVideoMedian {
 
   GstVideoMedianSize filtersize;
   gboolean lum_only;
+
+  guint n_threads;
+  GstWorkers *workers;
 };
 
 struct _GstVideoMedianClass {
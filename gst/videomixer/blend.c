@@ -38,6 +38,35 @@
 GST_DEBUG_CATEGORY_STATIC (gst_videomixer_blend_debug);
 #define GST_CAT_DEFAULT gst_videomixer_blend_debug
 
+/* The checker pattern repeats every 16 lines and only has two different
+ * lines, 0 and 8. Once those are painted the rest of the plane is copied from
+ * them line by line. */
+static void
+_fill_checker_lines (guint8 * dest, gint stride, gint row_bytes, gint height)
+{
+  gint i;
+
+  for (i = 0; i < height; i += 8) {
+    const guint8 *src = dest + (i & 8) * stride;
+    gint first = (i < 16) ? i + 1 : i;
+    gint lines = MIN (i + 8, height) - first;
+
+    if (lines > 0)
+      video_mixer_orc_memcpy_2d (dest + first * stride, stride, src, 0,
+          row_bytes, lines);
+  }
+}
+
+/* copy the first line of a plane over all the others */
+static void
+_fill_from_first_line (guint8 * dest, gint stride, gint row_bytes,
+    gint height)
+{
+  if (height > 1)
+    video_mixer_orc_memcpy_2d (dest + stride, stride, dest, 0, row_bytes,
+        height - 1);
+}
+
 /* Below are the implementations of everything */
 
 /* A32 is for AYUV, ARGB and BGRA */
@@ -118,47 +147,38 @@ BLEND_A32 (argb, overlay, _overlay_loop_bgra);
 BLEND_A32 (bgra, overlay, _overlay_loop_argb);
 #endif
 
-#define A32_CHECKER_C(name, RGB, A, C1, C2, C3) \
+#define A32_CHECKER(name, RGB, A, C1, C2, C3) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name (GstVideoFrame * frame) \
 { \
   gint i, j; \
   gint val; \
   static const gint tab[] = { 80, 160, 80, 160 }; \
-  gint width, height; \
-  guint8 *dest; \
+  gint width, height, stride; \
+  guint8 *data, *dest; \
   \
-  dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
   height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   \
-  if (!RGB) { \
-    for (i = 0; i < height; i++) { \
-      for (j = 0; j < width; j++) { \
-        dest[A] = 0xff; \
-        dest[C1] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
-        dest[C2] = 128; \
-        dest[C3] = 128; \
-        dest += 4; \
-      } \
-    } \
-  } else { \
-    for (i = 0; i < height; i++) { \
-      for (j = 0; j < width; j++) { \
-        val = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
-        dest[A] = 0xFF; \
-        dest[C1] = val; \
-        dest[C2] = val; \
-        dest[C3] = val; \
-        dest += 4; \
-      } \
+  for (i = 0; i < MIN (height, 9); i += 8) { \
+    dest = data + i * stride; \
+    for (j = 0; j < width; j++) { \
+      val = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
+      dest[A] = 0xff; \
+      dest[C1] = val; \
+      dest[C2] = RGB ? val : 128; \
+      dest[C3] = RGB ? val : 128; \
+      dest += 4; \
     } \
   } \
+  _fill_checker_lines (data, stride, width * 4, height); \
 }
 
-A32_CHECKER_C (argb, TRUE, 0, 1, 2, 3);
-A32_CHECKER_C (bgra, TRUE, 3, 2, 1, 0);
-A32_CHECKER_C (ayuv, FALSE, 0, 1, 2, 3);
+A32_CHECKER (argb, TRUE, 0, 1, 2, 3);
+A32_CHECKER (bgra, TRUE, 3, 2, 1, 0);
+A32_CHECKER (ayuv, FALSE, 0, 1, 2, 3);
 
 #define YUV_TO_R(Y,U,V) (CLAMP (1.164 * (Y - 16) + 1.596 * (V - 128), 0, 255))
 #define YUV_TO_G(Y,U,V) (CLAMP (1.164 * (Y - 16) - 0.813 * (V - 128) - 0.391 * (U - 128), 0, 255))
@@ -353,12 +373,12 @@ fill_checker_##format_name (GstVideoFrame * frame) \
   comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = 0; i < MIN (comp_height, 9); i += 8) { \
     for (j = 0; j < comp_width; j++) { \
-      *p++ = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
+      p[i * rowstride + j] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
     } \
-    p += rowstride - comp_width; \
   } \
+  _fill_checker_lines (p, rowstride, comp_width, comp_height); \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 1); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
@@ -582,12 +602,12 @@ fill_checker_##format_name (GstVideoFrame * frame) \
   comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = 0; i < MIN (comp_height, 9); i += 8) { \
     for (j = 0; j < comp_width; j++) { \
-      *p++ = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
+      p[i * rowstride + j] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
     } \
-    p += rowstride - comp_width; \
   } \
+  _fill_checker_lines (p, rowstride, comp_width, comp_height); \
   \
   p = GST_VIDEO_FRAME_PLANE_DATA (frame, 1); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
@@ -626,13 +646,13 @@ fill_color_##format_name (GstVideoFrame * frame, \
   comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1); \
   \
-  for (i = 0; i < comp_height; i++) { \
+  if (comp_height > 0) { \
     for (j = 0; j < comp_width; j++) { \
       u[j*2] = colU; \
       v[j*2] = colV; \
     } \
-    u += rowstride; \
-    v += rowstride; \
+    _fill_from_first_line (MIN (u, v), rowstride, comp_width * 2, \
+        comp_height); \
   } \
 }
 
@@ -710,30 +730,30 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   BLENDLOOP(dest, dest_stride, src, src_stride, b_alpha, src_width * bpp, src_height); \
 }
 
-#define RGB_FILL_CHECKER_C(name, bpp, r, g, b) \
+#define RGB_FILL_CHECKER(name, bpp, r, g, b) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name (GstVideoFrame * frame) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
-  gint stride, dest_add, width, height; \
-  guint8 *dest; \
+  gint stride, width, height; \
+  guint8 *data, *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
   height = GST_VIDEO_FRAME_HEIGHT (frame); \
-  dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
-  dest_add = stride - width * bpp; \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = 0; i < MIN (height, 9); i += 8) { \
+    dest = data + i * stride; \
     for (j = 0; j < width; j++) { \
       dest[r] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)];       /* red */ \
       dest[g] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)];       /* green */ \
       dest[b] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)];       /* blue */ \
       dest += bpp; \
     } \
-    dest += dest_add; \
   } \
+  _fill_checker_lines (data, stride, width * bpp, height); \
 }
 
 #define RGB_FILL_COLOR(name, bpp, MEMSET_RGB) \
@@ -742,7 +762,6 @@ fill_color_##name (GstVideoFrame * frame, \
     gint colY, gint colU, gint colV) \
 { \
   gint red, green, blue; \
-  gint i; \
   gint dest_stride; \
   gint width, height; \
   guint8 *dest; \
@@ -756,9 +775,9 @@ fill_color_##name (GstVideoFrame * frame, \
   green = YUV_TO_G (colY, colU, colV); \
   blue = YUV_TO_B (colY, colU, colV); \
   \
-  for (i = 0; i < height; i++) { \
+  if (height > 0) { \
     MEMSET_RGB (dest, red, green, blue, width); \
-    dest += dest_stride; \
+    _fill_from_first_line (dest, dest_stride, width * bpp, height); \
   } \
 }
 
@@ -787,7 +806,7 @@ _memset_##name (guint8* dest, gint red, gint green, gint blue, gint width) { \
 #define _orc_memcpy_u32(dest,src,len) video_mixer_orc_memcpy_u32((guint32 *) dest, (const guint32 *) src, len/4)
 
 RGB_BLEND (rgb, 3, memcpy, video_mixer_orc_blend_u8);
-RGB_FILL_CHECKER_C (rgb, 3, 0, 1, 2);
+RGB_FILL_CHECKER (rgb, 3, 0, 1, 2);
 MEMSET_RGB_C (rgb, 0, 1, 2);
 RGB_FILL_COLOR (rgb_c, 3, _memset_rgb_c);
 
@@ -795,7 +814,7 @@ MEMSET_RGB_C (bgr, 2, 1, 0);
 RGB_FILL_COLOR (bgr_c, 3, _memset_bgr_c);
 
 RGB_BLEND (xrgb, 4, _orc_memcpy_u32, video_mixer_orc_blend_u8);
-RGB_FILL_CHECKER_C (xrgb, 4, 1, 2, 3);
+RGB_FILL_CHECKER (xrgb, 4, 1, 2, 3);
 MEMSET_XRGB (xrgb, 24, 16, 0);
 RGB_FILL_COLOR (xrgb, 4, _memset_xrgb);
 
@@ -879,24 +898,25 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   BLENDLOOP(dest, dest_stride, src, src_stride, b_alpha, 2 * src_width, src_height); \
 }
 
-#define PACKED_422_FILL_CHECKER_C(name, Y1, U, Y2, V) \
+#define PACKED_422_FILL_CHECKER(name, Y1, U, Y2, V) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name (GstVideoFrame * frame) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
-  gint dest_add; \
+  gint stride; \
   gint width, height; \
-  guint8 *dest; \
+  guint8 *data, *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
   width = GST_ROUND_UP_2 (width); \
   height = GST_VIDEO_FRAME_HEIGHT (frame); \
-  dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
-  dest_add = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) - width * 2; \
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   width /= 2; \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = 0; i < MIN (height, 9); i += 8) { \
+    dest = data + i * stride; \
     for (j = 0; j < width; j++) { \
       dest[Y1] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
       dest[Y2] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
@@ -904,8 +924,8 @@ fill_checker_##name##_c (GstVideoFrame * frame) \
       dest[V] = 128; \
       dest += 4; \
     } \
-    dest += dest_add; \
   } \
+  _fill_checker_lines (data, stride, width * 4, height); \
 }
 
 #define PACKED_422_FILL_COLOR(name, Y1, U, Y2, V) \
@@ -935,8 +955,8 @@ fill_color_##name (GstVideoFrame * frame, \
 }
 
 PACKED_422_BLEND (yuy2, memcpy, video_mixer_orc_blend_u8);
-PACKED_422_FILL_CHECKER_C (yuy2, 0, 1, 2, 3);
-PACKED_422_FILL_CHECKER_C (uyvy, 1, 0, 3, 2);
+PACKED_422_FILL_CHECKER (yuy2, 0, 1, 2, 3);
+PACKED_422_FILL_CHECKER (uyvy, 1, 0, 3, 2);
 PACKED_422_FILL_COLOR (yuy2, 24, 16, 8, 0);
 PACKED_422_FILL_COLOR (yvyu, 24, 0, 8, 16);
 PACKED_422_FILL_COLOR (uyvy, 16, 24, 0, 8);
@@ -1022,19 +1042,19 @@ gst_video_mixer_init_blend (void)
   gst_video_mixer_blend_xrgb = blend_xrgb;
   gst_video_mixer_blend_yuy2 = blend_yuy2;
 
-  gst_video_mixer_fill_checker_argb = fill_checker_argb_c;
-  gst_video_mixer_fill_checker_bgra = fill_checker_bgra_c;
-  gst_video_mixer_fill_checker_ayuv = fill_checker_ayuv_c;
+  gst_video_mixer_fill_checker_argb = fill_checker_argb;
+  gst_video_mixer_fill_checker_bgra = fill_checker_bgra;
+  gst_video_mixer_fill_checker_ayuv = fill_checker_ayuv;
   gst_video_mixer_fill_checker_i420 = fill_checker_i420;
   gst_video_mixer_fill_checker_nv12 = fill_checker_nv12;
   gst_video_mixer_fill_checker_nv21 = fill_checker_nv21;
   gst_video_mixer_fill_checker_y444 = fill_checker_y444;
   gst_video_mixer_fill_checker_y42b = fill_checker_y42b;
   gst_video_mixer_fill_checker_y41b = fill_checker_y41b;
-  gst_video_mixer_fill_checker_rgb = fill_checker_rgb_c;
-  gst_video_mixer_fill_checker_xrgb = fill_checker_xrgb_c;
-  gst_video_mixer_fill_checker_yuy2 = fill_checker_yuy2_c;
-  gst_video_mixer_fill_checker_uyvy = fill_checker_uyvy_c;
+  gst_video_mixer_fill_checker_rgb = fill_checker_rgb;
+  gst_video_mixer_fill_checker_xrgb = fill_checker_xrgb;
+  gst_video_mixer_fill_checker_yuy2 = fill_checker_yuy2;
+  gst_video_mixer_fill_checker_uyvy = fill_checker_uyvy;
 
   gst_video_mixer_fill_color_argb = fill_color_argb;
   gst_video_mixer_fill_color_bgra = fill_color_bgra;
@@ -292,6 +292,14 @@ done:
   return ret;
 }
 
+/* drop the cached converted frame, it was made with the old converter */
+static void
+gst_videomixer2_pad_clear_converted (GstVideoMixer2Pad * pad)
+{
+  gst_buffer_replace (&pad->converted_buffer, NULL);
+  gst_buffer_replace (&pad->converted_source, NULL);
+}
+
 static gboolean
 gst_videomixer2_update_converters (GstVideoMixer2 * mix)
 {
@@ -416,6 +424,7 @@ gst_videomixer2_update_converters (GstVideoMixer2 * mix)
       videomixer_videoconvert_convert_free (pad->convert);
 
     pad->convert = NULL;
+    gst_videomixer2_pad_clear_converted (pad);
 
     colorimetry = gst_video_colorimetry_to_string (&(pad->info.colorimetry));
     chroma = gst_video_chroma_to_string (pad->info.chroma_site);
@@ -737,10 +746,12 @@ gst_videomixer2_pad_init (GstVideoMixer2Pad * mixerpad)
 
 /* GstVideoMixer2 */
 #define DEFAULT_BACKGROUND VIDEO_MIXER2_BACKGROUND_CHECKER
+#define DEFAULT_N_THREADS 1
 enum
 {
   PROP_0,
-  PROP_BACKGROUND
+  PROP_BACKGROUND,
+  PROP_N_THREADS
 };
 
 #define GST_TYPE_VIDEO_MIXER2_BACKGROUND (gst_videomixer2_background_get_type())
@@ -1013,63 +1024,289 @@ gst_videomixer2_fill_queues (GstVideoMixer2 * mix,
   return 1;
 }
 
-static GstFlowReturn
-gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
-    GstClockTime output_start_time, GstClockTime output_end_time,
-    GstBuffer ** outbuf)
+/* output lines are handed out to the threads in multiples of this, it keeps
+ * the stripes aligned to the chroma subsampling and to the checker pattern */
+#define STRIPE_ALIGN 16
+
+/* the blend functions round pad positions to the chroma subsampling, which
+ * is at most 4 pixels */
+#define POSITION_ALIGN 4
+
+/* [x0, x1) x [y0, y1) in output pixels */
+typedef struct
 {
-  GSList *l;
-  guint outsize;
+  gint x0, y0, x1, y1;
+} GstVideoMixer2Rect;
+
+/* a pad frame ready to be composited */
+typedef struct
+{
+  GstVideoFrame frame;
+  GstBuffer *converted_buf;
+  gint xpos, ypos;
+  gdouble alpha;
+
+  /* pixels the pad overwrites completely, empty if it is not opaque */
+  GstVideoMixer2Rect opaque;
+  /* TRUE if the pad is hidden behind an opaque pad above it */
+  gboolean culled;
+
+  /* set if @src_frame still has to be converted into @frame */
+  VideoConvert *convert;
+  GstVideoFrame src_frame;
+} GstVideoMixer2BlendInput;
+
+/* everything the stripes of one output frame share */
+typedef struct
+{
+  GstVideoMixer2 *mix;
+  GstVideoFrame *outframe;
   BlendFunction composite;
-  GstVideoFrame outframe;
-  static GstAllocationParams params = { 0, 15, 0, 0, };
+  GstVideoMixer2BlendInput *inputs;
+  guint n_inputs;
 
-  outsize = GST_VIDEO_INFO_SIZE (&mix->info);
+  /* full-width band of lines that is covered by an opaque pad and does not
+   * need the background */
+  gint covered_start, covered_end;
+} GstVideoMixer2BlendData;
 
-  *outbuf = gst_buffer_new_allocate (NULL, outsize, &params);
-  GST_BUFFER_TIMESTAMP (*outbuf) = output_start_time;
-  GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
+/* make @stripe a view of the lines [@y, @y + @height) of @frame */
+static void
+gst_videomixer2_get_stripe (const GstVideoFrame * frame, gint y, gint height,
+    GstVideoFrame * stripe)
+{
+  guint plane;
 
-  gst_video_frame_map (&outframe, &mix->info, *outbuf, GST_MAP_READWRITE);
+  *stripe = *frame;
+  stripe->info.height = height;
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (frame); plane++) {
+    gint plane_y = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (frame->info.finfo,
+        plane, y);
+
+    stripe->data[plane] = (guint8 *) frame->data[plane] +
+        plane_y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+  }
+}
 
-  /* default to blending */
-  composite = mix->blend;
+/* paint the configured background into @frame */
+static void
+gst_videomixer2_fill_background (GstVideoMixer2 * mix, GstVideoFrame * frame)
+{
   switch (mix->background) {
     case VIDEO_MIXER2_BACKGROUND_CHECKER:
-      mix->fill_checker (&outframe);
+      mix->fill_checker (frame);
       break;
     case VIDEO_MIXER2_BACKGROUND_BLACK:
-      mix->fill_color (&outframe, 16, 128, 128);
+      mix->fill_color (frame, 16, 128, 128);
       break;
     case VIDEO_MIXER2_BACKGROUND_WHITE:
-      mix->fill_color (&outframe, 240, 128, 128);
+      mix->fill_color (frame, 240, 128, 128);
       break;
     case VIDEO_MIXER2_BACKGROUND_TRANSPARENT:
     {
-      guint i, plane, num_planes, height;
+      guint j, plane, num_planes, comp_height;
 
-      num_planes = GST_VIDEO_FRAME_N_PLANES (&outframe);
+      num_planes = GST_VIDEO_FRAME_N_PLANES (frame);
       for (plane = 0; plane < num_planes; ++plane) {
         guint8 *pdata;
         gsize rowsize, plane_stride;
 
-        pdata = GST_VIDEO_FRAME_PLANE_DATA (&outframe, plane);
-        plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, plane);
-        rowsize = GST_VIDEO_FRAME_COMP_WIDTH (&outframe, plane)
-            * GST_VIDEO_FRAME_COMP_PSTRIDE (&outframe, plane);
-        height = GST_VIDEO_FRAME_COMP_HEIGHT (&outframe, plane);
-        for (i = 0; i < height; ++i) {
+        pdata = GST_VIDEO_FRAME_PLANE_DATA (frame, plane);
+        plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+        rowsize = GST_VIDEO_FRAME_COMP_WIDTH (frame, plane)
+            * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, plane);
+        comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, plane);
+        for (j = 0; j < comp_height; ++j) {
           memset (pdata, 0, rowsize);
           pdata += plane_stride;
         }
       }
-
-      /* use overlay to keep background transparent */
-      composite = mix->overlay;
       break;
     }
   }
+}
+
+/* fill the background of one stripe of the output and composite all pads
+ * over it in z-order. The blend functions clip the pads against the stripe
+ * like against any other output frame, so every stripe produces exactly the
+ * lines it would have in a single pass. */
+static void
+gst_videomixer2_blend_stripe (gpointer user_data, guint slice, guint n_slices)
+{
+  GstVideoMixer2BlendData *data = user_data;
+  GstVideoMixer2 *mix = data->mix;
+  gint height = GST_VIDEO_FRAME_HEIGHT (data->outframe);
+  gint n_units = (height + STRIPE_ALIGN - 1) / STRIPE_ALIGN;
+  gint start, end;
+  gint skip_start, skip_end;
+  GstVideoFrame stripe;
+  guint i;
+
+  start = MIN (height, (n_units * slice / n_slices) * STRIPE_ALIGN);
+  end = MIN (height, (n_units * (slice + 1) / n_slices) * STRIPE_ALIGN);
+  if (start >= end)
+    return;
+
+  /* skip the part of the stripe that is covered anyway. The skipped lines
+   * are rounded inwards to the stripe alignment so that the checker pattern
+   * keeps its phase, the few extra lines get overwritten by the pad */
+  skip_start = end;
+  skip_end = end;
+  if (data->covered_start < data->covered_end) {
+    skip_start = data->covered_start <= 0 ? start :
+        GST_ROUND_UP_N (data->covered_start, STRIPE_ALIGN);
+    skip_end = data->covered_end >= height ? end :
+        GST_ROUND_DOWN_N (data->covered_end, STRIPE_ALIGN);
+    skip_start = CLAMP (skip_start, start, end);
+    skip_end = CLAMP (skip_end, start, end);
+    if (skip_start >= skip_end)
+      skip_start = skip_end = end;
+  }
+
+  if (skip_start > start) {
+    gst_videomixer2_get_stripe (data->outframe, start, skip_start - start,
+        &stripe);
+    gst_videomixer2_fill_background (mix, &stripe);
+  }
+  if (end > skip_end) {
+    gst_videomixer2_get_stripe (data->outframe, skip_end, end - skip_end,
+        &stripe);
+    gst_videomixer2_fill_background (mix, &stripe);
+  }
 
+  gst_videomixer2_get_stripe (data->outframe, start, end - start, &stripe);
+
+  for (i = 0; i < data->n_inputs; i++) {
+    GstVideoMixer2BlendInput *input = &data->inputs[i];
+
+    if (input->culled)
+      continue;
+
+    data->composite (&input->frame, input->xpos, input->ypos - start,
+        input->alpha, &stripe);
+  }
+}
+
+static gboolean
+gst_videomixer2_rect_contains (const GstVideoMixer2Rect * outer,
+    const GstVideoMixer2Rect * inner)
+{
+  return outer->x0 <= inner->x0 && outer->y0 <= inner->y0 &&
+      outer->x1 >= inner->x1 && outer->y1 >= inner->y1;
+}
+
+/* Find the pads that overwrite their area completely and use them to skip
+ * the pads below them and the background under full-width ones. Only the
+ * output formats without alpha copy opaque pads verbatim; with alpha the
+ * result always depends on the pixels below. The rectangles are kept on the
+ * safe side of the position rounding done by the blend functions. */
+static void
+gst_videomixer2_cull_inputs (GstVideoMixer2 * mix,
+    GstVideoMixer2BlendData * data)
+{
+  gint width = GST_VIDEO_INFO_WIDTH (&mix->info);
+  gint height = GST_VIDEO_INFO_HEIGHT (&mix->info);
+  gboolean output_alpha = GST_VIDEO_INFO_HAS_ALPHA (&mix->info);
+  gint i, j;
+
+  data->covered_start = data->covered_end = 0;
+
+  for (i = data->n_inputs - 1; i >= 0; i--) {
+    GstVideoMixer2BlendInput *input = &data->inputs[i];
+    gint w = GST_VIDEO_FRAME_WIDTH (&input->frame);
+    gint h = GST_VIDEO_FRAME_HEIGHT (&input->frame);
+    GstVideoMixer2Rect *opaque = &input->opaque;
+    GstVideoMixer2Rect extent;
+
+    extent.x0 = MAX (input->xpos - POSITION_ALIGN, 0);
+    extent.y0 = MAX (input->ypos - POSITION_ALIGN, 0);
+    extent.x1 = MIN (input->xpos + w + POSITION_ALIGN, width);
+    extent.y1 = MIN (input->ypos + h + POSITION_ALIGN, height);
+
+    for (j = i + 1; j < data->n_inputs; j++) {
+      if (gst_videomixer2_rect_contains (&data->inputs[j].opaque, &extent)) {
+        GST_LOG_OBJECT (mix, "pad %d is hidden by pad %d", i, j);
+        input->culled = TRUE;
+        break;
+      }
+    }
+
+    if (output_alpha || input->alpha != 1.0)
+      continue;
+
+    opaque->x0 = input->xpos <= 0 ? 0 :
+        GST_ROUND_UP_N (input->xpos + POSITION_ALIGN - 1, POSITION_ALIGN);
+    opaque->y0 = input->ypos <= 0 ? 0 :
+        GST_ROUND_UP_N (input->ypos + POSITION_ALIGN - 1, POSITION_ALIGN);
+    opaque->x1 = input->xpos + w >= width ? width :
+        GST_ROUND_DOWN_N (input->xpos + w, POSITION_ALIGN);
+    opaque->y1 = input->ypos + h >= height ? height :
+        GST_ROUND_DOWN_N (input->ypos + h, POSITION_ALIGN);
+
+    if (opaque->x0 >= opaque->x1 || opaque->y0 >= opaque->y1) {
+      memset (opaque, 0, sizeof (*opaque));
+      continue;
+    }
+
+    if (opaque->x0 == 0 && opaque->x1 == width &&
+        opaque->y1 - opaque->y0 > data->covered_end - data->covered_start) {
+      data->covered_start = opaque->y0;
+      data->covered_end = opaque->y1;
+    }
+  }
+}
+
+/* run the pending conversions, every thread takes every n_slices-th pad */
+static void
+gst_videomixer2_convert_inputs (gpointer user_data, guint slice,
+    guint n_slices)
+{
+  GstVideoMixer2BlendData *data = user_data;
+  guint i;
+
+  for (i = slice; i < data->n_inputs; i += n_slices) {
+    GstVideoMixer2BlendInput *input = &data->inputs[i];
+
+    if (input->convert)
+      videomixer_videoconvert_convert_convert (input->convert, &input->frame,
+          &input->src_frame);
+  }
+}
+
+static GstFlowReturn
+gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
+    GstClockTime output_start_time, GstClockTime output_end_time,
+    GstBuffer ** outbuf)
+{
+  GSList *l;
+  guint outsize, i;
+  GstVideoFrame outframe;
+  GstVideoMixer2BlendData data;
+  guint n_convert = 0;
+  static GstAllocationParams params = { 0, 15, 0, 0, };
+
+  outsize = GST_VIDEO_INFO_SIZE (&mix->info);
+
+  *outbuf = gst_buffer_new_allocate (NULL, outsize, &params);
+  GST_BUFFER_TIMESTAMP (*outbuf) = output_start_time;
+  GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
+
+  gst_video_frame_map (&outframe, &mix->info, *outbuf, GST_MAP_READWRITE);
+
+  data.mix = mix;
+  data.outframe = &outframe;
+  /* default to blending, use overlay to keep a transparent background
+   * transparent */
+  if (mix->background == VIDEO_MIXER2_BACKGROUND_TRANSPARENT)
+    data.composite = mix->overlay;
+  else
+    data.composite = mix->blend;
+  data.inputs = g_new0 (GstVideoMixer2BlendInput, mix->numpads);
+  data.n_inputs = 0;
+
+  /* map and convert all inputs first, the compositing itself is then split
+   * over the threads */
   for (l = mix->sinkpads; l; l = l->next) {
     GstVideoMixer2Pad *pad = l->data;
     GstVideoMixer2Collect *mixcol = pad->mixcol;
@@ -1078,10 +1315,12 @@ gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
       GstClockTime timestamp;
       gint64 stream_time;
       GstSegment *seg;
-      GstVideoFrame converted_frame;
-      GstBuffer *converted_buf = NULL;
+      GstVideoMixer2BlendInput *input;
       GstVideoFrame frame;
 
+      g_assert (data.n_inputs < mix->numpads);
+      input = &data.inputs[data.n_inputs++];
+
       seg = &mixcol->collect.segment;
 
       timestamp = GST_BUFFER_TIMESTAMP (mixcol->buffer);
@@ -1105,29 +1344,75 @@ gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
               GST_VIDEO_INFO_FORMAT (&mix->info), pad->info.width,
               pad->info.height);
           pad->need_conversion_update = FALSE;
+          gst_videomixer2_pad_clear_converted (pad);
         }
 
         converted_size = pad->conversion_info.size;
         converted_size = converted_size > outsize ? converted_size : outsize;
-        converted_buf = gst_buffer_new_allocate (NULL, converted_size, &params);
 
-        gst_video_frame_map (&converted_frame, &(pad->conversion_info),
-            converted_buf, GST_MAP_READWRITE);
-        videomixer_videoconvert_convert_convert (pad->convert, &converted_frame,
-            &frame);
-        gst_video_frame_unmap (&frame);
+        if (pad->converted_source == mixcol->buffer) {
+          /* same input as last time, the converted frame is still good */
+          GST_LOG_OBJECT (pad, "reusing converted frame");
+          gst_video_frame_unmap (&frame);
+          input->converted_buf = gst_buffer_ref (pad->converted_buffer);
+          gst_video_frame_map (&input->frame, &(pad->conversion_info),
+              input->converted_buf, GST_MAP_READ);
+        } else {
+          /* recycle the previous converted buffer if nobody else uses it */
+          if (!pad->converted_buffer
+              || gst_buffer_get_size (pad->converted_buffer) != converted_size
+              || !gst_buffer_is_writable (pad->converted_buffer)) {
+            gst_buffer_replace (&pad->converted_buffer, NULL);
+            pad->converted_buffer =
+                gst_buffer_new_allocate (NULL, converted_size, &params);
+          }
+          gst_buffer_replace (&pad->converted_source, mixcol->buffer);
+
+          input->converted_buf = gst_buffer_ref (pad->converted_buffer);
+          gst_video_frame_map (&input->frame, &(pad->conversion_info),
+              input->converted_buf, GST_MAP_READWRITE);
+          input->convert = pad->convert;
+          input->src_frame = frame;
+          n_convert++;
+        }
       } else {
-        converted_frame = frame;
+        input->frame = frame;
       }
 
-      composite (&converted_frame, pad->xpos, pad->ypos, pad->alpha, &outframe);
+      input->xpos = pad->xpos;
+      input->ypos = pad->ypos;
+      input->alpha = pad->alpha;
+    }
+  }
 
-      if (pad->convert)
-        gst_buffer_unref (converted_buf);
+  gst_workers_ensure (&mix->workers, g_atomic_int_get (&mix->n_threads));
 
-      gst_video_frame_unmap (&converted_frame);
-    }
+  /* the pads have their own converters, so they are converted in parallel */
+  if (mix->workers && n_convert > 1)
+    gst_workers_run (mix->workers, gst_videomixer2_convert_inputs, &data);
+  else if (n_convert > 0)
+    gst_videomixer2_convert_inputs (&data, 0, 1);
+
+  gst_videomixer2_cull_inputs (mix, &data);
+
+  if (mix->workers)
+    gst_workers_run (mix->workers, gst_videomixer2_blend_stripe, &data);
+  else
+    gst_videomixer2_blend_stripe (&data, 0, 1);
+
+  for (i = 0; i < data.n_inputs; i++) {
+    GstVideoMixer2BlendInput *input = &data.inputs[i];
+
+    if (input->convert)
+      gst_video_frame_unmap (&input->src_frame);
+
+    if (input->converted_buf)
+      gst_buffer_unref (input->converted_buf);
+
+    gst_video_frame_unmap (&input->frame);
   }
+  g_free (data.inputs);
+
   gst_video_frame_unmap (&outframe);
 
   return GST_FLOW_OK;
@@ -2150,6 +2435,7 @@ gst_videomixer2_release_pad (GstElement * element, GstPad * pad)
 
   if (mixpad->convert)
     videomixer_videoconvert_convert_free (mixpad->convert);
+  gst_videomixer2_pad_clear_converted (mixpad);
 
   mix->sinkpads = g_slist_remove (mix->sinkpads, pad);
   gst_child_proxy_child_removed (GST_CHILD_PROXY (mix), G_OBJECT (mixpad),
@@ -2181,6 +2467,8 @@ gst_videomixer2_finalize (GObject * o)
   GstVideoMixer2 *mix = GST_VIDEO_MIXER2 (o);
 
   gst_object_unref (mix->collect);
+  if (mix->workers)
+    gst_workers_free (mix->workers);
   g_mutex_clear (&mix->lock);
   g_mutex_clear (&mix->setcaps_lock);
 
@@ -2198,6 +2486,7 @@ gst_videomixer2_dispose (GObject * o)
 
     if (mixpad->convert)
       videomixer_videoconvert_convert_free (mixpad->convert);
+    gst_videomixer2_pad_clear_converted (mixpad);
   }
 
   if (mix->pending_tags) {
@@ -2218,6 +2507,9 @@ gst_videomixer2_get_property (GObject * object,
     case PROP_BACKGROUND:
       g_value_set_enum (value, mix->background);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, g_atomic_int_get (&mix->n_threads));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2234,6 +2526,10 @@ gst_videomixer2_set_property (GObject * object,
     case PROP_BACKGROUND:
       mix->background = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      /* takes effect with the next output frame */
+      g_atomic_int_set (&mix->n_threads, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2296,6 +2592,20 @@ gst_videomixer2_class_init (GstVideoMixer2Class * klass)
           GST_TYPE_VIDEO_MIXER2_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVideoMixer2:n-threads:
+   *
+   * The number of threads that composite an output frame. Every thread fills
+   * the background of a horizontal stripe of the output and blends all pads
+   * over it in z-order, so the output does not depend on this setting.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to composite a frame", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_videomixer2_request_new_pad);
   gstelement_class->release_pad =
@@ -2333,6 +2643,7 @@ gst_videomixer2_init (GstVideoMixer2 * mix)
 
   mix->collect = gst_collect_pads_new ();
   mix->background = DEFAULT_BACKGROUND;
+  mix->n_threads = DEFAULT_N_THREADS;
   mix->current_caps = NULL;
   mix->pending_tags = NULL;
 
@@ -25,6 +25,7 @@
 #include <gst/video/video.h>
 
 #include "blend.h"
+#include <gst/workers/gstworkers.h>
 #include <gst/base/gstcollectpads.h>
 
 G_BEGIN_DECLS
@@ -122,6 +123,11 @@ struct _GstVideoMixer2
   gboolean send_stream_start;
 
   GstTagList *pending_tags;
+
+  /* number of threads the output frame is split over, the workers are only
+   * touched from the streaming thread */
+  guint n_threads;
+  GstWorkers *workers;
 };
 
 struct _GstVideoMixer2Class
@@ -72,6 +72,10 @@ struct _GstVideoMixer2Pad
   VideoConvert *convert;
 
   gboolean need_conversion_update;
+
+  /* last converted frame and the input buffer it was converted from */
+  GstBuffer *converted_buffer;
+  GstBuffer *converted_source;
 };
 
 struct _GstVideoMixer2PadClass
@@ -49,6 +49,16 @@
 GST_DEBUG_CATEGORY_STATIC (wavenc_debug);
 #define GST_CAT_DEFAULT wavenc_debug
 
+#define DEFAULT_RF64                    FALSE
+#define DEFAULT_HEADER_UPDATE_INTERVAL  0
+
+enum
+{
+  PROP_0,
+  PROP_RF64,
+  PROP_HEADER_UPDATE_INTERVAL
+};
+
 struct riff_struct
 {
   guint8 id[4];                 /* RIFF */
@@ -162,14 +172,54 @@ static gboolean gst_wavenc_event (GstPad * pad, GstObject * parent,
 static GstStateChangeReturn gst_wavenc_change_state (GstElement * element,
     GstStateChange transition);
 static gboolean gst_wavenc_sink_setcaps (GstPad * pad, GstCaps * caps);
+static void gst_wavenc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_wavenc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static void
 gst_wavenc_class_init (GstWavEncClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *element_class;
 
+  gobject_class = (GObjectClass *) klass;
   element_class = (GstElementClass *) klass;
 
+  gobject_class->set_property = gst_wavenc_set_property;
+  gobject_class->get_property = gst_wavenc_get_property;
+
+  /**
+   * GstWavEnc:rf64:
+   *
+   * Reserve space for a ds64 chunk in the header, so that the file can be
+   * turned into an RF64 file when it grows beyond 4 GB. Smaller files stay
+   * normal WAV files with an additional JUNK chunk.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_RF64,
+      g_param_spec_boolean ("rf64", "RF64",
+          "Write an RF64 file if the data grows beyond 4 GB", DEFAULT_RF64,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWavEnc:header-update-interval:
+   *
+   * Rewrite the header with the sizes of the data written so far every
+   * this many nanoseconds of audio, so that a recording that is cut off
+   * is still a valid file up to the last update. Needs a seekable
+   * downstream such as filesink. 0 only writes the final header on EOS.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_HEADER_UPDATE_INTERVAL,
+      g_param_spec_uint64 ("header-update-interval", "Header update interval",
+          "Interval between updates of the header in nanoseconds of audio "
+          "(0 = only on EOS)", 0, G_MAXUINT64, DEFAULT_HEADER_UPDATE_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class->change_state = GST_DEBUG_FUNCPTR (gst_wavenc_change_state);
 
   gst_element_class_set_static_metadata (element_class, "WAV audio muxer",
@@ -200,10 +250,17 @@ gst_wavenc_init (GstWavEnc * wavenc)
   gst_pad_set_caps (wavenc->srcpad,
       gst_static_pad_template_get_caps (&src_factory));
   gst_element_add_pad (GST_ELEMENT (wavenc), wavenc->srcpad);
+
+  wavenc->rf64 = DEFAULT_RF64;
+  wavenc->header_update_interval = DEFAULT_HEADER_UPDATE_INTERVAL;
 }
 
 #define WAV_HEADER_LEN 44
 
+/* the JUNK chunk that becomes the ds64 chunk of an RF64 file, with the
+ * 64 bit RIFF size, data size and sample count and an empty table */
+#define DS64_CHUNK_LEN (8 + 28)
+
 static GstBuffer *
 gst_wavenc_create_header_buf (GstWavEnc * wavenc)
 {
@@ -211,15 +268,23 @@ gst_wavenc_create_header_buf (GstWavEnc * wavenc)
   GstBuffer *buf;
   GstMapInfo map;
   guint8 *header;
+  guint64 riff_len;
+  guint ds64_len;
+  gboolean large;
 
-  buf = gst_buffer_new_and_alloc (WAV_HEADER_LEN);
+  ds64_len = wavenc->header_length - WAV_HEADER_LEN;
+  riff_len = wavenc->meta_length + wavenc->audio_length +
+      wavenc->header_length - 8;
+  /* the 32 bit sizes of an RF64 file are -1, the real ones are in ds64 */
+  large = ds64_len > 0 && riff_len > G_MAXUINT32;
+
+  buf = gst_buffer_new_and_alloc (wavenc->header_length);
   gst_buffer_map (buf, &map, GST_MAP_WRITE);
   header = map.data;
-  memset (header, 0, WAV_HEADER_LEN);
+  memset (header, 0, wavenc->header_length);
 
-  memcpy (wave.riff.id, "RIFF", 4);
-  wave.riff.len =
-      wavenc->meta_length + wavenc->audio_length + WAV_HEADER_LEN - 8;
+  memcpy (wave.riff.id, large ? "RF64" : "RIFF", 4);
+  wave.riff.len = MIN (riff_len, G_MAXUINT32);
   memcpy (wave.riff.wav_id, "WAVE", 4);
 
   memcpy (wave.format.id, "fmt ", 4);
@@ -234,11 +299,26 @@ gst_wavenc_create_header_buf (GstWavEnc * wavenc)
       wave.common.wBlockAlign * wave.common.dwSamplesPerSec;
 
   memcpy (wave.data.id, "data", 4);
-  wave.data.len = wavenc->audio_length;
+  wave.data.len = large ? G_MAXUINT32 : MIN (wavenc->audio_length,
+      G_MAXUINT32);
 
   memcpy (header, (char *) wave.riff.id, 4);
   GST_WRITE_UINT32_LE (header + 4, wave.riff.len);
   memcpy (header + 8, (char *) wave.riff.wav_id, 4);
+
+  if (ds64_len > 0) {
+    memcpy (header + 12, large ? "ds64" : "JUNK", 4);
+    GST_WRITE_UINT32_LE (header + 16, ds64_len - 8);
+    if (large) {
+      GST_WRITE_UINT64_LE (header + 20, riff_len);
+      GST_WRITE_UINT64_LE (header + 28, wavenc->audio_length);
+      GST_WRITE_UINT64_LE (header + 36,
+          wavenc->audio_length / wave.common.wBlockAlign);
+    }
+    /* the other chunks follow the reserved space */
+    header += ds64_len;
+  }
+
   memcpy (header + 12, (char *) wave.format.id, 4);
   GST_WRITE_UINT32_LE (header + 16, wave.format.len);
   GST_WRITE_UINT16_LE (header + 20, wave.common.wFormatTag);
@@ -266,8 +346,9 @@ gst_wavenc_push_header (GstWavEnc * wavenc)
   gst_segment_init (&segment, GST_FORMAT_BYTES);
   gst_pad_push_event (wavenc->srcpad, gst_event_new_segment (&segment));
 
-  GST_DEBUG_OBJECT (wavenc, "writing header, meta_size=%u, audio_size=%u",
-      wavenc->meta_length, wavenc->audio_length);
+  GST_DEBUG_OBJECT (wavenc, "writing header, meta_size=%" G_GUINT64_FORMAT
+      ", audio_size=%" G_GUINT64_FORMAT, wavenc->meta_length,
+      wavenc->audio_length);
 
   outbuf = gst_wavenc_create_header_buf (wavenc);
   GST_BUFFER_OFFSET (outbuf) = 0;
@@ -278,10 +359,48 @@ gst_wavenc_push_header (GstWavEnc * wavenc)
     GST_WARNING_OBJECT (wavenc, "push header failed: flow = %s",
         gst_flow_get_name (ret));
   }
+  wavenc->header_audio_length = wavenc->audio_length;
 
   return ret;
 }
 
+/* rewrite the header with the sizes so far and continue after the data */
+static GstFlowReturn
+gst_wavenc_update_header (GstWavEnc * wavenc)
+{
+  GstFlowReturn ret;
+  GstSegment segment;
+
+  ret = gst_wavenc_push_header (wavenc);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.start = wavenc->header_length + wavenc->audio_length;
+  segment.time = segment.start;
+  gst_pad_push_event (wavenc->srcpad, gst_event_new_segment (&segment));
+
+  return GST_FLOW_OK;
+}
+
+/* only a downstream that says it can't seek gets no header updates, for
+ * everything else the header is rewritten on EOS as before */
+static gboolean
+gst_wavenc_is_seekable (GstWavEnc * wavenc)
+{
+  GstQuery *query;
+  gboolean seekable = TRUE;
+
+  query = gst_query_new_seeking (GST_FORMAT_BYTES);
+  if (gst_pad_peer_query (wavenc->srcpad, query))
+    gst_query_parse_seeking (query, NULL, &seekable, NULL, NULL);
+  gst_query_unref (query);
+
+  GST_DEBUG_OBJECT (wavenc, "downstream is seekable: %d", seekable);
+
+  return seekable;
+}
+
 static gboolean
 gst_wavenc_sink_setcaps (GstPad * pad, GstCaps * caps)
 {
@@ -407,21 +526,20 @@ gst_wavparse_tags_foreach (const GstTagList * tags, const gchar * tag,
 
 }
 
-static GstFlowReturn
-gst_wavenc_write_tags (GstWavEnc * wavenc)
+static GstBuffer *
+gst_wavenc_create_tags_buf (GstWavEnc * wavenc)
 {
   const GstTagList *user_tags;
   GstTagList *tags;
   guint size;
-  GstBuffer *buf;
   GstByteWriter bw;
 
-  g_return_val_if_fail (wavenc != NULL, GST_FLOW_OK);
+  g_return_val_if_fail (wavenc != NULL, NULL);
 
   user_tags = gst_tag_setter_get_tag_list (GST_TAG_SETTER (wavenc));
   if ((!wavenc->tags) && (!user_tags)) {
     GST_DEBUG_OBJECT (wavenc, "have no tags");
-    return GST_FLOW_OK;
+    return NULL;
   }
   tags =
       gst_tag_list_merge (user_tags, wavenc->tags,
@@ -446,9 +564,7 @@ gst_wavenc_write_tags (GstWavEnc * wavenc)
 
   gst_tag_list_unref (tags);
 
-  buf = gst_byte_writer_reset_and_get_buffer (&bw);
-  wavenc->meta_length += gst_buffer_get_size (buf);
-  return gst_pad_push (wavenc->srcpad, buf);
+  return gst_byte_writer_reset_and_get_buffer (&bw);
 }
 
 static gboolean
@@ -607,8 +723,8 @@ gst_wavenc_write_notes (guint8 ** data, GList * list)
   return TRUE;
 }
 
-static GstFlowReturn
-gst_wavenc_write_toc (GstWavEnc * wavenc)
+static GstBuffer *
+gst_wavenc_create_toc_buf (GstWavEnc * wavenc)
 {
   GList *list;
   GstToc *toc;
@@ -624,7 +740,7 @@ gst_wavenc_write_toc (GstWavEnc * wavenc)
   }
   if (!wavenc->toc) {
     GST_WARNING_OBJECT (wavenc, "have no toc");
-    return GST_FLOW_OK;
+    return NULL;
   }
 
   toc = gst_toc_ref (wavenc->toc);
@@ -641,7 +757,7 @@ gst_wavenc_write_toc (GstWavEnc * wavenc)
     while (list) {
       subentry = list->data;
       if (!gst_toc_entry_is_sequence (subentry))
-        return FALSE;
+        goto invalid_toc;
       list = g_list_next (list);
     }
     list = gst_toc_entry_get_sub_entries (entry);
@@ -650,7 +766,7 @@ gst_wavenc_write_toc (GstWavEnc * wavenc)
     while (list) {
       entry = list->data;
       if (!gst_toc_entry_is_sequence (entry))
-        return FALSE;
+        goto invalid_toc;
       list = g_list_next (list);
     }
     list = gst_toc_get_entries (toc);
@@ -687,7 +803,8 @@ gst_wavenc_write_toc (GstWavEnc * wavenc)
     size += 12 + cues_size;
   } else {
     GST_WARNING_OBJECT (wavenc, "cue's not found");
-    return FALSE;
+    gst_toc_unref (toc);
+    return NULL;
   }
   /* count labls size */
   if (wavenc->labls) {
@@ -752,6 +869,35 @@ gst_wavenc_write_toc (GstWavEnc * wavenc)
     g_list_free_full (wavenc->notes, g_free);
 
   gst_buffer_unmap (buf, &map);
+
+  return buf;
+
+  /* ERRORS */
+invalid_toc:
+  {
+    GST_WARNING_OBJECT (wavenc, "toc entries are not sequences");
+    gst_toc_unref (toc);
+    return NULL;
+  }
+}
+
+/* push the cue, labl, note and info chunks with a single write */
+static GstFlowReturn
+gst_wavenc_write_meta (GstWavEnc * wavenc)
+{
+  GstBuffer *buf, *tags;
+
+  buf = gst_wavenc_create_toc_buf (wavenc);
+  tags = gst_wavenc_create_tags_buf (wavenc);
+  if (buf && tags)
+    buf = gst_buffer_append (buf, tags);
+  else if (tags)
+    buf = tags;
+
+  if (buf == NULL)
+    return GST_FLOW_OK;
+
+  GST_BUFFER_OFFSET (buf) = wavenc->header_length + wavenc->audio_length;
   wavenc->meta_length += gst_buffer_get_size (buf);
 
   return gst_pad_push (wavenc->srcpad, buf);
@@ -784,19 +930,21 @@ gst_wavenc_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GstFlowReturn flow;
       GST_DEBUG_OBJECT (wavenc, "got EOS");
 
-      flow = gst_wavenc_write_toc (wavenc);
-      if (flow != GST_FLOW_OK) {
-        GST_WARNING_OBJECT (wavenc, "error pushing toc: %s",
-            gst_flow_get_name (flow));
-      }
-      flow = gst_wavenc_write_tags (wavenc);
-      if (flow != GST_FLOW_OK) {
-        GST_WARNING_OBJECT (wavenc, "error pushing tags: %s",
-            gst_flow_get_name (flow));
-      }
+      if (wavenc->seekable) {
+        flow = gst_wavenc_write_meta (wavenc);
+        if (flow != GST_FLOW_OK) {
+          GST_WARNING_OBJECT (wavenc, "error pushing toc and tags: %s",
+              gst_flow_get_name (flow));
+        }
 
-      /* write header with correct length values */
-      gst_wavenc_push_header (wavenc);
+        /* write header with correct length values */
+        gst_wavenc_push_header (wavenc);
+      } else {
+        /* chunks after the data would be taken for audio by readers, as
+         * the header can't be updated with the real data size */
+        GST_DEBUG_OBJECT (wavenc, "downstream is not seekable, not writing "
+            "toc, tags and final header");
+      }
 
       /* we're done with this file */
       wavenc->finished_properly = TRUE;
@@ -854,6 +1002,11 @@ gst_wavenc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     /* starting a file, means we have to finish it properly */
     wavenc->finished_properly = FALSE;
 
+    wavenc->header_length = WAV_HEADER_LEN;
+    if (wavenc->rf64)
+      wavenc->header_length += DS64_CHUNK_LEN;
+    wavenc->seekable = gst_wavenc_is_seekable (wavenc);
+
     /* push initial bogus header, it will be updated on EOS */
     flow = gst_wavenc_push_header (wavenc);
     if (flow != GST_FLOW_OK) {
@@ -863,6 +1016,7 @@ gst_wavenc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     }
     GST_DEBUG_OBJECT (wavenc, "wrote dummy header");
     wavenc->audio_length = 0;
+    wavenc->header_audio_length = 0;
     wavenc->sent_header = TRUE;
   }
 
@@ -872,16 +1026,67 @@ gst_wavenc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   buf = gst_buffer_make_writable (buf);
 
-  GST_BUFFER_OFFSET (buf) = WAV_HEADER_LEN + wavenc->audio_length;
+  GST_BUFFER_OFFSET (buf) = wavenc->header_length + wavenc->audio_length;
   GST_BUFFER_OFFSET_END (buf) = GST_BUFFER_OFFSET_NONE;
 
   wavenc->audio_length += gst_buffer_get_size (buf);
 
   flow = gst_pad_push (wavenc->srcpad, buf);
 
+  if (flow == GST_FLOW_OK && wavenc->seekable &&
+      wavenc->header_update_interval > 0) {
+    guint64 interval;
+
+    interval = gst_util_uint64_scale (wavenc->header_update_interval,
+        wavenc->rate * (wavenc->width / 8) * wavenc->channels, GST_SECOND);
+    if (wavenc->audio_length - wavenc->header_audio_length >= interval) {
+      GST_LOG_OBJECT (wavenc, "updating header");
+      flow = gst_wavenc_update_header (wavenc);
+    }
+  }
+
   return flow;
 }
 
+static void
+gst_wavenc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstWavEnc *wavenc = GST_WAVENC (object);
+
+  switch (prop_id) {
+    case PROP_RF64:
+      /* takes effect with the next file */
+      wavenc->rf64 = g_value_get_boolean (value);
+      break;
+    case PROP_HEADER_UPDATE_INTERVAL:
+      wavenc->header_update_interval = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_wavenc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstWavEnc *wavenc = GST_WAVENC (object);
+
+  switch (prop_id) {
+    case PROP_RF64:
+      g_value_set_boolean (value, wavenc->rf64);
+      break;
+    case PROP_HEADER_UPDATE_INTERVAL:
+      g_value_set_uint64 (value, wavenc->header_update_interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static GstStateChangeReturn
 gst_wavenc_change_state (GstElement * element, GstStateChange transition)
 {
@@ -898,6 +1103,9 @@ gst_wavenc_change_state (GstElement * element, GstStateChange transition)
        * header when we get EOS and know the exact length */
       wavenc->audio_length = 0x7FFF0000;
       wavenc->meta_length = 0;
+      wavenc->header_length = WAV_HEADER_LEN;
+      wavenc->header_audio_length = 0;
+      wavenc->seekable = TRUE;
       wavenc->sent_header = FALSE;
       /* its true because we haven't writen anything */
       wavenc->finished_properly = TRUE;
@@ -58,9 +58,20 @@ struct _GstWavEnc {
   guint      rate;
   guint      channels;
   
+  /* properties */
+  gboolean   rf64;
+  guint64    header_update_interval;
+
   /* data sizes */
-  guint32    audio_length;
-  guint32    meta_length;
+  guint64    audio_length;
+  guint64    meta_length;
+
+  /* size of the header, with the space reserved for the ds64 chunk */
+  guint      header_length;
+  /* audio_length when the header was last written */
+  guint64    header_audio_length;
+  /* FALSE if downstream can't go back to update the header */
+  gboolean   seekable;
 
   gboolean   sent_header;
   gboolean   finished_properly;
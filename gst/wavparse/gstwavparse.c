@@ -91,11 +91,15 @@ static void gst_wavparse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
 #define DEFAULT_IGNORE_LENGTH FALSE
+#define DEFAULT_BUFFER_DURATION (40 * GST_MSECOND)
+#define DEFAULT_READ_SIZE 0
 
 enum
 {
   PROP_0,
   PROP_IGNORE_LENGTH,
+  PROP_BUFFER_DURATION,
+  PROP_READ_SIZE,
 };
 
 static GstStaticPadTemplate sink_template_factory =
@@ -173,6 +177,35 @@ gst_wavparse_class_init (GstWavParseClass * klass)
           DEFAULT_IGNORE_LENGTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)
       );
 
+  /**
+   * GstWavParse:buffer-duration:
+   *
+   * The duration of the output buffers, at least 4096 bytes are output
+   * per buffer (for formats with a known bitrate).
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (object_class, PROP_BUFFER_DURATION,
+      g_param_spec_uint64 ("buffer-duration", "Buffer duration",
+          "Duration of the output buffers in nanoseconds", GST_MSECOND,
+          G_MAXUINT64, DEFAULT_BUFFER_DURATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWavParse:read-size:
+   *
+   * In pull mode, read this many bytes from upstream at once and output
+   * sample aligned sub-buffers of that block, instead of pulling every
+   * output buffer on its own. 0 pulls every output buffer separately.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (object_class, PROP_READ_SIZE,
+      g_param_spec_uint ("read-size", "Read size",
+          "Bytes to read from upstream at once in pull mode "
+          "(0 = size of an output buffer)", 0, G_MAXINT, DEFAULT_READ_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_wavparse_change_state;
   gstelement_class->send_event = gst_wavparse_send_event;
 
@@ -238,6 +271,10 @@ gst_wavparse_reset (GstWavParse * wav)
   if (wav->start_segment)
     gst_event_unref (wav->start_segment);
   wav->start_segment = NULL;
+  if (wav->block)
+    gst_buffer_unref (wav->block);
+  wav->block = NULL;
+  wav->block_offset = 0;
 }
 
 static void
@@ -256,6 +293,9 @@ gst_wavparse_init (GstWavParse * wavparse)
 {
   gst_wavparse_reset (wavparse);
 
+  wavparse->buffer_duration = DEFAULT_BUFFER_DURATION;
+  wavparse->read_size = DEFAULT_READ_SIZE;
+
   /* sink */
   wavparse->sinkpad =
       gst_pad_new_from_static_template (&sink_template_factory, "sink");
@@ -1592,7 +1632,7 @@ gst_wavparse_stream_headers (GstWavParse * wav)
    * so we do not end up with too many of them */
   /* var abuse */
   upstream_size = 0;
-  gst_wavparse_time_to_bytepos (wav, 40 * GST_MSECOND, &upstream_size);
+  gst_wavparse_time_to_bytepos (wav, wav->buffer_duration, &upstream_size);
   wav->max_buf_size = upstream_size;
   wav->max_buf_size = MAX (wav->max_buf_size, MAX_BUFFER_SIZE);
   if (wav->blockalign > 0)
@@ -1813,6 +1853,49 @@ gst_wavparse_add_src_pad (GstWavParse * wav, GstBuffer * buf)
   }
 }
 
+/* Get @desired bytes at the current offset as a sub-buffer of a block of
+ * read-size bytes, pulling a new block from upstream when the current one
+ * does not cover them. The block starts at a sample boundary like the
+ * offset, so all sub-buffers stay sample aligned. */
+static GstFlowReturn
+gst_wavparse_pull_block (GstWavParse * wav, guint64 desired, GstBuffer ** buf)
+{
+  GstFlowReturn res;
+  gsize avail;
+
+  if (wav->block == NULL || wav->offset < wav->block_offset ||
+      wav->offset + desired >
+      wav->block_offset + gst_buffer_get_size (wav->block)) {
+    GstBuffer *block = NULL;
+    guint64 read_size;
+
+    if (wav->block)
+      gst_buffer_unref (wav->block);
+    wav->block = NULL;
+
+    read_size = wav->read_size;
+    if (wav->blockalign > 0)
+      read_size -= read_size % wav->blockalign;
+    read_size = MAX (read_size, desired);
+
+    GST_LOG_OBJECT (wav, "pulling block of %" G_GUINT64_FORMAT " bytes at %"
+        G_GUINT64_FORMAT, read_size, wav->offset);
+
+    if ((res = gst_pad_pull_range (wav->sinkpad, wav->offset, read_size,
+                &block)) != GST_FLOW_OK)
+      return res;
+
+    wav->block = block;
+    wav->block_offset = wav->offset;
+  }
+
+  avail = gst_buffer_get_size (wav->block) - (wav->offset - wav->block_offset);
+  *buf = gst_buffer_copy_region (wav->block, GST_BUFFER_COPY_MEMORY,
+      wav->offset - wav->block_offset, MIN (avail, desired));
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_wavparse_stream_data (GstWavParse * wav)
 {
@@ -1878,6 +1961,22 @@ iterate_adapter:
     }
 
     buf = gst_adapter_take_buffer (wav->adapter, desired);
+  } else if (wav->read_size > desired) {
+    if ((res = gst_wavparse_pull_block (wav, desired, &buf)) != GST_FLOW_OK)
+      goto pull_error;
+
+    /* we may get a short buffer at the end of the file */
+    if (gst_buffer_get_size (buf) < desired) {
+      gsize size = gst_buffer_get_size (buf);
+
+      GST_LOG_OBJECT (wav, "Got only %" G_GSIZE_FORMAT " bytes of data", size);
+      if (size >= wav->blockalign) {
+        gst_buffer_resize (buf, 0, size - (size % wav->blockalign));
+      } else {
+        gst_buffer_unref (buf);
+        goto found_eos;
+      }
+    }
   } else {
     if ((res = gst_pad_pull_range (wav->sinkpad, wav->offset,
                 desired, &buf)) != GST_FLOW_OK)
@@ -2749,6 +2848,12 @@ gst_wavparse_set_property (GObject * object, guint prop_id,
     case PROP_IGNORE_LENGTH:
       self->ignore_length = g_value_get_boolean (value);
       break;
+    case PROP_BUFFER_DURATION:
+      self->buffer_duration = g_value_get_uint64 (value);
+      break;
+    case PROP_READ_SIZE:
+      self->read_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -2768,6 +2873,12 @@ gst_wavparse_get_property (GObject * object, guint prop_id,
     case PROP_IGNORE_LENGTH:
       g_value_set_boolean (value, self->ignore_length);
       break;
+    case PROP_BUFFER_DURATION:
+      g_value_set_uint64 (value, self->buffer_duration);
+      break;
+    case PROP_READ_SIZE:
+      g_value_set_uint (value, self->read_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -122,6 +122,12 @@ struct _GstWavParse {
   gboolean discont;
 
   gboolean ignore_length;
+  GstClockTime buffer_duration;
+  guint read_size;
+
+  /* pull mode read-ahead block and its offset */
+  GstBuffer *block;
+  guint64 block_offset;
 };
 
 struct _GstWavParseClass {
@@ -133,6 +133,37 @@ gst_y4m_encode_reset (GstY4mEncode * filter)
   filter->negotiated = FALSE;
 }
 
+/* y4m wants the planes back to back without any row padding, work out that
+ * layout and return TRUE when the negotiated one already matches it */
+static gboolean
+gst_y4m_encode_get_packed_info (GstVideoInfo * info, GstVideoInfo * out_info)
+{
+  gboolean packed = TRUE;
+  gsize offset = 0;
+  gint i;
+
+  *out_info = *info;
+
+  for (i = 0; i < GST_VIDEO_INFO_N_PLANES (info); i++) {
+    gint stride;
+
+    stride = GST_VIDEO_INFO_COMP_WIDTH (info, i) *
+        GST_VIDEO_INFO_COMP_PSTRIDE (info, i);
+
+    GST_VIDEO_INFO_PLANE_STRIDE (out_info, i) = stride;
+    GST_VIDEO_INFO_PLANE_OFFSET (out_info, i) = offset;
+
+    if (GST_VIDEO_INFO_PLANE_STRIDE (info, i) != stride ||
+        GST_VIDEO_INFO_PLANE_OFFSET (info, i) != offset)
+      packed = FALSE;
+
+    offset += stride * GST_VIDEO_INFO_COMP_HEIGHT (info, i);
+  }
+  GST_VIDEO_INFO_SIZE (out_info) = offset;
+
+  return packed;
+}
+
 static gboolean
 gst_y4m_encode_setcaps (GstPad * pad, GstCaps * vscaps)
 {
@@ -163,6 +194,11 @@ gst_y4m_encode_setcaps (GstPad * pad, GstCaps * vscaps)
   }
 
   filter->info = info;
+  filter->padded = !gst_y4m_encode_get_packed_info (&info, &filter->out_info);
+
+  GST_DEBUG_OBJECT (filter, "input is %s, frame size %" G_GSIZE_FORMAT,
+      filter->padded ? "padded" : "packed",
+      GST_VIDEO_INFO_SIZE (&filter->out_info));
 
   /* the template caps will do for the src pad, should always accept */
   ret = gst_pad_set_caps (filter->srcpad,
@@ -238,20 +274,83 @@ gst_y4m_encode_get_stream_header (GstY4mEncode * filter, gboolean tff)
 static inline GstBuffer *
 gst_y4m_encode_get_frame_header (GstY4mEncode * filter)
 {
-  gpointer header;
+  static const gchar header[] = "FRAME\n";
   GstBuffer *buf;
-  gsize len;
-
-  header = g_strdup_printf ("FRAME\n");
-  len = strlen (header);
 
   buf = gst_buffer_new ();
   gst_buffer_append_memory (buf,
-      gst_memory_new_wrapped (0, header, len, 0, len, header, g_free));
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) header,
+          sizeof (header) - 1, 0, sizeof (header) - 1, NULL, NULL));
 
   return buf;
 }
 
+/* check if the frame in @buf can be passed on as is */
+static gboolean
+gst_y4m_encode_frame_is_packed (GstY4mEncode * filter, GstBuffer * buf)
+{
+  GstVideoMeta *vmeta;
+  gint i;
+
+  if (gst_buffer_get_size (buf) < GST_VIDEO_INFO_SIZE (&filter->out_info))
+    return FALSE;
+
+  vmeta = gst_buffer_get_video_meta (buf);
+  if (vmeta == NULL)
+    return !filter->padded;
+
+  if (vmeta->n_planes != GST_VIDEO_INFO_N_PLANES (&filter->out_info))
+    return FALSE;
+
+  for (i = 0; i < vmeta->n_planes; i++) {
+    if (vmeta->stride[i] != GST_VIDEO_INFO_PLANE_STRIDE (&filter->out_info, i)
+        || vmeta->offset[i] != GST_VIDEO_INFO_PLANE_OFFSET (&filter->out_info,
+            i))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* copy the planes of @buf into a new buffer without row padding */
+static GstBuffer *
+gst_y4m_encode_repack_frame (GstY4mEncode * filter, GstBuffer * buf)
+{
+  GstVideoFrame frame;
+  GstBuffer *outbuf;
+  GstMapInfo map;
+  gint i, j;
+
+  if (!gst_video_frame_map (&frame, &filter->info, buf, GST_MAP_READ))
+    return NULL;
+
+  outbuf = gst_buffer_new_allocate (NULL,
+      GST_VIDEO_INFO_SIZE (&filter->out_info), NULL);
+  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+    const guint8 *src;
+    guint8 *dest;
+    gint sstride, dstride, h;
+
+    src = GST_VIDEO_FRAME_PLANE_DATA (&frame, i);
+    sstride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i);
+    dest = map.data + GST_VIDEO_INFO_PLANE_OFFSET (&filter->out_info, i);
+    dstride = GST_VIDEO_INFO_PLANE_STRIDE (&filter->out_info, i);
+    h = GST_VIDEO_INFO_COMP_HEIGHT (&filter->out_info, i);
+
+    for (j = 0; j < h; j++) {
+      memcpy (dest, src, dstride);
+      dest += dstride;
+      src += sstride;
+    }
+  }
+
+  gst_buffer_unmap (outbuf, &map);
+  gst_video_frame_unmap (&frame);
+
+  return outbuf;
+}
+
 static GstFlowReturn
 gst_y4m_encode_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -278,7 +377,28 @@ gst_y4m_encode_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   } else {
     outbuf = gst_y4m_encode_get_frame_header (filter);
   }
-  /* join with data, FIXME, strides are all wrong etc */
+  /* join with data, the memory of packed frames is passed on as is and only
+   * frames with row padding or a custom layout need to be copied */
+  if (gst_y4m_encode_frame_is_packed (filter, buf)) {
+    gsize size = GST_VIDEO_INFO_SIZE (&filter->out_info);
+
+    if (gst_buffer_get_size (buf) > size) {
+      GstBuffer *sub;
+
+      sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, 0, size);
+      gst_buffer_unref (buf);
+      buf = sub;
+    }
+  } else {
+    GstBuffer *packed;
+
+    GST_LOG_OBJECT (filter, "repacking frame");
+    packed = gst_y4m_encode_repack_frame (filter, buf);
+    gst_buffer_unref (buf);
+    if (packed == NULL)
+      goto map_failed;
+    buf = packed;
+  }
   outbuf = gst_buffer_append (outbuf, buf);
   /* decorate */
   outbuf = gst_buffer_make_writable (outbuf);
@@ -295,6 +415,13 @@ not_negotiated:
     gst_buffer_unref (buf);
     return GST_FLOW_NOT_NEGOTIATED;
   }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (filter, STREAM, FORMAT, (NULL),
+        ("failed to map input frame"));
+    gst_buffer_unref (outbuf);
+    return GST_FLOW_ERROR;
+  }
 }
 
 static GstStateChangeReturn
@@ -51,6 +51,10 @@ struct _GstY4mEncode {
   GstVideoInfo info;
   gboolean negotiated;
 
+  /* packed layout written to the stream */
+  GstVideoInfo out_info;
+  gboolean padded;
+
   const gchar *colorspace;
   /* state information */
   gboolean header;
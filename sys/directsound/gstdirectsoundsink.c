@@ -211,6 +211,8 @@ gst_directsound_sink_init (GstDirectSoundSink * dsoundsink)
   dsoundsink->volume = 100;
   g_mutex_init (&dsoundsink->dsound_lock);
   dsoundsink->first_buffer_after_reset = FALSE;
+  dsoundsink->notify_event = NULL;
+  dsoundsink->segment_time = 1;
 }
 
 static void
@@ -420,6 +422,7 @@ gst_directsound_sink_prepare (GstAudioSink * asink,
   HRESULT hRes;
   DSBUFFERDESC descSecondary;
   WAVEFORMATEX wfx;
+  LPDIRECTSOUNDNOTIFY pDSNotify = NULL;
 
   dsoundsink = GST_DIRECTSOUND_SINK (asink);
 
@@ -481,7 +484,8 @@ gst_directsound_sink_prepare (GstAudioSink * asink,
   /* create a secondary directsound buffer */
   memset (&descSecondary, 0, sizeof (DSBUFFERDESC));
   descSecondary.dwSize = sizeof (DSBUFFERDESC);
-  descSecondary.dwFlags = DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_GLOBALFOCUS;
+  descSecondary.dwFlags = DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_GLOBALFOCUS |
+      DSBCAPS_CTRLPOSITIONNOTIFY;
   if (!gst_directsound_sink_is_spdif_format (spec))
     descSecondary.dwFlags |= DSBCAPS_CTRLVOLUME;
 
@@ -499,6 +503,36 @@ gst_directsound_sink_prepare (GstAudioSink * asink,
 
   gst_directsound_sink_set_volume (dsoundsink, dsoundsink->volume, FALSE);
 
+  /* get notified at the start of every segment so that write can wait for
+   * the device to free a segment instead of polling the play cursor */
+  dsoundsink->segment_time = MAX (1,
+      gst_util_uint64_scale_int (spec->segsize, 1000, wfx.nAvgBytesPerSec));
+  dsoundsink->notify_event = CreateEvent (NULL, FALSE, FALSE, NULL);
+
+  hRes = IDirectSoundBuffer_QueryInterface (dsoundsink->pDSBSecondary,
+      &IID_IDirectSoundNotify, (LPVOID *) & pDSNotify);
+  if (SUCCEEDED (hRes) && dsoundsink->notify_event) {
+    DSBPOSITIONNOTIFY *positions;
+    gint i;
+
+    positions = g_new (DSBPOSITIONNOTIFY, spec->segtotal);
+    for (i = 0; i < spec->segtotal; i++) {
+      positions[i].dwOffset = i * spec->segsize;
+      positions[i].hEventNotify = dsoundsink->notify_event;
+    }
+    hRes = IDirectSoundNotify_SetNotificationPositions (pDSNotify,
+        spec->segtotal, positions);
+    g_free (positions);
+  }
+  if (pDSNotify)
+    IDirectSoundNotify_Release (pDSNotify);
+
+  /* without notifications the wait times out after each segment */
+  if (FAILED (hRes)) {
+    GST_WARNING_OBJECT (dsoundsink, "no position notifications: %s",
+        DXGetErrorString9 (hRes));
+  }
+
   return TRUE;
 }
 
@@ -515,6 +549,11 @@ gst_directsound_sink_unprepare (GstAudioSink * asink)
     dsoundsink->pDSBSecondary = NULL;
   }
 
+  if (dsoundsink->notify_event) {
+    CloseHandle (dsoundsink->notify_event);
+    dsoundsink->notify_event = NULL;
+  }
+
   return TRUE;
 }
 
@@ -570,7 +609,12 @@ gst_directsound_sink_write (GstAudioSink * asink, gpointer data, guint length)
           dwCurrentPlayCursor - dsoundsink->current_circular_offset;
 
     if (length >= dwFreeBufferSize) {
-      Sleep (100);
+      /* wait until the play cursor crosses into the next segment */
+      if (dsoundsink->notify_event)
+        WaitForSingleObject (dsoundsink->notify_event,
+            dsoundsink->segment_time);
+      else
+        Sleep (dsoundsink->segment_time);
       hRes = IDirectSoundBuffer_GetCurrentPosition (dsoundsink->pDSBSecondary,
           &dwCurrentPlayCursor, NULL);
 
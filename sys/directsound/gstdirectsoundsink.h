@@ -81,6 +81,11 @@ struct _GstDirectSoundSink
 
   gboolean first_buffer_after_reset;
 
+  /* signalled when playback crosses a segment boundary */
+  HANDLE notify_event;
+  /* duration of a segment in ms, the longest write waits for free space */
+  DWORD segment_time;
+
   GstAudioRingBufferFormatType type;
 };
 
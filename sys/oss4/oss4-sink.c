@@ -47,7 +47,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
@@ -84,11 +86,14 @@ static gint gst_oss4_sink_write (GstAudioSink * asink, gpointer data,
     guint length);
 static guint gst_oss4_sink_delay (GstAudioSink * asink);
 static void gst_oss4_sink_reset (GstAudioSink * asink);
+static gboolean gst_oss4_sink_map_dma (GstOss4Sink * oss);
+static void gst_oss4_sink_unmap_dma (GstOss4Sink * oss);
 
 #define DEFAULT_DEVICE      NULL
 #define DEFAULT_DEVICE_NAME NULL
 #define DEFAULT_MUTE        FALSE
 #define DEFAULT_VOLUME      1.0
+#define DEFAULT_MMAP        FALSE
 #define MAX_VOLUME          10.0
 
 enum
@@ -98,6 +103,7 @@ enum
   PROP_DEVICE_NAME,
   PROP_VOLUME,
   PROP_MUTE,
+  PROP_MMAP,
   PROP_LAST
 };
 
@@ -155,6 +161,23 @@ gst_oss4_sink_class_init (GstOss4SinkClass * klass)
           "Mute state of this stream", DEFAULT_MUTE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstOss4Sink:mmap:
+   *
+   * Copy the samples straight into the memory mapped DMA buffer of the
+   * device instead of writing them to the device. This avoids a copy in the
+   * driver and a system call per segment. Devices that can't map their
+   * buffer fall back to writing. Takes effect the next time the device is
+   * prepared.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_MMAP,
+      g_param_spec_boolean ("mmap", "Memory map",
+          "Write into the memory mapped DMA buffer of the device", DEFAULT_MMAP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   basesink_class->get_caps = GST_DEBUG_FUNCPTR (gst_oss4_sink_getcaps);
 
   audiosink_class->open = GST_DEBUG_FUNCPTR (gst_oss4_sink_open_func);
@@ -189,6 +212,8 @@ gst_oss4_sink_init (GstOss4Sink * osssink)
   osssink->probed_caps = NULL;
   osssink->device_name = NULL;
   osssink->mute_volume = 100 | (100 << 8);
+  osssink->mmap = DEFAULT_MMAP;
+  osssink->dma = NULL;
 }
 
 static void
@@ -322,6 +347,11 @@ gst_oss4_sink_set_property (GObject * object, guint prop_id,
     case PROP_MUTE:
       gst_oss4_sink_set_mute (oss, g_value_get_boolean (value));
       break;
+    case PROP_MMAP:
+      GST_OBJECT_LOCK (oss);
+      oss->mmap = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (oss);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -366,6 +396,11 @@ gst_oss4_sink_get_property (GObject * object, guint prop_id,
     case PROP_MUTE:
       g_value_set_boolean (value, gst_oss4_sink_get_mute (oss));
       break;
+    case PROP_MMAP:
+      GST_OBJECT_LOCK (oss);
+      g_value_set_boolean (value, oss->mmap);
+      GST_OBJECT_UNLOCK (oss);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -557,6 +592,8 @@ gst_oss4_sink_close (GstAudioSink * asink)
 {
   GstOss4Sink *oss = GST_OSS4_SINK (asink);
 
+  gst_oss4_sink_unmap_dma (oss);
+
   if (oss->fd != -1) {
     GST_DEBUG_OBJECT (oss, "closing device");
     close (oss->fd);
@@ -584,6 +621,7 @@ static gboolean
 gst_oss4_sink_prepare (GstAudioSink * asink, GstAudioRingBufferSpec * spec)
 {
   GstOss4Sink *oss;
+  gboolean use_mmap;
 
   oss = GST_OSS4_SINK (asink);
 
@@ -594,6 +632,14 @@ gst_oss4_sink_prepare (GstAudioSink * asink, GstAudioRingBufferSpec * spec)
   }
 
   oss->bytes_per_sample = GST_AUDIO_INFO_BPF (&spec->info);
+  oss->finfo = spec->info.finfo;
+
+  GST_OBJECT_LOCK (oss);
+  use_mmap = oss->mmap;
+  GST_OBJECT_UNLOCK (oss);
+
+  if (use_mmap && !gst_oss4_sink_map_dma (oss))
+    GST_INFO_OBJECT (oss, "can't map the DMA buffer, writing to the device");
 
   return TRUE;
 }
@@ -625,6 +671,171 @@ couldnt_reopen:
   }
 }
 
+/* map the DMA buffer of the device, the device is started with a buffer
+ * full of silence and then plays it in a loop while we stay ahead of it */
+static gboolean
+gst_oss4_sink_map_dma (GstOss4Sink * oss)
+{
+  struct audio_buf_info info = { 0, };
+  gint caps = 0, trig;
+  gpointer dma;
+  gint size;
+
+  if (ioctl (oss->fd, SNDCTL_DSP_GETCAPS, &caps) == -1 ||
+      (caps & (PCM_CAP_MMAP | PCM_CAP_TRIGGER)) !=
+      (PCM_CAP_MMAP | PCM_CAP_TRIGGER))
+    goto no_mmap;
+
+  if (ioctl (oss->fd, SNDCTL_DSP_GETOSPACE, &info) == -1)
+    goto no_space;
+
+  size = info.fragstotal * info.fragsize;
+  if (size <= 0)
+    goto no_space;
+
+  dma = mmap (NULL, size, PROT_WRITE, MAP_SHARED, oss->fd, 0);
+  if (dma == MAP_FAILED)
+    goto mmap_failed;
+
+  gst_audio_format_fill_silence (oss->finfo, dma, size);
+
+  trig = 0;
+  if (ioctl (oss->fd, SNDCTL_DSP_SETTRIGGER, &trig) == -1)
+    goto trigger_failed;
+  trig = PCM_ENABLE_OUTPUT;
+  if (ioctl (oss->fd, SNDCTL_DSP_SETTRIGGER, &trig) == -1)
+    goto trigger_failed;
+
+  oss->dma = dma;
+  oss->dma_size = size;
+  oss->dma_written = 0;
+  oss->dma_played = 0;
+  oss->dma_last_bytes = 0;
+
+  GST_DEBUG_OBJECT (oss, "mapped %d bytes of DMA buffer", size);
+
+  return TRUE;
+
+  /* ERRORS */
+no_mmap:
+  {
+    GST_DEBUG_OBJECT (oss, "device can't mmap, caps: 0x%08x", caps);
+    return FALSE;
+  }
+no_space:
+  {
+    GST_DEBUG_OBJECT (oss, "GETOSPACE failed: %s", g_strerror (errno));
+    return FALSE;
+  }
+mmap_failed:
+  {
+    GST_DEBUG_OBJECT (oss, "mmap failed: %s", g_strerror (errno));
+    return FALSE;
+  }
+trigger_failed:
+  {
+    GST_DEBUG_OBJECT (oss, "SETTRIGGER failed: %s", g_strerror (errno));
+    munmap (dma, size);
+    return FALSE;
+  }
+}
+
+static void
+gst_oss4_sink_unmap_dma (GstOss4Sink * oss)
+{
+  if (oss->dma == NULL)
+    return;
+
+  munmap (oss->dma, oss->dma_size);
+  oss->dma = NULL;
+  oss->dma_size = 0;
+}
+
+/* update the number of bytes the device played, count_info.bytes is only
+ * a 32 bit counter so we accumulate the differences */
+static gboolean
+gst_oss4_sink_update_dma_played (GstOss4Sink * oss)
+{
+  count_info ci = { 0, };
+
+  if (ioctl (oss->fd, SNDCTL_DSP_GETOPTR, &ci) == -1)
+    return FALSE;
+
+  oss->dma_played += (guint) (ci.bytes - oss->dma_last_bytes);
+  oss->dma_last_bytes = ci.bytes;
+
+  /* the device went round the buffer past our data and is playing old
+   * samples again, continue right behind the DMA pointer */
+  if (oss->dma_played > oss->dma_written) {
+    GST_DEBUG_OBJECT (oss, "underrun of %" G_GUINT64_FORMAT " bytes",
+        oss->dma_played - oss->dma_written);
+    oss->dma_written = oss->dma_played;
+  }
+
+  return TRUE;
+}
+
+static gint
+gst_oss4_sink_write_dma (GstOss4Sink * oss, const guint8 * data, guint length)
+{
+  guint written = 0;
+
+  while (written < length) {
+    guint avail, offset, n;
+
+    if (!gst_oss4_sink_update_dma_played (oss))
+      goto getoptr_failed;
+
+    avail = oss->dma_size - (guint) (oss->dma_written - oss->dma_played);
+    if (avail == 0) {
+      struct pollfd pfd = { oss->fd, POLLOUT, 0 };
+
+      /* wait for the device to play a fragment */
+      if (poll (&pfd, 1, 100) < 0 && errno != EINTR)
+        goto poll_failed;
+      continue;
+    }
+
+    offset = oss->dma_written % oss->dma_size;
+    n = MIN (length - written, avail);
+    n = MIN (n, oss->dma_size - offset);
+
+    memcpy (oss->dma + offset, data + written, n);
+    oss->dma_written += n;
+    written += n;
+  }
+
+  /* keep the device from looping over stale samples when we run late, the
+   * buffer behind our data is silence until we write again */
+  {
+    guint offset, avail, n;
+
+    avail = oss->dma_size - (guint) (oss->dma_written - oss->dma_played);
+    offset = oss->dma_written % oss->dma_size;
+    n = MIN (avail, oss->dma_size - offset);
+    gst_audio_format_fill_silence (oss->finfo, oss->dma + offset, n);
+    gst_audio_format_fill_silence (oss->finfo, oss->dma, avail - n);
+  }
+
+  GST_LOG_OBJECT (oss, "copied %u bytes into the DMA buffer", length);
+
+  return length;
+
+  /* ERRORS */
+getoptr_failed:
+  {
+    GST_ELEMENT_ERROR (oss, RESOURCE, WRITE, (_("Audio playback error.")),
+        ("GETOPTR: %s (device: %s)", g_strerror (errno), oss->open_device));
+    return -1;
+  }
+poll_failed:
+  {
+    GST_ELEMENT_ERROR (oss, RESOURCE, WRITE, (_("Audio playback error.")),
+        ("poll: %s (device: %s)", g_strerror (errno), oss->open_device));
+    return -1;
+  }
+}
+
 static gint
 gst_oss4_sink_write (GstAudioSink * asink, gpointer data, guint length)
 {
@@ -633,6 +844,9 @@ gst_oss4_sink_write (GstAudioSink * asink, gpointer data, guint length)
 
   oss = GST_OSS4_SINK_CAST (asink);
 
+  if (oss->dma != NULL)
+    return gst_oss4_sink_write_dma (oss, data, length);
+
   n = write (oss->fd, data, length);
   GST_LOG_OBJECT (asink, "wrote %d/%d samples, %d bytes",
       n / oss->bytes_per_sample, length / oss->bytes_per_sample, n);
@@ -668,6 +882,13 @@ gst_oss4_sink_delay (GstAudioSink * asink)
 
   oss = GST_OSS4_SINK_CAST (asink);
 
+  /* in mmap mode GETODELAY doesn't know how far ahead we wrote */
+  if (oss->dma != NULL) {
+    if (!gst_oss4_sink_update_dma_played (oss))
+      return 0;
+    return (oss->dma_written - oss->dma_played) / oss->bytes_per_sample;
+  }
+
   GST_OBJECT_LOCK (oss);
   if (ioctl (oss->fd, SNDCTL_DSP_GETODELAY, &delay) < 0 || delay < 0) {
     GST_LOG_OBJECT (oss, "GETODELAY failed");
@@ -683,7 +904,12 @@ gst_oss4_sink_delay (GstAudioSink * asink)
 static void
 gst_oss4_sink_reset (GstAudioSink * asink)
 {
+  GstOss4Sink *oss = GST_OSS4_SINK_CAST (asink);
+
   /* There's nothing we can do here really: OSS can't handle access to the
    * same device/fd from multiple threads and might deadlock or blow up in
-   * other ways if we try an ioctl SNDCTL_DSP_HALT or similar */
+   * other ways if we try an ioctl SNDCTL_DSP_HALT or similar. In mmap mode
+   * the device keeps looping over its buffer though, so silence it */
+  if (oss->dma != NULL)
+    gst_audio_format_fill_silence (oss->finfo, oss->dma, oss->dma_size);
 }
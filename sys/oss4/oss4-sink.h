@@ -46,6 +46,15 @@ struct _GstOss4Sink {
   gint          bytes_per_sample;
   gint          mute_volume;
 
+  /* mmap mode, dma is NULL when writing to the fd */
+  gboolean      mmap;
+  guint8      * dma;
+  gint          dma_size;
+  guint64       dma_written;        /* total bytes copied to dma */
+  guint64       dma_played;         /* total bytes played by the device */
+  guint         dma_last_bytes;     /* last count_info.bytes */
+  const GstAudioFormatInfo * finfo;
+
   GstCaps     * probed_caps;
 };
 
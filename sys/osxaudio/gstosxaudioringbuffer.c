@@ -222,6 +222,9 @@ gst_osx_audio_ring_buffer_acquire (GstAudioRingBuffer * buf,
         G_USEC_PER_SEC) * GST_AUDIO_INFO_BPF (&spec->info);
     spec->segtotal = spec->buffer_time / spec->latency_time;
     is_passthrough = FALSE;
+    /* let the IO proc run once per segment if the device allows it */
+    osxbuf->core_audio->buffer_frames =
+        spec->segsize / GST_AUDIO_INFO_BPF (&spec->info);
   }
 
   GST_DEBUG_OBJECT (osxbuf, "Format: " CORE_AUDIO_FORMAT,
@@ -49,6 +49,7 @@ gst_core_audio_init (GstCoreAudio * core_audio)
   core_audio->device_id = kAudioDeviceUnknown;
   core_audio->is_src = FALSE;
   core_audio->audiounit = NULL;
+  core_audio->buffer_frames = 0;
 #ifndef HAVE_IOS
   core_audio->hog_pid = -1;
   core_audio->disabled_mixing = FALSE;
@@ -84,6 +84,8 @@ struct _GstCoreAudio
   gint stream_idx;
   gboolean io_proc_active;
   gboolean io_proc_needs_deactivation;
+  /* requested size of the blocks the IO proc handles, 0 for the default */
+  guint32 buffer_frames;
 
   /* For LPCM in/out */
   AudioUnit audiounit;
@@ -156,6 +156,30 @@ _audio_device_get_latency (AudioDeviceID device_id)
   return latency;
 }
 
+static inline gboolean
+_audio_device_get_buffer_frame_size_range (AudioDeviceID device_id,
+    AudioValueRange * range)
+{
+  OSStatus status = noErr;
+  UInt32 propertySize = sizeof (*range);
+
+  AudioObjectPropertyAddress audioDeviceBufferFrameSizeRangeAddress = {
+    kAudioDevicePropertyBufferFrameSizeRange,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+  };
+
+  status = AudioObjectGetPropertyData (device_id,
+      &audioDeviceBufferFrameSizeRangeAddress, 0, NULL, &propertySize, range);
+  if (status != noErr) {
+    GST_WARNING ("failed to get buffer frame size range: %"
+        GST_FOURCC_FORMAT, GST_FOURCC_ARGS (status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 static inline pid_t
 _audio_device_get_hog (AudioDeviceID device_id)
 {
@@ -1110,6 +1134,49 @@ gst_core_audio_get_samples_and_latency_impl (GstCoreAudio * core_audio,
   return TRUE;
 }
 
+/* Lower the number of frames the IO proc is called for to the requested
+ * segment size, so that a small latency-time also gives a small hardware
+ * buffer. The size is a setting of the device for this process only, it is
+ * never raised above what the device already uses. */
+static void
+gst_core_audio_set_buffer_frame_size (GstCoreAudio * core_audio)
+{
+  AudioValueRange range;
+  UInt32 frames, current;
+  UInt32 propertySize = sizeof (current);
+  OSStatus status;
+
+  if (core_audio->buffer_frames == 0)
+    return;
+
+  status = AudioUnitGetProperty (core_audio->audiounit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, /* N/A for global */
+      &current, &propertySize);
+  if (status) {
+    GST_WARNING_OBJECT (core_audio->osxbuf, "Failed to get frame size: %"
+        GST_FOURCC_FORMAT, GST_FOURCC_ARGS (status));
+    return;
+  }
+
+  frames = core_audio->buffer_frames;
+  if (_audio_device_get_buffer_frame_size_range (core_audio->device_id,
+          &range))
+    frames = CLAMP (frames, (UInt32) range.mMinimum, (UInt32) range.mMaximum);
+
+  if (frames >= current)
+    return;
+
+  status = AudioUnitSetProperty (core_audio->audiounit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0,      /* N/A for global */
+      &frames, sizeof (frames));
+  if (status) {
+    GST_WARNING_OBJECT (core_audio->osxbuf, "Failed to set frame size to %u: %"
+        GST_FOURCC_FORMAT, (guint) frames, GST_FOURCC_ARGS (status));
+    return;
+  }
+
+  GST_DEBUG_OBJECT (core_audio, "IO buffer size changed from %u to %u frames",
+      (guint) current, (guint) frames);
+}
+
 static gboolean
 gst_core_audio_initialize_impl (GstCoreAudio * core_audio,
     AudioStreamBasicDescription format, GstCaps * caps,
@@ -1137,6 +1204,8 @@ gst_core_audio_initialize_impl (GstCoreAudio * core_audio,
     if (!gst_core_audio_bind_device (core_audio))
       goto done;
 
+    gst_core_audio_set_buffer_frame_size (core_audio);
+
     if (core_audio->is_src) {
       propertySize = sizeof (*frame_size);
       status = AudioUnitGetProperty (core_audio->audiounit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0,     /* N/A for global */
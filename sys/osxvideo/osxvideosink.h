@@ -83,6 +83,12 @@ struct _GstOSXVideoSink {
   NSView *superview;
   gboolean keep_par;
   gboolean embed;
+
+  /* the frame waiting to be presented by the main thread, a newer frame
+   * replaces it when it wasn't presented in time */
+  GMutex present_lock;
+  GstBuffer *present_buf;
+  guint64 frames_dropped;
 };
 
 struct _GstOSXVideoSinkClass {
@@ -127,6 +133,7 @@ GType gst_osx_video_sink_get_type(void);
 -(void) resize;
 -(void) destroy;
 -(void) showFrame: (GstBufferObject*) buf;
+-(void) presentFrame;
 -(void) setView: (NSView*) view;
 + (BOOL) isMainThread;
 -(void) nsAppThread;
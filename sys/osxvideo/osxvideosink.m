@@ -417,6 +417,10 @@ gst_osx_video_sink_change_state (GstElement * element,
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_osx_video_sink_clear_present (osxvideosink);
+      GST_DEBUG_OBJECT (osxvideosink, "%" G_GUINT64_FORMAT " frames dropped",
+          osxvideosink->frames_dropped);
+      osxvideosink->frames_dropped = 0;
       GST_VIDEO_SINK_WIDTH (osxvideosink) = 0;
       GST_VIDEO_SINK_HEIGHT (osxvideosink) = 0;
       gst_osx_video_sink_osxwindow_destroy (osxvideosink);
@@ -431,20 +435,44 @@ done:
   return ret;
 }
 
+static void
+gst_osx_video_sink_clear_present (GstOSXVideoSink * osxvideosink)
+{
+  g_mutex_lock (&osxvideosink->present_lock);
+  gst_buffer_replace (&osxvideosink->present_buf, NULL);
+  g_mutex_unlock (&osxvideosink->present_lock);
+}
+
+/* The frame is only handed to the main thread, which draws it when it gets
+ * around to it. The drawing waits for the vertical retrace, so when the main
+ * thread is slower than the stream only the most recent frame is kept and
+ * the streaming thread never blocks on the compositor. */
 static GstFlowReturn
 gst_osx_video_sink_show_frame (GstBaseSink * bsink, GstBuffer * buf)
 {
   GstOSXVideoSink *osxvideosink;
-  GstBufferObject* bufferobject;
+  gboolean schedule;
   NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
 
   osxvideosink = GST_OSX_VIDEO_SINK (bsink);
 
   GST_DEBUG ("show_frame");
-  bufferobject = [[GstBufferObject alloc] initWithBuffer:buf];
-  gst_osx_video_sink_call_from_main_thread(osxvideosink,
-      osxvideosink->osxvideosinkobject,
-      @selector(showFrame:), bufferobject, NO);
+  g_mutex_lock (&osxvideosink->present_lock);
+  schedule = osxvideosink->present_buf == NULL;
+  if (!schedule) {
+    osxvideosink->frames_dropped++;
+    GST_DEBUG_OBJECT (osxvideosink, "dropping frame %p that was not "
+        "presented in time, %" G_GUINT64_FORMAT " dropped",
+        osxvideosink->present_buf, osxvideosink->frames_dropped);
+  }
+  gst_buffer_replace (&osxvideosink->present_buf, buf);
+  g_mutex_unlock (&osxvideosink->present_lock);
+
+  /* a present call is already on its way otherwise */
+  if (schedule)
+    gst_osx_video_sink_call_from_main_thread(osxvideosink,
+        osxvideosink->osxvideosinkobject,
+        @selector(presentFrame), nil, NO);
   [pool release];
   return GST_FLOW_OK;
 }
@@ -519,6 +547,9 @@ gst_osx_video_sink_init (GstOSXVideoSink * sink)
   sink->superview = NULL;
   sink->osxvideosinkobject = [[GstOSXVideoSinkObject alloc] initWithSink:sink];
   sink->keep_par = FALSE;
+  g_mutex_init (&sink->present_lock);
+  sink->present_buf = NULL;
+  sink->frames_dropped = 0;
 }
 
 static void
@@ -545,6 +576,9 @@ gst_osx_video_sink_finalize (GObject *object)
   if (osxvideosink->osxvideosinkobject)
     [(GstOSXVideoSinkObject*)(osxvideosink->osxvideosinkobject) release];
 
+  gst_osx_video_sink_clear_present (osxvideosink);
+  g_mutex_clear (&osxvideosink->present_lock);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -920,6 +954,27 @@ no_texture_buffer:
   goto out;
 }
 
+- (void) presentFrame
+{
+  GstBufferObject *bufferobject;
+  GstBuffer *buf;
+
+  /* take the most recent frame, this call is scheduled again for the next
+   * one */
+  g_mutex_lock (&osxvideosink->present_lock);
+  buf = osxvideosink->present_buf;
+  osxvideosink->present_buf = NULL;
+  g_mutex_unlock (&osxvideosink->present_lock);
+
+  /* flushed while we were waiting for the main thread */
+  if (buf == NULL)
+    return;
+
+  bufferobject = [[GstBufferObject alloc] initWithBuffer:buf];
+  gst_buffer_unref (buf);
+  [self showFrame:bufferobject];
+}
+
 -(void) destroy
 {
   NSAutoreleasePool *pool;
@@ -43,6 +43,7 @@
 #include "gst/allocators/gstdmabuf.h"
 
 #include <gstv4l2bufferpool.h>
+#include "gstv4l2capturegroup.h"
 
 #include "v4l2_calls.h"
 #include "gst/gst-i18n-plugin.h"
@@ -101,6 +102,52 @@ G_DEFINE_TYPE (GstV4l2BufferPool, gst_v4l2_buffer_pool, GST_TYPE_BUFFER_POOL);
 static void gst_v4l2_buffer_pool_release_buffer (GstBufferPool * bpool,
     GstBuffer * buffer);
 
+/* the modes that queue the memory of upstream buffers */
+#define GST_V4L2_IS_IMPORT_MODE(obj) ((obj)->mode == GST_V4L2_IO_USERPTR || \
+    (obj)->mode == GST_V4L2_IO_DMABUF_IMPORT)
+
+/* the memory type of the v4l2 buffers, exported dmabuf buffers are MMAP
+ * buffers for the driver */
+static enum v4l2_memory
+gst_v4l2_buffer_pool_memory (GstV4l2BufferPool * pool)
+{
+  switch (pool->obj->mode) {
+    case GST_V4L2_IO_USERPTR:
+      return V4L2_MEMORY_USERPTR;
+#if HAVE_DECL_V4L2_MEMORY_DMABUF
+    case GST_V4L2_IO_DMABUF_IMPORT:
+      return V4L2_MEMORY_DMABUF;
+#endif
+    default:
+      return V4L2_MEMORY_MMAP;
+  }
+}
+
+/* drop the upstream buffer that is attached to @slot */
+static void
+gst_v4l2_buffer_pool_release_import (GstV4l2BufferPool * pool,
+    GstBuffer * slot)
+{
+  GstV4l2Meta *meta;
+  guint i;
+
+  meta = GST_V4L2_META_GET (slot);
+  g_assert (meta != NULL);
+
+  if (meta->imported == NULL)
+    return;
+
+  GST_LOG_OBJECT (pool, "release imported buffer %p from slot %u",
+      meta->imported, meta->vbuffer.index);
+
+  for (i = 0; i < meta->n_import_maps; i++)
+    gst_memory_unmap (meta->import_map[i].memory, &meta->import_map[i]);
+  meta->n_import_maps = 0;
+
+  gst_buffer_unref (meta->imported);
+  meta->imported = NULL;
+}
+
 static void
 gst_v4l2_buffer_pool_free_buffer (GstBufferPool * bpool, GstBuffer * buffer)
 {
@@ -111,8 +158,25 @@ gst_v4l2_buffer_pool_free_buffer (GstBufferPool * bpool, GstBuffer * buffer)
 
   switch (obj->mode) {
     case GST_V4L2_IO_RW:
+      break;
     case GST_V4L2_IO_DMABUF:
+    {
+      GstV4l2Meta *meta;
+      gint i;
+
+      meta = GST_V4L2_META_GET (buffer);
+      g_assert (meta != NULL);
+
+      /* the last ref on the exported memory closes the dmabuf fd */
+      for (i = 0; i < meta->n_planes; i++) {
+        if (meta->dmamem[i])
+          gst_memory_unref (meta->dmamem[i]);
+        meta->dmamem[i] = NULL;
+      }
+
+      pool->buffers[meta->vbuffer.index] = NULL;
       break;
+    }
     case GST_V4L2_IO_MMAP:
     {
       GstV4l2Meta *meta;
@@ -136,6 +200,17 @@ gst_v4l2_buffer_pool_free_buffer (GstBufferPool * bpool, GstBuffer * buffer)
       break;
     }
     case GST_V4L2_IO_USERPTR:
+    case GST_V4L2_IO_DMABUF_IMPORT:
+    {
+      GstV4l2Meta *meta;
+
+      meta = GST_V4L2_META_GET (buffer);
+      g_assert (meta != NULL);
+
+      gst_v4l2_buffer_pool_release_import (pool, buffer);
+      pool->buffers[meta->vbuffer.index] = NULL;
+      break;
+    }
     default:
       g_assert_not_reached ();
       break;
@@ -274,24 +349,22 @@ gst_v4l2_buffer_pool_alloc_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
         expbuf.index = meta->vbuffer.index;
         expbuf.flags = O_CLOEXEC;
 
+        /* the buffers stay MMAP buffers for the driver, we only hand out
+         * a dmabuf fd of each plane. The meta keeps a ref on the exported
+         * memory so that it can be put back in the buffer after a dequeue */
         for (i = 0; i < meta->n_planes; i++) {
           expbuf.plane = i;
 
           if (v4l2_ioctl (pool->video_fd, VIDIOC_EXPBUF, &expbuf) < 0)
             goto expbuf_failed;
 
-          gst_buffer_append_memory (newbuf,
-              gst_dmabuf_allocator_alloc (pool->allocator, expbuf.fd,
-                  meta->vplanes[i].length));
-        }
-
-        meta->vbuffer.memory = V4L2_MEMORY_DMABUF;
+          GST_LOG_OBJECT (pool, "  exported plane %d as fd %d", i, expbuf.fd);
 
-        /* in non-MPLANE mode our meta is not automatically updated
-         * because the plane is emulated (not referenced by
-         * meta->vbuffer) */
-        if (!V4L2_TYPE_IS_MULTIPLANAR (obj->type))
-          meta->vplanes[0].m.fd = meta->vbuffer.m.fd;
+          meta->mem[i] = NULL;
+          meta->dmamem[i] = gst_dmabuf_allocator_alloc (pool->allocator,
+              expbuf.fd, meta->vplanes[i].length);
+          gst_buffer_append_memory (newbuf, gst_memory_ref (meta->dmamem[i]));
+        }
       }
 #endif
       /* add metadata to raw video buffers */
@@ -355,6 +428,38 @@ gst_v4l2_buffer_pool_alloc_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
       break;
     }
     case GST_V4L2_IO_USERPTR:
+    case GST_V4L2_IO_DMABUF_IMPORT:
+    {
+      /* an empty slot, the memory comes from upstream when it is queued */
+      newbuf = gst_buffer_new ();
+      meta = GST_V4L2_META_ADD (newbuf);
+
+      index = pool->num_allocated;
+
+      GST_LOG_OBJECT (pool, "creating slot %u, %p", index, newbuf);
+
+      memset (&meta->vbuffer, 0x0, sizeof (struct v4l2_buffer));
+      memset (meta->vplanes, 0x0, sizeof (meta->vplanes));
+      meta->vbuffer.index = index;
+      meta->vbuffer.type = obj->type;
+      meta->vbuffer.memory = gst_v4l2_buffer_pool_memory (pool);
+
+      meta->n_planes = obj->n_v4l2_planes;
+      if (V4L2_TYPE_IS_MULTIPLANAR (obj->type)) {
+        meta->vbuffer.length = obj->n_v4l2_planes;
+        meta->vbuffer.m.planes = meta->vplanes;
+      }
+
+      for (i = 0; i < meta->n_planes; i++) {
+        meta->mem[i] = NULL;
+        meta->dmamem[i] = NULL;
+        meta->import_key[i] = 0;
+      }
+      meta->imported = NULL;
+      meta->import_seq = 0;
+      meta->n_import_maps = 0;
+      break;
+    }
     default:
       newbuf = NULL;
       g_assert_not_reached ();
@@ -409,6 +514,8 @@ expbuf_failed:
     gint errnosave = errno;
 
     GST_WARNING ("Failed EXPBUF: %s", g_strerror (errnosave));
+    while (--i >= 0)
+      gst_memory_unref (meta->dmamem[i]);
     gst_buffer_unref (newbuf);
     errno = errnosave;
     return GST_FLOW_ERROR;
@@ -473,22 +580,25 @@ gst_v4l2_buffer_pool_set_config (GstBufferPool * bpool, GstStructure * config)
       break;
     case GST_V4L2_IO_DMABUF:
     case GST_V4L2_IO_MMAP:
+    case GST_V4L2_IO_USERPTR:
+    case GST_V4L2_IO_DMABUF_IMPORT:
     {
-      /* request a reasonable number of buffers when no max specified. We will
-       * copy when we run out of buffers */
+      /* request a reasonable number of buffers when no max specified, enough
+       * for the buffers downstream wants to keep and our copy threshold. We
+       * will copy when we run out of buffers */
       if (max_buffers == 0)
-        num_buffers = 4;
+        num_buffers = MAX (4, min_buffers + 2);
       else
         num_buffers = max_buffers;
 
       /* first, lets request buffers, and see how many we can get: */
-      GST_DEBUG_OBJECT (pool, "starting, requesting %d MMAP buffers",
-          num_buffers);
+      GST_DEBUG_OBJECT (pool, "starting, requesting %d buffers of memory %d",
+          num_buffers, gst_v4l2_buffer_pool_memory (pool));
 
       memset (&breq, 0, sizeof (struct v4l2_requestbuffers));
       breq.type = obj->type;
       breq.count = num_buffers;
-      breq.memory = V4L2_MEMORY_MMAP;
+      breq.memory = gst_v4l2_buffer_pool_memory (pool);
 
       if (v4l2_ioctl (pool->video_fd, VIDIOC_REQBUFS, &breq) < 0)
         goto reqbufs_failed;
@@ -504,6 +614,15 @@ gst_v4l2_buffer_pool_set_config (GstBufferPool * bpool, GstStructure * config)
         GST_WARNING_OBJECT (pool, "using %u buffers instead", breq.count);
         num_buffers = breq.count;
       }
+
+      if (GST_V4L2_IS_IMPORT_MODE (obj)) {
+        /* the slots are made when starting, the pool itself never hands out
+         * buffers and nothing is ever copied */
+        min_buffers = 0;
+        copy_threshold = 0;
+        break;
+      }
+
       /* update min buffers with the amount of buffers we just reserved. We need
        * to configure this value in the bufferpool so that the default start
        * implementation calls our allocate function */
@@ -520,7 +639,6 @@ gst_v4l2_buffer_pool_set_config (GstBufferPool * bpool, GstStructure * config)
       }
       break;
     }
-    case GST_V4L2_IO_USERPTR:
     default:
       num_buffers = 0;
       copy_threshold = 0;
@@ -531,13 +649,19 @@ gst_v4l2_buffer_pool_set_config (GstBufferPool * bpool, GstStructure * config)
   pool->size = size;
   pool->num_buffers = num_buffers;
   pool->copy_threshold = copy_threshold;
-
-  if (obj->mode == GST_V4L2_IO_DMABUF)
-    allocator = gst_dmabuf_allocator_new ();
+  pool->policy = obj->pool_policy;
+  /* without a configured max, don't grow without bounds */
+  if (max_buffers == 0)
+    pool->max_buffers = MAX (num_buffers, GST_V4L2_MAX_BUFFERS);
+  else
+    pool->max_buffers = max_buffers;
 
   if (pool->allocator)
     gst_object_unref (pool->allocator);
-  if ((pool->allocator = allocator))
+
+  if (obj->mode == GST_V4L2_IO_DMABUF)
+    pool->allocator = gst_dmabuf_allocator_new ();
+  else if ((pool->allocator = allocator))
     gst_object_ref (allocator);
   pool->params = params;
 
@@ -585,6 +709,7 @@ start_streaming (GstV4l2BufferPool * pool)
     case GST_V4L2_IO_MMAP:
     case GST_V4L2_IO_USERPTR:
     case GST_V4L2_IO_DMABUF:
+    case GST_V4L2_IO_DMABUF_IMPORT:
       GST_DEBUG_OBJECT (pool, "STREAMON");
       if (v4l2_ioctl (pool->video_fd, VIDIOC_STREAMON, &obj->type) < 0)
         goto start_failed;
@@ -617,16 +742,44 @@ gst_v4l2_buffer_pool_start (GstBufferPool * bpool)
   pool->buffers = g_new0 (GstBuffer *, pool->num_buffers);
   pool->num_allocated = 0;
 
+  pool->num_underruns = 0;
+  pool->num_grown = 0;
+  pool->num_copies = 0;
+  pool->num_drops = 0;
+  pool->num_stale = 0;
+
   /* now, allocate the buffers: */
   if (!GST_BUFFER_POOL_CLASS (parent_class)->start (bpool))
     goto start_failed;
 
+  /* make the slots for the upstream memory */
+  if (GST_V4L2_IS_IMPORT_MODE (obj)) {
+    guint n;
+
+    pool->slots = g_new0 (GstBuffer *, pool->num_buffers);
+    pool->import_seq = 0;
+    for (n = 0; n < pool->num_buffers; n++) {
+      if (gst_v4l2_buffer_pool_alloc_buffer (bpool, &pool->slots[n],
+              NULL) != GST_FLOW_OK)
+        goto start_failed;
+    }
+  }
+
   /* we can start capturing now, we wait for the playback case until we queued
    * the first buffer */
-  if (!V4L2_TYPE_IS_OUTPUT (obj->type))
+  if (!V4L2_TYPE_IS_OUTPUT (obj->type)) {
     if (!start_streaming (pool))
       goto start_failed;
 
+    /* let the thread of the group dequeue our frames */
+    if (obj->capture_group && obj->capture_group[0] != '\0' &&
+        obj->mode != GST_V4L2_IO_RW) {
+      pool->member = gst_v4l2_capture_group_join (obj->capture_group, pool);
+      if (pool->member == NULL)
+        goto start_failed;
+    }
+  }
+
   gst_poll_set_flushing (obj->poll, FALSE);
 
   return TRUE;
@@ -647,7 +800,7 @@ gst_v4l2_buffer_pool_free_buffers (GstV4l2BufferPool * pool)
     memset (&breq, 0, sizeof (struct v4l2_requestbuffers));
     breq.type = pool->obj->type;
     breq.count = 0;
-    breq.memory = V4L2_MEMORY_MMAP;
+    breq.memory = gst_v4l2_buffer_pool_memory (pool);
     if (v4l2_ioctl (pool->video_fd, VIDIOC_REQBUFS, &breq) < 0) {
       GST_ERROR_OBJECT (pool, "error releasing buffers: %s",
           g_strerror (errno));
@@ -666,8 +819,17 @@ gst_v4l2_buffer_pool_stop (GstBufferPool * bpool)
 
   GST_DEBUG_OBJECT (pool, "stopping pool");
 
+  GST_INFO_OBJECT (pool, "ran low on buffers %u times, grown by %u buffers, "
+      "%u copies, %u drops, %u stale frames skipped", pool->num_underruns,
+      pool->num_grown, pool->num_copies, pool->num_drops, pool->num_stale);
+
   gst_poll_set_flushing (obj->poll, TRUE);
 
+  if (pool->member) {
+    gst_v4l2_capture_group_leave (pool->member);
+    pool->member = NULL;
+  }
+
   if (pool->streaming) {
     switch (obj->mode) {
       case GST_V4L2_IO_RW:
@@ -675,6 +837,7 @@ gst_v4l2_buffer_pool_stop (GstBufferPool * bpool)
       case GST_V4L2_IO_MMAP:
       case GST_V4L2_IO_USERPTR:
       case GST_V4L2_IO_DMABUF:
+      case GST_V4L2_IO_DMABUF_IMPORT:
         /* we actually need to sync on all queued buffers but not
          * on the non-queued ones */
         GST_DEBUG_OBJECT (pool, "STREAMOFF");
@@ -691,6 +854,16 @@ gst_v4l2_buffer_pool_stop (GstBufferPool * bpool)
   /* first free the buffers in the queue */
   ret = GST_BUFFER_POOL_CLASS (parent_class)->stop (bpool);
 
+  /* the slots give back the upstream buffers they still hold */
+  if (pool->slots) {
+    for (n = 0; n < pool->num_buffers; n++) {
+      if (pool->slots[n])
+        gst_v4l2_buffer_pool_free_buffer (bpool, pool->slots[n]);
+    }
+    g_free (pool->slots);
+    pool->slots = NULL;
+  }
+
   /* then free the remaining buffers */
   for (n = 0; n < pool->num_buffers; n++) {
     if (pool->buffers[n])
@@ -750,7 +923,17 @@ select_error:
   }
 }
 
-static GstFlowReturn
+/**
+ * gst_v4l2_buffer_pool_qbuf:
+ * @pool: a #GstV4l2BufferPool
+ * @buf: a #GstBuffer of @pool
+ *
+ * Queue @buf in the device, buffers without v4l2 meta are copies and are
+ * unreffed.
+ *
+ * Returns: %GST_FLOW_OK on success.
+ */
+GstFlowReturn
 gst_v4l2_buffer_pool_qbuf (GstV4l2BufferPool * pool, GstBuffer * buf)
 {
   GstV4l2Meta *meta;
@@ -806,7 +989,17 @@ queue_failed:
   }
 }
 
-static GstFlowReturn
+/**
+ * gst_v4l2_buffer_pool_dqbuf:
+ * @pool: a #GstV4l2BufferPool
+ * @buffer: (out): the dequeued buffer
+ *
+ * Wait for the device and dequeue the next buffer, the buffer carries the
+ * timestamp of the driver.
+ *
+ * Returns: %GST_FLOW_OK on success.
+ */
+GstFlowReturn
 gst_v4l2_buffer_pool_dqbuf (GstV4l2BufferPool * pool, GstBuffer ** buffer)
 {
   GstFlowReturn res;
@@ -824,12 +1017,7 @@ gst_v4l2_buffer_pool_dqbuf (GstV4l2BufferPool * pool, GstBuffer ** buffer)
   /* prepare the buffer */
   memset (&vbuffer, 0x00, sizeof (vbuffer));
   vbuffer.type = obj->type;
-#if HAVE_DECL_V4L2_MEMORY_DMABUF
-  if (obj->mode == GST_V4L2_IO_DMABUF)
-    vbuffer.memory = V4L2_MEMORY_DMABUF;
-  else
-#endif
-    vbuffer.memory = V4L2_MEMORY_MMAP;
+  vbuffer.memory = gst_v4l2_buffer_pool_memory (pool);
 
   /* prepare the planes of the buffer */
   if (V4L2_TYPE_IS_MULTIPLANAR (obj->type)) {
@@ -913,11 +1101,19 @@ gst_v4l2_buffer_pool_dqbuf (GstV4l2BufferPool * pool, GstBuffer ** buffer)
       || obj->type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
     gst_buffer_remove_all_memory (outbuf);
     for (i = 0; i < meta->n_planes; i++) {
-      gst_buffer_append_memory (outbuf,
-          gst_memory_new_wrapped (GST_MEMORY_FLAG_NO_SHARE,
-              meta->mem[i], meta->vplanes[i].length,
-              meta->vplanes[i].data_offset,
-              meta->vplanes[i].bytesused, NULL, NULL));
+      if (obj->mode == GST_V4L2_IO_DMABUF) {
+        GstMemory *mem = gst_memory_ref (meta->dmamem[i]);
+
+        gst_memory_resize (mem, (gssize) meta->vplanes[i].data_offset -
+            (gssize) mem->offset, meta->vplanes[i].bytesused);
+        gst_buffer_append_memory (outbuf, mem);
+      } else {
+        gst_buffer_append_memory (outbuf,
+            gst_memory_new_wrapped (GST_MEMORY_FLAG_NO_SHARE,
+                meta->mem[i], meta->vplanes[i].length,
+                meta->vplanes[i].data_offset,
+                meta->vplanes[i].bytesused, NULL, NULL));
+      }
     }
   }
 
@@ -989,6 +1185,28 @@ no_buffer:
   }
 }
 
+/* check without blocking if the device has another frame ready */
+static gboolean
+gst_v4l2_buffer_pool_has_frame (GstV4l2BufferPool * pool)
+{
+  GstV4l2Object *obj = pool->obj;
+
+  if (!obj->can_poll_device || pool->member)
+    return FALSE;
+
+  return gst_poll_wait (obj->poll, 0) > 0;
+}
+
+/* the next captured buffer, from the capture group when we are in one */
+static GstFlowReturn
+gst_v4l2_buffer_pool_next (GstV4l2BufferPool * pool, GstBuffer ** buffer)
+{
+  if (pool->member)
+    return gst_v4l2_capture_member_pop (pool->member, buffer);
+
+  return gst_v4l2_buffer_pool_dqbuf (pool, buffer);
+}
+
 static GstFlowReturn
 gst_v4l2_buffer_pool_acquire_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -1014,20 +1232,47 @@ gst_v4l2_buffer_pool_acquire_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
           break;
         case GST_V4L2_IO_DMABUF:
         case GST_V4L2_IO_MMAP:
+        retry:
           /* just dequeue a buffer, we basically use the queue of v4l2 as the
            * storage for our buffers. This function does poll first so we can
            * interrupt it fine. */
-          ret = gst_v4l2_buffer_pool_dqbuf (pool, buffer);
+          ret = gst_v4l2_buffer_pool_next (pool, buffer);
           if (G_UNLIKELY (ret != GST_FLOW_OK))
             goto done;
 
-          /* start copying buffers when we are running low on buffers */
+          /* downstream is late, give back the frames that already have a
+           * successor so that the latency doesn't build up in the queue */
+          while (g_atomic_int_get (&obj->skip_stale) &&
+              gst_v4l2_buffer_pool_has_frame (pool)) {
+            GST_LOG_OBJECT (pool, "skip stale buffer %p", *buffer);
+            pool->num_stale++;
+            ret = gst_v4l2_buffer_pool_qbuf (pool, *buffer);
+            *buffer = NULL;
+            if (ret != GST_FLOW_OK)
+              goto done;
+
+            ret = gst_v4l2_buffer_pool_dqbuf (pool, buffer);
+            if (G_UNLIKELY (ret != GST_FLOW_OK))
+              goto done;
+          }
+
+          /* we are running low on buffers, apply the policy */
           if (pool->num_queued < pool->copy_threshold) {
             GstBuffer *copy;
+
+            pool->num_underruns++;
 #ifdef VIDIOC_CREATE_BUFS
-            if (pool->can_alloc) {
+            if (pool->policy == GST_V4L2_POOL_POLICY_GROW && pool->can_alloc
+                && pool->num_allocated < pool->max_buffers) {
+              GstBufferPoolAcquireParams grow_params = { 0, };
+
+              /* never wait for the parent, we only want a new buffer */
+              grow_params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
               if (GST_BUFFER_POOL_CLASS (parent_class)->acquire_buffer (bpool,
-                      &copy, params) == GST_FLOW_OK) {
+                      &copy, &grow_params) == GST_FLOW_OK) {
+                GST_DEBUG_OBJECT (pool, "grown to %u buffers",
+                    pool->num_allocated);
+                pool->num_grown++;
                 gst_v4l2_buffer_pool_release_buffer (bpool, copy);
                 break;
               } else {
@@ -1036,10 +1281,23 @@ gst_v4l2_buffer_pool_acquire_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
             }
 #endif
 
+            if (pool->policy == GST_V4L2_POOL_POLICY_DROP) {
+              /* give the frame back to the device and wait for the next
+               * one, downstream gets back-pressure instead of copies */
+              GST_LOG_OBJECT (pool, "drop buffer %p", *buffer);
+              pool->num_drops++;
+              ret = gst_v4l2_buffer_pool_qbuf (pool, *buffer);
+              *buffer = NULL;
+              if (ret != GST_FLOW_OK)
+                goto done;
+              goto retry;
+            }
+
             /* copy the buffer */
             copy = gst_buffer_copy_region (*buffer,
                 GST_BUFFER_COPY_ALL | GST_BUFFER_COPY_DEEP, 0, -1);
             GST_LOG_OBJECT (pool, "copy buffer %p->%p", *buffer, copy);
+            pool->num_copies++;
 
             /* and requeue so that we can continue capturing */
             ret = gst_v4l2_buffer_pool_qbuf (pool, *buffer);
@@ -1206,6 +1464,7 @@ gst_v4l2_buffer_pool_finalize (GObject * object)
   if (pool->allocator)
     gst_object_unref (pool->allocator);
   g_free (pool->buffers);
+  g_free (pool->slots);
 
   gst_object_unref (pool->obj->element);
 
@@ -1336,6 +1595,212 @@ cleanup:
   }
 }
 
+/* configure and activate the pool when the element did not do it */
+static gboolean
+gst_v4l2_buffer_pool_ensure_active (GstV4l2BufferPool * pool)
+{
+  GstBufferPool *bpool = GST_BUFFER_POOL_CAST (pool);
+  GstStructure *config;
+
+  if (gst_buffer_pool_is_active (bpool))
+    return TRUE;
+
+  /* this pool was not activated, configure and activate */
+  GST_DEBUG_OBJECT (pool, "activating pool");
+
+  config = gst_buffer_pool_get_config (bpool);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  gst_buffer_pool_set_config (bpool, config);
+
+  return gst_buffer_pool_set_active (bpool, TRUE);
+}
+
+/* queue the memory of @buf in a free slot without copying. The slot keeps
+ * a ref on @buf until the driver gives it back. With one memory for each v4l2
+ * plane every plane uses its own memory, with a single memory the planes are
+ * found at the offsets of the video meta. */
+static GstFlowReturn
+gst_v4l2_buffer_pool_import (GstV4l2BufferPool * pool, GstBuffer * buf)
+{
+  GstV4l2Object *obj = pool->obj;
+  GstV4l2Meta *meta;
+  GstBuffer *slot = NULL;
+  GstMemory *mem[GST_VIDEO_MAX_PLANES];
+  gsize offset[GST_VIDEO_MAX_PLANES], size[GST_VIDEO_MAX_PLANES];
+  guintptr key[GST_VIDEO_MAX_PLANES];
+  GstMapInfo map[GST_VIDEO_MAX_PLANES];
+  guint i, n, n_planes, n_maps = 0;
+  GstFlowReturn ret;
+
+  n_planes = obj->n_v4l2_planes;
+
+  if (gst_buffer_n_memory (buf) == n_planes) {
+    for (i = 0; i < n_planes; i++) {
+      mem[i] = gst_buffer_peek_memory (buf, i);
+      offset[i] = 0;
+      size[i] = mem[i]->size;
+    }
+  } else if (gst_buffer_n_memory (buf) == 1) {
+    GstVideoMeta *vmeta = gst_buffer_get_video_meta (buf);
+    gsize total = gst_buffer_get_size (buf);
+
+    for (i = 0; i < n_planes; i++) {
+      mem[i] = gst_buffer_peek_memory (buf, 0);
+      if (vmeta)
+        offset[i] = vmeta->offset[i];
+      else
+        offset[i] = GST_VIDEO_INFO_PLANE_OFFSET (&obj->info, i);
+    }
+    for (i = 0; i < n_planes; i++) {
+      gsize end = i + 1 < n_planes ? offset[i + 1] : total;
+
+      if (end < offset[i] || end > total)
+        goto wrong_layout;
+      size[i] = end - offset[i];
+    }
+  } else
+    goto wrong_layout;
+
+  /* the dmabuf fd or the address of each plane */
+  for (i = 0; i < n_planes; i++) {
+    if (obj->mode == GST_V4L2_IO_DMABUF_IMPORT) {
+      if (!gst_is_dmabuf_memory (mem[i]))
+        goto not_dmabuf;
+      /* there is no data offset in non MPLANE mode */
+      if (!V4L2_TYPE_IS_MULTIPLANAR (obj->type) && mem[i]->offset != 0)
+        goto wrong_layout;
+      key[i] = gst_dmabuf_memory_get_fd (mem[i]);
+    } else {
+      if (i == 0 || mem[i] != mem[i - 1]) {
+        if (!gst_memory_map (mem[i], &map[n_maps], GST_MAP_READ))
+          goto map_failed;
+        n_maps++;
+      }
+      key[i] = (guintptr) map[n_maps - 1].data + offset[i];
+    }
+  }
+
+  /* take the free slot that was last queued with the same memory so that the
+   * driver can reuse what it set up for it, otherwise take the free slot that
+   * was used the longest time ago */
+  for (n = 0; n < pool->num_buffers; n++) {
+    GstV4l2Meta *m = GST_V4L2_META_GET (pool->slots[n]);
+
+    if (pool->buffers[m->vbuffer.index] != NULL)
+      continue;
+
+    if (memcmp (m->import_key, key, n_planes * sizeof (guintptr)) == 0) {
+      slot = pool->slots[n];
+      break;
+    }
+    if (slot == NULL || m->import_seq < GST_V4L2_META_GET (slot)->import_seq)
+      slot = pool->slots[n];
+  }
+  if (slot == NULL)
+    goto no_slot;
+
+  meta = GST_V4L2_META_GET (slot);
+
+  for (i = 0; i < n_planes; i++) {
+    struct v4l2_plane *plane = &meta->vplanes[i];
+
+#if HAVE_DECL_V4L2_MEMORY_DMABUF
+    if (obj->mode == GST_V4L2_IO_DMABUF_IMPORT) {
+      plane->m.fd = key[i];
+      plane->length = mem[i]->maxsize;
+      plane->data_offset = mem[i]->offset + offset[i];
+      plane->bytesused = plane->data_offset + size[i];
+    } else
+#endif
+    {
+      plane->m.userptr = key[i];
+      plane->length = size[i];
+      plane->data_offset = 0;
+      plane->bytesused = size[i];
+    }
+    meta->import_key[i] = key[i];
+  }
+
+  if (!V4L2_TYPE_IS_MULTIPLANAR (obj->type)) {
+    /* here meta->n_planes == 1 */
+    meta->vbuffer.length = meta->vplanes[0].length;
+    meta->vbuffer.bytesused = meta->vplanes[0].bytesused;
+#if HAVE_DECL_V4L2_MEMORY_DMABUF
+    if (obj->mode == GST_V4L2_IO_DMABUF_IMPORT)
+      meta->vbuffer.m.fd = meta->vplanes[0].m.fd;
+    else
+#endif
+      meta->vbuffer.m.userptr = meta->vplanes[0].m.userptr;
+  }
+
+  GST_LOG_OBJECT (pool, "import buffer %p in slot %u, queued:%d", buf,
+      meta->vbuffer.index, pool->num_queued);
+
+  if (v4l2_ioctl (pool->video_fd, VIDIOC_QBUF, &meta->vbuffer) < 0)
+    goto queue_failed;
+
+  meta->imported = gst_buffer_ref (buf);
+  memcpy (meta->import_map, map, n_maps * sizeof (GstMapInfo));
+  meta->n_import_maps = n_maps;
+  meta->import_seq = ++pool->import_seq;
+
+  pool->buffers[meta->vbuffer.index] = slot;
+  pool->num_queued++;
+
+  /* if we are not streaming yet (this is the first buffer, start
+   * streaming now */
+  if (!pool->streaming)
+    if (!start_streaming (pool))
+      return GST_FLOW_ERROR;
+
+  if (pool->num_queued == pool->num_allocated) {
+    /* all slots are queued, wait until the driver is done with one and give
+     * its buffer back to upstream */
+    ret = gst_v4l2_buffer_pool_dqbuf (pool, &slot);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
+    gst_v4l2_buffer_pool_release_import (pool, slot);
+  }
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+wrong_layout:
+  {
+    GST_ERROR_OBJECT (pool, "can't import buffer %p with %u memories in %u "
+        "planes", buf, gst_buffer_n_memory (buf), n_planes);
+    return GST_FLOW_ERROR;
+  }
+not_dmabuf:
+  {
+    GST_ERROR_OBJECT (pool, "buffer %p has no dmabuf memory", buf);
+    return GST_FLOW_ERROR;
+  }
+map_failed:
+  {
+    GST_ERROR_OBJECT (pool, "failed to map buffer %p", buf);
+    goto cleanup;
+  }
+no_slot:
+  {
+    GST_ERROR_OBJECT (pool, "no free slot for buffer %p", buf);
+    goto cleanup;
+  }
+queue_failed:
+  {
+    GST_WARNING_OBJECT (pool, "could not queue a buffer %d (%s)", errno,
+        g_strerror (errno));
+    goto cleanup;
+  }
+cleanup:
+  {
+    for (i = 0; i < n_maps; i++)
+      gst_memory_unmap (map[i].memory, &map[i]);
+    return GST_FLOW_ERROR;
+  }
+}
+
 /**
  * gst_v4l2_buffer_pool_process:
  * @bpool: a #GstBufferPool
@@ -1366,6 +1831,7 @@ gst_v4l2_buffer_pool_process (GstV4l2BufferPool * pool, GstBuffer * buf)
           ret = gst_v4l2_do_read (pool, buf);
           break;
 
+        case GST_V4L2_IO_DMABUF:
         case GST_V4L2_IO_MMAP:
         {
           GstBuffer *tmp;
@@ -1375,7 +1841,7 @@ gst_v4l2_buffer_pool_process (GstV4l2BufferPool * pool, GstBuffer * buf)
             goto done;
 
           /* buffer not from our pool, grab a frame and copy it into the target */
-          if ((ret = gst_v4l2_buffer_pool_dqbuf (pool, &tmp)) != GST_FLOW_OK)
+          if ((ret = gst_v4l2_buffer_pool_next (pool, &tmp)) != GST_FLOW_OK)
             goto done;
 
           if (!gst_v4l2_object_copy (obj, buf, tmp))
@@ -1413,20 +1879,8 @@ gst_v4l2_buffer_pool_process (GstV4l2BufferPool * pool, GstBuffer * buf)
             GST_LOG_OBJECT (pool, "processing buffer from our pool");
           } else {
             GST_LOG_OBJECT (pool, "alloc buffer from our pool");
-            if (!gst_buffer_pool_is_active (bpool)) {
-              GstStructure *config;
-
-              /* this pool was not activated, configure and activate */
-              GST_DEBUG_OBJECT (pool, "activating pool");
-
-              config = gst_buffer_pool_get_config (bpool);
-              gst_buffer_pool_config_add_option (config,
-                  GST_BUFFER_POOL_OPTION_VIDEO_META);
-              gst_buffer_pool_set_config (bpool, config);
-
-              if (!gst_buffer_pool_set_active (bpool, TRUE))
-                goto activate_failed;
-            }
+            if (!gst_v4l2_buffer_pool_ensure_active (pool))
+              goto activate_failed;
 
             /* this can block if all buffers are outstanding which would be
              * strange because we would expect the upstream element to have
@@ -1470,6 +1924,14 @@ gst_v4l2_buffer_pool_process (GstV4l2BufferPool * pool, GstBuffer * buf)
         }
 
         case GST_V4L2_IO_USERPTR:
+        case GST_V4L2_IO_DMABUF_IMPORT:
+          /* queue the upstream memory itself */
+          if (!gst_v4l2_buffer_pool_ensure_active (pool))
+            goto activate_failed;
+
+          ret = gst_v4l2_buffer_pool_import (pool, buf);
+          break;
+
         default:
           g_assert_not_reached ();
           break;
@@ -1505,3 +1967,19 @@ start_failed:
     return GST_FLOW_ERROR;
   }
 }
+
+/**
+ * gst_v4l2_buffer_pool_set_flushing:
+ * @pool: a #GstV4l2BufferPool
+ * @flushing: the new flushing state
+ *
+ * Unblock a capture that waits for its capture group while @flushing is
+ * %TRUE. Waiting for the device itself is unblocked with the poll of the
+ * v4l2 object.
+ */
+void
+gst_v4l2_buffer_pool_set_flushing (GstV4l2BufferPool * pool, gboolean flushing)
+{
+  if (pool->member)
+    gst_v4l2_capture_member_set_flushing (pool->member, flushing);
+}
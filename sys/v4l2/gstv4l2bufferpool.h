@@ -30,6 +30,7 @@
 typedef struct _GstV4l2BufferPool GstV4l2BufferPool;
 typedef struct _GstV4l2BufferPoolClass GstV4l2BufferPoolClass;
 typedef struct _GstV4l2Meta GstV4l2Meta;
+typedef struct _GstV4l2CaptureMember GstV4l2CaptureMember;
 
 #include "gstv4l2object.h"
 
@@ -60,10 +61,27 @@ struct _GstV4l2BufferPool
   guint num_allocated;       /* number of buffers allocated by the driver */
   guint num_queued;          /* number of buffers queued in the driver */
   guint copy_threshold;      /* when our pool runs lower, start handing out copies */
+  guint max_buffers;         /* the number of buffers we can grow to */
+  GstV4l2PoolPolicy policy;  /* what to do when running low */
+
+  /* statistics */
+  guint num_underruns;       /* times the device was running low */
+  guint num_grown;           /* buffers allocated while running */
+  guint num_copies;          /* copies handed out */
+  guint num_drops;           /* frames given back to the device */
+  guint num_stale;           /* frames skipped because we were late */
 
   gboolean streaming;
 
+  /* when the frames are dequeued by a capture group */
+  GstV4l2CaptureMember *member;
+
   GstBuffer **buffers;
+
+  /* in the import modes, the buffers that carry the v4l2 slots. Upstream
+   * memory is attached to a slot while it is queued */
+  GstBuffer **slots;
+  guint64 import_seq;        /* counter for the least recently used slot */
 };
 
 struct _GstV4l2BufferPoolClass
@@ -90,6 +108,20 @@ struct _GstV4l2Meta {
    * was placed for each v4l2 plane */
   gpointer mem[GST_VIDEO_MAX_PLANES];
 
+  /* only useful in GST_V4L2_IO_DMABUF case.
+   * the exported memory of each v4l2 plane */
+  GstMemory *dmamem[GST_VIDEO_MAX_PLANES];
+
+  /* only useful in the GST_V4L2_IO_USERPTR and GST_V4L2_IO_DMABUF_IMPORT
+   * cases. The upstream buffer that is queued in the slot, the fd or the
+   * address of each plane the slot was last queued with and the mappings
+   * of the upstream memory that are held while it is queued */
+  GstBuffer *imported;
+  guintptr import_key[GST_VIDEO_MAX_PLANES];
+  guint64 import_seq;
+  GstMapInfo import_map[GST_VIDEO_MAX_PLANES];
+  guint n_import_maps;
+
   /* plane info for multi-planar buffers */
   struct v4l2_plane vplanes[GST_VIDEO_MAX_PLANES];
 
@@ -108,6 +140,11 @@ GstBufferPool *     gst_v4l2_buffer_pool_new     (GstV4l2Object *obj, GstCaps *c
 
 GstFlowReturn       gst_v4l2_buffer_pool_process (GstV4l2BufferPool * bpool, GstBuffer * buf);
 
+GstFlowReturn       gst_v4l2_buffer_pool_qbuf    (GstV4l2BufferPool * pool, GstBuffer * buf);
+GstFlowReturn       gst_v4l2_buffer_pool_dqbuf   (GstV4l2BufferPool * pool, GstBuffer ** buffer);
+
+void                gst_v4l2_buffer_pool_set_flushing (GstV4l2BufferPool * pool, gboolean flushing);
+
 G_END_DECLS
 
 #endif /*__GST_V4L2_BUFFER_POOL_H__ */
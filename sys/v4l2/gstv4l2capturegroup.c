@@ -0,0 +1,358 @@
+/* GStreamer
+ *
+ * gstv4l2capturegroup.c: dequeue the frames of several devices in one thread
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+
+#include "gstv4l2capturegroup.h"
+
+GST_DEBUG_CATEGORY_EXTERN (v4l2_debug);
+#define GST_CAT_DEFAULT v4l2_debug
+
+/* The pools of all sources with the same capture group are members of one
+ * group. The thread of the group waits for all the devices at once and
+ * dequeues the frames of every device that is ready in the same wakeup, the
+ * streaming threads of the sources only take the frames from their queue. */
+struct _GstV4l2CaptureGroup
+{
+  gchar *name;
+  gint refcount;                /* with groups_lock */
+
+  GMutex lock;
+  GCond cond;                   /* signaled after each batch */
+  GList *members;
+  GstPoll *poll;
+  GThread *thread;
+  gboolean running;
+};
+
+struct _GstV4l2CaptureMember
+{
+  GstV4l2CaptureGroup *group;
+  GstV4l2BufferPool *pool;      /* not reffed, the pool owns the member */
+  GstPollFD pollfd;
+
+  /* with the group lock */
+  gboolean watched;             /* if pollfd is in the poll of the group */
+  GQueue queue;                 /* dequeued buffers */
+  GstFlowReturn ret;
+  gboolean flushing;
+};
+
+/* how often to check the devices that have no buffers queued */
+#define STARVED_INTERVAL (10 * GST_MSECOND)
+
+static GMutex groups_lock;
+static GHashTable *groups;
+
+/* watch the devices that can produce a frame, with the group lock. V4L2
+ * reports an error from poll() while no buffer is queued so those devices
+ * are left out until downstream gave a buffer back. Returns %TRUE when a
+ * device is waiting for that. */
+static gboolean
+gst_v4l2_capture_group_update_fds (GstV4l2CaptureGroup * group)
+{
+  GList *walk;
+  gboolean starved = FALSE;
+
+  for (walk = group->members; walk; walk = g_list_next (walk)) {
+    GstV4l2CaptureMember *member = walk->data;
+    gboolean active, watch;
+
+    active = !member->flushing && member->ret == GST_FLOW_OK;
+    watch = active && member->pool->num_queued > 0;
+    if (active && !watch)
+      starved = TRUE;
+
+    if (watch == member->watched)
+      continue;
+
+    if (watch) {
+      gst_poll_add_fd (group->poll, &member->pollfd);
+      gst_poll_fd_ctl_read (group->poll, &member->pollfd, TRUE);
+    } else {
+      gst_poll_remove_fd (group->poll, &member->pollfd);
+    }
+    member->watched = watch;
+  }
+
+  return starved;
+}
+
+static gpointer
+gst_v4l2_capture_group_thread (GstV4l2CaptureGroup * group)
+{
+  GstClockTime timeout;
+  GList *walk;
+  gint res;
+
+  GST_DEBUG ("capture group %s started", group->name);
+
+  g_mutex_lock (&group->lock);
+  while (group->running) {
+    if (gst_v4l2_capture_group_update_fds (group))
+      timeout = STARVED_INTERVAL;
+    else
+      timeout = GST_CLOCK_TIME_NONE;
+
+    /* one wakeup for all the devices that have a frame */
+    g_mutex_unlock (&group->lock);
+    res = gst_poll_wait (group->poll, timeout);
+    g_mutex_lock (&group->lock);
+
+    if (res < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+      GST_WARNING ("capture group %s: poll error %s", group->name,
+          g_strerror (errno));
+
+    for (walk = group->members; walk; walk = g_list_next (walk)) {
+      GstV4l2CaptureMember *member = walk->data;
+      GstBuffer *buffer;
+
+      if (!member->watched || member->flushing || member->ret != GST_FLOW_OK)
+        continue;
+
+      if (!gst_poll_fd_can_read (group->poll, &member->pollfd) &&
+          !gst_poll_fd_has_error (group->poll, &member->pollfd))
+        continue;
+
+      member->ret = gst_v4l2_buffer_pool_dqbuf (member->pool, &buffer);
+      if (member->ret == GST_FLOW_OK) {
+        g_queue_push_tail (&member->queue, buffer);
+      } else if (member->ret == GST_FLOW_FLUSHING) {
+        /* the source is being unlocked, it will tell us */
+        member->ret = GST_FLOW_OK;
+      } else {
+        /* the source picks up the error, the device is not watched anymore
+         * until it is flushed */
+        GST_WARNING ("capture group %s: dequeue failed: %s", group->name,
+            gst_flow_get_name (member->ret));
+      }
+    }
+    /* wake up the sources of this batch */
+    g_cond_broadcast (&group->cond);
+  }
+  g_mutex_unlock (&group->lock);
+
+  GST_DEBUG ("capture group %s stopped", group->name);
+
+  return NULL;
+}
+
+/* give the buffers that were not taken back to the device, with the group
+ * lock */
+static void
+gst_v4l2_capture_member_requeue (GstV4l2CaptureMember * member)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&member->queue)))
+    gst_v4l2_buffer_pool_qbuf (member->pool, buffer);
+}
+
+/**
+ * gst_v4l2_capture_group_join:
+ * @name: the name of the group
+ * @pool: a streaming capture pool
+ *
+ * Make @pool a member of the capture group @name, the group is created when
+ * needed. From now on the capture thread of the group dequeues the frames of
+ * @pool, get them with gst_v4l2_capture_member_pop().
+ *
+ * Returns: the new member or %NULL when the capture thread could not be
+ * started.
+ */
+GstV4l2CaptureMember *
+gst_v4l2_capture_group_join (const gchar * name, GstV4l2BufferPool * pool)
+{
+  GstV4l2CaptureGroup *group;
+  GstV4l2CaptureMember *member;
+  GError *error = NULL;
+
+  g_mutex_lock (&groups_lock);
+  if (groups == NULL)
+    groups = g_hash_table_new (g_str_hash, g_str_equal);
+
+  group = g_hash_table_lookup (groups, name);
+  if (group == NULL) {
+    group = g_slice_new0 (GstV4l2CaptureGroup);
+    group->name = g_strdup (name);
+    g_mutex_init (&group->lock);
+    g_cond_init (&group->cond);
+    group->poll = gst_poll_new (TRUE);
+    group->running = TRUE;
+
+    group->thread = g_thread_try_new ("v4l2-capture-group",
+        (GThreadFunc) gst_v4l2_capture_group_thread, group, &error);
+    if (group->thread == NULL)
+      goto thread_failed;
+
+    g_hash_table_insert (groups, group->name, group);
+  }
+  group->refcount++;
+  g_mutex_unlock (&groups_lock);
+
+  member = g_slice_new0 (GstV4l2CaptureMember);
+  member->group = group;
+  member->pool = pool;
+  gst_poll_fd_init (&member->pollfd);
+  member->pollfd.fd = pool->video_fd;
+  member->watched = FALSE;
+  g_queue_init (&member->queue);
+  member->ret = GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (pool, "joining capture group %s", name);
+
+  g_mutex_lock (&group->lock);
+  group->members = g_list_append (group->members, member);
+  g_mutex_unlock (&group->lock);
+
+  /* make the thread pick up the new device */
+  gst_poll_restart (group->poll);
+
+  return member;
+
+  /* ERRORS */
+thread_failed:
+  {
+    GST_ERROR_OBJECT (pool, "failed to start capture thread: %s",
+        error->message);
+    g_error_free (error);
+    g_mutex_unlock (&groups_lock);
+    gst_poll_free (group->poll);
+    g_cond_clear (&group->cond);
+    g_mutex_clear (&group->lock);
+    g_free (group->name);
+    g_slice_free (GstV4l2CaptureGroup, group);
+    return NULL;
+  }
+}
+
+/**
+ * gst_v4l2_capture_group_leave:
+ * @member: a #GstV4l2CaptureMember
+ *
+ * Remove @member from its group and free it, the frames that were not taken
+ * are queued in the device again. The thread of the group stops with the
+ * last member. Call this while the device is still streaming.
+ */
+void
+gst_v4l2_capture_group_leave (GstV4l2CaptureMember * member)
+{
+  GstV4l2CaptureGroup *group = member->group;
+  gboolean last;
+
+  GST_DEBUG_OBJECT (member->pool, "leaving capture group %s", group->name);
+
+  g_mutex_lock (&group->lock);
+  group->members = g_list_remove (group->members, member);
+  if (member->watched)
+    gst_poll_remove_fd (group->poll, &member->pollfd);
+  gst_v4l2_capture_member_requeue (member);
+  g_mutex_unlock (&group->lock);
+  gst_poll_restart (group->poll);
+
+  g_slice_free (GstV4l2CaptureMember, member);
+
+  g_mutex_lock (&groups_lock);
+  last = (--group->refcount == 0);
+  if (last)
+    g_hash_table_remove (groups, group->name);
+  g_mutex_unlock (&groups_lock);
+
+  if (!last)
+    return;
+
+  g_mutex_lock (&group->lock);
+  group->running = FALSE;
+  g_mutex_unlock (&group->lock);
+  gst_poll_set_flushing (group->poll, TRUE);
+  g_thread_join (group->thread);
+
+  gst_poll_free (group->poll);
+  g_cond_clear (&group->cond);
+  g_mutex_clear (&group->lock);
+  g_free (group->name);
+  g_slice_free (GstV4l2CaptureGroup, group);
+}
+
+/**
+ * gst_v4l2_capture_member_pop:
+ * @member: a #GstV4l2CaptureMember
+ * @buffer: (out): the next captured buffer
+ *
+ * Wait until the capture thread dequeued a frame of @member.
+ *
+ * Returns: %GST_FLOW_OK, %GST_FLOW_FLUSHING when @member is flushing or the
+ * error of the last dequeue.
+ */
+GstFlowReturn
+gst_v4l2_capture_member_pop (GstV4l2CaptureMember * member,
+    GstBuffer ** buffer)
+{
+  GstV4l2CaptureGroup *group = member->group;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&group->lock);
+  while (g_queue_is_empty (&member->queue) && !member->flushing &&
+      member->ret == GST_FLOW_OK)
+    g_cond_wait (&group->cond, &group->lock);
+
+  if (member->flushing) {
+    ret = GST_FLOW_FLUSHING;
+  } else if (!g_queue_is_empty (&member->queue)) {
+    *buffer = g_queue_pop_head (&member->queue);
+    ret = GST_FLOW_OK;
+  } else {
+    ret = member->ret;
+  }
+  g_mutex_unlock (&group->lock);
+
+  return ret;
+}
+
+/**
+ * gst_v4l2_capture_member_set_flushing:
+ * @member: a #GstV4l2CaptureMember
+ * @flushing: the new flushing state
+ *
+ * Unblock gst_v4l2_capture_member_pop() and stop dequeueing the frames of
+ * @member while @flushing is %TRUE. The frames that were not taken yet are
+ * queued in the device again.
+ */
+void
+gst_v4l2_capture_member_set_flushing (GstV4l2CaptureMember * member,
+    gboolean flushing)
+{
+  GstV4l2CaptureGroup *group = member->group;
+
+  g_mutex_lock (&group->lock);
+  member->flushing = flushing;
+  if (flushing)
+    gst_v4l2_capture_member_requeue (member);
+  else
+    member->ret = GST_FLOW_OK;
+  g_cond_broadcast (&group->cond);
+  g_mutex_unlock (&group->lock);
+
+  gst_poll_restart (group->poll);
+}
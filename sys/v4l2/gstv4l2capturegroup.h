@@ -0,0 +1,43 @@
+/* GStreamer
+ *
+ * gstv4l2capturegroup.h: dequeue the frames of several devices in one thread
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_V4L2_CAPTURE_GROUP_H__
+#define __GST_V4L2_CAPTURE_GROUP_H__
+
+#include <gst/gst.h>
+
+#include "gstv4l2bufferpool.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GstV4l2CaptureGroup GstV4l2CaptureGroup;
+
+GstV4l2CaptureMember * gst_v4l2_capture_group_join  (const gchar * name,
+                                                     GstV4l2BufferPool * pool);
+void                   gst_v4l2_capture_group_leave (GstV4l2CaptureMember * member);
+
+GstFlowReturn          gst_v4l2_capture_member_pop  (GstV4l2CaptureMember * member,
+                                                     GstBuffer ** buffer);
+void                   gst_v4l2_capture_member_set_flushing (GstV4l2CaptureMember * member,
+                                                     gboolean flushing);
+
+G_END_DECLS
+
+#endif /* __GST_V4L2_CAPTURE_GROUP_H__ */
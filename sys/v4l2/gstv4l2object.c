@@ -73,6 +73,8 @@ GST_DEBUG_CATEGORY_EXTERN (GST_CAT_PERFORMANCE);
 #define DEFAULT_PROP_CHANNEL            NULL
 #define DEFAULT_PROP_FREQUENCY          0
 #define DEFAULT_PROP_IO_MODE            GST_V4L2_IO_AUTO
+#define DEFAULT_PROP_POOL_POLICY        GST_V4L2_POOL_POLICY_GROW
+#define DEFAULT_PROP_CACHE_CAPS         FALSE
 
 enum
 {
@@ -399,6 +401,8 @@ gst_v4l2_io_mode_get_type (void)
       {GST_V4L2_IO_MMAP, "GST_V4L2_IO_MMAP", "mmap"},
       {GST_V4L2_IO_USERPTR, "GST_V4L2_IO_USERPTR", "userptr"},
       {GST_V4L2_IO_DMABUF, "GST_V4L2_IO_DMABUF", "dmabuf"},
+      {GST_V4L2_IO_DMABUF_IMPORT, "GST_V4L2_IO_DMABUF_IMPORT",
+          "dmabuf-import"},
 
       {0, NULL, NULL}
     };
@@ -407,6 +411,26 @@ gst_v4l2_io_mode_get_type (void)
   return v4l2_io_mode;
 }
 
+#define GST_TYPE_V4L2_POOL_POLICY (gst_v4l2_pool_policy_get_type ())
+static GType
+gst_v4l2_pool_policy_get_type (void)
+{
+  static GType v4l2_pool_policy = 0;
+
+  if (!v4l2_pool_policy) {
+    static const GEnumValue pool_policies[] = {
+      {GST_V4L2_POOL_POLICY_GROW, "Allocate more buffers, then copy", "grow"},
+      {GST_V4L2_POOL_POLICY_COPY, "Copy the buffers", "copy"},
+      {GST_V4L2_POOL_POLICY_DROP, "Drop frames", "drop"},
+
+      {0, NULL, NULL}
+    };
+    v4l2_pool_policy =
+        g_enum_register_static ("GstV4l2PoolPolicy", pool_policies);
+  }
+  return v4l2_pool_policy;
+}
+
 void
 gst_v4l2_object_install_properties_helper (GObjectClass * gobject_class,
     const char *default_device)
@@ -530,6 +554,37 @@ gst_v4l2_object_install_properties_helper (GObjectClass * gobject_class,
           "When enabled, the pixel aspect ratio will be enforced", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstV4l2Src:pool-policy:
+   *
+   * What to do when downstream holds on to so many capture buffers that
+   * the device is about to run out of them. "grow" allocates more buffers
+   * with VIDIOC_CREATE_BUFS, up to the maximum of the pool configuration or
+   * 16, and copies after that. "copy" hands out copies of the frames and
+   * "drop" gives the frame back to the device and waits for the next one.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_POOL_POLICY,
+      g_param_spec_enum ("pool-policy", "Pool policy",
+          "What to do when running low on buffers",
+          GST_TYPE_V4L2_POOL_POLICY, DEFAULT_PROP_POOL_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstV4l2Src:cache-caps:
+   *
+   * Keep the caps probed from the device in the user cache directory and
+   * use them the next time the device is opened. The cache is used as long
+   * as the driver, card, bus, driver version, capabilities and the list of
+   * formats of the device don't change.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_CAPS,
+      g_param_spec_boolean ("cache-caps", "Cache caps",
+          "Cache the probed caps of the device on disk",
+          DEFAULT_PROP_CACHE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 GstV4l2Object *
@@ -567,6 +622,8 @@ gst_v4l2_object_new (GstElement * element,
   v4l2object->xwindow_id = 0;
 
   v4l2object->keep_aspect = TRUE;
+  v4l2object->pool_policy = DEFAULT_PROP_POOL_POLICY;
+  v4l2object->cache_caps = DEFAULT_PROP_CACHE_CAPS;
 
   v4l2object->n_v4l2_planes = 0;
 
@@ -610,6 +667,8 @@ gst_v4l2_object_destroy (GstV4l2Object * v4l2object)
   if (v4l2object->channel)
     g_free (v4l2object->channel);
 
+  g_free (v4l2object->capture_group);
+
   if (v4l2object->formats) {
     gst_v4l2_object_clear_format_list (v4l2object);
   }
@@ -748,6 +807,12 @@ gst_v4l2_object_set_property_helper (GstV4l2Object * v4l2object,
     case PROP_FORCE_ASPECT_RATIO:
       v4l2object->keep_aspect = g_value_get_boolean (value);
       break;
+    case PROP_POOL_POLICY:
+      v4l2object->pool_policy = g_value_get_enum (value);
+      break;
+    case PROP_CACHE_CAPS:
+      v4l2object->cache_caps = g_value_get_boolean (value);
+      break;
     default:
       return FALSE;
       break;
@@ -840,6 +905,12 @@ gst_v4l2_object_get_property_helper (GstV4l2Object * v4l2object,
     case PROP_FORCE_ASPECT_RATIO:
       g_value_set_boolean (value, v4l2object->keep_aspect);
       break;
+    case PROP_POOL_POLICY:
+      g_value_set_enum (value, v4l2object->pool_policy);
+      break;
+    case PROP_CACHE_CAPS:
+      g_value_set_boolean (value, v4l2object->cache_caps);
+      break;
     default:
       return FALSE;
       break;
@@ -2370,9 +2441,23 @@ gst_v4l2_object_setup_pool (GstV4l2Object * v4l2object, GstCaps * caps)
   if (v4l2object->vcap.capabilities & V4L2_CAP_STREAMING) {
     if (v4l2object->req_mode == GST_V4L2_IO_AUTO)
       mode = GST_V4L2_IO_MMAP;
-  } else if (v4l2object->req_mode == GST_V4L2_IO_MMAP)
+  } else if (v4l2object->req_mode == GST_V4L2_IO_MMAP ||
+      v4l2object->req_mode == GST_V4L2_IO_USERPTR ||
+      v4l2object->req_mode == GST_V4L2_IO_DMABUF ||
+      v4l2object->req_mode == GST_V4L2_IO_DMABUF_IMPORT)
     goto method_not_supported;
 
+  /* importing upstream memory is only done for output, capture buffers are
+   * filled in our own pool */
+  if ((mode == GST_V4L2_IO_USERPTR || mode == GST_V4L2_IO_DMABUF_IMPORT) &&
+      !V4L2_TYPE_IS_OUTPUT (v4l2object->type))
+    goto method_not_supported;
+
+#if !HAVE_DECL_V4L2_MEMORY_DMABUF
+  if (mode == GST_V4L2_IO_DMABUF || mode == GST_V4L2_IO_DMABUF_IMPORT)
+    goto method_not_supported;
+#endif
+
   /* if still no transport selected, error out */
   if (mode == GST_V4L2_IO_AUTO)
     goto no_supported_capture_method;
@@ -2804,6 +2889,10 @@ gst_v4l2_object_unlock (GstV4l2Object * v4l2object)
   GST_LOG_OBJECT (v4l2object->element, "flush poll");
   gst_poll_set_flushing (v4l2object->poll, TRUE);
 
+  if (v4l2object->pool)
+    gst_v4l2_buffer_pool_set_flushing (GST_V4L2_BUFFER_POOL_CAST
+        (v4l2object->pool), TRUE);
+
   return TRUE;
 }
 
@@ -2813,6 +2902,10 @@ gst_v4l2_object_unlock_stop (GstV4l2Object * v4l2object)
   GST_LOG_OBJECT (v4l2object->element, "flush stop poll");
   gst_poll_set_flushing (v4l2object->poll, FALSE);
 
+  if (v4l2object->pool)
+    gst_v4l2_buffer_pool_set_flushing (GST_V4L2_BUFFER_POOL_CAST
+        (v4l2object->pool), FALSE);
+
   return TRUE;
 }
 
@@ -2888,6 +2981,132 @@ invalid_buffer:
   }
 }
 
+/* everything the probed caps depend on, a cached result is only used when
+ * the key is the same */
+static gchar *
+gst_v4l2_object_caps_cache_key (GstV4l2Object * v4l2object, GSList * formats)
+{
+  GString *key;
+  GSList *walk;
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key, "%s|%s|%s|%08x|%08x|%d",
+      (const gchar *) v4l2object->vcap.driver,
+      (const gchar *) v4l2object->vcap.card,
+      (const gchar *) v4l2object->vcap.bus_info, v4l2object->vcap.version,
+      v4l2object->vcap.capabilities, v4l2object->type);
+
+  g_string_append_printf (key, "|aspect=%d", v4l2object->keep_aspect);
+  if (v4l2object->par)
+    g_string_append_printf (key, "|par=%d/%d",
+        gst_value_get_fraction_numerator (v4l2object->par),
+        gst_value_get_fraction_denominator (v4l2object->par));
+
+  for (walk = formats; walk; walk = walk->next) {
+    struct v4l2_fmtdesc *format = walk->data;
+
+    g_string_append_printf (key, "|%" GST_FOURCC_FORMAT,
+        GST_FOURCC_ARGS (format->pixelformat));
+  }
+
+  return g_string_free (key, FALSE);
+}
+
+/* one file for each device, a new driver version replaces it */
+static gchar *
+gst_v4l2_object_caps_cache_file (GstV4l2Object * v4l2object)
+{
+  gchar *id, *sum, *name, *file;
+
+  id = g_strdup_printf ("%s|%s|%s|%d", (const gchar *) v4l2object->vcap.driver,
+      (const gchar *) v4l2object->vcap.card,
+      (const gchar *) v4l2object->vcap.bus_info, v4l2object->type);
+  sum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, id, -1);
+  name = g_strconcat (sum, ".caps", NULL);
+  file = g_build_filename (g_get_user_cache_dir (), "gstreamer-1.0", "v4l2",
+      name, NULL);
+
+  g_free (name);
+  g_free (sum);
+  g_free (id);
+
+  return file;
+}
+
+static GstCaps *
+gst_v4l2_object_load_cached_caps (GstV4l2Object * v4l2object, GSList * formats)
+{
+  GKeyFile *kf;
+  gchar *file, *key, *cached_key = NULL, *str = NULL;
+  GstCaps *caps = NULL;
+
+  file = gst_v4l2_object_caps_cache_file (v4l2object);
+  key = gst_v4l2_object_caps_cache_key (v4l2object, formats);
+
+  kf = g_key_file_new ();
+  if (!g_key_file_load_from_file (kf, file, G_KEY_FILE_NONE, NULL))
+    goto done;
+
+  cached_key = g_key_file_get_string (kf, "caps", "key", NULL);
+  if (cached_key == NULL || strcmp (cached_key, key) != 0) {
+    GST_DEBUG_OBJECT (v4l2object->element, "cached caps in %s are stale",
+        file);
+    goto done;
+  }
+
+  str = g_key_file_get_string (kf, "caps", "caps", NULL);
+  if (str)
+    caps = gst_caps_from_string (str);
+
+  GST_DEBUG_OBJECT (v4l2object->element, "cached caps from %s: %"
+      GST_PTR_FORMAT, file, caps);
+
+done:
+  g_free (str);
+  g_free (cached_key);
+  g_key_file_free (kf);
+  g_free (key);
+  g_free (file);
+
+  return caps;
+}
+
+static void
+gst_v4l2_object_save_cached_caps (GstV4l2Object * v4l2object, GSList * formats,
+    GstCaps * caps)
+{
+  GKeyFile *kf;
+  gchar *file, *dir, *key, *str, *data;
+  GError *error = NULL;
+
+  file = gst_v4l2_object_caps_cache_file (v4l2object);
+  key = gst_v4l2_object_caps_cache_key (v4l2object, formats);
+  str = gst_caps_to_string (caps);
+
+  kf = g_key_file_new ();
+  g_key_file_set_string (kf, "caps", "key", key);
+  g_key_file_set_string (kf, "caps", "caps", str);
+  data = g_key_file_to_data (kf, NULL, NULL);
+
+  dir = g_path_get_dirname (file);
+  g_mkdir_with_parents (dir, 0755);
+
+  if (!g_file_set_contents (file, data, -1, &error)) {
+    GST_WARNING_OBJECT (v4l2object->element, "failed to cache caps: %s",
+        error->message);
+    g_error_free (error);
+  } else {
+    GST_DEBUG_OBJECT (v4l2object->element, "cached caps in %s", file);
+  }
+
+  g_free (dir);
+  g_free (data);
+  g_key_file_free (kf);
+  g_free (str);
+  g_free (key);
+  g_free (file);
+}
+
 GstCaps *
 gst_v4l2_object_get_caps (GstV4l2Object * v4l2object, GstCaps * filter)
 {
@@ -2898,6 +3117,13 @@ gst_v4l2_object_get_caps (GstV4l2Object * v4l2object, GstCaps * filter)
   if (v4l2object->probed_caps == NULL) {
     formats = gst_v4l2_object_get_format_list (v4l2object);
 
+    /* probing all sizes and frame intervals can take seconds */
+    if (v4l2object->cache_caps &&
+        (ret = gst_v4l2_object_load_cached_caps (v4l2object, formats))) {
+      v4l2object->probed_caps = ret;
+      goto done;
+    }
+
     ret = gst_caps_new_empty ();
 
     for (walk = formats; walk; walk = walk->next) {
@@ -2923,8 +3149,12 @@ gst_v4l2_object_get_caps (GstV4l2Object * v4l2object, GstCaps * filter)
       }
     }
     v4l2object->probed_caps = ret;
+
+    if (v4l2object->cache_caps)
+      gst_v4l2_object_save_cached_caps (v4l2object, formats, ret);
   }
 
+done:
   if (filter) {
     ret = gst_caps_intersect_full (filter, v4l2object->probed_caps,
         GST_CAPS_INTERSECT_FIRST);
@@ -58,6 +58,13 @@ typedef struct _GstV4l2Object GstV4l2Object;
 typedef struct _GstV4l2ObjectClassHelper GstV4l2ObjectClassHelper;
 typedef struct _GstV4l2Xv GstV4l2Xv;
 
+/* used by the buffer pool, which is included below */
+typedef enum {
+  GST_V4L2_POOL_POLICY_GROW = 0,
+  GST_V4L2_POOL_POLICY_COPY = 1,
+  GST_V4L2_POOL_POLICY_DROP = 2
+} GstV4l2PoolPolicy;
+
 #include <gstv4l2bufferpool.h>
 
 /* size of v4l2 buffer pool in streaming case */
@@ -76,7 +83,8 @@ typedef enum {
   GST_V4L2_IO_RW      = 1,
   GST_V4L2_IO_MMAP    = 2,
   GST_V4L2_IO_USERPTR = 3,
-  GST_V4L2_IO_DMABUF  = 4
+  GST_V4L2_IO_DMABUF  = 4,
+  GST_V4L2_IO_DMABUF_IMPORT = 5
 } GstV4l2IOMode;
 
 typedef gboolean  (*GstV4l2GetInOutFunction)  (GstV4l2Object * v4l2object, gint * input);
@@ -137,6 +145,19 @@ struct _GstV4l2Object {
   /* wanted mode */
   GstV4l2IOMode req_mode;
 
+  /* what the pool does when it runs low on capture buffers */
+  GstV4l2PoolPolicy pool_policy;
+
+  /* the name of the capture group of the device or NULL */
+  gchar *capture_group;
+
+  /* if the probed caps are cached on disk */
+  gboolean cache_caps;
+
+  /* set by the element while downstream QoS reports that we are late, the
+   * pool then skips frames that already have a successor */
+  volatile gint skip_stale;
+
   /* optional pool */
   GstBufferPool *pool;
 
@@ -196,7 +217,9 @@ GType gst_v4l2_object_get_type (void);
     PROP_IO_MODE,             \
     PROP_EXTRA_CONTROLS,      \
     PROP_PIXEL_ASPECT_RATIO,  \
-    PROP_FORCE_ASPECT_RATIO
+    PROP_FORCE_ASPECT_RATIO,  \
+    PROP_POOL_POLICY,         \
+    PROP_CACHE_CAPS
 
 /* create/destroy */
 GstV4l2Object*  gst_v4l2_object_new       (GstElement * element,
@@ -66,6 +66,7 @@
 #include "gst/gst-i18n-plugin.h"
 
 #include <string.h>
+#include <unistd.h>
 
 GST_DEBUG_CATEGORY (v4l2sink_debug);
 #define GST_CAT_DEFAULT v4l2sink_debug
@@ -572,7 +573,13 @@ gst_v4l2sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
   if (caps == NULL)
     goto no_caps;
 
-  if ((pool = obj->pool))
+  if (obj->mode == GST_V4L2_IO_USERPTR ||
+      obj->mode == GST_V4L2_IO_DMABUF_IMPORT) {
+    /* the memory of the upstream buffers is queued in the device, let
+     * upstream allocate from its own pool */
+    pool = NULL;
+    size = obj->sizeimage;
+  } else if ((pool = obj->pool))
     gst_object_ref (pool);
 
   if (pool != NULL) {
@@ -595,6 +602,15 @@ gst_v4l2sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
   /* we need at least 2 buffers to operate */
   gst_query_add_allocation_pool (query, pool, size, 2, 0);
 
+  if (obj->mode == GST_V4L2_IO_USERPTR) {
+    GstAllocationParams params;
+
+    /* drivers map user pointers page by page */
+    gst_allocation_params_init (&params);
+    params.align = getpagesize () - 1;
+    gst_query_add_allocation_param (query, NULL, &params);
+  }
+
   /* we also support various metadata */
   gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
   gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
@@ -52,6 +52,7 @@
 
 #include <gst/video/gstvideometa.h>
 #include <gst/video/gstvideopool.h>
+#include <gst/allocators/gstdmabuf.h>
 
 #include "gstv4l2src.h"
 
@@ -68,11 +69,14 @@ GST_DEBUG_CATEGORY (v4l2src_debug);
 #define GST_CAT_DEFAULT v4l2src_debug
 
 #define DEFAULT_PROP_DEVICE   "/dev/video0"
+#define DEFAULT_PROP_CAPTURE_GROUP NULL
 
 enum
 {
   PROP_0,
   V4L2_STD_OBJECT_PROPS,
+  PROP_CAPTURE_GROUP,
+  PROP_STATS,
   PROP_LAST
 };
 
@@ -123,6 +127,7 @@ static gboolean gst_v4l2src_stop (GstBaseSrc * src);
 static gboolean gst_v4l2src_set_caps (GstBaseSrc * src, GstCaps * caps);
 static GstCaps *gst_v4l2src_get_caps (GstBaseSrc * src, GstCaps * filter);
 static gboolean gst_v4l2src_query (GstBaseSrc * bsrc, GstQuery * query);
+static gboolean gst_v4l2src_event (GstBaseSrc * src, GstEvent * event);
 static gboolean gst_v4l2src_decide_allocation (GstBaseSrc * src,
     GstQuery * query);
 static GstFlowReturn gst_v4l2src_fill (GstPushSrc * src, GstBuffer * out);
@@ -156,6 +161,39 @@ gst_v4l2src_class_init (GstV4l2SrcClass * klass)
   gst_v4l2_object_install_properties_helper (gobject_class,
       DEFAULT_PROP_DEVICE);
 
+  /**
+   * GstV4l2Src:capture-group:
+   *
+   * Sources with the same capture group share one thread that waits for
+   * all their devices at once and dequeues the frames of every device that
+   * is ready in the same wakeup. The frames keep the timestamps of the
+   * driver. Only used in the streaming io-modes.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_CAPTURE_GROUP,
+      g_param_spec_string ("capture-group", "Capture group",
+          "Name of the group of sources that share a capture thread",
+          DEFAULT_PROP_CAPTURE_GROUP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstV4l2Src:stats:
+   *
+   * Statistics about the time captured frames spent in the driver queue,
+   * measured with the timestamps of the driver. The structure has the
+   * #guint64 fields "queue-delay", "max-queue-delay" and
+   * "average-queue-delay" in nanoseconds, and the #guint field
+   * "stale-skipped" with the number of frames that were not pushed because
+   * downstream was late and a newer frame was ready.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics about the queue delay of the frames",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstV4l2Src::prepare-format:
    * @v4l2src: the v4l2src instance
@@ -193,6 +231,7 @@ gst_v4l2src_class_init (GstV4l2SrcClass * klass)
   basesrc_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_v4l2src_unlock_stop);
   basesrc_class->stop = GST_DEBUG_FUNCPTR (gst_v4l2src_stop);
   basesrc_class->query = GST_DEBUG_FUNCPTR (gst_v4l2src_query);
+  basesrc_class->event = GST_DEBUG_FUNCPTR (gst_v4l2src_event);
   basesrc_class->fixate = GST_DEBUG_FUNCPTR (gst_v4l2src_fixate);
   basesrc_class->negotiate = GST_DEBUG_FUNCPTR (gst_v4l2src_negotiate);
   basesrc_class->decide_allocation =
@@ -236,6 +275,10 @@ gst_v4l2src_set_property (GObject * object,
   if (!gst_v4l2_object_set_property_helper (v4l2src->v4l2object,
           prop_id, value, pspec)) {
     switch (prop_id) {
+      case PROP_CAPTURE_GROUP:
+        g_free (v4l2src->v4l2object->capture_group);
+        v4l2src->v4l2object->capture_group = g_value_dup_string (value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -252,6 +295,25 @@ gst_v4l2src_get_property (GObject * object,
   if (!gst_v4l2_object_get_property_helper (v4l2src->v4l2object,
           prop_id, value, pspec)) {
     switch (prop_id) {
+      case PROP_CAPTURE_GROUP:
+        g_value_set_string (value, v4l2src->v4l2object->capture_group);
+        break;
+      case PROP_STATS:
+      {
+        GstStructure *s;
+
+        GST_OBJECT_LOCK (v4l2src);
+        s = gst_structure_new ("application/x-v4l2src-stats",
+            "queue-delay", G_TYPE_UINT64, (guint64) v4l2src->last_delay,
+            "max-queue-delay", G_TYPE_UINT64, (guint64) v4l2src->max_delay,
+            "average-queue-delay", G_TYPE_UINT64,
+            (guint64) v4l2src->avg_delay, "stale-skipped", G_TYPE_UINT,
+            v4l2src->stale_skipped, NULL);
+        GST_OBJECT_UNLOCK (v4l2src);
+
+        g_value_take_boxed (value, s);
+        break;
+      }
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -551,6 +613,21 @@ gst_v4l2src_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
   else
     gst_query_add_allocation_pool (query, pool, size, min, max);
 
+#if HAVE_DECL_V4L2_MEMORY_DMABUF
+  /* the buffers carry exported dmabuf memory, tell the base class so that
+   * it reports this allocator as well */
+  if (obj->mode == GST_V4L2_IO_DMABUF) {
+    GstAllocator *allocator;
+
+    allocator = gst_dmabuf_allocator_new ();
+    if (gst_query_get_n_allocation_params (query) > 0)
+      gst_query_set_nth_allocation_param (query, 0, allocator, NULL);
+    else
+      gst_query_add_allocation_param (query, allocator, NULL);
+    gst_object_unref (allocator);
+  }
+#endif
+
   return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (bsrc, query);
 }
 
@@ -620,6 +697,30 @@ done:
   return res;
 }
 
+static gboolean
+gst_v4l2src_event (GstBaseSrc * src, GstEvent * event)
+{
+  GstV4l2Src *v4l2src = GST_V4L2SRC (src);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_QOS:
+    {
+      GstClockTimeDiff diff;
+
+      gst_event_parse_qos (event, NULL, NULL, &diff, NULL);
+
+      /* while we are late, only push the newest frame of the driver */
+      GST_LOG_OBJECT (src, "QoS diff %" G_GINT64_FORMAT, diff);
+      g_atomic_int_set (&v4l2src->v4l2object->skip_stale, diff > 0);
+      break;
+    }
+    default:
+      break;
+  }
+
+  return GST_BASE_SRC_CLASS (parent_class)->event (src, event);
+}
+
 /* start and stop are not symmetric -- start will open the device, but not start
  * capture. it's setcaps that will start capture, which is called via basesrc's
  * negotiate method. stop will both stop capture and close the device.
@@ -630,6 +731,14 @@ gst_v4l2src_start (GstBaseSrc * src)
   GstV4l2Src *v4l2src = GST_V4L2SRC (src);
 
   v4l2src->offset = 0;
+  g_atomic_int_set (&v4l2src->v4l2object->skip_stale, FALSE);
+
+  GST_OBJECT_LOCK (v4l2src);
+  v4l2src->last_delay = 0;
+  v4l2src->max_delay = 0;
+  v4l2src->avg_delay = 0;
+  v4l2src->stale_skipped = 0;
+  GST_OBJECT_UNLOCK (v4l2src);
 
   /* activate settings for first frame */
   v4l2src->ctrl_time = 0;
@@ -766,6 +875,18 @@ gst_v4l2src_fill (GstPushSrc * src, GstBuffer * buf)
     GST_DEBUG_OBJECT (v4l2src, "ts: %" GST_TIME_FORMAT " now %" GST_TIME_FORMAT
         " delay %" GST_TIME_FORMAT, GST_TIME_ARGS (timestamp),
         GST_TIME_ARGS (gstnow), GST_TIME_ARGS (delay));
+
+    GST_OBJECT_LOCK (v4l2src);
+    v4l2src->last_delay = delay;
+    v4l2src->max_delay = MAX (v4l2src->max_delay, delay);
+    /* average over roughly the last 8 frames */
+    if (v4l2src->avg_delay == 0)
+      v4l2src->avg_delay = delay;
+    else
+      v4l2src->avg_delay = (7 * v4l2src->avg_delay + delay) / 8;
+    v4l2src->stale_skipped =
+        GST_V4L2_BUFFER_POOL_CAST (obj->pool)->num_stale;
+    GST_OBJECT_UNLOCK (v4l2src);
   } else {
     /* we assume 1 frame latency otherwise */
     if (GST_CLOCK_TIME_IS_VALID (duration))
@@ -60,6 +60,12 @@ struct _GstV4l2Src
   guint64 offset;
 
   GstClockTime ctrl_time;
+
+  /* time the frames spent in the driver queue, with LOCK */
+  GstClockTime last_delay;
+  GstClockTime max_delay;
+  GstClockTime avg_delay;
+  guint stale_skipped;
 };
 
 struct _GstV4l2SrcClass
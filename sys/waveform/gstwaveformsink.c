@@ -172,6 +172,8 @@ gst_waveform_sink_init (GstWaveFormSink * wfsink)
   wfsink->buffer_size = BUFFER_SIZE;
   wfsink->free_buffers_count = wfsink->buffer_count;
   wfsink->bytes_in_queue = 0;
+  wfsink->free_buffer_event = NULL;
+  wfsink->buffer_time = 1;
 
   InitializeCriticalSection (&wfsink->critic_wave);
 }
@@ -359,6 +361,20 @@ gst_waveform_sink_prepare (GstAudioSink * asink, GstAudioRingBufferSpec * spec)
   /* save bytes per sample to use it in delay */
   wfsink->bytes_per_sample = spec->info.bpf;
 
+  /* the device queue follows the segments of the ringbuffer, so that the
+   * latency-time and buffer-time properties configure the size and number
+   * of the wave buffers */
+  wfsink->buffer_size = spec->segsize;
+  wfsink->buffer_count = MAX (spec->segtotal, 2);
+  wfsink->buffer_time = MAX (1,
+      gst_util_uint64_scale_int (wfsink->buffer_size, 1000,
+          wfx.nAvgBytesPerSec));
+
+  GST_CAT_DEBUG_OBJECT (waveformsink_debug, wfsink,
+      "%u buffers of %u bytes", wfsink->buffer_count, wfsink->buffer_size);
+
+  wfsink->free_buffer_event = CreateEvent (NULL, FALSE, FALSE, NULL);
+
   /* open the default audio device with the given caps */
   mmresult = waveOutOpen (&wfsink->hwaveout, WAVE_MAPPER,
       &wfx, (DWORD_PTR) waveOutProc, (DWORD_PTR) wfsink, CALLBACK_FUNCTION);
@@ -425,6 +441,11 @@ gst_waveform_sink_unprepare (GstAudioSink * asink)
     wfsink->hwaveout = NULL;
   }
 
+  if (wfsink->free_buffer_event) {
+    CloseHandle (wfsink->free_buffer_event);
+    wfsink->free_buffer_event = NULL;
+  }
+
   return TRUE;
 }
 
@@ -449,8 +470,11 @@ gst_waveform_sink_write (GstAudioSink * asink, gpointer data, guint length)
 
   while (remaining_length > 0) {
     if (wfsink->free_buffers_count == 0) {
-      /* no free buffer available, wait for one */
-      Sleep (10);
+      /* no free buffer available, wait until the device returns one */
+      if (wfsink->free_buffer_event)
+        WaitForSingleObject (wfsink->free_buffer_event, wfsink->buffer_time);
+      else
+        Sleep (wfsink->buffer_time);
       continue;
     }
 
@@ -562,5 +586,9 @@ waveOutProc (HWAVEOUT hwo,
     EnterCriticalSection (&wfsink->critic_wave);
     wfsink->free_buffers_count++;
     LeaveCriticalSection (&wfsink->critic_wave);
+
+    /* SetEvent is one of the few calls allowed in the callback */
+    if (wfsink->free_buffer_event)
+      SetEvent (wfsink->free_buffer_event);
   }
 }
@@ -77,6 +77,12 @@ struct _GstWaveFormSink
 
   /* number of free buffers available */
   guint free_buffers_count;
+
+  /* signalled by the device callback when a buffer has been played */
+  HANDLE free_buffer_event;
+
+  /* duration of a buffer in ms, the longest write waits for a free one */
+  DWORD buffer_time;
   
   /* current free buffer where you have to write incoming data */
   guint write_buffer;
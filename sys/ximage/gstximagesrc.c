@@ -39,6 +39,7 @@
 #include "config.h"
 #endif
 #include "gstximagesrc.h"
+#include "gstximagesrcpool.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -76,39 +77,14 @@ enum
   PROP_REMOTE,
   PROP_XID,
   PROP_XNAME,
+  PROP_SKIP_UNCHANGED,
 };
 
 #define gst_ximage_src_parent_class parent_class
 G_DEFINE_TYPE (GstXImageSrc, gst_ximage_src, GST_TYPE_PUSH_SRC);
 
 static GstCaps *gst_ximage_src_fixate (GstBaseSrc * bsrc, GstCaps * caps);
-static void gst_ximage_src_clear_bufpool (GstXImageSrc * ximagesrc);
-
-/* Called when a buffer is returned from the pipeline */
-static void
-gst_ximage_src_return_buf (GstXImageSrc * ximagesrc, GstBuffer * ximage)
-{
-  GstMetaXImage *meta = GST_META_XIMAGE_GET (ximage);
-
-  /* If our geometry changed we can't reuse that image. */
-  if ((meta->width != ximagesrc->width) || (meta->height != ximagesrc->height)) {
-    GST_DEBUG_OBJECT (ximagesrc,
-        "destroy image %p as its size changed %dx%d vs current %dx%d",
-        ximage, meta->width, meta->height, ximagesrc->width, ximagesrc->height);
-    g_mutex_lock (&ximagesrc->x_lock);
-    gst_ximageutil_ximage_destroy (ximagesrc->xcontext, ximage);
-    g_mutex_unlock (&ximagesrc->x_lock);
-  } else {
-    /* In that case we can reuse the image and add it to our image pool. */
-    GST_LOG_OBJECT (ximagesrc, "recycling image %p in pool", ximage);
-    /* need to increment the refcount again to recycle */
-    gst_buffer_ref (ximage);
-    g_mutex_lock (&ximagesrc->pool_lock);
-    GST_BUFFER_FLAGS (GST_BUFFER (ximage)) = 0; /* clear out any flags from the previous use */
-    ximagesrc->buffer_pool = g_slist_prepend (ximagesrc->buffer_pool, ximage);
-    g_mutex_unlock (&ximagesrc->pool_lock);
-  }
-}
+static void gst_ximage_src_release_pool (GstXImageSrc * s);
 
 static Window
 gst_ximage_src_find_window (GstXImageSrc * src, Window root, const char *name)
@@ -293,7 +269,7 @@ gst_ximage_src_stop (GstBaseSrc * basesrc)
   src->last_ximage = NULL;
 #endif
 
-  gst_ximage_src_clear_bufpool (src);
+  gst_ximage_src_release_pool (src);
 
 #ifdef HAVE_XFIXES
   if (src->cursor_image)
@@ -446,148 +422,198 @@ copy_buffer (GstBuffer * dest, GstBuffer * src)
 }
 #endif
 
-/* Retrieve an XImageSrcBuffer, preferably from our
- * pool of existing images and populate it from the window */
+#ifdef HAVE_XDAMAGE
+/* check if the pointer moved or changed its shape since it was drawn in the
+ * last frame */
+static gboolean
+gst_ximage_src_cursor_changed (GstXImageSrc * ximagesrc)
+{
+  XFixesCursorImage *cursor;
+  gboolean changed;
+
+  if (!ximagesrc->show_pointer || !ximagesrc->have_xfixes)
+    return FALSE;
+
+  if (ximagesrc->cursor_image == NULL)
+    return TRUE;
+
+  cursor = XFixesGetCursorImage (ximagesrc->xcontext->disp);
+  if (cursor == NULL)
+    return TRUE;
+
+  changed = cursor->x != ximagesrc->cursor_image->x ||
+      cursor->y != ximagesrc->cursor_image->y ||
+      cursor->cursor_serial != ximagesrc->cursor_image->cursor_serial;
+  XFree (cursor);
+
+  return changed;
+}
+
+/* a read-only buffer with the pixels of the last frame, it keeps the last
+ * frame alive and makes it non-writable for as long as it exists */
 static GstBuffer *
-gst_ximage_src_ximage_get (GstXImageSrc * ximagesrc)
+gst_ximage_src_duplicate_last (GstXImageSrc * ximagesrc)
 {
-  GstBuffer *ximage = NULL;
-  GstMetaXImage *meta;
+  GstBuffer *last = ximagesrc->last_ximage;
+  GstMetaXImage *meta = GST_META_XIMAGE_GET (last);
+  GstBuffer *dup;
 
-  g_mutex_lock (&ximagesrc->pool_lock);
-  while (ximagesrc->buffer_pool != NULL) {
-    ximage = ximagesrc->buffer_pool->data;
+  dup = gst_buffer_new ();
+  gst_buffer_append_memory (dup,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, meta->ximage->data,
+          meta->size, 0, meta->size, gst_buffer_ref (last),
+          (GDestroyNotify) gst_buffer_unref));
 
-    meta = GST_META_XIMAGE_GET (ximage);
+  return dup;
+}
+#endif
 
-    if ((meta->width != ximagesrc->width) ||
-        (meta->height != ximagesrc->height)) {
-      gst_ximage_buffer_free (ximage);
-    }
+static GstFlowReturn
+gst_ximage_src_acquire (GstXImageSrc * ximagesrc, GstBuffer ** ximage)
+{
+  GstFlowReturn ret;
 
-    ximagesrc->buffer_pool = g_slist_delete_link (ximagesrc->buffer_pool,
-        ximagesrc->buffer_pool);
-  }
-  g_mutex_unlock (&ximagesrc->pool_lock);
-
-  if (ximage == NULL) {
-    GST_DEBUG_OBJECT (ximagesrc, "creating image (%dx%d)",
-        ximagesrc->width, ximagesrc->height);
-
-    g_mutex_lock (&ximagesrc->x_lock);
-    ximage = gst_ximageutil_ximage_new (ximagesrc->xcontext,
-        GST_ELEMENT (ximagesrc), ximagesrc->width, ximagesrc->height,
-        (BufferReturnFunc) (gst_ximage_src_return_buf));
-    if (ximage == NULL) {
-      GST_ELEMENT_ERROR (ximagesrc, RESOURCE, WRITE, (NULL),
-          ("could not create a %dx%d ximage", ximagesrc->width,
-              ximagesrc->height));
-      g_mutex_unlock (&ximagesrc->x_lock);
-      return NULL;
-    }
+  if (G_UNLIKELY (ximagesrc->pool == NULL))
+    return GST_FLOW_NOT_NEGOTIATED;
 
-    g_mutex_unlock (&ximagesrc->x_lock);
+  ret = gst_buffer_pool_acquire_buffer (ximagesrc->pool, ximage, NULL);
+  if (G_UNLIKELY (ret == GST_FLOW_ERROR)) {
+    GST_ELEMENT_ERROR (ximagesrc, RESOURCE, WRITE, (NULL),
+        ("could not create a %dx%d ximage", ximagesrc->width,
+            ximagesrc->height));
   }
 
-  g_return_val_if_fail (GST_IS_XIMAGE_SRC (ximagesrc), NULL);
+  return ret;
+}
+
+/* Retrieve an XImageSrcBuffer from our pool of images and populate it from
+ * the window. With XDamage only the damaged areas are copied into the last
+ * frame and GST_FLOW_CUSTOM_SUCCESS is returned when nothing changed and
+ * unchanged frames are skipped */
+static GstFlowReturn
+gst_ximage_src_ximage_get (GstXImageSrc * ximagesrc, GstBuffer ** buf)
+{
+  GstBuffer *ximage = NULL;
+  GstMetaXImage *meta;
+  GstFlowReturn ret;
 
-  meta = GST_META_XIMAGE_GET (ximage);
+  g_return_val_if_fail (GST_IS_XIMAGE_SRC (ximagesrc), GST_FLOW_ERROR);
 
 #ifdef HAVE_XDAMAGE
   if (ximagesrc->have_xdamage && ximagesrc->use_damage &&
       ximagesrc->last_ximage != NULL) {
     XEvent ev;
-
-    /* have_frame is TRUE when either the entire screen has been
-     * grabbed or when the last image has been copied */
-    gboolean have_frame = FALSE;
+    XRectangle *rects = NULL;
+    int i, nrects = 0;
+    gboolean damaged = FALSE;
 
     GST_DEBUG_OBJECT (ximagesrc, "Retrieving screen using XDamage");
 
-    do {
+    /* the damage accumulates in the damage object, the events only tell us
+     * that it is no longer empty */
+    while (XPending (ximagesrc->xcontext->disp)) {
       XNextEvent (ximagesrc->xcontext->disp, &ev);
+      if (ev.type == ximagesrc->damage_event_base + XDamageNotify)
+        damaged = TRUE;
+    }
+    if (damaged) {
+      XDamageSubtract (ximagesrc->xcontext->disp, ximagesrc->damage, None,
+          ximagesrc->damage_region);
+      rects = XFixesFetchRegion (ximagesrc->xcontext->disp,
+          ximagesrc->damage_region, &nrects);
+    }
 
-      if (ev.type == ximagesrc->damage_event_base + XDamageNotify) {
-        XserverRegion parts;
-        XRectangle *rects;
-        int nrects;
-
-        parts = XFixesCreateRegion (ximagesrc->xcontext->disp, 0, 0);
-        XDamageSubtract (ximagesrc->xcontext->disp, ximagesrc->damage, None,
-            parts);
-        /* Now copy out all of the damaged rectangles. */
-        rects = XFixesFetchRegion (ximagesrc->xcontext->disp, parts, &nrects);
-        if (rects != NULL) {
-          int i;
-
-          if (!have_frame) {
-            GST_LOG_OBJECT (ximagesrc,
-                "Copying from last frame ximage->size: %" G_GSIZE_FORMAT,
-                gst_buffer_get_size (ximage));
-            copy_buffer (ximage, ximagesrc->last_ximage);
-            have_frame = TRUE;
-          }
-          for (i = 0; i < nrects; i++) {
-            GST_LOG_OBJECT (ximagesrc,
-                "Damaged sub-region @ %d,%d size %dx%d reported",
-                rects[i].x, rects[i].y, rects[i].width, rects[i].height);
-
-            /* if we only want a small area, clip this damage region to
-             * area we want */
-            if (ximagesrc->endx > ximagesrc->startx &&
-                ximagesrc->endy > ximagesrc->starty) {
-              /* see if damage area intersects */
-              if (rects[i].x + rects[i].width - 1 < ximagesrc->startx ||
-                  rects[i].x > ximagesrc->endx) {
-                /* trivial reject */
-              } else if (rects[i].y + rects[i].height - 1 < ximagesrc->starty ||
-                  rects[i].y > ximagesrc->endy) {
-                /* trivial reject */
-              } else {
-                /* find intersect region */
-                int startx, starty, width, height;
-
-                startx = (rects[i].x < ximagesrc->startx) ? ximagesrc->startx :
-                    rects[i].x;
-                starty = (rects[i].y < ximagesrc->starty) ? ximagesrc->starty :
-                    rects[i].y;
-                width = (rects[i].x + rects[i].width - 1 < ximagesrc->endx) ?
-                    rects[i].x + rects[i].width - startx :
-                    ximagesrc->endx - startx + 1;
-                height = (rects[i].y + rects[i].height - 1 < ximagesrc->endy) ?
-                    rects[i].y + rects[i].height - starty : ximagesrc->endy -
-                    starty + 1;
-
-                GST_LOG_OBJECT (ximagesrc,
-                    "Retrieving damaged sub-region @ %d,%d size %dx%d as intersect region",
-                    startx, starty, width, height);
-                XGetSubImage (ximagesrc->xcontext->disp, ximagesrc->xwindow,
-                    startx, starty, width, height, AllPlanes, ZPixmap,
-                    meta->ximage, startx - ximagesrc->startx,
-                    starty - ximagesrc->starty);
-              }
-            } else {
-
-              GST_LOG_OBJECT (ximagesrc,
-                  "Retrieving damaged sub-region @ %d,%d size %dx%d",
-                  rects[i].x, rects[i].y, rects[i].width, rects[i].height);
-
-              XGetSubImage (ximagesrc->xcontext->disp, ximagesrc->xwindow,
-                  rects[i].x, rects[i].y,
-                  rects[i].width, rects[i].height,
-                  AllPlanes, ZPixmap, meta->ximage, rects[i].x, rects[i].y);
-            }
-          }
+    if (rects == NULL || nrects == 0) {
+      if (rects)
+        free (rects);
+      rects = NULL;
+      nrects = 0;
+
+      if (!gst_ximage_src_cursor_changed (ximagesrc)) {
+        GST_LOG_OBJECT (ximagesrc, "Nothing changed since the last frame");
+        if (ximagesrc->skip_unchanged)
+          return GST_FLOW_CUSTOM_SUCCESS;
+
+        *buf = gst_ximage_src_duplicate_last (ximagesrc);
+        return GST_FLOW_OK;
+      }
+    }
+
+    if (gst_buffer_is_writable (ximagesrc->last_ximage)) {
+      /* nobody else uses the last frame anymore, update it in place */
+      GST_LOG_OBJECT (ximagesrc, "Updating last frame in place");
+      ximage = ximagesrc->last_ximage;
+      ximagesrc->last_ximage = NULL;
+    } else {
+      ret = gst_ximage_src_acquire (ximagesrc, &ximage);
+      if (ret != GST_FLOW_OK) {
+        if (rects)
           free (rects);
-        }
+        return ret;
       }
-    } while (XPending (ximagesrc->xcontext->disp));
-    if (!have_frame) {
+
       GST_LOG_OBJECT (ximagesrc,
           "Copying from last frame ximage->size: %" G_GSIZE_FORMAT,
           gst_buffer_get_size (ximage));
       copy_buffer (ximage, ximagesrc->last_ximage);
     }
+    meta = GST_META_XIMAGE_GET (ximage);
+
+    /* Now copy out all of the damaged rectangles. */
+    for (i = 0; i < nrects; i++) {
+      GST_LOG_OBJECT (ximagesrc,
+          "Damaged sub-region @ %d,%d size %dx%d reported",
+          rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+
+      /* if we only want a small area, clip this damage region to
+       * area we want */
+      if (ximagesrc->endx > ximagesrc->startx &&
+          ximagesrc->endy > ximagesrc->starty) {
+        /* see if damage area intersects */
+        if (rects[i].x + rects[i].width - 1 < ximagesrc->startx ||
+            rects[i].x > ximagesrc->endx) {
+          /* trivial reject */
+        } else if (rects[i].y + rects[i].height - 1 < ximagesrc->starty ||
+            rects[i].y > ximagesrc->endy) {
+          /* trivial reject */
+        } else {
+          /* find intersect region */
+          int startx, starty, width, height;
+
+          startx = (rects[i].x < ximagesrc->startx) ? ximagesrc->startx :
+              rects[i].x;
+          starty = (rects[i].y < ximagesrc->starty) ? ximagesrc->starty :
+              rects[i].y;
+          width = (rects[i].x + rects[i].width - 1 < ximagesrc->endx) ?
+              rects[i].x + rects[i].width - startx :
+              ximagesrc->endx - startx + 1;
+          height = (rects[i].y + rects[i].height - 1 < ximagesrc->endy) ?
+              rects[i].y + rects[i].height - starty : ximagesrc->endy -
+              starty + 1;
+
+          GST_LOG_OBJECT (ximagesrc,
+              "Retrieving damaged sub-region @ %d,%d size %dx%d as intersect region",
+              startx, starty, width, height);
+          XGetSubImage (ximagesrc->xcontext->disp, ximagesrc->xwindow,
+              startx, starty, width, height, AllPlanes, ZPixmap,
+              meta->ximage, startx - ximagesrc->startx,
+              starty - ximagesrc->starty);
+        }
+      } else {
+
+        GST_LOG_OBJECT (ximagesrc,
+            "Retrieving damaged sub-region @ %d,%d size %dx%d",
+            rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+
+        XGetSubImage (ximagesrc->xcontext->disp, ximagesrc->xwindow,
+            rects[i].x, rects[i].y,
+            rects[i].width, rects[i].height,
+            AllPlanes, ZPixmap, meta->ximage, rects[i].x, rects[i].y);
+      }
+    }
+    if (rects)
+      free (rects);
+
 #ifdef HAVE_XFIXES
     /* re-get area where last mouse pointer was  but only if in our clipping
      * bounds */
@@ -650,6 +676,10 @@ gst_ximage_src_ximage_get (GstXImageSrc * ximagesrc)
 
   } else {
 #endif
+    ret = gst_ximage_src_acquire (ximagesrc, &ximage);
+    if (ret != GST_FLOW_OK)
+      return ret;
+    meta = GST_META_XIMAGE_GET (ximage);
 
 #ifdef HAVE_XSHM
     if (ximagesrc->xcontext->use_xshm) {
@@ -770,7 +800,9 @@ gst_ximage_src_ximage_get (GstXImageSrc * ximagesrc)
     GST_LOG_OBJECT (ximagesrc, "reffing current buffer for last_ximage");
   }
 #endif
-  return ximage;
+  *buf = ximage;
+
+  return GST_FLOW_OK;
 }
 
 static GstFlowReturn
@@ -782,6 +814,7 @@ gst_ximage_src_create (GstPushSrc * bs, GstBuffer ** buf)
   GstClockTime next_capture_ts;
   GstClockTime dur;
   gint64 next_frame_no;
+  GstFlowReturn fret;
 
   if (!gst_ximage_src_recalc (s)) {
     GST_ELEMENT_ERROR (s, RESOURCE, FAILED,
@@ -792,6 +825,7 @@ gst_ximage_src_create (GstPushSrc * bs, GstBuffer ** buf)
   if (s->fps_n <= 0 || s->fps_d <= 0)
     return GST_FLOW_NOT_NEGOTIATED;     /* FPS must be > 0 */
 
+again:
   /* Now, we might need to wait for the next multiple of the fps
    * before capturing */
 
@@ -857,9 +891,14 @@ gst_ximage_src_create (GstPushSrc * bs, GstBuffer ** buf)
   s->last_frame_no = next_frame_no;
   GST_OBJECT_UNLOCK (s);
 
-  image = gst_ximage_src_ximage_get (s);
-  if (!image)
-    return GST_FLOW_ERROR;
+  fret = gst_ximage_src_ximage_get (s, &image);
+  if (fret == GST_FLOW_CUSTOM_SUCCESS) {
+    GST_LOG_OBJECT (s, "Skipping unchanged frame %" G_GINT64_FORMAT,
+        next_frame_no);
+    goto again;
+  }
+  if (fret != GST_FLOW_OK)
+    return fret;
 
   *buf = image;
   GST_BUFFER_DTS (*buf) = GST_CLOCK_TIME_NONE;
@@ -890,6 +929,9 @@ gst_ximage_src_set_property (GObject * object, guint prop_id,
     case PROP_USE_DAMAGE:
       src->use_damage = g_value_get_boolean (value);
       break;
+    case PROP_SKIP_UNCHANGED:
+      src->skip_unchanged = g_value_get_boolean (value);
+      break;
     case PROP_STARTX:
       src->startx = g_value_get_uint (value);
       break;
@@ -948,6 +990,9 @@ gst_ximage_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_USE_DAMAGE:
       g_value_set_boolean (value, src->use_damage);
       break;
+    case PROP_SKIP_UNCHANGED:
+      g_value_set_boolean (value, src->skip_unchanged);
+      break;
     case PROP_STARTX:
       g_value_set_uint (value, src->startx);
       break;
@@ -975,30 +1020,6 @@ gst_ximage_src_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
-static void
-gst_ximage_src_clear_bufpool (GstXImageSrc * ximagesrc)
-{
-  g_mutex_lock (&ximagesrc->pool_lock);
-  while (ximagesrc->buffer_pool != NULL) {
-    GstBuffer *ximage = ximagesrc->buffer_pool->data;
-
-    gst_ximage_buffer_free (ximage);
-
-    ximagesrc->buffer_pool = g_slist_delete_link (ximagesrc->buffer_pool,
-        ximagesrc->buffer_pool);
-  }
-  g_mutex_unlock (&ximagesrc->pool_lock);
-}
-
-static void
-gst_ximage_src_dispose (GObject * object)
-{
-  /* Drop references in the buffer_pool */
-  gst_ximage_src_clear_bufpool (GST_XIMAGE_SRC (object));
-
-  G_OBJECT_CLASS (parent_class)->dispose (object);
-}
-
 static void
 gst_ximage_src_finalize (GObject * object)
 {
@@ -1008,7 +1029,6 @@ gst_ximage_src_finalize (GObject * object)
     ximageutil_xcontext_clear (src->xcontext);
 
   g_free (src->xname);
-  g_mutex_clear (&src->pool_lock);
   g_mutex_clear (&src->x_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -1085,12 +1105,60 @@ gst_ximage_src_get_caps (GstBaseSrc * bs, GstCaps * filter)
       NULL);
 }
 
+static void
+gst_ximage_src_release_pool (GstXImageSrc * s)
+{
+  if (s->pool) {
+    gst_buffer_pool_set_active (s->pool, FALSE);
+    gst_object_unref (s->pool);
+    s->pool = NULL;
+  }
+}
+
+/* the images are allocated by us, XShm images can't come from downstream */
+static gboolean
+gst_ximage_src_setup_pool (GstXImageSrc * s, GstCaps * caps, guint size)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+
+  pool = gst_ximage_src_pool_new (s);
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, 0, 0);
+  if (!gst_buffer_pool_set_config (pool, config))
+    goto config_failed;
+
+  gst_ximage_src_release_pool (s);
+  s->pool = pool;
+
+  if (!gst_buffer_pool_set_active (pool, TRUE))
+    goto activate_failed;
+
+  return TRUE;
+
+  /* ERRORS */
+config_failed:
+  {
+    GST_WARNING_OBJECT (s, "failed to configure buffer pool");
+    gst_object_unref (pool);
+    return FALSE;
+  }
+activate_failed:
+  {
+    GST_WARNING_OBJECT (s, "failed to activate buffer pool");
+    gst_ximage_src_release_pool (s);
+    return FALSE;
+  }
+}
+
 static gboolean
 gst_ximage_src_set_caps (GstBaseSrc * bs, GstCaps * caps)
 {
   GstXImageSrc *s = GST_XIMAGE_SRC (bs);
   GstStructure *structure;
   const GValue *new_fps;
+  GstVideoInfo info;
 
   /* If not yet opened, disallow setcaps until later */
   if (!s->xcontext)
@@ -1108,7 +1176,10 @@ gst_ximage_src_set_caps (GstBaseSrc * bs, GstCaps * caps)
 
   GST_DEBUG_OBJECT (s, "peer wants %d/%d fps", s->fps_n, s->fps_d);
 
-  return TRUE;
+  if (!gst_video_info_from_caps (&info, caps))
+    return FALSE;
+
+  return gst_ximage_src_setup_pool (s, caps, GST_VIDEO_INFO_SIZE (&info));
 }
 
 static GstCaps *
@@ -1139,7 +1210,6 @@ gst_ximage_src_class_init (GstXImageSrcClass * klass)
 
   gc->set_property = gst_ximage_src_set_property;
   gc->get_property = gst_ximage_src_get_property;
-  gc->dispose = gst_ximage_src_dispose;
   gc->finalize = gst_ximage_src_finalize;
 
   g_object_class_install_property (gc, PROP_DISPLAY_NAME,
@@ -1230,6 +1300,19 @@ gst_ximage_src_class_init (GstXImageSrcClass * klass)
       g_param_spec_string ("xname", "Window name",
           "Window name to capture from", NULL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstXImageSrc:skip-unchanged:
+   *
+   * When XDamage is used and nothing on the screen changed since the last
+   * frame, don't push a frame. Otherwise the last frame is pushed again
+   * without copying it. Downstream will see gaps in the timestamps.
+   *
+   * Since: 1.4
+   */
+  g_object_class_install_property (gc, PROP_SKIP_UNCHANGED,
+      g_param_spec_boolean ("skip-unchanged", "Skip unchanged frames",
+          "Don't push frames when nothing changed (with XDamage)", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (ec, "Ximage video source",
       "Source/Video",
@@ -1254,10 +1337,10 @@ gst_ximage_src_init (GstXImageSrc * ximagesrc)
   gst_base_src_set_format (GST_BASE_SRC (ximagesrc), GST_FORMAT_TIME);
   gst_base_src_set_live (GST_BASE_SRC (ximagesrc), TRUE);
 
-  g_mutex_init (&ximagesrc->pool_lock);
   g_mutex_init (&ximagesrc->x_lock);
   ximagesrc->show_pointer = TRUE;
   ximagesrc->use_damage = TRUE;
+  ximagesrc->skip_unchanged = FALSE;
   ximagesrc->startx = 0;
   ximagesrc->starty = 0;
   ximagesrc->endx = 0;
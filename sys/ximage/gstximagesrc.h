@@ -71,15 +71,15 @@ struct _GstXImageSrc
   /* Protect X Windows calls */
   GMutex  x_lock;
 
-  /* Gathered pool of emitted buffers */
-  GMutex  pool_lock;
-  GSList *buffer_pool;
+  /* pool of the images we capture into */
+  GstBufferPool *pool;
 
   /* XFixes and XDamage support */
   gboolean have_xfixes;
   gboolean have_xdamage;
   gboolean show_pointer;
   gboolean use_damage;
+  gboolean skip_unchanged;
 
   /* co-ordinates for start and end */
   guint startx;
@@ -0,0 +1,168 @@
+/* GStreamer
+ *
+ * gstximagesrcpool.c: buffer pool of ximagesrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstximagesrcpool.h"
+
+#include <gst/video/video.h>
+
+GST_DEBUG_CATEGORY_STATIC (ximagesrcpool_debug);
+#define GST_CAT_DEFAULT (ximagesrcpool_debug)
+
+#define gst_ximage_src_pool_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstXImageSrcPool, gst_ximage_src_pool,
+    GST_TYPE_BUFFER_POOL,
+    GST_DEBUG_CATEGORY_INIT (ximagesrcpool_debug, "ximagesrcpool", 0,
+        "ximagesrc buffer pool"));
+
+static gboolean
+gst_ximage_src_pool_set_config (GstBufferPool * bpool, GstStructure * config)
+{
+  GstXImageSrcPool *pool = GST_XIMAGE_SRC_POOL_CAST (bpool);
+  GstCaps *caps;
+  GstVideoInfo info;
+
+  if (!gst_buffer_pool_config_get_params (config, &caps, NULL, NULL, NULL))
+    goto wrong_config;
+
+  if (caps == NULL || !gst_video_info_from_caps (&info, caps))
+    goto wrong_caps;
+
+  pool->width = GST_VIDEO_INFO_WIDTH (&info);
+  pool->height = GST_VIDEO_INFO_HEIGHT (&info);
+
+  GST_LOG_OBJECT (pool, "configured images of %dx%d", pool->width,
+      pool->height);
+
+  return GST_BUFFER_POOL_CLASS (parent_class)->set_config (bpool, config);
+
+  /* ERRORS */
+wrong_config:
+  {
+    GST_WARNING_OBJECT (pool, "invalid config %" GST_PTR_FORMAT, config);
+    return FALSE;
+  }
+wrong_caps:
+  {
+    GST_WARNING_OBJECT (pool, "failed getting geometry from caps %"
+        GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+}
+
+static GstFlowReturn
+gst_ximage_src_pool_alloc_buffer (GstBufferPool * bpool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstXImageSrcPool *pool = GST_XIMAGE_SRC_POOL_CAST (bpool);
+  GstXImageSrc *src = pool->src;
+  GstBuffer *ximage = NULL;
+
+  GST_DEBUG_OBJECT (pool, "creating image (%dx%d)", pool->width,
+      pool->height);
+
+  g_mutex_lock (&src->x_lock);
+  if (src->xcontext)
+    ximage = gst_ximageutil_ximage_new (src->xcontext, GST_ELEMENT (src),
+        pool->width, pool->height, NULL);
+  g_mutex_unlock (&src->x_lock);
+
+  if (ximage == NULL)
+    goto no_ximage;
+
+  *buffer = ximage;
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+no_ximage:
+  {
+    GST_WARNING_OBJECT (pool, "could not create a %dx%d ximage",
+        pool->width, pool->height);
+    return GST_FLOW_ERROR;
+  }
+}
+
+static void
+gst_ximage_src_pool_free_buffer (GstBufferPool * bpool, GstBuffer * buffer)
+{
+  GstXImageSrcPool *pool = GST_XIMAGE_SRC_POOL_CAST (bpool);
+  GstXImageSrc *src = pool->src;
+
+  GST_LOG_OBJECT (pool, "destroying image %p", buffer);
+
+  /* the X context is gone when the buffer comes back after the element
+   * stopped, the images are then released together with the display */
+  g_mutex_lock (&src->x_lock);
+  gst_ximageutil_ximage_destroy (src->xcontext, buffer);
+  g_mutex_unlock (&src->x_lock);
+
+  GST_BUFFER_POOL_CLASS (parent_class)->free_buffer (bpool, buffer);
+}
+
+static void
+gst_ximage_src_pool_finalize (GObject * object)
+{
+  GstXImageSrcPool *pool = GST_XIMAGE_SRC_POOL_CAST (object);
+
+  gst_object_unref (pool->src);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_ximage_src_pool_init (GstXImageSrcPool * pool)
+{
+}
+
+static void
+gst_ximage_src_pool_class_init (GstXImageSrcPoolClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GstBufferPoolClass *bufferpool_class = GST_BUFFER_POOL_CLASS (klass);
+
+  object_class->finalize = gst_ximage_src_pool_finalize;
+
+  bufferpool_class->set_config = gst_ximage_src_pool_set_config;
+  bufferpool_class->alloc_buffer = gst_ximage_src_pool_alloc_buffer;
+  bufferpool_class->free_buffer = gst_ximage_src_pool_free_buffer;
+}
+
+/**
+ * gst_ximage_src_pool_new:
+ * @src: the #GstXImageSrc the images are captured by
+ *
+ * Construct a new buffer pool for the XImages of @src.
+ *
+ * Returns: the new pool, use gst_object_unref() to free resources
+ */
+GstBufferPool *
+gst_ximage_src_pool_new (GstXImageSrc * src)
+{
+  GstXImageSrcPool *pool;
+
+  pool = g_object_new (GST_TYPE_XIMAGE_SRC_POOL, NULL);
+  pool->src = gst_object_ref (src);
+
+  return GST_BUFFER_POOL_CAST (pool);
+}
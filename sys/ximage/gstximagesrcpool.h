@@ -0,0 +1,67 @@
+/* GStreamer
+ *
+ * gstximagesrcpool.h: buffer pool of ximagesrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_XIMAGE_SRC_POOL_H__
+#define __GST_XIMAGE_SRC_POOL_H__
+
+#include <gst/gst.h>
+
+#include "gstximagesrc.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_XIMAGE_SRC_POOL      (gst_ximage_src_pool_get_type())
+#define GST_IS_XIMAGE_SRC_POOL(obj)   (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_XIMAGE_SRC_POOL))
+#define GST_XIMAGE_SRC_POOL(obj)      (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_XIMAGE_SRC_POOL, GstXImageSrcPool))
+#define GST_XIMAGE_SRC_POOL_CAST(obj) ((GstXImageSrcPool*)(obj))
+
+typedef struct _GstXImageSrcPool GstXImageSrcPool;
+typedef struct _GstXImageSrcPoolClass GstXImageSrcPoolClass;
+
+/**
+ * GstXImageSrcPool:
+ *
+ * A pool of XImages of the capture size, shared memory ones when XShm is
+ * usable. Creating and attaching an shm segment is expensive so the
+ * images are recycled for as long as the pool is active.
+ */
+struct _GstXImageSrcPool
+{
+  GstBufferPool parent;
+
+  /* the element owning the X context, its x_lock protects the X calls */
+  GstXImageSrc *src;
+
+  gint width;
+  gint height;
+};
+
+struct _GstXImageSrcPoolClass
+{
+  GstBufferPoolClass parent_class;
+};
+
+GType gst_ximage_src_pool_get_type (void);
+
+GstBufferPool *gst_ximage_src_pool_new (GstXImageSrc * src);
+
+G_END_DECLS
+
+#endif /* __GST_XIMAGE_SRC_POOL_H__ */
@@ -360,8 +360,10 @@ gst_ximageutil_ximage_new (GstXContext * xcontext,
   gboolean succeeded = FALSE;
 
   ximage = gst_buffer_new ();
-  GST_MINI_OBJECT_CAST (ximage)->dispose =
-      (GstMiniObjectDisposeFunction) gst_ximagesrc_buffer_dispose;
+  /* buffers of a GstBufferPool are recycled by the pool */
+  if (return_func)
+    GST_MINI_OBJECT_CAST (ximage)->dispose =
+        (GstMiniObjectDisposeFunction) gst_ximagesrc_buffer_dispose;
 
   meta = GST_META_XIMAGE_ADD (ximage);
   meta->width = width;
@@ -133,7 +133,8 @@ void ximageutil_calculate_pixel_aspect_ratio (GstXContext * xcontext);
 
 /* custom ximagesrc buffer, copied from ximagesink */
 
-/* BufferReturnFunc is called when a buffer is finalised */
+/* BufferReturnFunc is called when a buffer is finalised, it can be NULL for
+ * the buffers of a GstBufferPool */
 typedef void (*BufferReturnFunc) (GstElement *parent, GstBuffer *buf);
 
 /**
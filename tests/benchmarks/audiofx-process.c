@@ -0,0 +1,211 @@
+/* GStreamer
+ *
+ * audiofx-process.c: benchmark for the audiofx processing functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs
+ *
+ *   audiotestsrc ! audio/x-raw,format=FMT ! ELEMENT ! fakesink
+ *
+ * for the simple audiofx elements with every format and method they
+ * support, and reports the samples per second of the element. The time of
+ * the same pipeline with identity instead of the element is subtracted so
+ * that the test source does not count.
+ *
+ * The Orc kernels fall back to their C implementations when the benchmark
+ * is run with ORC_CODE=backup, which gives the numbers to compare with:
+ *
+ *   audiofx-process
+ *   ORC_CODE=backup audiofx-process
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+typedef struct
+{
+  const gchar *element;
+  const gchar *props;
+  const gchar *formats[6];
+  gint channels;
+} Benchmark;
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define NE(fmt) fmt "LE"
+#else
+#define NE(fmt) fmt "BE"
+#endif
+
+/* *INDENT-OFF* */
+static const Benchmark benchmarks[] = {
+  {"audioamplify", "amplification=1.5 clipping-method=clip",
+      {"S8", NE ("S16"), NE ("S32"), NE ("F32"), NE ("F64"), NULL}, 2},
+  {"audioamplify", "amplification=1.5 clipping-method=wrap-negative",
+      {"S8", NE ("S16"), NE ("S32"), NE ("F32"), NE ("F64"), NULL}, 2},
+  {"audioamplify", "amplification=1.5 clipping-method=wrap-positive",
+      {"S8", NE ("S16"), NE ("S32"), NE ("F32"), NE ("F64"), NULL}, 2},
+  {"audioamplify", "amplification=1.5 clipping-method=none",
+      {"S8", NE ("S16"), NE ("S32"), NE ("F32"), NE ("F64"), NULL}, 2},
+  {"audioinvert", "degree=0.4", {NE ("S16"), NE ("F32"), NULL}, 2},
+  {"audiopanorama", "panorama=-0.5 method=psychoacoustic",
+      {NE ("S16"), NE ("F32"), NULL}, 2},
+  {"audiopanorama", "panorama=-0.5 method=simple",
+      {NE ("S16"), NE ("F32"), NULL}, 2},
+  {"audiokaraoke", "level=0.8", {NE ("S16"), NE ("F32"), NULL}, 2},
+  {"audiodynamic", "characteristics=hard-knee mode=compressor threshold=0.5",
+      {NE ("S16"), NE ("F32"), NULL}, 2},
+  {"audiodynamic", "characteristics=soft-knee mode=expander threshold=0.5",
+      {NE ("S16"), NE ("F32"), NULL}, 2},
+};
+/* *INDENT-ON* */
+
+static gint num_buffers = 2000;
+static gint samples_per_buffer = 4096;
+static gchar *element = NULL;
+static gchar *format = NULL;
+
+static GOptionEntry entries[] = {
+  {"buffers", 'n', 0, G_OPTION_ARG_INT, &num_buffers,
+      "Number of buffers per run (default 2000)", "N"},
+  {"samples", 's', 0, G_OPTION_ARG_INT, &samples_per_buffer,
+      "Samples per channel in a buffer (default 4096)", "SAMPLES"},
+  {"element", 'e', 0, G_OPTION_ARG_STRING, &element,
+      "Only run for this element", "ELEMENT"},
+  {"format", 'f', 0, G_OPTION_ARG_STRING, &format,
+      "Only run for this format", "FORMAT"},
+  {NULL}
+};
+
+/* returns the time of the run in microseconds or -1 on errors */
+static gint64
+run_pipeline (const gchar * filter, const gchar * fmt, gint channels)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  gchar *desc;
+  gint64 start, end, ret = -1;
+
+  desc = g_strdup_printf ("audiotestsrc wave=saw num-buffers=%d "
+      "samplesperbuffer=%d ! audio/x-raw,format=%s,channels=%d,rate=48000 ! "
+      "%s ! fakesink sync=false", num_buffers, samples_per_buffer, fmt,
+      channels, filter);
+  pipeline = gst_parse_launch (desc, &err);
+  g_free (desc);
+  if (!pipeline) {
+    g_printerr ("could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+    return -1;
+  }
+
+  bus = gst_element_get_bus (pipeline);
+
+  start = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = g_get_monotonic_time ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%s %s error: %s\n", filter, fmt, err->message);
+    g_clear_error (&err);
+  } else {
+    ret = end - start;
+  }
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+static gboolean
+run_benchmark (const Benchmark * b, const gchar * fmt)
+{
+  gchar *filter;
+  gint64 base, t;
+  gdouble samples;
+
+  base = run_pipeline ("identity", fmt, b->channels);
+  filter = g_strdup_printf ("%s %s", b->element, b->props);
+  t = run_pipeline (filter, fmt, b->channels);
+  g_free (filter);
+  if (base < 0 || t < 0)
+    return FALSE;
+
+  samples = (gdouble) num_buffers * samples_per_buffer * b->channels;
+  t = MAX (t - base, 1);
+  g_print ("%-14s %-6s %-56s %9.2f Msamples/s\n", b->element, fmt, b->props,
+      samples / t);
+
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gboolean ok = TRUE;
+  guint i, j;
+
+  ctx = g_option_context_new ("- benchmark the audiofx processing functions");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_buffers <= 0 || samples_per_buffer <= 0) {
+    g_printerr ("invalid arguments\n");
+    return 1;
+  }
+
+  g_print ("%d buffers of %d samples, ORC_CODE=%s\n", num_buffers,
+      samples_per_buffer, GST_STR_NULL (g_getenv ("ORC_CODE")));
+
+  for (i = 0; i < G_N_ELEMENTS (benchmarks); i++) {
+    const Benchmark *b = &benchmarks[i];
+
+    if (element && g_strcmp0 (element, b->element))
+      continue;
+
+    for (j = 0; b->formats[j]; j++) {
+      if (format && g_ascii_strcasecmp (format, b->formats[j]))
+        continue;
+      ok &= run_benchmark (b, b->formats[j]);
+    }
+  }
+
+  g_free (element);
+  g_free (format);
+
+  return ok ? 0 : 1;
+}
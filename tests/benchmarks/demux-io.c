@@ -0,0 +1,377 @@
+/* GStreamer
+ *
+ * demux-io.c: benchmark for the input handling of parsers and demuxers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs the demuxer or parser for each of the given files in these modes:
+ *
+ *   pull:     filesrc ! ELEMENT
+ *   push:     pushfilesrc ! ELEMENT
+ *   push-N:   filesrc ! rndbuffersize min=N max=N ! ELEMENT
+ *   push-rnd: filesrc ! rndbuffersize min=1 max=65536 ! ELEMENT
+ *
+ * and every source pad of the element goes to a fakesink. For each run it
+ * reports the MB/s of input, the time until the first buffer arrived in a
+ * sink and the memory allocations from the default allocator per output
+ * buffer, which shows how much the element copies:
+ *
+ *   demux-io file.mp4 file.mkv file.mp3
+ *   demux-io -e wavparse -s 1,188,4096 file.wav
+ *
+ * The element is picked from the file extension unless it is given with -e.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+
+typedef struct
+{
+  const gchar *extension;
+  const gchar *element;
+} Extension;
+
+static const Extension extensions[] = {
+  {"mp4", "qtdemux"}, {"m4a", "qtdemux"}, {"mov", "qtdemux"},
+  {"3gp", "qtdemux"}, {"mkv", "matroskademux"}, {"mka", "matroskademux"},
+  {"webm", "matroskademux"}, {"avi", "avidemux"}, {"flv", "flvdemux"},
+  {"wav", "wavparse"}, {"mp3", "mpegaudioparse"}, {"aac", "aacparse"},
+  {"ac3", "ac3parse"}, {"amr", "amrparse"}, {"dts", "dcaparse"},
+  {"flac", "flacparse"}, {"wv", "wavpackparse"}
+};
+
+/* wraps the system memory allocator to count the allocations */
+typedef GstAllocator CountingAllocator;
+typedef GstAllocatorClass CountingAllocatorClass;
+
+static GType counting_allocator_get_type (void);
+G_DEFINE_TYPE (CountingAllocator, counting_allocator, GST_TYPE_ALLOCATOR);
+
+static GstAllocator *sysmem_allocator;
+static volatile gint n_allocs;
+
+static GstMemory *
+counting_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  g_atomic_int_inc (&n_allocs);
+
+  /* the memory belongs to the system memory allocator and goes back there */
+  return gst_allocator_alloc (sysmem_allocator, size, params);
+}
+
+static void
+counting_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  g_assert_not_reached ();
+}
+
+static void
+counting_allocator_class_init (CountingAllocatorClass * klass)
+{
+  klass->alloc = counting_allocator_alloc;
+  klass->free = counting_allocator_free;
+}
+
+static void
+counting_allocator_init (CountingAllocator * allocator)
+{
+}
+
+typedef struct
+{
+  GstElement *pipeline;
+  volatile gint n_buffers;
+  gint64 start;
+  volatile gint64 first_buffer;
+} Run;
+
+static gint min_size = 1;
+static gint max_size = 65536;
+static gchar *sizes = NULL;
+static gchar *element = NULL;
+
+static GOptionEntry entries[] = {
+  {"element", 'e', 0, G_OPTION_ARG_STRING, &element,
+      "Use this parser or demuxer for all files", "ELEMENT"},
+  {"sizes", 's', 0, G_OPTION_ARG_STRING, &sizes,
+      "Comma separated chunk sizes for rndbuffersize (default 188,4096,65536)",
+      "SIZES"},
+  {NULL}
+};
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buf, GstPad * pad, Run * run)
+{
+  if (g_atomic_int_add (&run->n_buffers, 1) == 0)
+    run->first_buffer = g_get_monotonic_time ();
+}
+
+static GstElement *
+add_sink (Run * run)
+{
+  GstElement *sink;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), run);
+  gst_bin_add (GST_BIN (run->pipeline), sink);
+
+  return sink;
+}
+
+static void
+pad_added_cb (GstElement * demux, GstPad * pad, Run * run)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  sink = add_sink (run);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_element_sync_state_with_parent (sink);
+}
+
+static GstElement *
+make_source (const gchar * file, gint chunk_size)
+{
+  GstElement *src = NULL;
+  gchar *uri;
+
+  if (chunk_size < 0) {
+    uri = g_strdup_printf ("pushfile://%s", file);
+    src = gst_element_make_from_uri (GST_URI_SRC, uri, NULL, NULL);
+    g_free (uri);
+  } else {
+    src = gst_element_factory_make ("filesrc", NULL);
+    if (src)
+      g_object_set (src, "location", file, NULL);
+  }
+
+  return src;
+}
+
+/* @chunk_size is -1 for pushfilesrc, 0 for pull mode and the size of the
+ * rndbuffersize chunks otherwise, with G_MAXINT for random sizes. Returns
+ * FALSE on errors */
+static gboolean
+run_pipeline (const gchar * file, const gchar * name, gint chunk_size,
+    gint64 file_size)
+{
+  GstElement *src, *filter = NULL, *demux, *prev;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  GstPad *srcpad;
+  Run run = { NULL, };
+  gint64 end, t;
+  gchar *mode;
+  gboolean ret = FALSE;
+
+  src = make_source (file, chunk_size);
+  demux = gst_element_factory_make (name, NULL);
+  if (src == NULL || demux == NULL) {
+    g_printerr ("could not create the source or %s\n", name);
+    if (src)
+      gst_object_unref (src);
+    if (demux)
+      gst_object_unref (demux);
+    return FALSE;
+  }
+
+  run.pipeline = gst_pipeline_new (NULL);
+  gst_bin_add_many (GST_BIN (run.pipeline), src, demux, NULL);
+  prev = src;
+
+  if (chunk_size > 0) {
+    filter = gst_element_factory_make ("rndbuffersize", NULL);
+    if (chunk_size == G_MAXINT) {
+      g_object_set (filter, "min", min_size, "max", max_size, "seed", 42,
+          NULL);
+    } else {
+      g_object_set (filter, "min", chunk_size, "max", chunk_size, NULL);
+    }
+    gst_bin_add (GST_BIN (run.pipeline), filter);
+    gst_element_link (src, filter);
+    prev = filter;
+  }
+  gst_element_link (prev, demux);
+
+  /* parsers have a static source pad, demuxers add theirs */
+  srcpad = gst_element_get_static_pad (demux, "src");
+  if (srcpad) {
+    gst_element_link (demux, add_sink (&run));
+    gst_object_unref (srcpad);
+  } else {
+    g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added_cb), &run);
+  }
+
+  bus = gst_element_get_bus (run.pipeline);
+
+  g_atomic_int_set (&n_allocs, 0);
+  run.start = g_get_monotonic_time ();
+  gst_element_set_state (run.pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = g_get_monotonic_time ();
+
+  if (chunk_size < 0)
+    mode = g_strdup ("push");
+  else if (chunk_size == 0)
+    mode = g_strdup ("pull");
+  else if (chunk_size == G_MAXINT)
+    mode = g_strdup ("push-rnd");
+  else
+    mode = g_strdup_printf ("push-%d", chunk_size);
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%s %s %s error: %s\n", name, mode, file, err->message);
+    g_clear_error (&err);
+  } else if (run.n_buffers == 0) {
+    g_printerr ("%s %s %s: no buffers\n", name, mode, file);
+  } else {
+    t = MAX (end - run.start, 1);
+    g_print ("%-16s %-10s %9.2f MB/s %8.2f allocs/buffer %8.2f ms to first "
+        "buffer\n", name, mode, (gdouble) file_size / t,
+        (gdouble) g_atomic_int_get (&n_allocs) / run.n_buffers,
+        (run.first_buffer - run.start) / 1000.0);
+    ret = TRUE;
+  }
+  gst_message_unref (msg);
+  g_free (mode);
+
+  gst_element_set_state (run.pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (run.pipeline);
+
+  return ret;
+}
+
+static const gchar *
+find_element (const gchar * file)
+{
+  const gchar *ext;
+  guint i;
+
+  if (element)
+    return element;
+
+  ext = strrchr (file, '.');
+  if (ext == NULL)
+    return NULL;
+
+  for (i = 0; i < G_N_ELEMENTS (extensions); i++) {
+    if (!g_ascii_strcasecmp (ext + 1, extensions[i].extension))
+      return extensions[i].element;
+  }
+
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gboolean ok = TRUE;
+  gchar **chunk_sizes;
+  gint i, j;
+
+  ctx = g_option_context_new ("FILES - benchmark parsers and demuxers");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (argc < 2) {
+    g_printerr ("no files given\n");
+    return 1;
+  }
+
+  sysmem_allocator = gst_allocator_find (GST_ALLOCATOR_SYSMEM);
+  gst_allocator_set_default (g_object_new (counting_allocator_get_type (),
+          NULL));
+
+  chunk_sizes = g_strsplit (sizes ? sizes : "188,4096,65536", ",", -1);
+
+  for (i = 1; i < argc; i++) {
+    gchar *file;
+    const gchar *name;
+    gint64 file_size;
+    GStatBuf st;
+
+    name = find_element (argv[i]);
+    if (name == NULL) {
+      g_printerr ("%s: no element for this file, use -e\n", argv[i]);
+      ok = FALSE;
+      continue;
+    }
+
+    if (g_path_is_absolute (argv[i])) {
+      file = g_strdup (argv[i]);
+    } else {
+      gchar *cwd = g_get_current_dir ();
+
+      file = g_build_filename (cwd, argv[i], NULL);
+      g_free (cwd);
+    }
+
+    if (g_stat (file, &st) != 0) {
+      g_printerr ("%s: could not stat file\n", file);
+      g_free (file);
+      ok = FALSE;
+      continue;
+    }
+    file_size = st.st_size;
+
+    g_print ("%s, %" G_GINT64_FORMAT " bytes\n", file, file_size);
+
+    ok &= run_pipeline (file, name, 0, file_size);
+    ok &= run_pipeline (file, name, -1, file_size);
+    for (j = 0; chunk_sizes[j]; j++) {
+      gint chunk_size = atoi (chunk_sizes[j]);
+
+      if (chunk_size > 0)
+        ok &= run_pipeline (file, name, chunk_size, file_size);
+    }
+    ok &= run_pipeline (file, name, G_MAXINT, file_size);
+
+    g_free (file);
+  }
+
+  g_strfreev (chunk_sizes);
+  g_free (element);
+  g_free (sizes);
+  gst_object_unref (sysmem_allocator);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,411 @@
+/* GStreamer
+ *
+ * rtpbin-receive.c: benchmark for the RTP receive path
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Feeds synthetic RTP packets over UDP into
+ *
+ *   udpsrc ! rtpbin ! rtpmp2tdepay ! fakesink
+ *
+ * with one depayloader and sink per SSRC, and reports the throughput, the
+ * CPU time per packet and percentiles of the latency between sending a
+ * packet and its arrival in the sink.
+ *
+ * The send time of each packet is stored in the first bytes of its payload,
+ * which rtpmp2tdepay passes on unmodified.
+ *
+ *   rtpbin-receive --rate 20000 --packets 200000 --ssrcs 4 --loss 1
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include <gst/gst.h>
+#include <gio/gio.h>
+
+#define RTP_HEADER_LEN 12
+#define PAYLOAD_TYPE   33
+#define CLOCK_RATE     90000
+
+static gint rate = 10000;
+static gint num_packets = 100000;
+static gint num_ssrcs = 1;
+static gint payload_size = 1316;
+static gdouble loss = 0.0;
+static gdouble reorder = 0.0;
+static gint latency = 50;
+static gint port = 5004;
+static gboolean buffer_list = FALSE;
+
+static GOptionEntry entries[] = {
+  {"rate", 'r', 0, G_OPTION_ARG_INT, &rate,
+      "Packets per second over all SSRCs (default 10000)", "PPS"},
+  {"packets", 'n', 0, G_OPTION_ARG_INT, &num_packets,
+      "Number of packets to send (default 100000)", "N"},
+  {"ssrcs", 's', 0, G_OPTION_ARG_INT, &num_ssrcs,
+      "Number of SSRCs (default 1)", "N"},
+  {"payload-size", 'p', 0, G_OPTION_ARG_INT, &payload_size,
+      "Payload size in bytes (default 1316)", "BYTES"},
+  {"loss", 'l', 0, G_OPTION_ARG_DOUBLE, &loss,
+      "Percentage of packets to drop (default 0)", "PERCENT"},
+  {"reorder", 'o', 0, G_OPTION_ARG_DOUBLE, &reorder,
+      "Percentage of packets to swap with the next one (default 0)",
+      "PERCENT"},
+  {"latency", 'L', 0, G_OPTION_ARG_INT, &latency,
+      "Latency of the jitterbuffer in ms (default 50)", "MS"},
+  {"port", 'P', 0, G_OPTION_ARG_INT, &port,
+      "UDP port to use (default 5004)", "PORT"},
+  {"buffer-list", 'b', 0, G_OPTION_ARG_NONE, &buffer_list,
+      "Make the jitterbuffer push buffer lists", NULL},
+  {NULL}
+};
+
+typedef struct
+{
+  GMutex lock;
+  /* latency of each received packet in us */
+  GArray *latencies;
+  gint64 first_time;
+  gint64 last_time;
+} Stats;
+
+static Stats stats;
+
+static gint64
+get_cpu_time (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+        G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+  return 0;
+}
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad, gpointer data)
+{
+  gint64 now, sent;
+  guint8 bytes[8];
+  gint32 latency_us;
+
+  now = g_get_monotonic_time ();
+  if (gst_buffer_extract (buffer, 0, bytes, 8) != 8)
+    return;
+  sent = GST_READ_UINT64_BE (bytes);
+  latency_us = (gint32) CLAMP (now - sent, 0, G_MAXINT32);
+
+  g_mutex_lock (&stats.lock);
+  if (stats.first_time == 0)
+    stats.first_time = now;
+  stats.last_time = now;
+  g_array_append_val (stats.latencies, latency_us);
+  g_mutex_unlock (&stats.lock);
+}
+
+static void
+pad_added (GstElement * rtpbin, GstPad * pad, GstElement * pipeline)
+{
+  GstElement *depay, *sink;
+  GstPad *sinkpad;
+  gchar *name;
+
+  name = gst_pad_get_name (pad);
+  if (!g_str_has_prefix (name, "recv_rtp_src_")) {
+    g_free (name);
+    return;
+  }
+  g_free (name);
+
+  depay = gst_element_factory_make ("rtpmp2tdepay", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_assert (depay && sink);
+
+  g_object_set (sink, "sync", FALSE, "async", FALSE, "signal-handoffs", TRUE,
+      NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), depay, sink, NULL);
+  gst_element_link (depay, sink);
+  gst_element_sync_state_with_parent (sink);
+  gst_element_sync_state_with_parent (depay);
+
+  sinkpad = gst_element_get_static_pad (depay, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    g_printerr ("could not link depayloader\n");
+  gst_object_unref (sinkpad);
+}
+
+static void
+new_jitterbuffer (GstElement * rtpbin, GstElement * jitterbuffer,
+    guint session, guint ssrc, gpointer data)
+{
+  if (buffer_list &&
+      g_object_class_find_property (G_OBJECT_GET_CLASS (jitterbuffer),
+          "buffer-list"))
+    g_object_set (jitterbuffer, "buffer-list", TRUE, NULL);
+}
+
+static GstElement *
+create_pipeline (void)
+{
+  GstElement *pipeline, *udpsrc, *rtpbin;
+  GstCaps *caps;
+  GstPad *srcpad, *sinkpad;
+
+  pipeline = gst_pipeline_new (NULL);
+  udpsrc = gst_element_factory_make ("udpsrc", NULL);
+  rtpbin = gst_element_factory_make ("rtpbin", NULL);
+  if (!udpsrc || !rtpbin) {
+    g_printerr ("udpsrc or rtpbin not available\n");
+    exit (1);
+  }
+
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "video",
+      "clock-rate", G_TYPE_INT, CLOCK_RATE,
+      "encoding-name", G_TYPE_STRING, "MP2T",
+      "payload", G_TYPE_INT, PAYLOAD_TYPE, NULL);
+  g_object_set (udpsrc, "port", port, "caps", caps,
+      "buffer-size", 8 * 1024 * 1024, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (rtpbin, "latency", latency, NULL);
+  g_signal_connect (rtpbin, "pad-added", (GCallback) pad_added, pipeline);
+  g_signal_connect (rtpbin, "new-jitterbuffer", (GCallback) new_jitterbuffer,
+      NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), udpsrc, rtpbin, NULL);
+
+  srcpad = gst_element_get_static_pad (udpsrc, "src");
+  sinkpad = gst_element_get_request_pad (rtpbin, "recv_rtp_sink_0");
+  gst_pad_link (srcpad, sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return pipeline;
+}
+
+static gsize
+make_packet (guint8 * data, guint16 seqnum, guint32 rtptime, guint32 ssrc)
+{
+  data[0] = 0x80;
+  data[1] = PAYLOAD_TYPE;
+  GST_WRITE_UINT16_BE (data + 2, seqnum);
+  GST_WRITE_UINT32_BE (data + 4, rtptime);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  /* the send time is written just before sending */
+  memset (data + RTP_HEADER_LEN + 8, 0x47, payload_size - 8);
+
+  return RTP_HEADER_LEN + payload_size;
+}
+
+static void
+send_packet (GSocket * socket, GSocketAddress * addr, guint8 * data,
+    gsize len)
+{
+  GError *err = NULL;
+
+  GST_WRITE_UINT64_BE (data + RTP_HEADER_LEN, g_get_monotonic_time ());
+  if (g_socket_send_to (socket, addr, (const gchar *) data, len, NULL,
+          &err) < 0) {
+    g_printerr ("send failed: %s\n", err->message);
+    g_clear_error (&err);
+  }
+}
+
+/* send all packets at the configured rate, returns the number of packets
+ * that was sent */
+static gint
+send_packets (void)
+{
+  GSocket *socket;
+  GSocketAddress *addr;
+  GInetAddress *inet;
+  guint8 *data, *held;
+  gsize len, held_len = 0;
+  gint64 start, target;
+  guint16 *seqnums;
+  gint i, sent = 0;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  g_assert (socket);
+  inet = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (inet, port);
+  g_object_unref (inet);
+
+  data = g_malloc (RTP_HEADER_LEN + payload_size);
+  held = g_malloc (RTP_HEADER_LEN + payload_size);
+  seqnums = g_new0 (guint16, num_ssrcs);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < num_packets; i++) {
+    gint s = i % num_ssrcs;
+    guint32 rtptime;
+
+    /* pace the packets */
+    target = start + (gint64) i * G_USEC_PER_SEC / rate;
+    while (g_get_monotonic_time () < target)
+      g_usleep (MIN (target - g_get_monotonic_time (), 1000));
+
+    /* one frame per packet per SSRC */
+    rtptime = (guint32) ((guint64) (i / num_ssrcs) * CLOCK_RATE * num_ssrcs /
+        rate);
+    len = make_packet (data, seqnums[s]++, rtptime, 0x10000 + s);
+
+    if (loss > 0.0 && g_random_double_range (0.0, 100.0) < loss)
+      continue;
+
+    if (held_len > 0) {
+      /* send the held packet after this one */
+      send_packet (socket, addr, data, len);
+      send_packet (socket, addr, held, held_len);
+      sent += 2;
+      held_len = 0;
+      continue;
+    }
+    if (reorder > 0.0 && g_random_double_range (0.0, 100.0) < reorder) {
+      memcpy (held, data, len);
+      held_len = len;
+      continue;
+    }
+    send_packet (socket, addr, data, len);
+    sent++;
+  }
+  if (held_len > 0) {
+    send_packet (socket, addr, held, held_len);
+    sent++;
+  }
+
+  g_free (seqnums);
+  g_free (held);
+  g_free (data);
+  g_object_unref (addr);
+  g_object_unref (socket);
+
+  return sent;
+}
+
+static gint
+compare_int32 (gconstpointer a, gconstpointer b)
+{
+  return *(const gint32 *) a - *(const gint32 *) b;
+}
+
+static gint32
+percentile (GArray * array, gdouble p)
+{
+  guint idx;
+
+  if (array->len == 0)
+    return 0;
+
+  idx = MIN ((guint) (p / 100.0 * array->len), array->len - 1);
+  return g_array_index (array, gint32, idx);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GstElement *pipeline;
+  gint64 cpu_start, cpu_end, start, end;
+  gint sent;
+  guint received;
+  gdouble elapsed;
+
+  ctx = g_option_context_new ("- benchmark the RTP receive path");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (rate <= 0 || num_packets <= 0 || num_ssrcs <= 0 || payload_size < 8) {
+    g_printerr ("invalid arguments\n");
+    return 1;
+  }
+
+  g_mutex_init (&stats.lock);
+  stats.latencies = g_array_sized_new (FALSE, FALSE, sizeof (gint32),
+      num_packets);
+
+  pipeline = create_pipeline ();
+  if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    g_printerr ("could not start pipeline\n");
+    return 1;
+  }
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  g_print ("sending %d packets of %d bytes at %d packets/s for %d SSRCs\n",
+      num_packets, payload_size, rate, num_ssrcs);
+
+  cpu_start = get_cpu_time ();
+  start = g_get_monotonic_time ();
+  sent = send_packets ();
+
+  /* wait for the jitterbuffers to drain */
+  g_usleep ((latency + 500) * 1000);
+  end = g_get_monotonic_time ();
+  cpu_end = get_cpu_time ();
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  received = stats.latencies->len;
+  g_array_sort (stats.latencies, compare_int32);
+
+  elapsed = stats.last_time > stats.first_time ?
+      (stats.last_time - stats.first_time) / (gdouble) G_USEC_PER_SEC : 0.0;
+
+  g_print ("sent %d, received %u packets in %.3f s\n", sent, received,
+      elapsed);
+  if (elapsed > 0.0)
+    g_print ("throughput: %.0f packets/s\n", received / elapsed);
+  if (received > 0 && cpu_end > cpu_start)
+    g_print ("cpu: %.2f us/packet (%.1f%% of %.3f s, sender included)\n",
+        (cpu_end - cpu_start) / (gdouble) received,
+        100.0 * (cpu_end - cpu_start) / (end - start),
+        (end - start) / (gdouble) G_USEC_PER_SEC);
+  g_print ("latency (us): p50 %d, p90 %d, p99 %d, p99.9 %d, max %d\n",
+      percentile (stats.latencies, 50.0), percentile (stats.latencies, 90.0),
+      percentile (stats.latencies, 99.0), percentile (stats.latencies, 99.9),
+      percentile (stats.latencies, 100.0));
+
+  g_array_free (stats.latencies, TRUE);
+  g_mutex_clear (&stats.lock);
+
+  return 0;
+}
@@ -0,0 +1,314 @@
+/* GStreamer
+ *
+ * video-filters.c: benchmark for the pixel processing of the video filters
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs
+ *
+ *   videotestsrc ! video/x-raw,format=FMT,width=W,height=H ! ELEMENT ! fakesink
+ *
+ * for the video filters with every format of their sink pad template that
+ * videotestsrc can produce, at 720p, 1080p and 2160p, and reports the time
+ * per pixel of the element. The time of the same pipeline with identity
+ * instead of the element is subtracted so that the test source does not
+ * count. shapewipe gets its mask from a second videotestsrc, whose time is
+ * counted too. The blending of videomixer is measured by videomixer-blend.
+ *
+ * The Orc kernels fall back to their C implementations when the benchmark
+ * is run with ORC_CODE=backup, which gives the numbers to compare with:
+ *
+ *   video-filters
+ *   ORC_CODE=backup video-filters
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+typedef struct
+{
+  const gchar *element;
+  const gchar *props;
+} Benchmark;
+
+/* *INDENT-OFF* */
+static const Benchmark benchmarks[] = {
+  {"videobox", "left=16 right=16 top=16 bottom=16"},
+  {"videobox", "left=-16 right=-16 top=-16 bottom=-16 alpha=0.5"},
+  {"alpha", "method=set alpha=0.5"},
+  {"alpha", "method=green"},
+  {"videoflip", "method=horizontal-flip"},
+  {"videoflip", "method=clockwise"},
+  {"videobalance", "saturation=0.5 hue=0.2 brightness=0.1 contrast=1.2"},
+  {"gamma", "gamma=1.5"},
+  {"videomedian", "filtersize=5"},
+  {"videomedian", "filtersize=9"},
+  {"deinterlace", "mode=interlaced method=linear"},
+  {"deinterlace", "mode=interlaced method=linearblend"},
+  {"deinterlace", "mode=interlaced method=vfir"},
+  {"deinterlace", "mode=interlaced method=greedyl"},
+  {"deinterlace", "mode=interlaced method=greedyh"},
+  {"deinterlace", "mode=interlaced method=tomsmocomp"},
+  {"deinterlace", "mode=interlaced method=scalerbob"},
+  {"shapewipe", "position=0.5 border=0.1"},
+  {"smptealpha", "type=1 position=0.5"},
+  {"smptealpha", "type=23 position=0.5 border=100"},
+};
+/* *INDENT-ON* */
+
+static const gint resolutions[][2] = {
+  {1280, 720}, {1920, 1080}, {3840, 2160}
+};
+
+static gint num_frames = 50;
+static gchar *element = NULL;
+static gchar *format = NULL;
+static gint height = 0;
+
+static GOptionEntry entries[] = {
+  {"frames", 'n', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames per run (default 50)", "N"},
+  {"element", 'e', 0, G_OPTION_ARG_STRING, &element,
+      "Only run for this element", "ELEMENT"},
+  {"format", 'f', 0, G_OPTION_ARG_STRING, &format,
+      "Only run for this format", "FORMAT"},
+  {"height", 'H', 0, G_OPTION_ARG_INT, &height,
+      "Only run for this resolution (720, 1080 or 2160)", "LINES"},
+  {NULL}
+};
+
+static void
+add_format (GPtrArray * formats, const gchar * fmt)
+{
+  guint i;
+
+  for (i = 0; i < formats->len; i++) {
+    if (!g_strcmp0 (g_ptr_array_index (formats, i), fmt))
+      return;
+  }
+  g_ptr_array_add (formats, g_strdup (fmt));
+}
+
+/* collects the raw video formats of the pad template @name of @factory_name
+ * in a new array of strings */
+static GPtrArray *
+get_formats (const gchar * factory_name, const gchar * name)
+{
+  GstElementFactory *factory;
+  const GList *l;
+  GPtrArray *formats;
+
+  formats = g_ptr_array_new_with_free_func (g_free);
+
+  factory = gst_element_factory_find (factory_name);
+  if (factory == NULL)
+    return formats;
+
+  for (l = gst_element_factory_get_static_pad_templates (factory); l;
+      l = l->next) {
+    GstStaticPadTemplate *templ = l->data;
+    GstCaps *caps;
+    guint i, j;
+
+    if (g_strcmp0 (templ->name_template, name))
+      continue;
+
+    caps = gst_static_caps_get (&templ->static_caps);
+    for (i = 0; i < gst_caps_get_size (caps); i++) {
+      GstStructure *s = gst_caps_get_structure (caps, i);
+      const GValue *v = gst_structure_get_value (s, "format");
+
+      if (!gst_structure_has_name (s, "video/x-raw") || v == NULL)
+        continue;
+
+      if (G_VALUE_HOLDS_STRING (v)) {
+        add_format (formats, g_value_get_string (v));
+      } else if (GST_VALUE_HOLDS_LIST (v)) {
+        for (j = 0; j < gst_value_list_get_size (v); j++)
+          add_format (formats,
+              g_value_get_string (gst_value_list_get_value (v, j)));
+      }
+    }
+    gst_caps_unref (caps);
+  }
+  gst_object_unref (factory);
+
+  return formats;
+}
+
+static gboolean
+has_format (GPtrArray * formats, const gchar * fmt)
+{
+  guint i;
+
+  for (i = 0; i < formats->len; i++) {
+    if (!g_strcmp0 (g_ptr_array_index (formats, i), fmt))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* returns the time of the run in microseconds or -1 on errors */
+static gint64
+run_pipeline (const gchar * filter, const gchar * fmt, gint w, gint h,
+    gboolean mask)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  gchar *desc, *mask_desc = NULL;
+  gint64 start, end, ret = -1;
+
+  if (mask) {
+    mask_desc = g_strdup_printf ("videotestsrc pattern=gradient "
+        "num-buffers=%d ! video/x-raw,format=GRAY8,width=%d,height=%d ! "
+        "f.mask_sink", num_frames, w, h);
+  }
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=%d ! "
+      "video/x-raw,format=%s,width=%d,height=%d,framerate=30/1 ! "
+      "%s name=f ! fakesink sync=false %s", num_frames, fmt, w, h, filter,
+      mask_desc ? mask_desc : "");
+  pipeline = gst_parse_launch (desc, &err);
+  g_free (desc);
+  g_free (mask_desc);
+  if (!pipeline) {
+    g_printerr ("could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+    return -1;
+  }
+
+  bus = gst_element_get_bus (pipeline);
+
+  start = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = g_get_monotonic_time ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%s %s %dx%d error: %s\n", filter, fmt, w, h, err->message);
+    g_clear_error (&err);
+  } else {
+    ret = end - start;
+  }
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+static gboolean
+run_benchmark (const Benchmark * b, const gchar * fmt, gint w, gint h)
+{
+  gboolean mask = !g_strcmp0 (b->element, "shapewipe");
+  gchar *filter;
+  gint64 base, t;
+  gdouble pixels;
+
+  base = run_pipeline ("identity", fmt, w, h, FALSE);
+  filter = g_strdup_printf ("%s %s", b->element, b->props);
+  t = run_pipeline (filter, fmt, w, h, mask);
+  g_free (filter);
+  if (base < 0 || t < 0)
+    return FALSE;
+
+  pixels = (gdouble) num_frames * w * h;
+  t = MAX (t - base, 1);
+  g_print ("%-13s %-6s %4dp %-48s %7.3f ns/pixel\n", b->element, fmt, h,
+      b->props, t * 1000.0 / pixels);
+
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GPtrArray *src_formats;
+  gboolean ok = TRUE;
+  guint i, j, k;
+
+  ctx = g_option_context_new ("- benchmark the video filter kernels");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames <= 0) {
+    g_printerr ("invalid arguments\n");
+    return 1;
+  }
+
+  g_print ("%d frames, ORC_CODE=%s\n", num_frames,
+      GST_STR_NULL (g_getenv ("ORC_CODE")));
+
+  src_formats = get_formats ("videotestsrc", "src");
+
+  for (i = 0; i < G_N_ELEMENTS (benchmarks); i++) {
+    const Benchmark *b = &benchmarks[i];
+    GPtrArray *formats;
+
+    if (element && g_strcmp0 (element, b->element))
+      continue;
+
+    formats = get_formats (b->element,
+        g_strcmp0 (b->element, "shapewipe") ? "sink" : "video_sink");
+    if (formats->len == 0) {
+      g_printerr ("%s: element not found\n", b->element);
+      ok = FALSE;
+    }
+
+    for (j = 0; j < formats->len; j++) {
+      const gchar *fmt = g_ptr_array_index (formats, j);
+
+      if (format && g_ascii_strcasecmp (format, fmt))
+        continue;
+      if (!has_format (src_formats, fmt))
+        continue;
+
+      for (k = 0; k < G_N_ELEMENTS (resolutions); k++) {
+        if (height && height != resolutions[k][1])
+          continue;
+        ok &= run_benchmark (b, fmt, resolutions[k][0], resolutions[k][1]);
+      }
+    }
+    g_ptr_array_unref (formats);
+  }
+
+  g_ptr_array_unref (src_formats);
+  g_free (element);
+  g_free (format);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/* GStreamer
+ *
+ * videomixer-blend.c: benchmark for the videomixer blend and fill functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs
+ *
+ *   videotestsrc ! video/x-raw,format=FMT ! videomixer ! fakesink
+ *
+ * for every format videomixer can blend, with the pad smaller than the
+ * output and a pad alpha below 1.0 so that every frame is filled with the
+ * background and then blended, and reports the time per frame.
+ *
+ * The Orc kernels fall back to their C implementations when the benchmark
+ * is run with ORC_CODE=backup, which gives the numbers to compare with:
+ *
+ *   videomixer-blend --background checker
+ *   ORC_CODE=backup videomixer-blend --background checker
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+static const gchar *formats[] = {
+  "AYUV", "ARGB", "BGRA", "ABGR", "RGBA", "Y444", "Y42B", "YUY2", "UYVY",
+  "YVYU", "I420", "YV12", "NV12", "NV21", "Y41B", "RGB", "BGR", "xRGB",
+  "xBGR", "RGBx", "BGRx", NULL
+};
+
+static gint num_frames = 300;
+static gint width = 1280;
+static gint height = 720;
+static gdouble alpha = 0.5;
+static gchar *background = NULL;
+static gchar *format = NULL;
+
+static GOptionEntry entries[] = {
+  {"frames", 'n', 0, G_OPTION_ARG_INT, &num_frames,
+      "Number of frames per format (default 300)", "N"},
+  {"width", 'W', 0, G_OPTION_ARG_INT, &width,
+      "Output width (default 1280)", "PIXELS"},
+  {"height", 'H', 0, G_OPTION_ARG_INT, &height,
+      "Output height (default 720)", "PIXELS"},
+  {"alpha", 'a', 0, G_OPTION_ARG_DOUBLE, &alpha,
+      "Alpha of the input pad (default 0.5)", "ALPHA"},
+  {"background", 'b', 0, G_OPTION_ARG_STRING, &background,
+      "Background of the mixer (default checker)", "BACKGROUND"},
+  {"format", 'f', 0, G_OPTION_ARG_STRING, &format,
+      "Only run for this format", "FORMAT"},
+  {NULL}
+};
+
+static gboolean
+run_format (const gchar * fmt)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GError *err = NULL;
+  gchar *desc;
+  gchar alpha_str[G_ASCII_DTOSTR_BUF_SIZE];
+  gint64 start, end;
+  gboolean ret = FALSE;
+
+  g_ascii_dtostr (alpha_str, sizeof (alpha_str), alpha);
+
+  /* the input covers the middle of the output, the rest is background */
+  desc = g_strdup_printf ("videomixer name=mix background=%s "
+      "sink_0::xpos=%d sink_0::ypos=%d sink_0::alpha=%s ! "
+      "video/x-raw,format=%s,width=%d,height=%d ! fakesink sync=false "
+      "videotestsrc num-buffers=%d pattern=ball ! "
+      "video/x-raw,format=%s,width=%d,height=%d,framerate=30/1 ! mix.",
+      background, width / 4, height / 4, alpha_str, fmt, width, height,
+      num_frames, fmt, width / 2, height / 2);
+  pipeline = gst_parse_launch (desc, &err);
+  g_free (desc);
+  if (!pipeline) {
+    g_printerr ("could not create pipeline: %s\n", err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+
+  bus = gst_element_get_bus (pipeline);
+
+  start = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = g_get_monotonic_time ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("%-5s error: %s\n", fmt, err->message);
+    g_clear_error (&err);
+  } else {
+    g_print ("%-5s %8.3f ms/frame\n", fmt,
+        (end - start) / 1000.0 / num_frames);
+    ret = TRUE;
+  }
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gboolean ok = TRUE;
+  gint i;
+
+  ctx = g_option_context_new ("- benchmark the videomixer blend functions");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_frames <= 0 || width < 4 || height < 4) {
+    g_printerr ("invalid arguments\n");
+    return 1;
+  }
+  if (!background)
+    background = g_strdup ("checker");
+
+  g_print ("%d frames of %dx%d, background %s, alpha %.2f, ORC_CODE=%s\n",
+      num_frames, width, height, background, alpha,
+      GST_STR_NULL (g_getenv ("ORC_CODE")));
+
+  for (i = 0; formats[i]; i++) {
+    if (format && g_ascii_strcasecmp (format, formats[i]))
+      continue;
+    ok &= run_format (formats[i]);
+  }
+
+  g_free (background);
+  g_free (format);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/* GStreamer ALawDec unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+static GstElement *alawdec = NULL;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw,"
+        "format = (string) " GST_AUDIO_NE (S16) ", "
+        "rate = (int) 8000, "
+        "channels = (int) 1, " "layout = (string)interleaved")
+    );
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-alaw," "rate = (int) 8000," "channels = (int) 1")
+    );
+
+static void
+alawdec_setup (void)
+{
+  GstCaps *src_caps;
+
+  src_caps =
+      gst_caps_from_string ("audio/x-alaw," "rate = (int) 8000,"
+      "channels = (int) 1");
+
+  GST_DEBUG ("%s", __FUNCTION__);
+
+  alawdec = gst_check_setup_element ("alawdec");
+
+  mysrcpad = gst_check_setup_src_pad (alawdec, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (alawdec, &sinktemplate);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  gst_check_setup_events (mysrcpad, alawdec, src_caps, GST_FORMAT_TIME);
+
+  fail_unless (gst_element_set_state (alawdec, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS, "could not change state to playing");
+
+  gst_caps_unref (src_caps);
+}
+
+static void
+buffer_unref (void *buffer, void *user_data)
+{
+  gst_buffer_unref (GST_BUFFER (buffer));
+}
+
+static void
+alawdec_teardown (void)
+{
+  /* free decoded buffers */
+  g_list_foreach (buffers, buffer_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_element_set_state (alawdec, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (alawdec);
+  gst_check_teardown_sink_pad (alawdec);
+  gst_check_teardown_element (alawdec);
+  alawdec = NULL;
+}
+
+/* The G.711 decoder as it computed every sample before the lookup table */
+static gint16
+reference_decode (guint8 a_val)
+{
+  gint t;
+  gint seg;
+
+  a_val ^= 0x55;
+  t = a_val & 0x7f;
+  if (t < 16) {
+    t = (t << 4) + 8;
+  } else {
+    seg = (t >> 4) & 0x07;
+    t = ((t & 0x0f) << 4) + 0x108;
+    t <<= seg - 1;
+  }
+  return ((a_val & 0x80) ? t : -t);
+}
+
+/* a buffer of @size codes, counting up from @first */
+static GstBuffer *
+make_codes (gint first, gint size)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint i;
+
+  buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < size; i++)
+    map.data[i] = (guint8) (first + i);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static void
+check_decoded (GstBuffer * buffer, gint first, gint size)
+{
+  GstMapInfo map;
+  gint16 *samples;
+  gint i;
+
+  fail_unless_equals_int (gst_buffer_get_size (buffer), size * 2);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  samples = (gint16 *) map.data;
+  for (i = 0; i < size; i++)
+    fail_unless_equals_int (samples[i], reference_decode (first + i));
+  gst_buffer_unmap (buffer, &map);
+}
+
+GST_START_TEST (test_decode_all_codes)
+{
+  GstBuffer *buffer;
+
+  buffer = make_codes (0, 256);
+  GST_BUFFER_TIMESTAMP (buffer) = 0;
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  buffer = GST_BUFFER (buffers->data);
+  check_decoded (buffer, 0, 256);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer), 0);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+      gst_util_uint64_scale_int (256, GST_SECOND, 8000));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_decode_list)
+{
+  static const gint sizes[] = { 160, 1, 33, 0, 256 };
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GstClockTime ts = 0;
+  GList *l;
+  gint i;
+
+  /* small packets as a depayloader would hand them out */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    buffer = make_codes (i * 77, sizes[i]);
+    GST_BUFFER_TIMESTAMP (buffer) = ts;
+    gst_buffer_list_add (list, buffer);
+    ts += gst_util_uint64_scale_int (sizes[i], GST_SECOND, 8000);
+  }
+
+  fail_unless (gst_pad_push_list (mysrcpad, list) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), G_N_ELEMENTS (sizes));
+  ts = 0;
+  for (i = 0, l = buffers; l; i++, l = l->next) {
+    GstBuffer *out = GST_BUFFER (l->data);
+    GstClockTime duration;
+
+    duration = gst_util_uint64_scale_int (sizes[i], GST_SECOND, 8000);
+    check_decoded (out, i * 77, sizes[i]);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (out), ts);
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (out), duration);
+    ts += duration;
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+alawdec_suite (void)
+{
+  Suite *s = suite_create ("alawdec");
+  TCase *tc_chain = tcase_create ("alawdec");
+
+  tcase_add_checked_fixture (tc_chain, alawdec_setup, alawdec_teardown);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_decode_all_codes);
+  tcase_add_test (tc_chain, test_decode_list);
+  return s;
+}
+
+GST_CHECK_MAIN (alawdec)
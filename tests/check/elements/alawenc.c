@@ -0,0 +1,285 @@
+/* GStreamer ALawEnc unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+#include <string.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+static GstElement *alawenc = NULL;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-alaw," "rate = (int) 8000,"
+        "channels = (int) 1")
+    );
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw,"
+        "format = (string) " GST_AUDIO_NE (S16) ", "
+        "rate = (int) 8000, "
+        "channels = (int) 1, " "layout = (string)interleaved")
+    );
+
+static void
+alawenc_setup (void)
+{
+  GstCaps *src_caps;
+
+  src_caps = gst_caps_from_string ("audio/x-raw,"
+      "format = (string) " GST_AUDIO_NE (S16) ", "
+      "rate = (int) 8000, "
+      "channels = (int) 1, " "layout = (string)interleaved");
+
+  GST_DEBUG ("%s", __FUNCTION__);
+
+  alawenc = gst_check_setup_element ("alawenc");
+
+  mysrcpad = gst_check_setup_src_pad (alawenc, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (alawenc, &sinktemplate);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  gst_check_setup_events (mysrcpad, alawenc, src_caps, GST_FORMAT_TIME);
+
+  fail_unless (gst_element_set_state (alawenc, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS, "could not change state to playing");
+
+  gst_caps_unref (src_caps);
+}
+
+static void
+buffer_unref (void *buffer, void *user_data)
+{
+  gst_buffer_unref (GST_BUFFER (buffer));
+}
+
+static void
+alawenc_teardown (void)
+{
+  /* free encoded buffers */
+  g_list_foreach (buffers, buffer_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_element_set_state (alawenc, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (alawenc);
+  gst_check_teardown_sink_pad (alawenc);
+  gst_check_teardown_element (alawenc);
+  alawenc = NULL;
+}
+
+/* The G.711 encoder as it computed every sample before the lookup table,
+ * the table is filled from the same segment search */
+static gint
+reference_segment (gint val)
+{
+  gint r = 1;
+
+  val >>= 8;
+  if (val & 0xf0) {
+    val >>= 4;
+    r += 4;
+  }
+  if (val & 0x0c) {
+    val >>= 2;
+    r += 2;
+  }
+  if (val & 0x02)
+    r += 1;
+  return r;
+}
+
+static guint8
+reference_encode (gint pcm_val)
+{
+  gint mask;
+  gint seg;
+  guint8 aval;
+
+  if (pcm_val >= 0) {
+    mask = 0xD5;
+  } else {
+    mask = 0x55;
+    pcm_val = -pcm_val;
+    if (pcm_val > 0x7fff)
+      pcm_val = 0x7fff;
+  }
+
+  if (pcm_val < 256) {
+    aval = pcm_val >> 4;
+  } else {
+    seg = reference_segment (pcm_val);
+    aval = (seg << 4) | ((pcm_val >> (seg + 3)) & 0x0f);
+  }
+  return aval ^ mask;
+}
+
+/* a buffer holding every S16 value once, starting at @first */
+static GstBuffer *
+make_all_samples (gint first)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint16 *samples;
+  gint i;
+
+  buffer = gst_buffer_new_allocate (NULL, 65536 * sizeof (gint16), NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  samples = (gint16 *) map.data;
+  for (i = 0; i < 65536; i++)
+    samples[i] = (gint16) (first + i);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static void
+check_encoded (GstBuffer * buffer, gint first, gint count)
+{
+  GstMapInfo map;
+  gint i;
+
+  fail_unless_equals_int (gst_buffer_get_size (buffer), count);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  for (i = 0; i < count; i++) {
+    gint16 sample = (gint16) (first + i);
+
+    fail_unless_equals_int (map.data[i], reference_encode (sample));
+  }
+  gst_buffer_unmap (buffer, &map);
+}
+
+GST_START_TEST (test_encode_in_place)
+{
+  GstBuffer *buffer;
+
+  /* no other reference, the samples are encoded in place */
+  buffer = make_all_samples (-32768);
+  GST_BUFFER_TIMESTAMP (buffer) = 0;
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  buffer = GST_BUFFER (buffers->data);
+  check_encoded (buffer, -32768, 65536);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer), 0);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+      gst_util_uint64_scale_int (65536, GST_SECOND, 8000));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_encode_copy)
+{
+  GstBuffer *buffer, *input;
+  GstMapInfo map;
+  gint16 *samples;
+  gint i;
+
+  /* keep a reference, the samples must be encoded into a new buffer and
+   * the input left alone */
+  input = make_all_samples (-32768);
+  GST_BUFFER_TIMESTAMP (input) = GST_SECOND;
+  GST_BUFFER_FLAG_SET (input, GST_BUFFER_FLAG_DISCONT);
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_ref (input)) ==
+      GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  buffer = GST_BUFFER (buffers->data);
+  fail_unless (buffer != input);
+  check_encoded (buffer, -32768, 65536);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer), GST_SECOND);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT));
+
+  /* the input still holds the samples it was pushed with */
+  gst_buffer_map (input, &map, GST_MAP_READ);
+  samples = (gint16 *) map.data;
+  for (i = 0; i < 65536; i++)
+    fail_unless_equals_int (samples[i], (gint16) (-32768 + i));
+  gst_buffer_unmap (input, &map);
+  gst_buffer_unref (input);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_encode_list)
+{
+  static const gint sizes[] = { 160, 1, 33, 0, 2048 };
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GstClockTime ts = 0;
+  GList *l;
+  gint i;
+
+  /* small packets as a depayloader would hand them out, each one starts
+   * at a different sample so the whole range is covered */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    buffer = make_all_samples (-32768 + i * 12345);
+    gst_buffer_resize (buffer, 0, sizes[i] * sizeof (gint16));
+    GST_BUFFER_TIMESTAMP (buffer) = ts;
+    gst_buffer_list_add (list, buffer);
+    ts += gst_util_uint64_scale_int (sizes[i], GST_SECOND, 8000);
+  }
+  /* one buffer is also held elsewhere and takes the copying path */
+  buffer = gst_buffer_ref (gst_buffer_list_get (list, 2));
+
+  fail_unless (gst_pad_push_list (mysrcpad, list) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), G_N_ELEMENTS (sizes));
+  ts = 0;
+  for (i = 0, l = buffers; l; i++, l = l->next) {
+    GstBuffer *out = GST_BUFFER (l->data);
+    GstClockTime duration;
+
+    duration = gst_util_uint64_scale_int (sizes[i], GST_SECOND, 8000);
+    check_encoded (out, -32768 + i * 12345, sizes[i]);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (out), ts);
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (out), duration);
+    ts += duration;
+  }
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+alawenc_suite (void)
+{
+  Suite *s = suite_create ("alawenc");
+  TCase *tc_chain = tcase_create ("alawenc");
+
+  tcase_add_checked_fixture (tc_chain, alawenc_setup, alawenc_teardown);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_encode_in_place);
+  tcase_add_test (tc_chain, test_encode_copy);
+  tcase_add_test (tc_chain, test_encode_list);
+  return s;
+}
+
+GST_CHECK_MAIN (alawenc)
@@ -44,6 +44,9 @@ GstPad *mysrcpad, *mysinkpad;
     "layout = (string) interleaved, "   \
     "format = (string) " GST_AUDIO_NE(S16)
 
+#define FORMATS "{ S8, " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (S32) ", " \
+    GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (F64) " }"
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -51,7 +54,7 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
         "channels = (int) 1, "
         "rate = (int) [ 1,  MAX ], "
         "layout = (string) interleaved, "
-        "format = (string) " GST_AUDIO_NE (S16)));
+        "format = (string) " FORMATS));
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -59,7 +62,7 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
         "channels = (int) 1, "
         "rate = (int) [ 1,  MAX ], "
         "layout = (string) interleaved, "
-        "format = (string) " GST_AUDIO_NE (S16)));
+        "format = (string) " FORMATS));
 
 static GstElement *
 setup_amplify (void)
@@ -446,6 +449,158 @@ GST_START_TEST (test_200_wrap_positive)
 
 GST_END_TEST;
 
+/* what the per-sample C loops did before the Orc functions, integers are
+ * multiplied in float and truncated. Without clipping 8 and 16 bit samples
+ * wrap around like with wrap-negative, the 32 bit ones saturate */
+static gint64
+reference_amplify_int (gint64 x, gfloat amp, gint method, gint bits)
+{
+  gint64 min = -(G_GINT64_CONSTANT (1) << (bits - 1)), max = -min - 1;
+  gint64 val = (gint64) (x * amp);
+
+  if (method == 0 || (method == 3 && bits == 32))
+    return CLAMP (val, min, max);
+
+  if (val > max)
+    val = min + (val - min) % (max + 1 - min);
+  else if (val < min)
+    val = max - (max - val) % (max + 1 - min);
+
+  return val;
+}
+
+static void
+check_against_reference (GstAudioFormat format, gint method, gfloat amp)
+{
+  const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+  gint bits = GST_AUDIO_FORMAT_INFO_WIDTH (finfo);
+  gboolean is_float = GST_AUDIO_FORMAT_INFO_IS_FLOAT (finfo);
+  GstElement *amplify;
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  GstMapInfo map, outmap;
+  GRand *rand;
+  guint i, n = 1000;
+
+  amplify = setup_amplify ();
+  g_object_set (G_OBJECT (amplify), "amplification", amp, "clipping-method",
+      method, NULL);
+  fail_unless (gst_element_set_state (amplify,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, gst_audio_format_to_string (format),
+      "rate", G_TYPE_INT, 44100, "channels", G_TYPE_INT, 1,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  gst_check_setup_events (mysrcpad, amplify, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* the whole range and a bit more for floats, starting at the ends */
+  rand = g_rand_new_with_seed (bits + method);
+  inbuffer = gst_buffer_new_and_alloc (n * bits / 8);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < n; i++) {
+    gdouble v = (i < 3) ? i - 1.0 : g_rand_double_range (rand, -1.0, 1.0);
+
+    switch (format) {
+      case GST_AUDIO_FORMAT_S8:
+        ((gint8 *) map.data)[i] = (v < 0) ? v * -G_MININT8 : v * G_MAXINT8;
+        break;
+      case GST_AUDIO_FORMAT_S16:
+        ((gint16 *) map.data)[i] = (v < 0) ? v * -G_MININT16 : v * G_MAXINT16;
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        ((gint32 *) map.data)[i] = (v < 0) ? v * -(gdouble) G_MININT32 :
+            v * G_MAXINT32;
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        ((gfloat *) map.data)[i] = 1.5 * v;
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        ((gdouble *) map.data)[i] = 1.5 * v;
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  g_rand_free (rand);
+
+  /* keep the input, the element works on a copy */
+  gst_buffer_ref (inbuffer);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  gst_buffer_map (inbuffer, &map, GST_MAP_READ);
+  gst_buffer_map (GST_BUFFER (buffers->data), &outmap, GST_MAP_READ);
+  for (i = 0; i < n; i++) {
+    if (is_float) {
+      gdouble x, res, ref;
+
+      if (format == GST_AUDIO_FORMAT_F32) {
+        x = ((gfloat *) map.data)[i];
+        res = ((gfloat *) outmap.data)[i];
+        ref = (gfloat) (((gfloat) x) * amp);
+      } else {
+        x = ((gdouble *) map.data)[i];
+        res = ((gdouble *) outmap.data)[i];
+        ref = x * amp;
+      }
+      if (method == 0)
+        ref = CLAMP (ref, -1.0, 1.0);
+      fail_unless (res == ref, "%lf * %f: %lf != %lf", x, amp, res, ref);
+    } else {
+      gint64 x, res;
+
+      if (format == GST_AUDIO_FORMAT_S8) {
+        x = ((gint8 *) map.data)[i];
+        res = ((gint8 *) outmap.data)[i];
+      } else if (format == GST_AUDIO_FORMAT_S16) {
+        x = ((gint16 *) map.data)[i];
+        res = ((gint16 *) outmap.data)[i];
+      } else {
+        x = ((gint32 *) map.data)[i];
+        res = ((gint32 *) outmap.data)[i];
+      }
+      fail_unless (res == reference_amplify_int (x, amp, method, bits),
+          "%" G_GINT64_FORMAT " * %f: %" G_GINT64_FORMAT, x, amp, res);
+    }
+  }
+  gst_buffer_unmap (GST_BUFFER (buffers->data), &outmap);
+  gst_buffer_unmap (inbuffer, &map);
+  gst_buffer_unref (inbuffer);
+
+  /* cleanup */
+  cleanup_amplify (amplify);
+}
+
+/* all the formats and clipping methods that are done by Orc functions */
+GST_START_TEST (test_orc_against_reference)
+{
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S8, GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_S32,
+    GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_F64
+  };
+  static const gfloat amps[] = { 0.5, 2.0, -1.5, 3.7 };
+  guint f, a;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (a = 0; a < G_N_ELEMENTS (amps); a++) {
+      /* clip */
+      check_against_reference (formats[f], 0, amps[a]);
+      /* none */
+      check_against_reference (formats[f], 3, amps[a]);
+      /* wrap-negative */
+      if (formats[f] == GST_AUDIO_FORMAT_S8 ||
+          formats[f] == GST_AUDIO_FORMAT_S16)
+        check_against_reference (formats[f], 1, amps[a]);
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 amplify_suite (void)
 {
@@ -461,6 +616,7 @@ amplify_suite (void)
   tcase_add_test (tc_chain, test_200_wrap_negative);
   tcase_add_test (tc_chain, test_050_wrap_positive);
   tcase_add_test (tc_chain, test_200_wrap_positive);
+  tcase_add_test (tc_chain, test_orc_against_reference);
   return s;
 }
 
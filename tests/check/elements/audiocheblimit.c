@@ -26,6 +26,9 @@
 #include <gst/check/gstcheck.h>
 
 #include <math.h>
+#include <string.h>
+
+#include "../../gst/audiofx/audiofxbaseiirfilter.h"
 
 /* For ease of programming we use globals to keep refs for our floating
  * src and sink pads we create; otherwise we always have to do get_pad,
@@ -1057,6 +1060,181 @@ GST_START_TEST (test_type2_64_hp_22050hz)
 GST_END_TEST;
 
 
+static GstStaticPadTemplate anysinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate anysrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* Multiplies the sections of the filter out into one transfer function and
+ * runs every channel through it in direct form, like the filter did before
+ * it ran the sections one after another */
+static gdouble *
+reference_filter (GstAudioFXBaseIIRFilter * filter, const gdouble * in,
+    guint frames, guint channels)
+{
+  guint np = filter->n_sections * filter->order, no = filter->order;
+  gdouble *a, *b, *ta, *tb, *x, *y, *out;
+  guint s, i, k, c;
+
+  a = g_new0 (gdouble, np + 1);
+  b = g_new0 (gdouble, np + 1);
+  ta = g_new0 (gdouble, np + 1);
+  tb = g_new0 (gdouble, np + 1);
+  a[0] = b[0] = 1.0;
+  for (s = 0; s < filter->n_sections; s++) {
+    const gdouble *sb = filter->sections + s * 2 * (no + 1);
+    const gdouble *sa = sb + no + 1;
+
+    memcpy (ta, a, sizeof (gdouble) * (np + 1));
+    memcpy (tb, b, sizeof (gdouble) * (np + 1));
+    memset (a, 0, sizeof (gdouble) * (np + 1));
+    memset (b, 0, sizeof (gdouble) * (np + 1));
+    for (i = 0; i <= (s + 1) * no; i++) {
+      for (k = 0; k <= no && k <= i; k++) {
+        a[i] += sa[k] * ta[i - k];
+        b[i] += sb[k] * tb[i - k];
+      }
+    }
+  }
+
+  x = g_new (gdouble, np + 1);
+  y = g_new (gdouble, np + 1);
+  out = g_new (gdouble, frames * channels);
+  for (c = 0; c < channels; c++) {
+    memset (x, 0, sizeof (gdouble) * (np + 1));
+    memset (y, 0, sizeof (gdouble) * (np + 1));
+    for (i = 0; i < frames; i++) {
+      gdouble val;
+
+      memmove (x + 1, x, sizeof (gdouble) * np);
+      memmove (y + 1, y, sizeof (gdouble) * np);
+      x[0] = in[i * channels + c];
+      val = b[0] * x[0];
+      for (k = 1; k <= np; k++)
+        val += b[k] * x[k] - a[k] * y[k];
+      y[0] = val;
+      out[i * channels + c] = val;
+    }
+  }
+
+  g_free (a);
+  g_free (b);
+  g_free (ta);
+  g_free (tb);
+  g_free (x);
+  g_free (y);
+
+  return out;
+}
+
+/* Pushes noise with @channels through @filter and checks the output
+ * against reference_filter() */
+static void
+check_against_reference (GstElement * filter, gboolean is_64, guint channels)
+{
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  GstMapInfo map;
+  GRand *rand;
+  gdouble *in, *ref;
+  guint frames = 1024, i;
+
+  mysrcpad = gst_check_setup_src_pad (filter, &anysrctemplate);
+  mysinkpad = gst_check_setup_sink_pad (filter, &anysinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_element_set_state (filter,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, is_64 ? GST_AUDIO_NE (F64) : GST_AUDIO_NE (F32),
+      "layout", G_TYPE_STRING, "interleaved",
+      "channels", G_TYPE_INT, channels,
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+      "rate", G_TYPE_INT, 44100, NULL);
+  gst_check_setup_events (mysrcpad, filter, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* the reference gets the same, possibly rounded, input */
+  rand = g_rand_new_with_seed (channels);
+  in = g_new (gdouble, frames * channels);
+  inbuffer = gst_buffer_new_and_alloc (frames * channels *
+      (is_64 ? sizeof (gdouble) : sizeof (gfloat)));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < frames * channels; i++) {
+    in[i] = g_rand_double_range (rand, -1.0, 1.0);
+    if (is_64) {
+      ((gdouble *) map.data)[i] = in[i];
+    } else {
+      ((gfloat *) map.data)[i] = in[i];
+      in[i] = ((gfloat *) map.data)[i];
+    }
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  g_rand_free (rand);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  ref = reference_filter ((GstAudioFXBaseIIRFilter *) filter, in, frames,
+      channels);
+
+  gst_buffer_map (GST_BUFFER (buffers->data), &map, GST_MAP_READ);
+  for (i = 0; i < frames * channels; i++) {
+    gdouble res = is_64 ? ((gdouble *) map.data)[i] :
+        ((gfloat *) map.data)[i];
+
+    fail_unless (fabs (res - ref[i]) <= (is_64 ? 1e-9 : 1e-5),
+        "sample %u of %u channels: %lf != %lf", i, channels, res, ref[i]);
+  }
+  gst_buffer_unmap (GST_BUFFER (buffers->data), &map);
+
+  g_free (in);
+  g_free (ref);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (filter);
+  gst_check_teardown_sink_pad (filter);
+}
+
+/* The filter runs as a cascade of sections, which must give the same
+ * output as the multiplied out transfer function for all modes, types
+ * and sample formats, and with more channels than are filtered at once */
+GST_START_TEST (test_sections_against_direct_form)
+{
+  static const guint channels[] = { 1, 3, 10 };
+  gint mode, type, is_64;
+  guint c;
+
+  for (is_64 = 0; is_64 < 2; is_64++) {
+    for (mode = 0; mode < 2; mode++) {
+      for (type = 1; type <= 2; type++) {
+        for (c = 0; c < G_N_ELEMENTS (channels); c++) {
+          GstElement *filter = gst_check_setup_element ("audiocheblimit");
+
+          g_object_set (G_OBJECT (filter), "mode", mode, "type", type,
+              "poles", 8, "ripple", 0.25, "cutoff", 44100 / 4.0, NULL);
+          check_against_reference (filter, is_64, channels[c]);
+          gst_check_teardown_element (filter);
+        }
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+
 static Suite *
 audiocheblimit_suite (void)
 {
@@ -1080,6 +1258,7 @@ audiocheblimit_suite (void)
   tcase_add_test (tc_chain, test_type2_64_lp_22050hz);
   tcase_add_test (tc_chain, test_type2_64_hp_0hz);
   tcase_add_test (tc_chain, test_type2_64_hp_22050hz);
+  tcase_add_test (tc_chain, test_sections_against_direct_form);
   return s;
 }
 
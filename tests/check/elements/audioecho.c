@@ -21,6 +21,10 @@
 #include <gst/check/gstcheck.h>
 #include <gst/audio/audio.h>
 
+#include <math.h>
+
+#include "../../gst/audiofx/audioecho.h"
+
 gboolean have_eos = FALSE;
 
 /* For ease of programming we use globals to keep refs for our floating
@@ -40,7 +44,7 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "channels = (int) [ 1, 2 ], "
+        "channels = (int) [ 1, MAX ], "
         "rate = (int) [ 1,  MAX ], "
         "format = (string) { "
         GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (F64) " }"));
@@ -48,7 +52,7 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "channels = (int) [ 1, 2 ], "
+        "channels = (int) [ 1, MAX ], "
         "rate = (int) [ 1,  MAX ], "
         "format = (string) { "
         GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (F64) " }"));
@@ -223,6 +227,206 @@ GST_START_TEST (test_feedback)
 
 GST_END_TEST;
 
+GST_START_TEST (test_taps)
+{
+  GstElement *echo;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  gdouble in[] = { 1.0, -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, };
+  gdouble out[] = { 1.0, -1.0, 0.0, 0.0, 0.5, -0.5, 0.0, 0.0, 0.25, -0.25 };
+  gdouble res[10];
+
+  echo = setup_echo ();
+  g_object_set (G_OBJECT (echo), "delay", (GstClockTime) 20000, "intensity",
+      0.5, "feedback", 0.0, "taps", 2, NULL);
+  fail_unless (gst_element_set_state (echo,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (ECHO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, echo, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  inbuffer =
+      gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY, in, sizeof (in), 0,
+      sizeof (in), NULL, NULL);
+  fail_unless (gst_buffer_memcmp (inbuffer, 0, in, sizeof (in)) == 0);
+  ASSERT_BUFFER_REFCOUNT (inbuffer, "inbuffer", 1);
+
+  /* pushing gives away my reference ... */
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  /* ... but it ends up being collected on the global buffer list */
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+
+  fail_unless (gst_buffer_extract (outbuffer, 0, res,
+          sizeof (res)) == sizeof (res));
+  GST_INFO
+      ("expected %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf real %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf %+lf",
+      out[0], out[1], out[2], out[3], out[4], out[5], out[6], out[7], out[8],
+      out[9], res[0], res[1], res[2], res[3], res[4], res[5], res[6], res[7],
+      res[8], res[9]);
+  fail_unless (gst_buffer_memcmp (outbuffer, 0, out, sizeof (out)) == 0);
+
+  /* cleanup */
+  cleanup_echo (echo);
+}
+
+GST_END_TEST;
+
+/* Runs @in through the delay line one frame at a time, the way the
+ * element did before it processed blocks, with the extra taps added up in
+ * front of the first one. The written delay line is rounded like the
+ * element's for F32 */
+static gdouble *
+reference_echo (GstAudioEcho * self, const gdouble * in, guint frames,
+    guint channels, gboolean is_float)
+{
+  guint rate = GST_AUDIO_FILTER_RATE (self), t, i, c;
+  guint echo_frames[3];
+  gdouble echo_off[3], gain[3];
+  gdouble *line = g_new0 (gdouble, frames * channels);
+  gdouble *out = g_new (gdouble, frames * channels);
+
+  fail_unless (self->taps <= G_N_ELEMENTS (echo_frames));
+  for (t = 0; t < self->taps; t++) {
+    guint64 delay = self->delay * (t + 1);
+
+    if (t == 0)
+      echo_frames[t] = self->delay_frames;
+    else
+      echo_frames[t] = CLAMP (gst_util_uint64_scale (delay, rate, GST_SECOND),
+          1, self->buffer_size_frames);
+    /* the next frame is still in the line */
+    fail_unless (echo_frames[t] >= 2);
+    echo_off[t] = CLAMP ((((gdouble) delay) * rate) / GST_SECOND -
+        echo_frames[t], 0.0, 1.0);
+    gain[t] = (t == 0) ? self->intensity : gain[t - 1] * self->intensity;
+  }
+
+  for (i = 0; i < frames; i++) {
+    for (c = 0; c < channels; c++) {
+      gdouble x = in[i * channels + c], y = x, echo0 = 0.0;
+
+      for (t = 0; t < self->taps; t++) {
+        gdouble e0 = 0.0, e1 = 0.0, echo;
+
+        if (i >= echo_frames[t])
+          e0 = line[(i - echo_frames[t]) * channels + c];
+        if (i + 1 >= echo_frames[t])
+          e1 = line[(i + 1 - echo_frames[t]) * channels + c];
+        echo = e0 + (e1 - e0) * echo_off[t];
+        if (t == 0)
+          echo0 = echo;
+        y += gain[t] * echo;
+      }
+      out[i * channels + c] = y;
+      line[i * channels + c] = x + self->feedback * echo0;
+      if (is_float)
+        line[i * channels + c] = (gfloat) line[i * channels + c];
+    }
+  }
+  g_free (line);
+
+  return out;
+}
+
+static void
+check_against_reference (gboolean is_float, guint channels, guint taps)
+{
+  static const guint chunks[] = { 100, 37, 251, 1, 512, 99 };
+  GstElement *echo;
+  GstCaps *caps;
+  GRand *rand;
+  GList *l;
+  gdouble *in, *ref;
+  guint frames = 3000, bps = is_float ? sizeof (gfloat) : sizeof (gdouble);
+  guint i, pos;
+
+  echo = setup_echo ();
+  g_object_set (G_OBJECT (echo), "max-delay", 5 * GST_MSECOND, "delay",
+      (GstClockTime) 1370 * GST_USECOND, "intensity", 0.6, "feedback", 0.4,
+      "taps", taps, NULL);
+  fail_unless (gst_element_set_state (echo,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, is_float ? GST_AUDIO_NE (F32) :
+      GST_AUDIO_NE (F64), "rate", G_TYPE_INT, 44100,
+      "channels", G_TYPE_INT, channels,
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  gst_check_setup_events (mysrcpad, echo, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  rand = g_rand_new_with_seed (channels * taps);
+  in = g_new (gdouble, frames * channels);
+  for (i = 0; i < frames * channels; i++) {
+    in[i] = g_rand_double_range (rand, -1.0, 1.0);
+    if (is_float)
+      in[i] = (gfloat) in[i];
+  }
+  g_rand_free (rand);
+
+  /* odd buffer sizes, so that blocks end everywhere in the delay line */
+  for (pos = 0, i = 0; pos < frames; i++) {
+    guint n = MIN (chunks[i % G_N_ELEMENTS (chunks)], frames - pos);
+    GstBuffer *inbuffer;
+    GstMapInfo map;
+    guint j;
+
+    inbuffer = gst_buffer_new_and_alloc (n * channels * bps);
+    gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < n * channels; j++) {
+      if (is_float)
+        ((gfloat *) map.data)[j] = in[pos * channels + j];
+      else
+        ((gdouble *) map.data)[j] = in[pos * channels + j];
+    }
+    gst_buffer_unmap (inbuffer, &map);
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+    pos += n;
+  }
+
+  ref = reference_echo ((GstAudioEcho *) echo, in, frames, channels,
+      is_float);
+
+  for (pos = 0, l = buffers; l; l = l->next) {
+    GstMapInfo map;
+    guint j;
+
+    gst_buffer_map (GST_BUFFER (l->data), &map, GST_MAP_READ);
+    for (j = 0; j < map.size / bps; j++, pos++) {
+      gdouble res = is_float ? ((gfloat *) map.data)[j] :
+          ((gdouble *) map.data)[j];
+
+      fail_unless (fabs (res - ref[pos]) < (is_float ? 1e-5 : 1e-12),
+          "sample %u: %lf != %lf", pos, res, ref[pos]);
+    }
+    gst_buffer_unmap (GST_BUFFER (l->data), &map);
+  }
+  fail_unless_equals_int (pos, frames * channels);
+
+  g_free (in);
+  g_free (ref);
+
+  /* cleanup */
+  cleanup_echo (echo);
+}
+
+GST_START_TEST (test_blocks_against_reference)
+{
+  check_against_reference (FALSE, 1, 1);
+  check_against_reference (FALSE, 3, 1);
+  check_against_reference (FALSE, 3, 3);
+  check_against_reference (TRUE, 1, 1);
+  check_against_reference (TRUE, 3, 1);
+  check_against_reference (TRUE, 3, 3);
+}
+
+GST_END_TEST;
+
 static Suite *
 audioecho_suite (void)
 {
@@ -233,6 +437,8 @@ audioecho_suite (void)
   tcase_add_test (tc_chain, test_passthrough);
   tcase_add_test (tc_chain, test_echo);
   tcase_add_test (tc_chain, test_feedback);
+  tcase_add_test (tc_chain, test_taps);
+  tcase_add_test (tc_chain, test_blocks_against_reference);
 
   return s;
 }
@@ -22,6 +22,8 @@
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#include <math.h>
+
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 
@@ -111,7 +113,63 @@ on_handoff (GstElement * object, GstBuffer * buffer, GstPad * pad,
   }
 }
 
-GST_START_TEST (test_pipeline)
+#define LONG_KERNEL_LENGTH 64
+#define LONG_KERNEL_DELAY 40
+
+static void
+on_rate_changed_long (GstElement * element, gint rate, gpointer user_data)
+{
+  GValueArray *va;
+  GValue v = { 0, };
+  gint i;
+
+  fail_unless (rate > 0);
+
+  va = g_value_array_new (LONG_KERNEL_LENGTH);
+
+  /* a delay, long enough for the FFT convolution */
+  g_value_init (&v, G_TYPE_DOUBLE);
+  for (i = 0; i < LONG_KERNEL_LENGTH; i++) {
+    g_value_set_double (&v, (i == LONG_KERNEL_DELAY) ? 1.0 : 0.0);
+    g_value_array_append (va, &v);
+    g_value_reset (&v);
+  }
+
+  g_object_set (G_OBJECT (element), "kernel", va, NULL);
+
+  g_value_array_free (va);
+}
+
+static void
+on_handoff_long (GstElement * object, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  if (!have_data) {
+    GstMapInfo map;
+    gdouble *data;
+    gboolean nonzero = FALSE;
+    gint i, n;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    data = (gdouble *) map.data;
+    n = map.size / sizeof (gdouble);
+
+    /* both channels are delayed */
+    fail_unless (n > 2 * (LONG_KERNEL_DELAY + 16));
+    for (i = 0; i < 2 * LONG_KERNEL_DELAY; i++)
+      fail_unless (fabs (data[i]) < 1e-10);
+    for (i = 2 * LONG_KERNEL_DELAY; i < n; i++)
+      nonzero |= fabs (data[i]) > 1e-3;
+    fail_unless (nonzero);
+
+    gst_buffer_unmap (buffer, &map);
+    have_data = TRUE;
+  }
+}
+
+static void
+run_pipeline (GCallback rate_changed, GCallback handoff, gint channels,
+    guint partition_length, guint n_threads)
 {
   GstElement *pipeline, *src, *cfilter, *filter, *sink;
   GstCaps *caps;
@@ -132,23 +190,26 @@ GST_START_TEST (test_pipeline)
   fail_unless (cfilter != NULL);
 #if G_BYTE_ORDER == G_BIG_ENDIAN
   caps = gst_caps_new_simple ("audio/x-raw",
-      "format", G_TYPE_STRING, "F64BE", NULL);
+      "format", G_TYPE_STRING, "F64BE", "channels", G_TYPE_INT, channels,
+      NULL);
 #else
   caps = gst_caps_new_simple ("audio/x-raw",
-      "format", G_TYPE_STRING, "F64LE", NULL);
+      "format", G_TYPE_STRING, "F64LE", "channels", G_TYPE_INT, channels,
+      NULL);
 #endif
   g_object_set (G_OBJECT (cfilter), "caps", caps, NULL);
   gst_caps_unref (caps);
 
   filter = gst_element_factory_make ("audiofirfilter", NULL);
   fail_unless (filter != NULL);
-  g_signal_connect (G_OBJECT (filter), "rate-changed",
-      G_CALLBACK (on_rate_changed), NULL);
+  g_object_set (G_OBJECT (filter), "partition-length", partition_length,
+      "n-threads", n_threads, NULL);
+  g_signal_connect (G_OBJECT (filter), "rate-changed", rate_changed, NULL);
 
   sink = gst_element_factory_make ("fakesink", NULL);
   fail_unless (sink != NULL);
   g_object_set (G_OBJECT (sink), "signal-handoffs", TRUE, NULL);
-  g_signal_connect (G_OBJECT (sink), "handoff", G_CALLBACK (on_handoff), NULL);
+  g_signal_connect (G_OBJECT (sink), "handoff", handoff, NULL);
 
   gst_bin_add_many (GST_BIN (pipeline), src, cfilter, filter, sink, NULL);
   fail_unless (gst_element_link_many (src, cfilter, filter, sink, NULL));
@@ -175,6 +236,174 @@ GST_START_TEST (test_pipeline)
   gst_object_unref (pipeline);
 }
 
+GST_START_TEST (test_pipeline)
+{
+  run_pipeline (G_CALLBACK (on_rate_changed), G_CALLBACK (on_handoff), 1, 0,
+      1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pipeline_partitioned)
+{
+  run_pipeline (G_CALLBACK (on_rate_changed_long),
+      G_CALLBACK (on_handoff_long), 2, 16, 2);
+}
+
+GST_END_TEST;
+
+#define REF_KERNEL_LENGTH 70
+#define REF_CHANNELS 3
+#define REF_FRAMES 2000
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+#define REF_FORMAT "F64BE"
+#else
+#define REF_FORMAT "F64LE"
+#endif
+
+static GstPad *mysrcpad, *mysinkpad;
+static gdouble ref_kernel[REF_KERNEL_LENGTH];
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static void
+on_rate_changed_ref (GstElement * element, gint rate, gpointer user_data)
+{
+  GValueArray *va;
+  GValue v = { 0, };
+  gint i;
+
+  va = g_value_array_new (REF_KERNEL_LENGTH);
+
+  g_value_init (&v, G_TYPE_DOUBLE);
+  for (i = 0; i < REF_KERNEL_LENGTH; i++) {
+    g_value_set_double (&v, ref_kernel[i]);
+    g_value_array_append (va, &v);
+    g_value_reset (&v);
+  }
+
+  g_object_set (G_OBJECT (element), "kernel", va, NULL);
+
+  g_value_array_free (va);
+}
+
+/* Pushes noise in chunks of odd sizes through the filter and compares the
+ * output with a direct convolution of every channel with the kernel */
+static void
+check_against_direct_convolution (guint partition_length, guint n_threads)
+{
+  static const guint chunks[] = { 100, 37, 251, 1, 512, 99 };
+  GstElement *filter;
+  GstCaps *caps;
+  GRand *rand;
+  gdouble *in, *out;
+  guint i, k, c, pos, n_out;
+  GList *l;
+
+  rand = g_rand_new_with_seed (partition_length);
+  for (i = 0; i < REF_KERNEL_LENGTH; i++)
+    ref_kernel[i] = g_rand_double_range (rand, -0.5, 0.5);
+  in = g_new (gdouble, REF_FRAMES * REF_CHANNELS);
+  for (i = 0; i < REF_FRAMES * REF_CHANNELS; i++)
+    in[i] = g_rand_double_range (rand, -1.0, 1.0);
+  g_rand_free (rand);
+
+  filter = gst_check_setup_element ("audiofirfilter");
+  g_object_set (G_OBJECT (filter), "partition-length", partition_length,
+      "n-threads", n_threads, NULL);
+  g_signal_connect (G_OBJECT (filter), "rate-changed",
+      G_CALLBACK (on_rate_changed_ref), NULL);
+  mysrcpad = gst_check_setup_src_pad (filter, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (filter, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_element_set_state (filter,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, REF_FORMAT,
+      "layout", G_TYPE_STRING, "interleaved",
+      "channels", G_TYPE_INT, REF_CHANNELS,
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+      "rate", G_TYPE_INT, 44100, NULL);
+  gst_check_setup_events (mysrcpad, filter, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  for (pos = 0, i = 0; pos < REF_FRAMES; i++) {
+    guint n = MIN (chunks[i % G_N_ELEMENTS (chunks)], REF_FRAMES - pos);
+    GstBuffer *inbuffer;
+
+    inbuffer = gst_buffer_new_and_alloc (n * REF_CHANNELS * sizeof (gdouble));
+    gst_buffer_fill (inbuffer, 0, in + pos * REF_CHANNELS,
+        n * REF_CHANNELS * sizeof (gdouble));
+    GST_BUFFER_TIMESTAMP (inbuffer) =
+        gst_util_uint64_scale_int (pos, GST_SECOND, 44100);
+    GST_BUFFER_DURATION (inbuffer) =
+        gst_util_uint64_scale_int (n, GST_SECOND, 44100);
+    GST_BUFFER_OFFSET (inbuffer) = pos;
+    GST_BUFFER_OFFSET_END (inbuffer) = pos + n;
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+    pos += n;
+  }
+  /* the residue is pushed on EOS */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  out = g_new0 (gdouble, REF_FRAMES * REF_CHANNELS);
+  n_out = 0;
+  for (l = buffers; l; l = l->next) {
+    gsize size = gst_buffer_get_size (GST_BUFFER (l->data));
+
+    size = MIN (size, (REF_FRAMES * REF_CHANNELS - n_out) * sizeof (gdouble));
+    gst_buffer_extract (GST_BUFFER (l->data), 0, out + n_out, size);
+    n_out += size / sizeof (gdouble);
+  }
+  fail_unless_equals_int (n_out, REF_FRAMES * REF_CHANNELS);
+
+  for (i = 0; i < REF_FRAMES; i++) {
+    for (c = 0; c < REF_CHANNELS; c++) {
+      gdouble ref = 0.0;
+
+      for (k = 0; k < REF_KERNEL_LENGTH && k <= i; k++)
+        ref += ref_kernel[k] * in[(i - k) * REF_CHANNELS + c];
+      fail_unless (fabs (out[i * REF_CHANNELS + c] - ref) < 1e-9,
+          "frame %u channel %u: %lf != %lf", i, c,
+          out[i * REF_CHANNELS + c], ref);
+    }
+  }
+
+  g_free (in);
+  g_free (out);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (filter);
+  gst_check_teardown_sink_pad (filter);
+  gst_check_teardown_element (filter);
+}
+
+GST_START_TEST (test_fft_against_direct_convolution)
+{
+  /* one block for the whole kernel */
+  check_against_direct_convolution (0, 1);
+  /* partitions that do and don't divide the kernel length */
+  check_against_direct_convolution (14, 1);
+  check_against_direct_convolution (16, 1);
+  check_against_direct_convolution (16, 2);
+  check_against_direct_convolution (50, 3);
+}
+
 GST_END_TEST;
 
 static Suite *
@@ -185,6 +414,8 @@ audiofirfilter_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_pipeline);
+  tcase_add_test (tc_chain, test_pipeline_partitioned);
+  tcase_add_test (tc_chain, test_fft_against_direct_convolution);
 
   return s;
 }
@@ -29,6 +29,8 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/check/gstcheck.h>
 
+#include <math.h>
+
 gboolean have_eos = FALSE;
 
 /* For ease of programming we use globals to keep refs for our floating
@@ -48,7 +50,8 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "format = (string) " GST_AUDIO_NE (S16) ", "
+        "format = (string) { " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (F32)
+        " }, "
         "layout = (string) interleaved, "
         "channels = (int) 1, " "rate = (int) [ 1,  MAX ]")
     );
@@ -56,7 +59,8 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "format = (string) " GST_AUDIO_NE (S16) ", "
+        "format = (string) { " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (F32)
+        " }, "
         "layout = (string) interleaved, "
         "channels = (int) 1, " "rate = (int) [ 1,  MAX ]")
     );
@@ -266,6 +270,96 @@ GST_START_TEST (test_25_inverse)
 
 GST_END_TEST;
 
+/* Compares the Orc functions with the mix of the sample and its inverse
+ * in float, as the C loop did it. For S16 the inverse of x is -1 - x,
+ * the float samples were truncated to integers before and are now
+ * compared with the untruncated result */
+static void
+check_against_reference (gboolean is_float, gfloat degree)
+{
+  GstElement *invert;
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  GstMapInfo map, outmap;
+  GRand *rand;
+  gfloat dry = 1.0 - degree;
+  guint i, n = 1000;
+
+  invert = setup_invert ();
+  g_object_set (G_OBJECT (invert), "degree", degree, NULL);
+  fail_unless (gst_element_set_state (invert,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, is_float ? GST_AUDIO_NE (F32) :
+      GST_AUDIO_NE (S16), "rate", G_TYPE_INT, 44100,
+      "channels", G_TYPE_INT, 1, "layout", G_TYPE_STRING, "interleaved",
+      NULL);
+  gst_check_setup_events (mysrcpad, invert, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  rand = g_rand_new_with_seed (degree * 100);
+  inbuffer = gst_buffer_new_and_alloc (n * (is_float ? 4 : 2));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < n; i++) {
+    if (is_float)
+      ((gfloat *) map.data)[i] = g_rand_double_range (rand, -1.0, 1.0);
+    else if (i < 2)
+      ((gint16 *) map.data)[i] = i ? G_MAXINT16 : G_MININT16;
+    else
+      ((gint16 *) map.data)[i] =
+          g_rand_int_range (rand, G_MININT16, G_MAXINT16 + 1);
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  g_rand_free (rand);
+
+  /* keep the input, the element works on a copy */
+  gst_buffer_ref (inbuffer);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  gst_buffer_map (inbuffer, &map, GST_MAP_READ);
+  gst_buffer_map (GST_BUFFER (buffers->data), &outmap, GST_MAP_READ);
+  for (i = 0; i < n; i++) {
+    if (is_float) {
+      gfloat x = ((gfloat *) map.data)[i];
+      gfloat res = ((gfloat *) outmap.data)[i];
+      gfloat ref = x * dry - x * degree;
+
+      fail_unless (fabs (res - ref) <= 1e-6, "%f: %f != %f", x, res, ref);
+    } else {
+      gint16 x = ((gint16 *) map.data)[i];
+      gint16 res = ((gint16 *) outmap.data)[i];
+      glong ref = x * dry + (-1 - x) * degree;
+
+      ref = CLAMP (ref, G_MININT16, G_MAXINT16);
+      /* the sum may be rounded differently if it is fused */
+      fail_unless (ABS (res - ref) <= 1, "%d: %d != %ld", x, res, ref);
+    }
+  }
+  gst_buffer_unmap (GST_BUFFER (buffers->data), &outmap);
+  gst_buffer_unmap (inbuffer, &map);
+  gst_buffer_unref (inbuffer);
+
+  /* cleanup */
+  cleanup_invert (invert);
+}
+
+GST_START_TEST (test_orc_against_reference)
+{
+  check_against_reference (FALSE, 0.25);
+  check_against_reference (FALSE, 0.5);
+  check_against_reference (FALSE, 0.8);
+  check_against_reference (FALSE, 1.0);
+  check_against_reference (TRUE, 0.25);
+  check_against_reference (TRUE, 0.5);
+  check_against_reference (TRUE, 0.8);
+  check_against_reference (TRUE, 1.0);
+}
+
+GST_END_TEST;
+
 static Suite *
 invert_suite (void)
 {
@@ -277,6 +371,7 @@ invert_suite (void)
   tcase_add_test (tc_chain, test_zero);
   tcase_add_test (tc_chain, test_full_inverse);
   tcase_add_test (tc_chain, test_25_inverse);
+  tcase_add_test (tc_chain, test_orc_against_reference);
 
   return s;
 }
@@ -27,6 +27,8 @@
 
 #include <math.h>
 
+#include "../../gst/audiofx/audiofxbasefirfilter.h"
+
 /* For ease of programming we use globals to keep refs for our floating
  * src and sink pads we create; otherwise we always have to do get_pad,
  * get_peer, and then remove references in every test function */
@@ -1109,6 +1111,123 @@ GST_START_TEST (test_64_small_buffer)
 
 GST_END_TEST;
 
+/* the windowed sinc kernel for @w the way the element computed it before
+ * the window was cached and only half of the taps calculated, normalized
+ * for unity gain at DC */
+static gdouble *
+reference_lowpass (gint len, gint window, gdouble w)
+{
+  gdouble *kernel = g_new (gdouble, len);
+  gdouble sum = 0.0;
+  gint i;
+
+  for (i = 0; i < len; ++i) {
+    if (i == (len - 1) / 2.0)
+      kernel[i] = w;
+    else
+      kernel[i] = sin (w * (i - (len - 1) / 2.0)) / (i - (len - 1) / 2.0);
+
+    switch (window) {
+      case 0:                  /* hamming */
+        kernel[i] *= (0.54 - 0.46 * cos (2 * G_PI * i / (len - 1)));
+        break;
+      case 1:                  /* blackman */
+        kernel[i] *= (0.42 - 0.5 * cos (2 * G_PI * i / (len - 1)) +
+            0.08 * cos (4 * G_PI * i / (len - 1)));
+        break;
+      case 2:{                 /* gaussian */
+        gdouble x = 3.0 / len * (2 * i - (len - 1));
+
+        kernel[i] *= exp (-0.5 * x * x);
+        break;
+      }
+      case 3:                  /* cosine */
+        kernel[i] *= cos (G_PI * i / (len - 1) - G_PI / 2);
+        break;
+      case 4:                  /* hann */
+        kernel[i] *= 0.5 * (1 - cos (2 * G_PI * i / (len - 1)));
+        break;
+    }
+  }
+
+  for (i = 0; i < len; ++i)
+    sum += kernel[i];
+  for (i = 0; i < len; ++i)
+    kernel[i] /= sum;
+
+  return kernel;
+}
+
+static void
+check_kernel (GstElement * element, const gdouble * ref, gint len)
+{
+  GstAudioFXBaseFIRFilter *filter = (GstAudioFXBaseFIRFilter *) element;
+  gint i;
+
+  fail_unless (filter->kernel != NULL);
+  fail_unless_equals_int (filter->kernel_length, len);
+  for (i = 0; i < len; i++)
+    fail_unless (fabs (filter->kernel[i] - ref[i]) < 1e-12,
+        "tap %d of %d: %.17g != %.17g", i, len, filter->kernel[i], ref[i]);
+}
+
+/* Compare the kernels with the ones from reference_lowpass() while the
+ * parameters change in the playing element, so that the cached window
+ * and the kernel are recalculated when they have to be */
+GST_START_TEST (test_kernel_against_reference)
+{
+  static const gint lengths[] = { 31, 1001, 20001 };
+  static const gfloat bands[][2] = { {100.0, 11025.0}, {5000.0, 22050.0} };
+  GstElement *audiowsincband;
+  GstCaps *caps;
+  guint l, w, m, f;
+  gint i;
+
+  audiowsincband = setup_audiowsincband ();
+  fail_unless (gst_element_set_state (audiowsincband,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  caps = gst_caps_from_string (AUDIO_WSINC_BAND_CAPS_STRING_64);
+  gst_check_setup_events (mysrcpad, audiowsincband, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  for (l = 0; l < G_N_ELEMENTS (lengths); l++) {
+    for (w = 0; w < 5; w++) {
+      for (m = 0; m < 2; m++) {
+        for (f = 0; f < G_N_ELEMENTS (bands); f++) {
+          gint len = lengths[l];
+          gdouble *ref, *hp;
+
+          g_object_set (G_OBJECT (audiowsincband), "length", len,
+              "window", w, "mode", m, "lower-frequency", bands[f][0],
+              "upper-frequency", bands[f][1], NULL);
+
+          /* band reject is the lowpass at the lower frequency plus the
+           * highpass at the upper one, band pass is its inversion */
+          ref = reference_lowpass (len, w, 2 * G_PI * (bands[f][0] / 44100));
+          hp = reference_lowpass (len, w, 2 * G_PI * (bands[f][1] / 44100));
+          for (i = 0; i < len; i++)
+            ref[i] -= hp[i];
+          ref[(len - 1) / 2] += 1.0;
+          if (m == 0) {
+            for (i = 0; i < len; i++)
+              ref[i] = -ref[i];
+            ref[len / 2] += 1.0;
+          }
+          check_kernel (audiowsincband, ref, len);
+          g_free (ref);
+          g_free (hp);
+        }
+      }
+    }
+  }
+
+  /* cleanup */
+  cleanup_audiowsincband (audiowsincband);
+}
+
+GST_END_TEST;
+
 static Suite *
 audiowsincband_suite (void)
 {
@@ -1130,6 +1249,7 @@ audiowsincband_suite (void)
   tcase_add_test (tc_chain, test_64_br_11025hz);
   tcase_add_test (tc_chain, test_64_br_22050hz);
   tcase_add_test (tc_chain, test_64_small_buffer);
+  tcase_add_test (tc_chain, test_kernel_against_reference);
 
   return s;
 }
@@ -0,0 +1,414 @@
+/* GStreamer
+ *
+ * cutter.c: Unit test for the cutter element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+
+#include <math.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+static GstBus *mybus;
+
+#define CUTTER_RATE 8000
+#define CUTTER_THRESHOLD 0.1
+#define CUTTER_RUN_LENGTH (500 * GST_MSECOND)
+#define CUTTER_PRE_LENGTH (200 * GST_MSECOND)
+#define CUTTER_BUFFERS 80
+
+#define CUTTER_CAPS_TEMPLATE_STRING \
+  "audio/x-raw, " \
+    "format = (string) { S8, " GST_AUDIO_NE (S16) " }, " \
+    "layout = (string) interleaved, " \
+    "rate = (int) [ 1, MAX ], " \
+    "channels = (int) [ 1, MAX ]"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CUTTER_CAPS_TEMPLATE_STRING)
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CUTTER_CAPS_TEMPLATE_STRING)
+    );
+
+static GstElement *
+setup_cutter (const gchar * format, gint channels, gboolean leaky)
+{
+  GstElement *cutter;
+  GstCaps *caps;
+
+  GST_DEBUG ("setup_cutter");
+  cutter = gst_check_setup_element ("cutter");
+  g_object_set (cutter, "threshold", CUTTER_THRESHOLD,
+      "run-length", CUTTER_RUN_LENGTH, "pre-length", CUTTER_PRE_LENGTH,
+      "leaky", leaky, NULL);
+  mysrcpad = gst_check_setup_src_pad (cutter, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (cutter, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, format,
+      "rate", G_TYPE_INT, CUTTER_RATE,
+      "channels", G_TYPE_INT, channels,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  if (channels == 2)
+    gst_caps_set_simple (caps, "channel-mask", GST_TYPE_BITMASK,
+        G_GUINT64_CONSTANT (0x3), NULL);
+  gst_check_setup_events (mysrcpad, cutter, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  mybus = gst_bus_new ();
+  gst_element_set_bus (cutter, mybus);
+
+  fail_unless (gst_element_set_state (cutter,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return cutter;
+}
+
+static void
+cleanup_cutter (GstElement * cutter)
+{
+  GST_DEBUG ("cleanup_cutter");
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_bus_set_flushing (mybus, TRUE);
+  gst_element_set_bus (cutter, NULL);
+  gst_object_unref (mybus);
+  mybus = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (cutter);
+  gst_check_teardown_sink_pad (cutter);
+  gst_check_teardown_element (cutter);
+}
+
+/* What the cutter did with the buffers, as worked out by the reference or
+ * seen from the element. */
+typedef struct
+{
+  /* timestamps of the buffers that were passed on */
+  GArray *output;
+  /* the "cutter" messages */
+  GArray *above;
+  GArray *timestamps;
+  GArray *silences;
+  GArray *dropped;
+  guint silent_runs;
+  GstClockTime silent_time;
+} CutterResult;
+
+static void
+cutter_result_init (CutterResult * res)
+{
+  res->output = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  res->above = g_array_new (FALSE, FALSE, sizeof (gboolean));
+  res->timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  res->silences = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  res->dropped = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  res->silent_runs = 0;
+  res->silent_time = 0;
+}
+
+static void
+cutter_result_clear (CutterResult * res)
+{
+  g_array_free (res->output, TRUE);
+  g_array_free (res->above, TRUE);
+  g_array_free (res->timestamps, TRUE);
+  g_array_free (res->silences, TRUE);
+  g_array_free (res->dropped, TRUE);
+}
+
+static void
+cutter_result_add_message (CutterResult * res, gboolean above,
+    GstClockTime timestamp, GstClockTime silence, GstClockTime dropped)
+{
+  g_array_append_val (res->above, above);
+  g_array_append_val (res->timestamps, timestamp);
+  g_array_append_val (res->silences, silence);
+  g_array_append_val (res->dropped, dropped);
+}
+
+static void
+fail_unless_results_equal (const CutterResult * res, const CutterResult * ref)
+{
+  guint i;
+
+  fail_unless_equals_int (res->output->len, ref->output->len);
+  for (i = 0; i < ref->output->len; i++)
+    fail_unless_equals_uint64 (g_array_index (res->output, GstClockTime, i),
+        g_array_index (ref->output, GstClockTime, i));
+
+  fail_unless_equals_int (res->above->len, ref->above->len);
+  for (i = 0; i < ref->above->len; i++) {
+    fail_unless_equals_int (g_array_index (res->above, gboolean, i),
+        g_array_index (ref->above, gboolean, i));
+    fail_unless_equals_uint64 (g_array_index (res->timestamps, GstClockTime,
+            i), g_array_index (ref->timestamps, GstClockTime, i));
+    fail_unless_equals_uint64 (g_array_index (res->silences, GstClockTime, i),
+        g_array_index (ref->silences, GstClockTime, i));
+    fail_unless_equals_uint64 (g_array_index (res->dropped, GstClockTime, i),
+        g_array_index (ref->dropped, GstClockTime, i));
+  }
+
+  fail_unless_equals_int (res->silent_runs, ref->silent_runs);
+  fail_unless_equals_uint64 (res->silent_time, ref->silent_time);
+}
+
+/* The cutter as it was before the square sums were done in integers and the
+ * pre-record buffers were queued: the mean square is summed in doubles and
+ * the pre-record buffer is a list.  The silence statistics are added the way
+ * the element documents them. */
+
+typedef struct
+{
+  gint16 *data;
+  guint n_samples;
+  GstClockTime timestamp;
+  GstClockTime duration;
+} RefBuffer;
+
+static void
+reference_cutter (const RefBuffer * bufs, guint n_bufs, gint width,
+    gboolean leaky, CutterResult * ref)
+{
+  gboolean silent = FALSE, silent_prev;
+  gdouble silent_run_length = 0.0, pre_run_length = 0.0;
+  GstClockTime silence = 0, dropped = 0;
+  GList *pre_buffer = NULL;
+  guint i, j;
+
+  for (i = 0; i < n_bufs; i++) {
+    gdouble squaresum = 0.0, RMS;
+
+    for (j = 0; j < bufs[i].n_samples; j++)
+      squaresum += ((gdouble) bufs[i].data[j]) * bufs[i].data[j];
+    RMS = sqrt (squaresum / (gdouble) (1 << ((width - 1) * 2))
+        / bufs[i].n_samples);
+
+    silent_prev = silent;
+    if (RMS < CUTTER_THRESHOLD)
+      silent_run_length += gst_guint64_to_gdouble (bufs[i].duration);
+    else {
+      silent_run_length = 0.0;
+      silent = FALSE;
+    }
+    if (silent_run_length > CUTTER_RUN_LENGTH)
+      silent = TRUE;
+
+    if (silent != silent_prev) {
+      if (silent) {
+        cutter_result_add_message (ref, FALSE, bufs[i].timestamp, 0, 0);
+        silence = 0;
+        dropped = 0;
+      } else {
+        cutter_result_add_message (ref, TRUE, bufs[i].timestamp, silence,
+            dropped);
+        ref->silent_runs++;
+        ref->silent_time += silence;
+
+        while (pre_buffer) {
+          const RefBuffer *prebuf = g_list_first (pre_buffer)->data;
+
+          pre_buffer = g_list_remove (pre_buffer, prebuf);
+          g_array_append_val (ref->output, prebuf->timestamp);
+        }
+        pre_run_length = 0.0;
+      }
+    }
+
+    if (silent) {
+      pre_buffer = g_list_append (pre_buffer, (gpointer) & bufs[i]);
+      pre_run_length += gst_guint64_to_gdouble (bufs[i].duration);
+      silence += bufs[i].duration;
+
+      while (pre_run_length > CUTTER_PRE_LENGTH) {
+        const RefBuffer *prebuf = g_list_first (pre_buffer)->data;
+
+        pre_buffer = g_list_remove (pre_buffer, prebuf);
+        pre_run_length -= gst_guint64_to_gdouble (prebuf->duration);
+        if (!leaky)
+          g_array_append_val (ref->output, prebuf->timestamp);
+        else
+          dropped += prebuf->duration;
+      }
+    } else {
+      g_array_append_val (ref->output, bufs[i].timestamp);
+    }
+  }
+
+  g_list_free (pre_buffer);
+}
+
+/* Buffers of noise at levels that make up loud parts, silences that are too
+ * short to be cut and long ones, followed by levels around the threshold.
+ * The sizes change so the pre-record buffer holds a varying number of
+ * them. */
+
+static RefBuffer *
+make_buffers (gint width, gint channels, GRand * rand)
+{
+  RefBuffer *bufs = g_new (RefBuffer, CUTTER_BUFFERS);
+  GstClockTime timestamp = 0;
+  gint max = (1 << (width - 1)) - 1;
+  guint i, j;
+
+  for (i = 0; i < CUTTER_BUFFERS; i++) {
+    guint n_frames = (i % 3 == 0) ? 333 : 800;
+    gdouble rms;
+
+    if (i < 40)
+      rms = (i % 20 < 3 || i % 20 == 12 || i % 20 == 16) ? 0.3 : 0.02;
+    else
+      rms = CUTTER_THRESHOLD * g_rand_double_range (rand, 0.8, 1.2);
+
+    bufs[i].n_samples = n_frames * channels;
+    bufs[i].data = g_new (gint16, bufs[i].n_samples);
+    for (j = 0; j < bufs[i].n_samples; j++) {
+      /* uniform noise has an RMS of a third of the peak */
+      gdouble x = rms * sqrt (3.0) * g_rand_double_range (rand, -1.0, 1.0);
+
+      bufs[i].data[j] = CLAMP (x * max, -max, max);
+    }
+    bufs[i].timestamp = timestamp;
+    bufs[i].duration =
+        gst_util_uint64_scale (n_frames, GST_SECOND, CUTTER_RATE);
+    timestamp += bufs[i].duration;
+  }
+
+  return bufs;
+}
+
+static void
+check_against_reference (gint width, gint channels, gboolean leaky)
+{
+  GstElement *cutter;
+  CutterResult res, ref;
+  RefBuffer *bufs;
+  GstMessage *message;
+  GRand *rand;
+  GList *l;
+  guint i, j;
+
+  rand = g_rand_new_with_seed (width * 10 + channels);
+  bufs = make_buffers (width, channels, rand);
+  g_rand_free (rand);
+
+  cutter_result_init (&ref);
+  reference_cutter (bufs, CUTTER_BUFFERS, width, leaky, &ref);
+
+  cutter = setup_cutter ((width == 8) ? "S8" : GST_AUDIO_NE (S16), channels,
+      leaky);
+  for (i = 0; i < CUTTER_BUFFERS; i++) {
+    GstBuffer *inbuffer;
+    GstMapInfo map;
+
+    inbuffer = gst_buffer_new_and_alloc (bufs[i].n_samples * width / 8);
+    gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < bufs[i].n_samples; j++) {
+      if (width == 8)
+        ((gint8 *) map.data)[j] = bufs[i].data[j];
+      else
+        ((gint16 *) map.data)[j] = bufs[i].data[j];
+    }
+    gst_buffer_unmap (inbuffer, &map);
+    GST_BUFFER_TIMESTAMP (inbuffer) = bufs[i].timestamp;
+    GST_BUFFER_DURATION (inbuffer) = bufs[i].duration;
+
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+
+  cutter_result_init (&res);
+  for (l = buffers; l; l = l->next) {
+    GstClockTime timestamp = GST_BUFFER_TIMESTAMP (l->data);
+
+    g_array_append_val (res.output, timestamp);
+  }
+
+  while ((message = gst_bus_pop_filtered (mybus, GST_MESSAGE_ELEMENT))) {
+    const GstStructure *s = gst_message_get_structure (message);
+    GstClockTime timestamp, silence = 0, dropped = 0;
+    gboolean above;
+
+    fail_unless (gst_structure_has_name (s, "cutter"));
+    fail_unless (gst_structure_get_boolean (s, "above", &above));
+    fail_unless (gst_structure_get_clock_time (s, "timestamp", &timestamp));
+    if (above) {
+      fail_unless (gst_structure_get_clock_time (s, "silence-duration",
+              &silence));
+      fail_unless (gst_structure_get_clock_time (s, "dropped-duration",
+              &dropped));
+    }
+    cutter_result_add_message (&res, above, timestamp, silence, dropped);
+    gst_message_unref (message);
+  }
+
+  g_object_get (cutter, "silent-runs", &res.silent_runs,
+      "silent-time", &res.silent_time, NULL);
+
+  /* the test signal has to cover both kinds of silence */
+  fail_unless (ref.silent_runs >= 2);
+  fail_unless_results_equal (&res, &ref);
+
+  cutter_result_clear (&res);
+  cutter_result_clear (&ref);
+  for (i = 0; i < CUTTER_BUFFERS; i++)
+    g_free (bufs[i].data);
+  g_free (bufs);
+
+  /* buffers still in the pre-record buffer are released with the element */
+  cleanup_cutter (cutter);
+}
+
+GST_START_TEST (test_against_reference)
+{
+  check_against_reference (8, 1, FALSE);
+  check_against_reference (8, 2, TRUE);
+  check_against_reference (16, 1, TRUE);
+  check_against_reference (16, 2, FALSE);
+}
+
+GST_END_TEST;
+
+static Suite *
+cutter_suite (void)
+{
+  Suite *s = suite_create ("cutter");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_against_reference);
+
+  return s;
+}
+
+GST_CHECK_MAIN (cutter);
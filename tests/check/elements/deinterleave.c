@@ -617,6 +617,255 @@ GST_START_TEST (test_8_channels_float32)
 
 GST_END_TEST;
 
+static GstBuffer *passthrough_buffer;
+
+static GstFlowReturn
+deinterleave_chain_passthrough (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  fail_unless (passthrough_buffer == NULL);
+  passthrough_buffer = buffer;
+
+  return GST_FLOW_OK;
+}
+
+static void
+deinterleave_pad_added_passthrough (GstElement * src, GstPad * pad,
+    GstPad * mysinkpad)
+{
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+GST_START_TEST (test_1_channel_passthrough)
+{
+  static GstStaticPadTemplate mono_srctemplate =
+      GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("audio/x-raw, "
+          "format = (string) " GST_AUDIO_NE (F32) ", "
+          "channels = (int) 1, layout = (string) interleaved, "
+          "rate = (int) 48000"));
+  GstPad *sinkpad, *mysinkpad;
+  GstBuffer *inbuf;
+  GstCaps *caps;
+
+  passthrough_buffer = NULL;
+
+  deinterleave = gst_element_factory_make ("deinterleave", NULL);
+  fail_unless (deinterleave != NULL);
+
+  mysrcpad = gst_pad_new_from_static_template (&mono_srctemplate, "src");
+  fail_unless (mysrcpad != NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  caps = gst_caps_from_string ("audio/x-raw, "
+      "format = (string) " GST_AUDIO_NE (F32) ", "
+      "channels = (int) 1, layout = (string) interleaved, "
+      "rate = (int) 48000");
+  gst_check_setup_events (mysrcpad, deinterleave, caps, GST_FORMAT_TIME);
+
+  sinkpad = gst_element_get_static_pad (deinterleave, "sink");
+  fail_unless (sinkpad != NULL);
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  g_object_unref (sinkpad);
+
+  fail_unless (gst_element_set_state (deinterleave,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  inbuf = gst_buffer_new_and_alloc (48000 * sizeof (gfloat));
+  gst_buffer_memset (inbuf, 0, 0, 48000 * sizeof (gfloat));
+
+  /* the pad is only added with the caps, which come with the first buffer */
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink0");
+  gst_pad_set_chain_function (mysinkpad, deinterleave_chain_passthrough);
+  gst_pad_set_active (mysinkpad, TRUE);
+  g_signal_connect (deinterleave, "pad-added",
+      G_CALLBACK (deinterleave_pad_added_passthrough), mysinkpad);
+
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_ref (inbuf)) ==
+      GST_FLOW_OK);
+
+  /* a mono stream is pushed on without a copy */
+  fail_unless (passthrough_buffer == inbuf);
+  gst_buffer_unref (passthrough_buffer);
+  gst_buffer_unref (inbuf);
+
+  fail_unless (gst_element_set_state (deinterleave,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  g_object_unref (mysinkpad);
+  g_object_unref (mysrcpad);
+  g_object_unref (deinterleave);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+/* the deinterleave tests with many channels and all sample widths compare
+ * the output with the input copied sample by sample */
+static GstStaticPadTemplate any_sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate any_srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GByteArray **ref_outputs;
+
+static GstFlowReturn
+deinterleave_chain_ref (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstMapInfo map;
+  guint channel;
+
+  fail_unless_equals_int (sscanf (GST_PAD_NAME (pad), "sink%u", &channel), 1);
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  g_byte_array_append (ref_outputs[channel], map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static void
+deinterleave_pad_added_ref (GstElement * src, GstPad * pad, gpointer data)
+{
+  gchar *name;
+
+  name = g_strdup_printf ("sink%d", nsinkpads);
+  mysinkpads[nsinkpads] =
+      gst_pad_new_from_static_template (&any_sinktemplate, name);
+  g_free (name);
+  fail_if (mysinkpads[nsinkpads] == NULL);
+
+  gst_pad_set_chain_function (mysinkpads[nsinkpads], deinterleave_chain_ref);
+  fail_unless (gst_pad_link (pad, mysinkpads[nsinkpads]) == GST_PAD_LINK_OK);
+  gst_pad_set_active (mysinkpads[nsinkpads], TRUE);
+  nsinkpads++;
+}
+
+static void
+check_against_reference (const gchar * format, guint width, guint channels)
+{
+  /* odd sizes so that the blocks don't fit the buffers */
+  static const guint chunks[] = { 1000, 333, 1 };
+  GstPad *sinkpad;
+  GstBuffer *inbuf;
+  GstCaps *caps;
+  GstMapInfo map;
+  GByteArray *input;
+  GRand *rand;
+  guint i, c, b, nframes = 0;
+
+  mysinkpads = g_new0 (GstPad *, channels);
+  nsinkpads = 0;
+  ref_outputs = g_new0 (GByteArray *, channels);
+  for (c = 0; c < channels; c++)
+    ref_outputs[c] = g_byte_array_new ();
+
+  deinterleave = gst_element_factory_make ("deinterleave", NULL);
+  fail_unless (deinterleave != NULL);
+
+  mysrcpad = gst_pad_new_from_static_template (&any_srctemplate, "src");
+  fail_unless (mysrcpad != NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, format,
+      "channels", G_TYPE_INT, channels,
+      "layout", G_TYPE_STRING, "interleaved",
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+      "rate", G_TYPE_INT, 48000, NULL);
+  gst_check_setup_events (mysrcpad, deinterleave, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  sinkpad = gst_element_get_static_pad (deinterleave, "sink");
+  fail_unless (sinkpad != NULL);
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  g_object_unref (sinkpad);
+
+  g_signal_connect (deinterleave, "pad-added",
+      G_CALLBACK (deinterleave_pad_added_ref), NULL);
+
+  fail_unless (gst_element_set_state (deinterleave,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  rand = g_rand_new_with_seed (channels * width);
+  input = g_byte_array_new ();
+  for (i = 0; i < G_N_ELEMENTS (chunks); i++) {
+    guint size = chunks[i] * channels * width;
+
+    inbuf = gst_buffer_new_and_alloc (size);
+    gst_buffer_map (inbuf, &map, GST_MAP_WRITE);
+    for (b = 0; b < size; b++)
+      map.data[b] = g_rand_int (rand);
+    g_byte_array_append (input, map.data, size);
+    gst_buffer_unmap (inbuf, &map);
+
+    fail_unless (gst_pad_push (mysrcpad, inbuf) == GST_FLOW_OK);
+    nframes += chunks[i];
+  }
+  g_rand_free (rand);
+
+  fail_unless_equals_int (nsinkpads, channels);
+  for (c = 0; c < channels; c++) {
+    fail_unless_equals_int (ref_outputs[c]->len, nframes * width);
+
+    for (i = 0; i < nframes; i++) {
+      for (b = 0; b < width; b++) {
+        guint8 res = ref_outputs[c]->data[i * width + b];
+        guint8 ref = input->data[(i * channels + c) * width + b];
+
+        fail_unless (res == ref, "%s, %u channels: frame %u, channel %u, "
+            "byte %u: %u != %u", format, channels, i, c, b, res, ref);
+      }
+    }
+  }
+
+  fail_unless (gst_element_set_state (deinterleave,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  for (c = 0; c < channels; c++) {
+    g_object_unref (mysinkpads[c]);
+    g_byte_array_unref (ref_outputs[c]);
+  }
+  g_free (mysinkpads);
+  mysinkpads = NULL;
+  g_free (ref_outputs);
+  ref_outputs = NULL;
+  g_byte_array_unref (input);
+
+  g_object_unref (mysrcpad);
+  g_object_unref (deinterleave);
+}
+
+GST_START_TEST (test_deinterleave_against_reference)
+{
+  static const struct
+  {
+    const gchar *format;
+    guint width;
+  } formats[] = {
+    {"S8", 1},
+    {GST_AUDIO_NE (S16), 2},
+    {GST_AUDIO_NE (S24), 3},
+    {GST_AUDIO_NE (S32), 4},
+    {GST_AUDIO_NE (F64), 8}
+  };
+  static const guint channels[] = { 2, 3, 11, 64 };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    for (j = 0; j < G_N_ELEMENTS (channels); j++)
+      check_against_reference (formats[i].format, formats[i].width,
+          channels[j]);
+}
+
+GST_END_TEST;
+
 static Suite *
 deinterleave_suite (void)
 {
@@ -630,6 +879,8 @@ deinterleave_suite (void)
   tcase_add_test (tc_chain, test_2_channels_1_linked);
   tcase_add_test (tc_chain, test_2_channels_caps_change);
   tcase_add_test (tc_chain, test_8_channels_float32);
+  tcase_add_test (tc_chain, test_1_channel_passthrough);
+  tcase_add_test (tc_chain, test_deinterleave_against_reference);
 
   return s;
 }
@@ -26,6 +26,7 @@
 #include <gst/check/gstcheck.h>
 
 #include <math.h>
+#include <string.h>
 
 /* For ease of programming we use globals to keep refs for our floating
  * src and sink pads we create; otherwise we always have to do get_pad,
@@ -205,6 +206,75 @@ GST_START_TEST (test_equalizer_5bands_minus_24)
 
 GST_END_TEST;
 
+GST_START_TEST (test_equalizer_5bands_single_precision)
+{
+  GstElement *equalizer;
+  GstBuffer *inbuffer;
+  GstCaps *caps;
+  gdouble *in, *res, rms_in, rms_out;
+  gint i;
+  GstMapInfo map;
+
+  equalizer = setup_equalizer ();
+  g_object_set (G_OBJECT (equalizer), "num-bands", 5, "single-precision",
+      TRUE, NULL);
+
+  fail_unless_equals_int (gst_child_proxy_get_children_count (GST_CHILD_PROXY
+          (equalizer)), 5);
+
+  for (i = 0; i < 5; i++) {
+    GObject *band =
+        gst_child_proxy_get_child_by_index (GST_CHILD_PROXY (equalizer), i);
+    fail_unless (band != NULL);
+
+    g_object_set (band, "gain", -24.0, NULL);
+    g_object_unref (band);
+  }
+
+  fail_unless (gst_element_set_state (equalizer,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (1024 * sizeof (gdouble));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  in = (gdouble *) map.data;
+  for (i = 0; i < 1024; i++)
+    in[i] = g_random_double_range (-1.0, 1.0);
+  gst_buffer_unmap (inbuffer, &map);
+
+  rms_in = 0.0;
+  for (i = 0; i < 1024; i++)
+    rms_in += in[i] * in[i];
+  rms_in = sqrt (rms_in / 1024);
+
+  caps = gst_caps_from_string (EQUALIZER_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, equalizer, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+  ASSERT_BUFFER_REFCOUNT (inbuffer, "inbuffer", 1);
+
+  /* pushing gives away my reference ... */
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  /* ... and puts a new buffer on the global list */
+  fail_unless (g_list_length (buffers) == 1);
+
+  gst_buffer_map (GST_BUFFER (buffers->data), &map, GST_MAP_READ);
+  res = (gdouble *) map.data;
+
+  rms_out = 0.0;
+  for (i = 0; i < 1024; i++)
+    rms_out += res[i] * res[i];
+  rms_out = sqrt (rms_out / 1024);
+  gst_buffer_unmap (GST_BUFFER (buffers->data), &map);
+
+  fail_unless (rms_in > rms_out);
+
+  /* cleanup */
+  cleanup_equalizer (equalizer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_equalizer_5bands_plus_12)
 {
   GstElement *equalizer;
@@ -360,6 +430,138 @@ GST_START_TEST (test_equalizer_presets)
 
 GST_END_TEST;
 
+static GstStaticPadTemplate anysinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate anysrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* runs size bytes of data through a fresh 5 band equalizer and returns
+ * the output buffer */
+static GstBuffer *
+run_equalizer (GstAudioFormat format, guint channels,
+    gboolean single_precision, gconstpointer data, gsize size)
+{
+  GstElement *equalizer;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  gint i;
+
+  equalizer = gst_check_setup_element ("equalizer-nbands");
+  mysrcpad = gst_check_setup_src_pad (equalizer, &anysrctemplate);
+  mysinkpad = gst_check_setup_sink_pad (equalizer, &anysinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  g_object_set (G_OBJECT (equalizer), "num-bands", 5, "single-precision",
+      single_precision, NULL);
+  for (i = 0; i < 5; i++) {
+    GObject *band =
+        gst_child_proxy_get_child_by_index (GST_CHILD_PROXY (equalizer), i);
+    fail_unless (band != NULL);
+
+    g_object_set (band, "gain", (i % 2) ? -12.0 : 9.0, NULL);
+    g_object_unref (band);
+  }
+
+  fail_unless (gst_element_set_state (equalizer,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, gst_audio_format_to_string (format),
+      "layout", G_TYPE_STRING, "interleaved",
+      "channels", G_TYPE_INT, channels,
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0,
+      "rate", G_TYPE_INT, 48000, NULL);
+  gst_check_setup_events (mysrcpad, equalizer, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  inbuffer = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_fill (inbuffer, 0, data, size);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless (g_list_length (buffers) == 1);
+  outbuffer = gst_buffer_ref (GST_BUFFER (buffers->data));
+
+  cleanup_equalizer (equalizer);
+
+  return outbuffer;
+}
+
+/* The channels of a frame share the coefficients but nothing else, so
+ * filtering all of them at once must give exactly the same samples as
+ * filtering every channel on its own as a mono stream */
+static void
+check_multichannel (GstAudioFormat format, guint channels,
+    gboolean single_precision)
+{
+  const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+  guint width = GST_AUDIO_FORMAT_INFO_WIDTH (finfo) / 8;
+  guint frames = 1024, i, c;
+  guint8 *in, *mono_in;
+  GstBuffer *outbuffer, *monobuffer;
+  GstMapInfo map, mono_map;
+  GRand *rand;
+
+  rand = g_rand_new_with_seed (channels);
+  in = g_malloc (frames * channels * width);
+  for (i = 0; i < frames * channels; i++) {
+    gdouble val = g_rand_double_range (rand, -1.0, 1.0) / (1 + i % channels);
+
+    if (format == GST_AUDIO_FORMAT_S16)
+      ((gint16 *) in)[i] = val * G_MAXINT16;
+    else if (format == GST_AUDIO_FORMAT_F32)
+      ((gfloat *) in)[i] = val;
+    else
+      ((gdouble *) in)[i] = val;
+  }
+  g_rand_free (rand);
+
+  outbuffer = run_equalizer (format, channels, single_precision, in,
+      frames * channels * width);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, frames * channels * width);
+
+  mono_in = g_malloc (frames * width);
+  for (c = 0; c < channels; c++) {
+    for (i = 0; i < frames; i++)
+      memcpy (mono_in + i * width, in + (i * channels + c) * width, width);
+
+    monobuffer = run_equalizer (format, 1, single_precision, mono_in,
+        frames * width);
+    gst_buffer_map (monobuffer, &mono_map, GST_MAP_READ);
+    for (i = 0; i < frames; i++)
+      fail_unless (memcmp (mono_map.data + i * width,
+              map.data + (i * channels + c) * width, width) == 0,
+          "channel %u of %u differs at frame %u", c, channels, i);
+    gst_buffer_unmap (monobuffer, &mono_map);
+    gst_buffer_unref (monobuffer);
+  }
+  g_free (mono_in);
+
+  gst_buffer_unmap (outbuffer, &map);
+  gst_buffer_unref (outbuffer);
+  g_free (in);
+}
+
+GST_START_TEST (test_equalizer_multichannel)
+{
+  /* 10 channels are more than are run through a band at once */
+  check_multichannel (GST_AUDIO_FORMAT_S16, 3, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_S16, 10, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_F32, 3, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_F32, 10, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_F64, 3, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_F64, 10, FALSE);
+  check_multichannel (GST_AUDIO_FORMAT_S16, 10, TRUE);
+  check_multichannel (GST_AUDIO_FORMAT_F32, 10, TRUE);
+  check_multichannel (GST_AUDIO_FORMAT_F64, 10, TRUE);
+}
+
+GST_END_TEST;
 
 static Suite *
 equalizer_suite (void)
@@ -371,8 +573,10 @@ equalizer_suite (void)
   tcase_add_test (tc_chain, test_equalizer_5bands_passthrough);
   tcase_add_test (tc_chain, test_equalizer_5bands_minus_24);
   tcase_add_test (tc_chain, test_equalizer_5bands_plus_12);
+  tcase_add_test (tc_chain, test_equalizer_5bands_single_precision);
   tcase_add_test (tc_chain, test_equalizer_band_number_changing);
   tcase_add_test (tc_chain, test_equalizer_presets);
+  tcase_add_test (tc_chain, test_equalizer_multichannel);
 
   return s;
 }
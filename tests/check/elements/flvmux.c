@@ -53,7 +53,7 @@ handoff_cb (GstElement * element, GstBuffer * buf, GstPad * pad,
 }
 
 static void
-mux_pcm_audio (guint num_buffers, guint repeat)
+mux_pcm_audio (guint num_buffers, guint repeat, gboolean zero_copy)
 {
   GstElement *src, *sink, *flvmux, *conv, *pipeline;
   GstPad *sinkpad, *srcpad;
@@ -79,6 +79,8 @@ mux_pcm_audio (guint num_buffers, guint repeat)
   flvmux = gst_element_factory_make ("flvmux", "flvmux");
   fail_unless (flvmux != NULL, "Failed to create 'flvmux' element!");
 
+  g_object_set (flvmux, "zero-copy", zero_copy, NULL);
+
   sink = gst_element_factory_make ("fakesink", "fakesink");
   fail_unless (sink != NULL, "Failed to create 'fakesink' element!");
 
@@ -147,7 +149,14 @@ GST_START_TEST (test_index_writing)
 {
   /* note: there's a magic 128 value in flvmux when doing index writing */
   if ((__i__ % 33) == 1)
-    mux_pcm_audio (__i__, 2);
+    mux_pcm_audio (__i__, 2, FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_zero_copy)
+{
+  mux_pcm_audio (130, 2, TRUE);
 }
 
 GST_END_TEST;
@@ -168,6 +177,7 @@ flvmux_suite (void)
 #endif
 
   tcase_add_loop_test (tc_chain, test_index_writing, 1, loop);
+  tcase_add_test (tc_chain, test_zero_copy);
 
   return s;
 }
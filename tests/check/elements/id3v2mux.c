@@ -506,6 +506,64 @@ GST_START_TEST (test_id3v2mux)
 
 GST_END_TEST;
 
+GST_START_TEST (test_id3v2mux_tag_size)
+{
+  GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS ("application/x-id3"));
+  GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS ("audio/mpeg"));
+  GstElement *id3mux;
+  GstPad *srcpad, *sinkpad;
+  GstTagList *tags;
+  GstBuffer *buf;
+  GstCaps *caps;
+  GstMapInfo map;
+
+  id3mux = gst_check_setup_element ("id3v2mux");
+  g_object_set (id3mux, "tag-size", 8192, NULL);
+  srcpad = gst_check_setup_src_pad (id3mux, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (id3mux, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  tags = test_taglib_id3mux_create_tags (0xFFFFFFFF);
+  gst_tag_setter_merge_tags (GST_TAG_SETTER (id3mux), tags,
+      GST_TAG_MERGE_APPEND);
+  gst_tag_list_unref (tags);
+
+  fail_unless (gst_element_set_state (id3mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("audio/mpeg, mpegversion=(int)1");
+  gst_check_setup_events (srcpad, id3mux, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  buf = gst_buffer_new_and_alloc (MP3_FRAME_SIZE);
+  gst_buffer_fill (buf, 0, mp3_dummyhdr, sizeof (mp3_dummyhdr));
+  fail_unless_equals_int (gst_pad_push (srcpad, buf), GST_FLOW_OK);
+
+  /* the tag is padded to the requested size, the audio follows as is */
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  buf = GST_BUFFER (buffers->data);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 8192);
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, "ID3", 3) == 0);
+  fail_unless_equals_int (map.data[map.size - 1], 0);
+  gst_buffer_unmap (buf, &map);
+  buf = GST_BUFFER (buffers->next->data);
+  fail_unless_equals_int (gst_buffer_get_size (buf), MP3_FRAME_SIZE);
+
+  gst_element_set_state (id3mux, GST_STATE_NULL);
+  gst_check_drop_buffers ();
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (id3mux);
+  gst_check_teardown_sink_pad (id3mux);
+  gst_check_teardown_element (id3mux);
+}
+
+GST_END_TEST;
+
 static Suite *
 id3v2mux_suite (void)
 {
@@ -514,6 +572,7 @@ id3v2mux_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_id3v2mux);
+  tcase_add_test (tc_chain, test_id3v2mux_tag_size);
 
   return s;
 }
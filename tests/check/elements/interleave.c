@@ -769,6 +769,193 @@ GST_START_TEST (test_interleave_2ch_pipeline_custom_chanpos)
 
 GST_END_TEST;
 
+/* the interleave tests with many channels and all sample widths compare the
+ * output with the input copied sample by sample */
+#define REF_FRAMES 1000
+#define REF_BUFFERS 3
+
+static const gchar *ref_format;
+static guint ref_width, ref_channels, ref_gap_channel, ref_frames_out;
+
+/* a byte of the input of @channel that is different for every channel and
+ * position in the stream */
+static guint8
+ref_byte (guint channel, guint pos)
+{
+  guint32 h = (channel + 1) * 2654435761u ^ (pos + 1) * 40503u;
+
+  return h >> 24;
+}
+
+static void
+src_handoff_ref (GstElement * element, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  guint channel = GPOINTER_TO_UINT (user_data);
+  guint8 *data;
+  guint i, offset, size = REF_FRAMES * ref_width;
+  GstCaps *caps;
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, ref_format,
+      "channels", G_TYPE_INT, 1,
+      "layout", G_TYPE_STRING, "interleaved",
+      "rate", G_TYPE_INT, 48000, NULL);
+  gst_pad_set_caps (pad, caps);
+  gst_caps_unref (caps);
+
+  /* the number of buffers this source has made so far */
+  offset = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (element),
+          "ref-offset"));
+  g_object_set_data (G_OBJECT (element), "ref-offset",
+      GUINT_TO_POINTER (offset + 1));
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = ref_byte (channel, offset * size + i);
+
+  gst_buffer_append_memory (buffer, gst_memory_new_wrapped (0, data,
+          size, 0, size, data, g_free));
+
+  /* one channel has a gap in the middle */
+  if (channel == ref_gap_channel && offset == 1)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+
+  GST_BUFFER_OFFSET (buffer) = GST_BUFFER_OFFSET_NONE;
+  GST_BUFFER_TIMESTAMP (buffer) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
+  GST_BUFFER_DURATION (buffer) =
+      gst_util_uint64_scale_int (REF_FRAMES, GST_SECOND, 48000);
+}
+
+static void
+sink_handoff_ref (GstElement * element, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  GstMapInfo map;
+  guint i, c, b, nframes;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size % (ref_width * ref_channels), 0);
+  nframes = map.size / (ref_width * ref_channels);
+
+  for (i = 0; i < nframes; i++) {
+    guint frame = ref_frames_out + i;
+
+    for (c = 0; c < ref_channels; c++) {
+      for (b = 0; b < ref_width; b++) {
+        guint8 res = map.data[(i * ref_channels + c) * ref_width + b];
+        guint8 ref;
+
+        if (c == ref_gap_channel && frame / REF_FRAMES == 1)
+          ref = 0;
+        else
+          ref = ref_byte (c, frame * ref_width + b);
+
+        fail_unless (res == ref, "%s, %u channels: frame %u, channel %u, "
+            "byte %u: %u != %u", ref_format, ref_channels, frame, c, b, res,
+            ref);
+      }
+    }
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  ref_frames_out += nframes;
+}
+
+static void
+check_against_reference (const gchar * format, guint width, guint channels)
+{
+  GstElement *pipeline, *interleave, *sink;
+  GstPad **sinkpads, *tmp, *tmp2;
+  GstMessage *msg;
+  guint i;
+
+  ref_format = format;
+  ref_width = width;
+  ref_channels = channels;
+  ref_gap_channel = 1;
+  ref_frames_out = 0;
+
+  pipeline = (GstElement *) gst_pipeline_new ("pipeline");
+  fail_unless (pipeline != NULL);
+
+  interleave = gst_element_factory_make ("interleave", "interleave");
+  fail_unless (interleave != NULL);
+  g_object_set (interleave, "channel-positions-from-input", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), gst_object_ref (interleave));
+
+  sinkpads = g_new0 (GstPad *, channels);
+  for (i = 0; i < channels; i++) {
+    GstElement *src;
+
+    src = gst_element_factory_make ("fakesrc", NULL);
+    fail_unless (src != NULL);
+    g_object_set (src, "num-buffers", REF_BUFFERS, NULL);
+    g_object_set (src, "signal-handoffs", TRUE, NULL);
+    g_signal_connect (src, "handoff", G_CALLBACK (src_handoff_ref),
+        GUINT_TO_POINTER (i));
+    gst_bin_add (GST_BIN (pipeline), src);
+
+    sinkpads[i] = gst_element_get_request_pad (interleave, "sink_%u");
+    fail_unless (sinkpads[i] != NULL);
+    tmp = gst_element_get_static_pad (src, "src");
+    fail_unless (gst_pad_link (tmp, sinkpads[i]) == GST_PAD_LINK_OK);
+    gst_object_unref (tmp);
+  }
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (sink != NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (sink_handoff_ref), NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  tmp = gst_element_get_static_pad (interleave, "src");
+  tmp2 = gst_element_get_static_pad (sink, "sink");
+  fail_unless (gst_pad_link (tmp, tmp2) == GST_PAD_LINK_OK);
+  gst_object_unref (tmp);
+  gst_object_unref (tmp2);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  msg = gst_bus_poll (GST_ELEMENT_BUS (pipeline), GST_MESSAGE_EOS, -1);
+  gst_message_unref (msg);
+
+  fail_unless_equals_int (ref_frames_out, REF_FRAMES * REF_BUFFERS);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  for (i = 0; i < channels; i++) {
+    gst_element_release_request_pad (interleave, sinkpads[i]);
+    gst_object_unref (sinkpads[i]);
+  }
+  g_free (sinkpads);
+  gst_object_unref (interleave);
+  gst_object_unref (pipeline);
+}
+
+GST_START_TEST (test_interleave_against_reference)
+{
+  static const struct
+  {
+    const gchar *format;
+    guint width;
+  } formats[] = {
+    {"S8", 1},
+    {GST_AUDIO_NE (S16), 2},
+    {GST_AUDIO_NE (S24), 3},
+    {GST_AUDIO_NE (S32), 4},
+    {GST_AUDIO_NE (F64), 8}
+  };
+  static const guint channels[] = { 3, 11, 40 };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    for (j = 0; j < G_N_ELEMENTS (channels); j++)
+      check_against_reference (formats[i].format, formats[i].width,
+          channels[j]);
+}
+
+GST_END_TEST;
+
 static Suite *
 interleave_suite (void)
 {
@@ -784,6 +971,7 @@ interleave_suite (void)
   tcase_add_test (tc_chain, test_interleave_2ch_pipeline);
   tcase_add_test (tc_chain, test_interleave_2ch_pipeline_input_chanpos);
   tcase_add_test (tc_chain, test_interleave_2ch_pipeline_custom_chanpos);
+  tcase_add_test (tc_chain, test_interleave_against_reference);
 
   return s;
 }
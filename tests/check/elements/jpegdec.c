@@ -20,6 +20,7 @@
  */
 
 #include <unistd.h>
+#include <string.h>
 
 #include <gio/gio.h>
 #include <gst/check/gstcheck.h>
@@ -125,6 +126,73 @@ GST_START_TEST (test_jpegdec_discover)
 
 GST_END_TEST;
 
+/* decode a few frames of a test stream, either in one thread or in batches
+ * of frames on several threads */
+static GList *
+decode_test_stream (guint n_threads)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample;
+  GList *buffers = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=7 pattern=ball ! "
+      "video/x-raw, format=I420, width=320, height=240, framerate=30/1 ! "
+      "jpegenc ! jpegdec n-threads=%u ! appsink name=sink", n_threads);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  while ((sample = gst_app_sink_pull_sample (GST_APP_SINK (sink)))) {
+    buffers = g_list_append (buffers,
+        gst_buffer_ref (gst_sample_get_buffer (sample)));
+    gst_sample_unref (sample);
+  }
+  fail_unless (gst_app_sink_is_eos (GST_APP_SINK (sink)));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return buffers;
+}
+
+/* Verify the threads decode the same frames in the same order. */
+GST_START_TEST (test_jpegdec_threads)
+{
+  GList *serial, *threaded, *l, *m;
+
+  serial = decode_test_stream (1);
+  threaded = decode_test_stream (3);
+
+  /* the last frames of an unfinished batch are pushed at EOS */
+  fail_unless_equals_int (g_list_length (serial), 7);
+  fail_unless_equals_int (g_list_length (threaded), 7);
+
+  for (l = serial, m = threaded; l && m; l = l->next, m = m->next) {
+    GstMapInfo a, b;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (l->data),
+        GST_BUFFER_PTS (m->data));
+
+    gst_buffer_map (l->data, &a, GST_MAP_READ);
+    gst_buffer_map (m->data, &b, GST_MAP_READ);
+    fail_unless_equals_int (a.size, b.size);
+    fail_unless (memcmp (a.data, b.data, a.size) == 0);
+    gst_buffer_unmap (m->data, &b);
+    gst_buffer_unmap (l->data, &a);
+  }
+
+  g_list_free_full (serial, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (threaded, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
 static Suite *
 jpegdec_suite (void)
 {
@@ -134,6 +202,7 @@ jpegdec_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_jpegdec_explicit);
   tcase_add_test (tc_chain, test_jpegdec_discover);
+  tcase_add_test (tc_chain, test_jpegdec_threads);
 
   return s;
 }
@@ -21,6 +21,7 @@
  */
 
 #include <unistd.h>
+#include <string.h>
 
 #include <gst/check/gstcheck.h>
 #include <gst/app/gstappsink.h>
@@ -223,6 +224,75 @@ GST_START_TEST (test_jpegenc_different_caps)
 
 GST_END_TEST;
 
+/* encode a few frames with @n_threads and return the jpeg buffers */
+static GList *
+encode_test_stream (guint n_threads)
+{
+  GstElement *jpegenc;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GList *result;
+  gint i;
+
+  jpegenc = setup_jpegenc (&any_sinktemplate);
+  g_object_set (jpegenc, "n-threads", n_threads, NULL);
+  gst_element_set_state (jpegenc, GST_STATE_PLAYING);
+
+  caps = gst_caps_new_simple ("video/x-raw", "width", G_TYPE_INT,
+      320, "height", G_TYPE_INT, 240, "framerate",
+      GST_TYPE_FRACTION, 25, 1, "format", G_TYPE_STRING, "I420", NULL);
+  gst_check_setup_events (mysrcpad, jpegenc, caps, GST_FORMAT_TIME);
+
+  for (i = 0; i < 7; i++) {
+    fail_unless ((buffer = create_video_buffer (caps)) != NULL);
+    buffer = gst_buffer_make_writable (buffer);
+    GST_BUFFER_PTS (buffer) = i * GST_SECOND / 25;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND / 25;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  result = buffers;
+  buffers = NULL;
+
+  cleanup_jpegenc (jpegenc);
+
+  return result;
+}
+
+GST_START_TEST (test_jpegenc_threads)
+{
+  GList *serial, *threaded, *l, *m;
+
+  serial = encode_test_stream (1);
+  threaded = encode_test_stream (3);
+
+  /* the last frames of an unfinished batch are pushed at EOS */
+  fail_unless_equals_int (g_list_length (serial), 7);
+  fail_unless_equals_int (g_list_length (threaded), 7);
+
+  for (l = serial, m = threaded; l && m; l = l->next, m = m->next) {
+    GstMapInfo a, b;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (l->data),
+        GST_BUFFER_PTS (m->data));
+
+    gst_buffer_map (l->data, &a, GST_MAP_READ);
+    gst_buffer_map (m->data, &b, GST_MAP_READ);
+    fail_unless_equals_int (a.size, b.size);
+    fail_unless (memcmp (a.data, b.data, a.size) == 0);
+    gst_buffer_unmap (m->data, &b);
+    gst_buffer_unmap (l->data, &a);
+  }
+
+  g_list_free_full (serial, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (threaded, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
 static Suite *
 jpegenc_suite (void)
 {
@@ -232,6 +302,7 @@ jpegenc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_jpegenc_getcaps);
   tcase_add_test (tc_chain, test_jpegenc_different_caps);
+  tcase_add_test (tc_chain, test_jpegenc_threads);
 
   return s;
 }
@@ -0,0 +1,148 @@
+/* GStreamer
+ *
+ * unit test for latencyreport
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstElement *
+setup_latencyreport (void)
+{
+  GstElement *latencyreport;
+
+  GST_DEBUG ("setup_latencyreport");
+
+  latencyreport = gst_check_setup_element ("latencyreport");
+  mysrcpad = gst_check_setup_src_pad (latencyreport, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (latencyreport, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return latencyreport;
+}
+
+static void
+cleanup_latencyreport (GstElement * latencyreport)
+{
+  GST_DEBUG ("cleanup_latencyreport");
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (latencyreport);
+  gst_check_teardown_sink_pad (latencyreport);
+  gst_check_teardown_element (latencyreport);
+}
+
+static guint64
+get_uint64 (const GstStructure * s, const gchar * field)
+{
+  guint64 val = 0;
+
+  fail_unless (gst_structure_get_uint64 (s, field, &val), "missing %s",
+      field);
+  return val;
+}
+
+GST_START_TEST (test_report_on_eos)
+{
+  GstElement *latencyreport;
+  const GstStructure *s;
+  GstMessage *msg;
+  GstBus *bus;
+  GstCaps *caps;
+  gint i;
+
+  latencyreport = setup_latencyreport ();
+  /* only report on EOS */
+  g_object_set (latencyreport, "interval", G_MAXUINT64, NULL);
+
+  bus = gst_bus_new ();
+  gst_element_set_bus (latencyreport, bus);
+
+  fail_unless (gst_element_set_state (latencyreport,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_empty_simple ("application/x-test");
+  gst_check_setup_events (mysrcpad, latencyreport, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < 10; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (100);
+
+    gst_buffer_memset (buffer, 0, 0, 100);
+    GST_BUFFER_PTS (buffer) = i * GST_MSECOND;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  fail_unless_equals_int (g_list_length (buffers), 10);
+  fail_unless (gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT) == NULL);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  s = gst_message_get_structure (msg);
+  fail_unless (gst_structure_has_name (s, "latency-report"));
+
+  fail_unless_equals_uint64 (get_uint64 (s, "buffers"), 10);
+  fail_unless_equals_uint64 (get_uint64 (s, "bytes"), 1000);
+  fail_unless_equals_uint64 (get_uint64 (s, "size-p50"), 100);
+  fail_unless_equals_uint64 (get_uint64 (s, "size-p99"), 100);
+  fail_unless_equals_uint64 (get_uint64 (s, "size-max"), 100);
+  fail_unless (get_uint64 (s, "processing-p50") <=
+      get_uint64 (s, "processing-p99"));
+  fail_unless (get_uint64 (s, "processing-p99") <=
+      get_uint64 (s, "processing-max"));
+  gst_message_unref (msg);
+
+  gst_element_set_bus (latencyreport, NULL);
+  gst_object_unref (bus);
+  gst_check_drop_buffers ();
+
+  cleanup_latencyreport (latencyreport);
+}
+
+GST_END_TEST;
+
+static Suite *
+latencyreport_suite (void)
+{
+  Suite *s = suite_create ("latencyreport");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_report_on_eos);
+
+  return s;
+}
+
+GST_CHECK_MAIN (latencyreport);
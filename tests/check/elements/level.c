@@ -40,7 +40,7 @@ static GstPad *mysrcpad, *mysinkpad;
     "format = (string) { "GST_AUDIO_NE(S16)", "GST_AUDIO_NE(F32)" }, " \
     "layout = (string) interleaved, " \
     "rate = (int) [ 1, MAX ], " \
-    "channels = (int) [ 1, 8 ]"
+    "channels = (int) [ 1, MAX ]"
 
 /* we use rate = 1000 here for easy buffer size calculations */
 #define LEVEL_S16_CAPS_STRING \
@@ -582,6 +582,128 @@ GST_START_TEST (test_message_timestamps)
 
 GST_END_TEST;
 
+/* the per-channel square sum and peak of @channel, the way level computed
+ * them before all channels were done in one pass */
+static void
+reference_level (const gpointer data, gboolean is_float, guint num,
+    guint channels, guint channel, gdouble * NCS, gdouble * NPS)
+{
+  gdouble squaresum = 0.0, peaksquare = 0.0, square;
+  guint j;
+
+  for (j = channel; j < num; j += channels) {
+    if (is_float)
+      square = ((gdouble) ((gfloat *) data)[j]) * ((gfloat *) data)[j];
+    else
+      square = ((gdouble) ((gint16 *) data)[j]) * ((gint16 *) data)[j];
+    if (square > peaksquare)
+      peaksquare = square;
+    squaresum += square;
+  }
+
+  if (is_float) {
+    *NCS = squaresum;
+    *NPS = peaksquare;
+  } else {
+    *NCS = squaresum / (gdouble) (G_GINT64_CONSTANT (1) << 30);
+    *NPS = peaksquare / (gdouble) (G_GINT64_CONSTANT (1) << 30);
+  }
+}
+
+static void
+check_multichannel (gboolean is_float, guint channels)
+{
+  GstElement *level;
+  GstBuffer *inbuffer;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+  GstMapInfo map;
+  GRand *rand;
+  gchar *caps_str;
+  guint num = 100 * channels, i, c;
+  gsize size = num * (is_float ? sizeof (gfloat) : sizeof (gint16));
+
+  caps_str = g_strdup_printf ("audio/x-raw, format = (string) %s, "
+      "layout = (string) interleaved, rate = (int) 1000, "
+      "channels = (int) %u, channel-mask = (bitmask) 0",
+      is_float ? GST_AUDIO_NE (F32) : GST_AUDIO_NE (S16), channels);
+  level = setup_level (caps_str);
+  g_free (caps_str);
+  g_object_set (level, "message", TRUE, "interval", GST_SECOND / 10, NULL);
+  gst_element_set_state (level, GST_STATE_PLAYING);
+  bus = gst_bus_new ();
+  gst_element_set_bus (level, bus);
+
+  /* every channel gets noise of a different amplitude */
+  rand = g_rand_new_with_seed (channels);
+  inbuffer = gst_buffer_new_and_alloc (size);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < num; i++) {
+    gdouble amp = 1.0 / (1 + i % channels);
+
+    if (is_float)
+      ((gfloat *) map.data)[i] = amp * g_rand_double_range (rand, -1.0, 1.0);
+    else
+      ((gint16 *) map.data)[i] =
+          amp * g_rand_int_range (rand, G_MININT16, G_MAXINT16 + 1);
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  g_rand_free (rand);
+  GST_BUFFER_TIMESTAMP (inbuffer) = G_GUINT64_CONSTANT (0);
+
+  gst_buffer_ref (inbuffer);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  message = gst_bus_poll (bus, GST_MESSAGE_ELEMENT, -1);
+  structure = gst_message_get_structure (message);
+
+  gst_buffer_map (inbuffer, &map, GST_MAP_READ);
+  for (c = 0; c < channels; c++) {
+    gdouble NCS, NPS, rms, peak, decay;
+    GValueArray *arr;
+
+    reference_level (map.data, is_float, num, channels, c, &NCS, &NPS);
+
+    arr = g_value_get_boxed (gst_structure_get_value (structure, "rms"));
+    rms = g_value_get_double (g_value_array_get_nth (arr, c));
+    arr = g_value_get_boxed (gst_structure_get_value (structure, "peak"));
+    peak = g_value_get_double (g_value_array_get_nth (arr, c));
+    arr = g_value_get_boxed (gst_structure_get_value (structure, "decay"));
+    decay = g_value_get_double (g_value_array_get_nth (arr, c));
+    GST_DEBUG ("channel %u: rms %lf, peak %lf, decay %lf", c, rms, peak,
+        decay);
+
+    fail_unless (fabs (rms - 20 * log10 (sqrt (NCS / 100) + 1e-35f)) < 1e-9);
+    fail_unless (fabs (peak - 10 * log10 (NPS + 1e-35f)) < 1e-9);
+    fail_unless (fabs (decay - 10 * log10 (NPS + 1e-35f)) < 1e-9);
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  gst_buffer_unref (inbuffer);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (level, NULL);
+  gst_object_unref (bus);
+  gst_check_drop_buffers ();
+  gst_element_set_state (level, GST_STATE_NULL);
+  cleanup_level (level);
+}
+
+/* compares the one-pass calculators with the per-channel reference for
+ * mono, a group of channels and more channels than fit in one group */
+GST_START_TEST (test_multichannel)
+{
+  check_multichannel (FALSE, 1);
+  check_multichannel (FALSE, 3);
+  check_multichannel (FALSE, 10);
+  check_multichannel (TRUE, 1);
+  check_multichannel (TRUE, 3);
+  check_multichannel (TRUE, 10);
+}
+
+GST_END_TEST;
+
 static Suite *
 level_suite (void)
 {
@@ -597,6 +719,7 @@ level_suite (void)
   tcase_add_test (tc_chain, test_message_on_eos);
   tcase_add_test (tc_chain, test_message_count);
   tcase_add_test (tc_chain, test_message_timestamps);
+  tcase_add_test (tc_chain, test_multichannel);
 
   return s;
 }
@@ -21,6 +21,7 @@
  */
 
 #include <unistd.h>
+#include <string.h>
 
 #include <gst/check/gstcheck.h>
 #include <gst/base/gstadapter.h>
@@ -436,6 +437,80 @@ GST_START_TEST (test_reset)
 
 GST_END_TEST;
 
+static gint
+find_bytes (const guint8 * data, gsize size, const guint8 * needle,
+    gsize needle_size, gsize from)
+{
+  gsize i;
+
+  for (i = from; i + needle_size <= size; i++) {
+    if (memcmp (data + i, needle, needle_size) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+GST_START_TEST (test_streamable_index)
+{
+  GstElement *matroskamux;
+  GstBuffer *inbuffer, *outbuffer;
+  GstAdapter *adapter;
+  GstCaps *caps;
+  const guint8 *data;
+  gsize size;
+  gint cluster, cues, seekhead;
+  guint8 cluster_id[] = { 0x1f, 0x43, 0xb6, 0x75 };
+  guint8 cues_id[] = { 0x1c, 0x53, 0xbb, 0x6b };
+  guint8 seekhead_id[] = { 0x11, 0x4d, 0x9b, 0x74 };
+  guint8 unknown_size[] = { 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+  int i;
+
+  matroskamux = setup_matroskamux (&srcac3template);
+  g_object_set (matroskamux, "streamable-index", TRUE, NULL);
+
+  caps = gst_caps_from_string (AC3_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, matroskamux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < 2; i++) {
+    inbuffer = gst_buffer_new_allocate (NULL, 1, 0);
+    gst_buffer_memset (inbuffer, 0, 0x42, 1);
+    GST_BUFFER_TIMESTAMP (inbuffer) = i * GST_MSECOND;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  adapter = gst_adapter_new ();
+  while (buffers) {
+    outbuffer = GST_BUFFER (buffers->data);
+    buffers = g_list_remove (buffers, outbuffer);
+    gst_adapter_push (adapter, outbuffer);
+  }
+
+  size = gst_adapter_available (adapter);
+  data = gst_adapter_map (adapter, size);
+
+  /* the cluster has its size filled in, and Cues followed by a SeekHead
+   * come after it */
+  cluster = find_bytes (data, size, cluster_id, sizeof (cluster_id), 0);
+  fail_unless (cluster >= 0);
+  fail_unless (cluster + 12 <= size);
+  fail_if (memcmp (data + cluster + 4, unknown_size,
+          sizeof (unknown_size)) == 0);
+  cues = find_bytes (data, size, cues_id, sizeof (cues_id), cluster);
+  fail_unless (cues > cluster);
+  seekhead = find_bytes (data, size, seekhead_id, sizeof (seekhead_id), cues);
+  fail_unless (seekhead > cues);
+
+  gst_adapter_unmap (adapter);
+  g_object_unref (adapter);
+
+  cleanup_matroskamux (matroskamux);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_link_webmmux_webm_sink)
 {
   static GstStaticPadTemplate webm_sinktemplate =
@@ -472,6 +547,7 @@ matroskamux_suite (void)
   tcase_add_test (tc_chain, test_vorbis_header);
   tcase_add_test (tc_chain, test_block_group);
   tcase_add_test (tc_chain, test_reset);
+  tcase_add_test (tc_chain, test_streamable_index);
   tcase_add_test (tc_chain, test_link_webmmux_webm_sink);
 
   return s;
@@ -158,6 +158,37 @@ GST_START_TEST (test_tags)
 
 GST_END_TEST;
 
+GST_START_TEST (test_values)
+{
+  static const gint16 in[] = { 0, -1, 1, 100, -100, 32767, -32768, 8158 };
+  static const guint8 expected[] = {
+    0xff, 0x7f, 0xff, 0xf2, 0x72, 0x80, 0x00, 0x9f
+  };
+  GstBuffer *buffer, *outbuf;
+  GstMapInfo map;
+  gint16 *data;
+  guint i;
+
+  fail_unless (gst_element_set_state (mulawenc, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS, "could not change state to playing");
+
+  buffer = gst_buffer_new_allocate (NULL, sizeof (in), NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    data[i] = GINT16_TO_LE (in[i]);
+  gst_buffer_unmap (buffer, &map);
+
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  fail_unless (g_list_length (buffers) == 1);
+  outbuf = GST_BUFFER (buffers->data);
+  fail_unless_equals_int (gst_buffer_get_size (outbuf), sizeof (expected));
+  fail_unless (gst_buffer_memcmp (outbuf, 0, expected, sizeof (expected)) == 0);
+}
+
+GST_END_TEST;
+
 static Suite *
 mulawenc_suite (void)
 {
@@ -169,6 +200,7 @@ mulawenc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_one_buffer);
   tcase_add_test (tc_chain, test_tags);
+  tcase_add_test (tc_chain, test_values);
   return s;
 }
 
@@ -134,6 +134,55 @@ GST_START_TEST (test_multifilesink_max_files)
 
 GST_END_TEST;
 
+GST_START_TEST (test_multifilesink_async_write)
+{
+  GstElement *pipeline;
+  GstElement *mfs;
+  int i;
+  const gchar *tmpdir;
+  gchar *my_tmpdir;
+  gchar *template;
+  gchar *mfs_pattern;
+
+  tmpdir = g_get_tmp_dir ();
+  template = g_build_filename (tmpdir, "multifile-test-XXXXXX", NULL);
+  my_tmpdir = g_mkdtemp (template);
+  fail_if (my_tmpdir == NULL);
+
+  pipeline =
+      gst_parse_launch
+      ("videotestsrc num-buffers=10 ! video/x-raw,format=(string)I420,width=320,height=240 ! multifilesink name=mfs",
+      NULL);
+  fail_if (pipeline == NULL);
+  mfs = gst_bin_get_by_name (GST_BIN (pipeline), "mfs");
+  fail_if (mfs == NULL);
+  mfs_pattern = g_build_filename (my_tmpdir, "%05d", NULL);
+  /* two frames per file, and a queue small enough to block upstream */
+  g_object_set (G_OBJECT (mfs), "location", mfs_pattern, "next-file", 4,
+      "max-file-size", (guint64) (2 * 115200), "async-write", TRUE,
+      "max-queued-bytes", (guint64) 1, "data-sync", 1, NULL);
+  g_object_unref (mfs);
+  run_pipeline (pipeline);
+  gst_object_unref (pipeline);
+
+  for (i = 0; i < 5; i++) {
+    GStatBuf st;
+    char *s;
+
+    s = g_strdup_printf (mfs_pattern, i);
+    fail_if (g_stat (s, &st) != 0);
+    fail_unless_equals_int (st.st_size, 2 * 115200);
+    fail_if (g_remove (s) != 0);
+    g_free (s);
+  }
+  fail_if (g_remove (my_tmpdir) != 0);
+
+  g_free (mfs_pattern);
+  g_free (my_tmpdir);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_multifilesink_key_unit)
 {
   GstElement *mfs;
@@ -256,6 +305,79 @@ GST_START_TEST (test_multifilesrc)
 
 GST_END_TEST;
 
+static void
+check_multifilesrc (const gchar * src_desc)
+{
+  GstElement *pipeline;
+  GstElement *mfs;
+  int i;
+  const gchar *tmpdir;
+  gchar *my_tmpdir;
+  gchar *template;
+  gchar *mfs_pattern;
+  gchar *desc;
+
+  tmpdir = g_get_tmp_dir ();
+  template = g_build_filename (tmpdir, "multifile-test-XXXXXX", NULL);
+  my_tmpdir = g_mkdtemp (template);
+  fail_if (my_tmpdir == NULL);
+
+  pipeline =
+      gst_parse_launch
+      ("videotestsrc num-buffers=10 ! video/x-raw,format=(string)I420,width=320,height=240 ! multifilesink name=mfs",
+      NULL);
+  fail_if (pipeline == NULL);
+  mfs = gst_bin_get_by_name (GST_BIN (pipeline), "mfs");
+  fail_if (mfs == NULL);
+  mfs_pattern = g_build_filename (my_tmpdir, "%05d", NULL);
+  g_object_set (G_OBJECT (mfs), "location", mfs_pattern, NULL);
+  g_free (mfs_pattern);
+  g_object_unref (mfs);
+  run_pipeline (pipeline);
+  gst_object_unref (pipeline);
+
+  desc = g_strdup_printf ("%s name=mfs ! video/x-raw,format=(string)I420,"
+      "width=320,height=240,framerate=10/1 ! fakesink", src_desc);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_if (pipeline == NULL);
+  mfs = gst_bin_get_by_name (GST_BIN (pipeline), "mfs");
+  fail_if (mfs == NULL);
+  mfs_pattern = g_build_filename (my_tmpdir, "%05d", NULL);
+  g_object_set (G_OBJECT (mfs), "location", mfs_pattern, NULL);
+  g_object_unref (mfs);
+  run_pipeline (pipeline);
+  gst_object_unref (pipeline);
+
+  for (i = 0; i < 10; i++) {
+    char *s;
+
+    s = g_strdup_printf (mfs_pattern, i);
+    fail_if (g_remove (s) != 0);
+    g_free (s);
+  }
+  fail_if (g_remove (my_tmpdir) != 0);
+
+  g_free (mfs_pattern);
+  g_free (my_tmpdir);
+}
+
+GST_START_TEST (test_multifilesrc_mmap)
+{
+  check_multifilesrc ("multifilesrc use-mmap=true read-ahead=3");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_multifilesrc_prefetch)
+{
+  check_multifilesrc ("multifilesrc prefetch=4");
+  check_multifilesrc ("multifilesrc prefetch=4 use-mmap=true loop=true "
+      "stop-index=9");
+}
+
+GST_END_TEST;
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -315,8 +437,11 @@ multifile_suite (void)
 
   tcase_add_test (tc_chain, test_multifilesink_key_frame);
   tcase_add_test (tc_chain, test_multifilesink_max_files);
+  tcase_add_test (tc_chain, test_multifilesink_async_write);
   tcase_add_test (tc_chain, test_multifilesink_key_unit);
   tcase_add_test (tc_chain, test_multifilesrc);
+  tcase_add_test (tc_chain, test_multifilesrc_mmap);
+  tcase_add_test (tc_chain, test_multifilesrc_prefetch);
   tcase_add_test (tc_chain, test_multifilesrc_stop_index);
 
   return s;
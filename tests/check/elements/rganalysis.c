@@ -62,6 +62,9 @@
 #include <gst/check/gstcheck.h>
 #include <gst/audio/audio.h>
 
+#include <math.h>
+#include <string.h>
+
 /* For ease of programming we use globals to keep refs for our floating src and
  * sink pads we create; otherwise we always have to do get_pad, get_peer, and
  * then remove references in every test function */
@@ -1899,6 +1902,350 @@ MAKE_GAIN_TEST_INT16_STEREO (32000, 16);
 MAKE_GAIN_TEST_INT16_STEREO (44100, 16);
 MAKE_GAIN_TEST_INT16_STEREO (48000, 16);
 
+/* The per-channel analysis the interleaved lanes replaced, written out for
+ * whole tracks at 48000 and 44100 Hz.  The filters and the windows follow
+ * the old code operation by operation, so the results have to match
+ * exactly. */
+
+static const gfloat ref_a_yule[2][11] = {
+  {1., -3.84664617118067, 7.81501653005538, -11.34170355132042,
+        13.05504219327545, -12.28759895145294, 9.48293806319790,
+        -5.87257861775999, 2.75465861874613, -0.86984376593551,
+      0.13919314567432},
+  {1., -3.47845948550071, 6.36317777566148, -8.54751527471874, 9.47693607801280,
+        -8.81498681370155, 6.85401540936998, -4.39470996079559,
+      2.19611684890774, -0.75104302451432, 0.13149317958808}
+};
+
+static const gfloat ref_b_yule[2][11] = {
+  {0.03857599435200, -0.02160367184185, -0.00123395316851, -0.00009291677959,
+        -0.01655260341619, 0.02161526843274, -0.02074045215285,
+      0.00594298065125, 0.00306428023191, 0.00012025322027, 0.00288463683916},
+  {0.05418656406430, -0.02911007808948, -0.00848709379851, -0.00851165645469,
+        -0.00834990904936, 0.02245293253339, -0.02596338512915,
+        0.01624864962975, -0.00240879051584, 0.00674613682247,
+      -0.00187763777362}
+};
+
+static const gfloat ref_a_butter[2][3] = {
+  {1., -1.97223372919527, 0.97261396931306},
+  {1., -1.96977855582618, 0.97022847566350}
+};
+
+static const gfloat ref_b_butter[2][3] = {
+  {0.98621192462708, -1.97242384925416, 0.98621192462708},
+  {0.98500175787242, -1.97000351574484, 0.98500175787242}
+};
+
+#define REF_ORDER 10
+#define REF_HISTOGRAM_SIZE (100 * 120)
+
+typedef struct
+{
+  gint sample_rate;
+  /* Both channels of the track, scaled to +/-32768. */
+  GArray *l, *r;
+  gdouble peak;
+  guint n_frames;
+} RefTrack;
+
+static void
+ref_track_init (RefTrack * track, gint sample_rate)
+{
+  track->sample_rate = sample_rate;
+  track->l = g_array_new (FALSE, FALSE, sizeof (gfloat));
+  track->r = g_array_new (FALSE, FALSE, sizeof (gfloat));
+  track->peak = 0.;
+  track->n_frames = 0;
+}
+
+static void
+ref_track_clear (RefTrack * track)
+{
+  g_array_free (track->l, TRUE);
+  g_array_free (track->r, TRUE);
+}
+
+/* Runs the equal loudness filter over a whole channel. */
+
+static gfloat *
+ref_filter (const RefTrack * track, const GArray * channel)
+{
+  gint index = (track->sample_rate == 48000) ? 0 : 1;
+  const gfloat *a = ref_a_yule[index], *b = ref_b_yule[index];
+  const gfloat *ab = ref_a_butter[index], *bb = ref_b_butter[index];
+  guint n = channel->len;
+  gfloat *in = g_new0 (gfloat, n + REF_ORDER);
+  gfloat *step = g_new0 (gfloat, n + REF_ORDER);
+  gfloat *out = g_new0 (gfloat, n + REF_ORDER);
+  guint i;
+
+  memcpy (in + REF_ORDER, channel->data, n * sizeof (gfloat));
+  for (i = REF_ORDER; i < n + REF_ORDER; i++) {
+    step[i] = 1e-10 + in[i] * b[0]
+        + in[i - 1] * b[1] - step[i - 1] * a[1]
+        + in[i - 2] * b[2] - step[i - 2] * a[2]
+        + in[i - 3] * b[3] - step[i - 3] * a[3]
+        + in[i - 4] * b[4] - step[i - 4] * a[4]
+        + in[i - 5] * b[5] - step[i - 5] * a[5]
+        + in[i - 6] * b[6] - step[i - 6] * a[6]
+        + in[i - 7] * b[7] - step[i - 7] * a[7]
+        + in[i - 8] * b[8] - step[i - 8] * a[8]
+        + in[i - 9] * b[9] - step[i - 9] * a[9]
+        + in[i - 10] * b[10] - step[i - 10] * a[10];
+    out[i] = step[i] * bb[0]
+        + step[i - 1] * bb[1] - out[i - 1] * ab[1]
+        + step[i - 2] * bb[2] - out[i - 2] * ab[2];
+  }
+
+  g_free (in);
+  g_free (step);
+  memmove (out, out + REF_ORDER, n * sizeof (gfloat));
+
+  return out;
+}
+
+/* Adds the RMS windows of the track to @histogram.  An incomplete last
+ * window is dropped. */
+
+static void
+ref_track_histogram (const RefTrack * track, guint32 * histogram)
+{
+  guint window = (track->sample_rate * 50 + 999) / 1000;
+  gfloat *out_l = ref_filter (track, track->l);
+  gfloat *out_r = ref_filter (track, track->r);
+  guint i, j;
+
+  for (i = 0; i + window <= track->n_frames; i += window) {
+    gdouble square_sum = 0., val;
+    gint ival;
+
+    for (j = i; j < i + window; j++)
+      square_sum += out_l[j] * out_l[j] + out_r[j] * out_r[j];
+
+    val = 100 * 10. * log10 (square_sum / window * 0.5 + 1.e-37);
+    ival = CLAMP ((gint) val, 0, REF_HISTOGRAM_SIZE - 1);
+    histogram[ival]++;
+  }
+
+  g_free (out_l);
+  g_free (out_r);
+}
+
+static gdouble
+ref_gain (const guint32 * histogram)
+{
+  guint32 sum = 0, upper;
+  guint i;
+
+  for (i = 0; i < REF_HISTOGRAM_SIZE; i++)
+    sum += histogram[i];
+  fail_unless (sum > 0);
+
+  upper = (guint32) ceil (sum * (1. - (gdouble) (95 / 100.)));
+  for (i = REF_HISTOGRAM_SIZE; i--;) {
+    if (upper <= histogram[i])
+      break;
+    upper -= histogram[i];
+  }
+
+  return SILENCE_GAIN - (gdouble) i / 100;
+}
+
+/* Pushes @n_frames frames of noise with a changing level in @format and
+ * adds them to the reference track.  The buffers get odd sizes that don't
+ * line up with the RMS windows. */
+
+static void
+push_ref_frames (RefTrack * track, GRand * rand, const gchar * format,
+    gint channels, guint n_frames)
+{
+  static const guint chunks[] = { 1000, 17, 2205, 1, 4801, 333 };
+  gboolean is_float = (strcmp (format, GST_AUDIO_NE (F32)) == 0);
+  guint i, c, k = 0;
+
+  send_caps_event (format, track->sample_rate, channels);
+
+  while (n_frames) {
+    guint n = MIN (n_frames, chunks[k++ % G_N_ELEMENTS (chunks)]);
+    gsize size = n * channels * (is_float ? sizeof (gfloat) : sizeof (gint16));
+    GstBuffer *buf = gst_buffer_new_and_alloc (size);
+    GstMapInfo map;
+
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    for (i = 0; i < n; i++) {
+      gdouble level = 0.5 + 0.45 * sin (track->n_frames / 3000.);
+      gfloat ref[2];
+
+      for (c = 0; c < channels; c++) {
+        gdouble x = level * g_rand_double_range (rand, -1.0, 1.0);
+
+        if (is_float) {
+          gfloat f = x;
+
+          ((gfloat *) map.data)[i * channels + c] = f;
+          track->peak = MAX (track->peak, fabs (f));
+          ref[c] = f * 32768.;
+        } else {
+          gint16 s = x * 32767;
+
+          ((gint16 *) map.data)[i * channels + c] = s;
+          track->peak = MAX (track->peak, ABS (s) / 32768.);
+          ref[c] = s;
+        }
+      }
+      /* Mono counts for both channels. */
+      g_array_append_val (track->l, ref[0]);
+      g_array_append_val (track->r, ref[channels - 1]);
+      track->n_frames++;
+    }
+    gst_buffer_unmap (buf, &map);
+
+    push_buffer (buf);
+    n_frames -= n;
+  }
+}
+
+/* Ends the track and checks its tags.  Returns the tag list, which may
+ * also hold the album result. */
+
+static GstTagList *
+check_track_against_reference (GstElement * element, const RefTrack * track)
+{
+  guint32 histogram[REF_HISTOGRAM_SIZE] = { 0, };
+  GstTagList *tag_list;
+
+  send_eos_event (element);
+  tag_list = poll_tags_followed_by_eos (element);
+  ref_track_histogram (track, histogram);
+  fail_unless_track_peak (tag_list, track->peak);
+  fail_unless_track_gain (tag_list, ref_gain (histogram));
+
+  return tag_list;
+}
+
+GST_START_TEST (test_lanes_against_reference)
+{
+  static const struct
+  {
+    const gchar *format;
+    gint sample_rate;
+    gint channels;
+  } tests[] = {
+    {GST_AUDIO_NE (F32), 44100, 2},
+    {GST_AUDIO_NE (F32), 48000, 1},
+    {GST_AUDIO_NE (S16), 44100, 1},
+    {GST_AUDIO_NE (S16), 48000, 2}
+  };
+  GstElement *element;
+  GstTagList *tag_list;
+  RefTrack track;
+  GRand *rand;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    element = setup_rganalysis ();
+    set_playing_state (element);
+    send_stream_start_event (element);
+    send_caps_event (tests[i].format, tests[i].sample_rate,
+        tests[i].channels);
+    send_segment_event (element);
+
+    rand = g_rand_new_with_seed (i);
+    ref_track_init (&track, tests[i].sample_rate);
+    push_ref_frames (&track, rand, tests[i].format, tests[i].channels,
+        3 * tests[i].sample_rate);
+    tag_list = check_track_against_reference (element, &track);
+    gst_tag_list_unref (tag_list);
+    ref_track_clear (&track);
+    g_rand_free (rand);
+
+    cleanup_rganalysis (element);
+  }
+}
+
+GST_END_TEST;
+
+/* Mono data followed by stereo data within a track switches the context
+ * from one lane to two; mono data after that is analyzed in both lanes. */
+
+GST_START_TEST (test_lanes_mono_stereo_against_reference)
+{
+  GstElement *element = setup_rganalysis ();
+  GstTagList *tag_list;
+  RefTrack track;
+  GRand *rand;
+
+  set_playing_state (element);
+  send_stream_start_event (element);
+  send_caps_event (GST_AUDIO_NE (F32), 48000, 1);
+  send_segment_event (element);
+
+  rand = g_rand_new_with_seed (42);
+  ref_track_init (&track, 48000);
+  /* Switch in the middle of an RMS window. */
+  push_ref_frames (&track, rand, GST_AUDIO_NE (F32), 1, 48000 + 1234);
+  push_ref_frames (&track, rand, GST_AUDIO_NE (F32), 2, 48000);
+  push_ref_frames (&track, rand, GST_AUDIO_NE (S16), 1, 24000 + 5);
+  push_ref_frames (&track, rand, GST_AUDIO_NE (S16), 2, 24000);
+  tag_list = check_track_against_reference (element, &track);
+  gst_tag_list_unref (tag_list);
+  ref_track_clear (&track);
+  g_rand_free (rand);
+
+  cleanup_rganalysis (element);
+}
+
+GST_END_TEST;
+
+/* The album result is taken from the histograms of all tracks added
+ * together. */
+
+GST_START_TEST (test_album_against_reference)
+{
+  GstElement *element = setup_rganalysis ();
+  guint32 histogram[REF_HISTOGRAM_SIZE] = { 0, };
+  GstTagList *tag_list;
+  RefTrack track;
+  gdouble album_peak = 0.;
+  GRand *rand;
+  gint i;
+
+  g_object_set (element, "num-tracks", 3, NULL);
+  set_playing_state (element);
+  send_stream_start_event (element);
+  send_caps_event (GST_AUDIO_NE (F32), 44100, 2);
+  send_segment_event (element);
+
+  rand = g_rand_new_with_seed (7);
+  for (i = 0; i < 3; i++) {
+    if (i > 0) {
+      send_flush_events (element);
+      send_segment_event (element);
+    }
+
+    ref_track_init (&track, 44100);
+    push_ref_frames (&track, rand, GST_AUDIO_NE (F32), (i == 1) ? 1 : 2,
+        (i + 1) * 44100 + 100);
+    ref_track_histogram (&track, histogram);
+    album_peak = MAX (album_peak, track.peak);
+    tag_list = check_track_against_reference (element, &track);
+    if (i < 2) {
+      fail_if_album_tags (tag_list);
+    } else {
+      fail_unless_album_peak (tag_list, album_peak);
+      fail_unless_album_gain (tag_list, ref_gain (histogram));
+    }
+    gst_tag_list_unref (tag_list);
+    ref_track_clear (&track);
+  }
+  g_rand_free (rand);
+
+  cleanup_rganalysis (element);
+}
+
+GST_END_TEST;
+
 static Suite *
 rganalysis_suite (void)
 {
@@ -1933,6 +2280,10 @@ rganalysis_suite (void)
 
   tcase_add_test (tc_chain, test_all_formats);
 
+  tcase_add_test (tc_chain, test_lanes_against_reference);
+  tcase_add_test (tc_chain, test_lanes_mono_stereo_against_reference);
+  tcase_add_test (tc_chain, test_album_against_reference);
+
   tcase_add_test (tc_chain, test_gain_float_mono_8000);
   tcase_add_test (tc_chain, test_gain_float_mono_11025);
   tcase_add_test (tc_chain, test_gain_float_mono_12000);
@@ -18,6 +18,7 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -633,6 +634,388 @@ GST_START_TEST (rtp_h264_list_gt_mtu_avc)
 
 GST_END_TEST;
 
+static GstStaticPadTemplate h264_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-h264")
+    );
+
+static GstStaticPadTemplate rtp_sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+/* with au alignment the last NAL of a buffer is payloaded right away and the
+ * fragments refer to the memory of the input buffer */
+GST_START_TEST (rtp_h264_au_aligned_fragments)
+{
+  GstElement *pay;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstBuffer *inbuf, *outbuf;
+  GstMemory *inmem, *outmem;
+  GList *walk;
+  guint8 header[12];
+  guint8 *data;
+  gsize payload_bytes = 0;
+
+  pay = gst_check_setup_element ("rtph264pay");
+  g_object_set (pay, "mtu", 28, NULL);
+  srcpad = gst_check_setup_src_pad (pay, &h264_src_template);
+  sinkpad = gst_check_setup_sink_pad (pay, &rtp_sink_template);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  ASSERT_SET_STATE (pay, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("video/x-h264, "
+      "stream-format = (string) byte-stream, alignment = (string) au");
+  gst_check_setup_events (srcpad, pay, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* a non-IDR slice of 60 bytes after the start code */
+  inbuf = gst_buffer_new_allocate (NULL, 64, NULL);
+  gst_buffer_memset (inbuf, 0, 0xaa, 64);
+  data = g_malloc (5);
+  data[0] = data[1] = data[2] = 0x00;
+  data[3] = 0x01;
+  data[4] = 0x01;
+  gst_buffer_fill (inbuf, 0, data, 5);
+  g_free (data);
+  GST_BUFFER_PTS (inbuf) = 0;
+  inmem = gst_buffer_peek_memory (inbuf, 0);
+
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_ref (inbuf)),
+      GST_FLOW_OK);
+
+  /* all fragments are out without waiting for the next buffer */
+  fail_unless (buffers != NULL);
+  for (walk = buffers; walk; walk = walk->next) {
+    outbuf = walk->data;
+    fail_unless (gst_buffer_n_memory (outbuf) > 1);
+    outmem = gst_buffer_peek_memory (outbuf, gst_buffer_n_memory (outbuf) - 1);
+    fail_unless (outmem == inmem || outmem->parent == inmem);
+    payload_bytes += gst_memory_get_sizes (outmem, NULL, NULL);
+
+    gst_buffer_extract (outbuf, 0, header, sizeof (header));
+    /* the marker is only set on the last fragment of the access unit */
+    fail_unless_equals_int ((header[1] & 0x80) != 0, walk->next == NULL);
+  }
+  /* without the start code and the NAL header, which is in the FU header */
+  fail_unless_equals_int (payload_bytes, 64 - 4 - 1);
+
+  gst_buffer_unref (inbuf);
+  gst_check_drop_buffers ();
+  ASSERT_SET_STATE (pay, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_src_pad (pay);
+  gst_check_teardown_sink_pad (pay);
+  gst_check_teardown_element (pay);
+}
+
+GST_END_TEST;
+
+static GstStaticPadTemplate rtp_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate h264_sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-h264, stream-format = (string) byte-stream, "
+        "alignment = (string) nal")
+    );
+
+/* the fragments of a FU-A are reassembled by referencing the memory of the
+ * RTP packets */
+GST_START_TEST (rtp_h264depay_fu_a_memory)
+{
+  GstElement *depay;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstBuffer *inbuf[3], *outbuf;
+  GstMemory *mem;
+  guint8 packet[12 + 2 + 20];
+  guint8 expected[4 + 1 + 3 * 20];
+  gint i;
+
+  depay = gst_check_setup_element ("rtph264depay");
+  srcpad = gst_check_setup_src_pad (depay, &rtp_src_template);
+  sinkpad = gst_check_setup_sink_pad (depay, &h264_sink_template);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  ASSERT_SET_STATE (depay, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("application/x-rtp, media = (string) video, "
+      "clock-rate = (int) 90000, encoding-name = (string) H264");
+  gst_check_setup_events (srcpad, depay, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  expected[0] = expected[1] = expected[2] = 0x00;
+  expected[3] = 0x01;
+  /* NRI 3, IDR slice with first_mb_in_slice 0 */
+  expected[4] = 0x65;
+
+  for (i = 0; i < 3; i++) {
+    memset (packet, 0, sizeof (packet));
+    /* version 2, payload type 96, marker on the last fragment */
+    packet[0] = 0x80;
+    packet[1] = 0x60 | (i == 2 ? 0x80 : 0x00);
+    packet[3] = i;
+    /* FU indicator and FU header with the start and end bits */
+    packet[12] = 0x7c;
+    packet[13] = 0x05 | (i == 0 ? 0x80 : 0x00) | (i == 2 ? 0x40 : 0x00);
+    memset (packet + 14, 0x80 + i, 20);
+    memcpy (expected + 5 + i * 20, packet + 14, 20);
+
+    inbuf[i] = gst_buffer_new_allocate (NULL, sizeof (packet), NULL);
+    gst_buffer_fill (inbuf[i], 0, packet, sizeof (packet));
+    GST_BUFFER_PTS (inbuf[i]) = 0;
+
+    fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_ref (inbuf[i])),
+        GST_FLOW_OK);
+  }
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  outbuf = buffers->data;
+  fail_unless_equals_int (gst_buffer_get_size (outbuf), sizeof (expected));
+  fail_unless (gst_buffer_memcmp (outbuf, 0, expected, sizeof (expected)) == 0);
+
+  /* the NAL header followed by one memory per fragment */
+  fail_unless_equals_int (gst_buffer_n_memory (outbuf), 4);
+  for (i = 0; i < 3; i++) {
+    mem = gst_buffer_peek_memory (outbuf, i + 1);
+    fail_unless (mem->parent == gst_buffer_peek_memory (inbuf[i], 0));
+    gst_buffer_unref (inbuf[i]);
+  }
+
+  gst_check_drop_buffers ();
+  ASSERT_SET_STATE (depay, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_src_pad (depay);
+  gst_check_teardown_sink_pad (depay);
+  gst_check_teardown_element (depay);
+}
+
+GST_END_TEST;
+
+static GstStaticPadTemplate any_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate any_sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* push @inbufs with @caps into @element and return what comes out. The caps
+ * of the output are returned in @outcaps. */
+static GList *
+push_through_element (GstElement * element, GstCaps * caps, GList * inbufs,
+    GstCaps ** outcaps)
+{
+  GstPad *srcpad, *sinkpad;
+  GList *walk, *outbufs;
+
+  srcpad = gst_check_setup_src_pad (element, &any_src_template);
+  sinkpad = gst_check_setup_sink_pad (element, &any_sink_template);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  ASSERT_SET_STATE (element, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  gst_check_setup_events (srcpad, element, caps, GST_FORMAT_TIME);
+
+  for (walk = inbufs; walk; walk = walk->next)
+    fail_unless_equals_int (gst_pad_push (srcpad,
+            gst_buffer_ref (walk->data)), GST_FLOW_OK);
+
+  *outcaps = gst_pad_get_current_caps (sinkpad);
+  outbufs = buffers;
+  buffers = NULL;
+
+  ASSERT_SET_STATE (element, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_src_pad (element);
+  gst_check_teardown_sink_pad (element);
+  gst_check_teardown_element (element);
+
+  return outbufs;
+}
+
+/* raw video survives payloading and depayloading with any number of
+ * threads */
+GST_START_TEST (rtp_vraw_threads)
+{
+  static const GstVideoFormat formats[] = { GST_VIDEO_FORMAT_I420,
+    GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_AYUV, GST_VIDEO_FORMAT_Y41B
+  };
+  static const guint n_threads[] = { 1, 3 };
+  GstElement *pay, *depay;
+  GstVideoInfo info;
+  GstCaps *caps, *rtpcaps, *outcaps;
+  GstBuffer *frame;
+  GstMapInfo map;
+  GList *inbufs, *rtpbufs, *outbufs;
+  gint f, t, i;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    gst_video_info_init (&info);
+    gst_video_info_set_format (&info, formats[f], 64, 32);
+    caps = gst_video_info_to_caps (&info);
+
+    frame = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+    gst_buffer_map (frame, &map, GST_MAP_WRITE);
+    for (i = 0; i < map.size; i++)
+      map.data[i] = i * 7;
+    if (formats[f] == GST_VIDEO_FORMAT_AYUV) {
+      /* the alpha channel is not transported */
+      for (i = 0; i < map.size; i += 4)
+        map.data[i] = 0;
+    }
+    gst_buffer_unmap (frame, &map);
+    GST_BUFFER_PTS (frame) = 0;
+    GST_BUFFER_DURATION (frame) = GST_SECOND / 30;
+    inbufs = g_list_append (NULL, frame);
+
+    for (t = 0; t < G_N_ELEMENTS (n_threads); t++) {
+      pay = gst_check_setup_element ("rtpvrawpay");
+      /* split lines over packets */
+      g_object_set (pay, "mtu", 100, "n-threads", n_threads[t], NULL);
+      rtpbufs = push_through_element (pay, caps, inbufs, &rtpcaps);
+      fail_unless (g_list_length (rtpbufs) > 3 * n_threads[t]);
+
+      depay = gst_check_setup_element ("rtpvrawdepay");
+      g_object_set (depay, "n-threads", n_threads[t], NULL);
+      outbufs = push_through_element (depay, rtpcaps, rtpbufs, &outcaps);
+      fail_unless_equals_int (g_list_length (outbufs), 1);
+
+      gst_buffer_map (frame, &map, GST_MAP_READ);
+      fail_unless (gst_buffer_memcmp (outbufs->data, 0, map.data,
+              map.size) == 0);
+      gst_buffer_unmap (frame, &map);
+
+      g_list_free_full (rtpbufs, (GDestroyNotify) gst_buffer_unref);
+      g_list_free_full (outbufs, (GDestroyNotify) gst_buffer_unref);
+      gst_caps_unref (rtpcaps);
+      gst_caps_unref (outcaps);
+    }
+
+    g_list_free_full (inbufs, (GDestroyNotify) gst_buffer_unref);
+    gst_caps_unref (caps);
+  }
+}
+
+GST_END_TEST;
+
+/* a frame with the given scan data size and two quant tables */
+static GstBuffer *
+make_jpeg_frame (guint scan_size)
+{
+  static const guint8 sof_sos[] = {
+    /* SOF, 16x16, 3 components */
+    0xff, 0xc0, 0x00, 0x11, 0x08, 0x00, 0x10, 0x00, 0x10, 0x03,
+    0x01, 0x21, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01,
+    /* SOS */
+    0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11,
+    0x00, 0x3f, 0x00
+  };
+  guint8 *data, *p;
+  guint size;
+
+  size = 2 + 4 + 2 * 65 + sizeof (sof_sos) + scan_size + 2;
+  p = data = g_malloc (size);
+
+  /* SOI */
+  *p++ = 0xff;
+  *p++ = 0xd8;
+  /* DQT with tables 0 and 1 */
+  *p++ = 0xff;
+  *p++ = 0xdb;
+  *p++ = 0x00;
+  *p++ = 0x84;
+  *p++ = 0x00;
+  memset (p, 0x01, 64);
+  p += 64;
+  *p++ = 0x01;
+  memset (p, 0x02, 64);
+  p += 64;
+  memcpy (p, sof_sos, sizeof (sof_sos));
+  p += sizeof (sof_sos);
+  memset (p, 0x55, scan_size);
+  p += scan_size;
+  /* EOI */
+  *p++ = 0xff;
+  *p++ = 0xd9;
+
+  return gst_buffer_new_wrapped (data, size);
+}
+
+/* the headers parsed from the first frame are reused for the second one */
+GST_START_TEST (rtp_jpeg_header_cache)
+{
+  GstElement *pay;
+  GstCaps *caps, *rtpcaps;
+  GList *inbufs, *rtpbufs, *walk;
+  GstBuffer *frame;
+  guint8 header[12 + 12];
+  guint offset = 0, frames = 0, packets = 0;
+  gsize size;
+
+  frame = make_jpeg_frame (400);
+  inbufs = g_list_append (NULL, gst_buffer_ref (frame));
+  inbufs = g_list_append (inbufs, frame);
+
+  pay = gst_check_setup_element ("rtpjpegpay");
+  g_object_set (pay, "mtu", 200, NULL);
+  caps = gst_caps_from_string ("image/jpeg, width = (int) 16, "
+      "height = (int) 16");
+  rtpbufs = push_through_element (pay, caps, inbufs, &rtpcaps);
+  gst_caps_unref (caps);
+
+  for (walk = rtpbufs; walk; walk = walk->next) {
+    GstBuffer *buf = walk->data;
+    guint frag_offset;
+
+    size = gst_buffer_get_size (buf);
+    fail_unless (size >= sizeof (header));
+    gst_buffer_extract (buf, 0, header, sizeof (header));
+
+    /* JPEG header, type 0 from the 4:2:2 sampling, Q 255, 2x2 blocks */
+    frag_offset = (header[13] << 16) | (header[14] << 8) | header[15];
+    fail_unless_equals_int (frag_offset, offset);
+    fail_unless_equals_int (header[16], 0);
+    fail_unless_equals_int (header[17], 255);
+    fail_unless_equals_int (header[18], 2);
+    fail_unless_equals_int (header[19], 2);
+
+    if (offset == 0) {
+      /* quant header with two 8 bit tables */
+      fail_unless_equals_int (header[20], 0);
+      fail_unless_equals_int (header[21], 0);
+      fail_unless_equals_int ((header[22] << 8) | header[23], 128);
+      offset += size - 12 - 8 - 4 - 128;
+    } else {
+      offset += size - 12 - 8;
+    }
+    packets++;
+
+    if (header[1] & 0x80) {
+      /* the scan data and EOI */
+      fail_unless_equals_int (offset, 402);
+      offset = 0;
+      frames++;
+    }
+  }
+  fail_unless_equals_int (frames, 2);
+  fail_unless_equals_int (packets % 2, 0);
+
+  g_list_free_full (inbufs, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (rtpbufs, (GDestroyNotify) gst_buffer_unref);
+  gst_caps_unref (rtpcaps);
+}
+
+GST_END_TEST;
+
 static const guint8 rtp_L16_frame_data[] =
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
@@ -687,6 +1070,104 @@ GST_START_TEST (rtp_mp2t)
 }
 
 GST_END_TEST;
+/* TS packets are aggregated in groups of ts-packets */
+GST_START_TEST (rtp_mp2t_ts_packets)
+{
+  GstElement *pay;
+  GstCaps *caps, *rtpcaps;
+  GstBuffer *buf;
+  GList *inbufs, *rtpbufs, *walk;
+  static const guint expected[] = { 2, 2, 2, 1 };
+  gint i;
+
+  buf = gst_buffer_new_allocate (NULL, 7 * 188, NULL);
+  gst_buffer_memset (buf, 0, 0x47, 7 * 188);
+  inbufs = g_list_append (NULL, buf);
+
+  pay = gst_check_setup_element ("rtpmp2tpay");
+  g_object_set (pay, "ts-packets", 2, NULL);
+  caps = gst_caps_from_string ("video/mpegts, packetsize = (int) 188, "
+      "systemstream = (boolean) true");
+  rtpbufs = push_through_element (pay, caps, inbufs, &rtpcaps);
+  gst_caps_unref (caps);
+
+  fail_unless_equals_int (g_list_length (rtpbufs), G_N_ELEMENTS (expected));
+  for (walk = rtpbufs, i = 0; walk; walk = walk->next, i++)
+    fail_unless_equals_int (gst_buffer_get_size (walk->data),
+        12 + expected[i] * 188);
+
+  g_list_free_full (inbufs, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (rtpbufs, (GDestroyNotify) gst_buffer_unref);
+  gst_caps_unref (rtpcaps);
+}
+
+GST_END_TEST;
+
+static guint mp2t_lists_received;
+
+static GstFlowReturn
+mp2t_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  fail_unless_equals_int (gst_buffer_list_length (list), 3);
+  mp2t_lists_received++;
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+/* a list of RTP packets comes out as one list of TS */
+GST_START_TEST (rtp_mp2t_depay_list)
+{
+  GstElement *depay;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstBufferList *list;
+  guint8 packet[12 + 188];
+  gint i;
+
+  depay = gst_check_setup_element ("rtpmp2tdepay");
+  srcpad = gst_check_setup_src_pad (depay, &any_src_template);
+  sinkpad = gst_check_setup_sink_pad (depay, &any_sink_template);
+  gst_pad_set_chain_list_function (sinkpad, mp2t_chain_list);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  ASSERT_SET_STATE (depay, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("application/x-rtp, media = (string) video, "
+      "payload = (int) 33, clock-rate = (int) 90000, "
+      "encoding-name = (string) MP2T");
+  gst_check_setup_events (srcpad, depay, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    GstBuffer *buf;
+
+    memset (packet, 0x47, sizeof (packet));
+    packet[0] = 0x80;
+    packet[1] = 33;
+    packet[2] = 0;
+    packet[3] = i;
+
+    buf = gst_buffer_new_allocate (NULL, sizeof (packet), NULL);
+    gst_buffer_fill (buf, 0, packet, sizeof (packet));
+    GST_BUFFER_PTS (buf) = 0;
+    gst_buffer_list_add (list, buf);
+  }
+
+  mp2t_lists_received = 0;
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+  fail_unless_equals_int (mp2t_lists_received, 1);
+  fail_unless (buffers == NULL);
+
+  ASSERT_SET_STATE (depay, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_src_pad (depay);
+  gst_check_teardown_sink_pad (depay);
+  gst_check_teardown_element (depay);
+}
+
+GST_END_TEST;
+
 static const guint8 rtp_mp4v_frame_data[] =
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
@@ -935,9 +1416,14 @@ rtp_payloading_suite (void)
   tcase_add_test (tc_chain, rtp_h264_list_lt_mtu_avc);
   tcase_add_test (tc_chain, rtp_h264_list_gt_mtu);
   tcase_add_test (tc_chain, rtp_h264_list_gt_mtu_avc);
+  tcase_add_test (tc_chain, rtp_h264_au_aligned_fragments);
+  tcase_add_test (tc_chain, rtp_h264depay_fu_a_memory);
+  tcase_add_test (tc_chain, rtp_vraw_threads);
   tcase_add_test (tc_chain, rtp_L16);
   tcase_add_test (tc_chain, rtp_L24);
   tcase_add_test (tc_chain, rtp_mp2t);
+  tcase_add_test (tc_chain, rtp_mp2t_ts_packets);
+  tcase_add_test (tc_chain, rtp_mp2t_depay_list);
   tcase_add_test (tc_chain, rtp_mp4v);
   tcase_add_test (tc_chain, rtp_mp4v_list);
   tcase_add_test (tc_chain, rtp_mp4g);
@@ -951,6 +1437,7 @@ rtp_payloading_suite (void)
   tcase_add_test (tc_chain, rtp_jpeg_list_width_greater_than_2040);
   tcase_add_test (tc_chain, rtp_jpeg_list_height_greater_than_2040);
   tcase_add_test (tc_chain, rtp_jpeg_list_width_and_height_greater_than_2040);
+  tcase_add_test (tc_chain, rtp_jpeg_header_cache);
   tcase_add_test (tc_chain, rtp_g729);
   return s;
 }
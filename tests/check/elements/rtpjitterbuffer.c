@@ -294,6 +294,37 @@ GST_START_TEST (test_push_unordered)
 
 GST_END_TEST;
 
+GST_START_TEST (test_push_unordered_buffer_list)
+{
+  GstElement *jitterbuffer;
+  const guint num_buffers = 4;
+  GstBuffer *buffer;
+
+  jitterbuffer = setup_jitterbuffer (num_buffers);
+  g_object_set (jitterbuffer, "buffer-list", TRUE, NULL);
+  fail_unless (start_jitterbuffer (jitterbuffer)
+      == GST_STATE_CHANGE_SUCCESS, "could not set to playing");
+
+  /* push buffers; 0,2,1,3, they are all pushed in one list when the
+   * deadline of the first one expires */
+  buffer = (GstBuffer *) inbuffers->data;
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  buffer = g_list_nth_data (inbuffers, 2);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  buffer = g_list_nth_data (inbuffers, 1);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  buffer = g_list_nth_data (inbuffers, 3);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  /* check the buffer list */
+  check_jitterbuffer_results (jitterbuffer, num_buffers);
+
+  /* cleanup */
+  cleanup_jitterbuffer (jitterbuffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_basetime)
 {
   GstElement *jitterbuffer;
@@ -1174,6 +1205,9 @@ GST_START_TEST (test_rtx_two_missing)
   rtx_stat = gst_structure_get_value (rtx_stats, "rtx-rtt");
   g_assert_cmpuint (g_value_get_uint64 (rtx_stat), ==, 0);
 
+  rtx_stat = gst_structure_get_value (rtx_stats, "num-timers");
+  fail_unless (rtx_stat != NULL && G_VALUE_HOLDS_UINT (rtx_stat));
+
   destroy_testharness (&data);
 }
 
@@ -1336,6 +1370,7 @@ rtpjitterbuffer_suite (void)
   tcase_add_test (tc_chain, test_push_forward_seq);
   tcase_add_test (tc_chain, test_push_backward_seq);
   tcase_add_test (tc_chain, test_push_unordered);
+  tcase_add_test (tc_chain, test_push_unordered_buffer_list);
   tcase_add_test (tc_chain, test_basetime);
   tcase_add_test (tc_chain, test_clear_pt_map);
   tcase_add_test (tc_chain, test_only_one_lost_event_on_large_gaps);
@@ -292,6 +292,116 @@ GST_START_TEST (test_rtpdtmfmux_lock)
 
 GST_END_TEST;
 
+static GstBuffer *
+make_rtp_buffer (int i)
+{
+  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+
+  buf = gst_rtp_buffer_new_allocate (10, 0, 0);
+  GST_BUFFER_PTS (buf) = i * 1000;
+  GST_BUFFER_DURATION (buf) = 1000;
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtpbuffer);
+  gst_rtp_buffer_set_version (&rtpbuffer, 2);
+  gst_rtp_buffer_set_payload_type (&rtpbuffer, 98);
+  gst_rtp_buffer_set_ssrc (&rtpbuffer, 44);
+  gst_rtp_buffer_set_timestamp (&rtpbuffer, 200 + i);
+  gst_rtp_buffer_set_seq (&rtpbuffer, 2000 + i);
+  gst_rtp_buffer_unmap (&rtpbuffer);
+
+  return buf;
+}
+
+/* one sink pad, mixing buffers and lists, writable and shared buffers */
+GST_START_TEST (test_rtpmux_single_pad_list)
+{
+  GstElement *rtpmux;
+  GstPad *reqpad, *src, *sink;
+  GstBufferList *list;
+  GstBuffer *shared;
+  GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
+  GstCaps *caps;
+  GstSegment segment;
+  GList *node;
+  guint seqnum;
+  int i;
+
+  rtpmux = gst_check_setup_element ("rtpmux");
+  g_object_set (rtpmux, "seqnum-offset", 100, "timestamp-offset", 1000,
+      "ssrc", 55, NULL);
+
+  reqpad = gst_element_get_request_pad (rtpmux, "sink_1");
+  fail_unless (reqpad != NULL);
+  sink = gst_check_setup_sink_pad_by_name (rtpmux, &sinktemplate, "src");
+  src = gst_pad_new_from_static_template (&srctemplate, "src");
+  fail_unless (gst_pad_link (src, reqpad) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (rtpmux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (sink, TRUE);
+  gst_pad_set_active (src, TRUE);
+
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_stream_start ("stream1")));
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "payload", G_TYPE_INT, 98, "clock-rate", G_TYPE_INT, 3,
+      "seqnum-base", G_TYPE_UINT, 56, "clock-base", G_TYPE_UINT, 57,
+      "ssrc", G_TYPE_UINT, 66, NULL);
+  fail_unless (gst_pad_set_caps (src, caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (src, gst_event_new_segment (&segment)));
+
+  /* the first buffer makes the pad the active one, the rest can then be
+   * stamped without the lock */
+  fail_unless (gst_pad_push (src, make_rtp_buffer (0)) == GST_FLOW_OK);
+
+  list = gst_buffer_list_new ();
+  for (i = 1; i < 5; i++)
+    gst_buffer_list_add (list, make_rtp_buffer (i));
+  shared = gst_buffer_ref (gst_buffer_list_get (list, 2));
+  fail_unless (gst_pad_push_list (src, list) == GST_FLOW_OK);
+
+  fail_unless (gst_pad_push (src, make_rtp_buffer (5)) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 6);
+  for (node = buffers, i = 0; node; node = node->next, i++) {
+    gst_rtp_buffer_map (node->data, GST_MAP_READ, &rtpbuffer);
+    fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtpbuffer), 55);
+    fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtpbuffer),
+        200 - 57 + 1000 + i);
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtpbuffer), 100 + 1 + i);
+    gst_rtp_buffer_unmap (&rtpbuffer);
+  }
+
+  /* the buffer we kept a reference to was copied, not stamped */
+  fail_unless (shared != g_list_nth_data (buffers, 3));
+  gst_rtp_buffer_map (shared, GST_MAP_READ, &rtpbuffer);
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtpbuffer), 2003);
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtpbuffer), 44);
+  gst_rtp_buffer_unmap (&rtpbuffer);
+  gst_buffer_unref (shared);
+
+  g_object_get (rtpmux, "seqnum", &seqnum, NULL);
+  fail_unless_equals_int (seqnum, 106);
+
+  g_list_foreach (buffers, (GFunc) gst_buffer_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (sink, FALSE);
+  gst_pad_set_active (src, FALSE);
+  fail_unless (gst_element_set_state (rtpmux,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_pad_by_name (rtpmux, "src");
+  gst_object_unref (reqpad);
+  gst_check_teardown_pad_by_name (rtpmux, "sink_1");
+  gst_element_release_request_pad (rtpmux, reqpad);
+  gst_check_teardown_element (rtpmux);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpmux_suite (void)
 {
@@ -300,6 +410,7 @@ rtpmux_suite (void)
 
   tc_chain = tcase_create ("rtpmux_basic");
   tcase_add_test (tc_chain, test_rtpmux_basic);
+  tcase_add_test (tc_chain, test_rtpmux_single_pad_list);
   suite_add_tcase (s, tc_chain);
 
   tc_chain = tcase_create ("rtpdtmfmux_basic");
@@ -1469,6 +1469,151 @@ GST_START_TEST (test_rtxreceive_data_reconstruction)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtxqueue_lookup)
+{
+  const gint num_buffers = 11;
+  const guint ssrc = 1234567;
+  GList *in_buffers, *node;
+  guint payload_type;
+  GstElement *rtxqueue;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstEvent *event;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  /* 1 to 10 pushed, then 6 to 9 retransmitted, then 11 */
+  const guint expected[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 6, 7, 8, 9, 11 };
+  gint i;
+
+  in_buffers = generate_test_buffers (num_buffers, ssrc, &payload_type);
+  gst_check_drop_buffers ();
+
+  rtxqueue = gst_check_setup_element ("rtprtxqueue");
+  g_object_set (rtxqueue, "max-size-packets", 5, NULL);
+
+  srcpad = gst_check_setup_src_pad (rtxqueue, &srctemplate);
+  fail_unless_equals_int (gst_pad_set_active (srcpad, TRUE), TRUE);
+  sinkpad = gst_check_setup_sink_pad (rtxqueue, &sinktemplate);
+  fail_unless_equals_int (gst_pad_set_active (sinkpad, TRUE), TRUE);
+
+  ASSERT_SET_STATE (rtxqueue, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("application/x-rtp, "
+      "media = (string)video, payload = (int)96, "
+      "ssrc = (uint)1234567, clock-rate = (int)90000, "
+      "encoding-name = (string)RAW");
+  gst_check_setup_events (srcpad, rtxqueue, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  node = in_buffers;
+  for (i = 0; i < num_buffers - 1; i++) {
+    fail_unless_equals_int (gst_pad_push (srcpad,
+            gst_buffer_ref (GST_BUFFER (node->data))), GST_FLOW_OK);
+    node = g_list_next (node);
+  }
+
+  /* request 4 and the 5 packets after it in one go, only 6 to 9 are still
+   * queued */
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequest",
+          "seqnum", G_TYPE_UINT, 4, "blp", G_TYPE_UINT, 0x1f,
+          "ssrc", G_TYPE_UINT, ssrc, NULL));
+  fail_unless_equals_int (gst_pad_push_event (sinkpad, event), TRUE);
+
+  /* the next packet pushes out the retransmissions */
+  fail_unless_equals_int (gst_pad_push (srcpad,
+          gst_buffer_ref (GST_BUFFER (node->data))), GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), G_N_ELEMENTS (expected));
+  for (i = 0, node = buffers; node; i++, node = g_list_next (node)) {
+    fail_unless (gst_rtp_buffer_map (GST_BUFFER (node->data), GST_MAP_READ,
+            &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), expected[i]);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+
+  g_list_free_full (in_buffers, (GDestroyNotify) gst_buffer_unref);
+  gst_check_drop_buffers ();
+
+  gst_check_teardown_src_pad (rtxqueue);
+  gst_check_teardown_sink_pad (rtxqueue);
+  gst_check_teardown_element (rtxqueue);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtxqueue_max_size_bytes)
+{
+  const gint num_buffers = 11;
+  const guint ssrc = 1234567;
+  GList *in_buffers, *node;
+  guint payload_type;
+  GstElement *rtxqueue;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstEvent *event;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gsize size;
+  gint i;
+
+  in_buffers = generate_test_buffers (num_buffers, ssrc, &payload_type);
+  gst_check_drop_buffers ();
+
+  /* all packets have the same size, keep 3 of them */
+  size = gst_buffer_get_size (GST_BUFFER (in_buffers->data));
+  rtxqueue = gst_check_setup_element ("rtprtxqueue");
+  g_object_set (rtxqueue, "max-size-packets", 0, "max-size-bytes",
+      (guint) (3 * size), NULL);
+
+  srcpad = gst_check_setup_src_pad (rtxqueue, &srctemplate);
+  fail_unless_equals_int (gst_pad_set_active (srcpad, TRUE), TRUE);
+  sinkpad = gst_check_setup_sink_pad (rtxqueue, &sinktemplate);
+  fail_unless_equals_int (gst_pad_set_active (sinkpad, TRUE), TRUE);
+
+  ASSERT_SET_STATE (rtxqueue, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("application/x-rtp, "
+      "media = (string)video, payload = (int)96, "
+      "ssrc = (uint)1234567, clock-rate = (int)90000, "
+      "encoding-name = (string)RAW");
+  gst_check_setup_events (srcpad, rtxqueue, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  node = in_buffers;
+  for (i = 0; i < num_buffers - 1; i++) {
+    fail_unless_equals_int (gst_pad_push (srcpad,
+            gst_buffer_ref (GST_BUFFER (node->data))), GST_FLOW_OK);
+    node = g_list_next (node);
+  }
+
+  /* request all packets, only 8 to 10 are still queued */
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequest",
+          "seqnum", G_TYPE_UINT, 1, "blp", G_TYPE_UINT, 0x1ff,
+          "ssrc", G_TYPE_UINT, ssrc, NULL));
+  fail_unless_equals_int (gst_pad_push_event (sinkpad, event), TRUE);
+
+  fail_unless_equals_int (gst_pad_push (srcpad,
+          gst_buffer_ref (GST_BUFFER (node->data))), GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), num_buffers + 3);
+  node = g_list_nth (buffers, num_buffers - 1);
+  for (i = 8; i <= 10; i++, node = g_list_next (node)) {
+    fail_unless (gst_rtp_buffer_map (GST_BUFFER (node->data), GST_MAP_READ,
+            &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), i);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+
+  g_list_free_full (in_buffers, (GDestroyNotify) gst_buffer_unref);
+  gst_check_drop_buffers ();
+
+  gst_check_teardown_src_pad (rtxqueue);
+  gst_check_teardown_sink_pad (rtxqueue);
+  gst_check_teardown_element (rtxqueue);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtprtx_suite (void)
 {
@@ -1485,6 +1630,8 @@ rtprtx_suite (void)
   tcase_add_test (tc_chain, test_rtxsender_max_size_packets);
   tcase_add_test (tc_chain, test_rtxsender_max_size_time);
   tcase_add_test (tc_chain, test_rtxreceive_data_reconstruction);
+  tcase_add_test (tc_chain, test_rtxqueue_lookup);
+  tcase_add_test (tc_chain, test_rtxqueue_max_size_bytes);
 
   return s;
 }
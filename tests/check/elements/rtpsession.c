@@ -116,7 +116,8 @@ destroy_testharness (TestData * data)
 }
 
 static void
-setup_testharness (TestData * data, gboolean session_as_sender)
+setup_testharness_full (TestData * data, gboolean session_as_sender,
+    gboolean shared_rtcp_thread)
 {
   GstPad *rtp_sink_pad, *rtcp_src_pad, *rtp_src_pad;
   GstSegment seg;
@@ -132,6 +133,8 @@ setup_testharness (TestData * data, gboolean session_as_sender)
   g_signal_connect (data->session, "request-pt-map",
       (GCallback) pt_map_requested, data);
   g_assert (data->session);
+  g_object_set (data->session, "shared-rtcp-thread", shared_rtcp_thread,
+      NULL);
   gst_element_set_clock (data->session, data->clock);
   g_assert_cmpint (gst_element_set_state (data->session,
           GST_STATE_PLAYING), !=, GST_STATE_CHANGE_FAILURE);
@@ -181,6 +184,12 @@ setup_testharness (TestData * data, gboolean session_as_sender)
     gst_mini_object_unref (obj);
 }
 
+static void
+setup_testharness (TestData * data, gboolean session_as_sender)
+{
+  setup_testharness_full (data, session_as_sender, FALSE);
+}
+
 GST_START_TEST (test_multiple_ssrc_rr)
 {
   TestData data;
@@ -250,6 +259,141 @@ GST_START_TEST (test_multiple_ssrc_rr)
 
 GST_END_TEST;
 
+static gint rtp_pushed;
+
+static GstFlowReturn
+test_rtp_pad_chain_cb (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_atomic_int_inc (&rtp_pushed);
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+/* This verifies that a list of packets of multiple sources is handled like
+ * the same packets pushed one by one */
+GST_START_TEST (test_receive_rtp_list)
+{
+  TestData data;
+  GstFlowReturn res;
+  GstClockID id;
+  GstBufferList *list;
+  GstBuffer *out_buf;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket rtcp_packet;
+  int i;
+  guint32 ssrc, exthighestseq, jitter, lsr, dlsr;
+  gint32 packetslost;
+  guint8 fractionlost;
+
+  setup_testharness (&data, FALSE);
+  rtp_pushed = 0;
+  gst_pad_set_chain_function (data.rtpsrc, test_rtp_pad_chain_cb);
+  g_assert (gst_pad_set_active (data.rtpsrc, TRUE));
+
+  gst_test_clock_set_time (GST_TEST_CLOCK (data.clock), 10 * GST_MSECOND);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 5; i++)
+    gst_buffer_list_add (list, generate_test_buffer (i * 20 * GST_MSECOND,
+            FALSE, i, i * 20, 0x01BADBAD));
+  for (i = 0; i < 5; i++)
+    gst_buffer_list_add (list, generate_test_buffer (i * 20 * GST_MSECOND,
+            FALSE, i, i * 20, 0xDEADBEEF));
+
+  res = gst_pad_push_list (data.src, list);
+  fail_unless_equals_int (res, GST_FLOW_OK);
+  fail_unless_equals_int (g_atomic_int_get (&rtp_pushed), 10);
+
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (data.clock), &id);
+  gst_test_clock_set_time (GST_TEST_CLOCK (data.clock),
+      gst_clock_id_get_time (id) + (2 * GST_SECOND));
+  gst_test_clock_process_next_clock_id (GST_TEST_CLOCK (data.clock));
+
+  out_buf = g_async_queue_pop (data.rtcp_queue);
+  g_assert (out_buf != NULL);
+  g_assert (gst_rtcp_buffer_validate (out_buf));
+  gst_rtcp_buffer_map (out_buf, GST_MAP_READ, &rtcp);
+  g_assert (gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet));
+  g_assert (gst_rtcp_packet_get_type (&rtcp_packet) == GST_RTCP_TYPE_RR);
+  g_assert_cmpint (gst_rtcp_packet_get_rb_count (&rtcp_packet), ==, 2);
+
+  gst_rtcp_packet_get_rb (&rtcp_packet, 0, &ssrc, &fractionlost, &packetslost,
+      &exthighestseq, &jitter, &lsr, &dlsr);
+  g_assert_cmpint (ssrc, ==, 0x01BADBAD);
+  g_assert_cmpint (exthighestseq, ==, 4);
+  g_assert_cmpint (packetslost, ==, 0);
+
+  gst_rtcp_packet_get_rb (&rtcp_packet, 1, &ssrc, &fractionlost, &packetslost,
+      &exthighestseq, &jitter, &lsr, &dlsr);
+  g_assert_cmpint (ssrc, ==, 0xDEADBEEF);
+  g_assert_cmpint (exthighestseq, ==, 4);
+  g_assert_cmpint (packetslost, ==, 0);
+
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (out_buf);
+
+  destroy_testharness (&data);
+}
+
+GST_END_TEST;
+
+/* This verifies that the RTCP timeouts run from the shared thread pool */
+GST_START_TEST (test_shared_rtcp_thread)
+{
+  TestData data;
+  GstFlowReturn res;
+  GstClockID id;
+  GstBuffer *out_buf;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket rtcp_packet;
+  int i;
+  guint32 ssrc, exthighestseq, jitter, lsr, dlsr;
+  gint32 packetslost;
+  guint8 fractionlost;
+
+  setup_testharness_full (&data, FALSE, TRUE);
+  rtp_pushed = 0;
+  gst_pad_set_chain_function (data.rtpsrc, test_rtp_pad_chain_cb);
+  g_assert (gst_pad_set_active (data.rtpsrc, TRUE));
+
+  gst_test_clock_set_time (GST_TEST_CLOCK (data.clock), 10 * GST_MSECOND);
+
+  for (i = 0; i < 5; i++) {
+    res = gst_pad_push (data.src, generate_test_buffer (i * 20 * GST_MSECOND,
+            FALSE, i, i * 20, 0x01BADBAD));
+    fail_unless_equals_int (res, GST_FLOW_OK);
+  }
+  fail_unless_equals_int (g_atomic_int_get (&rtp_pushed), 5);
+
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (data.clock), &id);
+  gst_test_clock_set_time (GST_TEST_CLOCK (data.clock),
+      gst_clock_id_get_time (id) + (2 * GST_SECOND));
+  gst_test_clock_process_next_clock_id (GST_TEST_CLOCK (data.clock));
+
+  out_buf = g_async_queue_pop (data.rtcp_queue);
+  g_assert (out_buf != NULL);
+  g_assert (gst_rtcp_buffer_validate (out_buf));
+  gst_rtcp_buffer_map (out_buf, GST_MAP_READ, &rtcp);
+  g_assert (gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet));
+  g_assert (gst_rtcp_packet_get_type (&rtcp_packet) == GST_RTCP_TYPE_RR);
+  g_assert_cmpint (gst_rtcp_packet_get_rb_count (&rtcp_packet), ==, 1);
+
+  gst_rtcp_packet_get_rb (&rtcp_packet, 0, &ssrc, &fractionlost, &packetslost,
+      &exthighestseq, &jitter, &lsr, &dlsr);
+  g_assert_cmpint (ssrc, ==, 0x01BADBAD);
+  g_assert_cmpint (exthighestseq, ==, 4);
+
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (out_buf);
+
+  /* the next timeout is scheduled again from the pool */
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (data.clock), NULL);
+
+  destroy_testharness (&data);
+}
+
+GST_END_TEST;
+
 /* This verifies that rtpsession will correctly place RBs round-robin
  * across multiple SRs when there are too many senders that their RBs
  * do not fit in one SR */
@@ -397,6 +541,8 @@ gstrtpsession_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_multiple_ssrc_rr);
   tcase_add_test (tc_chain, test_multiple_senders_roundrobin_rbs);
+  tcase_add_test (tc_chain, test_receive_rtp_list);
+  tcase_add_test (tc_chain, test_shared_rtcp_thread);
 
   return s;
 }
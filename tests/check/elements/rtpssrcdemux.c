@@ -0,0 +1,153 @@
+/* GStreamer
+ *
+ * rtpssrcdemux.c: unit tests for the rtpssrcdemux element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+#define NUM_SSRCS 4
+
+static gint pushed[NUM_SSRCS];
+static gint new_pads;
+static GList *sinkpads;
+
+static GstFlowReturn
+demux_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gint idx = GPOINTER_TO_INT (gst_pad_get_element_private (pad));
+
+  g_atomic_int_inc (&pushed[idx]);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static void
+new_ssrc_pad (GstElement * demux, guint32 ssrc, GstPad * pad, gpointer data)
+{
+  GstPad *sinkpad;
+
+  fail_unless (ssrc >= 1 && ssrc <= NUM_SSRCS);
+
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_element_private (sinkpad, GINT_TO_POINTER (ssrc - 1));
+  gst_pad_set_chain_function (sinkpad, demux_pad_chain);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+  sinkpads = g_list_prepend (sinkpads, sinkpad);
+
+  g_atomic_int_inc (&new_pads);
+}
+
+static GstBuffer *
+generate_test_buffer (guint seqnum, guint32 ssrc)
+{
+  GstBuffer *buf;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  buf = gst_rtp_buffer_new_allocate (10, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static void
+unlink_and_unref_pad (GstPad * pad)
+{
+  GstPad *peer = gst_pad_get_peer (pad);
+
+  if (peer) {
+    gst_pad_unlink (peer, pad);
+    gst_object_unref (peer);
+  }
+  gst_object_unref (pad);
+}
+
+GST_START_TEST (test_demux_ssrcs)
+{
+  GstElement *demux;
+  GstPad *srcpad;
+  GstCaps *caps;
+  gint i;
+
+  new_pads = 0;
+  memset (pushed, 0, sizeof (pushed));
+
+  demux = gst_check_setup_element ("rtpssrcdemux");
+  g_signal_connect (demux, "new-ssrc-pad", (GCallback) new_ssrc_pad, NULL);
+  srcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  fail_unless (gst_pad_set_active (srcpad, TRUE));
+  ASSERT_SET_STATE (demux, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("application/x-rtp, clock-rate = (int)90000");
+  gst_check_setup_events (srcpad, demux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* runs of the same SSRC and interleaved SSRCs */
+  for (i = 0; i < 100; i++) {
+    guint32 ssrc = i < 40 ? (i / 10) % NUM_SSRCS + 1 : i % NUM_SSRCS + 1;
+
+    fail_unless_equals_int (gst_pad_push (srcpad, generate_test_buffer (i,
+                ssrc)), GST_FLOW_OK);
+  }
+
+  fail_unless_equals_int (new_pads, NUM_SSRCS);
+  for (i = 0; i < NUM_SSRCS; i++)
+    fail_unless_equals_int (pushed[i], 25);
+
+  /* a cleared SSRC gets a new pad */
+  g_signal_emit_by_name (demux, "clear-ssrc", 1);
+  fail_unless_equals_int (gst_pad_push (srcpad, generate_test_buffer (100, 1)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (new_pads, NUM_SSRCS + 1);
+  fail_unless_equals_int (pushed[0], 26);
+
+  g_list_free_full (sinkpads, (GDestroyNotify) unlink_and_unref_pad);
+  sinkpads = NULL;
+
+  ASSERT_SET_STATE (demux, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  gst_check_teardown_src_pad (demux);
+  gst_check_teardown_element (demux);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpssrcdemux_suite (void)
+{
+  Suite *s = suite_create ("rtpssrcdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_demux_ssrcs);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpssrcdemux);
@@ -0,0 +1,224 @@
+/* GStreamer
+ *
+ * scaletempo.c: Unit test for the scaletempo element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+
+#include <math.h>
+
+#include "../../gst/audiofx/gstscaletempo.h"
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+GstPad *mysrcpad, *mysinkpad;
+
+#define SCALETEMPO_RATE 44100
+#define SCALETEMPO_CHANNELS 2
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw, "
+        "format = (string) { " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (F32)
+        " }, rate = (int) 44100, channels = (int) 2, "
+        "layout = (string) interleaved"));
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw, "
+        "format = (string) { " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (F32)
+        " }, rate = (int) 44100, channels = (int) 2, "
+        "layout = (string) interleaved"));
+
+/* the search function the element picked and how often it was called */
+static guint (*element_best_overlap_offset) (GstScaletempo * st);
+static guint n_searches;
+
+/* The correlation of the windowed overlap with the queue at @off, summed
+ * in the order the plain search loops used to */
+static gdouble
+reference_correlation (GstScaletempo * st, guint off)
+{
+  guint n = st->samples_overlap - st->samples_per_frame;
+  guint base = st->samples_per_frame * (off + 1);
+  gdouble corr = 0.0;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    if (st->use_int) {
+      gint32 w = ((gint32 *) st->table_window)[i];
+      gint16 o = ((gint16 *) st->buf_overlap)[st->samples_per_frame + i];
+      gint16 q = ((gint16 *) st->buf_queue)[base + i];
+
+      corr += (gdouble) ((w * o) >> 15) * q;
+    } else {
+      gfloat w = ((gfloat *) st->table_window)[i];
+      gfloat o = ((gfloat *) st->buf_overlap)[st->samples_per_frame + i];
+      gfloat q = ((gfloat *) st->buf_queue)[base + i];
+
+      corr += (gdouble) (w * o) * q;
+    }
+  }
+
+  return corr;
+}
+
+/* Runs the search of the element and checks that no other offset
+ * correlates noticeably better than the one it found */
+static guint
+check_best_overlap_offset (GstScaletempo * st)
+{
+  guint bytes_off = element_best_overlap_offset (st);
+  gdouble corr, best = -G_MAXDOUBLE, max_abs = 0.0;
+  guint off;
+
+  fail_unless (bytes_off % st->bytes_per_frame == 0);
+  fail_unless (bytes_off / st->bytes_per_frame < st->frames_search);
+
+  for (off = 0; off < st->frames_search; off++) {
+    corr = reference_correlation (st, off);
+    best = MAX (best, corr);
+    max_abs = MAX (max_abs, fabs (corr));
+  }
+  corr = reference_correlation (st, bytes_off / st->bytes_per_frame);
+  fail_unless (corr >= best - 1e-4 * max_abs,
+      "offset %u correlates with %lf, best is %lf",
+      bytes_off / st->bytes_per_frame, corr, best);
+
+  n_searches++;
+
+  return bytes_off;
+}
+
+static void
+push_noise (GRand * rand, gboolean use_int, guint frames)
+{
+  GstBuffer *inbuffer;
+  GstMapInfo map;
+  guint i;
+
+  inbuffer = gst_buffer_new_and_alloc (frames * SCALETEMPO_CHANNELS *
+      (use_int ? sizeof (gint16) : sizeof (gfloat)));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < frames * SCALETEMPO_CHANNELS; i++) {
+    /* a tone plus noise, so there is something to find */
+    gdouble val = 0.5 * sin (2 * G_PI * 440 * (i / SCALETEMPO_CHANNELS) /
+        SCALETEMPO_RATE) + g_rand_double_range (rand, -0.25, 0.25);
+
+    if (use_int)
+      ((gint16 *) map.data)[i] = val * G_MAXINT16;
+    else
+      ((gfloat *) map.data)[i] = val;
+  }
+  gst_buffer_unmap (inbuffer, &map);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+}
+
+static void
+check_search (gboolean use_int, guint search, gboolean expect_fft)
+{
+  GstElement *scaletempo;
+  GstScaletempo *st;
+  GstCaps *caps;
+  GstSegment segment;
+  GRand *rand;
+  guint i;
+
+  scaletempo = gst_check_setup_element ("scaletempo");
+  st = (GstScaletempo *) scaletempo;
+  g_object_set (G_OBJECT (scaletempo), "search", search, NULL);
+  mysrcpad = gst_check_setup_src_pad (scaletempo, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (scaletempo, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_element_set_state (scaletempo,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, use_int ? GST_AUDIO_NE (S16) :
+      GST_AUDIO_NE (F32), "rate", G_TYPE_INT, SCALETEMPO_RATE,
+      "channels", G_TYPE_INT, SCALETEMPO_CHANNELS,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  gst_check_setup_events (mysrcpad, scaletempo, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* scaletempo is in passthrough mode at normal speed */
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.rate = 1.5;
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* the first buffer is too small for a search but sets the buffers up */
+  rand = g_rand_new_with_seed (search);
+  push_noise (rand, use_int, 64);
+  fail_unless (st->best_overlap_offset != NULL);
+  fail_unless_equals_int (st->fft != NULL, expect_fft);
+
+  element_best_overlap_offset = st->best_overlap_offset;
+  st->best_overlap_offset = check_best_overlap_offset;
+  n_searches = 0;
+  for (i = 0; i < 20; i++)
+    push_noise (rand, use_int, 4096);
+  g_rand_free (rand);
+  fail_unless (n_searches > 20);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (scaletempo);
+  gst_check_teardown_sink_pad (scaletempo);
+  gst_check_teardown_element (scaletempo);
+}
+
+GST_START_TEST (test_direct_search)
+{
+  check_search (FALSE, 2, FALSE);
+  check_search (TRUE, 2, FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fft_search)
+{
+  check_search (FALSE, 30, TRUE);
+  check_search (TRUE, 30, TRUE);
+}
+
+GST_END_TEST;
+
+static Suite *
+scaletempo_suite (void)
+{
+  Suite *s = suite_create ("scaletempo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_direct_search);
+  tcase_add_test (tc_chain, test_fft_search);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scaletempo);
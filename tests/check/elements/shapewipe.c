@@ -74,7 +74,8 @@ on_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   return GST_FLOW_OK;
 }
 
-GST_START_TEST (test_general)
+static void
+check_general (guint n_threads)
 {
   GstElement *shapewipe, *videosrc, *masksrc, *sink, *bin;
   GstPad *p;
@@ -90,6 +91,7 @@ GST_START_TEST (test_general)
   sink = gst_bin_new ("mysink");
   shapewipe = gst_element_factory_make ("shapewipe", NULL);
   fail_unless (shapewipe != NULL);
+  g_object_set (G_OBJECT (shapewipe), "n-threads", n_threads, NULL);
   gst_bin_add_many (GST_BIN (bin), videosrc, masksrc, shapewipe, sink, NULL);
 
   myvideosrcpad =
@@ -299,6 +301,18 @@ GST_START_TEST (test_general)
   gst_object_unref (bin);
 }
 
+GST_START_TEST (test_general)
+{
+  check_general (1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_general_threads)
+{
+  check_general (3);
+}
+
 GST_END_TEST;
 
 static Suite *
@@ -310,6 +324,7 @@ shapewipe_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_general);
+  tcase_add_test (tc_chain, test_general_threads);
 
   return s;
 }
@@ -345,6 +345,57 @@ GST_START_TEST (test_bad_password_digest_auth)
 
 GST_END_TEST;
 
+static void
+parallel_handoff_cb (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    guint64 * p_offset)
+{
+  /* buffers must come out contiguous and in order */
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), *p_offset);
+  *p_offset += gst_buffer_get_size (buf);
+}
+
+GST_START_TEST (test_parallel_requests)
+{
+  GstElement *pipe, *src, *sink;
+  GstMessage *msg;
+  guint64 offset = 0;
+  gchar *url;
+
+  pipe = gst_pipeline_new (NULL);
+
+  src = gst_element_factory_make ("souphttpsrc", NULL);
+  fail_unless (src != NULL);
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (sink != NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (parallel_handoff_cb),
+      &offset);
+
+  gst_bin_add (GST_BIN (pipe), src);
+  gst_bin_add (GST_BIN (pipe), sink);
+  fail_unless (gst_element_link (src, sink));
+
+  url = g_strdup_printf ("http://127.0.0.1:%u/", http_port);
+  g_object_set (src, "location", url, "parallel-requests", 2,
+      "chunk-size", 1024, NULL);
+  g_free (url);
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+  msg = gst_bus_poll (GST_ELEMENT_BUS (pipe),
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* the test server sends 4096 bytes */
+  fail_unless_equals_uint64 (offset, 4096);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static gboolean icy_caps = FALSE;
 
 static void
@@ -478,6 +529,7 @@ souphttpsrc_suite (void)
     tcase_add_test (tc_chain, test_good_user_digest_auth);
     tcase_add_test (tc_chain, test_bad_user_digest_auth);
     tcase_add_test (tc_chain, test_bad_password_digest_auth);
+    tcase_add_test (tc_chain, test_parallel_requests);
 
     if (ssl_server != NULL)
       tcase_add_test (tc_chain, test_https);
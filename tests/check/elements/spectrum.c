@@ -21,8 +21,10 @@
  */
 
 #include <unistd.h>
+#include <math.h>
 
 #include <gst/audio/audio.h>
+#include <gst/fft/gstfftf32.h>
 #include <gst/check/gstcheck.h>
 
 gboolean have_eos = FALSE;
@@ -522,6 +524,155 @@ GST_START_TEST (test_float64)
 
 GST_END_TEST;
 
+/* the magnitudes of one FFT over @nfft frames of @channel, computed the way
+ * spectrum did before it de-interleaved all channels at once and cached the
+ * window */
+static void
+reference_magnitudes (const gpointer data, gboolean is_float, guint channels,
+    guint channel, guint bands, gint threshold, gfloat * magnitude)
+{
+  guint nfft = 2 * bands - 2;
+  gfloat *input = g_new (gfloat, nfft);
+  GstFFTF32Complex *freqdata = g_new (GstFFTF32Complex, bands);
+  GstFFTF32 *fft_ctx = gst_fft_f32_new (nfft, FALSE);
+  gdouble val;
+  guint i;
+
+  for (i = 0; i < nfft; i++) {
+    if (is_float)
+      input[i] = ((gfloat *) data)[i * channels + channel];
+    else
+      input[i] = ((gint16 *) data)[i * channels + channel] / 32767.0f;
+  }
+
+  gst_fft_f32_window (fft_ctx, input, GST_FFT_WINDOW_HAMMING);
+  gst_fft_f32_fft (fft_ctx, input, freqdata);
+
+  for (i = 0; i < bands; i++) {
+    val = freqdata[i].r * freqdata[i].r;
+    val += freqdata[i].i * freqdata[i].i;
+    val /= nfft * nfft;
+    val = 10.0 * log10 (val);
+    if (val < threshold)
+      val = threshold;
+    magnitude[i] = val;
+  }
+
+  gst_fft_f32_free (fft_ctx);
+  g_free (freqdata);
+  g_free (input);
+}
+
+#define MULTI_BANDS 65
+#define MULTI_NFFT (2 * MULTI_BANDS - 2)
+
+/* one interval is exactly one FFT of MULTI_NFFT frames */
+static void
+check_multichannel (gboolean is_float, guint channels, gboolean fast_db,
+    gdouble tolerance)
+{
+  GstElement *spectrum;
+  GstBuffer *inbuffer;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+  const GValue *list;
+  GstMapInfo map;
+  GRand *rand;
+  gchar *caps_str;
+  gfloat reference[MULTI_BANDS];
+  guint num = MULTI_NFFT * channels, i, c;
+  gsize size = num * (is_float ? sizeof (gfloat) : sizeof (gint16));
+
+  caps_str = g_strdup_printf ("audio/x-raw, format = (string) %s, "
+      "layout = (string) interleaved, rate = (int) 12800, "
+      "channels = (int) %u, channel-mask = (bitmask) 0",
+      is_float ? GST_AUDIO_NE (F32) : GST_AUDIO_NE (S16), channels);
+  spectrum = setup_spectrum (caps_str);
+  g_free (caps_str);
+  g_object_set (spectrum, "post-messages", TRUE, "interval",
+      MULTI_NFFT * GST_SECOND / 12800, "bands", MULTI_BANDS, "threshold", -80,
+      "multi-channel", TRUE, "fast-db", fast_db, NULL);
+  fail_unless (gst_element_set_state (spectrum,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  bus = gst_bus_new ();
+  gst_element_set_bus (spectrum, bus);
+
+  /* every channel gets noise of a different amplitude */
+  rand = g_rand_new_with_seed (channels);
+  inbuffer = gst_buffer_new_allocate (NULL, size, 0);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < num; i++) {
+    gdouble amp = 1.0 / (1 + i % channels);
+
+    if (is_float)
+      ((gfloat *) map.data)[i] = amp * g_rand_double_range (rand, -1.0, 1.0);
+    else
+      ((gint16 *) map.data)[i] = amp * g_rand_int_range (rand, -32767, 32768);
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  g_rand_free (rand);
+  GST_BUFFER_TIMESTAMP (inbuffer) = G_GUINT64_CONSTANT (0);
+
+  gst_buffer_ref (inbuffer);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  message = gst_bus_poll (bus, GST_MESSAGE_ELEMENT, -1);
+  structure = gst_message_get_structure (message);
+  list = gst_structure_get_value (structure, "magnitude");
+  fail_unless_equals_int (gst_value_array_get_size (list), channels);
+
+  gst_buffer_map (inbuffer, &map, GST_MAP_READ);
+  for (c = 0; c < channels; c++) {
+    const GValue *bands = gst_value_array_get_value (list, c);
+
+    reference_magnitudes (map.data, is_float, channels, c, MULTI_BANDS, -80,
+        reference);
+    fail_unless_equals_int (gst_value_array_get_size (bands), MULTI_BANDS);
+    for (i = 0; i < MULTI_BANDS; i++) {
+      gfloat level =
+          g_value_get_float (gst_value_array_get_value (bands, i));
+
+      GST_DEBUG ("channel %u band[%3u] is %.4f, expected %.4f", c, i, level,
+          reference[i]);
+      fail_unless (fabs (level - reference[i]) < tolerance,
+          "channel %u band %u: %f != %f", c, i, level, reference[i]);
+    }
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  gst_buffer_unref (inbuffer);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (spectrum, NULL);
+  gst_object_unref (bus);
+  fail_unless (gst_element_set_state (spectrum,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+  cleanup_spectrum (spectrum);
+}
+
+/* the one pass de-interleaving and the cached window against a per-channel
+ * reference using gst_fft_f32_window() */
+GST_START_TEST (test_multichannel)
+{
+  check_multichannel (FALSE, 1, FALSE, 1e-3);
+  check_multichannel (FALSE, 3, FALSE, 1e-3);
+  check_multichannel (TRUE, 1, FALSE, 1e-3);
+  check_multichannel (TRUE, 5, FALSE, 1e-3);
+}
+
+GST_END_TEST;
+
+/* fast-db has to stay within its documented error of 0.005 dB */
+GST_START_TEST (test_fast_db)
+{
+  check_multichannel (FALSE, 2, TRUE, 0.005 + 1e-3);
+  check_multichannel (TRUE, 2, TRUE, 0.005 + 1e-3);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 spectrum_suite (void)
@@ -534,6 +685,8 @@ spectrum_suite (void)
   tcase_add_test (tc_chain, test_int32);
   tcase_add_test (tc_chain, test_float32);
   tcase_add_test (tc_chain, test_float64);
+  tcase_add_test (tc_chain, test_multichannel);
+  tcase_add_test (tc_chain, test_fast_db);
 
   return s;
 }
@@ -19,6 +19,8 @@
  */
 #include <gst/check/gstcheck.h>
 #include <gst/base/gstbasesink.h>
+#include <gst/net/gstnetaddressmeta.h>
+#include <gio/gio.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -185,6 +187,244 @@ GST_START_TEST (test_udpsink_bufferlist)
 GST_END_TEST;
 #endif
 
+static GstStaticPadTemplate list_srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+GST_START_TEST (test_multiudpsink_render_list)
+{
+  GstElement *udpsink;
+  GstPad *srcpad;
+  GstBufferList *list;
+  GstSegment segment;
+  GSocket *socket;
+  GInetAddress *ia;
+  GSocketAddress *sa;
+  guint16 port;
+  gchar *clients;
+  gint i;
+
+  /* receiver, bound to a free port on the loopback interface */
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, 0);
+  fail_unless (g_socket_bind (socket, sa, TRUE, NULL));
+  g_object_unref (sa);
+  g_object_unref (ia);
+
+  sa = g_socket_get_local_address (socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (sa));
+  g_object_unref (sa);
+
+  udpsink = gst_check_setup_element ("multiudpsink");
+  clients = g_strdup_printf ("127.0.0.1:%u,127.0.0.1:%u", port, port);
+  g_object_set (udpsink, "clients", clients, NULL);
+  g_free (clients);
+
+  srcpad = gst_check_setup_src_pad_by_name (udpsink, &list_srctemplate,
+      "sink");
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (udpsink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* three packets, the last one made of two memories */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_allocate (NULL, 10 + i, NULL);
+    gst_buffer_memset (buf, 0, 'a' + i, 10 + i);
+    if (i == 2)
+      buf = gst_buffer_append (buf, gst_buffer_new_allocate (NULL, 5, NULL));
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* the same two clients were added, so every packet arrives twice */
+  for (i = 0; i < 6; i++) {
+    gchar data[32];
+    gssize len;
+
+    len = g_socket_receive (socket, data, sizeof (data), NULL, NULL);
+    fail_unless_equals_int (len, (i % 3 == 2) ? 17 : 10 + (i % 3));
+    fail_unless_equals_int (data[0], 'a' + (i % 3));
+  }
+
+  gst_element_set_state (udpsink, GST_STATE_NULL);
+
+  gst_check_teardown_pad_by_name (udpsink, "sink");
+  gst_check_teardown_element (udpsink);
+
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_multiudpsink_gso)
+{
+  static const gint sizes[] = { 100, 100, 100, 60, 30, 30 };
+  GstElement *udpsink;
+  GstPad *srcpad;
+  GstBufferList *list;
+  GstSegment segment;
+  GSocket *socket;
+  GInetAddress *ia;
+  GSocketAddress *sa;
+  guint16 port;
+  gchar *clients;
+  gint i;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, 0);
+  fail_unless (g_socket_bind (socket, sa, TRUE, NULL));
+  g_object_unref (sa);
+  g_object_unref (ia);
+
+  sa = g_socket_get_local_address (socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (sa));
+  g_object_unref (sa);
+
+  udpsink = gst_check_setup_element ("multiudpsink");
+  clients = g_strdup_printf ("127.0.0.1:%u", port);
+  g_object_set (udpsink, "clients", clients, "gso", TRUE, NULL);
+  g_free (clients);
+
+  srcpad = gst_check_setup_src_pad_by_name (udpsink, &list_srctemplate,
+      "sink");
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (udpsink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* two runs of equally sized packets, each ending with a smaller one */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_allocate (NULL, sizes[i], NULL);
+    gst_buffer_memset (buf, 0, 'a' + i, sizes[i]);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* with or without GSO support, the packets arrive as they were */
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gchar data[256];
+    gssize len;
+
+    len = g_socket_receive (socket, data, sizeof (data), NULL, NULL);
+    fail_unless_equals_int (len, sizes[i]);
+    fail_unless_equals_int (data[0], 'a' + i);
+    fail_unless_equals_int (data[len - 1], 'a' + i);
+  }
+
+  gst_element_set_state (udpsink, GST_STATE_NULL);
+
+  gst_check_teardown_pad_by_name (udpsink, "sink");
+  gst_check_teardown_element (udpsink);
+
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_dynudpsink_render_list)
+{
+  GstElement *udpsink;
+  GstPad *srcpad;
+  GstBufferList *list;
+  GstSegment segment;
+  GSocket *socket;
+  GInetAddress *ia;
+  GSocketAddress *sa, *dest, *dest2;
+  guint16 port;
+  gint i;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, 0);
+  fail_unless (g_socket_bind (socket, sa, TRUE, NULL));
+  g_object_unref (sa);
+
+  sa = g_socket_get_local_address (socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (sa));
+  g_object_unref (sa);
+
+  /* two address objects for the same receiver */
+  dest = g_inet_socket_address_new (ia, port);
+  dest2 = g_inet_socket_address_new (ia, port);
+  g_object_unref (ia);
+
+  udpsink = gst_check_setup_element ("dynudpsink");
+
+  srcpad = gst_check_setup_src_pad_by_name (udpsink, &list_srctemplate,
+      "sink");
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (udpsink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* four packets, the third one without destination is dropped and the
+   * last one is made of two memories */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 4; i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_allocate (NULL, 10 + i, NULL);
+    gst_buffer_memset (buf, 0, 'a' + i, 10 + i);
+    if (i == 3)
+      buf = gst_buffer_append (buf, gst_buffer_new_allocate (NULL, 5, NULL));
+    if (i != 2)
+      gst_buffer_add_net_address_meta (buf, i == 1 ? dest2 : dest);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  for (i = 0; i < 4; i++) {
+    gchar data[32];
+    gssize len;
+
+    if (i == 2)
+      continue;
+
+    len = g_socket_receive (socket, data, sizeof (data), NULL, NULL);
+    fail_unless_equals_int (len, (i == 3) ? 18 : 10 + i);
+    fail_unless_equals_int (data[0], 'a' + i);
+  }
+
+  gst_element_set_state (udpsink, GST_STATE_NULL);
+
+  gst_check_teardown_pad_by_name (udpsink, "sink");
+  gst_check_teardown_element (udpsink);
+
+  g_object_unref (dest);
+  g_object_unref (dest2);
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
 /*
  * Creates the test suite.
  *
@@ -201,6 +441,9 @@ udpsink_suite (void)
   tcase_set_timeout (tc_chain, 60);
 
   suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_multiudpsink_render_list);
+  tcase_add_test (tc_chain, test_multiudpsink_gso);
+  tcase_add_test (tc_chain, test_dynudpsink_render_list);
 #if 0
   tcase_add_test (tc_chain, test_udpsink);
   tcase_add_test (tc_chain, test_udpsink_bufferlist);
@@ -20,6 +20,9 @@
 #include <gio/gio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -109,6 +112,149 @@ GST_START_TEST (test_udpsrc_empty_packet)
 
 GST_END_TEST;
 
+GST_START_TEST (test_udpsrc_batch)
+{
+  GstElement *udpsrc;
+  GSocket *socket;
+  GSocketAddress *sa;
+  GInetAddress *ia;
+  GstPad *sinkpad;
+  int port = 0;
+  gint i;
+
+  udpsrc = gst_check_setup_element ("udpsrc");
+  fail_unless (udpsrc != NULL);
+  g_object_set (udpsrc, "port", 0, "batch-size", 8, "mtu", 4, NULL);
+
+  sinkpad = gst_check_setup_sink_pad_by_name (udpsrc, &sinktemplate, "src");
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  g_object_get (udpsrc, "port", &port, NULL);
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, port);
+
+  /* more packets than the batch size, and bigger than the mtu */
+  for (i = 0; i < 20; i++) {
+    gchar data[16];
+
+    g_snprintf (data, sizeof (data), "packet%02d", i);
+    fail_unless (g_socket_send_to (socket, sa, data, 9, NULL, NULL) == 9);
+  }
+
+  g_usleep (G_USEC_PER_SEC / 2);
+
+  fail_unless_equals_int (g_list_length (buffers), 20);
+  for (i = 0; i < 20; i++) {
+    GstBuffer *buf = GST_BUFFER (g_list_nth_data (buffers, i));
+    GstMapInfo map;
+    gchar data[16];
+
+    g_snprintf (data, sizeof (data), "packet%02d", i);
+    fail_unless (GST_BUFFER_DTS_IS_VALID (buf));
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, 9);
+    fail_unless_equals_string ((gchar *) map.data, data);
+    gst_buffer_unmap (buf, &map);
+  }
+
+  g_object_unref (sa);
+  g_object_unref (ia);
+
+  gst_element_set_state (udpsrc, GST_STATE_NULL);
+
+  gst_check_teardown_pad_by_name (udpsrc, "src");
+  gst_check_teardown_element (udpsrc);
+
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_udpsrc_gro)
+{
+  GstElement *udpsrc;
+  GSocket *socket;
+  GSocketAddress *sa;
+  GInetAddress *ia;
+  GstPad *sinkpad;
+  gboolean gso = FALSE;
+  gchar data[450];
+  int port = 0;
+  gint i;
+
+  udpsrc = gst_check_setup_element ("udpsrc");
+  fail_unless (udpsrc != NULL);
+  g_object_set (udpsrc, "port", 0, "gro", TRUE, NULL);
+
+  sinkpad = gst_check_setup_sink_pad_by_name (udpsrc, &sinktemplate, "src");
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  g_object_get (udpsrc, "port", &port, NULL);
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, port);
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 'a' + i / 100;
+
+#ifdef __linux__
+  {
+    gint seg_size = 100;
+
+    /* UDP_SEGMENT, over loopback the packets stay coalesced */
+    gso = setsockopt (g_socket_get_fd (socket), 17, 103, &seg_size,
+        sizeof (seg_size)) == 0;
+  }
+#endif
+
+  /* five packets, the last one smaller than the others */
+  if (gso) {
+    fail_unless (g_socket_send_to (socket, sa, data, 450, NULL, NULL) == 450);
+  } else {
+    for (i = 0; i < 450; i += 100)
+      fail_unless (g_socket_send_to (socket, sa, data + i, MIN (100, 450 - i),
+              NULL, NULL) == MIN (100, 450 - i));
+  }
+
+  g_usleep (G_USEC_PER_SEC / 2);
+
+  fail_unless_equals_int (g_list_length (buffers), 5);
+  for (i = 0; i < 5; i++) {
+    GstBuffer *buf = GST_BUFFER (g_list_nth_data (buffers, i));
+    GstMapInfo map;
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, i < 4 ? 100 : 50);
+    fail_unless (memcmp (map.data, data + i * 100, map.size) == 0);
+    gst_buffer_unmap (buf, &map);
+  }
+
+  g_object_unref (sa);
+  g_object_unref (ia);
+
+  gst_element_set_state (udpsrc, GST_STATE_NULL);
+
+  gst_check_teardown_pad_by_name (udpsrc, "src");
+  gst_check_teardown_element (udpsrc);
+
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
 static Suite *
 udpsrc_suite (void)
 {
@@ -117,6 +263,8 @@ udpsrc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_udpsrc_empty_packet);
+  tcase_add_test (tc_chain, test_udpsrc_batch);
+  tcase_add_test (tc_chain, test_udpsrc_gro);
   return s;
 }
 
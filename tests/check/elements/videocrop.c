@@ -533,6 +533,85 @@ GST_START_TEST (test_passthrough)
 
 GST_END_TEST;
 
+static gboolean
+crop_meta_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION) {
+    gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+    gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+GST_START_TEST (test_crop_meta)
+{
+  GstElement *crop;
+  GstPad *srcpad, *sinkpad;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstBuffer *inbuf, *outbuf;
+  GstVideoCropMeta *crop_meta;
+  GstVideoMeta *video_meta;
+  static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+  static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+  crop = gst_check_setup_element ("videocrop");
+  g_object_set (crop, "left", 2, "right", 4, "top", 6, "bottom", 8, NULL);
+
+  srcpad = gst_check_setup_src_pad (crop, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (crop, &sinktemplate);
+  gst_pad_set_query_function (sinkpad, crop_meta_sink_query);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (crop,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 64, 48);
+  caps = gst_video_info_to_caps (&info);
+  gst_check_setup_events (srcpad, crop, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  inbuf = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&info));
+  gst_buffer_ref (inbuf);
+  fail_unless_equals_int (gst_pad_push (srcpad, inbuf), GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  outbuf = GST_BUFFER (buffers->data);
+
+  /* the data is not copied, only described by the metas */
+  fail_unless (gst_buffer_peek_memory (outbuf, 0) ==
+      gst_buffer_peek_memory (inbuf, 0));
+
+  crop_meta = gst_buffer_get_video_crop_meta (outbuf);
+  fail_unless (crop_meta != NULL);
+  fail_unless_equals_int (crop_meta->x, 2);
+  fail_unless_equals_int (crop_meta->y, 6);
+  fail_unless_equals_int (crop_meta->width, 64 - 2 - 4);
+  fail_unless_equals_int (crop_meta->height, 48 - 6 - 8);
+
+  video_meta = gst_buffer_get_video_meta (outbuf);
+  fail_unless (video_meta != NULL);
+  fail_unless_equals_int (video_meta->width, 64);
+  fail_unless_equals_int (video_meta->height, 48);
+
+  gst_buffer_unref (inbuf);
+  gst_check_drop_buffers ();
+  fail_unless (gst_element_set_state (crop,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (crop);
+  gst_check_teardown_sink_pad (crop);
+  gst_check_teardown_element (crop);
+}
+
+GST_END_TEST;
+
 static gint
 notgst_value_list_get_nth_int (const GValue * list_val, guint n)
 {
@@ -810,6 +889,7 @@ videocrop_suite (void)
   tcase_add_test (tc_chain, test_crop_to_1x1);
   tcase_add_test (tc_chain, test_caps_transform);
   tcase_add_test (tc_chain, test_passthrough);
+  tcase_add_test (tc_chain, test_crop_meta);
   tcase_add_test (tc_chain, test_unit_sizes);
   tcase_add_loop_test (tc_chain, test_cropping, 0, 25);
 
@@ -225,6 +225,7 @@ GST_START_TEST (test_videoflip)
   check_filter ("videoflip", 2, "method", 2, NULL);
   check_filter ("videoflip", 2, "method", 4, NULL);
   check_filter ("videoflip", 2, "method", 5, NULL);
+  check_filter ("videoflip", 2, "method", 2, "n-threads", 3, NULL);
 
   event = gst_event_new_tag (gst_tag_list_new_empty ());
   check_filter_with_event ("videoflip", event, 2, "method", 8, NULL);
@@ -153,6 +153,64 @@ GST_START_TEST (test_y4m)
 
 GST_END_TEST;
 
+#define PADDED_CAPS_STRING "video/x-raw, " \
+                           "format = (string) I420, "\
+                           "width = (int) 383, " \
+                           "height = (int) 288, " \
+                           "framerate = (fraction) 25/1, " \
+                           "pixel-aspect-ratio = (fraction) 1/1"
+
+GST_START_TEST (test_y4m_padded)
+{
+  GstElement *y4menc;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  GstMapInfo map;
+  gchar *data;
+  gint size, i;
+
+  y4menc = setup_y4menc ();
+  fail_unless (gst_element_set_state (y4menc,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* Y rows are padded to 384 bytes, chroma rows of 192 bytes are tight */
+  size = 384 * 288 + 2 * 192 * 144;
+  inbuffer = gst_buffer_new_and_alloc (size);
+  gst_buffer_memset (inbuffer, 0, 0, size);
+  for (i = 0; i < 288; i++)
+    gst_buffer_memset (inbuffer, i * 384 + 383, 0xff, 1);
+
+  caps = gst_caps_from_string (PADDED_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, y4menc, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  outbuffer = GST_BUFFER (buffers->data);
+
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  data = strstr ((gchar *) map.data, "FRAME\n");
+  fail_unless (data != NULL);
+  data += strlen ("FRAME\n");
+  /* padding must have been stripped from the rows */
+  fail_unless_equals_int (map.size - (data - (gchar *) map.data),
+      383 * 288 + 2 * 192 * 144);
+  for (i = 0; i < 383 * 288 + 2 * 192 * 144; i++)
+    fail_unless (data[i] == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  buffers = g_list_remove (buffers, outbuffer);
+  gst_buffer_unref (outbuffer);
+
+  cleanup_y4menc (y4menc);
+  g_list_free (buffers);
+  buffers = NULL;
+}
+
+GST_END_TEST;
+
 static Suite *
 y4menc_suite (void)
 {
@@ -161,6 +219,7 @@ y4menc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_y4m);
+  tcase_add_test (tc_chain, test_y4m_padded);
 
   return s;
 }
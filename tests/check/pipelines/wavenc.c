@@ -24,6 +24,8 @@
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#include <string.h>
+
 #include <gst/check/gstcheck.h>
 #include <gst/audio/audio.h>
 #include <gst/audio/audio-enumtypes.h>
@@ -155,6 +157,58 @@ GST_START_TEST (test_encode_stereo)
 
 GST_END_TEST;
 
+static void
+header_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    GstBuffer ** header)
+{
+  if (*header == NULL)
+    *header = gst_buffer_ref (buf);
+}
+
+GST_START_TEST (test_encode_rf64_reserved)
+{
+  GstElement *pipeline, *sink;
+  GstBuffer *header = NULL;
+  GstMessage *msg;
+  GstBus *bus;
+  GstMapInfo map;
+
+  pipeline = gst_parse_launch ("audiotestsrc num-buffers=10 ! "
+      "audio/x-raw,format=S16LE,channels=2,rate=44100 ! wavenc rf64=true ! "
+      "fakesink name=sink signal-handoffs=true", NULL);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (header_handoff), &header);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* a file below 4 GB is a RIFF file with the ds64 space kept as JUNK */
+  fail_unless (header != NULL);
+  gst_buffer_map (header, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 44 + 36);
+  fail_unless (memcmp (map.data, "RIFF", 4) == 0);
+  fail_unless (memcmp (map.data + 8, "WAVE", 4) == 0);
+  fail_unless (memcmp (map.data + 12, "JUNK", 4) == 0);
+  fail_unless_equals_int (GST_READ_UINT32_LE (map.data + 16), 28);
+  fail_unless (memcmp (map.data + 48, "fmt ", 4) == 0);
+  fail_unless_equals_int (GST_READ_UINT16_LE (map.data + 58), 2);
+  fail_unless (memcmp (map.data + 72, "data", 4) == 0);
+  gst_buffer_unmap (header, &map);
+  gst_buffer_unref (header);
+}
+
+GST_END_TEST;
+
 #if 0
 GST_START_TEST (test_encode_multichannel)
 {
@@ -196,6 +250,7 @@ wavenc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_encode_stereo);
+  tcase_add_test (tc_chain, test_encode_rf64_reserved);
   /* FIXME: improve wavenc
      tcase_add_test (tc_chain, test_encode_multichannel);
    */